@@ -41,6 +41,8 @@
 
 // Private variables
 static struct pios_mutex *lock;
+// Kept in step with the object by its callback, so reads need no lock
+static volatile SystemAlarmsData alarms_cache;
 
 // Private functions
 static int32_t hasSeverity(SystemAlarmsAlarmOptions severity);
@@ -54,6 +56,8 @@ int32_t AlarmsInitialize(void)
 	lock = PIOS_Mutex_Create();
 	PIOS_Assert(lock != NULL);
 
+	SystemAlarmsConnectCopy(&alarms_cache);
+
 	uint8_t reboot_reason = SYSTEMALARMS_REBOOTCAUSE_UNDEFINED;
 
 	switch (PIOS_RESET_GetResetReason()) {
@@ -104,6 +108,12 @@ int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity
 		return -1;
 	}
 
+	// Most calls leave the severity as it was, those are done here
+	if (alarms_cache.Alarm[alarm] == severity)
+	{
+		return 0;
+	}
+
 	// Lock
 	PIOS_Mutex_Lock(lock, PIOS_MUTEX_TIMEOUT_MAX);
 
@@ -128,17 +138,13 @@ int32_t AlarmsSet(SystemAlarmsAlarmElem alarm, SystemAlarmsAlarmOptions severity
  */
 SystemAlarmsAlarmOptions AlarmsGet(SystemAlarmsAlarmElem alarm)
 {
-	SystemAlarmsData alarms;
-
 	// Check that this is a valid alarm
 	if (alarm >= SYSTEMALARMS_ALARM_NUMELEM)
 	{
 		return 0;
 	}
 
-    // Read alarm
-    SystemAlarmsGet(&alarms);
-    return alarms.Alarm[alarm];
+    return alarms_cache.Alarm[alarm];
 }
 
 /**
@@ -218,27 +224,18 @@ int32_t AlarmsHasCritical()
  */
 static int32_t hasSeverity(SystemAlarmsAlarmOptions severity)
 {
-	SystemAlarmsData alarms;
 	uint32_t n;
 
-	// Lock
-	PIOS_Mutex_Lock(lock, PIOS_MUTEX_TIMEOUT_MAX);
-
-    // Read alarms
-    SystemAlarmsGet(&alarms);
-
     // Go through alarms and check if any are of the given severity or higher
     for (n = 0; n < SYSTEMALARMS_ALARM_NUMELEM; ++n)
     {
-    	if ( alarms.Alarm[n] >= severity)
+    	if ( alarms_cache.Alarm[n] >= severity)
     	{
-    		PIOS_Mutex_Unlock(lock);
     		return 1;
     	}
     }
 
     // If this point is reached then no alarms found
-	PIOS_Mutex_Unlock(lock);
     return 0;
 }
 
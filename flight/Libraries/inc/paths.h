@@ -40,6 +40,22 @@ struct path_status {
 	float path_direction[2];
 };
 
+/**
+ * Geometry of a path segment, which only changes with the path
+ */
+struct path_segment {
+	uint8_t mode;
+	bool clockwise;
+	float start[2];
+	float end[2];
+	float path[2];		// end minus start
+	float dist_path;	// length of path
+	float center[2];	// of the circle or arc
+	float radius;		// of the circle or arc
+};
+
+void path_segment_init(const PathDesiredData *pathDesired, struct path_segment *seg);
+void path_segment_progress(const struct path_segment *seg, const float * cur_point, struct path_status * status);
 void path_progress(const PathDesiredData *pathDesired, const float * cur_point, struct path_status * status);
 
 #endif /* PATHS_H_ */
@@ -29,6 +29,8 @@
 #include "systemalarms.h"
 
 extern int32_t configuration_check();
+void configuration_check_invalidate(uint32_t obj_id);
+void configuration_check_modules();
 void set_config_error(SystemAlarmsConfigErrorOptions error_code);
 
 #endif /* SANITYCHECK_H */
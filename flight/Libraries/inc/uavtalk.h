@@ -35,6 +35,10 @@ typedef int32_t (*UAVTalkOutputCb)(void *ctx, uint8_t *data, int32_t length);
 typedef void (*UAVTalkAckCb)(void *ctx, uint32_t obj_id, uint16_t inst_id);
 typedef int32_t (*UAVTalkFileCb)(void *ctx, uint8_t *buf,
 		uint32_t file_id, uint32_t offset, uint32_t len);
+//! Reserve space for a whole frame in the output, or NULL to copy it out via UAVTalkOutputCb
+typedef uint8_t *(*UAVTalkReserveCb)(void *ctx, int32_t length);
+//! Send a frame built in reserved space
+typedef int32_t (*UAVTalkCommitCb)(void *ctx, int32_t length);
 
 //! Tracking statistics for a UAVTalk connection
 typedef struct {
@@ -57,6 +61,11 @@ typedef enum {UAVTALK_STATE_ERROR = 0, UAVTALK_STATE_SYNC, UAVTALK_STATE_TYPE, U
 UAVTalkConnection UAVTalkInitialize(void *ctx, UAVTalkOutputCb outputStream, UAVTalkAckCb ackCallback, UAVTalkFileCb fileCallback);
 int32_t UAVTalkSendObject(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint8_t acked);
 int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId);
+int32_t UAVTalkSendObjectData(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId,
+		const void *data, bool timestamped);
+int32_t UAVTalkSendObjectPartial(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId,
+		const uint16_t *fieldSizes, uint8_t numFields, uint32_t fieldMask, bool timestamped,
+		const void *data);
 void UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t *rxbytes,
 		int numbytes);
 UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connection, uint8_t rxbyte);
@@ -64,6 +73,8 @@ UAVTalkRxState UAVTalkRelayInputStream(UAVTalkConnection connectionHandle, uint8
 int32_t UAVTalkRelayPacket(UAVTalkConnection inConnectionHandle, UAVTalkConnection outConnectionHandle);
 int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle);
 void UAVTalkGetStats(UAVTalkConnection connection, UAVTalkStats *stats);
+void UAVTalkSetDirectOutput(UAVTalkConnection connectionHandle,
+		UAVTalkReserveCb reserveCallback, UAVTalkCommitCb commitCallback);
 uint32_t UAVTalkGetPacketObjId(UAVTalkConnection connection);
 uint32_t UAVTalkGetPacketInstId(UAVTalkConnection connection);
 
@@ -97,6 +97,8 @@ typedef struct {
 	uint8_t *txBuffer;
 
 	UAVTalkOutputCb outCb;
+	UAVTalkReserveCb reserveCb;
+	UAVTalkCommitCb commitCb;
 	UAVTalkAckCb ackCb;
 	UAVTalkFileCb fileCb;
 	void *cbCtx;
@@ -118,9 +120,32 @@ typedef struct {
 #define UAVTALK_TYPE_FILEDATA  (UAVTALK_TYPE_VER | 0x09)
 #define UAVTALK_TYPE_OBJ_TS    (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ)
 
+/* Partial object: the header, instance id and timestamp of an object frame,
+ * then a 32 bit mask of the fields present and only those fields, in packed
+ * order.  Bit n is the nth field of the packed object. */
+#define UAVTALK_TYPE_OBJ_PARTIAL    (UAVTALK_TYPE_VER | 0x0C)
+#define UAVTALK_TYPE_OBJ_PARTIAL_TS (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_OBJ_PARTIAL)
+#define UAVTALK_PARTIAL_MASK_LENGTH 4
+#define UAVTALK_PARTIAL_MAX_FIELDS  32
+
+/* Compressed records, only ever written to logs by the Logging module:
+ *   key:   sync, type, len(2), objId(4), slot, timestamp(2), data, crc
+ *   delta: sync, type, len(2), slot, timestamp(2), payload, crc
+ * A key stores a single instance object in a slot; a delta is the XOR
+ * against the slot's last sample, as a bitmap of non-zero bytes followed by
+ * those bytes for each group of 8. */
+#define UAVTALK_TYPE_LOG_KEY   (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_VER | 0x0A)
+#define UAVTALK_TYPE_LOG_DELTA (UAVTALK_TIMESTAMPED | UAVTALK_TYPE_VER | 0x0B)
+
 #define UAVTALK_FILEDATA_EOF   0x01
 #define UAVTALK_FILEDATA_LAST  0x02
 
+/* Low bits of the file request flags ask for a number of data messages per
+ * request; 0 keeps the default */
+#define UAVTALK_FILEREQ_WINDOW_MASK     0x00FF
+#define UAVTALK_FILEREQ_DEFAULT_WINDOW  6
+#define UAVTALK_FILEREQ_MAX_WINDOW      32
+
 //macros
 #define CHECKCONHANDLE(handle,variable,failcommand) \
 	variable = (UAVTalkConnectionData*) handle; \
@@ -351,6 +351,24 @@ void INSCovariancePrediction(float dT)
 	CovariancePrediction(F, G, Q, dT, P);
 }
 
+/**
+ * Propagate the covariance over several state prediction steps at once.
+ * The process noise of each step adds up, so it grows with the sum of the
+ * squared step lengths rather than the square of their total.
+ * @param[in] dT total length of the steps
+ * @param[in] dTsqSum sum of the squared lengths of the steps
+ */
+void INSCovariancePredictionSteps(float dT, float dTsqSum)
+{
+	float Qsteps[NUMW];
+	float scale = dTsqSum / (dT * dT);
+
+	for (int i = 0; i < NUMW; i++)
+		Qsteps[i] = Q[i] * scale;
+
+	CovariancePrediction(F, G, Qsteps, dT, P);
+}
+
 void INSCorrection(const float mag_data[3], const float Pos[3], const float Vel[3],
 		   float BaroAlt, uint16_t SensorsUsed)
 {
@@ -589,6 +607,8 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 //            - or see Simon, "Optimal State Estimation," 1st Ed, p.150
 //  The SensorsUsed variable is a bitwise mask indicating which sensors
 //     should be used in the update.
+//  Each row of H has at most four nonzero terms, so only those are used
+//     to find HP and HPHR.  A row without any leaves P and X as they are.
 //  ************************************************
 
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
@@ -596,7 +616,8 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
 		  uint16_t SensorsUsed)
 {
 	float HP[NUMX], HPHR, Error;
-	uint8_t i, j, k, m;
+	uint8_t i, j, k, m, n, num_nz;
+	uint8_t nz[NUMX];
 
 	// Iterate through all the possible measurements and apply the
 	// appropriate corrections
@@ -604,14 +625,22 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
 
 		if (SensorsUsed & (0x01 << m)) {	// use this sensor for update
 
+			num_nz = 0;	// Find the nonzero terms of this row of H
+			for (k = 0; k < NUMX; k++)
+				if (H[m][k] != 0.0f)
+					nz[num_nz++] = k;
+
+			if (num_nz == 0)
+				continue;
+
 			for (j = 0; j < NUMX; j++) {	// Find Hp = H*P
 				HP[j] = 0.0f;
-				for (k = 0; k < NUMX; k++)
-					HP[j] += H[m][k] * P[k][j];
+				for (n = 0; n < num_nz; n++)
+					HP[j] += H[m][nz[n]] * P[nz[n]][j];
 			}
 			HPHR = R[m];	// Find  HPHR = H*P*H' + R
-			for (k = 0; k < NUMX; k++)
-				HPHR += HP[k] * H[m][k];
+			for (n = 0; n < num_nz; n++)
+				HPHR += HP[nz[n]] * H[m][nz[n]];
 
 			for (k = 0; k < NUMX; k++)
 				K[k][m] = HP[k] / HPHR;	// find K = HP/HPHR
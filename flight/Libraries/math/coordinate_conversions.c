@@ -58,6 +58,66 @@ void RneFromLLA(float LLA[3], float Rne[3][3])
 	Rne[2][2] = -sinLat;
 }
 
+/**
+ * Work out the home terms of the NED conversions
+ * @param[out] home frame to set up
+ * @param[in] lat home latitude in degrees * 10e6
+ * @param[in] lon home longitude in degrees * 10e6
+ * @param[in] alt home altitude in m
+ */
+void home_frame_init(struct home_frame *home, int32_t lat, int32_t lon, float alt)
+{
+	home->lat = lat;
+	home->lon = lon;
+	home->alt = alt;
+
+	home->T[0] = (alt + 6.378137E6f) * (DEG2RAD / 10.0e6f);
+	home->T[1] = cosf(lat / 10.0e6f * DEG2RAD) * home->T[0];
+	home->T[2] = -1.0f;
+}
+
+/**
+ * Convert positions to NED relative to home
+ * @param[in] home frame from home_frame_init()
+ * @param[in] lat latitudes in degrees * 10e6
+ * @param[in] lon longitudes in degrees * 10e6
+ * @param[in] alt altitudes in m
+ * @param[out] NED positions in m
+ * @param[in] count number of positions
+ */
+void lla_to_ned_batch(const struct home_frame *home, const int32_t *lat,
+		const int32_t *lon, const float *alt, float NED[][3], int count)
+{
+	const float T0 = home->T[0], T1 = home->T[1], T2 = home->T[2];
+
+	for (int i = 0; i < count; i++) {
+		NED[i][0] = T0 * (lat[i] - home->lat);
+		NED[i][1] = T1 * (lon[i] - home->lon);
+		NED[i][2] = T2 * (alt[i] - home->alt);
+	}
+}
+
+/**
+ * Convert NED positions relative to home back to latitude, longitude and altitude
+ * @param[in] home frame from home_frame_init()
+ * @param[in] NED positions in m
+ * @param[out] lat latitudes in degrees * 10e6
+ * @param[out] lon longitudes in degrees * 10e6
+ * @param[out] alt altitudes in m
+ * @param[in] count number of positions
+ */
+void ned_to_lla_batch(const struct home_frame *home, const float NED[][3],
+		int32_t *lat, int32_t *lon, float *alt, int count)
+{
+	const float iT0 = 1.0f / home->T[0], iT1 = 1.0f / home->T[1], iT2 = 1.0f / home->T[2];
+
+	for (int i = 0; i < count; i++) {
+		lat[i] = home->lat + (int32_t)roundf(NED[i][0] * iT0);
+		lon[i] = home->lon + (int32_t)roundf(NED[i][1] * iT1);
+		alt[i] = home->alt + NED[i][2] * iT2;
+	}
+}
+
 // ****** find roll, pitch, yaw from quaternion ********
 void Quaternion2RPY(const float q[4], float rpy[3])
 {
@@ -268,6 +328,12 @@ void Rv2Rot(float Rv[3], float R[3][3])
 	// To save .text space, uses Quaternion2R()
 	float q[4];
 
+	Rv2Quaternion(Rv, q);
+	Quaternion2R(q, R);
+}
+
+void Rv2Quaternion(const float Rv[3], float q[4])
+{
 	float angle = VectorMagnitude(Rv);
 	if (angle <= 0.00048828125f) {
 		// angle < sqrt(2*machine_epsilon(float)), so flush cos(x) to 1.0f
@@ -286,8 +352,24 @@ void Rv2Rot(float Rv[3], float R[3][3])
 		q[2] = scale*Rv[1];
 		q[3] = scale*Rv[2];
 	}
+}
 
-	Quaternion2R(q, R);
+/**
+ * @brief Find the rotation vector of a gyro interval, making up for the
+ * coning the samples miss with the interval before (two sample algorithm)
+ * @param[in] dtheta_prev the delta angle of the last interval
+ * @param[in] dtheta the delta angle of this interval
+ * @param[out] phi the rotation vector of this interval
+ */
+void coning_rotation_vector(const float dtheta_prev[3], const float dtheta[3], float phi[3])
+{
+	float coning[3];
+
+	CrossProduct(dtheta_prev, dtheta, coning);
+
+	phi[0] = dtheta[0] + coning[0] * (1.0f / 12.0f);
+	phi[1] = dtheta[1] + coning[1] * (1.0f / 12.0f);
+	phi[2] = dtheta[2] + coning[2] * (1.0f / 12.0f);
 }
 
 // ****** Vector Cross Product ********
@@ -35,9 +35,30 @@
 #define COORDINATECONVERSIONS_H_
 
 #include <stdbool.h>
+#include <stdint.h>
 
 void RneFromLLA(float LLA[3], float Rne[3][3]);
 
+/**
+ * Local tangent plane around a home location, as used for NED positions
+ * everywhere on board.  The per home terms are worked out once, so a
+ * position costs a multiply per axis either way.  Latitude and longitude
+ * are in the UAVO units of degrees * 10e6, and the differences to home are
+ * taken in integers so no precision is lost to floats.
+ */
+struct home_frame {
+	int32_t lat;
+	int32_t lon;
+	float alt;
+	float T[3];	// Metres NED per unit of latitude, longitude and altitude
+};
+
+void home_frame_init(struct home_frame *home, int32_t lat, int32_t lon, float alt);
+void lla_to_ned_batch(const struct home_frame *home, const int32_t *lat,
+		const int32_t *lon, const float *alt, float NED[][3], int count);
+void ned_to_lla_batch(const struct home_frame *home, const float NED[][3],
+		int32_t *lat, int32_t *lon, float *alt, int count);
+
     // ****** find rotation matrix from rotation vector
 void Rv2Rot(float Rv[3], float R[3][3]);
 
@@ -62,6 +83,12 @@ void R2Quaternion(float R[3][3], float q[4]);
 	// ****** solution is approximate if can't be exact ***
 uint8_t RotFrom2Vectors(const float v1b[3], const float v1e[3], const float v2b[3], const float v2e[3], float Rbe[3][3]);
 
+	// ****** Quaternion from Rotation Vector ********
+void Rv2Quaternion(const float Rv[3], float q[4]);
+
+	// ****** Coning Compensated Rotation Vector ********
+void coning_rotation_vector(const float dtheta_prev[3], const float dtheta[3], float phi[3]);
+
 	// ****** Vector Cross Product ********
 void CrossProduct(const float v1[3], const float v2[3], float result[3]);
 
@@ -59,8 +59,9 @@ static const float lpfilter_butterworth_factors[16] = {
 	0.3902f, 1.1111f, 1.6629f, 1.9616f
 };
 
+/* Transposed direct form II, which needs two state terms instead of four */
 struct lpfilter_biquad_state {
-	float x1, x2, y1, y2;
+	float s1, s2;
 };
 
 struct lpfilter_biquad {
@@ -82,12 +83,28 @@ struct lpfilter_state {
 
 };
 
+/**
+ * Run one biquad stage on a sample.  With b1 = 2*b0 and b2 = b0, this takes
+ * three multiplies.
+ */
+static inline float lpfilter_biquad_step(const struct lpfilter_biquad *b,
+		struct lpfilter_biquad_state *s, float sample)
+{
+	float bx = b->b0 * sample;
+	float y = bx + s->s1;
+
+	s->s1 = 2.0f * bx + b->a1 * y + s->s2;
+	s->s2 = bx + b->a2 * y;
+
+	return y;
+}
+
 void lpfilter_construct_single_biquad(struct lpfilter_biquad *b, float cutoff, float dT, float q, uint8_t width)
 {
 	float f = 1.0f / tanf((float)M_PI*cutoff*dT);
 
 	// Skipping calculation of b1 and b2, since this only going to do Butterworth.
-	// These terms are optimized away in the actual filtering calculation.
+	// They are 2*b0 and b0, which lpfilter_biquad_step uses directly.
 	b->b0 = 1.0f / (1.0f + q*f + f*f);
 	b->a1 = 2.0f * (f*f - 1.0f) * b->b0;
 	b->a2 = -(1.0f - q*f + f*f) * b->b0;
@@ -201,17 +218,8 @@ float lpfilter_run_single(lpfilter_state_t filter, uint8_t axis, float sample)
 	for(int i = 0; i < order; i++)
 	{
 		struct lpfilter_biquad *b = filter->biquad[i];
-		struct lpfilter_biquad_state *s = &b->s[axis];
 
-		float y = b->b0 * (sample + 2.0f * s->x1 + s->x2) + b->a1 * s->y1 + b->a2 * s->y2;
-
-		s->y2 = s->y1;
-		s->y1 = y;
-
-		s->x2 = s->x1;
-		s->x1 = sample;
-
-		sample = y;
+		sample = lpfilter_biquad_step(b, &b->s[axis], sample);
 	}
 
 	return sample;
@@ -243,17 +251,7 @@ void lpfilter_run(lpfilter_state_t filter, float *sample)
 
 		for(int j = 0; j < filter->width; j++)
 		{
-			struct lpfilter_biquad_state *s = &b->s[j];
-
-			float y = b->b0 * (sample[j] + 2.0f * s->x1 + s->x2) + b->a1 * s->y1 + b->a2 * s->y2;
-
-			s->y2 = s->y1;
-			s->y1 = y;
-
-			s->x2 = s->x1;
-			s->x1 = sample[j];
-
-			sample[j] = y;
+			sample[j] = lpfilter_biquad_step(b, &b->s[j], sample[j]);
 		}
 	}
 }
@@ -329,6 +329,55 @@ uint16_t randomize_int(uint16_t interval)
 	return (uint16_t)( ((float)interval * (float)lo) / (float)0x7FFFFFFF );
 }
 
+/**
+ * In place radix-2 complex FFT
+ * @param[in,out] re Real parts
+ * @param[in,out] im Imaginary parts
+ * @param[in] n Number of points, a power of 2
+ */
+void fft_radix2(float *re, float *im, uint16_t n)
+{
+	// Bit reversal permutation
+	for (uint16_t i = 1, j = 0; i < n; i++) {
+		uint16_t bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+
+		if (i < j) {
+			float tmp = re[i]; re[i] = re[j]; re[j] = tmp;
+			tmp = im[i]; im[i] = im[j]; im[j] = tmp;
+		}
+	}
+
+	for (uint16_t len = 2; len <= n; len <<= 1) {
+		float angle = -2 * PI / len;
+		float w_re = cosf(angle);
+		float w_im = sinf(angle);
+
+		for (uint16_t i = 0; i < n; i += len) {
+			float t_re = 1, t_im = 0;
+
+			for (uint16_t k = 0; k < len / 2; k++) {
+				uint16_t a = i + k;
+				uint16_t b = a + len / 2;
+
+				float b_re = re[b] * t_re - im[b] * t_im;
+				float b_im = re[b] * t_im + im[b] * t_re;
+
+				re[b] = re[a] - b_re;
+				im[b] = im[a] - b_im;
+				re[a] += b_re;
+				im[a] += b_im;
+
+				float next_re = t_re * w_re - t_im * w_im;
+				t_im = t_re * w_im + t_im * w_re;
+				t_re = next_re;
+			}
+		}
+	}
+}
+
 /**
  * @}
  * @}
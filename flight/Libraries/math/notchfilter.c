@@ -0,0 +1,389 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Filtering support libraries
+ * @{
+ *
+ * @file       notchfilter.c
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @brief      Notch filters that follow the strongest vibration peak or the motors
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "pios.h"
+#include "misc_math.h"
+#include "notchfilter.h"
+
+#define NOTCHFILTER_MAX_WIDTH		3
+#define RPMNOTCH_MAX_WIDTH		3
+#define NOTCHFILTER_WINDOW		64
+
+//! Share of the time, in percent, the peak search may take up
+#define NOTCHFILTER_CPU_PERCENT		5
+//! How much more power than the band's average a bin needs to count as a peak
+#define NOTCHFILTER_PEAK_RATIO		4.0f
+//! How far towards a new peak the notch moves in one step
+#define NOTCHFILTER_TRACK_GAIN		0.5f
+
+/*
+ * The samples of each axis are decimated by averaging, so the band searched
+ * fits under the Nyquist frequency of a short window.  Once a window is
+ * collected, one axis per call is transformed and its notch retuned to the
+ * strongest bin in the band, interpolated between its neighbours.  A new
+ * window isn't collected until enough samples have passed for the search
+ * to stay within NOTCHFILTER_CPU_PERCENT of the time.
+ */
+
+struct notchfilter_axis {
+	// Transposed direct form II, with b2 = b0 and a1 = b1
+	float b0, b1, a2;
+	float s1, s2;
+
+	float freq;
+	bool active;
+
+	float decim_sum;
+	float samples[NOTCHFILTER_WINDOW];
+};
+
+struct notchfilter_state {
+	struct notchfilter_axis axis[NOTCHFILTER_MAX_WIDTH];
+
+	float window[NOTCHFILTER_WINDOW];
+	float re[NOTCHFILTER_WINDOW];
+	float im[NOTCHFILTER_WINDOW];
+
+	float dT, q;
+	float min_freq, max_freq;
+	float bin_freq;
+	uint16_t min_bin, max_bin;
+
+	uint16_t decimation;
+	uint16_t decim_count;
+	uint16_t collected;
+	uint8_t analyze_axis;
+	uint8_t width;
+
+	uint32_t analysis_us;
+	uint32_t holdoff;
+};
+
+//! Motors whose rotation frequency can be notched
+#define RPMNOTCH_MAX_MOTORS		10
+
+struct rpmnotch_motor {
+	float b0, b1, a2;
+	float s1[RPMNOTCH_MAX_WIDTH], s2[RPMNOTCH_MAX_WIDTH];
+
+	bool active;
+};
+
+/*
+ * One notch per motor, at the rotation frequency its ESC reports, shared by
+ * all axes.  Retuning is left to the caller, when a reading changes.
+ */
+struct rpmnotch_state {
+	struct rpmnotch_motor motor[RPMNOTCH_MAX_MOTORS];
+
+	float dT, q;
+	float min_freq, max_freq;
+	uint8_t motors;
+};
+
+static void notch_coeffs(float freq, float dT, float q, float *b0, float *b1, float *a2)
+{
+	float w0 = 2.0f * (float)M_PI * freq * dT;
+	float alpha = sinf(w0) / (2.0f * q);
+	float g = 1.0f / (1.0f + alpha);
+
+	*b0 = g;
+	*b1 = -2.0f * cosf(w0) * g;
+	*a2 = (1.0f - alpha) * g;
+}
+
+static void notchfilter_tune(struct notchfilter_state *filter, struct notchfilter_axis *ax)
+{
+	notch_coeffs(ax->freq, filter->dT, filter->q, &ax->b0, &ax->b1, &ax->a2);
+}
+
+static void notchfilter_collect(struct notchfilter_state *filter, const float *sample)
+{
+	for (int i = 0; i < filter->width; i++)
+		filter->axis[i].decim_sum += sample[i];
+
+	if (++filter->decim_count < filter->decimation)
+		return;
+
+	for (int i = 0; i < filter->width; i++) {
+		struct notchfilter_axis *ax = &filter->axis[i];
+
+		ax->samples[filter->collected] = ax->decim_sum / filter->decimation;
+		ax->decim_sum = 0;
+	}
+
+	filter->decim_count = 0;
+	filter->collected++;
+}
+
+static void notchfilter_analyze(struct notchfilter_state *filter)
+{
+	uint32_t start = PIOS_DELAY_GetRaw();
+	struct notchfilter_axis *ax = &filter->axis[filter->analyze_axis];
+
+	float mean = 0;
+	for (int i = 0; i < NOTCHFILTER_WINDOW; i++)
+		mean += ax->samples[i];
+	mean /= NOTCHFILTER_WINDOW;
+
+	for (int i = 0; i < NOTCHFILTER_WINDOW; i++) {
+		filter->re[i] = filter->window[i] * (ax->samples[i] - mean);
+		filter->im[i] = 0;
+	}
+
+	fft_radix2(filter->re, filter->im, NOTCHFILTER_WINDOW);
+
+	// Power of the band and the bins either side of it, kept in re
+	for (uint16_t k = filter->min_bin - 1; k <= filter->max_bin + 1; k++)
+		filter->re[k] = filter->re[k] * filter->re[k] + filter->im[k] * filter->im[k];
+
+	float total = 0, peak = 0;
+	uint16_t peak_bin = 0;
+	for (uint16_t k = filter->min_bin; k <= filter->max_bin; k++) {
+		total += filter->re[k];
+		if (filter->re[k] > peak) {
+			peak = filter->re[k];
+			peak_bin = k;
+		}
+	}
+
+	uint16_t bins = filter->max_bin - filter->min_bin + 1;
+
+	// Leakage from below the band slopes down into it, so it needs to be a
+	// local maximum too
+	if (peak_bin && peak * bins > NOTCHFILTER_PEAK_RATIO * total &&
+			filter->re[peak_bin - 1] < peak && filter->re[peak_bin + 1] < peak) {
+		float y0 = sqrtf(filter->re[peak_bin - 1]);
+		float y1 = sqrtf(peak);
+		float y2 = sqrtf(filter->re[peak_bin + 1]);
+		float delta = 0.5f * (y2 - y0) / (2.0f * y1 - y0 - y2);
+
+		float freq = bound_min_max((peak_bin + delta) * filter->bin_freq,
+				filter->min_freq, filter->max_freq);
+
+		if (ax->active) {
+			ax->freq += NOTCHFILTER_TRACK_GAIN * (freq - ax->freq);
+		} else {
+			ax->freq = freq;
+			ax->active = true;
+		}
+
+		notchfilter_tune(filter, ax);
+	}
+
+	filter->analysis_us += PIOS_DELAY_DiffuS(start);
+
+	if (++filter->analyze_axis < filter->width)
+		return;
+
+	// Collecting the window took its own share of the time already
+	uint32_t period_us = filter->analysis_us * 100 / NOTCHFILTER_CPU_PERCENT;
+	uint32_t window_us = NOTCHFILTER_WINDOW * filter->decimation * filter->dT * 1e6f;
+
+	filter->holdoff = 0;
+	if (period_us > window_us)
+		filter->holdoff = (period_us - window_us) / (filter->dT * 1e6f);
+
+	filter->analyze_axis = 0;
+	filter->analysis_us = 0;
+	filter->collected = 0;
+}
+
+/**
+ * Create or retune a set of notches that follow the strongest peak of
+ * each axis within a band.
+ * @param[in,out] filter_ptr filter to (re)initialize, allocated if NULL
+ * @param[in] min_freq lower end of the band searched, in Hz
+ * @param[in] max_freq upper end of the band searched, in Hz
+ * @param[in] q quality of the notches, the center frequency over the width
+ * @param[in] dT sample period, in seconds
+ * @param[in] width number of axes
+ */
+void notchfilter_create(notchfilter_state_t *filter_ptr, float min_freq, float max_freq, float q, float dT, uint8_t width)
+{
+	if (!filter_ptr || width > NOTCHFILTER_MAX_WIDTH)
+		PIOS_Assert(0);
+
+	if (!*filter_ptr) {
+		*filter_ptr = PIOS_malloc_no_dma(sizeof(struct notchfilter_state));
+		if (!*filter_ptr)
+			PIOS_Assert(0);
+	}
+
+	notchfilter_state_t filter = *filter_ptr;
+	memset(filter, 0, sizeof(struct notchfilter_state));
+
+	float rate = 1.0f / dT;
+
+	filter->width = width;
+	filter->dT = dT;
+	filter->q = MAX(q, 0.5f);
+	filter->max_freq = bound_min_max(max_freq, 1.0f, 0.4f * rate);
+	filter->min_freq = bound_min_max(min_freq, 1.0f, filter->max_freq);
+
+	// Keep the band well below the Nyquist frequency after decimation
+	filter->decimation = MAX((int)(rate / (2.5f * filter->max_freq)), 1);
+	filter->bin_freq = rate / filter->decimation / NOTCHFILTER_WINDOW;
+
+	// The bins either side of the band are looked at, and DC is left out
+	filter->min_bin = MAX((int)ceilf(filter->min_freq / filter->bin_freq), 2);
+	filter->max_bin = MIN((int)(filter->max_freq / filter->bin_freq), NOTCHFILTER_WINDOW / 2 - 1);
+	if (filter->max_bin < filter->min_bin)
+		filter->max_bin = filter->min_bin;
+
+	// Hann window
+	for (int i = 0; i < NOTCHFILTER_WINDOW; i++)
+		filter->window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / (NOTCHFILTER_WINDOW - 1));
+}
+
+/**
+ * Notch a sample of each axis, and look for the peaks to notch
+ * @param[in] filter filter created by notchfilter_create
+ * @param[in,out] sample sample of each axis, replaced by the filtered values
+ */
+void notchfilter_run(notchfilter_state_t filter, float *sample)
+{
+	if (!filter)
+		return;
+
+	if (filter->holdoff)
+		filter->holdoff--;
+	else if (filter->collected < NOTCHFILTER_WINDOW)
+		notchfilter_collect(filter, sample);
+	else
+		notchfilter_analyze(filter);
+
+	for (int i = 0; i < filter->width; i++) {
+		struct notchfilter_axis *ax = &filter->axis[i];
+
+		if (!ax->active)
+			continue;
+
+		float x = sample[i];
+		float y = ax->b0 * x + ax->s1;
+
+		ax->s1 = ax->b1 * (x - y) + ax->s2;
+		ax->s2 = ax->b0 * x - ax->a2 * y;
+		sample[i] = y;
+	}
+}
+
+/**
+ * Create or reset a bank of notches that follow the motors' rotation.
+ * All notches start out inactive.
+ * @param[in,out] filter_ptr filter to (re)initialize, allocated if NULL
+ * @param[in] motors number of motors that may be notched
+ * @param[in] min_freq lowest frequency notched, in Hz
+ * @param[in] q quality of the notches, the center frequency over the width
+ * @param[in] dT sample period, in seconds
+ */
+void rpmnotch_create(rpmnotch_state_t *filter_ptr, uint8_t motors, float min_freq, float q, float dT)
+{
+	if (!filter_ptr || motors > RPMNOTCH_MAX_MOTORS)
+		PIOS_Assert(0);
+
+	if (!*filter_ptr) {
+		*filter_ptr = PIOS_malloc_no_dma(sizeof(struct rpmnotch_state));
+		if (!*filter_ptr)
+			PIOS_Assert(0);
+	}
+
+	rpmnotch_state_t filter = *filter_ptr;
+	memset(filter, 0, sizeof(struct rpmnotch_state));
+
+	filter->motors = motors;
+	filter->dT = dT;
+	filter->q = MAX(q, 0.5f);
+	filter->max_freq = 0.4f / dT;
+	filter->min_freq = bound_min_max(min_freq, 1.0f, filter->max_freq);
+}
+
+/**
+ * Move the notch of a motor to its rotation frequency.  Outside of the
+ * range that can be notched, the motor's notch is switched off.
+ * @param[in] filter filter created by rpmnotch_create
+ * @param[in] motor index of the motor
+ * @param[in] freq rotation frequency, in Hz
+ */
+void rpmnotch_set_freq(rpmnotch_state_t filter, uint8_t motor, float freq)
+{
+	if (!filter || motor >= filter->motors)
+		return;
+
+	struct rpmnotch_motor *m = &filter->motor[motor];
+
+	if (freq < filter->min_freq || freq > filter->max_freq) {
+		m->active = false;
+		return;
+	}
+
+	// Coming back in, don't ring with what was left from last time
+	if (!m->active) {
+		memset(m->s1, 0, sizeof(m->s1));
+		memset(m->s2, 0, sizeof(m->s2));
+	}
+
+	notch_coeffs(freq, filter->dT, filter->q, &m->b0, &m->b1, &m->a2);
+	m->active = true;
+}
+
+/**
+ * Notch a sample of each of the three axes at every active motor frequency
+ * @param[in] filter filter created by rpmnotch_create
+ * @param[in,out] sample sample of each axis, replaced by the filtered values
+ */
+void rpmnotch_run(rpmnotch_state_t filter, float *sample)
+{
+	if (!filter)
+		return;
+
+	for (int j = 0; j < filter->motors; j++) {
+		struct rpmnotch_motor *m = &filter->motor[j];
+
+		if (!m->active)
+			continue;
+
+		for (int i = 0; i < RPMNOTCH_MAX_WIDTH; i++) {
+			float x = sample[i];
+			float y = m->b0 * x + m->s1[i];
+
+			m->s1[i] = m->b1 * (x - y) + m->s2[i];
+			m->s2[i] = m->b0 * x - m->a2 * y;
+			sample[i] = y;
+		}
+	}
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,44 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Filtering support libraries
+ * @{
+ *
+ * @file       notchfilter.h
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @brief      Notch filters that follow the strongest vibration peak or the motors
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef NOTCHFILTER_H
+#define NOTCHFILTER_H
+
+typedef struct notchfilter_state* notchfilter_state_t;
+
+void notchfilter_create(notchfilter_state_t *filter_ptr, float min_freq, float max_freq, float q, float dT, uint8_t width);
+void notchfilter_run(notchfilter_state_t filter, float *sample);
+
+typedef struct rpmnotch_state* rpmnotch_state_t;
+
+void rpmnotch_create(rpmnotch_state_t *filter_ptr, uint8_t motors, float min_freq, float q, float dT);
+void rpmnotch_set_freq(rpmnotch_state_t filter, uint8_t motor, float freq);
+void rpmnotch_run(rpmnotch_state_t filter, float *sample);
+
+#endif // NOTCHFILTER_H
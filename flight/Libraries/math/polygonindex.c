@@ -0,0 +1,320 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Filtering support libraries
+ * @{
+ *
+ * @file       polygonindex.c
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @brief      Grid index for point in polygon tests
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "polygonindex.h"
+
+#define NO_VERTEX 0xffff
+
+/**
+ * Clear out all polygons.
+ * @param[in] idx the index
+ */
+void polyindex_reset(struct polygon_index *idx)
+{
+	idx->num_vertices = 0;
+	idx->dim = 0;
+
+	for (int i = 0; i < POLYINDEX_MAX_POLYGONS; i++)
+		idx->first[i] = NO_VERTEX;
+}
+
+/**
+ * Append a vertex to a polygon.  The vertices of a polygon must be added
+ * one after the other; the polygon closes back to its first vertex.
+ * @param[in] idx the index
+ * @param[in] polygon polygon number, less than POLYINDEX_MAX_POLYGONS
+ * @param[in] x,y vertex position
+ * @returns false if the vertex can't be added
+ */
+bool polyindex_add_vertex(struct polygon_index *idx, uint8_t polygon,
+		float x, float y)
+{
+	uint16_t n = idx->num_vertices;
+
+	if (polygon >= POLYINDEX_MAX_POLYGONS || n >= POLYINDEX_MAX_VERTICES)
+		return false;
+
+	if (idx->first[polygon] == NO_VERTEX)
+		idx->first[polygon] = n;
+	else if (idx->polygon[n - 1] != polygon)
+		return false;
+
+	idx->vertices[n][0] = x;
+	idx->vertices[n][1] = y;
+	idx->polygon[n] = polygon;
+	idx->num_vertices++;
+
+	return true;
+}
+
+//! Vertex at the other end of the edge starting at vertex i
+static uint16_t edge_end(const struct polygon_index *idx, uint16_t i)
+{
+	if (i + 1 < idx->num_vertices && idx->polygon[i + 1] == idx->polygon[i])
+		return i + 1;
+
+	return idx->first[idx->polygon[i]];
+}
+
+//! Which side of the line through a and b point p is on
+static float side(const float *a, const float *b, const float *p)
+{
+	return (b[0] - a[0]) * (p[1] - a[1]) - (b[1] - a[1]) * (p[0] - a[0]);
+}
+
+static int cell_of(const struct polygon_index *idx, int axis, float v)
+{
+	int c = floorf((v - idx->origin[axis]) / idx->cell_len[axis]);
+
+	if (c < 0)
+		return 0;
+	if (c >= idx->dim)
+		return idx->dim - 1;
+
+	return c;
+}
+
+//! Conservatively, whether edge a-b passes through a cell
+static bool edge_in_cell(const struct polygon_index *idx, const float *a,
+		const float *b, int cx, int cy)
+{
+	// Grow the cell a little so rounding can't lose a grazing edge
+	float ex = idx->cell_len[0] * 0.001f, ey = idx->cell_len[1] * 0.001f;
+	float x0 = idx->origin[0] + cx * idx->cell_len[0] - ex;
+	float y0 = idx->origin[1] + cy * idx->cell_len[1] - ey;
+	float x1 = x0 + idx->cell_len[0] + 2 * ex;
+	float y1 = y0 + idx->cell_len[1] + 2 * ey;
+
+	const float corners[4][2] = {
+		{ x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 }
+	};
+
+	int pos = 0, neg = 0;
+
+	for (int i = 0; i < 4; i++) {
+		float s = side(a, b, corners[i]);
+
+		if (s >= 0)
+			pos++;
+		if (s <= 0)
+			neg++;
+	}
+
+	// Only if the line doesn't leave all corners on one side
+	return pos && neg;
+}
+
+/**
+ * Visits every edge/cell pair.  Counts them into cell_refs when counting,
+ * otherwise stores the edges using cell_refs as write cursors.
+ */
+static uint32_t walk_edges(struct polygon_index *idx, bool fill)
+{
+	uint32_t total = 0;
+
+	for (uint16_t i = 0; i < idx->num_vertices; i++) {
+		const float *a = idx->vertices[i];
+		const float *b = idx->vertices[edge_end(idx, i)];
+
+		int cx0 = cell_of(idx, 0, fminf(a[0], b[0]));
+		int cx1 = cell_of(idx, 0, fmaxf(a[0], b[0]));
+		int cy0 = cell_of(idx, 1, fminf(a[1], b[1]));
+		int cy1 = cell_of(idx, 1, fmaxf(a[1], b[1]));
+
+		for (int cy = cy0; cy <= cy1; cy++) {
+			for (int cx = cx0; cx <= cx1; cx++) {
+				if (!edge_in_cell(idx, a, b, cx, cy))
+					continue;
+
+				int c = cy * idx->dim + cx;
+
+				if (fill)
+					idx->refs[idx->cell_refs[c]++] = i;
+				else
+					idx->cell_refs[c + 1]++;
+
+				total++;
+			}
+		}
+	}
+
+	return total;
+}
+
+//! Full crossing number test, only used to classify the cell centres
+static uint16_t brute_query(const struct polygon_index *idx, const float *p)
+{
+	uint16_t mask = 0;
+
+	for (uint16_t i = 0; i < idx->num_vertices; i++) {
+		const float *a = idx->vertices[i];
+		const float *b = idx->vertices[edge_end(idx, i)];
+
+		if ((a[1] > p[1]) != (b[1] > p[1])) {
+			float x = a[0] + (p[1] - a[1]) * (b[0] - a[0]) / (b[1] - a[1]);
+
+			if (p[0] < x)
+				mask ^= 1 << idx->polygon[i];
+		}
+	}
+
+	return mask;
+}
+
+static void cell_centre(const struct polygon_index *idx, int cx, int cy,
+		float *p)
+{
+	p[0] = idx->origin[0] + (cx + 0.5f) * idx->cell_len[0];
+	p[1] = idx->origin[1] + (cy + 0.5f) * idx->cell_len[1];
+}
+
+/**
+ * Build the grid after all vertices are added.  Costs a pass over all
+ * edges per cell, so do it when the polygons change, not per query.
+ * @param[in] idx the index
+ */
+void polyindex_build(struct polygon_index *idx)
+{
+	uint16_t n = idx->num_vertices;
+
+	idx->dim = 0;
+
+	if (!n)
+		return;
+
+	float min[2] = { idx->vertices[0][0], idx->vertices[0][1] };
+	float max[2] = { min[0], min[1] };
+
+	for (uint16_t i = 1; i < n; i++) {
+		for (int axis = 0; axis < 2; axis++) {
+			min[axis] = fminf(min[axis], idx->vertices[i][axis]);
+			max[axis] = fmaxf(max[axis], idx->vertices[i][axis]);
+		}
+	}
+
+	// Leave a margin so nothing sits right on the grid boundary
+	for (int axis = 0; axis < 2; axis++) {
+		float margin = (max[axis] - min[axis]) / 64 + 1.0f;
+
+		idx->origin[axis] = min[axis] - margin;
+		max[axis] += margin;
+	}
+
+	// Long edges cross many cells; coarsen the grid until they all fit.
+	// With a single cell there's one reference per edge, which always does.
+	for (idx->dim = POLYINDEX_GRID_DIM; idx->dim > 1; idx->dim /= 2) {
+		for (int axis = 0; axis < 2; axis++)
+			idx->cell_len[axis] = (max[axis] - idx->origin[axis]) / idx->dim;
+
+		memset(idx->cell_refs, 0, sizeof(idx->cell_refs));
+
+		if (walk_edges(idx, false) <= POLYINDEX_MAX_REFS)
+			break;
+	}
+
+	if (idx->dim == 1) {
+		for (int axis = 0; axis < 2; axis++)
+			idx->cell_len[axis] = max[axis] - idx->origin[axis];
+
+		memset(idx->cell_refs, 0, sizeof(idx->cell_refs));
+		walk_edges(idx, false);
+	}
+
+	int cells = idx->dim * idx->dim;
+
+	for (int c = 0; c < cells; c++)
+		idx->cell_refs[c + 1] += idx->cell_refs[c];
+
+	walk_edges(idx, true);
+
+	// Filling advanced each cell's start to the next one's; shift back.
+	for (int c = cells; c > 0; c--)
+		idx->cell_refs[c] = idx->cell_refs[c - 1];
+	idx->cell_refs[0] = 0;
+
+	for (int cy = 0; cy < idx->dim; cy++) {
+		for (int cx = 0; cx < idx->dim; cx++) {
+			float p[2];
+
+			cell_centre(idx, cx, cy, p);
+			idx->cell_mask[cy * idx->dim + cx] = brute_query(idx, p);
+		}
+	}
+}
+
+/**
+ * Which polygons contain a point.  Starts from the cell centre and flips
+ * polygons for each of the cell's edges crossed on the way to the point.
+ * @param[in] idx the index
+ * @param[in] x,y the point
+ * @returns bit mask of polygons containing the point
+ */
+uint16_t polyindex_query(const struct polygon_index *idx, float x, float y)
+{
+	if (!idx->dim)
+		return 0;
+
+	float fx = (x - idx->origin[0]) / idx->cell_len[0];
+	float fy = (y - idx->origin[1]) / idx->cell_len[1];
+
+	// Off the grid is outside of everything
+	if (!(fx >= 0 && fx < idx->dim && fy >= 0 && fy < idx->dim))
+		return 0;
+
+	int cx = fx, cy = fy;
+	int c = cy * idx->dim + cx;
+
+	float p[2] = { x, y };
+	float centre[2];
+
+	cell_centre(idx, cx, cy, centre);
+
+	uint16_t mask = idx->cell_mask[c];
+
+	for (uint16_t r = idx->cell_refs[c]; r < idx->cell_refs[c + 1]; r++) {
+		uint16_t i = idx->refs[r];
+		const float *a = idx->vertices[i];
+		const float *b = idx->vertices[edge_end(idx, i)];
+
+		// Half open on both so a path through a vertex counts once
+		if (((side(centre, p, a) > 0) != (side(centre, p, b) > 0)) &&
+				((side(a, b, centre) > 0) != (side(a, b, p) > 0)))
+			mask ^= 1 << idx->polygon[i];
+	}
+
+	return mask;
+}
+
+/**
+ * @}
+ * @}
+ */
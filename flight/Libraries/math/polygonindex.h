@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Filtering support libraries
+ * @{
+ *
+ * @file       polygonindex.h
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @brief      Grid index for point in polygon tests
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef POLYGONINDEX_H
+#define POLYGONINDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//! Polygons are identified by a bit in a uint16_t mask
+#define POLYINDEX_MAX_POLYGONS		16
+#define POLYINDEX_MAX_VERTICES		256
+#define POLYINDEX_GRID_DIM			16
+//! Edge references over all cells; the grid coarsens until they fit
+#define POLYINDEX_MAX_REFS			512
+
+/**
+ * Set of polygons with a uniform grid over their bounding box.  Every
+ * cell knows which polygons contain its centre and which edges pass
+ * through it, so a point only needs testing against the few edges
+ * between it and its cell centre.
+ */
+struct polygon_index {
+	float vertices[POLYINDEX_MAX_VERTICES][2];
+	uint8_t polygon[POLYINDEX_MAX_VERTICES];
+	uint16_t num_vertices;
+	uint16_t first[POLYINDEX_MAX_POLYGONS];
+
+	float origin[2];
+	float cell_len[2];
+	uint8_t dim;
+
+	uint16_t cell_mask[POLYINDEX_GRID_DIM * POLYINDEX_GRID_DIM];
+	uint16_t cell_refs[POLYINDEX_GRID_DIM * POLYINDEX_GRID_DIM + 1];
+	uint16_t refs[POLYINDEX_MAX_REFS];
+};
+
+void polyindex_reset(struct polygon_index *idx);
+bool polyindex_add_vertex(struct polygon_index *idx, uint8_t polygon,
+		float x, float y);
+void polyindex_build(struct polygon_index *idx);
+uint16_t polyindex_query(const struct polygon_index *idx, float x, float y);
+
+#endif // POLYGONINDEX_H
@@ -0,0 +1,212 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Filtering support libraries
+ * @{
+ *
+ * @file       rlsident.c
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @brief      Recursive least squares identification of the rate response
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "rlsident.h"
+
+// Angular accelerations are in the 1e3-1e4 deg/s^2 range; keep the
+// regressors of similar magnitude so single precision P stays healthy.
+#define ACCEL_SCALE		1e-3f
+
+// Motor lag the instrument assumes; only needs to be in the right range
+#define INSTRUMENT_TAU	0.035f
+
+#define P_INITIAL		100.0f
+// Stop forgetting when the data isn't exciting enough to keep P bounded
+#define P_MAX			1e4f
+
+/**
+ * Set up the estimator.
+ * @param[in] id the estimator
+ * @param[in] dT sample period (s)
+ * @param[in] cutoff lowpass applied to gyro and command alike (Hz)
+ * @param[in] memory time constant of the exponential forgetting (s)
+ */
+void rlsident_init(struct rlsident *id, float dT, float cutoff, float memory)
+{
+	memset(id, 0, sizeof(*id));
+
+	id->dT = dT;
+	id->lpf_alpha = 1.0f - expf(-2.0f * (float)M_PI * cutoff * dT);
+	id->forget = 1.0f - dT / memory;
+	id->lag_alpha = 1.0f - expf(-dT / INSTRUMENT_TAU);
+
+	for (int axis = 0; axis < RLSIDENT_AXES; axis++) {
+		for (int i = 0; i < RLSIDENT_PARAMS; i++)
+			id->P[axis][i][i] = P_INITIAL;
+	}
+}
+
+/**
+ * Drop the signal history, e.g. after samples were lost.  The estimate
+ * is kept and refined from the next samples on.
+ * @param[in] id the estimator
+ */
+void rlsident_restart(struct rlsident *id)
+{
+	id->primed = 0;
+}
+
+/**
+ * One recursive instrumental variable step.  With z == phi this is plain
+ * RLS; with a noise free instrument the gyro noise in the regressor no
+ * longer biases the estimate.
+ */
+static void rls_step(float *theta, float (*P)[RLSIDENT_PARAMS],
+		const float *phi, const float *z, float y, float forget)
+{
+	float Pz[RLSIDENT_PARAMS], phiP[RLSIDENT_PARAMS];
+	float denom = forget;
+	float err = y;
+
+	for (int i = 0; i < RLSIDENT_PARAMS; i++) {
+		Pz[i] = 0;
+		phiP[i] = 0;
+
+		for (int j = 0; j < RLSIDENT_PARAMS; j++) {
+			Pz[i] += P[i][j] * z[j];
+			phiP[i] += phi[j] * P[j][i];
+		}
+
+		denom += phi[i] * Pz[i];
+		err -= theta[i] * phi[i];
+	}
+
+	float inv_denom = 1.0f / denom;
+	float trace = 0;
+
+	for (int i = 0; i < RLSIDENT_PARAMS; i++)
+		theta[i] += Pz[i] * inv_denom * err;
+
+	for (int i = 0; i < RLSIDENT_PARAMS; i++) {
+		for (int j = 0; j < RLSIDENT_PARAMS; j++)
+			P[i][j] -= Pz[i] * phiP[j] * inv_denom;
+
+		trace += P[i][i];
+	}
+
+	if (trace < P_MAX) {
+		float inv_forget = 1.0f / forget;
+
+		for (int i = 0; i < RLSIDENT_PARAMS; i++) {
+			for (int j = 0; j < RLSIDENT_PARAMS; j++)
+				P[i][j] *= inv_forget;
+		}
+	}
+}
+
+/**
+ * Add one control loop sample.
+ * @param[in] id the estimator
+ * @param[in] gyro rates of all axes (deg/s)
+ * @param[in] u actuator commands of all axes
+ */
+void rlsident_update(struct rlsident *id, const float *gyro, const float *u)
+{
+	if (!id->primed) {
+		for (int axis = 0; axis < RLSIDENT_AXES; axis++) {
+			id->gyro_filt[axis] = gyro[axis];
+			id->u_filt[axis] = u[axis];
+			id->accel[axis] = 0;
+			id->u_lag[axis] = u[axis];
+		}
+
+		id->primed = 1;
+		return;
+	}
+
+	const float k_accel = ACCEL_SCALE / id->dT;
+
+	for (int axis = 0; axis < RLSIDENT_AXES; axis++) {
+		float gyro_filt = id->gyro_filt[axis] +
+			id->lpf_alpha * (gyro[axis] - id->gyro_filt[axis]);
+		float accel = (gyro_filt - id->gyro_filt[axis]) * k_accel;
+
+		// Needs one acceleration before there's something to regress on
+		if (id->primed > 1) {
+			float *theta = id->theta[axis];
+			const float phi[RLSIDENT_PARAMS] = {
+				id->accel[axis], id->u_filt[axis], 1.0f
+			};
+
+			// Instrument for the acceleration: the command through a
+			// typical motor lag. Follows the acceleration closely but
+			// knows nothing of the gyro noise.
+			const float z[RLSIDENT_PARAMS] = {
+				id->u_lag[axis], phi[1], 1.0f
+			};
+
+			rls_step(theta, id->P[axis], phi, z, accel, id->forget);
+		}
+
+		id->gyro_filt[axis] = gyro_filt;
+		id->accel[axis] = accel;
+		id->u_lag[axis] += id->lag_alpha * (id->u_filt[axis] - id->u_lag[axis]);
+		id->u_filt[axis] += id->lpf_alpha * (u[axis] - id->u_filt[axis]);
+	}
+
+	if (id->primed > 1)
+		id->updates++;
+	else
+		id->primed = 2;
+}
+
+/**
+ * Current estimate for an axis.
+ * @param[in] id the estimator
+ * @param[in] axis axis number
+ * @param[out] tau motor time constant (s)
+ * @param[out] beta natural log of the rate gain ((deg/s^2) per unit command)
+ * @returns false if the estimate doesn't describe a stable, positive gain
+ * system (yet)
+ */
+bool rlsident_get(const struct rlsident *id, int axis, float *tau, float *beta)
+{
+	const float *theta = id->theta[axis];
+
+	// theta[0] is the per sample decay of the acceleration
+	if (!(theta[0] > 0.0f && theta[0] < 1.0f))
+		return false;
+
+	float gain = theta[1] / ACCEL_SCALE / (1.0f - theta[0]);
+	if (!(gain > 0.0f))
+		return false;
+
+	*tau = -id->dT / logf(theta[0]);
+	*beta = logf(gain);
+
+	return true;
+}
+
+/**
+ * @}
+ * @}
+ */
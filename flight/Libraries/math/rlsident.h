@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ * @addtogroup TauLabsMath Filtering support libraries
+ * @{
+ *
+ * @file       rlsident.h
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @brief      Recursive least squares identification of the rate response
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef RLSIDENT_H
+#define RLSIDENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RLSIDENT_AXES		3
+#define RLSIDENT_PARAMS		3
+
+/**
+ * Per axis model of the same form the autotune analysis fits:
+ * the rate accelerates at exp(beta) times a motor state that follows
+ * the actuator command with time constant tau.
+ *
+ * Regresses the next angular acceleration on the current one, the
+ * command and a constant; all axes are updated side by side.  A lagged
+ * copy of the command stands in as instrument for the measured
+ * acceleration, so the differentiated gyro noise doesn't drag tau down.
+ */
+struct rlsident {
+	float theta[RLSIDENT_AXES][RLSIDENT_PARAMS];
+	float P[RLSIDENT_AXES][RLSIDENT_PARAMS][RLSIDENT_PARAMS];
+
+	float gyro_filt[RLSIDENT_AXES];
+	float u_filt[RLSIDENT_AXES];
+	float accel[RLSIDENT_AXES];
+	float u_lag[RLSIDENT_AXES];
+
+	float dT;
+	float lpf_alpha;
+	float lag_alpha;
+	float forget;
+
+	uint8_t primed;
+	uint32_t updates;
+};
+
+void rlsident_init(struct rlsident *id, float dT, float cutoff, float memory);
+void rlsident_restart(struct rlsident *id);
+void rlsident_update(struct rlsident *id, const float *gyro, const float *u);
+bool rlsident_get(const struct rlsident *id, int axis, float *tau, float *beta);
+
+#endif // RLSIDENT_H
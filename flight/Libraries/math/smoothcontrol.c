@@ -83,6 +83,11 @@ void smoothcontrol_reinit(smoothcontrol_state state, uint8_t axis_num, float new
 void smoothcontrol_set_mode(smoothcontrol_state state, uint8_t axis_num, uint8_t mode)
 {
 	PIOS_Assert(state && axis_num <= 3);
+
+	// Settings updates pass the mode again; don't disturb the axis then
+	if (state->axis[axis_num].mode == mode)
+		return;
+
 	state->axis[axis_num].mode = mode;
 	smoothcontrol_reinit(state, axis_num, state->axis[axis_num].signal);
 }
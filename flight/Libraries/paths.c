@@ -40,86 +40,133 @@
 #include "pathdesired.h"
 
 // private functions
-static void path_endpoint(const float * start_point, const float * end_point,
+static void path_endpoint(const struct path_segment *seg,
                           const float * cur_point, struct path_status * status);
-static void path_vector(const float * start_point, const float * end_point,
+static void path_vector(const struct path_segment *seg,
                         const float * cur_point, struct path_status * status);
-static void path_circle(const float * center_point, float radius,
-                        const float * cur_point, struct path_status * status,
-                        bool clockwise);
-static void path_curve(const float * start_point, const float * end_point,
-                       float radius, const float * cur_point,
-                       struct path_status * status, bool clockwise);
+static void path_circle(const struct path_segment *seg,
+                        const float * cur_point, struct path_status * status);
+static void path_curve(const struct path_segment *seg,
+                       const float * cur_point, struct path_status * status);
+static void path_curve_center(struct path_segment *seg, float radius);
 
 /**
- * @brief Compute progress along path and deviation from it
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
+ * @brief Compute the geometry of a path segment that doesn't depend on the
+ * current location
+ * @param[in] pathDesired The path
+ * @param[out] seg The segment geometry, for @ref path_segment_progress
+ */
+void path_segment_init(const PathDesiredData *pathDesired,
+                       struct path_segment *seg)
+{
+	seg->mode = pathDesired->Mode;
+	seg->start[0] = pathDesired->Start[0];
+	seg->start[1] = pathDesired->Start[1];
+	seg->end[0] = pathDesired->End[0];
+	seg->end[1] = pathDesired->End[1];
+
+	seg->path[0] = seg->end[0] - seg->start[0];
+	seg->path[1] = seg->end[1] - seg->start[1];
+	seg->dist_path = sqrtf(seg->path[0] * seg->path[0] +
+	                       seg->path[1] * seg->path[1]);
+
+	seg->clockwise = false;
+	seg->radius = 0;
+
+	switch (seg->mode) {
+		case PATHDESIRED_MODE_CIRCLERIGHT:
+			seg->clockwise = true;
+			// fall through
+		case PATHDESIRED_MODE_CIRCLELEFT:
+			path_curve_center(seg, pathDesired->ModeParameters);
+			break;
+		case PATHDESIRED_MODE_CIRCLEPOSITIONRIGHT:
+			seg->clockwise = true;
+			// fall through
+		case PATHDESIRED_MODE_CIRCLEPOSITIONLEFT:
+			seg->radius = pathDesired->ModeParameters;
+			if (seg->radius < 0.10f) {
+				seg->radius = 0.10f;	// Never try a circle less than 10cm
+			}
+			seg->center[0] = seg->end[0];
+			seg->center[1] = seg->end[1];
+			break;
+		default:
+			break;
+	}
+}
+
+/**
+ * @brief Compute progress along a path segment and deviation from it
+ * @param[in] seg Segment geometry from @ref path_segment_init
  * @param[in] cur_point Current location
- * @param[in] mode Path following mode
  * @param[out] status Structure containing progress along path and deviation
  */
-void path_progress(const PathDesiredData *pathDesired,
-                   const float *cur_point,
-                   struct path_status *status)
+void path_segment_progress(const struct path_segment *seg,
+                           const float *cur_point,
+                           struct path_status *status)
 {
-	uint8_t mode = pathDesired->Mode;
-	float start_point[2] = {pathDesired->Start[0],pathDesired->Start[1]};
-	float end_point[2] = {pathDesired->End[0],pathDesired->End[1]};
-
-	switch(mode) {
+	switch(seg->mode) {
 		case PATHDESIRED_MODE_VECTOR:
-			return path_vector(start_point, end_point, cur_point, status);
+			return path_vector(seg, cur_point, status);
 			break;
 		case PATHDESIRED_MODE_CIRCLERIGHT:
-			return path_curve(start_point, end_point, pathDesired->ModeParameters, cur_point, status, 1);
-			break;
 		case PATHDESIRED_MODE_CIRCLELEFT:
-			return path_curve(start_point, end_point, pathDesired->ModeParameters, cur_point, status, 0);
+			return path_curve(seg, cur_point, status);
 			break;
 		case PATHDESIRED_MODE_CIRCLEPOSITIONLEFT:
-			return path_circle(end_point, pathDesired->ModeParameters, cur_point, status, 0);
-			break;
 		case PATHDESIRED_MODE_CIRCLEPOSITIONRIGHT:
-			return path_circle(end_point, pathDesired->ModeParameters, cur_point, status, 1);
+			return path_circle(seg, cur_point, status);
 			break;
 		case PATHDESIRED_MODE_ENDPOINT:
 		case PATHDESIRED_MODE_HOLDPOSITION:
 		default:
 			// use the endpoint as default failsafe if called in unknown modes
-			return path_endpoint(start_point, end_point, cur_point, status);
+			return path_endpoint(seg, cur_point, status);
 			break;
 	}
 }
 
+/**
+ * @brief Compute progress along path and deviation from it
+ * @param[in] pathDesired The path
+ * @param[in] cur_point Current location
+ * @param[out] status Structure containing progress along path and deviation
+ *
+ * Callers following the same path for a while should rather keep a
+ * @ref path_segment around and use @ref path_segment_progress.
+ */
+void path_progress(const PathDesiredData *pathDesired,
+                   const float *cur_point,
+                   struct path_status *status)
+{
+	struct path_segment seg;
+
+	path_segment_init(pathDesired, &seg);
+	path_segment_progress(&seg, cur_point, status);
+}
+
 /**
  * @brief Compute progress towards endpoint. Deviation equals distance
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
+ * @param[in] seg Segment geometry
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_endpoint(const float *start_point,
-                          const float *end_point,
+static void path_endpoint(const struct path_segment *seg,
                           const float *cur_point,
                           struct path_status *status)
 {
-	float path_north, path_east, diff_north, diff_east;
-	float dist_path, dist_diff;
+	float diff_north, diff_east;
+	float dist_diff;
 
 	// we do not correct in this mode
 	status->correction_direction[0] = status->correction_direction[1] = 0;
 
-	// Distance to go
-	path_north = end_point[0] - start_point[0];
-	path_east = end_point[1] - start_point[1];
-
 	// Current progress location relative to end
-	diff_north = end_point[0] - cur_point[0];
-	diff_east = end_point[1] - cur_point[1];
+	diff_north = seg->end[0] - cur_point[0];
+	diff_east = seg->end[1] - cur_point[1];
 
 	dist_diff = sqrtf( diff_north * diff_north + diff_east * diff_east );
-	dist_path = sqrtf( path_north * path_north + path_east * path_east );
 
 	if(dist_diff < 1e-6f ) {
 		status->fractional_progress = 1;
@@ -128,7 +175,7 @@ static void path_endpoint(const float *start_point,
 		return;
 	}
 
-	status->fractional_progress = 1 - dist_diff / (1 + dist_path);
+	status->fractional_progress = 1 - dist_diff / (1 + seg->dist_path);
 	status->error = dist_diff;
 
 	// Compute direction to travel
@@ -138,44 +185,37 @@ static void path_endpoint(const float *start_point,
 
 /**
  * @brief Compute progress along path and deviation from it
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
+ * @param[in] seg Segment geometry
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_vector(const float *start_point,
-                        const float *end_point,
+static void path_vector(const struct path_segment *seg,
                         const float *cur_point,
                         struct path_status *status)
 {
-	float path_north, path_east, diff_north, diff_east;
-	float dist_path;
+	float diff_north, diff_east;
+	float dist_path = seg->dist_path;
 	float dot;
 	float normal[2];
 
-	// Distance to go
-	path_north = end_point[0] - start_point[0];
-	path_east = end_point[1] - start_point[1];
-
-	// Current progress location relative to start
-	diff_north = cur_point[0] - start_point[0];
-	diff_east = cur_point[1] - start_point[1];
-
-	dot = path_north * diff_north + path_east * diff_east;
-	dist_path = sqrtf( path_north * path_north + path_east * path_east );
-
 	if(dist_path < 1e-6f) {
 		// if the path is too short, we cannot determine vector direction.
 		// Fly towards the endpoint to prevent flying away,
 		// but assume progress=1 either way.
-		path_endpoint( start_point, end_point, cur_point, status );
+		path_endpoint(seg, cur_point, status);
 		status->fractional_progress = 1;
 		return;
 	}
 
+	// Current progress location relative to start
+	diff_north = cur_point[0] - seg->start[0];
+	diff_east = cur_point[1] - seg->start[1];
+
+	dot = seg->path[0] * diff_north + seg->path[1] * diff_east;
+
 	// Compute the normal to the path
-	normal[0] = -path_east / dist_path;
-	normal[1] = path_north / dist_path;
+	normal[0] = -seg->path[1] / dist_path;
+	normal[1] = seg->path[0] / dist_path;
 
 	status->fractional_progress = dot / (dist_path * dist_path);
 	status->error = normal[0] * diff_north + normal[1] * diff_east;
@@ -188,35 +228,29 @@ static void path_vector(const float *start_point,
 	status->error = fabsf(status->error);
 
 	// Compute direction to travel
-	status->path_direction[0] = path_north / dist_path;
-	status->path_direction[1] = path_east / dist_path;
+	status->path_direction[0] = seg->path[0] / dist_path;
+	status->path_direction[1] = seg->path[1] / dist_path;
 
 }
 
 /**
  * @brief Circle location continuously
- * @param[in] start_point Starting point
- * @param[in] end_point Center point
+ * @param[in] seg Segment geometry, with the center and radius of the circle
  * @param[in] cur_point Current location
  * @param[out] status Structure containing progress along path and deviation
  */
-static void path_circle(const float * center_point,
-                        float radius,
+static void path_circle(const struct path_segment *seg,
                         const float * cur_point,
-                        struct path_status * status,
-                        bool clockwise)
+                        struct path_status * status)
 {
 	float diff_north, diff_east;
 	float cradius;
 	float normal[2];
-
-	if (radius < 0.10f) {
-		radius = 0.10f;		// Never try a circle less than 10cm
-	}
+	float radius = seg->radius;
 
 	// Current location relative to center
-	diff_north = cur_point[0] - center_point[0];
-	diff_east = cur_point[1] - center_point[1];
+	diff_north = cur_point[0] - seg->center[0];
+	diff_east = cur_point[1] - seg->center[1];
 
 	cradius = sqrtf(  diff_north * diff_north   +   diff_east * diff_east );
 
@@ -231,7 +265,7 @@ static void path_circle(const float * center_point,
 		return;
 	}
 
-	if (clockwise) {
+	if (seg->clockwise) {
 		// Compute the normal to the radius clockwise
 		normal[0] = -diff_east / cradius;
 		normal[1] = diff_north / cradius;
@@ -258,23 +292,17 @@ static void path_circle(const float * center_point,
 }
 
 /**
- * @brief Compute progress along circular path and deviation from it
- * @param[in] start_point Starting point
- * @param[in] end_point Ending point
- * @param[in] radius Radius of the curve segment
- * @param[in] cur_point Current location
- * @param[out] status Structure containing progress along path and deviation
+ * @brief Compute the center of the arc of a curve segment
+ * @param[in,out] seg Segment geometry, with the end points filled in
+ * @param[in] radius Radius of the curve segment, negative for the long way
  */
-static void path_curve(const float * start_point,
-                       const float * end_point,
-                       float radius,
-                       const float * cur_point,
-                       struct path_status *status,
-                       bool clockwise)
+static void path_curve_center(struct path_segment *seg, float radius)
 {
+	const float *start_point = seg->start;
+	const float *end_point = seg->end;
+
 	// OK for up to 10km
-	float min_radius = sqrtf(powf(start_point[0] - end_point[0], 2) +
-		powf(start_point[1] - end_point[1], 2)) / 2.0f + 0.01f;
+	float min_radius = seg->dist_path / 2.0f + 0.01f;
 
 	if (fabsf(radius) < min_radius) {
 		// This was possibly floating point confusion.
@@ -294,22 +322,17 @@ static void path_curve(const float * start_point,
 		}
 	}
 
-	float diff_north, diff_east;
-	float path_north, path_east;
-	float cradius;
-	float normal[2];
-
 	// Compute the center of the circle connecting the two points as the intersection of two circles
 	// around the two points from
 	// http://www.mathworks.com/matlabcentral/newsreader/view_thread/255121
-	float m_n, m_e, p_n, p_e, d, center[2];
+	float m_n, m_e, p_n, p_e, d;
 
 	// Center between start and end
 	m_n = (start_point[0] + end_point[0]) / 2;
 	m_e = (start_point[1] + end_point[1]) / 2;
 
 	// Normal vector the line between start and end.
-	if (clockwise) {
+	if (seg->clockwise) {
 		p_n = -(end_point[1] - start_point[1]);
 		p_e = (end_point[0] - start_point[0]);
 	} else {
@@ -321,19 +344,35 @@ static void path_curve(const float * start_point,
 	d = sqrtf(radius * radius / (p_n * p_n + p_e * p_e) - 0.25f);
 
 	float radius_sign = (radius > 0) ? 1 : -1;
-	float m_radius = fabsf(radius);
+	seg->radius = fabsf(radius);
 
 	if (fabsf(p_n) < 1e-3f && fabsf(p_e) < 1e-3f) {
-		center[0] = m_n;
-		center[1] = m_e;
+		seg->center[0] = m_n;
+		seg->center[1] = m_e;
 	} else {
-		center[0] = m_n + p_n * d * radius_sign;
-		center[1] = m_e + p_e * d * radius_sign;
+		seg->center[0] = m_n + p_n * d * radius_sign;
+		seg->center[1] = m_e + p_e * d * radius_sign;
 	}
+}
+
+/**
+ * @brief Compute progress along circular path and deviation from it
+ * @param[in] seg Segment geometry, with the center and radius of the arc
+ * @param[in] cur_point Current location
+ * @param[out] status Structure containing progress along path and deviation
+ */
+static void path_curve(const struct path_segment *seg,
+                       const float * cur_point,
+                       struct path_status *status)
+{
+	float diff_north, diff_east;
+	float cradius;
+	float normal[2];
+	float m_radius = seg->radius;
 
 	// Current location relative to center
-	diff_north = cur_point[0] - center[0];
-	diff_east = cur_point[1] - center[1];
+	diff_north = cur_point[0] - seg->center[0];
+	diff_east = cur_point[1] - seg->center[1];
 
 	// Compute current radius from the center
 	cradius = sqrtf(  diff_north * diff_north   +   diff_east * diff_east );
@@ -353,7 +392,7 @@ static void path_curve(const float * start_point,
 		return;
 	}
 
-	if (clockwise) {
+	if (seg->clockwise) {
 		// Compute the normal to the radius clockwise
 		normal[0] = -diff_east / cradius;
 		normal[1] = diff_north / cradius;
@@ -371,12 +410,10 @@ static void path_curve(const float * start_point,
 	status->path_direction[0] = normal[0];
 	status->path_direction[1] = normal[1];
 
-	path_north = end_point[0] - start_point[0];
-	path_east = end_point[1] - start_point[1];
-	diff_north = cur_point[0] - start_point[0];
-	diff_east = cur_point[1] - start_point[1];
-	float dist_path = sqrtf( path_north * path_north + path_east * path_east );
-	float dot = path_north * diff_north + path_east * diff_east;
+	diff_north = cur_point[0] - seg->start[0];
+	diff_east = cur_point[1] - seg->start[1];
+	float dist_path = seg->dist_path;
+	float dot = seg->path[0] * diff_north + seg->path[1] * diff_east;
 
 	status->fractional_progress = dot / (dist_path * dist_path);
 
@@ -61,14 +61,66 @@ static int32_t check_stabilization_rates();
 //! Check the system is safe for autonomous flight
 static int32_t check_safe_autonomous();
 
+//! Check the modes on the flight mode switch are usable
+static int32_t check_flight_modes();
+
+#define CHECK_MAX_DEPS 3
+
+/**
+ * The sub checks in order of precedence: the first error found is the
+ * one reported.  Each only reruns when an object it reads changed.  The
+ * flight mode check also depends on which modules are running, see
+ * configuration_check_modules().
+ */
+static const struct {
+	int32_t (*check)();
+	uint32_t deps[CHECK_MAX_DEPS];
+} checks[] = {
+	{ check_flight_modes, { MANUALCONTROLSETTINGS_OBJID,
+		SYSTEMSETTINGS_OBJID, STATEESTIMATION_OBJID } },
+	{ check_stabilization_rates, { STABILIZATIONSETTINGS_OBJID } },
+	{ check_safe_to_arm, { FLIGHTSTATUS_OBJID } },
+};
+
+#define NUM_CHECKS NELEMENTS(checks)
+
+//! Set from object callbacks; a single store, so no lock needed
+static volatile bool check_stale[NUM_CHECKS];
+static int32_t check_result[NUM_CHECKS];
+static bool checks_valid;
+
+/**
+ * Mark the checks that read an object as needing to run again.
+ * @param[in] obj_id the object that changed, or 0 for all checks
+ */
+void configuration_check_invalidate(uint32_t obj_id)
+{
+	for (int i = 0; i < NUM_CHECKS; i++) {
+		for (int j = 0; j < CHECK_MAX_DEPS; j++) {
+			if (!obj_id || checks[i].deps[j] == obj_id) {
+				check_stale[i] = true;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Rerun the flight mode check, which depends on which modules are
+ * running rather than on any one object.
+ */
+void configuration_check_modules()
+{
+	check_stale[0] = true;
+}
+
 /**
- * Run a preflight check over the hardware configuration
- * and currently active modules
+ * Run the preflight checks over the hardware configuration and currently
+ * active modules that are affected by changes since the last run, and
+ * update the configuration alarm.
  */
 int32_t configuration_check()
 {
-	SystemAlarmsConfigErrorOptions error_code = SYSTEMALARMS_CONFIGERROR_NONE;
-	
 	// For when modules are not running we should explicitly check the objects are
 	// valid
 	if (ManualControlSettingsHandle() == NULL ||
@@ -77,6 +129,44 @@ int32_t configuration_check()
 		return 0;
 	}
 
+	bool ran = false;
+
+	for (int i = 0; i < NUM_CHECKS; i++) {
+		if (check_stale[i] || !checks_valid) {
+			// Clear first so a change while checking isn't lost
+			check_stale[i] = false;
+			check_result[i] = checks[i].check();
+			ran = true;
+		}
+	}
+
+	checks_valid = true;
+
+	if (!ran) {
+		return 0;
+	}
+
+	SystemAlarmsConfigErrorOptions error_code = SYSTEMALARMS_CONFIGERROR_NONE;
+
+	for (int i = 0; i < NUM_CHECKS; i++) {
+		if (check_result[i] != SYSTEMALARMS_CONFIGERROR_NONE) {
+			error_code = check_result[i];
+			break;
+		}
+	}
+
+	set_config_error(error_code);
+
+	return 0;
+}
+
+/**
+ * Check each available flight mode position for a usable mode
+ */
+static int32_t check_flight_modes()
+{
+	SystemAlarmsConfigErrorOptions error_code = SYSTEMALARMS_CONFIGERROR_NONE;
+
 	// Classify airframe type
 	bool multirotor = true;
 	uint8_t airframe_type;
@@ -161,15 +251,7 @@ int32_t configuration_check()
 		}
 	}
 
-	// Check the stabilization rates are within what the sensors can track
-	error_code = (error_code == SYSTEMALARMS_CONFIGERROR_NONE) ? check_stabilization_rates() : error_code;
-
-	// Only check safe to arm if no other errors exist
-	error_code = (error_code == SYSTEMALARMS_CONFIGERROR_NONE) ? check_safe_to_arm() : error_code;
-
-	set_config_error(error_code);
-
-	return 0;
+	return error_code;
 }
 
 
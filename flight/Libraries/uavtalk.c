@@ -43,9 +43,10 @@
 // Private functions
 static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle objectId, uint16_t instId, uint8_t type);
 static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
-static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
+static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type, const void *data);
 static int32_t sendNack(UAVTalkConnectionData *connection, uint32_t objId);
-static int32_t receiveObject(UAVTalkConnectionData *connection);
+static int32_t receiveObject(UAVTalkConnectionData *connection, const uint8_t *data);
+static int32_t setupPayload(UAVTalkInputProcessor *iproc);
 static int32_t sendBuf(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_t len);
 
 /**
@@ -84,6 +85,28 @@ UAVTalkConnection UAVTalkInitialize(void *ctx, UAVTalkOutputCb outputStream,
 	return (UAVTalkConnection) connection;
 }
 
+/**
+ * Let object frames be built directly in the output (e.g. a COM port's
+ * transmit queue) rather than in txBuffer and then copied there.  Frames
+ * the output can't reserve room for still go through the output callback.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] reserveCallback Reserves room for a frame
+ * \param[in] commitCallback Sends a frame built in reserved room
+ */
+void UAVTalkSetDirectOutput(UAVTalkConnection connectionHandle,
+		UAVTalkReserveCb reserveCallback, UAVTalkCommitCb commitCallback)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return );
+
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	connection->reserveCb = reserveCallback;
+	connection->commitCb = commitCallback;
+
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+}
+
 /**
  * Get communication statistics counters since last call (reset afterwards)
  * \param[in] connection UAVTalkConnection to be used
@@ -146,6 +169,148 @@ int32_t UAVTalkSendObjectTimestamped(UAVTalkConnection connectionHandle, UAVObjH
 	return objectTransaction(connection, obj, instId, UAVTALK_TYPE_OBJ_TS);
 }
 
+/**
+ * Send an object instance from a copy of its data, e.g. the data passed to
+ * an event callback, instead of packing it from the object.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] data The instance data, or NULL to pack it from the object
+ * \param[in] timestamped True to add a timestamp, as for logging
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectData(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId,
+		const void *data, bool timestamped)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	if (instId == UAVOBJ_ALL_INSTANCES) {
+		return -1;
+	}
+
+	return sendSingleObject(connection, obj, instId,
+			timestamped ? UAVTALK_TYPE_OBJ_TS : UAVTALK_TYPE_OBJ, data);
+}
+
+/**
+ * Send only some fields of an object, as a partial object frame.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] obj Object to send
+ * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES)
+ * \param[in] fieldSizes Size of each field in packed order, from the
+ * object's generated FIELDSIZES
+ * \param[in] numFields Number of fields, at most 32
+ * \param[in] fieldMask Bit n set to send the nth field, from the generated
+ * FIELDBIT constants
+ * \param[in] timestamped True to add a timestamp, as for logging
+ * \param[in] data The instance data, e.g. as passed to an event callback, or
+ * NULL to pack it from the object
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkSendObjectPartial(UAVTalkConnection connectionHandle, UAVObjHandle obj, uint16_t instId,
+		const uint16_t *fieldSizes, uint8_t numFields, uint32_t fieldMask, bool timestamped,
+		const void *data)
+{
+	UAVTalkConnectionData *connection;
+	CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	if (!connection->outCb) return -1;
+
+	if (instId == UAVOBJ_ALL_INSTANCES || numFields > UAVTALK_PARTIAL_MAX_FIELDS) {
+		return -1;
+	}
+
+	int32_t objLength = UAVObjGetNumBytes(obj);
+	uint32_t objId = UAVObjGetID(obj);
+	int32_t dataOffset;
+
+	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	connection->txBuffer[0] = UAVTALK_SYNC_VAL;
+	connection->txBuffer[1] = timestamped ? UAVTALK_TYPE_OBJ_PARTIAL_TS : UAVTALK_TYPE_OBJ_PARTIAL;
+	connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
+	connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
+	connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
+	connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+
+	if (UAVObjIsSingleInstance(obj)) {
+		dataOffset = 8;
+	} else {
+		connection->txBuffer[8] = (uint8_t)(instId & 0xFF);
+		connection->txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
+		dataOffset = 10;
+	}
+
+	if (timestamped) {
+		uint32_t time = PIOS_Thread_Systime();
+		connection->txBuffer[dataOffset] = (uint8_t)(time & 0xFF);
+		connection->txBuffer[dataOffset + 1] = (uint8_t)((time >> 8) & 0xFF);
+		dataOffset += 2;
+	}
+
+	// Without the data, pack the whole object after the mask, then squeeze
+	// out the fields that are not sent
+	uint8_t *out = &connection->txBuffer[dataOffset + UAVTALK_PARTIAL_MASK_LENGTH];
+	const uint8_t *src = data ? data : out;
+
+	if ((dataOffset + UAVTALK_PARTIAL_MASK_LENGTH + objLength +
+				UAVTALK_CHECKSUM_LENGTH) > UAVTALK_MAX_PACKET_LENGTH ||
+			(!data && UAVObjPack(obj, instId, out) < 0)) {
+		PIOS_Recursive_Mutex_Unlock(connection->lock);
+		return -1;
+	}
+
+	int32_t offset = 0;
+	int32_t length = 0;
+
+	for (int i = 0; i < numFields; i++) {
+		if (offset + fieldSizes[i] > objLength) {
+			break;
+		}
+
+		if (fieldMask & (1u << i)) {
+			memmove(&out[length], &src[offset], fieldSizes[i]);
+			length += fieldSizes[i];
+		}
+
+		offset += fieldSizes[i];
+	}
+
+	if (offset != objLength) {
+		// The field table doesn't describe this object
+		PIOS_Recursive_Mutex_Unlock(connection->lock);
+		return -1;
+	}
+
+	fieldMask &= (numFields < 32) ? ((1u << numFields) - 1) : 0xFFFFFFFF;
+	connection->txBuffer[dataOffset] = (uint8_t)(fieldMask & 0xFF);
+	connection->txBuffer[dataOffset + 1] = (uint8_t)((fieldMask >> 8) & 0xFF);
+	connection->txBuffer[dataOffset + 2] = (uint8_t)((fieldMask >> 16) & 0xFF);
+	connection->txBuffer[dataOffset + 3] = (uint8_t)((fieldMask >> 24) & 0xFF);
+	dataOffset += UAVTALK_PARTIAL_MASK_LENGTH;
+
+	connection->txBuffer[2] = (uint8_t)((dataOffset+length) & 0xFF);
+	connection->txBuffer[3] = (uint8_t)(((dataOffset+length) >> 8) & 0xFF);
+
+	connection->txBuffer[dataOffset+length] = PIOS_CRC_updateCRC(0, connection->txBuffer, dataOffset+length);
+
+	uint16_t tx_msg_len = dataOffset+length+UAVTALK_CHECKSUM_LENGTH;
+	int32_t rc = (*connection->outCb)(connection->cbCtx, connection->txBuffer,
+			tx_msg_len);
+
+	if (rc == tx_msg_len) {
+		++connection->stats.txObjects;
+		connection->stats.txBytes += tx_msg_len;
+		connection->stats.txObjectBytes += length;
+	}
+
+	PIOS_Recursive_Mutex_Unlock(connection->lock);
+	return 0;
+}
+
 /**
  * Execute the requested transaction on an object.
  * \param[in] connection UAVTalkConnection to be used
@@ -170,6 +335,82 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle
 	}
 }
 
+/**
+ * Work out the object, instance and payload length of a frame from its
+ * header.  The type, size and object id must be parsed, and rxPacketLength
+ * must be the length of the header without the instance id.
+ * \param[in] iproc The input processor holding the parsed header
+ * \return 0 Success
+ * \return -1 The frame is malformed
+ */
+static int32_t setupPayload(UAVTalkInputProcessor *iproc)
+{
+	if (iproc->type == UAVTALK_TYPE_FILEREQ) {
+		/* Slightly overloaded from "normal" case.  Consume
+		 * 4 bytes of offset and 2 bytes of flags.
+		 */
+		iproc->obj = NULL;
+		iproc->instanceLength = 0;
+		iproc->length = 6;
+
+		if ((iproc->packet_size - iproc->rxPacketLength) !=
+				iproc->length) {
+			return -1;
+		}
+
+		return 0;
+	}
+
+	// Search for object.
+	iproc->obj = UAVObjGetByID(iproc->objId);
+
+	// Determine data length
+	if (iproc->type == UAVTALK_TYPE_OBJ_REQ || iproc->type == UAVTALK_TYPE_ACK || iproc->type == UAVTALK_TYPE_NACK) {
+		iproc->length = 0;
+		iproc->instanceLength = 0;
+
+		/* Length is always pretty much expected to be 0
+		 * here, but it can be 2 if it's a multiple inst
+		 * obj requested.  Don't peer into metadata to
+		 * figure this out-- use the packet length
+		 * [so we can properly NAK objects we don't know]
+		 */
+		if ((iproc->packet_size - iproc->rxPacketLength) == 2) {
+			iproc->instanceLength = 2;
+		} else if (iproc->length > 0) {
+			return -1;
+		}
+	} else if (iproc->type == UAVTALK_TYPE_OBJ_PARTIAL) {
+		/* Partial objects are framed so they can be relayed,
+		 * but the flight side has no field tables to apply
+		 * them with; receiveObject() drops them.
+		 */
+		iproc->instanceLength = (iproc->obj && !UAVObjIsSingleInstance(iproc->obj)) ? 2 : 0;
+		iproc->length = iproc->packet_size - iproc->rxPacketLength - iproc->instanceLength;
+	} else {
+		if (iproc->obj) {
+			iproc->length = UAVObjGetNumBytes(iproc->obj);
+			iproc->instanceLength = (UAVObjIsSingleInstance(iproc->obj) ? 0 : 2);
+		} else {
+			// We don't know if it's a multi-instance object, so just assume it's 0.
+			iproc->instanceLength = 0;
+			iproc->length = iproc->packet_size - iproc->rxPacketLength;
+		}
+	}
+
+	// Check length and determine next state
+	if (iproc->length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
+		return -1;
+	}
+
+	// Check the lengths match
+	if ((iproc->rxPacketLength + iproc->instanceLength + iproc->length) != iproc->packet_size) { // packet error - mismatched packet size
+		return -1;
+	}
+
+	return 0;
+}
+
 /**
  * Process an byte from the telemetry stream.
  * \param[in] connection UAVTalkConnection to be used
@@ -261,65 +502,7 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 		if (iproc->rxCount < 4)
 			break;
 
-		if (iproc->type == UAVTALK_TYPE_FILEREQ) {
-			/* Slightly overloaded from "normal" case.  Consume
-			 * 4 bytes of offset and 2 bytes of flags.
-			 */
-
-			iproc->instanceLength = 0;
-			iproc->rxCount = 0;
-			iproc->length = 6;
-
-			if ((iproc->packet_size - iproc->rxPacketLength) !=
-					iproc->length) {
-				iproc->state = UAVTALK_STATE_ERROR;
-				break;
-			}
-
-			iproc->state = UAVTALK_STATE_DATA;
-
-			break;
-		}
-
-		// Search for object.
-		iproc->obj = UAVObjGetByID(iproc->objId);
-
-		// Determine data length
-		if (iproc->type == UAVTALK_TYPE_OBJ_REQ || iproc->type == UAVTALK_TYPE_ACK || iproc->type == UAVTALK_TYPE_NACK) {
-			iproc->length = 0;
-			iproc->instanceLength = 0;
-
-			/* Length is always pretty much expected to be 0
-			 * here, but it can be 2 if it's a multiple inst
-			 * obj requested.  Don't peer into metadata to
-			 * figure this out-- use the packet length
-			 * [so we can properly NAK objects we don't know]
-			 */
-			if ((iproc->packet_size - iproc->rxPacketLength) == 2) {
-				iproc->instanceLength = 2;
-			} else if (iproc->length > 0) {
-				iproc->state = UAVTALK_STATE_ERROR;
-				break; 
-			}
-		} else {
-			if (iproc->obj) {
-				iproc->length = UAVObjGetNumBytes(iproc->obj);
-				iproc->instanceLength = (UAVObjIsSingleInstance(iproc->obj) ? 0 : 2);
-			} else {
-				// We don't know if it's a multi-instance object, so just assume it's 0.
-				iproc->instanceLength = 0;
-				iproc->length = iproc->packet_size - iproc->rxPacketLength;
-			}
-		}
-
-		// Check length and determine next state
-		if (iproc->length >= UAVTALK_MAX_PAYLOAD_LENGTH) {
-			iproc->state = UAVTALK_STATE_ERROR;
-			break;
-		}
-
-		// Check the lengths match
-		if ((iproc->rxPacketLength + iproc->instanceLength + iproc->length) != iproc->packet_size) { // packet error - mismatched packet size
+		if (setupPayload(iproc) < 0) {
 			iproc->state = UAVTALK_STATE_ERROR;
 			break;
 		}
@@ -405,10 +588,85 @@ UAVTalkRxState UAVTalkProcessInputStreamQuiet(UAVTalkConnection connectionHandle
 }
 
 /**
- * Process an byte from the telemetry stream.
+ * Parse and receive a frame that lies whole at the start of a block of
+ * received bytes.  The header is checked and the frame CRCed in one go, and
+ * the payload is unpacked straight from the block.
  * \param[in] connection UAVTalkConnection to be used
- * \param[in] rxbyte Received byte
- * \return UAVTalkRxState
+ * \param[in] buf Received bytes, starting at a sync byte
+ * \param[in] len Number of bytes in buf
+ * \return the length of the frame received, or 0 if buf doesn't start
+ * with a complete, valid frame
+ */
+static int32_t processFrame(UAVTalkConnectionData *connection,
+		const uint8_t *buf, int32_t len)
+{
+	UAVTalkInputProcessor *iproc = &connection->iproc;
+
+	if (len < (int32_t) (UAVTALK_MIN_HEADER_LENGTH + UAVTALK_CHECKSUM_LENGTH) ||
+			buf[0] != UAVTALK_SYNC_VAL ||
+			(buf[1] & UAVTALK_TYPE_MASK) != UAVTALK_TYPE_VER) {
+		return 0;
+	}
+
+	uint16_t packet_size = buf[2] | (buf[3] << 8);
+
+	if (packet_size < UAVTALK_MIN_HEADER_LENGTH ||
+			packet_size > UAVTALK_MAX_HEADER_LENGTH + UAVTALK_MAX_PAYLOAD_LENGTH ||
+			len < packet_size + UAVTALK_CHECKSUM_LENGTH) {
+		return 0;
+	}
+
+	uint8_t cs = PIOS_CRC_updateCRC(0, buf, packet_size);
+
+	if (cs != buf[packet_size]) {
+		return 0;
+	}
+
+	iproc->type = buf[1];
+	iproc->packet_size = packet_size;
+	iproc->objId = buf[4] | (buf[5] << 8) | (buf[6] << 16) |
+		((uint32_t) buf[7] << 24);
+	iproc->rxPacketLength = UAVTALK_MIN_HEADER_LENGTH;
+
+	if (setupPayload(iproc) < 0) {
+		return 0;
+	}
+
+	iproc->instId = 0;
+
+	if (iproc->instanceLength) {
+		// The byte parser doesn't take an instance id on a NACK either
+		if (iproc->type == UAVTALK_TYPE_NACK) {
+			return 0;
+		}
+
+		iproc->instId = buf[8] | (buf[9] << 8);
+	}
+
+	iproc->cs = cs;
+	iproc->rxPacketLength = packet_size + UAVTALK_CHECKSUM_LENGTH;
+
+	connection->stats.rxBytes += iproc->rxPacketLength;
+	connection->stats.rxObjectBytes += iproc->length;
+	connection->stats.rxObjects++;
+
+	receiveObject(connection, buf + UAVTALK_MIN_HEADER_LENGTH +
+			iproc->instanceLength);
+
+	/* The payload isn't in rxBuffer, so this frame can't be relayed or
+	 * received again */
+	iproc->state = UAVTALK_STATE_SYNC;
+
+	return iproc->rxPacketLength;
+}
+
+/**
+ * Process a block of bytes from the telemetry stream.  Frames that arrive
+ * whole within the block are parsed in place; anything else (frames split
+ * across blocks, garbage) goes through the byte-wise parser.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] rxbytes Received bytes
+ * \param[in] numbytes Number of bytes received
  */
 void UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t *rxbytes,
 		int numbytes)
@@ -417,14 +675,36 @@ void UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t *rxby
 
 	CHECKCONHANDLE(connectionHandle,connection,return);
 
-	for (int i = 0; i < numbytes; i++) {
+	UAVTalkInputProcessor *iproc = &connection->iproc;
+
+	int i = 0;
+
+	while (i < numbytes) {
+		if (iproc->state == UAVTALK_STATE_ERROR) {
+			connection->stats.rxErrors++;
+			iproc->state = UAVTALK_STATE_SYNC;
+		}
+
+		if (iproc->state == UAVTALK_STATE_SYNC ||
+				iproc->state == UAVTALK_STATE_COMPLETE) {
+			int32_t frame_len = processFrame(connection,
+					rxbytes + i, numbytes - i);
+
+			if (frame_len > 0) {
+				i += frame_len;
+				continue;
+			}
+		}
+
 		UAVTalkRxState state =
 			UAVTalkProcessInputStreamQuiet(connectionHandle,
 					rxbytes[i]);
 
 		if (state == UAVTALK_STATE_COMPLETE) {
-			receiveObject(connection);
+			receiveObject(connection, connection->rxBuffer);
 		}
+
+		i++;
 	}
 }
 
@@ -533,7 +813,7 @@ int32_t UAVTalkReceiveObject(UAVTalkConnection connectionHandle)
 		return -1;
 	}
 
-	return receiveObject(connection);
+	return receiveObject(connection, connection->rxBuffer);
 }
 
 /**
@@ -655,13 +935,15 @@ static int32_t sendBuf(UAVTalkConnection connectionHandle, uint8_t *buf, uint16_
 /**
  * Handles a request for file data.
  * \param[in] connection The connection on which a request was just received.
+ * \param[in] data The request payload
  */
-static void handleFileReq(UAVTalkConnectionData *connection)
+static void handleFileReq(UAVTalkConnectionData *connection,
+		const uint8_t *data)
 {
 	UAVTalkInputProcessor *iproc = &connection->iproc;
 	uint32_t file_id = iproc->objId;
 
-	struct filereq_data *req = (struct filereq_data *) connection->rxBuffer;
+	const struct filereq_data *req = (const struct filereq_data *) data;
 
 	/* printf("Got filereq for file_id=%08x offs=%d\n", file_id, req->offset); */
 
@@ -687,6 +969,14 @@ static void handleFileReq(UAVTalkConnectionData *connection)
 
 	uint32_t file_offset = req->offset;
 
+	int window = req->flags & UAVTALK_FILEREQ_WINDOW_MASK;
+
+	if (window == 0) {
+		window = UAVTALK_FILEREQ_DEFAULT_WINDOW;
+	} else if (window > UAVTALK_FILEREQ_MAX_WINDOW) {
+		window = UAVTALK_FILEREQ_MAX_WINDOW;
+	}
+
 	for (int i = 0; ; i++) {
 		resp->offset = file_offset;
 		resp->flags = 0;
@@ -706,7 +996,7 @@ static void handleFileReq(UAVTalkConnectionData *connection)
 
 			file_offset += cb_numbytes;
 
-			if (i == 5) {	/* 6 messages per chunk */
+			if (i == window - 1) {
 				resp->flags = UAVTALK_FILEDATA_LAST;
 			} else {
 				resp->flags = 0;
@@ -747,12 +1037,11 @@ static void handleFileReq(UAVTalkConnectionData *connection)
  * \param[in] type Type of received message (UAVTALK_TYPE_OBJ, UAVTALK_TYPE_OBJ_REQ, UAVTALK_TYPE_OBJ_ACK, UAVTALK_TYPE_ACK, UAVTALK_TYPE_NACK)
  * \param[in] objId ID of the object to work on
  * \param[in] instId The instance ID of UAVOBJ_ALL_INSTANCES for all instances.
- * \param[in] data Data buffer
- * \param[in] length Buffer length
+ * \param[in] data The received payload
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t receiveObject(UAVTalkConnectionData *connection)
+static int32_t receiveObject(UAVTalkConnectionData *connection, const uint8_t *data)
 {
 	int32_t ret = 0;
 
@@ -783,7 +1072,7 @@ static int32_t receiveObject(UAVTalkConnectionData *connection)
 
 	/* File request data is a special case. */
 	if (type == UAVTALK_TYPE_FILEREQ) {
-		handleFileReq(connection);
+		handleFileReq(connection, data);
 
 		return 0;
 	}
@@ -796,7 +1085,7 @@ static int32_t receiveObject(UAVTalkConnectionData *connection)
 		// All instances, not allowed for OBJ messages
 		if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
 			// Unpack object, if the instance does not exist it will be created!
-			UAVObjUnpack(obj, instId, connection->rxBuffer);
+			UAVObjUnpack(obj, instId, data);
 		} else {
 			ret = -1;
 		}
@@ -805,7 +1094,7 @@ static int32_t receiveObject(UAVTalkConnectionData *connection)
 		// All instances, not allowed for OBJ_ACK messages
 		if (obj && (instId != UAVOBJ_ALL_INSTANCES)) {
 			// Unpack object, if the instance does not exist it will be created!
-			if (UAVObjUnpack(obj, instId, connection->rxBuffer) == 0) {
+			if (UAVObjUnpack(obj, instId, data) == 0) {
 				// Transmit ACK
 				sendObject(connection, obj, instId, UAVTALK_TYPE_ACK);
 			} else {
@@ -864,17 +1153,17 @@ static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, u
 			numInst = UAVObjGetNumInstances(obj);
 			// Send all instances
 			for (n = 0; n < numInst; ++n) {
-				sendSingleObject(connection, obj, n, type);
+				sendSingleObject(connection, obj, n, type, NULL);
 			}
 			return 0;
 		} else {
-			return sendSingleObject(connection, obj, instId, type);
+			return sendSingleObject(connection, obj, instId, type, NULL);
 		}
 	} else if (type == UAVTALK_TYPE_OBJ_REQ) {
-		return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_OBJ_REQ);
+		return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_OBJ_REQ, NULL);
 	} else if (type == UAVTALK_TYPE_ACK) {
 		if (instId != UAVOBJ_ALL_INSTANCES) {
-			return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_ACK);
+			return sendSingleObject(connection, obj, instId, UAVTALK_TYPE_ACK, NULL);
 		} else {
 			return -1;
 		}
@@ -889,10 +1178,11 @@ static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, u
  * \param[in] obj Object handle to send
  * \param[in] instId The instance ID (can NOT be UAVOBJ_ALL_INSTANCES, use sendObject() instead)
  * \param[in] type Transaction type
+ * \param[in] data The instance data, or NULL to pack it from the object
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type)
+static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type, const void *data)
 {
 	int32_t length;
 	int32_t dataOffset;
@@ -915,51 +1205,80 @@ static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle
 	// Setup type and object id fields
 	objId = UAVObjGetID(obj);
 
+	dataOffset = UAVObjIsSingleInstance(obj) ? 8 : 10;
+
+	if (type & UAVTALK_TIMESTAMPED) {
+		dataOffset += 2;
+	}
+
+	uint16_t tx_msg_len = dataOffset+length+UAVTALK_CHECKSUM_LENGTH;
+
 	PIOS_Recursive_Mutex_Lock(connection->lock, PIOS_MUTEX_TIMEOUT_MAX);
 
-	connection->txBuffer[0] = UAVTALK_SYNC_VAL;  // sync byte
-	connection->txBuffer[1] = type;
-	// data length inserted here below
-	connection->txBuffer[4] = (uint8_t)(objId & 0xFF);
-	connection->txBuffer[5] = (uint8_t)((objId >> 8) & 0xFF);
-	connection->txBuffer[6] = (uint8_t)((objId >> 16) & 0xFF);
-	connection->txBuffer[7] = (uint8_t)((objId >> 24) & 0xFF);
+	/* Build the frame in place in the output when it has room,
+	 * otherwise in txBuffer to be copied out */
+	uint8_t *buf = NULL;
+
+	if (connection->reserveCb) {
+		buf = connection->reserveCb(connection->cbCtx, tx_msg_len);
+	}
+
+	bool direct = (buf != NULL);
+
+	if (!direct) {
+		buf = connection->txBuffer;
+	}
+
+	buf[0] = UAVTALK_SYNC_VAL;  // sync byte
+	buf[1] = type;
+	// Store the packet length
+	buf[2] = (uint8_t)((dataOffset+length) & 0xFF);
+	buf[3] = (uint8_t)(((dataOffset+length) >> 8) & 0xFF);
+	buf[4] = (uint8_t)(objId & 0xFF);
+	buf[5] = (uint8_t)((objId >> 8) & 0xFF);
+	buf[6] = (uint8_t)((objId >> 16) & 0xFF);
+	buf[7] = (uint8_t)((objId >> 24) & 0xFF);
+
+	int32_t offset = 8;
 
 	// Setup instance ID if one is required
-	if (UAVObjIsSingleInstance(obj)) {
-		dataOffset = 8;
-	} else {
-		connection->txBuffer[8] = (uint8_t)(instId & 0xFF);
-		connection->txBuffer[9] = (uint8_t)((instId >> 8) & 0xFF);
-		dataOffset = 10;
+	if (!UAVObjIsSingleInstance(obj)) {
+		buf[8] = (uint8_t)(instId & 0xFF);
+		buf[9] = (uint8_t)((instId >> 8) & 0xFF);
+		offset = 10;
 	}
 
 	// Add timestamp when the transaction type is appropriate
 	if (type & UAVTALK_TIMESTAMPED) {
 		uint32_t time = PIOS_Thread_Systime();
-		connection->txBuffer[dataOffset] = (uint8_t)(time & 0xFF);
-		connection->txBuffer[dataOffset + 1] = (uint8_t)((time >> 8) & 0xFF);
-		dataOffset += 2;
+		buf[offset] = (uint8_t)(time & 0xFF);
+		buf[offset + 1] = (uint8_t)((time >> 8) & 0xFF);
 	}
 
 	// Copy data (if any)
-	if (length > 0) {
-		if (UAVObjPack(obj, instId, &connection->txBuffer[dataOffset]) < 0) {
+	if (length > 0 && data) {
+		memcpy(&buf[dataOffset], data, length);
+	} else if (length > 0) {
+		if (UAVObjPack(obj, instId, &buf[dataOffset]) < 0) {
+			if (direct) {
+				connection->commitCb(connection->cbCtx, 0);
+			}
+
 			PIOS_Recursive_Mutex_Unlock(connection->lock);
 			return -1;
 		}
 	}
 
-	// Store the packet length
-	connection->txBuffer[2] = (uint8_t)((dataOffset+length) & 0xFF);
-	connection->txBuffer[3] = (uint8_t)(((dataOffset+length) >> 8) & 0xFF);
-
 	// Calculate checksum
-	connection->txBuffer[dataOffset+length] = PIOS_CRC_updateCRC(0, connection->txBuffer, dataOffset+length);
+	buf[dataOffset+length] = PIOS_CRC_updateCRC(0, buf, dataOffset+length);
 
-	uint16_t tx_msg_len = dataOffset+length+UAVTALK_CHECKSUM_LENGTH;
-	int32_t rc = (*connection->outCb)(connection->cbCtx, connection->txBuffer,
-			tx_msg_len);
+	int32_t rc;
+
+	if (direct) {
+		rc = connection->commitCb(connection->cbCtx, tx_msg_len);
+	} else {
+		rc = (*connection->outCb)(connection->cbCtx, buf, tx_msg_len);
+	}
 
 	if (rc == tx_msg_len) {
 		// Update stats
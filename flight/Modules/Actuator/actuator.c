@@ -49,9 +49,11 @@
 #include "mixersettings.h"
 #include "cameradesired.h"
 #include "manualcontrolcommand.h"
+#include "motorrpm.h"
 #include "pios_thread.h"
 #include "pios_queue.h"
 #include "misc_math.h"
+#include "loopmonitor.h"
 
 // Private constants
 #define MAX_QUEUE_SIZE 2
@@ -71,6 +73,7 @@
 
 DONT_BUILD_IF(ACTUATORSETTINGS_TIMERUPDATEFREQ_NUMELEM > PIOS_SERVO_MAX_BANKS, TooManyServoBanks);
 DONT_BUILD_IF(MAX_MIX_ACTUATORS > ACTUATORCOMMAND_CHANNEL_NUMELEM, TooManyMixers);
+DONT_BUILD_IF(MAX_MIX_ACTUATORS > MOTORRPM_RPM_NUMELEM, TooManyMotorRpms);
 DONT_BUILD_IF((MIXERSETTINGS_MIXER1VECTOR_NUMELEM - MIXERSETTINGS_MIXER1VECTOR_ACCESSORY0) < MANUALCONTROLCOMMAND_ACCESSORY_NUMELEM, AccessoryMismatch);
 
 #define MIXER_SCALE 128
@@ -98,6 +101,16 @@ static float motor_mixer[MAX_MIX_ACTUATORS * MIXERSETTINGS_MIXER1VECTOR_NUMELEM]
 
 /* These are various settings objects used throughout the actuator code */
 static ActuatorSettingsData actuatorSettings;
+
+/* Scaling of each channel from -1/+1 to its pulse width, worked out from
+ * ActuatorSettings when it changes rather than for every output.
+ */
+static struct channel_scale {
+	float neutral;
+	float pos_gain, neg_gain;
+	float lo, hi;
+} channel_scale[MAX_MIX_ACTUATORS];
+
 static SystemSettingsAirframeTypeOptions airframe_type;
 
 static float curve1[MIXERSETTINGS_THROTTLECURVE1_NUMELEM];
@@ -108,8 +121,10 @@ static MixerSettingsCurve2SourceOptions curve2_src;
 // Private functions
 static void actuator_task(void* parameters);
 
+static void compute_channel_scale();
 static float scale_channel(float value, int idx);
 static void set_failsafe();
+static void update_motor_rpm();
 
 static float throt_curve(const float input, const float *curve,
 		uint8_t num_points);
@@ -165,6 +180,10 @@ int32_t ActuatorInitialize()
 		return -1;
 	}
 
+	if (MotorRpmInitialize() == -1) {
+		return -1;
+	}
+
 #if defined(MIXERSTATUS_DIAGNOSTICS)
 	// UAVO only used for inspecting the internal status of the mixer during debug
 	if (MixerStatusInitialize()  == -1) {
@@ -312,7 +331,8 @@ static void fill_desired_vector(
 }
 
 static void post_process_scale_and_commit(float *motor_vect, float dT,
-		bool armed, bool spin_while_armed, bool stabilize_now)
+		bool armed, bool spin_while_armed, bool stabilize_now,
+		uint32_t mix_start)
 {
 	float min_chan = INFINITY;
 	float max_chan = -INFINITY;
@@ -439,28 +459,46 @@ static void post_process_scale_and_commit(float *motor_vect, float dT,
 		command.Channel[ct] = scale_channel(motor_vect[ct], ct);
 	}
 
-	// Store update time
-	command.UpdateTime = 1000.0f*dT;
+	bool read_only = ActuatorCommandReadOnly();
 
-	ActuatorCommandMaxUpdateTimeGet(&command.MaxUpdateTime);
-
-	if (command.UpdateTime > command.MaxUpdateTime)
-		command.MaxUpdateTime = 1000.0f*dT;
-
-	// Update output object
-	if (!ActuatorCommandReadOnly()) {
-		ActuatorCommandSet(&command);
-	} else {
+	if (read_only) {
 		// it's read only during servo configuration--
 		// so GCS takes precedence.
 		ActuatorCommandGet(&command);
 	}
 
+	LoopMonitorEnd(LOOPMONITOR_MIXER, mix_start);
+
+	/* Drive the outputs before publishing anything.  Setting the
+	 * object runs its callbacks (e.g. logging) in this task, which
+	 * would otherwise sit between the gyro sample and the motors.
+	 */
+	uint32_t output_start = LoopMonitorStart();
+
 	for (int n = 0; n < MAX_MIX_ACTUATORS; ++n) {
 		PIOS_Servo_Set(n, command.Channel[n]);
 	}
 
 	PIOS_Servo_Update();
+
+	LoopMonitorEnd(LOOPMONITOR_OUTPUT, output_start);
+	LoopMonitorEndFromSample(LOOPMONITOR_LATENCY);
+
+	update_motor_rpm();
+
+	if (read_only)
+		return;
+
+	// Store update time
+	command.UpdateTime = 1000.0f*dT;
+
+	ActuatorCommandMaxUpdateTimeGet(&command.MaxUpdateTime);
+
+	if (command.UpdateTime > command.MaxUpdateTime)
+		command.MaxUpdateTime = 1000.0f*dT;
+
+	// Update output object
+	ActuatorCommandSet(&command);
 }
 
 static void normalize_input_data(uint32_t this_systime,
@@ -556,7 +594,10 @@ static void actuator_task(void* parameters)
 	// Ensure the initial state of actuators is safe.
 	actuator_settings_updated = false;
 	ActuatorSettingsGet(&actuatorSettings);
+	compute_channel_scale();
 
+	PIOS_Servo_SetBidirectional(actuatorSettings.BidirectionalDShot ==
+			ACTUATORSETTINGS_BIDIRECTIONALDSHOT_TRUE);
 	PIOS_Servo_SetMode(actuatorSettings.TimerUpdateFreq,
 			ACTUATORSETTINGS_TIMERUPDATEFREQ_NUMELEM,
 			actuatorSettings.ChannelMax,
@@ -575,12 +616,28 @@ static void actuator_task(void* parameters)
 		 */
 		if (actuator_settings_updated) {
 			actuator_settings_updated = false;
-			ActuatorSettingsGet(&actuatorSettings);
 
-			PIOS_Servo_SetMode(actuatorSettings.TimerUpdateFreq,
-					ACTUATORSETTINGS_TIMERUPDATEFREQ_NUMELEM,
-					actuatorSettings.ChannelMax,
-					actuatorSettings.ChannelMin);
+			uint32_t changed = ActuatorSettingsGetChanges(&actuatorSettings);
+
+			if (changed & (ACTUATORSETTINGS_CHANNELMAX_FIELDBIT |
+						ACTUATORSETTINGS_CHANNELMIN_FIELDBIT |
+						ACTUATORSETTINGS_CHANNELNEUTRAL_FIELDBIT)) {
+				compute_channel_scale();
+			}
+
+			// Reprogramming the timers glitches the outputs; only
+			// when the output configuration itself changed
+			if (changed & (ACTUATORSETTINGS_TIMERUPDATEFREQ_FIELDBIT |
+						ACTUATORSETTINGS_CHANNELMAX_FIELDBIT |
+						ACTUATORSETTINGS_CHANNELMIN_FIELDBIT |
+						ACTUATORSETTINGS_BIDIRECTIONALDSHOT_FIELDBIT)) {
+				PIOS_Servo_SetBidirectional(actuatorSettings.BidirectionalDShot ==
+						ACTUATORSETTINGS_BIDIRECTIONALDSHOT_TRUE);
+				PIOS_Servo_SetMode(actuatorSettings.TimerUpdateFreq,
+						ACTUATORSETTINGS_TIMERUPDATEFREQ_NUMELEM,
+						actuatorSettings.ChannelMax,
+						actuatorSettings.ChannelMin);
+			}
 		}
 
 		if (mixer_settings_updated) {
@@ -660,6 +717,14 @@ static void actuator_task(void* parameters)
 
 		bool armed, spin_while_armed, stabilize_now;
 
+		/* Wait out the last update and ready the outputs now, rather
+		 * than between mixing and triggering them.
+		 */
+		if (actuatorSettings.DShotSync == ACTUATORSETTINGS_DSHOTSYNC_TRUE)
+			PIOS_Servo_PrepareUpdate();
+
+		uint32_t mix_start = LoopMonitorStart();
+
 		/* Receive manual control and desired UAV objects.  Perform
 		 * arming / hangtime checks; form a vector with desired
 		 * axis actions.
@@ -680,7 +745,7 @@ static void actuator_task(void* parameters)
 		 * Program the actual values to the timer subsystem.
 		 */
 		post_process_scale_and_commit(motor_vect, dT, armed,
-				spin_while_armed, stabilize_now);
+				spin_while_armed, stabilize_now, mix_start);
 
 		/* If we got this far, everything is OK. */
 		AlarmsClear(SYSTEMALARMS_ALARM_ACTUATOR);
@@ -719,32 +784,35 @@ static float collective_curve(float const input, float const * curve, uint8_t nu
 	return linear_interpolate(input, curve, num_points, -1.0f, 1.0f);
 }
 
+/**
+ * Work out the scaling of each channel from the actuator settings.  Max may
+ * be below min for reversed channels, so the bounds are sorted here.
+ */
+static void compute_channel_scale()
+{
+	for (int idx = 0; idx < MAX_MIX_ACTUATORS; idx++) {
+		float max = actuatorSettings.ChannelMax[idx];
+		float min = actuatorSettings.ChannelMin[idx];
+		float neutral = actuatorSettings.ChannelNeutral[idx];
+
+		channel_scale[idx].neutral = neutral;
+		channel_scale[idx].pos_gain = max - neutral;
+		channel_scale[idx].neg_gain = neutral - min;
+		channel_scale[idx].lo = fminf(min, max);
+		channel_scale[idx].hi = fmaxf(min, max);
+	}
+}
+
 /**
  * Convert channel from -1/+1 to servo pulse duration in microseconds
  */
 static float scale_channel(float value, int idx)
 {
-	float max = actuatorSettings.ChannelMax[idx];
-	float min = actuatorSettings.ChannelMin[idx];
-	float neutral = actuatorSettings.ChannelNeutral[idx];
-
-	float valueScaled;
-	// Scale
-	if (value >= 0.0f) {
-		valueScaled = value*(max-neutral) + neutral;
-	} else {
-		valueScaled = value*(neutral-min) + neutral;
-	}
+	const struct channel_scale *s = &channel_scale[idx];
 
-	if (max>min) {
-		if (valueScaled > max) valueScaled = max;
-		if (valueScaled < min) valueScaled = min;
-	} else {
-		if (valueScaled < max) valueScaled = max;
-		if (valueScaled > min) valueScaled = min;
-	}
+	float gain = (value >= 0.0f) ? s->pos_gain : s->neg_gain;
 
-	return valueScaled;
+	return bound_min_max(value * gain + s->neutral, s->lo, s->hi);
 }
 
 static float channel_failsafe_value(int idx)
@@ -788,6 +856,33 @@ static void set_failsafe()
 	ActuatorCommandChannelSet(Channel);
 }
 
+/**
+ * Publish the motor speeds the ESCs reported, when they're asked to
+ */
+static void update_motor_rpm()
+{
+	if (actuatorSettings.BidirectionalDShot != ACTUATORSETTINGS_BIDIRECTIONALDSHOT_TRUE)
+		return;
+
+	MotorRpmData motor_rpm = { { 0 } };
+	uint32_t pole_pairs = actuatorSettings.MotorPoles / 2;
+
+	if (!pole_pairs)
+		pole_pairs = 1;
+
+	for (int n = 0; n < MAX_MIX_ACTUATORS; ++n) {
+		uint32_t erpm;
+
+		if (!PIOS_Servo_GetERPM(n, &erpm))
+			continue;
+
+		uint32_t rpm = erpm / pole_pairs;
+		motor_rpm.Rpm[n] = rpm > UINT16_MAX ? UINT16_MAX : rpm;
+	}
+
+	MotorRpmSet(&motor_rpm);
+}
+
 /**
  * @}
  * @}
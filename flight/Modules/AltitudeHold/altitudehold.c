@@ -66,6 +66,11 @@
 #define STACK_SIZE_BYTES 648
 #define TASK_PRIORITY PIOS_THREAD_PRIO_LOW
 
+//! Run the controller off the vertical estimate at up to this interval (ms)
+#define VELOCITY_UPDATE_MS 5
+//! Fallback period in case the estimate stops updating (ms)
+#define FALLBACK_MS 20
+
 // Private variables
 static struct pios_thread *altitudeHoldTaskHandle;
 static struct pios_queue *queue;
@@ -166,8 +171,7 @@ static void altitudeHoldTask(void *parameters)
 	AlarmsSet(SYSTEMALARMS_ALARM_ALTITUDEHOLD, SYSTEMALARMS_ALARM_OK);
 
 	// Main task loop
-	const uint32_t dt_ms = 20;
-	uint32_t timeout = dt_ms;
+	uint32_t timeout = 100;
 	uint32_t timeval = PIOS_DELAY_GetRaw();
 
 	while (1) {
@@ -187,8 +191,19 @@ static void altitudeHoldTask(void *parameters)
 			} else if (flight_mode != FLIGHTSTATUS_FLIGHTMODE_ALTITUDEHOLD)
 				engaged = false;
 
-			// Run loop at 20 Hz when engaged otherwise just slowly wait for it to be engaged
-			timeout = engaged ? dt_ms : 100;
+			// The vertical filter updates VelocityActual every accel
+			// sample.  Listen to it while engaged, so the controller runs
+			// straight after a fresh estimate instead of sampling it on
+			// its own schedule.
+			if (engaged)
+				UAVObjConnectQueueThrottled(VelocityActualHandle(), queue,
+						EV_UPDATED, VELOCITY_UPDATE_MS);
+			else
+				UAVObjDisconnectQueue(VelocityActualHandle(), queue);
+
+			// When engaged the estimate drives the loop, otherwise just
+			// slowly wait for it to be engaged
+			timeout = engaged ? FALLBACK_MS : 100;
 
 			continue;
 
@@ -55,6 +55,7 @@
 #include "coordinate_conversions.h"
 #include "WorldMagModel.h"
 #include "insgps.h"
+#include "loopmonitor.h"
 
 // UAVOs
 #include "accels.h"
@@ -84,6 +85,9 @@
 #define TASK_PRIORITY PIOS_THREAD_PRIO_HIGH
 #define FAILSAFE_TIMEOUT_MS 10
 
+//! Longest the INS covariance is left without propagating it [s]
+#define INS_COVARIANCE_PERIOD 0.004f
+
 // Private types
 
 // Track the initialization state of the complementary filter
@@ -114,6 +118,9 @@ struct complementary_filter_state {
 	//! Indicate if currently acquiring gyro samples
 	bool       accumulating_gyro;
 
+	//! The delta angle of the last step, for the coning compensation
+	float      last_dtheta[3];
+
 	//! Store when the function is initialized to time arming and convergence
 	uint32_t   reset_timeval;
 
@@ -126,6 +133,7 @@ struct cfvert {
 	float velocity_z;
 	float position_z;
 	float time_constant_z;
+	float k1_z, k2_z, k3_z;
 	float accel_correction_z;
 	float position_base_z;
 	float position_error_z;
@@ -160,6 +168,9 @@ static struct cfvert cfvert; //!< State information for vertical filter
 
 static float dT_expected = 0.001f;	// assume 1KHz if we don't know.
 
+//! When the primary filter got its sample and started updating
+static uint32_t update_start;
+
 // Private functions
 static void AttitudeTask(void *parameters);
 
@@ -470,8 +481,10 @@ static void AttitudeTask(void *parameters)
 
 		updateNedAccel();
 
-		if(ret_val == 0)
+		if(ret_val == 0) {
+			LoopMonitorEnd(LOOPMONITOR_ATTITUDE, update_start);
 			first_run = false;
+		}
 
 		PIOS_WDG_UpdateFlag(PIOS_WDG_ATTITUDE);
 	}
@@ -509,6 +522,8 @@ static int32_t updateAttitudeComplementary(float dT, bool first_run, bool second
 				return -1;
 			}
 		}
+
+		update_start = LoopMonitorStart();
 	}
 
 	AccelsGet(&accelsData);
@@ -566,6 +581,9 @@ static int32_t updateAttitudeComplementary(float dT, bool first_run, bool second
 
 		complementary_filter_state.arming_count = 0;
 
+		for (int i = 0; i < 3; i++)
+			complementary_filter_state.last_dtheta[i] = 0;
+
 		float baro;
 		BaroAltitudeAltitudeGet(&baro);
 		cfvert_reset(&cfvert, baro, attitudeSettings.VertPositionTau);
@@ -753,19 +771,22 @@ static int32_t updateAttitudeComplementary(float dT, bool first_run, bool second
 	gyrosData.y += accel_err[1] * accKp;
 	gyrosData.z += accel_err[2] * accKp + mag_err[2] * mgKp;
 
-	// Work out time derivative from INSAlgo writeup
-	// Also accounts for the fact that gyros are in deg/s
-	float qdot[4];
-	qdot[0] = (-cf_q[1] * gyrosData.x - cf_q[2] * gyrosData.y - cf_q[3] * gyrosData.z) * dT * DEG2RAD / 2;
-	qdot[1] = (cf_q[0] * gyrosData.x - cf_q[3] * gyrosData.y + cf_q[2] * gyrosData.z) * dT * DEG2RAD / 2;
-	qdot[2] = (cf_q[3] * gyrosData.x + cf_q[0] * gyrosData.y - cf_q[1] * gyrosData.z) * dT * DEG2RAD / 2;
-	qdot[3] = (-cf_q[2] * gyrosData.x + cf_q[1] * gyrosData.y + cf_q[0] * gyrosData.z) * dT * DEG2RAD / 2;
+	// Rotate by the delta angle of the step, compensated for coning so
+	// longer steps keep their accuracy. Gyros are in deg/s.
+	float dtheta[3] = {
+		gyrosData.x * dT * DEG2RAD,
+		gyrosData.y * dT * DEG2RAD,
+		gyrosData.z * dT * DEG2RAD
+	};
+	float phi[3], dq[4], q_new[4];
+	coning_rotation_vector(complementary_filter_state.last_dtheta, dtheta, phi);
+	for (int i = 0; i < 3; i++)
+		complementary_filter_state.last_dtheta[i] = dtheta[i];
 
 	// Take a time step
-	cf_q[0] = cf_q[0] + qdot[0];
-	cf_q[1] = cf_q[1] + qdot[1];
-	cf_q[2] = cf_q[2] + qdot[2];
-	cf_q[3] = cf_q[3] + qdot[3];
+	Rv2Quaternion(phi, dq);
+	quat_mult(cf_q, dq, q_new);
+	quat_copy(q_new, cf_q);
 
 	if(cf_q[0] < 0) {
 		cf_q[0] = -cf_q[0];
@@ -857,6 +878,12 @@ static void cfvert_reset(struct cfvert *cf, float baro, float time_constant)
 	cf->position_z = 0;
 	cf->time_constant_z = time_constant;
 	cf->accel_correction_z = 0;
+
+	// Runs every accel sample, so work the gains out once here
+	cf->k1_z = 3 / time_constant;
+	cf->k2_z = 3 / (time_constant * time_constant);
+	cf->k3_z = 1 / (time_constant * time_constant * time_constant);
+
 	cf->position_base_z = 0;
 	cf->position_error_z = 0;
 	cf->position_correction_z = 0;
@@ -866,13 +893,9 @@ static void cfvert_reset(struct cfvert *cf, float baro, float time_constant)
 //! Predict the position in the future
 static void cfvert_predict_pos(struct cfvert *cf, float z_accel, float dt)
 {
-	float k1_z = 3 / cf->time_constant_z;
-	float k2_z = 3 / powf(cf->time_constant_z, 2);
-	float k3_z = 1 / powf(cf->time_constant_z, 3);
-
-	cf->accel_correction_z += cf->position_error_z * k3_z * dt;
-	cf->velocity_z += cf->position_error_z * k2_z * dt;
-	cf->position_correction_z += cf->position_error_z * k1_z * dt;
+	cf->accel_correction_z += cf->position_error_z * cf->k3_z * dt;
+	cf->velocity_z += cf->position_error_z * cf->k2_z * dt;
+	cf->position_correction_z += cf->position_error_z * cf->k1_z * dt;
 
 	float velocity_increase;
 	velocity_increase = (z_accel + cf->accel_correction_z) * dt;
@@ -1059,6 +1082,9 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 
 	static uint32_t ins_last_time = 0;
 	static uint32_t ins_init_time = 0;
+	static float cov_dT;
+	static float cov_dTsq;
+	static float last_dtheta[3];
 
 	static enum {INS_INIT, INS_WARMUP, INS_RUNNING} ins_state;
 
@@ -1099,6 +1125,8 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 		return -1;
 	}
 
+	update_start = LoopMonitorStart();
+
 	// Get most recent data
 	GyrosGet(&gyrosData);
 	AccelsGet(&accelsData);
@@ -1220,6 +1248,10 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 
 		ins_last_time = PIOS_DELAY_GetRaw();	
 		ins_init_time = ins_last_time;
+		cov_dT = 0;
+		cov_dTsq = 0;
+		for (int i = 0; i < 3; i++)
+			last_dtheta[i] = 0;
 
 		return 0;
 	} else if (ins_state == INS_INIT)
@@ -1269,11 +1301,23 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 		gyros[2] = gyrosData.z * DEG2RAD;
 	}
 
+	// Make up for the coning between samples, as the rates the step
+	// would need to end in the compensated rotation
+	float dtheta[3], phi[3];
+	for (int i = 0; i < 3; i++)
+		dtheta[i] = gyros[i] * dT;
+	coning_rotation_vector(last_dtheta, dtheta, phi);
+	for (int i = 0; i < 3; i++) {
+		last_dtheta[i] = dtheta[i];
+		gyros[i] = phi[i] / dT;
+	}
+
 	// Advance the state estimate
 	INSStatePrediction(gyros, &accelsData.x, dT);
 
-	// Advance the covariance estimate
-	INSCovariancePrediction(dT);
+	// The covariance changes slowly, so it is propagated at a lower rate
+	cov_dT += dT;
+	cov_dTsq += dT * dT;
 
 	if(mag_updated) {
 		sensors |= MAG_SENSORS;
@@ -1350,6 +1394,13 @@ static int32_t updateAttitudeINSGPS(bool first_run, bool outdoor_mode)
 		NED[2] = -(baroData.Altitude + baro_offset);
 	}
 
+	// Advance the covariance estimate, always up to date for a correction
+	if (sensors || cov_dT >= INS_COVARIANCE_PERIOD) {
+		INSCovariancePredictionSteps(cov_dT, cov_dTsq);
+		cov_dT = 0;
+		cov_dTsq = 0;
+	}
+
 	/*
 	 * TODO: Need to add a general sanity check for all the inputs to make sure their kosher
 	 * although probably should occur within INS itself
@@ -51,15 +51,25 @@
 #include "systemsettings.h"
 
 #include "misc_math.h"
+#include "rlsident.h"
+#include "stabilization.h"
 
 // Private constants
-#define STACK_SIZE_BYTES 640
+#define STACK_SIZE_BYTES 768
 #define TASK_PRIORITY PIOS_THREAD_PRIO_NORMAL
 
 #ifndef AUTOTUNE_AVERAGING_DECIMATION
 #define AUTOTUNE_AVERAGING_DECIMATION 1
 #endif
 
+// Loops buffered between drains; 32ms at 2KHz
+#define SAMPLE_QUEUE_LEN 64
+#define DRAIN_MS 5
+
+// Identification filter cutoff (Hz) and memory (s)
+#define IDENT_CUTOFF 50.0f
+#define IDENT_MEMORY 4.0f
+
 // Private types
 enum autotune_state { AT_INIT, AT_RUN };
 
@@ -85,11 +95,14 @@ static struct at_measurement *at_averages;
 static struct pios_thread *taskHandle;
 static bool module_enabled;
 
-static volatile uint32_t throttle_accumulator;
-static volatile uint32_t update_counter = 0;
-static volatile bool tune_running = false;
+static uint32_t throttle_accumulator;
+static uint32_t update_counter = 0;
+static bool tune_running = false;
 extern uint16_t ident_wiggle_points;
 
+static struct rlsident ident;
+static float ident_dT;
+
 uint16_t decim_wiggle_points;
 
 // Private functions
@@ -146,18 +159,11 @@ int32_t AutotuneStart(void)
 
 MODULE_INITCALL(AutotuneInitialize, AutotuneStart)
 
-static void at_new_actuators(UAVObjEvent * ev, void *ctx, void *obj, int len) {
-	(void) ev; (void) ctx;
-
+static void at_new_sample(const struct ident_sample *s) {
 	static bool first_cycle = false;
+	static uint16_t next_cycle;
 
-	ActuatorDesiredData actuators;
-	ActuatorDesiredGet(&actuators);
-
-	GyrosData g;
-	GyrosGet(&g);
-
-	if (actuators.SystemIdentCycle == 0xffff) {
+	if (s->cycle == 0xffff) {
 		if (tune_running) {
 			tune_running = false;
 			first_cycle = false;
@@ -170,10 +176,12 @@ static void at_new_actuators(UAVObjEvent * ev, void *ctx, void *obj, int len) {
 	 * !running !first_cycle -> running first_cycle -> running !first_cycle
 	 */
 	if (!tune_running || first_cycle) {
-		if (actuators.SystemIdentCycle == 0x0000) {
+		if (s->cycle == 0x0000) {
 			if (!tune_running) {
 				update_counter = 0;
 				throttle_accumulator = 0;
+				rlsident_init(&ident, ident_dT, IDENT_CUTOFF,
+						IDENT_MEMORY);
 			}
 
 			tune_running = true;
@@ -181,22 +189,30 @@ static void at_new_actuators(UAVObjEvent * ev, void *ctx, void *obj, int len) {
 		}
 	}
 
-	struct at_measurement *avg_point = &at_averages[actuators.SystemIdentCycle / AUTOTUNE_AVERAGING_DECIMATION];
+	struct at_measurement *avg_point = &at_averages[s->cycle / AUTOTUNE_AVERAGING_DECIMATION];
 
 	if (first_cycle) {
 		*avg_point = (struct at_measurement) { { 0 } };
 	}
 
-	avg_point->y[0] += g.x;
-	avg_point->y[1] += g.y;
-	avg_point->y[2] += g.z;
+	for (int i = 0; i < 3; i++) {
+		avg_point->y[i] += s->gyro[i];
+		avg_point->u[i] += s->actuator[i];
+	}
+
+	if (tune_running) {
+		// Lost samples would look like a jump in the response
+		if (s->cycle != next_cycle) {
+			rlsident_restart(&ident);
+		}
 
-	avg_point->u[0] += actuators.Roll;
-	avg_point->u[1] += actuators.Pitch;
-	avg_point->u[2] += actuators.Yaw;
+		rlsident_update(&ident, s->gyro, s->actuator);
+	}
+
+	next_cycle = (s->cycle + 1) & (ident_wiggle_points - 1);
 
 	update_counter++;
-	throttle_accumulator += 10000 * actuators.Thrust;
+	throttle_accumulator += 10000 * s->thrust;
 }
 
 static void UpdateSystemIdent(uint32_t predicts, float hover_throttle,
@@ -208,6 +224,15 @@ static void UpdateSystemIdent(uint32_t predicts, float hover_throttle,
 
 	system_ident.HoverThrottle = hover_throttle;
 
+	for (int i = 0; i < 3; i++) {
+		// Left at 0 until the estimate makes sense
+		float tau = 0, beta = 0;
+		rlsident_get(&ident, i, &tau, &beta);
+
+		system_ident.Tau[i] = tau;
+		system_ident.Beta[i] = beta;
+	}
+
 	SystemIdentSet(&system_ident);
 }
 
@@ -276,18 +301,39 @@ static void AutotuneTask(void *parameters)
 	uint16_t buf_size = sizeof(*at_averages) * decim_wiggle_points;
 	at_averages = PIOS_malloc(buf_size);
 
-	while (!at_averages) {
+	circ_queue_t samples = circ_queue_new(sizeof(struct ident_sample),
+			SAMPLE_QUEUE_LEN);
+
+	while (!at_averages || !samples) {
 		/* Infinite loop because we couldn't get our buffer */
 		/* Assert alarm XXX? */
 		PIOS_Thread_Sleep(2500);
 	}
 
-	ActuatorDesiredConnectCallback(at_new_actuators);
+	ident_dT = 1.0f / PIOS_SENSORS_GetSampleRate(PIOS_SENSOR_GYRO);
+	rlsident_init(&ident, ident_dT, IDENT_CUTOFF, IDENT_MEMORY);
+
+	// Stabilization starts handing us every loop from here on
+	ident_samples = samples;
 
 	bool save_needed = false;
 	enum autotune_state state = AT_INIT;
+	uint32_t last_update = PIOS_Thread_Systime();
 
 	while(1) {
+		struct ident_sample sample;
+
+		while (circ_queue_read_data(samples, &sample, 1)) {
+			at_new_sample(&sample);
+		}
+
+		if (!PIOS_Thread_Period_Elapsed(last_update, YIELD_MS)) {
+			PIOS_Thread_Sleep(DRAIN_MS);
+			continue;
+		}
+
+		last_update = PIOS_Thread_Systime();
+
 		uint8_t armed;
 
 		FlightStatusArmedGet(&armed);
@@ -306,7 +352,7 @@ static void AutotuneTask(void *parameters)
 						true);
 
 				// Save the UAVO locally.
-				UAVObjSave(SystemIdentHandle(), 0);
+				UAVObjSaveDeferred(SystemIdentHandle(), 0);
 				state = AT_INIT;
 
 				save_needed = false;
@@ -345,8 +391,6 @@ static void AutotuneTask(void *parameters)
 
 				break;
 		}
-
-		PIOS_Thread_Sleep(YIELD_MS);
 	}
 }
 
@@ -43,6 +43,7 @@
 
 #include "openpilot.h"
 #include <eventdispatcher.h>
+#include "coordinate_conversions.h"
 #include "misc_math.h"
 #include "physical_constants.h"
 #include "pios_thread.h"
@@ -397,24 +398,18 @@ static void tablet_info_process() {
 		HomeLocationData homeLocation;
 		HomeLocationGet(&homeLocation);
 
-		PoiLocationData poi;
-
-		float lat, alt;
-		lat = homeLocation.Latitude / 10.0e6f * DEG2RAD;
-		alt = homeLocation.Altitude;
+		struct home_frame home;
+		home_frame_init(&home, homeLocation.Latitude, homeLocation.Longitude, homeLocation.Altitude);
 
-		float T[3];
-		T[0] = alt+6.378137E6f;
-		T[1] = cosf(lat)*(alt+6.378137E6f);
-		T[2] = -1.0f;
+		// The tablet altitude is taken relative to home here
+		float alt = homeLocation.Altitude + tablet.Altitude;
+		float NED[1][3];
+		lla_to_ned_batch(&home, &tablet.Latitude, &tablet.Longitude, &alt, NED, 1);
 
-		float dL[3] = {(tablet.Latitude - homeLocation.Latitude) / 10.0e6f * DEG2RAD,
-			(tablet.Longitude - homeLocation.Longitude) / 10.0e6f * DEG2RAD,
-			(tablet.Altitude)};
-
-		poi.North = T[0] * dL[0];
-		poi.East = T[1] * dL[1];
-		poi.Down = T[2] * dL[2];
+		PoiLocationData poi;
+		poi.North = NED[0][0];
+		poi.East = NED[0][1];
+		poi.Down = NED[0][2];
 		PoiLocationSet(&poi);
 	}
 }
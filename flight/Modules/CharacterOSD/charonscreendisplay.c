@@ -184,8 +184,10 @@ static void program_characters(charosd_state_t state, uint8_t font)
 		}
 	}
 	if (changed) {
+		PIOS_MAX7456_clear(state->dev);
 		PIOS_MAX7456_puts(state->dev, MAX7456_FMT_H_CENTER,
 				  6, loaded_txt, 0);
+		PIOS_MAX7456_flush(state->dev);
 		PIOS_Thread_Sleep(1000);
 	}
 	state->prev_font = font;
@@ -262,6 +264,7 @@ static void splash_screen(charosd_state_t state)
 	const char *boot_reason = AlarmBootReason(alarm.RebootCause);
 	PIOS_MAX7456_puts(state->dev, MAX7456_FMT_H_CENTER, 4, welcome_msg, 0);
 	PIOS_MAX7456_puts(state->dev, MAX7456_FMT_H_CENTER, 6, boot_reason, 0);
+	PIOS_MAX7456_flush(state->dev);
 
 	PIOS_Thread_Sleep(SPLASH_TIME_MS);
 }
@@ -309,11 +312,18 @@ static void CharOnScreenDisplayTask(void *parameters)
 		screen_draw(state, &page);
 
 		if (PIOS_MAX7456_stall_detect(state->dev)) {
+			PIOS_MAX7456_clear(state->dev);
 			PIOS_MAX7456_puts(state->dev, MAX7456_FMT_H_CENTER, 6, "... STALLED ...", 0);
+			PIOS_MAX7456_flush(state->dev);
 			PIOS_Thread_Sleep(10000);
+			continue;
 		}
 
+		/* Only what changed since the last frame goes out, in the
+		 * vertical blanking interval.
+		 */
 		PIOS_MAX7456_wait_vsync(state->dev);
+		PIOS_MAX7456_flush(state->dev);
 	}
 }
 
@@ -62,7 +62,7 @@ static void updateSettings();
 
 #define TASK_PRIORITY                   PIOS_THREAD_PRIO_LOW
 
-#define BRIDGE_BUF_LEN 10
+#define BRIDGE_BUF_LEN 64
 
 // ****************
 // Private variables
@@ -69,6 +69,7 @@ static void updateSettings();
 
 #define GPS_TIMEOUT_MS                  750
 #define GPS_COM_TIMEOUT_MS              100
+#define GPS_READ_CHUNK                  32 // bytes taken from the port at once
 #define STACK_SIZE_BYTES                850
 
 #define TASK_PRIORITY                   PIOS_THREAD_PRIO_LOW
@@ -156,7 +157,7 @@ int32_t GPSInitialize(void)
 				}
 				break;
 			case MODULESETTINGS_GPSDATAPROTOCOL_UBX:
-				gps_rx_buffer = PIOS_malloc(sizeof(struct UBXPacket));
+				gps_rx_buffer = PIOS_malloc(UBX_MAX_FRAME_LEN);
 				if (gps_rx_buffer == NULL) {
 					AlarmsSet(SYSTEMALARMS_ALARM_GPS, SYSTEMALARMS_ALARM_ERROR);
 					return -1;
@@ -256,21 +257,22 @@ static void gpsTask(void *parameters)
 			continue;
 		}
 
-		uint8_t c;
+		uint8_t c[GPS_READ_CHUNK];
+		uint16_t len;
 
 		// This blocks the task until there is something on the buffer
-		while (PIOS_COM_ReceiveBuffer(gpsPort, &c, 1, xDelay) > 0)
+		while ((len = PIOS_COM_ReceiveBuffer(gpsPort, c, sizeof(c), xDelay)) > 0)
 		{
 			int res;
 			switch (gpsProtocol) {
 #if defined(PIOS_INCLUDE_GPS_NMEA_PARSER)
 				case MODULESETTINGS_GPSDATAPROTOCOL_NMEA:
-					res = parse_nmea_stream (c,gps_rx_buffer, &gpsposition, &gpsRxStats);
+					res = parse_nmea_buffer (c, len, gps_rx_buffer, &gpsposition, &gpsRxStats);
 					break;
 #endif
 #if defined(PIOS_INCLUDE_GPS_UBX_PARSER)
 				case MODULESETTINGS_GPSDATAPROTOCOL_UBX:
-					res = parse_ubx_stream (c,gps_rx_buffer, &gpsposition, &gpsRxStats);
+					res = parse_ubx_buffer (c, len, gps_rx_buffer, &gpsposition, &gpsRxStats);
 					break;
 #endif
 				default:
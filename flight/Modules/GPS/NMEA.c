@@ -184,6 +184,24 @@ int parse_nmea_stream (uint8_t c, char *gps_rx_buffer, GPSPositionData *GpsData,
 	return PARSER_INCOMPLETE;
 }
 
+/**
+ * Parse a span of the incoming stream
+ * \return PARSER_COMPLETE if any sentence in it was, else what the last byte gave
+ */
+int parse_nmea_buffer(const uint8_t *buf, uint16_t len, char *gps_rx_buffer, GPSPositionData *GpsData, struct GPS_RX_STATS *gpsRxStats)
+{
+	int ret = PARSER_INCOMPLETE;
+
+	for (uint16_t i = 0; i < len; i++) {
+		int res = parse_nmea_stream(buf[i], gps_rx_buffer, GpsData, gpsRxStats);
+
+		if (ret != PARSER_COMPLETE)
+			ret = res;
+	}
+
+	return ret;
+}
+
 const static struct nmea_parser *NMEA_find_parser_by_prefix(const char *prefix)
 {
 	if (!prefix) {
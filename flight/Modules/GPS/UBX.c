@@ -35,105 +35,71 @@
 
 #include "UBX.h"
 #include "GPS.h"
+#include "ubx_frame.h"
 
 static uint32_t parse_errors;
 
-static bool checksum_ubx_message(const struct UBXPacket *);
 static uint32_t parse_ubx_message(const struct UBXPacket *, GPSPositionData *);
 
-// parse incoming character stream for messages in UBX binary format
+struct ubx_parse_ctx {
+	char *gps_rx_buffer;
+	GPSPositionData *GpsData;
+};
 
-int parse_ubx_stream (uint8_t c, char *gps_rx_buffer, GPSPositionData *GpsData, struct GPS_RX_STATS *gpsRxStats)
+// gathers frames split across spans, in gps_rx_buffer
+static struct ubx_frame_state frame_state;
+
+static void ubx_frame_received(void *ctx, uint8_t msg_class, uint8_t id,
+		const uint8_t *payload, uint16_t len)
+{
+	struct ubx_parse_ctx *parse_ctx = ctx;
+	struct UBXPacket *ubx = (struct UBXPacket *)parse_ctx->gps_rx_buffer;
+
+	// The payload can sit anywhere in the received data, where its fields
+	// can't be read directly; it may also be a frame in gps_rx_buffer itself
+	memmove(&ubx->payload, payload, len);
+	ubx->header.class = msg_class;
+	ubx->header.id = id;
+	ubx->header.len = len;
+
+	parse_ubx_message(ubx, parse_ctx->GpsData);
+}
+
+// parse a span of the incoming stream for messages in UBX binary format,
+// complete if any message in it was
+
+int parse_ubx_buffer (const uint8_t *buf, uint16_t len, char *gps_rx_buffer, GPSPositionData *GpsData, struct GPS_RX_STATS *gpsRxStats)
 {
-	enum proto_states {
-		START,
-		UBX_SY2,
-		UBX_CLASS,
-		UBX_ID,
-		UBX_LEN1,
-		UBX_LEN2,
-		UBX_PAYLOAD,
-		UBX_CHK1,
-		UBX_CHK2,
-		FINISHED
+	struct ubx_parse_ctx ctx = {
+		.gps_rx_buffer = gps_rx_buffer,
+		.GpsData = GpsData,
 	};
 
-	static enum proto_states proto_state = START;
-	static uint16_t rx_count = 0;
-	struct UBXPacket *ubx = (struct UBXPacket *)gps_rx_buffer;
+	if (frame_state.partial != (uint8_t *)gps_rx_buffer)
+		ubx_frame_init(&frame_state, (uint8_t *)gps_rx_buffer, UBX_MAX_FRAME_LEN);
 
-	switch (proto_state) {
-		case START: // detect protocol
-			if (c ==  UBX_SYNC1) // first UBX sync char found
-				proto_state = UBX_SY2;
-			break;
-		case UBX_SY2:
-			if (c == UBX_SYNC2) // second UBX sync char found
-				proto_state = UBX_CLASS;
-			else
-				proto_state = START; // reset state
-			break;
-		case UBX_CLASS:
-			ubx->header.class = c;
-			proto_state = UBX_ID;
-			break;
-		case UBX_ID:
-			ubx->header.id = c;
-			proto_state = UBX_LEN1;
-			break;
-		case UBX_LEN1:
-			ubx->header.len = c;
-			proto_state = UBX_LEN2;
-			break;
-		case UBX_LEN2:
-			ubx->header.len += (c << 8);
-			if (ubx->header.len > sizeof(UBXPayload)) {
-				gpsRxStats->gpsRxOverflow++;
-				proto_state = START;
-			} else {
-				rx_count = 0;
-				proto_state = UBX_PAYLOAD;
-			}
-			break;
-		case UBX_PAYLOAD:
-			if (rx_count < ubx->header.len) {
-				ubx->payload.payload[rx_count] = c;
-				if (++rx_count == ubx->header.len)
-					proto_state = UBX_CHK1;
-			} else {
-				gpsRxStats->gpsRxOverflow++;
-				proto_state = START;
-			}
-			break;
-		case UBX_CHK1:
-			ubx->header.ck_a = c;
-			proto_state = UBX_CHK2;
-			break;
-		case UBX_CHK2:
-			ubx->header.ck_b = c;
-			if (checksum_ubx_message(ubx)) { // message complete and valid
-				parse_ubx_message(ubx, GpsData);
-				proto_state = FINISHED;
-			} else {
-				gpsRxStats->gpsRxChkSumError++;
-				proto_state = START;
-			}
-			break;
-		default: break;
+	uint32_t chksum_errors = frame_state.chksum_errors;
+	uint32_t overflows = frame_state.overflows;
+
+	uint16_t frames = ubx_frame_parse(&frame_state, buf, len,
+			ubx_frame_received, &ctx);
+
+	gpsRxStats->gpsRxReceived += frames;
+	if (frame_state.chksum_errors != chksum_errors) {
+		gpsRxStats->gpsRxChkSumError += frame_state.chksum_errors - chksum_errors;
+		parse_errors += frame_state.chksum_errors - chksum_errors;
+		UBloxInfoParseErrorsSet(&parse_errors);
 	}
+	gpsRxStats->gpsRxOverflow += frame_state.overflows - overflows;
 
-	if (proto_state == START)
-		return PARSER_ERROR;	// parser couldn't use this byte
-	else if (proto_state == FINISHED) {
-		gpsRxStats->gpsRxReceived++;
-		proto_state = START;
+	if (frames)
 		return PARSER_COMPLETE;	// message complete & processed
-	}
+	else if (frame_state.held)
+		return PARSER_INCOMPLETE; // message not (yet) complete
 
-	return PARSER_INCOMPLETE; // message not (yet) complete
+	return PARSER_ERROR;	// parser couldn't use these bytes
 }
 
-
 // Keep track of various GPS messages needed to make up a single UAVO update
 // time-of-week timestamp is used to correlate matching messages
 
@@ -165,40 +131,6 @@ bool check_msgtracker (uint32_t tow, uint8_t msg_flag)
 	return true;
 }
 
-static bool checksum_ubx_message (const struct UBXPacket *ubx)
-{
-	int i;
-	uint8_t ck_a, ck_b;
-
-	ck_a = ubx->header.class;
-	ck_b = ck_a;
-
-	ck_a += ubx->header.id;
-	ck_b += ck_a;
-
-	ck_a += ubx->header.len & 0xff;
-	ck_b += ck_a;
-
-	ck_a += ubx->header.len >> 8;
-	ck_b += ck_a;
-
-	for (i = 0; i < ubx->header.len; i++) {
-		ck_a += ubx->payload.payload[i];
-		ck_b += ck_a;
-	}
-
-	if (ubx->header.ck_a == ck_a &&
-			ubx->header.ck_b == ck_b)
-		return true;
-	else {
-		parse_errors++;
-		UBloxInfoParseErrorsSet(&parse_errors);
-
-		return false;
-	}
-
-}
-
 static void parse_ubx_nav_posllh (const struct UBX_NAV_POSLLH *posllh, GPSPositionData *GpsPosition)
 {
 	if (check_msgtracker(posllh->iTOW, POSLLH_RECEIVED)) {
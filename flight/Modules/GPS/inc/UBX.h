@@ -32,6 +32,7 @@
 #include "openpilot.h"
 #include "gpsposition.h"
 #include "GPS.h"
+#include "ubx_frame.h"
 
 
 #define UBX_SYNC1						0xb5 // UBX protocol synchronization characters
@@ -224,7 +225,10 @@ struct UBXPacket {
 	UBXPayload	payload;
 };
 
-int  parse_ubx_stream(uint8_t, char *, GPSPositionData *, struct GPS_RX_STATS *);
+//! Longest frame taken, as received with sync chars and checksum
+#define UBX_MAX_FRAME_LEN	(sizeof(UBXPayload) + UBX_FRAME_OVERHEAD)
+
+int  parse_ubx_buffer(const uint8_t *, uint16_t, char *, GPSPositionData *, struct GPS_RX_STATS *);
 
 #endif /* UBX_H */
 
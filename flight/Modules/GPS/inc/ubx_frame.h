@@ -0,0 +1,69 @@
+/**
+ ******************************************************************************
+ * @addtogroup Modules Modules
+ * @{
+ * @addtogroup GPSModule GPS
+ * @{
+ *
+ * @file       ubx_frame.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief      Splits a received byte stream into UBX frames
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef UBX_FRAME_H
+#define UBX_FRAME_H
+
+#include <stdint.h>
+
+//! Sync chars, class, id and length before the payload, checksum after it
+#define UBX_FRAME_HEADER_LEN	6
+#define UBX_FRAME_OVERHEAD	8
+
+/**
+ * Called for each frame with a good checksum. The payload is only valid
+ * during the call, and may sit at any alignment.
+ */
+typedef void (*ubx_frame_cb)(void *ctx, uint8_t msg_class, uint8_t id,
+		const uint8_t *payload, uint16_t len);
+
+struct ubx_frame_state {
+	//! Holds a frame that is split across spans, raw as received
+	uint8_t *partial;
+	//! Size of partial, which also bounds the frames taken
+	uint16_t partial_size;
+	//! How much of a frame partial holds
+	uint16_t held;
+
+	uint32_t received;
+	uint32_t chksum_errors;
+	uint32_t overflows;
+};
+
+void ubx_frame_init(struct ubx_frame_state *state, uint8_t *partial,
+		uint16_t partial_size);
+uint16_t ubx_frame_parse(struct ubx_frame_state *state, const uint8_t *buf,
+		uint16_t len, ubx_frame_cb cb, void *ctx);
+uint16_t ubx_frame_checksum(const uint8_t *buf, uint16_t len);
+
+#endif /* UBX_FRAME_H */
+
+/**
+ * @}
+ * @}
+ */
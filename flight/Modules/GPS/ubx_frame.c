@@ -0,0 +1,218 @@
+/**
+ ******************************************************************************
+ * @addtogroup Modules Modules
+ * @{
+ * @addtogroup GPSModule GPS
+ * @{
+ *
+ * @file       ubx_frame.c
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief      Splits a received byte stream into UBX frames
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * Frames that lie wholly within a span are checked and passed on where
+ * they are, with no copy. Only a frame cut off by the end of a span is
+ * gathered in the partial buffer until the rest arrives.
+ */
+
+#include <string.h>
+
+#include "ubx_frame.h"
+
+#define UBX_SYNC1 0xb5
+#define UBX_SYNC2 0x62
+
+/**
+ * @brief Set up the parser state
+ * @param[in] partial buffer for frames split across spans
+ * @param[in] partial_size its size, the longest frame taken
+ */
+void ubx_frame_init(struct ubx_frame_state *state, uint8_t *partial,
+		uint16_t partial_size)
+{
+	memset(state, 0, sizeof(*state));
+
+	state->partial = partial;
+	state->partial_size = partial_size;
+}
+
+/**
+ * @brief The UBX (8 bit Fletcher) checksum of a span
+ *
+ * Works four bytes at a time: over a block, ck_b gains four times ck_a plus
+ * the bytes weighted by how many sums they are still part of. The sums run
+ * wide and are cut to 8 bits at the end, which gives the same result.
+ *
+ * @returns ck_a in the low byte, ck_b in the high byte
+ */
+uint16_t ubx_frame_checksum(const uint8_t *buf, uint16_t len)
+{
+	uint32_t ck_a = 0, ck_b = 0;
+	uint16_t i = 0;
+
+	for (; i + 4 <= len; i += 4) {
+		uint32_t b0 = buf[i], b1 = buf[i + 1], b2 = buf[i + 2], b3 = buf[i + 3];
+
+		ck_b += 4 * ck_a + 4 * b0 + 3 * b1 + 2 * b2 + b3;
+		ck_a += b0 + b1 + b2 + b3;
+	}
+
+	for (; i < len; i++) {
+		ck_a += buf[i];
+		ck_b += ck_a;
+	}
+
+	return (ck_a & 0xff) | ((ck_b & 0xff) << 8);
+}
+
+static uint16_t frame_len(const uint8_t *frame)
+{
+	return (frame[4] | (frame[5] << 8)) + UBX_FRAME_OVERHEAD;
+}
+
+//! Check a whole frame and pass it on if good
+static uint16_t frame_check(struct ubx_frame_state *state, const uint8_t *frame,
+		ubx_frame_cb cb, void *ctx)
+{
+	uint16_t len = frame_len(frame);
+	uint16_t ck = ubx_frame_checksum(frame + 2, len - 4);
+
+	if (frame[len - 2] != (ck & 0xff) || frame[len - 1] != (ck >> 8)) {
+		state->chksum_errors++;
+		return 0;
+	}
+
+	state->received++;
+	cb(ctx, frame[2], frame[3], frame + UBX_FRAME_HEADER_LEN,
+			len - UBX_FRAME_OVERHEAD);
+
+	return 1;
+}
+
+/**
+ * @brief Gather the rest of a frame held in partial
+ * @returns The number of bytes of buf used
+ */
+static uint16_t continue_partial(struct ubx_frame_state *state,
+		const uint8_t *buf, uint16_t len, ubx_frame_cb cb, void *ctx,
+		uint16_t *frames)
+{
+	uint16_t i = 0;
+
+	while (state->held < UBX_FRAME_HEADER_LEN && i < len) {
+		// Look at this byte again as the start of a frame
+		if (state->held == 1 && buf[i] != UBX_SYNC2) {
+			state->held = 0;
+			return i;
+		}
+
+		state->partial[state->held++] = buf[i++];
+	}
+
+	if (state->held < UBX_FRAME_HEADER_LEN)
+		return i;
+
+	uint16_t total = frame_len(state->partial);
+	if (total > state->partial_size) {
+		state->overflows++;
+		state->held = 0;
+		return i;
+	}
+
+	uint16_t n = total - state->held;
+	if (n > len - i)
+		n = len - i;
+
+	memcpy(state->partial + state->held, buf + i, n);
+	state->held += n;
+	i += n;
+
+	if (state->held == total) {
+		*frames += frame_check(state, state->partial, cb, ctx);
+		state->held = 0;
+	}
+
+	return i;
+}
+
+/**
+ * @brief Find the UBX frames in a span of received data
+ * @param[in] cb called for each good frame
+ * @returns The number of good frames found
+ */
+uint16_t ubx_frame_parse(struct ubx_frame_state *state, const uint8_t *buf,
+		uint16_t len, ubx_frame_cb cb, void *ctx)
+{
+	uint16_t frames = 0;
+	uint16_t i = 0;
+
+	while (i < len) {
+		if (state->held) {
+			i += continue_partial(state, buf + i, len - i, cb, ctx, &frames);
+			continue;
+		}
+
+		const uint8_t *sync = memchr(buf + i, UBX_SYNC1, len - i);
+		if (!sync)
+			break;
+
+		i = sync - buf;
+		uint16_t avail = len - i;
+
+		if (avail >= 2 && buf[i + 1] != UBX_SYNC2) {
+			i++;
+			continue;
+		}
+
+		if (avail < UBX_FRAME_HEADER_LEN) {
+			// The header is cut off, gather it bit by bit
+			i += continue_partial(state, buf + i, avail, cb, ctx, &frames);
+			continue;
+		}
+
+		uint16_t total = frame_len(buf + i);
+		if (total > state->partial_size) {
+			state->overflows++;
+			i += 2;
+			continue;
+		}
+
+		if (total > avail) {
+			memcpy(state->partial, buf + i, avail);
+			state->held = avail;
+			break;
+		}
+
+		if (frame_check(state, buf + i, cb, ctx)) {
+			frames++;
+			i += total;
+		} else {
+			// Resync just past this frame's sync chars
+			i += 2;
+		}
+	}
+
+	return frames;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -7,7 +7,7 @@
  *
  * @file       geofence.c
  * @author     Tau Labs, http://taulabs.org, Copyright (C) 2012-2014
- * @author     dRonin, http://dronin.org Copyright (C) 2015
+ * @author     dRonin, http://dronin.org Copyright (C) 2015-2017
  * @brief      Check the UAV is within the geofence boundaries
  *
  * @see        The GNU Public License (GPL) Version 3
@@ -33,9 +33,13 @@
 #include <eventdispatcher.h>
 #include "misc_math.h"
 #include "physical_constants.h"
+#include "polygonindex.h"
 
 #include "geofencesettings.h"
+#include "geofencevertex.h"
+#include "geofencezone.h"
 #include "positionactual.h"
+#include "velocityactual.h"
 #include "modulesettings.h"
 
 
@@ -46,14 +50,29 @@
 
 // Private types
 
-// Private variables
+//! Zones as of the last rebuild of the index
+struct fence_zones {
+	struct polygon_index index;
+
+	uint16_t keep_in;
+	uint16_t keep_out;
+	uint16_t alt_limited;
+	float floor[POLYINDEX_MAX_POLYGONS];
+	float ceiling[POLYINDEX_MAX_POLYGONS];
+};
 
 // Private functions
 static void settingsUpdated(UAVObjEvent* ev, void *ctx, void *obj, int len);
+static void zonesUpdated(UAVObjEvent* ev, void *ctx, void *obj, int len);
 static void checkPosition(UAVObjEvent* ev, void *ctx, void *obj, int len);
+static void rebuildZones(void);
+static bool zonesBreached(float north, float east, float alt);
 
 // Private variables
 static GeoFenceSettingsData *geofenceSettings;
+static struct fence_zones *zones;
+static float warningRadius2, errorRadius2;
+static volatile bool zones_dirty;
 
 /**
  * Initialise the module, called on startup
@@ -80,17 +99,30 @@ int32_t GeofenceInitialize(void)
 		return -1;
 	}
 
+	if (GeoFenceZoneInitialize() == -1 || GeoFenceVertexInitialize() == -1) {
+		module_enabled = false;
+		return -1;
+	}
+
 	if (module_enabled) {
 		// allocate and initialize the static data storage only if module is enabled
 		geofenceSettings = (GeoFenceSettingsData *) PIOS_malloc(sizeof(GeoFenceSettingsData));
-		if (geofenceSettings == NULL) {
+		zones = (struct fence_zones *) PIOS_malloc(sizeof(struct fence_zones));
+		if (geofenceSettings == NULL || zones == NULL) {
 			module_enabled = false;
 			return -1;
 		}
 
+		polyindex_reset(&zones->index);
+		zones->keep_in = zones->keep_out = zones->alt_limited = 0;
+
 		GeoFenceSettingsConnectCallback(settingsUpdated);
 		settingsUpdated(NULL, NULL, NULL, 0);
 
+		GeoFenceZoneConnectCallback(zonesUpdated);
+		GeoFenceVertexConnectCallback(zonesUpdated);
+		zones_dirty = true;
+
 		return 0;
 	}
 
@@ -124,21 +156,141 @@ MODULE_INITCALL(GeofenceInitialize, GeofenceStart);
 static void checkPosition(UAVObjEvent* ev, void *ctx, void *obj, int len)
 {
 	(void) ev; (void) ctx; (void) obj; (void) len;
+
+	if (zones_dirty) {
+		zones_dirty = false;
+		rebuildZones();
+	}
+
 	if (PositionActualHandle()) {
 		PositionActualData positionActual;
 		PositionActualGet(&positionActual);
 
 		const float distance2 = powf(positionActual.North, 2) + powf(positionActual.East, 2);
+		const float alt = -positionActual.Down;
 
-		// ErrorRadius is squared when it is fetched, so this is correct
-		if (distance2 > geofenceSettings->ErrorRadius) {
+		if (distance2 > errorRadius2 ||
+				zonesBreached(positionActual.North, positionActual.East, alt)) {
 			AlarmsSet(SYSTEMALARMS_ALARM_GEOFENCE, SYSTEMALARMS_ALARM_ERROR);
-		} else if (distance2 > geofenceSettings->WarningRadius) {
+			return;
+		}
+
+		if (distance2 > warningRadius2) {
 			AlarmsSet(SYSTEMALARMS_ALARM_GEOFENCE, SYSTEMALARMS_ALARM_WARNING);
-		} else {
-			AlarmsClear(SYSTEMALARMS_ALARM_GEOFENCE);
+			return;
+		}
+
+		// Extrapolate along the current velocity to see whether a zone
+		// boundary is coming up. Each step is a grid lookup.
+		if (VelocityActualHandle() && zones->index.dim) {
+			VelocityActualData velocityActual;
+			VelocityActualGet(&velocityActual);
+
+			for (uint8_t t = 1; t <= geofenceSettings->BreachWarningTime; t++) {
+				if (zonesBreached(positionActual.North + velocityActual.North * t,
+						positionActual.East + velocityActual.East * t,
+						alt - velocityActual.Down * t)) {
+					AlarmsSet(SYSTEMALARMS_ALARM_GEOFENCE, SYSTEMALARMS_ALARM_WARNING);
+					return;
+				}
+			}
+		}
+
+		AlarmsClear(SYSTEMALARMS_ALARM_GEOFENCE);
+	}
+}
+
+/**
+ * Whether a position is outside all keep in zones or inside any keep out
+ * zone, taking floors and ceilings into account.
+ */
+static bool zonesBreached(float north, float east, float alt)
+{
+	if (!zones->index.dim)
+		return false;
+
+	uint16_t inside = polyindex_query(&zones->index, north, east);
+	uint16_t in_alt = inside & zones->alt_limited;
+
+	for (int i = 0; in_alt; i++, in_alt >>= 1) {
+		if ((in_alt & 1) && (alt < zones->floor[i] || alt > zones->ceiling[i]))
+			inside &= ~(1 << i);
+	}
+
+	if (inside & zones->keep_out)
+		return true;
+
+	return zones->keep_in && !(inside & zones->keep_in);
+}
+
+/**
+ * Rebuild the zone index from the GeoFenceZone and GeoFenceVertex objects.
+ * Vertices that don't fit, or belong to no enabled zone, are left out.
+ */
+static void rebuildZones(void)
+{
+	struct polygon_index *index = &zones->index;
+	uint16_t enabled = 0;
+
+	zones->keep_in = zones->keep_out = zones->alt_limited = 0;
+
+	uint16_t num_zones = UAVObjGetNumInstances(GeoFenceZoneHandle());
+	if (num_zones > POLYINDEX_MAX_POLYGONS)
+		num_zones = POLYINDEX_MAX_POLYGONS;
+
+	for (uint16_t i = 0; i < num_zones; i++) {
+		GeoFenceZoneData zone;
+		GeoFenceZoneInstGet(i, &zone);
+
+		if (zone.Type == GEOFENCEZONE_TYPE_KEEPIN)
+			zones->keep_in |= 1 << i;
+		else if (zone.Type == GEOFENCEZONE_TYPE_KEEPOUT)
+			zones->keep_out |= 1 << i;
+		else
+			continue;
+
+		enabled |= 1 << i;
+
+		if (zone.Ceiling > zone.Floor) {
+			zones->alt_limited |= 1 << i;
+			zones->floor[i] = zone.Floor;
+			zones->ceiling[i] = zone.Ceiling;
 		}
 	}
+
+	polyindex_reset(index);
+
+	uint16_t num_vertices = UAVObjGetNumInstances(GeoFenceVertexHandle());
+	uint16_t has_vertices = 0;
+
+	for (uint16_t i = 0; i < num_vertices; i++) {
+		GeoFenceVertexData vertex;
+		GeoFenceVertexInstGet(i, &vertex);
+
+		if (vertex.Zone >= POLYINDEX_MAX_POLYGONS || !(enabled & (1 << vertex.Zone)))
+			continue;
+
+		if (polyindex_add_vertex(index, vertex.Zone,
+				vertex.Position[GEOFENCEVERTEX_POSITION_NORTH],
+				vertex.Position[GEOFENCEVERTEX_POSITION_EAST]))
+			has_vertices |= 1 << vertex.Zone;
+	}
+
+	// An enabled zone without an outline can't be checked against
+	zones->keep_in &= has_vertices;
+	zones->keep_out &= has_vertices;
+
+	polyindex_build(index);
+}
+
+/**
+ * Zones or their outlines changed; rebuild before the next check, so an
+ * upload of many vertices costs a single rebuild.
+ */
+static void zonesUpdated(UAVObjEvent* ev, void *ctx, void *obj, int len)
+{
+	(void) ev; (void) ctx; (void) obj; (void) len;
+	zones_dirty = true;
 }
 
 /**
@@ -150,8 +302,8 @@ static void settingsUpdated(UAVObjEvent* ev, void *ctx, void *obj, int len)
 	GeoFenceSettingsGet(geofenceSettings);
 
 	// Cache squared distances to save computations
-	geofenceSettings->WarningRadius = powf(geofenceSettings->WarningRadius, 2);
-	geofenceSettings->ErrorRadius = powf(geofenceSettings->ErrorRadius, 2);
+	warningRadius2 = powf(geofenceSettings->WarningRadius, 2);
+	errorRadius2 = powf(geofenceSettings->ErrorRadius, 2);
 }
 
 /**
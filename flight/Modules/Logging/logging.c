@@ -73,6 +73,7 @@
 #include "pios_com_priv.h"
 
 #include <uavtalk.h>
+#include "uavtalk_priv.h"
 
 // Private constants
 #define STACK_SIZE_BYTES 1200
@@ -81,8 +82,59 @@ const char DIGITS[16] = "0123456789abcdef";
 
 #define LOGGING_PERIOD_MS 100
 
+// Delta compression of the fast, highly correlated objects
+#define LOG_DELTA_NUM_SLOTS 6
+#define LOG_DELTA_MAX_OBJ_BYTES 64
+// Samples between keys, so a log stays decodable past a damaged record
+#define LOG_DELTA_KEY_INTERVAL 128
+#define LOG_DELTA_KEY_HEADER 11
+#define LOG_DELTA_HEADER 7
+#define LOG_DELTA_MAX_RECORD (LOG_DELTA_KEY_HEADER + LOG_DELTA_MAX_OBJ_BYTES + \
+		LOG_DELTA_MAX_OBJ_BYTES / 8 + UAVTALK_CHECKSUM_LENGTH)
+
+// Index records written to each flash arena, at least once a second and
+// whenever the armed state or flight mode changes
+#define LOG_INDEX_PERIOD_MS 1000
+#define LOG_INDEX_RECORDS_PER_ARENA 12
+
 // Private types
 
+//! Entry of a compiled logging profile
+struct log_profile_entry {
+	UAVObjHandle (*handle)();
+	//! Multiple of the minimum logging period, 0 to log every change up to 100Hz
+	uint16_t decimation;
+	//! Delta compress the object when compression is enabled
+	bool compress;
+	//! Generated field sizes of the object, NULL to log the whole object
+	const uint16_t *field_sizes;
+	uint8_t num_fields;
+	//! FIELDBITs of the fields to log, as partial objects
+	uint32_t field_mask;
+};
+
+/* A delta slot is the callback context of its object, so the callback finds
+ * it without searching */
+struct log_delta_slot {
+	UAVObjHandle obj;
+	uint16_t since_key;
+	uint8_t last[LOG_DELTA_MAX_OBJ_BYTES];
+};
+
+//! Where a moment of the flight is in the log file
+struct log_index_record {
+	uint32_t timestamp;	/* ms since boot */
+	uint32_t offset;	/* bytes into the log file */
+	uint8_t armed;
+	uint8_t flight_mode;
+} __attribute__((packed));
+
+struct log_delta_state {
+	struct log_delta_slot slots[LOG_DELTA_NUM_SLOTS];
+	uint8_t num_slots;
+	uint8_t record[LOG_DELTA_MAX_RECORD];
+};
+
 // Private variables
 static UAVTalkConnection uavTalkCon;
 static struct pios_thread *loggingTaskHandle;
@@ -94,25 +146,87 @@ static LoggingStatsData loggingData;
 static void    loggingTask(void *parameters);
 static int32_t send_data(uint8_t *data, int32_t length);
 static int32_t send_data_nonblock(void *ctx, uint8_t *data, int32_t length);
+static uint8_t *reserve_data(void *ctx, int32_t length);
+static int32_t commit_data(void *ctx, int32_t length);
 static uint16_t get_minimum_logging_period();
 static void unregister_object(UAVObjHandle obj);
 static void register_object(UAVObjHandle obj);
 static void register_default_profile();
+static void unregister_default_profile();
 static void logAll(UAVObjHandle obj);
 static void logSettings(UAVObjHandle obj);
 static void writeHeader();
 static void updateSettings();
+static void log_delta_reset();
+static void log_delta_unregister();
+static struct log_delta_slot *log_delta_assign(UAVObjHandle obj);
+static bool log_delta(struct log_delta_slot *slot, const uint8_t *data, int len);
+#ifdef PIOS_INCLUDE_LOG_TO_FLASH
+static void log_index_reset();
+static void log_index_update();
+#endif
 
 // Local variables
 static uintptr_t logging_com_id;
 static uint32_t written_bytes;
+static uint32_t dropped_bytes;
 static bool destination_onboard_flash;
+static struct log_delta_state *log_delta_state;
+static bool log_delta_enabled;
+#ifdef PIOS_INCLUDE_LOG_TO_FLASH
+static uint32_t log_start_bytes;
+static struct log_index_record log_index_last;
+#endif
+
+static const uint16_t manual_control_sizes[] = MANUALCONTROLCOMMAND_FIELDSIZES;
+static const uint16_t attitude_sizes[] = ATTITUDEACTUAL_FIELDSIZES;
+
+//! Objects of the basic profile, looked up once when logging starts
+static const struct log_profile_entry basic_profile[] = {
+	// Log all changes
+	{ FlightStatusHandle, 0 },
+	{ SystemAlarmsHandle, 0 },
+	{ WaypointActiveHandle, 0 },
+	{ SystemIdentHandle, 0 },
+
+	// Log fast
+	{ AccelsHandle, 1, true },
+	{ GyrosHandle, 1, true },
+
+	// Log a bit slower
+	{ AttitudeActualHandle, 5, false, attitude_sizes, NELEMENTS(attitude_sizes),
+		ATTITUDEACTUAL_ROLL_FIELDBIT | ATTITUDEACTUAL_PITCH_FIELDBIT |
+		ATTITUDEACTUAL_YAW_FIELDBIT },
+	{ MagnetometerHandle, 5 },
+	{ ManualControlCommandHandle, 5, false, manual_control_sizes, NELEMENTS(manual_control_sizes),
+		MANUALCONTROLCOMMAND_CONNECTED_FIELDBIT | MANUALCONTROLCOMMAND_THROTTLE_FIELDBIT |
+		MANUALCONTROLCOMMAND_ROLL_FIELDBIT | MANUALCONTROLCOMMAND_PITCH_FIELDBIT |
+		MANUALCONTROLCOMMAND_YAW_FIELDBIT | MANUALCONTROLCOMMAND_RSSI_FIELDBIT |
+		MANUALCONTROLCOMMAND_COLLECTIVE_FIELDBIT | MANUALCONTROLCOMMAND_ARMSWITCH_FIELDBIT },
+	{ ActuatorDesiredHandle, 5 },
+	{ StabilizationDesiredHandle, 5 },
+
+	// Log slow
+	{ FlightBatteryStateHandle, 10 },
+	{ BaroAltitudeHandle, 10 },
+	{ AirspeedActualHandle, 10 },
+	{ GPSPositionHandle, 10 },
+	{ PositionActualHandle, 10 },
+	{ VelocityActualHandle, 10 },
+
+	// Log very slow
+	{ GPSTimeHandle, 50 },
+
+	// Log very very slow
+	{ GPSSatellitesHandle, 500 },
+};
 
 #ifdef PIOS_INCLUDE_LOG_TO_FLASH
 static const struct streamfs_cfg streamfs_settings = {
-	.fs_magic      = 0x89abceef,
+	.fs_magic      = 0x89abcef0,
 	.arena_size    = PIOS_LOGFLASH_SECT_SIZE,
 	.write_size    = 0x00000100, /* 256 bytes */
+	.index_size    = LOG_INDEX_RECORDS_PER_ARENA * sizeof(struct log_index_record),
 };
 #endif
 
@@ -187,6 +301,8 @@ int32_t LoggingInitialize(void)
 		module_enabled = false;
 		return -1;
 	}
+
+	UAVTalkSetDirectOutput(uavTalkCon, &reserve_data, &commit_data);
 	
 	return 0;
 }
@@ -230,6 +346,7 @@ static void loggingTask(void *parameters)
 
 	LoggingStatsGet(&loggingData);
 	loggingData.BytesLogged = 0;
+	loggingData.BytesDropped = 0;
 	
 #ifdef PIOS_INCLUDE_LOG_TO_FLASH
 	if (destination_onboard_flash) {
@@ -295,6 +412,8 @@ static void loggingTask(void *parameters)
 		case LOGGINGSTATS_OPERATION_INITIALIZING:
 			// Unregister all objects
 			UAVObjIterate(&unregister_object);
+			unregister_default_profile();
+			log_delta_unregister();
 #ifdef PIOS_INCLUDE_LOG_TO_FLASH
 			if (destination_onboard_flash){
 				// Close the file if it is open for reading
@@ -314,6 +433,8 @@ static void loggingTask(void *parameters)
 					loggingData.MinFileId = PIOS_STREAMFS_MinFileId(logging_com_id);
 					loggingData.MaxFileId = PIOS_STREAMFS_MaxFileId(logging_com_id);
 					LoggingStatsSet(&loggingData);
+
+					log_index_reset();
 				}
 			}
 			else {
@@ -324,6 +445,7 @@ static void loggingTask(void *parameters)
 
 			// Write information at start of the log file
 			writeHeader();
+			log_delta_reset();
 
 			// Log settings
 			if (settings.InitiallyLog == LOGGINGSETTINGS_INITIALLYLOG_ALLOBJECTS) {
@@ -345,6 +467,7 @@ static void loggingTask(void *parameters)
 
 			// Empty the queue
 			LoggingStatsBytesLoggedSet(&written_bytes);
+			LoggingStatsBytesDroppedSet(&dropped_bytes);
 			loggingData.Operation = LOGGINGSTATS_OPERATION_LOGGING;
 			LoggingStatsSet(&loggingData);
 			break;
@@ -353,7 +476,14 @@ static void loggingTask(void *parameters)
 				// Sleep between updating stats.
 				PIOS_Thread_Sleep_Until(&now, LOGGING_PERIOD_MS);
 
+#ifdef PIOS_INCLUDE_LOG_TO_FLASH
+				if (destination_onboard_flash) {
+					log_index_update();
+				}
+#endif
+
 				LoggingStatsBytesLoggedSet(&written_bytes);
+				LoggingStatsBytesDroppedSet(&dropped_bytes);
 
 				now = PIOS_Thread_Systime();
 			}
@@ -375,7 +505,11 @@ static void loggingTask(void *parameters)
 					memcpy(loggingData.FileSector, read_data, LOGGINGSTATS_FILESECTOR_NUMELEM);
 					loggingData.Operation = LOGGINGSTATS_OPERATION_IDLE;
 
-				} else if (read_open && (read_sector + 1) == loggingData.FileSectorNum) {
+				} else if (read_open && ((read_sector + 1) == loggingData.FileSectorNum ||
+						PIOS_STREAMFS_Seek(logging_com_id, loggingData.FileSectorNum *
+							LOGGINGSTATS_FILESECTOR_NUMELEM) == 0)) {
+					// Sectors are read in order, or seeked to when the
+					// GCS only wants part of the file
 					int32_t bytes_read = PIOS_STREAMFS_Read(logging_com_id, loggingData.FileSector, LOGGINGSTATS_FILESECTOR_NUMELEM);
 					if (bytes_read < 0) {
 						// close on error
@@ -448,8 +582,10 @@ static void logSettings(UAVObjHandle obj)
 
 static int32_t send_data(uint8_t *data, int32_t length)
 {
-	if (PIOS_COM_SendBuffer(logging_com_id, data, length) < 0)
+	if (PIOS_COM_SendBuffer(logging_com_id, data, length) < 0) {
+		dropped_bytes += length;
 		return -1;
+	}
 
 	written_bytes += length;
 
@@ -467,30 +603,284 @@ static int32_t send_data_nonblock(void *ctx, uint8_t *data, int32_t length)
 {
 	(void) ctx;
 
-	if (PIOS_COM_SendBufferNonBlocking(logging_com_id, data, length) < 0)
+	if (PIOS_COM_SendBufferNonBlocking(logging_com_id, data, length) < 0) {
+		// The destination isn't keeping up with the log rate
+		dropped_bytes += length;
 		return -1;
+	}
 
 	written_bytes += length;
 
 	return length;
 }
 
+/**
+ * Reserve room for a whole UAVTalk frame in the log's transmit queue
+ * \param[in] length Length of the frame
+ * \return where to build the frame, or NULL to send it via send_data_nonblock
+ */
+static uint8_t *reserve_data(void *ctx, int32_t length)
+{
+	(void) ctx;
+
+	return PIOS_COM_ReserveBuffer(logging_com_id, length);
+}
+
+/**
+ * Send a frame built by reserve_data
+ * \param[in] length Length of the frame
+ * \return number of bytes sent
+ */
+static int32_t commit_data(void *ctx, int32_t length)
+{
+	(void) ctx;
+
+	written_bytes += length;
+
+	return PIOS_COM_CommitBuffer(logging_com_id, length);
+}
+
 /**
  * @brief Callback for adding an object to the logging queue
  * @param ev the event
  */
 static void obj_updated_callback(UAVObjEvent * ev, void* cb_ctx, void *uavo_data, int uavo_len)
 {
-	(void) cb_ctx; (void) uavo_data; (void) uavo_len;
-
 	if (loggingData.Operation != LOGGINGSTATS_OPERATION_LOGGING){
 		// We are not logging, so all events are discarded
 		return;
 	}
 
-	UAVTalkSendObjectTimestamped(uavTalkCon, ev->obj, ev->instId);
+	// Objects with a delta slot are connected with it as their context
+	if (cb_ctx && log_delta(cb_ctx, uavo_data, uavo_len)) {
+		return;
+	}
+
+	// Send from the data passed in, it is the object's own
+	UAVTalkSendObjectData(uavTalkCon, ev->obj, ev->instId, uavo_data, true);
+}
+
+/**
+ * @brief Callback for objects of which only some fields are logged
+ * @param ev the event
+ * @param cb_ctx the object's profile entry
+ */
+static void obj_partial_callback(UAVObjEvent * ev, void* cb_ctx, void *uavo_data, int uavo_len)
+{
+	const struct log_profile_entry *entry = cb_ctx;
+
+	if (loggingData.Operation != LOGGINGSTATS_OPERATION_LOGGING){
+		return;
+	}
+
+	UAVTalkSendObjectPartial(uavTalkCon, ev->obj, ev->instId,
+			entry->field_sizes, entry->num_fields, entry->field_mask, true,
+			uavo_data);
 }
 
+/**
+ * Start a new log with no delta slots; they are assigned as the profile's
+ * objects are registered.  The state is allocated the first time
+ * compression is enabled.
+ */
+static void log_delta_reset()
+{
+	log_delta_enabled = false;
+
+	if (settings.Compression != LOGGINGSETTINGS_COMPRESSION_DELTA) {
+		return;
+	}
+
+	if (!log_delta_state) {
+		log_delta_state = PIOS_malloc(sizeof(*log_delta_state));
+		if (!log_delta_state) {
+			return;
+		}
+	}
+
+	log_delta_state->num_slots = 0;
+	log_delta_enabled = true;
+}
+
+/**
+ * Disconnect the objects registered with a delta slot as context
+ */
+static void log_delta_unregister()
+{
+	if (!log_delta_state) {
+		return;
+	}
+
+	for (int i = 0; i < log_delta_state->num_slots; i++) {
+		struct log_delta_slot *slot = &log_delta_state->slots[i];
+
+		UAVObjDisconnectCallback(slot->obj, obj_updated_callback, slot);
+	}
+
+	log_delta_state->num_slots = 0;
+}
+
+/**
+ * Assign a delta slot to an object, so its first sample is logged as a key
+ * \param[in] obj Object to compress
+ * \return the slot, to connect the object with, or NULL if the object is
+ * logged plainly
+ */
+static struct log_delta_slot *log_delta_assign(UAVObjHandle obj)
+{
+	if (!log_delta_enabled || !obj ||
+			log_delta_state->num_slots >= LOG_DELTA_NUM_SLOTS ||
+			!UAVObjIsSingleInstance(obj) ||
+			UAVObjGetNumBytes(obj) > LOG_DELTA_MAX_OBJ_BYTES) {
+		return NULL;
+	}
+
+	struct log_delta_slot *slot =
+		&log_delta_state->slots[log_delta_state->num_slots++];
+
+	slot->obj = obj;
+	slot->since_key = LOG_DELTA_KEY_INTERVAL;
+
+	return slot;
+}
+
+/**
+ * XOR a sample against the previous one and pack the result: for each
+ * group of 8 bytes, a bitmap of the non-zero bytes followed by those bytes.
+ * Unchanged sign/exponent bytes of floats and high bytes of slowly moving
+ * values cost one bit each.
+ * \return length of the packed delta
+ */
+static int32_t log_delta_pack(uint8_t *out, const uint8_t *last,
+		const uint8_t *data, int len)
+{
+	int32_t out_len = 0;
+
+	for (int i = 0; i < len; i += 8) {
+		uint8_t *mask = &out[out_len++];
+		*mask = 0;
+
+		for (int j = 0; j < 8 && (i + j) < len; j++) {
+			uint8_t delta = data[i + j] ^ last[i + j];
+
+			if (delta) {
+				*mask |= 1 << j;
+				out[out_len++] = delta;
+			}
+		}
+	}
+
+	return out_len;
+}
+
+/**
+ * Log an update of a compressed object as a key or as a delta against the
+ * last logged sample.  Object callbacks are serialized by the object
+ * manager lock, so the slots need no locking of their own.
+ * \param[in] slot Delta slot of the updated object
+ * \param[in] data Object data
+ * \param[in] len Length of the object data
+ * \return true if the update was handled, false if it should be logged as
+ * a plain object
+ */
+static bool log_delta(struct log_delta_slot *slot, const uint8_t *data, int len)
+{
+	UAVObjHandle obj = slot->obj;
+	uint8_t slot_num = slot - log_delta_state->slots;
+
+	if (!data || len != UAVObjGetNumBytes(obj)) {
+		return false;
+	}
+
+	uint8_t *buf = log_delta_state->record;
+	uint32_t time = PIOS_Thread_Systime();
+	int32_t length = -1;
+
+	if (slot->since_key < LOG_DELTA_KEY_INTERVAL) {
+		length = log_delta_pack(&buf[LOG_DELTA_HEADER], slot->last, data, len);
+	}
+
+	if (length >= 0 && length < len) {
+		buf[1] = UAVTALK_TYPE_LOG_DELTA;
+		buf[4] = slot_num;
+		buf[5] = (uint8_t)(time & 0xFF);
+		buf[6] = (uint8_t)((time >> 8) & 0xFF);
+		length += LOG_DELTA_HEADER;
+		slot->since_key++;
+	} else {
+		uint32_t obj_id = UAVObjGetID(obj);
+
+		buf[1] = UAVTALK_TYPE_LOG_KEY;
+		buf[4] = (uint8_t)(obj_id & 0xFF);
+		buf[5] = (uint8_t)((obj_id >> 8) & 0xFF);
+		buf[6] = (uint8_t)((obj_id >> 16) & 0xFF);
+		buf[7] = (uint8_t)((obj_id >> 24) & 0xFF);
+		buf[8] = slot_num;
+		buf[9] = (uint8_t)(time & 0xFF);
+		buf[10] = (uint8_t)((time >> 8) & 0xFF);
+		memcpy(&buf[LOG_DELTA_KEY_HEADER], data, len);
+		length = LOG_DELTA_KEY_HEADER + len;
+		slot->since_key = 0;
+	}
+
+	buf[0] = UAVTALK_SYNC_VAL;
+	buf[2] = (uint8_t)(length & 0xFF);
+	buf[3] = (uint8_t)((length >> 8) & 0xFF);
+	buf[length] = PIOS_CRC_updateCRC(0, buf, length);
+
+	if (send_data_nonblock(NULL, buf, length + UAVTALK_CHECKSUM_LENGTH) < 0) {
+		// The reader never saw this sample, so the next one can't
+		// be a delta against it
+		slot->since_key = LOG_DELTA_KEY_INTERVAL;
+	}
+
+	memcpy(slot->last, data, len);
+
+	return true;
+}
+
+
+#ifdef PIOS_INCLUDE_LOG_TO_FLASH
+/**
+ * Start indexing a new log file, with a record as soon as logging starts
+ */
+static void log_index_reset()
+{
+	log_start_bytes = written_bytes;
+	memset(&log_index_last, 0xFF, sizeof(log_index_last));
+}
+
+/**
+ * Add an index record when the armed state or flight mode changed, or a
+ * while after the last one.  The offset counts what was queued to the file,
+ * so it may be a little ahead of the data in flash; readers look for the
+ * next sync byte.
+ */
+static void log_index_update()
+{
+	FlightStatusData flight_status;
+	FlightStatusGet(&flight_status);
+
+	struct log_index_record record = {
+		.timestamp = PIOS_Thread_Systime(),
+		.offset = written_bytes - log_start_bytes,
+		.armed = flight_status.Armed,
+		.flight_mode = flight_status.FlightMode,
+	};
+
+	if (record.armed == log_index_last.armed &&
+			record.flight_mode == log_index_last.flight_mode &&
+			(record.timestamp - log_index_last.timestamp) < LOG_INDEX_PERIOD_MS) {
+		return;
+	}
+
+	// A full index area is retried on the next period, in the next arena
+	if (PIOS_STREAMFS_WriteIndex(logging_com_id, (const uint8_t *) &record,
+				sizeof(record)) == 0) {
+		log_index_last = record;
+	}
+}
+#endif /* PIOS_INCLUDE_LOG_TO_FLASH */
 
 /**
  * Get the minimum logging period in milliseconds
@@ -572,12 +962,18 @@ static void register_object(UAVObjHandle obj)
 
 	period = MAX(period, get_minimum_logging_period());
 
+	void *ctx = NULL;
+	if (obj == GyrosHandle() || obj == AccelsHandle() ||
+			obj == ActuatorCommandHandle()) {
+		ctx = log_delta_assign(obj);
+	}
+
 	if (period == 1) {
 		// log every update
-		UAVObjConnectCallback(obj, obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED);
+		UAVObjConnectCallback(obj, obj_updated_callback, ctx, EV_UPDATED | EV_UNPACKED);
 	} else {
 		// log updates throttled
-		UAVObjConnectCallbackThrottled(obj, obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, period);
+		UAVObjConnectCallbackThrottled(obj, obj_updated_callback, ctx, EV_UPDATED | EV_UNPACKED, period);
 	}
 }
 
@@ -589,60 +985,43 @@ static void register_default_profile()
 	// For the default profile, we limit things to 100Hz (for now)
 	uint16_t min_period = MAX(get_minimum_logging_period(), 10);
 
-	// Objects for which we log all changes (use 100Hz to limit max data rate)
-	UAVObjConnectCallbackThrottled(FlightStatusHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10);
-	UAVObjConnectCallbackThrottled(SystemAlarmsHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10);
-	if (WaypointActiveHandle()) {
-		UAVObjConnectCallbackThrottled(WaypointActiveHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10);
-	}
-
-	if (SystemIdentHandle()){
-		UAVObjConnectCallbackThrottled(SystemIdentHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10);
-	}
+	for (int i = 0; i < NELEMENTS(basic_profile); i++) {
+		const struct log_profile_entry *entry = &basic_profile[i];
+		UAVObjHandle obj = entry->handle();
 
-	// Log fast
-	UAVObjConnectCallbackThrottled(AccelsHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, min_period);
-	UAVObjConnectCallbackThrottled(GyrosHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, min_period);
+		if (!obj) {
+			continue;
+		}
 
-	// Log a bit slower
-	UAVObjConnectCallbackThrottled(AttitudeActualHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 5 * min_period);
+		uint16_t period = entry->decimation ? entry->decimation * min_period : 10;
 
-	if (MagnetometerHandle()) {
-		UAVObjConnectCallbackThrottled(MagnetometerHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 5 * min_period);
-	}
+		if (entry->field_sizes) {
+			UAVObjConnectCallbackThrottled(obj, obj_partial_callback,
+					(void *) entry, EV_UPDATED | EV_UNPACKED, period);
+			continue;
+		}
 
-	UAVObjConnectCallbackThrottled(ManualControlCommandHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 5 * min_period);
-	UAVObjConnectCallbackThrottled(ActuatorDesiredHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 5 * min_period);
-	UAVObjConnectCallbackThrottled(StabilizationDesiredHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 5 * min_period);
+		void *ctx = NULL;
+		if (entry->compress) {
+			ctx = log_delta_assign(obj);
+		}
 
-	// Log slow
-	if (FlightBatteryStateHandle()) {
-		UAVObjConnectCallbackThrottled(FlightBatteryStateHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10 * min_period);
-	}
-	if (BaroAltitudeHandle()) {
-		UAVObjConnectCallbackThrottled(BaroAltitudeHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10 * min_period);
-	}
-	if (AirspeedActualHandle()) {
-		UAVObjConnectCallbackThrottled(AirspeedActualHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10 * min_period);
-	}
-	if (GPSPositionHandle()) {
-		UAVObjConnectCallbackThrottled(GPSPositionHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10 * min_period);
-	}
-	if (PositionActualHandle()) {
-		UAVObjConnectCallbackThrottled(PositionActualHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10 * min_period);
-	}
-	if (VelocityActualHandle()) {
-		UAVObjConnectCallbackThrottled(VelocityActualHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 10 * min_period);
+		UAVObjConnectCallbackThrottled(obj, obj_updated_callback, ctx, EV_UPDATED | EV_UNPACKED, period);
 	}
+}
 
-	// Log very slow
-	if (GPSTimeHandle()) {
-		UAVObjConnectCallbackThrottled(GPSTimeHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 50 * min_period);
-	}
+/**
+ * Disconnect the objects of the default profile logged as partial objects
+ */
+static void unregister_default_profile()
+{
+	for (int i = 0; i < NELEMENTS(basic_profile); i++) {
+		const struct log_profile_entry *entry = &basic_profile[i];
+		UAVObjHandle obj = entry->handle();
 
-	// Log very very slow
-	if (GPSSatellitesHandle()) {
-		UAVObjConnectCallbackThrottled(GPSSatellitesHandle(), obj_updated_callback, NULL, EV_UPDATED | EV_UNPACKED, 500 * min_period);
+		if (obj && entry->field_sizes) {
+			UAVObjDisconnectCallback(obj, obj_partial_callback, (void *) entry);
+		}
 	}
 }
 
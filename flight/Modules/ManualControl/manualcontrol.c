@@ -195,7 +195,8 @@ static void manualControlTask(void *parameters)
 			break;
 		}
 
-		// Wait until next update
+		// Run again as soon as a receiver frame arrives; the period
+		// keeps the failsafe logic going when none do
 		PIOS_RCVR_WaitActivity(UPDATE_PERIOD_MS);
 		PIOS_WDG_UpdateFlag(PIOS_WDG_MANUAL);
 	}
@@ -37,6 +37,7 @@
 #include "tablet_control.h"
 #include "transmitter_control.h"
 #include "physical_constants.h"
+#include "coordinate_conversions.h"
 
 #include "flightstatus.h"
 #include "gpsposition.h"
@@ -202,22 +203,14 @@ enum control_events tablet_control_get_events()
  */
 static int32_t tabletInfo_to_ned(TabletInfoData *tabletInfo, float *NED)
 {
-	// TODO: Abstract out this code and also precompute the part based
-	// on home location.
-
 	HomeLocationData homeLocation;
 	HomeLocationGet(&homeLocation);
 
 	GPSPositionData gpsPosition;
 	GPSPositionGet(&gpsPosition);
 
-	float lat = homeLocation.Latitude / 10.0e6f * DEG2RAD;
-	float alt = homeLocation.Altitude;
-
-	float T[3];
-	T[0] = alt+6.378137E6f;
-	T[1] = cosf(lat)*(alt+6.378137E6f);
-	T[2] = -1.0f;
+	struct home_frame home;
+	home_frame_init(&home, homeLocation.Latitude, homeLocation.Longitude, homeLocation.Altitude);
 
 	// Tablet altitude is in WSG84 but we use height above the geoid elsewhere so use the
 	// GPS GeoidSeparation as a proxy
@@ -226,13 +219,10 @@ static int32_t tabletInfo_to_ned(TabletInfoData *tabletInfo, float *NED)
 	// and https://code.google.com/p/android/issues/detail?id=53471
 	// This means that "(tabletInfo->Altitude + gpsPosition.GeoidSeparation - homeLocation.Altitude)"
 	// will be correct or incorrect depending on the device.
-	float dL[3] = {(tabletInfo->Latitude - homeLocation.Latitude) / 10.0e6f * DEG2RAD,
-		(tabletInfo->Longitude - homeLocation.Longitude) / 10.0e6f * DEG2RAD,
-		(tabletInfo->Altitude + gpsPosition.GeoidSeparation - homeLocation.Altitude)};
+	float alt = tabletInfo->Altitude + gpsPosition.GeoidSeparation;
 
-	NED[0] = T[0] * dL[0];
-	NED[1] = T[1] * dL[1];
-	NED[2] = T[2] * dL[2];
+	lla_to_ned_batch(&home, &tabletInfo->Latitude, &tabletInfo->Longitude, &alt,
+			(float (*)[3])NED, 1);
 
 	return 0;
 }
@@ -1246,7 +1246,7 @@ void brainre1_menu(void)
 
 	if ((current_state == FSM_STATE_RE1_SAVEEXIT) && (current_event == FSM_EVENT_RIGHT)) {
 		// Save and exit
-		UAVObjSave(HwBrainRE1Handle(), 0);
+		UAVObjSaveDeferred(HwBrainRE1Handle(), 0);
 	}
 }
 #endif /* defined(USE_STM32F4xx_BRAINFPVRE1) */
@@ -1400,7 +1400,7 @@ void rgbled_menu(void)
 
 		if ((current_state == FSM_STATE_RGB_SAVEEXIT) && (current_event == FSM_EVENT_RIGHT)) {
 			// Save and exit
-			UAVObjSave(RGBLEDSettingsHandle(), 0);
+			UAVObjSaveDeferred(RGBLEDSettingsHandle(), 0);
 		}
 	}
 	else {
@@ -1493,7 +1493,7 @@ void filter_menu(void)
 
 	if ((current_state == FSM_STATE_FILTER_SAVEEXIT) && (current_event == FSM_EVENT_RIGHT)) {
 		// Save and exit
-		UAVObjSave(StateEstimationHandle(), 0);
+		UAVObjSaveDeferred(StateEstimationHandle(), 0);
 	}
 }
 
@@ -1593,7 +1593,7 @@ void flightmode_menu(void)
 
 	if ((current_state == FSM_STATE_FMODE_SAVEEXIT) && (current_event == FSM_EVENT_RIGHT)) {
 		// Save and exit
-		UAVObjSave(ManualControlSettingsHandle(), 0);
+		UAVObjSaveDeferred(ManualControlSettingsHandle(), 0);
 	}
 }
 
@@ -1723,7 +1723,7 @@ void pidrate_menu(void)
 	if (current_state == FSM_STATE_PIDRATE_SAVEEXIT) {
 		draw_selected_icon(MENU_LINE_X - 4, y_pos + 4);
 		if (current_event == FSM_EVENT_RIGHT)
-			UAVObjSave(StabilizationSettingsHandle(), 0);
+			UAVObjSaveDeferred(StabilizationSettingsHandle(), 0);
 	}
 	
 	y_pos += MENU_LINE_SPACING;
@@ -1800,7 +1800,7 @@ void pidatt_menu(void)
 	if (current_state == FSM_STATE_PIDATT_SAVEEXIT) {
 		draw_selected_icon(MENU_LINE_X - 4, y_pos + 4);
 		if (current_event == FSM_EVENT_RIGHT)
-			UAVObjSave(StabilizationSettingsHandle(), 0);
+			UAVObjSaveDeferred(StabilizationSettingsHandle(), 0);
 	}
 
 	y_pos += MENU_LINE_SPACING;
@@ -1981,7 +1981,7 @@ void sticklimits_menu(void)
 	if (current_state == FSM_STATE_STICKLIMITS_SAVEEXIT) {
 		draw_selected_icon(MENU_LINE_X - 4, y_pos + 4);
 		if (current_event == FSM_EVENT_RIGHT)
-			UAVObjSave(StabilizationSettingsHandle(), 0);
+			UAVObjSaveDeferred(StabilizationSettingsHandle(), 0);
 	}
 
 	y_pos += MENU_LINE_SPACING;
@@ -2167,7 +2167,7 @@ void vtx_menu()
 		draw_selected_icon(MENU_LINE_X - 4, y_pos + 4);
 		if (current_event == FSM_EVENT_RIGHT) {
 			VTXSettingsSet(&settings);
-			UAVObjSave(VTXSettingsHandle(), 0);
+			UAVObjSaveDeferred(VTXSettingsHandle(), 0);
 		}
 	}
 
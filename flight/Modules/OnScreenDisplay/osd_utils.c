@@ -67,56 +67,49 @@ void clearGraphics()
 #endif /* defined(PIOS_VIDEO_SPLITBUFFER) */
 }
 
+/**
+ * OR a row of image bytes into the buffer, shifted right by bit_offset.
+ * Each buffer byte is written once: the bits that a source byte shifts out
+ * are carried into the next one.
+ */
+static void blit_row(uint8_t *dst, const uint8_t *src, uint8_t len, uint8_t bit_offset)
+{
+	if (bit_offset == 0) {
+		for (uint8_t i = 0; i < len; i++)
+			dst[i] |= src[i];
+
+		return;
+	}
+
+	uint8_t carry = 0;
+
+	for (uint8_t i = 0; i < len; i++) {
+		dst[i] |= carry | (src[i] >> bit_offset);
+		carry = src[i] << (8 - bit_offset);
+	}
+
+	dst[len] |= carry;
+}
+
 void draw_image(uint16_t x, uint16_t y, const struct Image * image)
 {
 #if defined(PIOS_VIDEO_SPLITBUFFER)
 	CHECK_COORDS(x + image->width, y + image->height);
 	uint8_t byte_width = image->width / 8;
-	uint8_t pixel_offset = x % 8;
-	uint8_t mask1 = 0xFF;
-	uint8_t mask2 = 0x00;
-
-	if (pixel_offset > 0) {
-		for (uint8_t i = 0; i<pixel_offset; i++) {
-			mask2 |= 0x01 << i;
-		}
-		mask1 = ~mask2;
-	}
 
 	for (uint16_t yp = 0; yp < image->height; yp++) {
-		for (uint16_t xp = 0; xp < image->width / 8; xp++) {
-			draw_buffer_level[(y + yp) * BUFFER_WIDTH + xp + x / 8] |= (image->level[yp * byte_width + xp] & mask1) >> pixel_offset;
-			draw_buffer_mask[(y + yp) * BUFFER_WIDTH + xp + x / 8] |= (image->mask[yp * byte_width + xp] & mask1) >> pixel_offset;
-			if (pixel_offset > 0) {
-				draw_buffer_level[(y + yp) * BUFFER_WIDTH + xp + x / 8 + 1] |= (image->level[yp * byte_width + xp] & mask2) <<
-						(8 - pixel_offset);
-				draw_buffer_mask[(y + yp) * BUFFER_WIDTH + xp + x / 8 + 1] |= (image->mask[yp * byte_width + xp] & mask2) <<
-						(8 - pixel_offset);
-			}
-		}
+		blit_row(&draw_buffer_level[(y + yp) * BUFFER_WIDTH + x / 8],
+				&image->level[yp * byte_width], byte_width, x % 8);
+		blit_row(&draw_buffer_mask[(y + yp) * BUFFER_WIDTH + x / 8],
+				&image->mask[yp * byte_width], byte_width, x % 8);
 	}
 #else
 	CHECK_COORDS(x + image->width, y + image->height);
 	uint8_t byte_width = image->width / 4;
-	uint8_t pixel_offset = 2 * (x % 4);
-	uint8_t mask1 = 0xFF;
-	uint8_t mask2 = 0x00;
-
-	if (pixel_offset > 0) {
-		for (uint8_t i = 0; i<pixel_offset; i++) {
-			mask2 |= 0x01 << i;
-		}
-		mask1 = ~mask2;
-	}
 
 	for (uint16_t yp = 0; yp < image->height; yp++) {
-		for (uint16_t xp = 0; xp < byte_width; xp++) {
-			draw_buffer[(y + yp) * BUFFER_WIDTH + xp + x / 4] |= (image->data[yp * byte_width + xp] & mask1) >> pixel_offset;
-			if (pixel_offset > 0) {
-				draw_buffer[(y + yp) * BUFFER_WIDTH + xp + x / 4 + 1] |= (image->data[yp * byte_width + xp] & mask2) <<
-						(8 - pixel_offset);
-			}
-		}
+		blit_row(&draw_buffer[(y + yp) * BUFFER_WIDTH + x / 4],
+				&image->data[yp * byte_width], byte_width, 2 * (x % 4));
 	}
 #endif /* PIOS_VIDEO_SPLITBUFFER */
 }
@@ -1217,66 +1210,68 @@ void write_char(uint8_t ch, int x, int y, const struct FontEntry *font_info)
 	if (ch == 255)
 		return;
 
-	// check if char is partly out of boundary
-	uint8_t partly_out = (x < GRAPHICS_LEFT) || (x + font_info->width > GRAPHICS_RIGHT) || (y < GRAPHICS_TOP) || (y + font_info->height > GRAPHICS_BOTTOM);
-	// check if char is totally out of boundary, if so return
-	if (partly_out && ((x + font_info->width < GRAPHICS_LEFT) || (x > GRAPHICS_RIGHT) || (y + font_info->height < GRAPHICS_TOP) || (y > GRAPHICS_BOTTOM))) {
+	// A row is drawn whole or not at all, so a char sticking out left or
+	// right is skipped and one sticking out at the top or bottom is clipped
+	// to its visible rows, once for the whole glyph.
+	if ((x < GRAPHICS_LEFT) || (x + font_info->width > GRAPHICS_RIGHT))
+		return;
+
+	int y_start = (y < GRAPHICS_TOP) ? GRAPHICS_TOP : y;
+	int y_end = y + font_info->height;
+	if (y_end > GRAPHICS_BOTTOM + 1)
+		y_end = GRAPHICS_BOTTOM + 1;
+	if (y_start >= y_end)
 		return;
-	}
 
-	// Compute starting address of character
-	int addr = CALC_BUFF_ADDR(x, y);
+	// Compute starting address of the first visible row of the character
+	int addr = CALC_BUFF_ADDR(x, y_start);
 	int wbit = CALC_BIT_IN_WORD(x);
-	row = ch * font_info->height;
+	row = ch * font_info->height + (y_start - y);
 
 	if (font_info->width > 8) {
+		const uint32_t *glyph = (const uint32_t *)font_info->data + row;
 		uint32_t data;
-		for (yy = y; yy < y + font_info->height; yy++) {
-			if (!partly_out || ((x >= GRAPHICS_LEFT) && (x + font_info->width <= GRAPHICS_RIGHT) && (yy >= GRAPHICS_TOP) && (yy <= GRAPHICS_BOTTOM))) {
-				data = ((uint32_t*)font_info->data)[row];
+		for (yy = y_start; yy < y_end; yy++) {
+			data = *glyph++;
 #if defined(PIOS_VIDEO_SPLITBUFFER)
-				mask = data & 0xFFFF;
-				levels   = (data >> 16) & 0xFFFF;
-				// mask
-				write_word_misaligned_OR(draw_buffer_mask, mask, addr, wbit);
-				// level
-				write_word_misaligned_OR(draw_buffer_level, mask, addr, wbit);
-				mask = (mask & levels);
-				write_word_misaligned_NAND(draw_buffer_level, mask, addr, wbit);
+			mask = data & 0xFFFF;
+			levels   = (data >> 16) & 0xFFFF;
+			// mask
+			write_word_misaligned_OR(draw_buffer_mask, mask, addr, wbit);
+			// level
+			write_word_misaligned_OR(draw_buffer_level, mask, addr, wbit);
+			mask = (mask & levels);
+			write_word_misaligned_NAND(draw_buffer_level, mask, addr, wbit);
 #else
-				data16 = (data & 0xFFFF0000) >> 16;
-				mask = data16 | (data16 << 1);
-				write_word_misaligned_MASKED(draw_buffer, data16, mask, addr, wbit);
-				data16 = (data & 0x0000FFFF);
-				mask = data16 | (data16 << 1);
-				write_word_misaligned_MASKED(draw_buffer, data16, mask, addr + 2, wbit);
+			data16 = (data & 0xFFFF0000) >> 16;
+			mask = data16 | (data16 << 1);
+			write_word_misaligned_MASKED(draw_buffer, data16, mask, addr, wbit);
+			data16 = (data & 0x0000FFFF);
+			mask = data16 | (data16 << 1);
+			write_word_misaligned_MASKED(draw_buffer, data16, mask, addr + 2, wbit);
 #endif /* defined(PIOS_VIDEO_SPLITBUFFER) */
-			}
 			addr += BUFFER_WIDTH;
-			row++;
 		}
 	}
 	else {
+		const uint16_t *glyph = font_info->data + row;
 		uint16_t data;
-		for (yy = y; yy < y + font_info->height; yy++) {
-			if (!partly_out || ((x >= GRAPHICS_LEFT) && (x + font_info->width <= GRAPHICS_RIGHT) && (yy >= GRAPHICS_TOP) && (yy <= GRAPHICS_BOTTOM))) {
-				data = font_info->data[row];
+		for (yy = y_start; yy < y_end; yy++) {
+			data = *glyph++;
 #if defined(PIOS_VIDEO_SPLITBUFFER)
-				levels = data & 0xFF00;
-				mask = (data & 0x00FF) << 8;
-				// mask
-				write_word_misaligned_OR(draw_buffer_mask, mask, addr, wbit);
-				// level
-				write_word_misaligned_OR(draw_buffer_level, mask, addr, wbit);
-				mask = (mask & levels);
-				write_word_misaligned_NAND(draw_buffer_level, mask, addr, wbit);
+			levels = data & 0xFF00;
+			mask = (data & 0x00FF) << 8;
+			// mask
+			write_word_misaligned_OR(draw_buffer_mask, mask, addr, wbit);
+			// level
+			write_word_misaligned_OR(draw_buffer_level, mask, addr, wbit);
+			mask = (mask & levels);
+			write_word_misaligned_NAND(draw_buffer_level, mask, addr, wbit);
 #else
-				mask = data | (data << 1);
-				write_word_misaligned_MASKED(draw_buffer, data, mask, addr, wbit);
+			mask = data | (data << 1);
+			write_word_misaligned_MASKED(draw_buffer, data, mask, addr, wbit);
 #endif /* defined(PIOS_VIDEO_SPLITBUFFER) */
-			}
 			addr += BUFFER_WIDTH;
-			row++;
 		}
 	}
 }
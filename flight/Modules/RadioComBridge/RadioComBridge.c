@@ -58,8 +58,14 @@
 #include "baroaltitude.h"
 #include "modulesettings.h"
 
+// these objects are relayed over the radio ahead of everything else
+#include "gcsreceiver.h"
+#include "flighttelemetrystats.h"
+#include "gcstelemetrystats.h"
+
 #include "pios_thread.h"
 #include "pios_queue.h"
+#include "pios_mutex.h"
 
 #include <pios_hal.h>
 
@@ -73,6 +79,10 @@
 #define EVENT_QUEUE_SIZE  10
 #define MAX_PORT_DELAY    200
 #define PPM_INPUT_TIMEOUT 100
+#define HELD_FRAME_DELAY  5
+#define HELD_FRAME_BYTES  (2 * UAVTALK_MAX_PACKET_LENGTH)
+// Room in the radio transmit queue that only priority frames may use
+#define RADIO_TX_RESERVE  128
 
 // ****************
 // Private types
@@ -96,6 +106,12 @@ typedef struct {
 	// Error statistics.
 	uint32_t telemetryTxRetries;
 	uint32_t radioTxRetries;
+	uint32_t radioTxDropped;
+
+	// Frames waiting for the radio to catch up, back to back, oldest first.
+	struct pios_mutex *heldFrameLock;
+	uint8_t *heldFrames;
+	uint16_t heldFramesLength;
 
 	// Is this modem the coordinator
 	bool isCoordinator;
@@ -121,6 +137,7 @@ static void objectPersistenceUpdatedCb(UAVObjEvent * objEv, void *ctx,
 				void *obj, int len);
 static void registerObject(UAVObjHandle obj);
 static void updateSettings();
+static bool flushHeldFrames();
 
 // ****************
 // Private variables
@@ -230,9 +247,18 @@ static int32_t RadioComBridgeInitialize(void)
 	data->uavtalkEventQueue = PIOS_Queue_Create(EVENT_QUEUE_SIZE, sizeof(UAVObjEvent));
 	data->radioEventQueue = PIOS_Queue_Create(EVENT_QUEUE_SIZE, sizeof(UAVObjEvent));
 
+	// Room for frames held back from a backlogged radio.
+	data->heldFrameLock = PIOS_Mutex_Create();
+	data->heldFrames = PIOS_malloc(HELD_FRAME_BYTES);
+	data->heldFramesLength = 0;
+	if (!data->heldFrameLock || !data->heldFrames) {
+		return -1;
+	}
+
 	// Initialize the statistics.
 	data->telemetryTxRetries = 0;
 	data->radioTxRetries = 0;
+	data->radioTxDropped = 0;
 
 	return 0;
 }
@@ -281,6 +307,7 @@ static void updateRadioComBridgeStats()
 
 	radioComBridgeStats.TelemetryTxRetries = data->telemetryTxRetries;
 	radioComBridgeStats.RadioTxRetries = data->radioTxRetries;
+	radioComBridgeStats.RadioTxDropped = data->radioTxDropped;
 
 	// Update stats object
 	radioComBridgeStats.TelemetryTxBytes +=
@@ -437,12 +464,16 @@ static void telemetryRxTask( __attribute__ ((unused))
 			inputPort = PIOS_COM_TELEM_USB;
 		}
 #endif /* PIOS_INCLUDE_USB */
+		// Send on held frames once the radio has caught up, and keep
+		// checking back until it has.
+		bool held = flushHeldFrames();
+
 		if (inputPort) {
 			uint8_t serial_data[32];
 			uint16_t bytes_to_process =
 			    PIOS_COM_ReceiveBuffer(inputPort, serial_data,
 						   sizeof(serial_data),
-						   MAX_PORT_DELAY);
+						   held ? HELD_FRAME_DELAY : MAX_PORT_DELAY);
 			if (bytes_to_process > 0) {
 				PIOS_ANNUNC_Toggle(PIOS_LED_RX);
 				for (uint8_t i = 0; i < bytes_to_process;
@@ -518,9 +549,199 @@ static int32_t UAVTalkSendHandler(void *ctx, uint8_t * buf, int32_t length)
 	return ret;
 }
 
+/**
+ * Does a frame keep a link or a vehicle under control?  These go out as
+ * soon as they come in, whatever else is waiting for the radio.
+ *
+ * @param[in] buf The UAVTalk frame
+ * @return true if the frame is a priority frame
+ */
+static bool isPriorityFrame(const uint8_t *buf)
+{
+	uint8_t type = buf[1];
+
+	if (type == UAVTALK_TYPE_ACK || type == UAVTALK_TYPE_NACK) {
+		return true;
+	}
+
+	uint32_t objId = buf[4] | (buf[5] << 8) | (buf[6] << 16) |
+		((uint32_t) buf[7] << 24);
+
+	switch (objId) {
+	case GCSRECEIVER_OBJID:
+	case RFM22BRECEIVER_OBJID:
+	case FLIGHTTELEMETRYSTATS_OBJID:
+	case GCSTELEMETRYSTATS_OBJID:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Get the length of a UAVTalk frame from its header.
+ *
+ * @param[in] buf The UAVTalk frame
+ * @return the frame length, including the checksum
+ */
+static uint16_t frameLength(const uint8_t *buf)
+{
+	return (buf[2] | (buf[3] << 8)) + UAVTALK_CHECKSUM_LENGTH;
+}
+
+/**
+ * Is a frame a complete object update?  A newer update of the same object
+ * instance carries everything an older one does.
+ *
+ * @param[in] buf The UAVTalk frame
+ * @return true if the frame is an object update
+ */
+static bool isObjectUpdate(const uint8_t *buf)
+{
+	switch (buf[1]) {
+	case UAVTALK_TYPE_OBJ:
+	case UAVTALK_TYPE_OBJ_TS:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Does a new object update make a held one stale?
+ *
+ * @param[in] held The held frame
+ * @param[in] buf The new object update
+ * @param[in] length The new frame length
+ * @return true if both update the same object instance the same way
+ */
+static bool isSupersededBy(const uint8_t *held, const uint8_t *buf,
+		uint16_t length)
+{
+	if (held[1] != buf[1] || frameLength(held) != length ||
+			memcmp(&held[4], &buf[4], 4)) {
+		return false;
+	}
+
+	uint32_t objId = buf[4] | (buf[5] << 8) | (buf[6] << 16) |
+		((uint32_t) buf[7] << 24);
+	UAVObjHandle obj = UAVObjGetByID(objId);
+
+	if ((obj && UAVObjIsSingleInstance(obj)) ||
+			length < UAVTALK_MAX_HEADER_LENGTH) {
+		return true;
+	}
+
+	// Objects relayed without being known here are taken to have an
+	// instance field, so at worst an update isn't replaced.
+	return held[8] == buf[8] && held[9] == buf[9];
+}
+
+/**
+ * Can a frame other than a priority frame be queued for the radio without
+ * eating into the room kept for priority frames?
+ *
+ * @param[in] length The frame length
+ */
+static bool radioHasRoom(uint16_t length)
+{
+	return PIOS_COM_GetTxBytesFree(PIOS_COM_RFM22B) >=
+		length + RADIO_TX_RESERVE;
+}
+
+/**
+ * Send held frames on to the radio, oldest first, while there's room for
+ * them.  Must be called with heldFrameLock held.
+ *
+ * @param[in] needed Wait for the radio until this much room is free to
+ * hold another frame
+ * @return true if frames are still held
+ */
+static bool flushHeldFramesLocked(uint16_t needed)
+{
+	while (data->heldFramesLength) {
+		uint16_t length = frameLength(data->heldFrames);
+
+		if (!PIOS_COM_Available(PIOS_COM_RFM22B)) {
+			// The link went away; so does whatever was in flight.
+			data->radioTxDropped++;
+		} else if (radioHasRoom(length)) {
+			PIOS_COM_SendBuffer(PIOS_COM_RFM22B, data->heldFrames,
+					length);
+		} else if (HELD_FRAME_BYTES - data->heldFramesLength < needed) {
+#ifdef PIOS_INCLUDE_WDG
+			PIOS_WDG_UpdateFlag(PIOS_WDG_TELEMETRYRX);
+#endif
+			PIOS_Thread_Sleep(HELD_FRAME_DELAY);
+			continue;
+		} else {
+			return true;
+		}
+
+		data->heldFramesLength -= length;
+		memmove(data->heldFrames, data->heldFrames + length,
+				data->heldFramesLength);
+	}
+
+	return false;
+}
+
+/**
+ * Send held frames on to the radio while there's room for them.
+ *
+ * @return true if frames are still held
+ */
+static bool flushHeldFrames()
+{
+	if (!PIOS_COM_RFM22B) {
+		return false;
+	}
+
+	PIOS_Mutex_Lock(data->heldFrameLock, PIOS_MUTEX_TIMEOUT_MAX);
+	bool held = flushHeldFramesLocked(0);
+	PIOS_Mutex_Unlock(data->heldFrameLock);
+
+	return held;
+}
+
+/**
+ * Hold a frame back until the radio catches up.  An object update replaces
+ * a held update of the same object instance; otherwise this waits for room
+ * to hold the frame.  Must be called with heldFrameLock held.
+ *
+ * @param[in] buf The UAVTalk frame
+ * @param[in] length The frame length
+ */
+static void holdFrameLocked(const uint8_t *buf, uint16_t length)
+{
+	if (isObjectUpdate(buf)) {
+		for (uint16_t pos = 0; pos < data->heldFramesLength;
+				pos += frameLength(data->heldFrames + pos)) {
+			if (isSupersededBy(data->heldFrames + pos, buf, length)) {
+				memcpy(data->heldFrames + pos, buf, length);
+				data->radioTxDropped++;
+				return;
+			}
+		}
+	}
+
+	flushHeldFramesLocked(length);
+
+	memcpy(data->heldFrames + data->heldFramesLength, buf, length);
+	data->heldFramesLength += length;
+}
+
 /**
  * Transmit data buffer to the com port.
  *
+ * The radio is usually the slowest link, so frames for it are sent by
+ * priority rather than in the order they came in.  Priority frames always
+ * go straight to the radio, and room is kept for them in its transmit
+ * queue.  Other frames only use the rest of the queue.  Once that fills,
+ * they are held back in order until the radio catches up, and an object
+ * update still held when a newer one of the same instance comes in is
+ * dropped for it.
+ *
  * @param[in] buf Data buffer to send
  * @param[in] length Length of buffer
  * @return -1 on failure
@@ -528,16 +749,31 @@ static int32_t UAVTalkSendHandler(void *ctx, uint8_t * buf, int32_t length)
  */
 static int32_t RadioSendHandler(void *ctx, uint8_t * buf, int32_t length)
 {
-	(void) NULL;
+	(void) ctx;
 
 	uint32_t outputPort = PIOS_COM_RFM22B;
 
 	// Don't send any data unless the radio port is available.
-	if (outputPort && PIOS_COM_Available(outputPort)) {
+	if (!outputPort || !PIOS_COM_Available(outputPort)) {
+		return -1;
+	}
+
+	if (isPriorityFrame(buf)) {
 		return PIOS_COM_SendBuffer(outputPort, buf, length);
+	}
+
+	PIOS_Mutex_Lock(data->heldFrameLock, PIOS_MUTEX_TIMEOUT_MAX);
+
+	// Don't let a frame overtake those held before it.
+	if (!flushHeldFramesLocked(0) && radioHasRoom(length)) {
+		length = PIOS_COM_SendBuffer(outputPort, buf, length);
 	} else {
-		return -1;
+		holdFrameLocked(buf, length);
 	}
+
+	PIOS_Mutex_Unlock(data->heldFrameLock);
+
+	return length;
 }
 
 #define MetaObjectId(x) (x+1)
@@ -728,6 +964,21 @@ static void objectPersistenceUpdatedCb(UAVObjEvent * objEv, void *ctx,
 						       obj_per.
 						       InstanceID) == 0;
 				}
+#endif
+				break;
+			}
+		case OBJECTPERSISTENCE_OPERATION_SAVELIST:
+			{
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS)
+				uint16_t num_objs = 0;
+
+				// The list ends at the first unused entry
+				while (num_objs < OBJECTPERSISTENCE_OBJECTIDS_NUMELEM &&
+						obj_per.ObjectIDs[num_objs] != 0)
+					num_objs++;
+
+				success = UAVObjSaveListById(obj_per.ObjectIDs,
+						num_objs) == 0;
 #endif
 				break;
 			}
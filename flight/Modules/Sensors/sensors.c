@@ -36,6 +36,8 @@
 #include "pios_queue.h"
 #include "misc_math.h"
 #include "lpfilter.h"
+#include "notchfilter.h"
+#include "loopmonitor.h"
 
 #if defined(PIOS_INCLUDE_PX4FLOW)
 #include "pios_px4flow_priv.h"
@@ -56,6 +58,7 @@ extern uintptr_t external_i2c_adapter_id;
 #include "rangefinder.h"
 #include "inssettings.h"
 #include "magnetometer.h"
+#include "motorrpm.h"
 #include "magbias.h"
 #include "coordinate_conversions.h"
 
@@ -98,6 +101,8 @@ static void updateTemperatureComp(float temperature, float *temp_bias);
 // Private variables
 static struct pios_thread *sensorsTaskHandle;
 static INSSettingsData insSettings;
+static SensorSettingsData sensorSettings;
+static AttitudeSettingsData attitudeSettings;
 static AccelsData accelsData;
 
 // These values are initialized by settings but can be updated by the attitude algorithm
@@ -124,6 +129,12 @@ static int8_t rotate = 0;
 static enum mag_calibration_algo mag_calibration_algo = MAG_CALIBRATION_PRELEMARI;
 
 static lpfilter_state_t gyro_filter;
+static notchfilter_state_t gyro_notch;
+static bool gyro_notch_enabled;
+static rpmnotch_state_t motor_notch;
+static bool motor_notch_enabled;
+static volatile MotorRpmData motor_rpm;
+static uint16_t motor_notch_rpm[MOTORRPM_RPM_NUMELEM];
 static lpfilter_state_t accel_filter;
 
 /**
@@ -148,7 +159,8 @@ int32_t SensorsInitialize(void)
 		|| MagBiasInitialize() == -1 \
 		|| AttitudeSettingsInitialize() == -1 \
 		|| SensorSettingsInitialize() == -1 \
-		|| INSSettingsInitialize() == -1) {
+		|| INSSettingsInitialize() == -1 \
+		|| MotorRpmInitialize() == -1) {
 
 		return -1;
 	}
@@ -198,6 +210,8 @@ int32_t SensorsInitialize(void)
 	SensorSettingsConnectCallback(&settingsUpdatedCb);
 	INSSettingsConnectCallback(&settingsUpdatedCb);
 
+	MotorRpmConnectCopy(&motor_rpm);
+
 	return 0;
 }
 
@@ -234,6 +248,12 @@ static void SensorsTask(void *parameters)
 	UAVObjEvent ev;
 	settingsUpdatedCb(&ev, NULL, NULL, 0);
 
+	uint16_t gyro_rate = PIOS_SENSORS_GetSampleRate(PIOS_SENSOR_GYRO);
+
+	// Each gyro sample should be through before the next one arrives
+	if (gyro_rate)
+		TaskMonitorSetDeadline(TASKINFO_RUNNING_SENSORS, 1000000 / gyro_rate);
+
 	// Main task loop
 	lastSysTime = PIOS_Thread_Systime();
 	uint32_t good_runs = 1;
@@ -247,32 +267,37 @@ static void SensorsTask(void *parameters)
 			PIOS_Thread_Sleep_Until(&lastSysTime, SENSOR_PERIOD);
 		}
 
-		struct pios_sensor_gyro_data gyros;
-		struct pios_sensor_accel_data accels;
+		struct pios_sensor_gyro_data *gyros;
+		struct pios_sensor_accel_data *accels;
 		struct pios_sensor_mag_data mags;
 		struct pios_sensor_baro_data baro;
 
 		uint32_t timeval = PIOS_DELAY_GetRaw();
 
-		//Block on gyro data but nothing else
-		struct pios_queue *queue;
-		queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_GYRO);
-		if (queue == NULL || PIOS_Queue_Receive(queue, &gyros, SENSOR_PERIOD) == false) {
+		//Block on gyro data but nothing else.  Gyro and accel samples
+		//are used in place in the queue slots and released afterwards.
+		struct pios_queue *gyro_queue;
+		gyro_queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_GYRO);
+		if (gyro_queue == NULL ||
+				(gyros = PIOS_Queue_Peek(gyro_queue, SENSOR_PERIOD)) == NULL) {
 			good_runs = 0;
 			continue;
 		}
 
+		struct pios_queue *queue;
 		queue = PIOS_SENSORS_GetQueue(PIOS_SENSOR_ACCEL);
-		if (queue == NULL || PIOS_Queue_Receive(queue, &accels, 0) == false) {
+		if (queue == NULL || (accels = PIOS_Queue_Peek(queue, 0)) == NULL) {
 			//If no new accels data is ready, reuse the latest sample
 			AccelsSet(&accelsData);
+		} else {
+			update_accels(accels);
+			PIOS_Queue_Release(queue, accels);
 		}
-		else
-			update_accels(&accels);
 
 		// Update gyros after the accels since the rest of the code expects
 		// the accels to be available first
-		update_gyros(&gyros);
+		update_gyros(gyros);
+		PIOS_Queue_Release(gyro_queue, gyros);
 
 		bool test_good_run = good_runs > REQUIRED_GOOD_CYCLES;
 
@@ -383,12 +408,31 @@ static void update_accels(struct pios_sensor_accel_data *accels)
 	AccelsSet(&accelsData);
 }
 
+/**
+ * @brief Move the motor notches to where the motors are turning now
+ */
+static void update_motor_notch()
+{
+	for (int i = 0; i < MOTORRPM_RPM_NUMELEM; i++) {
+		uint16_t rpm = motor_rpm.Rpm[i];
+
+		// Much narrower than the notch; saves retuning every sample
+		if (abs(rpm - motor_notch_rpm[i]) * 100 <= motor_notch_rpm[i])
+			continue;
+
+		motor_notch_rpm[i] = rpm;
+		rpmnotch_set_freq(motor_notch, i, rpm / 60.0f);
+	}
+}
+
 /**
  * @brief Apply calibration and rotation to the raw gyro data
  * @param[in] gyros The raw gyro data
  */
 static void update_gyros(struct pios_sensor_gyro_data *gyros)
 {
+	LoopMonitorMarkSample();
+
 	// Scale the gyros
 	float gyros_out[3] = {
 	    gyros->x * gyro_scale[0],
@@ -396,8 +440,20 @@ static void update_gyros(struct pios_sensor_gyro_data *gyros)
 	    gyros->z * gyro_scale[2]
 	};
 
+	uint32_t filter_start = LoopMonitorStart();
+
+	if (gyro_notch_enabled)
+		notchfilter_run(gyro_notch, gyros_out);
+
+	if (motor_notch_enabled) {
+		update_motor_notch();
+		rpmnotch_run(motor_notch, gyros_out);
+	}
+
 	lpfilter_run(gyro_filter, gyros_out);
 
+	LoopMonitorEnd(LOOPMONITOR_FILTER, filter_start);
+
 	GyrosData gyrosData;
 	gyrosData.temperature = gyros->temperature;
 
@@ -697,14 +753,25 @@ static void mag_calibration_fix_length(MagnetometerData *mag)
 /**
  * Locally cache some variables from the AtttitudeSettings object
  */
+/**
+ * Settings update callback.  Filters are only rebuilt, and the mag bias
+ * only reset, when the fields they depend on change.
+ */
 static void settingsUpdatedCb(UAVObjEvent * objEv, void *ctx, void *obj, int len)
 {
 	(void) ctx; (void) obj; (void) len;
 
-	SensorSettingsData sensorSettings;
-	SensorSettingsGet(&sensorSettings);
+	static bool settings_loaded;
+
+	uint32_t sensor_changed = SensorSettingsGetChanges(&sensorSettings);
+	uint32_t attitude_changed = AttitudeSettingsGetChanges(&attitudeSettings);
 	INSSettingsGet(&insSettings);
 
+	if (!settings_loaded) {
+		sensor_changed = attitude_changed = 0xffffffff;
+		settings_loaded = true;
+	}
+
 #ifdef PIOS_TOLERATE_MISSING_SENSORS
 	if (sensorSettings.TolerateMissingSensors ==
 			SENSORSETTINGS_TOLERATEMISSINGSENSORS_TRUE) {
@@ -743,39 +810,71 @@ static void settingsUpdatedCb(UAVObjEvent * objEv, void *ctx, void *obj, int len
 	gyro_coeff_z[3] =  sensorSettings.ZGyroTempCoeff[3];
 	z_accel_offset  =  sensorSettings.ZAccelOffset;
 
-	// Zero out any adaptive tracking
-	MagBiasData magBias;
-	MagBiasGet(&magBias);
-	magBias.x = 0;
-	magBias.y = 0;
-	magBias.z = 0;
-	MagBiasSet(&magBias);
-
-	uint8_t bias_correct;
-	AttitudeSettingsBiasCorrectGyroGet(&bias_correct);
-	bias_correct_gyro = (bias_correct == ATTITUDESETTINGS_BIASCORRECTGYRO_TRUE);
-
-	AttitudeSettingsData attitudeSettings;
-	AttitudeSettingsGet(&attitudeSettings);
-	// Indicates not to expend cycles on rotation
-	if(attitudeSettings.BoardRotation[0] == 0 && attitudeSettings.BoardRotation[1] == 0 &&
-	   attitudeSettings.BoardRotation[2] == 0) {
-		rotate = 0;
-	} else {
-		float rotationQuat[4];
-		const float rpy[3] = {attitudeSettings.BoardRotation[ATTITUDESETTINGS_BOARDROTATION_ROLL] / 100.0f,
-			attitudeSettings.BoardRotation[ATTITUDESETTINGS_BOARDROTATION_PITCH] / 100.0f,
-			attitudeSettings.BoardRotation[ATTITUDESETTINGS_BOARDROTATION_YAW] / 100.0f};
-		RPY2Quaternion(rpy, rotationQuat);
-		Quaternion2R(rotationQuat, Rsb);
-		rotate = 1;
+	if (sensor_changed & (SENSORSETTINGS_MAGBIAS_FIELDBIT |
+				SENSORSETTINGS_MAGSCALE_FIELDBIT)) {
+		// Zero out any adaptive tracking
+		MagBiasData magBias;
+		MagBiasGet(&magBias);
+		magBias.x = 0;
+		magBias.y = 0;
+		magBias.z = 0;
+		MagBiasSet(&magBias);
+	}
+
+	if (attitude_changed & ATTITUDESETTINGS_BIASCORRECTGYRO_FIELDBIT) {
+		bias_correct_gyro = (attitudeSettings.BiasCorrectGyro == ATTITUDESETTINGS_BIASCORRECTGYRO_TRUE);
+	}
+
+	if (attitude_changed & ATTITUDESETTINGS_BOARDROTATION_FIELDBIT) {
+		// Indicates not to expend cycles on rotation
+		if(attitudeSettings.BoardRotation[0] == 0 && attitudeSettings.BoardRotation[1] == 0 &&
+		   attitudeSettings.BoardRotation[2] == 0) {
+			rotate = 0;
+		} else {
+			float rotationQuat[4];
+			const float rpy[3] = {attitudeSettings.BoardRotation[ATTITUDESETTINGS_BOARDROTATION_ROLL] / 100.0f,
+				attitudeSettings.BoardRotation[ATTITUDESETTINGS_BOARDROTATION_PITCH] / 100.0f,
+				attitudeSettings.BoardRotation[ATTITUDESETTINGS_BOARDROTATION_YAW] / 100.0f};
+			RPY2Quaternion(rpy, rotationQuat);
+			Quaternion2R(rotationQuat, Rsb);
+			rotate = 1;
+		}
 	}
 
 	float gyro_dT = 1.0f / (float)PIOS_SENSORS_GetSampleRate(PIOS_SENSOR_GYRO);
 	float accel_dT = 1.0f / (float)PIOS_SENSORS_GetSampleRate(PIOS_SENSOR_ACCEL);
 
-	lpfilter_create(&gyro_filter, sensorSettings.LowpassCutoff, gyro_dT, sensorSettings.LowpassOrder, 3);
-	lpfilter_create(&accel_filter, sensorSettings.LowpassCutoff, accel_dT, sensorSettings.LowpassOrder, 3);
+	if (sensor_changed & (SENSORSETTINGS_LOWPASSCUTOFF_FIELDBIT |
+				SENSORSETTINGS_LOWPASSORDER_FIELDBIT)) {
+		lpfilter_create(&gyro_filter, sensorSettings.LowpassCutoff, gyro_dT, sensorSettings.LowpassOrder, 3);
+		lpfilter_create(&accel_filter, sensorSettings.LowpassCutoff, accel_dT, sensorSettings.LowpassOrder, 3);
+	}
+
+	if (sensor_changed & (SENSORSETTINGS_DYNAMICNOTCH_FIELDBIT |
+				SENSORSETTINGS_DYNAMICNOTCHRANGE_FIELDBIT |
+				SENSORSETTINGS_DYNAMICNOTCHQ_FIELDBIT)) {
+		gyro_notch_enabled = false;
+		if (sensorSettings.DynamicNotch == SENSORSETTINGS_DYNAMICNOTCH_TRUE) {
+			notchfilter_create(&gyro_notch,
+					sensorSettings.DynamicNotchRange[SENSORSETTINGS_DYNAMICNOTCHRANGE_MIN],
+					sensorSettings.DynamicNotchRange[SENSORSETTINGS_DYNAMICNOTCHRANGE_MAX],
+					sensorSettings.DynamicNotchQ, gyro_dT, 3);
+			gyro_notch_enabled = true;
+		}
+	}
+
+	if (sensor_changed & (SENSORSETTINGS_RPMNOTCH_FIELDBIT |
+				SENSORSETTINGS_RPMNOTCHMINFREQ_FIELDBIT |
+				SENSORSETTINGS_RPMNOTCHQ_FIELDBIT)) {
+		motor_notch_enabled = false;
+		if (sensorSettings.RpmNotch == SENSORSETTINGS_RPMNOTCH_TRUE) {
+			rpmnotch_create(&motor_notch, MOTORRPM_RPM_NUMELEM,
+					sensorSettings.RpmNotchMinFreq,
+					sensorSettings.RpmNotchQ, gyro_dT);
+			memset(motor_notch_rpm, 0, sizeof(motor_notch_rpm));
+			motor_notch_enabled = true;
+		}
+	}
 }
 /**
   * @}
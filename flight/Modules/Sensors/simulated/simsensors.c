@@ -39,7 +39,9 @@
 #include "pios_thread.h"
 
 #include "accels.h"
+#include "actuatorcommand.h"
 #include "actuatordesired.h"
+#include "actuatorsettings.h"
 #include "airspeedactual.h"
 #include "attitudeactual.h"
 #include "attitudesimulated.h"
@@ -54,7 +56,9 @@
 #include "homelocation.h"
 #include "magnetometer.h"
 #include "magbias.h"
+#include "mixersettings.h"
 #include "ratedesired.h"
+#include "simulationsettings.h"
 #include "systemsettings.h"
 
 #include "coordinate_conversions.h"
@@ -76,6 +80,8 @@ static void simulateModelAgnostic();
 static void simulateModelQuadcopter();
 static void simulateModelAirplane();
 static void simulateModelCar();
+static bool simulateMotors(float dT, float rates[3], float *thrust,
+		float gyro_vib[3], float accel_vib[3]);
 
 static void magOffsetEstimation(MagnetometerData *mag);
 
@@ -134,6 +140,7 @@ static int32_t SimSensorsInitialize(void)
 	GPSVelocityInitialize();
 	MagnetometerInitialize();
 	MagBiasInitialize();
+	SimulationSettingsInitialize();
 
 	return 0;
 }
@@ -172,6 +179,9 @@ static void SensorsTask(void *parameters)
 	AlarmsClear(SYSTEMALARMS_ALARM_SENSORS);
 
 	PIOS_SENSORS_SetMaxGyro(500);
+
+	uint32_t tm = PIOS_DELAY_GetRaw();
+
 	// Main task loop
 	while (1) {
 		PIOS_WDG_UpdateFlag(PIOS_WDG_SENSORS);
@@ -218,9 +228,9 @@ static void SensorsTask(void *parameters)
 				simulateModelCar();
 		}
 
-		static uint32_t tm = 0;
 
-		PIOS_Thread_Sleep_Until(&tm, 2);
+		// Wake on the delay timer, so the period keeps its phase
+		PIOS_Thread_Sleep_Until_uS(&tm, SENSOR_PERIOD * 1000);
 	}
 }
 
@@ -327,6 +337,137 @@ static void simulateModelAgnostic()
 	MagnetometerSet(&mag);
 }
 
+//! Normalized speed of each motor, 0 to 1
+static float motor_speed[ACTUATORCOMMAND_CHANNEL_NUMELEM];
+//! Rotor angle of each motor [rad], for the vibration it makes
+static float motor_phase[ACTUATORCOMMAND_CHANNEL_NUMELEM];
+
+/**
+ * Step the motors of a multirotor and the body rates they drive
+ *
+ * Each motor output (as the mixer type says) is scaled from ChannelMin to
+ * ChannelMax, and the motor speed follows it with a first order lag.  Thrust
+ * goes with the square of the speed.  The torques come from the mixer
+ * coefficients, so the airframe flown is the one configured.  Inertia is
+ * taken to be diagonal, with the cross coupling of the axes left out.
+ *
+ * @param[in] dT time step [s]
+ * @param[in,out] rates body rates [deg/s]
+ * @param[out] thrust total thrust [m/s^2]
+ * @param[out] gyro_vib vibration seen by the gyros [deg/s]
+ * @param[out] accel_vib vibration seen by the accels [m/s^2]
+ * @returns false when there are no motors in the mixer
+ */
+static bool simulateMotors(float dT, float rates[3], float *thrust,
+		float gyro_vib[3], float accel_vib[3])
+{
+	const float TWO_PI = 2 * (float)M_PI;
+
+	SimulationSettingsData settings;
+	SimulationSettingsGet(&settings);
+	MixerSettingsData mixerSettings;
+	MixerSettingsGet(&mixerSettings);
+	ActuatorSettingsData actuatorSettings;
+	ActuatorSettingsGet(&actuatorSettings);
+	ActuatorCommandData command;
+	ActuatorCommandGet(&command);
+
+	const uint8_t types[ACTUATORCOMMAND_CHANNEL_NUMELEM] = {
+		mixerSettings.Mixer1Type, mixerSettings.Mixer2Type,
+		mixerSettings.Mixer3Type, mixerSettings.Mixer4Type,
+		mixerSettings.Mixer5Type, mixerSettings.Mixer6Type,
+		mixerSettings.Mixer7Type, mixerSettings.Mixer8Type,
+		mixerSettings.Mixer9Type, mixerSettings.Mixer10Type,
+	};
+	const int16_t *vectors[ACTUATORCOMMAND_CHANNEL_NUMELEM] = {
+		mixerSettings.Mixer1Vector, mixerSettings.Mixer2Vector,
+		mixerSettings.Mixer3Vector, mixerSettings.Mixer4Vector,
+		mixerSettings.Mixer5Vector, mixerSettings.Mixer6Vector,
+		mixerSettings.Mixer7Vector, mixerSettings.Mixer8Vector,
+		mixerSettings.Mixer9Vector, mixerSettings.Mixer10Vector,
+	};
+	const uint8_t axes[3] = {
+		MIXERSETTINGS_MIXER1VECTOR_ROLL,
+		MIXERSETTINGS_MIXER1VECTOR_PITCH,
+		MIXERSETTINGS_MIXER1VECTOR_YAW,
+	};
+
+	float alpha = (settings.MotorTimeConstant > dT) ? dT / settings.MotorTimeConstant : 1.0f;
+
+	float torque[3] = {0, 0, 0};
+	float authority[3] = {0, 0, 0};
+	float total = 0;
+	int motors = 0;
+
+	for (int i = 0; i < 3; i++) {
+		gyro_vib[i] = 0;
+		accel_vib[i] = 0;
+	}
+
+	for (int i = 0; i < ACTUATORCOMMAND_CHANNEL_NUMELEM; i++) {
+		if (types[i] != MIXERSETTINGS_MIXER1TYPE_MOTOR)
+			continue;
+
+		motors++;
+
+		// Disarmed the actuator holds motors at ChannelMin
+		float range = actuatorSettings.ChannelMax[i] - actuatorSettings.ChannelMin[i];
+		float u = 0;
+		if (range != 0)
+			u = (command.Channel[i] - actuatorSettings.ChannelMin[i]) / range;
+		if (!(u > 0))
+			u = 0;
+		else if (u > 1)
+			u = 1;
+
+		motor_speed[i] += (u - motor_speed[i]) * alpha;
+
+		float speed = motor_speed[i];
+		float motor_thrust = speed * speed;
+		total += motor_thrust;
+
+		for (int j = 0; j < 3; j++) {
+			float k = vectors[i][axes[j]] / 128.0f;
+			torque[j] += motor_thrust * k;
+			authority[j] += fabsf(k);
+		}
+
+		motor_phase[i] += TWO_PI * settings.MotorMaxFrequency * speed * dT;
+		if (motor_phase[i] > TWO_PI)
+			motor_phase[i] -= TWO_PI;
+
+		// An unbalanced rotor shakes the frame in the plane it spins in,
+		// and some of that ends up along the thrust axis
+		for (int h = 0; h < SIMULATIONSETTINGS_VIBRATION_NUMELEM; h++) {
+			float a = settings.Vibration[h] * motor_thrust;
+			float phase = (h + 1) * motor_phase[i];
+			accel_vib[0] += a * sinf(phase);
+			accel_vib[1] += a * cosf(phase);
+			accel_vib[2] += 0.5f * a * sinf(phase + i);
+		}
+
+		gyro_vib[0] += settings.GyroVibration * motor_thrust * sinf(motor_phase[i]);
+		gyro_vib[1] += settings.GyroVibration * motor_thrust * cosf(motor_phase[i]);
+	}
+
+	if (motors == 0)
+		return false;
+
+	*thrust = settings.MaxThrust * GRAVITY * total / motors;
+
+	// AngularAccel is for one side at full output and the other stopped,
+	// which is half of the summed coefficients
+	for (int j = 0; j < 3; j++) {
+		float accel = 0;
+		if (authority[j] > 0)
+			accel = settings.AngularAccel[j] * torque[j] / (authority[j] / 2);
+
+		rates[j] += (accel - settings.RateDamping * rates[j]) * dT;
+	}
+
+	return true;
+}
+
 float thrustToDegs = 50;
 bool overideAttitude = false;
 static void simulateModelQuadcopter()
@@ -362,17 +503,37 @@ static void simulateModelQuadcopter()
 	if (thrust != thrust)
 		thrust = 0;
 
-	float control_scaling = 3000.0f;
-	// In rad/s
-	rpy[0] = control_scaling * actuatorDesired.Roll * (1 - ACTUATOR_ALPHA) + rpy[0] * ACTUATOR_ALPHA;
-	rpy[1] = control_scaling * actuatorDesired.Pitch * (1 - ACTUATOR_ALPHA) + rpy[1] * ACTUATOR_ALPHA;
-	rpy[2] = control_scaling * actuatorDesired.Yaw * (1 - ACTUATOR_ALPHA) + rpy[2] * ACTUATOR_ALPHA;
+	SimulationSettingsData simSettings;
+	SimulationSettingsGet(&simSettings);
+
+	float gyro_noise = GYRO_NOISE_SCALE;
+	float accel_noise = 0;
+	float gyro_vib[3] = {0, 0, 0};
+	float accel_vib[3] = {0, 0, 0};
+
+	bool rigid_body = simSettings.MultirotorModel == SIMULATIONSETTINGS_MULTIROTORMODEL_RIGIDBODY &&
+		simulateMotors(dT, rpy, &thrust, gyro_vib, accel_vib);
+
+	if (rigid_body) {
+		gyro_noise = simSettings.GyroNoise;
+		accel_noise = simSettings.AccelNoise;
+
+		// Resting on the ground the motors can't turn the frame
+		if (pos[2] >= 0 && thrust < GRAVITY)
+			rpy[0] = rpy[1] = rpy[2] = 0;
+	} else {
+		float control_scaling = 3000.0f;
+		// In rad/s
+		rpy[0] = control_scaling * actuatorDesired.Roll * (1 - ACTUATOR_ALPHA) + rpy[0] * ACTUATOR_ALPHA;
+		rpy[1] = control_scaling * actuatorDesired.Pitch * (1 - ACTUATOR_ALPHA) + rpy[1] * ACTUATOR_ALPHA;
+		rpy[2] = control_scaling * actuatorDesired.Yaw * (1 - ACTUATOR_ALPHA) + rpy[2] * ACTUATOR_ALPHA;
+	}
 
 	temperature = 20;
 	GyrosData gyrosData; // Skip get as we set all the fields
-	gyrosData.x = rpy[0] + rand_gauss() * GYRO_NOISE_SCALE + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11; // - powf(temperature - 20,3) * 0.05;;
-	gyrosData.y = rpy[1] + rand_gauss() * GYRO_NOISE_SCALE + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11;
-	gyrosData.z = rpy[2] + rand_gauss() * GYRO_NOISE_SCALE + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11;
+	gyrosData.x = rpy[0] + gyro_vib[0] + rand_gauss() * gyro_noise + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11; // - powf(temperature - 20,3) * 0.05;;
+	gyrosData.y = rpy[1] + gyro_vib[1] + rand_gauss() * gyro_noise + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11;
+	gyrosData.z = rpy[2] + gyro_vib[2] + rand_gauss() * gyro_noise + (temperature - 20) * 1 + powf(temperature - 20,2) * 0.11;
 	gyrosData.temperature = temperature;
 	GyrosSet(&gyrosData);
 
@@ -444,9 +605,12 @@ static void simulateModelQuadcopter()
 
 	// Transform the accels back in to body frame
 	AccelsData accelsData; // Skip get as we set all the fields
-	accelsData.x = ned_accel[0] * Rbe[0][0] + ned_accel[1] * Rbe[0][1] + ned_accel[2] * Rbe[0][2] + accel_bias[0];
-	accelsData.y = ned_accel[0] * Rbe[1][0] + ned_accel[1] * Rbe[1][1] + ned_accel[2] * Rbe[1][2] + accel_bias[1];
-	accelsData.z = ned_accel[0] * Rbe[2][0] + ned_accel[1] * Rbe[2][1] + ned_accel[2] * Rbe[2][2] + accel_bias[2];
+	accelsData.x = ned_accel[0] * Rbe[0][0] + ned_accel[1] * Rbe[0][1] + ned_accel[2] * Rbe[0][2] + accel_bias[0]
+		+ accel_vib[0] + rand_gauss() * accel_noise;
+	accelsData.y = ned_accel[0] * Rbe[1][0] + ned_accel[1] * Rbe[1][1] + ned_accel[2] * Rbe[1][2] + accel_bias[1]
+		+ accel_vib[1] + rand_gauss() * accel_noise;
+	accelsData.z = ned_accel[0] * Rbe[2][0] + ned_accel[1] * Rbe[2][1] + ned_accel[2] * Rbe[2][2] + accel_bias[2]
+		+ accel_vib[2] + rand_gauss() * accel_noise;
 	accelsData.temperature = 30;
 	AccelsSet(&accelsData);
 
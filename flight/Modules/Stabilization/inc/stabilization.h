@@ -32,8 +32,21 @@
 #ifndef STABILIZATION_H
 #define STABILIZATION_H
 
+#include "circqueue.h"
+
 enum {ROLL,PITCH,YAW,MAX_AXES};
 
+//! One control loop iteration, as handed to autotune's identification
+struct ident_sample {
+	float gyro[MAX_AXES];
+	float actuator[MAX_AXES];
+	float thrust;
+	uint16_t cycle;		//!< SystemIdentCycle; 0xffff marks the end of a tune
+};
+
+//! Set up by autotune to receive every loop while a tune runs
+extern circ_queue_t ident_samples;
+
 int32_t StabilizationInitialize();
 
 #endif /* STABILIZATION_H */
@@ -69,6 +69,7 @@
 
 // Includes for various stabilization algorithms
 #include "virtualflybar.h"
+#include "loopmonitor.h"
 
 // MAX_AXES expected to be present and equal to 3
 DONT_BUILD_IF((MAX_AXES+0 != 3), stabAxisWrongCount);
@@ -124,6 +125,7 @@ static SubTrimData subTrim;
 static struct pios_queue *queue;
 
 uint16_t ident_wiggle_points;
+circ_queue_t ident_samples;
 
 static float axis_lock_accum[MAX_AXES] = {0,0,0};
 static uint8_t max_axis_lock = 0;
@@ -149,7 +151,7 @@ static volatile bool systemSettingsUpdated = true;
 static void stabilizationTask(void* parameters);
 static void zero_pids(void);
 static void calculate_pids(void);
-static void update_settings();
+static void update_settings(float dT_expected);
 static float get_throttle(StabilizationDesiredData *stabilization_desired, SystemSettingsAirframeTypeOptions *airframe_type);
 
 #ifndef NO_CONTROL_DEADBANDS
@@ -322,6 +324,8 @@ static void stabilizationTask(void* parameters)
 
 	smoothcontrol_update_dT(rc_smoothing, dT_expected);
 
+	TaskMonitorSetDeadline(TASKINFO_RUNNING_STABILIZATION, dT_expected * 1000000);
+
 	if (dT_expected < 0.0004f) {
 		// For future 3.2KHz-- 640ms period
 		ident_shift = 8;
@@ -354,22 +358,8 @@ static void stabilizationTask(void* parameters)
 		PIOS_WDG_UpdateFlag(PIOS_WDG_STABILIZATION);
 
 		if (settings_flag) {
-			update_settings();
-
-			// Default 350ms.
-			// 175ms to 39.3% of response
-			// 350ms to 63.2% of response
-			// 700ms to 86.4% of response
-			max_rate_alpha = expf(-dT_expected / settings.AcroDynamicTau);
-
-			// Compute time constant for vbar decay term
-			if (vbar_settings.VbarTau < 0.001f) {
-				vbar_decay = 0;
-			} else {
-				vbar_decay = expf(-dT_expected / vbar_settings.VbarTau);
-			}
-
 			settings_flag = false;
+			update_settings(dT_expected);
 		}
 
 		// Wait until the AttitudeRaw object is updated, if a timeout then go to failsafe
@@ -379,6 +369,8 @@ static void stabilizationTask(void* parameters)
 			continue;
 		}
 
+		uint32_t pid_start = LoopMonitorStart();
+
 		static bool frequency_wrong = false;
 
 		float dT = PIOS_DELAY_DiffuS(timeval) * 1.0e-6f;
@@ -1008,8 +1000,40 @@ static void stabilizationTask(void* parameters)
 		// Save dT
 		actuatorDesired.UpdateTime = dT * 1000;
 
+		LoopMonitorEnd(LOOPMONITOR_PID, pid_start);
+
 		ActuatorDesiredSet(&actuatorDesired);
 
+		// Autotune needs every loop; the UAVO callbacks don't keep up
+		static bool ident_end_pending;
+		bool ident_running = actuatorDesired.SystemIdentCycle != 0xffff;
+
+		if (ident_samples && (ident_running || ident_end_pending)) {
+			struct ident_sample sample = {
+				.gyro = {
+					gyro_filtered[ROLL],
+					gyro_filtered[PITCH],
+					gyro_filtered[YAW],
+				},
+				.actuator = {
+					actuatorDesiredAxis[ROLL],
+					actuatorDesiredAxis[PITCH],
+					actuatorDesiredAxis[YAW],
+				},
+				.thrust = actuatorDesired.Thrust,
+				.cycle = actuatorDesired.SystemIdentCycle,
+			};
+
+			// Dropped when full, autotune notices the gap in cycles.
+			// The end marker is retried until it gets through.
+			if (circ_queue_write_data(ident_samples, &sample, 1) &&
+					!ident_running)
+				ident_end_pending = false;
+		}
+
+		if (ident_running)
+			ident_end_pending = true;
+
 		if(flightStatus.Armed != FLIGHTSTATUS_ARMED_ARMED ||
 		   (lowThrottleZeroIntegral && get_throttle(&stabDesired, &airframe_type) < 0))
 		{
@@ -1147,23 +1171,71 @@ static void calculate_pids()
 #endif
 }
 
-static void update_settings()
+/**
+ * Bring the settings and what's derived from them up to date.  TxPID and
+ * the GCS sliders change single fields often, so only redo what depends
+ * on the fields that actually changed.
+ */
+static void update_settings(float dT_expected)
 {
-	SubTrimSettingsData subTrimSettings;
+	static SubTrimSettingsData subTrimSettings;
+	static bool settings_loaded;
 
-	SubTrimGet(&subTrim);
-	SubTrimSettingsGet(&subTrimSettings);
+	uint32_t changed = StabilizationSettingsGetChanges(&settings);
+	uint32_t vbar_changed = VbarSettingsGetChanges(&vbar_settings);
+	uint32_t trim_changed = SubTrimSettingsGetChanges(&subTrimSettings);
 
-	// Set the trim angles
-	subTrim.Roll = subTrimSettings.Roll;
-	subTrim.Pitch = subTrimSettings.Pitch;
+	if (!settings_loaded) {
+		changed = vbar_changed = trim_changed = 0xffffffff;
+		settings_loaded = true;
+	}
+
+	if (trim_changed) {
+		SubTrimGet(&subTrim);
 
-	SubTrimSet(&subTrim);
+		// Set the trim angles
+		subTrim.Roll = subTrimSettings.Roll;
+		subTrim.Pitch = subTrimSettings.Pitch;
 
-	StabilizationSettingsGet(&settings);
-	VbarSettingsGet(&vbar_settings);
+		SubTrimSet(&subTrim);
+	}
+
+	const uint32_t pid_fields =
+		STABILIZATIONSETTINGS_ROLLRATEPID_FIELDBIT |
+		STABILIZATIONSETTINGS_PITCHRATEPID_FIELDBIT |
+		STABILIZATIONSETTINGS_YAWRATEPID_FIELDBIT |
+		STABILIZATIONSETTINGS_ROLLPI_FIELDBIT |
+		STABILIZATIONSETTINGS_PITCHPI_FIELDBIT |
+		STABILIZATIONSETTINGS_YAWPI_FIELDBIT |
+		STABILIZATIONSETTINGS_COORDINATEDFLIGHTYAWPI_FIELDBIT |
+		STABILIZATIONSETTINGS_DERIVATIVECUTOFF_FIELDBIT |
+		STABILIZATIONSETTINGS_DERIVATIVEGAMMA_FIELDBIT;
+	const uint32_t vbar_pid_fields =
+		VBARSETTINGS_VBARROLLPID_FIELDBIT |
+		VBARSETTINGS_VBARPITCHPID_FIELDBIT |
+		VBARSETTINGS_VBARYAWPID_FIELDBIT;
+
+	// The deadbands are past the 32nd field, so they come as all bits
+	if ((changed & pid_fields) || (vbar_changed & vbar_pid_fields)) {
+		calculate_pids();
+	}
 
-	calculate_pids();
+	if (changed & STABILIZATIONSETTINGS_ACRODYNAMICTAU_FIELDBIT) {
+		// Default 350ms.
+		// 175ms to 39.3% of response
+		// 350ms to 63.2% of response
+		// 700ms to 86.4% of response
+		max_rate_alpha = expf(-dT_expected / settings.AcroDynamicTau);
+	}
+
+	if (vbar_changed & VBARSETTINGS_VBARTAU_FIELDBIT) {
+		// Compute time constant for vbar decay term
+		if (vbar_settings.VbarTau < 0.001f) {
+			vbar_decay = 0;
+		} else {
+			vbar_decay = expf(-dT_expected / vbar_settings.VbarTau);
+		}
+	}
 
 	// Maximum deviation to accumulate for axis lock
 	max_axis_lock = settings.MaxAxisLock;
@@ -256,6 +256,63 @@ static void interp_in_hsv(bool backwards, const uint8_t *rgb_start,
 	rgb_out[2] = float_to_q8(rgbf[2]);
 }
 
+/* The range colour as a function of the blend fraction, precomputed at
+ * RAMP_STEPS + 1 points.  Blending in HSV is too expensive to do for
+ * every update; in between points it's blended linearly in RGB.
+ */
+#define RAMP_SHIFT 10
+#define RAMP_STEPS (65536 >> RAMP_SHIFT)
+
+static uint8_t ramp[RAMP_STEPS + 1][3];
+static uint8_t ramp_base[3], ramp_end[3];
+static uint8_t ramp_type = 0xff;
+
+static void update_ramp(const RGBLEDSettingsData *rgbSettings)
+{
+	if (ramp_type == rgbSettings->RangeColorBlendType &&
+			!memcmp(ramp_base, rgbSettings->RangeBaseColor, 3) &&
+			!memcmp(ramp_end, rgbSettings->RangeEndColor, 3)) {
+		return;
+	}
+
+	ramp_type = rgbSettings->RangeColorBlendType;
+	memcpy(ramp_base, rgbSettings->RangeBaseColor, 3);
+	memcpy(ramp_end, rgbSettings->RangeEndColor, 3);
+
+	for (int i = 0; i <= RAMP_STEPS; i++) {
+		uint16_t fraction = (i < RAMP_STEPS) ? (i << RAMP_SHIFT) : 65535;
+
+		switch (ramp_type) {
+			default:
+			case RGBLEDSETTINGS_RANGECOLORBLENDTYPE_LINEARRGBFADE:
+				for (int c = 0; c < 3; c++) {
+					ramp[i][c] = linear_interp_u16(ramp_base[c],
+							ramp_end[c], fraction);
+				}
+				break;
+			case RGBLEDSETTINGS_RANGECOLORBLENDTYPE_LINEARINHSV:
+				interp_in_hsv(false, ramp_base, ramp_end,
+						ramp[i], fraction);
+				break;
+			case RGBLEDSETTINGS_RANGECOLORBLENDTYPE_LINEARINHSVBACKWARDSHUE:
+				interp_in_hsv(true, ramp_base, ramp_end,
+						ramp[i], fraction);
+				break;
+		}
+	}
+}
+
+static void ramp_color(uint16_t fraction, uint8_t *rgb_out)
+{
+	int idx = fraction >> RAMP_SHIFT;
+	uint16_t sub = (fraction & ((1 << RAMP_SHIFT) - 1)) << (16 - RAMP_SHIFT);
+
+	for (int c = 0; c < 3; c++) {
+		rgb_out[c] = linear_interp_u16(ramp[idx][c], ramp[idx + 1][c],
+				sub);
+	}
+}
+
 static inline uint16_t float_to_u16(float in)
 {
 	if (in >= 1) {
@@ -405,34 +462,8 @@ void systemmod_process_rgb_leds(bool led_override, bool led_override_active,
 			break;
 	}
 
-	switch (rgbSettings.RangeColorBlendType) {
-		default:
-		case RGBLEDSETTINGS_RANGECOLORBLENDTYPE_LINEARRGBFADE:
-			range_color[0] = linear_interp_u16(
-					rgbSettings.RangeBaseColor[0],
-					rgbSettings.RangeEndColor[0],
-					fraction);
-			range_color[1] = linear_interp_u16(
-					rgbSettings.RangeBaseColor[1],
-					rgbSettings.RangeEndColor[1],
-					fraction);
-			range_color[2] = linear_interp_u16(
-					rgbSettings.RangeBaseColor[2],
-					rgbSettings.RangeEndColor[2],
-					fraction);
-		case RGBLEDSETTINGS_RANGECOLORBLENDTYPE_LINEARINHSV:
-			interp_in_hsv(false, rgbSettings.RangeBaseColor,
-					rgbSettings.RangeEndColor,
-					range_color,
-					fraction);
-			break;
-		case RGBLEDSETTINGS_RANGECOLORBLENDTYPE_LINEARINHSVBACKWARDSHUE:
-			interp_in_hsv(true, rgbSettings.RangeBaseColor,
-					rgbSettings.RangeEndColor,
-					range_color,
-					fraction);
-			break;
-	}
+	update_ramp(&rgbSettings);
+	ramp_color(fraction, range_color);
 
 	if (force_dim) {
 		range_color[0] /= 2;
@@ -37,6 +37,7 @@
 #include "sanitycheck.h"
 #include "taskinfo.h"
 #include "taskmonitor.h"
+#include "loopmonitor.h"
 #include "pios_thread.h"
 #include "pios_mutex.h"
 #include "pios_queue.h"
@@ -45,6 +46,7 @@
 
 #include "annunciatorsettings.h"
 #include "flightstatus.h"
+#include "looptiming.h"
 #include "manualcontrolsettings.h"
 #include "objectpersistence.h"
 #include "rfm22bstatus.h"
@@ -85,6 +87,9 @@ extern annuncdac_dev_t pios_dac_annunciator_id;
 
 #define TASK_PRIORITY PIOS_THREAD_PRIO_NORMAL
 
+/* How soon to do the next step of a settings garbage collection */
+#define SETTINGS_GC_STEP_MS 10
+
 /* When we're blinking morse code, this works out to 10.6 WPM.  It's also
  * nice and relatively prime to most other rates of things, so we don't get
  * bad beat frequencies. */
@@ -150,6 +155,12 @@ static void configurationUpdatedCb(UAVObjEvent * ev, void *ctx, void *obj, int l
 #endif
 
 static void systemTask(void *parameters);
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS) && !defined(PIPXTREME)
+static bool settingsGarbageCollectStep(void);
+#endif
+#ifndef PIPXTREME
+static int32_t deferredSavesDueIn(void);
+#endif
 static inline void updateStats();
 static inline void updateSystemAlarms();
 static inline void updateRfm22bStats();
@@ -208,6 +219,10 @@ int32_t SystemModInitialize(void)
 	if (WatchdogStatusInitialize() == -1)
 		return -1;
 #endif
+#if defined(DIAG_LOOPTIMING)
+	if (LoopTimingInitialize() == -1)
+		return -1;
+#endif
 
 	objectPersistenceQueue = PIOS_Queue_Create(1, sizeof(UAVObjEvent));
 	if (objectPersistenceQueue == NULL)
@@ -252,21 +267,123 @@ static void systemTask(void *parameters)
 		ManualControlSettingsConnectCallback(configurationUpdatedCb);
 	if (FlightStatusHandle())
 		FlightStatusConnectCallback(configurationUpdatedCb);
+	if (StateEstimationHandle())
+		StateEstimationConnectCallback(configurationUpdatedCb);
+#endif
+
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS) && !defined(PIPXTREME)
+	bool settings_gc_pending = true;
+	bool was_armed = false;
 #endif
 
 	// Main system loop
 	while (1) {
 		int32_t delayTime = processPeriodicUpdates();
 
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS) && !defined(PIPXTREME)
+		// Collecting stops while armed; pick it back up after the flight
+		uint8_t armed;
+		FlightStatusArmedGet(&armed);
+
+		if (armed == FLIGHTSTATUS_ARMED_DISARMED) {
+			if (was_armed) {
+				settings_gc_pending = true;
+			}
+
+			was_armed = false;
+		} else {
+			was_armed = true;
+		}
+
+		if (settings_gc_pending && delayTime > SETTINGS_GC_STEP_MS) {
+			delayTime = SETTINGS_GC_STEP_MS;
+		}
+#endif
+
+#ifndef PIPXTREME
+		int32_t saves_due_in = deferredSavesDueIn();
+
+		if (saves_due_in >= 0 && delayTime > saves_due_in) {
+			delayTime = saves_due_in;
+		}
+#endif
+
 		UAVObjEvent ev;
 
 		if (PIOS_Queue_Receive(objectPersistenceQueue, &ev, delayTime) == true) {
 			// If object persistence is updated call the callback
 			objectUpdatedCb(&ev, NULL, NULL, 0);
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS) && !defined(PIPXTREME)
+			settings_gc_pending = true;
+#endif
 		}
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS) && !defined(PIPXTREME)
+		else if (settings_gc_pending) {
+			settings_gc_pending = settingsGarbageCollectStep();
+		}
+#endif
+
+#ifndef PIPXTREME
+		if (deferredSavesDueIn() == 0) {
+			UAVObjFlushDeferredSaves();
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS)
+			settings_gc_pending = true;
+#endif
+		}
+#endif
 	}
 }
 
+#ifndef PIPXTREME
+/**
+ * Tell when to write out the deferred settings saves.  They are held
+ * while armed, as flash writes may stall the CPU, and written as soon as
+ * arming starts so nothing is left pending for the flight.
+ * \returns ms until due, 0 if due now, or -1 if there is nothing to write
+ */
+static int32_t deferredSavesDueIn(void)
+{
+	int32_t due_in = UAVObjDeferredSavesDueIn();
+
+	if (due_in < 0) {
+		return -1;
+	}
+
+	uint8_t armed;
+	FlightStatusArmedGet(&armed);
+
+	if (armed == FLIGHTSTATUS_ARMED_ARMED) {
+		return -1;
+	} else if (armed == FLIGHTSTATUS_ARMED_ARMING) {
+		return 0;
+	}
+
+	return due_in;
+}
+#endif
+
+#if defined(PIOS_INCLUDE_LOGFS_SETTINGS) && !defined(PIPXTREME)
+/**
+ * Collect the settings filesystem a bit at a time while idle, so that
+ * saves rarely have to wait for a whole garbage collection.  Erasing
+ * internal flash stalls the CPU, so this only happens while disarmed.
+ * \returns true if there is more to do now, false if done or armed
+ */
+static bool settingsGarbageCollectStep(void)
+{
+	extern uintptr_t pios_uavo_settings_fs_id;
+
+	uint8_t armed;
+	FlightStatusArmedGet(&armed);
+
+	if (armed != FLIGHTSTATUS_ARMED_DISARMED) {
+		return false;
+	}
+
+	return PIOS_FLASHFS_GarbageCollectStep(pios_uavo_settings_fs_id) > 0;
+}
+#endif
+
 #if defined(PIOS_INCLUDE_ANNUNC)
 
 #define BLINK_STRING_RADIO "r "
@@ -436,6 +553,11 @@ static void systemPeriodicCb(UAVObjEvent *ev, void *ctx, void *obj_data, int len
 		TaskMonitorUpdateAll();
 #endif
 
+#if defined(DIAG_LOOPTIMING)
+		// Publish the control loop timing, this throttles itself
+		LoopMonitorUpdateAll();
+#endif
+
 #endif /* PIPXTREME */
 	}
 
@@ -491,8 +613,11 @@ static void systemPeriodicCb(UAVObjEvent *ev, void *ctx, void *obj_data, int len
 				 * through startup... but it also just
 				 * seems prudent to check this stuff
 				 * every half second or so while disarmed.
-				 * (for lost events, etc.)
+				 * Settings changes invalidate their own
+				 * checks, so only the module dependent
+				 * one needs redoing.
 				 */
+				configuration_check_modules();
 				config_check_needed = true;
 			}
 		}
@@ -599,6 +724,10 @@ static void objectUpdatedCb(UAVObjEvent * ev, void *ctx, void *obj_data, int len
 			return;
 		}
 
+		// Saves still deferred go first, so they don't undo what is
+		// asked for here, e.g. a delete
+		UAVObjFlushDeferredSaves();
+
 		if (objper.Operation == OBJECTPERSISTENCE_OPERATION_LOAD) {
 			// Get selected object
 			obj = UAVObjGetByID(objper.ObjectID);
@@ -616,6 +745,18 @@ static void objectUpdatedCb(UAVObjEvent * ev, void *ctx, void *obj_data, int len
 
 			// Save selected instance
 			retval = UAVObjSave(obj, objper.InstanceID);
+		} else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_SAVELIST) {
+			uint16_t num_objs = 0;
+
+			// The list ends at the first unused entry
+			while (num_objs < OBJECTPERSISTENCE_OBJECTIDS_NUMELEM &&
+					objper.ObjectIDs[num_objs] != 0) {
+				num_objs++;
+			}
+
+			// Save instance 0 of each, in as few flash transactions
+			// as possible
+			retval = UAVObjSaveListById(objper.ObjectIDs, num_objs);
 		} else if (objper.Operation == OBJECTPERSISTENCE_OPERATION_DELETE) {
 			// Delete selected instance
 			retval = UAVObjDeleteById(objper.ObjectID, objper.InstanceID);
@@ -654,7 +795,8 @@ static void objectUpdatedCb(UAVObjEvent * ev, void *ctx, void *obj_data, int len
 
 static void configurationUpdatedCb(UAVObjEvent * ev, void *ctx, void *obj, int len)
 {
-	(void) ev; (void) ctx; (void) obj; (void) len;
+	(void) ctx; (void) obj; (void) len;
+	configuration_check_invalidate(UAVObjGetID(ev->obj));
 	config_check_needed = true;
 }
 #endif
@@ -709,6 +851,7 @@ static void updateRfm22bStats() {
 		rfm22bStatus.Timeouts    = radio_stats.timeouts;
 		rfm22bStatus.RSSI        = radio_stats.rssi;
 		rfm22bStatus.LinkQuality = radio_stats.link_quality;
+		rfm22bStatus.AirDatarate = radio_stats.air_datarate;
 		if (first_time) {
 			first_time = false;
 		} else {
@@ -769,6 +912,14 @@ static void updateStats()
 	stats.HeapRemaining = PIOS_heap_get_free_size();
 	stats.FastHeapRemaining = PIOS_fastheap_get_free_size();
 
+	struct pios_heap_pool_stats events, throttled;
+	UAVObjGetPoolStats(&events, &throttled);
+
+	stats.PoolBlocksInUse[SYSTEMSTATS_POOLBLOCKSINUSE_OBJECTEVENT] = events.in_use;
+	stats.PoolBlocksInUse[SYSTEMSTATS_POOLBLOCKSINUSE_THROTTLEDEVENT] = throttled.in_use;
+	stats.PoolBlocksAllocated[SYSTEMSTATS_POOLBLOCKSALLOCATED_OBJECTEVENT] = events.capacity;
+	stats.PoolBlocksAllocated[SYSTEMSTATS_POOLBLOCKSALLOCATED_THROTTLEDEVENT] = throttled.capacity;
+
 	// Get Irq stack status
 	stats.IRQStackRemaining = GetFreeIrqStackSize();
 
@@ -793,6 +944,8 @@ static void updateStats()
 	lastTickCount = now;
 	idleCounterClear = 1;
 
+	stats.CPULoadPeak = PIOS_Thread_Get_Peak_Load();
+
 #if defined(PIOS_INCLUDE_ADC) && defined(PIOS_ADC_USE_TEMP_SENSOR)
 	float temp_voltage = 3.3f * PIOS_ADC_DevicePinGet(PIOS_INTERNAL_ADC, 0) / ((1 << 12) - 1);
 	const float STM32_TEMP_V25 = 1.43f; /* V */
@@ -838,9 +991,26 @@ static void updateSystemAlarms()
 	// Right now CPU monitoring on simulator is worthless.
 	AlarmsClear(SYSTEMALARMS_ALARM_CPUOVERLOAD);
 #else
+	bool deadlines_missed = false;
+
+#if defined(DIAG_TASKS)
+	// Any task that fell behind since the last check is a warning even
+	// when the average load looks fine
+	static uint32_t last_deadline_misses;
+	uint16_t misses[TASKINFO_DEADLINEMISSES_NUMELEM];
+	uint32_t total_misses = 0;
+
+	TaskInfoDeadlineMissesGet(misses);
+	for (int i = 0; i < TASKINFO_DEADLINEMISSES_NUMELEM; i++)
+		total_misses += misses[i];
+
+	deadlines_missed = total_misses != last_deadline_misses;
+	last_deadline_misses = total_misses;
+#endif
+
 	if (stats.CPULoad > CPULOAD_LIMIT_CRITICAL) {
 		AlarmsSet(SYSTEMALARMS_ALARM_CPUOVERLOAD, SYSTEMALARMS_ALARM_CRITICAL);
-	} else if (stats.CPULoad > CPULOAD_LIMIT_WARNING) {
+	} else if (stats.CPULoad > CPULOAD_LIMIT_WARNING || deadlines_missed) {
 		AlarmsSet(SYSTEMALARMS_ALARM_CPUOVERLOAD, SYSTEMALARMS_ALARM_WARNING);
 	} else {
 		AlarmsClear(SYSTEMALARMS_ALARM_CPUOVERLOAD);
@@ -38,14 +38,23 @@
 #include "gcstelemetrystats.h"
 #include "modulesettings.h"
 #include "sessionmanaging.h"
+#include "settingsdigest.h"
+#include "telemetryping.h"
+#include "telemetryspeednegotiation.h"
 #include "pios_thread.h"
 #include "pios_mutex.h"
 #include "pios_queue.h"
 
 #include "pios_hal.h"
+#include "misc_math.h"
 
 #include <uavtalk.h>
 
+#ifdef PIOS_INCLUDE_LOG_TO_FLASH
+#include "pios_streamfs.h"
+#include "pios_crc.h"
+#endif
+
 #ifndef TELEM_QUEUE_SIZE
 /* 115200 = 11520 bytes/sec; if each transaction is 32 bytes,
  * this is 160ms of stuff.  Conversely, this is about 380 bytes
@@ -68,12 +77,60 @@
 #define STATS_UPDATE_PERIOD_MS 1753
 #define CONNECTION_TIMEOUT_MS 8000
 #define USB_ACTIVITY_TIMEOUT_MS 6000
+#define FILEID_LOG_BASE 0x00010000 /* Must match the GCS flight log download */
+#define FILEID_LOG_INDEX_BASE 0x00020000
+#define FILEID_LOG_CHECKSUM_BASE 0x00030000
+#define FILEID_TASK_TRACE 0x00040000 /* Must match python/dronin-tasktrace */
 
 #define MAX_ACKS_PENDING 3
 #define ACK_TIMEOUT_MS 250
 
+/* Time for the ack of a speed change to go out before switching, the GCS
+ * waits as long after receiving it */
+#define SPEED_SWITCH_DELAY_MS 250
+/* A speed tried is kept only if the GCS commits it within this time; stays
+ * below the GCS connection timeout so the link comes back on failure */
+#define SPEED_TRIAL_TIMEOUT_MS 4000
+
+/* Events are sorted off the queue into lanes.  Control goes first;
+ * realtime and bulk share what is left by deficit round robin, the
+ * quantum being the bytes a lane may send per round. */
+#define LANE_LEN 16
+#define REALTIME_QUANTUM_BYTES 256
+#define BULK_QUANTUM_BYTES 64
+/* Bulk is only sent when it leaves this much of the tx buffer free, so
+ * realtime objects never queue behind a full buffer of settings */
+#define TX_HEADROOM_BYTES 64
+#define TX_SPACE_RETRY_MS 2
+/* After this many retries bulk goes anyway, the buffer may be too small */
+#define BULK_MAX_DEFERS 25
+#define DRR_MAX_PASSES 64
+#define FRAME_OVERHEAD_BYTES 12
+
+/* Adaptive rate: periodic realtime objects have their periods stretched by
+ * 2^rate_shift while the realtime lane backs up or the link drops frames,
+ * and get them back one step per few quiet stats periods */
+#define RATE_MAX_SHIFT 3
+#define RATE_CONGESTED_DEPTH (LANE_LEN * 3 / 4)
+#define RATE_QUIET_DEPTH (LANE_LEN / 4)
+#define RATE_RECOVER_PERIODS 3
+
 // Private types
 
+enum telem_lane_id {
+	TELEM_LANE_CONTROL,	/* Handshake, stats and speed negotiation */
+	TELEM_LANE_REALTIME,	/* State and other data objects */
+	TELEM_LANE_BULK,	/* Settings and metadata */
+	TELEM_NUM_LANES
+};
+
+struct telem_lane {
+	UAVObjEvent events[LANE_LEN];
+	uint8_t head;
+	uint8_t count;
+	uint16_t deficit;
+};
+
 // Private variables
 
 struct pending_ack {
@@ -95,11 +152,40 @@ struct telemetry_state {
 
 	struct pios_mutex *ack_mutex;
 
+	uint32_t trial_speed;		/* Speed being tried on the RF port, 0 if none */
+	uint32_t trial_deadline;
+	uint32_t negotiated_speed;	/* Committed speed, 0 for the configured one */
+
+	struct telem_lane lanes[TELEM_NUM_LANES];
+	enum telem_lane_id drr_lane;	/* Lane the round robin is at */
+	UAVObjEvent held_ev;		/* Taken off the queue, its lane was full */
+	bool have_held;
+	uint8_t bulk_defers;
+
+	uint8_t realtime_peak;		/* Deepest the realtime lane got */
+	uint16_t lane_overflows;
+	uint32_t link_errors;
+	uint8_t rate_shift;
+	uint8_t quiet_periods;
+
 	UAVTalkConnection uavTalkCon;
+	uintptr_t reserved_port;	/* Port a frame is being built in */
+};
+
+static const uint32_t negotiable_speeds[] = {
+	57600, 115200, 230400, 460800, 921600
+};
+
+static const uint16_t lane_quantum[TELEM_NUM_LANES] = {
+	[TELEM_LANE_REALTIME] = REALTIME_QUANTUM_BYTES,
+	[TELEM_LANE_BULK] = BULK_QUANTUM_BYTES,
 };
 
 static struct telemetry_state telem_state = { };
 
+// When the last ping came in, it goes back with the echo
+static volatile uint32_t ping_rx_time;
+
 #if defined(PIOS_COM_TELEM_USB)
 static volatile uint32_t usb_timeout_time;
 #endif
@@ -111,20 +197,32 @@ static void telemetryTxTask(void *parameters);
 static void telemetryRxTask(void *parameters);
 
 static int32_t transmitData(void *ctx, uint8_t *data, int32_t length);
+static uint8_t *reserveTransmit(void *ctx, int32_t length);
+static int32_t commitTransmit(void *ctx, int32_t length);
 static void addAckPending(telem_t telem, UAVObjHandle obj, uint16_t inst_id);
 static void ackCallback(void *ctx, uint32_t obj_id, uint16_t inst_id);
 
 static void registerObject(telem_t telem, UAVObjHandle obj);
 static void updateObject(telem_t telem, UAVObjHandle obj, int32_t eventType);
+static enum telem_lane_id laneForEvent(const UAVObjEvent *ev);
 static int32_t setUpdatePeriod(telem_t telem, UAVObjHandle obj, int32_t updatePeriodMs);
 static void processObjEvent(telem_t telem, UAVObjEvent * ev);
+static bool processNextEvent(telem_t telem);
 static void updateTelemetryStats(telem_t telem);
+static void adaptUpdateRates(telem_t telem);
 static void gcsTelemetryStatsUpdated();
+static void speedNegotiationUpdated(telem_t telem);
+static void pingEcho(telem_t telem);
+static void checkSpeedNegotiation(telem_t telem, bool connected);
+static uint32_t configuredSpeed();
 static void updateSettings();
 static uintptr_t getComPort();
 static void session_managing_updated(UAVObjEvent * ev, void *ctx, void *obj,
 		int len);
 static void update_object_instances(uint32_t obj_id, uint32_t inst_id);
+static void settings_digest_updated(UAVObjEvent * ev, void *ctx, void *obj,
+		int len);
+static void ping_received(UAVObjEvent * ev, void *ctx, void *obj, int len);
 
 static int32_t fileReqCallback(void *ctx, uint8_t *buf,
                 uint32_t file_id, uint32_t offset, uint32_t len);
@@ -133,6 +231,12 @@ static void registerObjectShim(UAVObjHandle obj) {
 	registerObject(&telem_state, obj);
 }
 
+static void updateObjectShim(UAVObjHandle obj) {
+	if (!UAVObjIsMetaobject(obj)) {
+		updateObject(&telem_state, obj, EV_NONE);
+	}
+}
+
 /**
  * Initialise the telemetry module
  * \return -1 if initialisation failed
@@ -151,6 +255,8 @@ int32_t TelemetryStart(void)
 
 	// Listen to objects of interest
 	GCSTelemetryStatsConnectQueue(telem_state.queue);
+	TelemetrySpeedNegotiationConnectQueue(telem_state.queue);
+	TelemetryPingConnectQueue(telem_state.queue);
     
 	struct pios_thread *telemetryTxTaskHandle;
 	struct pios_thread *telemetryRxTaskHandle;
@@ -176,7 +282,10 @@ int32_t TelemetryInitialize(void)
 {
 	if (FlightTelemetryStatsInitialize() == -1 ||
 			GCSTelemetryStatsInitialize() == -1 ||
-			SessionManagingInitialize() == -1) {
+			SessionManagingInitialize() == -1 ||
+			SettingsDigestInitialize() == -1 ||
+			TelemetrySpeedNegotiationInitialize() == -1 ||
+			TelemetryPingInitialize() == -1) {
 		return -1;
 	}
 
@@ -195,8 +304,12 @@ int32_t TelemetryInitialize(void)
 	// Initialise UAVTalk
 	telem_state.uavTalkCon = UAVTalkInitialize(&telem_state, &transmitData,
 			&ackCallback, fileReqCallback);
+	UAVTalkSetDirectOutput(telem_state.uavTalkCon, &reserveTransmit,
+			&commitTransmit);
 
 	SessionManagingConnectCallback(session_managing_updated);
+	SettingsDigestConnectCallback(settings_digest_updated);
+	TelemetryPingConnectCallback(ping_received);
 
 	//register the new uavo instance callback function in the uavobjectmanager
 	UAVObjRegisterNewInstanceCB(update_object_instances);
@@ -262,6 +375,16 @@ static void updateObject(telem_t telem, UAVObjHandle obj, int32_t eventType)
 	UAVObjGetMetadata(obj, &metadata);
 	updateMode = UAVObjGetTelemetryUpdateMode(&metadata);
 
+	// Stretch the period of realtime objects while the link is congested
+	UAVObjEvent ev = { .obj = obj };
+
+	if (laneForEvent(&ev) == TELEM_LANE_REALTIME) {
+		uint32_t period = (uint32_t)metadata.telemetryUpdatePeriod <<
+			telem->rate_shift;
+
+		metadata.telemetryUpdatePeriod = MIN(period, UINT16_MAX);
+	}
+
 	// Setup object depending on update mode
 	switch (updateMode) {
 	case UPDATEMODE_PERIODIC:
@@ -416,10 +539,60 @@ static void addAckPending(telem_t telem, UAVObjHandle obj, uint16_t inst_id)
 	}
 }
 
+#ifdef PIOS_INCLUDE_LOG_TO_FLASH
+/**
+ * Serves the checksum of an on-board log as an 8 byte file: the length of
+ * the log and the CRC32 of its contents.  Lets the GCS verify a download
+ * and recognise logs it already has without fetching them again.
+ *
+ * The whole log is read to compute it, with buf as scratch space, so this
+ * holds up the telemetry task for a moment on long logs.
+ *
+ * \param[out] buf Buffer to fill, also used while reading the log
+ * \param[in] log_id The log file to checksum
+ * \param[in] offset The offset of information requested
+ * \param[in] len The size of buf
+ * \returns The number of bytes filled, 0 on EOF, negative on error.
+ */
+static int32_t logChecksum(uint8_t *buf, uint32_t log_id,
+		uint32_t offset, uint32_t len)
+{
+	struct {
+		uint32_t length;
+		uint32_t crc;
+	} __attribute__((packed)) checksum = { 0, 0 };
+
+	if (offset >= sizeof(checksum)) {
+		return 0;
+	}
+
+	int32_t ret;
+
+	while ((ret = PIOS_STREAMFS_ReadAt(FLASH_PARTITION_LABEL_LOG, log_id,
+			checksum.length, buf, len)) > 0) {
+		checksum.crc = PIOS_CRC32_updateCRC(checksum.crc, buf, ret);
+		checksum.length += ret;
+	}
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	len = MIN(len, sizeof(checksum) - offset);
+	memcpy(buf, ((uint8_t *) &checksum) + offset, len);
+
+	return len;
+}
+#endif /* PIOS_INCLUDE_LOG_TO_FLASH */
+
 /**
  * Callback for when we receive a request for data.  Converts a file
  * id to the actual unit of information, and returns/copies it.
- * Currently only operates on partitions.
+ * File ids below FLASH_PARTITION_NUM_LABELS are whole partitions, ids
+ * from FILEID_LOG_BASE up are the files of the on-board log, ids from
+ * FILEID_LOG_INDEX_BASE up their index records and ids from
+ * FILEID_LOG_CHECKSUM_BASE up their checksums.  FILEID_TASK_TRACE is the
+ * task switch trace, when built with DIAG_TASK_TRACE.
  *
  * \param[in] ctx Callback context (telemetry subsystem handle)
  * \param[in] file_id The requested file_id
@@ -467,6 +640,29 @@ static int32_t fileReqCallback(void *ctx, uint8_t *buf,
 		return len;
 	}
 
+#if defined(DIAG_TASK_TRACE)
+	if (file_id == FILEID_TASK_TRACE) {
+		return PIOS_Thread_Trace_Read(offset, buf, len);
+	}
+#endif
+
+#ifdef PIOS_INCLUDE_LOG_TO_FLASH
+	if (file_id >= FILEID_LOG_CHECKSUM_BASE) {
+		return logChecksum(buf, file_id - FILEID_LOG_CHECKSUM_BASE,
+				offset, len);
+	}
+
+	if (file_id >= FILEID_LOG_INDEX_BASE) {
+		return PIOS_STREAMFS_ReadIndexAt(FLASH_PARTITION_LABEL_LOG,
+				file_id - FILEID_LOG_INDEX_BASE, offset, buf, len);
+	}
+
+	if (file_id >= FILEID_LOG_BASE) {
+		return PIOS_STREAMFS_ReadAt(FLASH_PARTITION_LABEL_LOG,
+				file_id - FILEID_LOG_BASE, offset, buf, len);
+	}
+#endif
+
 	return -1;
 }
 
@@ -517,8 +713,17 @@ static void processObjEvent(telem_t telem, UAVObjEvent * ev)
 {
 	if (ev->obj == 0) {
 		updateTelemetryStats(telem);
+		adaptUpdateRates(telem);
 	} else if (ev->obj == GCSTelemetryStatsHandle()) {
 		gcsTelemetryStatsUpdated(telem);
+	} else if (ev->obj == TelemetrySpeedNegotiationHandle()) {
+		if (ev->event == EV_UNPACKED) {
+			speedNegotiationUpdated(telem);
+		}
+	} else if (ev->obj == TelemetryPingHandle()) {
+		if (ev->event == EV_UNPACKED) {
+			pingEcho(telem);
+		}
 	} else {
 		// Act on event
 		if (ev->event == EV_UPDATED || ev->event == EV_UPDATED_MANUAL ||
@@ -557,29 +762,235 @@ static void processObjEvent(telem_t telem, UAVObjEvent * ev)
 	}
 }
 
+/**
+ * Determine the lane an event is sent from
+ */
+static enum telem_lane_id laneForEvent(const UAVObjEvent *ev)
+{
+	if (ev->obj == 0 || ev->obj == GCSTelemetryStatsHandle() ||
+			ev->obj == FlightTelemetryStatsHandle() ||
+			ev->obj == TelemetrySpeedNegotiationHandle()) {
+		return TELEM_LANE_CONTROL;
+	}
+
+	if (UAVObjIsMetaobject(ev->obj) || UAVObjIsSettings(ev->obj)) {
+		return TELEM_LANE_BULK;
+	}
+
+	return TELEM_LANE_REALTIME;
+}
+
+/**
+ * Put an event on its lane.  An event already waiting there is not queued
+ * twice, as the object goes out with its latest data anyway.
+ * \param[in] ev the event
+ * \return false if the lane is full
+ */
+static bool laneAdd(telem_t telem, const UAVObjEvent *ev)
+{
+	enum telem_lane_id id = laneForEvent(ev);
+	struct telem_lane *lane = &telem->lanes[id];
+
+	for (int i = 0; i < lane->count; i++) {
+		const UAVObjEvent *queued = &lane->events[(lane->head + i) % LANE_LEN];
+
+		if (queued->obj == ev->obj && queued->instId == ev->instId &&
+				queued->event == ev->event) {
+			return true;
+		}
+	}
+
+	if (lane->count >= LANE_LEN) {
+		if (id == TELEM_LANE_REALTIME) {
+			telem->lane_overflows++;
+		}
+
+		return false;
+	}
+
+	lane->events[(lane->head + lane->count) % LANE_LEN] = *ev;
+	lane->count++;
+
+	if (id == TELEM_LANE_REALTIME && lane->count > telem->realtime_peak) {
+		telem->realtime_peak = lane->count;
+	}
+
+	return true;
+}
+
+static bool laneTake(struct telem_lane *lane, UAVObjEvent *ev)
+{
+	if (lane->count == 0) {
+		return false;
+	}
+
+	*ev = lane->events[lane->head];
+	lane->head = (lane->head + 1) % LANE_LEN;
+	lane->count--;
+
+	return true;
+}
+
+static bool lanesPending(telem_t telem)
+{
+	for (int i = 0; i < TELEM_NUM_LANES; i++) {
+		if (telem->lanes[i].count) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Estimate what sending an event puts on the link
+ */
+static uint16_t eventBytes(const UAVObjEvent *ev)
+{
+	uint32_t bytes = UAVObjGetNumBytes(ev->obj);
+
+	if (ev->instId == UAVOBJ_ALL_INSTANCES) {
+		bytes *= UAVObjGetNumInstances(ev->obj);
+	}
+
+	bytes += FRAME_OVERHEAD_BYTES;
+
+	return bytes > UINT16_MAX ? UINT16_MAX : bytes;
+}
+
+/**
+ * Check whether bulk can go out and still leave the tx buffer room for
+ * realtime objects.
+ * \param[in] bytes size of the bulk event
+ * \return true if it should be sent now
+ */
+static bool bulkFits(telem_t telem, uint16_t bytes)
+{
+	uintptr_t port = getComPort();
+
+	if (!port || telem->bulk_defers >= BULK_MAX_DEFERS ||
+			PIOS_COM_GetTxBytesFree(port) >= bytes + TX_HEADROOM_BYTES) {
+		telem->bulk_defers = 0;
+		return true;
+	}
+
+	telem->bulk_defers++;
+
+	return false;
+}
+
+/**
+ * Process the next event from the lanes: control first, then realtime and
+ * bulk by deficit round robin.
+ * \return true if an event was processed, false if there was none or bulk
+ * is waiting for tx space
+ */
+static bool processNextEvent(telem_t telem)
+{
+	struct telem_lane *realtime = &telem->lanes[TELEM_LANE_REALTIME];
+	struct telem_lane *bulk = &telem->lanes[TELEM_LANE_BULK];
+	UAVObjEvent ev;
+
+	if (laneTake(&telem->lanes[TELEM_LANE_CONTROL], &ev)) {
+		processObjEvent(telem, &ev);
+		return true;
+	}
+
+	if (!realtime->count && !bulk->count) {
+		return false;
+	}
+
+	/* Every pass sends or gives a lane another quantum, the bound only
+	 * matters for objects many quanta big */
+	for (int i = 0; i < DRR_MAX_PASSES; i++) {
+		enum telem_lane_id id = telem->drr_lane;
+		struct telem_lane *lane = &telem->lanes[id];
+
+		if (lane->count) {
+			uint16_t bytes = eventBytes(&lane->events[lane->head]);
+
+			if (lane->deficit >= bytes) {
+				if (id != TELEM_LANE_BULK || bulkFits(telem, bytes)) {
+					laneTake(lane, &ev);
+					lane->deficit = lane->count ? lane->deficit - bytes : 0;
+
+					processObjEvent(telem, &ev);
+					return true;
+				}
+
+				if (!realtime->count) {
+					return false;
+				}
+			}
+		} else {
+			lane->deficit = 0;
+		}
+
+		/* Other lane's turn; a lane held back by tx space doesn't
+		 * bank quanta while it waits */
+		id = (id == TELEM_LANE_REALTIME) ? TELEM_LANE_BULK : TELEM_LANE_REALTIME;
+		lane = &telem->lanes[id];
+
+		if (lane->count &&
+				lane->deficit < eventBytes(&lane->events[lane->head])) {
+			lane->deficit += lane_quantum[id];
+		}
+
+		telem->drr_lane = id;
+	}
+
+	return false;
+}
+
 /**
  * Telemetry transmit task, regular priority
  */
 static void telemetryTxTask(void *parameters)
 {
 	telem_t telem = parameters;
+	uint32_t timeout = PIOS_QUEUE_TIMEOUT_MAX;
 
 	// Update telemetry settings
 	updateSettings();
 
+	telem->drr_lane = TELEM_LANE_REALTIME;
+
 	// Loop forever
 	while (1) {
 		UAVObjEvent ev;
 
-		// Wait for queue message
-		if (PIOS_Queue_Receive(telem->queue,&ev,
-					PIOS_QUEUE_TIMEOUT_MAX) == true) {
-			// Process event
-			processObjEvent(telem, &ev);
+		if (telem->have_held && laneAdd(telem, &telem->held_ev)) {
+			telem->have_held = false;
+		}
+
+		if (telem->have_held) {
+			if (timeout) {
+				PIOS_Thread_Sleep(TX_SPACE_RETRY_MS);
+			}
+		} else {
+			/* Sort what has arrived into the lanes, blocking only
+			 * when there is nothing to send */
+			while (PIOS_Queue_Receive(telem->queue, &ev, timeout)) {
+				timeout = 0;
+
+				if (!laneAdd(telem, &ev)) {
+					telem->held_ev = ev;
+					telem->have_held = true;
+					break;
+				}
+			}
+		}
+
+		if (processNextEvent(telem)) {
+			timeout = 0;
 
 			PIOS_Mutex_Lock(telem->ack_mutex, PIOS_MUTEX_TIMEOUT_MAX);
 			ackHousekeeping(telem);
 			PIOS_Mutex_Unlock(telem->ack_mutex);
+		} else if (lanesPending(telem)) {
+			timeout = TX_SPACE_RETRY_MS;
+		} else {
+			timeout = PIOS_QUEUE_TIMEOUT_MAX;
 		}
 	}
 }
@@ -682,6 +1093,41 @@ static int32_t transmitData(void *ctx, uint8_t * data, int32_t length)
 	return -1;
 }
 
+/**
+ * Reserve room for a whole frame in the transmit queue of the current port,
+ * so UAVTalk can pack it there directly.
+ * \param[in] length Length of the frame
+ * \return where to build the frame, or NULL to send it with transmitData
+ */
+static uint8_t *reserveTransmit(void *ctx, int32_t length)
+{
+	telem_t telem = ctx;
+
+	uintptr_t outputPort = getComPort();
+
+	if (!outputPort)
+		return NULL;
+
+	uint8_t *buf = PIOS_COM_ReserveBuffer(outputPort, length);
+
+	if (buf)
+		telem->reserved_port = outputPort;
+
+	return buf;
+}
+
+/**
+ * Send a frame built by reserveTransmit
+ * \param[in] length Length of the frame
+ * \return number of bytes sent
+ */
+static int32_t commitTransmit(void *ctx, int32_t length)
+{
+	telem_t telem = ctx;
+
+	return PIOS_COM_CommitBuffer(telem->reserved_port, length);
+}
+
 /**
  * Set update period of object (it must be already setup for periodic updates)
  * \param[in] obj The object to update
@@ -736,6 +1182,8 @@ static void updateTelemetryStats(telem_t telem)
 	FlightTelemetryStatsGet(&flightStats);
 	GCSTelemetryStatsGet(&gcsStats);
 
+	flightStats.UpdatePeriodScale = 1 << telem->rate_shift;
+
 	// Update stats object
 	if (flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED) {
 		/* This is bogus because updates to GCSTelemetryStats trigger
@@ -746,6 +1194,8 @@ static void updateTelemetryStats(telem_t telem)
 		flightStats.RxFailures += utalkStats.rxErrors;
 		flightStats.TxFailures += telem->tx_errors;
 		flightStats.TxRetries += telem->tx_retries;
+		telem->link_errors += utalkStats.rxErrors + telem->tx_errors +
+			telem->tx_retries;
 		telem->tx_errors = 0;
 		telem->tx_retries = 0;
 	} else {
@@ -800,6 +1250,9 @@ static void updateTelemetryStats(telem_t telem)
 		AlarmsSet(SYSTEMALARMS_ALARM_TELEMETRY, SYSTEMALARMS_ALARM_ERROR);
 	}
 
+	checkSpeedNegotiation(telem,
+			flightStats.Status == FLIGHTTELEMETRYSTATS_STATUS_CONNECTED);
+
 	// Update object
 	FlightTelemetryStatsSet(&flightStats);
 
@@ -809,6 +1262,165 @@ static void updateTelemetryStats(telem_t telem)
 	}
 }
 
+/**
+ * Adjust the periodic update rates to what the link keeps up with.  Called
+ * every stats period; a deep or overflowing realtime lane or frames lost
+ * either way double the periods, a few quiet periods in a row halve them
+ * again.
+ */
+static void adaptUpdateRates(telem_t telem)
+{
+	uint8_t adapt;
+	ModuleSettingsTelemetryRateAdaptGet(&adapt);
+
+	uint8_t shift = telem->rate_shift;
+
+	if (adapt != MODULESETTINGS_TELEMETRYRATEADAPT_TRUE) {
+		shift = 0;
+	} else if (telem->lane_overflows ||
+			telem->realtime_peak >= RATE_CONGESTED_DEPTH ||
+			telem->link_errors) {
+		telem->quiet_periods = 0;
+
+		if (shift < RATE_MAX_SHIFT) {
+			shift++;
+		}
+	} else if (telem->realtime_peak <= RATE_QUIET_DEPTH && shift > 0) {
+		if (++telem->quiet_periods >= RATE_RECOVER_PERIODS) {
+			telem->quiet_periods = 0;
+			shift--;
+		}
+	} else {
+		telem->quiet_periods = 0;
+	}
+
+	telem->realtime_peak = 0;
+	telem->lane_overflows = 0;
+	telem->link_errors = 0;
+
+	if (shift != telem->rate_shift) {
+		telem->rate_shift = shift;
+
+		UAVObjIterate(&updateObjectShim);
+
+		uint8_t scale = 1 << shift;
+		FlightTelemetryStatsUpdatePeriodScaleSet(&scale);
+	}
+}
+
+/**
+ * Called each time the GCS writes the speed negotiation object.
+ * Try switches the RF port to the requested speed, once the ack had time
+ * to go out; Commit, received at the new speed, keeps it.
+ */
+static void speedNegotiationUpdated(telem_t telem)
+{
+	TelemetrySpeedNegotiationData negotiation;
+	TelemetrySpeedNegotiationGet(&negotiation);
+
+	if (!PIOS_COM_TELEM_RF || getComPort() != PIOS_COM_TELEM_RF) {
+		return;
+	}
+
+	switch (negotiation.Command) {
+	case TELEMETRYSPEEDNEGOTIATION_COMMAND_TRY:
+		// Bluetooth modules are set up for the configured speed only
+		if (telem->trial_speed || !configuredSpeed()) {
+			return;
+		}
+
+		for (uint32_t i = 0; i < NELEMENTS(negotiable_speeds); i++) {
+			if (negotiable_speeds[i] != negotiation.Speed) {
+				continue;
+			}
+
+			PIOS_Thread_Sleep(SPEED_SWITCH_DELAY_MS);
+			PIOS_COM_ChangeBaud(PIOS_COM_TELEM_RF, negotiation.Speed);
+
+			telem->trial_speed = negotiation.Speed;
+			telem->trial_deadline = PIOS_Thread_Systime() +
+				SPEED_TRIAL_TIMEOUT_MS;
+			break;
+		}
+		break;
+	case TELEMETRYSPEEDNEGOTIATION_COMMAND_COMMIT:
+		if (telem->trial_speed && telem->trial_speed == negotiation.Speed) {
+			telem->negotiated_speed = telem->trial_speed;
+			telem->trial_speed = 0;
+		}
+		break;
+	}
+}
+
+/**
+ * Send a ping from the GCS back, stamped with when it came in and when it
+ * goes out.  It waits its turn with the realtime objects, so the GCS sees
+ * the delay those get.
+ */
+static void pingEcho(telem_t telem)
+{
+	TelemetryPingData ping;
+	TelemetryPingGet(&ping);
+
+	ping.FlightRxTime = ping_rx_time;
+	ping.FlightTxTime = PIOS_Thread_Systime();
+	TelemetryPingSet(&ping);
+
+	if (UAVTalkSendObject(telem->uavTalkCon, TelemetryPingHandle(), 0,
+				false) == -1) {
+		telem->tx_errors++;
+	}
+}
+
+/**
+ * Go back from a speed tried but not committed in time, and to the
+ * configured speed once the GCS is gone so it can connect again.
+ * \param[in] connected whether the GCS is connected
+ */
+static void checkSpeedNegotiation(telem_t telem, bool connected)
+{
+	if (telem->trial_speed &&
+			(int32_t)(PIOS_Thread_Systime() - telem->trial_deadline) >= 0) {
+		telem->trial_speed = 0;
+
+		PIOS_COM_ChangeBaud(PIOS_COM_TELEM_RF, telem->negotiated_speed ?
+				telem->negotiated_speed : configuredSpeed());
+	}
+
+	if (!connected && !telem->trial_speed && telem->negotiated_speed) {
+		telem->negotiated_speed = 0;
+
+		PIOS_COM_ChangeBaud(PIOS_COM_TELEM_RF, configuredSpeed());
+	}
+}
+
+/**
+ * Get the configured telemetry speed
+ * \return the speed in bps, 0 for the Bluetooth module setup options
+ */
+static uint32_t configuredSpeed()
+{
+	uint8_t speed;
+	ModuleSettingsTelemetrySpeedGet(&speed);
+
+	switch (speed) {
+	case MODULESETTINGS_TELEMETRYSPEED_9600:
+		return 9600;
+	case MODULESETTINGS_TELEMETRYSPEED_19200:
+		return 19200;
+	case MODULESETTINGS_TELEMETRYSPEED_38400:
+		return 38400;
+	case MODULESETTINGS_TELEMETRYSPEED_57600:
+		return 57600;
+	case MODULESETTINGS_TELEMETRYSPEED_115200:
+		return 115200;
+	case MODULESETTINGS_TELEMETRYSPEED_230400:
+		return 230400;
+	}
+
+	return 0;
+}
+
 /**
  * Update the telemetry settings, called on startup.
  */
@@ -851,6 +1463,17 @@ static uintptr_t getComPort()
 /**
  * SessionManaging object updated callback
  */
+/**
+ * Note when a ping arrives; called from the receive task as it is unpacked
+ */
+static void ping_received(UAVObjEvent * ev, void *ctx, void *obj, int len)
+{
+	(void) ctx; (void) obj; (void) len;
+	if (ev->event == EV_UNPACKED) {
+		ping_rx_time = PIOS_Thread_Systime();
+	}
+}
+
 static void session_managing_updated(UAVObjEvent * ev, void *ctx, void *obj, int len)
 {
 	(void) ctx; (void) obj; (void) len;
@@ -872,6 +1495,48 @@ static void session_managing_updated(UAVObjEvent * ev, void *ctx, void *obj, int
 	}
 }
 
+/**
+ * SettingsDigest object updated callback
+ *
+ * The GCS writes the index of the first object it is interested in; reply
+ * with the IDs and data CRCs of the next settings objects from there on.
+ * A partially filled reply marks the end of the list.
+ */
+static void settings_digest_updated(UAVObjEvent * ev, void *ctx, void *obj, int len)
+{
+	(void) ctx; (void) obj; (void) len;
+	if (ev->event != EV_UNPACKED) {
+		return;
+	}
+
+	SettingsDigestData digest;
+	SettingsDigestGet(&digest);
+
+	uint8_t count = UAVObjCount();
+	uint8_t index = digest.ObjectIndex;
+	uint8_t n = 0;
+
+	for (; index < count && n < SETTINGSDIGEST_OBJECTID_NUMELEM; index++) {
+		UAVObjHandle handle = UAVObjGetByID(UAVObjIDByIndex(index));
+
+		if (!handle || !UAVObjIsSettings(handle)) {
+			continue;
+		}
+
+		digest.ObjectID[n] = UAVObjGetID(handle);
+		digest.DataCRC[n] = UAVObjGetDataCRC(handle);
+		n++;
+	}
+
+	for (; n < SETTINGSDIGEST_OBJECTID_NUMELEM; n++) {
+		digest.ObjectID[n] = 0;
+		digest.DataCRC[n] = 0;
+	}
+
+	digest.NextObjectIndex = index;
+	SettingsDigestSet(&digest);
+}
+
 /**
  * New UAVO object instance callback
  * This is called from the uavobjectmanager
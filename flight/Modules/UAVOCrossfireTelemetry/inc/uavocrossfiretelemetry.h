@@ -31,7 +31,9 @@
 
 #include "pios_crossfire.h"
 
-// Update each object how often
-#define UPDATE_HZ					3
+// Update each object how often, link permitting
+#define ATTITUDE_UPDATE_HZ			10
+#define BATTERY_UPDATE_HZ			2
+#define GPS_UPDATE_HZ				5
 
 #endif // UAVOCROSSFIRETELEMETRY_H
@@ -190,44 +190,103 @@ static int crsftelem_create_gps(uint8_t *buf)
 	return pos;
 }
 
-static void uavoCrossfireTelemetryTask(void *parameters)
+struct crsftelem_sensor {
+	int (*create)(uint8_t *buf);
+	uint8_t len;
+	uint16_t period;
+};
+
+// Everything we know how to send, with the longest frame each produces.
+static const struct crsftelem_sensor crsftelem_sensors[] = {
+	{ crsftelem_create_attitude, CRSF_FRAME_LEN(CRSF_PAYLOAD_ATTITUDE), 1000 / ATTITUDE_UPDATE_HZ },
+	{ crsftelem_create_battery, CRSF_FRAME_LEN(CRSF_PAYLOAD_BATTERY), 1000 / BATTERY_UPDATE_HZ },
+	{ crsftelem_create_gps, CRSF_FRAME_LEN(CRSF_PAYLOAD_GPS), 1000 / GPS_UPDATE_HZ },
+};
+
+#define NUM_SENSORS NELEMENTS(crsftelem_sensors)
+
+static uint32_t crsftelem_last_sent[NUM_SENSORS];
+
+/**
+ * Fill one telemetry slot. Sensors that are due go in stalest first,
+ * relative to their update rate, for as long as they fit the budget.
+ * @param[out] buf burst buffer
+ * @param[in] budget number of bytes the slot can take
+ * @param[in] now current system time in ms
+ * @returns number of bytes in buf
+ */
+static int crsftelem_fill_slot(uint8_t *buf, uint8_t budget, uint32_t now)
 {
-	// Three objects, each at UPDATE_HZ
-	uint32_t idledelay = 1000 / (3 * UPDATE_HZ);
-	uint8_t counter = 0;
+	bool done[NUM_SENSORS] = { false };
+	int pos = 0;
 
+	while (1) {
+		int best = -1;
+		uint32_t best_stale = 0;
+
+		for (int i = 0; i < NUM_SENSORS; i++) {
+			const struct crsftelem_sensor *s = &crsftelem_sensors[i];
+
+			if (done[i] || pos + s->len > budget)
+				continue;
+
+			uint32_t age = now - crsftelem_last_sent[i];
+			if (age > 60000)
+				age = 60000;
+
+			// Staleness in 1/256ths of the update period; due at 256.
+			uint32_t stale = (age << 8) / s->period;
+
+			if (stale >= 256 && stale > best_stale) {
+				best = i;
+				best_stale = stale;
+			}
+		}
+
+		if (best < 0)
+			break;
+
+		// Sensors without anything to say (e.g. no GPS fix) come back
+		// around at their normal rate.
+		done[best] = true;
+		crsftelem_last_sent[best] = now;
+		pos += crsftelem_sensors[best].create(buf + pos);
+	}
+
+	return pos;
+}
+
+static void uavoCrossfireTelemetryTask(void *parameters)
+{
 	// Wait for stuff to setup?
 	PIOS_Thread_Sleep(1000);
 
 	while (1) {
-		uint8_t buf[CRSF_MAX_FRAMELEN];
-		uint8_t len = 0;
+		uint8_t buf[CRSF_MAX_TELEMBURST];
+		uint32_t period_us;
+		uint8_t budget = PIOS_Crossfire_GetTelemetrySlot(crsf_telem_dev_id, &period_us);
 
-		if(!PIOS_Crossfire_IsFailsafed(crsf_telem_dev_id)) {
+		// Every RC frame makes a slot; sleep through to the next one.
+		uint32_t slot_ms = period_us / 1000;
+		if (slot_ms < 1)
+			slot_ms = 1;
 
-			switch(counter++ % 3) {
-				default:
-				case 0: // Attitude
-					len = crsftelem_create_attitude(buf);
-					break;
-				case 1: // Battery
-					len = crsftelem_create_battery(buf);
-					break;
-				case 2: // GPS
-					len = crsftelem_create_gps(buf);
-					break;
-			}
+		if(!PIOS_Crossfire_IsFailsafed(crsf_telem_dev_id)) {
+			int len = crsftelem_fill_slot(buf, budget, PIOS_Thread_Systime());
 
 			if(len) {
 				while(PIOS_Crossfire_SendTelemetry(crsf_telem_dev_id, buf, len)) {
-					// Keep repeating until telemetry went through, without
-					// locking up the whole thing.
-					PIOS_Thread_Sleep(2);
+					// Keep repeating until the next window comes around,
+					// without locking up the whole thing.
+					if(PIOS_Crossfire_IsFailsafed(crsf_telem_dev_id))
+						break;
+
+					PIOS_Thread_Sleep(1);
 				}
 			}
 		}
 
-		PIOS_Thread_Sleep(idledelay);
+		PIOS_Thread_Sleep(slot_ms);
 	}
 }
 
@@ -60,6 +60,7 @@
 
 static void uavoMavlinkBridgeTask(void *parameters);
 static bool stream_trigger(enum MAV_DATA_STREAM stream_num);
+static void receive_requests();
 
 // ****************
 // Private constants
@@ -73,6 +74,11 @@ static bool stream_trigger(enum MAV_DATA_STREAM stream_num);
 #define TASK_PRIORITY               PIOS_THREAD_PRIO_LOW
 #define TASK_RATE_HZ				10
 
+// Not in the generated headers of this MAVLink version
+#define REQUEST_DATA_STREAM_CRC_EXTRA 148
+
+#define RX_CHUNK_LEN 16
+
 static const uint8_t mav_rates[] =
 	 { [MAV_DATA_STREAM_RAW_SENSORS]=0x02, //2Hz
 	   [MAV_DATA_STREAM_EXTENDED_STATUS]=0x02, //2Hz
@@ -92,10 +98,29 @@ static uint32_t mavlink_port;
 
 static bool module_enabled = false;
 
+// Whether requests can be read from the port
+static bool receive_enabled = false;
+
 static uint8_t * stream_ticks;
 
+static uint8_t * stream_rates;
+
 static mavlink_message_t *mav_msg;
 
+// Bytes the port can carry in a task period, and what is left of it
+static int32_t tx_tick_budget;
+static int32_t tx_credit;
+
+// Just enough of a MAVLink parser to pick up REQUEST_DATA_STREAM
+static struct {
+	uint16_t idx;
+	uint8_t len;
+	uint8_t msgid;
+	uint8_t ck_a;
+	uint16_t crc;
+	uint8_t payload[MAVLINK_MSG_ID_REQUEST_DATA_STREAM_LEN];
+} mav_rx;
+
 static void updateSettings();
 
 /**
@@ -125,12 +150,21 @@ static int32_t uavoMavlinkBridgeInitialize(void) {
 	if (mavlink_port && PIOS_Modules_IsEnabled(PIOS_MODULE_UAVOMAVLINKBRIDGE)) {
 		updateSettings();
 
+		// A port shared with the GPS receives for the GPS module
+		receive_enabled = PIOS_COM_HasReceiveBuffer(mavlink_port);
+#if defined(PIOS_COM_GPS)
+		if (mavlink_port == PIOS_COM_GPS)
+			receive_enabled = false;
+#endif
+
 		mav_msg = PIOS_malloc(sizeof(*mav_msg));
 		stream_ticks = PIOS_malloc_no_dma(MAXSTREAMS);
+		stream_rates = PIOS_malloc_no_dma(MAXSTREAMS);
 
-		if (mav_msg && stream_ticks) {
+		if (mav_msg && stream_ticks && stream_rates) {
 			for (int x = 0; x < MAXSTREAMS; ++x) {
-				stream_ticks[x] = (TASK_RATE_HZ / mav_rates[x]);
+				stream_rates[x] = mav_rates[x];
+				stream_ticks[x] = mav_rates[x] ? (TASK_RATE_HZ / mav_rates[x]) : 0;
 			}
 
 			module_enabled = true;
@@ -149,6 +183,93 @@ static void send_message() {
 		mav_msg->len;
 
 	PIOS_COM_SendBuffer(mavlink_port, &mav_msg->magic, msg_length);
+	tx_credit -= msg_length;
+}
+
+/**
+ * Change the rate of a stream, or of all of them, as a ground station asks
+ * with REQUEST_DATA_STREAM
+ */
+static void set_stream_rate(uint8_t stream_id, uint16_t rate, bool start)
+{
+	if (!start)
+		rate = 0;
+	else if (rate > TASK_RATE_HZ)
+		rate = TASK_RATE_HZ;
+
+	for (int x = 0; x < MAXSTREAMS; ++x) {
+		if (stream_id != MAV_DATA_STREAM_ALL && stream_id != x)
+			continue;
+		// Only streams that are implemented can be started
+		if (mav_rates[x] == 0)
+			continue;
+
+		stream_rates[x] = rate;
+		stream_ticks[x] = 0;
+	}
+}
+
+/**
+ * Feed a received byte through the parser, acting on the requests found
+ */
+static void parse_request_byte(uint8_t c)
+{
+	if (mav_rx.idx == 0) {
+		if (c == MAVLINK_STX) {
+			mav_rx.idx = 1;
+			crc_init(&mav_rx.crc);
+		}
+		return;
+	}
+
+	uint16_t pos = mav_rx.idx++;
+
+	// Header after STX: length, sequence, system, component, message id
+	if (pos <= MAVLINK_CORE_HEADER_LEN + mav_rx.len) {
+		if (pos == 1)
+			mav_rx.len = c;
+		else if (pos == MAVLINK_CORE_HEADER_LEN)
+			mav_rx.msgid = c;
+		else if (pos > MAVLINK_CORE_HEADER_LEN &&
+				pos - MAVLINK_CORE_HEADER_LEN <= sizeof(mav_rx.payload))
+			mav_rx.payload[pos - MAVLINK_CORE_HEADER_LEN - 1] = c;
+
+		crc_accumulate(c, &mav_rx.crc);
+		return;
+	}
+
+	if (pos == MAVLINK_CORE_HEADER_LEN + mav_rx.len + 1) {
+		mav_rx.ck_a = c;
+		return;
+	}
+
+	mav_rx.idx = 0;
+
+	if (mav_rx.msgid != MAVLINK_MSG_ID_REQUEST_DATA_STREAM ||
+			mav_rx.len != MAVLINK_MSG_ID_REQUEST_DATA_STREAM_LEN)
+		return;
+
+	crc_accumulate(REQUEST_DATA_STREAM_CRC_EXTRA, &mav_rx.crc);
+	if (mav_rx.ck_a != (mav_rx.crc & 0xff) || c != (mav_rx.crc >> 8))
+		return;
+
+	// Payload is in wire order: rate (LE), system, component, stream, start
+	uint16_t rate = mav_rx.payload[0] | (mav_rx.payload[1] << 8);
+	set_stream_rate(mav_rx.payload[4], rate, mav_rx.payload[5] != 0);
+}
+
+static void receive_requests()
+{
+	uint8_t buf[RX_CHUNK_LEN];
+	uint16_t len;
+
+	if (!receive_enabled)
+		return;
+
+	while ((len = PIOS_COM_ReceiveBuffer(mavlink_port, buf, sizeof(buf), 0)) > 0) {
+		for (uint16_t i = 0; i < len; i++)
+			parse_request_byte(buf[i]);
+	}
 }
 
 /**
@@ -166,18 +287,47 @@ static void uavoMavlinkBridgeTask(void *parameters) {
 		FlightBatterySettingsGet(&batSettings);
 
 	SystemStatsData systemStats;
+	FlightStatusData flightStatus;
+	GPSPositionData gpsPosData;
+	AttitudeActualData attActual;
 
 	while (1) {
 		PIOS_Thread_Sleep_Until(&lastSysTime, 1000 / TASK_RATE_HZ);
 
-		if (stream_trigger(MAV_DATA_STREAM_EXTENDED_STATUS)) {
+		receive_requests();
+
+		// What wasn't used of the last period isn't saved up, so
+		// streams held back don't all go out at once later
+		tx_credit += tx_tick_budget;
+		if (tx_credit > tx_tick_budget)
+			tx_credit = tx_tick_budget;
+
+		bool status_due = stream_trigger(MAV_DATA_STREAM_EXTENDED_STATUS);
+		bool rc_due = stream_trigger(MAV_DATA_STREAM_RC_CHANNELS);
+		bool position_due = stream_trigger(MAV_DATA_STREAM_POSITION);
+		bool extra1_due = stream_trigger(MAV_DATA_STREAM_EXTRA1);
+		bool extra2_due = stream_trigger(MAV_DATA_STREAM_EXTRA2);
+
+		// Each object is fetched once per tick, however many of the due
+		// streams use it, so the object lock is taken only once for it
+		if (status_due || rc_due || position_due || extra1_due)
+			SystemStatsGet(&systemStats);
+		if (extra2_due)
+			FlightStatusGet(&flightStatus);
+		if (position_due || extra2_due) {
+			memset(&gpsPosData, 0, sizeof(gpsPosData));
+			if (GPSPositionHandle() != NULL )
+				GPSPositionGet(&gpsPosData);
+		}
+		if (extra1_due || extra2_due)
+			AttitudeActualGet(&attActual);
+
+		if (status_due) {
 			FlightBatteryStateData batState = {};
 
 			if (FlightBatteryStateHandle() != NULL )
 				FlightBatteryStateGet(&batState);
 
-			SystemStatsGet(&systemStats);
-
 			int8_t battery_remaining = 0;
 			if (batSettings.Capacity != 0) {
 				if (batState.ConsumedEnergy < batSettings.Capacity) {
@@ -224,13 +374,10 @@ static void uavoMavlinkBridgeTask(void *parameters) {
 			send_message();
 		}
 
-		if (stream_trigger(MAV_DATA_STREAM_RC_CHANNELS)) {
+		if (rc_due) {
 			ManualControlCommandData manualState;
-			FlightStatusData flightStatus;
 
 			ManualControlCommandGet(&manualState);
-			FlightStatusGet(&flightStatus);
-			SystemStatsGet(&systemStats);
 
 			//TODO connect with RSSI object and pass in last argument
 			mavlink_msg_rc_channels_raw_pack(0, 200, mav_msg,
@@ -260,16 +407,11 @@ static void uavoMavlinkBridgeTask(void *parameters) {
 			send_message();
 		}
 
-		if (stream_trigger(MAV_DATA_STREAM_POSITION)) {
-			GPSPositionData gpsPosData = {};
+		if (position_due) {
 			HomeLocationData homeLocation = {};
-			SystemStatsGet(&systemStats);
 
-			if (GPSPositionHandle() != NULL )
-				GPSPositionGet(&gpsPosData);
 			if (HomeLocationHandle() != NULL )
 				HomeLocationGet(&homeLocation);
-			SystemStatsGet(&systemStats);
 
 			uint8_t gps_fix_type;
 			switch (gpsPosData.Status)
@@ -337,13 +479,7 @@ static void uavoMavlinkBridgeTask(void *parameters) {
 			//mavlink_msg_mission_current_pack
 		}
 
-		if (stream_trigger(MAV_DATA_STREAM_EXTRA1)) {
-			AttitudeActualData attActual;
-			SystemStatsData systemStats;
-
-			AttitudeActualGet(&attActual);
-			SystemStatsGet(&systemStats);
-
+		if (extra1_due) {
 			mavlink_msg_attitude_pack(0, 200, mav_msg,
 					// time_boot_ms Timestamp (milliseconds since system boot)
 					systemStats.FlightTime,
@@ -363,23 +499,16 @@ static void uavoMavlinkBridgeTask(void *parameters) {
 			send_message();
 		}
 
-		if (stream_trigger(MAV_DATA_STREAM_EXTRA2)) {
+		if (extra2_due) {
 			ActuatorDesiredData actDesired;
-			AttitudeActualData attActual;
 			AirspeedActualData airspeedActual = {};
-			GPSPositionData gpsPosData = {};
 			BaroAltitudeData baroAltitude = {};
-			FlightStatusData flightStatus;
 
 			if (AirspeedActualHandle() != NULL )
 				AirspeedActualGet(&airspeedActual);
-			if (GPSPositionHandle() != NULL )
-				GPSPositionGet(&gpsPosData);
 			if (BaroAltitudeHandle() != NULL )
 				BaroAltitudeGet(&baroAltitude);
 			ActuatorDesiredGet(&actDesired);
-			AttitudeActualGet(&attActual);
-			FlightStatusGet(&flightStatus);
 
 			float altitude = 0;
 			if (BaroAltitudeHandle() != NULL)
@@ -471,13 +600,18 @@ static void uavoMavlinkBridgeTask(void *parameters) {
 }
 
 static bool stream_trigger(enum MAV_DATA_STREAM stream_num) {
-	uint8_t rate = (uint8_t) mav_rates[stream_num];
+	uint8_t rate = stream_rates[stream_num];
 
 	if (rate == 0) {
 		return false;
 	}
 
 	if (stream_ticks[stream_num] == 0) {
+		// the port is full, keep the stream due until it has room
+		if (tx_credit <= 0) {
+			return false;
+		}
+
 		// we're triggering now, setup the next trigger point
 		if (rate > TASK_RATE_HZ) {
 			rate = TASK_RATE_HZ;
@@ -500,6 +634,42 @@ static void updateSettings()
 		ModuleSettingsMavlinkSpeedGet(&speed);
 
 		PIOS_HAL_ConfigureSerialSpeed(mavlink_port, speed);
+
+		uint32_t bps;
+		switch (speed) {
+		case MODULESETTINGS_MAVLINKSPEED_1200:
+			bps = 1200;
+			break;
+		case MODULESETTINGS_MAVLINKSPEED_2400:
+			bps = 2400;
+			break;
+		case MODULESETTINGS_MAVLINKSPEED_4800:
+			bps = 4800;
+			break;
+		case MODULESETTINGS_MAVLINKSPEED_9600:
+			bps = 9600;
+			break;
+		case MODULESETTINGS_MAVLINKSPEED_19200:
+			bps = 19200;
+			break;
+		case MODULESETTINGS_MAVLINKSPEED_38400:
+			bps = 38400;
+			break;
+		case MODULESETTINGS_MAVLINKSPEED_57600:
+			bps = 57600;
+			break;
+		case MODULESETTINGS_MAVLINKSPEED_230400:
+			bps = 230400;
+			break;
+		default:
+			// 115200, and the Bluetooth modules are set up for it
+			bps = 115200;
+			break;
+		}
+
+		// 10 bits on the wire per byte
+		tx_tick_budget = bps / 10 / TASK_RATE_HZ;
+		tx_credit = tx_tick_budget;
 	}
 }
 /**
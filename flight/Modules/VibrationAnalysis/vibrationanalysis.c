@@ -29,15 +29,18 @@
 
 /**
  * Input objects: @ref Accels, @ref VibrationAnalysisSettings
- * Output object: @ref VibrationAnalysisOutput
+ * Output object: @ref VibrationAnalysisOutput, @ref VibrationAnalysisSpectrum
  *
  * This module executes on a timer trigger. When the module is
  * triggered it will update the data of VibrationAnalysiOutput,
- * with the accumulated accelerometer samples. 
+ * with the accumulated accelerometer samples. In spectrum output mode
+ * the window is transformed on board instead, and only the quantized
+ * log magnitude of the bins is sent in VibrationAnalysisSpectrum.
  */
 
 #include "openpilot.h"
 #include "physical_constants.h"
+#include "misc_math.h"
 #include "pios_thread.h"
 #include "pios_queue.h"
 
@@ -45,13 +48,14 @@
 #include "modulesettings.h"
 #include "vibrationanalysisoutput.h"
 #include "vibrationanalysissettings.h"
+#include "vibrationanalysisspectrum.h"
 
 
 // Private constants
 
 #define MAX_QUEUE_SIZE 2
 
-#define STACK_SIZE_BYTES (200 + 448 + 16 + (2*3*window_size)*0) // The memory requirement grows linearly 
+#define STACK_SIZE_BYTES (200 + 448 + 16 + 128 + (2*3*window_size)*0) // The memory requirement grows linearly 
 																				  // with window size. The constant is multiplied
 																				  // by 0 in order to reflect the fact that the
 																				  // malloc'ed memory is not taken from the module 
@@ -67,6 +71,11 @@
 
 #define MAX_WINDOW_SIZE 1024
 
+#define MAX_SPECTRUM_WINDOW_SIZE 256  // Bounds the spectrum working memory to a few kB
+#define SPECTRUM_BINS_PER_INSTANCE 32 // Number of bins per axis in each VibrationAnalysisSpectrum update
+#define SPECTRUM_DB_PER_LSB 0.5f      // Quantization step of the log magnitude
+#define SPECTRUM_DB_OFFSET -80.0f     // Log magnitude sent as 0, in dB relative to 1 m/s^2
+
 // Comment for larger smaller buffers and much better accuracy. The maximum window size will be allocated.
 #define USE_SINGLE_INSTANCE_BUFFERS 1
 
@@ -98,9 +107,18 @@ static struct VibrationAnalysis_data {
 	int16_t *accel_buffer_z;
 } *vtd;
 
+// Spectrum mode working memory, allocated the first time the mode is used
+static struct VibrationAnalysis_spectrum {
+	int16_t samples[3][MAX_SPECTRUM_WINDOW_SIZE];
+	float re[MAX_SPECTRUM_WINDOW_SIZE];
+	float im[MAX_SPECTRUM_WINDOW_SIZE];
+	uint8_t bins[3][MAX_SPECTRUM_WINDOW_SIZE / 2];
+} *vsd;
+
 
 // Private functions
 static void VibrationAnalysisTask(void *parameters);
+static void VibrationAnalysisSendSpectrum(uint16_t window_size);
 
 /*
 *   Releases any memory dinamically allocated
@@ -320,7 +338,8 @@ static int32_t VibrationAnalysisInitialize(void)
 		return -1;
 
 	// Initialize UAVOs
-	if (VibrationAnalysisSettingsInitialize() == -1 || VibrationAnalysisOutputInitialize() == -1) {
+	if (VibrationAnalysisSettingsInitialize() == -1 || VibrationAnalysisOutputInitialize() == -1 ||
+			VibrationAnalysisSpectrumInitialize() == -1) {
         module_enabled = false;
         return -1;
     }
@@ -341,6 +360,7 @@ static void VibrationAnalysisTask(void *parameters)
     uint8_t runAnalysisFlag = VIBRATIONANALYSISSETTINGS_TESTINGSTATUS_OFF; // By default, turn analysis off
     uint16_t sampleRate_ms = 100; // Default sample rate of 100ms
     uint16_t sample_count;
+    uint16_t spectrum_window = 0; // Window size in spectrum mode, 0 to send time samples
     
     UAVObjEvent ev;
     
@@ -386,6 +406,30 @@ static void VibrationAnalysisTask(void *parameters)
             
             vibrationAnalysisOutputData.samples = vtd->window_size;
 
+            // Check if the spectrum is to be computed here
+            uint8_t output_mode;
+            VibrationAnalysisSettingsOutputModeGet(&output_mode);
+            spectrum_window = 0;
+            if (output_mode == VIBRATIONANALYSISSETTINGS_OUTPUTMODE_SPECTRUM) {
+                if (vsd == NULL)
+                    vsd = (struct VibrationAnalysis_spectrum *) PIOS_malloc(sizeof(*vsd));
+
+                // Without memory, fall back to sending the time samples
+                if (vsd != NULL)
+                    spectrum_window = MIN(vtd->window_size, MAX_SPECTRUM_WINDOW_SIZE);
+
+                // Each chunk of bins goes out in its own instance, as
+                // updates of one instance would be coalesced by telemetry
+                uint16_t chunks = (spectrum_window / 2 + SPECTRUM_BINS_PER_INSTANCE - 1) / SPECTRUM_BINS_PER_INSTANCE;
+                for (uint16_t i = VibrationAnalysisSpectrumGetNumInstances(); i < chunks; i++) {
+                    if (VibrationAnalysisSpectrumCreateInstance() == 0)
+                        break;
+                }
+
+                if (VibrationAnalysisSpectrumGetNumInstances() < chunks)
+                    spectrum_window = 0;
+            }
+
             lastSettingsUpdateTime = PIOS_Thread_Systime();
 
             runningAcquisition = 1;
@@ -429,10 +473,10 @@ static void VibrationAnalysisTask(void *parameters)
         vtd->accels_static_bias_y = alpha*accels_avg_y + (1-alpha)*vtd->accels_static_bias_y;
         vtd->accels_static_bias_z = alpha*accels_avg_z + (1-alpha)*vtd->accels_static_bias_z;
         
-        // Add averaged values to the buffer, and remove DC bias.
-        vtd->accel_buffer_x[sample_count] = (accels_avg_x - vtd->accels_static_bias_x)*FLOAT_TO_FIXED;
-        vtd->accel_buffer_y[sample_count] = (accels_avg_y - vtd->accels_static_bias_y)*FLOAT_TO_FIXED;
-        vtd->accel_buffer_z[sample_count] = (accels_avg_z - vtd->accels_static_bias_z)*FLOAT_TO_FIXED;
+        // Remove DC bias.
+        int16_t sample_x = (accels_avg_x - vtd->accels_static_bias_x)*FLOAT_TO_FIXED;
+        int16_t sample_y = (accels_avg_y - vtd->accels_static_bias_y)*FLOAT_TO_FIXED;
+        int16_t sample_z = (accels_avg_z - vtd->accels_static_bias_z)*FLOAT_TO_FIXED;
         
         //Reset the accumulators
         vtd->accels_data_sum_x = 0;
@@ -440,6 +484,26 @@ static void VibrationAnalysisTask(void *parameters)
         vtd->accels_data_sum_z = 0;
         vtd->accels_sum_count = 0;
 
+        // In spectrum mode, collect the full window and send its spectrum
+        if (spectrum_window > 0) {
+            vsd->samples[0][sample_count] = sample_x;
+            vsd->samples[1][sample_count] = sample_y;
+            vsd->samples[2][sample_count] = sample_z;
+
+            if (++sample_count == spectrum_window) {
+                VibrationAnalysisSendSpectrum(spectrum_window);
+
+                sample_count = 0;
+                runningAcquisition = 0;
+            }
+            continue;
+        }
+
+        // Add averaged values to the buffer
+        vtd->accel_buffer_x[sample_count] = sample_x;
+        vtd->accel_buffer_y[sample_count] = sample_y;
+        vtd->accel_buffer_z[sample_count] = sample_z;
+
         // Advance sample and reset when at buffer end
         sample_count++;
 
@@ -488,6 +552,56 @@ static void VibrationAnalysisTask(void *parameters)
     }
 }
 
+/**
+ * Transform the collected window of each axis and send the quantized
+ * log magnitude of its bins, SPECTRUM_BINS_PER_INSTANCE bins in each instance
+ * @param[in] window_size Number of samples collected, a power of 2
+ */
+static void VibrationAnalysisSendSpectrum(uint16_t window_size)
+{
+	uint16_t num_bins = window_size / 2;
+
+	for (uint8_t axis = 0; axis < 3; axis++) {
+		// Hann window, and back to m/s^2
+		for (uint16_t i = 0; i < window_size; i++) {
+			float w = 0.5f - 0.5f * cosf(2 * PI * i / (window_size - 1));
+			vsd->re[i] = w * vsd->samples[axis][i] / FLOAT_TO_FIXED;
+			vsd->im[i] = 0;
+		}
+
+		fft_radix2(vsd->re, vsd->im, window_size);
+
+		for (uint16_t k = 0; k < num_bins; k++) {
+			// Single sided amplitude, corrected for the Hann window's gain of 1/2
+			float mag = 4 * sqrtf(vsd->re[k] * vsd->re[k] + vsd->im[k] * vsd->im[k]) / window_size;
+			float db = 20 * log10f(mag + 1e-9f);
+			float q = (db - SPECTRUM_DB_OFFSET) / SPECTRUM_DB_PER_LSB + 0.5f;
+
+			vsd->bins[axis][k] = q <= 0 ? 0 : (q >= 255 ? 255 : (uint8_t) q);
+		}
+	}
+
+	VibrationAnalysisSpectrumData spectrum;
+	spectrum.samples = num_bins;
+	spectrum.dBPerLSB = SPECTRUM_DB_PER_LSB;
+	spectrum.dBOffset = SPECTRUM_DB_OFFSET;
+
+	for (uint16_t first = 0, index = 0; first < num_bins; first += SPECTRUM_BINS_PER_INSTANCE, index++) {
+		uint16_t count = MIN(SPECTRUM_BINS_PER_INSTANCE, num_bins - first);
+
+		memset(spectrum.x, 0, sizeof(spectrum.x));
+		memset(spectrum.y, 0, sizeof(spectrum.y));
+		memset(spectrum.z, 0, sizeof(spectrum.z));
+		memcpy(spectrum.x, &vsd->bins[0][first], count);
+		memcpy(spectrum.y, &vsd->bins[1][first], count);
+		memcpy(spectrum.z, &vsd->bins[2][first], count);
+		spectrum.index = index;
+
+		VibrationAnalysisSpectrumInstSet(index, &spectrum);
+		VibrationAnalysisSpectrumInstUpdated(index);
+	}
+}
+
 /**
  * @}
  * @}
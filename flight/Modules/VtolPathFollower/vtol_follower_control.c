@@ -71,6 +71,11 @@ static float vtol_path_m=0, vtol_path_r=0, vtol_end_m=0, vtol_end_r=0;
 // Time constants converted to IIR parameter
 static float loiter_brakealpha=0.96f, loiter_errordecayalpha=0.88f;
 
+// Geometry of the path being followed, and the path it was computed from
+static struct path_segment path_seg;
+static PathDesiredData path_seg_desired;
+static bool path_seg_valid;
+
 static int32_t vtol_follower_control_impl(const float dT,
 	const float *hold_pos_ned, float alt_rate, bool update_status);
 
@@ -102,7 +107,15 @@ int32_t vtol_follower_control_path(const float dT, const PathDesiredData *pathDe
 		    velocityActual.East * guidanceSettings.PositionFeedforward,
 		positionActual.Down };
 
-	path_progress(pathDesired, cur_pos_ned, progress);
+	// The geometry only changes with the path
+	if (!path_seg_valid ||
+			memcmp(&path_seg_desired, pathDesired, sizeof(path_seg_desired))) {
+		path_seg_desired = *pathDesired;
+		path_segment_init(pathDesired, &path_seg);
+		path_seg_valid = true;
+	}
+
+	path_segment_progress(&path_seg, cur_pos_ned, progress);
 
 	// Check if we have already completed this leg
 	bool current_leg_completed = 
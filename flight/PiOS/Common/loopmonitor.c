@@ -0,0 +1,129 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ *
+ * @file       loopmonitor.c
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief      Control loop timing library
+ * @see        The GNU Public License (GPL) Version 3
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "openpilot.h"
+#include "loopmonitor.h"
+
+#if defined(DIAG_LOOPTIMING)
+#include "looptiming.h"
+#include "pios_thread.h"
+
+// Private constants
+#define LOOPMONITOR_UPDATE_PERIOD_MS	1000
+
+// Upper edges of the LoopTiming buckets, the last one takes the rest
+static const uint16_t bucket_limits_us[LOOPTIMING_SENSORREAD_NUMELEM - 1] = {
+	5, 10, 20, 50, 100, 200, 500
+};
+
+DONT_BUILD_IF(LOOPTIMING_MAX_NUMELEM != LOOPMONITOR_NUM_STAGES, LoopTimingStages);
+
+// Private variables
+
+/* Each stage is only recorded by one task.  The system task reads and
+ * clears the counts without a lock, a count caught in between may get lost.
+ */
+static uint16_t counts[LOOPMONITOR_NUM_STAGES][LOOPTIMING_SENSORREAD_NUMELEM];
+static uint16_t max_us[LOOPMONITOR_NUM_STAGES];
+static uint32_t lastUpdateTime;
+
+//! When the gyro sample the loop is working on was taken
+static volatile uint32_t sample_time;
+
+/**
+ * Count how long a stage took into its histogram
+ * @param[in] stage the stage of the loop
+ * @param[in] start raw time from LoopMonitorStart
+ */
+void LoopMonitorRecord(enum loopmonitor_stage stage, uint32_t start)
+{
+	uint32_t us = PIOS_DELAY_DiffuS(start);
+
+	int bucket = 0;
+	while (bucket < LOOPTIMING_SENSORREAD_NUMELEM - 1 && us >= bucket_limits_us[bucket])
+		bucket++;
+
+	if (counts[stage][bucket] < UINT16_MAX)
+		counts[stage][bucket]++;
+
+	if (us > max_us[stage])
+		max_us[stage] = us > UINT16_MAX ? UINT16_MAX : us;
+}
+
+/**
+ * Note the time a gyro sample came in, for the stages that span the loop
+ */
+void LoopMonitorMarkSample(void)
+{
+	sample_time = PIOS_DELAY_GetRaw();
+}
+
+/**
+ * Count the time since the last gyro sample into a stage's histogram
+ * @param[in] stage the stage of the loop
+ */
+void LoopMonitorEndFromSample(enum loopmonitor_stage stage)
+{
+	LoopMonitorRecord(stage, sample_time);
+}
+#endif /* DIAG_LOOPTIMING */
+
+/**
+ * Publish the stage timings counted since the last update, once a second
+ */
+void LoopMonitorUpdateAll(void)
+{
+#if defined(DIAG_LOOPTIMING)
+	uint32_t now = PIOS_Thread_Systime();
+	if (now - lastUpdateTime < LOOPMONITOR_UPDATE_PERIOD_MS)
+		return;
+	lastUpdateTime = now;
+
+	LoopTimingData data;
+	void *fields[LOOPMONITOR_NUM_STAGES] = {
+		[LOOPMONITOR_SENSORREAD] = data.SensorRead,
+		[LOOPMONITOR_FILTER] = data.Filter,
+		[LOOPMONITOR_ATTITUDE] = data.Attitude,
+		[LOOPMONITOR_PID] = data.PID,
+		[LOOPMONITOR_MIXER] = data.Mixer,
+		[LOOPMONITOR_OUTPUT] = data.Output,
+		[LOOPMONITOR_LATENCY] = data.Latency,
+	};
+
+	for (int stage = 0; stage < LOOPMONITOR_NUM_STAGES; stage++) {
+		memcpy(fields[stage], counts[stage], sizeof(counts[stage]));
+		memset(counts[stage], 0, sizeof(counts[stage]));
+
+		data.Max[stage] = max_us[stage];
+		max_us[stage] = 0;
+	}
+
+	LoopTimingSet(&data);
+#endif
+}
+
+/**
+ * @}
+ */
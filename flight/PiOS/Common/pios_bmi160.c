@@ -40,6 +40,7 @@
 #include "pios_semaphore.h"
 #include "pios_thread.h"
 #include "pios_queue.h"
+#include "loopmonitor.h"
 
 /* Private constants */
 #define PIOS_BMI160_TASK_PRIORITY    PIOS_THREAD_PRIO_HIGHEST
@@ -52,10 +53,14 @@
 #define BMI160_REG_GYR_DATA_X_LSB 0x0C
 #define BMI160_REG_STATUS 0x1B
 #define BMI160_REG_TEMPERATURE_0 0x20
+#define BMI160_REG_FIFO_LENGTH_0 0x22
+#define BMI160_REG_FIFO_DATA 0x24
 #define BMI160_REG_ACC_CONF 0x40
 #define BMI160_REG_ACC_RANGE 0x41
 #define BMI160_REG_GYR_CONF 0x42
 #define BMI160_REG_GYR_RANGE 0x43
+#define BMI160_REG_FIFO_CONFIG_0 0x46
+#define BMI160_REG_FIFO_CONFIG_1 0x47
 #define BMI160_REG_INT_EN1 0x51
 #define BMI160_REG_INT_OUT_CTRL 0x53
 #define BMI160_REG_INT_MAP1 0x56
@@ -68,14 +73,22 @@
 #define BMI160_PMU_CMD_PMU_ACC_NORMAL 0x11
 #define BMI160_PMU_CMD_PMU_GYR_NORMAL 0x15
 #define BMI160_INT_EN1_DRDY 0x10
+#define BMI160_INT_EN1_FWM 0x40
 #define BMI160_INT_OUT_CTRL_INT1_CONFIG 0x0A
 #define BMI160_REG_INT_MAP1_INT1_DRDY 0x80
+#define BMI160_REG_INT_MAP1_INT1_FWM 0x40
+#define BMI160_FIFO_CONFIG_1_ACC_GYR 0xC0
+#define BMI160_CMD_FIFO_FLUSH 0xB0
 #define BMI160_CMD_START_FOC 0x03
 #define BMI160_CMD_PROG_NVM 0xA0
 #define BMI160_REG_STATUS_NVM_RDY 0x10
 #define BMI160_REG_STATUS_FOC_RDY 0x08
 #define BMI160_REG_CONF_NVM_PROG_EN 0x02
 
+/* A headerless FIFO frame holds the gyro then the accel data, like the
+ * data registers */
+#define BMI160_FIFO_FRAME_LEN 12
+
 /* Global Variables */
 enum pios_bmi160_dev_magic {
 	PIOS_BMI160_DEV_MAGIC = 0x76dfa5ba,
@@ -108,6 +121,8 @@ static uint8_t PIOS_BMI160_ReadReg(uint8_t reg);
 static int32_t PIOS_BMI160_WriteReg(uint8_t reg, uint8_t data);
 static int32_t PIOS_BMI160_ClaimBus();
 static int32_t PIOS_BMI160_ReleaseBus();
+static void PIOS_BMI160_Convert(const uint8_t *frame, struct pios_sensor_accel_data *accel_data,
+		struct pios_sensor_gyro_data *gyro_data);
 
 
 /**
@@ -116,6 +131,8 @@ static int32_t PIOS_BMI160_ReleaseBus();
  */
 int32_t PIOS_BMI160_Init(uint32_t spi_id, uint32_t slave_num, const struct pios_bmi160_cfg *cfg, bool do_foc)
 {
+	PIOS_Assert(cfg->fifo_samples <= PIOS_BMI160_MAX_FIFO_SAMPLES);
+
 	dev = PIOS_BMI160_alloc(cfg);
 	if (dev == NULL)
 		return -1;
@@ -260,8 +277,30 @@ static int32_t PIOS_BMI160_Config(const struct pios_bmi160_cfg *cfg)
 		return -7;
 	}
 
-	// Enable data ready interrupt
-	if (PIOS_BMI160_WriteReg(BMI160_REG_INT_EN1, BMI160_INT_EN1_DRDY) != 0){
+	bool use_fifo = cfg->fifo_samples > 1;
+
+	if (use_fifo) {
+		// Headerless accel and gyro frames, interrupt when a burst is in
+		if (PIOS_BMI160_WriteReg(BMI160_REG_FIFO_CONFIG_0,
+				cfg->fifo_samples * BMI160_FIFO_FRAME_LEN / 4) != 0) {
+			return -8;
+		}
+		PIOS_DELAY_WaitmS(1);
+
+		if (PIOS_BMI160_WriteReg(BMI160_REG_FIFO_CONFIG_1, BMI160_FIFO_CONFIG_1_ACC_GYR) != 0) {
+			return -8;
+		}
+		PIOS_DELAY_WaitmS(1);
+
+		if (PIOS_BMI160_WriteReg(BMI160_REG_CMD, BMI160_CMD_FIFO_FLUSH) != 0) {
+			return -8;
+		}
+		PIOS_DELAY_WaitmS(1);
+	}
+
+	// Enable data ready or FIFO watermark interrupt
+	if (PIOS_BMI160_WriteReg(BMI160_REG_INT_EN1,
+			use_fifo ? BMI160_INT_EN1_FWM : BMI160_INT_EN1_DRDY) != 0){
 		return -8;
 	}
 	PIOS_DELAY_WaitmS(1);
@@ -272,8 +311,9 @@ static int32_t PIOS_BMI160_Config(const struct pios_bmi160_cfg *cfg)
 	}
 	PIOS_DELAY_WaitmS(1);
 
-	// Map data ready interrupt to INT1 pin
-	if (PIOS_BMI160_WriteReg(BMI160_REG_INT_MAP1, BMI160_REG_INT_MAP1_INT1_DRDY) != 0){
+	// Map the interrupt to INT1 pin
+	if (PIOS_BMI160_WriteReg(BMI160_REG_INT_MAP1,
+			use_fifo ? BMI160_REG_INT_MAP1_INT1_FWM : BMI160_REG_INT_MAP1_INT1_DRDY) != 0){
 		return -10;
 	}
 	PIOS_DELAY_WaitmS(1);
@@ -368,13 +408,17 @@ static struct bmi160_dev *PIOS_BMI160_alloc(const struct pios_bmi160_cfg *cfg)
 
 	bmi160_dev->magic = PIOS_BMI160_DEV_MAGIC;
 
-	bmi160_dev->accel_queue = PIOS_Queue_Create(PIOS_BMI160_MAX_DOWNSAMPLE, sizeof(struct pios_sensor_accel_data));
+	// Room for a whole FIFO burst
+	uint8_t queue_len = cfg->fifo_samples > PIOS_BMI160_MAX_DOWNSAMPLE ?
+			cfg->fifo_samples : PIOS_BMI160_MAX_DOWNSAMPLE;
+
+	bmi160_dev->accel_queue = PIOS_Queue_Create(queue_len, sizeof(struct pios_sensor_accel_data));
 	if (bmi160_dev->accel_queue == NULL) {
 		PIOS_free(bmi160_dev);
 		return NULL;
 	}
 
-	bmi160_dev->gyro_queue = PIOS_Queue_Create(PIOS_BMI160_MAX_DOWNSAMPLE, sizeof(struct pios_sensor_gyro_data));
+	bmi160_dev->gyro_queue = PIOS_Queue_Create(queue_len, sizeof(struct pios_sensor_gyro_data));
 	if (bmi160_dev->gyro_queue == NULL) {
 		PIOS_Queue_Delete(dev->accel_queue);
 		PIOS_free(bmi160_dev);
@@ -495,164 +539,236 @@ bool PIOS_BMI160_IRQHandler(void)
 }
 
 
+/**
+ * @brief Convert a sample to our frame and units
+ * @param[in] frame The gyro and accel data, as in the data registers
+ */
+static void PIOS_BMI160_Convert(const uint8_t *frame, struct pios_sensor_accel_data *accel_data,
+		struct pios_sensor_gyro_data *gyro_data)
+{
+	enum {
+		IDX_GYRO_XOUT_L = 0,
+		IDX_GYRO_XOUT_H,
+		IDX_GYRO_YOUT_L,
+		IDX_GYRO_YOUT_H,
+		IDX_GYRO_ZOUT_L,
+		IDX_GYRO_ZOUT_H,
+		IDX_ACCEL_XOUT_L,
+		IDX_ACCEL_XOUT_H,
+		IDX_ACCEL_YOUT_L,
+		IDX_ACCEL_YOUT_H,
+		IDX_ACCEL_ZOUT_L,
+		IDX_ACCEL_ZOUT_H,
+	};
+
+	float accel_x = (int16_t)(frame[IDX_ACCEL_XOUT_H] << 8 | frame[IDX_ACCEL_XOUT_L]);
+	float accel_y = (int16_t)(frame[IDX_ACCEL_YOUT_H] << 8 | frame[IDX_ACCEL_YOUT_L]);
+	float accel_z = (int16_t)(frame[IDX_ACCEL_ZOUT_H] << 8 | frame[IDX_ACCEL_ZOUT_L]);
+	float gyro_x = (int16_t)(frame[IDX_GYRO_XOUT_H] << 8 | frame[IDX_GYRO_XOUT_L]);
+	float gyro_y = (int16_t)(frame[IDX_GYRO_YOUT_H] << 8 | frame[IDX_GYRO_YOUT_L]);
+	float gyro_z = (int16_t)(frame[IDX_GYRO_ZOUT_H] << 8 | frame[IDX_GYRO_ZOUT_L]);
+
+	/* 
+	 * Convert from sensor frame (x: forward y: left z: up) to
+	 * TL convention (x: forward y: right z: down).
+	 * See flight/Doc/imu_orientation.md for more detail
+	 */
+	switch (dev->cfg->orientation) {
+	case PIOS_BMI160_TOP_0DEG:
+		accel_data->x = accel_x;
+		accel_data->y = -accel_y;
+		accel_data->z = -accel_z;
+		gyro_data->x  = gyro_x;
+		gyro_data->y  = -gyro_y;
+		gyro_data->z  = -gyro_z;
+		break;
+	case PIOS_BMI160_TOP_90DEG:
+		accel_data->x = accel_y;
+		accel_data->y = accel_x;
+		accel_data->z = -accel_z;
+		gyro_data->x  = gyro_y;
+		gyro_data->y  = gyro_x;
+		gyro_data->z  = -gyro_z;
+		break;
+	case PIOS_BMI160_TOP_180DEG:
+		accel_data->x = -accel_x;
+		accel_data->y = accel_y;
+		accel_data->z = -accel_z;
+		gyro_data->x  = -gyro_x;
+		gyro_data->y  = gyro_y;
+		gyro_data->z  = -gyro_z;
+		break;
+	case PIOS_BMI160_TOP_270DEG:
+		accel_data->x = -accel_y;
+		accel_data->y = -accel_x;
+		accel_data->z = -accel_z;
+		gyro_data->x  = -gyro_y;
+		gyro_data->y  = -gyro_x;
+		gyro_data->z  = -gyro_z;
+		break;
+	case PIOS_BMI160_BOTTOM_0DEG:
+		accel_data->x = accel_x;
+		accel_data->y = accel_y;
+		accel_data->z = accel_z;
+		gyro_data->x  = gyro_x;
+		gyro_data->y  = gyro_y;
+		gyro_data->z  = gyro_z;
+		break;
+	case PIOS_BMI160_BOTTOM_90DEG:
+		accel_data->x = -accel_y;
+		accel_data->y = accel_x;
+		accel_data->z = accel_z;
+		gyro_data->x  = -gyro_y;
+		gyro_data->y  = gyro_x;
+		gyro_data->z  = gyro_z;
+		break;
+	case PIOS_BMI160_BOTTOM_180DEG:
+		accel_data->x = -accel_x;
+		accel_data->y = -accel_y;
+		accel_data->z = accel_z;
+		gyro_data->x  = -gyro_x;
+		gyro_data->y  = -gyro_y;
+		gyro_data->z  = gyro_z;
+		break;
+	case PIOS_BMI160_BOTTOM_270DEG:
+		accel_data->x = accel_y;
+		accel_data->y = -accel_x;
+		accel_data->z = accel_z;
+		gyro_data->x  = gyro_y;
+		gyro_data->y  = -gyro_x;
+		gyro_data->z  = gyro_z;
+		break;
+	}
+
+	// Apply sensor scaling
+	accel_data->x *= dev->accel_scale;
+	accel_data->y *= dev->accel_scale;
+	accel_data->z *= dev->accel_scale;
+
+	gyro_data->x *= dev->gyro_scale;
+	gyro_data->y *= dev->gyro_scale;
+	gyro_data->z *= dev->gyro_scale;
+}
+
 static void PIOS_BMI160_Task(void *parameters)
 {
 	float temperature = 0.f;
 	uint8_t temp_interleave_cnt = 0;
+	bool use_fifo = dev->cfg->fifo_samples > 1;
+
+	enum {
+		BUFFER_SIZE = 1 + PIOS_BMI160_MAX_FIFO_SAMPLES * BMI160_FIFO_FRAME_LEN,
+	};
+
+	uint8_t bmi160_rec_buf[BUFFER_SIZE];
+	uint8_t bmi160_tx_buf[BUFFER_SIZE];
 
 	while (1) {
 		//Wait for data ready interrupt
 		if (PIOS_Semaphore_Take(dev->data_ready_sema, PIOS_SEMAPHORE_TIMEOUT_MAX) != true)
 			continue;
 
-		enum {
-			IDX_REG = 0,
-			IDX_GYRO_XOUT_L,
-			IDX_GYRO_XOUT_H,
-			IDX_GYRO_YOUT_L,
-			IDX_GYRO_YOUT_H,
-			IDX_GYRO_ZOUT_L,
-			IDX_GYRO_ZOUT_H,
-			IDX_ACCEL_XOUT_L,
-			IDX_ACCEL_XOUT_H,
-			IDX_ACCEL_YOUT_L,
-			IDX_ACCEL_YOUT_H,
-			IDX_ACCEL_ZOUT_L,
-			IDX_ACCEL_ZOUT_H,
-			BUFFER_SIZE,
-		};
-
-		uint8_t bmi160_rec_buf[BUFFER_SIZE];
-		uint8_t bmi160_tx_buf[BUFFER_SIZE] = {BMI160_REG_GYR_DATA_X_LSB | 0x80, 0, 0, 0, 0, 0,
-				0, 0, 0, 0, 0, 0, 0};
+		uint32_t read_start = LoopMonitorStart();
 
-		if (PIOS_BMI160_ClaimBus() != 0)
-			continue;
+		uint8_t num_samples = 1;
+		bool more = false;
+
+		if (use_fifo) {
+			// See how much the FIFO holds, the watermark's worth or more
+			memset(bmi160_tx_buf, 0, 3);
+			bmi160_tx_buf[0] = BMI160_REG_FIFO_LENGTH_0 | 0x80;
+
+			if (PIOS_BMI160_ClaimBus() != 0)
+				continue;
+
+			if (PIOS_SPI_TransferBlock(dev->spi_id, bmi160_tx_buf, bmi160_rec_buf, 3) < 0) {
+				PIOS_BMI160_ReleaseBus();
+				continue;
+			}
 
-		if (PIOS_SPI_TransferBlock(dev->spi_id, bmi160_tx_buf, bmi160_rec_buf, BUFFER_SIZE) < 0) {
 			PIOS_BMI160_ReleaseBus();
-			continue;
+
+			uint16_t fifo_len = (bmi160_rec_buf[2] & 0x07) << 8 | bmi160_rec_buf[1];
+			num_samples = fifo_len / BMI160_FIFO_FRAME_LEN;
+
+			/* Read a burst at most.  The interrupt stays up while the
+			 * FIFO is over the watermark, so it won't come again for
+			 * what's left; go around again for it instead.
+			 */
+			if (num_samples > PIOS_BMI160_MAX_FIFO_SAMPLES) {
+				num_samples = PIOS_BMI160_MAX_FIFO_SAMPLES;
+				more = true;
+			}
+
+			if (num_samples == 0)
+				continue;
 		}
 
-		PIOS_BMI160_ReleaseBus();
+		uint16_t transfer_size = 1 + num_samples * BMI160_FIFO_FRAME_LEN;
 
-		struct pios_sensor_accel_data accel_data;
-		struct pios_sensor_gyro_data gyro_data;
+		memset(bmi160_tx_buf, 0, transfer_size);
+		bmi160_tx_buf[0] = (use_fifo ? BMI160_REG_FIFO_DATA : BMI160_REG_GYR_DATA_X_LSB) | 0x80;
 
-		float accel_x = (int16_t)(bmi160_rec_buf[IDX_ACCEL_XOUT_H] << 8 | bmi160_rec_buf[IDX_ACCEL_XOUT_L]);
-		float accel_y = (int16_t)(bmi160_rec_buf[IDX_ACCEL_YOUT_H] << 8 | bmi160_rec_buf[IDX_ACCEL_YOUT_L]);
-		float accel_z = (int16_t)(bmi160_rec_buf[IDX_ACCEL_ZOUT_H] << 8 | bmi160_rec_buf[IDX_ACCEL_ZOUT_L]);
-		float gyro_x = (int16_t)(bmi160_rec_buf[IDX_GYRO_XOUT_H] << 8 | bmi160_rec_buf[IDX_GYRO_XOUT_L]);
-		float gyro_y = (int16_t)(bmi160_rec_buf[IDX_GYRO_YOUT_H] << 8 | bmi160_rec_buf[IDX_GYRO_YOUT_L]);
-		float gyro_z = (int16_t)(bmi160_rec_buf[IDX_GYRO_ZOUT_H] << 8 | bmi160_rec_buf[IDX_GYRO_ZOUT_L]);
+		if (PIOS_BMI160_ClaimBus() != 0)
+			continue;
 
-		/* 
-		 * Convert from sensor frame (x: forward y: left z: up) to
-		 * TL convention (x: forward y: right z: down).
-		 * See flight/Doc/imu_orientation.md for more detail
-		 */
-		switch (dev->cfg->orientation) {
-		case PIOS_BMI160_TOP_0DEG:
-			accel_data.x = accel_x;
-			accel_data.y = -accel_y;
-			accel_data.z = -accel_z;
-			gyro_data.x  = gyro_x;
-			gyro_data.y  = -gyro_y;
-			gyro_data.z  = -gyro_z;
-			break;
-		case PIOS_BMI160_TOP_90DEG:
-			accel_data.x = accel_y;
-			accel_data.y = accel_x;
-			accel_data.z = -accel_z;
-			gyro_data.x  = gyro_y;
-			gyro_data.y  = gyro_x;
-			gyro_data.z  = -gyro_z;
-			break;
-		case PIOS_BMI160_TOP_180DEG:
-			accel_data.x = -accel_x;
-			accel_data.y = accel_y;
-			accel_data.z = -accel_z;
-			gyro_data.x  = -gyro_x;
-			gyro_data.y  = gyro_y;
-			gyro_data.z  = -gyro_z;
-			break;
-		case PIOS_BMI160_TOP_270DEG:
-			accel_data.x = -accel_y;
-			accel_data.y = -accel_x;
-			accel_data.z = -accel_z;
-			gyro_data.x  = -gyro_y;
-			gyro_data.y  = -gyro_x;
-			gyro_data.z  = -gyro_z;
-			break;
-		case PIOS_BMI160_BOTTOM_0DEG:
-			accel_data.x = accel_x;
-			accel_data.y = accel_y;
-			accel_data.z = accel_z;
-			gyro_data.x  = gyro_x;
-			gyro_data.y  = gyro_y;
-			gyro_data.z  = gyro_z;
-			break;
-		case PIOS_BMI160_BOTTOM_90DEG:
-			accel_data.x = -accel_y;
-			accel_data.y = accel_x;
-			accel_data.z = accel_z;
-			gyro_data.x  = -gyro_y;
-			gyro_data.y  = gyro_x;
-			gyro_data.z  = gyro_z;
-			break;
-		case PIOS_BMI160_BOTTOM_180DEG:
-			accel_data.x = -accel_x;
-			accel_data.y = -accel_y;
-			accel_data.z = accel_z;
-			gyro_data.x  = -gyro_x;
-			gyro_data.y  = -gyro_y;
-			gyro_data.z  = gyro_z;
-			break;
-		case PIOS_BMI160_BOTTOM_270DEG:
-			accel_data.x = accel_y;
-			accel_data.y = -accel_x;
-			accel_data.z = accel_z;
-			gyro_data.x  = gyro_y;
-			gyro_data.y  = -gyro_x;
-			gyro_data.z  = gyro_z;
-			break;
+		if (PIOS_SPI_TransferBlock(dev->spi_id, bmi160_tx_buf, bmi160_rec_buf, transfer_size) < 0) {
+			PIOS_BMI160_ReleaseBus();
+			continue;
 		}
 
-		// Apply sensor scaling
-		accel_data.x *= dev->accel_scale;
-		accel_data.y *= dev->accel_scale;
-		accel_data.z *= dev->accel_scale;
-
-		gyro_data.x *= dev->gyro_scale;
-		gyro_data.y *= dev->gyro_scale;
-		gyro_data.z *= dev->gyro_scale;
+		PIOS_BMI160_ReleaseBus();
 
 		// Get the temperature
 		// NOTE: We do this down here so the chip-select has some time to go low. Strange things happen
 		// When this is done right after readin the accels / gyros
 		if (temp_interleave_cnt % dev->cfg->temperature_interleaving == 0){
+			uint8_t temp_tx_buf[3] = {BMI160_REG_TEMPERATURE_0 | 0x80, 0, 0};
+			uint8_t temp_rec_buf[3];
+
 			if (PIOS_BMI160_ClaimBus() != 0)
 				continue;
 
-			uint8_t bmi160_tx_buf[BUFFER_SIZE] = {BMI160_REG_TEMPERATURE_0 | 0x80, 0, 0, 0, 0, 0,
-					0, 0, 0, 0, 0, 0, 0};
-			if (PIOS_SPI_TransferBlock(dev->spi_id, bmi160_tx_buf, bmi160_rec_buf, 3) < 0) {
+			if (PIOS_SPI_TransferBlock(dev->spi_id, temp_tx_buf, temp_rec_buf, 3) < 0) {
 				PIOS_BMI160_ReleaseBus();
 				continue;
 			}
 
 			PIOS_BMI160_ReleaseBus();
-			temperature =  23.f + (int16_t)(bmi160_rec_buf[2] << 8 | bmi160_rec_buf[1]) / 512.f;
+			temperature =  23.f + (int16_t)(temp_rec_buf[2] << 8 | temp_rec_buf[1]) / 512.f;
 		}
 
-		accel_data.temperature = temperature;
-		gyro_data.temperature = temperature;
+		LoopMonitorEnd(LOOPMONITOR_SENSORREAD, read_start);
+
+		/* The samples of a burst are evenly spaced at the output data
+		 * rate, which the consumers already take as the sample period.
+		 */
+		for (uint8_t i = 0; i < num_samples; i++) {
+			struct pios_sensor_accel_data *accel_data = PIOS_Queue_Reserve(dev->accel_queue);
+			struct pios_sensor_gyro_data *gyro_data = PIOS_Queue_Reserve(dev->gyro_queue);
+
+			if (!accel_data || !gyro_data) {
+				if (accel_data)
+					PIOS_Queue_Release(dev->accel_queue, accel_data);
+				if (gyro_data)
+					PIOS_Queue_Release(dev->gyro_queue, gyro_data);
+				break;
+			}
+
+			PIOS_BMI160_Convert(&bmi160_rec_buf[1 + i * BMI160_FIFO_FRAME_LEN],
+					accel_data, gyro_data);
 
+			accel_data->temperature = temperature;
+			gyro_data->temperature = temperature;
 
-		PIOS_Queue_Send(dev->accel_queue, &accel_data, 0);
-		PIOS_Queue_Send(dev->gyro_queue, &gyro_data, 0);
+			PIOS_Queue_Commit(dev->accel_queue, accel_data, 0);
+			PIOS_Queue_Commit(dev->gyro_queue, gyro_data, 0);
+		}
 
 		temp_interleave_cnt += 1;
+
+		if (more)
+			PIOS_Semaphore_Give(dev->data_ready_sema);
 	}
 }
 
@@ -378,6 +378,78 @@ int32_t PIOS_COM_SendBuffer(uintptr_t com_id, const uint8_t *buffer, uint16_t le
 	return sent;
 }
 
+/**
+* Reserves contiguous space at the end of the transmit queue, so a caller
+* can build a message in place instead of copying it in.  On success the
+* port is held against other senders until PIOS_COM_CommitBuffer.
+* \param[in] port COM port
+* \param[in] len number of bytes to reserve
+* \return pointer to the reserved space, or NULL if the port is busy, down
+*         or doesn't have len contiguous bytes free; send the message with
+*         PIOS_COM_SendBuffer* instead.
+*/
+uint8_t *PIOS_COM_ReserveBuffer(uintptr_t com_id, uint16_t len)
+{
+	struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+	if (!PIOS_COM_validate(com_dev) || !com_dev->tx) {
+		return NULL;
+	}
+
+#if defined(PIOS_INCLUDE_RTOS)
+	if (PIOS_Mutex_Lock(com_dev->sendbuffer_mtx, 0) != true) {
+		return NULL;
+	}
+#endif /* defined(PIOS_INCLUDE_RTOS) */
+
+	uint16_t contig;
+	uint8_t *buf = circ_queue_write_pos(com_dev->tx, &contig, NULL);
+
+	/* A down device is left to the send path, which empties the queue */
+	if ((com_dev->driver->available &&
+			!com_dev->driver->available(com_dev->lower_id)) ||
+			contig < len) {
+#if defined(PIOS_INCLUDE_RTOS)
+		PIOS_Mutex_Unlock(com_dev->sendbuffer_mtx);
+#endif /* PIOS_INCLUDE_RTOS */
+		return NULL;
+	}
+
+	return buf;
+}
+
+/**
+* Queues data written into space from PIOS_COM_ReserveBuffer for
+* transmission and releases the port.
+* \param[in] port COM port
+* \param[in] len number of bytes written, at most the number reserved
+* \return number of bytes queued
+*/
+int32_t PIOS_COM_CommitBuffer(uintptr_t com_id, uint16_t len)
+{
+	struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+	PIOS_Assert(PIOS_COM_validate(com_dev));
+
+	if (len > 0) {
+		circ_queue_advance_write_multi(com_dev->tx, len);
+
+		if (com_dev->driver->tx_start) {
+			uint16_t tx_avail;
+
+			circ_queue_read_pos(com_dev->tx, NULL, &tx_avail);
+			com_dev->driver->tx_start(com_dev->lower_id,
+						  tx_avail);
+		}
+	}
+
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Mutex_Unlock(com_dev->sendbuffer_mtx);
+#endif /* PIOS_INCLUDE_RTOS */
+
+	return len;
+}
+
 /**
 * Sends a single character over given port
 * \param[in] port COM port
@@ -516,6 +588,30 @@ uint16_t PIOS_COM_GetNumReceiveBytesPending(uintptr_t com_id) {
 	return rx_pending;
 }
 
+/**
+ * Reports how much more can be queued for sending without waiting.
+ * \param[in] com_id the COM instance to send to
+ * \returns number of free bytes in the transmit buffer, 0 if none
+ */
+uint16_t PIOS_COM_GetTxBytesFree(uintptr_t com_id) {
+	struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+	if (!PIOS_COM_validate(com_dev)) {
+		/* Undefined COM port for this board (see pios_board.c) */
+		PIOS_Assert(0);
+	}
+
+	if (!com_dev->tx) {
+		return 0;
+	}
+
+	uint16_t tx_free;
+
+	circ_queue_write_pos(com_dev->tx, NULL, &tx_free);
+
+	return tx_free;
+}
+
 /**
 * Transfer bytes from port buffers into another buffer
 * \param[in] port COM port
@@ -595,6 +691,22 @@ bool PIOS_COM_Available(uintptr_t com_id)
 	return (com_dev->driver->available)(com_dev->lower_id);
 }
 
+/**
+ * Query if a com port was set up to receive.
+ * \param[in] com_id the COM instance
+ * \returns true if it has a receive buffer
+ */
+bool PIOS_COM_HasReceiveBuffer(uintptr_t com_id)
+{
+	struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
+
+	if (!PIOS_COM_validate(com_dev)) {
+		return false;
+	}
+
+	return com_dev->rx != NULL;
+}
+
 uintptr_t PIOS_COM_GetDriverCtx(uintptr_t com_id) {
 	struct pios_com_dev *com_dev = (struct pios_com_dev *)com_id;
 
@@ -32,11 +32,6 @@
 
 #ifdef PIOS_INCLUDE_CROSSFIRE
 
-// Addresses with one-based index, because they're used after a pointer
-// increase only.
-#define CRSF_LEN_IDX				2
-#define CRSF_HEADER_IDX				3
-
 #include "pios_crc.h"
 #include "pios_com.h"
 #include "pios_com_priv.h"
@@ -51,10 +46,8 @@
  */
 struct pios_crossfire_dev {
 	uint32_t magic;
-	uint8_t buf_pos;
 	uint16_t rx_timer;
 	uint16_t failsafe_timer;
-	uint8_t bytes_expected;
 
 	uint16_t channel_data[PIOS_CROSSFIRE_CHANNELS];
 
@@ -63,6 +56,8 @@ struct pios_crossfire_dev {
 		uint8_t rx_buf[sizeof(struct crsf_frame_t)];
 	} u;
 
+	struct pios_rxframe rxframe;
+
 	// Need a copy of the USART/driver ref to initialize a COM device
 	// when necessary.
 	uintptr_t usart_id;
@@ -74,6 +69,12 @@ struct pios_crossfire_dev {
 
 	// To track frame starts to track whether telemetry is OK to send.
 	uint32_t time_frame_start;
+
+	// Start of the last RC frame, and the smoothed RC frame period in us,
+	// to size the telemetry slots to what the link is actually doing.
+	uint32_t time_rc_frame;
+	uint32_t frame_period;
+	uint8_t period_rejects;
 };
 
 /**
@@ -112,26 +113,48 @@ static void PIOS_Crossfire_SetAllChannels(struct pios_crossfire_dev *dev, uint16
 static uint16_t PIOS_Crossfire_Receive(uintptr_t context, uint8_t *buf, uint16_t buf_len,
 		uint16_t *headroom, bool *task_woken);
 /**
- * @brief Reset the internal receive buffer state
- * @param[in] dev device driver instance pointer
+ * @brief Frame length from the address and length fields
+ * @param[in] header Start of the frame
+ * @retval Frame length, or 0 if the length field isn't plausible
  */
-static void PIOS_Crossfire_ResetBuffer(struct pios_crossfire_dev *dev);
+static uint16_t PIOS_Crossfire_FrameLen(const uint8_t *header);
 /**
  * @brief Unpack a frame from the internal receive buffer to the channel buffer
- * @param[in] dev device driver instance pointer
+ * @param[in] context Driver instance handle
+ * @param[in] frame Frame data
+ * @param[in] len Frame length
+ * @retval true if an RC channel frame was decoded
  */
-static bool PIOS_Crossfire_UnpackFrame(struct pios_crossfire_dev *dev);
+static bool PIOS_Crossfire_UnpackFrame(uintptr_t context, const uint8_t *frame,
+		uint16_t len);
 /**
  * @brief RTC tick callback
  * @param[in] context Driver instance handle
  */
 static void PIOS_Crossfire_Supervisor(uintptr_t context);
+/**
+ * @brief Update the RC frame period estimate with a new RC frame
+ * @param[in] dev Driver instance
+ */
+static void PIOS_Crossfire_UpdatePeriod(struct pios_crossfire_dev *dev);
+/**
+ * @brief Time after an RC frame start by which telemetry must be done
+ * @param[in] dev Driver instance
+ * @retval Send window end in us
+ */
+static uint32_t PIOS_Crossfire_WindowEnd(const struct pios_crossfire_dev *dev);
 
 // public
 const struct pios_rcvr_driver pios_crossfire_rcvr_driver = {
 	.read = PIOS_Crossfire_Read,
 };
 
+static const struct pios_rxframe_proto pios_crossfire_frame_proto = {
+	.header_len = CRSF_ADDRESS_LEN + CRSF_LENGTH_LEN,
+	.frame_len = PIOS_Crossfire_FrameLen,
+	.decode = PIOS_Crossfire_UnpackFrame,
+};
+
 
 static struct pios_crossfire_dev *PIOS_Crossfire_Alloc(void)
 {
@@ -162,11 +185,12 @@ int PIOS_Crossfire_Init(uintptr_t *crsf_id, const struct pios_com_driver *driver
 	dev->usart_id = usart_id;
 	dev->usart_driver = driver;
 
-	PIOS_Crossfire_ResetBuffer(dev);
+	PIOS_RxFrame_Init(&dev->rxframe, &pios_crossfire_frame_proto,
+		dev->u.rx_buf, sizeof(dev->u.rx_buf), *crsf_id);
 	PIOS_Crossfire_SetAllChannels(dev, PIOS_RCVR_INVALID);
 
 	// Get COM device for telemetry.
-	if(PIOS_COM_Init(&dev->telem_com_id, dev->usart_driver, dev->usart_id, 0, CRSF_MAX_FRAMELEN))
+	if(PIOS_COM_Init(&dev->telem_com_id, dev->usart_driver, dev->usart_id, 0, CRSF_MAX_TELEMBURST))
 		return -1;
 
 	if (!PIOS_RTC_RegisterTickCallback(PIOS_Crossfire_Supervisor, *crsf_id))
@@ -214,38 +238,13 @@ static uint16_t PIOS_Crossfire_Receive(uintptr_t context, uint8_t *buf, uint16_t
 	if (!PIOS_Crossfire_Validate(dev))
 		goto out_fail;
 
-	if(dev->buf_pos == 0) {
+	if(PIOS_RxFrame_Idle(&dev->rxframe)) {
 		dev->time_frame_start = PIOS_DELAY_GetRaw();
 	}
 
-	for (int i = 0; i < buf_len; i++) {
-		// Ignore any stuff beyond what's expected.
-		if(dev->buf_pos >= dev->bytes_expected)
-			break;
-
-		dev->u.rx_buf[dev->buf_pos++] = buf[i];
-
-		if(dev->buf_pos == CRSF_LEN_IDX) {
-			// Read length field and adjust. Denotes payload, plus type field, plus CRC field.
-			dev->bytes_expected = CRSF_ADDRESS_LEN + CRSF_LENGTH_LEN + dev->u.frame.length;
-
-			// If length field isn't plausible, ignore rest of the data.
-			if(dev->bytes_expected >= CRSF_MAX_FRAMELEN) {
-				dev->bytes_expected = 0;
-				break;
-			}
-		}
-
-		if (dev->buf_pos == dev->bytes_expected) {
-			// Frame complete, decode.
-			if(PIOS_Crossfire_UnpackFrame(dev)) {
-				// Frame is valid, trigger semaphore.
-				PIOS_RCVR_ActiveFromISR();
-				// Ignore any stuff that might be left in the buffer.
-				// There shouldn't be anything.
-				break;
-			}
-		}
+	if(PIOS_RxFrame_Push(&dev->rxframe, buf, buf_len)) {
+		// Frame is valid, trigger semaphore.
+		PIOS_RCVR_ActiveFromISR();
 	}
 
 	dev->rx_timer = 0;
@@ -261,14 +260,25 @@ out_fail:
 	return 0;
 }
 
-static void PIOS_Crossfire_ResetBuffer(struct pios_crossfire_dev *dev)
+static uint16_t PIOS_Crossfire_FrameLen(const uint8_t *header)
 {
-	dev->buf_pos = 0;
-	dev->bytes_expected = CRSF_MAX_FRAMELEN;
+	// Length field denotes payload, plus type field, plus CRC field.
+	const struct crsf_frame_t *frame = (const struct crsf_frame_t *)header;
+	uint16_t frame_len = CRSF_ADDRESS_LEN + CRSF_LENGTH_LEN + frame->length;
+
+	// If length field isn't plausible, this isn't a frame start.
+	if(frame->length < CRSF_TYPE_LEN + CRSF_CRC_LEN ||
+			frame_len >= CRSF_MAX_FRAMELEN)
+		return 0;
+
+	return frame_len;
 }
 
-static bool PIOS_Crossfire_UnpackFrame(struct pios_crossfire_dev *dev)
+static bool PIOS_Crossfire_UnpackFrame(uintptr_t context, const uint8_t *frame,
+		uint16_t len)
 {
+	struct pios_crossfire_dev *dev = (struct pios_crossfire_dev *)context;
+
 	// Currently there appears to be only RC channel messages.
 	// We also only care about those for now.
 
@@ -309,13 +319,12 @@ static bool PIOS_Crossfire_UnpackFrame(struct pios_crossfire_dev *dev)
 			// RC control is still happening.
 			dev->failsafe_timer = 0;
 
-			PIOS_Crossfire_ResetBuffer(dev);
+			PIOS_Crossfire_UpdatePeriod(dev);
 
 			return true;
 		}
 	}
 
-	PIOS_Crossfire_ResetBuffer(dev);
 	return false;
 }
 
@@ -330,13 +339,48 @@ static void PIOS_Crossfire_Supervisor(uintptr_t context)
 	// So if more than 1.6ms passed without communication, safe to say that a new
 	// packet is inbound.
 	if (++dev->rx_timer > 1)
-		PIOS_Crossfire_ResetBuffer(dev);
+		PIOS_RxFrame_Gap(&dev->rxframe);
 
 	// Failsafe after 50ms.
 	if (++dev->failsafe_timer > 32)
 		PIOS_Crossfire_SetAllChannels(dev, PIOS_RCVR_TIMEOUT);
 }
 
+static void PIOS_Crossfire_UpdatePeriod(struct pios_crossfire_dev *dev)
+{
+	uint32_t interval = PIOS_DELAY_DiffuS2(dev->time_rc_frame, dev->time_frame_start);
+	bool first = !dev->time_rc_frame;
+
+	dev->time_rc_frame = dev->time_frame_start;
+
+	// Lost a frame, or still syncing up. Larger intervals than 50ms mean
+	// we've been in failsafe anyway.
+	if (first || interval < CRSF_TIMING_MAXFRAME || interval > 50000)
+		return;
+
+	// A single long interval is a dropped frame. If they keep coming,
+	// the link switched to a lower rate.
+	if (dev->frame_period && interval > dev->frame_period * 3 / 2 &&
+			++dev->period_rejects < 4)
+		return;
+
+	if (!dev->frame_period || dev->period_rejects >= 4)
+		dev->frame_period = interval;
+	else
+		dev->frame_period = (dev->frame_period * 7 + interval) / 8;
+
+	dev->period_rejects = 0;
+}
+
+static uint32_t PIOS_Crossfire_WindowEnd(const struct pios_crossfire_dev *dev)
+{
+	uint32_t period = dev->frame_period ? dev->frame_period : CRSF_TIMING_FRAMEDISTANCE;
+
+	// Stay clear of the next RC frame by as much as we wait after the
+	// last one.
+	return period - CRSF_TIMING_MAXFRAME;
+}
+
 int PIOS_Crossfire_SendTelemetry(uintptr_t crsf_id, uint8_t *buf, uint8_t bytes)
 {
 	struct pios_crossfire_dev *dev = (struct pios_crossfire_dev*)crsf_id;
@@ -356,9 +400,10 @@ int PIOS_Crossfire_SendTelemetry(uintptr_t crsf_id, uint8_t *buf, uint8_t bytes)
 		return 0;
 
 	uint32_t delay = PIOS_DELAY_DiffuS(dev->time_frame_start);
-	if((delay > CRSF_TIMING_MAXFRAME) & (delay < (CRSF_TIMING_FRAMEDISTANCE-CRSF_TIMING_MAXFRAME))) {
+	if((delay > CRSF_TIMING_MAXFRAME) &&
+			(delay + bytes * CRSF_TIMING_BYTE < PIOS_Crossfire_WindowEnd(dev))) {
 
-		// We're still within the send window.
+		// The whole lot fits into the send window.
 		PIOS_COM_SendBuffer(dev->telem_com_id, buf, (uint16_t)bytes);
 		return 0;
 
@@ -367,6 +412,25 @@ int PIOS_Crossfire_SendTelemetry(uintptr_t crsf_id, uint8_t *buf, uint8_t bytes)
 	}
 }
 
+uint8_t PIOS_Crossfire_GetTelemetrySlot(uintptr_t crsf_id, uint32_t *period_us)
+{
+	struct pios_crossfire_dev *dev = (struct pios_crossfire_dev*)crsf_id;
+
+	if(!PIOS_Crossfire_Validate(dev))
+		PIOS_Assert(0);
+
+	if(period_us)
+		*period_us = dev->frame_period ? dev->frame_period : CRSF_TIMING_FRAMEDISTANCE;
+
+	uint32_t window = PIOS_Crossfire_WindowEnd(dev);
+	if(window <= CRSF_TIMING_MAXFRAME)
+		return 0;
+
+	uint32_t bytes = (window - CRSF_TIMING_MAXFRAME) / CRSF_TIMING_BYTE;
+
+	return bytes > CRSF_MAX_TELEMBURST ? CRSF_MAX_TELEMBURST : bytes;
+}
+
 bool PIOS_Crossfire_IsFailsafed(uintptr_t crsf_id)
 {
 	struct pios_crossfire_dev *dev = (struct pios_crossfire_dev*)crsf_id;
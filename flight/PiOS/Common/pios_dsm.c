@@ -46,12 +46,22 @@ static uint16_t PIOS_DSM_RxInCallback(uintptr_t context,
 				      uint16_t *headroom,
 				      bool *need_yield);
 static void PIOS_DSM_Supervisor(uintptr_t dsm_id);
+static uint16_t PIOS_DSM_FrameLen(const uint8_t *header);
+static bool PIOS_DSM_DecodeFrame(uintptr_t context, const uint8_t *frame,
+				 uint16_t len);
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_dsm_rcvr_driver = {
 	.read = PIOS_DSM_Get,
 };
 
+static const struct pios_rxframe_proto pios_dsm_frame_proto = {
+	.header_len = 1,
+	.frame_len = PIOS_DSM_FrameLen,
+	.decode = PIOS_DSM_DecodeFrame,
+	.gap_sync = true,
+};
+
 enum dsm_resolution {
 	DSM_UNKNOWN, DSM_10BIT, DSM_11BIT
 };
@@ -63,10 +73,9 @@ enum pios_dsm_dev_magic {
 struct pios_dsm_state {
 	uint16_t channel_data[PIOS_DSM_NUM_INPUTS];
 	uint8_t received_data[DSM_FRAME_LENGTH];
+	struct pios_rxframe rxframe;
 	uint8_t receive_timer;
 	uint8_t failsafe_timer;
-	uint8_t frame_found;
-	uint8_t byte_count;
 #ifdef DSM_LOST_FRAME_COUNTER
 	uint8_t	frames_lost_last;
 	uint16_t frames_lost;
@@ -147,7 +156,6 @@ static void PIOS_DSM_ResetState(struct pios_dsm_dev *dsm_dev)
 	struct pios_dsm_state *state = &(dsm_dev->state);
 	state->receive_timer = 0;
 	state->failsafe_timer = 0;
-	state->frame_found = 0;
 #ifdef DSM_LOST_FRAME_COUNTER
 	state->frames_lost_last = 0;
 	state->frames_lost = 0;
@@ -272,28 +280,26 @@ stream_error:
 	return -1;
 }
 
-/* Update decoder state processing input byte from the DSMx stream */
-static void PIOS_DSM_UpdateState(struct pios_dsm_dev *dsm_dev, uint8_t byte)
+/* DSM frames have no sync byte; every frame starts after a gap */
+static uint16_t PIOS_DSM_FrameLen(const uint8_t *header)
 {
-	struct pios_dsm_state *state = &(dsm_dev->state);
-	if (state->frame_found) {
-		/* receiving the data frame */
-		if (state->byte_count < DSM_FRAME_LENGTH) {
-			/* store next byte */
-			state->received_data[state->byte_count++] = byte;
-			if (state->byte_count == DSM_FRAME_LENGTH) {
-				/* full frame received - process and wait for new one */
-				if (!PIOS_DSM_UnrollChannels(dsm_dev)) {
-					/* data looking good */
-					state->failsafe_timer = 0;
-					PIOS_RCVR_ActiveFromISR();
-				}
-
-				/* prepare for the next frame */
-				state->frame_found = 0;
-			}
-		}
-	}
+	return DSM_FRAME_LENGTH;
+}
+
+/* Process a full frame; the next one starts after a gap */
+static bool PIOS_DSM_DecodeFrame(uintptr_t context, const uint8_t *frame,
+				 uint16_t len)
+{
+	struct pios_dsm_dev *dsm_dev = (struct pios_dsm_dev *)context;
+
+	if (PIOS_DSM_UnrollChannels(dsm_dev))
+		return false;
+
+	/* data looking good */
+	dsm_dev->state.failsafe_timer = 0;
+	PIOS_RCVR_ActiveFromISR();
+
+	return true;
 }
 
 /* Initialise DSM receiver interface */
@@ -352,6 +358,10 @@ int32_t PIOS_DSM_Init(uintptr_t *dsm_id,
 		PIOS_DSM_Bind(dsm_dev, num_pulses);
 
 	PIOS_DSM_ResetState(dsm_dev);
+	PIOS_RxFrame_Init(&dsm_dev->state.rxframe, &pios_dsm_frame_proto,
+			  dsm_dev->state.received_data,
+			  sizeof(dsm_dev->state.received_data),
+			  (uintptr_t)dsm_dev);
 
 	*dsm_id = (uintptr_t)dsm_dev;
 
@@ -378,10 +388,8 @@ static uint16_t PIOS_DSM_RxInCallback(uintptr_t context,
 	PIOS_Assert(valid);
 
 	/* process byte(s) and clear receive timer */
-	for (uint8_t i = 0; i < buf_len; i++) {
-		PIOS_DSM_UpdateState(dsm_dev, buf[i]);
-		dsm_dev->state.receive_timer = 0;
-	}
+	PIOS_RxFrame_Push(&dsm_dev->state.rxframe, buf, buf_len);
+	dsm_dev->state.receive_timer = 0;
 
 	/* Always signal that we can accept another byte */
 	if (headroom)
@@ -439,8 +447,7 @@ static void PIOS_DSM_Supervisor(uintptr_t dsm_id)
 
 	/* waiting for new frame if no bytes were received in 8ms */
 	if (++state->receive_timer > 4) {
-		state->frame_found = 1;
-		state->byte_count = 0;
+		PIOS_RxFrame_Gap(&state->rxframe);
 		state->receive_timer = 0;
 	}
 
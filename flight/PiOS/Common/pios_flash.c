@@ -403,6 +403,42 @@ int32_t PIOS_FLASH_erase_range(uintptr_t partition_id, uint32_t start_offset, ui
 	return 0;
 }
 
+/**
+ * @brief Find the chip sector holding an offset within this partition
+ * @param[in] partition_id opaque handle for a specific partition
+ * @param[in] offset offset (in bytes) from beginning of partition
+ * @param[out] sector_offset offset (in bytes) from beginning of partition to the start of the sector
+ * @param[out] sector_size size (in bytes) of the sector
+ * @return 0 if success or error code
+ * @retval -20 if partition_id is not a valid partition identifier
+ * @retval -22 if failed to find beginning of partition within the partition table
+ * @retval -23 if offset is beyond the end of the partition
+ */
+int32_t PIOS_FLASH_get_sector_extents(uintptr_t partition_id, uint32_t offset, uint32_t *sector_offset, uint32_t *sector_size)
+{
+	PIOS_Assert(sector_offset);
+	PIOS_Assert(sector_size);
+
+	struct pios_flash_partition *partition = (struct pios_flash_partition *)partition_id;
+
+	if (!PIOS_FLASH_validate_partition(partition))
+		return -20;
+
+	struct pios_flash_sector_desc sector_desc;
+	if (!pios_flash_get_partition_first_sector(partition, &sector_desc))
+		return -22;
+
+	do {
+		if (offset < sector_desc.partition_offset + sector_desc.sector_size) {
+			*sector_offset = sector_desc.partition_offset;
+			*sector_size   = sector_desc.sector_size;
+			return 0;
+		}
+	} while (pios_flash_get_partition_next_sector(partition, &sector_desc));
+
+	return -23;
+}
+
 /**
  * @brief Erase all of the flash sectors within this partition
  * @param[in] partition_id opaque handle for a specific partition
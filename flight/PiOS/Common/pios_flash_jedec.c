@@ -71,6 +71,7 @@ struct jedec_flash_dev {
 
 	const struct pios_flash_jedec_cfg *cfg;
 	struct pios_semaphore *transaction_lock;
+	bool program_pending;
 	enum pios_jedec_dev_magic magic;
 };
 
@@ -84,6 +85,7 @@ static int32_t PIOS_Flash_Jedec_ClaimBus(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_ReleaseBus(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_WriteEnable(struct jedec_flash_dev *flash_dev);
 static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev);
+static void PIOS_Flash_Jedec_WaitProgram(struct jedec_flash_dev *flash_dev);
 
 /**
  * @brief Allocate a new device
@@ -96,6 +98,7 @@ static struct jedec_flash_dev *PIOS_Flash_Jedec_alloc(void)
 	if (!flash_dev) return (NULL);
 
 	flash_dev->magic = PIOS_JEDEC_DEV_MAGIC;
+	flash_dev->program_pending = false;
 
 	return(flash_dev);
 }
@@ -204,6 +207,26 @@ static int32_t PIOS_Flash_Jedec_Busy(struct jedec_flash_dev *flash_dev)
 	return status & JEDEC_STATUS_BUSY;
 }
 
+/**
+ * @brief Wait for the page program started by the last write to complete.
+ * Writes return as soon as the page is clocked out, so the caller can
+ * prepare the next page while the chip programs this one; every other
+ * command has to wait here first.
+ */
+static void PIOS_Flash_Jedec_WaitProgram(struct jedec_flash_dev *flash_dev)
+{
+	if (!flash_dev->program_pending)
+		return;
+
+	while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
+#if defined(PIOS_INCLUDE_RTOS)
+		PIOS_Thread_Sleep(1);
+#endif
+	}
+
+	flash_dev->program_pending = false;
+}
+
 /**
  * @brief Execute the write enable instruction and returns the status
  * @returns 0 if successful, -1 if unable to claim bus
@@ -344,6 +367,8 @@ static int32_t PIOS_Flash_Jedec_EraseSector(uintptr_t chip_id, uint32_t chip_sec
 		(chip_offset >>  0) & 0xff,
 	};
 
+	PIOS_Flash_Jedec_WaitProgram(flash_dev);
+
 	if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0)
 		return ret;
 
@@ -401,6 +426,8 @@ static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t chip_id, uint32_t chip_offse
 	if (((chip_offset & 0xff) + len) > 0x100)
 		return -3;
 
+	PIOS_Flash_Jedec_WaitProgram(flash_dev);
+
 	if ((ret = PIOS_Flash_Jedec_WriteEnable(flash_dev)) != 0)
 		return ret;
 
@@ -421,11 +448,9 @@ static int32_t PIOS_Flash_Jedec_WriteData(uintptr_t chip_id, uint32_t chip_offse
 
 	PIOS_Flash_Jedec_ReleaseBus(flash_dev);
 
-	// Keep polling when bus is busy too
 #if defined(PIOS_INCLUDE_RTOS)
-	while (PIOS_Flash_Jedec_Busy(flash_dev) != 0) {
-		PIOS_Thread_Sleep(1);
-	}
+	// The next command waits for the program to complete
+	flash_dev->program_pending = true;
 #else
 
 	// Query status this way to prevent accel chip locking us out
@@ -457,6 +482,8 @@ static int32_t PIOS_Flash_Jedec_ReadData(uintptr_t chip_id, uint32_t chip_offset
 	if (PIOS_Flash_Jedec_Validate(flash_dev) != 0)
 		return -1;
 
+	PIOS_Flash_Jedec_WaitProgram(flash_dev);
+
 	if (PIOS_Flash_Jedec_ClaimBus(flash_dev) == -1)
 		return -1;
 
@@ -500,6 +527,8 @@ int32_t PIOS_Flash_Jedec_ReadOTPData(uintptr_t chip_id, uint32_t chip_offset, ui
 	if (PIOS_Flash_Jedec_Validate(flash_dev) != 0)
 		return -1;
 
+	PIOS_Flash_Jedec_WaitProgram(flash_dev);
+
 	if (PIOS_Flash_Jedec_ClaimBus(flash_dev) == -1)
 		return -1;
 
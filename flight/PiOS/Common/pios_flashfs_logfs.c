@@ -42,6 +42,15 @@ enum pios_flashfs_logfs_dev_magic {
 	PIOS_FLASHFS_LOGFS_DEV_MAGIC = 0x94938201,
 };
 
+/* Slots copied per step of the background garbage collection */
+#define LOGFS_GC_COPY_SLOTS 4
+
+enum logfs_gc_state {
+	LOGFS_GC_IDLE,
+	LOGFS_GC_ERASE,	/* erasing the destination arena, a sector a step */
+	LOGFS_GC_COPY,	/* copying active slots to it */
+};
+
 struct logfs_state {
 	enum pios_flashfs_logfs_dev_magic magic;
 	const struct flashfs_logfs_cfg *cfg;
@@ -55,6 +64,26 @@ struct logfs_state {
 	uint16_t num_free_slots;   /* slots in free state */
 	uint16_t num_active_slots; /* slots in active state */
 
+	/*
+	 * Hash of (obj_id, obj_inst_id) of each active slot of the mounted
+	 * arena, 0 for all others.  Lets lookups read only the slot headers
+	 * that can match.  NULL if it couldn't be allocated, then lookups
+	 * scan the arena.
+	 */
+	uint16_t *slot_index;
+
+	/*
+	 * Garbage collection in progress.  While copying, new objects
+	 * still go to the active arena, and objects deleted from it after
+	 * they were copied are also obsoleted in the destination.
+	 */
+	enum logfs_gc_state gc_state;
+	uint8_t gc_arena_id;	 /* destination arena */
+	uint32_t gc_erase_count; /* erase count to give the destination */
+	uint32_t gc_erase_offset; /* next sector to erase, within the arena */
+	uint16_t gc_src_slot;	 /* next slot of the active arena to copy */
+	uint16_t gc_dst_slot;	 /* next free slot of the destination */
+
 	/* Underlying flash partition handle */
 	uintptr_t partition_id;
 	uint32_t partition_size;
@@ -101,6 +130,11 @@ enum arena_state {
 struct arena_header {
 	uint32_t magic;
 	enum arena_state state;
+	/*
+	 * Times the arena was erased, to spread the erases across arenas.
+	 * Reads all ones on filesystems formatted before it was added.
+	 */
+	uint32_t erase_count;
 } __attribute__((packed));
 
 
@@ -109,29 +143,78 @@ struct arena_header {
  ****************************************/
 
 /**
- * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @brief Reads how many times the given arena was erased
  * @return 0 if success, < 0 on failure
  * @note Must be called while holding the flash transaction lock
  */
-static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+static int32_t logfs_get_erase_count(const struct logfs_state *logfs, uint8_t arena_id, uint32_t *erase_count)
 {
 	uintptr_t arena_addr = logfs_get_addr (logfs, arena_id, 0);
 
-	/* Erase all of the sectors in the arena */
-	if (PIOS_FLASH_erase_range(logfs->partition_id, arena_addr, logfs->cfg->arena_size) != 0) {
+	struct arena_header arena_hdr;
+	if (PIOS_FLASH_read_data(logfs->partition_id,
+					arena_addr,
+					(uint8_t *)&arena_hdr,
+					sizeof(arena_hdr)) != 0) {
 		return -1;
 	}
 
+	if (arena_hdr.magic != logfs->cfg->fs_magic ||
+			arena_hdr.erase_count == 0xFFFFFFFF) {
+		*erase_count = 0;
+	} else {
+		*erase_count = arena_hdr.erase_count;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Sets an arena whose sectors were all erased to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_mark_arena_erased(const struct logfs_state *logfs, uint8_t arena_id, uint32_t erase_count)
+{
+	uintptr_t arena_addr = logfs_get_addr (logfs, arena_id, 0);
+
 	/* Mark this arena as fully erased */
 	struct arena_header arena_hdr = {
 		.magic = logfs->cfg->fs_magic,
 		.state = ARENA_STATE_ERASED,
+		.erase_count = erase_count,
 	};
 
 	if (PIOS_FLASH_write_data(logfs->partition_id,
 					arena_addr,
 					(uint8_t *)&arena_hdr,
 					sizeof(arena_hdr)) != 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Erases all sectors within the given arena and sets arena to erased state.
+ * @return 0 if success, < 0 on failure
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_erase_arena(const struct logfs_state *logfs, uint8_t arena_id)
+{
+	uintptr_t arena_addr = logfs_get_addr (logfs, arena_id, 0);
+
+	uint32_t erase_count;
+	if (logfs_get_erase_count(logfs, arena_id, &erase_count) != 0) {
+		return -1;
+	}
+
+	/* Erase all of the sectors in the arena */
+	if (PIOS_FLASH_erase_range(logfs->partition_id, arena_addr, logfs->cfg->arena_size) != 0) {
+		return -1;
+	}
+
+	if (logfs_mark_arena_erased(logfs, arena_id, erase_count + 1) != 0) {
 		return -2;
 	}
 
@@ -397,6 +480,31 @@ static bool logfs_log_is_full(const struct logfs_state *logfs)
 	return (logfs->num_free_slots == 0);
 }
 
+/*
+ * Hash of an object instance for the slot index; never 0, which marks
+ * slots that aren't active.
+ */
+static uint16_t logfs_slot_hash(uint32_t obj_id, uint16_t obj_inst_id)
+{
+	uint32_t h = (obj_id ^ (obj_id >> 16)) * 0x45d9f3b;
+
+	h = (h ^ (h >> 16)) + obj_inst_id;
+
+	return (uint16_t)(h ^ (h >> 16)) ? : 1;
+}
+
+static void logfs_index_set(struct logfs_state *logfs, uint16_t slot_id, const struct slot_header *slot_hdr)
+{
+	if (!logfs->slot_index)
+		return;
+
+	if (slot_hdr->state == SLOT_STATE_ACTIVE) {
+		logfs->slot_index[slot_id] = logfs_slot_hash(slot_hdr->obj_id, slot_hdr->obj_inst_id);
+	} else {
+		logfs->slot_index[slot_id] = 0;
+	}
+}
+
 static int32_t logfs_unmount_log(struct logfs_state *logfs)
 {
 	PIOS_Assert (logfs->mounted);
@@ -447,6 +555,8 @@ static int32_t logfs_mount_log(struct logfs_state *logfs, uint8_t arena_id)
 		case SLOT_STATE_OBSOLETE:
 			break;
 		}
+
+		logfs_index_set(logfs, slot_id, &slot_hdr);
 	}
 
 	/* Scan is complete, mark the arena mounted */
@@ -519,6 +629,11 @@ int32_t PIOS_FLASHFS_Logfs_Init(uintptr_t *fs_id, const struct flashfs_logfs_cfg
 	logfs->partition_id   = partition_id; /* underlying partition */
 	logfs->partition_size = partition_size; /* size of underlying partition */
 	logfs->mounted        = false;
+	logfs->gc_state       = LOGFS_GC_IDLE;
+
+	/* Without the index lookups still work, by scanning the arena */
+	logfs->slot_index = PIOS_malloc_no_dma(sizeof(*logfs->slot_index) *
+			(cfg->arena_size / cfg->slot_size));
 
 	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
 		rc = -1;
@@ -579,6 +694,10 @@ int32_t PIOS_FLASHFS_Logfs_Destroy(uintptr_t fs_id)
 		goto out_exit;
 	}
 
+	if (logfs->slot_index) {
+		PIOS_free(logfs->slot_index);
+	}
+
 	PIOS_FLASHFS_Logfs_free(logfs);
 	rc = 0;
 
@@ -586,79 +705,238 @@ out_exit:
 	return rc;
 }
 
+/*
+ * Number of slots of an arena up to the first free one: for the active
+ * arena the ones in the log, for the garbage collection destination the
+ * ones copied so far.
+ */
+static uint16_t logfs_used_slots(const struct logfs_state *logfs, uint8_t arena_id)
+{
+	if (arena_id == logfs->active_arena_id) {
+		return (logfs->cfg->arena_size / logfs->cfg->slot_size) - logfs->num_free_slots;
+	}
+
+	return logfs->gc_dst_slot;
+}
+
+/*
+ * Is garbage collection worth starting ahead of need?
+ * true = the log is three quarters full and collecting would free at least a quarter of it
+ */
+static bool logfs_gc_wanted(const struct logfs_state *logfs)
+{
+	uint16_t num_slots = (logfs->cfg->arena_size / logfs->cfg->slot_size) - 1;
+	uint16_t num_obsolete_slots = num_slots - logfs->num_free_slots - logfs->num_active_slots;
+
+	return (logfs->gc_state == LOGFS_GC_IDLE &&
+		logfs->num_free_slots < num_slots / 4 &&
+		num_obsolete_slots >= num_slots / 4);
+}
+
+/**
+ * @brief Picks the least erased arena, other than the active one, to collect into
+ * @return arena_id (>=0) of the destination arena
+ * @return -1 if failed to read an arena header
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_pick_gc_arena(const struct logfs_state *logfs, uint32_t *erase_count)
+{
+	uint8_t num_arenas = logfs->partition_size / logfs->cfg->arena_size;
+	int32_t best_arena_id = -1;
+
+	/* On a tie, the arena following the active one wins */
+	for (uint8_t i = 1; i < num_arenas; i++) {
+		uint8_t arena_id = (logfs->active_arena_id + i) % num_arenas;
+		uint32_t count;
+
+		if (logfs_get_erase_count(logfs, arena_id, &count) != 0) {
+			return -1;
+		}
+
+		if (best_arena_id < 0 || count < *erase_count) {
+			best_arena_id = arena_id;
+			*erase_count  = count;
+		}
+	}
+
+	return best_arena_id;
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
-static int32_t logfs_garbage_collect (struct logfs_state *logfs) {
+static int32_t logfs_gc_start(struct logfs_state *logfs)
+{
 	PIOS_Assert (logfs->mounted);
 
-	/* Source arena is the active arena */
-	uint8_t src_arena_id = logfs->active_arena_id;
+	int32_t arena_id = logfs_pick_gc_arena(logfs, &logfs->gc_erase_count);
+	if (arena_id < 0) {
+		return -1;
+	}
 
-	/* Compute destination arena */
-	uint8_t dst_arena_id = (logfs->active_arena_id + 1) % (logfs->partition_size / logfs->cfg->arena_size);
+	logfs->gc_arena_id     = arena_id;
+	logfs->gc_erase_offset = 0;
+	logfs->gc_src_slot     = 1;
+	logfs->gc_dst_slot     = 1;
+	logfs->gc_state        = LOGFS_GC_ERASE;
 
-	/* Erase destination arena */
-	if (logfs_erase_arena (logfs, dst_arena_id) != 0) {
+	return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int32_t logfs_gc_erase_step(struct logfs_state *logfs)
+{
+	uintptr_t arena_addr = logfs_get_addr (logfs, logfs->gc_arena_id, 0);
+
+	/* Erase the next sector of the destination arena */
+	uint32_t sector_offset;
+	uint32_t sector_size;
+	if (PIOS_FLASH_get_sector_extents(logfs->partition_id,
+					arena_addr + logfs->gc_erase_offset,
+					&sector_offset,
+					&sector_size) != 0) {
 		return -1;
 	}
 
-	/* Reserve the destination arena so we can start filling it */
-	if (logfs_reserve_arena (logfs, dst_arena_id) != 0) {
-		/* Unable to reserve the arena */
+	if (PIOS_FLASH_erase_range(logfs->partition_id, sector_offset, sector_size) != 0) {
 		return -2;
 	}
 
+	logfs->gc_erase_offset = sector_offset + sector_size - arena_addr;
+
+	if (logfs->gc_erase_offset < logfs->cfg->arena_size) {
+		/* More sectors to go */
+		return 0;
+	}
+
+	if (logfs_mark_arena_erased(logfs, logfs->gc_arena_id, logfs->gc_erase_count + 1) != 0) {
+		return -3;
+	}
+
+	/* Reserve the destination arena so we can start filling it */
+	if (logfs_reserve_arena (logfs, logfs->gc_arena_id) != 0) {
+		return -4;
+	}
+
+	logfs->gc_state = LOGFS_GC_COPY;
+
+	return 0;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int32_t logfs_gc_copy_step(struct logfs_state *logfs)
+{
+	uint8_t src_arena_id = logfs->active_arena_id;
+	uint8_t dst_arena_id = logfs->gc_arena_id;
+
 	/* Copy active slots from active arena to destination arena */
-	uint16_t dst_slot_id = 1;
-	for (uint16_t src_slot_id = 1;
-	     src_slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
-	     src_slot_id++) {
+	for (uint8_t copied = 0;
+	     copied < LOGFS_GC_COPY_SLOTS &&
+	     logfs->gc_src_slot < logfs_used_slots(logfs, src_arena_id);
+	     logfs->gc_src_slot++) {
 		struct slot_header slot_hdr;
-		uintptr_t src_addr = logfs_get_addr (logfs, src_arena_id, src_slot_id);
+		uintptr_t src_addr = logfs_get_addr (logfs, src_arena_id, logfs->gc_src_slot);
 		if (PIOS_FLASH_read_data(logfs->partition_id,
 						src_addr,
 						(uint8_t *)&slot_hdr,
 						sizeof (slot_hdr)) != 0) {
-			return -3;
+			return -1;
 		}
 
 		if (slot_hdr.state == SLOT_STATE_ACTIVE) {
-			uintptr_t dst_addr = logfs_get_addr (logfs, dst_arena_id, dst_slot_id);
+			uintptr_t dst_addr = logfs_get_addr (logfs, dst_arena_id, logfs->gc_dst_slot);
 			if (logfs_raw_copy_bytes(logfs,
 							src_addr,
 							sizeof(slot_hdr) + slot_hdr.obj_size,
 							dst_addr) != 0) {
 				/* Failed to copy all bytes */
-				return -4;
+				return -2;
 			}
-			dst_slot_id++;
+			logfs->gc_dst_slot++;
+			copied++;
 		}
 	}
 
+	if (logfs->gc_src_slot < logfs_used_slots(logfs, src_arena_id)) {
+		/* More slots to go */
+		return 0;
+	}
+
 	/* Activate the destination arena */
 	if (logfs_activate_arena (logfs, dst_arena_id) != 0) {
-		return -5;
+		return -3;
 	}
 
 	/* Unmount the source arena */
 	if (logfs_unmount_log (logfs) != 0) {
-		return -6;
+		return -4;
 	}
 
 	/* Obsolete the source arena */
 	if (logfs_obsolete_arena (logfs, src_arena_id) != 0) {
-		return -7;
+		return -5;
 	}
 
 	/* Mount the new arena */
 	if (logfs_mount_log (logfs, dst_arena_id) != 0) {
-		return -8;
+		return -6;
+	}
+
+	logfs->gc_state = LOGFS_GC_IDLE;
+
+	return 0;
+}
+
+/**
+ * @brief Does one bounded step of the garbage collection in progress:
+ * erasing a sector of the destination, or copying a few slots to it.
+ * @return 0 if success, < 0 on failure, which abandons the collection
+ * @note Must be called while holding the flash transaction lock
+ */
+static int32_t logfs_gc_step(struct logfs_state *logfs)
+{
+	int32_t rc;
+
+	switch (logfs->gc_state) {
+	case LOGFS_GC_ERASE:
+		rc = logfs_gc_erase_step(logfs);
+		break;
+	case LOGFS_GC_COPY:
+		rc = logfs_gc_copy_step(logfs);
+		break;
+	default:
+		rc = 0;
+		break;
+	}
+
+	if (rc != 0) {
+		/* The destination was never activated, the next collection erases it again */
+		logfs->gc_state = LOGFS_GC_IDLE;
+	}
+
+	return rc;
+}
+
+/* NOTE: Must be called while holding the flash transaction lock */
+static int32_t logfs_garbage_collect (struct logfs_state *logfs) {
+	PIOS_Assert (logfs->mounted);
+
+	/* Start a collection, or finish the one running in the background */
+	if (logfs->gc_state == LOGFS_GC_IDLE) {
+		if (logfs_gc_start(logfs) != 0) {
+			return -1;
+		}
+	}
+
+	while (logfs->gc_state != LOGFS_GC_IDLE) {
+		if (logfs_gc_step(logfs) != 0) {
+			return -2;
+		}
 	}
 
 	return 0;
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
-static int16_t logfs_object_find_next (const struct logfs_state *logfs, struct slot_header *slot_hdr, uint16_t *curr_slot, uint32_t obj_id, uint16_t obj_inst_id)
+static int16_t logfs_object_find_next (const struct logfs_state *logfs, uint8_t arena_id, struct slot_header *slot_hdr, uint16_t *curr_slot, uint32_t obj_id, uint16_t obj_inst_id)
 {
 	PIOS_Assert(slot_hdr);
 	PIOS_Assert(curr_slot);
@@ -666,10 +944,20 @@ static int16_t logfs_object_find_next (const struct logfs_state *logfs, struct s
 	/* First slot in the arena is reserved for arena header, skip it. */
 	if (*curr_slot == 0) *curr_slot = 1;
 
+	uint16_t hash = logfs_slot_hash(obj_id, obj_inst_id);
+
+	/* Only the active arena is indexed */
+	const uint16_t *slot_index = (arena_id == logfs->active_arena_id) ? logfs->slot_index : NULL;
+
 	for (uint16_t slot_id = *curr_slot;
-	     slot_id < (logfs->cfg->arena_size / logfs->cfg->slot_size);
+	     slot_id < logfs_used_slots(logfs, arena_id);
 	     slot_id++) {
-		uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, slot_id);
+		if (slot_index && slot_index[slot_id] != hash) {
+			/* Not active, or some other object */
+			continue;
+		}
+
+		uintptr_t slot_addr = logfs_get_addr (logfs, arena_id, slot_id);
 
 		if (PIOS_FLASH_read_data(logfs->partition_id,
 						slot_addr,
@@ -696,7 +984,7 @@ static int16_t logfs_object_find_next (const struct logfs_state *logfs, struct s
 
 /* NOTE: Must be called while holding the flash transaction lock */
 /* OPTIMIZE: could trust that there is at most one active version of every object and terminate the search when we find one */
-static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+static int8_t logfs_delete_from_arena (struct logfs_state *logfs, uint8_t arena_id, uint32_t obj_id, uint16_t obj_inst_id)
 {
 	int8_t rc;
 
@@ -704,11 +992,11 @@ static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, u
 	uint16_t curr_slot_id = 0;
 	do {
 		struct slot_header slot_hdr;
-		switch (logfs_object_find_next (logfs, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
+		switch (logfs_object_find_next (logfs, arena_id, &slot_hdr, &curr_slot_id, obj_id, obj_inst_id)) {
 		case 0:
 			/* Found a matching slot.  Obsolete it. */
 			slot_hdr.state = SLOT_STATE_OBSOLETE;
-			uintptr_t slot_addr = logfs_get_addr (logfs, logfs->active_arena_id, curr_slot_id);
+			uintptr_t slot_addr = logfs_get_addr (logfs, arena_id, curr_slot_id);
 
 			if (PIOS_FLASH_write_data(logfs->partition_id,
 							slot_addr,
@@ -717,7 +1005,13 @@ static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, u
 				rc = -2;
 				goto out_exit;
 			}
+			if (arena_id != logfs->active_arena_id) {
+				/* Garbage collection copy, not counted */
+				break;
+			}
+
 			/* Object has been successfully obsoleted and is no longer active */
+			logfs_index_set(logfs, curr_slot_id, &slot_hdr);
 			logfs->num_active_slots--;
 			break;
 		case -1:
@@ -736,6 +1030,19 @@ out_exit:
 	return rc;
 }
 
+/* NOTE: Must be called while holding the flash transaction lock */
+static int8_t logfs_delete_object (struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id)
+{
+	if (logfs->gc_state == LOGFS_GC_COPY) {
+		/* The garbage collection may have copied it already */
+		if (logfs_delete_from_arena (logfs, logfs->gc_arena_id, obj_id, obj_inst_id) != 0) {
+			return -1;
+		}
+	}
+
+	return logfs_delete_from_arena (logfs, logfs->active_arena_id, obj_id, obj_inst_id);
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 static int8_t logfs_reserve_free_slot (struct logfs_state *logfs, uint16_t *slot_id, struct slot_header *slot_hdr, uint32_t obj_id, uint16_t obj_inst_id, uint16_t obj_size)
 {
@@ -830,11 +1137,63 @@ static int8_t logfs_append_to_log (struct logfs_state *logfs, uint32_t obj_id, u
 	}
 
 	/* Object has been successfully written to the slot */
+	logfs_index_set(logfs, free_slot_id, &slot_hdr);
 	logfs->num_active_slots++;
 	return 0;
 }
 
 
+/**
+ * @brief Writes one object instance to the log, within a transaction
+ * @return 0 if success or an error code of PIOS_FLASHFS_ObjSave
+ */
+static int8_t logfs_save_object(struct logfs_state *logfs, uint32_t obj_id, uint16_t obj_inst_id, uint8_t *obj_data, uint16_t obj_size)
+{
+	PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
+
+	if (logfs_delete_object (logfs, obj_id, obj_inst_id) != 0) {
+		return -3;
+	}
+
+	/*
+	 * All old versions of this object + instance have been invalidated.
+	 * Write the new object.
+	 */
+
+	/* Check if the arena is entirely full. */
+	if (logfs_fs_is_full(logfs)) {
+		/* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
+		return -4;
+	}
+
+	/* Is garbage collection required? */
+	if (logfs_log_is_full(logfs)) {
+		/* Note: Log Full means the log is full but may contain obsolete slots so gc may free some space */
+		if (logfs_garbage_collect(logfs) != 0) {
+			return -5;
+		}
+		/* Check one more time just to be sure we actually free'd some space */
+		if (logfs_log_is_full(logfs)) {
+			/*
+			 * Log is still full even after gc!
+			 * NOTE: This should not happen since the filesystem wasn't full
+			 *       when we checked above so gc should have helped.
+			 */
+			PIOS_DEBUG_Assert(0);
+			return -6;
+		}
+	}
+
+	/* We have room for our new object.  Append it to the log. */
+	if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
+		/* Error during append */
+		return -7;
+	}
+
+	/* Object successfully written to the log */
+	return 0;
+}
+
 /**********************************
  *
  * Provide a PIOS_FLASHFS_* driver
@@ -869,61 +1228,49 @@ int32_t PIOS_FLASHFS_ObjSave(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
 		goto out_exit;
 	}
 
-	PIOS_Assert(obj_size <= (logfs->cfg->slot_size - sizeof(struct slot_header)));
-
 	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
 		rc = -2;
 		goto out_exit;
 	}
 
-	if (logfs_delete_object (logfs, obj_id, obj_inst_id) != 0) {
-		rc = -3;
-		goto out_end_trans;
-	}
+	rc = logfs_save_object(logfs, obj_id, obj_inst_id, obj_data, obj_size);
 
-	/*
-	 * All old versions of this object + instance have been invalidated.
-	 * Write the new object.
-	 */
+	PIOS_FLASH_end_transaction(logfs->partition_id);
 
-	/* Check if the arena is entirely full. */
-	if (logfs_fs_is_full(logfs)) {
-		/* Note: Filesystem Full means we're full of *active* records so gc won't help at all. */
-		rc = -4;
-		goto out_end_trans;
-	}
+out_exit:
+	return rc;
+}
 
-	/* Is garbage collection required? */
-	if (logfs_log_is_full(logfs)) {
-		/* Note: Log Full means the log is full but may contain obsolete slots so gc may free some space */
-		if (logfs_garbage_collect(logfs) != 0) {
-			rc = -5;
-			goto out_end_trans;
-		}
-		/* Check one more time just to be sure we actually free'd some space */
-		if (logfs_log_is_full(logfs)) {
-			/*
-			 * Log is still full even after gc!
-			 * NOTE: This should not happen since the filesystem wasn't full
-			 *       when we checked above so gc should have helped.
-			 */
-			PIOS_DEBUG_Assert(0);
-			rc = -6;
-			goto out_end_trans;
-		}
+/**
+ * @brief Saves a list of object instances to the filesystem in one transaction
+ * @param[in] fs_id The filesystem to use for this action
+ * @param[in] objs The object instances to save
+ * @param[in] num_objs Number of entries in objs
+ * @return 0 if success or error code of PIOS_FLASHFS_ObjSave
+ * @note Saving stops at the first failure; the objects before it stay saved.
+ */
+int32_t PIOS_FLASHFS_ObjSaveList(uintptr_t fs_id, const struct pios_flashfs_obj *objs, uint16_t num_objs)
+{
+	int8_t rc;
+
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		rc = -1;
+		goto out_exit;
 	}
 
-	/* We have room for our new object.  Append it to the log. */
-	if (logfs_append_to_log(logfs, obj_id, obj_inst_id, obj_data, obj_size) != 0) {
-		/* Error during append */
-		rc = -7;
-		goto out_end_trans;
+	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
+		rc = -2;
+		goto out_exit;
 	}
 
-	/* Object successfully written to the log */
 	rc = 0;
+	for (uint16_t i = 0; i < num_objs && rc == 0; i++) {
+		rc = logfs_save_object(logfs, objs[i].obj_id, objs[i].obj_inst_id,
+				objs[i].obj_data, objs[i].obj_size);
+	}
 
-out_end_trans:
 	PIOS_FLASH_end_transaction(logfs->partition_id);
 
 out_exit:
@@ -965,7 +1312,7 @@ int32_t PIOS_FLASHFS_ObjLoad(uintptr_t fs_id, uint32_t obj_id, uint16_t obj_inst
 	/* Find the object in the log */
 	uint16_t slot_id = 0;
 	struct slot_header slot_hdr;
-	if (logfs_object_find_next (logfs, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
+	if (logfs_object_find_next (logfs, logfs->active_arena_id, &slot_hdr, &slot_id, obj_id, obj_inst_id) != 0) {
 		/* Object does not exist in fs */
 		rc = -3;
 		goto out_end_trans;
@@ -1042,6 +1389,52 @@ out_exit:
 	return rc;
 }
 
+/**
+ * @brief Does a bounded step of garbage collection ahead of need
+ * @param[in] fs_id The filesystem to use for this action
+ * @return 0 if there is nothing left to do, 1 if more steps are needed, or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if failed to start transaction
+ * @retval -3 if garbage collection failed
+ * @note Collection starts when the log is mostly full of obsolete slots,
+ * so that saves rarely have to wait for a whole collection.  Each step
+ * erases one sector or copies a few slots.
+ */
+int32_t PIOS_FLASHFS_GarbageCollectStep(uintptr_t fs_id)
+{
+	int32_t rc;
+
+	struct logfs_state *logfs = (struct logfs_state *)fs_id;
+
+	if (!PIOS_FLASHFS_Logfs_validate(logfs)) {
+		rc = -1;
+		goto out_exit;
+	}
+
+	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
+		rc = -2;
+		goto out_exit;
+	}
+
+	if (logfs_gc_wanted(logfs) && logfs_gc_start(logfs) != 0) {
+		rc = -3;
+		goto out_end_trans;
+	}
+
+	if (logfs_gc_step(logfs) != 0) {
+		rc = -3;
+		goto out_end_trans;
+	}
+
+	rc = (logfs->gc_state != LOGFS_GC_IDLE) ? 1 : 0;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(logfs->partition_id);
+
+out_exit:
+	return rc;
+}
+
 /**
  * @brief Erases all filesystem arenas and activate the first arena
  * @param[in] fs_id The filesystem to use for this action
@@ -1067,6 +1460,8 @@ int32_t PIOS_FLASHFS_Format(uintptr_t fs_id)
 		logfs_unmount_log(logfs);
 	}
 
+	logfs->gc_state = LOGFS_GC_IDLE;
+
 	if (PIOS_FLASH_start_transaction(logfs->partition_id) != 0) {
 		rc = -2;
 		goto out_exit;
@@ -88,6 +88,7 @@ static void gcsreceiver_updated(UAVObjEvent * ev, void *ctx, void *obj, int len)
 	if (ev->obj == GCSReceiverHandle()) {
 		GCSReceiverGet(&gcsreceiverdata);
 		gcsrcvr_dev->Fresh = true;
+		PIOS_RCVR_Active();
 	}
 }
 
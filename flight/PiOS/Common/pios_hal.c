@@ -142,26 +142,47 @@ uintptr_t pios_com_debug_id;
 #define PIOS_COM_GPS_TX_BUF_LEN 16
 #endif
 
+/* F4 has the RAM to keep a full speed USB link busy */
 #ifndef PIOS_COM_TELEM_USB_RX_BUF_LEN
+#if defined(STM32F4XX)
+#define PIOS_COM_TELEM_USB_RX_BUF_LEN 257
+#else
 #define PIOS_COM_TELEM_USB_RX_BUF_LEN 65
 #endif
+#endif
 
 #ifndef PIOS_COM_TELEM_USB_TX_BUF_LEN
+#if defined(STM32F4XX)
+#define PIOS_COM_TELEM_USB_TX_BUF_LEN 513
+#else
 #define PIOS_COM_TELEM_USB_TX_BUF_LEN 65
 #endif
+#endif
 
 #ifndef PIOS_COM_BRIDGE_RX_BUF_LEN
+#if defined(STM32F4XX)
+#define PIOS_COM_BRIDGE_RX_BUF_LEN 513
+#else
 #define PIOS_COM_BRIDGE_RX_BUF_LEN 65
 #endif
+#endif
 
 #ifndef PIOS_COM_BRIDGE_TX_BUF_LEN
+#if defined(STM32F4XX)
+#define PIOS_COM_BRIDGE_TX_BUF_LEN 513
+#else
 #define PIOS_COM_BRIDGE_TX_BUF_LEN 12
 #endif
+#endif
 
 #ifndef PIOS_COM_MAVLINK_TX_BUF_LEN
 #define PIOS_COM_MAVLINK_TX_BUF_LEN 128
 #endif
 
+#ifndef PIOS_COM_MAVLINK_RX_BUF_LEN
+#define PIOS_COM_MAVLINK_RX_BUF_LEN 32
+#endif
+
 #ifndef PIOS_COM_MSP_TX_BUF_LEN
 #define PIOS_COM_MSP_TX_BUF_LEN 128
 #endif
@@ -784,7 +805,7 @@ void PIOS_HAL_ConfigurePort(HwSharedPortTypesOptions port_type,
 
 	case HWSHARED_PORTTYPES_MAVLINKTX:
 #if defined(PIOS_INCLUDE_MAVLINK)
-		PIOS_HAL_ConfigureCom(usart_port_cfg, &usart_port_params, 0, PIOS_COM_MAVLINK_TX_BUF_LEN, com_driver, &port_driver_id);
+		PIOS_HAL_ConfigureCom(usart_port_cfg, &usart_port_params, PIOS_COM_MAVLINK_RX_BUF_LEN, PIOS_COM_MAVLINK_TX_BUF_LEN, com_driver, &port_driver_id);
 		target = &pios_com_mavlink_id;
 		PIOS_Modules_Enable(PIOS_MODULE_UAVOMAVLINKBRIDGE);
 #endif          /* PIOS_INCLUDE_MAVLINK */
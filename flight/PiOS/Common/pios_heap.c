@@ -242,6 +242,144 @@ void PIOS_heap_increase_size(size_t bytes)
 }
 
 
+/*
+ * Block pools.  Each pool hands out blocks of a single size, carved out of
+ * regions taken from the standard or fast heap.  Freed blocks go on the
+ * pool's free list and are reused by the next allocation from that pool,
+ * so objects that come and go (event listeners) don't leak heap, and the
+ * alignment padding is paid once per region rather than once per block.
+ */
+struct pios_heap_pool {
+	void *free_list;
+	uint16_t block_size;
+	uint16_t blocks_per_region;
+	bool fast;
+
+	struct pios_heap_pool_stats stats;
+};
+
+struct pios_heap_pool *PIOS_heap_pool_create(size_t block_size,
+		uint16_t blocks_per_region, bool fast)
+{
+	if (block_size < sizeof(void *))
+		block_size = sizeof(void *);
+
+	/* Every block in the region must stay pointer-aligned */
+	block_size = (block_size + sizeof(uintptr_t) - 1) &
+		~(sizeof(uintptr_t) - 1);
+
+	if (block_size > UINT16_MAX || blocks_per_region == 0)
+		return NULL;
+
+	struct pios_heap_pool *pool = PIOS_malloc_no_dma(sizeof(*pool));
+
+	if (pool == NULL)
+		return NULL;
+
+	*pool = (struct pios_heap_pool) {
+		.block_size = block_size,
+		.blocks_per_region = blocks_per_region,
+		.fast = fast,
+	};
+
+	return pool;
+}
+
+static bool pool_grow(struct pios_heap_pool *pool)
+{
+	size_t region_size = (size_t)pool->block_size * pool->blocks_per_region;
+	uint8_t *region;
+
+	if (pool->fast)
+		region = PIOS_malloc_no_dma(region_size);
+	else
+		region = PIOS_malloc(region_size);
+
+	if (region == NULL)
+		return false;
+
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Thread_Scheduler_Suspend();
+#endif	/* PIOS_INCLUDE_RTOS */
+
+	for (uint16_t i = 0; i < pool->blocks_per_region; i++) {
+		void **block = (void **)(region + i * pool->block_size);
+
+		*block = pool->free_list;
+		pool->free_list = block;
+	}
+
+	pool->stats.capacity += pool->blocks_per_region;
+
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Thread_Scheduler_Resume();
+#endif	/* PIOS_INCLUDE_RTOS */
+
+	return true;
+}
+
+void *PIOS_heap_pool_alloc(struct pios_heap_pool *pool)
+{
+	void **block;
+
+	do {
+#if defined(PIOS_INCLUDE_RTOS)
+		PIOS_Thread_Scheduler_Suspend();
+#endif	/* PIOS_INCLUDE_RTOS */
+
+		block = pool->free_list;
+
+		if (block != NULL) {
+			pool->free_list = *block;
+
+			pool->stats.in_use++;
+			if (pool->stats.in_use > pool->stats.peak)
+				pool->stats.peak = pool->stats.in_use;
+		}
+
+#if defined(PIOS_INCLUDE_RTOS)
+		PIOS_Thread_Scheduler_Resume();
+#endif	/* PIOS_INCLUDE_RTOS */
+
+		/* The heap takes the scheduler lock itself, so grow the pool
+		 * with it released and try again. */
+	} while (block == NULL && pool_grow(pool));
+
+	return block;
+}
+
+void PIOS_heap_pool_free(struct pios_heap_pool *pool, void *buf)
+{
+	if (buf == NULL)
+		return;
+
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Thread_Scheduler_Suspend();
+#endif	/* PIOS_INCLUDE_RTOS */
+
+	*(void **)buf = pool->free_list;
+	pool->free_list = buf;
+	pool->stats.in_use--;
+
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Thread_Scheduler_Resume();
+#endif	/* PIOS_INCLUDE_RTOS */
+}
+
+void PIOS_heap_pool_get_stats(struct pios_heap_pool *pool,
+		struct pios_heap_pool_stats *stats)
+{
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Thread_Scheduler_Suspend();
+#endif	/* PIOS_INCLUDE_RTOS */
+
+	*stats = pool->stats;
+
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Thread_Scheduler_Resume();
+#endif	/* PIOS_INCLUDE_RTOS */
+}
+
 /* Provide an implementation of _sbrk for library functions.
  * Right now it returns failure always.
  */
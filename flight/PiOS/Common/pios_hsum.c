@@ -94,12 +94,22 @@ static uint16_t PIOS_HSUM_RxInCallback(uintptr_t context,
 				       uint16_t *headroom,
 				       bool *need_yield);
 static void PIOS_HSUM_Supervisor(uintptr_t hsum_id);
+static uint16_t PIOS_HSUM_FrameLen(const uint8_t *header);
+static bool PIOS_HSUM_DecodeFrame(uintptr_t context, const uint8_t *frame,
+				  uint16_t len);
 
 /* Local Variables */
 const struct pios_rcvr_driver pios_hsum_rcvr_driver = {
 	.read = PIOS_HSUM_Get,
 };
 
+static const struct pios_rxframe_proto pios_hsum_frame_proto = {
+	.header_len = HSUM_HEADER_LENGTH,
+	.frame_len = PIOS_HSUM_FrameLen,
+	.decode = PIOS_HSUM_DecodeFrame,
+	.gap_sync = true,
+};
+
 enum pios_hsum_dev_magic {
 	PIOS_HSUM_DEV_MAGIC = 0x4853554D,
 };
@@ -107,12 +117,10 @@ enum pios_hsum_dev_magic {
 struct pios_hsum_state {
 	uint16_t channel_data[PIOS_HSUM_NUM_INPUTS];
 	uint8_t received_data[HSUM_MAX_FRAME_LENGTH];
+	struct pios_rxframe rxframe;
 	uint8_t receive_timer;
 	uint8_t failsafe_timer;
-	uint8_t frame_found;
 	uint8_t tx_connected;
-	uint8_t byte_count;
-	uint8_t frame_length;
 };
 
 struct pios_hsum_dev {
@@ -156,7 +164,6 @@ static void PIOS_HSUM_ResetState(struct pios_hsum_dev *hsum_dev)
 	struct pios_hsum_state *state = &(hsum_dev->state);
 	state->receive_timer = 0;
 	state->failsafe_timer = 0;
-	state->frame_found = 0;
 	state->tx_connected = 0;
 	PIOS_HSUM_ResetChannels(hsum_dev);
 }
@@ -166,13 +173,14 @@ static void PIOS_HSUM_ResetState(struct pios_hsum_dev *hsum_dev)
  * \output 0 frame data accepted
  * \output -1 frame error found
  */
-static int PIOS_HSUM_UnrollChannels(struct pios_hsum_dev *hsum_dev)
+static int PIOS_HSUM_UnrollChannels(struct pios_hsum_dev *hsum_dev,
+				    const uint8_t *frame, uint16_t frame_len)
 {
 	struct pios_hsum_state *state = &(hsum_dev->state);
 
 	/* check the header and crc for a valid HoTT SUM stream */
-	uint8_t vendor = state->received_data[0];
-	uint8_t status = state->received_data[1];
+	uint8_t vendor = frame[0];
+	uint8_t status = frame[1];
 	if (vendor != HSUM_GRAUPNER_ID)
 		/* Graupner ID was expected */
 		goto stream_error;
@@ -184,26 +192,19 @@ static int PIOS_HSUM_UnrollChannels(struct pios_hsum_dev *hsum_dev)
 		/* check crc before processing */
 		if (hsum_dev->proto == PIOS_HSUM_PROTO_SUMD) {
 			/* SUMD has 16 bit CCITT CRC */
-			uint16_t crc = 0;
-			uint8_t *s = &(state->received_data[0]);
-			int len = state->byte_count - 2;
-			for (int n = 0; n < len; n++) {
-				crc ^= (uint16_t)s[n] << 8;
-				for (int i = 0; i < 8; i++)
-					crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
-			}
-			if (crc ^ (((uint16_t)s[len] << 8) | s[len + 1]))
+			int len = frame_len - 2;
+			uint16_t crc = PIOS_CRC16_CCITT_updateCRC(0, frame, len);
+			if (crc ^ (((uint16_t)frame[len] << 8) | frame[len + 1]))
 				/* wrong crc checksum found */
 				goto stream_error;
 		}
 		if (hsum_dev->proto == PIOS_HSUM_PROTO_SUMH) {
 			/* SUMH has only 8 bit added CRC */
 			uint8_t crc = 0;
-			uint8_t *s = &(state->received_data[0]);
-			int len = state->byte_count - 1;
+			int len = frame_len - 1;
 			for (int n = 0; n < len; n++)
-				crc += s[n];
-			if (crc ^ s[len])
+				crc += frame[n];
+			if (crc ^ frame[len])
 				/* wrong crc checksum found */
 				goto stream_error;
 		}
@@ -223,8 +224,8 @@ static int PIOS_HSUM_UnrollChannels(struct pios_hsum_dev *hsum_dev)
 	}
 	
 	/* unroll channels */
-	uint8_t n_channels = state->received_data[2];
-	uint8_t *s = &(state->received_data[3]);
+	uint8_t n_channels = frame[2];
+	const uint8_t *s = &frame[3];
 	uint16_t word;
 
 	for (int i = 0; i < HSUM_MAX_CHANNELS_PER_FRAME; i++) {
@@ -250,29 +251,27 @@ stream_error:
 	return -1;
 }
 
-/* Update decoder state processing input byte from the HoTT stream */
-static void PIOS_HSUM_UpdateState(struct pios_hsum_dev *hsum_dev, uint8_t byte)
+/* The 3rd header byte contains the number of channels */
+static uint16_t PIOS_HSUM_FrameLen(const uint8_t *header)
 {
-	struct pios_hsum_state *state = &(hsum_dev->state);
-	if (state->frame_found) {
-		/* receiving the data frame */
-		if (state->byte_count < HSUM_MAX_FRAME_LENGTH) {
-			/* store next byte */
-			state->received_data[state->byte_count++] = byte;
-			if (state->byte_count == HSUM_HEADER_LENGTH) {
-				/* 3rd byte contains the number of channels. calculate frame size */
-				state->frame_length = HSUM_OVERHEAD_LENGTH + 2 * byte;
-			}
-			if (state->byte_count == state->frame_length) {
-				/* full frame received - process and wait for new one */
-				if (!PIOS_HSUM_UnrollChannels(hsum_dev))
-					/* data looking good */
-					state->failsafe_timer = 0;
-				/* prepare for the next frame */
-				state->frame_found = 0;
-			}
-		}
-	}
+	if (header[2] > HSUM_MAX_CHANNELS_PER_FRAME)
+		return 0;
+
+	return HSUM_OVERHEAD_LENGTH + 2 * header[2];
+}
+
+/* Process a full frame; the next one starts after a gap */
+static bool PIOS_HSUM_DecodeFrame(uintptr_t context, const uint8_t *frame,
+				  uint16_t len)
+{
+	struct pios_hsum_dev *hsum_dev = (struct pios_hsum_dev *)context;
+
+	if (PIOS_HSUM_UnrollChannels(hsum_dev, frame, len))
+		return false;
+
+	/* data looking good */
+	hsum_dev->state.failsafe_timer = 0;
+	return true;
 }
 
 /* Initialise HoTT receiver interface */
@@ -294,6 +293,10 @@ int32_t PIOS_HSUM_Init(uintptr_t *hsum_id,
 	hsum_dev->proto = proto;
 
 	PIOS_HSUM_ResetState(hsum_dev);
+	PIOS_RxFrame_Init(&hsum_dev->state.rxframe, &pios_hsum_frame_proto,
+			  hsum_dev->state.received_data,
+			  sizeof(hsum_dev->state.received_data),
+			  (uintptr_t)hsum_dev);
 
 	*hsum_id = (uintptr_t)hsum_dev;
 
@@ -320,10 +323,8 @@ static uint16_t PIOS_HSUM_RxInCallback(uintptr_t context,
 	PIOS_Assert(valid);
 
 	/* process byte(s) and clear receive timer */
-	for (uint8_t i = 0; i < buf_len; i++) {
-		PIOS_HSUM_UpdateState(hsum_dev, buf[i]);
-		hsum_dev->state.receive_timer = 0;
-	}
+	PIOS_RxFrame_Push(&hsum_dev->state.rxframe, buf, buf_len);
+	hsum_dev->state.receive_timer = 0;
 
 	/* Always signal that we can accept more data */
 	if (headroom)
@@ -381,10 +382,8 @@ static void PIOS_HSUM_Supervisor(uintptr_t hsum_id)
 
 	/* waiting for new frame if no bytes were received in 8ms */
 	if (++state->receive_timer > 4) {
-		state->frame_found = 1;
-		state->byte_count = 0;
+		PIOS_RxFrame_Gap(&state->rxframe);
 		state->receive_timer = 0;
-		state->frame_length = HSUM_MAX_FRAME_LENGTH;
 	}
 
 	/* activate failsafe if no frames have arrived in 102.4ms */
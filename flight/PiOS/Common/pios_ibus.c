@@ -43,12 +43,11 @@
  */
 struct pios_ibus_dev {
 	uint32_t magic;
-	int buf_pos;
 	int rx_timer;
 	int failsafe_timer;
-	uint16_t checksum;
 	uint16_t channel_data[PIOS_IBUS_CHANNELS];
 	uint8_t rx_buf[PIOS_IBUS_BUFLEN];
+	struct pios_rxframe rxframe;
 };
 
 /**
@@ -87,15 +86,20 @@ static void PIOS_IBus_SetAllChannels(struct pios_ibus_dev *dev, uint16_t value);
 static uint16_t PIOS_IBus_Receive(uintptr_t context, uint8_t *buf, uint16_t buf_len,
 		uint16_t *headroom, bool *task_woken);
 /**
- * @brief Reset the internal receive buffer state
- * @param[in] dev device driver instance pointer
+ * @brief Frame length for a frame header
+ * @param[in] header First byte of the frame
+ * @retval Frame length, or 0 if this is not a sync byte
  */
-static void PIOS_IBus_ResetBuffer(struct pios_ibus_dev *dev);
+static uint16_t PIOS_IBus_FrameLen(const uint8_t *header);
 /**
- * @brief Unpack a frame from the internal receive buffer to the channel buffer
- * @param[in] dev device driver instance pointer
+ * @brief Check a complete frame and unpack it to the channel buffer
+ * @param[in] context Driver instance handle
+ * @param[in] frame Frame data
+ * @param[in] len Frame length
+ * @retval true if the checksum matched
  */
-static void PIOS_IBus_UnpackFrame(struct pios_ibus_dev *dev);
+static bool PIOS_IBus_UnpackFrame(uintptr_t context, const uint8_t *frame,
+		uint16_t len);
 /**
  * @brief RTC tick callback
  * @param[in] context Driver instance handle
@@ -107,6 +111,12 @@ const struct pios_rcvr_driver pios_ibus_rcvr_driver = {
 	.read = PIOS_IBus_Read,
 };
 
+static const struct pios_rxframe_proto pios_ibus_frame_proto = {
+	.header_len = 1,
+	.frame_len = PIOS_IBus_FrameLen,
+	.decode = PIOS_IBus_UnpackFrame,
+};
+
 
 static struct pios_ibus_dev *PIOS_IBus_Alloc(void)
 {
@@ -136,6 +146,8 @@ int PIOS_IBus_Init(uintptr_t *ibus_id, const struct pios_com_driver *driver,
 	*ibus_id = (uintptr_t)dev;
 
 	PIOS_IBus_SetAllChannels(dev, PIOS_RCVR_INVALID);
+	PIOS_RxFrame_Init(&dev->rxframe, &pios_ibus_frame_proto, dev->rx_buf,
+			sizeof(dev->rx_buf), *ibus_id);
 
 	if (!PIOS_RTC_RegisterTickCallback(PIOS_IBus_Supervisor, *ibus_id))
 		PIOS_Assert(0);
@@ -170,21 +182,12 @@ static uint16_t PIOS_IBus_Receive(uintptr_t context, uint8_t *buf, uint16_t buf_
 	if (!PIOS_IBus_Validate(dev))
 		goto out_fail;
 
-	for (int i = 0; i < buf_len; i++) {
-		if (dev->buf_pos == 0 && buf[i] != PIOS_IBUS_SYNCBYTE)
-			continue;
-
-		dev->rx_buf[dev->buf_pos++] = buf[i];
-		if (dev->buf_pos <= PIOS_IBUS_BUFLEN - 2)
-			dev->checksum -= buf[i];
-		else if (dev->buf_pos == PIOS_IBUS_BUFLEN)
-			PIOS_IBus_UnpackFrame(dev);
-	}
+	PIOS_RxFrame_Push(&dev->rxframe, buf, buf_len);
 
 	dev->rx_timer = 0;
 
 	if (headroom) {
-		*headroom = PIOS_IBUS_BUFLEN - dev->buf_pos;
+		*headroom = PIOS_IBUS_BUFLEN;
 	}
 
 	if (task_woken) {
@@ -205,27 +208,33 @@ out_fail:
 	return 0;
 }
 
-static void PIOS_IBus_ResetBuffer(struct pios_ibus_dev *dev)
+static uint16_t PIOS_IBus_FrameLen(const uint8_t *header)
 {
-	dev->checksum = 0xffff;
-	dev->buf_pos = 0;
+	return (header[0] == PIOS_IBUS_SYNCBYTE) ? PIOS_IBUS_BUFLEN : 0;
 }
 
-static void PIOS_IBus_UnpackFrame(struct pios_ibus_dev *dev)
+static bool PIOS_IBus_UnpackFrame(uintptr_t context, const uint8_t *frame,
+		uint16_t len)
 {
-	uint16_t rxsum = dev->rx_buf[PIOS_IBUS_BUFLEN - 1] << 8 |
-			dev->rx_buf[PIOS_IBUS_BUFLEN - 2];
-	if (dev->checksum != rxsum)
-		goto out_fail;
+	struct pios_ibus_dev *dev = (struct pios_ibus_dev *)context;
 
-	uint16_t *chan = (uint16_t *)&dev->rx_buf[2];
-	for (int i = 0; i < PIOS_IBUS_CHANNELS; i++)
-		dev->channel_data[i] = *chan++;
+	uint16_t checksum = 0xffff;
+	for (int i = 0; i < PIOS_IBUS_BUFLEN - 2; i++)
+		checksum -= frame[i];
+
+	uint16_t rxsum = frame[PIOS_IBUS_BUFLEN - 1] << 8 |
+			frame[PIOS_IBUS_BUFLEN - 2];
+	if (checksum != rxsum)
+		return false;
+
+	const uint8_t *chan = &frame[2];
+	for (int i = 0; i < PIOS_IBUS_CHANNELS; i++, chan += 2)
+		dev->channel_data[i] = chan[1] << 8 | chan[0];
 
 	dev->failsafe_timer = 0;
+	PIOS_RCVR_ActiveFromISR();
 
-out_fail:
-	PIOS_IBus_ResetBuffer(dev);
+	return true;
 }
 
 static void PIOS_IBus_Supervisor(uintptr_t context)
@@ -234,7 +243,7 @@ static void PIOS_IBus_Supervisor(uintptr_t context)
 	PIOS_Assert(PIOS_IBus_Validate(dev));
 
 	if (++dev->rx_timer > 3)
-		PIOS_IBus_ResetBuffer(dev);
+		PIOS_RxFrame_Gap(&dev->rxframe);
 
 	if (++dev->failsafe_timer > 32)
 		PIOS_IBus_SetAllChannels(dev, PIOS_RCVR_TIMEOUT);
@@ -69,6 +69,13 @@
 #define SYNC_INTERVAL_NTSC 33366
 #define SYNC_INTERVAL_PAL  40000
 
+#define SCREEN_SIZE (MAX7456_PAL_ROWS * MAX7456_COLUMNS)
+
+/* Readdressing costs three register writes plus the end of the previous
+ * run; rewriting up to this many unchanged characters is cheaper.
+ */
+#define FLUSH_MAX_GAP 3
+
 ///////////////////////////////////////////////////////////////////////////////
 
 struct max7456_dev_s {
@@ -80,15 +87,21 @@ struct max7456_dev_s {
 	uint8_t mode, right, bottom, hcenter, vcenter;
 
 	uint8_t mask;
-	bool opened;
 
 	bool force_mode;
 	uint8_t det_mode_fallback;
 
 	uint32_t next_sync_expected;
+
+	/* Frame being drawn, and what display memory holds */
+	uint8_t frame[SCREEN_SIZE];
+	uint8_t frame_attr[SCREEN_SIZE];
+	uint8_t shown[SCREEN_SIZE];
+	uint8_t shown_attr[SCREEN_SIZE];
 };
 
 static bool poll_vsync_spi (max7456_dev_t dev);
+static void clear_display(max7456_dev_t dev);
 
 /* Max7456 says 100ns period (10MHz) is OK.  But it may be off-board in
  * some circumstances, so let's not push our luck.
@@ -283,7 +296,7 @@ static void reset_hard(max7456_dev_t dev)
 		write_register_sel(dev, r, brightness);
 	}
 
-	PIOS_MAX7456_clear(dev);
+	clear_display(dev);
 }
 
 int PIOS_MAX7456_init(max7456_dev_t *dev_out,
@@ -314,11 +327,8 @@ void PIOS_MAX7456_set_mode(max7456_dev_t dev, bool force, uint8_t fallback)
 	detect_mode(dev);
 }
 
-void PIOS_MAX7456_clear(max7456_dev_t dev)
+static void clear_display(max7456_dev_t dev)
 {
-	PIOS_Assert(dev->magic == MAX7456_MAGIC);
-	PIOS_Assert(!dev->opened);
-
 	uint8_t dmm;
 	dmm = read_register_sel(dev, MAX7456_REG_DMM);
 
@@ -330,6 +340,17 @@ void PIOS_MAX7456_clear(max7456_dev_t dev)
 	while (MAX7456_DMM_CLR_R(dmm) != MAX7456_DMM_CLR_READY) {
 		dmm = read_register_sel(dev, MAX7456_REG_DMM);
 	}
+
+	memset(dev->shown, 0, sizeof(dev->shown));
+	memset(dev->shown_attr, 0, sizeof(dev->shown_attr));
+}
+
+void PIOS_MAX7456_clear(max7456_dev_t dev)
+{
+	PIOS_Assert(dev->magic == MAX7456_MAGIC);
+
+	memset(dev->frame, 0, sizeof(dev->frame));
+	memset(dev->frame_attr, 0, sizeof(dev->frame_attr));
 }
 
 void PIOS_MAX7456_upload_char (max7456_dev_t dev, uint8_t char_index,
@@ -408,16 +429,8 @@ void PIOS_MAX7456_download_char (max7456_dev_t dev, uint8_t char_index,
 }
 
 /* Assumes you have already selected */
-static inline void set_offset (max7456_dev_t dev, uint8_t col, uint8_t row)
+static inline void set_offset (max7456_dev_t dev, uint16_t offset)
 {
-	PIOS_Assert(dev->magic == MAX7456_MAGIC);
-
-	if (col > 29) {
-		// Still will wrap to next line...
-		col = 29;
-	}
-
-	uint16_t offset = (row * 30 + col) & 0x1ff;
 	write_register(dev, MAX7456_REG_DMAH, offset >> 8);
 	write_register(dev, MAX7456_REG_DMAL,(uint8_t) offset);
 }
@@ -434,59 +447,107 @@ void PIOS_MAX7456_put (max7456_dev_t dev,
 {
 	PIOS_Assert(dev->magic == MAX7456_MAGIC);
 
-	PIOS_Assert(!dev->opened);
+	if (col > 29) {
+		// Still will wrap to next line...
+		col = 29;
+	}
 
-	chip_select(dev);
-	set_offset(dev, col, row);
-	write_register(dev, MAX7456_REG_DMM,(attr & 0x07) << 3);
-	write_register(dev, MAX7456_REG_DMDI, chr);
-	chip_unselect(dev);
+	uint16_t offset = row * MAX7456_COLUMNS + col;
+
+	if (offset < SCREEN_SIZE) {
+		dev->frame[offset] = chr;
+		dev->frame_attr[offset] = attr & 0x07;
+	}
 }
 
-static void PIOS_MAX7456_open (max7456_dev_t dev, uint8_t col, uint8_t row,
-		uint8_t attr)
+#define valid_char(c) (c == MAX7456_DMDI_AUTOINCREMENT_STOP ? 0x00 : c)
+void PIOS_MAX7456_puts(max7456_dev_t dev, uint8_t col, uint8_t row, const char *s, uint8_t attr)
 {
 	PIOS_Assert(dev->magic == MAX7456_MAGIC);
 
-	PIOS_Assert(!dev->opened);
+	if (col == MAX7456_FMT_H_CENTER) {
+		col = ((MAX7456_COLUMNS - strlen(s)) / 2);
+	}
 
-	dev->opened = true;
+	uint16_t offset = (row > dev->bottom ? 0 : row) * MAX7456_COLUMNS +
+		(col > dev->right ? 0 : col);
 
-	chip_select(dev);
-	set_offset(dev, col > dev->right ? 0 : col, row > dev->bottom ? 0 : row);
+	// Like the chip's auto increment, runs on into the next line
+	while (*s && offset < SCREEN_SIZE)
+	{
+		dev->frame[offset] = valid_char(*s);
+		dev->frame_attr[offset] = attr & 0x07;
+		offset++;
+		s++;
+	}
+}
 
-	// 16 bits operating mode, char attributes, autoincrement
-	write_register(dev, MAX7456_REG_DMM, ((attr & 0x07) << 3) | 0x01);
+static inline bool cell_changed(max7456_dev_t dev, uint16_t i)
+{
+	return dev->frame[i] != dev->shown[i] ||
+		dev->frame_attr[i] != dev->shown_attr[i];
 }
 
-static void PIOS_MAX7456_close (max7456_dev_t dev)
+void PIOS_MAX7456_flush(max7456_dev_t dev)
 {
 	PIOS_Assert(dev->magic == MAX7456_MAGIC);
 
-	PIOS_Assert(dev->opened);
+	uint16_t i = 0;
 
-	// terminate autoincrement mode
-	write_register(dev, MAX7456_REG_DMDI, MAX7456_DMDI_AUTOINCREMENT_STOP);
+	while (i < SCREEN_SIZE) {
+		if (!cell_changed(dev, i)) {
+			i++;
+			continue;
+		}
 
-	chip_unselect(dev);
-	dev->opened = false;
-}
+		uint8_t attr = dev->frame_attr[i];
 
-#define valid_char(c) (c == MAX7456_DMDI_AUTOINCREMENT_STOP ? 0x00 : c)
-void PIOS_MAX7456_puts(max7456_dev_t dev, uint8_t col, uint8_t row, const char *s, uint8_t attr)
-{
-	PIOS_Assert(dev->magic == MAX7456_MAGIC);
+		chip_select(dev);
+		set_offset(dev, i);
 
-	if (col == MAX7456_FMT_H_CENTER) {
-		col = ((MAX7456_COLUMNS - strlen(s)) / 2);
-	}
-	PIOS_MAX7456_open(dev, col, row, attr);
-	while (*s)
-	{
-		write_register(dev, MAX7456_REG_DMDI, valid_char(*s));
-		s++;
+		if (dev->frame[i] == MAX7456_DMDI_AUTOINCREMENT_STOP) {
+			// Would end auto increment, so it has to go on its own
+			write_register(dev, MAX7456_REG_DMM, attr << 3);
+			write_register(dev, MAX7456_REG_DMDI, dev->frame[i]);
+			chip_unselect(dev);
+
+			dev->shown[i] = dev->frame[i];
+			dev->shown_attr[i] = attr;
+			i++;
+			continue;
+		}
+
+		/* Extend the run over following changes with the same
+		 * attributes, bridging short unchanged gaps.
+		 */
+		uint16_t last = i;
+
+		for (uint16_t j = i + 1; j < SCREEN_SIZE &&
+				j <= last + FLUSH_MAX_GAP + 1; j++) {
+			if (dev->frame_attr[j] != attr ||
+					dev->frame[j] == MAX7456_DMDI_AUTOINCREMENT_STOP) {
+				break;
+			}
+
+			if (cell_changed(dev, j)) {
+				last = j;
+			}
+		}
+
+		// 16 bits operating mode, char attributes, autoincrement
+		write_register(dev, MAX7456_REG_DMM, (attr << 3) | 0x01);
+
+		for (; i <= last; i++) {
+			write_register(dev, MAX7456_REG_DMDI, dev->frame[i]);
+			dev->shown[i] = dev->frame[i];
+			dev->shown_attr[i] = attr;
+		}
+
+		// terminate autoincrement mode
+		write_register(dev, MAX7456_REG_DMDI, MAX7456_DMDI_AUTOINCREMENT_STOP);
+
+		chip_unselect(dev);
 	}
-	PIOS_MAX7456_close(dev);
 }
 
 void PIOS_MAX7456_get_extents(max7456_dev_t dev, 
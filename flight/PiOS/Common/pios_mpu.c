@@ -38,6 +38,7 @@
 #include "pios_queue.h"
 #include "physical_constants.h"
 #include "taskmonitor.h"
+#include "loopmonitor.h"
 
 #include "pios_mpu_priv.h"
 
@@ -991,6 +992,8 @@ static void PIOS_MPU_Task(void *parameters)
 		if (PIOS_Semaphore_Take(mpu_dev->data_ready_sema, PIOS_SEMAPHORE_TIMEOUT_MAX) != true)
 			continue;
 
+		uint32_t read_start = LoopMonitorStart();
+
 #if defined(PIOS_INCLUDE_SPI)
 		if (mpu_dev->com_driver_type == PIOS_MPU_COM_SPI) {
 			// claim bus in high speed mode
@@ -1014,8 +1017,17 @@ static void PIOS_MPU_Task(void *parameters)
 		}
 #endif // defined(PIOS_INCLUDE_I2C)
 
-		struct pios_sensor_accel_data accel_data;
-		struct pios_sensor_gyro_data gyro_data;
+		// Fill the queue slots in place rather than copying samples in
+		struct pios_sensor_accel_data *accel_data = PIOS_Queue_Reserve(mpu_dev->accel_queue);
+		struct pios_sensor_gyro_data *gyro_data = PIOS_Queue_Reserve(mpu_dev->gyro_queue);
+
+		if (!accel_data || !gyro_data) {
+			if (accel_data)
+				PIOS_Queue_Release(mpu_dev->accel_queue, accel_data);
+			if (gyro_data)
+				PIOS_Queue_Release(mpu_dev->gyro_queue, gyro_data);
+			continue;
+		}
 
 		float accel_x = (int16_t)(mpu_rec_buf[IDX_ACCEL_XOUT_H] << 8 | mpu_rec_buf[IDX_ACCEL_XOUT_L]);
 		float accel_y = (int16_t)(mpu_rec_buf[IDX_ACCEL_YOUT_H] << 8 | mpu_rec_buf[IDX_ACCEL_YOUT_L]);
@@ -1041,12 +1053,12 @@ static void PIOS_MPU_Task(void *parameters)
 		 */
 		switch (mpu_dev->cfg->orientation) {
 		case PIOS_MPU_TOP_0DEG:
-			accel_data.x =  accel_y;
-			accel_data.y =  accel_x;
-			accel_data.z = -accel_z;
-			gyro_data.x  =  gyro_y;
-			gyro_data.y  =  gyro_x;
-			gyro_data.z  = -gyro_z;
+			accel_data->x =  accel_y;
+			accel_data->y =  accel_x;
+			accel_data->z = -accel_z;
+			gyro_data->x  =  gyro_y;
+			gyro_data->y  =  gyro_x;
+			gyro_data->z  = -gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   =  mag_x;
 			mag_data.y   =  mag_y;
@@ -1054,12 +1066,12 @@ static void PIOS_MPU_Task(void *parameters)
 #endif // PIOS_INCLUDE_MPU_MAG
 			break;
 		case PIOS_MPU_TOP_90DEG:
-			accel_data.x = -accel_x;
-			accel_data.y =  accel_y;
-			accel_data.z = -accel_z;
-			gyro_data.x  = -gyro_x;
-			gyro_data.y  =  gyro_y;
-			gyro_data.z  = -gyro_z;
+			accel_data->x = -accel_x;
+			accel_data->y =  accel_y;
+			accel_data->z = -accel_z;
+			gyro_data->x  = -gyro_x;
+			gyro_data->y  =  gyro_y;
+			gyro_data->z  = -gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   = -mag_y;
 			mag_data.y   =  mag_x;
@@ -1067,12 +1079,12 @@ static void PIOS_MPU_Task(void *parameters)
 #endif // PIOS_INCLUDE_MPU_MAG
 			break;
 		case PIOS_MPU_TOP_180DEG:
-			accel_data.x = -accel_y;
-			accel_data.y = -accel_x;
-			accel_data.z = -accel_z;
-			gyro_data.x  = -gyro_y;
-			gyro_data.y  = -gyro_x;
-			gyro_data.z  = -gyro_z;
+			accel_data->x = -accel_y;
+			accel_data->y = -accel_x;
+			accel_data->z = -accel_z;
+			gyro_data->x  = -gyro_y;
+			gyro_data->y  = -gyro_x;
+			gyro_data->z  = -gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   = -mag_x;
 			mag_data.y   = -mag_y;
@@ -1080,12 +1092,12 @@ static void PIOS_MPU_Task(void *parameters)
 #endif // PIOS_INCLUDE_MPU_MAG
 			break;
 		case PIOS_MPU_TOP_270DEG:
-			accel_data.x =  accel_x;
-			accel_data.y = -accel_y;
-			accel_data.z = -accel_z;
-			gyro_data.x  =  gyro_x;
-			gyro_data.y  = -gyro_y;
-			gyro_data.z  = -gyro_z;
+			accel_data->x =  accel_x;
+			accel_data->y = -accel_y;
+			accel_data->z = -accel_z;
+			gyro_data->x  =  gyro_x;
+			gyro_data->y  = -gyro_y;
+			gyro_data->z  = -gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   =  mag_y;
 			mag_data.y   = -mag_x;
@@ -1093,12 +1105,12 @@ static void PIOS_MPU_Task(void *parameters)
 #endif // PIOS_INCLUDE_MPU_MAG
 			break;
 		case PIOS_MPU_BOTTOM_0DEG:
-			accel_data.x =  accel_y;
-			accel_data.y = -accel_x;
-			accel_data.z =  accel_z;
-			gyro_data.x  =  gyro_y;
-			gyro_data.y  = -gyro_x;
-			gyro_data.z  =  gyro_z;
+			accel_data->x =  accel_y;
+			accel_data->y = -accel_x;
+			accel_data->z =  accel_z;
+			gyro_data->x  =  gyro_y;
+			gyro_data->y  = -gyro_x;
+			gyro_data->z  =  gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   =  mag_x;
 			mag_data.y   = -mag_y;
@@ -1107,12 +1119,12 @@ static void PIOS_MPU_Task(void *parameters)
 			break;
 
 		case PIOS_MPU_BOTTOM_90DEG:
-			accel_data.x =  accel_x;
-			accel_data.y =  accel_y;
-			accel_data.z =  accel_z;
-			gyro_data.x  =  gyro_x;
-			gyro_data.y  =  gyro_y;
-			gyro_data.z  =  gyro_z;
+			accel_data->x =  accel_x;
+			accel_data->y =  accel_y;
+			accel_data->z =  accel_z;
+			gyro_data->x  =  gyro_x;
+			gyro_data->y  =  gyro_y;
+			gyro_data->z  =  gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   =  mag_y;
 			mag_data.y   =  mag_x;
@@ -1121,12 +1133,12 @@ static void PIOS_MPU_Task(void *parameters)
 			break;
 
 		case PIOS_MPU_BOTTOM_180DEG:
-			accel_data.x = -accel_y;
-			accel_data.y =  accel_x;
-			accel_data.z =  accel_z;
-			gyro_data.x  = -gyro_y;
-			gyro_data.y  =  gyro_x;
-			gyro_data.z  =  gyro_z;
+			accel_data->x = -accel_y;
+			accel_data->y =  accel_x;
+			accel_data->z =  accel_z;
+			gyro_data->x  = -gyro_y;
+			gyro_data->y  =  gyro_x;
+			gyro_data->z  =  gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   = -mag_x;
 			mag_data.y   =  mag_y;
@@ -1135,12 +1147,12 @@ static void PIOS_MPU_Task(void *parameters)
 			break;
 
 		case PIOS_MPU_BOTTOM_270DEG:
-			accel_data.x = -accel_x;
-			accel_data.y = -accel_y;
-			accel_data.z =  accel_z;
-			gyro_data.x  = -gyro_x;
-			gyro_data.y  = -gyro_y;
-			gyro_data.z  =  gyro_z;
+			accel_data->x = -accel_x;
+			accel_data->y = -accel_y;
+			accel_data->z =  accel_z;
+			gyro_data->x  = -gyro_x;
+			gyro_data->y  = -gyro_y;
+			gyro_data->z  =  gyro_z;
 #ifdef PIOS_INCLUDE_MPU_MAG
 			mag_data.x   = -mag_y;
 			mag_data.y   = -mag_x;
@@ -1158,19 +1170,21 @@ static void PIOS_MPU_Task(void *parameters)
 
 		// Apply sensor scaling
 		float accel_scale = PIOS_MPU_GetAccelScale();
-		accel_data.x *= accel_scale;
-		accel_data.y *= accel_scale;
-		accel_data.z *= accel_scale;
-		accel_data.temperature = temperature;
+		accel_data->x *= accel_scale;
+		accel_data->y *= accel_scale;
+		accel_data->z *= accel_scale;
+		accel_data->temperature = temperature;
 
 		float gyro_scale = PIOS_MPU_GetGyroScale();
-		gyro_data.x *= gyro_scale;
-		gyro_data.y *= gyro_scale;
-		gyro_data.z *= gyro_scale;
-		gyro_data.temperature = temperature;
+		gyro_data->x *= gyro_scale;
+		gyro_data->y *= gyro_scale;
+		gyro_data->z *= gyro_scale;
+		gyro_data->temperature = temperature;
+
+		LoopMonitorEnd(LOOPMONITOR_SENSORREAD, read_start);
 
-		PIOS_Queue_Send(mpu_dev->accel_queue, &accel_data, 0);
-		PIOS_Queue_Send(mpu_dev->gyro_queue, &gyro_data, 0);
+		PIOS_Queue_Commit(mpu_dev->accel_queue, accel_data, 0);
+		PIOS_Queue_Commit(mpu_dev->gyro_queue, gyro_data, 0);
 
 #ifdef PIOS_INCLUDE_MPU_MAG
 		if (mpu_dev->use_mag) {
@@ -853,7 +853,11 @@ static void pios_openlrs_rx_loop(struct pios_openlrs_dev *openlrs_dev)
 
 	if (openlrs_dev->rf_mode == Received) {
 
-		DEBUG_PRINTF(2,"Packet Received. Dt=%d\r\n", timeUs-openlrs_dev->lastPacketTimeUs);
+		// The packet arrived when the radio raised nIRQ, not when this
+		// task got around to it; hops are timed from the arrival
+		uint32_t packetTimeUs = openlrs_dev->irqTimeUs;
+
+		DEBUG_PRINTF(2,"Packet Received. Dt=%d\r\n", packetTimeUs-openlrs_dev->lastPacketTimeUs);
 
 		// Read the packet from RFM22b
 		rfm22_claimBus(openlrs_dev);
@@ -871,7 +875,7 @@ static void pios_openlrs_rx_loop(struct pios_openlrs_dev *openlrs_dev)
 		PIOS_ANNUNC_Toggle(PIOS_LED_LINK);
 #endif /* PIOS_LED_LINK */
 
-		openlrs_dev->lastPacketTimeUs = timeUs;
+		openlrs_dev->lastPacketTimeUs = packetTimeUs;
 		openlrs_dev->numberOfLostPackets = 0;
 		openlrs_status.LinkQuality <<= 1;
 		openlrs_status.LinkQuality |= 1;
@@ -1259,7 +1263,7 @@ static void pios_openlrs_task(void *parameters)
 			// If we have sampled RSSI we want to schedule to hop when a packet has been missed
 			uint32_t time_till_timeout_us  = (getInterval(&openlrs_dev->bind_data) + packet_timeout_us) - time_since_packet_us;
 			delay_ms = (time_till_timeout_us + 999) / 1000;
-			DEBUG_PRINTF(3, "T2: %d %d\r\n", time_till_timeout_us,delay_ms, time_since_packet_us);
+			DEBUG_PRINTF(3, "T2: %d %d %d\r\n", time_till_timeout_us, delay_ms, time_since_packet_us);
 		}
 
 		// Maximum delay based on packet time
@@ -1274,17 +1278,17 @@ static void pios_openlrs_task(void *parameters)
 					openlrs_dev->lastRSSITimeUs = openlrs_dev->lastPacketTimeUs;
 					openlrs_status.LastRSSI = rfmGetRSSI(openlrs_dev); // Read the RSSI value
 
-					DEBUG_PRINTF(3, "Sampled RSSI: %d %d\r\n", openlrs_status.LastRSSI, delay);
+					DEBUG_PRINTF(3, "Sampled RSSI: %d %d\r\n", openlrs_status.LastRSSI, delay_ms);
 				}
 			} else {
 				// We timed out because packet was missed
-				DEBUG_PRINTF(3, "ISR Timeout. Missed packet: %d %d %d\r\n", delay, getInterval(&openlrs_dev->bind_data), time_since_packet_us);
+				DEBUG_PRINTF(3, "ISR Timeout. Missed packet: %d %d %d\r\n", delay_ms, getInterval(&openlrs_dev->bind_data), time_since_packet_us);
 				pios_openlrs_rx_loop(openlrs_dev);
 			}
 
 			rssi_sampled = true;
 		} else {
-			DEBUG_PRINTF(3, "ISR %d %d %d\r\n", delay, getInterval(&openlrs_dev->bind_data), time_since_packet_us);
+			DEBUG_PRINTF(3, "ISR %d %d %d\r\n", delay_ms, getInterval(&openlrs_dev->bind_data), time_since_packet_us);
 
 			// Process incoming data
 			pios_openlrs_rx_loop(openlrs_dev);
@@ -1308,6 +1312,7 @@ bool PIOS_OpenLRS_EXT_Int(void)
 		openlrs_dev->rf_mode = Transmitted;
 	}
 	else if (openlrs_dev->rf_mode == Receive) {
+		openlrs_dev->irqTimeUs = PIOS_DELAY_GetuS();
 		openlrs_dev->rf_mode = Received;
 	}
 
@@ -45,6 +45,16 @@ struct pios_queue
 #define PIOS_QUEUE_MAX_WAITERS 2
 #endif /* !defined(PIOS_QUEUE_MAX_WAITERS) */
 
+static systime_t PIOS_Queue_Timeout(uint32_t timeout_ms)
+{
+	if (timeout_ms == PIOS_QUEUE_TIMEOUT_MAX)
+		return TIME_INFINITE;
+	else if (timeout_ms == 0)
+		return TIME_IMMEDIATE;
+	else
+		return MS2ST(timeout_ms);
+}
+
 /**
  *
  * @brief   Creates a queue.
@@ -100,29 +110,13 @@ void PIOS_Queue_Delete(struct pios_queue *queuep)
  */
 bool PIOS_Queue_Send(struct pios_queue *queuep, const void *itemp, uint32_t timeout_ms)
 {
-	void *buf = chPoolAlloc(&queuep->mp);
+	void *buf = PIOS_Queue_Reserve(queuep);
 	if (buf == NULL)
 		return false;
 
 	memcpy(buf, itemp, queuep->mp.mp_object_size);
 
-	systime_t timeout;
-	if (timeout_ms == PIOS_QUEUE_TIMEOUT_MAX)
-		timeout = TIME_INFINITE;
-	else if (timeout_ms == 0)
-		timeout = TIME_IMMEDIATE;
-	else
-		timeout = MS2ST(timeout_ms);
-
-	msg_t result = chMBPost(&queuep->mb, (msg_t)buf, timeout);
-
-	if (result != RDY_OK)
-	{
-		chPoolFree(&queuep->mp, buf);
-		return false;
-	}
-
-	return true;
+	return PIOS_Queue_Commit(queuep, buf, timeout_ms);
 }
 
 /**
@@ -175,26 +169,93 @@ bool PIOS_Queue_Send_FromISR(struct pios_queue *queuep, const void *itemp, bool
  */
 bool PIOS_Queue_Receive(struct pios_queue *queuep, void *itemp, uint32_t timeout_ms)
 {
-	msg_t buf;
+	void *buf = PIOS_Queue_Peek(queuep, timeout_ms);
+	if (buf == NULL)
+		return false;
 
-	systime_t timeout;
-	if (timeout_ms == PIOS_QUEUE_TIMEOUT_MAX)
-		timeout = TIME_INFINITE;
-	else if (timeout_ms == 0)
-		timeout = TIME_IMMEDIATE;
-	else
-		timeout = MS2ST(timeout_ms);
+	memcpy(itemp, buf, queuep->mp.mp_object_size);
+
+	PIOS_Queue_Release(queuep, buf);
 
-	msg_t result = chMBFetch(&queuep->mb, &buf, timeout);
+	return true;
+}
+
+/**
+ *
+ * @brief   Reserves a free item slot to be filled in place.
+ *
+ * @param[in] queuep       pointer to instance of @p struct pios_queue
+ *
+ * @returns pointer to the slot, or NULL if none is free
+ *
+ */
+void *PIOS_Queue_Reserve(struct pios_queue *queuep)
+{
+	return chPoolAlloc(&queuep->mp);
+}
+
+/**
+ *
+ * @brief   Appends a reserved slot to a queue.  On failure the slot is
+ *          released, so the caller no longer owns it either way.
+ *
+ * @param[in] queuep       pointer to instance of @p struct pios_queue
+ * @param[in] itemp        slot from @p PIOS_Queue_Reserve
+ * @param[in] timeout_ms   timeout for appending item to queue in milliseconds
+ *
+ * @returns true on success or false on timeout or failure
+ *
+ */
+bool PIOS_Queue_Commit(struct pios_queue *queuep, void *itemp, uint32_t timeout_ms)
+{
+	msg_t result = chMBPost(&queuep->mb, (msg_t)itemp,
+			PIOS_Queue_Timeout(timeout_ms));
 
 	if (result != RDY_OK)
+	{
+		chPoolFree(&queuep->mp, itemp);
 		return false;
+	}
 
-	memcpy(itemp, (void*)buf, queuep->mp.mp_object_size);
+	return true;
+}
 
-	chPoolFree(&queuep->mp, (void*)buf);
+/**
+ *
+ * @brief   Takes the item at the front of a queue without copying it.
+ *          The slot must be handed back with @p PIOS_Queue_Release.
+ *
+ * @param[in] queuep       pointer to instance of @p struct pios_queue
+ * @param[in] timeout_ms   timeout for retrieving item from queue in milliseconds
+ *
+ * @returns pointer to the item, or NULL on timeout or failure
+ *
+ */
+void *PIOS_Queue_Peek(struct pios_queue *queuep, uint32_t timeout_ms)
+{
+	msg_t buf;
 
-	return true;
+	msg_t result = chMBFetch(&queuep->mb, &buf,
+			PIOS_Queue_Timeout(timeout_ms));
+
+	if (result != RDY_OK)
+		return NULL;
+
+	return (void *)buf;
+}
+
+/**
+ *
+ * @brief   Returns a slot obtained from @p PIOS_Queue_Peek or
+ *          @p PIOS_Queue_Reserve to the queue's free pool.
+ *
+ * @param[in] queuep       pointer to instance of @p struct pios_queue
+ * @param[in] itemp        the slot
+ *
+ */
+void PIOS_Queue_Release(struct pios_queue *queuep, void *itemp)
+{
+	chPoolFree(&queuep->mp, itemp);
 }
 
 #endif /* defined(PIOS_INCLUDE_CHIBIOS) */
@@ -120,40 +120,54 @@ int32_t PIOS_RCVR_Read(uintptr_t rcvr_id, uint8_t channel)
 
 #define MIN_WAKE_INTERVAL_uS 4000	/* 250Hz ought to be enough for anyone*/
 
+/**
+ * @brief Waits for a receiver to deliver a new frame
+ * @param[in] timeout_ms how long to wait before giving up, so the caller
+ * can keep running its failsafe checks without a receiver
+ * @returns true if woken by a frame, false on timeout
+ *
+ * Frames arriving faster than MIN_WAKE_INTERVAL_uS are picked up late
+ * rather than dropped, so a frame never waits for the timeout.
+ */
 bool PIOS_RCVR_WaitActivity(uint32_t timeout_ms) {
-  if (rcvr_activity) {
-    bool result = PIOS_Semaphore_Take(rcvr_activity, timeout_ms);
-    if(!result) {
-      // If the semaphore times out, update last wake, to try to avoid
-      // resonance due to jitter, when the update rate of the receiver
-      // matches the timeout.
-      rcvr_last_wake = PIOS_DELAY_GetRaw();
-    }
-    return result;
-  } else {
+  if (!rcvr_activity) {
     PIOS_Thread_Sleep(timeout_ms);
 
     return false;
   }
+
+  if (!PIOS_Semaphore_Take(rcvr_activity, timeout_ms)) {
+    return false;
+  }
+
+  uint32_t since_wake = PIOS_DELAY_DiffuS(rcvr_last_wake);
+
+  if (since_wake < MIN_WAKE_INTERVAL_uS) {
+    PIOS_Thread_Sleep((MIN_WAKE_INTERVAL_uS - since_wake + 999) / 1000);
+  }
+
+  rcvr_last_wake = PIOS_DELAY_GetRaw();
+
+  return true;
 }
 
+/**
+ * @brief Signals that a receiver has completed a new frame
+ */
 void PIOS_RCVR_Active() {
-  if (PIOS_DELAY_DiffuS(rcvr_last_wake) >= MIN_WAKE_INTERVAL_uS) {
-    if (rcvr_activity) {
-      rcvr_last_wake = PIOS_DELAY_GetRaw();
-      PIOS_Semaphore_Give(rcvr_activity);
-    }
+  if (rcvr_activity) {
+    PIOS_Semaphore_Give(rcvr_activity);
   }
 }
 
+/**
+ * @brief Signals that a receiver has completed a new frame, from an ISR
+ */
 void PIOS_RCVR_ActiveFromISR() {
-  if (PIOS_DELAY_DiffuS(rcvr_last_wake) >= MIN_WAKE_INTERVAL_uS) {
-    bool dont_care;
+  bool dont_care;
 
-    if (rcvr_activity) {
-      rcvr_last_wake = PIOS_DELAY_GetRaw();
-      PIOS_Semaphore_Give_FromISR(rcvr_activity, &dont_care);
-    }
+  if (rcvr_activity) {
+    PIOS_Semaphore_Give_FromISR(rcvr_activity, &dont_care);
   }
 }
 
@@ -109,6 +109,10 @@
 #define RFM22B_DEFAULT_CHANNEL_SET       24
 #define RFM22B_PPM_ONLY_DATARATE         HWSHARED_MAXRFSPEED_9600
 #define RADIO_SYNC_PULSES_DISCONNECT     3
+#define RFM22B_ADAPT_MIN_DATA            32	// Bytes a slot must still carry to step down to a datarate
+#define RFM22B_ADAPT_CYCLES              8	// Hop cycles of packets to judge the link by
+#define RFM22B_ADAPT_SWITCH_CYCLES       2	// Hop cycles from announcing a datarate to using it
+#define RFM22B_ADAPT_HOLDOFF             4	// Judgements to wait after stepping down
 // The maximum amount of time without activity before initiating a reset.
 #define PIOS_RFM22B_SUPERVISOR_TIMEOUT   150	// ms
 
@@ -221,6 +225,10 @@ static uint32_t rfm22_coordinatorTime(struct pios_rfm22b_dev *rfm22b_dev, uint32
 static uint8_t rfm22_calcChannel(struct pios_rfm22b_dev *rfm22b_dev, uint8_t index);
 static uint8_t rfm22_calcChannelFromClock(struct pios_rfm22b_dev *rfm22b_dev);
 static bool rfm22_changeChannel(struct pios_rfm22b_dev *rfm22b_dev);
+static uint8_t rfm22_maxPacketLen(struct pios_rfm22b_dev *rfm22b_dev, uint8_t datarate);
+static void rfm22_setAirDatarate(struct pios_rfm22b_dev *rfm22b_dev, uint8_t datarate);
+static bool rfm22_adaptDatarate(struct pios_rfm22b_dev *rfm22b_dev);
+static uint8_t rfm22_rateControl(struct pios_rfm22b_dev *rfm22b_dev);
 static void rfm22_clearLEDs();
 static bool rfm22_InRxWait(struct pios_rfm22b_dev * rfb22b_id);
 
@@ -706,16 +714,53 @@ void PIOS_RFM22B_Config(uint32_t rfm22b_id,
 	}
 
 	// Calculate the maximum packet length from the datarate.
+	rfm22b_dev->max_packet_len = rfm22_maxPacketLen(rfm22b_dev, datarate);
+
+	// The slots keep the timing of the configured datarate, so a slower one
+	// only fits a shorter packet.  Only step down as far as a packet still
+	// carries a useful amount of data.  The coordinator judges the link by
+	// what it hears back, so one way links stay put.
+	uint8_t min_air_datarate = datarate;
+	if (!ppm_only && !rfm22b_dev->one_way_link) {
+		uint8_t overhead = RS_ECC_NPARITY + 1 +
+			(ppm_mode ? RFM22B_PPM_NUM_CHANNELS + 1 : 0);
+
+		while (min_air_datarate > 0 &&
+				rfm22_maxPacketLen(rfm22b_dev, min_air_datarate - 1) >=
+				overhead + RFM22B_ADAPT_MIN_DATA) {
+			min_air_datarate--;
+		}
+	}
+	rfm22b_dev->min_air_datarate = min_air_datarate;
+
+	rfm22b_dev->air_datarate = datarate;
+	rfm22b_dev->pending_datarate = datarate;
+	rfm22b_dev->air_max_packet_len = rfm22b_dev->max_packet_len;
+}
+
+/**
+ * The longest packet that fits in a slot at a datarate.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] datarate  The datarate lookup index
+ */
+static uint8_t rfm22_maxPacketLen(struct pios_rfm22b_dev *rfm22b_dev, uint8_t datarate)
+{
 	float bytes_per_period =
 	    (float)data_rate[datarate] * (float)(rfm22b_dev->packet_time -
 						 2) / 9000;
 
-	rfm22b_dev->max_packet_len =
-	    bytes_per_period - TX_PREAMBLE_NIBBLES / 2 - SYNC_BYTES -
+	int32_t len = bytes_per_period - TX_PREAMBLE_NIBBLES / 2 - SYNC_BYTES -
 	    HEADER_BYTES - LENGTH_BYTES;
-	if (rfm22b_dev->max_packet_len > RFM22B_MAX_PACKET_LEN) {
-		rfm22b_dev->max_packet_len = RFM22B_MAX_PACKET_LEN;
+
+	if (len < 0) {
+		return 0;
+	}
+	if (len > RFM22B_MAX_PACKET_LEN) {
+		return RFM22B_MAX_PACKET_LEN;
 	}
+
+	return len;
 }
 
 /**
@@ -751,6 +796,7 @@ void PIOS_RFM22B_GetStats(uint32_t rfm22b_id, struct rfm22b_stats *stats)
 	}
 	// Calculate the current link quality
 	rfm22_calculateLinkQuality(rfm22b_dev);
+	rfm22b_dev->stats.air_datarate = data_rate[rfm22b_dev->air_datarate];
 
 	// Return the stats.
 	memcpy(stats, &rfm22b_dev->stats, sizeof(rfm22b_dev->stats));
@@ -1236,8 +1282,9 @@ static void pios_rfm22_task(void *parameters)
 			rfm22_process_event(rfm22b_dev, RADIO_EVENT_ERROR);
 		}
 
-		// Change channels if necessary.
-		if (rfm22_changeChannel(rfm22b_dev)) {
+		// Change channels and datarates if necessary.
+		bool new_channel = rfm22_changeChannel(rfm22b_dev);
+		if (rfm22_adaptDatarate(rfm22b_dev) || new_channel) {
 			rfm22_process_event(rfm22b_dev, RADIO_EVENT_RX_MODE);
 		}
 
@@ -1607,7 +1654,7 @@ static enum pios_radio_event rfm22_init(struct pios_rfm22b_dev *rfm22b_dev)
 
 	// Initialize the frequency and datarate to te default.
 	rfm22_setNominalCarrierFrequency(rfm22b_dev, 0, rfm22b_dev->base_freq);
-	pios_rfm22_setDatarate(rfm22b_dev);
+	rfm22_setAirDatarate(rfm22b_dev, rfm22b_dev->datarate);
 
 	return RADIO_EVENT_INITIALIZED;
 }
@@ -1627,7 +1674,7 @@ static enum pios_radio_event rfm22_init(struct pios_rfm22b_dev *rfm22b_dev)
  */
 static void pios_rfm22_setDatarate(struct pios_rfm22b_dev *rfm22b_dev)
 {
-	HwSharedMaxRfSpeedOptions datarate = rfm22b_dev->datarate;
+	uint8_t datarate = rfm22b_dev->air_datarate;
 	bool data_whitening = true;
 
 	// Claim the SPI bus.
@@ -1839,7 +1886,7 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev
 	uint8_t *p = radio_dev->tx_packet;
 	uint8_t len = 0;
 	uint8_t max_data_len =
-	    radio_dev->max_packet_len -
+	    radio_dev->air_max_packet_len -
 	    (radio_dev->ppm_only_mode ? 0 : RS_ECC_NPARITY);
 
 	// Don't send if it's not our turn, or if we're receiving a packet.
@@ -1887,11 +1934,24 @@ static enum pios_radio_event radio_txStart(struct pios_rfm22b_dev
 		}
 	}
 
-	// Append data from the com interface if applicable.
-	if (!radio_dev->ppm_only_mode && radio_dev->tx_out_cb) {
-		// Try to get some data to send
-		bool need_yield = false;
-		len += (radio_dev->tx_out_cb) (radio_dev->tx_out_context, p + len, max_data_len - len, NULL, &need_yield);
+	// Append the datarate control byte and data from the com interface
+	// if applicable.  Whatever UAVTalk frames are queued get packed in
+	// back to back, as far as they fit.
+	if (!radio_dev->ppm_only_mode) {
+		uint8_t data_len = 0;
+
+		if (radio_dev->tx_out_cb && (max_data_len > len + 1)) {
+			// Try to get some data to send
+			bool need_yield = false;
+			data_len = (radio_dev->tx_out_cb) (radio_dev->tx_out_context, p + len + 1, max_data_len - len - 1, NULL, &need_yield);
+		}
+
+		// The sync channel always carries the control byte, so rate
+		// changes get through even when there's nothing else to say.
+		if ((data_len > 0) || (len > 0) || (radio_dev->channel_index == 0)) {
+			p[len] = rfm22_rateControl(radio_dev);
+			len += 1 + data_len;
+		}
 	}
 
 	// Always send a packet on the sync channel. So if length is zero (no data)
@@ -2023,6 +2083,7 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev
 		// Ensure the packet it long enough
 		if (data_len < ppm_len) {
 			good_packet = false;
+			corrected_packet = false;
 		}
 
 		// Verify the CRC if this is a PPM only packet.
@@ -2037,7 +2098,7 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev
 			}
 		}
 
-		if (good_packet) {
+		if (good_packet || corrected_packet) {
 			for (uint8_t i = 0; i < RFM22B_PPM_NUM_CHANNELS; ++i) {
 				// Is this a valid channel?
 				if (p[0] & (1 << i)) {
@@ -2071,6 +2132,22 @@ static enum pios_radio_event radio_receivePacket(struct pios_rfm22b_dev
 		rfm22b_add_rx_status(radio_dev, RADIO_ERROR_RX_PACKET);
 	}
 
+	// Follow the datarate changes our coordinator announces.
+	if ((good_packet || corrected_packet) && !radio_dev->ppm_only_mode &&
+			(data_len > 0)) {
+		uint8_t rate = p[0] >> 4;
+
+		if (!rfm22_isCoordinator(radio_dev) &&
+				radio_dev->rx_destination_id == rfm22_destinationID(radio_dev) &&
+				rate >= radio_dev->min_air_datarate && rate <= radio_dev->datarate) {
+			radio_dev->pending_datarate = rate;
+			radio_dev->pending_cycle = p[0] & 0x0F;
+		}
+
+		p++;
+		data_len--;
+	}
+
 	if (good_packet || corrected_packet) {
 		// Send the data to the com port
 		bool rx_need_yield;
@@ -2206,6 +2283,25 @@ static void rfm22_calculateLinkQuality(struct pios_rfm22b_dev *rfm22b_dev)
 static void rfm22b_add_rx_status(struct pios_rfm22b_dev *rfm22b_dev,
 				 enum pios_rfm22b_rx_packet_status status)
 {
+	// Count what we hear for the datarate adaptation.
+	switch (status) {
+	case RADIO_GOOD_RX_PACKET:
+		if (rfm22b_dev->adapt_good < UINT8_MAX)
+			rfm22b_dev->adapt_good++;
+		break;
+	case RADIO_CORRECTED_RX_PACKET:
+		if (rfm22b_dev->adapt_corrected < UINT8_MAX)
+			rfm22b_dev->adapt_corrected++;
+		break;
+	case RADIO_ERROR_RX_PACKET:
+	case RADIO_ERROR_RX_SYNC_MISSED:
+		if (rfm22b_dev->adapt_bad < UINT8_MAX)
+			rfm22b_dev->adapt_bad++;
+		break;
+	default:
+		break;
+	}
+
 	// track a local ring pointer where to store status values to. initial
 	// value doesn't matter
 	static uint32_t rx_status_count;
@@ -2277,7 +2373,7 @@ static void rfm22_synchronizeClock(struct pios_rfm22b_dev *rfm22b_dev)
 	uint16_t time_delta = start_time % frequency_hop_cycle_time;
 
 	// Calculate the adjustment for the preamble
-	uint8_t offset = (uint8_t) ceilf(35000.0F / data_rate[rfm22b_dev->datarate]);
+	uint8_t offset = (uint8_t) ceilf(35000.0F / data_rate[rfm22b_dev->air_datarate]);
 
 	rfm22b_dev->time_delta = frequency_hop_cycle_time - time_delta + offset;
 }
@@ -2394,6 +2490,124 @@ static bool rfm22_changeChannel(struct pios_rfm22b_dev *rfm22b_dev)
 	return rfm22_setFreqHopChannel(rfm22b_dev, channel_idx);
 }
 
+/*****************************************************************************
+* Adaptive Datarate Functions
+*****************************************************************************/
+
+/**
+ * Reprogram the radio for another datarate, keeping the slot timing.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @param[in] datarate  The datarate lookup index
+ */
+static void rfm22_setAirDatarate(struct pios_rfm22b_dev *rfm22b_dev, uint8_t datarate)
+{
+	rfm22b_dev->air_datarate = datarate;
+	rfm22b_dev->air_max_packet_len = rfm22_maxPacketLen(rfm22b_dev, datarate);
+	pios_rfm22_setDatarate(rfm22b_dev);
+}
+
+/**
+ * The control byte leading the data of each packet: the datarate the sender
+ * uses, or is about to use, and the hop cycle that one starts with.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ */
+static uint8_t rfm22_rateControl(struct pios_rfm22b_dev *rfm22b_dev)
+{
+	return (rfm22b_dev->pending_datarate << 4) | (rfm22b_dev->pending_cycle & 0x0F);
+}
+
+/**
+ * Step the datarate with the link quality.
+ *
+ * Once per frequency hop cycle, the coordinator judges the link by the
+ * packets it heard from the remote modem.  It steps down when packets go
+ * missing or most need correcting, and back up after a clean stretch.
+ * A change is announced in every packet, with the hop cycle both modems
+ * switch at, a couple of cycles out.  Whenever the link drops, both modems
+ * fall back to the configured datarate, so they always meet again there.
+ *
+ * @param[in] rfm22b_dev  The device structure
+ * @return true if the datarate changed and the receiver needs restarting
+ */
+static bool rfm22_adaptDatarate(struct pios_rfm22b_dev *rfm22b_dev)
+{
+	if (!rfm22_isConnected(rfm22b_dev)) {
+		rfm22b_dev->pending_datarate = rfm22b_dev->datarate;
+		rfm22b_dev->adapt_cycles = 0;
+		rfm22b_dev->adapt_good = rfm22b_dev->adapt_corrected = rfm22b_dev->adapt_bad = 0;
+
+		if (rfm22b_dev->air_datarate != rfm22b_dev->datarate) {
+			rfm22_setAirDatarate(rfm22b_dev, rfm22b_dev->datarate);
+			return true;
+		}
+
+		return false;
+	}
+
+	// Only look at it as a new hop cycle starts.
+	if (rfm22b_dev->channel_index != 0) {
+		return false;
+	}
+
+	uint32_t time = rfm22_coordinatorTime(rfm22b_dev, PIOS_Thread_Systime());
+	uint16_t cycle_time = rfm22b_dev->packet_time * num_channels[rfm22b_dev->datarate];
+	uint8_t cycle = (time / cycle_time) & 0x0F;
+
+	if (cycle == rfm22b_dev->adapt_last_cycle) {
+		return false;
+	}
+	rfm22b_dev->adapt_last_cycle = cycle;
+
+	bool changed = false;
+	if ((rfm22b_dev->pending_datarate != rfm22b_dev->air_datarate) &&
+			(cycle == rfm22b_dev->pending_cycle)) {
+		rfm22_setAirDatarate(rfm22b_dev, rfm22b_dev->pending_datarate);
+		changed = true;
+	}
+
+	// Leave the judging to the coordinator, and wait for changes to land.
+	if (!rfm22_isCoordinator(rfm22b_dev) ||
+			(rfm22b_dev->pending_datarate != rfm22b_dev->air_datarate)) {
+		return changed;
+	}
+
+	if (changed || (++rfm22b_dev->adapt_cycles < RFM22B_ADAPT_CYCLES)) {
+		if (changed) {
+			rfm22b_dev->adapt_cycles = 0;
+			rfm22b_dev->adapt_good = rfm22b_dev->adapt_corrected = rfm22b_dev->adapt_bad = 0;
+		}
+		return changed;
+	}
+
+	uint16_t received = rfm22b_dev->adapt_good + rfm22b_dev->adapt_corrected;
+	uint8_t datarate = rfm22b_dev->air_datarate;
+
+	if (rfm22b_dev->adapt_holdoff) {
+		rfm22b_dev->adapt_holdoff--;
+	}
+
+	if ((rfm22b_dev->adapt_bad > 1 || rfm22b_dev->adapt_corrected * 2 > received) &&
+			(datarate > rfm22b_dev->min_air_datarate)) {
+		datarate--;
+		rfm22b_dev->adapt_holdoff = RFM22B_ADAPT_HOLDOFF;
+	} else if ((rfm22b_dev->adapt_bad == 0) && (rfm22b_dev->adapt_corrected * 8 <= received) &&
+			!rfm22b_dev->adapt_holdoff && (datarate < rfm22b_dev->datarate)) {
+		datarate++;
+	}
+
+	if (datarate != rfm22b_dev->air_datarate) {
+		rfm22b_dev->pending_datarate = datarate;
+		rfm22b_dev->pending_cycle = (cycle + RFM22B_ADAPT_SWITCH_CYCLES) & 0x0F;
+	}
+
+	rfm22b_dev->adapt_cycles = 0;
+	rfm22b_dev->adapt_good = rfm22b_dev->adapt_corrected = rfm22b_dev->adapt_bad = 0;
+
+	return false;
+}
+
 /*****************************************************************************
 * Error Handling Functions
 *****************************************************************************/
@@ -0,0 +1,157 @@
+/**
+ ******************************************************************************
+ * @file       pios_rxframe.c
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_RxFrame Serial receiver frame assembly
+ * @{
+ * @brief Assembles serial receiver protocol frames from received spans
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include <pios_rxframe.h>
+
+#include <string.h>
+
+/**
+ * Set up frame assembly for a protocol.
+ * @param[in] frame the assembly state
+ * @param[in] proto the protocol framing
+ * @param[in] buf frame buffer, large enough for the longest frame
+ * @param[in] buf_len size of buf
+ * @param[in] context passed to the protocol decode function
+ */
+void PIOS_RxFrame_Init(struct pios_rxframe *frame,
+		const struct pios_rxframe_proto *proto,
+		uint8_t *buf, uint16_t buf_len, uintptr_t context)
+{
+	frame->proto = proto;
+	frame->context = context;
+	frame->buf = buf;
+	frame->buf_len = buf_len;
+	frame->pos = 0;
+	frame->expected = 0;
+	frame->armed = !proto->gap_sync;
+}
+
+/**
+ * Feed received bytes.  Whole spans are copied into the frame buffer at a
+ * time and every frame completed is handed to the protocol decoder.
+ * @param[in] frame the assembly state
+ * @param[in] data received bytes
+ * @param[in] len number of bytes in data
+ * @returns the number of good frames decoded
+ */
+int PIOS_RxFrame_Push(struct pios_rxframe *frame, const uint8_t *data,
+		uint16_t len)
+{
+	const struct pios_rxframe_proto *proto = frame->proto;
+	int good = 0;
+
+	while (len && frame->armed) {
+		uint16_t n;
+
+		if (!frame->expected) {
+			n = proto->header_len - frame->pos;
+			if (n > len)
+				n = len;
+
+			memcpy(frame->buf + frame->pos, data, n);
+			frame->pos += n;
+			data += n;
+			len -= n;
+
+			if (frame->pos < proto->header_len)
+				break;
+
+			uint16_t frame_len = proto->frame_len(frame->buf);
+
+			if (frame_len < proto->header_len ||
+					frame_len > frame->buf_len)
+				frame_len = 0;
+
+			if (!frame_len) {
+				frame->pos--;
+
+				if (proto->gap_sync) {
+					/* Wait for the line to go quiet */
+					frame->pos = 0;
+					frame->armed = false;
+				} else if (frame->pos) {
+					/* Slide along to look for a header */
+					memmove(frame->buf, frame->buf + 1,
+							frame->pos);
+				}
+
+				continue;
+			}
+
+			frame->expected = frame_len;
+		}
+
+		n = frame->expected - frame->pos;
+		if (n > len)
+			n = len;
+
+		memcpy(frame->buf + frame->pos, data, n);
+		frame->pos += n;
+		data += n;
+		len -= n;
+
+		if (frame->pos < frame->expected)
+			break;
+
+		if (proto->decode(frame->context, frame->buf, frame->pos))
+			good++;
+
+		frame->pos = 0;
+		frame->expected = 0;
+		frame->armed = !proto->gap_sync;
+	}
+
+	return good;
+}
+
+/**
+ * Called when the line has been idle for longer than the gap between
+ * frames of the protocol.  Drops any partial frame and lets a new frame
+ * start with the next byte.
+ * @param[in] frame the assembly state
+ */
+void PIOS_RxFrame_Gap(struct pios_rxframe *frame)
+{
+	frame->pos = 0;
+	frame->expected = 0;
+	frame->armed = true;
+}
+
+/**
+ * @returns true if no frame is in progress
+ */
+bool PIOS_RxFrame_Idle(const struct pios_rxframe *frame)
+{
+	return frame->pos == 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -42,6 +42,9 @@ static uint16_t PIOS_SBus_RxInCallback(uintptr_t context,
 				       uint16_t *headroom,
 				       bool *need_yield);
 static void PIOS_SBus_Supervisor(uintptr_t sbus_id);
+static uint16_t PIOS_SBus_FrameLen(const uint8_t *header);
+static bool PIOS_SBus_DecodeFrame(uintptr_t context, const uint8_t *frame,
+				  uint16_t len);
 
 
 /* Local Variables */
@@ -49,16 +52,22 @@ const struct pios_rcvr_driver pios_sbus_rcvr_driver = {
 	.read = PIOS_SBus_Get,
 };
 
+static const struct pios_rxframe_proto pios_sbus_frame_proto = {
+	.header_len = 1,
+	.frame_len = PIOS_SBus_FrameLen,
+	.decode = PIOS_SBus_DecodeFrame,
+};
+
 enum pios_sbus_dev_magic {
 	PIOS_SBUS_DEV_MAGIC = 0x53427573,
 };
 
 struct pios_sbus_state {
 	uint16_t channel_data[PIOS_SBUS_NUM_INPUTS];
-	uint8_t received_data[SBUS_FRAME_LENGTH - 2];
+	uint8_t received_data[SBUS_FRAME_LENGTH];
+	struct pios_rxframe rxframe;
 	uint8_t receive_timer;
 	uint8_t failsafe_timer;
-	uint8_t byte_count;
 };
 
 struct pios_sbus_dev {
@@ -97,7 +106,6 @@ static void PIOS_SBus_ResetState(struct pios_sbus_state *state)
 {
 	state->failsafe_timer = 0;
 	state->receive_timer = 0;
-	state->byte_count = 0;
 	PIOS_SBus_ResetChannels(state);
 }
 
@@ -116,6 +124,10 @@ int32_t PIOS_SBus_Init(uintptr_t *sbus_id,
 	if (!sbus_dev) return -1;
 
 	PIOS_SBus_ResetState(&(sbus_dev->state));
+	PIOS_RxFrame_Init(&sbus_dev->state.rxframe, &pios_sbus_frame_proto,
+			  sbus_dev->state.received_data,
+			  sizeof(sbus_dev->state.received_data),
+			  (uintptr_t)sbus_dev);
 
 	*sbus_id = (uintptr_t)sbus_dev;
 
@@ -151,13 +163,13 @@ static int32_t PIOS_SBus_Get(uintptr_t rcvr_id, uint8_t channel)
 }
 
 /**
- * Compute channel_data[] from received_data[].
+ * Compute channel_data[] from the frame data following the SOF byte.
  * For efficiency it unrolls first 8 channels without loops and does the
  * same for other 8 channels. Also 2 discrete channels will be set.
  */
-static void PIOS_SBus_UnrollChannels(struct pios_sbus_state *state)
+static void PIOS_SBus_UnrollChannels(struct pios_sbus_state *state,
+				     const uint8_t *s)
 {
-	uint8_t *s = state->received_data;
 	uint16_t *d = state->channel_data;
 
 #define F(v,s) (((v) >> (s)) & 0x7ff)
@@ -187,45 +199,44 @@ static void PIOS_SBus_UnrollChannels(struct pios_sbus_state *state)
 	d[17] = (s[22] & SBUS_FLAG_DC2) ? SBUS_VALUE_MAX : SBUS_VALUE_MIN;
 }
 
-/* Update decoder state processing input byte from the S.Bus stream */
-static void PIOS_SBus_UpdateState(struct pios_sbus_state *state, uint8_t b)
+/* Every frame starts with the SOF byte and has a fixed length */
+static uint16_t PIOS_SBus_FrameLen(const uint8_t *header)
+{
+	return (header[0] == SBUS_SOF_BYTE) ? SBUS_FRAME_LENGTH : 0;
+}
+
+/* Decode a complete frame, SOF byte included */
+static bool PIOS_SBus_DecodeFrame(uintptr_t context, const uint8_t *frame,
+				  uint16_t len)
 {
-	if (state->byte_count == 0) {
-		if (b == SBUS_SOF_BYTE) {
-			/* do not store the SOF byte */
-			state->byte_count++;
-		}
-		/* Otherwise discard this byte. */
-		return;
+	struct pios_sbus_dev *sbus_dev = (struct pios_sbus_dev *)context;
+	struct pios_sbus_state *state = &(sbus_dev->state);
+
+	uint8_t eof = frame[SBUS_FRAME_LENGTH - 1];
+	if (eof != SBUS_EOF_BYTE &&
+			(eof & SBUS_R7008SB_EOF_COUNTER_MASK) != SBUS_R7008SB_EOF_BYTE) {
+		/* discard whole frame */
+		return false;
 	}
 
-	/* do not store last frame byte as well */
-	if (state->byte_count < SBUS_FRAME_LENGTH - 1) {
-		/* store next byte */
-		state->received_data[state->byte_count - 1] = b;
-		state->byte_count++;
-	} else {
-		if (b == SBUS_EOF_BYTE || (b & SBUS_R7008SB_EOF_COUNTER_MASK) == SBUS_R7008SB_EOF_BYTE) {
-			/* full frame received */
-			uint8_t flags = state->received_data[SBUS_FRAME_LENGTH - 3];
-			if (flags & SBUS_FLAG_FL) {
-				/* frame lost, do not update */
-			} else if (flags & SBUS_FLAG_FS) {
-				/* failsafe flag active */
-				PIOS_SBus_ResetChannels(state);
-			} else {
-				/* data looking good */
-				PIOS_SBus_UnrollChannels(state);
-				state->failsafe_timer = 0;
-				PIOS_RCVR_ActiveFromISR();
-			}
-		} else {
-			/* discard whole frame */
-		}
-
-		/* prepare for the next frame */
-		state->byte_count = 0;
+	uint8_t flags = frame[SBUS_FRAME_LENGTH - 2];
+	if (flags & SBUS_FLAG_FL) {
+		/* frame lost, do not update */
+		return false;
 	}
+
+	if (flags & SBUS_FLAG_FS) {
+		/* failsafe flag active */
+		PIOS_SBus_ResetChannels(state);
+		return false;
+	}
+
+	/* data looking good */
+	PIOS_SBus_UnrollChannels(state, frame + 1);
+	state->failsafe_timer = 0;
+	PIOS_RCVR_ActiveFromISR();
+
+	return true;
 }
 
 /* Comm byte received callback */
@@ -243,9 +254,7 @@ static uint16_t PIOS_SBus_RxInCallback(uintptr_t context,
 	struct pios_sbus_state *state = &(sbus_dev->state);
 
 	/* process byte(s) and clear receive timer */
-	for (uint8_t i = 0; i < buf_len; i++) {
-		PIOS_SBus_UpdateState(state, buf[i]);
-	}
+	PIOS_RxFrame_Push(&state->rxframe, buf, buf_len);
 
 	state->receive_timer = 0;
 
@@ -283,7 +292,7 @@ static void PIOS_SBus_Supervisor(uintptr_t sbus_id)
 	/* An appropriate gap of at least 3.2ms causes us to go back to
 	 * expecting start of frame. */
 	if (++state->receive_timer > 2) {
-		state->byte_count = 0;
+		PIOS_RxFrame_Gap(&state->rxframe);
 		state->receive_timer = 0;
 	}
 
@@ -74,11 +74,9 @@ struct pios_srxl_dev {
 	enum pios_srxl_magic magic;
 	uint16_t channels[PIOS_SRXL_MAX_CHANNELS];
 	uint8_t rx_buffer[PIOS_SRXL_RXBUF_LEN];
-	uint8_t rx_buffer_pos;
+	struct pios_rxframe rxframe;
 	uint32_t rx_timer;
 	uint32_t failsafe_timer;
-	uint8_t frame_length;
-	uint16_t crc;
 };
 
 /* Private Functions */
@@ -94,11 +92,11 @@ static struct pios_srxl_dev *PIOS_SRXL_AllocDev(void);
  */
 static bool PIOS_SRXL_ValidateDev(struct pios_srxl_dev *dev);
 /**
- * @brief Update the CRC of the current frame with a new byte
- * @param[in] dev Pointer to device structure
- * @param[in] value New byte to be added to CRC
+ * @brief Get the frame length for a sync byte
+ * @param[in] header Pointer to the sync byte
+ * @return Frame length, or 0 if this is not a known sync byte
  */
-static void PIOS_SRXL_UpdateCRC(struct pios_srxl_dev *dev, uint8_t value);
+static uint16_t PIOS_SRXL_FrameLen(const uint8_t *header);
 /**
  * @brief Serial receive callback
  * @param[in] context Pointer to device structure
@@ -112,9 +110,13 @@ static uint16_t PIOS_SRXL_RxCallback(uintptr_t context, uint8_t *buf,
 	uint16_t buf_len, uint16_t *headroom, bool *task_woken);
 /**
  * @brief Parse the current frame (checking CRC) and unpack channel contents
- * @param[in] dev Pointer to device structure
+ * @param[in] context Pointer to device structure
+ * @param[in] buf Pointer to frame data
+ * @param[in] len Frame length
+ * @return true if the frame CRC was good
  */
-static void PIOS_SRXL_ParseFrame(struct pios_srxl_dev *dev);
+static bool PIOS_SRXL_ParseFrame(uintptr_t context, const uint8_t *buf,
+	uint16_t len);
 /**
  * @brief Reset all channels
  * @param[in] dev Pointer to device structure
@@ -134,6 +136,11 @@ static int32_t PIOS_SRXL_Read(uintptr_t id, uint8_t channel);
 void PIOS_SRXL_Supervisor(uintptr_t id);
 
 /* Private Variables */
+static const struct pios_rxframe_proto pios_srxl_frame_proto = {
+	.header_len = 1,
+	.frame_len = PIOS_SRXL_FrameLen,
+	.decode = PIOS_SRXL_ParseFrame,
+};
 
 /* Public Variables */
 const struct pios_rcvr_driver pios_srxl_rcvr_driver = {
@@ -169,6 +176,8 @@ static struct pios_srxl_dev *PIOS_SRXL_AllocDev(void)
 		return NULL;
 
 	dev->magic = PIOS_SRXL_MAGIC;
+	PIOS_RxFrame_Init(&dev->rxframe, &pios_srxl_frame_proto, dev->rx_buffer,
+		sizeof(dev->rx_buffer), (uintptr_t)dev);
 
 	return dev;
 }
@@ -180,20 +189,18 @@ static bool PIOS_SRXL_ValidateDev(struct pios_srxl_dev *dev)
 	return false;
 }
 
-static void PIOS_SRXL_UpdateCRC(struct pios_srxl_dev *dev, uint8_t value)
+static uint16_t PIOS_SRXL_FrameLen(const uint8_t *header)
 {
-	if (!PIOS_SRXL_ValidateDev(dev))
-		return;
+	switch (header[0]) {
+	case PIOS_SRXL_SYNC_MULTIPLEX12:
+		return sizeof(struct pios_srxl_frame_multiplex12);
+	case PIOS_SRXL_SYNC_MULTIPLEX16:
+		return sizeof(struct pios_srxl_frame_multiplex16);
+	case PIOS_SRXL_SYNC_WEATRONIC16:
+		return sizeof(struct pios_srxl_frame_weatronic16);
+	}
 
-	uint8_t i;
-	dev->crc = dev->crc ^ (int16_t)value << 8;
-	for(i = 0; i < 8; i++)
-	{
-		if(dev->crc & 0x8000)
-			dev->crc = dev->crc << 1^0x1021;
-		else
-			dev->crc = dev->crc << 1;
-		}
+	return 0;
 }
 
 static uint16_t PIOS_SRXL_RxCallback(uintptr_t context, uint8_t *buf,
@@ -204,64 +211,46 @@ static uint16_t PIOS_SRXL_RxCallback(uintptr_t context, uint8_t *buf,
 		return PIOS_RCVR_INVALID;
 
 	dev->rx_timer = 0;
-	uint16_t consumed = 0;
-
-	for (int i = 0; i < buf_len; i++) {
-		if (dev->rx_buffer_pos == 0) {
-			dev->crc = 0;
-			if (buf[i] == PIOS_SRXL_SYNC_MULTIPLEX12) {
-				dev->frame_length = sizeof(struct pios_srxl_frame_multiplex12);
-			} else if (buf[i] == PIOS_SRXL_SYNC_MULTIPLEX16) {
-				dev->frame_length = sizeof(struct pios_srxl_frame_multiplex16);
-			} else if (buf[i] == PIOS_SRXL_SYNC_WEATRONIC16) {
-				dev->frame_length = sizeof(struct pios_srxl_frame_weatronic16);
-			} else {
-				continue;
-			}
-		}
-		dev->rx_buffer[dev->rx_buffer_pos++] = buf[i];
-		PIOS_SRXL_UpdateCRC(dev, buf[i]);
-		if (dev->rx_buffer_pos == dev->frame_length)
-				PIOS_SRXL_ParseFrame(dev);
-		consumed++;
-	}
+
+	PIOS_RxFrame_Push(&dev->rxframe, buf, buf_len);
 
 	if (headroom)
-		*headroom = PIOS_SRXL_RXBUF_LEN - dev->rx_buffer_pos;
+		*headroom = PIOS_SRXL_RXBUF_LEN;
 	*task_woken = false;
 
-	return consumed;
+	return buf_len;
 }
 
-static void PIOS_SRXL_ParseFrame(struct pios_srxl_dev *dev)
+static bool PIOS_SRXL_ParseFrame(uintptr_t context, const uint8_t *buf,
+	uint16_t len)
 {
-	if (!PIOS_SRXL_ValidateDev(dev))
-		return;
+	struct pios_srxl_dev *dev = (struct pios_srxl_dev *)context;
 
-	if (dev->crc == 0) {
+	/* CRC over the whole frame, CRC field included, comes out as zero */
+	if (PIOS_CRC16_CCITT_updateCRC(0, buf, len) == 0) {
 		bool failsafe = false; // only used by variants with failsafe flag
 
-		switch (dev->rx_buffer[0]) {
+		switch (buf[0]) {
 		case PIOS_SRXL_SYNC_MULTIPLEX16:
 		{
-			struct pios_srxl_frame_multiplex16 *frame =
-					(struct pios_srxl_frame_multiplex16 *)dev->rx_buffer;
+			const struct pios_srxl_frame_multiplex16 *frame =
+					(const struct pios_srxl_frame_multiplex16 *)buf;
 			for (int i = 0; i < 16; i++)
 				dev->channels[i] = BE16_TO_CPU(frame->chan[i]);
 		}
 			break;
 		case PIOS_SRXL_SYNC_MULTIPLEX12:
 		{
-			struct pios_srxl_frame_multiplex12 *frame =
-					(struct pios_srxl_frame_multiplex12 *)dev->rx_buffer;
+			const struct pios_srxl_frame_multiplex12 *frame =
+					(const struct pios_srxl_frame_multiplex12 *)buf;
 			for (int i = 0; i < 12; i++)
 				dev->channels[i] = BE16_TO_CPU(frame->chan[i]);
 		}
 			break;
 		case PIOS_SRXL_SYNC_WEATRONIC16:
 		{
-			struct pios_srxl_frame_weatronic16 *frame =
-					(struct pios_srxl_frame_weatronic16 *)dev->rx_buffer;
+			const struct pios_srxl_frame_weatronic16 *frame =
+					(const struct pios_srxl_frame_weatronic16 *)buf;
 			for (int i = 0; i < 16; i++) {
 				int16_t value = 2000 + BE16_TO_CPU(frame->chan[i]); // centre values around 2000
 				if (value < 0 || value > 4000)
@@ -280,9 +269,11 @@ static void PIOS_SRXL_ParseFrame(struct pios_srxl_dev *dev)
 			dev->failsafe_timer = 0;
 
 		PIOS_RCVR_ActiveFromISR();
+
+		return true;
 	}
 
-	dev->rx_buffer_pos = 0;
+	return false;
 }
 
 static int32_t PIOS_SRXL_Read(uintptr_t id, uint8_t channel)
@@ -315,7 +306,7 @@ void PIOS_SRXL_Supervisor(uintptr_t id)
 	 * (4 * 21) / 1.6 ~ 53 ticks
 	 */
 	if (++dev->rx_timer >= 5)
-		dev->rx_buffer_pos = 0;
+		PIOS_RxFrame_Gap(&dev->rxframe);
 	if (++dev->failsafe_timer >= 53)
 		PIOS_SRXL_ResetChannels(dev, PIOS_RCVR_TIMEOUT);
 }
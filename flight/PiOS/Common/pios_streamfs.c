@@ -47,7 +47,9 @@
  * large files or logging information
  *
  * Files are written into continuous sectors of the flash chip. Each
- * sector has a footer to indicate the file id and the sector id.
+ * sector has a footer to indicate the file id and the sector id, and
+ * optionally an index area before it for small records describing the
+ * data, so a reader can seek in a file without reading all of it.
  *
  * Arenas map onto sectors. 
  */
@@ -87,7 +89,10 @@ struct streamfs_state {
 	uintptr_t rx_in_context;
 	pios_com_callback tx_out_cb;
 	uintptr_t tx_out_context;
-	uint8_t *com_buffer;
+	/* Data for the page being filled; the previous page is being
+	 * programmed by the flash chip meanwhile */
+	uint8_t *write_buf;
+	uint32_t write_buf_len;
 
 	/* Information for current file handle */
 	bool file_open_writing;
@@ -96,15 +101,27 @@ struct streamfs_state {
 	int32_t active_file_segment;
 	int32_t active_file_arena;
 	int32_t active_file_arena_offset;
+	int32_t active_file_first_arena;
+	uint32_t active_index_len;
 
 	/* Information about file system contents */
 	int32_t min_file_id;
 	int32_t max_file_id;
+	int32_t min_file_arena;	/* an arena of min_file_id */
+	int32_t last_arena;	/* last arena of max_file_id */
+
+	/* Next free record of the superblock arena */
+	uint32_t sb_next;
+
+	/* Start of the file last read with PIOS_STREAMFS_ReadAt */
+	int32_t read_at_file_id;
+	int32_t read_at_first_arena;
+	uint32_t read_at_first_segment;
 
 	/* Underlying flash partition handle */
 	uintptr_t partition_id;
 	uint32_t partition_size;
-	uint32_t partition_arenas;
+	uint32_t partition_arenas;	/* for files, the superblock uses the last one */
 };
 
 /*
@@ -130,6 +147,31 @@ struct streamfs_footer {
 	uint16_t file_segment;
 } __attribute__((packed));
 
+/*
+ * Summary of the filesystem contents, so that mounting doesn't need to
+ * read the footer of every arena.  Appended to the last arena of the
+ * partition on every change; the last valid record is the current one.
+ */
+struct streamfs_superblock {
+	uint32_t magic;
+	int32_t min_file_id;
+	int32_t max_file_id;
+	int32_t min_file_arena;
+	int32_t last_arena;
+	uint32_t check;
+} __attribute__((packed));
+
+#define STREAMFS_SUPERBLOCK_MAGIC 0x5B10C4E1
+
+/**
+ * @brief Bytes of file data in an arena, before the index area and footer
+ */
+static uint32_t streamfs_data_size(const struct streamfs_state *streamfs)
+{
+	return streamfs->cfg->arena_size - streamfs->cfg->index_size -
+		sizeof(struct streamfs_footer);
+}
+
 
 /****************************************
  * Arena life-cycle transition functions
@@ -170,6 +212,10 @@ static int32_t streamfs_erase_all_arenas(const struct streamfs_state *streamfs)
 	return 0;
 }
 
+/* Instances by partition, so other modules can read files with
+ * PIOS_STREAMFS_ReadAt without access to the com handle */
+static struct streamfs_state *streamfs_instances[FLASH_PARTITION_NUM_LABELS];
+
 static bool streamfs_validate(const struct streamfs_state *streamfs)
 {
 	return (streamfs && (streamfs->magic == PIOS_FLASHFS_STREAMFS_DEV_MAGIC));
@@ -210,6 +256,7 @@ static int32_t streamfs_new_sector(struct streamfs_state *streamfs)
 	streamfs->active_file_arena = (streamfs->active_file_arena + 1) % streamfs->partition_arenas;
 	streamfs->active_file_arena_offset = 0;
 	streamfs->active_file_segment++;
+	streamfs->active_index_len = 0;
 
 	// Test whether the sector has already been erased by checking the footer
 	start_address = streamfs_get_addr(streamfs, streamfs->active_file_arena,
@@ -263,7 +310,7 @@ static int32_t streamfs_close_sector(struct streamfs_state *streamfs)
  */
 static int32_t streamfs_find_first_arena(struct streamfs_state *streamfs, int32_t file_id)
 {
-	uint16_t num_arenas = streamfs->partition_size / streamfs->cfg->arena_size;
+	uint16_t num_arenas = streamfs->partition_arenas;
 
 	bool found_file = false;
 	uint32_t min_segment = 0xFFFFFFFF;
@@ -294,47 +341,6 @@ static int32_t streamfs_find_first_arena(struct streamfs_state *streamfs, int32_
 	return -2;
 }
 
-/**
- * Find the last arena for a file
- * @param[in] streamfs the file system handle
- * @param[in] file_id the file to find
- * @return the sector number if found, or negative if there was an error
- *
- * @NOTE: Must be called while holding the flash transaction lock
- */
-static int32_t streamfs_find_last_arena(struct streamfs_state *streamfs, int32_t file_id)
-{
-	uint16_t num_arenas = streamfs->partition_size / streamfs->cfg->arena_size;
-
-	bool found_file = false;
-	int32_t max_segment = -1;
-	uint32_t sector = 0;
-
-	for (uint16_t arena = 0; arena < num_arenas; arena++) {
-		// Read footer for each arena
-		struct streamfs_footer footer;
-		uint32_t start_address = streamfs_get_addr(streamfs, arena,
-				                                   streamfs->cfg->arena_size - sizeof(footer));
-		if (PIOS_FLASH_read_data(streamfs->partition_id, start_address, (uint8_t *) &footer, sizeof(footer)) != 0) {
-			return -3;
-		}
-
-		if (footer.magic == streamfs->cfg->fs_magic && footer.file_id == file_id) {
-			found_file = true;
-			if (footer.file_segment > max_segment) {
-				max_segment = footer.file_segment;
-				sector = arena;
-			}
-		}
-	}
-
-	if (found_file) {
-		return sector;
-	}
-
-	return -4;
-}
-
 /**
  * Find the first sector for a file
  * @param[in] streamfs the file system handle
@@ -344,16 +350,8 @@ static int32_t streamfs_find_last_arena(struct streamfs_state *streamfs, int32_t
  */
 static int32_t streamfs_find_new_sector(struct streamfs_state *streamfs)
 {
-	// No files on file system
-	if (streamfs->max_file_id < 0) {
-		return 0;
-	}
-
-	int32_t last_sector = streamfs_find_last_arena(streamfs, streamfs->max_file_id);
-	PIOS_Assert(last_sector >= 0);
-
-	uint16_t num_arenas = streamfs->partition_size / streamfs->cfg->arena_size;
-	return (last_sector + 1) % num_arenas;
+	// With no files on the file system, last_arena is the last one
+	return (streamfs->last_arena + 1) % streamfs->partition_arenas;
 }
 
 /* NOTE: Must be called while holding the flash transaction lock */
@@ -371,10 +369,10 @@ static int32_t streamfs_append_to_file(struct streamfs_state *streamfs, uint8_t
 		uint32_t start_address = streamfs_get_addr(streamfs, streamfs->active_file_arena,
 			                                                 streamfs->active_file_arena_offset);
 
-		// Make sure not to write into the space for the footer
+		// Make sure not to write into the space for the index and footer
 		uint32_t bytes_to_write = len;
-		if ((streamfs->active_file_arena_offset + bytes_to_write) > (streamfs->cfg->arena_size - sizeof(struct streamfs_footer))) {
-			bytes_to_write = streamfs->cfg->arena_size - sizeof(struct streamfs_footer) - streamfs->active_file_arena_offset;
+		if ((streamfs->active_file_arena_offset + bytes_to_write) > streamfs_data_size(streamfs)) {
+			bytes_to_write = streamfs_data_size(streamfs) - streamfs->active_file_arena_offset;
 		}
 
 		if (PIOS_FLASH_write_data(streamfs->partition_id, start_address, data, bytes_to_write) != 0) {
@@ -388,7 +386,7 @@ static int32_t streamfs_append_to_file(struct streamfs_state *streamfs, uint8_t
 		data = &data[bytes_to_write];
 
 
-		if (streamfs->active_file_arena_offset >= (streamfs->cfg->arena_size - sizeof(struct streamfs_footer))) {
+		if (streamfs->active_file_arena_offset >= streamfs_data_size(streamfs)) {
 			if (streamfs_new_sector(streamfs) != 0) {
 				return -4;
 			}
@@ -398,6 +396,41 @@ static int32_t streamfs_append_to_file(struct streamfs_state *streamfs, uint8_t
 	return total_written;
 }
 
+/**
+ * @brief Room left in the page of the file being written, so every program
+ * operation covers exactly one aligned page
+ * @return number of bytes up to the next write_size boundary or the index
+ */
+static uint32_t streamfs_page_space(const struct streamfs_state *streamfs)
+{
+	uint32_t offset = streamfs->active_file_arena_offset;
+	uint32_t space = streamfs->cfg->write_size - (offset % streamfs->cfg->write_size);
+	uint32_t data_end = streamfs_data_size(streamfs);
+
+	return MIN(space, data_end - offset);
+}
+
+/**
+ * @brief Program the buffered page into the file
+ * @return 0 if success, or the streamfs_append_to_file error
+ *
+ * @NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_flush_page(struct streamfs_state *streamfs)
+{
+	if (streamfs->write_buf_len == 0) {
+		return 0;
+	}
+
+	int32_t rc = streamfs_append_to_file(streamfs, streamfs->write_buf,
+			streamfs->write_buf_len);
+
+	// Data that failed to program is dropped rather than retried forever
+	streamfs->write_buf_len = 0;
+
+	return (rc < 0) ? rc : 0;
+}
+
 /* NOTE: Must be called while holding the flash transaction lock */
 static int32_t streamfs_read_from_file(struct streamfs_state *streamfs, uint8_t *data, uint32_t len)
 {
@@ -437,10 +470,10 @@ static int32_t streamfs_read_from_file(struct streamfs_state *streamfs, uint8_t
 		start_address = streamfs_get_addr(streamfs, streamfs->active_file_arena,
 			                                        streamfs->active_file_arena_offset);
 
-		// Read either remaining bytes or until the footer
+		// Read either remaining bytes or until the index
 		int32_t bytes_to_read = len;
-		if ((streamfs->active_file_arena_offset + bytes_to_read) > (streamfs->cfg->arena_size - sizeof(struct streamfs_footer))) {
-			bytes_to_read = streamfs->cfg->arena_size - sizeof(struct streamfs_footer) - streamfs->active_file_arena_offset;
+		if ((streamfs->active_file_arena_offset + bytes_to_read) > streamfs_data_size(streamfs)) {
+			bytes_to_read = streamfs_data_size(streamfs) - streamfs->active_file_arena_offset;
 		}
 
 		// Do not read more than valid bytes
@@ -458,10 +491,9 @@ static int32_t streamfs_read_from_file(struct streamfs_state *streamfs, uint8_t
 		data = &data[bytes_to_read];
 
 		streamfs->active_file_arena_offset += bytes_to_read;
-		PIOS_Assert(streamfs->active_file_arena_offset <= (streamfs->cfg->arena_size - sizeof(struct streamfs_footer)));
-		if (streamfs->active_file_arena_offset == streamfs->cfg->arena_size - sizeof(struct streamfs_footer)) {
-			uint16_t num_arenas = streamfs->partition_size / streamfs->cfg->arena_size;
-			streamfs->active_file_arena = (streamfs->active_file_arena + 1) % num_arenas;
+		PIOS_Assert(streamfs->active_file_arena_offset <= streamfs_data_size(streamfs));
+		if (streamfs->active_file_arena_offset == streamfs_data_size(streamfs)) {
+			streamfs->active_file_arena = (streamfs->active_file_arena + 1) % streamfs->partition_arenas;
 			streamfs->active_file_arena_offset = 0;
 		}
 	}
@@ -478,11 +510,14 @@ static int32_t streamfs_scan_filesystem(struct streamfs_state *streamfs)
 	if (streamfs->file_open_reading)
 		return -2;
 
-	uint16_t num_arenas = streamfs->partition_size / streamfs->cfg->arena_size;
+	uint16_t num_arenas = streamfs->partition_arenas;
 	streamfs->min_file_id = -1;
 	streamfs->max_file_id = 0;
+	streamfs->min_file_arena = 0;
+	streamfs->last_arena = num_arenas - 1;
 
 	bool found_file = false;
+	int32_t last_segment = -1;
 
 	for (uint16_t arena = 0; arena < num_arenas; arena++) {
 		// Read footer for each arena
@@ -495,18 +530,178 @@ static int32_t streamfs_scan_filesystem(struct streamfs_state *streamfs)
 
 		if (footer.magic == streamfs->cfg->fs_magic) {
 			found_file = true;
-			if (footer.file_id < streamfs->min_file_id)
+			if (footer.file_id < streamfs->min_file_id) {
 				streamfs->min_file_id = footer.file_id;
-			if (footer.file_id > streamfs->max_file_id)
+				streamfs->min_file_arena = arena;
+			}
+			if (footer.file_id > streamfs->max_file_id) {
 				streamfs->max_file_id = footer.file_id;
+				last_segment = -1;
+			}
+			if (footer.file_id == streamfs->max_file_id &&
+					(int32_t) footer.file_segment > last_segment) {
+				last_segment = footer.file_segment;
+				streamfs->last_arena = arena;
+			}
 		}
 	}
 
 	if (!found_file) {
 		streamfs->min_file_id = -1;
 		streamfs->max_file_id = -1;
+		streamfs->last_arena = num_arenas - 1;
+	}
+
+	return 0;
+}
+
+static uint32_t streamfs_superblock_check(const struct streamfs_superblock *sb)
+{
+	return ~(sb->magic + sb->min_file_id + sb->max_file_id +
+			sb->min_file_arena + sb->last_arena);
+}
+
+static uintptr_t streamfs_superblock_addr(const struct streamfs_state *streamfs, uint32_t record)
+{
+	return streamfs_get_addr(streamfs, streamfs->partition_arenas, 0) +
+		record * sizeof(struct streamfs_superblock);
+}
+
+/**
+ * Append the current contents summary to the superblock arena
+ * @NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_write_superblock(struct streamfs_state *streamfs)
+{
+	uint32_t num_records = streamfs->cfg->arena_size / sizeof(struct streamfs_superblock);
+
+	if (streamfs->sb_next >= num_records) {
+		if (streamfs_erase_arena(streamfs, streamfs->partition_arenas) != 0) {
+			return -1;
+		}
+
+		streamfs->sb_next = 0;
+	}
+
+	struct streamfs_superblock sb = {
+		.magic = STREAMFS_SUPERBLOCK_MAGIC,
+		.min_file_id = streamfs->min_file_id,
+		.max_file_id = streamfs->max_file_id,
+		.min_file_arena = streamfs->min_file_arena,
+		.last_arena = streamfs->last_arena,
+	};
+	sb.check = streamfs_superblock_check(&sb);
+
+	if (PIOS_FLASH_write_data(streamfs->partition_id,
+				streamfs_superblock_addr(streamfs, streamfs->sb_next),
+				(uint8_t *) &sb, sizeof(sb)) != 0) {
+		return -2;
 	}
 
+	streamfs->sb_next++;
+
+	return 0;
+}
+
+/**
+ * Read the footer of an arena
+ * @return 1 if it belongs to this filesystem, 0 if not, <0 on error
+ * @NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_read_footer(struct streamfs_state *streamfs, int32_t arena,
+		struct streamfs_footer *footer)
+{
+	uint32_t start_address = streamfs_get_addr(streamfs, arena,
+			streamfs->cfg->arena_size - sizeof(*footer));
+	if (PIOS_FLASH_read_data(streamfs->partition_id, start_address, (uint8_t *) footer, sizeof(*footer)) != 0) {
+		return -1;
+	}
+
+	return (footer->magic == streamfs->cfg->fs_magic) ? 1 : 0;
+}
+
+/**
+ * Load the contents summary from the superblock arena instead of
+ * scanning every arena.  The footers it points at are checked, and the
+ * one after the last file must not belong to a newer file; that would
+ * have been written without a close.
+ * @return 0 if loaded, <0 if a full scan is needed
+ * @NOTE: Must be called while holding the flash transaction lock
+ */
+static int32_t streamfs_load_superblock(struct streamfs_state *streamfs)
+{
+	uint32_t num_records = streamfs->cfg->arena_size / sizeof(struct streamfs_superblock);
+	struct streamfs_superblock sb;
+
+	/* Records are appended, so find the first erased one */
+	uint32_t lo = 0;
+	uint32_t hi = num_records;
+
+	while (lo < hi) {
+		uint32_t mid = (lo + hi) / 2;
+
+		if (PIOS_FLASH_read_data(streamfs->partition_id,
+					streamfs_superblock_addr(streamfs, mid),
+					(uint8_t *) &sb, sizeof(sb)) != 0) {
+			return -1;
+		}
+
+		if (sb.magic == 0xFFFFFFFF) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+
+	streamfs->sb_next = lo;
+
+	if (lo == 0) {
+		return -2;
+	}
+
+	if (PIOS_FLASH_read_data(streamfs->partition_id,
+				streamfs_superblock_addr(streamfs, lo - 1),
+				(uint8_t *) &sb, sizeof(sb)) != 0) {
+		return -1;
+	}
+
+	if (sb.magic != STREAMFS_SUPERBLOCK_MAGIC ||
+			sb.check != streamfs_superblock_check(&sb)) {
+		/* Torn write, or file data from before the superblock: start over */
+		streamfs->sb_next = num_records;
+		return -3;
+	}
+
+	if (sb.last_arena < 0 || sb.last_arena >= (int32_t) streamfs->partition_arenas ||
+			sb.min_file_arena < 0 || sb.min_file_arena >= (int32_t) streamfs->partition_arenas) {
+		return -4;
+	}
+
+	struct streamfs_footer footer;
+	int32_t rc;
+
+	if (sb.max_file_id >= 0) {
+		rc = streamfs_read_footer(streamfs, sb.last_arena, &footer);
+		if (rc <= 0 || (int32_t) footer.file_id != sb.max_file_id) {
+			return -5;
+		}
+
+		rc = streamfs_read_footer(streamfs, sb.min_file_arena, &footer);
+		if (rc <= 0 || (int32_t) footer.file_id != sb.min_file_id) {
+			return -6;
+		}
+	}
+
+	rc = streamfs_read_footer(streamfs, (sb.last_arena + 1) % streamfs->partition_arenas, &footer);
+	if (rc < 0 || (rc > 0 && (int32_t) footer.file_id > sb.max_file_id)) {
+		return -7;
+	}
+
+	streamfs->min_file_id = sb.min_file_id;
+	streamfs->max_file_id = sb.max_file_id;
+	streamfs->min_file_arena = sb.min_file_arena;
+	streamfs->last_arena = sb.last_arena;
+
 	return 0;
 }
 
@@ -523,8 +718,8 @@ static void PIOS_STREAMFS_Task(void *parameters)
 		if (streamfs->tx_out_cb) {
 			bytes_to_write = (streamfs->tx_out_cb)(
 				streamfs->tx_out_context,
-				streamfs->com_buffer,
-				streamfs->cfg->write_size,
+				&streamfs->write_buf[streamfs->write_buf_len],
+				streamfs_page_space(streamfs) - streamfs->write_buf_len,
 				NULL, NULL);
 		}
 
@@ -542,6 +737,13 @@ static void PIOS_STREAMFS_Task(void *parameters)
 			continue;
 		}
 
+		streamfs->write_buf_len += bytes_to_write;
+
+		if (streamfs->write_buf_len < streamfs_page_space(streamfs)) {
+			// Keep filling the page
+			continue;
+		}
+
 		if (PIOS_FLASH_start_transaction(streamfs->partition_id) != 0) {
 			PIOS_Mutex_Unlock(streamfs->mutex);
 			PIOS_Thread_Sleep(50);	// Don't spin
@@ -550,18 +752,26 @@ static void PIOS_STREAMFS_Task(void *parameters)
 			continue;
 		}
 
-		// Flush available data from PIOS_COM interface to
-		// file system
-		while (bytes_to_write > 0) {
-			if (streamfs_append_to_file(streamfs, streamfs->com_buffer, bytes_to_write) != 0) {
+		// Flush full pages from PIOS_COM interface to the file
+		// system.  The flash driver returns as soon as a page is
+		// clocked out, so the next page fills while the chip is
+		// still programming the last one.
+		while (streamfs->write_buf_len >= streamfs_page_space(streamfs)) {
+			if (streamfs_flush_page(streamfs) != 0) {
 				break;
 			}
 
 			bytes_to_write = (streamfs->tx_out_cb)(
 					streamfs->tx_out_context,
-					streamfs->com_buffer,
-					streamfs->cfg->write_size,
+					streamfs->write_buf,
+					streamfs_page_space(streamfs),
 					NULL, NULL);
+
+			if (bytes_to_write <= 0) {
+				break;
+			}
+
+			streamfs->write_buf_len = bytes_to_write;
 		}
 
 		PIOS_FLASH_end_transaction(streamfs->partition_id);
@@ -597,9 +807,16 @@ int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, enu
 	/* sector_size must exactly divide the partition size */
 	PIOS_Assert((partition_size % cfg->arena_size) == 0);
 
+	/* Files need two arenas, and the last one holds the superblock */
+	PIOS_Assert((partition_size / cfg->arena_size) > 2);
+
 	/* sector_size must exceed write_size */
 	PIOS_Assert(cfg->arena_size > cfg->write_size);
 
+	/* The index and footer share the last page, so index records never
+	 * straddle a page boundary */
+	PIOS_Assert(cfg->index_size + sizeof(struct streamfs_footer) <= cfg->write_size);
+
 	int8_t rc;
 
 	struct streamfs_state *streamfs;
@@ -610,8 +827,8 @@ int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, enu
 		goto out_exit;
 	}
 
-	streamfs->com_buffer = (uint8_t *)PIOS_malloc(cfg->write_size);
-	if (!streamfs->com_buffer) {
+	streamfs->write_buf = (uint8_t *)PIOS_malloc(cfg->write_size);
+	if (!streamfs->write_buf) {
 		PIOS_free(streamfs);
 		return -1;
 	}
@@ -620,13 +837,16 @@ int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, enu
 	streamfs->cfg            = cfg;	/* filesystem configuration */
 	streamfs->partition_id   = partition_id; /* underlying partition */
 	streamfs->partition_size = partition_size; /* size of underlying partition */
-	streamfs->partition_arenas = partition_size / cfg->arena_size;
+	streamfs->partition_arenas = partition_size / cfg->arena_size - 1;
 
 	streamfs->file_open_writing        = false;
 	streamfs->file_open_reading        = false;
 	streamfs->active_file_id           = 0;
 	streamfs->active_file_arena        = 0;
 	streamfs->active_file_arena_offset = 0;
+	streamfs->active_index_len         = 0;
+	streamfs->read_at_file_id          = -1;
+	streamfs->write_buf_len            = 0;
 
 	streamfs->mutex = PIOS_Mutex_Create();
 
@@ -647,15 +867,18 @@ int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, enu
 		goto out_exit;
 	}
 
-	// TODO: find the first sector after the last file
 	// TODO: validate that the partition is valid for streaming (magic?)
 
-	// Scan filesystem contents
-	streamfs_scan_filesystem(streamfs);
+	// Scan filesystem contents, unless the superblock is good
+	if (streamfs_load_superblock(streamfs) != 0) {
+		streamfs_scan_filesystem(streamfs);
+		streamfs_write_superblock(streamfs);
+	}
 
 	rc = 0;
 
 	*fs_id = (uintptr_t) streamfs;
+	streamfs_instances[partition_label] = streamfs;
 
 //out_end_trans:
 	PIOS_FLASH_end_transaction(streamfs->partition_id);
@@ -695,11 +918,24 @@ int32_t PIOS_STREAMFS_Format(uintptr_t fs_id)
 		goto out_exit;
 	}
 
+	streamfs->read_at_file_id = -1;
+
 	if (streamfs_erase_all_arenas(streamfs) != 0) {
 		rc = -3;
 		goto out_end_trans;
 	}
 
+	streamfs->min_file_id = -1;
+	streamfs->max_file_id = -1;
+	streamfs->min_file_arena = 0;
+	streamfs->last_arena = streamfs->partition_arenas - 1;
+	streamfs->sb_next = 0;
+
+	if (streamfs_write_superblock(streamfs) != 0) {
+		rc = -3;
+		goto out_end_trans;
+	}
+
 	/* Chip erased and log remounted successfully */
 	rc = 0;
 
@@ -757,11 +993,16 @@ int32_t PIOS_STREAMFS_OpenWrite(uintptr_t fs_id)
 		goto out_exit;
 	}
 
+	// The new file may overwrite the arenas of the file being read
+	streamfs->read_at_file_id = -1;
+
 	// TODO: use clever scheme to find where to start a new file
 	streamfs->active_file_id = streamfs->max_file_id + 1;
 	streamfs->active_file_segment = 0;
 	streamfs->active_file_arena = streamfs_find_new_sector(streamfs);
 	streamfs->active_file_arena_offset = 0;
+	streamfs->active_index_len = 0;
+	streamfs->write_buf_len = 0;
 	streamfs->file_open_writing = true;
 
 	// Erase this sector to prepare for streaming
@@ -821,6 +1062,7 @@ int32_t PIOS_STREAMFS_OpenRead(uintptr_t fs_id, uint32_t file_id)
 	// Find start of file
 	streamfs->active_file_arena = streamfs_find_first_arena(streamfs, file_id);
 	if (streamfs->active_file_arena >= 0) {
+		streamfs->active_file_first_arena = streamfs->active_file_arena;
 		streamfs->active_file_id = file_id;
 		streamfs->active_file_segment = 0;
 		streamfs->active_file_arena_offset = 0;
@@ -905,6 +1147,9 @@ int32_t PIOS_STREAMFS_Close(uintptr_t fs_id)
 		goto out_exit;
 	}
 
+	// Program the partial page left in the buffer
+	streamfs_flush_page(streamfs);
+
 	if (streamfs->active_file_arena_offset != 0) {
 		// Close segment when something has been written. This avoids creating
 		// null files with an open/close operation
@@ -914,8 +1159,6 @@ int32_t PIOS_STREAMFS_Close(uintptr_t fs_id)
 		}
 	}
 
-
-	// TODO: make sure to flush remaining data
 	streamfs->file_open_writing = false;
 
 	if (streamfs_scan_filesystem(streamfs) != 0) {
@@ -923,6 +1166,11 @@ int32_t PIOS_STREAMFS_Close(uintptr_t fs_id)
 		goto out_end_trans;
 	}
 
+	if (streamfs_write_superblock(streamfs) != 0) {
+		rc = -5;
+		goto out_end_trans;
+	}
+
 	rc = 0;
 
 out_end_trans:
@@ -947,7 +1195,7 @@ int32_t PIOS_STREAMFS_Read(uintptr_t fs_id, uint8_t *data, uint32_t len) {
 	bool valid = streamfs_validate(streamfs);
 	PIOS_Assert(valid);
 
-	uint16_t num_arenas = streamfs->partition_size / streamfs->cfg->arena_size;
+	uint16_t num_arenas = streamfs->partition_arenas;
 	if (streamfs->file_open_writing)
 		return -3;
 
@@ -971,6 +1219,326 @@ int32_t PIOS_STREAMFS_Read(uintptr_t fs_id, uint8_t *data, uint32_t len) {
 	return rc;
 }
 
+/**
+ * @brief Move the read position of the file open for reading
+ * @param[in] fs_id the streaming device handle
+ * @param[in] offset byte offset from the start of the file
+ * @return 0 if successful or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if no file is open for reading
+ * @retval -3 if failed to start transaction
+ * @retval -4 if the offset is past the end of the file
+ * @retval -5 if failed to read from flash
+ * @retval -6 if failed to lock the filesystem
+ */
+int32_t PIOS_STREAMFS_Seek(uintptr_t fs_id, uint32_t offset)
+{
+	int32_t rc;
+
+	struct streamfs_state *streamfs = (struct streamfs_state *)
+		PIOS_COM_GetDriverCtx(fs_id);
+	bool locked = false;
+
+	if (!streamfs_validate(streamfs)) {
+		rc = -1;
+		goto out_exit;
+	}
+
+	locked = PIOS_Mutex_Lock(streamfs->mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	if (!locked) {
+		rc = -6;
+		goto out_exit;
+	}
+
+	if (!streamfs->file_open_reading) {
+		rc = -2;
+		goto out_exit;
+	}
+
+	if (PIOS_FLASH_start_transaction(streamfs->partition_id) != 0) {
+		rc = -3;
+		goto out_exit;
+	}
+
+	// Every arena but the last of a file holds a full data area
+	uint32_t segment = offset / streamfs_data_size(streamfs);
+	uint32_t arena_offset = offset % streamfs_data_size(streamfs);
+
+	if (segment >= streamfs->partition_arenas) {
+		rc = -4;
+		goto out_end_trans;
+	}
+
+	struct streamfs_footer first, footer;
+	uint32_t arena = (streamfs->active_file_first_arena + segment) % streamfs->partition_arenas;
+
+	if (PIOS_FLASH_read_data(streamfs->partition_id,
+				streamfs_get_addr(streamfs, streamfs->active_file_first_arena,
+					streamfs->cfg->arena_size - sizeof(first)),
+				(uint8_t *) &first, sizeof(first)) != 0 ||
+			PIOS_FLASH_read_data(streamfs->partition_id,
+				streamfs_get_addr(streamfs, arena,
+					streamfs->cfg->arena_size - sizeof(footer)),
+				(uint8_t *) &footer, sizeof(footer)) != 0) {
+		rc = -5;
+		goto out_end_trans;
+	}
+
+	if (footer.magic != streamfs->cfg->fs_magic ||
+			footer.file_id != streamfs->active_file_id ||
+			footer.file_segment != first.file_segment + segment ||
+			arena_offset > footer.written_bytes) {
+		rc = -4;
+		goto out_end_trans;
+	}
+
+	streamfs->active_file_arena = arena;
+	streamfs->active_file_arena_offset = arena_offset;
+
+	rc = 0;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(streamfs->partition_id);
+
+out_exit:
+	if (locked) {
+		PIOS_Mutex_Unlock(streamfs->mutex);
+	}
+
+	return rc;
+}
+
+/**
+ * @brief Add a record to the index area of the arena being written.  The
+ * record is programmed right away, while file data may still be buffered.
+ * @param[in] fs_id the streaming device handle
+ * @param[in] record the record to add
+ * @param[in] len length of the record
+ * @return 0 if successful or error code
+ * @retval -1 if fs_id is not a valid filesystem instance
+ * @retval -2 if no file is open for writing
+ * @retval -3 if the index area of this arena is full
+ * @retval -4 if failed to start transaction
+ * @retval -5 if failed to write to flash
+ * @retval -6 if the filesystem is busy
+ */
+int32_t PIOS_STREAMFS_WriteIndex(uintptr_t fs_id, const uint8_t *record, uint32_t len)
+{
+	int32_t rc;
+
+	struct streamfs_state *streamfs = (struct streamfs_state *)
+		PIOS_COM_GetDriverCtx(fs_id);
+
+	if (!streamfs_validate(streamfs)) {
+		return -1;
+	}
+
+	/* Don't wait long for the streaming task to finish a page */
+	if (!PIOS_Mutex_Lock(streamfs->mutex, 10)) {
+		return -6;
+	}
+
+	if (!streamfs->file_open_writing) {
+		rc = -2;
+		goto out_exit;
+	}
+
+	if (streamfs->active_index_len + len > streamfs->cfg->index_size) {
+		rc = -3;
+		goto out_exit;
+	}
+
+	if (PIOS_FLASH_start_transaction(streamfs->partition_id) != 0) {
+		rc = -4;
+		goto out_exit;
+	}
+
+	uint32_t start_address = streamfs_get_addr(streamfs, streamfs->active_file_arena,
+			streamfs_data_size(streamfs) + streamfs->active_index_len);
+
+	if (PIOS_FLASH_write_data(streamfs->partition_id, start_address, record, len) != 0) {
+		rc = -5;
+		goto out_end_trans;
+	}
+
+	streamfs->active_index_len += len;
+
+	rc = 0;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(streamfs->partition_id);
+
+out_exit:
+	PIOS_Mutex_Unlock(streamfs->mutex);
+
+	return rc;
+}
+
+/**
+ * @brief Read from the data or the index areas of a file, without opening it
+ * @param[in] index true to read the index areas, which are read back to back
+ * as if they were one region of index_size bytes per arena
+ * @return number of bytes read, or the PIOS_STREAMFS_ReadAt error codes
+ */
+static int32_t streamfs_read_region(enum pios_flash_partition_labels partition_label,
+		uint32_t file_id, uint32_t offset, uint8_t *data, uint32_t len,
+		bool index)
+{
+	int32_t rc;
+
+	if (partition_label >= FLASH_PARTITION_NUM_LABELS) {
+		return -1;
+	}
+
+	struct streamfs_state *streamfs = streamfs_instances[partition_label];
+
+	if (!streamfs_validate(streamfs)) {
+		return -1;
+	}
+
+	/* The streaming task holds the lock while it has data to write, so
+	 * don't hang the caller for long */
+	if (!PIOS_Mutex_Lock(streamfs->mutex, 10)) {
+		return -6;
+	}
+
+	if (streamfs->file_open_writing) {
+		rc = -2;
+		goto out_exit;
+	}
+
+	if (PIOS_FLASH_start_transaction(streamfs->partition_id) != 0) {
+		rc = -3;
+		goto out_exit;
+	}
+
+	struct streamfs_footer footer;
+
+	/* Finding the start of a file scans every footer, so remember it for
+	 * the next chunks of the same file */
+	if (streamfs->read_at_file_id != (int32_t) file_id) {
+		int32_t arena = streamfs_find_first_arena(streamfs, file_id);
+		if (arena < 0) {
+			rc = -4;
+			goto out_end_trans;
+		}
+
+		uint32_t start_address = streamfs_get_addr(streamfs, arena,
+				streamfs->cfg->arena_size - sizeof(footer));
+		if (PIOS_FLASH_read_data(streamfs->partition_id, start_address, (uint8_t *) &footer, sizeof(footer)) != 0) {
+			rc = -5;
+			goto out_end_trans;
+		}
+
+		streamfs->read_at_file_id = file_id;
+		streamfs->read_at_first_arena = arena;
+		streamfs->read_at_first_segment = footer.file_segment;
+	}
+
+	const uint32_t region_start = index ? streamfs_data_size(streamfs) : 0;
+	const uint32_t region_size = index ? streamfs->cfg->index_size : streamfs_data_size(streamfs);
+	uint32_t total_read_len = 0;
+
+	if (region_size == 0) {
+		rc = 0;
+		goto out_end_trans;
+	}
+
+	while (len > 0) {
+		uint32_t segment = offset / region_size;
+		uint32_t arena_offset = offset % region_size;
+
+		if (segment >= streamfs->partition_arenas) {
+			break;
+		}
+
+		uint32_t arena = (streamfs->read_at_first_arena + segment) % streamfs->partition_arenas;
+
+		uint32_t start_address = streamfs_get_addr(streamfs, arena,
+				streamfs->cfg->arena_size - sizeof(footer));
+		if (PIOS_FLASH_read_data(streamfs->partition_id, start_address, (uint8_t *) &footer, sizeof(footer)) != 0) {
+			rc = -5;
+			goto out_end_trans;
+		}
+
+		// Unused index space reads as erased, but data ends where
+		// the arena's writes did
+		uint32_t valid_bytes = index ? region_size : footer.written_bytes;
+
+		// End of file, or the rest of it was overwritten by a later one
+		if (footer.magic != streamfs->cfg->fs_magic || footer.file_id != file_id ||
+				footer.file_segment != streamfs->read_at_first_segment + segment ||
+				arena_offset >= valid_bytes) {
+			break;
+		}
+
+		uint32_t bytes_to_read = MIN(len, valid_bytes - arena_offset);
+
+		start_address = streamfs_get_addr(streamfs, arena, region_start + arena_offset);
+		if (PIOS_FLASH_read_data(streamfs->partition_id, start_address, data, bytes_to_read) != 0) {
+			rc = -5;
+			goto out_end_trans;
+		}
+
+		len -= bytes_to_read;
+		offset += bytes_to_read;
+		total_read_len += bytes_to_read;
+		data = &data[bytes_to_read];
+	}
+
+	rc = total_read_len;
+
+out_end_trans:
+	PIOS_FLASH_end_transaction(streamfs->partition_id);
+
+out_exit:
+	PIOS_Mutex_Unlock(streamfs->mutex);
+
+	return rc;
+}
+
+/**
+ * @brief Read from any offset of a file, without opening it
+ * @param[in] partition_label partition holding the filesystem
+ * @param[in] file_id the file to read
+ * @param[in] offset byte offset within the file
+ * @param[out] data buffer for the data
+ * @param[in] len maximum number of bytes to read
+ * @return number of bytes read, 0 at the end of the file, < 0 on error
+ * @retval -1 if there is no filesystem on the partition
+ * @retval -2 if a file is open for writing
+ * @retval -3 if failed to start transaction
+ * @retval -4 if the file does not exist
+ * @retval -5 if failed to read from flash
+ * @retval -6 if the filesystem is busy
+ */
+int32_t PIOS_STREAMFS_ReadAt(enum pios_flash_partition_labels partition_label,
+		uint32_t file_id, uint32_t offset, uint8_t *data, uint32_t len)
+{
+	return streamfs_read_region(partition_label, file_id, offset, data,
+			len, false);
+}
+
+/**
+ * @brief Read the index records of a file, without opening it.  The index
+ * areas of the file's arenas are read back to back; space that was never
+ * written reads as 0xFF.
+ * @param[in] partition_label partition holding the filesystem
+ * @param[in] file_id the file whose index to read
+ * @param[in] offset byte offset within the index
+ * @param[out] data buffer for the records
+ * @param[in] len maximum number of bytes to read
+ * @return number of bytes read, 0 at the end of the index, < 0 on error
+ * (see PIOS_STREAMFS_ReadAt)
+ */
+int32_t PIOS_STREAMFS_ReadIndexAt(enum pios_flash_partition_labels partition_label,
+		uint32_t file_id, uint32_t offset, uint8_t *data, uint32_t len)
+{
+	return streamfs_read_region(partition_label, file_id, offset, data,
+			len, true);
+}
+
 // Testing methods for unit tests
 int32_t PIOS_STREAMFS_Testing_Write(uintptr_t fs_id, uint8_t *data, uint32_t len)
 {
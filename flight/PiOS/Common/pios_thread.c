@@ -259,6 +259,271 @@ uint32_t PIOS_Thread_Get_Stack_Usage(struct pios_thread *threadp)
 	return result;
 }
 
+#if defined(PIOS_THREAD_STATS)
+//! Length of the windows the peak load is taken over
+#define PIOS_THREAD_LOAD_WINDOW_US 10000
+
+static halrtcnt_t load_window_start;
+static halrtcnt_t load_window_idle;
+static uint8_t load_peak;
+
+/**
+ * @brief   Accounts activations and CPU load at a task switch.
+ * @note    Called from the ChibiOS context switch hook with the kernel
+ *          locked, so it has to stay short.
+ *
+ * An activation runs from the first time a thread is switched in after
+ * blocking until it blocks again; preemption doesn't end it.  Its
+ * response time is checked against the thread's deadline, if it has one.
+ *
+ * @param[in] ntp          thread switched in
+ * @param[in] otp          thread switched out
+ */
+void PIOS_Thread_Stats_Switch(Thread *ntp, Thread *otp)
+{
+	halrtcnt_t now = ntp->ticks_switched_in;
+
+	if (otp->p_state != THD_STATE_READY && otp->in_activation) {
+		halrtcnt_t response = now - otp->activation_start;
+
+		if (response > otp->max_response)
+			otp->max_response = response;
+
+		if (otp->deadline && response > otp->deadline)
+			otp->deadline_misses++;
+
+		otp->in_activation = 0;
+	}
+
+	if (!ntp->in_activation) {
+		ntp->activation_start = now;
+		ntp->in_activation = 1;
+	}
+
+	if (otp->p_prio == IDLEPRIO)
+		load_window_idle += now - otp->ticks_switched_in;
+
+	halrtcnt_t elapsed = now - load_window_start;
+
+	if (elapsed >= PIOS_THREAD_LOAD_WINDOW_US * (PIOS_SYSCLK / 1000000)) {
+		// The very first window runs from reset; don't count it
+		if (load_window_start) {
+			uint8_t load = 100 - load_window_idle / (elapsed / 100);
+
+			if (load > load_peak)
+				load_peak = load;
+		}
+
+		load_window_start = now;
+		load_window_idle = 0;
+	}
+}
+#endif /* defined(PIOS_THREAD_STATS) */
+
+/**
+ *
+ * @brief   Sets the time a thread has to finish each activation in.
+ *
+ * @param[in] threadp      pointer to instance of @p struct pios_thread
+ * @param[in] deadline_us  deadline in microseconds, 0 for none
+ *
+ */
+void PIOS_Thread_Set_Deadline(struct pios_thread *threadp, uint32_t deadline_us)
+{
+#if defined(PIOS_THREAD_STATS)
+	chSysLock();
+	threadp->threadp->deadline = deadline_us * (PIOS_SYSCLK / 1000000);
+	chSysUnlock();
+#endif /* defined(PIOS_THREAD_STATS) */
+}
+
+/**
+ *
+ * @brief   Returns the longest activation of a thread since the last call.
+ *
+ * @param[in] threadp      pointer to instance of @p struct pios_thread
+ * @param[out] deadline_misses  activations over the deadline since boot
+ *
+ * @return longest response time in microseconds
+ *
+ */
+uint32_t PIOS_Thread_Get_Max_Response(struct pios_thread *threadp,
+		uint16_t *deadline_misses)
+{
+#if defined(PIOS_THREAD_STATS)
+	chSysLock();
+
+	uint32_t result = threadp->threadp->max_response;
+	threadp->threadp->max_response = 0;
+	*deadline_misses = threadp->threadp->deadline_misses;
+
+	chSysUnlock();
+
+	return result / (PIOS_SYSCLK / 1000000);
+#else
+	*deadline_misses = 0;
+	return 0;
+#endif /* defined(PIOS_THREAD_STATS) */
+}
+
+/**
+ *
+ * @brief   Returns the highest CPU load seen since the last call.
+ *
+ * The load is taken over windows of about 10ms, so this catches
+ * bursts that an average over the telemetry period hides.
+ *
+ * @return peak load in percent
+ *
+ */
+uint8_t PIOS_Thread_Get_Peak_Load(void)
+{
+#if defined(PIOS_THREAD_STATS)
+	chSysLock();
+
+	uint8_t result = load_peak;
+	load_peak = 0;
+
+	chSysUnlock();
+
+	return result;
+#else
+	return 0;
+#endif /* defined(PIOS_THREAD_STATS) */
+}
+
+#if defined(DIAG_TASK_TRACE)
+#ifndef PIOS_THREAD_TRACE_LEN
+#define PIOS_THREAD_TRACE_LEN 256	/* events, must be a power of 2 */
+#endif
+
+#define PIOS_THREAD_TRACE_MAGIC 0x43525454	/* "TTRC" */
+#define PIOS_THREAD_TRACE_VERSION 1
+
+struct pios_thread_trace_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t num_events;
+	uint32_t clock_hz;
+} __attribute__((packed));
+
+struct pios_thread_trace_event {
+	uint32_t cycles;
+	uint8_t in_id;
+	uint8_t in_prio;
+	uint8_t out_id;
+	uint8_t out_state;
+} __attribute__((packed));
+
+static struct pios_thread_trace_event trace_ring[PIOS_THREAD_TRACE_LEN];
+static uint16_t trace_head;
+static uint16_t trace_count;
+static volatile bool trace_frozen;
+
+/**
+ * @brief   Records a task switch into the trace ring.
+ * @note    Called from the ChibiOS context switch hook with the kernel
+ *          locked, so it has to stay short.
+ *
+ * @param[in] cycles     cycle counter at the switch
+ * @param[in] in_id      trace id of the thread switched in
+ * @param[in] in_prio    priority of the thread switched in
+ * @param[in] out_id     trace id of the thread switched out
+ * @param[in] out_state  ChibiOS state of the thread switched out; READY
+ *                       means it was preempted rather than blocked
+ */
+void PIOS_Thread_Trace_Switch(uint32_t cycles, uint8_t in_id, uint8_t in_prio,
+		uint8_t out_id, uint8_t out_state)
+{
+	if (trace_frozen)
+		return;
+
+	struct pios_thread_trace_event *ev = &trace_ring[trace_head];
+
+	ev->cycles = cycles;
+	ev->in_id = in_id;
+	ev->in_prio = in_prio;
+	ev->out_id = out_id;
+	ev->out_state = out_state;
+
+	trace_head = (trace_head + 1) & (PIOS_THREAD_TRACE_LEN - 1);
+
+	if (trace_count < PIOS_THREAD_TRACE_LEN)
+		trace_count++;
+}
+
+/**
+ *
+ * @brief   Sets the id a thread is recorded with in the task switch trace.
+ *
+ * @param[in] threadp      pointer to instance of @p struct pios_thread
+ * @param[in] id           trace id, the TaskInfo index of the thread
+ *
+ */
+void PIOS_Thread_Trace_Register(struct pios_thread *threadp, uint8_t id)
+{
+	chSysLock();
+	threadp->threadp->trace_id = id;
+	chSysUnlock();
+}
+
+/**
+ *
+ * @brief   Reads the task switch trace as a file.
+ *
+ * A read at offset 0 freezes the trace so that the following chunks are
+ * consistent with each other; recording resumes once the end is read.
+ * The file is a struct pios_thread_trace_hdr followed by num_events
+ * struct pios_thread_trace_event, oldest first.
+ *
+ * @param[in] offset       offset into the trace file
+ * @param[out] buf         where to copy the data
+ * @param[in] len          maximum number of bytes to copy
+ *
+ * @return number of bytes copied, 0 at the end of the trace
+ *
+ */
+int32_t PIOS_Thread_Trace_Read(uint32_t offset, uint8_t *buf, uint32_t len)
+{
+	if (offset == 0) {
+		chSysLock();
+		trace_frozen = true;
+		chSysUnlock();
+	} else if (!trace_frozen) {
+		return 0;
+	}
+
+	struct pios_thread_trace_hdr hdr = {
+		.magic = PIOS_THREAD_TRACE_MAGIC,
+		.version = PIOS_THREAD_TRACE_VERSION,
+		.num_events = trace_count,
+		.clock_hz = PIOS_SYSCLK,
+	};
+
+	uint32_t size = sizeof(hdr) + trace_count * sizeof(trace_ring[0]);
+	uint32_t copied = 0;
+
+	while (copied < len && offset < size) {
+		if (offset < sizeof(hdr)) {
+			buf[copied++] = ((uint8_t *) &hdr)[offset++];
+			continue;
+		}
+
+		uint32_t ev_offs = offset - sizeof(hdr);
+		uint32_t idx = (trace_head - trace_count + ev_offs / sizeof(trace_ring[0])) &
+			(PIOS_THREAD_TRACE_LEN - 1);
+
+		buf[copied++] = ((uint8_t *) &trace_ring[idx])[ev_offs % sizeof(trace_ring[0])];
+		offset++;
+	}
+
+	if (offset >= size)
+		trace_frozen = false;
+
+	return copied;
+}
+#endif /* defined(DIAG_TASK_TRACE) */
+
 /**
  *
  * @brief   Suspends execution of all threads.
@@ -35,6 +35,7 @@
 // Private variables
 static struct pios_mutex *lock;
 static struct pios_thread *handles[TASKINFO_RUNNING_NUMELEM];
+static uint32_t deadlines[TASKINFO_RUNNING_NUMELEM];
 static uint32_t lastMonitorTime;
 
 // Private functions
@@ -66,6 +67,10 @@ int32_t TaskMonitorAdd(TaskInfoRunningElem task, struct pios_thread *threadp)
 	{
 		PIOS_Mutex_Lock(lock, PIOS_MUTEX_TIMEOUT_MAX);
 		handles[task_idx] = threadp;
+		PIOS_Thread_Set_Deadline(threadp, deadlines[task_idx]);
+#if defined(DIAG_TASK_TRACE)
+		PIOS_Thread_Trace_Register(threadp, task_idx);
+#endif
 		PIOS_Mutex_Unlock(lock);
 		return 0;
 	}
@@ -84,6 +89,10 @@ int32_t TaskMonitorRemove(TaskInfoRunningElem task)
 	if (task_idx < TASKINFO_RUNNING_NUMELEM)
 	{
 		PIOS_Mutex_Lock(lock, PIOS_MUTEX_TIMEOUT_MAX);
+#if defined(DIAG_TASK_TRACE)
+		if (handles[task_idx])
+			PIOS_Thread_Trace_Register(handles[task_idx], 0xFF);
+#endif
 		handles[task_idx] = 0;
 		PIOS_Mutex_Unlock(lock);
 		return 0;
@@ -105,6 +114,29 @@ bool TaskMonitorQueryRunning(TaskInfoRunningElem task)
 	return false;
 }
 
+/**
+ * Set the time a task has to finish each activation in.  Activations
+ * that take longer count in TaskInfo.DeadlineMisses.  May be called
+ * before the task is registered, e.g. from the task itself.
+ */
+int32_t TaskMonitorSetDeadline(TaskInfoRunningElem task, uint32_t deadline_us)
+{
+	uint32_t task_idx = (uint32_t) task;
+	if (task_idx < TASKINFO_RUNNING_NUMELEM)
+	{
+		PIOS_Mutex_Lock(lock, PIOS_MUTEX_TIMEOUT_MAX);
+		deadlines[task_idx] = deadline_us;
+		if (handles[task_idx])
+			PIOS_Thread_Set_Deadline(handles[task_idx], deadline_us);
+		PIOS_Mutex_Unlock(lock);
+		return 0;
+	}
+	else
+	{
+		return -1;
+	}
+}
+
 /**
  * Update the status of all tasks
  */
@@ -140,12 +172,19 @@ void TaskMonitorUpdateAll(void)
 			data.StackRemaining[n] = PIOS_Thread_Get_Stack_Usage(handles[n]);
 			/* Generate run time stats */
 			data.RunningTime[n] = PIOS_Thread_Get_Runtime(handles[n]) / deltaTime;
+
+			uint16_t misses;
+			uint32_t response = PIOS_Thread_Get_Max_Response(handles[n], &misses);
+			data.MaxResponseTime[n] = (response > UINT16_MAX) ? UINT16_MAX : response;
+			data.DeadlineMisses[n] = misses;
 		}
 		else
 		{
 			data.Running[n] = TASKINFO_RUNNING_FALSE;
 			data.StackRemaining[n] = 0;
 			data.RunningTime[n] = 0;
+			data.MaxResponseTime[n] = 0;
+			data.DeadlineMisses[n] = 0;
 		}
 	}
 
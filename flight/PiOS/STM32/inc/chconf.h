@@ -482,6 +482,51 @@ typedef uint32_t halrtcnt_t;
  */
 #define hal_lld_get_counter_value()         DWT_CYCCNT
 
+/**
+ * @brief   Task switch trace, see PIOS_Thread_Trace_Switch().
+ * @details Each thread carries the TaskInfo index it was registered with
+ *          so that the context switch hook can record it cheaply.
+ */
+#if defined(DIAG_TASK_TRACE)
+#define THREAD_EXT_TRACE_FIELDS   uint8_t trace_id;
+#define THREAD_EXT_TRACE_INIT(tp) ((tp)->trace_id = 0xFF)
+#define THREAD_TRACE_SWITCH(ntp, otp)                                       \
+  PIOS_Thread_Trace_Switch(ntp->ticks_switched_in, ntp->trace_id,           \
+                           ntp->p_prio, otp->trace_id, otp->p_state)
+void PIOS_Thread_Trace_Switch(uint32_t cycles, uint8_t in_id, uint8_t in_prio,
+                              uint8_t out_id, uint8_t out_state);
+#else
+#define THREAD_EXT_TRACE_FIELDS
+#define THREAD_EXT_TRACE_INIT(tp)
+#define THREAD_TRACE_SWITCH(ntp, otp)
+#endif
+
+/**
+ * @brief   Activation and load accounting, see PIOS_Thread_Stats_Switch().
+ */
+#if defined(DIAG_TASKS)
+#define PIOS_THREAD_STATS
+#define THREAD_EXT_STATS_FIELDS                                             \
+  halrtcnt_t activation_start;                                              \
+  halrtcnt_t max_response;                                                  \
+  halrtcnt_t deadline;                                                      \
+  uint16_t deadline_misses;                                                 \
+  uint8_t in_activation;
+#define THREAD_EXT_STATS_INIT(tp) {                                         \
+  (tp)->max_response = 0;                                                   \
+  (tp)->deadline = 0;                                                       \
+  (tp)->deadline_misses = 0;                                                \
+  (tp)->in_activation = 0;                                                  \
+}
+#define THREAD_STATS_SWITCH(ntp, otp) PIOS_Thread_Stats_Switch(ntp, otp)
+struct Thread;
+void PIOS_Thread_Stats_Switch(struct Thread *ntp, struct Thread *otp);
+#else
+#define THREAD_EXT_STATS_FIELDS
+#define THREAD_EXT_STATS_INIT(tp)
+#define THREAD_STATS_SWITCH(ntp, otp)
+#endif
+
 /**
  * @brief   Threads descriptor structure extension.
  * @details User fields added to the end of the @p Thread structure.
@@ -490,6 +535,8 @@ typedef uint32_t halrtcnt_t;
 #define THREAD_EXT_FIELDS                                                   \
   halrtcnt_t ticks_switched_in;                                             \
   halrtcnt_t ticks_total;                                                   \
+  THREAD_EXT_TRACE_FIELDS                                                   \
+  THREAD_EXT_STATS_FIELDS                                                   \
   /* Add threads custom fields here.*/
 #endif
 
@@ -502,6 +549,8 @@ typedef uint32_t halrtcnt_t;
  */
 #if !defined(THREAD_EXT_INIT_HOOK) || defined(__DOXYGEN__)
 #define THREAD_EXT_INIT_HOOK(tp) {                                          \
+  THREAD_EXT_TRACE_INIT(tp);                                                \
+  THREAD_EXT_STATS_INIT(tp);                                                \
   /* Add threads initialization code here.*/                                \
 }
 #endif
@@ -528,6 +577,8 @@ typedef uint32_t halrtcnt_t;
 #define THREAD_CONTEXT_SWITCH_HOOK(ntp, otp) {                              \
   ntp->ticks_switched_in = halGetCounterValue();                            \
   otp->ticks_total += ntp->ticks_switched_in - otp->ticks_switched_in;      \
+  THREAD_TRACE_SWITCH(ntp, otp);                                            \
+  THREAD_STATS_SWITCH(ntp, otp);                                            \
   /* System halt code here.*/                                               \
 }
 #endif
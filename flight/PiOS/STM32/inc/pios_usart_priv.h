@@ -42,6 +42,11 @@ struct pios_usart_cfg {
 	struct stm32_gpio rx;
 	struct stm32_gpio tx;
 	struct stm32_irq irq;
+	/* Optional (F4 only): receive by circular DMA instead of by byte.
+	 * The stream and its irq with its flags are given here, the stream's
+	 * vector must call PIOS_USART_RxDMA_IRQ_Handler. */
+	struct stm32_dma_chan rx_dma;
+	struct stm32_irq rx_dma_irq;
 };
 
 struct pios_usart_params {
@@ -54,6 +59,7 @@ struct pios_usart_params {
 
 extern int32_t PIOS_USART_Init(uintptr_t * usart_id, const struct pios_usart_cfg * cfg, struct pios_usart_params * params);
 extern const struct pios_usart_cfg * PIOS_USART_GetConfig(uintptr_t usart_id);
+extern void PIOS_USART_RxDMA_IRQ_Handler(const struct pios_usart_cfg * cfg);
 
 #endif /* PIOS_USART_PRIV_H */
 
@@ -191,6 +191,15 @@ uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later) {
 	return diff / us_ticks;
 }
 
+/**
+ * @brief Convert an interval in us to raw time.
+ * @return Interval in raw time, to add to a raw time
+ */
+uint32_t PIOS_DELAY_uSToRaw(uint32_t uS)
+{
+	return uS * us_ticks;
+}
+
 /**
   * @}
   * @}
@@ -276,6 +276,8 @@ static void PIOS_PPM_tim_edge_cb (uintptr_t tim_id, uintptr_t context, uint8_t c
 			     i < PIOS_PPM_IN_MAX_NUM_CHANNELS; i++) {
 				ppm_dev->CaptureValue[i] = PIOS_RCVR_TIMEOUT;
 			}
+
+			PIOS_RCVR_ActiveFromISR();
 		}
 
 		ppm_dev->Tracking = true;
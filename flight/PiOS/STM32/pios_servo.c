@@ -633,6 +633,39 @@ void PIOS_Servo_Set(uint8_t servo, float position)
 	PIOS_Servo_SetRaw(servo, position);
 }
 
+/**
+ * @brief Asks DShot ESCs for eRPM replies, from the next PIOS_Servo_SetMode on.
+ * Only DMA driven DShot on boards wired for capture supports this.
+ * @param[in] enabled Whether to use bidirectional DShot.
+ */
+void PIOS_Servo_SetBidirectional(bool enabled)
+{
+#if defined(PIOS_INCLUDE_DMASHOT)
+	PIOS_DMAShot_SetBidirectional(enabled);
+#endif
+}
+
+/**
+ * @brief Gets the eRPM an ESC last reported.
+ * @param[in] servo Servo number (0->num_channels-1)
+ * @param[out] erpm Electrical revolutions per minute
+ * @retval true if there is a recent reply, false otherwise
+ */
+bool PIOS_Servo_GetERPM(uint8_t servo, uint32_t *erpm)
+{
+	if (!servo_cfg || servo >= servo_cfg->num_channels ||
+			output_channels[servo].mode != SYNC_DSHOT_DMA) {
+		return false;
+	}
+
+#if defined(PIOS_INCLUDE_DMASHOT)
+	if (PIOS_DMAShot_IsConfigured())
+		return PIOS_DMAShot_GetERPM(&servo_cfg->channels[servo], erpm);
+#endif
+
+	return false;
+}
+
 #ifdef STM32F0XX	// No high-res delay on F0 yet
 static int DSHOT_Update()
 {
@@ -804,6 +837,23 @@ static int DSHOT_Update()
 }
 #endif /* !STM32F0xx */
 
+/**
+* Get synchronous outputs ready to go, so that PIOS_Servo_Update starts them
+* as soon as it's called. Optional.
+*/
+void PIOS_Servo_PrepareUpdate(void)
+{
+	if (!servo_cfg) {
+		return;
+	}
+
+#if defined(PIOS_INCLUDE_DMASHOT)
+	if (PIOS_DMAShot_IsReady()) {
+		PIOS_DMAShot_ArmUpdate();
+	}
+#endif
+}
+
 /**
 * Update the timer for HPWM/OneShot
 */
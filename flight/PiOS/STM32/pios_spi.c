@@ -88,7 +88,11 @@ int32_t PIOS_SPI_Init(uint32_t *spi_id, const struct pios_spi_cfg *cfg)
 	/* Bind the configuration to the device instance */
 	spi_dev->cfg = cfg;
 
+#if defined(PIOS_INCLUDE_RTOS)
+	spi_dev->busy = PIOS_Mutex_Create();
+#else
 	spi_dev->busy = PIOS_Semaphore_Create();
+#endif
 
 	switch (spi_dev->cfg->init.SPI_NSS) {
 	case SPI_NSS_Soft:
@@ -235,8 +239,13 @@ int32_t PIOS_SPI_ClaimBus(uint32_t spi_id)
 	bool valid = PIOS_SPI_validate(spi_dev);
 	PIOS_Assert(valid)
 
+#if defined(PIOS_INCLUDE_RTOS)
+	if (PIOS_Mutex_Lock(spi_dev->busy, PIOS_MUTEX_TIMEOUT_MAX) != true)
+		return -1;
+#else
 	if (PIOS_Semaphore_Take(spi_dev->busy, PIOS_SEMAPHORE_TIMEOUT_MAX) != true)
 		return -1;
+#endif
 
 	return 0;
 }
@@ -248,7 +257,11 @@ int32_t PIOS_SPI_ReleaseBus(uint32_t spi_id)
 	bool valid = PIOS_SPI_validate(spi_dev);
 	PIOS_Assert(valid)
 
+#if defined(PIOS_INCLUDE_RTOS)
+	PIOS_Mutex_Unlock(spi_dev->busy);
+#else
 	PIOS_Semaphore_Give(spi_dev->busy);
+#endif
 
 	return 0;
 }
@@ -172,6 +172,15 @@ uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later) {
 	return later - raw;
 }
 
+/**
+ * @brief Convert an interval in us to raw time.
+ * @return Interval in raw time, to add to a raw time
+ */
+uint32_t PIOS_DELAY_uSToRaw(uint32_t uS)
+{
+	return uS;
+}
+
 float PIOS_RTC_Rate()
 {
 	return ((float) SYSTICK_HZ) / RTC_DIVIDER;
@@ -43,6 +43,17 @@
 #define DMASHOT_600                                             600000
 #define DMASHOT_1200                                            1200000
 
+/**
+ * @brief DMA stream capturing the edges of one timer channel, for
+                        bidirectional DShot.
+ */
+struct pios_dmashot_capture_cfg {
+
+	DMA_Stream_TypeDef *stream;
+	uint32_t channel;
+
+};
+
 /**
  * @brief Configuration struct to assign a DMA channel and stream to a timer, and
                         optionally specify a master timer to update single timer registers of
@@ -58,6 +69,12 @@ struct pios_dmashot_timer_cfg {
 	TIM_TypeDef *master_timer;
 	uint16_t master_config;
 
+	// Optional, for bidirectional DShot: the transfer complete interrupt of
+	// the stream above (the board routes it to PIOS_DMAShot_DMA_IRQHandler),
+	// and a capture stream per timer channel, indexed by TIM_Channel_x >> 2.
+	NVIC_InitTypeDef interrupt;
+	struct pios_dmashot_capture_cfg capture[4];
+
 };
 
 /**
@@ -139,9 +156,39 @@ void PIOS_DMAShot_Validate();
  */
 void PIOS_DMAShot_WriteValue(const struct pios_tim_channel *servo_channel, uint16_t throttle);
 
+/**
+ * @brief Waits for the last update to go out and readies the timers and DMA channels for the next one,
+                        so that triggering it only has to start them. Optional; TriggerUpdate arms if needed,
+                        and arming again before it does nothing.
+ */
+void PIOS_DMAShot_ArmUpdate();
+
 /**
  * @brief Triggers the configured DMA channels to fire and send throttle values to the timer DMAR and optional CCRx registers.
  */
 void PIOS_DMAShot_TriggerUpdate();
 
+/**
+ * @brief Selects bidirectional DShot, where the ESC answers each (inverted) frame
+                        with its eRPM. Takes effect on the next timer initialization, and
+                        only on timers with an interrupt and capture streams configured.
+ * @param[in] enabled Whether to request eRPM replies.
+ */
+void PIOS_DMAShot_SetBidirectional(bool enabled);
+
+/**
+ * @brief Gets the last eRPM reply of a servo.
+ * @param[in] servo_channel The servo in question.
+ * @param[out] erpm Electrical revolutions per minute.
+ * @retval TRUE if a recent reply decoded correctly, FALSE otherwise.
+ */
+bool PIOS_DMAShot_GetERPM(const struct pios_tim_channel *servo_channel, uint32_t *erpm);
+
+/**
+ * @brief Handles the transfer complete interrupt of a timer's DMA stream, turning
+                        its pins around to capture the eRPM replies.
+ * @param[in] timer The STM32 timer whose stream interrupted.
+ */
+void PIOS_DMAShot_DMA_IRQHandler(TIM_TypeDef *timer);
+
 #endif // PIOS_DMASHOT_H
@@ -60,6 +60,14 @@ struct servo_timer {
 	union dma_buffer buffer;                                                        // DMA buffer
 	uint8_t dma_started;                                                            // Whether DMA transfers have been initiated
 
+	// Bidirectional DShot.
+	bool bidir;                                                                     // Pins turn around after each frame
+	volatile bool capturing;                                                        // Capture DMAs are running
+	TIM_OCInitTypeDef ocinit;                                                       // To restore output compare after capture
+	uint16_t *edges[4];                                                             // Captured edge timestamps per channel
+	uint32_t erpm[4];                                                               // Last decoded eRPM per channel
+	uint8_t erpm_age[4];                                                            // Frames since the last good reply
+
 };
 
 // DShot signal is 16-bit. Use a pause before and after to delimit signal and quell the timer CC
@@ -75,8 +83,18 @@ struct servo_timer {
 
 #define TIMC_TO_INDEX(c)                        ((c)>>2)
 
+// The eRPM reply is 21 bits, GCR encoded, sent at 5/4 the DShot bit rate. Every
+// bit can be an edge, plus some slack for the line settling after turnaround.
+#define DMASHOT_REPLY_BITS                      21
+#define DMASHOT_REPLY_EDGES                     (DMASHOT_REPLY_BITS + 3)
+
+// A reply older than this many frames is not reported anymore.
+#define DMASHOT_ERPM_MAX_AGE                    50
+
 const struct pios_dmashot_cfg *dmashot_cfg;
 struct servo_timer **servo_timers;
+static bool dmashot_bidir;
+static bool dmashot_armed;
 
 // Whether a timer is 16- or 32-bit wide.
 static inline bool PIOS_DMAShot_HalfWord(struct servo_timer *s_timer)
@@ -158,11 +176,17 @@ void PIOS_DMAShot_WriteValue(const struct pios_tim_channel *servo_channel, uint1
 		throttle = 2047;
 
 	throttle <<= 5;
-	throttle |=
+	uint16_t crc =
 			((throttle >> 4 ) & 0xf) ^
 			((throttle >> 8 ) & 0xf) ^
 			((throttle >> 12) & 0xf);
 
+	// Bidirectional DShot tells the ESC to answer by inverting the checksum.
+	if (s_timer->bidir)
+		crc = ~crc & 0xf;
+
+	throttle |= crc;
+
 	// Leading zero, trailing zero.
 	for (int i = DMASHOT_MESSAGE_PAUSE; i < DMASHOT_MESSAGE_WIDTH+DMASHOT_MESSAGE_PAUSE; i++) {
 		int addr = i * channels + shift;
@@ -299,6 +323,10 @@ void PIOS_DMAShot_InitializeGPIOs()
 
 				GPIO_InitTypeDef gpio_cfg = servo_channel->pin.init;
 				gpio_cfg.GPIO_Speed = GPIO_High_Speed;
+				// The line idles high in bidirectional mode, and the ESC drives it
+				// while we're listening.
+				if (s_timer->bidir)
+					gpio_cfg.GPIO_PuPd = GPIO_PuPd_UP;
 				GPIO_Init(servo_channel->pin.gpio, &gpio_cfg);
 
 				GPIO_PinAFConfig(servo_channel->pin.gpio, servo_channel->pin.pin_source, servo_channel->remap);
@@ -307,6 +335,22 @@ void PIOS_DMAShot_InitializeGPIOs()
 	}
 }
 
+// Whether the board gave us what's needed to capture replies on a timer.
+// Burst DMA to the CCRs of a slave timer is needed to turn around, so
+// master timer setups are out.
+static bool PIOS_DMAShot_CanCapture(struct servo_timer *s_timer)
+{
+	if (s_timer->dma->master_timer || !s_timer->dma->interrupt.NVIC_IRQChannelCmd)
+		return false;
+
+	for (int i = 0; i < 4; i++) {
+		if (s_timer->servo_channels[i] && !s_timer->dma->capture[i].stream)
+			return false;
+	}
+
+	return true;
+}
+
 static void PIOS_DMAShot_TimerSetup(struct servo_timer *s_timer, uint32_t sysclock, uint32_t dshot_freq, TIM_OCInitTypeDef *ocinit, bool master)
 {
 	TIM_TypeDef *timer = master ? s_timer->dma->master_timer : s_timer->dma->timer;
@@ -357,6 +401,8 @@ void PIOS_DMAShot_InitializeTimers(TIM_OCInitTypeDef *ocinit)
 	// If there's nothing setup, fail hard. We shouldn't be getting here.
 	PIOS_Assert(dmashot_cfg && servo_timers);
 
+	dmashot_armed = false;
+
 	for (int i = 0; i < MAX_TIMERS; i++) {
 
 		struct servo_timer *s_timer = servo_timers[i];
@@ -370,7 +416,16 @@ void PIOS_DMAShot_InitializeTimers(TIM_OCInitTypeDef *ocinit)
 			continue;
 		}
 
-		PIOS_DMAShot_TimerSetup(s_timer, s_timer->sysclock, s_timer->dshot_freq, ocinit, false);
+		s_timer->bidir = dmashot_bidir && PIOS_DMAShot_CanCapture(s_timer);
+		s_timer->ocinit = *ocinit;
+
+		if (s_timer->bidir) {
+			// Idle high, pulses low.
+			s_timer->ocinit.TIM_OCPolarity = TIM_OCPolarity_Low;
+			s_timer->ocinit.TIM_OCNPolarity = TIM_OCNPolarity_Low;
+		}
+
+		PIOS_DMAShot_TimerSetup(s_timer, s_timer->sysclock, s_timer->dshot_freq, &s_timer->ocinit, false);
 
 		int f = s_timer->sysclock / s_timer->dshot_freq;
 
@@ -381,6 +436,10 @@ void PIOS_DMAShot_InitializeTimers(TIM_OCInitTypeDef *ocinit)
 			PIOS_DMAShot_TimerSetup(s_timer, s_timer->sysclock, s_timer->dshot_freq, ocinit, true);
 
 		s_timer->dma_started = 0;
+		s_timer->capturing = false;
+
+		for (int j = 0; j < 4; j++)
+			s_timer->erpm_age[j] = DMASHOT_ERPM_MAX_AGE;
 	}
 }
 
@@ -429,8 +488,45 @@ static void PIOS_DMAShot_DMASetup(struct servo_timer *s_timer)
 
 	DMA_Init(s_timer->dma->stream, &dma);
 
-	// Don't do interrupts.
-	DMA_ITConfig(s_timer->dma->stream, DMA_IT_TC, DISABLE);
+	if (s_timer->bidir) {
+		// Turn the pins around once the frame is out.
+		DMA_ClearFlag(s_timer->dma->stream, s_timer->dma->tcif);
+		DMA_ITConfig(s_timer->dma->stream, DMA_IT_TC, ENABLE);
+		NVIC_Init((NVIC_InitTypeDef *)&s_timer->dma->interrupt);
+	} else {
+		// Don't do interrupts.
+		DMA_ITConfig(s_timer->dma->stream, DMA_IT_TC, DISABLE);
+	}
+}
+
+static void PIOS_DMAShot_CaptureSetup(struct servo_timer *s_timer, int idx)
+{
+	const struct pios_dmashot_capture_cfg *cap = &s_timer->dma->capture[idx];
+
+	DMA_Cmd(cap->stream, DISABLE);
+	while (DMA_GetCmdStatus(cap->stream) == ENABLE) ;
+
+	DMA_DeInit(cap->stream);
+
+	DMA_InitTypeDef dma;
+	DMA_StructInit(&dma);
+
+	// Only the low half of the CCR of 32-bit timers, which is plenty
+	// to time edges a couple microseconds apart.
+	dma.DMA_Channel = cap->channel;
+	dma.DMA_Memory0BaseAddr = (uint32_t)s_timer->edges[idx];
+	dma.DMA_PeripheralBaseAddr = (uint32_t)(&s_timer->dma->timer->CCR1 + idx);
+	dma.DMA_MemoryDataSize = DMA_MemoryDataSize_HalfWord;
+	dma.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
+	dma.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	dma.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+	dma.DMA_DIR = DMA_DIR_PeripheralToMemory;
+	dma.DMA_Mode = DMA_Mode_Normal;
+	dma.DMA_BufferSize = DMASHOT_REPLY_EDGES;
+	dma.DMA_Priority = DMA_Priority_High;
+	dma.DMA_FIFOMode = DMA_FIFOMode_Disable;
+
+	DMA_Init(cap->stream, &dma);
 }
 
 // Allocates an aligned buffer for DMA burst transfers. Returns uint32_t, since
@@ -470,15 +566,202 @@ void PIOS_DMAShot_InitializeDMAs()
 				);
 		}
 
+		if (s_timer->bidir) {
+			for (int j = 0; j < 4; j++) {
+				if (!s_timer->servo_channels[j])
+					continue;
+
+				if (!s_timer->edges[j]) {
+					s_timer->edges[j] = PIOS_malloc(DMASHOT_REPLY_EDGES * sizeof(uint16_t));
+					PIOS_Assert(s_timer->edges[j]);
+				}
+
+				PIOS_DMAShot_CaptureSetup(s_timer, j);
+			}
+		}
+
 		PIOS_DMAShot_DMASetup(s_timer);
 	}
 }
 
-void PIOS_DMAShot_TriggerUpdate()
+// Decodes the edges captured on a channel into eRPM. Returns false if the reply
+// is missing or garbled.
+static bool PIOS_DMAShot_DecodeReply(struct servo_timer *s_timer, int idx, int edges, uint32_t *erpm)
+{
+	static const int8_t gcr_decode[32] = {
+		-1, -1, -1, -1, -1, -1, -1, -1, -1,  9, 10, 11, -1, 13, 14, 15,
+		-1, -1,  2,  3, -1,  5,  6,  7, -1,  0,  8,  1, -1,  4, 12, -1,
+	};
+
+	if (edges < 2)
+		return false;
+
+	uint32_t bit_ticks = s_timer->sysclock / (s_timer->dshot_freq * 5 / 4);
+	uint16_t *e = s_timer->edges[idx];
+
+	// Run lengths between edges, in bits. The first edge is the start bit
+	// going low. The line returning high at the end leaves no final edge, so
+	// pad the last run out to 21 bits.
+	uint32_t value = 0;
+	int bits = 0;
+
+	for (int i = 1; i < edges; i++) {
+		uint16_t dt = e[i] - e[i - 1];
+		int len = (dt + bit_ticks / 2) / bit_ticks;
+
+		if (len < 1 || len > 3 || bits + len > DMASHOT_REPLY_BITS)
+			return false;
+
+		value <<= len;
+		value |= 1 << (len - 1);
+		bits += len;
+	}
+
+	if (bits < DMASHOT_REPLY_BITS - 3)
+		return false;
+
+	int len = DMASHOT_REPLY_BITS - bits;
+	if (len > 0) {
+		value <<= len;
+		value |= 1 << (len - 1);
+	}
+
+	// Each run starts with a transition, which is a one in the GCR code; the
+	// start bit's lands above the 20 bits that matter. Now undo GCR 5b4b.
+	uint32_t decoded = 0;
+	for (int i = 0; i < 4; i++) {
+		int nibble = gcr_decode[(value >> (5 * i)) & 0x1f];
+		if (nibble < 0)
+			return false;
+		decoded |= nibble << (4 * i);
+	}
+
+	uint32_t csum = decoded;
+	csum ^= csum >> 8;
+	csum ^= csum >> 4;
+	if ((csum & 0xf) != 0xf)
+		return false;
+
+	decoded >>= 4;
+
+	// Stopped motor.
+	if (decoded == 0x0fff) {
+		*erpm = 0;
+		return true;
+	}
+
+	// 9-bit mantissa, 3-bit exponent, in microseconds per electrical revolution.
+	uint32_t period = (decoded & 0x1ff) << (decoded >> 9);
+	if (!period)
+		return false;
+
+	*erpm = 60000000 / period;
+
+	return true;
+}
+
+// Stops capturing, collects the replies and gets the timer ready to send again.
+static void PIOS_DMAShot_FinishCapture(struct servo_timer *s_timer)
+{
+	TIM_TypeDef *timer = s_timer->dma->timer;
+
+	TIM_Cmd(timer, DISABLE);
+
+	for (int j = 0; j < 4; j++) {
+		if (!s_timer->servo_channels[j])
+			continue;
+
+		const struct pios_dmashot_capture_cfg *cap = &s_timer->dma->capture[j];
+
+		TIM_DMACmd(timer, TIM_DMA_CC1 << j, DISABLE);
+		DMA_Cmd(cap->stream, DISABLE);
+		while (DMA_GetCmdStatus(cap->stream) == ENABLE) ;
+
+		int edges = DMASHOT_REPLY_EDGES - DMA_GetCurrDataCounter(cap->stream);
+
+		uint32_t erpm;
+		if (PIOS_DMAShot_DecodeReply(s_timer, j, edges, &erpm)) {
+			s_timer->erpm[j] = erpm;
+			s_timer->erpm_age[j] = 0;
+		} else if (s_timer->erpm_age[j] < DMASHOT_ERPM_MAX_AGE) {
+			s_timer->erpm_age[j]++;
+		}
+
+		PIOS_DMAShot_CaptureSetup(s_timer, j);
+
+		// Both edge capture sets CCxNP, which must be clear for output compare,
+		// and OCxInit only touches it on advanced timers.
+		timer->CCER &= ~(TIM_CCER_CC1NP << (j << 2));
+	}
+
+	s_timer->capturing = false;
+
+	PIOS_DMAShot_TimerSetup(s_timer, s_timer->sysclock, s_timer->dshot_freq, &s_timer->ocinit, false);
+}
+
+void PIOS_DMAShot_DMA_IRQHandler(TIM_TypeDef *timer)
+{
+	PIOS_IRQ_Prologue();
+
+	struct servo_timer *s_timer = NULL;
+
+	for (int i = 0; servo_timers && i < MAX_TIMERS; i++) {
+		if (servo_timers[i] && servo_timers[i]->sysclock &&
+				servo_timers[i]->dma->timer == timer) {
+			s_timer = servo_timers[i];
+			break;
+		}
+	}
+
+	if (!s_timer || !s_timer->bidir)
+		goto out;
+
+	DMA_ClearFlag(s_timer->dma->stream, s_timer->dma->tcif);
+
+	TIM_DMACmd(timer, TIM_DMA_Update, DISABLE);
+
+	// The last value went into the preload registers; let the
+	// bit on the wire finish before letting go of the pins.
+	TIM_ClearFlag(timer, TIM_FLAG_Update);
+	while (TIM_GetFlagStatus(timer, TIM_FLAG_Update) != SET) ;
+
+	TIM_Cmd(timer, DISABLE);
+
+	TIM_ICInitTypeDef icinit;
+	TIM_ICStructInit(&icinit);
+	icinit.TIM_ICPolarity = TIM_ICPolarity_BothEdge;
+	icinit.TIM_ICSelection = TIM_ICSelection_DirectTI;
+
+	for (int j = 0; j < 4; j++) {
+		if (!s_timer->servo_channels[j])
+			continue;
+
+		icinit.TIM_Channel = j << 2;
+		TIM_ICInit(timer, &icinit);
+
+		DMA_Cmd(s_timer->dma->capture[j].stream, ENABLE);
+		TIM_DMACmd(timer, TIM_DMA_CC1 << j, ENABLE);
+	}
+
+	TIM_SetAutoreload(timer, 0xffff);
+	TIM_SetCounter(timer, 0);
+	TIM_Cmd(timer, ENABLE);
+
+	s_timer->capturing = true;
+
+out:
+	PIOS_IRQ_Epilogue();
+}
+
+void PIOS_DMAShot_ArmUpdate()
 {
 	// If there's nothing setup, fail hard. We shouldn't be getting here.
 	PIOS_Assert(dmashot_cfg && servo_timers);
 
+	// Already armed since the last update went out
+	if (dmashot_armed)
+		return;
+
 	for (int i = 0; i < MAX_TIMERS; i++) {
 		struct servo_timer *s_timer = servo_timers[i];
 		if (!s_timer || !s_timer->sysclock)
@@ -486,7 +769,16 @@ void PIOS_DMAShot_TriggerUpdate()
 
 		// Wait for DMA to finish.
 		if(s_timer->dma_started) {
-			while(DMA_GetFlagStatus(s_timer->dma->stream, s_timer->dma->tcif) != SET) ;
+			if (s_timer->bidir) {
+				// The interrupt has turned the pins around by then. Anything
+				// the ESC had to say has long arrived.
+				while (!s_timer->capturing) ;
+				PIOS_DMAShot_FinishCapture(s_timer);
+			} else {
+				while(DMA_GetFlagStatus(s_timer->dma->stream, s_timer->dma->tcif) != SET) ;
+			}
+
+			s_timer->dma_started = 0;
 		}
 
 		DMA_Cmd(s_timer->dma->stream, DISABLE);
@@ -510,6 +802,14 @@ void PIOS_DMAShot_TriggerUpdate()
 		DMA_SetCurrDataCounter(s_timer->dma->stream, PIOS_DMAShot_GetNumChannels(s_timer) * DMASHOT_STM32_BUFFER);
 	}
 
+	dmashot_armed = true;
+}
+
+void PIOS_DMAShot_TriggerUpdate()
+{
+	if (!dmashot_armed)
+		PIOS_DMAShot_ArmUpdate();
+
 	// Re-enable the timers and DMA in a separate loop, to make the signals line up better.
 	for (int i = 0; i < MAX_TIMERS; i++) {
 		struct servo_timer *s_timer = servo_timers[i];
@@ -535,6 +835,8 @@ void PIOS_DMAShot_TriggerUpdate()
 		DMA_Cmd(s_timer->dma->stream, ENABLE);
 		s_timer->dma_started = 1;
 	}
+
+	dmashot_armed = false;
 }
 
 bool PIOS_DMAShot_IsReady()
@@ -554,3 +856,25 @@ bool PIOS_DMAShot_IsConfigured()
 {
 	return dmashot_cfg != NULL;
 }
+
+void PIOS_DMAShot_SetBidirectional(bool enabled)
+{
+	dmashot_bidir = enabled;
+}
+
+bool PIOS_DMAShot_GetERPM(const struct pios_tim_channel *servo_channel, uint32_t *erpm)
+{
+	struct servo_timer *s_timer = PIOS_DMAShot_GetServoTimer(servo_channel);
+
+	if (!s_timer || !s_timer->bidir)
+		return false;
+
+	int idx = TIMC_TO_INDEX(servo_channel->timer_chan);
+
+	if (s_timer->erpm_age[idx] >= DMASHOT_ERPM_MAX_AGE)
+		return false;
+
+	*erpm = s_timer->erpm[idx];
+
+	return true;
+}
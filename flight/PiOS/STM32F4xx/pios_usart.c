@@ -54,6 +54,9 @@ const struct pios_com_driver pios_usart_com_driver = {
 	.bind_rx_cb = PIOS_USART_RegisterRxCallback,
 };
 
+//! Size of the circular receive DMA buffer, two halves to serve from
+#define PIOS_USART_RX_DMA_BUF_LEN 128
+
 enum pios_usart_dev_magic {
 	PIOS_USART_DEV_MAGIC = 0x4152834A,
 };
@@ -66,6 +69,9 @@ struct pios_usart_dev {
 	uintptr_t rx_in_context;
 	pios_com_callback tx_out_cb;
 	uintptr_t tx_out_context;
+
+	uint8_t *rx_dma_buf;
+	uint16_t rx_dma_pos;
 };
 
 static bool PIOS_USART_validate(struct pios_usart_dev * usart_dev)
@@ -92,6 +98,7 @@ static struct pios_usart_dev * PIOS_USART_alloc(void)
  * each physical IRQ to a specific registered device instance.
  */
 static void PIOS_USART_generic_irq_handler(uintptr_t usart_id);
+static void PIOS_USART_RxDMAInit(struct pios_usart_dev * usart_dev);
 
 static uintptr_t PIOS_USART_1_id;
 void USART1_IRQHandler(void) __attribute__ ((alias ("PIOS_USART_1_irq_handler")));
@@ -191,6 +198,13 @@ int32_t PIOS_USART_Init(uintptr_t * usart_id, const struct pios_usart_cfg * cfg,
 	/* Configure the USART */
 	USART_Init(usart_dev->cfg->regs, (USART_InitTypeDef *)&params->init);
 
+	if (usart_dev->cfg->rx_dma.channel) {
+		usart_dev->rx_dma_buf = PIOS_malloc(PIOS_USART_RX_DMA_BUF_LEN);
+		if (!usart_dev->rx_dma_buf) goto out_fail;
+
+		PIOS_USART_RxDMAInit(usart_dev);
+	}
+
 	*usart_id = (uintptr_t)usart_dev;
 
 	/* Configure USART Interrupts */
@@ -215,7 +229,10 @@ int32_t PIOS_USART_Init(uintptr_t * usart_id, const struct pios_usart_cfg * cfg,
 		break;
 	}
 	NVIC_Init((NVIC_InitTypeDef *)&(usart_dev->cfg->irq.init));
-	USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
+	if (usart_dev->rx_dma_buf)
+		USART_ITConfig(usart_dev->cfg->regs, USART_IT_IDLE, ENABLE);
+	else
+		USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
 	USART_ITConfig(usart_dev->cfg->regs, USART_IT_TXE,  ENABLE);
 
 	// FIXME XXX Clear / reset uart here - sends NUL char else
@@ -236,6 +253,12 @@ static void PIOS_USART_RxStart(uintptr_t usart_id, uint16_t rx_bytes_avail)
 	bool valid = PIOS_USART_validate(usart_dev);
 	PIOS_Assert(valid);
 	
+	if (usart_dev->rx_dma_buf) {
+		/* Have the irq pass on what is in the DMA buffer */
+		NVIC_SetPendingIRQ(usart_dev->cfg->irq.init.NVIC_IRQChannel);
+		return;
+	}
+
 	USART_ITConfig(usart_dev->cfg->regs, USART_IT_RXNE, ENABLE);
 }
 static void PIOS_USART_TxStart(uintptr_t usart_id, uint16_t tx_bytes_avail)
@@ -306,6 +329,76 @@ static void PIOS_USART_RegisterTxCallback(uintptr_t usart_id, pios_com_callback
 	usart_dev->tx_out_cb = tx_out_cb;
 }
 
+/**
+ * Set up the stream to fill the buffer over and over with what is received.
+ * It interrupts at half and full, the USART on an idle line, so the data is
+ * passed on in spans without waiting long behind a busy or a quiet line.
+ */
+static void PIOS_USART_RxDMAInit(struct pios_usart_dev * usart_dev)
+{
+	const struct pios_usart_cfg *cfg = usart_dev->cfg;
+	DMA_InitTypeDef dma_init;
+
+	DMA_StructInit(&dma_init);
+	dma_init.DMA_Channel = cfg->rx_dma.init.DMA_Channel;
+	dma_init.DMA_Priority = cfg->rx_dma.init.DMA_Priority;
+	dma_init.DMA_PeripheralBaseAddr = (uintptr_t) &cfg->regs->DR;
+	dma_init.DMA_Memory0BaseAddr = (uintptr_t) usart_dev->rx_dma_buf;
+	dma_init.DMA_DIR = DMA_DIR_PeripheralToMemory;
+	dma_init.DMA_BufferSize = PIOS_USART_RX_DMA_BUF_LEN;
+	dma_init.DMA_MemoryInc = DMA_MemoryInc_Enable;
+	dma_init.DMA_Mode = DMA_Mode_Circular;
+
+	DMA_Cmd(cfg->rx_dma.channel, DISABLE);
+	DMA_DeInit(cfg->rx_dma.channel);
+	DMA_Init(cfg->rx_dma.channel, &dma_init);
+
+	usart_dev->rx_dma_pos = 0;
+
+	NVIC_Init((NVIC_InitTypeDef *)&cfg->rx_dma_irq.init);
+	DMA_ITConfig(cfg->rx_dma.channel, DMA_IT_HT | DMA_IT_TC, ENABLE);
+	DMA_Cmd(cfg->rx_dma.channel, ENABLE);
+
+	USART_DMACmd(cfg->regs, USART_DMAReq_Rx, ENABLE);
+}
+
+/**
+ * Pass on what the DMA wrote to the buffer since the last time, at most in
+ * two spans when it wrapped around.
+ */
+static void PIOS_USART_RxDMAService(struct pios_usart_dev * usart_dev, bool * need_yield)
+{
+	uint16_t head = PIOS_USART_RX_DMA_BUF_LEN -
+		DMA_GetCurrDataCounter(usart_dev->cfg->rx_dma.channel);
+
+	if (head >= PIOS_USART_RX_DMA_BUF_LEN)
+		head = 0;
+
+	while (usart_dev->rx_dma_pos != head) {
+		uint16_t end = (head > usart_dev->rx_dma_pos) ?
+			head : PIOS_USART_RX_DMA_BUF_LEN;
+
+		if (usart_dev->rx_in_cb) {
+			(void) (usart_dev->rx_in_cb)(usart_dev->rx_in_context,
+					&usart_dev->rx_dma_buf[usart_dev->rx_dma_pos],
+					end - usart_dev->rx_dma_pos, NULL, need_yield);
+		}
+
+		usart_dev->rx_dma_pos = (end == PIOS_USART_RX_DMA_BUF_LEN) ? 0 : end;
+	}
+}
+
+/**
+ * Handler for the vector of the receive DMA stream of a port. The spans are
+ * passed on from the USART irq, so there is a single place they come from.
+ */
+void PIOS_USART_RxDMA_IRQ_Handler(const struct pios_usart_cfg * cfg)
+{
+	DMA_ClearFlag(cfg->rx_dma.channel, cfg->rx_dma_irq.flags);
+
+	NVIC_SetPendingIRQ(cfg->irq.init.NVIC_IRQChannel);
+}
+
 static void PIOS_USART_generic_irq_handler(uintptr_t usart_id)
 {
 	struct pios_usart_dev * usart_dev = (struct pios_usart_dev *)usart_id;
@@ -313,16 +406,26 @@ static void PIOS_USART_generic_irq_handler(uintptr_t usart_id)
 	bool valid = PIOS_USART_validate(usart_dev);
 	PIOS_Assert(valid);
 	
-	/* Force read of dr after sr to make sure to clear error flags */
 	volatile uint16_t sr = usart_dev->cfg->regs->SR;
-	volatile uint8_t dr = usart_dev->cfg->regs->DR;
-	
-	/* Check if RXNE flag is set */
+
 	bool rx_need_yield = false;
-	if (sr & USART_SR_RXNE) {
-		uint8_t byte = dr;
-		if (usart_dev->rx_in_cb) {
-			(void) (usart_dev->rx_in_cb)(usart_dev->rx_in_context, &byte, 1, NULL, &rx_need_yield);
+	if (usart_dev->rx_dma_buf) {
+		/* Read dr after sr to clear the idle and error flags, the DMA has
+		 * already taken the data */
+		if (sr & (USART_SR_IDLE | USART_SR_ORE | USART_SR_NE | USART_SR_FE))
+			(void) usart_dev->cfg->regs->DR;
+
+		PIOS_USART_RxDMAService(usart_dev, &rx_need_yield);
+	} else {
+		/* Force read of dr after sr to make sure to clear error flags */
+		volatile uint8_t dr = usart_dev->cfg->regs->DR;
+
+		/* Check if RXNE flag is set */
+		if (sr & USART_SR_RXNE) {
+			uint8_t byte = dr;
+			if (usart_dev->rx_in_cb) {
+				(void) (usart_dev->rx_in_cb)(usart_dev->rx_in_context, &byte, 1, NULL, &rx_need_yield);
+			}
 		}
 	}
 	
@@ -54,6 +54,13 @@ const struct pios_com_driver pios_usb_cdc_com_driver = {
 	.available   = PIOS_USB_CDC_Available,
 };
 
+/*
+ * Data is sent to the host in transfers of up to this many packets.  The
+ * core streams them back to back from the endpoint's TX FIFO, with one
+ * interrupt per transfer rather than per packet.
+ */
+#define PIOS_USB_CDC_TX_PACKETS 4
+
 enum pios_usb_cdc_dev_magic {
 	PIOS_USB_CDC_DEV_MAGIC = 0xAABBCCDD,
 };
@@ -75,13 +82,14 @@ struct pios_usb_cdc_dev {
 	uint8_t rx_packet_buffer[PIOS_USB_BOARD_CDC_DATA_LENGTH] __attribute__ ((aligned(4)));
 	volatile bool rx_active;
 
+	uint8_t tx_packet_buffer[PIOS_USB_BOARD_CDC_DATA_LENGTH * PIOS_USB_CDC_TX_PACKETS] __attribute__ ((aligned(4)));
+	volatile bool tx_active;
 	/*
-	 * NOTE: This is -1 as somewhat of a hack.  It ensures that we always send packets
-	 * that are strictly < maxPacketSize for this interface which means we never have
-	 * to bother with zero length packets (ZLP).
+	 * The host only sees a transfer end at a short packet.  One that
+	 * filled its last packet is ended with a zero length packet (ZLP)
+	 * if nothing else follows right away.
 	 */
-	uint8_t tx_packet_buffer[PIOS_USB_BOARD_CDC_DATA_LENGTH - 1] __attribute__ ((aligned(4)));
-	volatile bool tx_active;
+	bool tx_need_zlp;
 
 	uint8_t ctrl_tx_packet_buffer[PIOS_USB_BOARD_CDC_MGMT_LENGTH] __attribute__ ((aligned(4)));
 
@@ -159,6 +167,7 @@ int32_t PIOS_USB_CDC_Init(uintptr_t * usbcdc_id, const struct pios_usb_cdc_cfg *
 	/* Rx and Tx are not active yet */
 	usb_cdc_dev->rx_active = false;
 	usb_cdc_dev->tx_active = false;
+	usb_cdc_dev->tx_need_zlp = false;
 
 	/* Clear stats */
 	usb_cdc_dev->rx_dropped = 0;
@@ -198,11 +207,25 @@ static bool PIOS_USB_CDC_SendData(struct pios_usb_cdc_dev * usb_cdc_dev)
 					       NULL,
 					       &need_yield);
 	if (bytes_to_tx == 0) {
+		if (usb_cdc_dev->tx_need_zlp) {
+			usb_cdc_dev->tx_need_zlp = false;
+			usb_cdc_dev->tx_active = true;
+
+			PIOS_USBHOOK_EndpointTx(usb_cdc_dev->cfg->data_tx_ep,
+						usb_cdc_dev->tx_packet_buffer,
+						0);
+
+			return true;
+		}
+
 		usb_cdc_dev->tx_active = false;
 
 		return false;
 	}
 
+	usb_cdc_dev->tx_need_zlp =
+		(bytes_to_tx % PIOS_USB_BOARD_CDC_DATA_LENGTH) == 0;
+
 	/* 
 	 * Mark this endpoint as being tx active _before_ actually transmitting
 	 * to make sure we don't race with the Tx completion interrupt
@@ -305,6 +328,7 @@ static void PIOS_USB_CDC_CTRL_IF_Init(uintptr_t usb_cdc_id)
 	/* Register endpoint specific callbacks with the USBHOOK layer */
 	PIOS_USBHOOK_RegisterEpInCallback(usb_cdc_dev->cfg->ctrl_tx_ep,
 					  sizeof(usb_cdc_dev->ctrl_tx_packet_buffer),
+					  PIOS_USBHOOK_EP_INTERRUPT,
 					  PIOS_USB_CDC_CTRL_EP_IN_Callback,
 					  (uintptr_t) usb_cdc_dev);
 	usb_cdc_dev->usb_ctrl_if_enabled = true;
@@ -484,11 +508,13 @@ static void PIOS_USB_CDC_DATA_IF_Init(uintptr_t usb_cdc_id)
 
 	/* Register endpoint specific callbacks with the USBHOOK layer */
 	PIOS_USBHOOK_RegisterEpInCallback(usb_cdc_dev->cfg->data_tx_ep,
-					  sizeof(usb_cdc_dev->tx_packet_buffer),
+					  PIOS_USB_BOARD_CDC_DATA_LENGTH,
+					  PIOS_USBHOOK_EP_BULK,
 					  PIOS_USB_CDC_DATA_EP_IN_Callback,
 					  (uintptr_t) usb_cdc_dev);
 	PIOS_USBHOOK_RegisterEpOutCallback(usb_cdc_dev->cfg->data_rx_ep,
 					   sizeof(usb_cdc_dev->rx_packet_buffer),
+					   PIOS_USBHOOK_EP_BULK,
 					   PIOS_USB_CDC_DATA_EP_OUT_Callback,
 					   (uintptr_t) usb_cdc_dev);
 	usb_cdc_dev->usb_data_if_enabled = true;
@@ -507,6 +533,7 @@ static void PIOS_USB_CDC_DATA_IF_DeInit(uintptr_t usb_cdc_id)
 	usb_cdc_dev->rx_dropped = 0;
 	usb_cdc_dev->rx_oversize = 0;
 	usb_cdc_dev->tx_active = false;
+	usb_cdc_dev->tx_need_zlp = false;
 	usb_cdc_dev->usb_data_if_enabled = false;
 
 	/* DeRegister endpoint specific callbacks with the USBHOOK layer */
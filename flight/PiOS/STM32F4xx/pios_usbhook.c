@@ -125,7 +125,18 @@ struct usb_ep_entry {
 	uint16_t max_len;
 };
 static struct usb_ep_entry usb_epin_table[6];
-void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uintptr_t context)
+static uint8_t PIOS_USBHOOK_EpType(enum pios_usbhook_ep_type type)
+{
+	switch (type) {
+	case PIOS_USBHOOK_EP_BULK:
+		return USB_OTG_EP_BULK;
+	case PIOS_USBHOOK_EP_INTERRUPT:
+	default:
+		return USB_OTG_EP_INT;
+	}
+}
+
+void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, enum pios_usbhook_ep_type type, pios_usbhook_epcb cb, uintptr_t context)
 {
 	PIOS_Assert(epnum < NELEMENTS(usb_epin_table));
 	PIOS_Assert(cb);
@@ -137,10 +148,7 @@ void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, pios_usb
 	DCD_EP_Open(&pios_usb_otg_core_handle,
 		epnum | 0x80,
 		max_len,
-		USB_OTG_EP_INT);
-	/*
-	 * FIXME do not hardcode endpoint type
-	 */
+		PIOS_USBHOOK_EpType(type));
 }
 
 extern void PIOS_USBHOOK_DeRegisterEpInCallback(uint8_t epnum)
@@ -153,7 +161,7 @@ extern void PIOS_USBHOOK_DeRegisterEpInCallback(uint8_t epnum)
 }
 
 static struct usb_ep_entry usb_epout_table[6];
-void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uintptr_t context)
+void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, enum pios_usbhook_ep_type type, pios_usbhook_epcb cb, uintptr_t context)
 {
 	PIOS_Assert(epnum < NELEMENTS(usb_epout_table));
 	PIOS_Assert(cb);
@@ -165,10 +173,7 @@ void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_us
 	DCD_EP_Open(&pios_usb_otg_core_handle,
 		epnum,
 		max_len,
-		USB_OTG_EP_INT);
-	/*
-	 * FIXME do not hardcode endpoint type
-	 */
+		PIOS_USBHOOK_EpType(type));
 
 	/*
 	 * Make sure we refuse OUT transactions until we explicitly
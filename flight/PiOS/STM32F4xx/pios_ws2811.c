@@ -43,6 +43,7 @@
 #include "pios_tim_priv.h"
 
 #include "pios_ws2811.h"
+#include "pios_thread.h"
 
 struct ws2811_pixel_data_s {
 	uint8_t g;
@@ -57,6 +58,10 @@ struct ws2811_pixel_data_s {
 // interrupt rate of 3.33KHz.
 #define WS2811_DMA_BUFSIZE (6*24*2)
 
+// Longest unchanged colours go without being clocked out again, so LEDs
+// powered up late or upset by a glitch come right
+#define WS2811_REFRESH_PERIOD_MS 1000
+
 struct ws2811_dev_s {
 #define WS2811_MAGIC 0x31313832		/* '2811' */
 	uint32_t magic;
@@ -86,9 +91,16 @@ struct ws2811_dev_s {
 	// And this gets fixed up to be a shifted right image, etc.
 	uint8_t gpio_bit;
 
+	// DMA buffer words for each nibble of pixel data, two bits per word
+	uint32_t nibble_lut[16][2];
+
 	bool cur_buf;
 	bool eof;
 
+	// Pixel data changed since it was last clocked out
+	volatile bool dirty;
+	uint32_t last_update_ms;
+
 	volatile bool in_progress;
 
 	uint8_t *pixel_data_pos;
@@ -147,7 +159,26 @@ int PIOS_WS2811_init(ws2811_dev_t *dev_out, const struct pios_ws2811_cfg *cfg,
 		(dev->gpio_bit << 16) |
 		(dev->gpio_bit << 24);
 
+	// A '0' bit lets the pin fall early; a '1' leaves it to the
+	// prefilled odd byte.  Most significant bit first.
+	for (int n = 0; n < 16; n++) {
+		for (int w = 0; w < 2; w++) {
+			uint32_t word = (dev->gpio_bit << 8) | (dev->gpio_bit << 24);
+
+			if (!(n & (0x8 >> (w * 2)))) {
+				word |= dev->gpio_bit;
+			}
+
+			if (!(n & (0x4 >> (w * 2)))) {
+				word |= dev->gpio_bit << 16;
+			}
+
+			dev->nibble_lut[n][w] = word;
+		}
+	}
+
 	PIOS_WS2811_set_all(dev, 0, 0, 0);
+	dev->dirty = true;
 
 	GPIO_InitTypeDef gpio_cfg = {
 		.GPIO_Pin = cfg->gpio_pin,
@@ -193,41 +224,33 @@ int PIOS_WS2811_init(ws2811_dev_t *dev_out, const struct pios_ws2811_cfg *cfg,
 
 DONT_BUILD_IF((WS2811_DMA_BUFSIZE % 16) != 0, DMABufIntegralBytes);
 
-// Updates pixel_data_ptr to where we are.  returns true if we've reached
+// Updates pixel_data_pos to where we are.  returns true if we've reached
 // the end.
-static bool fill_dma_buf(uint8_t * restrict dma_buf, uint8_t **pixel_data_ptr,
-		uint8_t *pixel_data_end, uint8_t gpio_val) {
+static bool fill_dma_buf(ws2811_dev_t dev, uint32_t * restrict dma_buf) {
 	// Our local shadow of this, for efficient blitting.
-	uint8_t * restrict p_d_p = *pixel_data_ptr;
+	uint8_t * restrict p_d_p = dev->pixel_data_pos;
 
-	if (p_d_p >= pixel_data_end) {
+	if (p_d_p >= dev->pixel_data_end) {
 		// No pixel data filled.  So next interrupt we should stop
 		// timers and dmas
 		return true;
 	}
 
-	for (int i = 0; i < WS2811_DMA_BUFSIZE; i += 16) {
-		if (p_d_p >= pixel_data_end) break;
+	// Each pixel byte is 16 bytes of DMA buffer; 4 words.
+	for (int i = 0; i < WS2811_DMA_BUFSIZE / 4; i += 4) {
+		if (p_d_p >= dev->pixel_data_end) break;
 
 		uint8_t p = *(p_d_p++);
 
-		for (int j = 0; j < 8; j++) {
-			if (!(p & 0x80)) {
-				// It's zero-- therefore the pin has to fall
-				// early.
-				dma_buf[i + j*2] = gpio_val;
-			} else {
-				// It's one.  Therefore we let the prefilled
-				// bit in the odd position clear it; we do
-				// nothing.
-				dma_buf[i + j*2] = 0;
-			}
+		const uint32_t *hi = dev->nibble_lut[p >> 4];
+		const uint32_t *lo = dev->nibble_lut[p & 0xf];
 
-			// We clock out most significant bit first.
-			p = p << 1;
-		}
+		dma_buf[i] = hi[0];
+		dma_buf[i + 1] = hi[1];
+		dma_buf[i + 2] = lo[0];
+		dma_buf[i + 3] = lo[1];
 	}
-	*pixel_data_ptr = p_d_p;
+	dev->pixel_data_pos = p_d_p;
 
 	return false;
 }
@@ -316,12 +339,23 @@ void PIOS_WS2811_trigger_update(ws2811_dev_t dev)
 {
 	PIOS_Assert(dev->magic == WS2811_MAGIC);
 
+	// The LEDs latch their colours; only clock out changes, and now and
+	// then the same colours again
+	uint32_t now = PIOS_Thread_Systime();
+
+	if (!dev->dirty &&
+			(now - dev->last_update_ms) < WS2811_REFRESH_PERIOD_MS) {
+		return;
+	}
+
 	if (dev->in_progress) {
 		// XXX really need to ensure dead time here too
 		return;
 	}
 
 	dev->in_progress = true;
+	dev->dirty = false;
+	dev->last_update_ms = now;
 
 	dev->eof = false;
 
@@ -330,11 +364,9 @@ void PIOS_WS2811_trigger_update(ws2811_dev_t dev)
 	// Current one to blit is the first
 	dev->cur_buf = false;
 
-	fill_dma_buf((uint8_t *) dev->dma_buf_0, &dev->pixel_data_pos,
-			dev->pixel_data_end, dev->gpio_bit);
+	fill_dma_buf(dev, dev->dma_buf_0);
 
-	dev->eof = fill_dma_buf((uint8_t *) dev->dma_buf_1, &dev->pixel_data_pos,
-			dev->pixel_data_end, dev->gpio_bit);
+	dev->eof = fill_dma_buf(dev, dev->dma_buf_1);
 
 	ws2811_cue_dma(dev);
 }
@@ -383,11 +415,8 @@ void PIOS_WS2811_dma_interrupt_handler(ws2811_dev_t dev)
 	// If cur_buf is true, we're currently blitting 1, so we should
 	// be updating 0.
 
-	uint8_t *buf = (uint8_t *)
-		(dev->cur_buf ? dev->dma_buf_0 : dev->dma_buf_1);
-
-	dev->eof = fill_dma_buf(buf, &dev->pixel_data_pos,
-			dev->pixel_data_end, dev->gpio_bit);
+	dev->eof = fill_dma_buf(dev,
+			dev->cur_buf ? dev->dma_buf_0 : dev->dma_buf_1);
 
 epilogue:
 	PIOS_IRQ_Epilogue();
@@ -402,8 +431,14 @@ void PIOS_WS2811_set(ws2811_dev_t dev, int idx, uint8_t r, uint8_t g,
 		return;
 	}
 
-	dev->pixel_data[idx] = (struct ws2811_pixel_data_s)
-			{ .r = r, .g = g, .b = b };
+	struct ws2811_pixel_data_s *pixel = &dev->pixel_data[idx];
+
+	if (pixel->r == r && pixel->g == g && pixel->b == b) {
+		return;
+	}
+
+	*pixel = (struct ws2811_pixel_data_s) { .r = r, .g = g, .b = b };
+	dev->dirty = true;
 }
 
 void PIOS_WS2811_set_all(ws2811_dev_t dev, uint8_t r, uint8_t g,
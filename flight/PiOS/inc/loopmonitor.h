@@ -0,0 +1,93 @@
+/**
+ ******************************************************************************
+ * @addtogroup TauLabsLibraries Tau Labs Libraries
+ * @{
+ *
+ * @file       loopmonitor.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief      Control loop timing library
+ * @see        The GNU Public License (GPL) Version 3
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+#ifndef LOOPMONITOR_H
+#define LOOPMONITOR_H
+
+#include <stdint.h>
+#include "pios_delay.h"
+
+//! Stages of the control loop, in the order of the LoopTiming fields
+enum loopmonitor_stage {
+	LOOPMONITOR_SENSORREAD,
+	LOOPMONITOR_FILTER,
+	LOOPMONITOR_ATTITUDE,
+	LOOPMONITOR_PID,
+	LOOPMONITOR_MIXER,
+	LOOPMONITOR_OUTPUT,
+	LOOPMONITOR_LATENCY,
+	LOOPMONITOR_NUM_STAGES
+};
+
+void LoopMonitorUpdateAll(void);
+
+#if defined(DIAG_LOOPTIMING)
+void LoopMonitorRecord(enum loopmonitor_stage stage, uint32_t start);
+void LoopMonitorMarkSample(void);
+void LoopMonitorEndFromSample(enum loopmonitor_stage stage);
+
+/**
+ * Mark the start of a stage
+ * @return the raw time to pass to LoopMonitorEnd
+ */
+static inline uint32_t LoopMonitorStart(void)
+{
+	return PIOS_DELAY_GetRaw();
+}
+
+/**
+ * Count the time a stage took since LoopMonitorStart
+ */
+static inline void LoopMonitorEnd(enum loopmonitor_stage stage, uint32_t start)
+{
+	LoopMonitorRecord(stage, start);
+}
+#else
+/* Compiled out, so the stages cost nothing unless asked for */
+static inline uint32_t LoopMonitorStart(void)
+{
+	return 0;
+}
+
+static inline void LoopMonitorEnd(enum loopmonitor_stage stage, uint32_t start)
+{
+	(void) stage; (void) start;
+}
+
+static inline void LoopMonitorMarkSample(void)
+{
+}
+
+static inline void LoopMonitorEndFromSample(enum loopmonitor_stage stage)
+{
+	(void) stage;
+}
+#endif /* DIAG_LOOPTIMING */
+
+#endif // LOOPMONITOR_H
+
+/**
+ * @}
+ * @}
+ */
@@ -73,8 +73,13 @@ struct pios_bmi160_cfg {
 	enum pios_bmi160_acc_range acc_range;
 	enum pios_bmi160_gyro_range gyro_range;
 	uint8_t temperature_interleaving;
+	/* Samples read from the FIFO per interrupt, up to
+	 * PIOS_BMI160_MAX_FIFO_SAMPLES; 0 to read each sample on data ready */
+	uint8_t fifo_samples;
 };
 
+#define PIOS_BMI160_MAX_FIFO_SAMPLES 4
+
 /* Public Functions */
 extern int32_t PIOS_BMI160_Init(uint32_t spi_id, uint32_t slave_num, const struct pios_bmi160_cfg *cfg, bool do_foc);
 extern bool PIOS_BMI160_IRQHandler(void);
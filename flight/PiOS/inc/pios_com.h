@@ -56,13 +56,17 @@ extern int32_t PIOS_COM_SendCharNonBlocking(uintptr_t com_id, char c);
 extern int32_t PIOS_COM_SendChar(uintptr_t com_id, char c);
 extern int32_t PIOS_COM_SendBufferNonBlocking(uintptr_t com_id, const uint8_t *buffer, uint16_t len);
 extern int32_t PIOS_COM_SendBuffer(uintptr_t com_id, const uint8_t *buffer, uint16_t len);
+extern uint8_t *PIOS_COM_ReserveBuffer(uintptr_t com_id, uint16_t len);
+extern int32_t PIOS_COM_CommitBuffer(uintptr_t com_id, uint16_t len);
 extern int32_t PIOS_COM_SendStringNonBlocking(uintptr_t com_id, const char *str);
 extern int32_t PIOS_COM_SendString(uintptr_t com_id, const char *str);
 extern int32_t PIOS_COM_SendFormattedStringNonBlocking(uintptr_t com_id, const char *format, ...);
 extern int32_t PIOS_COM_SendFormattedString(uintptr_t com_id, const char *format, ...);
 extern uint16_t PIOS_COM_ReceiveBuffer(uintptr_t com_id, uint8_t * buf, uint16_t buf_len, uint32_t timeout_ms);
 extern bool PIOS_COM_Available(uintptr_t com_id);
+extern bool PIOS_COM_HasReceiveBuffer(uintptr_t com_id);
 uint16_t PIOS_COM_GetNumReceiveBytesPending(uintptr_t com_id);
+uint16_t PIOS_COM_GetTxBytesFree(uintptr_t com_id);
 
 #endif /* PIOS_COM_H */
 
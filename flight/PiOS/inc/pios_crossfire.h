@@ -67,6 +67,13 @@
 
 #define CRSF_TIMING_MAXFRAME		1000
 #define CRSF_TIMING_FRAMEDISTANCE	4000
+// 420kbit with start and stop bit, rounded up.
+#define CRSF_TIMING_BYTE			24
+
+// Longest telemetry burst to send after a single RC frame. Frames can go
+// back to back, but the receiver only buffers as much as the largest
+// frame the protocol allows.
+#define CRSF_MAX_TELEMBURST			64
 
 // We don't need those. Yet. More like a reference right now.
 struct crsf_payload_gps {
@@ -125,6 +132,9 @@ struct crsf_frame_t {
 // Get formal payload length.
 #define CRSF_PAYLOAD_LEN(x)		(CRSF_TYPE_LEN+(x)+CRSF_CRC_LEN)
 
+// Whole frame length on the wire for a given payload.
+#define CRSF_FRAME_LEN(x)		(CRSF_ADDRESS_LEN+CRSF_LENGTH_LEN+CRSF_PAYLOAD_LEN(x))
+
 extern const struct pios_rcvr_driver pios_crossfire_rcvr_driver;
 
 /**
@@ -141,6 +151,14 @@ int PIOS_Crossfire_InitTelemetry(uintptr_t crsf_id);
 
 int PIOS_Crossfire_SendTelemetry(uintptr_t crsf_id, uint8_t *buf, uint8_t bytes);
 
+/**
+ * @brief Telemetry budget of the link, as seen from the RC frame cadence
+ * @param[in] crsf_id Crossfire receiver device handle
+ * @param[out] period_us Measured RC frame period, or nominal if unknown
+ * @retval Number of telemetry bytes that fit after one RC frame
+ */
+uint8_t PIOS_Crossfire_GetTelemetrySlot(uintptr_t crsf_id, uint32_t *period_us);
+
 bool PIOS_Crossfire_IsFailsafed();
 
 #endif // PIOS_CROSSFIRE_H
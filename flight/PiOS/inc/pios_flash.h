@@ -47,6 +47,7 @@ extern int32_t PIOS_FLASH_start_transaction(uintptr_t partition_id);
 extern int32_t PIOS_FLASH_end_transaction(uintptr_t partition_id);
 extern int32_t PIOS_FLASH_erase_partition(uintptr_t partition_id);
 extern int32_t PIOS_FLASH_erase_range(uintptr_t partition_id, uint32_t start_offset, uint32_t size);
+extern int32_t PIOS_FLASH_get_sector_extents(uintptr_t partition_id, uint32_t offset, uint32_t *sector_offset, uint32_t *sector_size);
 extern int32_t PIOS_FLASH_write_data(uintptr_t partition_id, uint32_t offset, const uint8_t *data, uint16_t len);
 extern int32_t PIOS_FLASH_read_data(uintptr_t partition_id, uint32_t offset, uint8_t *data, uint16_t len);
 
@@ -29,6 +29,7 @@
 
 #include <stdlib.h>		/* size_t */
 #include <stdbool.h>		/* bool */
+#include <stdint.h>		/* uint16_t */
 
 extern bool PIOS_heap_malloc_failed_p(void);
 
@@ -42,4 +43,30 @@ extern size_t PIOS_fastheap_get_free_size(void);
 extern void PIOS_heap_initialize_blocks(void);
 extern void PIOS_heap_increase_size(size_t bytes);
 
+/**
+ * Fixed block size pools for small, frequently created and released
+ * allocations.  Freed blocks return to their pool, never to the heap.
+ */
+struct pios_heap_pool;
+
+struct pios_heap_pool_stats {
+	uint16_t in_use;	/* blocks handed out right now */
+	uint16_t peak;		/* most blocks ever handed out at once */
+	uint16_t capacity;	/* blocks taken from the heap */
+};
+
+/**
+ * @brief Create a pool of blocks of one size
+ * @param[in] block_size size of each block, rounded up for alignment
+ * @param[in] blocks_per_region number of blocks taken from the heap at once
+ * @param[in] fast place the blocks on the fast (non-DMA) heap if there is one
+ * @return the pool, or NULL if out of memory
+ */
+extern struct pios_heap_pool *PIOS_heap_pool_create(size_t block_size,
+		uint16_t blocks_per_region, bool fast);
+extern void *PIOS_heap_pool_alloc(struct pios_heap_pool *pool);
+extern void PIOS_heap_pool_free(struct pios_heap_pool *pool, void *buf);
+extern void PIOS_heap_pool_get_stats(struct pios_heap_pool *pool,
+		struct pios_heap_pool_stats *stats);
+
 #endif	/* PIOS_HEAP_H */
@@ -75,11 +75,21 @@ int PIOS_MAX7456_init (max7456_dev_t *dev_out,
 		uint32_t spi_handle, uint32_t slave_idx);
 
 /**
- * @brief Clear the screen
+ * @brief Clear the frame being drawn
  * @param[in] dev The max7456 device handle
  */
 void PIOS_MAX7456_clear (max7456_dev_t dev);
 
+/**
+ * @brief Show the frame drawn since the last flush
+ * @param[in] dev The max7456 device handle
+ *
+ * Drawing only updates a copy of the screen in RAM.  This writes the
+ * characters that differ from what the chip displays, in auto increment
+ * runs, so an unchanged screen costs no SPI traffic.
+ */
+void PIOS_MAX7456_flush (max7456_dev_t dev);
+
 /**
  * @brief Upload a character to the device
  * @param[in] dev The max7456 device handle
@@ -99,7 +109,7 @@ void PIOS_MAX7456_download_char (max7456_dev_t dev,
 		uint8_t char_index, uint8_t *data);
 
 /**
- * @brief Sets a position of character memory
+ * @brief Sets a position of the frame
  * @param[in] dev The max7456 device handle
  * @param[in] col The column to update
  * @param[in] row The row of the character to update
@@ -110,7 +120,7 @@ void PIOS_MAX7456_put (max7456_dev_t dev, uint8_t col, uint8_t row,
 		uint8_t chr, uint8_t attr);
 
 /**
- * @brief Sets a string into character memory
+ * @brief Sets a string into the frame
  * @param[in] dev The max7456 device handle
  * @param[in] col The column to begin the update at
  * @param[in] row The row of the character to update
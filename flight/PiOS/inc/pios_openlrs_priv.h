@@ -185,6 +185,7 @@ struct pios_openlrs_dev {
   // Variables from OpenLRS for radio control
   uint8_t hopcount;
   uint32_t lastPacketTimeUs;
+  volatile uint32_t irqTimeUs; // When nIRQ flagged the last packet
   uint32_t numberOfLostPackets;
   uint16_t lastAFCCvalue;
   uint32_t lastRSSITimeUs;
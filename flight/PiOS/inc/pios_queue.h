@@ -49,6 +49,16 @@ bool PIOS_Queue_Send(struct pios_queue *queuep, const void *itemp, uint32_t time
 bool PIOS_Queue_Send_FromISR(struct pios_queue *queuep, const void *itemp, bool *wokenp);
 bool PIOS_Queue_Receive(struct pios_queue *queuep, void *itemp, uint32_t timeout_ms);
 
+/*
+ * Zero-copy access: a producer reserves a slot, fills it in place and
+ * commits it; a consumer peeks at the front slot and releases it when
+ * done.  Each side may hold one slot at a time beyond the queue length.
+ */
+void *PIOS_Queue_Reserve(struct pios_queue *queuep);
+bool PIOS_Queue_Commit(struct pios_queue *queuep, void *itemp, uint32_t timeout_ms);
+void *PIOS_Queue_Peek(struct pios_queue *queuep, uint32_t timeout_ms);
+void PIOS_Queue_Release(struct pios_queue *queuep, void *itemp);
+
 #endif /* PIOS_QUEUE_H_ */
 
 /**
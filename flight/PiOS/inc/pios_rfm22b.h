@@ -81,6 +81,7 @@ struct rfm22b_stats {
 	int8_t rssi;
 	int8_t afc_correction;
 	uint8_t link_state;
+	uint32_t air_datarate;
 };
 
 /* Public Functions */
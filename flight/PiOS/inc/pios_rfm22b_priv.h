@@ -292,6 +292,26 @@ struct pios_rfm22b_dev {
 	bool packet_received_slice;
 	// Track consecutive sync packets that were missed
 	uint8_t sync_pulses_missed;
+	// The datarate lookup index currently on the air; datarate above is the
+	// configured one, which also sets the slot timing and channel count.
+	uint8_t air_datarate;
+	// The lowest datarate index that still leaves room for data in a slot
+	uint8_t min_air_datarate;
+	// The maximum packet length at air_datarate
+	uint8_t air_max_packet_len;
+	// A datarate change announced by the coordinator, and the hop cycle
+	// (modulo 16) both modems switch at
+	uint8_t pending_datarate;
+	uint8_t pending_cycle;
+	// The hop cycle the datarate was last looked at in
+	uint8_t adapt_last_cycle;
+	// Received packet counts since the coordinator last judged the link
+	uint8_t adapt_cycles;
+	uint8_t adapt_good;
+	uint8_t adapt_corrected;
+	uint8_t adapt_bad;
+	// Judgements to wait before trying a faster datarate again
+	uint8_t adapt_holdoff;
 };
 
 // External function definitions
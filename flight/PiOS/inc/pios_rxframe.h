@@ -0,0 +1,85 @@
+/**
+ ******************************************************************************
+ * @file       pios_rxframe.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_RxFrame Serial receiver frame assembly
+ * @{
+ * @brief Assembles serial receiver protocol frames from received spans
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef PIOS_RXFRAME_H
+#define PIOS_RXFRAME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * Describes the framing of a serial receiver protocol.  Protocols either
+ * start frames on a recognisable header (sync byte, length field) or, when
+ * gap_sync is set, only right after the line has been idle.
+ */
+struct pios_rxframe_proto {
+	/** Number of bytes needed before the frame length is known */
+	uint8_t header_len;
+
+	/**
+	 * Length of the frame that starts with header, including the header,
+	 * or 0 if header cannot start a frame.
+	 */
+	uint16_t (*frame_len)(const uint8_t *header);
+
+	/**
+	 * Check and decode a complete frame.
+	 * @returns true if the frame was good
+	 */
+	bool (*decode)(uintptr_t context, const uint8_t *frame, uint16_t len);
+
+	/** Frames only start after a gap, see PIOS_RxFrame_Gap */
+	bool gap_sync;
+};
+
+/** Frame assembly state; owned by the receiver driver */
+struct pios_rxframe {
+	const struct pios_rxframe_proto *proto;
+	uintptr_t context;
+	uint8_t *buf;
+	uint16_t buf_len;
+	uint16_t pos;
+	uint16_t expected;
+	bool armed;
+};
+
+void PIOS_RxFrame_Init(struct pios_rxframe *frame,
+		const struct pios_rxframe_proto *proto,
+		uint8_t *buf, uint16_t buf_len, uintptr_t context);
+int PIOS_RxFrame_Push(struct pios_rxframe *frame, const uint8_t *data,
+		uint16_t len);
+void PIOS_RxFrame_Gap(struct pios_rxframe *frame);
+bool PIOS_RxFrame_Idle(const struct pios_rxframe *frame);
+
+#endif /* PIOS_RXFRAME_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -68,7 +68,10 @@ extern void PIOS_Servo_SetFraction(uint8_t servo, uint16_t fraction,
 
 extern void PIOS_Servo_PrepareForReset();
 extern void PIOS_Servo_Set(uint8_t servo, float position);
+extern void PIOS_Servo_PrepareUpdate(void);
 extern void PIOS_Servo_Update(void);
+extern void PIOS_Servo_SetBidirectional(bool enabled);
+extern bool PIOS_Servo_GetERPM(uint8_t servo, uint32_t *erpm);
 
 #endif /* PIOS_SERVO_H */
 
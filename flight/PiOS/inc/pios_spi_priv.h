@@ -34,10 +34,18 @@
 #include <pios.h>
 #include <pios_stm32.h>
 #include "pios_semaphore.h"
+#include "pios_mutex.h"
 
 struct pios_spi_dev {
 	const struct pios_spi_cfg *cfg;
+#if defined(PIOS_INCLUDE_RTOS)
+	/* A mutex, so a low priority holder inherits the priority of a
+	 * waiting sensor task instead of being preempted while it holds
+	 * the bus */
+	struct pios_mutex *busy;
+#else
 	struct pios_semaphore *busy;
+#endif
 };
 
 struct pios_spi_cfg {
@@ -27,6 +27,7 @@
 #define PIOS_FLASHFS_STREAMFS_H_
 
 #include <stdint.h>
+#include "pios_flash.h"
 
 /* fs_id here is actually the com driver ID, to avoid having to do too
  * much bookkeepin' */
@@ -37,6 +38,14 @@ int32_t PIOS_STREAMFS_MinFileId(uintptr_t fs_id);
 int32_t PIOS_STREAMFS_MaxFileId(uintptr_t fs_id);
 int32_t PIOS_STREAMFS_Close(uintptr_t fs_id);
 int32_t PIOS_STREAMFS_Read(uintptr_t fs_id, uint8_t *data, uint32_t len);
+int32_t PIOS_STREAMFS_Seek(uintptr_t fs_id, uint32_t offset);
+int32_t PIOS_STREAMFS_WriteIndex(uintptr_t fs_id, const uint8_t *record, uint32_t len);
+
+/* Random access to complete files, by partition rather than com handle */
+int32_t PIOS_STREAMFS_ReadAt(enum pios_flash_partition_labels partition_label,
+		uint32_t file_id, uint32_t offset, uint8_t *data, uint32_t len);
+int32_t PIOS_STREAMFS_ReadIndexAt(enum pios_flash_partition_labels partition_label,
+		uint32_t file_id, uint32_t offset, uint8_t *data, uint32_t len);
 
 
 #endif	/* PIOS_FLASHFS_STREAMFS_H_ */
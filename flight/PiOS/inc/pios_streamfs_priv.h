@@ -35,7 +35,8 @@
 struct streamfs_cfg {
 	uint32_t fs_magic;
 	uint32_t arena_size; /* The size chunk that is erased (must equal sector size) */
-	uint32_t write_size;  /* The size to buffer between writes */
+	uint32_t write_size;  /* The size to buffer between writes, the flash page size */
+	uint32_t index_size;  /* Bytes reserved before each arena's footer for index records, 0 for none */
 };
 
 int32_t PIOS_STREAMFS_Init(uintptr_t *fs_id, const struct streamfs_cfg *cfg, enum pios_flash_partition_labels partition_label);
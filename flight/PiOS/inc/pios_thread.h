@@ -71,11 +71,23 @@ void PIOS_Thread_Delete(struct pios_thread *threadp);
 uint32_t PIOS_Thread_Systime(void);
 void PIOS_Thread_Sleep(uint32_t time_ms);
 void PIOS_Thread_Sleep_Until(uint32_t *previous_ms, uint32_t increment_ms);
+#if !defined(PIOS_INCLUDE_CHIBIOS)
+/* No timer-compare wakeup under ChibiOS yet, only a busy-wait */
+void PIOS_Thread_Sleep_Until_uS(uint32_t *previous_raw, uint32_t increment_us);
+#endif
 uint32_t PIOS_Thread_Get_Stack_Usage(struct pios_thread *threadp);
 uint32_t PIOS_Thread_Get_Runtime(struct pios_thread *threadp);
+void PIOS_Thread_Set_Deadline(struct pios_thread *threadp, uint32_t deadline_us);
+uint32_t PIOS_Thread_Get_Max_Response(struct pios_thread *threadp, uint16_t *deadline_misses);
+uint8_t PIOS_Thread_Get_Peak_Load(void);
 void PIOS_Thread_Scheduler_Suspend(void);
 void PIOS_Thread_Scheduler_Resume(void);
 
+#if defined(DIAG_TASK_TRACE)
+void PIOS_Thread_Trace_Register(struct pios_thread *threadp, uint8_t id);
+int32_t PIOS_Thread_Trace_Read(uint32_t offset, uint8_t *buf, uint32_t len);
+#endif
+
 /*
  * The following functions are provided to assist with common thread timing uses
  */
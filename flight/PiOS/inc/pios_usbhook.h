@@ -62,8 +62,13 @@ extern void PIOS_USBHOOK_RegisterIfOps(uint8_t ifnum, struct pios_usb_ifops * if
 
 typedef bool (*pios_usbhook_epcb)(uintptr_t context, uint8_t epnum, uint16_t len);
 
-extern void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uintptr_t context);
-extern void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, pios_usbhook_epcb cb, uintptr_t context);
+enum pios_usbhook_ep_type {
+	PIOS_USBHOOK_EP_INTERRUPT,
+	PIOS_USBHOOK_EP_BULK,
+};
+
+extern void PIOS_USBHOOK_RegisterEpInCallback(uint8_t epnum, uint16_t max_len, enum pios_usbhook_ep_type type, pios_usbhook_epcb cb, uintptr_t context);
+extern void PIOS_USBHOOK_RegisterEpOutCallback(uint8_t epnum, uint16_t max_len, enum pios_usbhook_ep_type type, pios_usbhook_epcb cb, uintptr_t context);
 extern void PIOS_USBHOOK_DeRegisterEpInCallback(uint8_t epnum);
 extern void PIOS_USBHOOK_DeRegisterEpOutCallback(uint8_t epnum);
 
@@ -49,6 +49,8 @@ int PIOS_WS2811_init(ws2811_dev_t *dev_out,
 /**
  * @brief Trigger an update of the LED strand
  * @param[in] dev WS2811 device handle
+ *
+ * Does nothing if no LED changed colour since the last update.
  */
 void PIOS_WS2811_trigger_update(ws2811_dev_t dev);
 
@@ -33,6 +33,7 @@ int32_t TaskMonitorInitialize(void);
 int32_t TaskMonitorAdd(TaskInfoRunningElem task, struct pios_thread *handlep);
 int32_t TaskMonitorRemove(TaskInfoRunningElem task);
 bool TaskMonitorQueryRunning(TaskInfoRunningElem task);
+int32_t TaskMonitorSetDeadline(TaskInfoRunningElem task, uint32_t deadline_us);
 void TaskMonitorUpdateAll(void);
 
 #endif // TASKMONITOR_H
@@ -198,6 +198,7 @@
 #include <pios_modules.h>
 
 #include <pios_crc.h>
+#include <pios_rxframe.h>
 
 #define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
 #define DONT_BUILD_IF(COND,MSG) typedef char static_assertion_##MSG[(COND)?-1:1]
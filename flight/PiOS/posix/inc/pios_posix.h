@@ -35,6 +35,13 @@
 #define FILEINFO FILE*
 
 #define PIOS_SERVO_NUM_OUTPUTS 8
+
+/* Virtual time, for running in lockstep with a simulator */
+void PIOS_DELAY_SetLockstep(void);
+bool PIOS_DELAY_IsLockstep(void);
+uint32_t PIOS_DELAY_GetVirtualmS(void);
+void PIOS_DELAY_AdvanceVirtual(uint32_t uS);
+void PIOS_DELAY_WaitVirtual(uint32_t raw);
 #define PIOS_SERVO_NUM_TIMERS PIOS_SERVO_NUM_OUTPUTS
 
 #if (defined(_WIN32) || defined(WIN32) || defined(__MINGW32__))
@@ -0,0 +1,56 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_reactor_priv.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief      Shared receive thread for the posix COM devices
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_REACTOR Reactor
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef PIOS_REACTOR_PRIV_H
+#define PIOS_REACTOR_PRIV_H
+
+#include <pios.h>
+
+//! Most file descriptors the reactor watches
+#define PIOS_REACTOR_MAX_FDS 32
+
+/**
+ * Called from the reactor thread when a file descriptor is readable, hung
+ * up or in error.  It should read once, without blocking, and remove the
+ * descriptor once it is done with it.
+ */
+typedef void (*pios_reactor_cb)(int fd, void *ctx);
+
+int32_t PIOS_Reactor_Add(int fd, pios_reactor_cb cb, void *ctx);
+void PIOS_Reactor_Remove(int fd);
+
+#endif /* PIOS_REACTOR_PRIV_H */
+
+/**
+ * @}
+ * @}
+ */
@@ -33,6 +33,7 @@
 #include "time.h"
 
 #include <time.h>
+#include <pthread.h>
 
 /**
  * This is the value used as a base.  Strictly not required, as times
@@ -41,6 +42,15 @@
  */
 static uint32_t base_time;
 
+/**
+ * In lockstep mode time is virtual, and only moves when the simulator
+ * steps it.  Waiting threads are woken on each step.
+ */
+static bool lockstep;
+static uint64_t virtual_time;
+static pthread_mutex_t virtual_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t virtual_step = PTHREAD_COND_INITIALIZER;
+
 #ifdef DRONIN_GETTIME
 int clock_gettime(clockid_t clk_id, struct timespec *t)
 {
@@ -115,6 +125,11 @@ int32_t PIOS_DELAY_Init(void)
 */
 int32_t PIOS_DELAY_WaituS(uint32_t uS)
 {
+	if (lockstep) {
+		PIOS_DELAY_WaitVirtual(PIOS_DELAY_GetRaw() + uS);
+		return 0;
+	}
+
 	struct timespec wait,rest;
 	wait.tv_sec=0;
 	wait.tv_nsec=1000*uS;
@@ -139,6 +154,11 @@ int32_t PIOS_DELAY_WaituS(uint32_t uS)
 */
 int32_t PIOS_DELAY_WaitmS(uint32_t mS)
 {
+	if (lockstep) {
+		PIOS_DELAY_WaitVirtual(PIOS_DELAY_GetRaw() + mS * 1000);
+		return 0;
+	}
+
 	struct timespec wait,rest;
 	wait.tv_sec=mS/1000;
 	wait.tv_nsec=(mS%1000)*1000000;
@@ -152,6 +172,10 @@ int32_t PIOS_DELAY_WaitmS(uint32_t mS)
 
 uint32_t PIOS_DELAY_GetRaw()
 {
+	if (lockstep) {
+		return (uint32_t) __atomic_load_n(&virtual_time, __ATOMIC_ACQUIRE);
+	}
+
 	uint32_t raw_us = get_monotonic_us_time() - base_time;
 	return raw_us;
 }
@@ -166,3 +190,57 @@ uint32_t PIOS_DELAY_DiffuS2(uint32_t raw, uint32_t later) {
 	return diff;
 }
 
+uint32_t PIOS_DELAY_uSToRaw(uint32_t uS)
+{
+	return uS;
+}
+
+/**
+ * Switch to virtual time, for running in lockstep with a simulator.  Must
+ * be done before anything is started.
+ */
+void PIOS_DELAY_SetLockstep(void)
+{
+	lockstep = true;
+}
+
+bool PIOS_DELAY_IsLockstep(void)
+{
+	return lockstep;
+}
+
+/**
+ * Virtual time in ms, which takes as long to wrap as the thread time of
+ * the flight controllers
+ */
+uint32_t PIOS_DELAY_GetVirtualmS(void)
+{
+	return __atomic_load_n(&virtual_time, __ATOMIC_ACQUIRE) / 1000;
+}
+
+/**
+ * Move virtual time on by a simulation step, waking the threads whose
+ * wait is over
+ * \param[in] uS length of the step
+ */
+void PIOS_DELAY_AdvanceVirtual(uint32_t uS)
+{
+	pthread_mutex_lock(&virtual_lock);
+	__atomic_store_n(&virtual_time, virtual_time + uS, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&virtual_step);
+	pthread_mutex_unlock(&virtual_lock);
+}
+
+/**
+ * Wait until virtual time reaches a raw time
+ * \param[in] raw time to wait for, as from PIOS_DELAY_GetRaw
+ */
+void PIOS_DELAY_WaitVirtual(uint32_t raw)
+{
+	pthread_mutex_lock(&virtual_lock);
+	while ((int32_t) (raw - (uint32_t) virtual_time) > 0) {
+		pthread_cond_wait(&virtual_step, &virtual_lock);
+	}
+	pthread_mutex_unlock(&virtual_lock);
+}
+
@@ -53,6 +53,9 @@
 #define INVALID_SOCKET (-1)
 #endif
 
+/* Time a packet stands for in lockstep mode, the ~3ms of the sample rate */
+#define FLIGHTGEAR_STEP_US 3000
+
 struct flightgear_dev {
 	int socket;
 
@@ -134,6 +137,14 @@ static void PIOS_FLIGHTGEAR_RxTask(void *param)
 			PIOS_Queue_Send(fg_dev->accel_queue, &accel_data, 0);
 			PIOS_Queue_Send(fg_dev->gyro_queue, &gyro_data, 0);
 
+			/* In lockstep each packet is one sample and one step of
+			 * time; nothing happens until the simulator sends the
+			 * next, however long it takes. */
+			if (PIOS_DELAY_IsLockstep()) {
+				PIOS_DELAY_AdvanceVirtual(FLIGHTGEAR_STEP_US);
+				break;
+			}
+
 			fd_set r;
 
 			FD_ZERO(&r);
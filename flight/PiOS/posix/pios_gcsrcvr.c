@@ -109,6 +109,7 @@ static void gcsreceiver_updated(UAVObjEvent * ev, void *ctx, void *obj,
 	if (ev->obj == GCSReceiverHandle()) {
 		GCSReceiverGet(&gcsreceiverdata);
 		gcsrcvr_dev->Fresh = true;
+		PIOS_RCVR_Active();
 	}
 }
 
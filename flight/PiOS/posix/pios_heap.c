@@ -81,6 +81,61 @@ size_t PIOS_fastheap_get_free_size(void)
 	return 0;
 }
 
+/*
+ * Block pools.  The host heap is good enough here, so blocks come straight
+ * from malloc and only the statistics are kept.
+ */
+struct pios_heap_pool {
+	size_t block_size;
+
+	struct pios_heap_pool_stats stats;
+};
+
+struct pios_heap_pool *PIOS_heap_pool_create(size_t block_size,
+		uint16_t blocks_per_region, bool fast)
+{
+	struct pios_heap_pool *pool = PIOS_malloc(sizeof(*pool));
+
+	if (pool == NULL)
+		return NULL;
+
+	*pool = (struct pios_heap_pool) {
+		.block_size = block_size,
+	};
+
+	return pool;
+}
+
+void *PIOS_heap_pool_alloc(struct pios_heap_pool *pool)
+{
+	void *buf = PIOS_malloc(pool->block_size);
+
+	if (buf != NULL) {
+		pool->stats.in_use++;
+		if (pool->stats.in_use > pool->stats.peak)
+			pool->stats.peak = pool->stats.in_use;
+		if (pool->stats.in_use > pool->stats.capacity)
+			pool->stats.capacity = pool->stats.in_use;
+	}
+
+	return buf;
+}
+
+void PIOS_heap_pool_free(struct pios_heap_pool *pool, void *buf)
+{
+	if (buf == NULL)
+		return;
+
+	pool->stats.in_use--;
+	free(buf);
+}
+
+void PIOS_heap_pool_get_stats(struct pios_heap_pool *pool,
+		struct pios_heap_pool_stats *stats)
+{
+	*stats = pool->stats;
+}
+
 /**
  * @}
  * @}
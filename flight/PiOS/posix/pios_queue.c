@@ -25,12 +25,16 @@
 
 #include <pthread.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <circqueue.h>
 
 #include <pios_queue.h>
 #include <pios_thread.h>
 
+/* Slots a producer and a consumer may hold beyond the queue length */
+#define QUEUE_MAX_WAITERS 2
+
 struct pios_queue {
 #define QUEUE_MAGIC 75657551	/* 'Queu' */
 	uint32_t magic;
@@ -41,7 +45,12 @@ struct pios_queue {
 	uint16_t item_size;
 	uint16_t q_len;
 
+	/* Pointers to items, in order of sending */
 	circ_queue_t queue;
+
+	/* Pointers to free item slots */
+	circ_queue_t pool;
+	void *slots;
 };
 
 struct pios_queue *PIOS_Queue_Create(size_t queue_length, size_t item_size)
@@ -71,9 +80,13 @@ struct pios_queue *PIOS_Queue_Create(size_t queue_length, size_t item_size)
 	q->item_size = item_size;
 	q->q_len = queue_length;
 
-	q->queue = circ_queue_new(item_size, queue_length+1);
+	uint16_t num_slots = queue_length + QUEUE_MAX_WAITERS;
+
+	q->queue = circ_queue_new(sizeof(void *), queue_length+1);
+	q->pool = circ_queue_new(sizeof(void *), num_slots+1);
+	q->slots = PIOS_malloc(item_size * num_slots);
 
-	if (!q->queue) {
+	if (!q->queue || !q->pool || !q->slots) {
 		pthread_mutex_destroy(&q->mutex);
 		pthread_cond_destroy(&q->cond);
 
@@ -81,6 +94,12 @@ struct pios_queue *PIOS_Queue_Create(size_t queue_length, size_t item_size)
 		return NULL;
 	}
 
+	for (int i = 0; i < num_slots; i++) {
+		void *slot = (uint8_t *)q->slots + i * item_size;
+
+		circ_queue_write_data(q->pool, &slot, 1);
+	}
+
 	q->magic = QUEUE_MAGIC;
 
 	return q;
@@ -98,44 +117,45 @@ void PIOS_Queue_Delete(struct pios_queue *queuep)
 	free(queuep);
 }
 
-bool PIOS_Queue_Send(struct pios_queue *queuep,
-		const void *itemp, uint32_t timeout_ms)
+static void queue_deadline(struct timespec *abstime, uint32_t timeout_ms)
 {
-	PIOS_Assert(queuep->magic == QUEUE_MAGIC);
+	clock_gettime(CLOCK_REALTIME, abstime);
 
-	struct timespec abstime;
+	abstime->tv_nsec += (timeout_ms % 1000) * 1000000;
+	abstime->tv_sec += timeout_ms / 1000;
 
+	if (abstime->tv_nsec > 1000000000) {
+		abstime->tv_nsec -= 1000000000;
+		abstime->tv_sec += 1;
+	}
+}
+
+/* Waits for the queue to change; false on timeout.  Mutex must be held. */
+static bool queue_wait(struct pios_queue *queuep, uint32_t timeout_ms,
+		const struct timespec *abstime)
+{
 	if (timeout_ms != PIOS_QUEUE_TIMEOUT_MAX) {
-		clock_gettime(CLOCK_REALTIME, &abstime);
+		return !pthread_cond_timedwait(&queuep->cond,
+				&queuep->mutex, abstime);
+	}
 
-		abstime.tv_nsec += (timeout_ms % 1000) * 1000000;
-		abstime.tv_sec += timeout_ms / 1000;
+	pthread_cond_wait(&queuep->cond, &queuep->mutex);
 
-		if (abstime.tv_nsec > 1000000000) {
-			abstime.tv_nsec -= 1000000000;
-			abstime.tv_sec += 1;
-		}
-	}
+	return true;
+}
 
-	pthread_mutex_lock(&queuep->mutex);
+bool PIOS_Queue_Send(struct pios_queue *queuep,
+		const void *itemp, uint32_t timeout_ms)
+{
+	void *slot = PIOS_Queue_Reserve(queuep);
 
-	while (!circ_queue_write_data(queuep->queue, itemp, 1)) {
-		if (timeout_ms != PIOS_QUEUE_TIMEOUT_MAX) {
-			if (pthread_cond_timedwait(&queuep->cond,
-					&queuep->mutex, &abstime)) {
-				pthread_mutex_unlock(&queuep->mutex);
-				return false;
-			}
-		} else {
-			pthread_cond_wait(&queuep->cond, &queuep->mutex);
-		}
+	if (!slot) {
+		return false;
 	}
 
-	pthread_cond_broadcast(&queuep->cond);
-
-	pthread_mutex_unlock(&queuep->mutex);
+	memcpy(slot, itemp, queuep->item_size);
 
-	return true;
+	return PIOS_Queue_Commit(queuep, slot, timeout_ms);
 }
 
 bool PIOS_Queue_Send_FromISR(struct pios_queue *queuep,
@@ -152,34 +172,82 @@ bool PIOS_Queue_Send_FromISR(struct pios_queue *queuep,
 
 bool PIOS_Queue_Receive(struct pios_queue *queuep,
 		void *itemp, uint32_t timeout_ms)
+{
+	void *slot = PIOS_Queue_Peek(queuep, timeout_ms);
+
+	if (!slot) {
+		return false;
+	}
+
+	memcpy(itemp, slot, queuep->item_size);
+
+	PIOS_Queue_Release(queuep, slot);
+
+	return true;
+}
+
+void *PIOS_Queue_Reserve(struct pios_queue *queuep)
+{
+	PIOS_Assert(queuep->magic == QUEUE_MAGIC);
+
+	void *slot;
+
+	pthread_mutex_lock(&queuep->mutex);
+
+	if (!circ_queue_read_data(queuep->pool, &slot, 1)) {
+		slot = NULL;
+	}
+
+	pthread_mutex_unlock(&queuep->mutex);
+
+	return slot;
+}
+
+bool PIOS_Queue_Commit(struct pios_queue *queuep,
+		void *itemp, uint32_t timeout_ms)
 {
 	PIOS_Assert(queuep->magic == QUEUE_MAGIC);
 
 	struct timespec abstime;
 
 	if (timeout_ms != PIOS_QUEUE_TIMEOUT_MAX) {
-		clock_gettime(CLOCK_REALTIME, &abstime);
+		queue_deadline(&abstime, timeout_ms);
+	}
 
-		abstime.tv_nsec += (timeout_ms % 1000) * 1000000;
-		abstime.tv_sec += timeout_ms / 1000;
+	pthread_mutex_lock(&queuep->mutex);
 
-		if (abstime.tv_nsec > 1000000000) {
-			abstime.tv_nsec -= 1000000000;
-			abstime.tv_sec += 1;
+	while (!circ_queue_write_data(queuep->queue, &itemp, 1)) {
+		if (!queue_wait(queuep, timeout_ms, &abstime)) {
+			circ_queue_write_data(queuep->pool, &itemp, 1);
+			pthread_mutex_unlock(&queuep->mutex);
+			return false;
 		}
 	}
 
+	pthread_cond_broadcast(&queuep->cond);
+
+	pthread_mutex_unlock(&queuep->mutex);
+
+	return true;
+}
+
+void *PIOS_Queue_Peek(struct pios_queue *queuep, uint32_t timeout_ms)
+{
+	PIOS_Assert(queuep->magic == QUEUE_MAGIC);
+
+	struct timespec abstime;
+	void *slot;
+
+	if (timeout_ms != PIOS_QUEUE_TIMEOUT_MAX) {
+		queue_deadline(&abstime, timeout_ms);
+	}
+
 	pthread_mutex_lock(&queuep->mutex);
 
-	while (!circ_queue_read_data(queuep->queue, itemp, 1)) {
-		if (timeout_ms != PIOS_QUEUE_TIMEOUT_MAX) {
-			if (pthread_cond_timedwait(&queuep->cond,
-					&queuep->mutex, &abstime)) {
-				pthread_mutex_unlock(&queuep->mutex);
-				return false;
-			}
-		} else {
-			pthread_cond_wait(&queuep->cond, &queuep->mutex);
+	while (!circ_queue_read_data(queuep->queue, &slot, 1)) {
+		if (!queue_wait(queuep, timeout_ms, &abstime)) {
+			pthread_mutex_unlock(&queuep->mutex);
+			return NULL;
 		}
 	}
 
@@ -187,7 +255,18 @@ bool PIOS_Queue_Receive(struct pios_queue *queuep,
 
 	pthread_mutex_unlock(&queuep->mutex);
 
-	return true;
+	return slot;
+}
+
+void PIOS_Queue_Release(struct pios_queue *queuep, void *itemp)
+{
+	PIOS_Assert(queuep->magic == QUEUE_MAGIC);
+
+	pthread_mutex_lock(&queuep->mutex);
+
+	circ_queue_write_data(queuep->pool, &itemp, 1);
+
+	pthread_mutex_unlock(&queuep->mutex);
 }
 
 /**
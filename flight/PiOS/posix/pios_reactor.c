@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_reactor.c
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief      Shared receive thread for the posix COM devices
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup PIOS PIOS Core hardware abstraction layer
+ * @{
+ * @addtogroup PIOS_REACTOR Reactor
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+/* Project Includes */
+#include "pios.h"
+
+#include <pios_reactor_priv.h>
+#include "pios_thread.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * One thread polls every descriptor the COM devices receive on, instead of
+ * a blocking thread per device; a simulation with many ports, or many
+ * simulations on one host, would otherwise mostly be switching between
+ * receive threads.
+ */
+
+struct reactor_entry {
+	int fd;
+	pios_reactor_cb cb;
+	void *ctx;
+};
+
+static pthread_mutex_t reactor_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct reactor_entry entries[PIOS_REACTOR_MAX_FDS];
+static int num_entries;
+
+/* Bumped whenever the entries change, so a round of callbacks on a stale
+ * copy stops */
+static uint32_t generation;
+
+/* Written to get the thread out of poll when the entries change */
+static int wake_pipe[2] = { -1, -1 };
+
+static struct pios_thread *reactor_thread;
+
+static void wake_reactor(void)
+{
+	uint8_t b = 0;
+
+	/* Nonblocking; if the pipe is full, a wake up is pending anyway */
+	if (write(wake_pipe[1], &b, 1) < 0) {
+		return;
+	}
+}
+
+/**
+ * ReactorTask
+ */
+static void PIOS_Reactor_Task(void *unused)
+{
+	(void) unused;
+
+	struct reactor_entry polled[PIOS_REACTOR_MAX_FDS];
+	struct pollfd fds[PIOS_REACTOR_MAX_FDS + 1];
+
+	while (1) {
+		pthread_mutex_lock(&reactor_lock);
+		int num_polled = num_entries;
+		uint32_t polled_generation = generation;
+		memcpy(polled, entries, num_polled * sizeof(polled[0]));
+		pthread_mutex_unlock(&reactor_lock);
+
+		fds[0].fd = wake_pipe[0];
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+
+		for (int i = 0; i < num_polled; i++) {
+			fds[i + 1].fd = polled[i].fd;
+			fds[i + 1].events = POLLIN;
+			fds[i + 1].revents = 0;
+		}
+
+		if (poll(fds, num_polled + 1, -1) < 0) {
+			if (errno != EINTR) {
+				perror("poll");
+				PIOS_Thread_Sleep(1);
+			}
+
+			continue;
+		}
+
+		if (fds[0].revents) {
+			uint8_t drain[16];
+
+			while (read(wake_pipe[0], drain, sizeof(drain)) > 0);
+		}
+
+		for (int i = 0; i < num_polled; i++) {
+			if (!fds[i + 1].revents) {
+				continue;
+			}
+
+			pthread_mutex_lock(&reactor_lock);
+			bool stale = generation != polled_generation;
+			pthread_mutex_unlock(&reactor_lock);
+
+			/* Anything still ready is seen again on the next poll */
+			if (stale) {
+				break;
+			}
+
+			polled[i].cb(polled[i].fd, polled[i].ctx);
+		}
+	}
+}
+
+/**
+ * Watch a file descriptor, starting the reactor thread on first use.
+ * @param[in] fd descriptor to wait for input on
+ * @param[in] cb called from the reactor thread when there is
+ * @param[in] ctx passed to the callback
+ * @return 0 if success or -1 if failure
+ */
+int32_t PIOS_Reactor_Add(int fd, pios_reactor_cb cb, void *ctx)
+{
+	pthread_mutex_lock(&reactor_lock);
+
+	if (!reactor_thread) {
+		if (pipe(wake_pipe)) {
+			perror("pipe");
+			pthread_mutex_unlock(&reactor_lock);
+			return -1;
+		}
+
+		fcntl(wake_pipe[0], F_SETFL, O_NONBLOCK);
+		fcntl(wake_pipe[1], F_SETFL, O_NONBLOCK);
+
+		reactor_thread = PIOS_Thread_Create(PIOS_Reactor_Task,
+				"pios_reactor", PIOS_THREAD_STACK_SIZE_MIN, NULL,
+				PIOS_THREAD_PRIO_HIGHEST);
+
+		if (!reactor_thread) {
+			close(wake_pipe[0]);
+			close(wake_pipe[1]);
+			pthread_mutex_unlock(&reactor_lock);
+			return -1;
+		}
+	}
+
+	if (num_entries >= PIOS_REACTOR_MAX_FDS) {
+		pthread_mutex_unlock(&reactor_lock);
+		return -1;
+	}
+
+	entries[num_entries].fd = fd;
+	entries[num_entries].cb = cb;
+	entries[num_entries].ctx = ctx;
+	num_entries++;
+	generation++;
+
+	pthread_mutex_unlock(&reactor_lock);
+
+	wake_reactor();
+
+	return 0;
+}
+
+/**
+ * Stop watching a file descriptor.  Once this returns from within a
+ * callback, the callback won't be called for it again.
+ * @param[in] fd descriptor passed to PIOS_Reactor_Add
+ */
+void PIOS_Reactor_Remove(int fd)
+{
+	pthread_mutex_lock(&reactor_lock);
+
+	for (int i = 0; i < num_entries; i++) {
+		if (entries[i].fd == fd) {
+			entries[i] = entries[--num_entries];
+			generation++;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&reactor_lock);
+
+	wake_reactor();
+}
+
+/**
+ * @}
+ * @}
+ */
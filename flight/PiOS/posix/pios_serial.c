@@ -38,7 +38,7 @@
 #if defined(PIOS_INCLUDE_SERIAL)
 
 #include <pios_serial_priv.h>
-#include "pios_thread.h"
+#include <pios_reactor_priv.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <errno.h>
@@ -81,32 +81,33 @@ static pios_ser_dev * find_ser_dev_by_id(uintptr_t serial)
 }
 
 /**
- * RxTask
+ * Pass what arrived straight on to the COM layer
  */
-static void PIOS_SERIAL_RxTask(void *ser_dev_n)
+static void PIOS_SERIAL_Receive(int fd, void *ser_dev_n)
 {
 	pios_ser_dev *ser_dev = (pios_ser_dev*)ser_dev_n;
 
-	const int INCOMING_BUFFER_SIZE = 16;
-	char incoming_buffer[INCOMING_BUFFER_SIZE];
+	int result = read(fd, ser_dev->rx_buffer, PIOS_SERIAL_RX_BUFFER_SIZE);
 
-	while (1) {
-		int result = read(ser_dev->fd, incoming_buffer, INCOMING_BUFFER_SIZE);
-
-		if (result > 0 && ser_dev->rx_in_cb) {
+	if (result > 0) {
+		if (ser_dev->rx_in_cb) {
 			bool rx_need_yield = false;
 
-			ser_dev->rx_in_cb(ser_dev->rx_in_context, (uint8_t*)incoming_buffer, result, NULL, &rx_need_yield);
+			ser_dev->rx_in_cb(ser_dev->rx_in_context, ser_dev->rx_buffer, result, NULL, &rx_need_yield);
 		}
 
-		if (result == 0) {
-			break;
-		}
+		return;
+	}
 
-		if (result == -1) {
-			PIOS_Thread_Sleep(1);
-		}
+	if (result == -1 && (errno == EAGAIN || errno == EINTR)) {
+		return;
 	}
+
+	if (result == -1) {
+		perror("serial-read");
+	}
+
+	PIOS_Reactor_Remove(fd);
 }
 
 /**
@@ -130,8 +131,11 @@ int32_t PIOS_SERIAL_Init(uintptr_t *serial_id, const char *path)
 		return -1;
 	}
 
-	PIOS_Thread_Create(PIOS_SERIAL_RxTask, "pios_serial_rx",
-		PIOS_THREAD_STACK_SIZE_MIN, ser_dev, PIOS_THREAD_PRIO_HIGHEST);
+	if (PIOS_Reactor_Add(ser_dev->fd, PIOS_SERIAL_Receive, ser_dev)) {
+		fprintf(stderr, "Can't watch serial port\n");
+		close(ser_dev->fd);
+		return -1;
+	}
 
 	printf("serial dev %p - path %s - fd %i opened\n", ser_dev,
 		path, ser_dev->fd);
@@ -79,6 +79,13 @@ void PIOS_Servo_Set(uint8_t servo, float position)
 	}
 }
 
+/**
+* Get synchronous outputs ready to go; nothing to do here
+*/
+void PIOS_Servo_PrepareUpdate(void)
+{
+}
+
 /**
 * Update the timer for HPWM/OneShot
 */
@@ -92,4 +99,13 @@ void PIOS_Servo_Update(void)
 void PIOS_Servo_PrepareForReset() {
 }
 
+void PIOS_Servo_SetBidirectional(bool enabled)
+{
+}
+
+bool PIOS_Servo_GetERPM(uint8_t servo, uint32_t *erpm)
+{
+	return false;
+}
+
 #endif
@@ -98,11 +98,13 @@ uintptr_t external_i2c_adapter_id;
 #endif
 
 static void Usage(char *cmdName) {
-	printf( "usage: %s [-f] [-r] [-m orientation] [-s spibase] [-d drvname:bus:id]\n"
+	printf( "usage: %s [-f] [-r] [-L] [-m orientation] [-s spibase] [-d drvname:bus:id]\n"
 		"\t\t[-l logfile] [-I i2cdev] [-i drvname:bus] [-g port]"
 		"\n"
 		"\t-f\tEnables floating point exception trapping mode\n"
 		"\t-r\tGoes realtime-class and pins all memory (requires root)\n"
+		"\t-L\tRuns in lockstep with the simulator; time only moves\n"
+		"\t\tas the simulator steps it\n"
 		"\t-l log\tWrites simulation data to a log\n"
 		"\t-g port\tStarts FlightGear driver on port\n"
 #ifdef PIOS_INCLUDE_SERIAL
@@ -443,7 +445,7 @@ void PIOS_SYS_Args(int argc, char *argv[]) {
 
 	bool first_arg = true;
 
-	while ((opt = getopt(argc, argv, "frg:l:s:d:S:I:i:")) != -1) {
+	while ((opt = getopt(argc, argv, "frLg:l:s:d:S:I:i:")) != -1) {
 		switch (opt) {
 			case 'f':
 				debug_fpe = true;
@@ -456,6 +458,14 @@ void PIOS_SYS_Args(int argc, char *argv[]) {
 
 				go_realtime();
 				break;
+			case 'L':
+				if (!first_arg) {
+					printf("Lockstep must be before hw\n");
+					exit(1);
+				}
+
+				PIOS_DELAY_SetLockstep();
+				break;
 			case 'l':
 			{
 				uintptr_t tmp;
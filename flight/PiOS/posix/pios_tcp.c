@@ -39,7 +39,7 @@
 #if defined(PIOS_INCLUDE_TCP)
 
 #include <pios_tcp_priv.h>
-#include "pios_thread.h"
+#include <pios_reactor_priv.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <errno.h>
@@ -87,75 +87,77 @@ static pios_tcp_dev * find_tcp_dev_by_id(uintptr_t tcp)
 	return (pios_tcp_dev *) tcp;
 }
 
+static void PIOS_TCP_Receive(int fd, void *tcp_dev_n);
+
 /**
- * RxTask
+ * Take a connection; one is served at a time, the others wait in the
+ * backlog until it is closed
  */
-static void PIOS_TCP_RxTask(void *tcp_dev_n)
+static void PIOS_TCP_Accept(int fd, void *tcp_dev_n)
 {
 	pios_tcp_dev *tcp_dev = (pios_tcp_dev*)tcp_dev_n;
-	
-	const int INCOMING_BUFFER_SIZE = 16;
-	char incoming_buffer[INCOMING_BUFFER_SIZE];
-	int error;
 
-	while (1) {
-	
-		do
-		{
-			tcp_dev->socket_connection = accept(tcp_dev->socket, NULL, NULL);
-			error = errno;
-
-			PIOS_Thread_Sleep(1);
-		} while (tcp_dev->socket_connection == INVALID_SOCKET && (error == EINTR || error == EAGAIN));
-
-		if (tcp_dev->socket_connection < 0) {
-			int error = errno;
-			(void)error;
-			perror("Accept failed");
-			close(tcp_dev->socket);
-			exit(EXIT_FAILURE);
-		}
+	int connection = accept(fd, NULL, NULL);
 
-		fprintf(stderr, "Connection accepted\n");
+	if (connection == INVALID_SOCKET) {
+		int error = errno;
 
-		while (1) {
-			// Received is used to track the scoket whereas the dev variable is only updated when it can be
+		if (error == EINTR || error == EAGAIN || error == ECONNABORTED)
+			return;
 
-			int result = recv(tcp_dev->socket_connection, (char *) incoming_buffer, INCOMING_BUFFER_SIZE, 0);
-			error = errno;
+		perror("Accept failed");
+		close(tcp_dev->socket);
+		exit(EXIT_FAILURE);
+	}
 
-			if (result > 0 && tcp_dev->rx_in_cb) {
+	fprintf(stderr, "Connection accepted\n");
 
-				bool rx_need_yield = false;
+	PIOS_Reactor_Remove(tcp_dev->socket);
 
-				tcp_dev->rx_in_cb(tcp_dev->rx_in_context, (uint8_t*)incoming_buffer, result, NULL, &rx_need_yield);
+	tcp_dev->socket_connection = connection;
 
-			}
+	if (PIOS_Reactor_Add(connection, PIOS_TCP_Receive, tcp_dev)) {
+		fprintf(stderr, "Can't watch connection\n");
+		tcp_dev->socket_connection = INVALID_SOCKET;
+		close(connection);
+		PIOS_Reactor_Add(tcp_dev->socket, PIOS_TCP_Accept, tcp_dev);
+	}
+}
 
-			if (result == 0) {
-				break;
-			}
+/**
+ * Pass what arrived on the connection straight on to the COM layer
+ */
+static void PIOS_TCP_Receive(int fd, void *tcp_dev_n)
+{
+	pios_tcp_dev *tcp_dev = (pios_tcp_dev*)tcp_dev_n;
 
-			if (result == -1) {
-				if (error == EAGAIN)
-					PIOS_Thread_Sleep(1);
-				else if (error == EINTR)
-					(void)error;
-				else
-					break;
-			}
+	int result = recv(fd, (char *) tcp_dev->rx_buffer, PIOS_TCP_RX_BUFFER_SIZE, 0);
+
+	if (result > 0) {
+		if (tcp_dev->rx_in_cb) {
+			bool rx_need_yield = false;
+
+			tcp_dev->rx_in_cb(tcp_dev->rx_in_context, tcp_dev->rx_buffer, result, NULL, &rx_need_yield);
 		}
-		
-		close(tcp_dev->socket_connection);
-		tcp_dev->socket_connection = INVALID_SOCKET;
+
+		return;
 	}
+
+	if (result == -1 && (errno == EAGAIN || errno == EINTR))
+		return;
+
+	// Closed or failed; go back to waiting for a connection
+	PIOS_Reactor_Remove(fd);
+	tcp_dev->socket_connection = INVALID_SOCKET;
+	close(fd);
+
+	PIOS_Reactor_Add(tcp_dev->socket, PIOS_TCP_Accept, tcp_dev);
 }
 
 
 /**
  * Open TCP socket
  */
-struct pios_thread *tcpRxTaskHandle;
 int32_t PIOS_TCP_Init(uintptr_t *tcp_id, const struct pios_tcp_cfg * cfg)
 {
 	pios_tcp_dev *tcp_dev = PIOS_malloc(sizeof(pios_tcp_dev));
@@ -205,8 +207,10 @@ int32_t PIOS_TCP_Init(uintptr_t *tcp_id, const struct pios_tcp_cfg * cfg)
 		exit(EXIT_FAILURE);
 	}
 	
-	tcpRxTaskHandle = PIOS_Thread_Create(
-			PIOS_TCP_RxTask, "pios_tcp_rx", PIOS_THREAD_STACK_SIZE_MIN, tcp_dev, PIOS_THREAD_PRIO_HIGHEST);
+	if (PIOS_Reactor_Add(tcp_dev->socket, PIOS_TCP_Accept, tcp_dev)) {
+		fprintf(stderr, "Can't watch socket\n");
+		exit(EXIT_FAILURE);
+	}
 	
 	printf("tcp dev %p - socket %i opened - result %i\n", tcp_dev, tcp_dev->socket, res);
 	
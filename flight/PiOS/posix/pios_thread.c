@@ -24,7 +24,9 @@
  */
 
 
+#include <errno.h>
 #include <pthread.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <pios.h>
@@ -100,6 +102,10 @@ void PIOS_Thread_Delete(struct pios_thread *threadp)
 
 uint32_t PIOS_Thread_Systime(void)
 {
+	if (PIOS_DELAY_IsLockstep()) {
+		return PIOS_DELAY_GetVirtualmS();
+	}
+
 	struct timespec monotime;
 
 	clock_gettime(CLOCK_MONOTONIC, &monotime);
@@ -123,6 +129,11 @@ void PIOS_Thread_Sleep(uint32_t time_ms)
 		}
 	}
 
+	if (PIOS_DELAY_IsLockstep()) {
+		PIOS_DELAY_WaitVirtual(PIOS_DELAY_GetRaw() + 1000 * time_ms);
+		return;
+	}
+
 	usleep(1000 * time_ms);
 }
 
@@ -142,6 +153,59 @@ void PIOS_Thread_Sleep_Until(uint32_t *previous_ms, uint32_t increment_ms)
 	}
 }
 
+/**
+ * Sleep for a regular interval given in microseconds; raw delay time is
+ * in microseconds here.
+ */
+void PIOS_Thread_Sleep_Until_uS(uint32_t *previous_raw, uint32_t increment_us)
+{
+	*previous_raw += increment_us;
+
+	uint32_t now = PIOS_DELAY_GetRaw();
+
+	uint32_t us = *previous_raw - now;
+
+	if (us > increment_us) {
+		// Late; if very late or wrapped, restart the timebase.
+		if (now - *previous_raw > increment_us) {
+			*previous_raw = now;
+		}
+
+		return;
+	}
+
+	if (PIOS_DELAY_IsLockstep()) {
+		PIOS_DELAY_WaitVirtual(*previous_raw);
+		return;
+	}
+
+#if defined(__linux__)
+	// An absolute wake time doesn't drift when interrupted
+	struct timespec wake;
+
+	clock_gettime(CLOCK_MONOTONIC, &wake);
+
+	wake.tv_sec += us / 1000000;
+	wake.tv_nsec += (us % 1000000) * 1000;
+
+	if (wake.tv_nsec >= 1000000000) {
+		wake.tv_sec++;
+		wake.tv_nsec -= 1000000000;
+	}
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR);
+#else
+	struct timespec wait, rest;
+
+	wait.tv_sec = us / 1000000;
+	wait.tv_nsec = (us % 1000000) * 1000;
+
+	while (nanosleep(&wait, &rest)) {
+		wait = rest;
+	}
+#endif
+}
+
 uint32_t PIOS_Thread_Get_Stack_Usage(struct pios_thread *threadp)
 {
 	return 0;	/* XXX */
@@ -152,6 +216,23 @@ uint32_t PIOS_Thread_Get_Runtime(struct pios_thread *threadp)
 	return 0;	/* XXX */
 }
 
+void PIOS_Thread_Set_Deadline(struct pios_thread *threadp, uint32_t deadline_us)
+{
+}
+
+uint32_t PIOS_Thread_Get_Max_Response(struct pios_thread *threadp,
+		uint16_t *deadline_misses)
+{
+	*deadline_misses = 0;
+
+	return 0;	/* XXX */
+}
+
+uint8_t PIOS_Thread_Get_Peak_Load(void)
+{
+	return 0;	/* XXX */
+}
+
 /**
   * @}
   * @}
@@ -36,6 +36,7 @@
 #define UAVOBJECTMANAGER_H
 
 #include "pios_queue.h"
+#include "pios_heap.h"
 
 #define UAVOBJ_ALL_INSTANCES 0xFFFF
 #define UAVOBJ_MAX_INSTANCES 1000
@@ -150,6 +151,8 @@ void UAVObjRegisterNewInstanceCB(new_uavo_instance_cb_t callback);
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats* statsOut);
 void UAVObjClearStats();
+void UAVObjGetPoolStats(struct pios_heap_pool_stats *events,
+		struct pios_heap_pool_stats *throttled);
 UAVObjHandle UAVObjRegister(uint32_t id,
 		int32_t isSingleInstance, int32_t isSettings, uint32_t numBytes, UAVObjInitializeCallback initCb);
 UAVObjHandle UAVObjGetByID(uint32_t id);
@@ -164,6 +167,10 @@ bool UAVObjIsSettings(UAVObjHandle obj);
 int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId, const uint8_t* dataIn);
 int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t* dataOut);
 int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId);
+int32_t UAVObjSaveListById(const uint32_t *obj_ids, uint16_t num_objs);
+int32_t UAVObjSaveDeferred(UAVObjHandle obj_handle, uint16_t instId);
+int32_t UAVObjDeferredSavesDueIn();
+int32_t UAVObjFlushDeferredSaves();
 int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId);
 int32_t UAVObjDeleteById(uint32_t obj_id, uint16_t inst_id);
 #if defined(PIOS_INCLUDE_SDCARD)
@@ -184,6 +191,8 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj_handle, uint16_t instId, const vo
 int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, const void* dataIn, uint32_t offset, uint32_t size);
 int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId, void* dataOut);
 int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, void* dataOut, uint32_t offset, uint32_t size);
+uint32_t UAVObjGetInstanceDataChanges(UAVObjHandle obj_handle, uint16_t instId, void *dataOut, const uint16_t *fieldSizes, uint16_t numFields);
+uint32_t UAVObjGetDataCRC(UAVObjHandle obj_handle);
 int32_t UAVObjSetMetadata(UAVObjHandle obj_handle, const UAVObjMetadata* dataIn);
 int32_t UAVObjGetMetadata(UAVObjHandle obj_handle, UAVObjMetadata* dataOut);
 uint8_t UAVObjGetMetadataAccess(const UAVObjMetadata* dataOut);
@@ -48,6 +48,9 @@ $(PARENT_INCLUDES)
 #define $(NAMEUC)_ISSINGLEINST $(ISSINGLEINST)
 #define $(NAMEUC)_ISSETTINGS $(ISSETTINGS)
 #define $(NAMEUC)_NUMBYTES $(NUMBYTES)
+#define $(NAMEUC)_NUMFIELDS $(NUMFIELDS)
+//! Size of each field in packed order, for partial object frames
+#define $(NAMEUC)_FIELDSIZES { $(FIELDSIZES) }
 
 // Generic interface functions
 int32_t $(NAME)Initialize();
@@ -86,6 +89,18 @@ static inline int32_t $(NAME)ConnectCopy(volatile $(NAME)Data *dataOut) {
 	return UAVObjConnectCallback($(NAME)Handle(), UAVObjCbCopyData, (void *)dataOut, EV_MASK_ALL_UPDATES);
 }
 
+/**
+ * @function $(NAME)GetChanges(dataOut)
+ * @brief Bring a copy of the object up to date
+ * @param[in,out] dataOut copy to update
+ * @returns FIELDBITs of the fields that differed from the copy
+ */
+static inline uint32_t $(NAME)GetChanges($(NAME)Data *dataOut) {
+	static const uint16_t sizes[] = $(NAMEUC)_FIELDSIZES;
+
+	return UAVObjGetInstanceDataChanges($(NAME)Handle(), 0, dataOut, sizes, $(NAMEUC)_NUMFIELDS);
+}
+
 static inline uint16_t $(NAME)CreateInstance() { return UAVObjCreateInstance($(NAME)Handle(), &$(NAME)SetDefaults); }
 
 static inline void $(NAME)Updated() { UAVObjUpdated($(NAME)Handle()); }
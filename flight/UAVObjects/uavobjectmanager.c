@@ -67,6 +67,7 @@ struct ObjectEventEntry {
 	UAVObjEventCallback       cb;
 	uint8_t                   hasThrottle : 1;
 	uint8_t                   eventMask : 7;
+	uint8_t                   throttledAlloc : 1; // from throttled_event_pool
 	struct ObjectEventEntry * next;
 };
 
@@ -128,6 +129,10 @@ struct UAVOData {
 struct UAVOSingle {
 	struct UAVOData   uavo;
 
+	/* Odd while the instance data is written; lets readers skip the
+	 * global lock, see readSingleLockless() */
+	volatile uint32_t seq __attribute__((aligned(4)));
+
 	uint8_t           instance0[];
 	/* 
 	 * Additional space will be malloc'd here to hold the
@@ -150,6 +155,12 @@ struct UAVOMulti {
 	struct UAVOData        uavo;
 
 	uint16_t               num_instances;
+
+	/* Instances by ID, for lookups without walking the list.  NULL
+	 * until a second instance is created. */
+	uint16_t               instances_cap;
+	struct UAVOMultiInst ** instances;
+
 	struct UAVOMultiInst   instance0;
 	/*
 	 * Additional space will be malloc'd here to hold the
@@ -173,21 +184,37 @@ struct UAVOMulti {
 #define InstanceDataOffset(inst) ((void*)&(( (struct UAVOMultiInst*)inst )->instance))
 #define InstanceData(instance) (void*)instance
 
+/** single instance data objects can be read without the lock **/
+#define IsLocklessObject(obj) (!(obj)->flags.isMeta && (obj)->flags.isSingle)
+
+//! Lockless reads tried before waiting on the lock for a busy writer
+#define LOCKLESS_READ_TRIES 2
+
 // Private functions
 static int32_t sendEvent(struct UAVOBase * obj, uint16_t instId,
 			UAVObjEventType event, void *obj_data, int len);
 static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId);
 static InstanceHandle getInstance(struct UAVOData * obj, uint16_t instId);
+static void beginWrite(UAVObjHandle obj_handle);
+static void endWrite(UAVObjHandle obj_handle);
+static bool readSingleLockless(UAVObjHandle obj_handle, void *dataOut,
+			uint32_t offset, uint32_t size);
 static int32_t connectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 			UAVObjEventCallback cb, void *cbCtx, uint8_t eventMask,
 			uint16_t interval);
 static int32_t disconnectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 			UAVObjEventCallback cb, void *cbCtx);
+static int32_t saveList(const uint32_t *obj_ids, const uint16_t *inst_ids,
+			uint16_t num_objs);
 
 // Private variables
 static struct UAVOData * uavo_list;
-static struct ObjectEventEntry * events_unused;
-static struct ObjectEventEntry * events_unused_throttled;
+/* Registered objects sorted by ID, for UAVObjGetByID */
+static struct UAVOData ** uavo_by_id;
+static uint16_t uavo_by_id_len;
+static uint16_t uavo_by_id_cap;
+static struct pios_heap_pool * event_pool;
+static struct pios_heap_pool * throttled_event_pool;
 static struct pios_recursive_mutex *mutex;
 static const UAVObjMetadata defMetadata = {
 	.flags = (ACCESS_READWRITE << UAVOBJ_ACCESS_SHIFT |
@@ -206,6 +233,10 @@ static new_uavo_instance_cb_t newUavObjInstanceCB;
 
 #define UAVO_CB_STACK_SIZE 512
 
+/* Event entries are walked on every object update, so keep them in
+ * fast memory */
+#define UAVO_EVENT_POOL_REGION 8
+
 static void *cb_stack;
 
 /**
@@ -217,8 +248,18 @@ int32_t UAVObjInitialize()
 {
 	// Initialize variables
 	uavo_list = NULL;
-	events_unused = NULL;
-	events_unused_throttled = NULL;
+	uavo_by_id = NULL;
+	uavo_by_id_len = 0;
+	uavo_by_id_cap = 0;
+
+	event_pool = PIOS_heap_pool_create(sizeof(struct ObjectEventEntry),
+			UAVO_EVENT_POOL_REGION, true);
+	throttled_event_pool = PIOS_heap_pool_create(
+			sizeof(struct ObjectEventEntryThrottled),
+			UAVO_EVENT_POOL_REGION, true);
+
+	if (!event_pool || !throttled_event_pool)
+		return -1;
 
 	// Allocate the stack used for callbacks.
 	cb_stack = PIOS_malloc_no_dma(UAVO_CB_STACK_SIZE);
@@ -253,6 +294,18 @@ void UAVObjGetStats(UAVObjStats * statsOut)
 	PIOS_Recursive_Mutex_Unlock(mutex);
 }
 
+/**
+ * Get the usage of the event entry pools
+ * @param[out] events pool of unthrottled event entries
+ * @param[out] throttled pool of throttled event entries
+ */
+void UAVObjGetPoolStats(struct pios_heap_pool_stats *events,
+		struct pios_heap_pool_stats *throttled)
+{
+	PIOS_heap_pool_get_stats(event_pool, events);
+	PIOS_heap_pool_get_stats(throttled_event_pool, throttled);
+}
+
 /**
  * Clear the statistics counters
  */
@@ -296,6 +349,8 @@ static struct UAVOData * UAVObjAllocSingle(uint32_t num_bytes)
 	uavo_base->flags.isSingle = true;
 	uavo_base->next_event     = NULL;
 
+	uavo_single->seq = 0;
+
 	/* Clear the instance data carried in the UAVO */
 	memset(&(uavo_single->instance0), 0, num_bytes);
 
@@ -321,6 +376,8 @@ static struct UAVOData * UAVObjAllocMulti(uint32_t num_bytes)
 
 	/* Set up the type-specific part of the UAVO */
 	uavo_multi->num_instances = 1;
+	uavo_multi->instances_cap = 0;
+	uavo_multi->instances = NULL;
 
 	/* Clear the instance data carried in the UAVO */
 	uavo_multi->instance0.next = NULL;
@@ -330,6 +387,52 @@ static struct UAVOData * UAVObjAllocMulti(uint32_t num_bytes)
 	return (&(uavo_multi->uavo));
 }
 
+/**
+ * Find where an ID is, or would go, in the table of objects by ID
+ * \return index of the first object with an ID not below id
+ */
+static uint16_t UAVObjIndexOf(uint32_t id)
+{
+	uint16_t lo = 0;
+	uint16_t hi = uavo_by_id_len;
+
+	while (lo < hi) {
+		uint16_t mid = lo + (hi - lo) / 2;
+
+		if (uavo_by_id[mid]->id < id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * Make room for one more object in the table of objects by ID.  The heap
+ * may not give memory back, so the table grows by doubling.
+ * \return true if there is room
+ */
+static bool UAVObjIndexReserve()
+{
+	if (uavo_by_id_len < uavo_by_id_cap)
+		return true;
+
+	uint16_t cap = uavo_by_id_cap ? uavo_by_id_cap * 2 : 32;
+	struct UAVOData **table = PIOS_malloc_no_dma(cap * sizeof(*table));
+	if (!table)
+		return false;
+
+	if (uavo_by_id_len)
+		memcpy(table, uavo_by_id, uavo_by_id_len * sizeof(*table));
+
+	PIOS_free(uavo_by_id);
+	uavo_by_id = table;
+	uavo_by_id_cap = cap;
+
+	return true;
+}
+
 /**************************
  * UAVObject Database APIs
  *************************/
@@ -357,6 +460,9 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 	if (UAVObjGetByID(id))
 		goto unlock_exit;
 
+	if (!UAVObjIndexReserve())
+		goto unlock_exit;
+
 	/* Map the various flags to one of the UAVO types we understand */
 	if (isSingleInstance) {
 		uavo_data = UAVObjAllocSingle (num_bytes);
@@ -380,6 +486,12 @@ UAVObjHandle UAVObjRegister(uint32_t id,
 	/* Add the newly created object to the global list of objects */
 	LL_APPEND(uavo_list, uavo_data);
 
+	uint16_t index = UAVObjIndexOf(id);
+	memmove(&uavo_by_id[index + 1], &uavo_by_id[index],
+		(uavo_by_id_len - index) * sizeof(*uavo_by_id));
+	uavo_by_id[index] = uavo_data;
+	uavo_by_id_len++;
+
 	/* Initialize object fields and metadata to default values */
 	if (initCb)
 		initCb((UAVObjHandle) uavo_data, 0);
@@ -413,19 +525,15 @@ UAVObjHandle UAVObjGetByID(uint32_t id)
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	// Look for object
-	struct UAVOData * tmp_obj;
-	LL_FOREACH(uavo_list, tmp_obj) {
-		if (tmp_obj->id == id) {
-			found_obj = &tmp_obj->base;
-			goto unlock_exit;
-		}
-		if (MetaObjectId(tmp_obj->id) == id) {
-			found_obj = &(tmp_obj->metaObj.base);
-			goto unlock_exit;
-		}
+	uint16_t index = UAVObjIndexOf(id);
+
+	if (index < uavo_by_id_len && uavo_by_id[index]->id == id) {
+		found_obj = &uavo_by_id[index]->base;
+	} else if (index > 0 && MetaObjectId(uavo_by_id[index - 1]->id) == id) {
+		// The one before has the next lower ID, its metaobject may match
+		found_obj = &uavo_by_id[index - 1]->metaObj.base;
 	}
 
-unlock_exit:
 	PIOS_Recursive_Mutex_Unlock(mutex);
 	return found_obj;
 }
@@ -633,7 +741,6 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
 
 		target = MetaDataPtr((struct UAVOMeta *)obj_handle);
 		len = MetaNumBytes;
-		memcpy(MetaDataPtr((struct UAVOMeta *)obj_handle), dataIn, MetaNumBytes);
 	} else {
 		struct UAVOData *obj;
 		InstanceHandle instEntry;
@@ -657,7 +764,9 @@ int32_t UAVObjUnpack(UAVObjHandle obj_handle, uint16_t instId,
 		len = obj->instance_size;
 	}
 
+	beginWrite(obj_handle);
 	memcpy(target, dataIn, len);
+	endWrite(obj_handle);
 
 	// Fire event
 	sendEvent((struct UAVOBase*)obj_handle, instId, EV_UNPACKED,
@@ -681,6 +790,17 @@ int32_t UAVObjPack(UAVObjHandle obj_handle, uint16_t instId, uint8_t * dataOut)
 {
 	PIOS_Assert(obj_handle);
 
+	if (IsLocklessObject(obj_handle)) {
+		if (instId != 0) {
+			return -1;
+		}
+
+		if (readSingleLockless(obj_handle, dataOut, 0,
+				((struct UAVOData *)obj_handle)->instance_size)) {
+			return 0;
+		}
+	}
+
 	// Lock
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
@@ -724,6 +844,63 @@ unlock_exit:
 static uint8_t uavobj_save_trampoline[256] __attribute__((aligned(4)));
 #endif	/* PIOS_INCLUDE_FASTHEAP */
 
+//! Most objects UAVObjSaveListById writes in one filesystem transaction
+#define UAVOBJ_SAVE_BATCH_LEN 8
+
+//! Most saves UAVObjSaveDeferred holds; beyond that they are written at once
+#define UAVOBJ_DEFERRED_SAVES_LEN 16
+//! How long deferred saves are held back to collect repeats, in ms
+#define UAVOBJ_DEFERRED_SAVE_DELAY 1000
+
+static struct {
+	uint32_t obj_id;
+	uint16_t inst_id;
+} deferred_saves[UAVOBJ_DEFERRED_SAVES_LEN];
+static uint8_t num_deferred_saves;
+static uint32_t deferred_since;
+
+/**
+ * Get the data of an object instance as it is persisted.
+ * @param[in] obj The object handle.
+ * @param[in] instId The instance ID
+ * @return pointer to the data or NULL if there is no such instance
+ */
+static uint8_t *persistedData(UAVObjHandle obj_handle, uint16_t instId)
+{
+	if (UAVObjIsMetaobject(obj_handle)) {
+		if (instId != 0)
+			return NULL;
+
+		return (uint8_t *) MetaDataPtr((struct UAVOMeta *)obj_handle);
+	}
+
+	InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
+
+	if (instEntry == NULL)
+		return NULL;
+
+	return InstanceData(instEntry);
+}
+
+/**
+ * Forget a deferred save of an object instance, e.g. because it is
+ * written right away.
+ */
+static void dropDeferredSave(uint32_t obj_id, uint16_t inst_id)
+{
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	for (int i = 0; i < num_deferred_saves; i++) {
+		if (deferred_saves[i].obj_id == obj_id &&
+				deferred_saves[i].inst_id == inst_id) {
+			deferred_saves[i] = deferred_saves[--num_deferred_saves];
+			break;
+		}
+	}
+
+	PIOS_Recursive_Mutex_Unlock(mutex);
+}
+
 /**
  * Save the data of the specified object to the file system (SD card).
  * If the object contains multiple instances, all of them will be saved.
@@ -738,68 +915,205 @@ int32_t UAVObjSave(UAVObjHandle obj_handle, uint16_t instId)
 {
 	PIOS_Assert(obj_handle);
 
-	if (UAVObjIsMetaobject(obj_handle)) {
-		if (instId != 0)
-			return -1;
+	dropDeferredSave(UAVObjGetID(obj_handle), instId);
+
+	uint8_t *data = persistedData(obj_handle, instId);
 
-		// Save the object to the filesystem
-		int32_t rc;
+	if (data == NULL)
+		return -1;
+
+	// Save the object to the filesystem
+	int32_t rc;
 #if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(uavobj_save_trampoline,
-			MetaDataPtr((struct UAVOMeta *)obj_handle),
-			UAVObjGetNumBytes(obj_handle));
-
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					uavobj_save_trampoline,
-					UAVObjGetNumBytes(obj_handle));
+	memcpy(uavobj_save_trampoline, data, UAVObjGetNumBytes(obj_handle));
+
+	rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
+				UAVObjGetID(obj_handle),
+				instId,
+				uavobj_save_trampoline,
+				UAVObjGetNumBytes(obj_handle));
 #else /* PIOS_INCLUDE_FASTHEAP */
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					(uint8_t*) MetaDataPtr((struct UAVOMeta *)obj_handle),
-					UAVObjGetNumBytes(obj_handle));
+	rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
+				UAVObjGetID(obj_handle),
+				instId,
+				data,
+				UAVObjGetNumBytes(obj_handle));
 #endif  /* PIOS_INCLUDE_FASTHEAP */
 
-		if (rc != 0)
-			return -1;
-	} else {
-		InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
+	if (rc != 0)
+		return -1;
 
-		if (instEntry == NULL)
-			return -1;
+	return 0;
+}
 
-		if (InstanceData(instEntry) == NULL)
-			return -1;
+/**
+ * Save instance 0 of each of a list of objects to the file system.
+ * The objects are written a few at a time, each batch in one filesystem
+ * transaction; on platforms with a fast heap a batch is also limited to what
+ * fits in the save trampoline.
+ * @param[in] obj_ids The object IDs.
+ * @param[in] num_objs Number of IDs
+ * @return 0 if success or -1 if failure, e.g. for an unknown object
+ */
+int32_t UAVObjSaveListById(const uint32_t *obj_ids, uint16_t num_objs)
+{
+	return saveList(obj_ids, NULL, num_objs);
+}
 
-		// Save the object to the filesystem
-		int32_t rc;
+/**
+ * Save a list of object instances, see UAVObjSaveListById.
+ * @param[in] obj_ids The object IDs.
+ * @param[in] inst_ids The instance of each object, NULL for instance 0
+ * @param[in] num_objs Number of IDs
+ * @return 0 if success or -1 if failure
+ */
+static int32_t saveList(const uint32_t *obj_ids, const uint16_t *inst_ids,
+		uint16_t num_objs)
+{
+	struct pios_flashfs_obj objs[UAVOBJ_SAVE_BATCH_LEN];
+
+	while (num_objs > 0) {
+		uint16_t batch_len = 0;
 #if defined(PIOS_INCLUDE_FASTHEAP)
-		memcpy(uavobj_save_trampoline,
-			InstanceData(instEntry),
-			UAVObjGetNumBytes(obj_handle));
-
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					uavobj_save_trampoline,
-					UAVObjGetNumBytes(obj_handle));
-#else /* PIOS_INCLUDE_FASTHEAP */
-		rc = PIOS_FLASHFS_ObjSave(pios_uavo_settings_fs_id,
-					UAVObjGetID(obj_handle),
-					instId,
-					InstanceData(instEntry),
-					UAVObjGetNumBytes(obj_handle));
-#endif  /* PIOS_INCLUDE_FASTHEAP */
+		uint32_t offset = 0;
+#endif	/* PIOS_INCLUDE_FASTHEAP */
+
+		while (batch_len < num_objs && batch_len < UAVOBJ_SAVE_BATCH_LEN) {
+			UAVObjHandle obj_handle = UAVObjGetByID(obj_ids[batch_len]);
+
+			if (obj_handle == NULL)
+				return -1;
+
+			uint16_t inst_id = inst_ids ? inst_ids[batch_len] : 0;
+			uint8_t *data = persistedData(obj_handle, inst_id);
 
-		if (rc != 0)
+			if (data == NULL)
+				return -1;
+
+			uint16_t size = UAVObjGetNumBytes(obj_handle);
+#if defined(PIOS_INCLUDE_FASTHEAP)
+			// The first always fits by itself
+			if (batch_len > 0 && offset + size > sizeof(uavobj_save_trampoline))
+				break;
+
+			memcpy(uavobj_save_trampoline + offset, data, size);
+			data = uavobj_save_trampoline + offset;
+			offset += (size + 3) & ~3;
+#endif	/* PIOS_INCLUDE_FASTHEAP */
+
+			objs[batch_len].obj_id = UAVObjGetID(obj_handle);
+			objs[batch_len].obj_inst_id = inst_id;
+			objs[batch_len].obj_size = size;
+			objs[batch_len].obj_data = data;
+			batch_len++;
+		}
+
+		if (PIOS_FLASHFS_ObjSaveList(pios_uavo_settings_fs_id, objs, batch_len) != 0)
 			return -1;
+
+		obj_ids += batch_len;
+		if (inst_ids)
+			inst_ids += batch_len;
+		num_objs -= batch_len;
 	}
 
 	return 0;
 }
 
+/**
+ * Save an object instance a little later, together with whatever else is
+ * saved meanwhile.  Repeated saves of the same instance are written once,
+ * with the data it has by then.  Meant for saves from a flight or UI loop,
+ * which shouldn't wait on the flash; the system task writes them out once
+ * UAVObjDeferredSavesDueIn says they are due, see UAVObjFlushDeferredSaves.
+ * @param[in] obj_handle The object handle.
+ * @param[in] instId The instance ID
+ * @return 0 if success or -1 if failure
+ */
+int32_t UAVObjSaveDeferred(UAVObjHandle obj_handle, uint16_t instId)
+{
+	PIOS_Assert(obj_handle);
+
+	uint32_t obj_id = UAVObjGetID(obj_handle);
+
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	for (int i = 0; i < num_deferred_saves; i++) {
+		if (deferred_saves[i].obj_id == obj_id &&
+				deferred_saves[i].inst_id == instId) {
+			PIOS_Recursive_Mutex_Unlock(mutex);
+			return 0;
+		}
+	}
+
+	if (num_deferred_saves < UAVOBJ_DEFERRED_SAVES_LEN) {
+		if (num_deferred_saves == 0)
+			deferred_since = PIOS_Thread_Systime();
+
+		deferred_saves[num_deferred_saves].obj_id = obj_id;
+		deferred_saves[num_deferred_saves].inst_id = instId;
+		num_deferred_saves++;
+
+		PIOS_Recursive_Mutex_Unlock(mutex);
+		return 0;
+	}
+
+	PIOS_Recursive_Mutex_Unlock(mutex);
+
+	// Nowhere to hold it
+	return UAVObjSave(obj_handle, instId);
+}
+
+/**
+ * Tell when the deferred saves should be written.
+ * @return ms until they are due, 0 if they are, or -1 if there are none
+ */
+int32_t UAVObjDeferredSavesDueIn()
+{
+	int32_t due_in = -1;
+
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	if (num_deferred_saves > 0) {
+		uint32_t held = PIOS_Thread_Systime() - deferred_since;
+
+		due_in = (held < UAVOBJ_DEFERRED_SAVE_DELAY) ?
+			UAVOBJ_DEFERRED_SAVE_DELAY - held : 0;
+	}
+
+	PIOS_Recursive_Mutex_Unlock(mutex);
+
+	return due_in;
+}
+
+/**
+ * Write out all deferred saves now, in as few filesystem transactions as
+ * they fit.  Saves deferred while this runs are held for the next flush.
+ * @return 0 if success or -1 if any failed
+ */
+int32_t UAVObjFlushDeferredSaves()
+{
+	uint32_t obj_ids[UAVOBJ_DEFERRED_SAVES_LEN];
+	uint16_t inst_ids[UAVOBJ_DEFERRED_SAVES_LEN];
+	uint16_t num_objs;
+
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	num_objs = num_deferred_saves;
+	for (int i = 0; i < num_objs; i++) {
+		obj_ids[i] = deferred_saves[i].obj_id;
+		inst_ids[i] = deferred_saves[i].inst_id;
+	}
+	num_deferred_saves = 0;
+
+	PIOS_Recursive_Mutex_Unlock(mutex);
+
+	if (num_objs == 0)
+		return 0;
+
+	return saveList(obj_ids, inst_ids, num_objs);
+}
+
 #if defined(PIOS_INCLUDE_FASTHEAP)
 /**
  * Trampoline buffer used for loads from the underlying filesystem.
@@ -824,10 +1138,14 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 
 	void *target;
 	int len;
+	int32_t rc = -1;
+
+	// Lock, the data may be changed underneath lockless readers
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
 	if (UAVObjIsMetaobject(obj_handle)) {
 		if (instId != 0)
-			return -1;
+			goto unlock_exit;
 
 		target = MetaDataPtr((struct UAVOMeta *)obj_handle);
 		len = UAVObjGetNumBytes(obj_handle);
@@ -836,14 +1154,13 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 		InstanceHandle instEntry = getInstance( (struct UAVOData *)obj_handle, instId);
 
 		if (instEntry == NULL)
-			return -1;
+			goto unlock_exit;
 
 		target = InstanceData(instEntry);
 		len = UAVObjGetNumBytes(obj_handle);
 	}
 
 	// Load the object from the filesystem
-	int32_t rc;
 #if defined(PIOS_INCLUDE_FASTHEAP)
 	rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
 			UAVObjGetID(obj_handle),
@@ -851,22 +1168,31 @@ int32_t UAVObjLoad(UAVObjHandle obj_handle, uint16_t instId)
 			uavobj_load_trampoline,
 			len);
 #else  /* PIOS_INCLUDE_FASTHEAP */
+	beginWrite(obj_handle);
 	rc = PIOS_FLASHFS_ObjLoad(pios_uavo_settings_fs_id,
 			UAVObjGetID(obj_handle),
 			instId,
 			target,
 			len);
+	endWrite(obj_handle);
 #endif  /* PIOS_INCLUDE_FASTHEAP */
 
-	if (rc != 0)
-		return -1;
+	if (rc != 0) {
+		rc = -1;
+		goto unlock_exit;
+	}
 
 #if defined(PIOS_INCLUDE_FASTHEAP)
+	beginWrite(obj_handle);
 	memcpy(target, uavobj_load_trampoline, len);
+	endWrite(obj_handle);
 #endif  /* PIOS_INCLUDE_FASTHEAP */
 
 	sendEvent((struct UAVOBase*)obj_handle, instId, EV_UNPACKED, target, len);
-	return 0;
+
+unlock_exit:
+	PIOS_Recursive_Mutex_Unlock(mutex);
+	return rc;
 }
 
 /**
@@ -1187,7 +1513,9 @@ int32_t UAVObjSetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, con
 	}
 
 	// Set data
+	beginWrite(obj_handle);
 	memcpy(target + offset, dataIn, size);
+	endWrite(obj_handle);
 
 	// Fire event
 	sendEvent((struct UAVOBase *)obj_handle, instId, EV_UPDATED,
@@ -1211,6 +1539,17 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj_handle, uint16_t instId,
 {
 	PIOS_Assert(obj_handle);
 
+	if (IsLocklessObject(obj_handle)) {
+		if (instId != 0) {
+			return -1;
+		}
+
+		if (readSingleLockless(obj_handle, dataOut, 0,
+				((struct UAVOData *)obj_handle)->instance_size)) {
+			return 0;
+		}
+	}
+
 	// Lock
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
@@ -1246,6 +1585,57 @@ unlock_exit:
 	return rc;
 }
 
+/**
+ * Refresh a copy of an object instance, noting which fields changed.
+ * Lets settings consumers redo only the work that depends on the changed
+ * fields, without keeping a second copy to compare against.
+ * \param[in] obj The object handle
+ * \param[in] instId The object instance ID
+ * \param[in,out] dataOut Copy of the instance data, brought up to date
+ * \param[in] fieldSizes Size of each field in packed order, from the
+ * object's generated FIELDSIZES
+ * \param[in] numFields Number of fields
+ * \return FIELDBIT mask of the changed fields.  Fields past the 32nd have
+ * no bit of their own, so if one of those changed all bits are set.
+ */
+uint32_t UAVObjGetInstanceDataChanges(UAVObjHandle obj_handle, uint16_t instId,
+		void *dataOut, const uint16_t *fieldSizes, uint16_t numFields)
+{
+	PIOS_Assert(obj_handle);
+	PIOS_Assert(!UAVObjIsMetaobject(obj_handle));
+
+	uint32_t changed = 0;
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	InstanceHandle instEntry = getInstance((struct UAVOData *) obj_handle,
+			instId);
+
+	if (instEntry == NULL) {
+		goto unlock_exit;
+	}
+
+	const uint8_t *src = InstanceData(instEntry);
+	uint8_t *dst = dataOut;
+
+	for (uint16_t i = 0; i < numFields; i++) {
+		uint16_t size = fieldSizes[i];
+
+		if (memcmp(dst, src, size)) {
+			memcpy(dst, src, size);
+			changed |= (i < 32) ? (1u << i) : 0xffffffff;
+		}
+
+		src += size;
+		dst += size;
+	}
+
+unlock_exit:
+	PIOS_Recursive_Mutex_Unlock(mutex);
+	return changed;
+}
+
 /**
  * Get the data of a specific object instance
  * \param[in] obj The object handle
@@ -1257,6 +1647,17 @@ int32_t UAVObjGetInstanceDataField(UAVObjHandle obj_handle, uint16_t instId, voi
 {
 	PIOS_Assert(obj_handle);
 
+	if (IsLocklessObject(obj_handle)) {
+		if (instId != 0 || (size + offset) >
+				((struct UAVOData *)obj_handle)->instance_size) {
+			return -1;
+		}
+
+		if (readSingleLockless(obj_handle, dataOut, offset, size)) {
+			return 0;
+		}
+	}
+
 	// Lock
 	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
 
@@ -1304,6 +1705,46 @@ unlock_exit:
 	return rc;
 }
 
+/**
+ * Compute a CRC32 over the data of all instances of an object, in instance
+ * order, without copying the data out of the object manager.
+ * \param[in] obj The object handle
+ * \return The CRC (PIOS_CRC32_updateCRC with a zero seed) of the data
+ */
+uint32_t UAVObjGetDataCRC(UAVObjHandle obj_handle)
+{
+	PIOS_Assert(obj_handle);
+
+	uint32_t crc = 0;
+
+	// Lock
+	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
+
+	if (UAVObjIsMetaobject(obj_handle)) {
+		crc = PIOS_CRC32_updateCRC(crc,
+				(uint8_t *) MetaDataPtr((struct UAVOMeta *)obj_handle),
+				MetaNumBytes);
+	} else {
+		struct UAVOData *obj = (struct UAVOData *) obj_handle;
+		uint16_t num_instances = UAVObjGetNumInstances(obj_handle);
+
+		for (uint16_t i = 0; i < num_instances; i++) {
+			InstanceHandle instEntry = getInstance(obj, i);
+
+			if (instEntry == NULL) {
+				break;
+			}
+
+			crc = PIOS_CRC32_updateCRC(crc, InstanceData(instEntry),
+					obj->instance_size);
+		}
+	}
+
+	PIOS_Recursive_Mutex_Unlock(mutex);
+
+	return crc;
+}
+
 /**
  * Set the object metadata
  * \param[in] obj The object handle
@@ -1498,6 +1939,19 @@ int8_t UAVObjReadOnly(UAVObjHandle obj_handle)
 	return -1;
 }
 
+/**
+ * Return an event entry to the pool it was allocated from
+ * \param[in] event The event entry, already unlinked from its object
+ */
+static void freeEvent(struct ObjectEventEntry *event)
+{
+	if (event->throttledAlloc) {
+		PIOS_heap_pool_free(throttled_event_pool, event);
+	} else {
+		PIOS_heap_pool_free(event_pool, event);
+	}
+}
+
 /**
  * Connect an event queue to the object, if the queue is already connected then the event mask is only updated.
  * All events matching the event mask will be pushed to the event queue.
@@ -1876,14 +2330,35 @@ static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 		}
 	}
 
+	struct UAVOMulti *uavo_multi = (struct UAVOMulti *) obj;
+
+	/* Make room in the table of instances, doubling it as the heap may
+	 * not give memory back */
+	if (instId >= uavo_multi->instances_cap) {
+		uint16_t cap = uavo_multi->instances_cap ? uavo_multi->instances_cap * 2 : 4;
+		struct UAVOMultiInst **table = PIOS_malloc_no_dma(cap * sizeof(*table));
+		if (!table)
+			return NULL;
+
+		if (uavo_multi->instances)
+			memcpy(table, uavo_multi->instances, instId * sizeof(*table));
+		else
+			table[0] = &uavo_multi->instance0;
+
+		PIOS_free(uavo_multi->instances);
+		uavo_multi->instances = table;
+		uavo_multi->instances_cap = cap;
+	}
+
 	/* Create the actual instance */
 	instEntry = (struct UAVOMultiInst *) PIOS_malloc_no_dma(sizeof(struct UAVOMultiInst)+obj->instance_size);
 	if (!instEntry)
 		return NULL;
 	memset(InstanceDataOffset(instEntry), 0, obj->instance_size);
-	LL_APPEND(( (struct UAVOMulti*)obj )->instance0.next, instEntry);
+	LL_APPEND(uavo_multi->instance0.next, instEntry);
 
-	( (struct UAVOMulti*)obj )->num_instances++;
+	uavo_multi->instances[instId] = instEntry;
+	uavo_multi->num_instances++;
 
 	// Fire event
 	UAVObjInstanceUpdated((UAVObjHandle) obj, instId);
@@ -1895,6 +2370,60 @@ static InstanceHandle createInstance(struct UAVOData * obj, uint16_t instId)
 	return InstanceDataOffset(instEntry);
 }
 
+/**
+ * Start changing the data of an object; the caller holds the lock, so there
+ * is a single writer.
+ */
+static void beginWrite(UAVObjHandle obj_handle)
+{
+	if (!IsLocklessObject(obj_handle))
+		return;
+
+	((struct UAVOSingle *)obj_handle)->seq++;
+	__sync_synchronize();
+}
+
+/**
+ * Done changing the data of an object
+ */
+static void endWrite(UAVObjHandle obj_handle)
+{
+	if (!IsLocklessObject(obj_handle))
+		return;
+
+	__sync_synchronize();
+	((struct UAVOSingle *)obj_handle)->seq++;
+}
+
+/**
+ * Copy out single instance data without the lock.  The copy is retried if a
+ * write went on meanwhile.  Gives up when the writer is busy, as it may be a
+ * lower priority task this one preempted; the caller then waits on the lock,
+ * which the writer holds.
+ * \return true if the data was copied
+ */
+static bool readSingleLockless(UAVObjHandle obj_handle, void *dataOut,
+			uint32_t offset, uint32_t size)
+{
+	struct UAVOSingle *obj = (struct UAVOSingle *)obj_handle;
+
+	for (int i = 0; i < LOCKLESS_READ_TRIES; i++) {
+		uint32_t seq = obj->seq;
+
+		if (seq & 1)
+			return false;
+
+		__sync_synchronize();
+		memcpy(dataOut, obj->instance0 + offset, size);
+		__sync_synchronize();
+
+		if (obj->seq == seq)
+			return true;
+	}
+
+	return false;
+}
+
 /**
  * Get the instance information or NULL if the instance does not exist
  */
@@ -1926,17 +2455,10 @@ static InstanceHandle getInstance(struct UAVOData * obj, uint16_t instId)
 		if (instId >= uavo_multi->num_instances)
 			return NULL;
 
-		// Look for specified instance ID
-		uint16_t instance = 0;
-		struct UAVOMultiInst *instEntry;
-		LL_FOREACH(&(uavo_multi->instance0), instEntry) {
-			if (instance++ == instId) {
-				/* Found it */
-				return &(instEntry->instance);
-			}
-		}
-		/* Instance was not found */
-		return NULL;
+		if (instId == 0)
+			return &(uavo_multi->instance0.instance);
+
+		return &(uavo_multi->instances[instId]->instance);
 	}
 }
 
@@ -1985,38 +2507,30 @@ static int32_t connectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 				}
 				else {
 					// We are changing the callback from unthrottled to throttled,
-					// need to allocate a new event (not ideal, as it leaks memory)
+					// need a throttled event in place of this one
 					LL_DELETE(obj->next_event, event);
+					freeEvent(event);
 					break;
 				}
 			}
 		}
 	}
 
-	int mallocSize = sizeof(*event);
-	struct ObjectEventEntry ** unused = &events_unused;
+	int allocSize = sizeof(*event);
+	struct pios_heap_pool *pool = event_pool;
 
 	if (interval) {
-		mallocSize = sizeof(*throttled);
-		unused = &events_unused_throttled;
+		allocSize = sizeof(*throttled);
+		pool = throttled_event_pool;
 	}
 
-	PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
-	if (*unused != NULL) {
-		// We can re-use the memory of a previously disconnected event
-		event = *unused;
-		LL_DELETE(*unused, event);
-	}
-	else {
-		event =	(struct ObjectEventEntry *) PIOS_malloc_no_dma(mallocSize);
-		if (event == NULL) {
-			PIOS_Recursive_Mutex_Unlock(mutex);
-			return -1;
-		}
+	event =	(struct ObjectEventEntry *) PIOS_heap_pool_alloc(pool);
+	if (event == NULL) {
+		return -1;
 	}
-	PIOS_Recursive_Mutex_Unlock(mutex);
 
-	memset(event, 0, mallocSize);
+	memset(event, 0, allocSize);
+	event->throttledAlloc = (interval != 0);
 	event->cb = cb;
 
 	if (!cb) {
@@ -2061,15 +2575,7 @@ static int32_t disconnectObj(UAVObjHandle obj_handle, struct pios_queue *queue,
 		if ((event->cb == cb && event->cbInfo.cbCtx == cbCtx) ||
 				((!event->cb) && event->cbInfo.queue == queue)) {
 			LL_DELETE(obj->next_event, event);
-			// store the unused memory for future reuse
-			PIOS_Recursive_Mutex_Lock(mutex, PIOS_MUTEX_TIMEOUT_MAX);
-			if (event->hasThrottle) {
-				LL_APPEND(events_unused_throttled, event);
-			}
-			else {
-				LL_APPEND(events_unused, event);
-			}
-			PIOS_Recursive_Mutex_Unlock(mutex);
+			freeEvent(event);
 			return 0;
 		}
 	}
@@ -45,6 +45,23 @@
 // Private variables
 static UAVObjHandle handle = NULL;
 
+// Default field values and metadata, kept in flash and copied from
+static const $(NAME)Data defaults = {
+$(INITFIELDS)};
+
+static const UAVObjMetadata defaultMetadata = {
+	.flags =
+		$(FLIGHTACCESS) << UAVOBJ_ACCESS_SHIFT |
+		$(GCSACCESS) << UAVOBJ_GCS_ACCESS_SHIFT |
+		$(FLIGHTTELEM_ACKED) << UAVOBJ_TELEMETRY_ACKED_SHIFT |
+		$(GCSTELEM_ACKED) << UAVOBJ_GCS_TELEMETRY_ACKED_SHIFT |
+		$(FLIGHTTELEM_UPDATEMODE) << UAVOBJ_TELEMETRY_UPDATE_MODE_SHIFT |
+		$(GCSTELEM_UPDATEMODE) << UAVOBJ_GCS_TELEMETRY_UPDATE_MODE_SHIFT,
+	.telemetryUpdatePeriod = $(FLIGHTTELEM_UPDATEPERIOD),
+	.gcsTelemetryUpdatePeriod = $(GCSTELEM_UPDATEPERIOD),
+	.loggingUpdatePeriod = $(LOGGING_UPDATEPERIOD),
+};
+
 /**
  * Initialize object.
  * \return 0 Success
@@ -71,30 +88,6 @@ int32_t $(NAME)Initialize(void)
 	}
 }
 
-static void $(NAME)SetDefaultsImpl(UAVObjHandle obj, uint16_t instId) {
-	// Initialize object fields to their default values
-	$(NAME)Data data = {};
-
-$(INITFIELDS)
-	UAVObjSetInstanceData(obj, instId, &data);
-}
-
-static void $(NAME)SetMetadataDefaults(UAVObjHandle obj) {
-	// Initialize object metadata to their default values
-	UAVObjMetadata metadata;
-	metadata.flags =
-		$(FLIGHTACCESS) << UAVOBJ_ACCESS_SHIFT |
-		$(GCSACCESS) << UAVOBJ_GCS_ACCESS_SHIFT |
-		$(FLIGHTTELEM_ACKED) << UAVOBJ_TELEMETRY_ACKED_SHIFT |
-		$(GCSTELEM_ACKED) << UAVOBJ_GCS_TELEMETRY_ACKED_SHIFT |
-		$(FLIGHTTELEM_UPDATEMODE) << UAVOBJ_TELEMETRY_UPDATE_MODE_SHIFT |
-		$(GCSTELEM_UPDATEMODE) << UAVOBJ_GCS_TELEMETRY_UPDATE_MODE_SHIFT;
-	metadata.telemetryUpdatePeriod = $(FLIGHTTELEM_UPDATEPERIOD);
-	metadata.gcsTelemetryUpdatePeriod = $(GCSTELEM_UPDATEPERIOD);
-	metadata.loggingUpdatePeriod = $(LOGGING_UPDATEPERIOD);
-	UAVObjSetMetadata(obj, &metadata);
-}
-
 /**
  * Initialize object fields and metadata with the default values.
  * If a default value is not specified the object fields
@@ -102,10 +95,10 @@ static void $(NAME)SetMetadataDefaults(UAVObjHandle obj) {
  */
 void $(NAME)SetDefaults(UAVObjHandle obj, uint16_t instId)
 {
-	$(NAME)SetDefaultsImpl(obj, instId);
+	UAVObjSetInstanceData(obj, instId, &defaults);
 
 	if (instId == 0) {
-		$(NAME)SetMetadataDefaults(obj);
+		UAVObjSetMetadata(obj, &defaultMetadata);
 	}
 }
 
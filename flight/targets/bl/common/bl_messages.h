@@ -50,6 +50,13 @@ enum bl_commands {
 	BL_MSG_WIPE_PARTITION,
 
 	BL_MSG_WRITE_START = 0x27,
+	/* Write start that erases sectors as they are written, sent only to
+	 * bootloaders advertising BL_CAP_FLAG_WINDOWED_WRITE */
+	BL_MSG_WRITE_START_WINDOWED = 0x28,
+	/* Delta writes, for bootloaders advertising BL_CAP_FLAG_DELTA_WRITE */
+	BL_MSG_SECTOR_CRC_REQ = 0x29,
+	BL_MSG_SECTOR_CRC_REP = 0x2A,
+	BL_MSG_WRITE_SEEK = 0x2B,
 };
 
 #define BL_MSG_FLAGS_ECHO_REQ 0x80
@@ -101,6 +108,10 @@ struct bl_messages {
 #define BL_CAP_EXTENSION_MAGIC 0x3456
 			uint16_t cap_extension_magic;
 			uint32_t partition_sizes[10];
+			/* Zero from bootloaders older than the flags */
+#define BL_CAP_FLAG_WINDOWED_WRITE 0x01
+#define BL_CAP_FLAG_DELTA_WRITE    0x02
+			uint8_t cap_flags;
 #endif	/* BL_INCLUDE_CAP_EXTENSIONS */
 		} cap_rep_specific;
 
@@ -145,7 +156,7 @@ struct bl_messages {
 		} status_req;
 
 		struct msg_status_rep {
-			uint32_t unused;
+			uint32_t additional_state; /* packets written, during writes */
 			uint8_t current_state;
 		} status_rep;
 
@@ -153,6 +164,18 @@ struct bl_messages {
 			enum dfu_partition_label label;
 		} wipe_partition;
 
+		struct msg_sector_crc {
+			uint32_t offset; /* any offset in the sector, its start in replies */
+			uint32_t size;   /* only used in replies, 0 if there is no such sector */
+			uint32_t crc;    /* only used in replies */
+			enum dfu_partition_label label;
+		} sector_crc;
+
+		struct msg_write_seek {
+			uint32_t offset; /* from the start of the partition */
+			uint32_t length; /* bytes written from offset on */
+		} write_seek;
+
 		uint8_t pad[62];
 	} __attribute__((aligned(1)))v;
 } __attribute__((packed));
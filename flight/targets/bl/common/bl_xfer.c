@@ -63,6 +63,58 @@ static uint32_t bl_compute_partition_crc(uintptr_t partition_id, uint32_t partit
 	return CRC_GetCRC();
 }
 
+static bool bl_sector_blank_p(uintptr_t partition_id, uint32_t partition_offset, uint32_t length)
+{
+	while (length) {
+		uint8_t buf[128];
+		uint32_t bytes_to_read = MIN(sizeof(buf), length);
+		PIOS_FLASH_read_data(partition_id,
+				partition_offset,
+				buf,
+				bytes_to_read);
+
+		for (uint32_t i = 0; i < bytes_to_read; i++) {
+			if (buf[i] != 0xFF)
+				return false;
+		}
+
+		partition_offset += bytes_to_read;
+		length           -= bytes_to_read;
+	}
+
+	return true;
+}
+
+/*
+ * Erase the sectors up to the one holding end_offset - 1, skipping blank ones.
+ * A sector that a seek landed in the middle of keeps its contents.
+ */
+static bool bl_xfer_erase_to(struct xfer_state * xfer, uint32_t end_offset)
+{
+	bool ok = true;
+
+	PIOS_FLASH_start_transaction(xfer->partition_id);
+	while (ok && xfer->erased_offset < end_offset) {
+		uint32_t sector_offset;
+		uint32_t sector_size;
+
+		if (PIOS_FLASH_get_sector_extents(xfer->partition_id, xfer->erased_offset,
+						&sector_offset, &sector_size) != 0) {
+			ok = false;
+			break;
+		}
+
+		if (sector_offset == xfer->erased_offset &&
+				!bl_sector_blank_p(xfer->partition_id, sector_offset, sector_size))
+			ok = (PIOS_FLASH_erase_range(xfer->partition_id, sector_offset, sector_size) == 0);
+
+		xfer->erased_offset = sector_offset + sector_size;
+	}
+	PIOS_FLASH_end_transaction(xfer->partition_id);
+
+	return ok;
+}
+
 bool bl_xfer_completed_p(const struct xfer_state * xfer)
 {
 	return (xfer->in_progress && (xfer->bytes_to_xfer == 0));
@@ -181,7 +233,7 @@ bool bl_xfer_send_next_read_packet(struct xfer_state * xfer)
 	return true;
 }
 
-bool bl_xfer_write_start(struct xfer_state * xfer, const struct msg_xfer_start *xfer_start)
+bool bl_xfer_write_start(struct xfer_state * xfer, const struct msg_xfer_start *xfer_start, bool erase_as_written)
 {
 	/* Disable any previous transfer */
 	xfer->in_progress = false;
@@ -241,8 +293,15 @@ bool bl_xfer_write_start(struct xfer_state * xfer, const struct msg_xfer_start *
 		return false;
 	}
 
-	/* Figure out if we need to erase the *selected* partition before writing to it */
-	if (partition_needs_erase) {
+	/*
+	 * Figure out if we need to erase the *selected* partition before writing to it.
+	 * When erasing as written, the host streams data while sectors are erased
+	 * on the way, and sectors that are already blank are left alone.
+	 */
+	xfer->erase_as_written = erase_as_written && partition_needs_erase;
+	xfer->erased_offset = xfer->original_partition_offset;
+
+	if (partition_needs_erase && !xfer->erase_as_written) {
 		PIOS_FLASH_start_transaction(xfer->partition_id);
 		int32_t ret = PIOS_FLASH_erase_partition(xfer->partition_id);
 		PIOS_FLASH_end_transaction(xfer->partition_id);
@@ -252,12 +311,49 @@ bool bl_xfer_write_start(struct xfer_state * xfer, const struct msg_xfer_start *
 
 	xfer->current_partition_offset = xfer->original_partition_offset;
 	xfer->bytes_to_xfer = bytes_to_xfer;
+	xfer->write_end = xfer->original_partition_offset + bytes_to_xfer;
 	xfer->next_packet_number = 0;
 	xfer->in_progress = true;
 
 	return true;
 }
 
+/*
+ * Skip ahead in a transfer that erases as written, leaving the skipped part of
+ * the partition as it is.  Packets after the seek write from the new offset on
+ * and are cut short at the end of the range given.
+ */
+bool bl_xfer_write_seek(struct xfer_state * xfer, const struct msg_write_seek *write_seek)
+{
+	if (!xfer->in_progress || !xfer->erase_as_written) {
+		return false;
+	}
+
+	uint32_t xfer_end = xfer->current_partition_offset + xfer->bytes_to_xfer;
+	uint32_t offset   = BE32_TO_CPU(write_seek->offset);
+	uint32_t length   = BE32_TO_CPU(write_seek->length);
+
+	if (offset > xfer_end - xfer->original_partition_offset) {
+		return false;
+	}
+	offset += xfer->original_partition_offset;
+
+	/* Only forwards, in whole words and within the transfer */
+	if ((offset < xfer->current_partition_offset) || (length > xfer_end - offset) ||
+			(offset % sizeof(uint32_t)) || (length % sizeof(uint32_t))) {
+		return false;
+	}
+
+	xfer->bytes_to_xfer -= offset - xfer->current_partition_offset;
+	xfer->current_partition_offset = offset;
+	xfer->write_end = offset + length;
+
+	if (xfer->erased_offset < offset)
+		xfer->erased_offset = offset;
+
+	return true;
+}
+
 bool bl_xfer_write_cont(struct xfer_state * xfer, const struct msg_xfer_cont *xfer_cont)
 {
 	if (!xfer->in_progress) {
@@ -270,13 +366,19 @@ bool bl_xfer_write_cont(struct xfer_state * xfer, const struct msg_xfer_cont *xf
 		return false;
 	}
 
-	uint32_t bytes_this_xfer = MIN(XFER_BYTES_PER_PACKET, xfer->bytes_to_xfer);
+	uint32_t bytes_this_xfer = MIN(XFER_BYTES_PER_PACKET,
+				xfer->write_end - xfer->current_partition_offset);
 
 	if (bytes_this_xfer == 0) {
 		/* Not expecting any more bytes. We shouldn't be in this function at all */
 		return false;
 	}
 
+	if (xfer->erase_as_written &&
+			!bl_xfer_erase_to(xfer, xfer->current_partition_offset + bytes_this_xfer)) {
+		return false;
+	}
+
 	/* Fix up the endian of the data words */
 	for (uint8_t i = 0; i < bytes_this_xfer / sizeof(uint32_t); i++) {
 		uint32_t *data = &((uint32_t *)xfer_cont->data)[i];
@@ -302,32 +404,50 @@ bool bl_xfer_write_cont(struct xfer_state * xfer, const struct msg_xfer_cont *xf
 	return true;
 }
 
-bool bl_xfer_wipe_partition(const struct msg_wipe_partition *wipe_partition)
+/* Erase whatever of the partition the data didn't reach, so the CRC covers a clean tail */
+bool bl_xfer_write_finish(struct xfer_state * xfer)
 {
-	enum pios_flash_partition_labels flash_label;
+	if (!xfer->erase_as_written)
+		return true;
+
+	return bl_xfer_erase_to(xfer, xfer->partition_size);
+}
 
-	switch (wipe_partition->label) {
+/* Flash partition behind a writable DFU partition */
+static bool bl_xfer_flash_label(enum dfu_partition_label label, enum pios_flash_partition_labels *flash_label)
+{
+	switch (label) {
 #ifdef F1_UPGRADER
 	case DFU_PARTITION_BL:
-		flash_label = FLASH_PARTITION_LABEL_BL;
+		*flash_label = FLASH_PARTITION_LABEL_BL;
 		break;
 #endif
 	case DFU_PARTITION_FW:
-		flash_label = FLASH_PARTITION_LABEL_FW;
+		*flash_label = FLASH_PARTITION_LABEL_FW;
 		break;
 	case DFU_PARTITION_SETTINGS:
-		flash_label = FLASH_PARTITION_LABEL_SETTINGS;
+		*flash_label = FLASH_PARTITION_LABEL_SETTINGS;
 		break;
 	case DFU_PARTITION_AUTOTUNE:
-		flash_label = FLASH_PARTITION_LABEL_AUTOTUNE;
+		*flash_label = FLASH_PARTITION_LABEL_AUTOTUNE;
 		break;
 	case DFU_PARTITION_LOG:
-		flash_label = FLASH_PARTITION_LABEL_LOG;
+		*flash_label = FLASH_PARTITION_LABEL_LOG;
 		break;
 	default:
 		return false;
 	}
 
+	return true;
+}
+
+bool bl_xfer_wipe_partition(const struct msg_wipe_partition *wipe_partition)
+{
+	enum pios_flash_partition_labels flash_label;
+
+	if (!bl_xfer_flash_label(wipe_partition->label, &flash_label))
+		return false;
+
 	uintptr_t partition_id;
 	if (PIOS_FLASH_find_partition_id(flash_label, &partition_id) != 0)
 		return false;
@@ -339,6 +459,42 @@ bool bl_xfer_wipe_partition(const struct msg_wipe_partition *wipe_partition)
 	return true;
 }
 
+/*
+ * Reply with the extents and CRC of the sector holding an offset (from the
+ * start of the flash partition), so the host can tell which sectors a new
+ * image changes.  A size of zero in the reply means there is no such sector.
+ */
+bool bl_xfer_send_sector_crc(const struct msg_sector_crc *sector_crc)
+{
+	struct bl_messages msg = {
+		.flags_command = BL_MSG_SECTOR_CRC_REP,
+		.v.sector_crc = {
+			.offset = sector_crc->offset,
+			.label  = sector_crc->label,
+		},
+	};
+
+	enum pios_flash_partition_labels flash_label;
+	uintptr_t partition_id;
+	uint32_t sector_offset;
+	uint32_t sector_size;
+
+	if (bl_xfer_flash_label(sector_crc->label, &flash_label) &&
+			(PIOS_FLASH_find_partition_id(flash_label, &partition_id) == 0) &&
+			(PIOS_FLASH_get_sector_extents(partition_id, BE32_TO_CPU(sector_crc->offset),
+						&sector_offset, &sector_size) == 0)) {
+		msg.v.sector_crc.offset = CPU_TO_BE32(sector_offset);
+		msg.v.sector_crc.size   = CPU_TO_BE32(sector_size);
+		msg.v.sector_crc.crc    = CPU_TO_BE32(bl_compute_partition_crc(partition_id,
+								sector_offset,
+								sector_size));
+	}
+
+	PIOS_COM_MSG_Send(PIOS_COM_TELEM_USB, (uint8_t *)&msg, sizeof(msg));
+
+	return (msg.v.sector_crc.size != 0);
+}
+
 bool bl_xfer_send_capabilities_self(void)
 {
 	/* Return capabilities of the specific device */
@@ -365,6 +521,7 @@ bool bl_xfer_send_capabilities_self(void)
 #if defined(BL_INCLUDE_CAP_EXTENSIONS)
 	/* Fill in capabilities extensions */
 	msg.v.cap_rep_specific.cap_extension_magic = BL_CAP_EXTENSION_MAGIC;
+	msg.v.cap_rep_specific.cap_flags = BL_CAP_FLAG_WINDOWED_WRITE | BL_CAP_FLAG_DELTA_WRITE;
 
 	uintptr_t partition_id;
 	uint32_t partition_size;
@@ -43,6 +43,10 @@ struct xfer_state {
 	bool     check_crc;
 	uint32_t crc;
 
+	bool     erase_as_written;
+	uint32_t erased_offset;	/* partition is erased up to here */
+	uint32_t write_end;	/* packets are cut short here */
+
 	uint32_t bytes_to_xfer;
 };
 
@@ -50,9 +54,12 @@ extern bool bl_xfer_completed_p(const struct xfer_state * xfer);
 extern bool bl_xfer_crc_ok_p(const struct xfer_state * xfer);
 extern bool bl_xfer_read_start(struct xfer_state * xfer, const struct msg_xfer_start *xfer_start);
 extern bool bl_xfer_send_next_read_packet(struct xfer_state * xfer);
-extern bool bl_xfer_write_start(struct xfer_state * xfer, const struct msg_xfer_start *xfer_start);
+extern bool bl_xfer_write_start(struct xfer_state * xfer, const struct msg_xfer_start *xfer_start, bool erase_as_written);
+extern bool bl_xfer_write_seek(struct xfer_state * xfer, const struct msg_write_seek *write_seek);
 extern bool bl_xfer_write_cont(struct xfer_state * xfer, const struct msg_xfer_cont *xfer_cont);
+extern bool bl_xfer_write_finish(struct xfer_state * xfer);
 extern bool bl_xfer_wipe_partition(const struct msg_wipe_partition *wipe_partition);
+extern bool bl_xfer_send_sector_crc(const struct msg_sector_crc *sector_crc);
 extern bool bl_xfer_send_capabilities_self(void);
 
 #endif	/* BL_XFER_H_ */
@@ -548,6 +548,10 @@ static bool bl_send_status(struct bl_fsm_context * context)
 		},
 	};
 
+	/* Lets a host streaming a write see how far the board got */
+	if (context->curr_state == BL_STATE_DFU_WRITE_IN_PROGRESS)
+		msg.v.status_rep.additional_state = CPU_TO_BE32(context->xfer.next_packet_number);
+
 	PIOS_COM_MSG_Send(PIOS_COM_TELEM_USB, (uint8_t *)&msg, sizeof(msg));
 
 	return true;
@@ -619,12 +623,22 @@ static void process_packet_rx(struct bl_fsm_context * context, const struct bl_m
 		break;
 
 	case BL_MSG_WRITE_START:
-		if (bl_xfer_write_start(&context->xfer, &(msg->v.xfer_start))) {
+	case BL_MSG_WRITE_START_WINDOWED:
+		if (bl_xfer_write_start(&context->xfer, &(msg->v.xfer_start),
+					command == BL_MSG_WRITE_START_WINDOWED)) {
 			bl_fsm_inject_event(context, BL_EVENT_WRITE_START);
 		} else {
 			/* Failed to start the write */
 		}
 		break;
+	case BL_MSG_WRITE_SEEK:
+		if (bl_fsm_get_state(context) == BL_STATE_DFU_WRITE_IN_PROGRESS) {
+			if (!bl_xfer_write_seek(&context->xfer, &(msg->v.write_seek))) {
+				/* Invalid seek, fail the transfer */
+				bl_fsm_inject_event(context, BL_EVENT_TRANSFER_ERROR);
+			}
+		}
+		break;
 	case BL_MSG_WRITE_CONT:
 		if (bl_fsm_get_state(context) == BL_STATE_DFU_WRITE_IN_PROGRESS) {
 			if (!bl_xfer_write_cont(&context->xfer, &(msg->v.xfer_cont))) {
@@ -638,7 +652,8 @@ static void process_packet_rx(struct bl_fsm_context * context, const struct bl_m
 		if (bl_fsm_get_state(context) == BL_STATE_DFU_WRITE_IN_PROGRESS) {
 			if (bl_xfer_completed_p(&context->xfer)) {
 				/* Transfer is finished, check the CRC */
-				if (bl_xfer_crc_ok_p(&context->xfer)) {
+				if (bl_xfer_write_finish(&context->xfer) &&
+						bl_xfer_crc_ok_p(&context->xfer)) {
 					bl_fsm_inject_event(context, BL_EVENT_TRANSFER_DONE);
 				} else {
 					/* Mismatched CRC */
@@ -664,8 +679,13 @@ static void process_packet_rx(struct bl_fsm_context * context, const struct bl_m
 		bl_xfer_wipe_partition(&(msg->v.wipe_partition));
 		break;
 
+	case BL_MSG_SECTOR_CRC_REQ:
+		bl_xfer_send_sector_crc(&(msg->v.sector_crc));
+		break;
+
 	case BL_MSG_CAP_REP:
 	case BL_MSG_STATUS_REP:
+	case BL_MSG_SECTOR_CRC_REP:
 	case BL_MSG_READ_CONT:
 		/* We've received a *reply* packet when we expected a request. */
 		break;
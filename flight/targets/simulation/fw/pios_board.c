@@ -53,7 +53,7 @@
 void Stack_Change() {
 }
 
-const struct pios_tcp_cfg pios_tcp_telem_cfg = {
+struct pios_tcp_cfg pios_tcp_telem_cfg = {
   .ip = "0.0.0.0",
   .port = 9000,
 };
@@ -130,6 +130,13 @@ void PIOS_Board_Init(void) {
 	HwSparkyInitialize();
 	HwSimulationInitialize();
 
+	/* Several instances can run side by side, each on its own port.  The
+	 * arguments aren't parsed yet, so this comes from the environment. */
+	const char *telem_port = getenv("DRONIN_TELEMETRY_PORT");
+	if (telem_port) {
+		pios_tcp_telem_cfg.port = atoi(telem_port);
+	}
+
 	uintptr_t pios_tcp_telem_rf_id;
 	if (PIOS_TCP_Init(&pios_tcp_telem_rf_id, &pios_tcp_telem_cfg)) {
 		PIOS_Assert(0);
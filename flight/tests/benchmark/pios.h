@@ -0,0 +1,11 @@
+/* Just what the flight libraries under benchmark need of PiOS */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define PIOS_malloc_no_dma(size) malloc(size)
+#define PIOS_malloc(size) malloc(size)
+
+/* Would be from pios_debug.h but that file pulls on way too many dependencies */
+#define PIOS_Assert(x) if (!(x)) { while (1) ; }
+#define PIOS_DEBUG_Assert(x) PIOS_Assert(x)
@@ -0,0 +1,310 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Benchmarks of the flight math and control libraries
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the
+ * benchmarks.  Each one times its kernel and records the time per call as
+ * the ns_per_call property of the test, so "make ut_benchmark_xml" gives a
+ * report that can be compared between changes.  The same is printed as a
+ * "BENCH <name> <ns>" line for a quick look.
+ *
+ * The figures are host figures; compare them with ones of the same machine.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* snprintf */
+#include <stdint.h>		/* uint*_t */
+#include <time.h>		/* clock_gettime */
+
+#define restrict __restrict	/* keep the aliasing hints the C code is timed with */
+
+extern "C" {
+#include "coordinate_conversions.h"
+#include "insgps.h"
+#include "lpfilter.h"
+#include "misc_math.h"
+#include "pid.h"
+}
+
+// Calls per timed batch, and the time each run of batches goes on for
+#define BATCH_CALLS 1000
+#define MIN_RUN_NS 50000000
+// Runs of each benchmark, of which the fastest is reported
+#define RUNS 5
+
+// Written by the kernels so the compiler can't drop the work
+static volatile float sink;
+
+static uint64_t now_ns()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Time a kernel, and report the time per call
+ * @param[in] kernel called with the call number, to vary its input
+ */
+template <typename Kernel> static void bench(Kernel kernel)
+{
+  double best = 0;
+
+  for (int run = 0; run < RUNS; run++) {
+    uint64_t calls = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+
+    do {
+      for (int i = 0; i < BATCH_CALLS; i++)
+        kernel(i);
+      calls += BATCH_CALLS;
+      elapsed = now_ns() - start;
+    } while (elapsed < MIN_RUN_NS);
+
+    double ns = (double)elapsed / calls;
+    if (run == 0 || ns < best)
+      best = ns;
+  }
+
+  const ::testing::TestInfo *info = ::testing::UnitTest::GetInstance()->current_test_info();
+
+  char value[32];
+  snprintf(value, sizeof(value), "%.1f", best);
+  ::testing::Test::RecordProperty("ns_per_call", value);
+
+  printf("BENCH %s.%s %s\n", info->test_case_name(), info->name(), value);
+}
+
+class Filters : public testing::Test {
+};
+
+TEST_F(Filters, LpfilterBiquad2ndOrder3Axis) {
+  lpfilter_state_t filter = NULL;
+  lpfilter_create(&filter, 100, 0.001f, 2, 3);
+
+  bench([&](int i) {
+    float sample[3] = { (float)(i & 15), -(float)(i & 7), 1.0f };
+    lpfilter_run(filter, sample);
+    sink = sample[0] + sample[1] + sample[2];
+  });
+}
+
+TEST_F(Filters, LpfilterBiquad4thOrder3Axis) {
+  lpfilter_state_t filter = NULL;
+  lpfilter_create(&filter, 100, 0.001f, 4, 3);
+
+  bench([&](int i) {
+    float sample[3] = { (float)(i & 15), -(float)(i & 7), 1.0f };
+    lpfilter_run(filter, sample);
+    sink = sample[0] + sample[1] + sample[2];
+  });
+}
+
+TEST_F(Filters, LpfilterFirstOrderSingle) {
+  lpfilter_state_t filter = NULL;
+  lpfilter_create(&filter, 100, 0.001f, 1, 1);
+
+  bench([&](int i) {
+    sink = lpfilter_run_single(filter, 0, (float)(i & 15));
+  });
+}
+
+class Control : public testing::Test {
+};
+
+TEST_F(Control, PidApply) {
+  struct pid pid;
+  pid_configure(&pid, 0.003f, 0.002f, 0.00003f, 0.3f);
+  pid_configure_derivative(0.008f, 1.0f);
+  pid_zero(&pid);
+
+  bench([&](int i) {
+    sink = pid_apply(&pid, (float)(i & 31) - 16, 0.001f);
+  });
+}
+
+TEST_F(Control, PidApplySetpoint) {
+  struct pid pid;
+  struct pid_deadband deadband;
+  pid_configure(&pid, 0.003f, 0.002f, 0.00003f, 0.3f);
+  pid_configure_derivative(0.008f, 1.0f);
+  pid_configure_deadband(&deadband, 5, 0.4f);
+  pid_zero(&pid);
+
+  bench([&](int i) {
+    sink = pid_apply_setpoint(&pid, &deadband, (float)(i & 31), 12, 0.001f);
+  });
+}
+
+class Ins : public testing::Test {
+protected:
+  virtual void SetUp() {
+    const float pos[3] = { 1.0f, -2.0f, -10.0f };
+    const float vel[3] = { 0.5f, 0.2f, -0.1f };
+    const float q[4] = { 0.9484f, 0.0797f, 0.1617f, 0.2603f };
+    const float gyro_bias[3] = { 0.01f, -0.02f, 0.005f };
+    const float accel_bias[3] = { 0, 0, 0.02f };
+    const float mag_north[3] = { 0.55f, 0.1f, 0.83f };
+
+    INSGPSInit();
+    INSSetState(pos, vel, q, gyro_bias, accel_bias);
+    INSSetMagNorth(mag_north);
+  }
+};
+
+TEST_F(Ins, StatePrediction) {
+  const float gyro[3] = { 0.3f, -0.2f, 0.1f };
+  const float accel[3] = { 0.5f, -0.3f, -9.6f };
+
+  bench([&](int i) {
+    (void) i;
+    INSStatePrediction(gyro, accel, 0.002f);
+  });
+}
+
+TEST_F(Ins, CovariancePrediction) {
+  bench([&](int i) {
+    (void) i;
+    INSCovariancePrediction(0.002f);
+  });
+}
+
+TEST_F(Ins, CorrectionBaro) {
+  const float mag[3] = { 0.55f, 0.1f, 0.83f };
+  const float pos[3] = { 1.0f, -2.0f, -10.0f };
+  const float vel[3] = { 0.5f, 0.2f, -0.1f };
+
+  bench([&](int i) {
+    INSCorrection(mag, pos, vel, 10.0f + (i & 1), BARO_SENSOR);
+  });
+}
+
+TEST_F(Ins, CorrectionFull) {
+  const float mag[3] = { 0.55f, 0.1f, 0.83f };
+  const float pos[3] = { 1.0f, -2.0f, -10.0f };
+  const float vel[3] = { 0.5f, 0.2f, -0.1f };
+
+  bench([&](int i) {
+    INSCorrection(mag, pos, vel, 10.0f + (i & 1), FULL_SENSORS);
+  });
+}
+
+class CoordinateConversions : public testing::Test {
+};
+
+TEST_F(CoordinateConversions, Quaternion2RPY) {
+  const float q[4] = { 0.9484f, 0.0797f, 0.1617f, 0.2603f };
+
+  bench([&](int i) {
+    float rpy[3];
+    (void) i;
+    Quaternion2RPY(q, rpy);
+    sink = rpy[0];
+  });
+}
+
+TEST_F(CoordinateConversions, RPY2Quaternion) {
+  bench([&](int i) {
+    const float rpy[3] = { (float)(i & 63), 10, -30 };
+    float q[4];
+    RPY2Quaternion(rpy, q);
+    sink = q[0];
+  });
+}
+
+TEST_F(CoordinateConversions, Quaternion2R) {
+  float q[4] = { 0.9484f, 0.0797f, 0.1617f, 0.2603f };
+
+  bench([&](int i) {
+    float Rbe[3][3];
+    (void) i;
+    Quaternion2R(q, Rbe);
+    sink = Rbe[0][0];
+  });
+}
+
+TEST_F(CoordinateConversions, LLA2NED) {
+  bench([&](int i) {
+    float LLA[3] = { 47.0f + (i & 15) * 0.001f, 8.5f, 400 };
+    const float ecef_delta[3] = { 12, -30, 4 };
+    float Rne[3][3];
+    float ned[3];
+    RneFromLLA(LLA, Rne);
+    rot_mult(Rne, ecef_delta, ned, false);
+    sink = ned[0];
+  });
+}
+
+class MiscMath : public testing::Test {
+};
+
+TEST_F(MiscMath, Expo3) {
+  bench([&](int i) {
+    sink = expo3((float)(i & 63) / 64, 50);
+  });
+}
+
+TEST_F(MiscMath, CubicDeadband) {
+  float m, r;
+  cubic_deadband_setup(5, 0.4f, &m, &r);
+
+  bench([&](int i) {
+    sink = cubic_deadband((float)(i & 31) - 16, 5, 0.4f, m, r);
+  });
+}
+
+TEST_F(MiscMath, LinearInterpolate) {
+  const float curve[5] = { 0, 0.2f, 0.5f, 0.75f, 1 };
+
+  bench([&](int i) {
+    sink = linear_interpolate((float)(i & 63) / 64, curve, 5, 0, 1);
+  });
+}
+
+TEST_F(MiscMath, CircularModulusDeg) {
+  bench([&](int i) {
+    sink = circular_modulus_deg((float)(i & 1023) - 512);
+  });
+}
+
+TEST_F(MiscMath, MatrixMul3x3) {
+  const float a[9] = { 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+
+  bench([&](int i) {
+    float b[9] = { (float)(i & 7), 1, 0, 0, 1, 0, 0, 0, 1 };
+    float out[9];
+    matrix_mul(a, b, out, 3, 3, 3);
+    sink = out[0];
+  });
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -84,3 +84,127 @@ TEST_F(RneFromLLATest, Equator) {
   ASSERT_NEAR(0, Rne[2][1], eps);
   ASSERT_NEAR(0, Rne[2][2], eps);
 };
+
+TEST_F(CoordConversion, Rv2Quaternion) {
+  const float Rv[3] = { 0, 0, (float)M_PI / 2 };
+  float q[4];
+
+  Rv2Quaternion(Rv, q);
+
+  float eps = 0.000001f;
+  EXPECT_NEAR(sqrtf(0.5f), q[0], eps);
+  EXPECT_NEAR(0, q[1], eps);
+  EXPECT_NEAR(0, q[2], eps);
+  EXPECT_NEAR(sqrtf(0.5f), q[3], eps);
+
+  // Tiny rotations take the small angle path
+  const float Rv_small[3] = { 1e-5f, -2e-5f, 0 };
+  Rv2Quaternion(Rv_small, q);
+  EXPECT_FLOAT_EQ(1, q[0]);
+  EXPECT_FLOAT_EQ(0.5e-5f, q[1]);
+  EXPECT_FLOAT_EQ(-1e-5f, q[2]);
+  EXPECT_FLOAT_EQ(0, q[3]);
+}
+
+// Delta angle of the coning rates a * (cos(w t), sin(w t), 0) over [t0, t1]
+static void coning_dtheta(double a, double w, double t0, double t1, float dtheta[3])
+{
+  dtheta[0] = a / w * (sin(w * t1) - sin(w * t0));
+  dtheta[1] = -a / w * (cos(w * t1) - cos(w * t0));
+  dtheta[2] = 0;
+}
+
+static void rotate(float q[4], const float phi[3])
+{
+  float dq[4], q_new[4];
+
+  Rv2Quaternion(phi, dq);
+  quat_mult(q, dq, q_new);
+  quat_copy(q_new, q);
+}
+
+TEST_F(CoordConversion, ConingCompensation) {
+  const double a = 2, w = 2 * M_PI * 10, dT = 0.004;
+  const int steps = 250, substeps = 100;
+
+  float q_true[4] = { 1, 0, 0, 0 };
+  float q_plain[4] = { 1, 0, 0, 0 };
+  float q_coning[4] = { 1, 0, 0, 0 };
+  float last_dtheta[3] = { 0, 0, 0 };
+
+  for (int i = 0; i < steps; i++) {
+    float dtheta[3], phi[3];
+
+    for (int j = 0; j < substeps; j++) {
+      coning_dtheta(a, w, dT * (i + (double)j / substeps),
+          dT * (i + (double)(j + 1) / substeps), dtheta);
+      rotate(q_true, dtheta);
+    }
+
+    coning_dtheta(a, w, dT * i, dT * (i + 1), dtheta);
+    rotate(q_plain, dtheta);
+
+    // The first step has no interval before it to compensate with
+    coning_rotation_vector(i ? last_dtheta : dtheta, dtheta, phi);
+    memcpy(last_dtheta, dtheta, sizeof(last_dtheta));
+    rotate(q_coning, phi);
+  }
+
+  // The coning shows up as a drift about z
+  float err_plain = fabsf(q_true[3] - q_plain[3]);
+  float err_coning = fabsf(q_true[3] - q_coning[3]);
+
+  EXPECT_GT(err_plain, 1e-4f);
+  EXPECT_LT(err_coning, err_plain * 0.1f);
+}
+
+TEST_F(CoordConversion, HomeFrameBatch) {
+  struct home_frame home;
+  home_frame_init(&home, 473977420, 85455940, 500);
+
+  // About 111 km per degree of latitude, less for longitude away from the equator
+  EXPECT_NEAR(111.4f / 10e6f * 1000, home.T[0], 0.1f / 10e6f * 1000);
+  EXPECT_NEAR(home.T[0] * cosf(47.397742f * (float)M_PI / 180), home.T[1], 1e-6f);
+  EXPECT_EQ(-1, home.T[2]);
+
+  const int32_t lat[] = { 473977420, 473977420 + 9000, 473977420 - 45000, 473977420 + 1 };
+  const int32_t lon[] = { 85455940, 85455940, 85455940 + 132600, 85455940 - 1 };
+  const float alt[] = { 500, 510, 420, 500 };
+  const int count = sizeof(alt) / sizeof(alt[0]);
+
+  float NED[count][3];
+  lla_to_ned_batch(&home, lat, lon, alt, NED, count);
+
+  EXPECT_FLOAT_EQ(0, NED[0][0]);
+  EXPECT_FLOAT_EQ(0, NED[0][1]);
+  EXPECT_FLOAT_EQ(0, NED[0][2]);
+
+  EXPECT_NEAR(100, NED[1][0], 0.5f);
+  EXPECT_FLOAT_EQ(0, NED[1][1]);
+  EXPECT_FLOAT_EQ(-10, NED[1][2]);
+
+  EXPECT_NEAR(-500, NED[2][0], 2);
+  EXPECT_NEAR(1000, NED[2][1], 5);
+  EXPECT_FLOAT_EQ(80, NED[2][2]);
+
+  // Differences are taken before going to float, so the least step survives
+  EXPECT_FLOAT_EQ(home.T[0], NED[3][0]);
+  EXPECT_FLOAT_EQ(-home.T[1], NED[3][1]);
+
+  // Every point matches the single conversion, and comes back where it was
+  int32_t lat_out[count], lon_out[count];
+  float alt_out[count];
+  ned_to_lla_batch(&home, NED, lat_out, lon_out, alt_out, count);
+
+  for (int i = 0; i < count; i++) {
+    float single[1][3];
+    lla_to_ned_batch(&home, &lat[i], &lon[i], &alt[i], single, 1);
+    EXPECT_FLOAT_EQ(NED[i][0], single[0][0]);
+    EXPECT_FLOAT_EQ(NED[i][1], single[0][1]);
+    EXPECT_FLOAT_EQ(NED[i][2], single[0][2]);
+
+    EXPECT_EQ(lat[i], lat_out[i]);
+    EXPECT_EQ(lon[i], lon_out[i]);
+    EXPECT_FLOAT_EQ(alt[i], alt_out[i]);
+  }
+}
@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test for the CRC routines
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+
+extern "C" {
+#include "pios_crc.h"		/* API for CRC functions */
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class CRC8 : public testing::Test {
+protected:
+  virtual void SetUp() {
+    srand(42);
+    for (unsigned int i = 0; i < sizeof(buf); i++) {
+      buf[i] = rand() & 0xff;
+    }
+  }
+
+  virtual void TearDown() {
+  }
+
+  // Reference: one table lookup per byte
+  uint8_t byteWise(uint8_t crc, const uint8_t *data, int32_t length) {
+    while (length--) {
+      crc = PIOS_CRC_updateByte(crc, *data++);
+    }
+    return crc;
+  }
+
+  uint8_t buf[1024];
+};
+
+TEST_F(CRC8, CheckValue) {
+  const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+  // CRC-8, poly 0x07, no reflection, zero init and xorout
+  EXPECT_EQ(0xf4, PIOS_CRC_updateCRC(0, check, sizeof(check)));
+  EXPECT_EQ(0xf4, byteWise(0, check, sizeof(check)));
+};
+
+TEST_F(CRC8, EmptyBuffer) {
+  EXPECT_EQ(0x00, PIOS_CRC_updateCRC(0x00, buf, 0));
+  EXPECT_EQ(0x5a, PIOS_CRC_updateCRC(0x5a, buf, 0));
+};
+
+TEST_F(CRC8, MatchesByteTable) {
+  // Every length up to a full UAVTalk frame and beyond, at every alignment
+  for (int32_t offset = 0; offset < 8; offset++) {
+    for (int32_t length = 0; length <= 300; length++) {
+      ASSERT_EQ(byteWise(0, buf + offset, length),
+          PIOS_CRC_updateCRC(0, buf + offset, length))
+        << "offset " << offset << " length " << length;
+    }
+  }
+};
+
+TEST_F(CRC8, MatchesByteTableWithSeed) {
+  for (int seed = 0; seed < 256; seed++) {
+    ASSERT_EQ(byteWise(seed, buf, 37), PIOS_CRC_updateCRC(seed, buf, 37))
+      << "seed " << seed;
+  }
+};
+
+TEST_F(CRC8, Incremental) {
+  // Splitting a buffer into chunks must give the same result as one pass
+  uint8_t whole = PIOS_CRC_updateCRC(0, buf, sizeof(buf));
+
+  for (int32_t chunk = 1; chunk <= 17; chunk++) {
+    uint8_t crc = 0;
+
+    for (int32_t pos = 0; pos < (int32_t) sizeof(buf); pos += chunk) {
+      int32_t len = sizeof(buf) - pos;
+      if (len > chunk) {
+        len = chunk;
+      }
+      crc = PIOS_CRC_updateCRC(crc, buf + pos, len);
+    }
+
+    EXPECT_EQ(whole, crc) << "chunk " << chunk;
+  }
+};
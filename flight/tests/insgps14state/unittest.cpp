@@ -0,0 +1,147 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memcpy */
+#include <stdint.h>		/* uint*_t */
+#include <math.h>		/* fabsf */
+
+#define NUMX 14
+#define NUMV 10
+
+extern "C" {
+#include "insgps.h"		/* API for the INS */
+
+/* Internals of insgps14state.c */
+extern float H[NUMV][NUMX], P[NUMX][NUMX], X[NUMX], R[NUMV], Be[3];
+
+void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+		  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+		  uint16_t SensorsUsed);
+void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
+void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV]);
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class INSGPS : public testing::Test {
+protected:
+  virtual void SetUp() {
+    const float pos[3] = { 1.0f, -2.0f, -10.0f };
+    const float vel[3] = { 0.5f, 0.2f, -0.1f };
+    const float q[4] = { 0.9484f, 0.0797f, 0.1617f, 0.2603f };
+    const float gyro_bias[3] = { 0.01f, -0.02f, 0.005f };
+    const float accel_bias[3] = { 0, 0, 0.02f };
+    const float mag_north[3] = { 0.55f, 0.1f, 0.83f };
+
+    INSGPSInit();
+    INSSetState(pos, vel, q, gyro_bias, accel_bias);
+    INSSetMagNorth(mag_north);
+
+    // Fly a little, so P picks up cross terms
+    for (int i = 0; i < 200; i++) {
+      const float gyro[3] = { 0.3f, -0.2f, 0.1f };
+      const float accel[3] = { 0.5f, -0.3f, -9.6f };
+
+      INSStatePrediction(gyro, accel, 0.002f);
+      INSCovariancePrediction(0.002f);
+    }
+  }
+
+  virtual void TearDown() {
+  }
+};
+
+/* The serial update as it was, going through every term of H */
+static void DenseSerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+		  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+		  uint16_t SensorsUsed)
+{
+	float HP[NUMX], HPHR, Error, K[NUMX];
+
+	for (int m = 0; m < NUMV; m++) {
+		if (!(SensorsUsed & (0x01 << m)))
+			continue;
+
+		for (int j = 0; j < NUMX; j++) {
+			HP[j] = 0.0f;
+			for (int k = 0; k < NUMX; k++)
+				HP[j] += H[m][k] * P[k][j];
+		}
+		HPHR = R[m];
+		for (int k = 0; k < NUMX; k++)
+			HPHR += HP[k] * H[m][k];
+
+		for (int k = 0; k < NUMX; k++)
+			K[k] = HP[k] / HPHR;
+
+		for (int i = 0; i < NUMX; i++) {
+			for (int j = i; j < NUMX; j++)
+				P[i][j] = P[j][i] = P[i][j] - K[i] * HP[j];
+		}
+
+		Error = Z[m] - Y[m];
+		for (int i = 0; i < NUMX; i++)
+			X[i] = X[i] + K[i] * Error;
+	}
+}
+
+TEST_F(INSGPS, SerialUpdateMatchesDense) {
+  const uint16_t masks[] = { FULL_SENSORS, POS_SENSORS | BARO_SENSOR, MAG_SENSORS, HORIZ_VEL_SENSORS };
+
+  for (uint16_t mask : masks) {
+    SetUp();
+
+    float Y[NUMV], Z[NUMV];
+    LinearizeH(X, Be, H);
+    MeasurementEq(X, Be, Y);
+
+    // Measurements a little off from the prediction
+    for (int m = 0; m < NUMV; m++)
+      Z[m] = Y[m] + 0.05f * (m + 1) * ((m & 1) ? -1 : 1);
+
+    float P_dense[NUMX][NUMX], X_dense[NUMX];
+    memcpy(P_dense, P, sizeof(P));
+    memcpy(X_dense, X, sizeof(X));
+
+    DenseSerialUpdate(H, R, Z, Y, P_dense, X_dense, mask);
+    SerialUpdate(H, R, Z, Y, P, X, mask);
+
+    for (int i = 0; i < NUMX; i++) {
+      EXPECT_NEAR(X_dense[i], X[i], 1e-5f + 1e-4f * fabsf(X_dense[i]));
+      for (int j = 0; j < NUMX; j++)
+        EXPECT_NEAR(P_dense[i][j], P[i][j], 1e-9f + 1e-4f * fabsf(P_dense[i][j]));
+    }
+  }
+}
@@ -230,6 +230,38 @@ TEST_F(LogfsTestCooked, WriteTwoVerifyOneB) {
   EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
 }
 
+TEST_F(LogfsTestCooked, BadIdSaveList) {
+  struct pios_flashfs_obj objs[] = {
+    { OBJ1_ID, 0, sizeof(obj1), obj1 },
+  };
+  EXPECT_EQ(-1, PIOS_FLASHFS_ObjSaveList(fs_id + 1, objs, 1));
+}
+
+TEST_F(LogfsTestCooked, WriteListVerifyTwo) {
+  /* Write obj1 and obj2 in one go, replacing an older obj1 */
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+
+  struct pios_flashfs_obj objs[] = {
+    { OBJ1_ID, 0, sizeof(obj1), obj1 },
+    { OBJ2_ID, 0, sizeof(obj2), obj2 },
+  };
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveList(fs_id, objs, 2));
+
+  unsigned char obj1_check[OBJ1_SIZE];
+  memset(obj1_check, 0, sizeof(obj1_check));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+  EXPECT_EQ(0, memcmp(obj1, obj1_check, sizeof(obj1)));
+
+  unsigned char obj2_check[OBJ2_SIZE];
+  memset(obj2_check, 0, sizeof(obj2_check));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+  EXPECT_EQ(0, memcmp(obj2, obj2_check, sizeof(obj2)));
+}
+
+TEST_F(LogfsTestCooked, WriteEmptyList) {
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSaveList(fs_id, NULL, 0));
+}
+
 TEST_F(LogfsTestCooked, WriteZeroSize) {
   /* Write a zero length object */
   EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ0_ID, 0, NULL, 0));
@@ -299,6 +331,59 @@ TEST_F(LogfsTestCooked, FillFilesystemAndGarbageCollect) {
   EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
 }
 
+TEST_F(LogfsTestCooked, BackgroundGarbageCollect) {
+  /* Nothing to collect in an empty filesystem */
+  EXPECT_EQ(0, PIOS_FLASHFS_GarbageCollectStep(fs_id));
+
+  for (uint16_t i = 0; i < 20; i++) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, i, obj1, sizeof(obj1)));
+  }
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+
+  /* Leave most of the log obsolete, with a few free slots */
+  for (uint32_t i = 0; i < 200; i++) {
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ3_ID, 0, obj3, sizeof(obj3)));
+  }
+
+  /* Overwrite and delete objects while they are being copied */
+  uint16_t steps = 0;
+  int32_t rc;
+  while ((rc = PIOS_FLASHFS_GarbageCollectStep(fs_id)) == 1) {
+    ASSERT_GT(20, steps);
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, steps, obj1_alt, sizeof(obj1_alt)));
+    if (steps == 3) {
+      EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ2_ID, 0));
+    }
+    steps++;
+  }
+  EXPECT_EQ(0, rc);
+  EXPECT_LT(3, steps);
+
+  /* Check both before and after remounting the collected arena */
+  for (uint8_t pass = 0; pass < 2; pass++) {
+    unsigned char obj1_check[OBJ1_SIZE];
+    for (uint16_t i = 0; i < 20; i++) {
+      memset(obj1_check, 0, sizeof(obj1_check));
+      EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, i, obj1_check, sizeof(obj1_check)));
+      EXPECT_EQ(0, memcmp(i < steps ? obj1_alt : obj1, obj1_check, sizeof(obj1)));
+    }
+
+    unsigned char obj2_check[OBJ2_SIZE];
+    EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+
+    unsigned char obj3_check[OBJ3_SIZE];
+    memset(obj3_check, 0, sizeof(obj3_check));
+    EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ3_ID, 0, obj3_check, sizeof(obj3_check)));
+    EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
+
+    PIOS_FLASHFS_Logfs_Destroy(fs_id);
+    EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_settings, FLASH_PARTITION_LABEL_SETTINGS));
+  }
+
+  /* The obsolete slots were freed, nothing more to collect */
+  EXPECT_EQ(0, PIOS_FLASHFS_GarbageCollectStep(fs_id));
+}
+
 TEST_F(LogfsTestCooked, WriteManyVerify) {
   for (uint32_t i = 0; i < 10000; i++) {
     /* Write a collection of objects */
@@ -332,6 +417,30 @@ TEST_F(LogfsTestCooked, WriteManyVerify) {
   EXPECT_EQ(0, memcmp(obj3, obj3_check, sizeof(obj3)));
 }
 
+TEST_F(LogfsTestCooked, WriteRemountVerify) {
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1, sizeof(obj1)));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 1, obj1, sizeof(obj1)));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ2_ID, 0, obj2, sizeof(obj2)));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjSave(fs_id, OBJ1_ID, 0, obj1_alt, sizeof(obj1_alt)));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjDelete(fs_id, OBJ1_ID, 1));
+
+  /* Remount, so that lookups go through the index built by the mount */
+  PIOS_FLASHFS_Logfs_Destroy(fs_id);
+  EXPECT_EQ(0, PIOS_FLASHFS_Logfs_Init(&fs_id, &flashfs_config_settings, FLASH_PARTITION_LABEL_SETTINGS));
+
+  unsigned char obj1_check[OBJ1_SIZE];
+  memset(obj1_check, 0, sizeof(obj1_check));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 0, obj1_check, sizeof(obj1_check)));
+  EXPECT_EQ(0, memcmp(obj1_alt, obj1_check, sizeof(obj1_alt)));
+
+  EXPECT_EQ(-3, PIOS_FLASHFS_ObjLoad(fs_id, OBJ1_ID, 1, obj1_check, sizeof(obj1_check)));
+
+  unsigned char obj2_check[OBJ2_SIZE];
+  memset(obj2_check, 0, sizeof(obj2_check));
+  EXPECT_EQ(0, PIOS_FLASHFS_ObjLoad(fs_id, OBJ2_ID, 0, obj2_check, sizeof(obj2_check)));
+  EXPECT_EQ(0, memcmp(obj2, obj2_check, sizeof(obj2)));
+}
+
 class LogfsTestCookedMultiPart : public LogfsTestRaw {
 protected:
   virtual void SetUp() {
@@ -740,3 +740,36 @@ TEST_F(MatrixMath, MixerMatrixInverses) {
     }
   }
 }
+
+// Test fixture for fft_radix2()
+class FFTRadix2 : public MiscMath {
+protected:
+  virtual void SetUp() {
+  }
+
+  virtual void TearDown() {
+  }
+};
+
+TEST_F(FFTRadix2, CosineLandsInItsBin) {
+  const float eps = 0.0001f;
+  const uint16_t n = 64;
+  float re[n], im[n];
+
+  for (uint16_t i = 0; i < n; i++) {
+    re[i] = 1.0f + cosf(2 * M_PI * 5 * i / n);
+    im[i] = 0;
+  }
+
+  fft_radix2(re, im, n);
+
+  for (uint16_t k = 0; k < n; k++) {
+    float expected = 0;
+    if (k == 0)
+      expected = n;
+    else if (k == 5 || k == n - 5)
+      expected = n / 2;
+
+    EXPECT_NEAR(expected, sqrtf(re[k] * re[k] + im[k] * im[k]), eps * n);
+  }
+}
@@ -0,0 +1,203 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test for the polygon grid index
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <math.h>
+
+#include <vector>
+
+extern "C" {
+#include "polygonindex.h"
+}
+
+struct Point {
+  float x, y;
+};
+
+typedef std::vector<Point> Polygon;
+
+// Plain crossing number test to compare against
+static bool contains(const Polygon &poly, float x, float y)
+{
+  bool in = false;
+
+  for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++) {
+    const Point &a = poly[i], &b = poly[j];
+
+    if ((a.y > y) != (b.y > y) &&
+        x < a.x + (y - a.y) * (b.x - a.x) / (b.y - a.y))
+      in = !in;
+  }
+
+  return in;
+}
+
+// Star with alternating radii, so it's properly concave
+static Polygon star(float cx, float cy, float r0, float r1, int points)
+{
+  Polygon p;
+
+  for (int i = 0; i < points * 2; i++) {
+    float r = (i & 1) ? r1 : r0;
+    float a = i * (float)M_PI / points;
+
+    p.push_back({ cx + r * cosf(a), cy + r * sinf(a) });
+  }
+
+  return p;
+}
+
+class PolygonIndex : public testing::Test {
+protected:
+  virtual void SetUp() {
+    idx = new polygon_index;
+    polyindex_reset(idx);
+    polys.clear();
+  }
+
+  virtual void TearDown() {
+    delete idx;
+  }
+
+  void add(const Polygon &poly) {
+    uint8_t n = polys.size();
+
+    for (size_t i = 0; i < poly.size(); i++)
+      ASSERT_TRUE(polyindex_add_vertex(idx, n, poly[i].x, poly[i].y));
+
+    polys.push_back(poly);
+  }
+
+  uint16_t expected(float x, float y) {
+    uint16_t mask = 0;
+
+    for (size_t i = 0; i < polys.size(); i++) {
+      if (contains(polys[i], x, y))
+        mask |= 1 << i;
+    }
+
+    return mask;
+  }
+
+  // Compare against the plain test on a fine raster over the area
+  void sweep(float x0, float y0, float x1, float y1, int steps) {
+    uint32_t seen = 0;
+
+    for (int i = 0; i <= steps; i++) {
+      for (int j = 0; j <= steps; j++) {
+        // Stay off the exact raster so points don't land on vertices
+        float x = x0 + (x1 - x0) * (i + 0.37f) / steps;
+        float y = y0 + (y1 - y0) * (j + 0.61f) / steps;
+        uint16_t mask = expected(x, y);
+
+        ASSERT_EQ(mask, polyindex_query(idx, x, y)) << x << "," << y;
+        seen |= 1u << mask;
+      }
+    }
+
+    // Make sure the sweep actually crosses some edges
+    EXPECT_NE(seen & (seen - 1), 0u);
+  }
+
+  struct polygon_index *idx;
+  std::vector<Polygon> polys;
+};
+
+TEST_F(PolygonIndex, Empty) {
+  polyindex_build(idx);
+
+  EXPECT_EQ(0, polyindex_query(idx, 0, 0));
+  EXPECT_EQ(0, polyindex_query(idx, 1e6f, -1e6f));
+};
+
+TEST_F(PolygonIndex, Square) {
+  add({ { -100, -100 }, { 100, -100 }, { 100, 100 }, { -100, 100 } });
+  polyindex_build(idx);
+
+  EXPECT_EQ(POLYINDEX_GRID_DIM, idx->dim);
+
+  EXPECT_EQ(1, polyindex_query(idx, 0, 0));
+  EXPECT_EQ(1, polyindex_query(idx, 99, -99));
+  EXPECT_EQ(0, polyindex_query(idx, 101, 0));
+  EXPECT_EQ(0, polyindex_query(idx, 0, -5000));
+
+  sweep(-150, -150, 150, 150, 200);
+};
+
+TEST_F(PolygonIndex, ConcaveAndNested) {
+  // Operating area, with two keep out zones inside and one overlapping
+  add(star(0, 0, 500, 200, 9));
+  add(star(100, 50, 60, 30, 5));
+  add({ { -50, -50 }, { -20, -50 }, { -20, -20 }, { -50, -20 } });
+  add(star(450, 0, 120, 80, 3));
+  polyindex_build(idx);
+
+  sweep(-600, -600, 600, 600, 300);
+  sweep(80, 30, 130, 80, 100);
+};
+
+TEST_F(PolygonIndex, ManyVertices) {
+  // Long thin edges all over the place force a coarser grid
+  add(star(0, 0, 1000, 10, POLYINDEX_MAX_VERTICES / 2 - 4));
+  add({ { 2000, 0 }, { 2100, 0 }, { 2100, 100 }, { 2000, 100 } });
+  polyindex_build(idx);
+
+  EXPECT_LT(idx->dim, POLYINDEX_GRID_DIM);
+  EXPECT_LE(idx->cell_refs[idx->dim * idx->dim], POLYINDEX_MAX_REFS);
+
+  sweep(-1100, -1100, 2200, 1100, 300);
+};
+
+TEST_F(PolygonIndex, RejectsBadVertices) {
+  EXPECT_TRUE(polyindex_add_vertex(idx, 0, 0, 0));
+  EXPECT_TRUE(polyindex_add_vertex(idx, 0, 1, 0));
+  EXPECT_TRUE(polyindex_add_vertex(idx, 2, 1, 1));
+
+  // Polygon 0 already ended
+  EXPECT_FALSE(polyindex_add_vertex(idx, 0, 0, 1));
+  EXPECT_FALSE(polyindex_add_vertex(idx, POLYINDEX_MAX_POLYGONS, 0, 1));
+
+  for (int i = idx->num_vertices; i < POLYINDEX_MAX_VERTICES; i++)
+    EXPECT_TRUE(polyindex_add_vertex(idx, 2, i, i));
+
+  EXPECT_FALSE(polyindex_add_vertex(idx, 2, 0, 0));
+};
+
+/**
+ * @}
+ * @}
+ */
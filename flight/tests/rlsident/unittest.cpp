@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     dRonin, http://dronin.org, Copyright (C) 2017
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test for the onboard rate response identification
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+#include <math.h>
+
+extern "C" {
+#include "rlsident.h"
+}
+
+// Simulates the autotune wiggle on a first order motor plus rate integrator
+class RlsIdent : public testing::Test {
+protected:
+  virtual void SetUp() {
+    srand(1234);
+  }
+
+  virtual void TearDown() {
+  }
+
+  float noise(float amplitude) {
+    return amplitude * (2.0f * rand() / RAND_MAX - 1.0f);
+  }
+
+  void run(struct rlsident *id, float dT, const float *tau,
+      const float *beta, float seconds, float gyro_noise) {
+    float motor[3] = { 0 }, rate[3] = { 0 };
+    int points = 0.512f / dT;
+
+    for (int k = 0; k < seconds / dT; k++) {
+      // Each axis gets its own part of the 8 step wiggle
+      int phase = (k * 8 / points) & 7;
+      float u[3] = { 0 }, gyro[3];
+
+      u[0] = (phase == 1) ? 0.1f : (phase == 2) ? -0.1f : 0;
+      u[1] = (phase == 3) ? 0.1f : (phase == 4) ? -0.1f : 0;
+      u[2] = (phase == 0) ? 0.1f : (phase == 5) ? -0.1f : 0;
+
+      for (int i = 0; i < 3; i++) {
+        gyro[i] = rate[i] + noise(gyro_noise);
+        motor[i] += (u[i] - motor[i]) * dT / tau[i];
+        rate[i] += expf(beta[i]) * motor[i] * dT;
+      }
+
+      rlsident_update(id, gyro, u);
+    }
+  }
+};
+
+TEST_F(RlsIdent, Noiseless) {
+  const float dT = 1.0f / 1000;
+  const float tau[3] = { 0.03f, 0.04f, 0.06f };
+  const float beta[3] = { 9.5f, 9.8f, 7.5f };
+
+  struct rlsident id;
+  rlsident_init(&id, dT, 50, 4);
+
+  run(&id, dT, tau, beta, 10, 0);
+
+  for (int i = 0; i < 3; i++) {
+    float t, b;
+
+    ASSERT_TRUE(rlsident_get(&id, i, &t, &b));
+    EXPECT_NEAR(tau[i], t, tau[i] * 0.05f) << "axis " << i;
+    EXPECT_NEAR(beta[i], b, 0.05f) << "axis " << i;
+  }
+};
+
+TEST_F(RlsIdent, NoisyFastLoop) {
+  const float dT = 1.0f / 2000;
+  const float tau[3] = { 0.025f, 0.025f, 0.05f };
+  const float beta[3] = { 10.0f, 10.2f, 8.0f };
+
+  struct rlsident id;
+  rlsident_init(&id, dT, 30, 4);
+
+  run(&id, dT, tau, beta, 20, 2.0f);
+
+  for (int i = 0; i < 3; i++) {
+    float t, b;
+
+    ASSERT_TRUE(rlsident_get(&id, i, &t, &b));
+    EXPECT_NEAR(tau[i], t, tau[i] * 0.2f) << "axis " << i;
+    EXPECT_NEAR(beta[i], b, 0.2f) << "axis " << i;
+  }
+};
+
+TEST_F(RlsIdent, RestartKeepsEstimate) {
+  const float dT = 1.0f / 1000;
+  const float tau[3] = { 0.03f, 0.03f, 0.03f };
+  const float beta[3] = { 9.0f, 9.0f, 9.0f };
+
+  struct rlsident id;
+  rlsident_init(&id, dT, 50, 4);
+
+  float t, b;
+  EXPECT_FALSE(rlsident_get(&id, 0, &t, &b));
+
+  run(&id, dT, tau, beta, 5, 0);
+  rlsident_restart(&id);
+
+  uint32_t updates = id.updates;
+  float gyro[3] = { 1000, 1000, 1000 }, u[3] = { 0 };
+
+  // A jump in the data right after a restart isn't regressed on
+  rlsident_update(&id, gyro, u);
+  rlsident_update(&id, gyro, u);
+  EXPECT_EQ(updates, id.updates);
+
+  ASSERT_TRUE(rlsident_get(&id, 0, &t, &b));
+  EXPECT_NEAR(tau[0], t, tau[0] * 0.05f);
+};
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,344 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test for receiver frame assembly
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+
+#include <vector>
+
+extern "C" {
+#include "pios_rxframe.h"
+}
+
+typedef std::vector<uint8_t> Frame;
+
+// Collects every frame handed to the decoder
+struct Decoded {
+  std::vector<Frame> frames;
+  bool (*check)(const uint8_t *frame, uint16_t len);
+};
+
+static bool collect(uintptr_t context, const uint8_t *frame, uint16_t len)
+{
+  Decoded *d = (Decoded *)context;
+
+  if (d->check && !d->check(frame, len))
+    return false;
+
+  d->frames.push_back(Frame(frame, frame + len));
+  return true;
+}
+
+// DSM: fixed 16 byte frames, only starting after a gap
+static uint16_t dsm_len(const uint8_t *header)
+{
+  (void)header;
+  return 16;
+}
+
+static const struct pios_rxframe_proto dsm_proto = {
+  1, dsm_len, collect, true
+};
+
+// S.Bus-like: sync byte, fixed length, end byte
+#define SYNC_LEN 25
+
+static uint16_t sync_len(const uint8_t *header)
+{
+  return (header[0] == 0x0f) ? SYNC_LEN : 0;
+}
+
+static bool sync_check(const uint8_t *frame, uint16_t len)
+{
+  return frame[len - 1] == 0x00;
+}
+
+static const struct pios_rxframe_proto sync_proto = {
+  1, sync_len, collect, false
+};
+
+// Crossfire-like: address byte, length byte, then length more bytes
+static uint16_t field_len(const uint8_t *header)
+{
+  if (header[0] != 0xc8 || header[1] < 2 || header[1] > 62)
+    return 0;
+
+  return 2 + header[1];
+}
+
+static const struct pios_rxframe_proto field_proto = {
+  2, field_len, collect, false
+};
+
+class RxFrame : public testing::Test {
+protected:
+  virtual void SetUp() {
+    decoded.check = NULL;
+  }
+
+  virtual void TearDown() {
+  }
+
+  void init(const struct pios_rxframe_proto *proto) {
+    PIOS_RxFrame_Init(&frame, proto, buf, sizeof(buf), (uintptr_t)&decoded);
+  }
+
+  // Push data in spans of span bytes, like DMA or FIFO delivery would
+  int push(const uint8_t *data, size_t len, size_t span) {
+    int good = 0;
+
+    while (len) {
+      size_t n = (len < span) ? len : span;
+
+      good += PIOS_RxFrame_Push(&frame, data, n);
+      data += n;
+      len -= n;
+    }
+
+    return good;
+  }
+
+  int push(const Frame &data, size_t span) {
+    return push(data.data(), data.size(), span);
+  }
+
+  struct pios_rxframe frame;
+  uint8_t buf[64];
+  Decoded decoded;
+};
+
+static Frame sync_frame(uint8_t seed)
+{
+  Frame f(SYNC_LEN);
+
+  f[0] = 0x0f;
+  for (int i = 1; i < SYNC_LEN - 1; i++)
+    f[i] = seed + i;
+  f[SYNC_LEN - 1] = 0x00;
+
+  return f;
+}
+
+static Frame field_frame(uint8_t len, uint8_t seed)
+{
+  Frame f(2 + len);
+
+  f[0] = 0xc8;
+  f[1] = len;
+  for (int i = 2; i < 2 + len; i++)
+    f[i] = seed + i;
+
+  return f;
+}
+
+TEST_F(RxFrame, GapSyncWaitsForGap) {
+  init(&dsm_proto);
+
+  Frame data(16, 0x55);
+
+  // Nothing starts until the line has gone quiet once
+  EXPECT_EQ(0, push(data, 16));
+  EXPECT_TRUE(decoded.frames.empty());
+
+  PIOS_RxFrame_Gap(&frame);
+  EXPECT_EQ(1, push(data, 5));
+  ASSERT_EQ(1u, decoded.frames.size());
+  EXPECT_EQ(data, decoded.frames[0]);
+
+  // Bytes after a frame are ignored until the next gap
+  EXPECT_EQ(0, push(data, 16));
+  EXPECT_EQ(1u, decoded.frames.size());
+};
+
+TEST_F(RxFrame, GapDropsPartialFrame) {
+  init(&dsm_proto);
+  PIOS_RxFrame_Gap(&frame);
+
+  Frame data(16);
+  for (int i = 0; i < 16; i++)
+    data[i] = i;
+
+  EXPECT_EQ(0, push(data.data(), 10, 10));
+  EXPECT_FALSE(PIOS_RxFrame_Idle(&frame));
+
+  PIOS_RxFrame_Gap(&frame);
+  EXPECT_TRUE(PIOS_RxFrame_Idle(&frame));
+
+  EXPECT_EQ(1, push(data, 16));
+  ASSERT_EQ(1u, decoded.frames.size());
+  EXPECT_EQ(data, decoded.frames[0]);
+};
+
+TEST_F(RxFrame, SyncBackToBack) {
+  decoded.check = sync_check;
+
+  for (size_t span = 1; span <= 64; span++) {
+    init(&sync_proto);
+    decoded.frames.clear();
+
+    Frame stream;
+    std::vector<Frame> sent;
+
+    // Leading garbage, then frames with no gaps between them
+    for (int i = 0; i < 7; i++)
+      stream.push_back(0x80 + i);
+
+    for (int i = 0; i < 5; i++) {
+      Frame f = sync_frame(i * 16);
+      sent.push_back(f);
+      stream.insert(stream.end(), f.begin(), f.end());
+    }
+
+    EXPECT_EQ(5, push(stream, span)) << "span " << span;
+    EXPECT_EQ(sent, decoded.frames) << "span " << span;
+  }
+};
+
+TEST_F(RxFrame, LengthFieldResync) {
+  init(&field_proto);
+
+  Frame stream;
+  std::vector<Frame> sent;
+
+  // A sync-looking byte with an implausible length is skipped over
+  stream.push_back(0x11);
+  stream.push_back(0xc8);
+  stream.push_back(0xc8);
+  stream.push_back(0xff);
+
+  for (int i = 0; i < 4; i++) {
+    Frame f = field_frame(2 + i * 8, i);
+    sent.push_back(f);
+    stream.insert(stream.end(), f.begin(), f.end());
+  }
+
+  EXPECT_EQ(4, push(stream, 3));
+  EXPECT_EQ(sent, decoded.frames);
+};
+
+TEST_F(RxFrame, OversizeFrameRejected) {
+  init(&field_proto);
+
+  // Claims more than the frame buffer can hold
+  Frame f = field_frame(62, 0);
+  Frame good = field_frame(4, 1);
+
+  f.insert(f.end(), good.begin(), good.end());
+
+  push(f, 16);
+
+  ASSERT_FALSE(decoded.frames.empty());
+  EXPECT_EQ(good, decoded.frames.back());
+  for (size_t i = 0; i < decoded.frames.size(); i++)
+    EXPECT_LE(decoded.frames[i].size(), sizeof(buf));
+};
+
+// Replays logic analyser captures of DSM satellites; a gap is signalled
+// whenever the line was quiet for longer than 2ms
+class RxFrameDsm : public RxFrame {
+protected:
+  void replay(const char *fn, size_t span) {
+    FILE *fid = fopen(fn, "r");
+    ASSERT_TRUE(fid != NULL) << fn;
+
+    char *line = NULL;
+    size_t len = 0;
+
+    // throwaway intro line
+    ASSERT_GT(getline(&line, &len, fid), 0);
+    free(line);
+
+    init(&dsm_proto);
+    decoded.frames.clear();
+
+    std::vector<Frame> bursts;
+    Frame burst;
+    double t, last = -1;
+    uint8_t val;
+
+    while (fscanf(fid, "%lf,%hhx,,", &t, &val) == 2) {
+      if (last >= 0 && t - last > 0.002) {
+        push(burst, span);
+        PIOS_RxFrame_Gap(&frame);
+
+        bursts.push_back(burst);
+        burst.clear();
+      }
+
+      burst.push_back(val);
+      last = t;
+    }
+
+    push(burst, span);
+    bursts.push_back(burst);
+
+    fclose(fid);
+
+    // Every complete burst after the first gap is one frame
+    std::vector<Frame> expected;
+    for (size_t i = 1; i < bursts.size(); i++) {
+      if (bursts[i].size() == 16)
+        expected.push_back(bursts[i]);
+    }
+
+    EXPECT_GT(expected.size(), 2000u);
+    ASSERT_EQ(expected.size(), decoded.frames.size());
+    for (size_t i = 0; i < expected.size(); i++)
+      ASSERT_EQ(expected[i], decoded.frames[i]) << "frame " << i;
+  }
+};
+
+TEST_F(RxFrameDsm, DX7_DSM2_11ms) {
+  replay("../dsm/DX7_11msDSM2.txt", 1);
+  replay("../dsm/DX7_11msDSM2.txt", 16);
+};
+
+TEST_F(RxFrameDsm, DX7_DSMX_22ms) {
+  replay("../dsm/DX7_22msDSMX.txt", 3);
+};
+
+TEST_F(RxFrameDsm, DX18_DSMX_11ms) {
+  replay("../dsm/DX18_11msDSMX.txt", 7);
+};
+
+TEST_F(RxFrameDsm, DX18_DSM2_22ms_XPlus) {
+  replay("../dsm/DX18_22msDSM2_XPlus_1024res.txt", 64);
+};
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ * @file       unittest.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup UnitTests
+ * @{
+ * @addtogroup UnitTests
+ * @{
+ * @brief Unit test
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+/*
+ * NOTE: This program uses the Google Test infrastructure to drive the unit test
+ *
+ * Main site for Google Test: http://code.google.com/p/googletest/
+ * Documentation and examples: http://code.google.com/p/googletest/wiki/Documentation
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdio.h>		/* printf */
+#include <stdlib.h>		/* abort */
+#include <string.h>		/* memset */
+#include <stdint.h>		/* uint*_t */
+
+#include <vector>
+
+extern "C" {
+
+#include "ubx_frame.h"
+
+}
+
+struct frame {
+  uint8_t cls, id;
+  std::vector<uint8_t> payload;
+};
+
+static void frame_cb(void *ctx, uint8_t cls, uint8_t id, const uint8_t *payload, uint16_t len)
+{
+  std::vector<frame> *frames = (std::vector<frame> *) ctx;
+  frames->push_back({ cls, id, std::vector<uint8_t>(payload, payload + len) });
+}
+
+// Encode a frame the plain way, one byte of checksum at a time
+static std::vector<uint8_t> encode(uint8_t cls, uint8_t id, const std::vector<uint8_t> &payload)
+{
+  std::vector<uint8_t> f = { 0xb5, 0x62, cls, id, (uint8_t)(payload.size() & 0xff), (uint8_t)(payload.size() >> 8) };
+  f.insert(f.end(), payload.begin(), payload.end());
+
+  uint8_t ck_a = 0, ck_b = 0;
+  for (size_t i = 2; i < f.size(); i++) {
+    ck_a += f[i];
+    ck_b += ck_a;
+  }
+  f.push_back(ck_a);
+  f.push_back(ck_b);
+
+  return f;
+}
+
+static std::vector<uint8_t> pattern(size_t len, uint8_t seed)
+{
+  std::vector<uint8_t> p(len);
+  for (size_t i = 0; i < len; i++)
+    p[i] = (uint8_t)(seed + i * 37);
+  return p;
+}
+
+// To use a test fixture, derive a class from testing::Test.
+class UBXFrame : public testing::Test {
+protected:
+  virtual void SetUp() {
+    ubx_frame_init(&state, partial, sizeof(partial));
+
+    // A navigation solution as a receiver sends it, with NMEA around it
+    const char *nmea = "$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n";
+    stream.insert(stream.end(), nmea, nmea + strlen(nmea));
+
+    sent.push_back({ 0x01, 0x02, pattern(28, 1) });  // NAV-POSLLH
+    sent.push_back({ 0x01, 0x12, pattern(36, 2) });  // NAV-VELNED
+    sent.push_back({ 0x01, 0x04, pattern(18, 3) });  // NAV-DOP
+    sent.push_back({ 0x01, 0x06, pattern(52, 4) });  // NAV-SOL
+    sent.push_back({ 0x05, 0x01, { 0x06, 0x01 } });  // ACK-ACK
+    sent.push_back({ 0x06, 0x08, { } });             // CFG-RATE poll
+
+    for (const frame &f : sent) {
+      std::vector<uint8_t> e = encode(f.cls, f.id, f.payload);
+      stream.insert(stream.end(), e.begin(), e.end());
+      stream.push_back(0xb5);  // a stray sync char between frames
+    }
+  }
+
+  virtual void TearDown() {
+  }
+
+  void expect_sent() {
+    ASSERT_EQ(sent.size(), got.size());
+    for (size_t i = 0; i < sent.size(); i++) {
+      EXPECT_EQ(sent[i].cls, got[i].cls);
+      EXPECT_EQ(sent[i].id, got[i].id);
+      EXPECT_EQ(sent[i].payload, got[i].payload);
+    }
+  }
+
+  struct ubx_frame_state state;
+  uint8_t partial[128];
+  std::vector<uint8_t> stream;
+  std::vector<frame> sent, got;
+};
+
+TEST_F(UBXFrame, KnownChecksums) {
+  // From the u-blox protocol description
+  const uint8_t ack[] = { 0xb5, 0x62, 0x05, 0x01, 0x02, 0x00, 0x06, 0x01, 0x0f, 0x38 };
+  const uint8_t cfg_rate_poll[] = { 0xb5, 0x62, 0x06, 0x08, 0x00, 0x00, 0x0e, 0x30 };
+
+  EXPECT_EQ(0x380f, ubx_frame_checksum(ack + 2, sizeof(ack) - 4));
+  EXPECT_EQ(0x300e, ubx_frame_checksum(cfg_rate_poll + 2, sizeof(cfg_rate_poll) - 4));
+}
+
+TEST_F(UBXFrame, ChecksumMatchesBytewise) {
+  for (size_t len = 0; len < 300; len++) {
+    std::vector<uint8_t> p = pattern(len, (uint8_t)len);
+    std::vector<uint8_t> e = encode(0x01, 0x30, p);
+
+    uint16_t ck = ubx_frame_checksum(&e[2], e.size() - 4);
+    EXPECT_EQ(e[e.size() - 2], ck & 0xff);
+    EXPECT_EQ(e[e.size() - 1], ck >> 8);
+  }
+}
+
+TEST_F(UBXFrame, WholeStream) {
+  EXPECT_EQ(sent.size(), ubx_frame_parse(&state, stream.data(), stream.size(), frame_cb, &got));
+
+  expect_sent();
+  EXPECT_EQ(sent.size(), state.received);
+  EXPECT_EQ(0u, state.chksum_errors);
+  EXPECT_EQ(0u, state.overflows);
+}
+
+TEST_F(UBXFrame, SplitAnywhere) {
+  // Cut the stream in two at every point
+  for (size_t cut = 0; cut <= stream.size(); cut++) {
+    ubx_frame_init(&state, partial, sizeof(partial));
+    got.clear();
+
+    ubx_frame_parse(&state, stream.data(), cut, frame_cb, &got);
+    ubx_frame_parse(&state, stream.data() + cut, stream.size() - cut, frame_cb, &got);
+
+    expect_sent();
+  }
+}
+
+TEST_F(UBXFrame, ByteAtATime) {
+  for (size_t i = 0; i < stream.size(); i++)
+    ubx_frame_parse(&state, &stream[i], 1, frame_cb, &got);
+
+  expect_sent();
+}
+
+TEST_F(UBXFrame, BadChecksum) {
+  std::vector<uint8_t> bad = encode(0x01, 0x02, pattern(28, 9));
+  bad[10] ^= 0x40;
+  stream.insert(stream.begin(), bad.begin(), bad.end());
+
+  ubx_frame_parse(&state, stream.data(), stream.size(), frame_cb, &got);
+
+  expect_sent();
+  EXPECT_EQ(1u, state.chksum_errors);
+}
+
+TEST_F(UBXFrame, TooLong) {
+  // Longer than the partial buffer can hold, this is skipped
+  std::vector<uint8_t> big = encode(0x01, 0x30, pattern(200, 5));
+  stream.insert(stream.begin(), big.begin(), big.end());
+
+  ubx_frame_parse(&state, stream.data(), stream.size(), frame_cb, &got);
+
+  expect_sent();
+  EXPECT_EQ(1u, state.overflows);
+}
+
+TEST_F(UBXFrame, SyncCharsAsData) {
+  // Frames that carry sync chars in their payload
+  std::vector<uint8_t> s;
+  sent.clear();
+  for (int i = 0; i < 4; i++) {
+    std::vector<uint8_t> p = { 0xb5, 0x62, 0xb5, 0xb5, (uint8_t)i };
+    sent.push_back({ 0x0a, 0x04, p });
+    std::vector<uint8_t> e = encode(0x0a, 0x04, p);
+    s.insert(s.end(), e.begin(), e.end());
+  }
+
+  for (size_t cut = 0; cut <= s.size(); cut++) {
+    ubx_frame_init(&state, partial, sizeof(partial));
+    got.clear();
+
+    ubx_frame_parse(&state, s.data(), cut, frame_cb, &got);
+    ubx_frame_parse(&state, s.data() + cut, s.size() - cut, frame_cb, &got);
+
+    expect_sent();
+  }
+}
@@ -0,0 +1,321 @@
+/**
+ ******************************************************************************
+ *
+ * @file       benchmark.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief Throughput benchmarks of the GCS telemetry hot paths
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "benchmark.h"
+
+#include "uavobjects/uavobjectmanager.h"
+#include "uavobjects/uavobjectsinit.h"
+#include "uavtalk/logdecoder.h"
+#include "uavtalk/uavtalk.h"
+#include "scopes2d/timeseriesstore.h"
+
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <algorithm>
+#include <atomic>
+
+#if defined(__GLIBC__)
+/*
+ * Count every heap allocation of the process, Qt's containers included, by
+ * standing in for the allocator entry points. operator new ends up here too.
+ */
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+}
+
+static std::atomic<quint64> allocationCount(0);
+
+extern "C" void *malloc(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t nmemb, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+static quint64 allocations()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+#else
+static quint64 allocations()
+{
+    return 0;
+}
+#endif
+
+// UAVTalk framing, as the flight side sends it
+static const quint8 SYNC_VAL = 0x3C;
+static const quint8 TYPE_OBJ = 0x20;
+static const int MIN_HEADER_LENGTH = 8;
+static const int MAX_PACKET_LENGTH = 256;
+
+// Reserved up front, so the latencies kept don't count as allocations
+static const int LATENCY_RESERVE = 1 << 20;
+
+QJsonObject Benchmark::Result::toJson() const
+{
+    QJsonObject json;
+
+    json["name"] = name;
+    json["frames"] = (double)frames;
+    json["seconds"] = seconds;
+    json["frames_per_s"] = framesPerSecond;
+    if (allocationsPerFrame >= 0)
+        json["allocs_per_frame"] = allocationsPerFrame;
+    json["p50_ns"] = (double)p50Ns;
+    json["p90_ns"] = (double)p90Ns;
+    json["p99_ns"] = (double)p99Ns;
+    json["max_ns"] = (double)maxNs;
+
+    return json;
+}
+
+QString Benchmark::Result::toString() const
+{
+    QString allocs = "n/a";
+    if (allocationsPerFrame >= 0)
+        allocs = QString::number(allocationsPerFrame, 'f', 2);
+
+    return QString("%1: %2 frames/s, %3 allocs/frame, p50 %4 ns, p90 %5 ns, p99 %6 ns, max %7 ns")
+        .arg(name)
+        .arg(framesPerSecond, 0, 'f', 0)
+        .arg(allocs)
+        .arg(p50Ns)
+        .arg(p90Ns)
+        .arg(p99Ns)
+        .arg(maxNs);
+}
+
+Benchmark::Benchmark(quint64 frames)
+    : frames(frames)
+{
+    // A private object manager, like the log exports decode into
+    objMngr = new UAVObjectManager;
+    UAVObjectsInitialize(objMngr);
+
+    sink.open(QIODevice::ReadWrite);
+    talk = new UAVTalk(&sink, objMngr);
+
+    buildStream();
+}
+
+Benchmark::~Benchmark()
+{
+    delete talk;
+    delete objMngr;
+}
+
+bool Benchmark::allocationsCounted()
+{
+#if defined(__GLIBC__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Pack a frame of instance 0 of every data object that fits one
+ */
+void Benchmark::buildStream()
+{
+    foreach (const QVector<UAVDataObject *> &instances, objMngr->getDataObjectsVector()) {
+        if (instances.isEmpty())
+            continue;
+
+        UAVObject *obj = instances.first();
+        int headerLength = MIN_HEADER_LENGTH + (obj->isSingleInstance() ? 0 : 2);
+        int length = headerLength + obj->getNumBytes();
+        if (length + 1 > MAX_PACKET_LENGTH)
+            continue;
+
+        QByteArray payload(obj->getNumBytes(), 0);
+        obj->pack((quint8 *)payload.data());
+
+        QByteArray frame(headerLength, 0);
+        frame[0] = SYNC_VAL;
+        frame[1] = TYPE_OBJ;
+        qToLittleEndian<quint16>(length, (uchar *)frame.data() + 2);
+        qToLittleEndian<quint32>(obj->getObjID(), (uchar *)frame.data() + 4);
+        if (!obj->isSingleInstance())
+            qToLittleEndian<quint16>(obj->getInstID(), (uchar *)frame.data() + 8);
+        frame.append(payload);
+        frame.append((char)UAVTalk::updateCRC(0, (const quint8 *)frame.constData(), length));
+
+        objects.append(obj);
+        stream.append(frame);
+        payloads.append(payload);
+    }
+}
+
+QVector<Benchmark::Result> Benchmark::runSynthetic()
+{
+    QVector<Result> results;
+
+    results.append(runUAVTalk());
+    results.append(runUnpack());
+    results.append(runScopeSampling());
+
+    return results;
+}
+
+/**
+ * @brief Frames go through UAVTalk one at a time, like on a slow link:
+ * framing, CRC check, lookup and unpack of the object
+ */
+Benchmark::Result Benchmark::runUAVTalk()
+{
+    return measure("uavtalk_process", frames, [this](quint64 i) {
+        const QByteArray &frame = stream.at(i % stream.size());
+        talk->processBytes((const quint8 *)frame.constData(), frame.size());
+        return true;
+    });
+}
+
+/**
+ * @brief Objects unpacked straight from their data, without the framing
+ */
+Benchmark::Result Benchmark::runUnpack()
+{
+    return measure("uavobject_unpack", frames, [this](quint64 i) {
+        int n = i % objects.size();
+        objects.at(n)->unpack((const quint8 *)payloads.at(n).constData());
+        return true;
+    });
+}
+
+/**
+ * @brief Updates of a plotted object, with the field sampled for every update
+ * like a time series scope curve has it
+ */
+Benchmark::Result Benchmark::runScopeSampling()
+{
+    UAVObject *obj = objMngr->getObject("AttitudeActual");
+    UAVObjectField *field = obj ? obj->getField("Roll") : Q_NULLPTR;
+    int n = objects.indexOf(obj);
+
+    if (!field || n < 0) {
+        Result skipped = Result();
+        skipped.name = "scope_sampling";
+        return skipped;
+    }
+
+    TimeSeriesBuffer buffer(field, 0);
+    buffer.retain(this, 60, 0);
+
+    const quint8 *payload = (const quint8 *)payloads.at(n).constData();
+
+    return measure("scope_sampling", frames, [obj, payload](quint64 i) {
+        Q_UNUSED(i);
+        obj->unpack(payload);
+        return true;
+    });
+}
+
+/**
+ * @brief Decode a recorded log record by record, as fast as it goes
+ */
+Benchmark::Result Benchmark::runReplay(const QString &logFileName)
+{
+    LogDecoder decoder(objMngr);
+
+    if (!decoder.open(logFileName)) {
+        error = decoder.errorString();
+        return Result();
+    }
+
+    Result result =
+        measure("replay:" + logFileName, Q_UINT64_C(0xFFFFFFFFFFFFFFFF), [&decoder](quint64 i) {
+            Q_UNUSED(i);
+            quint32 timestamp;
+            return decoder.next(&timestamp);
+        });
+
+    decoder.close();
+
+    return result;
+}
+
+/**
+ * @brief Call an operation up to maxCalls times, timing each call
+ */
+Benchmark::Result Benchmark::measure(const QString &name, quint64 maxCalls, const Operation &op)
+{
+    QVector<qint64> latencies;
+    latencies.reserve((int)qMin<quint64>(maxCalls, LATENCY_RESERVE));
+
+    quint64 allocationsBefore = allocations();
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 last = 0;
+
+    for (quint64 i = 0; i < maxCalls; i++) {
+        if (!op(i))
+            break;
+
+        qint64 now = timer.nsecsElapsed();
+        latencies.append(now - last);
+        last = now;
+    }
+
+    quint64 allocated = allocations() - allocationsBefore;
+
+    Result result = Result();
+    result.name = name;
+    result.frames = latencies.size();
+    result.seconds = last / 1e9;
+    result.allocationsPerFrame = -1;
+
+    if (latencies.isEmpty())
+        return result;
+
+    result.framesPerSecond = result.frames / result.seconds;
+    if (allocationsCounted())
+        result.allocationsPerFrame = (double)allocated / result.frames;
+
+    std::sort(latencies.begin(), latencies.end());
+    qint64 lastIndex = latencies.size() - 1;
+    result.p50Ns = latencies.at(lastIndex * 50 / 100);
+    result.p90Ns = latencies.at(lastIndex * 90 / 100);
+    result.p99Ns = latencies.at(lastIndex * 99 / 100);
+    result.maxNs = latencies.at(lastIndex);
+
+    return result;
+}
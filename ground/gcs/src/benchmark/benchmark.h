@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       benchmark.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief Throughput benchmarks of the GCS telemetry hot paths
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include <functional>
+
+class UAVObject;
+class UAVObjectManager;
+class UAVTalk;
+
+/**
+ * @brief Times the paths every received object takes: UAVTalk framing,
+ * object unpacking, log replay and the sampling of plotted fields.
+ *
+ * Each benchmark calls its operation once per frame (or record, or update)
+ * and reports frames per second, heap allocations per frame and the
+ * percentiles of the time each call took.
+ */
+class Benchmark
+{
+public:
+    struct Result
+    {
+        QString name;
+        quint64 frames;
+        double seconds;
+        double framesPerSecond;
+        double allocationsPerFrame; // Negative where allocations aren't counted
+        qint64 p50Ns;
+        qint64 p90Ns;
+        qint64 p99Ns;
+        qint64 maxNs;
+
+        QJsonObject toJson() const;
+        QString toString() const;
+    };
+
+    /**
+     * @param frames how many frames the synthetic benchmarks time
+     */
+    explicit Benchmark(quint64 frames);
+    ~Benchmark();
+
+    QVector<Result> runSynthetic();
+    Result runReplay(const QString &logFileName);
+
+    QString errorString() const { return error; }
+
+    static bool allocationsCounted();
+
+private:
+    /**
+     * @brief An operation timed per call; returns false when there's
+     * nothing left to time
+     */
+    typedef std::function<bool(quint64 i)> Operation;
+
+    UAVObjectManager *objMngr;
+    QBuffer sink;
+    UAVTalk *talk;
+    quint64 frames;
+    QString error;
+
+    //! Instance 0 of each data object that fits a frame
+    QVector<UAVObject *> objects;
+    //! A packed frame of each of objects, the synthetic telemetry stream
+    QVector<QByteArray> stream;
+    //! The packed data of each object of stream
+    QVector<QByteArray> payloads;
+
+    void buildStream();
+    Result runUAVTalk();
+    Result runUnpack();
+    Result runScopeSampling();
+
+    static Result measure(const QString &name, quint64 maxCalls, const Operation &op);
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,35 @@
+include(../../gcs.pri)
+
+QT += network qml
+CONFIG += console
+CONFIG -= app_bundle
+
+TEMPLATE = app
+TARGET = gcsbenchmark
+DESTDIR = $$GCS_APP_PATH
+
+# Links the plugins directly, without the plugin manager
+INCLUDEPATH *= $$GCS_SOURCE_TREE/src/plugins
+INCLUDEPATH *= $$GCS_SOURCE_TREE/src/plugins/scope
+LIBS += -L$$GCS_PLUGIN_PATH/dRonin
+
+include(../libs/extensionsystem/extensionsystem.pri)
+include(../libs/utils/utils.pri)
+include(../plugins/coreplugin/coreplugin.pri)
+include(../plugins/uavobjects/uavobjects.pri)
+include(../plugins/uavtalk/uavtalk.pri)
+
+linux-* {
+    QMAKE_RPATHDIR += $$GCS_LIBRARY_PATH
+    QMAKE_RPATHDIR += $$GCS_PLUGIN_PATH/dRonin
+}
+
+HEADERS += benchmark.h \
+    ../plugins/scope/scopes2d/timeseriesstore.h
+
+SOURCES += main.cpp \
+    benchmark.cpp \
+    ../plugins/scope/scopes2d/timeseriesstore.cpp
+
+# Objects are decoded into a private object manager
+SOURCES += $$UAVOBJECT_SYNTHETICS/uavobjectsinit.cpp
@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @brief Throughput benchmarks of the GCS telemetry hot paths
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "benchmark.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Times UAVTalk, UAVObject unpacking, scope sampling and the replay of logs");
+    parser.addHelpOption();
+    parser.addPositionalArgument("logs", "Recorded .drlog files to replay", "[logs...]");
+    QCommandLineOption jsonOption(QStringList() << "j"
+                                                << "json",
+                                  "Report in JSON");
+    parser.addOption(jsonOption);
+    QCommandLineOption framesOption(QStringList() << "n"
+                                                  << "frames",
+                                    "Frames each synthetic benchmark times", "count", "1000000");
+    parser.addOption(framesOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    Benchmark benchmark(parser.value(framesOption).toULongLong());
+
+    QVector<Benchmark::Result> results = benchmark.runSynthetic();
+
+    int status = 0;
+    foreach (const QString &log, parser.positionalArguments()) {
+        Benchmark::Result result = benchmark.runReplay(log);
+        if (result.name.isEmpty()) {
+            err << log << ": " << benchmark.errorString() << endl;
+            status = 1;
+            continue;
+        }
+        results.append(result);
+    }
+
+    if (parser.isSet(jsonOption)) {
+        QJsonArray report;
+        foreach (const Benchmark::Result &result, results)
+            report.append(result.toJson());
+
+        out << QJsonDocument(report).toJson();
+    } else {
+        foreach (const Benchmark::Result &result, results)
+            out << result.toString() << endl;
+    }
+
+    return status;
+}
@@ -237,6 +237,20 @@
     \sa initialize()
 */
 
+/*!
+    \fn bool IPlugin::delayedInitialize()
+    Called after all plugins are up and running and the main window is
+    shown, one plugin at a time from the event loop, in the same order as
+    IPlugin::extensionsInitialized().
+    Setup that doesn't have to be done before the user sees the application,
+    e.g. filling caches or scanning for files, belongs here rather than in
+    IPlugin::initialize() or IPlugin::extensionsInitialized().
+    Return true if time consuming work was done, so the plugin manager lets
+    the event loop run before moving on to the next plugin.
+    The default implementation does nothing and returns false.
+    \sa PluginManager::initializationDone()
+*/
+
 /*!
     \fn void IPlugin::shutdown()
     Called during a shutdown sequence in the same order as initialization
@@ -33,9 +33,13 @@
 #include "pluginspec_p.h"
 #include "optionsparser.h"
 #include "iplugin.h"
+#include "startupprofiler.h"
 
 #include <QtCore/QMetaProperty>
 #include <QtCore/QDir>
+#include <QtCore/QHash>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 #include <QtCore/QTextStream>
 #include <QtCore/QWriteLocker>
 #include <QtDebug>
@@ -49,6 +53,28 @@ typedef QList<ExtensionSystem::PluginSpec *> PluginSpecSet;
 
 enum { debugLeaks = 0 };
 
+// Time the event loop gets between two plugins that did delayed work
+enum { DELAYED_INITIALIZE_INTERVAL = 20 };
+
+namespace {
+
+class LibraryPreloader : public QRunnable
+{
+public:
+    LibraryPreloader(ExtensionSystem::Internal::PluginSpecPrivate *spec) : spec(spec) {}
+    void run()
+    {
+        ExtensionSystem::StartupProfiler::Scope scope(spec->name, "preload");
+        spec->preloadLibrary();
+        spec->loadTime = scope.elapsed();
+    }
+
+private:
+    ExtensionSystem::Internal::PluginSpecPrivate *spec;
+};
+
+} // namespace
+
 /*!
     \namespace ExtensionSystem
     \brief The ExtensionSystem namespace provides classes that belong to the core plugin system.
@@ -134,6 +160,11 @@ enum { debugLeaks = 0 };
     \sa plugins()
 */
 
+/*!
+    \fn void PluginManager::initializationDone()
+    Signal that all plugins have run their IPlugin::delayedInitialize().
+*/
+
 /*!
     \fn T *PluginManager::getObject() const
     Retrieve the object of a given type from the object pool.
@@ -183,6 +214,8 @@ PluginManager::PluginManager()
     : d(new PluginManagerPrivate(this)),m_allPluginsLoaded(false)
 {
     m_instance = this;
+    // Startup times are measured from here
+    StartupProfiler::now();
 }
 
 /*!
@@ -393,6 +426,11 @@ void PluginManager::formatPluginVersions(QTextStream &str) const
     }
 }
 
+void PluginManager::nextDelayedInitialize()
+{
+    d->nextDelayedInitialize();
+}
+
 void PluginManager::startTests()
 {
 #ifdef WITH_TESTS
@@ -461,6 +499,9 @@ PluginSpecPrivate *PluginManagerPrivate::privateSpec(PluginSpec *spec)
 PluginManagerPrivate::PluginManagerPrivate(PluginManager *pluginManager)
     : extension("xml"), q(pluginManager)
 {
+    delayedInitializeTimer.setSingleShot(true);
+    delayedInitializeTimer.setInterval(DELAYED_INITIALIZE_INTERVAL);
+    QObject::connect(&delayedInitializeTimer, SIGNAL(timeout()), q, SLOT(nextDelayedInitialize()));
 }
 
 /*!
@@ -478,6 +519,9 @@ PluginManagerPrivate::~PluginManagerPrivate()
 
 void PluginManagerPrivate::stopAll()
 {
+    delayedInitializeTimer.stop();
+    delayedInitializeQueue.clear();
+
     QList<PluginSpec *> queue = loadQueue();
     foreach (PluginSpec *spec, queue) {
         loadPlugin(spec, PluginSpec::Stopped);
@@ -545,6 +589,8 @@ void PluginManagerPrivate::removeObject(QObject *obj)
 void PluginManagerPrivate::loadPlugins()
 {
     QList<PluginSpec *> queue = loadQueue();
+    emit q->splashMessages(QObject::tr("Loading plugin libraries"));
+    preloadLibraries(queue);
     foreach (PluginSpec *spec, queue) {
         emit q->splashMessages(QString(QObject::tr("Loading %1 plugin")).arg(spec->name()));
         loadPlugin(spec, PluginSpec::Loaded);
@@ -562,11 +608,66 @@ void PluginManagerPrivate::loadPlugins()
     QListIterator<PluginSpec *> it(queue);
     it.toBack();
     while (it.hasPrevious()) {
-        loadPlugin(it.previous(), PluginSpec::Running);
+        PluginSpec *spec = it.previous();
+        loadPlugin(spec, PluginSpec::Running);
+        if (spec->state() == PluginSpec::Running)
+            delayedInitializeQueue.append(spec);
     }
     emit q->pluginsChanged();
     q->m_allPluginsLoaded=true;
     emit q->pluginsLoadEnded();
+
+    // Runs from the event loop, once the main window is up
+    delayedInitializeTimer.start();
+}
+
+/*!
+    \fn void PluginManagerPrivate::preloadLibraries(const QList<PluginSpec *> &queue)
+    \internal
+    Loads the plugin libraries on a thread pool, a level of the dependency
+    tree at a time, so a library is only loaded once all the libraries of
+    its dependencies are. The plugin instances are still created on the
+    main thread, by loadPlugin().
+*/
+void PluginManagerPrivate::preloadLibraries(const QList<PluginSpec *> &queue)
+{
+    // The queue has the dependencies of a plugin before the plugin
+    QHash<PluginSpec *, int> levels;
+    QList<QList<PluginSpec *> > waves;
+    foreach (PluginSpec *spec, queue) {
+        int level = 0;
+        foreach (PluginSpec *depSpec, spec->dependencySpecs())
+            level = qMax(level, levels.value(depSpec) + 1);
+        levels.insert(spec, level);
+        while (waves.size() <= level)
+            waves.append(QList<PluginSpec *>());
+        waves[level].append(spec);
+    }
+
+    QThreadPool pool;
+    foreach (const QList<PluginSpec *> &wave, waves) {
+        foreach (PluginSpec *spec, wave)
+            pool.start(new LibraryPreloader(spec->d));
+        pool.waitForDone();
+    }
+}
+
+/*!
+    \fn void PluginManagerPrivate::nextDelayedInitialize()
+    \internal
+*/
+void PluginManagerPrivate::nextDelayedInitialize()
+{
+    while (!delayedInitializeQueue.isEmpty()) {
+        PluginSpec *spec = delayedInitializeQueue.takeFirst();
+        StartupProfiler::Scope scope(spec->name(), "delayedInitialize");
+        if (spec->d->delayedInitialize()) {
+            // Let the event loop run before the next one
+            delayedInitializeTimer.start();
+            return;
+        }
+    }
+    emit q->initializationDone();
 }
 
 /*!
@@ -636,7 +737,9 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
     if (spec->hasError())
         return;
     if (destState == PluginSpec::Running) {
+        StartupProfiler::Scope scope(spec->name(), "extensionsInitialized");
         spec->d->initializeExtensions();
+        spec->d->extensionsInitializedTime = scope.elapsed();
         return;
     } else if (destState == PluginSpec::Deleted) {
         spec->d->kill();
@@ -651,11 +754,15 @@ void PluginManagerPrivate::loadPlugin(PluginSpec *spec, PluginSpec::State destSt
             return;
         }
     }
-    if (destState == PluginSpec::Loaded)
+    if (destState == PluginSpec::Loaded) {
+        StartupProfiler::Scope scope(spec->name(), "load");
         spec->d->loadLibrary();
-    else if (destState == PluginSpec::Initialized)
+        spec->d->loadTime += scope.elapsed();
+    } else if (destState == PluginSpec::Initialized) {
+        StartupProfiler::Scope scope(spec->name(), "initialize");
         spec->d->initializePlugin();
-    else if (destState == PluginSpec::Stopped)
+        spec->d->initializeTime = scope.elapsed();
+    } else if (destState == PluginSpec::Stopped)
         spec->d->stop();
 }
 
@@ -113,12 +113,14 @@ signals:
 
     void pluginsChanged();
     void pluginsLoadEnded();
+    void initializationDone();
     void splashMessages(QString);
 
     void hideSplash();
     void showSplash();
 private slots:
     void startTests();
+    void nextDelayedInitialize();
 
 private:
     Internal::PluginManagerPrivate *d;
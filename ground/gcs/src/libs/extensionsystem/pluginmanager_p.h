@@ -34,6 +34,7 @@
 #include <QtCore/QSet>
 #include <QtCore/QStringList>
 #include <QtCore/QObject>
+#include <QtCore/QTimer>
 
 namespace ExtensionSystem {
 
@@ -57,7 +58,9 @@ public:
     void loadPlugins();
     void setPluginPaths(const QStringList &paths);
     QList<PluginSpec *> loadQueue();
+    void preloadLibraries(const QList<PluginSpec *> &queue);
     void loadPlugin(PluginSpec *spec, PluginSpec::State destState);
+    void nextDelayedInitialize();
     void resolveDependencies();
 
     QList<PluginSpec *> pluginSpecs;
@@ -68,6 +71,9 @@ public:
 
     QStringList arguments;
 
+    QList<PluginSpec *> delayedInitializeQueue;
+    QTimer delayedInitializeTimer;
+
     // Look in argument descriptions of the specs for the option.
     PluginSpec *pluginForOption(const QString &option, bool *requiresArgument) const;
     PluginSpec *pluginByName(const QString &name) const;
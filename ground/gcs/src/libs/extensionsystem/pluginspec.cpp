@@ -321,6 +321,33 @@ QString PluginSpec::errorString() const
     return d->errorString;
 }
 
+/*!
+    \fn qint64 PluginSpec::loadTime() const
+    Microseconds it took to load the plugin's library.
+*/
+qint64 PluginSpec::loadTime() const
+{
+    return d->loadTime;
+}
+
+/*!
+    \fn qint64 PluginSpec::initializeTime() const
+    Microseconds spent in IPlugin::initialize().
+*/
+qint64 PluginSpec::initializeTime() const
+{
+    return d->initializeTime;
+}
+
+/*!
+    \fn qint64 PluginSpec::extensionsInitializedTime() const
+    Microseconds spent in IPlugin::extensionsInitialized().
+*/
+qint64 PluginSpec::extensionsInitializedTime() const
+{
+    return d->extensionsInitializedTime;
+}
+
 /*!
     \fn bool PluginSpec::provides(const QString &pluginName, const QString &version) const
     Returns if this plugin can be used to fill in a dependency of the given
@@ -384,6 +411,9 @@ PluginSpecPrivate::PluginSpecPrivate(PluginSpec *spec)
     : plugin(0),
     state(PluginSpec::Invalid),
     hasError(false),
+    loadTime(0),
+    initializeTime(0),
+    extensionsInitializedTime(0),
     q(spec)
 {
 }
@@ -746,20 +776,11 @@ bool PluginSpecPrivate::resolveDependencies(const QList<PluginSpec *> &specs)
 }
 
 /*!
-    \fn bool PluginSpecPrivate::loadLibrary()
+    \fn QString PluginSpecPrivate::libraryName() const
     \internal
 */
-bool PluginSpecPrivate::loadLibrary()
+QString PluginSpecPrivate::libraryName() const
 {
-    if (hasError)
-        return false;
-    if (state != PluginSpec::Resolved) {
-        if (state == PluginSpec::Loaded)
-            return true;
-        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
-        hasError = true;
-        return false;
-    }
 #ifdef QT_NO_DEBUG
 
 #ifdef Q_OS_WIN
@@ -782,6 +803,42 @@ bool PluginSpecPrivate::loadLibrary()
 
 #endif
 
+    return libName;
+}
+
+/*!
+    \fn bool PluginSpecPrivate::preloadLibrary()
+    \internal
+    Maps the plugin's library into the process without creating the plugin
+    instance, so it can run on a worker thread. loadLibrary() then finds the
+    library loaded, and reports any error.
+*/
+bool PluginSpecPrivate::preloadLibrary()
+{
+    if (hasError || state != PluginSpec::Resolved)
+        return false;
+
+    PluginLoader loader(libraryName());
+    return loader.load();
+}
+
+/*!
+    \fn bool PluginSpecPrivate::loadLibrary()
+    \internal
+*/
+bool PluginSpecPrivate::loadLibrary()
+{
+    if (hasError)
+        return false;
+    if (state != PluginSpec::Resolved) {
+        if (state == PluginSpec::Loaded)
+            return true;
+        errorString = QCoreApplication::translate("PluginSpec", "Loading the library failed because state != Resolved");
+        hasError = true;
+        return false;
+    }
+
+    QString libName = libraryName();
     PluginLoader loader(libName);
     if (!loader.load()) {
         hasError = true;
@@ -856,6 +913,18 @@ bool PluginSpecPrivate::initializeExtensions()
     return true;
 }
 
+/*!
+    \fn bool PluginSpecPrivate::delayedInitialize()
+    \internal
+    Returns true if the plugin did time consuming work.
+*/
+bool PluginSpecPrivate::delayedInitialize()
+{
+    if (hasError || state != PluginSpec::Running || !plugin)
+        return false;
+    return plugin->delayedInitialize();
+}
+
 /*!
     \fn bool PluginSpecPrivate::stop()
     \internal
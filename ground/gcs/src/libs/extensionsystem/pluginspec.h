@@ -102,6 +102,11 @@ public:
     bool hasError() const;
     QString errorString() const;
 
+    // startup wall times in microseconds
+    qint64 loadTime() const;
+    qint64 initializeTime() const;
+    qint64 extensionsInitializedTime() const;
+
 private:
     PluginSpec();
 
@@ -51,9 +51,12 @@ public:
     bool read(const QString &fileName);
     bool provides(const QString &pluginName, const QString &version) const;
     bool resolveDependencies(const QList<PluginSpec *> &specs);
+    QString libraryName() const;
+    bool preloadLibrary();
     bool loadLibrary();
     bool initializePlugin();
     bool initializeExtensions();
+    bool delayedInitialize();
     void stop();
     void kill();
 
@@ -79,6 +82,10 @@ public:
     bool hasError;
     QString errorString;
 
+    qint64 loadTime;
+    qint64 initializeTime;
+    qint64 extensionsInitializedTime;
+
     static bool isValidVersion(const QString &version);
     static int versionCompare(const QString &version1, const QString &version2);
 
@@ -79,6 +79,7 @@ PluginView::PluginView(PluginManager *manager, QWidget *parent)
     header->setSectionResizeMode(0, QHeaderView::ResizeToContents);
     header->setSectionResizeMode(1, QHeaderView::ResizeToContents);
     header->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+    header->setSectionResizeMode(3, QHeaderView::ResizeToContents);
     m_ui->pluginWidget->sortItems(1, Qt::AscendingOrder);
     p->manager = manager;
     connect(p->manager, SIGNAL(pluginsChanged()), this, SLOT(updateList()));
@@ -122,9 +123,18 @@ void PluginView::updateList()
             << ""
             << spec->name()
             << QString("%1 (%2)").arg(spec->version()).arg(spec->compatVersion())
+            << ""
             << spec->vendor()
             << QDir::toNativeSeparators(spec->filePath()));
-        item->setToolTip(4, QDir::toNativeSeparators(spec->filePath()));
+        // A number, so the column sorts by time
+        const qint64 startupTime = spec->loadTime() + spec->initializeTime()
+                + spec->extensionsInitializedTime();
+        item->setData(3, Qt::DisplayRole, qRound(startupTime / 100.0) / 10.0);
+        item->setToolTip(3, tr("Load %1 ms, initialize %2 ms, extensionsInitialized %3 ms")
+                         .arg(spec->loadTime() / 1000.0, 0, 'f', 1)
+                         .arg(spec->initializeTime() / 1000.0, 0, 'f', 1)
+                         .arg(spec->extensionsInitializedTime() / 1000.0, 0, 'f', 1));
+        item->setToolTip(5, QDir::toNativeSeparators(spec->filePath()));
         item->setIcon(0, spec->hasError() ? errorIcon : okIcon);
         item->setData(0, Qt::UserRole, qVariantFromValue(spec));
         items.append(item);
@@ -0,0 +1,164 @@
+/**
+ ******************************************************************************
+ *
+ * @file       startupprofiler.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      Records how long plugins and gadgets take to come up
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "startupprofiler.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMutex>
+#include <QtCore/QMutexLocker>
+#include <QtCore/QThread>
+
+/*!
+    \class ExtensionSystem::StartupProfiler
+    \brief Collects the wall time of the steps that bring the application up.
+
+    The plugin manager records loading, initialize(), extensionsInitialized()
+    and delayedInitialize() of every plugin, other code can add its own
+    events with a StartupProfiler::Scope. The events can be written out in
+    the Chrome trace event format, to be looked at in chrome://tracing.
+*/
+
+using namespace ExtensionSystem;
+
+namespace {
+
+struct ProfilerData
+{
+    ProfilerData() { timer.start(); }
+
+    QElapsedTimer timer;
+    QMutex lock;
+    QList<StartupProfiler::Event> events;
+};
+
+} // namespace
+
+Q_GLOBAL_STATIC(ProfilerData, profilerData)
+
+/*!
+    \fn qint64 StartupProfiler::now()
+    Microseconds since the profiler started, which is when the plugin
+    manager is created.
+*/
+qint64 StartupProfiler::now()
+{
+    return profilerData()->timer.nsecsElapsed() / 1000;
+}
+
+/*!
+    \fn void StartupProfiler::addEvent(const QString &name, const QString &category, qint64 start, qint64 duration)
+    Records an event of the calling thread. May be called from any thread.
+*/
+void StartupProfiler::addEvent(const QString &name, const QString &category, qint64 start,
+                               qint64 duration)
+{
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.start = start;
+    event.duration = duration;
+    event.thread = (quint64)(quintptr)QThread::currentThreadId();
+
+    ProfilerData *data = profilerData();
+    QMutexLocker locker(&data->lock);
+    data->events.append(event);
+}
+
+/*!
+    \fn QList<StartupProfiler::Event> StartupProfiler::events()
+    All events recorded so far, in the order they ended.
+*/
+QList<StartupProfiler::Event> StartupProfiler::events()
+{
+    ProfilerData *data = profilerData();
+    QMutexLocker locker(&data->lock);
+    return data->events;
+}
+
+/*!
+    \fn bool StartupProfiler::writeChromeTrace(const QString &fileName, QString *errorString)
+    Writes the events as complete events of the Chrome trace event format.
+*/
+bool StartupProfiler::writeChromeTrace(const QString &fileName, QString *errorString)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    QJsonArray traceEvents;
+    foreach (const Event &event, events()) {
+        QJsonObject obj;
+        obj["name"] = event.name;
+        obj["cat"] = event.category;
+        obj["ph"] = QString("X");
+        obj["ts"] = (double)event.start;
+        obj["dur"] = (double)event.duration;
+        obj["pid"] = (double)pid;
+        obj["tid"] = (double)event.thread;
+        traceEvents.append(obj);
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = traceEvents;
+    trace["displayTimeUnit"] = QString("ms");
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    if (file.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) < 0) {
+        if (errorString)
+            *errorString = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+/*!
+    \class ExtensionSystem::StartupProfiler::Scope
+    \brief Records an event from its construction to its destruction.
+*/
+StartupProfiler::Scope::Scope(const QString &name, const QString &category)
+    : m_name(name), m_category(category), m_start(StartupProfiler::now())
+{
+}
+
+StartupProfiler::Scope::~Scope()
+{
+    StartupProfiler::addEvent(m_name, m_category, m_start, elapsed());
+}
+
+/*!
+    \fn qint64 StartupProfiler::Scope::elapsed() const
+    Microseconds since the scope was entered.
+*/
+qint64 StartupProfiler::Scope::elapsed() const
+{
+    return StartupProfiler::now() - m_start;
+}
@@ -0,0 +1,73 @@
+/**
+ ******************************************************************************
+ *
+ * @file       startupprofiler.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      Records how long plugins and gadgets take to come up
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef EXTENSIONSYSTEM_STARTUPPROFILER_H
+#define EXTENSIONSYSTEM_STARTUPPROFILER_H
+
+#include "extensionsystem_global.h"
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+namespace ExtensionSystem {
+
+class EXTENSIONSYSTEM_EXPORT StartupProfiler
+{
+public:
+    struct Event
+    {
+        QString name;
+        QString category;
+        // Microseconds since the profiler started
+        qint64 start;
+        qint64 duration;
+        quint64 thread;
+    };
+
+    // Times the scope it is declared in
+    class EXTENSIONSYSTEM_EXPORT Scope
+    {
+    public:
+        Scope(const QString &name, const QString &category);
+        ~Scope();
+
+        qint64 elapsed() const;
+
+    private:
+        QString m_name;
+        QString m_category;
+        qint64 m_start;
+    };
+
+    static qint64 now();
+    static void addEvent(const QString &name, const QString &category, qint64 start,
+                         qint64 duration);
+    static QList<Event> events();
+
+    static bool writeChromeTrace(const QString &fileName, QString *errorString = 0);
+};
+
+} // namespace ExtensionSystem
+
+#endif // EXTENSIONSYSTEM_STARTUPPROFILER_H
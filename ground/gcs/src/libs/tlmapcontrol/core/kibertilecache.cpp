@@ -33,6 +33,7 @@ namespace core {
     {
         memoryCacheSize = 0;
         _MemoryCacheCapacity = 22;
+        decodedTiles.setMaxCost(64*1024);
     }
 
     void KiberTileCache::setMemoryCacheCapacity(const int &value)
@@ -67,4 +68,37 @@ namespace core {
         qDebug()<<"Cleaning Memory cache="<<" ended with "<<cachequeue.count()<<" tile "<<"ocupying "<<memoryCacheSize<<" bytes";
 #endif
     }
+
+    QPixmap KiberTileCache::DecodedTile(const RawTile &tile,const QByteArray &data)
+    {
+        // User images can change under the same key, don't keep them
+        RawTile key=tile;
+        if(key.Type()==MapType::UserImage)
+            return QPixmap::fromImage(QImage::fromData(data));
+
+        QPixmap *pic=decodedTiles.object(key);
+        if(pic)
+            return *pic;
+
+        // Convert once to the format the raster engine blits without
+        // conversion instead of on every paint
+        QImage image=QImage::fromData(data);
+        if(image.isNull())
+            return QPixmap();
+        if(image.format()!=QImage::Format_ARGB32_Premultiplied && image.hasAlphaChannel())
+            image=image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        pic=new QPixmap(QPixmap::fromImage(image));
+
+        int cost=qMax(1,pic->width()*pic->height()*pic->depth()/8/1024);
+#ifdef DEBUG_MEMORY_CACHE
+        qDebug()<<"Decoded tile"<<key.ToString()<<cost<<"KiB, decoded cache holds"<<decodedTiles.totalCost()<<"KiB";
+#endif
+        QPixmap ret=*pic;
+        decodedTiles.insert(key,pic,cost);
+        return ret;
+    }
+    void KiberTileCache::setDecodedCacheCapacity(const int &value)
+    {
+        decodedTiles.setMaxCost(value*1024);
+    }
 }
@@ -31,6 +31,8 @@
 #include <QMutex>
 #include <QReadWriteLock>
 #include <QQueue>
+#include <QCache>
+#include <QPixmap>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
@@ -47,8 +49,23 @@ namespace core {
         QHash <RawTile,QByteArray> cachequeue;
         QQueue <RawTile> list;
         long memoryCacheSize;
+
+        /**
+        * @brief Returns the decoded pixmap of a tile, decoding and caching
+        * it on a miss. The decoded tier is a least recently used cache
+        * bounded in bytes, shared by every map widget. Pixmaps are GUI
+        * objects, so this must only be called from the GUI thread.
+        *
+        * @param tile key of the tile, including its layer type
+        * @param data compressed image data of the tile
+        */
+        QPixmap DecodedTile(const RawTile &tile,const QByteArray &data);
+        void setDecodedCacheCapacity(const int &value); //In MB
+        int DecodedCacheCapacity(){return decodedTiles.maxCost()/1024;}
+        double DecodedCacheSize(){return decodedTiles.totalCost()/1024.0;}
     private:
         int _MemoryCacheCapacity;
+        QCache <RawTile,QPixmap> decodedTiles; //Cost in KiB
 
     };
 
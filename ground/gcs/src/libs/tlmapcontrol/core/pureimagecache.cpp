@@ -27,19 +27,132 @@
 #include "pureimagecache.h"
 #include <QDateTime>
 #include <QSettings>
+#include <QReadLocker>
+#include <QThreadPool>
+#include <QRunnable>
 //#define DEBUG_PUREIMAGECACHE
 namespace core {
     qlonglong PureImageCache::ConnCounter=0;
 
     PureImageCache::PureImageCache()
+        : generation(0)
+        , maxCacheSize(0)
     {
 
     }
 
+    namespace {
+        class MaintenanceTask:public QRunnable
+        {
+        public:
+            MaintenanceTask(PureImageCache *cache):cache(cache){}
+            void run(){cache->RunMaintenance();}
+        private:
+            PureImageCache *cache;
+        };
+    }
+
+    PureImageCache::Connection::Connection(const QString &file, quint32 generation)
+        : generation(generation)
+        , selectTile(0)
+        , existsTile(0)
+        , insertTile(0)
+        , insertTileData(0)
+        , touchTile(0)
+        , open(false)
+    {
+        name=QString("PureImageCache%1").arg(ConnCounter++);
+        QSqlDatabase cn=QSqlDatabase::addDatabase("QSQLITE",name);
+        cn.setDatabaseName(file);
+        if(!cn.open())
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"Connection: "<<cn.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            return;
+        }
+        PrepareDB(cn);
+
+        selectTile=new QSqlQuery(cn);
+        selectTile->prepare("SELECT Tiles.id, Tiles.LastAccess, TilesData.Tile FROM Tiles, TilesData WHERE Tiles.X=? AND Tiles.Y=? AND Tiles.Zoom=? AND Tiles.Type=? AND TilesData.id=Tiles.id");
+        existsTile=new QSqlQuery(cn);
+        existsTile->prepare("SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?");
+        insertTile=new QSqlQuery(cn);
+        insertTile->prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date,LastAccess) VALUES(?, ?, ?, ?,?,?)");
+        insertTileData=new QSqlQuery(cn);
+        insertTileData->prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+        touchTile=new QSqlQuery(cn);
+        touchTile->prepare("UPDATE Tiles SET LastAccess=? WHERE id=?");
+        open=true;
+    }
+
+    PureImageCache::Connection::~Connection()
+    {
+        delete selectTile;
+        delete existsTile;
+        delete insertTile;
+        delete insertTileData;
+        delete touchTile;
+        {
+            QSqlDatabase cn=QSqlDatabase::database(name,false);
+            cn.close();
+        }
+        QSqlDatabase::removeDatabase(name);
+    }
+
+    /**
+     * Get the connection of the calling thread, opening it on first use
+     * @return NULL if the database can't be opened
+     */
+    PureImageCache::Connection *PureImageCache::connection()
+    {
+        Connection *conn=connections.localData();
+        if(conn && conn->generation==generation)
+            return conn;
+
+        // Replaces, and closes, the connection to the previous cache location
+        Mcounter.lock();
+        conn=new Connection(gtilecache+"Data.qmdb",generation);
+        Mcounter.unlock();
+        connections.setLocalData(conn);
+
+        return conn->isOpen()?conn:0;
+    }
+
+    /**
+     * Set up a freshly opened database: write ahead logging lets the readers
+     * go on while tiles are written, and the index makes tile lookups cheap.
+     * Databases created by older versions get the index and the access date
+     * used for eviction here too.
+     */
+    void PureImageCache::PrepareDB(QSqlDatabase &db)
+    {
+        QSqlQuery query(db);
+        query.exec("PRAGMA journal_mode=WAL");
+        query.exec("PRAGMA synchronous=NORMAL");
+        query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+
+        bool hasAccess=false;
+        query.exec("PRAGMA table_info(Tiles)");
+        while(query.next())
+            hasAccess|=(query.value(1).toString()=="LastAccess");
+        if(!hasAccess)
+            query.exec("ALTER TABLE Tiles ADD COLUMN LastAccess INTEGER NOT NULL DEFAULT 0");
+        query.exec("CREATE INDEX IF NOT EXISTS IndexOfTilesAccess ON Tiles (LastAccess)");
+    }
+    qint64 PureImageCache::PragmaValue(QSqlDatabase &db, const QString &pragma)
+    {
+        QSqlQuery query(db);
+        if(query.exec("PRAGMA "+pragma) && query.next())
+            return query.value(0).toLongLong();
+        return 0;
+    }
+
     void PureImageCache::setGtileCache(const QString &value)
     {
         lock.lockForWrite();
         gtilecache=value;
+        generation++;
         QDir d;
         if(!d.exists(gtilecache))
         {
@@ -59,6 +172,7 @@ namespace core {
             }
         }
         lock.unlock();
+        ScheduleMaintenance();
     }
     QString PureImageCache::GtileCache()
     {
@@ -104,7 +218,18 @@ namespace core {
                 return false;
             }
             QSqlQuery query(db);
-            query.exec("CREATE TABLE IF NOT EXISTS Tiles (id INTEGER NOT NULL PRIMARY KEY, X INTEGER NOT NULL, Y INTEGER NOT NULL, Zoom INTEGER NOT NULL, Type INTEGER NOT NULL,Date TEXT)");
+            // Has to be set before the first table is created
+            query.exec("PRAGMA auto_vacuum=INCREMENTAL");
+            query.exec("CREATE TABLE IF NOT EXISTS Tiles (id INTEGER NOT NULL PRIMARY KEY, X INTEGER NOT NULL, Y INTEGER NOT NULL, Zoom INTEGER NOT NULL, Type INTEGER NOT NULL,Date TEXT, LastAccess INTEGER NOT NULL DEFAULT 0)");
+            if(query.numRowsAffected()==-1)
+            {
+#ifdef DEBUG_PUREIMAGECACHE
+                qDebug()<<"CreateEmptyDB: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+                db.close();
+                return false;
+            }
+            query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
             if(query.numRowsAffected()==-1)
             {
 #ifdef DEBUG_PUREIMAGECACHE
@@ -175,87 +300,284 @@ namespace core {
     {
         if(gtilecache.isEmpty()|gtilecache.isNull())
             return false;
-        lock.lockForRead();
+        QReadLocker locker(&lock);
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug()<<"PutImageToCache Start:";//<<pos;
 #endif //DEBUG_PUREIMAGECACHE
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+        Connection *conn=connection();
+        if(!conn)
+            return false;
+
+        conn->insertTile->addBindValue(pos.X());
+        conn->insertTile->addBindValue(pos.Y());
+        conn->insertTile->addBindValue(zoom);
+        conn->insertTile->addBindValue((int)type);
+        conn->insertTile->addBindValue(QDateTime::currentDateTime().toString());
+        conn->insertTile->addBindValue(QDateTime::currentDateTime().toTime_t());
+        if(!conn->insertTile->exec())
+            return false;
+
+        conn->insertTileData->addBindValue(tile);
+        if(!conn->insertTileData->exec())
+            return false;
+
+        if(writesSinceMaintenance.fetchAndAddRelaxed(1)+1>=MAINTENANCE_INTERVAL)
         {
-            QSqlDatabase cn;
-            cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-            QString db=gtilecache+"Data.qmdb";
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if(cn.open())
+            writesSinceMaintenance.store(0);
+            ScheduleMaintenance();
+        }
+        return true;
+    }
+
+    /**
+     * Group the following PutImageToCache calls of this thread into one
+     * transaction, which is much cheaper than one per tile
+     */
+    bool PureImageCache::BeginWriteBatch()
+    {
+        if(gtilecache.isEmpty()|gtilecache.isNull())
+            return false;
+        QReadLocker locker(&lock);
+        Connection *conn=connection();
+        if(!conn)
+            return false;
+        return QSqlDatabase::database(conn->name,false).transaction();
+    }
+
+    /**
+     * Commit the tiles written since BeginWriteBatch
+     */
+    bool PureImageCache::EndWriteBatch()
+    {
+        QReadLocker locker(&lock);
+        Connection *conn=connections.localData();
+        if(!conn || !conn->isOpen())
+            return false;
+        return QSqlDatabase::database(conn->name,false).commit();
+    }
+
+    QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
+    {
+        QByteArray ar;
+        QReadLocker locker(&lock);
+        if(!(gtilecache.isEmpty()|gtilecache.isNull()))
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"Cache dir="<<gtilecache<<" Try to GET:"<<pos.X()+","+pos.Y();
+#endif //DEBUG_PUREIMAGECACHE
+            Connection *conn=connection();
+            if(conn)
             {
+                conn->selectTile->addBindValue(pos.X());
+                conn->selectTile->addBindValue(pos.Y());
+                conn->selectTile->addBindValue(zoom);
+                conn->selectTile->addBindValue((int)type);
+                qint64 id=-1;
+                uint lastAccess=0;
+                if(conn->selectTile->exec() && conn->selectTile->next())
                 {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                    query.addBindValue(pos.X());
-                    query.addBindValue(pos.Y());
-                    query.addBindValue(zoom);
-
-                    query.addBindValue((int)type);
-                    query.addBindValue(QDateTime::currentDateTime().toString());
-                    query.exec();
+                    id=conn->selectTile->value(0).toLongLong();
+                    lastAccess=conn->selectTile->value(1).toUInt();
+                    ar=conn->selectTile->value(2).toByteArray();
                 }
+                conn->selectTile->finish();
+
+                // Eviction only needs a coarse access date, so most reads
+                // stay free of writes
+                uint now=QDateTime::currentDateTime().toTime_t();
+                if(id>=0 && lastAccess+ACCESS_RESOLUTION<now)
                 {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                    query.addBindValue(tile);
-                    query.exec();
+                    conn->touchTile->addBindValue(now);
+                    conn->touchTile->addBindValue(id);
+                    conn->touchTile->exec();
+                    conn->touchTile->finish();
                 }
-                cn.close();
             }
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
+
+        // Fall back to the read only packs, in the order they were mounted
+        for(int i=0;ar.isEmpty() && i<packs.count();++i)
+            ar=packs.at(i)->GetImage(type,pos,zoom);
+        return ar;
+    }
+
+    /**
+     * Check for a tile without reading its image out of the database
+     */
+    bool PureImageCache::HasImageInCache(MapType::Types type, Point pos, int zoom)
+    {
+        bool found=false;
+        QReadLocker locker(&lock);
+        if(!(gtilecache.isEmpty()|gtilecache.isNull()))
+        {
+            Connection *conn=connection();
+            if(conn)
+            {
+                conn->existsTile->addBindValue(pos.X());
+                conn->existsTile->addBindValue(pos.Y());
+                conn->existsTile->addBindValue(zoom);
+                conn->existsTile->addBindValue((int)type);
+                found=conn->existsTile->exec() && conn->existsTile->next();
+                conn->existsTile->finish();
+            }
+        }
+        for(int i=0;!found && i<packs.count();++i)
+            found=!packs.at(i)->GetImage(type,pos,zoom).isEmpty();
+        return found;
+    }
+
+    /**
+     * Add a tile pack as a read only cache layer, searched after the database
+     */
+    bool PureImageCache::MountTilePack(const QString &file)
+    {
+        TilePack *pack=new TilePack;
+        if(!pack->Open(file))
+        {
+            delete pack;
+            return false;
+        }
+        lock.lockForWrite();
+        packs.append(pack);
         lock.unlock();
         return true;
     }
-    QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
+    void PureImageCache::UnmountTilePacks()
     {
-        lock.lockForRead();
-        QByteArray ar;
+        lock.lockForWrite();
+        qDeleteAll(packs);
+        packs.clear();
+        lock.unlock();
+    }
+    QStringList PureImageCache::MountedTilePacks()
+    {
+        QReadLocker locker(&lock);
+        QStringList ret;
+        foreach(TilePack *pack,packs)
+            ret.append(pack->FileName());
+        return ret;
+    }
+
+    /**
+     * Cap the database size, 0 for no limit. Tiles not read for the longest
+     * time are evicted by the background maintenance.
+     */
+    void PureImageCache::setMaxCacheSize(qint64 const& bytes)
+    {
+        lock.lockForWrite();
+        maxCacheSize=qMax(Q_INT64_C(0),bytes);
+        lock.unlock();
+        ScheduleMaintenance();
+    }
+    qint64 PureImageCache::MaxCacheSize()
+    {
+        QReadLocker locker(&lock);
+        return maxCacheSize;
+    }
+
+    bool PureImageCache::GetCacheStats(CacheStats &stats)
+    {
+        stats.tiles=stats.fileSize=stats.freeSize=0;
+        QReadLocker locker(&lock);
         if(gtilecache.isEmpty()|gtilecache.isNull())
-            return ar;
-        QString dir=gtilecache;
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
-#ifdef DEBUG_PUREIMAGECACHE
-        qDebug()<<"Cache dir="<<dir<<" Try to GET:"<<pos.X()+","+pos.Y();
-#endif //DEBUG_PUREIMAGECACHE
+            return false;
+        Connection *conn=connection();
+        if(!conn)
+            return false;
+        QSqlDatabase db=QSqlDatabase::database(conn->name,false);
+        qint64 pageSize=PragmaValue(db,"page_size");
+        stats.fileSize=PragmaValue(db,"page_count")*pageSize;
+        stats.freeSize=PragmaValue(db,"freelist_count")*pageSize;
+        QSqlQuery query(db);
+        if(query.exec("SELECT COUNT(*) FROM Tiles") && query.next())
+            stats.tiles=query.value(0).toLongLong();
+        return true;
+    }
+
+    /**
+     * Run RunMaintenance on the global thread pool, unless it already runs
+     */
+    void PureImageCache::ScheduleMaintenance()
+    {
+        if(!maintenanceRunning.testAndSetAcquire(0,1))
+            return;
+        QThreadPool::globalInstance()->start(new MaintenanceTask(this));
+    }
 
+    /**
+     * Evict the least recently read tiles until the database is back under
+     * 90% of its cap, then hand the freed pages back to the file system a
+     * step at a time so tile loaders are never held up for long
+     */
+    void PureImageCache::RunMaintenance()
+    {
+        lock.lockForRead();
+        QString file=gtilecache+"Data.qmdb";
+        qint64 cap=maxCacheSize;
+        bool enabled=!(gtilecache.isEmpty()|gtilecache.isNull()) && QFileInfo(file).exists();
+        lock.unlock();
+
+        if(enabled)
         {
-            QString db=dir+"Data.qmdb";
+            Mcounter.lock();
+            QString name=QString("PureImageCacheMaintenance%1").arg(ConnCounter++);
+            Mcounter.unlock();
             {
-                QSqlDatabase cn;
+                QSqlDatabase db=QSqlDatabase::addDatabase("QSQLITE",name);
+                db.setDatabaseName(file);
+                db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+                if(db.open())
+                {
+                    PrepareDB(db);
+                    QSqlQuery query(db);
 
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
+                    // Databases created before incremental vacuum need one full
+                    // vacuum for the setting to take effect
+                    if(PragmaValue(db,"auto_vacuum")!=2)
+                    {
+#ifdef DEBUG_PUREIMAGECACHE
+                        qDebug()<<"RunMaintenance: enabling incremental vacuum";
+#endif //DEBUG_PUREIMAGECACHE
+                        query.exec("PRAGMA auto_vacuum=INCREMENTAL");
+                        query.exec("VACUUM");
+                    }
 
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
-                {
+                    qint64 pageSize=PragmaValue(db,"page_size");
+                    qint64 lowWater=cap/10*9;
+                    int evicted=0;
+                    while(cap>0)
                     {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int) type));
-                        query.next();
-                        if(query.isValid())
-                        {
-                            ar=query.value(0).toByteArray();
-                        }
+                        qint64 used=(PragmaValue(db,"page_count")-PragmaValue(db,"freelist_count"))*pageSize;
+                        if(used<=(evicted?lowWater:cap))
+                            break;
+                        if(!query.exec(QString("DELETE FROM Tiles WHERE id IN (SELECT id FROM Tiles ORDER BY LastAccess LIMIT %1)").arg(EVICT_BATCH))
+                                || query.numRowsAffected()<=0)
+                            break;
+                        evicted+=query.numRowsAffected();
                     }
-                    cn.close();
+
+                    qint64 free=PragmaValue(db,"freelist_count");
+                    while(free>0)
+                    {
+                        query.exec(QString("PRAGMA incremental_vacuum(%1)").arg(VACUUM_STEP));
+                        while(query.next()) {}
+                        qint64 left=PragmaValue(db,"freelist_count");
+                        if(left>=free)
+                            break;
+                        free=left;
+                    }
+#ifdef DEBUG_PUREIMAGECACHE
+                    qDebug()<<"RunMaintenance: evicted"<<evicted<<"tiles, size now"<<PragmaValue(db,"page_count")*pageSize;
+#endif //DEBUG_PUREIMAGECACHE
+                    query.finish();
+                    db.close();
                 }
             }
+            QSqlDatabase::removeDatabase(name);
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
-        lock.unlock();
-        return ar;
+        maintenanceRunning.store(0);
     }
+
     void PureImageCache::deleteOlderTiles(int const& days)
     {
         if(gtilecache.isEmpty()|gtilecache.isNull())
@@ -353,4 +675,99 @@ namespace core {
 
     }
 
+    /**
+     * Write every tile of a cache database into a tile pack
+     */
+    bool PureImageCache::ExportMapDataToPack(QString sourceFile, QString packFile)
+    {
+        bool ret=false;
+        {
+            QSqlDatabase ca = QSqlDatabase::addDatabase("QSQLITE","packsource");
+            ca.setDatabaseName(sourceFile);
+            if(QFileInfo(sourceFile).exists() && ca.open())
+            {
+                TilePack::Writer writer;
+                if(writer.Open(packFile))
+                {
+                    QSqlQuery query(ca);
+                    query.setForwardOnly(true);
+                    ret=query.exec("SELECT Tiles.X, Tiles.Y, Tiles.Zoom, Tiles.Type, TilesData.Tile FROM Tiles JOIN TilesData ON Tiles.id = TilesData.id");
+                    while(ret && query.next())
+                    {
+                        // Tiles out of the pack key range are skipped, not fatal
+                        writer.Add((MapType::Types)query.value(3).toInt(),Point(query.value(0).toLongLong(),query.value(1).toLongLong()),
+                                   query.value(2).toInt(),query.value(4).toByteArray());
+                    }
+                    ret=writer.Close() && ret;
+                }
+                ca.close();
+            }
+        }
+        QSqlDatabase::removeDatabase("packsource");
+        return ret;
+    }
+
+    /**
+     * Copy the tiles of a pack that a cache database is missing into it
+     */
+    bool PureImageCache::ImportMapDataFromPack(QString packFile, QString destFile)
+    {
+        TilePack pack;
+        if(!pack.Open(packFile))
+            return false;
+        if(!QFileInfo(destFile).exists() && !CreateEmptyDB(destFile))
+            return false;
+
+        bool ret=false;
+        {
+            QSqlDatabase cb = QSqlDatabase::addDatabase("QSQLITE","packdest");
+            cb.setDatabaseName(destFile);
+            if(cb.open())
+            {
+                PrepareDB(cb);
+                QSqlQuery exists(cb);
+                exists.prepare("SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?");
+                QSqlQuery insertTile(cb);
+                insertTile.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
+                QSqlQuery insertTileData(cb);
+                insertTileData.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+
+                QString date=QDateTime::currentDateTime().toString();
+                ret=cb.transaction();
+                for(int i=0;ret && i<pack.Count();++i)
+                {
+                    MapType::Types type;
+                    Point pos;
+                    int zoom;
+                    QByteArray data;
+                    if(!pack.EntryAt(i,type,pos,zoom,data))
+                        continue;
+
+                    exists.addBindValue(pos.X());
+                    exists.addBindValue(pos.Y());
+                    exists.addBindValue(zoom);
+                    exists.addBindValue((int)type);
+                    bool found=exists.exec() && exists.next();
+                    exists.finish();
+                    if(found)
+                        continue;
+
+                    insertTile.addBindValue(pos.X());
+                    insertTile.addBindValue(pos.Y());
+                    insertTile.addBindValue(zoom);
+                    insertTile.addBindValue((int)type);
+                    insertTile.addBindValue(date);
+                    insertTileData.addBindValue(data);
+                    ret=insertTile.exec() && insertTileData.exec();
+                }
+                ret=(ret && cb.commit());
+                if(!ret)
+                    cb.rollback();
+                cb.close();
+            }
+        }
+        QSqlDatabase::removeDatabase("packdest");
+        return ret;
+    }
+
 }
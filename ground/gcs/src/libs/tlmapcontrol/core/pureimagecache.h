@@ -40,8 +40,12 @@
 #include <QVariant>
 #include "pureimage.h"
 #include <QList>
+#include <QStringList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include "tilepack.h"
 namespace core {
     class PureImageCache
     {
@@ -51,14 +55,70 @@ namespace core {
         static bool CreateEmptyDB(const QString &file);
         bool PutImageToCache(const QByteArray &tile,const MapType::Types &type,const core::Point &pos, const int &zoom);
         QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
+        bool HasImageInCache(MapType::Types type, core::Point pos, int zoom);
+        bool BeginWriteBatch();
+        bool EndWriteBatch();
         QString GtileCache();
         void setGtileCache(const QString &value);
         static bool ExportMapDataToDB(QString sourceFile, QString destFile);
+        static bool ExportMapDataToPack(QString sourceFile, QString packFile);
+        static bool ImportMapDataFromPack(QString packFile, QString destFile);
+        bool MountTilePack(const QString &file);
+        void UnmountTilePacks();
+        QStringList MountedTilePacks();
         void deleteOlderTiles(int const& days);
+
+        struct CacheStats
+        {
+            qint64 tiles;
+            qint64 fileSize; //Bytes on disk
+            qint64 freeSize; //Bytes not yet returned by the incremental vacuum
+        };
+        bool GetCacheStats(CacheStats &stats);
+        void setMaxCacheSize(qint64 const& bytes);
+        qint64 MaxCacheSize();
+        void ScheduleMaintenance();
+        void RunMaintenance();
     private:
+        /**
+         * Database connection of one thread, kept open with its statements
+         * prepared until the thread exits or the cache moves
+         */
+        class Connection
+        {
+        public:
+            Connection(const QString &file, quint32 generation);
+            ~Connection();
+            bool isOpen() const { return open; }
+
+            QString name;
+            quint32 generation;
+            QSqlQuery *selectTile;
+            QSqlQuery *existsTile;
+            QSqlQuery *insertTile;
+            QSqlQuery *insertTileData;
+            QSqlQuery *touchTile;
+        private:
+            bool open;
+        };
+
+        Connection *connection();
+        static void PrepareDB(QSqlDatabase &db);
+        static qint64 PragmaValue(QSqlDatabase &db, const QString &pragma);
+        static const int ACCESS_RESOLUTION=3600; //Seconds between access date updates of a tile
+        static const int MAINTENANCE_INTERVAL=256; //Tiles written between background maintenance runs
+        static const int EVICT_BATCH=256; //Tiles deleted per eviction step
+        static const int VACUUM_STEP=1024; //Pages released per incremental vacuum step
+
         QString gtilecache;
+        quint32 generation;
         QMutex Mcounter;
         QReadWriteLock lock;
+        QThreadStorage<Connection *> connections;
+        QList<TilePack *> packs;
+        qint64 maxCacheSize;
+        QAtomicInt writesSinceMaintenance;
+        QAtomicInt maintenanceRunning;
         static qlonglong ConnCounter;
 
     };
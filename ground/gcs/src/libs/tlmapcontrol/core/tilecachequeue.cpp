@@ -79,21 +79,28 @@ void TileCacheQueue::run()
 #endif //DEBUG_TILECACHEQUEUE
     while(true)
     {
-        CacheItemQueue *task;
 #ifdef DEBUG_TILECACHEQUEUE
         qDebug()<<"Cache";
 #endif //DEBUG_TILECACHEQUEUE
         if(tileCacheQueue.count()>0)
         {
+            // Write everything queued so far in a single transaction
+            QList<CacheItemQueue*> batch;
             mutex.lock();
-            task=tileCacheQueue.dequeue();
+            while(tileCacheQueue.count()>0 && batch.count()<MAX_BATCH_SIZE)
+                batch.append(tileCacheQueue.dequeue());
             mutex.unlock();
+
+            Cache::Instance()->ImageCache.BeginWriteBatch();
+            foreach(CacheItemQueue *task,batch)
+            {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Cache engine Put:"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
+                qDebug()<<"Cache engine Put:"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
 #endif //DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
-            usleep(44);
-            delete task;
+                Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
+                delete task;
+            }
+            Cache::Instance()->ImageCache.EndWriteBatch();
         }
 
         else
@@ -0,0 +1,188 @@
+/**
+******************************************************************************
+*
+* @file       tilefetcher.cpp
+* @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+* @brief      Shared asynchronous downloader for map tiles
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   TLMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>
+*/
+#include "tilefetcher.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+//#define DEBUG_TILEFETCHER
+#ifdef DEBUG_TILEFETCHER
+#include <QDebug>
+#endif
+
+namespace core {
+    TileFetcher* TileFetcher::m_pInstance=0;
+
+    TileFetcher* TileFetcher::Instance()
+    {
+        static QMutex instanceLock;
+        QMutexLocker locker(&instanceLock);
+        if(!m_pInstance)
+            m_pInstance=new TileFetcher;
+        return m_pInstance;
+    }
+
+    TileFetcher::TileFetcher():network(0),window(MAX_IN_FLIGHT),generation(0)
+    {
+        thread.setObjectName("TileFetcher");
+        moveToThread(&thread);
+        thread.start();
+    }
+
+    TileFetcher::~TileFetcher()
+    {
+        CancelAll();
+        thread.quit();
+        thread.wait();
+    }
+
+    QByteArray TileFetcher::Fetch(const QNetworkRequest &request,const QNetworkProxy &proxy,int timeout,QNetworkReply::NetworkError &error)
+    {
+        QElapsedTimer elapsed;
+        elapsed.start();
+
+        if(!window.tryAcquire(1,timeout))
+        {
+            error=QNetworkReply::TimeoutError;
+            return QByteArray();
+        }
+
+        Job job;
+        job.request=request;
+        job.proxy=proxy;
+        job.error=QNetworkReply::NoError;
+        job.done=false;
+
+        QMutexLocker locker(&mutex);
+        pending.enqueue(&job);
+        QMetaObject::invokeMethod(this,"startPending",Qt::QueuedConnection);
+
+        while(!job.done)
+        {
+            qint64 remaining=timeout-elapsed.elapsed();
+            if(remaining<=0 || !finishedc.wait(&mutex,remaining))
+            {
+                if(job.done)
+                    break;
+
+                // Nobody may touch the job once we return, so detach it
+                // from whichever list still refers to it.
+                if(pending.removeOne(&job))
+                {
+                    window.release();
+                }
+                else
+                {
+                    QNetworkReply *reply=running.key(&job);
+                    if(reply)
+                    {
+                        running.remove(reply);
+                        QMetaObject::invokeMethod(reply,"abort",Qt::QueuedConnection);
+                    }
+                }
+                job.error=QNetworkReply::TimeoutError;
+                break;
+            }
+        }
+
+#ifdef DEBUG_TILEFETCHER
+        qDebug()<<"TileFetcher:"<<request.url()<<"error"<<job.error<<"in"<<elapsed.elapsed()<<"ms";
+#endif //DEBUG_TILEFETCHER
+        error=job.error;
+        return job.data;
+    }
+
+    void TileFetcher::CancelAll()
+    {
+        QMutexLocker locker(&mutex);
+        ++generation;
+        while(!pending.isEmpty())
+        {
+            Finish(pending.dequeue(),QNetworkReply::OperationCanceledError);
+            window.release();
+        }
+        // The slots of running requests are returned by replyFinished()
+        // once the aborted replies come back
+        foreach(QNetworkReply *reply,running.keys())
+        {
+            Finish(running.take(reply),QNetworkReply::OperationCanceledError);
+            QMetaObject::invokeMethod(reply,"abort",Qt::QueuedConnection);
+        }
+        finishedc.wakeAll();
+    }
+
+    quint32 TileFetcher::Generation()
+    {
+        QMutexLocker locker(&mutex);
+        return generation;
+    }
+
+    void TileFetcher::Finish(Job *job,QNetworkReply::NetworkError error)
+    {
+        job->error=error;
+        job->done=true;
+    }
+
+    void TileFetcher::startPending()
+    {
+        if(!network)
+        {
+            network=new QNetworkAccessManager(this);
+            connect(network,SIGNAL(finished(QNetworkReply*)),this,SLOT(replyFinished(QNetworkReply*)));
+        }
+
+        QMutexLocker locker(&mutex);
+        while(!pending.isEmpty())
+        {
+            Job *job=pending.dequeue();
+            if(!(network->proxy()==job->proxy))
+                network->setProxy(job->proxy);
+
+            QNetworkRequest request=job->request;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 8, 0)
+            request.setAttribute(QNetworkRequest::HTTP2AllowedAttribute,true);
+#endif
+            request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute,true);
+            running.insert(network->get(request),job);
+        }
+    }
+
+    void TileFetcher::replyFinished(QNetworkReply *reply)
+    {
+        {
+            QMutexLocker locker(&mutex);
+            Job *job=running.take(reply);
+            if(job)
+            {
+                if(reply->error()==QNetworkReply::NoError)
+                    job->data=reply->readAll();
+                Finish(job,reply->error());
+                finishedc.wakeAll();
+            }
+        }
+        window.release();
+        reply->deleteLater();
+    }
+}
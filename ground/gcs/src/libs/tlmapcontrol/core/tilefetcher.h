@@ -0,0 +1,111 @@
+/**
+******************************************************************************
+*
+* @file       tilefetcher.h
+* @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+* @brief      Shared asynchronous downloader for map tiles
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   TLMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef TILEFETCHER_H
+#define TILEFETCHER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QQueue>
+#include <QHash>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkRequest>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkProxy>
+
+namespace core {
+    /**
+     * @brief Downloads tiles for all loader threads through a single
+     * QNetworkAccessManager living on its own thread, so keep-alive and
+     * HTTP/2 connections to each provider are reused instead of being torn
+     * down with a per-tile manager and event loop.
+     */
+    class TileFetcher:public QObject
+    {
+        Q_OBJECT
+    public:
+        static TileFetcher* Instance();
+
+        /**
+         * @brief Fetch a tile, blocking the calling loader thread until the
+         * reply arrives, the request times out or it is cancelled
+         * @param request request to issue
+         * @param proxy proxy to use for the request
+         * @param timeout timeout in ms, including time queued for a slot
+         * @param error set to the reply error, TimeoutError or OperationCanceledError
+         * @return the reply body, empty on failure
+         */
+        QByteArray Fetch(const QNetworkRequest &request,const QNetworkProxy &proxy,int timeout,QNetworkReply::NetworkError &error);
+
+        /**
+         * @brief Abort every queued and in-flight request, e.g. when the
+         * viewport changes zoom level and the pending tiles are stale
+         */
+        void CancelAll();
+
+        /**
+         * @brief Counter bumped by every CancelAll(), for loaders to tell
+         * whether their task was cancelled while they were waiting
+         */
+        quint32 Generation();
+
+    private:
+        struct Job
+        {
+            QNetworkRequest request;
+            QNetworkProxy proxy;
+            QByteArray data;
+            QNetworkReply::NetworkError error;
+            bool done;
+        };
+
+        TileFetcher();
+        ~TileFetcher();
+        TileFetcher(const TileFetcher &);
+        TileFetcher& operator=(TileFetcher const&);
+
+        void Finish(Job *job,QNetworkReply::NetworkError error);
+
+        static TileFetcher* m_pInstance;
+        static const int MAX_IN_FLIGHT=8;
+
+        QThread thread;
+        QNetworkAccessManager *network;
+        QSemaphore window;
+        QMutex mutex;
+        QWaitCondition finishedc;
+        QQueue<Job*> pending;
+        QHash<QNetworkReply*,Job*> running;
+        quint32 generation;
+
+    private slots:
+        void startPending();
+        void replyFinished(QNetworkReply *reply);
+    };
+}
+#endif // TILEFETCHER_H
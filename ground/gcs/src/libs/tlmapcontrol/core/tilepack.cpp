@@ -0,0 +1,217 @@
+/**
+******************************************************************************
+*
+* @file       tilepack.cpp
+* @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+* @brief      Single file, memory mapped tile pack for offline use
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   TLMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>
+*/
+#include "tilepack.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+//#define DEBUG_TILEPACK
+#ifdef DEBUG_TILEPACK
+#include <QDebug>
+#endif
+
+namespace core {
+    const char TilePack::MAGIC[8]={'D','R','T','I','L','E','P','K'};
+
+    TilePack::TilePack():map(0),mapSize(0),index(0),count(0)
+    {
+
+    }
+    TilePack::~TilePack()
+    {
+        Close();
+    }
+
+    bool TilePack::Open(const QString &fileName)
+    {
+        Close();
+        file.setFileName(fileName);
+        if(!file.open(QIODevice::ReadOnly))
+            return false;
+
+        mapSize=file.size();
+        if(mapSize>=HEADER_SIZE)
+            map=file.map(0,mapSize);
+        if(!map)
+        {
+            Close();
+            return false;
+        }
+
+        quint32 version=qFromLittleEndian<quint32>(map+8);
+        quint32 entries=qFromLittleEndian<quint32>(map+12);
+        quint64 indexOffset=qFromLittleEndian<quint64>(map+16);
+        if(memcmp(map,MAGIC,sizeof(MAGIC))!=0 || version!=VERSION || indexOffset<(quint64)HEADER_SIZE
+                || indexOffset>(quint64)mapSize || (quint64)entries>((quint64)mapSize-indexOffset)/ENTRY_SIZE)
+        {
+#ifdef DEBUG_TILEPACK
+            qDebug()<<"TilePack: invalid pack"<<fileName;
+#endif //DEBUG_TILEPACK
+            Close();
+            return false;
+        }
+        index=map+indexOffset;
+        count=(int)entries;
+#ifdef DEBUG_TILEPACK
+        qDebug()<<"TilePack: mounted"<<fileName<<"with"<<count<<"tiles";
+#endif //DEBUG_TILEPACK
+        return true;
+    }
+    void TilePack::Close()
+    {
+        if(map)
+            file.unmap(map);
+        file.close();
+        map=0;
+        mapSize=0;
+        index=0;
+        count=0;
+    }
+
+    QByteArray TilePack::GetImage(const MapType::Types &type,const Point &pos,const int &zoom)const
+    {
+        quint64 key;
+        if(!map || !Key(type,pos,zoom,key))
+            return QByteArray();
+
+        int lo=0;
+        int hi=count;
+        while(lo<hi)
+        {
+            int mid=lo+(hi-lo)/2;
+            if(qFromLittleEndian<quint64>(index+mid*ENTRY_SIZE)<key)
+                lo=mid+1;
+            else
+                hi=mid;
+        }
+        if(lo<count && qFromLittleEndian<quint64>(index+lo*ENTRY_SIZE)==key)
+            return Data(index+lo*ENTRY_SIZE);
+        return QByteArray();
+    }
+    bool TilePack::EntryAt(int i,MapType::Types &type,Point &pos,int &zoom,QByteArray &data)const
+    {
+        if(!map || i<0 || i>=count)
+            return false;
+        const uchar *entry=index+i*ENTRY_SIZE;
+        quint64 key=qFromLittleEndian<quint64>(entry);
+        type=(MapType::Types)(key>>48);
+        zoom=(int)((key>>42)&0x3F);
+        pos=Point((key>>21)&0x1FFFFF,key&0x1FFFFF);
+        data=Data(entry);
+        return !data.isEmpty();
+    }
+
+    /**
+     * Tiles are copied out of the mapping, so they stay valid once the pack
+     * is closed
+     */
+    QByteArray TilePack::Data(const uchar *entry)const
+    {
+        quint64 offset=qFromLittleEndian<quint64>(entry+8);
+        quint32 size=qFromLittleEndian<quint32>(entry+16);
+        if(offset>(quint64)mapSize || size>(quint64)mapSize-offset)
+            return QByteArray();
+        return QByteArray((const char*)map+offset,size);
+    }
+
+    /**
+     * 16 bits of type, 6 of zoom and 21 for each coordinate, which covers
+     * every tile up to zoom 21
+     */
+    bool TilePack::Key(const MapType::Types &type,const Point &pos,const int &zoom,quint64 &key)
+    {
+        if(zoom<0 || zoom>MAX_ZOOM || (int)type<0 || (int)type>0xFFFF)
+            return false;
+        qint64 max=Q_INT64_C(1)<<zoom;
+        if(pos.X()<0 || pos.Y()<0 || pos.X()>=max || pos.Y()>=max)
+            return false;
+        key=((quint64)type<<48)|((quint64)zoom<<42)|((quint64)pos.X()<<21)|(quint64)pos.Y();
+        return true;
+    }
+
+    bool TilePack::Writer::Open(const QString &fileName)
+    {
+        index.clear();
+        file.setFileName(fileName);
+        if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+            return false;
+        // Header is written on Close(), once the index offset is known
+        return file.write(QByteArray(HEADER_SIZE,0))==HEADER_SIZE;
+    }
+    bool TilePack::Writer::Add(const MapType::Types &type,const Point &pos,const int &zoom,const QByteArray &data)
+    {
+        Entry entry;
+        if(!file.isOpen() || data.isEmpty() || !Key(type,pos,zoom,entry.key))
+            return false;
+        entry.offset=file.pos();
+        entry.size=data.size();
+        if(file.write(data)!=data.size())
+            return false;
+        index.append(entry);
+        return true;
+    }
+    bool TilePack::Writer::Close()
+    {
+        if(!file.isOpen())
+            return false;
+
+        std::stable_sort(index.begin(),index.end());
+        // Keep the first copy of any tile added twice
+        index.erase(std::unique(index.begin(),index.end(),
+                                [](const Entry &a,const Entry &b){return a.key==b.key;}),index.end());
+
+        // Align the index so it can be read in place
+        qint64 pad=(8-file.pos()%8)%8;
+        bool ok=(file.write(QByteArray(pad,0))==pad);
+        quint64 indexOffset=file.pos();
+
+        QByteArray table(index.count()*ENTRY_SIZE,0);
+        uchar *out=(uchar*)table.data();
+        foreach(const Entry &entry,index)
+        {
+            qToLittleEndian<quint64>(entry.key,out);
+            qToLittleEndian<quint64>(entry.offset,out+8);
+            qToLittleEndian<quint32>(entry.size,out+16);
+            out+=ENTRY_SIZE;
+        }
+        ok=ok && (file.write(table)==table.size());
+
+        QByteArray header(HEADER_SIZE,0);
+        uchar *h=(uchar*)header.data();
+        memcpy(h,MAGIC,sizeof(MAGIC));
+        qToLittleEndian<quint32>(VERSION,h+8);
+        qToLittleEndian<quint32>(index.count(),h+12);
+        qToLittleEndian<quint64>(indexOffset,h+16);
+        ok=ok && file.seek(0) && (file.write(header)==HEADER_SIZE);
+
+#ifdef DEBUG_TILEPACK
+        qDebug()<<"TilePack: wrote"<<index.count()<<"tiles to"<<file.fileName();
+#endif //DEBUG_TILEPACK
+        file.close();
+        index.clear();
+        return ok;
+    }
+}
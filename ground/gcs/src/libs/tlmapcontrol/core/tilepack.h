@@ -0,0 +1,102 @@
+/**
+******************************************************************************
+*
+* @file       tilepack.h
+* @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+* @brief      Single file, memory mapped tile pack for offline use
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   TLMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef TILEPACK_H
+#define TILEPACK_H
+
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include "maptype.h"
+#include "point.h"
+
+namespace core {
+    /**
+     * @brief Read only tile pack, mapped into memory.
+     *
+     * Layout, all integers little endian:
+     *   header:  "DRTILEPK", u32 version, u32 count, u64 index offset, u64 reserved
+     *   data:    the tile images, back to back
+     *   index:   count entries of u64 key, u64 offset, u32 size, u32 reserved,
+     *            sorted by key
+     * The key packs type, zoom, x and y so a lookup is one binary search.
+     */
+    class TilePack
+    {
+    public:
+        TilePack();
+        ~TilePack();
+        bool Open(const QString &fileName);
+        void Close();
+        bool IsOpen()const{return map!=0;}
+        QString FileName()const{return file.fileName();}
+        int Count()const{return count;}
+        QByteArray GetImage(const MapType::Types &type,const core::Point &pos,const int &zoom)const;
+        bool EntryAt(int index,MapType::Types &type,core::Point &pos,int &zoom,QByteArray &data)const;
+
+        /**
+         * @brief Writes a tile pack. Tiles may be added in any order, the
+         * index is sorted on Close().
+         */
+        class Writer
+        {
+        public:
+            bool Open(const QString &fileName);
+            bool Add(const MapType::Types &type,const core::Point &pos,const int &zoom,const QByteArray &data);
+            bool Close();
+        private:
+            struct Entry
+            {
+                quint64 key;
+                quint64 offset;
+                quint32 size;
+                bool operator<(const Entry &other)const{return key<other.key;}
+            };
+            QFile file;
+            QVector<Entry> index;
+        };
+
+    private:
+        TilePack(const TilePack &);
+        TilePack& operator=(TilePack const&);
+
+        static bool Key(const MapType::Types &type,const core::Point &pos,const int &zoom,quint64 &key);
+        QByteArray Data(const uchar *entry)const;
+
+        static const char MAGIC[8];
+        static const quint32 VERSION=1;
+        static const int HEADER_SIZE=32;
+        static const int ENTRY_SIZE=24;
+        static const int MAX_ZOOM=21;
+
+        QFile file;
+        uchar *map;
+        qint64 mapSize;
+        const uchar *index;
+        int count;
+    };
+}
+#endif // TILEPACK_H
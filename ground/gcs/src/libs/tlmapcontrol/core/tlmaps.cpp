@@ -364,16 +364,8 @@ namespace core {
             if(accessmode!=AccessMode::CacheOnly)
             {
                 { //Otherwise, we're getting the tiles from the internet
-                    QEventLoop q;
-                    QNetworkReply *reply;
                     QNetworkRequest qheader;
-                    QNetworkAccessManager network;
-                    QTimer tT;
-                    tT.setSingleShot(true);
-                    connect(&network, SIGNAL(finished(QNetworkReply*)),
-                            &q, SLOT(quit()));
-                    connect(&tT, SIGNAL(timeout()), &q, SLOT(quit()));
-                    network.setProxy(Proxy);
+                    QNetworkReply::NetworkError error;
     #ifdef DEBUG_GMAPS
                     qDebug()<<"Try Tile from the Internet";
     #endif //DEBUG_GMAPS
@@ -461,27 +453,31 @@ namespace core {
 #ifdef DEBUG_GMAPS
                     qDebug() << "qheader: " << qheader.url();
 #endif //DEBUG_GMAPS
-                    reply=network.get(qheader);
-                    tT.start(Timeout);
-                    q.exec();
-
-                    if(!tT.isActive()){
+                    // Don't hold the settings lock while waiting on the
+                    // network, or the loader threads download one at a time
+                    QNetworkProxy proxy=Proxy;
+                    int timeout=Timeout;
+                    locker.unlock();
+                    ret=TileFetcher::Instance()->Fetch(qheader,proxy,timeout,error);
+                    locker.relock();
+
+                    if(error==QNetworkReply::OperationCanceledError)
+                    {
+                        return ret;
+                    }
+                    if(error==QNetworkReply::TimeoutError){
                         errorvars.lock();
                         ++diag.timeouts;
                         errorvars.unlock();
                         return ret;
                     }
-                    tT.stop();
-                    if( (reply->error()!=QNetworkReply::NoError))
+                    if(error!=QNetworkReply::NoError)
                     {
                         errorvars.lock();
                         ++diag.networkerrors;
                         errorvars.unlock();
-                        reply->deleteLater();
                         return ret;
                     }
-                    ret=reply->readAll();
-                    reply->deleteLater();//TODO can't this be global??
                     if(ret.isEmpty())
                     {
     #ifdef DEBUG_GMAPS
@@ -538,6 +534,29 @@ namespace core {
         return Cache::Instance()->ImageCache.ExportMapDataToDB(file,Cache::Instance()->ImageCache.GtileCache()+QDir::separator()+"Data.qmdb");
     }
 
+    /**
+     * @brief TLMaps::IsTileCached Check the memory and database caches for
+     * a tile without loading it
+     */
+    bool TLMaps::IsTileCached(const MapType::Types &type,const Point &pos,const int &zoom)
+    {
+        if(useMemoryCache && !GetTileFromMemoryCache(RawTile(type,pos,zoom)).isEmpty())
+            return true;
+        return accessmode!=AccessMode::ServerOnly && Cache::Instance()->ImageCache.HasImageInCache(type,pos,zoom);
+    }
+    bool TLMaps::ExportToTilePack(const QString &file)
+    {
+        return Cache::Instance()->ImageCache.ExportMapDataToPack(Cache::Instance()->ImageCache.GtileCache()+QDir::separator()+"Data.qmdb",file);
+    }
+    bool TLMaps::ImportFromTilePack(const QString &file)
+    {
+        return Cache::Instance()->ImageCache.ImportMapDataFromPack(file,Cache::Instance()->ImageCache.GtileCache()+QDir::separator()+"Data.qmdb");
+    }
+    bool TLMaps::MountTilePack(const QString &file)
+    {
+        return Cache::Instance()->ImageCache.MountTilePack(file);
+    }
+
     diagnostics TLMaps::GetDiagnostics()
     {
         diagnostics i;
@@ -39,6 +39,7 @@
 #include "pureimagecache.h"
 #include "alllayersoftype.h"
 #include "urlfactory.h"
+#include "tilefetcher.h"
 #include "diagnostics.h"
 
 #include "../internals/pureprojection.h"
@@ -60,12 +61,16 @@ namespace core {
         static TLMaps* Instance();
         bool ImportFromGMDB(const QString &file);
         bool ExportToGMDB(const QString &file);
+        bool ExportToTilePack(const QString &file);
+        bool ImportFromTilePack(const QString &file);
+        bool MountTilePack(const QString &file);
         /// <summary>
         /// timeout for map connections
         /// </summary>
 
 
         QByteArray GetImageFromServer(const MapType::Types &type,const core::Point &pos,const int &zoom);
+        bool IsTileCached(const MapType::Types &type,const core::Point &pos,const int &zoom);
         QByteArray GetImageFromFile(const MapType::Types &type,const core::Point &pos,const int &zoom, double hScale, double vScale, QString userImageFileName, internals::PureProjection *projection);
         bool UseMemoryCache(){return useMemoryCache;}//TODO
         void setUseMemoryCache(const bool& value){useMemoryCache=value;}
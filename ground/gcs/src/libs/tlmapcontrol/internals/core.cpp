@@ -36,6 +36,7 @@ using namespace projections;
 namespace internals {
     Core::Core():started(false),MouseWheelZooming(false),currentPosition(0,0),currentPositionPixel(0,0),LastLocationInBounds(-1,-1),sizeOfMapArea(0,0)
             ,minOfTiles(0,0),maxOfTiles(0,0),zoom(0),isDragging(false),TooltipTextPadding(10,10),mapType(MapType::None),loaderLimit(5),maxzoom(21),runningThreads(0)
+            ,visibleTasks(0),prefetchZoom(-1),projectionCacheZoom(-1),projectionCacheProjection(0)
     {
         mousewheelzoomtype=MouseWheelZoomType::MousePositionAndCenter;
         SetProjection(new MercatorProjection());
@@ -65,17 +66,19 @@ namespace internals {
         qDebug()<<"core:run"<<" ID="<<debug;
 #endif //DEBUG_CORE
         bool last = false;
+        bool cancelled = false;
 
         LoadTask task;
+        quint32 fetchGeneration = TileFetcher::Instance()->Generation();
 
         MtileLoadQueue.lock();
         {
             if(tileLoadQueue.count() > 0)
             {
-                task = tileLoadQueue.dequeue();
+                task = TakeNextLoadTask();
                 {
 
-                    last = (tileLoadQueue.count() == 0);
+                    last = !task.Prefetch && visibleTasks == 0;
 #ifdef DEBUG_CORE
                     qDebug()<<"TileLoadQueue: " << tileLoadQueue.count()<<" Point:"<<task.Pos.ToString()<<" ID="<<debug;;
 #endif //DEBUG_CORE
@@ -84,7 +87,15 @@ namespace internals {
         }
         MtileLoadQueue.unlock();
 
-        if(task.HasValue())
+        if(task.HasValue() && task.Prefetch)
+        {
+            if(loaderLimit.tryAcquire(1,TLMaps::Instance()->Timeout))
+            {
+                PrefetchTile(task);
+                loaderLimit.release();
+            }
+        }
+        else if(task.HasValue())
             if(loaderLimit.tryAcquire(1,TLMaps::Instance()->Timeout))
             {
             MtileToload.lock();
@@ -144,6 +155,7 @@ namespace internals {
                                     Moverlays.lock();
                                     {
                                         t->Overlays.append(tileImage);
+                                        t->OverlayTypes.append(tl);
 #ifdef DEBUG_CORE
                                         qDebug()<<"Core::run append tileImage:"<<tileImage.length()<<" to tile:"<<t->GetPos().ToString()<<" now has "<<t->Overlays.count()<<" overlays"<<" ID="<<debug;
 #endif //DEBUG_CORE
@@ -153,6 +165,12 @@ namespace internals {
 
                                     break;
                                 }
+                                else if(TileFetcher::Instance()->Generation() != fetchGeneration)
+                                {
+                                    // The viewport moved on while we were waiting
+                                    cancelled = true;
+                                    break;
+                                }
                                 else if(TLMaps::Instance()->RetryLoadTile > 0)
                                 {
 #ifdef DEBUG_CORE
@@ -161,9 +179,12 @@ namespace internals {
                                 }
                             }
                             while(++retry < TLMaps::Instance()->RetryLoadTile);
+
+                            if(cancelled)
+                                break;
                         }
 
-                        if(t->Overlays.count() > 0)
+                        if(!cancelled && t->Overlays.count() > 0)
                         {
                             Matrix.SetTileAt(task.Pos,t);
                             emit OnNeedInvalidation();
@@ -219,6 +240,10 @@ namespace internals {
             emit OnTilesStillToLoad(tilesToload<0? 0:tilesToload);
             loaderLimit.release();
         }
+
+        if(task.HasValue() && !task.Prefetch)
+            QueuePrefetch();
+
         MrunningThreads.lock();
         --runningThreads;
         MrunningThreads.unlock();
@@ -245,7 +270,9 @@ namespace internals {
             {
                 MtileLoadQueue.lock();
                 tileLoadQueue.clear();
+                visibleTasks=0;
                 MtileLoadQueue.unlock();
+                TileFetcher::Instance()->CancelAll();
                 MtileToload.lock();
                 tilesToload=0;
                 MtileToload.unlock();
@@ -485,10 +512,60 @@ namespace internals {
 
     Point Core::FromLatLngToLocal(PointLatLng const& latlng)
     {
-        Point pLocal = Projection()->FromLatLngToPixel(latlng, Zoom());
+        Point pLocal = FromLatLngToPixelCached(latlng);
         pLocal.Offset(renderOffset);
         return pLocal;
     }
+
+    /**
+     * Overlay items ask for the same coordinates on every repaint, so their
+     * pixel positions are kept until the zoom or projection changes
+     */
+    Point Core::FromLatLngToPixelCached(PointLatLng const& latlng)
+    {
+        if(zoom!=projectionCacheZoom || projection!=projectionCacheProjection)
+            ReprojectCache();
+
+        QPair<double,double> key(latlng.Lat(),latlng.Lng());
+        QHash<QPair<double,double>,ProjectedPoint>::iterator it=projectionCache.find(key);
+        if(it==projectionCache.end())
+        {
+            if(projectionCache.size()>=MAX_PROJECTION_CACHE)
+                projectionCache.clear();
+            ProjectedPoint projected;
+            projected.pixel=projection->FromLatLngToPixel(latlng.Lat(),latlng.Lng(),zoom);
+            projected.used=true;
+            it=projectionCache.insert(key,projected);
+        }
+        else
+            it->used=true;
+        return it->pixel;
+    }
+
+    /**
+     * Recompute, in one pass, every coordinate looked up since the last
+     * reprojection and forget the rest, so the cache tracks what is on the map
+     */
+    void Core::ReprojectCache()
+    {
+        QHash<QPair<double,double>,ProjectedPoint>::iterator it=projectionCache.begin();
+        while(it!=projectionCache.end())
+        {
+            if(!it->used)
+            {
+                it=projectionCache.erase(it);
+                continue;
+            }
+            it->pixel=projection->FromLatLngToPixel(it.key().first,it.key().second,zoom);
+            it->used=false;
+            ++it;
+        }
+        projectionCacheZoom=zoom;
+        projectionCacheProjection=projection;
+#ifdef DEBUG_CORE
+        qDebug()<<"Core: reprojected"<<projectionCache.size()<<"overlay points at zoom"<<zoom;
+#endif //DEBUG_CORE
+    }
     int Core::GetMaxZoomToFitRect(RectLatLng const& rect)
     {
         int zoom = 0;
@@ -533,8 +610,11 @@ namespace internals {
             MtileLoadQueue.lock();
             {
                 tileLoadQueue.clear();
+                visibleTasks=0;
+                prefetchZoom=-1;
             }
             MtileLoadQueue.unlock();
+            TileFetcher::Instance()->CancelAll();
             MtileToload.lock();
             tilesToload=0;
             MtileToload.unlock();
@@ -637,13 +717,15 @@ namespace internals {
     {
         if(started)
         {
-            ProcessLoadTaskCallback.waitForDone();
             MtileLoadQueue.lock();
             {
                 tileLoadQueue.clear();
+                visibleTasks=0;
                 //tilesToload=0;
             }
             MtileLoadQueue.unlock();
+            TileFetcher::Instance()->CancelAll();
+            ProcessLoadTaskCallback.waitForDone();
             MtileToload.lock();
             tilesToload=0;
             MtileToload.unlock();
@@ -655,6 +737,7 @@ namespace internals {
         MtileDrawingList.lock();
         {
             FindTilesAround(tileDrawingList);
+            PruneLoadQueue();
 
 #ifdef DEBUG_CORE
             qDebug()<<"OnTileLoadStart: " << tileDrawingList.count() << " tiles to load at zoom " << Zoom() << ", time: " << QDateTime::currentDateTime().date();
@@ -674,7 +757,8 @@ namespace internals {
                             MtileToload.lock();
                             ++tilesToload;
                             MtileToload.unlock();
-                            tileLoadQueue.enqueue(task);
+                            tileLoadQueue.append(task);
+                            ++visibleTasks;
 #ifdef DEBUG_CORE
                             qDebug()<<"Core::UpdateBounds new Task"<<task.Pos.ToString();
 #endif //DEBUG_CORE
@@ -689,6 +773,166 @@ namespace internals {
         MtileDrawingList.unlock();
         UpdateGroundResolution();
     }
+    /**
+     * @brief Core::TakeNextLoadTask Remove the queued task closest to the
+     * viewport centre. Tiles of the current zoom always go before prefetches.
+     * MtileLoadQueue must be held.
+     */
+    LoadTask Core::TakeNextLoadTask()
+    {
+        int best=0;
+        int bestPriority=LoadTaskPriority(tileLoadQueue.at(0));
+        for(int i=1;i<tileLoadQueue.count();++i)
+        {
+            int priority=LoadTaskPriority(tileLoadQueue.at(i));
+            if(priority<bestPriority)
+            {
+                best=i;
+                bestPriority=priority;
+            }
+        }
+        LoadTask task=tileLoadQueue.takeAt(best);
+        if(!task.Prefetch)
+            --visibleTasks;
+        return task;
+    }
+    /**
+     * @brief Core::LoadTaskPriority Chebyshev distance of the task from the
+     * centre tile, scaled to the task zoom level. Lower loads first.
+     */
+    int Core::LoadTaskPriority(const LoadTask &task)
+    {
+        Point center=centerTileXYLocation;
+        if(task.Zoom>zoom)
+            center=Point(center.X()<<(task.Zoom-zoom),center.Y()<<(task.Zoom-zoom));
+        else if(task.Zoom<zoom)
+            center=Point(center.X()>>(zoom-task.Zoom),center.Y()>>(zoom-task.Zoom));
+
+        int distance=qMax(qAbs(task.Pos.X()-center.X()),qAbs(task.Pos.Y()-center.Y()));
+        if(task.Prefetch || task.Zoom!=zoom)
+            distance+=PREFETCH_PRIORITY;
+        return distance;
+    }
+    /**
+     * @brief Core::PruneLoadQueue Drop queued tasks that scrolled out of
+     * tileDrawingList, and every prefetch since the view they were queued
+     * for is gone. Their pool runs find another task or an empty queue.
+     * MtileDrawingList must be held.
+     */
+    void Core::PruneLoadQueue()
+    {
+        int dropped=0;
+        MtileLoadQueue.lock();
+        {
+            for(int i=tileLoadQueue.count()-1;i>=0;--i)
+            {
+                const LoadTask &task=tileLoadQueue.at(i);
+                if(task.Prefetch)
+                {
+                    tileLoadQueue.removeAt(i);
+                }
+                else if(task.Zoom!=zoom || !tileDrawingList.contains(task.Pos))
+                {
+                    tileLoadQueue.removeAt(i);
+                    --visibleTasks;
+                    ++dropped;
+                }
+            }
+#ifdef DEBUG_CORE
+            qDebug()<<"Core::PruneLoadQueue dropped"<<dropped<<"stale tasks";
+#endif //DEBUG_CORE
+        }
+        MtileLoadQueue.unlock();
+        MtileToload.lock();
+        tilesToload-=dropped;
+        MtileToload.unlock();
+    }
+    /**
+     * @brief Core::QueuePrefetch Once every visible tile is loaded and no
+     * other loader is running, queue the tiles of the adjacent zoom levels
+     * around the centre so zooming is served from the caches.
+     */
+    void Core::QueuePrefetch()
+    {
+        if(TLMaps::Instance()->GetAccessMode()==AccessMode::CacheOnly)
+            return;
+
+        MrunningThreads.lock();
+        bool idle=(runningThreads<=1);
+        MrunningThreads.unlock();
+        if(!idle)
+            return;
+
+        MtileDrawingList.lock();
+        MtileLoadQueue.lock();
+        if(visibleTasks==0 && !(prefetchZoom==zoom && prefetchCenter==centerTileXYLocation))
+        {
+            prefetchZoom=zoom;
+            prefetchCenter=centerTileXYLocation;
+
+            QList<LoadTask> tasks;
+            if(zoom<maxzoom)
+            {
+                // Zooming in only keeps the middle of the view, so only the
+                // children of the tiles next to the centre are worth it
+                Size max=Projection()->GetTileMatrixMaxXY(zoom+1);
+                foreach(Point p,tileDrawingList)
+                {
+                    if(qAbs(p.X()-prefetchCenter.X())>PREFETCH_RADIUS || qAbs(p.Y()-prefetchCenter.Y())>PREFETCH_RADIUS)
+                        continue;
+                    for(int i=0;i<4;++i)
+                    {
+                        Point child(2*p.X()+(i&1),2*p.Y()+(i>>1));
+                        if(child.X()<=max.Width() && child.Y()<=max.Height())
+                            tasks.append(LoadTask(child,zoom+1,true));
+                    }
+                }
+            }
+            if(zoom>0)
+            {
+                foreach(Point p,tileDrawingList)
+                {
+                    LoadTask task(Point(p.X()/2,p.Y()/2),zoom-1,true);
+                    if(!tasks.contains(task))
+                        tasks.append(task);
+                }
+            }
+
+#ifdef DEBUG_CORE
+            qDebug()<<"Core::QueuePrefetch"<<tasks.count()<<"tiles around"<<prefetchCenter.ToString();
+#endif //DEBUG_CORE
+            foreach(LoadTask task,tasks)
+            {
+                if(!tileLoadQueue.contains(task))
+                {
+                    tileLoadQueue.append(task);
+                    ProcessLoadTaskCallback.start(this);
+                }
+            }
+        }
+        MtileLoadQueue.unlock();
+        MtileDrawingList.unlock();
+    }
+    /**
+     * @brief Core::PrefetchTile Download every layer of a prefetch task into
+     * the memory and database caches without touching the tile matrix
+     */
+    void Core::PrefetchTile(const LoadTask &task)
+    {
+        if(qAbs(task.Zoom-zoom)!=1)
+            return;
+
+        QVector<MapType::Types> layers=TLMaps::Instance()->GetAllLayersOfType(GetMapType());
+        foreach(MapType::Types tl,layers)
+        {
+            if(tl==MapType::UserImage)
+                continue;
+            if(tl==MapType::PergoTurkeyMap)
+                TLMaps::Instance()->GetImageFromServer(tl,Point(task.Pos.X(),Projection()->GetTileMatrixMaxXY(task.Zoom).Height()-task.Pos.Y()),task.Zoom);
+            else
+                TLMaps::Instance()->GetImageFromServer(tl,task.Pos,task.Zoom);
+        }
+    }
     void Core::FindTilesAround(QList<Point> &list)
     {
         list.clear();;
@@ -39,6 +39,8 @@
 #include "QThreadPool"
 #include "tilematrix.h"
 #include <QQueue>
+#include <QHash>
+#include <QPair>
 #include "loadtask.h"
 #include "copyrightstrings.h"
 #include "rectlatlng.h"
@@ -137,6 +139,7 @@ namespace internals {
         void SetProjection(PureProjection* value)
         {
             projection=value;
+            projectionCacheZoom=-1;
             tileRect=Rectangle(core::Point(0,0),value->TileSize());
         }
         bool IsDragging()const{return isDragging;}
@@ -215,6 +218,16 @@ namespace internals {
         bool started;
         bool MouseWheelZooming;
         void keepInBounds();
+        LoadTask TakeNextLoadTask();
+        int LoadTaskPriority(const LoadTask &task);
+        void PruneLoadQueue();
+        void QueuePrefetch();
+        void PrefetchTile(const LoadTask &task);
+        static const int PREFETCH_RADIUS=1; //Tiles around the centre whose children are prefetched
+        static const int PREFETCH_PRIORITY=1<<20; //Priority offset putting prefetches behind visible tiles
+        core::Point FromLatLngToPixelCached(PointLatLng const& latlng);
+        void ReprojectCache();
+        static const int MAX_PROJECTION_CACHE=65536; //Overlay coordinates remembered per zoom level
         PointLatLng currentPosition;
         core::Point currentPositionPixel;
         core::Point renderOffset;
@@ -242,7 +255,19 @@ namespace internals {
 
         Rectangle CurrentRegion;
 
-        QQueue<LoadTask> tileLoadQueue;
+        QList<LoadTask> tileLoadQueue;
+        int visibleTasks; //Tasks in tileLoadQueue that are not prefetches
+        core::Point prefetchCenter;
+        int prefetchZoom;
+
+        struct ProjectedPoint
+        {
+            core::Point pixel;
+            bool used; //Looked up since the last reprojection
+        };
+        QHash<QPair<double,double>,ProjectedPoint> projectionCache;
+        int projectionCacheZoom;
+        PureProjection* projectionCacheProjection;
 
         int zoom;
 
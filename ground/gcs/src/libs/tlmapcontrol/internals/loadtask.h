@@ -39,17 +39,20 @@ struct LoadTask
   public:
     core::Point Pos; //Tile position in quadtile format
     int Zoom;        //Number of zoom levels, in quadtile format
+    bool Prefetch;   //Speculative load of an adjacent zoom level, only cached
 
 
-    LoadTask(Point pos, int zoom)
+    LoadTask(Point pos, int zoom, bool prefetch=false)
      {
         Pos = pos;
         Zoom = zoom;
+        Prefetch = prefetch;
     }
     LoadTask()
     {
         Pos=core::Point(-1,-1);
         Zoom=-1;
+        Prefetch=false;
     }
     bool HasValue()
     {
@@ -148,6 +148,21 @@ public:
     */
     void SetTileMemorySize(int const& value){core::TLMaps::Instance()->TilesInMemory.setMemoryCacheCapacity(value);}
 
+    /**
+    * @brief  Returns the currently used memory for decoded tiles, shared by all map widgets
+    *
+    * @return memory in Mb
+    */
+    double DecodedTileMemoryUsed()const{return core::TLMaps::Instance()->TilesInMemory.DecodedCacheSize();}
+
+    /**
+    * @brief  Sets the size of the memory for decoded tiles, shared by all map widgets
+    *
+    * @param  value size in Mb to use for decoded tiles
+    * @return
+    */
+    void SetDecodedTileMemorySize(int const& value){core::TLMaps::Instance()->TilesInMemory.setDecodedCacheCapacity(value);}
+
     /**
     * @brief Sets the location for the SQLite Database used for caching and the geocoding cache files
     *
@@ -159,6 +174,30 @@ public:
 
     }
 
+    /**
+    * @brief Writes the tiles of the cache database to a single file tile pack
+    *
+    * @param file path of the pack to create
+    * @return true on success
+    */
+    bool ExportTilePack(QString const& file){return core::TLMaps::Instance()->ExportToTilePack(file);}
+
+    /**
+    * @brief Copies the tiles of a tile pack missing from the cache database into it
+    *
+    * @param file path of the pack
+    * @return true on success
+    */
+    bool ImportTilePack(QString const& file){return core::TLMaps::Instance()->ImportFromTilePack(file);}
+
+    /**
+    * @brief Uses a tile pack in place as an additional, read only cache
+    *
+    * @param file path of the pack
+    * @return true if the pack could be opened
+    */
+    bool MountTilePack(QString const& file){return core::TLMaps::Instance()->MountTilePack(file);}
+
     /**
     * @brief  Deletes tiles in DataBase older than "days" days
     *
@@ -167,6 +206,30 @@ public:
     */
     void DeleteTilesOlderThan(int const& days){core::Cache::Instance()->ImageCache.deleteOlderTiles(days);}
 
+    /**
+    * @brief  Caps the size of the cache database. The least recently used tiles
+    * are evicted in the background once it grows past the cap.
+    *
+    * @param  value size in Mb, 0 for no limit
+    * @return
+    */
+    void SetCacheSizeLimit(int const& value){core::Cache::Instance()->ImageCache.setMaxCacheSize((qint64)value*1024*1024);}
+
+    /**
+    * @brief  Returns the cap on the size of the cache database
+    *
+    * @return size in Mb, 0 for no limit
+    */
+    int CacheSizeLimit(){return core::Cache::Instance()->ImageCache.MaxCacheSize()/(1024*1024);}
+
+    /**
+    * @brief  Returns the number of tiles and the size of the cache database
+    *
+    * @param  stats filled with the current figures
+    * @return false if there's no cache database
+    */
+    bool CacheStats(core::PureImageCache::CacheStats &stats){return core::Cache::Instance()->ImageCache.GetCacheStats(stats);}
+
     /**
     * @brief  Exports tiles from one DB to another. Only new tiles are added.
     *
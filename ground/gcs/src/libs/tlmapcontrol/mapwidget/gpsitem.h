@@ -32,8 +32,7 @@
 #include "uavmapfollowtype.h"
 #include "uavtrailtype.h"
 #include <QtSvg/QSvgRenderer>
-#include "trailitem.h"
-#include "traillineitem.h"
+#include "trailpathitem.h"
 #include "../core/corecommon.h"
 
 namespace mapcontrol
@@ -191,9 +190,7 @@ namespace mapcontrol
         QPixmap pic;
         core::Point localposition;
         TLMapWidget* mapwidget;
-        QGraphicsItemGroup* trail;
-        QGraphicsItemGroup * trailLine;
-        internals::PointLatLng lasttrailline;
+        TrailPathItem* trail;
         QTime timer;
         bool showtrail;
         bool showtrailline;
@@ -377,14 +377,16 @@ namespace mapcontrol
                             //lock(t.Overlays)
                             if(t!=0)
                             {
-                                foreach(QByteArray img,t->Overlays)
+                                for(int k=0;k<t->Overlays.count();++k)
                                 {
+                                    const QByteArray &img=t->Overlays.at(k);
                                     if(img.count()!=0)
                                     {
                                         if(!found)
                                             found = true;
                                         {
-                                            painter->drawPixmap(core->tileRect.X(),core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(),PureImageProxy::FromStream(img));
+                                            core::RawTile key(t->OverlayTypes.at(k),t->GetPos(),t->GetZoom());
+                                            painter->drawPixmap(core->tileRect.X(),core->tileRect.Y(), core->tileRect.Width(), core->tileRect.Height(),core::TLMaps::Instance()->TilesInMemory.DecodedTile(key,img));
                                         }
                                     }
                                 }
@@ -25,28 +25,69 @@
 * with this program; if not, see <http://www.gnu.org/licenses/>
 */
 #include "mapripper.h"
+#include <QSettings>
+#include <QFileInfo>
+#include <QRunnable>
 namespace mapcontrol
 {
 
-MapRipper::MapRipper(internals::Core * core, const internals::RectLatLng & rect):sleep(100),cancel(false),progressForm(0),core(core),yesToAll(false)
+namespace {
+    /**
+     * One of the download threads of a rip, pulling tiles until none are left
+     */
+    class RipWorker:public QRunnable
     {
-        if(!rect.IsEmpty())
+    public:
+        RipWorker(MapRipper *ripper,const QVector<core::MapType::Types> &types):ripper(ripper),types(types){}
+        void run(){ripper->RipTiles(types);}
+    private:
+        MapRipper *ripper;
+        QVector<core::MapType::Types> types;
+    };
+}
+
+MapRipper::MapRipper(internals::Core * core, const internals::RectLatLng & rect):cancel(false),progressForm(0),core(core),yesToAll(false)
+    {
+        type=core->GetMapType();
+        area=rect;
+        zoom=core->Zoom();
+        maxzoom=core->MaxZoom();
+        int index=0;
+
+        // Offer to pick up an interrupted rip of the same area, or of any
+        // area when nothing is selected
+        internals::RectLatLng savedArea;
+        core::MapType::Types savedType;
+        int savedZoom;
+        int savedIndex;
+        if(LoadJob(savedArea,savedType,savedZoom,savedIndex) && (rect.IsEmpty() || (rect==savedArea && type==savedType)))
+        {
+            QMessageBox msgBox;
+            msgBox.setText(QString("Resume the interrupted map rip at zoom level %1?").arg(savedZoom));
+            msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+            msgBox.setDefaultButton(QMessageBox::Yes);
+            if(msgBox.exec()==QMessageBox::Yes)
+            {
+                area=savedArea;
+                type=savedType;
+                zoom=savedZoom;
+                index=savedIndex;
+            }
+            else
+                ClearJob();
+        }
+
+        if(!area.IsEmpty())
         {
-            type=core->GetMapType();
             progressForm=new MapRipForm;
             connect(progressForm,SIGNAL(cancelRequest()),this,SLOT(stopFetching()));
-            area=rect;
-            zoom=core->Zoom();
-            maxzoom=core->MaxZoom();
-            points=core->Projection()->GetAreaTileList(area,zoom,0);
-            this->start();
-            cancel=false;
-            progressForm->show();
             connect(this,SIGNAL(percentageChanged(int)),progressForm,SLOT(SetPercentage(int)));
             connect(this,SIGNAL(numberOfTilesChanged(int,int)),progressForm,SLOT(SetNumberOfTiles(int,int)));
             connect(this,SIGNAL(providerChanged(QString,int)),progressForm,SLOT(SetProvider(QString,int)));
             connect(this,SIGNAL(finished()),this,SLOT(finish()));
+            progressForm->show();
             emit numberOfTilesChanged(0,0);
+            StartZoom(index);
         }
         else
 #ifdef Q_OS_DARWIN
@@ -74,19 +115,16 @@ void MapRipper::finish()
             ret=QMessageBox::Yes;
         if(ret==QMessageBox::Yes)
         {
-            points.clear();
-            points=core->Projection()->GetAreaTileList(area,zoom,0);
-            this->start();
+            StartZoom(0);
         }
         else if(ret==QMessageBox::YesAll)
         {
             yesToAll=true;
-            points.clear();
-            points=core->Projection()->GetAreaTileList(area,zoom,0);
-            this->start();
+            StartZoom(0);
         }
         else
         {
+            ClearJob();
             progressForm->close();
             delete progressForm;
             this->deleteLater();
@@ -94,6 +132,9 @@ void MapRipper::finish()
     }
     else
     {
+        // A cancelled job stays on disk to be resumed
+        if(!cancel)
+            ClearJob();
         yesToAll=false;
         progressForm->close();
         delete progressForm;
@@ -101,51 +142,149 @@ void MapRipper::finish()
     }
 }
 
+    /**
+     * @brief MapRipper::StartZoom Rip the current zoom level from a tile index
+     */
+    void MapRipper::StartZoom(int index)
+    {
+        points.clear();
+        points=core->Projection()->GetAreaTileList(area,zoom,0);
+        nextIndex=qBound(0,index,points.count());
+        doneIndex=nextIndex;
+        completed=nextIndex;
+        done.fill(false,points.count());
+        SaveJob();
+        this->start();
+    }
 
     void MapRipper::run()
     {
-        int countOk = 0;
-        bool goodtile=false;
-        //  Stuff.Shuffle<Point>(ref list);
         QVector<core::MapType::Types> types = TLMaps::Instance()->GetAllLayersOfType(type);
-        int all=points.count();
-        for(int i = 0; i < all; i++)
+        emit numberOfTilesChanged(points.count(),completed);
+        clock.start();
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(RIP_THREADS);
+        for(int i=0;i<RIP_THREADS;++i)
+            pool.start(new RipWorker(this,types));
+        pool.waitForDone();
+
+        mutex.lock();
+        SaveJob();
+        mutex.unlock();
+    }
+
+    /**
+     * @brief MapRipper::RipTiles Loop of a download thread. Tiles already in
+     * the cache are skipped without using any of the provider rate.
+     */
+    void MapRipper::RipTiles(const QVector<core::MapType::Types> &types)
+    {
+        forever
         {
-            emit numberOfTilesChanged(all,i+1);
-            if(cancel)
-                break;
+            int i;
+            {
+                QMutexLocker locker(&mutex);
+                if(cancel || nextIndex>=points.count())
+                    return;
+                i=nextIndex++;
+            }
 
-            core::Point p = points[i];
+            core::Point p = points.at(i);
+            bool goodtile=true;
+            foreach(core::MapType::Types type,types)
             {
-                //qDebug()<<"offline fetching:"<<p.ToString();
-                foreach(core::MapType::Types type,types)
-                {
-                    emit providerChanged(core::MapType::StrByType(type),zoom);
-                    QByteArray img = TLMaps::Instance()->GetImageFromServer(type, p, zoom);
-                    if(img.length()!=0)
-                    {
-                        goodtile=true;
-                        img=NULL;
-                    }
-                    else
-                        goodtile=false;
-                }
-                if(goodtile)
-                {
-                    countOk++;
-                }
-                else
-                {
-                    i--;
-                    QThread::msleep(1000);
+                if(TLMaps::Instance()->IsTileCached(type,p,zoom))
                     continue;
+
+                emit providerChanged(core::MapType::StrByType(type),zoom);
+                QByteArray img;
+                for(int retry=0;img.isEmpty() && retry<RIP_RETRIES && !cancel;++retry)
+                {
+                    WaitForProvider(type);
+                    img = TLMaps::Instance()->GetImageFromServer(type, p, zoom);
                 }
+                if(img.isEmpty())
+                    goodtile=false;
             }
-            emit percentageChanged((int) ((i+1)*100/all));//, i+1);
-            // worker.ReportProgress((int) ((i+1)*100/all), i+1);
+            TileDone(i,goodtile);
+        }
+    }
 
-            QThread::msleep(sleep);
+    /**
+     * @brief MapRipper::WaitForProvider Space the requests to each provider
+     * by 1/RIP_PROVIDER_RATE seconds, across all download threads
+     */
+    void MapRipper::WaitForProvider(core::MapType::Types type)
+    {
+        qint64 wait;
+        {
+            QMutexLocker locker(&mutex);
+            qint64 now=clock.elapsed();
+            qint64 slot=qMax(now,providerSlots.value((int)type,0));
+            providerSlots.insert((int)type,slot+1000/RIP_PROVIDER_RATE);
+            wait=slot-now;
         }
+        if(wait>0)
+            QThread::msleep(wait);
+    }
+
+    void MapRipper::TileDone(int index,bool good)
+    {
+        QMutexLocker locker(&mutex);
+        // A failed tile holds back the resume point so it is retried
+        if(good)
+            done[index]=true;
+        ++completed;
+        while(doneIndex<done.count() && done.at(doneIndex))
+            ++doneIndex;
+        if(completed%RIP_SAVE_INTERVAL==0)
+            SaveJob();
+
+        // Ripping goes through the memory cache, keep it in bounds
+        TLMaps::Instance()->kiberCacheLock.lockForWrite();
+        TLMaps::Instance()->TilesInMemory.RemoveMemoryOverload();
+        TLMaps::Instance()->kiberCacheLock.unlock();
+
+        emit numberOfTilesChanged(points.count(),completed);
+        emit percentageChanged((int) (completed*100/points.count()));
+    }
+
+    QString MapRipper::JobFile()
+    {
+        return core::Cache::Instance()->ImageCache.GtileCache()+"ripjob.ini";
+    }
+    /**
+     * @brief MapRipper::SaveJob Write the area, zoom level and done tiles of
+     * the rip next to the tile cache. mutex must be held, or no download
+     * thread running.
+     */
+    void MapRipper::SaveJob()
+    {
+        QSettings job(JobFile(),QSettings::IniFormat);
+        job.setValue("lat",area.Lat());
+        job.setValue("lng",area.Lng());
+        job.setValue("widthLng",area.WidthLng());
+        job.setValue("heightLat",area.HeightLat());
+        job.setValue("type",(int)type);
+        job.setValue("zoom",zoom);
+        job.setValue("index",doneIndex);
+    }
+    bool MapRipper::LoadJob(internals::RectLatLng &area,core::MapType::Types &type,int &zoom,int &index)
+    {
+        if(core::Cache::Instance()->ImageCache.GtileCache().isEmpty() || !QFileInfo(JobFile()).exists())
+            return false;
+        QSettings job(JobFile(),QSettings::IniFormat);
+        area=internals::RectLatLng(job.value("lat").toDouble(),job.value("lng").toDouble(),
+                                   job.value("widthLng").toDouble(),job.value("heightLat").toDouble());
+        type=(core::MapType::Types)job.value("type").toInt();
+        zoom=job.value("zoom").toInt();
+        index=job.value("index").toInt();
+        return !area.IsEmpty();
+    }
+    void MapRipper::ClearJob()
+    {
+        QFile::remove(JobFile());
     }
 
     void MapRipper::stopFetching()
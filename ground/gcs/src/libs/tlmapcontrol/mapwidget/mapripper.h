@@ -28,6 +28,10 @@
 #define MAPRIPPER_H
 
 #include <QThread>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
 #include "../internals/core.h"
 #include "mapripform.h"
 #include <QObject>
@@ -42,11 +46,24 @@ namespace mapcontrol
     public:
         MapRipper(internals::Core *,internals::RectLatLng const&);
         void run();
+        void RipTiles(const QVector<core::MapType::Types> &types);
     private:
+        static const int RIP_THREADS=4;          //Concurrent downloads
+        static const int RIP_PROVIDER_RATE=10;   //Max tile requests per second to each provider
+        static const int RIP_RETRIES=3;          //Attempts before a tile is given up on
+        static const int RIP_SAVE_INTERVAL=50;   //Tiles between saves of the job progress
+
+        void StartZoom(int index);
+        void WaitForProvider(core::MapType::Types type);
+        void TileDone(int index,bool good);
+        static QString JobFile();
+        void SaveJob();
+        static bool LoadJob(internals::RectLatLng &area,core::MapType::Types &type,int &zoom,int &index);
+        static void ClearJob();
+
         QList<core::Point> points;
         int zoom;
         core::MapType::Types type;
-        int sleep;
         internals::RectLatLng area;
         bool cancel;
         MapRipForm * progressForm;
@@ -55,6 +72,14 @@ namespace mapcontrol
         bool yesToAll;
         QMutex mutex;
 
+        // Progress of the current zoom level, guarded by mutex
+        int nextIndex;      //Next tile to hand out
+        int doneIndex;      //Every tile before this one is done, saved for resuming
+        int completed;
+        QVector<bool> done;
+        QElapsedTimer clock;
+        QHash<int,qint64> providerSlots; //Earliest time of the next request to each provider
+
     signals:
         void percentageChanged(int const& perc);
         void numberOfTilesChanged(int const& total,int const& actual);
@@ -252,6 +252,7 @@ namespace mapcontrol
         bool FollowMouse(){return followmouse;}
 
         internals::PointLatLng GetFromLocalToLatLng(QPointF p) {return map->FromLocalToLatLng(p.x(),p.y());}
+        QPointF GetFromLatLngToLocal(internals::PointLatLng const& p) {core::Point local=map->FromLatLngToLocal(p);return QPointF(local.X(),local.Y());}
 
         /**
         * @brief Creates a new WayPoint on the center of the map
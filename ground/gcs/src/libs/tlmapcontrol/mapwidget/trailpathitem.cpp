@@ -0,0 +1,221 @@
+/**
+******************************************************************************
+*
+* @file       trailpathitem.cpp
+* @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+* @brief      A graphicsItem drawing a whole vehicle trail as one path
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   TLMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>
+*/
+#include "trailpathitem.h"
+#include <QStack>
+#include <QPair>
+#include <QtMath>
+namespace mapcontrol
+{
+    const qreal TrailPathItem::SIMPLIFY_TOLERANCE=0.5;
+    const qreal TrailPathItem::DOT_SPACING=4;
+
+    TrailPathItem::TrailPathItem(QColor const& dotColor, QColor const& lineColor, MapGraphicItem *map):
+        QGraphicsItem(map),m_map(map),m_dotColor(dotColor),m_lineColor(lineColor),
+        m_showDots(true),m_showLine(true),m_head(0),m_count(0),m_dirty(false)
+    {
+        m_coords.resize(MAX_POINTS);
+        connect(map,SIGNAL(childRefreshPosition()),this,SLOT(RefreshPos()));
+    }
+
+    void TrailPathItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+    {
+        Q_UNUSED(option);
+        Q_UNUSED(widget);
+
+        if(m_dirty)
+            Simplify();
+
+        if(m_showLine)
+        {
+            QPen pen(m_lineColor);
+            pen.setWidth(1);
+            painter->setPen(pen);
+            painter->setBrush(Qt::NoBrush);
+            painter->drawPath(m_path);
+        }
+        if(m_showDots)
+        {
+            painter->setPen(Qt::black);
+            painter->setBrush(m_dotColor);
+            foreach(QPointF const& p,m_dots)
+                painter->drawEllipse(p,2,2);
+        }
+    }
+    QRectF TrailPathItem::boundingRect()const
+    {
+        return m_bounds.adjusted(-3,-3,3,3);
+    }
+    int TrailPathItem::type()const
+    {
+        return Type;
+    }
+
+    void TrailPathItem::AddPoint(internals::PointLatLng const& coord)
+    {
+        if(m_count<MAX_POINTS)
+        {
+            m_coords[(m_head+m_count)%MAX_POINTS]=coord;
+            ++m_count;
+        }
+        else
+        {
+            m_coords[m_head]=coord;
+            m_head=(m_head+1)%MAX_POINTS;
+            m_local.remove(0);
+        }
+
+        core::Point p=m_map->FromLatLngToLocal(coord);
+        QPointF local(p.X(),p.Y());
+        prepareGeometryChange();
+        m_local.append(local);
+        UpdateBounds(local);
+        m_dirty=true;
+        update();
+    }
+    void TrailPathItem::Clear()
+    {
+        prepareGeometryChange();
+        m_head=0;
+        m_count=0;
+        m_local.clear();
+        m_bounds=QRectF();
+        m_path=QPainterPath();
+        m_dots.clear();
+        m_dirty=false;
+        update();
+    }
+    void TrailPathItem::SetShowDots(bool const& value)
+    {
+        m_showDots=value;
+        setVisible(m_showDots || m_showLine);
+        update();
+    }
+    void TrailPathItem::SetShowLine(bool const& value)
+    {
+        m_showLine=value;
+        setVisible(m_showDots || m_showLine);
+        update();
+    }
+
+    /**
+     * @brief TrailPathItem::RefreshPos Reproject the whole trail after the
+     * map moved or zoomed
+     */
+    void TrailPathItem::RefreshPos()
+    {
+        prepareGeometryChange();
+        m_local.resize(m_count);
+        m_bounds=QRectF();
+        for(int i=0;i<m_count;++i)
+        {
+            core::Point p=m_map->FromLatLngToLocal(m_coords.at((m_head+i)%MAX_POINTS));
+            m_local[i]=QPointF(p.X(),p.Y());
+            UpdateBounds(m_local.at(i));
+        }
+        m_dirty=true;
+        update();
+    }
+
+    void TrailPathItem::UpdateBounds(QPointF const& point)
+    {
+        if(m_bounds.isNull())
+            m_bounds=QRectF(point,QSizeF(0,0));
+        else
+        {
+            m_bounds.setLeft(qMin(m_bounds.left(),point.x()));
+            m_bounds.setRight(qMax(m_bounds.right(),point.x()));
+            m_bounds.setTop(qMin(m_bounds.top(),point.y()));
+            m_bounds.setBottom(qMax(m_bounds.bottom(),point.y()));
+        }
+    }
+
+    /**
+     * @brief TrailPathItem::Simplify Rebuild the path from the points that
+     * Douglas-Peucker keeps at SIMPLIFY_TOLERANCE pixels, and the sample
+     * dots from the points at least DOT_SPACING apart
+     */
+    void TrailPathItem::Simplify()
+    {
+        m_dirty=false;
+        m_path=QPainterPath();
+        m_dots.clear();
+        int n=m_local.count();
+        if(n==0)
+            return;
+
+        QVector<bool> keep(n,false);
+        keep[0]=true;
+        keep[n-1]=true;
+        QStack<QPair<int,int> > spans;
+        if(n>2)
+            spans.push(qMakePair(0,n-1));
+        while(!spans.isEmpty())
+        {
+            QPair<int,int> span=spans.pop();
+            QPointF a=m_local.at(span.first);
+            QPointF b=m_local.at(span.second);
+            QPointF d=b-a;
+            qreal length=qSqrt(d.x()*d.x()+d.y()*d.y());
+
+            int farthest=-1;
+            qreal maxDistance=SIMPLIFY_TOLERANCE;
+            for(int i=span.first+1;i<span.second;++i)
+            {
+                QPointF v=m_local.at(i)-a;
+                qreal distance=(length>0)?qAbs(d.x()*v.y()-d.y()*v.x())/length
+                                         :qSqrt(v.x()*v.x()+v.y()*v.y());
+                if(distance>maxDistance)
+                {
+                    maxDistance=distance;
+                    farthest=i;
+                }
+            }
+            if(farthest>=0)
+            {
+                keep[farthest]=true;
+                if(farthest-span.first>1)
+                    spans.push(qMakePair(span.first,farthest));
+                if(span.second-farthest>1)
+                    spans.push(qMakePair(farthest,span.second));
+            }
+        }
+
+        for(int i=0;i<n;++i)
+        {
+            QPointF const& p=m_local.at(i);
+            if(keep.at(i))
+            {
+                if(m_path.elementCount()==0)
+                    m_path.moveTo(p);
+                else
+                    m_path.lineTo(p);
+            }
+            // Samples closer than a dot apart would only overdraw each other
+            if(m_dots.isEmpty() || qAbs(p.x()-m_dots.last().x())+qAbs(p.y()-m_dots.last().y())>=DOT_SPACING)
+                m_dots.append(p);
+        }
+    }
+}
@@ -0,0 +1,94 @@
+/**
+******************************************************************************
+*
+* @file       trailpathitem.h
+* @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+* @brief      A graphicsItem drawing a whole vehicle trail as one path
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   TLMapWidget
+* @{
+*
+*****************************************************************************/
+/*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+* for more details.
+*
+* You should have received a copy of the GNU General Public License along
+* with this program; if not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef TRAILPATHITEM_H
+#define TRAILPATHITEM_H
+
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QPainterPath>
+#include <QVector>
+#include "../internals/pointlatlng.h"
+#include <QObject>
+#include "mapgraphicitem.h"
+#include "../core/corecommon.h"
+
+namespace mapcontrol
+{
+    /**
+     * @brief Trail of a vehicle held in a ring buffer of positions and drawn
+     * as a single path, simplified with Douglas-Peucker at the current zoom,
+     * instead of one scene item per sample.
+     */
+    class TLMAPWIDGET_EXPORT TrailPathItem:public QObject,public QGraphicsItem
+    {
+        Q_OBJECT
+        Q_INTERFACES(QGraphicsItem)
+    public:
+        enum { Type = UserType + 10 };
+        TrailPathItem(QColor const& dotColor,QColor const& lineColor,MapGraphicItem * map);
+        void paint(QPainter *painter, const QStyleOptionGraphicsItem *option,
+                    QWidget *widget);
+        QRectF boundingRect() const;
+        int type() const;
+
+        /**
+        * @brief Appends a position to the trail, dropping the oldest one
+        *        once MAX_POINTS are held
+        */
+        void AddPoint(internals::PointLatLng const& coord);
+        void Clear();
+        void SetShowDots(bool const& value);
+        void SetShowLine(bool const& value);
+    private:
+        static const int MAX_POINTS=20000;
+        static const qreal SIMPLIFY_TOLERANCE; //Pixels
+        static const qreal DOT_SPACING; //Pixels between drawn sample dots
+
+        void Simplify();
+        void UpdateBounds(QPointF const& point);
+
+        MapGraphicItem * m_map;
+        QColor m_dotColor;
+        QColor m_lineColor;
+        bool m_showDots;
+        bool m_showLine;
+
+        // Ring buffer of the trail positions, oldest at m_head
+        QVector<internals::PointLatLng> m_coords;
+        int m_head;
+        int m_count;
+
+        // Positions in map coordinates at the current zoom, oldest first
+        QVector<QPointF> m_local;
+        QRectF m_bounds;
+        bool m_dirty;
+        QPainterPath m_path;
+        QVector<QPointF> m_dots;
+    public slots:
+        void RefreshPos();
+    };
+}
+#endif // TRAILPATHITEM_H
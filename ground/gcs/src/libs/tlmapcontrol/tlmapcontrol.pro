@@ -14,6 +14,7 @@ SOURCES += mapwidget/mapgraphicitem.cpp \
     mapwidget/mapripform.cpp \
     mapwidget/mapripper.cpp \
     mapwidget/traillineitem.cpp \
+    mapwidget/trailpathitem.cpp \
     mapwidget/mapline.cpp \
     mapwidget/mapcircle.cpp \
     mapwidget/waypointcurve.cpp \
@@ -27,6 +28,8 @@ SOURCES += mapwidget/mapgraphicitem.cpp \
     core/providerstrings.cpp \
     core/cacheitemqueue.cpp \
     core/tilecachequeue.cpp \
+    core/tilefetcher.cpp \
+    core/tilepack.cpp \
     core/alllayersoftype.cpp \
     core/urlfactory.cpp \
     core/point.cpp \
@@ -66,6 +69,7 @@ HEADERS += mapwidget/mapgraphicitem.h \
     mapwidget/mapripform.h \
     mapwidget/mapripper.h \
     mapwidget/traillineitem.h \
+    mapwidget/trailpathitem.h \
     mapwidget/mapline.h \
     mapwidget/mapcircle.h \
     mapwidget/waypointcurve.h \
@@ -82,6 +86,8 @@ HEADERS += mapwidget/mapgraphicitem.h \
     core/providerstrings.h \
     core/cacheitemqueue.h \
     core/tilecachequeue.h \
+    core/tilefetcher.h \
+    core/tilepack.h \
     core/alllayersoftype.h \
     core/urlfactory.h \
     core/geodecoderstatus.h \
@@ -162,15 +162,9 @@ int CoordinateConversions::NED2LLA_HomeECEF(double BaseECEF[3], double NED[3], d
   */
 int CoordinateConversions::NED2LLA_HomeLLA(double homeLLA[3], double NED[3], double LLA[3])
 {
-    double T[3];
-    // 6.378137E6 is the radius of the earth
-    T[0] = homeLLA[2]+6.378137E6f * M_PI / 180.0;
-    T[1] = cosf(homeLLA[0] * M_PI / 180.0)*(homeLLA[2]+6.378137E6f) * M_PI / 180.0;
-    T[2] = -1.0f;
-
-    LLA[0] = homeLLA[0] + NED[0] / T[0];
-    LLA[1] = homeLLA[1] + NED[1] / T[1];
-    LLA[2] = homeLLA[2] + NED[2] / T[2];
+    HomeFrame home;
+    HomeLLA2Frame(homeLLA, home);
+    NED2LLA_Batch(home, (const double(*)[3])NED, (double(*)[3])LLA, 1);
 
     return 0;
 }
@@ -212,22 +206,65 @@ void CoordinateConversions::LLA2NED_HomeECEF(double LLA[3], double BaseECEF[3],
   */
 void CoordinateConversions::LLA2NED_HomeLLA(double LLA[3], double homeLLA[3], double NED[3])
 {
-    double lat = homeLLA[0] * DEG2RAD;
-    double alt = homeLLA[2];
-
-    float T[3];
-    T[0] = alt+6.378137E6;
-    T[1] = cos(lat)*(alt+6.378137E6);
-    T[2] = -1.0;
-
-    float dL[3];
-    dL[0] = (float)((LLA[0] - homeLLA[0]) * DEG2RAD);
-    dL[1]  = (float)((LLA[1] - homeLLA[1]) * DEG2RAD);
-    dL[2]  = (float)(LLA[2] - homeLLA[2]);
-
-    NED[0] = T[0] * dL[0];
-    NED[1] = T[1] * dL[1];
-    NED[2] = T[2] * dL[2];
+    HomeFrame home;
+    HomeLLA2Frame(homeLLA, home);
+    LLA2NED_Batch(home, (const double(*)[3])LLA, (double(*)[3])NED, 1);
+}
+
+/**
+  * Work out the home terms of the NED conversions, the same local tangent
+  * plane the flight code uses
+  * @param[in] homeLLA latitude, longitude, and altitude (in [m]) of the home location
+  * @param[out] home the frame to pass to the batch conversions
+  */
+void CoordinateConversions::HomeLLA2Frame(const double homeLLA[3], HomeFrame &home)
+{
+    for (int i = 0; i < 3; i++)
+        home.LLA[i] = homeLLA[i];
+
+    home.T[0] = (homeLLA[2] + R_EQUATOR) * DEG2RAD;
+    home.T[1] = cos(homeLLA[0] * DEG2RAD) * home.T[0];
+    home.T[2] = -1.0;
+}
+
+/**
+  * Get the NED offsets from home of many locations
+  * @param[in] home frame from HomeLLA2Frame()
+  * @param[in] LLA latitude, longitude, and altitude (in [m]) of each location
+  * @param[out] NED the offset of each location from home (in [m])
+  * @param[in] count number of locations
+  */
+void CoordinateConversions::LLA2NED_Batch(const HomeFrame &home, const double LLA[][3],
+                                          double NED[][3], int count)
+{
+    const double lat = home.LLA[0], lon = home.LLA[1], alt = home.LLA[2];
+    const double T0 = home.T[0], T1 = home.T[1], T2 = home.T[2];
+
+    for (int i = 0; i < count; i++) {
+        NED[i][0] = T0 * (LLA[i][0] - lat);
+        NED[i][1] = T1 * (LLA[i][1] - lon);
+        NED[i][2] = T2 * (LLA[i][2] - alt);
+    }
+}
+
+/**
+  * Get the locations of many NED offsets from home
+  * @param[in] home frame from HomeLLA2Frame()
+  * @param[in] NED the offset of each location from home (in [m])
+  * @param[out] LLA latitude, longitude, and altitude (in [m]) of each location
+  * @param[in] count number of locations
+  */
+void CoordinateConversions::NED2LLA_Batch(const HomeFrame &home, const double NED[][3],
+                                          double LLA[][3], int count)
+{
+    const double lat = home.LLA[0], lon = home.LLA[1], alt = home.LLA[2];
+    const double iT0 = 1.0 / home.T[0], iT1 = 1.0 / home.T[1], iT2 = 1.0 / home.T[2];
+
+    for (int i = 0; i < count; i++) {
+        LLA[i][0] = lat + NED[i][0] * iT0;
+        LLA[i][1] = lon + NED[i][1] * iT1;
+        LLA[i][2] = alt + NED[i][2] * iT2;
+    }
 }
 
 // ****** find roll, pitch, yaw from quaternion ********
@@ -36,6 +36,16 @@ namespace Utils {
 class QTCREATOR_UTILS_EXPORT CoordinateConversions
 {
 public:
+    /**
+     * Home location with the per home terms of the NED conversions worked
+     * out, for converting many positions around the same home
+     */
+    struct HomeFrame
+    {
+        double LLA[3];
+        double T[3]; // Metres NED per degree latitude, degree longitude and metre altitude
+    };
+
     CoordinateConversions();
     int NED2LLA_HomeECEF(double BaseECEF[3], double NED[3], double LLA[3]);
     int NED2LLA_HomeLLA(double homeLLA[3], double NED[3], double LLA[3]);
@@ -44,6 +54,9 @@ public:
     int ECEF2LLA(double ECEF[3], double LLA[3]);
     void LLA2NED_HomeECEF(double LLA[3], double homeECEF[3], double Rne[3][3], double NED[3]);
     void LLA2NED_HomeLLA(double LLA[3], double homeLLA[3], double NED[3]);
+    void HomeLLA2Frame(const double homeLLA[3], HomeFrame &home);
+    void LLA2NED_Batch(const HomeFrame &home, const double LLA[][3], double NED[][3], int count);
+    void NED2LLA_Batch(const HomeFrame &home, const double NED[][3], double LLA[][3], int count);
     void Quaternion2RPY(const float q[4], float rpy[3]);
     void RPY2Quaternion(const float rpy[3], float q[4]);
     void Quaternion2R(const float q[4], float Rbe[3][3]);
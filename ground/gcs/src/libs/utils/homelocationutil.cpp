@@ -67,8 +67,9 @@ HomeLocationUtil::HomeLocationUtil()
 
         QDateTime dt = QDateTime::currentDateTime().toUTC();
 
-        //Fetch world magnetic model
-        int retval = WorldMagModel().GetMagVector(LLA, dt.date().month(), dt.date().day(), dt.date().year(), Be);
+        //Fetch world magnetic model, reusing the last evaluation nearby
+        static WorldMagModel wmm;
+        int retval = wmm.GetMagVectorLocal(LLA, dt.date().month(), dt.date().day(), dt.date().year(), Be);
         Q_ASSERT(retval >= 0);
 
         return retval;
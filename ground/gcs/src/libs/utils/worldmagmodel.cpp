@@ -59,7 +59,8 @@ const double CoeffFile[91][6] = COEFFS_FROM_NASA;
 
 namespace Utils {
 
-    WorldMagModel::WorldMagModel()
+    WorldMagModel::WorldMagModel() :
+        local_valid(false)
     {
         Initialize();
     }
@@ -111,6 +112,72 @@ namespace Utils {
         return 0;   // OK
     }
 
+    /**
+     * Like GetMagVector, but from a linearisation of the field around the
+     * last point the full model was evaluated at. The model only runs again
+     * once LLA is more than half a degree or 5km of altitude away, or the
+     * month changes.
+     */
+    int WorldMagModel::GetMagVectorLocal(double LLA[3], int Month, int Day, int Year, double Be[3])
+    {
+        const double maxDelta[3] = { 0.5, 0.5, 5000.0 };
+        double delta[3];
+        bool near = local_valid && local_month == Month && local_year == Year;
+
+        for (int i = 0; i < 3; i++) {
+            delta[i] = LLA[i] - local_lla[i];
+            if (fabs(delta[i]) > maxDelta[i])
+                near = false;
+        }
+
+        if (!near) {
+            local_valid = false;
+
+            int ret = GetMagVector(LLA, Month, Day, Year, local_Be);
+            if (ret < 0)
+                return ret;
+
+            // Step towards the equator and prime meridian to stay in range
+            const double step[3] = {
+                LLA[0] > 0 ? -0.05 : 0.05,
+                LLA[1] > 0 ? -0.05 : 0.05,
+                500.0
+            };
+
+            for (int j = 0; j < 3; j++) {
+                double p[3] = { LLA[0], LLA[1], LLA[2] };
+                double Bp[3];
+
+                p[j] += step[j];
+
+                ret = GetMagVector(p, Month, Day, Year, Bp);
+                if (ret < 0)
+                    return ret;
+
+                for (int i = 0; i < 3; i++)
+                    local_dBe[i][j] = (Bp[i] - local_Be[i]) / step[j];
+            }
+
+            for (int i = 0; i < 3; i++) {
+                local_lla[i] = LLA[i];
+                delta[i] = 0;
+            }
+
+            local_month = Month;
+            local_year = Year;
+            local_valid = true;
+        }
+
+        for (int i = 0; i < 3; i++) {
+            Be[i] = local_Be[i];
+
+            for (int j = 0; j < 3; j++)
+                Be[i] += local_dBe[i][j] * delta[j];
+        }
+
+        return 0;
+    }
+
     void WorldMagModel::Initialize()
     {   //      Sets default values for WMM subroutines.
         //      UPDATES : Ellip and MagneticModel
@@ -135,6 +135,7 @@ namespace Utils {
             WorldMagModel();
 
             int GetMagVector(double LLA[3], int Month, int Day, int Year, double Be[3]);
+            int GetMagVectorLocal(double LLA[3], int Month, int Day, int Year, double Be[3]);
 
         private:
             WMMtype_Ellipsoid       Ellip;
@@ -142,6 +143,13 @@ namespace Utils {
 
             double                  decimal_date;
 
+            // Field and its gradient around the last full evaluation
+            bool                    local_valid;
+            int                     local_month, local_year;
+            double                  local_lla[3];
+            double                  local_Be[3];
+            double                  local_dBe[3][3];
+
             void Initialize();
             int Geomag(WMMtype_CoordSpherical *CoordSpherical, WMMtype_CoordGeodetic *CoordGeodetic, WMMtype_GeoMagneticElements *GeoMagneticElements);
             void ComputeSphericalHarmonicVariables(WMMtype_CoordSpherical *CoordSpherical, int nMax, WMMtype_SphericalHarmonicVariables *SphVariables);
@@ -56,10 +56,16 @@
 #include <Eigen/SVD>
 #include <Eigen/QR>
 #include <cstdlib>
+#include <cstring>
 
 #define META_OPERATIONS_TIMEOUT 5000
 
-enum calibrationSuccessMessages { CALIBRATION_SUCCESS, ACCELEROMETER_FAILED, MAGNETOMETER_FAILED };
+enum calibrationSuccessMessages {
+    CALIBRATION_SUCCESS,
+    ACCELEROMETER_FAILED,
+    MAGNETOMETER_FAILED,
+    GYRO_TEMP_FAILED
+};
 
 #define sign(x) ((x < 0) ? -1 : 1)
 
@@ -70,6 +76,7 @@ Calibration::Calibration()
     , yCurve(NULL)
     , zCurve(NULL)
 {
+    resetTempCalFit();
 }
 
 Calibration::~Calibration()
@@ -373,7 +380,7 @@ void Calibration::dataUpdated(UAVObject *obj)
             if (ret == CALIBRATION_SUCCESS) {
                 emit showTempCalMessage(tr("Temperature compensation calibration succeeded"));
             } else {
-                emit showTempCalMessage(tr("Temperature compensation calibration succeeded"));
+                emit showTempCalMessage(tr("Temperature compensation calibration failed"));
             }
         }
     }
@@ -707,6 +714,7 @@ void Calibration::doStartTempCal()
     gyro_accum_y.clear();
     gyro_accum_z.clear();
     gyro_accum_temp.clear();
+    resetTempCalFit();
 
     // Disable gyro sensor bias correction to see raw data
     AttitudeSettings *attitudeSettings = AttitudeSettings::GetInstance(getObjectManager());
@@ -1108,6 +1116,17 @@ void Calibration::configureTempCurves(TempCompCurve *x, TempCompCurve *y, TempCo
     zCurve = z;
 }
 
+/**
+ * @brief Drop every other element of a list, keeping the first
+ */
+static void decimateList(QList<double> &list)
+{
+    int n = 0;
+    for (int i = 0; i < list.size(); i += 2)
+        list[n++] = list[i];
+    list.erase(list.begin() + n, list.end());
+}
+
 /**
   * Grab a sample of gyro data with the temperautre
   * @return true If enough data is averaged at this position
@@ -1121,20 +1140,36 @@ bool Calibration::storeTempCalMeasurement(UAVObject *obj)
         double gyros_body[3] = { gyrosData.x, gyrosData.y, gyrosData.z };
         double gyros_sensor[3];
         rotate_vector(boardRotationMatrix, gyros_body, gyros_sensor, false);
-        gyro_accum_x.append(gyros_sensor[0]);
-        gyro_accum_y.append(gyros_sensor[1]);
-        gyro_accum_z.append(gyros_sensor[2]);
-        gyro_accum_temp.append(gyrosData.temperature);
-    }
 
-    auto m = std::minmax_element(gyro_accum_temp.begin(), gyro_accum_temp.end());
-    double range = *m.second - *m.first; // max - min
-    emit tempCalProgressChanged(static_cast<int>((100 * range) / min_temperature_range));
+        if (addTempCalSample(gyrosData.temperature, gyros_sensor)) {
+            // The fit has all samples, the plot makes do with a thinned out set
+            if (((tempcal_samples - 1) % tempcal_plot_stride) == 0) {
+                gyro_accum_x.append(gyros_sensor[0]);
+                gyro_accum_y.append(gyros_sensor[1]);
+                gyro_accum_z.append(gyros_sensor[2]);
+                gyro_accum_temp.append(gyrosData.temperature);
+            }
+
+            if (gyro_accum_temp.size() >= TEMPCAL_MAX_PLOT_POINTS) {
+                decimateList(gyro_accum_x);
+                decimateList(gyro_accum_y);
+                decimateList(gyro_accum_z);
+                decimateList(gyro_accum_temp);
+                tempcal_plot_stride *= 2;
+            }
 
-    if ((gyro_accum_temp.size() % 10) == 0) {
-        updateTempCompCalibrationDisplay();
+            if ((tempcal_samples % 10) == 0) {
+                updateTempCompCalibrationDisplay();
+            }
+        }
     }
 
+    if (tempcal_samples == 0)
+        return false;
+
+    double range = tempcal_max_temp - tempcal_min_temp;
+    emit tempCalProgressChanged(static_cast<int>((100 * range) / min_temperature_range));
+
     // If enough data is collected, average it for this position
     if (range >= min_temperature_range) {
         return true;
@@ -1144,31 +1179,127 @@ bool Calibration::storeTempCalMeasurement(UAVObject *obj)
 }
 
 /**
- * @brief Calibration::updateTempCompCalibrationDisplay
+ * @brief Calibration::resetTempCalFit Clear the normal equations of the
+ * temperature compensation fit
  */
-void Calibration::updateTempCompCalibrationDisplay()
+void Calibration::resetTempCalFit()
 {
-    int n_samples = gyro_accum_temp.size();
-
-    // Construct the matrix of temperature.
-    Eigen::Matrix<double, Eigen::Dynamic, 4> X(n_samples, 4);
-
-    // And the matrix of gyro samples.
-    Eigen::Matrix<double, Eigen::Dynamic, 3> Y(n_samples, 3);
-
-    for (int i = 0; i < n_samples; ++i) {
-        X(i, 0) = 1;
-        X(i, 1) = gyro_accum_temp[i];
-        X(i, 2) = pow(gyro_accum_temp[i], 2);
-        X(i, 3) = pow(gyro_accum_temp[i], 3);
-        Y(i, 0) = gyro_accum_x[i];
-        Y(i, 1) = gyro_accum_y[i];
-        Y(i, 2) = gyro_accum_z[i];
+    memset(tempcal_xtx, 0, sizeof(tempcal_xtx));
+    memset(tempcal_xty, 0, sizeof(tempcal_xty));
+    memset(tempcal_yty, 0, sizeof(tempcal_yty));
+    tempcal_samples = 0;
+    tempcal_rejected = 0;
+    tempcal_min_temp = 0;
+    tempcal_max_temp = 0;
+    tempcal_plot_stride = 1;
+}
+
+/**
+ * @brief Calibration::addTempCalSample Accumulate a sample into the normal
+ * equations of Y = X * B, where a row of X is [1 t t^2 t^3] and a row of Y is
+ * the gyro sample. This keeps the fit at a constant size however long the
+ * calibration runs.
+ *
+ * Once the fit has settled, samples further than TEMPCAL_OUTLIER_SIGMA times
+ * the RMS residual from it are dropped. That is only judged within the
+ * temperatures seen so far, the fit isn't to be trusted outside of them.
+ * @return false if the sample was rejected
+ */
+bool Calibration::addTempCalSample(double temp, const double gyro[3])
+{
+    if (tempcal_samples >= TEMPCAL_MIN_FIT_SAMPLES && temp >= tempcal_min_temp
+        && temp <= tempcal_max_temp) {
+        double coeffs[4][3];
+        double rms[3];
+
+        if (solveTempCalFit(coeffs, rms)) {
+            for (int j = 0; j < 3; j++) {
+                double fit = coeffs[0][j] + temp * (coeffs[1][j]
+                                                    + temp * (coeffs[2][j] + temp * coeffs[3][j]));
+                if (rms[j] > 0 && fabs(gyro[j] - fit) > TEMPCAL_OUTLIER_SIGMA * rms[j]) {
+                    tempcal_rejected++;
+                    return false;
+                }
+            }
+        }
+    }
+
+    double x[4] = { 1, temp, temp * temp, temp * temp * temp };
+
+    for (int i = 0; i < 4; i++) {
+        for (int k = 0; k < 4; k++)
+            tempcal_xtx[i][k] += x[i] * x[k];
+        for (int j = 0; j < 3; j++)
+            tempcal_xty[i][j] += x[i] * gyro[j];
+    }
+    for (int j = 0; j < 3; j++)
+        tempcal_yty[j] += gyro[j] * gyro[j];
+
+    if (tempcal_samples == 0) {
+        tempcal_min_temp = temp;
+        tempcal_max_temp = temp;
+    } else {
+        tempcal_min_temp = qMin(tempcal_min_temp, temp);
+        tempcal_max_temp = qMax(tempcal_max_temp, temp);
+    }
+    tempcal_samples++;
+
+    return true;
+}
+
+/**
+ * @brief Calibration::solveTempCalFit Solve the normal equations accumulated
+ * so far
+ * @param coeffs the polynomial coefficients, [power][axis]
+ * @param rms the RMS residual of each axis
+ * @return false if there isn't enough data for a fit
+ */
+bool Calibration::solveTempCalFit(double coeffs[4][3], double rms[3]) const
+{
+    if (tempcal_samples < 4)
+        return false;
+
+    Eigen::Matrix<double, 4, 4> xtx;
+    Eigen::Matrix<double, 4, 3> xty;
+    for (int i = 0; i < 4; i++) {
+        for (int k = 0; k < 4; k++)
+            xtx(i, k) = tempcal_xtx[i][k];
+        for (int j = 0; j < 3; j++)
+            xty(i, j) = tempcal_xty[i][j];
     }
 
     // Solve Y = X * B
     // Use the cholesky-based Penrose pseudoinverse method.
-    Eigen::Matrix<double, 4, 3> result = (X.transpose() * X).ldlt().solve(X.transpose() * Y);
+    Eigen::LDLT<Eigen::Matrix<double, 4, 4> > ldlt(xtx);
+    if (ldlt.info() != Eigen::Success)
+        return false;
+
+    Eigen::Matrix<double, 4, 3> result = ldlt.solve(xty);
+
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 4; i++)
+            coeffs[i][j] = result(i, j);
+
+        // At the least squares solution, |Y - XB|^2 = Y^T Y - B^T X^T Y
+        double ssr = tempcal_yty[j] - result.col(j).dot(xty.col(j));
+        rms[j] = sqrt(qMax(ssr, 0.0) / tempcal_samples);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Calibration::updateTempCompCalibrationDisplay
+ */
+void Calibration::updateTempCompCalibrationDisplay()
+{
+    double coeffs[4][3];
+    double rms[3];
+
+    if (!solveTempCalFit(coeffs, rms))
+        return;
+
+    Eigen::Map<const Eigen::Matrix<double, 4, 3, Eigen::RowMajor> > result(&coeffs[0][0]);
 
     QList<double> xCoeffs, yCoeffs, zCoeffs;
     xCoeffs.clear();
@@ -1213,31 +1344,22 @@ int Calibration::computeTempCal()
     attitudeSettings->setData(attitudeSettingsData);
     attitudeSettings->updated();
 
-    int n_samples = gyro_accum_temp.size();
-
-    // Construct the matrix of temperature.
-    Eigen::Matrix<double, Eigen::Dynamic, 4> X(n_samples, 4);
-
-    // And the matrix of gyro samples.
-    Eigen::Matrix<double, Eigen::Dynamic, 3> Y(n_samples, 3);
+    double coeffs[4][3];
+    double rms[3];
 
-    for (int i = 0; i < n_samples; ++i) {
-        X(i, 0) = 1;
-        X(i, 1) = gyro_accum_temp[i];
-        X(i, 2) = pow(gyro_accum_temp[i], 2);
-        X(i, 3) = pow(gyro_accum_temp[i], 3);
-        Y(i, 0) = gyro_accum_x[i];
-        Y(i, 1) = gyro_accum_y[i];
-        Y(i, 2) = gyro_accum_z[i];
+    if (!solveTempCalFit(coeffs, rms)) {
+        qWarning() << "[Calibration] Too few samples for temperature compensation";
+        emit tempCalProgressChanged(0);
+        return GYRO_TEMP_FAILED;
     }
 
-    // Solve Y = X * B
-    // Use the cholesky-based Penrose pseudoinverse method.
-    Eigen::Matrix<double, 4, 3> result = (X.transpose() * X).ldlt().solve(X.transpose() * Y);
+    Eigen::Map<const Eigen::Matrix<double, 4, 3, Eigen::RowMajor> > result(&coeffs[0][0]);
 
     std::stringstream str;
     str << result.format(Eigen::IOFormat(4, 0, ", ", "\n", "[", "]"));
     qDebug().noquote() << "Solution:\n" << QString::fromStdString(str.str());
+    qDebug() << "Fit from" << tempcal_samples << "samples, rejected" << tempcal_rejected
+             << "outliers, residuals" << rms[0] << rms[1] << rms[2];
 
     // Store the results
     SensorSettings *sensorSettings = SensorSettings::GetInstance(getObjectManager());
@@ -201,6 +201,18 @@ private:
     QList<double> mag_accum_y;
     QList<double> mag_accum_z;
 
+    //! Normal equations of the temperature compensation fit, X^T X and X^T Y
+    double tempcal_xtx[4][4];
+    double tempcal_xty[4][3];
+    //! Sums of the squared gyro samples, for the residuals of the fit
+    double tempcal_yty[3];
+    int tempcal_samples;
+    int tempcal_rejected;
+    double tempcal_min_temp;
+    double tempcal_max_temp;
+    //! Only every this many samples is kept in gyro_accum_* for plotting
+    int tempcal_plot_stride;
+
     double gyro_data_x[6], gyro_data_y[6], gyro_data_z[6];
     double accel_data_x[6], accel_data_y[6], accel_data_z[6];
     double mag_data_x[6], mag_data_y[6], mag_data_z[6];
@@ -210,6 +222,9 @@ private:
     static const int NUM_SENSOR_UPDATES_SIX_POINT = 100;
     static const int SENSOR_UPDATE_PERIOD = 25;
     static const int NON_SENSOR_UPDATE_PERIOD = 0;
+    static const int TEMPCAL_MIN_FIT_SAMPLES = 100;
+    static const int TEMPCAL_OUTLIER_SIGMA = 5;
+    static const int TEMPCAL_MAX_PLOT_POINTS = 2000;
 
     double min_temperature_range;
     double boardRotationMatrix[3][3];
@@ -261,6 +276,15 @@ protected:
     //! Store a sample for temperature compensation
     bool storeTempCalMeasurement(UAVObject *obj);
 
+    //! Start a new temperature compensation fit
+    void resetTempCalFit();
+
+    //! Add a sample to the temperature compensation fit, unless it is an outlier
+    bool addTempCalSample(double temp, const double gyro[3]);
+
+    //! Solve the temperature compensation fit, coeffs[power][axis]
+    bool solveTempCalFit(double coeffs[4][3], double rms[3]) const;
+
     //! Compute temperature compensation factors
     int computeTempCal();
 
@@ -6,6 +6,7 @@ DEFINES += QWT_DLL
 QT += svg
 QT += network
 QT += charts
+QT += concurrent
 
 include(../../gcsplugin.pri)
 
@@ -56,6 +57,7 @@ HEADERS += calibration.h \
     configmodulewidget.h \
     configosdwidget.h \
     expocurve.h \
+    signalprocessing.h \
     qreadonlycheckbox.h
 
 SOURCES += calibration.cpp \
@@ -88,7 +90,8 @@ SOURCES += calibration.cpp \
     vehicletrim.cpp \
     configmodulewidget.cpp \
     configosdwidget.cpp \
-    expocurve.cpp
+    expocurve.cpp \
+    signalprocessing.cpp
 
 FORMS += airframe.ui \
     ccpm.ui \
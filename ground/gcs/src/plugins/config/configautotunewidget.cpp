@@ -31,11 +31,11 @@
 #include <algorithm>
 #include <numeric>
 
-#include "ffft/FFTReal.h"
-
 #include "configautotunewidget.h"
+#include "signalprocessing.h"
 
 #include <QtAlgorithms>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QChartView>
 #include <QClipboard>
 #include <QCryptographicHash>
@@ -519,9 +519,14 @@ AutotuneSlidersPage::AutotuneSlidersPage(QWidget *parent, AutotunedValues *autoV
 
     tuneState = autoValues;
 
-    // connect sliders to computation
-    connect(rateDamp, &QAbstractSlider::valueChanged, this, &AutotuneSlidersPage::compute);
-    connect(rateNoise, &QAbstractSlider::valueChanged, this, &AutotuneSlidersPage::compute);
+    // connect sliders to computation, once they stop moving
+    computeTimer.setSingleShot(true);
+    computeTimer.setInterval(COMPUTE_DELAY_MS);
+    connect(&computeTimer, &QTimer::timeout, this, &AutotuneSlidersPage::compute);
+    connect(rateDamp, &QAbstractSlider::valueChanged, &computeTimer,
+            static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(rateNoise, &QAbstractSlider::valueChanged, &computeTimer,
+            static_cast<void (QTimer::*)()>(&QTimer::start));
     connect(cbUseYaw, &QAbstractButton::toggled, this, &AutotuneSlidersPage::compute);
     connect(cbUseOuterKi, &QAbstractButton::toggled, this, &AutotuneSlidersPage::compute);
 
@@ -531,14 +536,27 @@ AutotuneSlidersPage::AutotuneSlidersPage(QWidget *parent, AutotunedValues *autoV
 
 void AutotuneSlidersPage::initializePage()
 {
+    // The measurements may have changed
+    solutions.clear();
+
     resetSliders();
 }
 
+bool AutotuneSlidersPage::validatePage()
+{
+    // Don't leave with gains for where the sliders were a moment ago
+    if (computeTimer.isActive())
+        compute();
+
+    return true;
+}
+
 void AutotuneSlidersPage::resetSliders()
 {
     rateDamp->setValue(105);
     rateNoise->setValue(10);
 
+    computeTimer.stop();
     compute();
 }
 
@@ -556,39 +574,18 @@ void AutotuneSlidersPage::setText(QLabel *lbl, double value, int precision)
     }
 }
 
-void AutotuneSlidersPage::compute()
+/**
+ * @brief Iterate the derivative filter and natural frequency for the desired
+ * response, until they settle
+ * @param damp damping asked for
+ * @param ghf high frequency gain allowed
+ */
+AutotuneSlidersPage::Solution AutotuneSlidersPage::solve(double damp, double ghf) const
 {
-    // These three parameters define the desired response properties
-    // - rate scale in the fraction of the natural speed of the system
-    //   to strive for.
-    // - damp is the amount of damping in the system. higher values
-    //   make oscillations less likely
-    // - ghf is the amount of high frequency gain and limits the influence
-    //   of noise
-
-    const double ghf = rateNoise->value() / 1000.0;
-    const double damp = rateDamp->value() / 100.0;
-
-    tuneState->damping = damp;
-    tuneState->noiseSens = ghf;
-
     /* Average roll and pitch tau for now. */
     double tau = (tuneState->tau[0] + tuneState->tau[1]) / 2.0;
     double beta_roll = tuneState->beta[0];
     double beta_pitch = tuneState->beta[1];
-    double beta_yaw = tuneState->beta[2];
-
-    // First clear out warnings..
-    lblWarnings->setText("");
-
-    if (beta_yaw < 6.8) {
-        lblWarnings->setText(tr("Unable to auto-calculate yaw gains for this craft."));
-        cbUseYaw->setChecked(false);
-        cbUseYaw->setEnabled(false);
-    }
-
-    bool doYaw = cbUseYaw->isChecked();
-    bool doOuterKi = cbUseOuterKi->isChecked();
 
     double wn = 1 / tau, wn_last = 1 / tau + 10;
     double tau_d = 0, tau_d_last = 1000;
@@ -621,6 +618,57 @@ void AutotuneSlidersPage::compute()
         wn_last = wn;
     }
 
+    Solution solution;
+    solution.converged = converged;
+    solution.iterations = iterations;
+    solution.wn = wn;
+    solution.tau_d = tau_d;
+    return solution;
+}
+
+void AutotuneSlidersPage::compute()
+{
+    // These three parameters define the desired response properties
+    // - rate scale in the fraction of the natural speed of the system
+    //   to strive for.
+    // - damp is the amount of damping in the system. higher values
+    //   make oscillations less likely
+    // - ghf is the amount of high frequency gain and limits the influence
+    //   of noise
+
+    const double ghf = rateNoise->value() / 1000.0;
+    const double damp = rateDamp->value() / 100.0;
+
+    tuneState->damping = damp;
+    tuneState->noiseSens = ghf;
+
+    /* Average roll and pitch tau for now. */
+    double tau = (tuneState->tau[0] + tuneState->tau[1]) / 2.0;
+    double beta_yaw = tuneState->beta[2];
+
+    // First clear out warnings..
+    lblWarnings->setText("");
+
+    if (beta_yaw < 6.8) {
+        lblWarnings->setText(tr("Unable to auto-calculate yaw gains for this craft."));
+        cbUseYaw->setChecked(false);
+        cbUseYaw->setEnabled(false);
+    }
+
+    bool doYaw = cbUseYaw->isChecked();
+    bool doOuterKi = cbUseOuterKi->isChecked();
+
+    // The sliders go back and forth over the same few positions
+    const QPair<int, int> key(rateDamp->value(), rateNoise->value());
+    if (!solutions.contains(key))
+        solutions.insert(key, solve(damp, ghf));
+    const Solution &solution = solutions[key];
+
+    const double wn = solution.wn;
+    const double tau_d = solution.tau_d;
+    const bool converged = solution.converged;
+    const int iterations = solution.iterations;
+
     tuneState->iterations = iterations;
     tuneState->converged = converged;
 
@@ -741,6 +789,11 @@ AutotuneBeginningPage::AutotuneBeginningPage(QWidget *parent,
     this->autoOpened = autoOpened;
     dataValid = false;
     setupUi(this);
+
+    connect(&analysisWatcher, &QFutureWatcherBase::progressValueChanged, this,
+            &AutotuneBeginningPage::analysisProgress);
+    connect(&analysisWatcher, &QFutureWatcherBase::finished, this,
+            &AutotuneBeginningPage::analysisFinished);
 }
 
 QString AutotuneBeginningPage::tuneValid(bool *okToContinue) const
@@ -834,7 +887,40 @@ void AutotuneBeginningPage::doDownloadAndProcess()
 
     progressBar->setValue(90);
 
-    processAutotuneData();
+    if (tuneState->valid || !processAutotuneData())
+        analysisFinished();
+}
+
+void AutotuneBeginningPage::analysisProgress(int axesDone)
+{
+    progressBar->setValue(90 + (10 * axesDone) / 3);
+}
+
+/**
+ * @brief Takes the results of the axes, once all of them are analysed or
+ * there's nothing left to analyse
+ */
+void AutotuneBeginningPage::analysisFinished()
+{
+    if (analysisWatcher.isFinished() && analysisWatcher.future().resultCount() == 3) {
+        for (int axis = 0; axis < 3; axis++) {
+            AutotuneAxisAnalysis analysis = analysisWatcher.resultAt(axis);
+
+            tuneState->model[axis] = new QLineSeries(this);
+            tuneState->model[axis]->replace(analysis.model);
+            tuneState->actual[axis] = new QLineSeries(this);
+            tuneState->actual[axis]->replace(analysis.actual);
+
+            tuneState->tau[axis] = analysis.tau;
+            tuneState->beta[axis] = analysis.beta;
+            tuneState->bias[axis] = analysis.bias;
+            tuneState->noise[axis] = analysis.noise;
+        }
+
+        tuneState->valid = true;
+
+        analysisWatcher.setFuture(QFuture<AutotuneAxisAnalysis>());
+    }
 
     progressBar->setValue(100);
 
@@ -869,116 +955,14 @@ bool AutotuneBeginningPage::isComplete() const
     return tuneState->valid && dataValid;
 }
 
-/* Run a Butterworth biquad filter on a circular buffer.  First go around once
- * to "prime" the filter, then actually filter in place.  This is derived from
- * @glowtape's excellent flight implementation
+/**
+ * @brief Checks the autotune data, and starts analysing its axes on the
+ * thread pool. analysisFinished() is called when they are done.
+ * @return false if the data is no good
  */
-void AutotuneBeginningPage::biquadFilter(float cutoff, int pts,
-        QVector<float> &data)
-{
-    float f = 1.0f / tan(M_PI * cutoff);
-    float q = 1.4142f;
-
-    float y2 = 0, y1 = 0, x2 = 0, x1 = 0;
-
-    float b0 = 1.0f / (1.0f + q * f + f * f);
-    float a1 = 2.0f * (f * f - 1.0f) * b0;
-    float a2 = -(1.0f - q * f + f * f) * b0;
-
-    for (int i = 0; i < pts; i++) {
-        float y = b0 * (data[i] + 2.0f * x1 + x2) + a1 * y1 + a2 * y2;
-
-        y2 = y1;
-        y1 = y;
-
-        x2 = x1;
-        x1 = data[i];
-    }
-
-    for (int i = 0; i < pts; i++) {
-        float y = b0 * (data[i] + 2.0f * x1 + x2) + a1 * y1 + a2 * y2;
-
-        y2 = y1;
-        y1 = y;
-
-        x2 = x1;
-        x1 = data[i];
-
-        data[i] = y;
-    }
-}
-
-/* Returns number of samples of delay between series */
-float AutotuneBeginningPage::getSampleDelay(int pts,
-        const QVector<float> &delayed, const QVector<float> &orig,
-        int seriesCutoff)
-{
-    ffft::FFTReal<float> fft(pts);
-
-    /* Convert to frequency domain */
-    QVector<float> delayed_fft(pts);
-    fft.do_fft(delayed_fft.data(), delayed.data());
-
-    QVector<float> orig_fft(pts);
-    fft.do_fft(orig_fft.data(), orig.data());
-
-    /* Now perform a correlation by multiplying -orig_fft* by delayed_fft.
-     * The types are all floats here, so we need to do the heavy lifting
-     * ourselves.   gfft = x+yi, dfft = u+vi, dfft* = u-vi,
-     * -dfft* = -u + vi
-     *
-     * -dfft* x gfft = (-ux - vy) + (vx - uy)i
-     */
-
-    QVector<float> product(pts);
-
-    int fpts = pts / 2;
-
-    // Memory layout here is annoyin'.  All reals, then all imaginaries
-    for (int i = 0; i < fpts; i++) {
-        float x = delayed_fft[i];
-        float y = delayed_fft[i + fpts];
-        float u = orig_fft[i];
-        float v = orig_fft[i + fpts];
-
-        product[i] = -(u * x) - (v * y);
-        product[i + fpts] = (v * x) - (u * y);
-    }
-
-    /* Inverse FFT converts this to the time domain */
-    QVector<float> prod_time(pts);
-
-    fft.do_ifft(product.data(), prod_time.data());
-
-    /* And we take magnitudes to find tau. */
-    QVector<float> mags(fpts);
-
-    int max_idx = 0;
-    float max_val = 0;
-
-    for (int i = 0; i < fpts / seriesCutoff; i++) {
-        float real = prod_time[i];
-        float imag = prod_time[i + fpts];
-        mags[i] = sqrt(real * real + imag * imag);
-
-        if (mags[i] > max_val) {
-            max_val = mags[i];
-            max_idx = i;
-        }
-
-        // cout << i << "\t" << mags[i] << "\n";
-    }
-
-    // cout << "Maximum mags[" << max_idx << "] = " << max_val << "\n";
-
-    // TODO / optional: interpolate/find a better peak around max_idx.
-
-    return max_idx;
-}
-
 bool AutotuneBeginningPage::processAutotuneData()
 {
-    QByteArray &loadedFile = tuneState->data;
+    const QByteArray &loadedFile = tuneState->data;
 
     const at_flash *flash_data = reinterpret_cast<const at_flash *>((const void *)loadedFile);
 
@@ -1002,86 +986,95 @@ bool AutotuneBeginningPage::processAutotuneData()
         return false;
     }
 
-    int pts = flash_data->hdr.wiggle_points;
+    analysisWatcher.setFuture(
+        QtConcurrent::mapped(QVector<int>() << 0 << 1 << 2, AxisAnalyzer(loadedFile)));
 
-    for (int axis = 0; axis < 3; axis++) {
-        QVector<float> gyro_deriv(pts);
-        QVector<float> actu_desired(pts);
+    return true;
+}
 
-        for (int i = 0; i < pts; i++) {
-            actu_desired[i] = flash_data->data[i].u[axis];
-        }
+AutotuneAxisAnalysis AutotuneBeginningPage::AxisAnalyzer::operator()(int axis) const
+{
+    const at_flash *flash_data = reinterpret_cast<const at_flash *>(data.constData());
 
-        // Differentiate the gyro data
-        for (int i = 1; i < pts; i++) {
-            gyro_deriv[i] = flash_data->data[i].y[axis] - flash_data->data[i - 1].y[axis];
-        }
+    int pts = flash_data->hdr.wiggle_points;
 
-        gyro_deriv[0] = flash_data->data[0].y[axis] - flash_data->data[pts - 1].y[axis];
+    AutotuneAxisAnalysis analysis;
 
-        float sample_tau = getSampleDelay(pts, gyro_deriv, actu_desired,
-                (axis == 2) ? 8 : 4);
+    QVector<float> gyro_deriv(pts);
+    QVector<float> actu_desired(pts);
 
-        float tau = sample_tau / flash_data->hdr.sample_rate;
+    for (int i = 0; i < pts; i++) {
+        actu_desired[i] = flash_data->data[i].u[axis];
+    }
 
-        biquadFilter(1 / (sample_tau * M_PI * 1.414), pts, actu_desired);
+    // Differentiate the gyro data
+    for (int i = 1; i < pts; i++) {
+        gyro_deriv[i] = flash_data->data[i].y[axis] - flash_data->data[i - 1].y[axis];
+    }
 
-        QVector<float> gyro_sorted = gyro_deriv;
-        QVector<float> actu_sorted = actu_desired;
+    gyro_deriv[0] = flash_data->data[0].y[axis] - flash_data->data[pts - 1].y[axis];
 
-        std::sort(gyro_sorted.begin(), gyro_sorted.end());
-        std::sort(actu_sorted.begin(), actu_sorted.end());
+    SignalProcessing::CrossCorrelator correlator;
+    int maxLag = pts / 2 / ((axis == 2) ? 8 : 4);
+    float sample_tau = correlator.delay(gyro_deriv, actu_desired, maxLag);
 
-        int low_idx = pts * 0.05 + 0.5;
-        int high_idx = pts - 1 - low_idx;
+    float tau = sample_tau / flash_data->hdr.sample_rate;
 
-        float gyro_span = gyro_sorted[high_idx] - gyro_sorted[low_idx];
-        float actu_span = actu_sorted[high_idx] - actu_sorted[low_idx];
+    SignalProcessing::BiquadLowpass(1 / (sample_tau * M_PI * 1.414)).filterCircular(actu_desired);
 
-        float gain = gyro_span / actu_span * flash_data->hdr.sample_rate;
+    QVector<float> gyro_sorted = gyro_deriv;
+    QVector<float> actu_sorted = actu_desired;
 
-        float avg = std::accumulate(gyro_deriv.begin(), gyro_deriv.end(), 0.0f) / pts;
+    std::sort(gyro_sorted.begin(), gyro_sorted.end());
+    std::sort(actu_sorted.begin(), actu_sorted.end());
 
-        for (int i = 0; i < pts; i++) {
-            gyro_deriv[i] = gyro_deriv[i] - avg;
-        }
+    int low_idx = pts * 0.05 + 0.5;
+    int high_idx = pts - 1 - low_idx;
 
-        float avg_act = std::accumulate(actu_desired.begin(), actu_desired.end(), 0.0f) / pts;
+    float gyro_span = gyro_sorted[high_idx] - gyro_sorted[low_idx];
+    float actu_span = actu_sorted[high_idx] - actu_sorted[low_idx];
 
-        for (int i = 0; i < pts; i++) {
-            actu_desired[i] = (actu_desired[i] - avg_act) * (gain / flash_data->hdr.sample_rate);
-        }
+    float gain = gyro_span / actu_span * flash_data->hdr.sample_rate;
 
-        tuneState->model[axis] = new QLineSeries(this);
-        tuneState->actual[axis] = new QLineSeries(this);
+    float avg = std::accumulate(gyro_deriv.begin(), gyro_deriv.end(), 0.0f) / pts;
 
-        for (int i = 0; i < pts; i++) {
-            int tm = (i * 1000) / flash_data->hdr.sample_rate;
+    for (int i = 0; i < pts; i++) {
+        gyro_deriv[i] = gyro_deriv[i] - avg;
+    }
 
-            tuneState->model[axis]->append(tm, actu_desired[i]);
-            tuneState->actual[axis]->append(tm, gyro_deriv[i]);
-        }
+    float avg_act = std::accumulate(actu_desired.begin(), actu_desired.end(), 0.0f) / pts;
+
+    for (int i = 0; i < pts; i++) {
+        actu_desired[i] = (actu_desired[i] - avg_act) * (gain / flash_data->hdr.sample_rate);
+    }
 
-        float bias = avg - avg_act * (gain / flash_data->hdr.sample_rate);
+    analysis.model.resize(pts);
+    analysis.actual.resize(pts);
 
-        double noise = 0;
+    for (int i = 0; i < pts; i++) {
+        int tm = (i * 1000) / flash_data->hdr.sample_rate;
 
-        for (int i = 0; i < pts; i++) {
-            noise += (actu_desired[i] - gyro_deriv[i]) * (actu_desired[i] - gyro_deriv[i]);
-        }
+        analysis.model[i] = QPointF(tm, actu_desired[i]);
+        analysis.actual[i] = QPointF(tm, gyro_deriv[i]);
+    }
 
-        noise = sqrt(noise / pts);
+    float bias = avg - avg_act * (gain / flash_data->hdr.sample_rate);
 
-        qDebug() << "Series " << axis << ": tau=" << tau << "; gain=" << gain << " (" << log(gain)
-                 << "); bias=" << bias << " noise=" << noise << "";
+    double noise = 0;
 
-        tuneState->tau[axis] = tau;
-        tuneState->beta[axis] = log(gain);
-        tuneState->bias[axis] = bias;
-        tuneState->noise[axis] = noise;
+    for (int i = 0; i < pts; i++) {
+        noise += (actu_desired[i] - gyro_deriv[i]) * (actu_desired[i] - gyro_deriv[i]);
     }
 
-    tuneState->valid = true;
+    noise = sqrt(noise / pts);
 
-    return true;
+    qDebug() << "Series " << axis << ": tau=" << tau << "; gain=" << gain << " (" << log(gain)
+             << "); bias=" << bias << " noise=" << noise << "";
+
+    analysis.tau = tau;
+    analysis.beta = log(gain);
+    analysis.bias = bias;
+    analysis.noise = noise;
+
+    return analysis;
 }
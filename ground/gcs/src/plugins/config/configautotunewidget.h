@@ -36,8 +36,13 @@
 #include "systemident.h"
 
 #include <QChart>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QLineSeries>
+#include <QPair>
+#include <QPointF>
 #include <QTimer>
+#include <QVector>
 #include <QWidget>
 #include <QWizardPage>
 #include <QtNetwork/QNetworkReply>
@@ -87,6 +92,18 @@ struct AutotunedValues
     QLineSeries *actual[3];
 };
 
+// What the analysis of the autotune data finds for one axis
+struct AutotuneAxisAnalysis
+{
+    float tau;
+    float beta;
+    float bias;
+    float noise;
+
+    QVector<QPointF> model;
+    QVector<QPointF> actual;
+};
+
 class AutotuneBeginningPage : public QWizardPage, private Ui::AutotuneBeginning
 {
     Q_OBJECT
@@ -105,12 +122,13 @@ private:
     AutotunedValues *tuneState;
     bool autoOpened;
     bool dataValid;
+    QFutureWatcher<AutotuneAxisAnalysis> analysisWatcher;
 
     /* Need a better place for all of these implementation things.  But
      * for now this is at least encapsulated and won't get tainted
      * elsewhere
      */
-    const uint64_t ATFLASH_MAGIC = 0x656e755480008041;
+    static const uint64_t ATFLASH_MAGIC = 0x656e755480008041;
 
     struct at_flash_header
     {
@@ -136,13 +154,23 @@ private:
         struct at_measurement data[];
     };
 
+    // Analyses an axis on a worker thread
+    struct AxisAnalyzer
+    {
+        typedef AutotuneAxisAnalysis result_type;
+
+        AxisAnalyzer(const QByteArray &data) : data(data) {}
+        AutotuneAxisAnalysis operator()(int axis) const;
+
+        QByteArray data;
+    };
+
     bool processAutotuneData();
-    void biquadFilter(float cutoff, int pts, QVector<float> &data);
-    float getSampleDelay(int pts, const QVector<float> &delayed,
-            const QVector<float> &orig, int seriesCutoff = 4);
 
 private slots:
     void doDownloadAndProcess();
+    void analysisProgress(int axesDone);
+    void analysisFinished();
 
 };
 
@@ -171,11 +199,28 @@ public:
     bool isComplete() const;
 
     void initializePage();
+    bool validatePage();
 
 private:
+    // The solution of the filter and natural frequency iteration
+    struct Solution
+    {
+        bool converged;
+        int iterations;
+        double wn;
+        double tau_d;
+    };
+
+    // Time for the sliders to settle before the gains are computed
+    static const int COMPUTE_DELAY_MS = 50;
+
     AutotunedValues *tuneState;
+    QTimer computeTimer;
+    // Solutions by damping and noise slider positions
+    QHash<QPair<int, int>, Solution> solutions;
 
     void setText(QLabel *lbl, double value, int precision);
+    Solution solve(double damp, double ghf) const;
 
 private slots:
     void compute();
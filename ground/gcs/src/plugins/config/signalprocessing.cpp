@@ -0,0 +1,167 @@
+/**
+ ******************************************************************************
+ *
+ * @file       signalprocessing.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Filtering and correlation of sampled sensor data
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#define _USE_MATH_DEFINES
+
+#include <cmath>
+
+#include "ffft/FFTReal.h"
+
+#include "signalprocessing.h"
+
+namespace SignalProcessing {
+
+BiquadLowpass::BiquadLowpass(float cutoff)
+{
+    float f = 1.0f / tan(M_PI * cutoff);
+    float q = 1.4142f;
+
+    b0 = 1.0f / (1.0f + q * f + f * f);
+    a1 = 2.0f * (f * f - 1.0f) * b0;
+    a2 = -(1.0f - q * f + f * f) * b0;
+}
+
+void BiquadLowpass::filterCircular(QVector<float> &data) const
+{
+    const int pts = data.size();
+    if (pts < 2)
+        return;
+
+    const float *x = data.constData();
+
+    // Feed forward terms, with the inputs before the start taken from the end
+    QVector<float> forward(pts);
+    forward[0] = b0 * (x[0] + 2.0f * x[pts - 1] + x[pts - 2]);
+    forward[1] = b0 * (x[1] + 2.0f * x[0] + x[pts - 1]);
+    for (int i = 2; i < pts; i++)
+        forward[i] = b0 * (x[i] + 2.0f * x[i - 1] + x[i - 2]);
+
+    // Priming pass, which starts out with no earlier inputs at all
+    float y2 = b0 * x[0];
+    float y1 = b0 * (x[1] + 2.0f * x[0]) + a1 * y2;
+    float y;
+    for (int i = 2; i < pts; i++) {
+        y = forward[i] + a1 * y1 + a2 * y2;
+        y2 = y1;
+        y1 = y;
+    }
+
+    float *out = data.data();
+    for (int i = 0; i < pts; i++) {
+        y = forward[i] + a1 * y1 + a2 * y2;
+        y2 = y1;
+        y1 = y;
+        out[i] = y;
+    }
+}
+
+CrossCorrelator::CrossCorrelator()
+{
+}
+
+CrossCorrelator::~CrossCorrelator()
+{
+}
+
+void CrossCorrelator::setLength(int length)
+{
+    if (fft && fft->get_length() == length)
+        return;
+
+    fft.reset(new ffft::FFTReal<float>(length));
+    delayedFft.resize(length);
+    origFft.resize(length);
+    product.resize(length);
+    correlation.resize(length);
+}
+
+int CrossCorrelator::delay(const QVector<float> &delayed, const QVector<float> &orig, int maxLag)
+{
+    const int pts = delayed.size();
+    Q_ASSERT(orig.size() == pts);
+
+    setLength(pts);
+
+    /* Convert to frequency domain */
+    fft->do_fft(delayedFft.data(), delayed.constData());
+    fft->do_fft(origFft.data(), orig.constData());
+
+    /* Now perform a correlation by multiplying -orig_fft* by delayed_fft.
+     * gfft = x+yi, dfft = u+vi, dfft* = u-vi, -dfft* = -u + vi
+     *
+     * -dfft* x gfft = (-ux - vy) + (vx - uy)i
+     *
+     * FFTReal keeps all the reals, then all the imaginaries, so this is a
+     * plain elementwise loop.
+     */
+    const int fpts = pts / 2;
+    const float *dre = delayedFft.constData();
+    const float *dim = dre + fpts;
+    const float *ore = origFft.constData();
+    const float *oim = ore + fpts;
+    float *pre = product.data();
+    float *pim = pre + fpts;
+
+    for (int i = 0; i < fpts; i++) {
+        pre[i] = -(ore[i] * dre[i]) - (oim[i] * dim[i]);
+        pim[i] = (oim[i] * dre[i]) - (ore[i] * dim[i]);
+    }
+
+    /* Inverse FFT converts this to the time domain */
+    fft->do_ifft(product.constData(), correlation.data());
+
+    /* The strongest lag has the largest magnitude; squares order the same */
+    const int lags = qMin(maxLag, fpts);
+    const float *cre = correlation.constData();
+    const float *cim = cre + fpts;
+
+    int maxIdx = 0;
+    float maxVal = 0;
+
+    for (int i = 0; i < lags; i++) {
+        float mag = cre[i] * cre[i] + cim[i] * cim[i];
+
+        if (mag > maxVal) {
+            maxVal = mag;
+            maxIdx = i;
+        }
+    }
+
+    // TODO / optional: interpolate/find a better peak around maxIdx.
+
+    return maxIdx;
+}
+
+} // namespace SignalProcessing
+
+/**
+ * @}
+ * @}
+ */
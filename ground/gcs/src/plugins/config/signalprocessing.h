@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       signalprocessing.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ConfigPlugin Config Plugin
+ * @{
+ * @brief Filtering and correlation of sampled sensor data
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef SIGNALPROCESSING_H
+#define SIGNALPROCESSING_H
+
+#include <QScopedPointer>
+#include <QVector>
+
+namespace ffft {
+template <class DT>
+class FFTReal;
+}
+
+namespace SignalProcessing {
+
+/**
+ * @brief A second order Butterworth lowpass, as used by the flight side.
+ *
+ * The feed forward half of the filter doesn't depend on earlier outputs, so it
+ * is worked out for the whole series first, in a loop the compiler can
+ * vectorize. Only the feedback half is left to the sequential pass.
+ */
+class BiquadLowpass
+{
+public:
+    /**
+     * @param cutoff cutoff frequency, as a fraction of the sample rate
+     */
+    explicit BiquadLowpass(float cutoff);
+
+    /**
+     * @brief Filter a circular buffer in place. The filter goes around once
+     * to prime its state first, so the start of the series sees the end.
+     */
+    void filterCircular(QVector<float> &data) const;
+
+private:
+    float b0;
+    float a1, a2;
+};
+
+/**
+ * @brief Finds the delay between two series by FFT cross-correlation.
+ *
+ * The transform and the buffers are kept between calls of the same length.
+ * The FFT object has a scratch buffer of its own, so a correlator must only
+ * be used by one thread at a time.
+ */
+class CrossCorrelator
+{
+public:
+    CrossCorrelator();
+    ~CrossCorrelator();
+
+    /**
+     * @brief Number of samples @p delayed lags behind @p orig
+     * @param delayed series of a power of 2 length
+     * @param orig series of the same length
+     * @param maxLag lags from maxLag on are not considered
+     * @return lag with the strongest correlation
+     */
+    int delay(const QVector<float> &delayed, const QVector<float> &orig, int maxLag);
+
+private:
+    void setLength(int length);
+
+    QScopedPointer<ffft::FFTReal<float> > fft;
+    QVector<float> delayedFft;
+    QVector<float> origFft;
+    QVector<float> product;
+    QVector<float> correlation;
+};
+
+} // namespace SignalProcessing
+
+#endif // SIGNALPROCESSING_H
+
+/**
+ * @}
+ * @}
+ */
@@ -118,78 +118,50 @@ void AlarmsMonitorWidget::init(QSvgRenderer *renderer, QGraphicsSvgItem *graph)
 
 void AlarmsMonitorWidget::updateMessages()
 {
-    QString error;
-    error.append("<html><head/><body>");
-    foreach (Core::GlobalMessage *msg,
-             Core::ICore::instance()->globalMessaging()->getActiveErrors()) {
-        QString temp;
-        temp = QString("<p><span style=' font-size:11pt; font-weight:600;'>%0</span></p>")
-                   .arg(msg->getBrief());
-        error.append(temp);
-        temp = QString("<p><span style=' font-style:italic;'>%0</span></p>")
-                   .arg(msg->getDescription());
-        error.append(temp);
-    }
-    error.append("</body></html>");
-    QString warning;
-    warning.append("<html><head/><body>");
-    foreach (Core::GlobalMessage *msg,
-             Core::ICore::instance()->globalMessaging()->getActiveWarnings()) {
-        QString temp;
-        temp = QString("<p><span style=' font-size:11pt; font-weight:600;'>%0</span></p>")
-                   .arg(msg->getBrief());
-        warning.append(temp);
-        temp = QString("<p><span style=' font-style:italic;'>%0</span></p>")
-                   .arg(msg->getDescription());
-        warning.append(temp);
-    }
-    warning.append("</body></html>");
-    QString info;
-    info.append("<html><head/><body>");
-    foreach (Core::GlobalMessage *msg,
-             Core::ICore::instance()->globalMessaging()->getActiveInfos()) {
-        QString temp;
-        temp = QString("<p><span style=' font-size:11pt; font-weight:600;'>%0</span></p>")
-                   .arg(msg->getBrief());
-        info.append(temp);
-        temp = QString("<p><span style=' font-style:italic;'>%0</span></p>")
-                   .arg(msg->getDescription());
-        info.append(temp);
-    }
-    info.append("</body></html>");
-    error_txt->setPlainText(
-        QString::number(Core::ICore::instance()->globalMessaging()->getActiveErrors().length()));
-    if (Core::ICore::instance()->globalMessaging()->getActiveErrors().length() > 0) {
-        error_txt->setOpacity(1);
-        hasErrors = true;
-    } else {
-        error = "No errors";
-        error_txt->setOpacity(DIMMED_SYMBOL);
-        hasErrors = false;
-    }
-    warning_txt->setPlainText(
-        QString::number(Core::ICore::instance()->globalMessaging()->getActiveWarnings().length()));
-    if (Core::ICore::instance()->globalMessaging()->getActiveWarnings().length() > 0) {
-        warning_txt->setOpacity(1);
-        hasWarnings = true;
-    } else {
-        warning = "No warnings";
-        warning_txt->setOpacity(DIMMED_SYMBOL);
-        hasWarnings = false;
-    }
-    info_txt->setPlainText(
-        QString::number(Core::ICore::instance()->globalMessaging()->getActiveInfos().length()));
-    if (Core::ICore::instance()->globalMessaging()->getActiveInfos().length() > 0) {
-        info_txt->setOpacity(1);
-        hasInfos = true;
+    Core::GlobalMessaging *messaging = Core::ICore::instance()->globalMessaging();
+
+    hasErrors = updateIndicator(messaging->getActiveErrors(), error_sym, error_txt, "No errors");
+    hasWarnings =
+        updateIndicator(messaging->getActiveWarnings(), warning_sym, warning_txt, "No warnings");
+    hasInfos = updateIndicator(messaging->getActiveInfos(), info_sym, info_txt, "No info");
+}
+
+/**
+ * @brief Show the count and descriptions of one kind of messages, touching
+ * the items only where they differ from what is shown
+ * @param messages the active messages of that kind
+ * @param sym the symbol, its tooltip lists the messages
+ * @param txt the count
+ * @param none tooltip when there are no messages
+ * @return true if there are any messages
+ */
+bool AlarmsMonitorWidget::updateIndicator(const QList<Core::GlobalMessage *> &messages,
+                                          QGraphicsSvgItem *sym, QGraphicsTextItem *txt,
+                                          const QString &none)
+{
+    QString tip;
+    if (messages.isEmpty()) {
+        tip = none;
     } else {
-        info = "No info";
-        info_txt->setOpacity(DIMMED_SYMBOL);
-        hasInfos = false;
+        tip.append("<html><head/><body>");
+        foreach (Core::GlobalMessage *msg, messages) {
+            tip.append(QString("<p><span style=' font-size:11pt; font-weight:600;'>%0</span></p>")
+                           .arg(msg->getBrief()));
+            tip.append(QString("<p><span style=' font-style:italic;'>%0</span></p>")
+                           .arg(msg->getDescription()));
+        }
+        tip.append("</body></html>");
     }
-    error_sym->setToolTip(error);
-    warning_sym->setToolTip(warning);
-    info_sym->setToolTip(info);
+
+    // Setting the text lays it out again and repaints, even if it's the same
+    QString count = QString::number(messages.length());
+    if (txt->toPlainText() != count)
+        txt->setPlainText(count);
+    if (sym->toolTip() != tip)
+        sym->setToolTip(tip);
+    txt->setOpacity(messages.isEmpty() ? DIMMED_SYMBOL : 1);
+
+    return !messages.isEmpty();
 }
 
 void AlarmsMonitorWidget::updateNeeded()
@@ -31,6 +31,10 @@
 #include <QSvgRenderer>
 #include <QTimer>
 
+namespace Core {
+class GlobalMessage;
+}
+
 class AlarmsMonitorWidget : public QObject
 {
     Q_OBJECT
@@ -52,6 +56,8 @@ private:
     AlarmsMonitorWidget();
     AlarmsMonitorWidget(AlarmsMonitorWidget const &); // Don't Implement.
     void operator=(AlarmsMonitorWidget const &); // Don't implement
+    bool updateIndicator(const QList<Core::GlobalMessage *> &messages, QGraphicsSvgItem *sym,
+                         QGraphicsTextItem *txt, const QString &none);
     QGraphicsSvgItem *error_sym;
     QGraphicsSvgItem *warning_sym;
     QGraphicsSvgItem *info_sym;
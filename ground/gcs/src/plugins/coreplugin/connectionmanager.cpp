@@ -50,6 +50,7 @@ ConnectionManager::ConnectionManager(Internal::MainWindow *mainWindow, QTabWidge
     , m_ioDev(NULL)
     , polling(true)
     , m_mainWindow(mainWindow)
+    , m_lostConnection(NULL)
 {
     QHBoxLayout *layout = new QHBoxLayout;
     layout->setSpacing(5);
@@ -125,6 +126,25 @@ void ConnectionManager::connectDeviceFailed(DevListItem &device)
     msgFailedToConnect.open();
 }
 
+/**
+ * @brief Whether a device is the one that went away while connected
+ * @param device The device to check
+ */
+bool ConnectionManager::isLostDevice(DevListItem &device)
+{
+    if (!m_lostConnection || device.connection != m_lostConnection || device.device.isNull())
+        return false;
+
+    if (m_lostTimer.elapsed() > FAST_RECONNECT_WINDOW_MS) {
+        m_lostConnection = NULL;
+        return false;
+    }
+
+    // USB devices are named by serial number, so this finds the same board
+    // even if it enumerates on a different path
+    return device.device->getName() == m_lostDeviceName;
+}
+
 /**
 *   Method called when the user clicks the "Connect" button
 */
@@ -154,6 +174,7 @@ bool ConnectionManager::connectDevice(DevListItem device)
     // we appear to have connected to the device OK
     // remember the connection/device details
     m_connectionDevice = device;
+    m_lostConnection = NULL;
     m_ioDev = io_dev;
 
     connect(m_connectionDevice.connection, SIGNAL(destroyed(QObject *)), this,
@@ -323,6 +344,14 @@ void ConnectionManager::telemetryUpdated(double txRate, double rxRate)
     m_monitorWidget->updateTelemetry(txRate, rxRate);
 }
 
+/**
+*   Slot called when the link latency figures are updated
+*/
+void ConnectionManager::linkLatencyUpdated(double rttMs, double uplinkMs, double downlinkMs)
+{
+    m_monitorWidget->updateLatency(rttMs, uplinkMs, downlinkMs);
+}
+
 void ConnectionManager::reconnectSlot()
 {
     qDebug() << "reconnect";
@@ -424,6 +453,12 @@ void ConnectionManager::updateConnectionList(IConnection *connection)
             // we are currently using the one we are about to erase
             if (m_connectionDevice.connection && m_connectionDevice.connection == connection
                 && m_connectionDevice.device == iter->device) {
+                if (!iter->device.isNull()) {
+                    m_lostConnection = connection;
+                    m_lostDeviceName = iter->device->getName();
+                    m_lostTimer.start();
+                }
+
                 disconnectDevice();
             }
 
@@ -495,7 +530,13 @@ void ConnectionManager::updateConnectionDropdown()
         m_availableDevList->addItem(d.getConName());
         m_availableDevList->setItemData(m_availableDevList->count() - 1, d.getConName(),
                                         Qt::ToolTipRole);
-        if (!m_ioDev && d.getConName().startsWith("USB")) {
+        if (!m_ioDev && polling && isLostDevice(d)) {
+            // Don't wait for the user or autoconnect, the board just rebooted
+            m_availableDevList->setCurrentIndex(m_availableDevList->count() - 1);
+            qDebug() << "Reconnecting device that went away:" << d.getConName();
+            if (!connectDevice(d))
+                m_lostConnection = NULL;
+        } else if (!m_ioDev && d.getConName().startsWith("USB")) {
             if (m_mainWindow->generalSettings()->autoConnect()
                 || m_mainWindow->generalSettings()->autoSelect())
                 m_availableDevList->setCurrentIndex(m_availableDevList->count() - 1);
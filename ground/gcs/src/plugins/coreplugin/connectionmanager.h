@@ -48,6 +48,7 @@
 
 #include "core_global.h"
 #include <QTimer>
+#include <QElapsedTimer>
 
 QT_BEGIN_NAMESPACE
 class QTabWidget;
@@ -132,6 +133,7 @@ public slots:
     void telemetryConnected();
     void telemetryDisconnected();
     void telemetryUpdated(double txRate, double rxRate);
+    void linkLatencyUpdated(double rttMs, double uplinkMs, double downlinkMs);
 
 private slots:
     void objectAdded(QObject *obj);
@@ -175,7 +177,15 @@ private:
     QTimer *reconnect;
     QTimer *reconnectCheck;
 
+    // A device that went away while connected, e.g. rebooting after
+    // saving hardware settings, is reconnected when it comes back
+    static const int FAST_RECONNECT_WINDOW_MS = 30000;
+    IConnection *m_lostConnection;
+    QString m_lostDeviceName;
+    QElapsedTimer m_lostTimer;
+
     void connectDeviceFailed(DevListItem &device);
+    bool isLostDevice(DevListItem &device);
 };
 
 } // namespace Core
@@ -48,6 +48,9 @@ GlobalMessage::GlobalMessage(MessageType type, QObject *parent)
 
 void GlobalMessage::setActive(bool value)
 {
+    // Alarms set every message on each update, most of them as they were
+    if (m_active == value)
+        return;
     m_active = value;
     emit changed(this);
 }
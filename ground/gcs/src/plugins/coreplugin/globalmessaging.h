@@ -51,11 +51,15 @@ public:
     }
     void setBrief(QString brief)
     {
+        if (m_brief == brief)
+            return;
         m_brief = brief;
         emit changed(this);
     }
     void setDescription(QString description)
     {
+        if (m_description == description)
+            return;
         m_description = description;
         emit changed(this);
     }
@@ -66,6 +66,9 @@ public:
     virtual void saveState(QSettings * /*qSettings*/) {}
     virtual void restoreState(QByteArray) {}
     virtual void restoreState(QSettings * /*qSettings*/) {}
+    // Called with false when the workspace of the gadget is hidden, and with
+    // true when it is shown again; a gadget may drop its object updates meanwhile
+    virtual void setActive(bool /*active*/) {}
 public slots:
     virtual void configurationChanged(IUAVGadgetConfiguration *) {}
     virtual void configurationAdded(IUAVGadgetConfiguration *) {}
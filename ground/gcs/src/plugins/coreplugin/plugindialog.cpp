@@ -32,12 +32,17 @@
 #include <extensionsystem/plugindetailsview.h>
 #include <extensionsystem/pluginerrorview.h>
 #include <extensionsystem/pluginspec.h>
+#include <extensionsystem/startupprofiler.h>
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QMessageBox>
 #include <QPushButton>
+#include <QTreeWidget>
 #include <QtDebug>
 
 using namespace Core::Internal;
@@ -51,6 +56,7 @@ PluginDialog::PluginDialog(QWidget *parent)
 
     m_detailsButton = new QPushButton(tr("Details"), this);
     m_errorDetailsButton = new QPushButton(tr("Error Details"), this);
+    m_profileButton = new QPushButton(tr("Startup Profile"), this);
     m_closeButton = new QPushButton(tr("Close"), this);
     m_detailsButton->setEnabled(false);
     m_errorDetailsButton->setEnabled(false);
@@ -60,6 +66,7 @@ PluginDialog::PluginDialog(QWidget *parent)
     QHBoxLayout *hl = new QHBoxLayout;
     hl->addWidget(m_detailsButton);
     hl->addWidget(m_errorDetailsButton);
+    hl->addWidget(m_profileButton);
     hl->addStretch(5);
     hl->addWidget(m_closeButton);
 
@@ -75,6 +82,7 @@ PluginDialog::PluginDialog(QWidget *parent)
             SLOT(openDetails(ExtensionSystem::PluginSpec *)));
     connect(m_detailsButton, SIGNAL(clicked()), this, SLOT(openDetails()));
     connect(m_errorDetailsButton, SIGNAL(clicked()), this, SLOT(openErrorDetails()));
+    connect(m_profileButton, SIGNAL(clicked()), this, SLOT(openProfile()));
     connect(m_closeButton, SIGNAL(clicked()), this, SLOT(accept()));
     updateButtons();
 }
@@ -136,3 +144,60 @@ void PluginDialog::openErrorDetails()
     dialog.resize(500, 300);
     dialog.exec();
 }
+
+/**
+ * @brief Shows the time plugins, modes and gadgets took to come up
+ */
+void PluginDialog::openProfile()
+{
+    QDialog dialog(this);
+    dialog.setWindowTitle(tr("Startup Profile"));
+    QVBoxLayout *layout = new QVBoxLayout;
+    dialog.setLayout(layout);
+
+    QTreeWidget *events = new QTreeWidget(&dialog);
+    events->setRootIsDecorated(false);
+    events->setHeaderLabels(QStringList() << tr("Name") << tr("Step") << tr("Start (ms)")
+                                          << tr("Duration (ms)"));
+    foreach (const ExtensionSystem::StartupProfiler::Event &event,
+             ExtensionSystem::StartupProfiler::events()) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(events);
+        item->setText(0, event.name);
+        item->setText(1, event.category);
+        // Numbers, so the columns sort by time
+        item->setData(2, Qt::DisplayRole, qRound(event.start / 100.0) / 10.0);
+        item->setData(3, Qt::DisplayRole, qRound(event.duration / 100.0) / 10.0);
+    }
+    events->setSortingEnabled(true);
+    events->sortItems(3, Qt::DescendingOrder);
+    events->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    layout->addWidget(events);
+
+    QDialogButtonBox *buttons =
+        new QDialogButtonBox(QDialogButtonBox::Close, Qt::Horizontal, &dialog);
+    QPushButton *exportButton =
+        buttons->addButton(tr("Export Chrome Trace..."), QDialogButtonBox::ActionRole);
+    layout->addWidget(buttons);
+    connect(exportButton, SIGNAL(clicked()), this, SLOT(exportProfile()));
+    connect(buttons, SIGNAL(accepted()), &dialog, SLOT(accept()));
+    connect(buttons, SIGNAL(rejected()), &dialog, SLOT(reject()));
+    dialog.resize(550, 500);
+    dialog.exec();
+}
+
+/**
+ * @brief Saves the startup profile in the Chrome trace event format, for
+ * chrome://tracing
+ */
+void PluginDialog::exportProfile()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Export Startup Profile"),
+                                                    "gcs_startup.json", tr("Trace (*.json)"));
+    if (fileName.isEmpty())
+        return;
+
+    QString error;
+    if (!ExtensionSystem::StartupProfiler::writeChromeTrace(fileName, &error))
+        QMessageBox::warning(this, tr("Export Startup Profile"),
+                             tr("Could not write %1: %2").arg(fileName).arg(error));
+}
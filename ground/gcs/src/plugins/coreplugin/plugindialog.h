@@ -54,12 +54,15 @@ namespace Internal {
         void openDetails();
         void openDetails(ExtensionSystem::PluginSpec *spec);
         void openErrorDetails();
+        void openProfile();
+        void exportProfile();
 
     private:
         ExtensionSystem::PluginView *m_view;
 
         QPushButton *m_detailsButton;
         QPushButton *m_errorDetailsButton;
+        QPushButton *m_profileButton;
         QPushButton *m_closeButton;
     };
 
@@ -123,6 +123,9 @@ TelemetryMonitorWidget::TelemetryMonitorWidget(QWidget *parent)
     m_connected = false;
     txValue = 0.0;
     rxValue = 0.0;
+    rttValue = -1.0;
+    uplinkValue = 0.0;
+    downlinkValue = 0.0;
 
     setMin(0.0);
     setMax(1200.0);
@@ -153,6 +156,7 @@ void TelemetryMonitorWidget::disconnect()
     updateTelemetry(maxValue, maxValue);
 
     m_connected = false;
+    rttValue = -1.0;
     updateTelemetry(0.0, 0.0);
 }
 
@@ -168,6 +172,18 @@ void TelemetryMonitorWidget::updateTelemetry(double txRate, double rxRate)
     showTelemetry();
 }
 
+/**
+ * @brief Median link latency this connection, shown in the tooltip
+ */
+void TelemetryMonitorWidget::updateLatency(double rttMs, double uplinkMs, double downlinkMs)
+{
+    rttValue = rttMs;
+    uplinkValue = uplinkMs;
+    downlinkValue = downlinkMs;
+
+    showTelemetry();
+}
+
 /** Converts the value into an percentage:
  * this enables smooth movement in moveIndex below
  */
@@ -176,11 +192,17 @@ void TelemetryMonitorWidget::showTelemetry()
     txIndex = (txValue - minValue) / (maxValue - minValue) * NODE_NUMELEM;
     rxIndex = (rxValue - minValue) / (maxValue - minValue) * NODE_NUMELEM;
 
-    if (m_connected)
-        this->setToolTip(QString("Tx: %0 bytes/sec\nRx: %1 bytes/sec")
-                             .arg(txValue, 0, 'f', 0)
-                             .arg(rxValue, 0, 'f', 0));
-    else
+    if (m_connected) {
+        QString tip = QString("Tx: %0 bytes/sec\nRx: %1 bytes/sec")
+                          .arg(txValue, 0, 'f', 0)
+                          .arg(rxValue, 0, 'f', 0);
+        if (rttValue >= 0)
+            tip += QString("\nLatency: %0 ms round trip (%1 up, %2 down)")
+                       .arg(rttValue, 0, 'f', 0)
+                       .arg(uplinkValue, 0, 'f', 0)
+                       .arg(downlinkValue, 0, 'f', 0);
+        this->setToolTip(tip);
+    } else
         this->setToolTip(QString("Disconnected"));
 
     int i;
@@ -61,6 +61,7 @@ public slots:
     void disconnect();
 
     void updateTelemetry(double txRate, double rxRate);
+    void updateLatency(double rttMs, double uplinkMs, double downlinkMs);
     void showTelemetry();
 
 protected:
@@ -78,6 +79,9 @@ private:
     double txValue;
     double rxIndex;
     double rxValue;
+    double rttValue; // Negative until the board echoes a ping
+    double uplinkValue;
+    double downlinkValue;
     double minValue;
     double maxValue;
     QSvgRenderer *renderer;
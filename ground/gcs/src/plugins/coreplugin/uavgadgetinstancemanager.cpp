@@ -36,6 +36,7 @@
 #include "icore.h"
 
 #include <extensionsystem/pluginmanager.h>
+#include <extensionsystem/startupprofiler.h>
 #include <QtCore/QStringList>
 #include <QtCore/QSettings>
 #include <QtCore/QDebug>
@@ -265,6 +266,7 @@ IUAVGadget *UAVGadgetInstanceManager::createGadget(QString classId, QWidget *par
         else
             emit splashMessages(tr("Loading EmptyGadget"));
         QList<IUAVGadgetConfiguration *> *configs = configurations(classId);
+        ExtensionSystem::StartupProfiler::Scope scope(classId, "gadget");
         IUAVGadget *g = f->createGadget(parent);
         IUAVGadget *gadget = new UAVGadgetDecorator(g, configs, forceLoadConfiguration);
         m_gadgetInstances.append(gadget);
@@ -46,6 +46,7 @@
 #include <coreplugin/imode.h>
 
 #include <extensionsystem/pluginmanager.h>
+#include <extensionsystem/startupprofiler.h>
 
 #include <utils/qtcassert.h>
 
@@ -53,6 +54,7 @@
 #include <QtCore/QMap>
 #include <QtCore/QProcess>
 #include <QtCore/QSet>
+#include <QtCore/QTemporaryFile>
 
 #include <QAction>
 #include <QApplication>
@@ -82,6 +84,8 @@ UAVGadgetManager::UAVGadgetManager(ICore *core, QString name, QIcon icon, int pr
     , m_icon(icon)
     , m_priority(priority)
     , m_widget(new QWidget(parent))
+    , m_statePending(false)
+    , m_gadgetsActive(true)
 {
 
     // checking that the mode name is unique gives harmless
@@ -133,13 +137,19 @@ QList<int> UAVGadgetManager::context() const
 
 void UAVGadgetManager::modeChanged(Core::IMode *mode)
 {
-    if (mode != this)
+    if (mode != this) {
+        setGadgetsActive(false);
         return;
+    }
+
+    restorePendingState();
 
     if (!m_currentGadget) {
         m_splitterOrView->view()->doReplaceGadget(0);
     }
 
+    setGadgetsActive(true);
+
     m_currentGadget->widget()->setFocus();
     showToolbars(toolbarsShown());
 }
@@ -284,6 +294,13 @@ void UAVGadgetManager::updateUavGadgetMenus()
 
 void UAVGadgetManager::saveState(QSettings *qSettings) const
 {
+    // Never shown, so the workspace is still as it was read
+    if (m_statePending) {
+        for (int i = 0; i < m_pendingState.size(); i++)
+            qSettings->setValue(m_pendingState.at(i).first, m_pendingState.at(i).second);
+        return;
+    }
+
     qSettings->setValue("version", "UAVGadgetManagerV1");
     qSettings->setValue("showToolbars", m_showToolbars);
     qSettings->beginGroup("splitter");
@@ -309,9 +326,12 @@ bool UAVGadgetManager::restoreState(QSettings *qSettings)
 
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
-    qSettings->beginGroup("splitter");
-    m_splitterOrView->restoreState(qSettings);
-    qSettings->endGroup();
+    {
+        ExtensionSystem::StartupProfiler::Scope scope(name(), "mode");
+        qSettings->beginGroup("splitter");
+        m_splitterOrView->restoreState(qSettings);
+        qSettings->endGroup();
+    }
 
     QApplication::restoreOverrideCursor();
     return true;
@@ -346,14 +366,66 @@ void UAVGadgetManager::readSettings(QSettings *qs)
     }
     qs->beginGroup(uniqueModeName());
 
-    restoreState(qs);
-
-    showToolbars(m_showToolbars);
+    if (m_core->modeManager()->currentMode() == this) {
+        m_statePending = false;
+        m_pendingState.clear();
+        restoreState(qs);
+        showToolbars(m_showToolbars);
+    } else {
+        // Gadgets are only created once the mode is shown, a workspace
+        // never opened costs nothing
+        m_pendingState.clear();
+        foreach (const QString &key, qs->allKeys())
+            m_pendingState.append(qMakePair(key, qs->value(key)));
+        m_statePending = true;
+    }
 
     qs->endGroup();
     qs->endGroup();
 }
 
+/**
+ * @brief Create the gadgets of the workspace as read by readSettings()
+ */
+void UAVGadgetManager::restorePendingState()
+{
+    if (!m_statePending)
+        return;
+
+    m_statePending = false;
+
+    // restoreState() and the gadgets take a QSettings, so hand them one
+    // holding only this workspace; it is never written to disk
+    QTemporaryFile file;
+    if (!file.open()) {
+        qWarning() << "[UAVGadgetManager] Can't restore workspace" << m_name;
+        m_pendingState.clear();
+        return;
+    }
+
+    {
+        QSettings qs(file.fileName(), QSettings::IniFormat);
+        for (int i = 0; i < m_pendingState.size(); i++)
+            qs.setValue(m_pendingState.at(i).first, m_pendingState.at(i).second);
+        restoreState(&qs);
+    }
+
+    m_pendingState.clear();
+}
+
+/**
+ * @brief Tell the gadgets whether their workspace is shown
+ */
+void UAVGadgetManager::setGadgetsActive(bool active)
+{
+    if (m_gadgetsActive == active)
+        return;
+
+    m_gadgetsActive = active;
+    foreach (IUAVGadget *gadget, m_splitterOrView->gadgets())
+        gadget->setActive(active);
+}
+
 void UAVGadgetManager::split(Qt::Orientation orientation)
 {
     if (m_core->modeManager()->currentMode() != this)
@@ -35,8 +35,10 @@
 
 #include <QWidget>
 #include <QtCore/QList>
+#include <QtCore/QPair>
 #include <QtCore/QPointer>
 #include <QtCore/QSettings>
+#include <QtCore/QVariant>
 #include <QIcon>
 
 QT_BEGIN_NAMESPACE
@@ -112,6 +114,8 @@ private:
     void removeGadget(IUAVGadget *gadget);
     void closeView(Core::Internal::UAVGadgetView *view);
     void emptyView(Core::Internal::UAVGadgetView *view);
+    void restorePendingState();
+    void setGadgetsActive(bool active);
     Core::Internal::SplitterOrView *currentSplitterOrView() const;
 
     bool m_showToolbars;
@@ -127,6 +131,11 @@ private:
     const char *m_uniqueModeName;
     QWidget *m_widget;
 
+    // Workspace as read, until the mode is first shown and its gadgets are created
+    QList<QPair<QString, QVariant>> m_pendingState;
+    bool m_statePending;
+    bool m_gadgetsActive;
+
     friend class Core::Internal::SplitterOrView;
     friend class Core::Internal::UAVGadgetView;
 };
@@ -8,17 +8,21 @@ include(../../gcsplugin.pri)
 include(../../libs/extensionsystem/extensionsystem.pri)
 
 include(../../plugins/coreplugin/coreplugin.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+include(../../plugins/uavtalk/uavtalk.pri)
 
 HEADERS += debugplugin.h \
     debugengine.h
 HEADERS += debuggadget.h
 HEADERS += debuggadgetwidget.h
 HEADERS += debuggadgetfactory.h
+HEADERS += perfcounters.h
 SOURCES += debugplugin.cpp \
     debugengine.cpp
 SOURCES += debuggadget.cpp
 SOURCES += debuggadgetfactory.cpp
 SOURCES += debuggadgetwidget.cpp
+SOURCES += perfcounters.cpp
 
 OTHER_FILES += DebugGadget.pluginspec
 
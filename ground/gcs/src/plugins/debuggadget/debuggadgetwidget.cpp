@@ -38,6 +38,7 @@
 #include <QMessageBox>
 #include <QScrollBar>
 #include <QTime>
+#include <QTreeWidgetItem>
 
 DebugGadgetWidget::DebugGadgetWidget(QWidget *parent)
     : QLabel(parent)
@@ -48,6 +49,17 @@ DebugGadgetWidget::DebugGadgetWidget(QWidget *parent)
     connect(de, &DebugEngine::message, this, &DebugGadgetWidget::message, Qt::QueuedConnection);
     connect(m_config->saveToFile, &QAbstractButton::clicked, this, &DebugGadgetWidget::saveLog);
     connect(m_config->clearLog, &QAbstractButton::clicked, this, &DebugGadgetWidget::clearLog);
+
+    linkItem = new QTreeWidgetItem(m_config->perfTree, QStringList(tr("Telemetry link")));
+    loopItem = new QTreeWidgetItem(m_config->perfTree, QStringList(tr("Event loop")));
+    objectsItem = new QTreeWidgetItem(m_config->perfTree, QStringList(tr("Objects received")));
+    m_config->perfTree->expandAll();
+
+    // Counters are only sampled while they are shown
+    perfCounters = new PerfCounters(this);
+    connect(perfCounters, &PerfCounters::sampled, this, &DebugGadgetWidget::showCounters);
+    connect(m_config->tabWidget, &QTabWidget::currentChanged, this,
+            &DebugGadgetWidget::updateSampling);
 }
 
 DebugGadgetWidget::~DebugGadgetWidget()
@@ -55,6 +67,56 @@ DebugGadgetWidget::~DebugGadgetWidget()
     // Do nothing
 }
 
+void DebugGadgetWidget::showEvent(QShowEvent *event)
+{
+    QLabel::showEvent(event);
+    updateSampling();
+}
+
+void DebugGadgetWidget::hideEvent(QHideEvent *event)
+{
+    QLabel::hideEvent(event);
+    updateSampling();
+}
+
+void DebugGadgetWidget::updateSampling()
+{
+    if (isVisible() && m_config->tabWidget->currentWidget() == m_config->performanceTab)
+        perfCounters->start();
+    else
+        perfCounters->stop();
+}
+
+void DebugGadgetWidget::showCounters()
+{
+    fillCounters(linkItem, perfCounters->linkCounters());
+
+    QVector<PerfCounters::Counter> loop;
+    loop.append({ tr("Average latency (ms)"), perfCounters->averageLatency() });
+    loop.append({ tr("Maximum latency (ms)"), perfCounters->maximumLatency() });
+    fillCounters(loopItem, loop);
+
+    fillCounters(objectsItem, perfCounters->objectCounters());
+}
+
+/**
+ * @brief Show counters below an item, reusing its rows
+ */
+void DebugGadgetWidget::fillCounters(QTreeWidgetItem *parent,
+                                     const QVector<PerfCounters::Counter> &counters)
+{
+    while (parent->childCount() > counters.size())
+        delete parent->takeChild(parent->childCount() - 1);
+    while (parent->childCount() < counters.size())
+        new QTreeWidgetItem(parent);
+
+    for (int i = 0; i < counters.size(); i++) {
+        QTreeWidgetItem *item = parent->child(i);
+        item->setText(0, counters.at(i).name);
+        item->setText(1, QString::number(counters.at(i).perSecond, 'f', 1));
+    }
+}
+
 void DebugGadgetWidget::saveLog()
 {
     QString fileName = QFileDialog::getSaveFileName(
@@ -31,6 +31,10 @@
 #include <QLabel>
 #include "ui_debug.h"
 #include "debugengine.h"
+#include "perfcounters.h"
+
+class QTreeWidgetItem;
+
 class DebugGadgetWidget : public QLabel
 {
     Q_OBJECT
@@ -39,13 +43,25 @@ public:
     DebugGadgetWidget(QWidget *parent = 0);
     ~DebugGadgetWidget();
 
+protected:
+    void showEvent(QShowEvent *event);
+    void hideEvent(QHideEvent *event);
+
 private:
     Ui_Form *m_config;
+    PerfCounters *perfCounters;
+    QTreeWidgetItem *linkItem;
+    QTreeWidgetItem *loopItem;
+    QTreeWidgetItem *objectsItem;
+
+    void fillCounters(QTreeWidgetItem *parent, const QVector<PerfCounters::Counter> &counters);
 private slots:
     void saveLog();
     void clearLog();
     void message(DebugEngine::Level level, const QString &msg, const QString &file, const int line,
                  const QString &function);
+    void updateSampling();
+    void showCounters();
 };
 #endif /* DEBUGGADGETWIDGET_H_ */
 
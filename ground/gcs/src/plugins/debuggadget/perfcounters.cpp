@@ -0,0 +1,181 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfcounters.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup DebugGadgetPlugin Debug Gadget Plugin
+ * @{
+ * @brief Samples telemetry and event loop counters for the debug gadget
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "perfcounters.h"
+#include "uavobjects/uavobjectmanager.h"
+#include "uavtalk/telemetrymanager.h"
+#include <extensionsystem/pluginmanager.h>
+
+#include <QTimer>
+#include <algorithm>
+
+PerfCounters::PerfCounters(QObject *parent)
+    : QObject(parent)
+    , latencySum(0)
+    , latencyMax(0)
+    , latencyProbes(0)
+    , latencyAverage(0)
+    , latencyMaximum(0)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    objManager = pm->getObject<UAVObjectManager>();
+
+    // The telemetry manager may come after us
+    objectAdded(pm->getObject<TelemetryManager>());
+    connect(pm, &ExtensionSystem::PluginManager::objectAdded, this, &PerfCounters::objectAdded);
+
+    sampleTimer = new QTimer(this);
+    sampleTimer->setInterval(SAMPLE_PERIOD_MS);
+    connect(sampleTimer, &QTimer::timeout, this, &PerfCounters::sample);
+
+    probeTimer = new QTimer(this);
+    probeTimer->setTimerType(Qt::PreciseTimer);
+    probeTimer->setInterval(PROBE_PERIOD_MS);
+    connect(probeTimer, &QTimer::timeout, this, &PerfCounters::probeLatency);
+}
+
+void PerfCounters::start()
+{
+    if (sampleTimer->isActive())
+        return;
+
+    // Only what is received from now on counts
+    unpackCounts.clear();
+    if (objManager) {
+        foreach (const QVector<UAVDataObject *> &instances, objManager->getDataObjectsVector()) {
+            foreach (UAVDataObject *obj, instances)
+                unpackCounts.insert(obj, obj->getUnpackCount());
+        }
+    }
+
+    latencySum = 0;
+    latencyMax = 0;
+    latencyProbes = 0;
+
+    sampleClock.start();
+    probeClock.start();
+    sampleTimer->start();
+    probeTimer->start();
+}
+
+void PerfCounters::stop()
+{
+    sampleTimer->stop();
+    probeTimer->stop();
+}
+
+void PerfCounters::objectAdded(QObject *obj)
+{
+    TelemetryManager *telMngr = qobject_cast<TelemetryManager *>(obj);
+    if (!telMngr || telemetryManager)
+        return;
+
+    telemetryManager = telMngr;
+    connect(telMngr, &TelemetryManager::telemetryStatsUpdated, this,
+            &PerfCounters::telemetryStatsUpdated);
+}
+
+/**
+ * @brief Keep the stats of a period as rates, they are taken (and reset) by
+ * the telemetry monitor, which is why they aren't sampled here
+ */
+void PerfCounters::telemetryStatsUpdated(const Telemetry::TelemetryStats &stats, int periodMs)
+{
+    if (!sampleTimer->isActive() || periodMs <= 0)
+        return;
+
+    double scale = 1000.0 / periodMs;
+
+    link.clear();
+    link.append({ tr("Bytes received"), stats.rxBytes * scale });
+    link.append({ tr("Bytes sent"), stats.txBytes * scale });
+    link.append({ tr("Objects received"), stats.rxObjects * scale });
+    link.append({ tr("Objects sent"), stats.txObjects * scale });
+    link.append({ tr("Receive errors"), stats.rxErrors * scale });
+    link.append({ tr("Send errors"), stats.txErrors * scale });
+    link.append({ tr("Send retries"), stats.txRetries * scale });
+    link.append({ tr("Datagrams lost"), stats.rxLost * scale });
+}
+
+/**
+ * @brief The probe timer is due every period, anything beyond that was spent
+ * by the event loop on other work
+ */
+void PerfCounters::probeLatency()
+{
+    qint64 late = probeClock.restart() - PROBE_PERIOD_MS;
+    if (late < 0)
+        late = 0;
+
+    latencySum += late;
+    latencyMax = qMax(latencyMax, late);
+    latencyProbes++;
+}
+
+void PerfCounters::sample()
+{
+    double scale = 1000.0 / qMax<qint64>(sampleClock.restart(), 1);
+
+    // Instances add up to their object
+    QHash<QString, double> rates;
+    if (objManager) {
+        foreach (const QVector<UAVDataObject *> &instances, objManager->getDataObjectsVector()) {
+            foreach (UAVDataObject *obj, instances) {
+                quint32 count = obj->getUnpackCount();
+                quint32 &last = unpackCounts[obj];
+                if (count != last) {
+                    rates[obj->getName()] += (count - last) * scale;
+                    last = count;
+                }
+            }
+        }
+    }
+
+    objects.clear();
+    objects.reserve(rates.size());
+    for (auto it = rates.constBegin(); it != rates.constEnd(); ++it)
+        objects.append({ it.key(), it.value() });
+    std::sort(objects.begin(), objects.end(), [](const Counter &a, const Counter &b) {
+        return a.perSecond > b.perSecond;
+    });
+
+    latencyAverage = latencyProbes ? (double)latencySum / latencyProbes : 0;
+    latencyMaximum = latencyMax;
+    latencySum = 0;
+    latencyMax = 0;
+    latencyProbes = 0;
+
+    emit sampled();
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ *
+ * @file       perfcounters.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup DebugGadgetPlugin Debug Gadget Plugin
+ * @{
+ * @brief Samples telemetry and event loop counters for the debug gadget
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+#include "uavtalk/telemetry.h"
+
+class QTimer;
+class TelemetryManager;
+class UAVObject;
+class UAVObjectManager;
+
+/**
+ * @brief Samples counters showing where the GCS spends its time during a
+ * session, once per second while running.
+ *
+ * Nothing is hooked into the paths being measured. Link counters come with
+ * the stats the telemetry monitor takes each stats period, object rates from
+ * the unpack count each object keeps, and the event loop latency from how
+ * late a short timer fires.
+ */
+class PerfCounters : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Counter
+    {
+        QString name;
+        double perSecond;
+    };
+
+    explicit PerfCounters(QObject *parent = 0);
+
+    void start();
+    void stop();
+
+    //! Link counters of the last stats period
+    const QVector<Counter> &linkCounters() const { return link; }
+    //! Objects received during the last second, busiest first
+    const QVector<Counter> &objectCounters() const { return objects; }
+    //! Event loop latency over the last second, in ms
+    double averageLatency() const { return latencyAverage; }
+    double maximumLatency() const { return latencyMaximum; }
+
+signals:
+    void sampled();
+
+private slots:
+    void objectAdded(QObject *obj);
+    void telemetryStatsUpdated(const Telemetry::TelemetryStats &stats, int periodMs);
+    void probeLatency();
+    void sample();
+
+private:
+    static const int SAMPLE_PERIOD_MS = 1000;
+    static const int PROBE_PERIOD_MS = 20;
+
+    UAVObjectManager *objManager;
+    QPointer<TelemetryManager> telemetryManager;
+    QTimer *sampleTimer;
+    QTimer *probeTimer;
+    QElapsedTimer sampleClock;
+    QElapsedTimer probeClock;
+
+    QVector<Counter> link;
+    QVector<Counter> objects;
+    QHash<UAVObject *, quint32> unpackCounts;
+
+    qint64 latencySum;
+    qint64 latencyMax;
+    int latencyProbes;
+    double latencyAverage;
+    double latencyMaximum;
+};
+
+#endif // PERFCOUNTERS_H
+
+/**
+ * @}
+ * @}
+ */
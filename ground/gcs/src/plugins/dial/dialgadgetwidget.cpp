@@ -41,7 +41,8 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent)
     setMinimumSize(64, 64);
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
     setScene(new QGraphicsScene(this));
-    setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing);
+    setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing
+                   | QPainter::SmoothPixmapTransform);
 
     m_renderer = new QSvgRenderer();
 
@@ -57,6 +58,9 @@ DialGadgetWidget::DialGadgetWidget(QWidget *parent)
     needle2Target = 0;
     needle3Target = 0;
 
+    // Nothing to show until a dial file is loaded
+    dialError = true;
+
     //	beSmooth = true;
     beSmooth = false;
 
@@ -331,6 +335,10 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
 
         l_scene->setSceneRect(m_background->boundingRect());
 
+        // The dial face doesn't change, render it once per size
+        m_background->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+        m_foreground->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
         // Now Initialize the center for all transforms of the dial needles to the
         // center of the background:
         // - Move the center of the needle to the center of the background.
@@ -409,6 +417,8 @@ void DialGadgetWidget::setDialFile(QString dfn, QString bg, QString fg, QString
         if (!dialTimer.isActive())
             dialTimer.start();
         dialError = false;
+
+        updateItemCaches();
     } else {
         qDebug() << "no file: display default background.";
         m_renderer->load(QString(":/dial/images/empty.svg"));
@@ -448,6 +458,33 @@ void DialGadgetWidget::resizeEvent(QResizeEvent *event)
 {
     Q_UNUSED(event);
     fitInView(m_background, Qt::KeepAspectRatio);
+    updateItemCaches();
+}
+
+/**
+ * @brief Keep the needles as pixmaps of the size they're shown at.
+ *
+ * Needles only ever move by their transform, so caching them in item
+ * coordinates lets them be blitted at their new angle or offset instead of
+ * rendering their SVG again on every update. The cache has to follow the
+ * scale of the view to stay sharp.
+ */
+void DialGadgetWidget::updateItemCaches()
+{
+    if (dialError)
+        return;
+
+    const qreal scale = transform().m11();
+    QGraphicsSvgItem *needles[] = { m_needle1, n2enabled ? m_needle2 : NULL,
+                                    n3enabled ? m_needle3 : NULL };
+
+    for (QGraphicsSvgItem *needle : needles) {
+        if (!needle)
+            continue;
+
+        QSize size = (needle->boundingRect().size() * scale).toSize().expandedTo(QSize(1, 1));
+        needle->setCacheMode(QGraphicsItem::ItemCoordinateCache, size);
+    }
 }
 
 void DialGadgetWidget::setDialFont(QString fontProps)
@@ -82,6 +82,8 @@ private slots:
     void rotateNeedles();
 
 private:
+    void updateItemCaches();
+
     QSvgRenderer *m_renderer;
     QGraphicsSvgItem *m_background;
     QGraphicsSvgItem *m_foreground;
@@ -39,11 +39,16 @@ bool GCSControl::firstInstance = true;
 
 GCSControl::GCSControl()
     : hasControl(false)
+    , sendPending(false)
+    , latencySumUs(0)
+    , latencyMaxUs(0)
+    , latencyCount(0)
 {
     Q_ASSERT(firstInstance); // There should only be one instance of this class
     firstInstance = false;
-    receiverActivity.setInterval(100);
-    connect(&receiverActivity, &QTimer::timeout, this, &GCSControl::receiverActivitySlot);
+    sendTimer.setSingleShot(true);
+    sendTimer.setTimerType(Qt::PreciseTimer);
+    connect(&sendTimer, &QTimer::timeout, this, &GCSControl::sendChannels);
 }
 
 void GCSControl::extensionsInitialized()
@@ -143,9 +148,12 @@ bool GCSControl::beginGCSControl()
     manControlSettingsUAVO->updated();
     connect(manControlSettingsUAVO, &UAVObject::objectUpdated, this, &GCSControl::objectsUpdated);
     hasControl = true;
+    lastSend.start();
+    latencyReport.start();
     for (quint8 x = 0; x < GCSReceiver::CHANNEL_NUMELEM; ++x)
         setChannel(x, 0);
-    receiverActivity.start();
+    // Also starts the keepalive, should the channels be centered already
+    queueSend();
     return true;
 }
 
@@ -162,7 +170,9 @@ bool GCSControl::endGCSControl()
     manControlSettingsUAVO->setMetadata(metaBackup);
     manControlSettingsUAVO->updated();
     hasControl = false;
-    receiverActivity.stop();
+    sendTimer.stop();
+    sendPending = false;
+    reportLatency();
     return true;
 }
 
@@ -173,7 +183,7 @@ bool GCSControl::setFlightMode(ManualControlSettings::FlightModePositionOptions
     manControlSettingsUAVO->setFlightModePosition(0, flightMode);
     manControlSettingsUAVO->updated();
     m_gcsReceiver->setChannel(ManualControlSettings::CHANNELGROUPS_FLIGHTMODE, CHANNEL_MIN);
-    m_gcsReceiver->updated();
+    queueSend();
     return true;
 }
 
@@ -206,19 +216,81 @@ bool GCSControl::setChannel(quint8 channel, float value)
         pwmValue = (value * (float)(CHANNEL_MAX - CHANNEL_NEUTRAL)) + (float)CHANNEL_NEUTRAL;
     else
         pwmValue = (value * (float)(CHANNEL_NEUTRAL - CHANNEL_MIN)) + (float)CHANNEL_NEUTRAL;
-    m_gcsReceiver->setChannel(channel, pwmValue);
-    m_gcsReceiver->updated();
+    if (m_gcsReceiver->getChannel(channel) != pwmValue) {
+        m_gcsReceiver->setChannel(channel, pwmValue);
+        queueSend();
+    }
     return true;
 }
 
+/**
+ * @brief GCSControl::queueSend Send the receiver as soon as allowed
+ *
+ * Sending only happens from the timer, so the channels set together, e.g.
+ * all sticks of a joystick sample, go out together in one update. The
+ * update is sent directly by telemetry when the timer fires, no later than
+ * MIN_SEND_PERIOD_MS after the last one.
+ */
+void GCSControl::queueSend()
+{
+    if (sendPending)
+        return;
+
+    sendPending = true;
+    pendingSince.start();
+
+    int due = qMax(0, MIN_SEND_PERIOD_MS - (int)lastSend.elapsed());
+    if (!sendTimer.isActive() || sendTimer.remainingTime() > due)
+        sendTimer.start(due);
+}
+
 void GCSControl::objectsUpdated(UAVObject *obj)
 {
     qDebug() << "GCSControl::objectsUpdated"
              << "Object" << obj->getName() << "changed outside this class";
 }
 
-void GCSControl::receiverActivitySlot()
+/**
+ * @brief GCSControl::sendChannels Send the receiver with the latest channels,
+ * either because they changed or to keep the link alive
+ */
+void GCSControl::sendChannels()
 {
-    if (m_gcsReceiver)
-        m_gcsReceiver->updated();
+    if (!hasControl || !m_gcsReceiver)
+        return;
+
+    m_gcsReceiver->updated();
+    lastSend.restart();
+
+    if (sendPending) {
+        sendPending = false;
+
+        qint64 latencyUs = pendingSince.nsecsElapsed() / 1000;
+        latencySumUs += latencyUs;
+        latencyMaxUs = qMax(latencyMaxUs, latencyUs);
+        latencyCount++;
+
+        if (latencyReport.elapsed() >= LATENCY_REPORT_PERIOD_MS)
+            reportLatency();
+    }
+
+    sendTimer.start(KEEPALIVE_PERIOD_MS);
+}
+
+/**
+ * @brief GCSControl::reportLatency Log how long channel changes waited to be
+ * sent since the last report
+ */
+void GCSControl::reportLatency()
+{
+    if (latencyCount > 0) {
+        qDebug() << "[GCSControl] Channel change to send latency over" << latencyCount
+                 << "updates: average" << (latencySumUs / latencyCount) / 1000.0 << "ms, max"
+                 << latencyMaxUs / 1000.0 << "ms";
+    }
+
+    latencySumUs = 0;
+    latencyMaxUs = 0;
+    latencyCount = 0;
+    latencyReport.restart();
 }
@@ -34,6 +34,7 @@
 #include "gcsreceiver.h"
 #include "extensionsystem/pluginmanager.h"
 #include "QTimer"
+#include <QElapsedTimer>
 #include "gcscontrolgadgetfactory.h"
 
 class GCSCONTROLSHARED_EXPORT GCSControl : public ExtensionSystem::IPlugin
@@ -61,18 +62,36 @@ public slots:
     bool setChannel(quint8 channel, float value);
 
 private:
+    // Fastest the receiver is sent at, and slowest, so the flight side knows
+    // the GCS is still there
+    static const int MIN_SEND_PERIOD_MS = 20;
+    static const int KEEPALIVE_PERIOD_MS = 100;
+    static const int LATENCY_REPORT_PERIOD_MS = 10000;
+
+    void queueSend();
+    void reportLatency();
+
     ManualControlSettings *manControlSettingsUAVO;
     GCSReceiver *m_gcsReceiver;
     static bool firstInstance;
     ManualControlSettings::DataFields dataBackup;
     ManualControlSettings::Metadata metaBackup;
     bool hasControl;
-    QTimer receiverActivity;
+    QTimer sendTimer;
+    QElapsedTimer lastSend;
+    QElapsedTimer pendingSince;
+    bool sendPending;
+
+    // Time from a channel change to the receiver going out
+    QElapsedTimer latencyReport;
+    qint64 latencySumUs;
+    qint64 latencyMaxUs;
+    int latencyCount;
 
     GCSControlGadgetFactory *mf;
 private slots:
     void objectsUpdated(UAVObject *);
-    void receiverActivitySlot();
+    void sendChannels();
 };
 
 #endif // GCSCONTROL_H
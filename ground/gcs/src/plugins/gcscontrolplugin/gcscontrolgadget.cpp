@@ -175,7 +175,8 @@ void GCSControlGadget::sticksChangedLocally(double leftX, double leftY, double r
 }
 
 //! Set the GCS Receiver object
-void GCSControlGadget::setGcsReceiver(double leftX, double leftY, double rightX, double rightY)
+void GCSControlGadget::setGcsReceiver(double leftX, double leftY, double rightX, double rightY,
+                                      bool showSticks)
 {
     GCSControl *ctr = getGcsControl();
     Q_ASSERT(ctr);
@@ -223,6 +224,9 @@ void GCSControlGadget::setGcsReceiver(double leftX, double leftY, double rightX,
     ctr->setPitch(newPitch);
     ctr->setYaw(newYaw);
 
+    if (!showSticks)
+        return;
+
     switch (controlsMode) {
     case 1:
         // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
@@ -467,27 +471,33 @@ void GCSControlGadget::axesValues(QListInt16 values)
         if (channelReverse[throttleChannel] == true)
             tValue = -tValue;
 
-    if (joystickTime.elapsed() > JOYSTICK_UPDATE_RATE) {
+    if (!enableSending)
+        return;
+
+    // Every sample goes to the receiver, which sends it as soon as the link
+    // allows. Only redrawing the sticks is held to the update rate.
+    bool showSticks = joystickTime.elapsed() > JOYSTICK_UPDATE_RATE;
+    if (showSticks)
         joystickTime.restart();
-        // Remap RPYT to left X/Y and right X/Y depending on mode
-        // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
-        // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
-        // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
-        // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
-        switch (controlsMode) {
-        case 1:
-            sticksChangedLocally(yValue / max, -pValue / max, rValue / max, -tValue / max);
-            break;
-        case 2:
-            sticksChangedLocally(yValue / max, -tValue / max, rValue / max, -pValue / max);
-            break;
-        case 3:
-            sticksChangedLocally(rValue / max, -pValue / max, yValue / max, -tValue / max);
-            break;
-        case 4:
-            sticksChangedLocally(rValue / max, -tValue / max, yValue / max, -pValue / max);
-            break;
-        }
+
+    // Remap RPYT to left X/Y and right X/Y depending on mode
+    // Mode 1: LeftX = Yaw, LeftY = Pitch, RightX = Roll, RightY = Throttle
+    // Mode 2: LeftX = Yaw, LeftY = THrottle, RightX = Roll, RightY = Pitch
+    // Mode 3: LeftX = Roll, LeftY = Pitch, RightX = Yaw, RightY = Throttle
+    // Mode 4: LeftX = Roll, LeftY = Throttle, RightX = Yaw, RightY = Pitch;
+    switch (controlsMode) {
+    case 1:
+        setGcsReceiver(yValue / max, -pValue / max, rValue / max, -tValue / max, showSticks);
+        break;
+    case 2:
+        setGcsReceiver(yValue / max, -tValue / max, rValue / max, -pValue / max, showSticks);
+        break;
+    case 3:
+        setGcsReceiver(rValue / max, -pValue / max, yValue / max, -tValue / max, showSticks);
+        break;
+    case 4:
+        setGcsReceiver(rValue / max, -tValue / max, yValue / max, -pValue / max, showSticks);
+        break;
     }
 }
 #endif
@@ -74,7 +74,8 @@ private:
     double constrain(double value);
 
     //! Set the GCS Receiver object
-    void setGcsReceiver(double leftX, double leftY, double rightX, double rightY);
+    void setGcsReceiver(double leftX, double leftY, double rightX, double rightY,
+                        bool showSticks = true);
 
     QTime joystickTime;
     GCSControlGadgetWidget *m_widget;
@@ -1,6 +1,6 @@
 TEMPLATE = lib
 TARGET = GpsDisplayGadget
-QT += svg serialport
+QT += svg
 
 include(../../gcsplugin.pri)
 
@@ -14,7 +14,6 @@ HEADERS += gpsconstellationwidget.h
 HEADERS += gpsparser.h
 HEADERS += telemetryparser.h
 HEADERS += gpssnrwidget.h
-HEADERS += buffer.h
 HEADERS += gpsdisplaygadget.h
 HEADERS += gpsdisplaywidget.h
 HEADERS += gpsdisplaygadgetfactory.h
@@ -24,7 +23,6 @@ SOURCES += gpsconstellationwidget.cpp
 SOURCES += gpsparser.cpp
 SOURCES += telemetryparser.cpp
 SOURCES += gpssnrwidget.cpp
-SOURCES += buffer.cpp
 SOURCES += gpsdisplaygadget.cpp
 SOURCES += gpsdisplaygadgetfactory.cpp
 SOURCES += gpsdisplaywidget.cpp
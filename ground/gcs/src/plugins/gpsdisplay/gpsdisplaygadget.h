@@ -27,8 +27,7 @@
 #ifndef GPSDISPLAYGADGET_H_
 #define GPSDISPLAYGADGET_H_
 
-#include <QtSerialPort/QSerialPort>
-#include <QtSerialPort/QSerialPortInfo>
+#include <QPointer>
 #include <coreplugin/iuavgadget.h>
 #include "gpsdisplaywidget.h"
 #include "telemetryparser.h"
@@ -53,7 +52,6 @@ private:
     QPointer<GpsDisplayWidget> m_widget;
     QPointer<GPSParser> parser;
     bool connected;
-    void processNewSerialData(QByteArray serialData);
 };
 
 #endif // GPSDISPLAYGADGET_H_
@@ -27,6 +27,9 @@
 #include "telemetryparser.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjects/uavobjectmanager.h"
+#include "gpsposition.h"
+#include "gpssatellites.h"
+#include "gpstime.h"
 #include <math.h>
 #include <QDebug>
 #include <QStringList>
@@ -39,23 +42,26 @@ TelemetryParser::TelemetryParser(QObject *parent)
 {
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVDataObject *gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSPosition"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateGPS(UAVObject *)));
+
+    GPSPosition *gpsPosition = GPSPosition::GetInstance(objManager);
+    if (gpsPosition != NULL) {
+        // Looked up once, the updates only index them
+        fixTypes = gpsPosition->getField("Status")->getOptions();
+        connect(gpsPosition, &UAVObject::objectUpdated, this, &TelemetryParser::updateGPS);
     } else {
         qDebug() << "Error: Object is unknown (GPSPosition).";
     }
 
-    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSTime"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateTime(UAVObject *)));
+    GPSTime *gpsTime = GPSTime::GetInstance(objManager);
+    if (gpsTime != NULL) {
+        connect(gpsTime, &UAVObject::objectUpdated, this, &TelemetryParser::updateTime);
     } else {
         qDebug() << "Error: Object is unknown (GPSTime).";
     }
 
-    gpsObj = dynamic_cast<UAVDataObject *>(objManager->getObject("GPSSatellites"));
-    if (gpsObj != NULL) {
-        connect(gpsObj, SIGNAL(objectUpdated(UAVObject *)), this, SLOT(updateSats(UAVObject *)));
+    GPSSatellites *gpsSatellites = GPSSatellites::GetInstance(objManager);
+    if (gpsSatellites != NULL) {
+        connect(gpsSatellites, &UAVObject::objectUpdated, this, &TelemetryParser::updateSats);
     }
 }
 
@@ -63,41 +69,34 @@ TelemetryParser::~TelemetryParser()
 {
 }
 
+/*
+ * The updates read the objects' data structures directly, rather than
+ * looking up each field by name and converting through QVariant.
+ */
+
 void TelemetryParser::updateGPS(UAVObject *object1)
 {
-    UAVObjectField *field = object1->getField(QString("Satellites"));
-    emit sv(field->getValue().toInt());
-
-    double lat = object1->getField(QString("Latitude"))->getDouble();
-    double lon = object1->getField(QString("Longitude"))->getDouble();
-    double alt = object1->getField(QString("Altitude"))->getDouble();
-    lat *= 1E-7;
-    lon *= 1E-7;
-    emit position(lat, lon, alt);
-
-    double hdg = object1->getField(QString("Heading"))->getDouble();
-    double spd = object1->getField(QString("Groundspeed"))->getDouble();
-    emit speedheading(spd, hdg);
-
-    QString fix = object1->getField(QString("Status"))->getValue().toString();
-    emit fixtype(fix);
-
-    double hdop = object1->getField(QString("HDOP"))->getDouble();
-    double vdop = object1->getField(QString("VDOP"))->getDouble();
-    double pdop = object1->getField(QString("PDOP"))->getDouble();
-    emit dop(hdop, vdop, pdop);
+    GPSPosition::DataFields gps = static_cast<GPSPosition *>(object1)->getData();
+
+    emit sv(gps.Satellites);
+
+    double lat = gps.Latitude * 1E-7;
+    double lon = gps.Longitude * 1E-7;
+    emit position(lat, lon, gps.Altitude);
+
+    emit speedheading(gps.Groundspeed, gps.Heading);
+
+    emit fixtype(fixTypes.value(gps.Status));
+
+    emit dop(gps.HDOP, gps.VDOP, gps.PDOP);
 }
 
 void TelemetryParser::updateTime(UAVObject *object1)
 {
-    double hour = object1->getField(QString("Hour"))->getDouble();
-    double minute = object1->getField(QString("Minute"))->getDouble();
-    double second = object1->getField(QString("Second"))->getDouble();
-    double time = second + minute * 100 + hour * 10000;
-    double year = object1->getField(QString("Year"))->getDouble();
-    double month = object1->getField(QString("Month"))->getDouble();
-    double day = object1->getField(QString("Day"))->getDouble();
-    double date = day + month * 100 + year * 10000;
+    GPSTime::DataFields gpsTime = static_cast<GPSTime *>(object1)->getData();
+
+    double time = gpsTime.Second + gpsTime.Minute * 100 + gpsTime.Hour * 10000;
+    double date = gpsTime.Day + gpsTime.Month * 100 + gpsTime.Year * 10000;
     emit datetime(date, time);
 }
 
@@ -110,14 +109,10 @@ void TelemetryParser::updateTime(UAVObject *object1)
   */
 void TelemetryParser::updateSats(UAVObject *object1)
 {
-    UAVObjectField *prn = object1->getField(QString("PRN"));
-    UAVObjectField *elevation = object1->getField(QString("Elevation"));
-    UAVObjectField *azimuth = object1->getField(QString("Azimuth"));
-    UAVObjectField *snr = object1->getField(QString("SNR"));
-
-    for (unsigned int i = 0; i < prn->getNumElements(); i++) {
-        emit satellite(i, prn->getValue(i).toInt(), elevation->getValue(i).toInt(),
-                       azimuth->getValue(i).toInt(), snr->getValue(i).toInt());
+    GPSSatellites::DataFields sats = static_cast<GPSSatellites *>(object1)->getData();
+
+    for (quint32 i = 0; i < GPSSatellites::PRN_NUMELEM; i++) {
+        emit satellite(i, sats.PRN[i], sats.Elevation[i], sats.Azimuth[i], sats.SNR[i]);
     }
 
     emit satellitesDone();
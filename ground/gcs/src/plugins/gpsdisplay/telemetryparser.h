@@ -46,6 +46,10 @@ public slots:
     void updateGPS(UAVObject *object1);
     void updateTime(UAVObject *object1);
     void updateSats(UAVObject *object1);
+
+private:
+    //! Names of the GPSPosition fix types
+    QStringList fixTypes;
 };
 
 #endif // TELEMETRYPARSER_H
@@ -12,12 +12,14 @@ HEADERS += ipconnectionplugin.h \
     ipconnection_global.h \
     ipconnectionconfiguration.h \
     ipconnectionoptionspage.h \
-    ipdevice.h
+    ipdevice.h \
+    sequencedudpdevice.h
 
 SOURCES += ipconnectionplugin.cpp \
     ipconnectionconfiguration.cpp \
     ipconnectionoptionspage.cpp \
-    ipdevice.cpp
+    ipdevice.cpp \
+    sequencedudpdevice.cpp
 
 FORMS += ipconnectionoptionspage.ui
 
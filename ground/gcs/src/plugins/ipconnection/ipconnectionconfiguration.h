@@ -51,6 +51,7 @@ public:
     enum Protocol {
         ProtocolTcp,
         ProtocolUdp,
+        ProtocolUdpSequenced, //!< UDP with numbered datagrams, see SequencedUdpDevice
     };
 
     struct Host
@@ -109,6 +109,7 @@ QWidget *IPConnectionOptionsDelegate::createEditor(QWidget *parent,
         auto editor = new QComboBox(parent);
         editor->addItem("TCP", IPConnectionConfiguration::ProtocolTcp);
         editor->addItem("UDP", IPConnectionConfiguration::ProtocolUdp);
+        editor->addItem(tr("UDP (sequenced)"), IPConnectionConfiguration::ProtocolUdpSequenced);
         editor->setFrame(false);
         return editor;
     }
@@ -217,8 +218,16 @@ QVariant IPConnectionOptionsModel::data(const QModelIndex &index, int role) cons
 
     const IPConnectionConfiguration::Host host = m_hosts.at(index.row());
 
-    if (index.column() == IPConnectionOptionsPage::ColumnProtocol && role == Qt::DisplayRole)
-        return host.protocol == IPConnectionConfiguration::ProtocolTcp ? "TCP" : "UDP";
+    if (index.column() == IPConnectionOptionsPage::ColumnProtocol && role == Qt::DisplayRole) {
+        switch (host.protocol) {
+        case IPConnectionConfiguration::ProtocolTcp:
+            return "TCP";
+        case IPConnectionConfiguration::ProtocolUdp:
+            return "UDP";
+        case IPConnectionConfiguration::ProtocolUdpSequenced:
+            return tr("UDP (sequenced)");
+        }
+    }
 
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
         switch (index.column()) {
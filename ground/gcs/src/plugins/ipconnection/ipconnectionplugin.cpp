@@ -30,6 +30,7 @@
  */
 
 #include "ipconnectionplugin.h"
+#include "sequencedudpdevice.h"
 
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/icore.h>
@@ -48,6 +49,7 @@ IPConnection *connection = 0;
 IPConnection::IPConnection()
 {
     ipSocket = NULL;
+    seqDevice = NULL;
     // create all our objects
     m_config = new IPConnectionConfiguration("IP Network Telemetry", NULL, this);
     m_config->readConfig();
@@ -63,6 +65,10 @@ IPConnection::IPConnection()
 
 IPConnection::~IPConnection()
 { // clean up our resources...
+    if (seqDevice) {
+        seqDevice->close();
+        delete seqDevice;
+    }
     if (ipSocket) {
         ipSocket->close();
         delete (ipSocket);
@@ -89,11 +95,20 @@ QList<IDevice *> IPConnection::availableDevices()
         }
         if (!found) {
             auto dev = new IPDevice();
+            QString scheme;
+            switch (host.protocol) {
+            case IPConnectionConfiguration::ProtocolTcp:
+                scheme = "tcp";
+                break;
+            case IPConnectionConfiguration::ProtocolUdp:
+                scheme = "udp";
+                break;
+            case IPConnectionConfiguration::ProtocolUdpSequenced:
+                scheme = "udpseq";
+                break;
+            }
             QString name =
-                QString("%0://%1:%2")
-                    .arg(host.protocol == IPConnectionConfiguration::ProtocolTcp ? "tcp" : "udp")
-                    .arg(host.hostname)
-                    .arg(host.port);
+                QString("%0://%1:%2").arg(scheme).arg(host.hostname).arg(host.port);
             dev->setDisplayName(name);
             dev->setName(name);
             dev->setHost(host);
@@ -146,7 +161,13 @@ QIODevice *IPConnection::openDevice(Core::IDevice *device)
 
         // in blocking mode so we wait for the connection to succeed
         if (ipSocket->waitForConnected(timeout)) {
-            return ipSocket;
+            if (dev->host().protocol != IPConnectionConfiguration::ProtocolUdpSequenced)
+                return ipSocket;
+
+            // Frame the stream into numbered datagrams
+            seqDevice = new SequencedUdpDevice(static_cast<QUdpSocket *>(ipSocket), this);
+            seqDevice->open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+            return seqDevice;
         }
 
         // tell user what went wrong
@@ -164,6 +185,11 @@ QIODevice *IPConnection::openDevice(Core::IDevice *device)
 
 void IPConnection::closeDevice(const QString &)
 {
+    if (seqDevice) {
+        seqDevice->close();
+        delete seqDevice;
+        seqDevice = NULL;
+    }
     if (ipSocket) {
         ipSocket->close();
         delete ipSocket;
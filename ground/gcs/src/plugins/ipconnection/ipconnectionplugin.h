@@ -43,6 +43,7 @@
 class QAbstractSocket;
 class QTcpSocket;
 class QUdpSocket;
+class SequencedUdpDevice;
 
 class IConnection;
 /**
@@ -72,6 +73,7 @@ protected slots:
 private:
     void openDevice(QString HostName, int Port, bool UseTCP);
     QAbstractSocket *ipSocket;
+    SequencedUdpDevice *seqDevice;
     IPConnectionConfiguration *m_config;
     IPConnectionOptionsPage *m_optionspage;
     QList<Core::IDevice *> devices;
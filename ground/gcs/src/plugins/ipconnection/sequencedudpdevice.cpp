@@ -0,0 +1,185 @@
+/**
+ ******************************************************************************
+ *
+ * @file       sequencedudpdevice.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup IPConnPlugin IP Telemetry Plugin
+ * @{
+ * @brief UDP telemetry with numbered datagrams
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "sequencedudpdevice.h"
+
+#include <QTimer>
+#include <QtEndian>
+#include <QtNetwork/QUdpSocket>
+
+SequencedUdpDevice::SequencedUdpDevice(QUdpSocket *socket, QObject *parent)
+    : QIODevice(parent)
+    , socket(socket)
+    , txSeq(0)
+    , rxSynced(false)
+    , rxExpected(0)
+    , rxLost(0)
+    , rxReordered(0)
+{
+    // Fires once control gets back to the event loop, after the frames of
+    // the current burst have been written
+    txTimer = new QTimer(this);
+    txTimer->setSingleShot(true);
+    txTimer->setInterval(0);
+
+    connect(txTimer, &QTimer::timeout, this, &SequencedUdpDevice::sendDatagram);
+    connect(socket, &QUdpSocket::readyRead, this, &SequencedUdpDevice::receiveDatagrams);
+}
+
+qint64 SequencedUdpDevice::bytesAvailable() const
+{
+    return rxBuffer.size() + QIODevice::bytesAvailable();
+}
+
+qint64 SequencedUdpDevice::bytesToWrite() const
+{
+    return txPayload.size() + socket->bytesToWrite();
+}
+
+void SequencedUdpDevice::close()
+{
+    if (isOpen())
+        sendDatagram();
+
+    txTimer->stop();
+    rxBuffer.clear();
+    QIODevice::close();
+}
+
+qint64 SequencedUdpDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 len = qMin<qint64>(maxSize, rxBuffer.size());
+
+    memcpy(data, rxBuffer.constData(), len);
+    rxBuffer.remove(0, len);
+
+    return len;
+}
+
+qint64 SequencedUdpDevice::writeData(const char *data, qint64 maxSize)
+{
+    const int maxPayload = MAX_DATAGRAM_SIZE - HEADER_SIZE;
+    qint64 written = 0;
+
+    // Frames are never split unless a single write is too big for a datagram
+    while (written < maxSize) {
+        int len = qMin<qint64>(maxSize - written, maxPayload);
+
+        if (txPayload.size() + len > maxPayload)
+            sendDatagram();
+
+        txPayload.append(data + written, len);
+        written += len;
+    }
+
+    if (!txTimer->isActive())
+        txTimer->start();
+
+    return written;
+}
+
+/**
+ * @brief Send what has been written so far as one datagram
+ */
+void SequencedUdpDevice::sendDatagram()
+{
+    if (txPayload.isEmpty())
+        return;
+
+    QByteArray datagram(HEADER_SIZE, 0);
+    datagram[0] = HEADER_MAGIC;
+    datagram[1] = HEADER_VERSION;
+    qToLittleEndian<quint16>(txSeq++, reinterpret_cast<uchar *>(datagram.data() + 2));
+    datagram.append(txPayload);
+
+    int len = txPayload.size();
+    txPayload.clear();
+
+    // A full socket buffer drops the datagram, the peer will count it lost
+    socket->write(datagram);
+
+    emit bytesWritten(len);
+}
+
+void SequencedUdpDevice::receiveDatagrams()
+{
+    bool received = false;
+
+    while (socket->hasPendingDatagrams()) {
+        QByteArray datagram(qMax<qint64>(socket->pendingDatagramSize(), 0), 0);
+        qint64 len = socket->readDatagram(datagram.data(), datagram.size());
+
+        if (len <= HEADER_SIZE || (quint8)datagram[0] != HEADER_MAGIC
+            || (quint8)datagram[1] != HEADER_VERSION)
+            continue;
+
+        trackSequence(
+            qFromLittleEndian<quint16>(reinterpret_cast<const uchar *>(datagram.constData() + 2)));
+
+        // Late datagrams are passed on too, they may hold acks
+        rxBuffer.append(datagram.constData() + HEADER_SIZE, len - HEADER_SIZE);
+        received = true;
+    }
+
+    if (received && isOpen())
+        emit readyRead();
+}
+
+/**
+ * @brief Update the loss and reorder counts with the sequence number of a
+ * received datagram
+ */
+void SequencedUdpDevice::trackSequence(quint16 seq)
+{
+    if (!rxSynced) {
+        rxSynced = true;
+        rxExpected = seq + 1;
+        return;
+    }
+
+    qint16 gap = static_cast<qint16>(seq - rxExpected);
+
+    if (gap >= 0) {
+        rxLost.fetchAndAddOrdered(gap);
+        rxExpected = seq + 1;
+    } else if (gap >= -REORDER_WINDOW) {
+        // It was counted lost when the datagrams after it came in
+        rxReordered.fetchAndAddOrdered(1);
+        if (rxLost.loadAcquire() > 0)
+            rxLost.fetchAndAddOrdered(-1);
+    } else {
+        rxExpected = seq + 1;
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
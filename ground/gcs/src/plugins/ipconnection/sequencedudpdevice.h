@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ *
+ * @file       sequencedudpdevice.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup IPConnPlugin IP Telemetry Plugin
+ * @{
+ * @brief UDP telemetry with numbered datagrams
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef SEQUENCEDUDPDEVICE_H
+#define SEQUENCEDUDPDEVICE_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QIODevice>
+
+class QTimer;
+class QUdpSocket;
+
+/**
+ * @brief Carries the UAVTalk stream over a connected UDP socket, whole frames
+ * per datagram, so a lost datagram only loses the frames in it instead of
+ * stalling the link like TCP does.
+ *
+ * Each datagram starts with a header of a magic byte, a version byte and a
+ * little endian 16 bit sequence number, followed by one or more complete
+ * UAVTalk frames. Every write() is taken to be a frame (as UAVTalkIO does);
+ * the frames written in one pass of the event loop are batched into as few
+ * datagrams of at most MAX_DATAGRAM_SIZE bytes as possible.
+ *
+ * Gaps and late arrivals in the received sequence are counted, and exposed
+ * as the datagramsLost and datagramsReordered properties for the telemetry
+ * statistics.
+ */
+class SequencedUdpDevice : public QIODevice
+{
+    Q_OBJECT
+    Q_PROPERTY(quint32 datagramsLost READ datagramsLost)
+    Q_PROPERTY(quint32 datagramsReordered READ datagramsReordered)
+
+public:
+    static const quint8 HEADER_MAGIC = 0xA5;
+    static const quint8 HEADER_VERSION = 1;
+    static const int HEADER_SIZE = 4;
+    // Stays below the IPv6 minimum MTU less the IP and UDP headers
+    static const int MAX_DATAGRAM_SIZE = 1200;
+    // Datagrams further behind than this mean the peer restarted its count
+    static const int REORDER_WINDOW = 64;
+
+    SequencedUdpDevice(QUdpSocket *socket, QObject *parent = 0);
+
+    bool isSequential() const override { return true; }
+    qint64 bytesAvailable() const override;
+    qint64 bytesToWrite() const override;
+    void close() override;
+
+    //! Datagrams missing from the received sequence, since opening
+    quint32 datagramsLost() const { return rxLost.loadAcquire(); }
+    //! Datagrams received after a later one, since opening
+    quint32 datagramsReordered() const { return rxReordered.loadAcquire(); }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private slots:
+    void receiveDatagrams();
+    void sendDatagram();
+
+private:
+    void trackSequence(quint16 seq);
+
+    QUdpSocket *socket;
+    QTimer *txTimer;
+
+    QByteArray rxBuffer;
+    QByteArray txPayload;
+    quint16 txSeq;
+
+    bool rxSynced;
+    quint16 rxExpected;
+    QAtomicInt rxLost;
+    QAtomicInt rxReordered;
+};
+
+#endif // SEQUENCEDUDPDEVICE_H
+
+/**
+ * @}
+ * @}
+ */
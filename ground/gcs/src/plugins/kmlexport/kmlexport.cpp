@@ -24,6 +24,8 @@
  */
 
 #include <QDebug>
+#include <QFile>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QTextStream>
 #include <QtGlobal>
@@ -44,18 +46,36 @@ const double ColorMap_Jet[256][3] = COLORMAP_JET;
        // hardcoded
 #define numberOfWallAxes 5 // Number of wall axes to plot. This shouldn't be hardcoded
 #define wallAxesSeparation 20 // Wall axes separation height in [m]. This shouldn't be hardcoded
+#define trackChunkSize 256 // Number of track segments per region
+#define regionMinLodPixels 128 // Size on screen a region needs for its track to be drawn
+#define regionMargin 0.0002 // Margin around a region in [deg], so hovering still makes one
+#define defaultTrackTolerance 0.5 // Track simplification in [m]
+#define defaultOverviewTolerance 5 // Ground track and wall axes simplification in [m]
+
+static const QString arrowIconHref = "http://maps.google.com/mapfiles/kml/shapes/arrow.png";
+
+static double distanceNED(const double a[3], const double b[3])
+{
+    return sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1])
+                + (a[2] - b[2]) * (a[2] - b[2]));
+}
 
 KmlExport::KmlExport(QString inputLogFileName, QString outputKmlFileName)
-    : outputFileName(outputKmlFileName)
+    : trackTolerance(defaultTrackTolerance)
+    , overviewTolerance(defaultOverviewTolerance)
+    , outputFileName(outputKmlFileName)
+    , firstPoint(false)
+    , timeStamp(0)
+    , lastPlacemarkTime(0)
 {
-    logFile.setFileName(inputLogFileName);
+    logFileName = inputLogFileName;
 
     // Create new UAVObject manager and initialize it with all UAVObjects
     UAVObjectManager *kmlUAVObjectManager = new UAVObjectManager;
     UAVObjectsInitialize(kmlUAVObjectManager);
 
-    // Connect new UAVO manager to a UAVTalk instance
-    kmlTalk = new UAVTalk(&logFile, kmlUAVObjectManager);
+    // Decode the log straight into the new UAVO manager
+    logDecoder = new LogDecoder(kmlUAVObjectManager);
 
     // Get the UAVObjects
     airspeedActual = AirspeedActual::GetInstance(kmlUAVObjectManager);
@@ -76,35 +96,12 @@ KmlExport::KmlExport(QString inputLogFileName, QString outputKmlFileName)
             SLOT(homeLocationUpdated(UAVObject *)), Qt::DirectConnection);
     connect(gpsPosition, SIGNAL(objectUpdated(UAVObject *)), this,
             SLOT(gpsPositionUpdated(UAVObject *)), Qt::DirectConnection);
+}
 
-    // Get the factory singleton to create KML elements.
-    factory = KmlFactory::GetFactory();
-
-    // Create <Document>
-    document = factory->CreateDocument();
-
-    // Create folders
-    timestampFolder = factory->CreateFolder();
-    timestampFolder->set_name("Arrows");
-
-    trackFolder = factory->CreateFolder();
-    trackFolder->set_name("Track");
-
-    // Create custom styles. Add as document's first elements
-    StyleMapPtr styleCBS = createCustomBalloonStyle();
-    document->add_styleselector(styleCBS);
-
-    StylePtr styleGT = createGroundTrackStyle();
-    document->add_styleselector(styleGT);
-
-    StyleMapPtr wallAxesStyle = createWallAxesStyle();
-    document->add_styleselector(wallAxesStyle);
-
-    // Create an array of lines which will make the wall axes.
-    for (int i = 0; i < numberOfWallAxes; i++) {
-        CoordinatesPtr coordinates = factory->CreateCoordinates();
-        wallAxes.append(coordinates);
-    }
+void KmlExport::setSimplification(double trackTolerance, double overviewTolerance)
+{
+    this->trackTolerance = trackTolerance;
+    this->overviewTolerance = overviewTolerance;
 }
 
 /**
@@ -118,84 +115,44 @@ bool KmlExport::exportToKML()
         return false;
     }
 
-    // Parses logfile and generates KML document
-    ret = preparseLogFile();
-    if (!ret) {
-        qDebug() << "Logfile preparsing failed";
+    QString format = QFileInfo(outputFileName).suffix().toUpper();
+    if (!kml.open(outputFileName)) {
+        qDebug() << format << "write failed: " << outputFileName << kml.errorString();
+        QMessageBox::critical(new QWidget(), QString("%1 write failed").arg(format),
+                              QString("Failed to write %1 file.").arg(format));
         return false;
     }
 
-    // Call parser.
-    parseLogFile();
+    exportTime = QDateTime::currentDateTimeUtc();
+    writeStyles();
 
-    // Add track to <Document>
-    document->add_feature(trackFolder);
+    // The track is written while the logfile is parsed
+    kml.xml().writeStartElement("Folder");
+    kml.xml().writeTextElement("name", "Track");
+    ret = parseLogFile();
+    writeTrackChunk();
+    kml.xml().writeEndElement();
 
     // Add timespans to <Document>
-    document->add_feature(timestampFolder);
-
-    // Add ground track to <Document>
-    {
-        LineStringPtr linestring = factory->CreateLineString();
-        linestring->set_extrude(false); // Do not extrude to ground
-        linestring->set_altitudemode(kmldom::ALTITUDEMODE_CLAMPTOGROUND);
-        linestring->set_coordinates(wallAxes[0]);
-
-        MultiGeometryPtr multiGeometry = factory->CreateMultiGeometry();
-        multiGeometry->add_geometry(linestring);
-
-        PlacemarkPtr placemark = factory->CreatePlacemark();
-        placemark->set_geometry(multiGeometry);
-        placemark->set_styleurl("#ts_2_tb");
-        placemark->set_name("Ground track");
-
-        document->add_feature(placemark);
-    }
-
-    // Add wall axes to <Document>
-    FolderPtr folder = factory->CreateFolder();
-    for (int i = 0; i < numberOfWallAxes; i++) {
-        LineStringPtr linestring = factory->CreateLineString();
-        linestring->set_extrude(false); // Do not extrude to ground
-        linestring->set_altitudemode(kmldom::ALTITUDEMODE_ABSOLUTE);
-        linestring->set_coordinates(wallAxes[i]);
-
-        MultiGeometryPtr multiGeometry = factory->CreateMultiGeometry();
-        multiGeometry->add_geometry(linestring);
-
-        PlacemarkPtr placemark = factory->CreatePlacemark();
-        placemark->set_geometry(multiGeometry);
-        placemark->set_styleurl("#ts_1_tb");
-
-        folder->add_feature(placemark);
-        folder->set_name("Wall axes");
+    kml.xml().writeStartElement("Folder");
+    kml.xml().writeTextElement("name", "Arrows");
+    foreach (const TimespanArrow &arrow, timespanArrows)
+        writeTimespanPlacemark(arrow);
+    kml.xml().writeEndElement();
+
+    // Add ground track and wall axes to <Document>
+    writeOverview();
+
+    if (!kml.close()) {
+        qDebug() << format << "write failed: " << outputFileName << kml.errorString();
+        QMessageBox::critical(new QWidget(), QString("%1 write failed").arg(format),
+                              QString("Failed to write %1 file.").arg(format));
+        return false;
     }
-    document->add_feature(folder);
-
-    // Create <kml> and give it <Document>.
-    KmlPtr kml = factory->CreateKml();
-    kml->set_feature(document); // kml takes ownership.
-
-    // Serialize to XML
-    std::string kml_data = kmldom::SerializePretty(kml);
 
-    // Save to file
-    if (QFileInfo(outputFileName).suffix().toLower() == "kmz") {
-        if (!kmlengine::KmzFile::WriteKmz(outputFileName.toStdString().c_str(), kml_data)) {
-            qDebug() << "KMZ write failed: " << outputFileName;
-            QMessageBox::critical(new QWidget(), "KMZ write failed", "Failed to write KMZ file.");
-            return false;
-        }
-    } else if (QFileInfo(outputFileName).suffix().toLower() == "kml") {
-        if (!kmlbase::File::WriteStringToFile(kml_data, outputFileName.toStdString())) {
-            qDebug() << "KML write failed: " << outputFileName;
-            QMessageBox::critical(new QWidget(), "KML write failed", "Failed to write KML file.");
-            return false;
-        }
-    } else {
-        qDebug() << "Write failed. Invalid file name:" << outputFileName;
-        QMessageBox::critical(new QWidget(), "Write failed",
-                              "Failed to write file. Invalid filename");
+    if (!ret) {
+        qDebug() << "Logfile parsing failed";
+        QFile::remove(outputFileName);
         return false;
     }
 
@@ -208,24 +165,13 @@ bool KmlExport::exportToKML()
  */
 bool KmlExport::open()
 {
-    if (logFile.isOpen()) {
-        logFile.close();
-    }
-
-    // Open log file as  ReadOnly
-    if (logFile.open(QIODevice::ReadOnly) == false) {
-        qDebug() << "Unable to open " << logFile.fileName() << " for logging";
+    if (logDecoder->open(logFileName) == false) {
+        qDebug() << "Unable to open " << logFileName << ":" << logDecoder->errorString();
         return false;
     }
 
-    logFile.readLine(); // Read first line of log file. This assumes that the logfile is of the new
-                        // format.
-    QString logGitHashString = logFile.readLine().trimmed(); // Read second line of log file. This
-                                                             // assumes that the logfile is of the
-                                                             // new format.
-    QString logUAVOHashString = logFile.readLine().trimmed(); // Read third line of log file. This
-                                                              // assumes that the logfile is of the
-                                                              // new format.
+    QString logGitHashString = logDecoder->gitHash();
+    QString logUAVOHashString = logDecoder->uavoHash();
     QString gitHash = QString::fromLatin1(Core::Constants::GCS_REVISION_STR);
     QString uavoHash =
         QString::fromLatin1(Core::Constants::UAVOSHA1_STR)
@@ -234,7 +180,14 @@ bool KmlExport::open()
             .replace(",", "")
             .replace("0x", ""); // See comment above for necessity for string replacements
 
-    if (logUAVOHashString != uavoHash) {
+    if (!logDecoder->hasHeader()) {
+        QMessageBox msgBox;
+        msgBox.setText("Corrupted file.");
+        msgBox.setInformativeText("GCS cannot find the separation byte. GCS will attempt to export "
+                                  "the file."); //<--TODO: add hyperlink to webpage with better
+                                                //description.
+        msgBox.exec();
+    } else if (logUAVOHashString != uavoHash) {
         QMessageBox msgBox;
         msgBox.setText("Likely log file incompatibility.");
         msgBox.setInformativeText(QString("The log file was made with branch %1, UAVO hash %2. GCS "
@@ -251,555 +204,369 @@ bool KmlExport::open()
         msgBox.exec();
     }
 
-    QString tmpLine = logFile.readLine(); // Look for the header/body separation string.
-    int cnt = 0;
-    while (tmpLine != "##\n" && cnt < 10 && !logFile.atEnd()) {
-        tmpLine = logFile.readLine().trimmed();
-        cnt++;
-    }
-
-    // Check if we reached the end of the file before finding the separation string
-    if (cnt >= 10 || logFile.atEnd()) {
-        QMessageBox msgBox;
-        msgBox.setText("Corrupted file.");
-        msgBox.setInformativeText("GCS cannot find the separation byte. GCS will attempt to export "
-                                  "the file."); //<--TODO: add hyperlink to webpage with better
-                                                //description.
-        msgBox.exec();
-
-        // Since we could not find the file separator, we need to return to the beginning of the
-        // file
-        logFile.seek(0);
-    }
-
     return true;
 }
 
 /**
- * @brief KmlExport::preparseLogFile Ensures that the logfile has data to export
- * @return Returns true if the logfile has data, false otherwise
+ * @brief KmlExport::stopExport Called to stop the export. Currently only closes
+ * the logfile
+ * @return Returns true
  */
-bool KmlExport::preparseLogFile()
+bool KmlExport::stopExport()
 {
-    // Read all log timestamps into array
-    timestampBuffer.clear(); // Save beginning of log for later use
-    timestampPos.clear();
-    quint64 logFileStartIdx = logFile.pos();
-    quint32 lastTimeStamp = 0;
-
-    while (!logFile.atEnd()) {
-        qint64 dataSize;
-
-        // Get time stamp position
-        timestampPos.append(logFile.pos());
-
-        // Read timestamp and logfile packet size
-        logFile.read((char *)&lastTimeStamp, sizeof(lastTimeStamp));
-        logFile.read((char *)&dataSize, sizeof(dataSize));
-
-        // Check if dataSize sync bytes are correct.
-        // TODO: LIKELY AS NOT, THIS WILL FAIL TO RESYNC BECAUSE THERE IS TOO LITTLE INFORMATION IN
-        // THE STRING OF SIX 0x00
-        if ((dataSize & 0xFFFFFFFFFFFF0000) != 0) {
-            qDebug() << "Wrong sync byte. At file location 0x"
-                     << QString("%1").arg(logFile.pos(), 0, 16) << "Got 0x"
-                     << QString("%1").arg(dataSize & 0xFFFFFFFFFFFF0000, 0, 16)
-                     << ", but expected 0x"
-                        "00"
-                        ".";
-            logFile.seek(timestampPos.last() + 1);
-            timestampPos.pop_back();
-            continue;
-        }
-
-        // Check if timestamps are sequential.
-        if (!timestampBuffer.isEmpty() && lastTimeStamp < timestampBuffer.last()) {
-            QMessageBox msgBox;
-            msgBox.setText("Corrupted file.");
-            msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected "
-                                      "behavior"); //<--TODO: add hyperlink to webpage with better
-                                                   //description.
-            msgBox.exec();
-
-            qDebug() << "Timestamp: " << timestampBuffer.last() << " " << lastTimeStamp;
-        }
-
-        timestampBuffer.append(lastTimeStamp);
+    return true;
+}
 
-        logFile.seek(timestampPos.last() + sizeof(lastTimeStamp) + sizeof(dataSize) + dataSize);
+/**
+ * @brief KmlExport::parseLogFile Decodes the whole logfile as fast as possible. The
+ * decoder updates the UAVObjects, which emit objectUpdated(UAVObject *) signals. These
+ * signals are connected to in the KmlExport constructor.
+ * @return Returns false if the logfile has no data to export
+ */
+bool KmlExport::parseLogFile()
+{
+    quint32 records = logDecoder->decodeAll([this](quint32 timestamp) {
+        timeStamp = timestamp;
+        return true;
+    });
+
+    if (!logDecoder->errorString().isEmpty()) {
+        qDebug() << "Error: Logfile corrupted!" << logDecoder->errorString();
+        QMessageBox::critical(
+            new QWidget(), "Corrupted file",
+            "Incorrect packet size. Stopping export. Data up to this point will be saved.");
     }
 
-    // Check if any timestamps were successfully read
-    if (timestampBuffer.size() == 0) {
+    stopExport();
+
+    // Check if any records were successfully read
+    if (records == 0) {
         QMessageBox msgBox;
         msgBox.setText("Empty logfile.");
         msgBox.setInformativeText("No log data can be found.");
         msgBox.exec();
 
-        stopExport();
         return false;
     }
 
-    // Reset to log beginning, including the timestamp.
-    logFile.seek(logFileStartIdx);
-
     return true;
 }
 
 /**
- * @brief KmlExport::stopExport Called to stop the export. Currently only closes
- * the logfile
- * @return Returns true
+ * @brief KmlExport::writeStyles Writes the styles the placemarks refer to
  */
-bool KmlExport::stopExport()
+void KmlExport::writeStyles()
 {
-    logFile.close();
-    return true;
+    QXmlStreamWriter &xml = kml.xml();
+
+    // Timespan arrows
+    xml.writeStartElement("StyleMap");
+    xml.writeAttribute("id", "directiveArrowStyle");
+    writeStylePair("normal");
+    writeStyle(QString(), "$[description]", arrowIconHref, 0.65, 0.75, false, 3.25);
+    xml.writeEndElement();
+    writeStylePair("highlight");
+    writeStyle(QString(), "$[description]", arrowIconHref, 0.65, 0.9, false, 6.5);
+    xml.writeEndElement();
+    xml.writeEndElement();
+
+    // Ground track
+    writeStyle("ts_2_tb", "$[id]", QString(), 0, 0, true, 9);
+
+    // Wall axes
+    xml.writeStartElement("StyleMap");
+    xml.writeAttribute("id", "ts_1_tb");
+    writeStylePair("normal");
+    writeStyle(QString(), "$[id]", QString(), 0, 0, true, .9);
+    xml.writeEndElement();
+    writeStylePair("highlight");
+    writeStyle(QString(), "$[id]", QString(), 0, 0.75, true, 1.8);
+    xml.writeEndElement();
+    xml.writeEndElement();
+
+    // Track segments, one style per color of the color map
+    for (int i = 0; i < 256; i++) {
+        xml.writeStartElement("StyleMap");
+        xml.writeAttribute("id", QString("speed_%1").arg(i));
+        for (int highlight = 0; highlight < 2; highlight++) {
+            writeStylePair(highlight ? "highlight" : "normal");
+            xml.writeStartElement("Style");
+            xml.writeStartElement("LineStyle");
+            writeJetColor("color", i);
+            xml.writeEndElement();
+            xml.writeStartElement("PolyStyle");
+            writeJetColor("color", i, 100);
+            if (highlight)
+                kml.writeBool("fill", false);
+            xml.writeEndElement();
+            xml.writeStartElement("BalloonStyle");
+            // Custom balloon style (gets rid of "Directions to here...")
+            xml.writeTextElement("text", "$[description]");
+            xml.writeEndElement();
+            xml.writeEndElement();
+            xml.writeEndElement();
+        }
+        xml.writeEndElement();
+    }
 }
 
 /**
- * @brief KmlExport::parseLogFile Parses logfile and exports results to KML file
+ * @brief KmlExport::writeStyle Writes a style with a custom balloon, which gets rid of
+ * "Directions to here...". See
+ * https://groups.google.com/forum/?fromgroups#!topic/kml-support-getting-started/2CqF9oiynRY
+ * @param id Style id, empty for a style within a style map
+ * @param iconHref Icon image, empty for the default icon
+ * @param blackLine Whether lines are black, rather than the default color
  */
-void KmlExport::parseLogFile()
+void KmlExport::writeStyle(const QString &id, const QString &balloonText, const QString &iconHref,
+                           double iconScale, double labelScale, bool blackLine, double lineWidth)
 {
-    qint64 packetSize;
-    quint32 timeStampIdx;
-
-    // Read packets
-    while (!logFile.atEnd()) {
-        if (logFile.bytesAvailable() < 4) {
-            break;
-        }
-
-        // Read timestamp and logfile packet size
-        logFile.read((char *)&timeStamp, sizeof(timeStamp));
-        logFile.read((char *)&packetSize, sizeof(packetSize));
-
-        if (packetSize < 1 || packetSize > (1024 * 1024)) {
-            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << packetSize << "\n";
-            QMessageBox::critical(
-                new QWidget(), "Corrupted file",
-                "Incorrect packet size. Stopping export. Data up to this point will be saved.");
-
-            break;
-        }
-
-        if (logFile.bytesAvailable() < packetSize) {
-            break;
-        }
+    QXmlStreamWriter &xml = kml.xml();
+
+    xml.writeStartElement("Style");
+    if (!id.isEmpty())
+        xml.writeAttribute("id", id);
+
+    xml.writeStartElement("IconStyle");
+    kml.writeNumber("scale", iconScale);
+    if (!iconHref.isEmpty()) {
+        xml.writeStartElement("Icon");
+        xml.writeTextElement("href", iconHref);
+        xml.writeEndElement();
+    }
+    xml.writeEndElement();
 
-        // Read the data packet from the file.
-        QByteArray dataBuffer;
-        dataBuffer.append(logFile.read(packetSize));
+    xml.writeStartElement("LabelStyle");
+    kml.writeColor("color", 255, 255, 255, 0);
+    kml.writeNumber("scale", labelScale);
+    xml.writeEndElement();
 
-        // Parse the packet. This operation passes the data to the kmlTalk object, which internally
-        // parses the data
-        // and then emits objectUpdated(UAVObject *) signals. These signals are connected to in the
-        // KmlExport constructor.
-        for (int i = 0; i < dataBuffer.size(); i++) {
-            kmlTalk->processInputByte(dataBuffer[i]);
-        }
+    xml.writeStartElement("LineStyle");
+    if (blackLine)
+        kml.writeColor("color", 255, 0, 0, 0);
+    kml.writeNumber("width", lineWidth);
+    xml.writeEndElement();
 
-        timeStampIdx++;
-    }
+    xml.writeStartElement("BalloonStyle");
+    xml.writeTextElement("text", balloonText);
+    xml.writeEndElement();
 
-    stopExport();
+    xml.writeEndElement();
 }
 
 /**
- * @brief KmlExport::createCustomBalloonStyle Creates a custom balloon stye, using an arrow as an
- * icon.
- * @return Returns the custom balloon style.
+ * @brief KmlExport::writeStylePair Starts a style map pair, which the caller ends after
+ * writing its style.
  */
-StyleMapPtr KmlExport::createCustomBalloonStyle()
+void KmlExport::writeStylePair(const QString &key)
 {
-    StyleMapPtr styleMap = factory->CreateStyleMap();
-
-    {
-
-        // Add custom balloon style (gets rid of "Directions to here...")
-        // https://groups.google.com/forum/?fromgroups#!topic/kml-support-getting-started/2CqF9oiynRY
-        BalloonStylePtr balloonStyle = factory->CreateBalloonStyle();
-        balloonStyle->set_text("$[description]");
-
-        // Change the icon
-        IconStyleIconPtr iconStyleIcon = factory->CreateIconStyleIcon();
-        iconStyleIcon->set_href("http://maps.google.com/mapfiles/kml/shapes/arrow.png");
-
-        // Create a label style
-        LabelStylePtr labelStyle = factory->CreateLabelStyle();
-        labelStyle->set_color(kmlbase::Color32(255, 0, 255, 255));
-        labelStyle->set_scale(0.75);
+    kml.xml().writeStartElement("Pair");
+    kml.xml().writeTextElement("key", key);
+}
 
-        // Create an icon style
-        IconStylePtr iconStyle = factory->CreateIconStyle();
-        iconStyle->set_icon(iconStyleIcon);
-        iconStyle->set_scale(0.65);
+/**
+ * @brief KmlExport::writeTrackChunk Writes the track segments collected so far, in a folder
+ * with a region around them.
+ */
+void KmlExport::writeTrackChunk()
+{
+    if (trackChunk.isEmpty())
+        return;
 
-        // Create a line style
-        LineStylePtr lineStyle = factory->CreateLineStyle();
-        lineStyle->set_width(3.25);
+    double north = -90, south = 90, east = -180, west = 180;
+    foreach (const TrackSegment &segment, trackChunk) {
+        north = qMax(north, qMax(segment.start.latitude, segment.end.latitude));
+        south = qMin(south, qMin(segment.start.latitude, segment.end.latitude));
+        east = qMax(east, qMax(segment.start.longitude, segment.end.longitude));
+        west = qMin(west, qMin(segment.start.longitude, segment.end.longitude));
+    }
 
-        // Link the style to the icon
-        StylePtr style = factory->CreateStyle();
-        style->set_balloonstyle(balloonStyle);
-        style->set_iconstyle(iconStyle);
-        style->set_linestyle(lineStyle);
-        style->set_labelstyle(labelStyle);
+    QXmlStreamWriter &xml = kml.xml();
 
-        PairPtr pair = factory->CreatePair();
-        pair->set_styleselector(style);
-        pair->set_key(kmldom::STYLESTATE_NORMAL);
+    xml.writeStartElement("Folder");
+    xml.writeTextElement("name", placemarkTime(trackChunk.first().time));
 
-        styleMap->add_pair(pair);
-    }
+    xml.writeStartElement("Region");
+    xml.writeStartElement("LatLonAltBox");
+    xml.writeTextElement("north", QString::number(north + regionMargin, 'f', 7));
+    xml.writeTextElement("south", QString::number(south - regionMargin, 'f', 7));
+    xml.writeTextElement("east", QString::number(east + regionMargin, 'f', 7));
+    xml.writeTextElement("west", QString::number(west - regionMargin, 'f', 7));
+    xml.writeEndElement();
+    xml.writeStartElement("Lod");
+    kml.writeNumber("minLodPixels", regionMinLodPixels);
+    xml.writeEndElement();
+    xml.writeEndElement();
 
-    {
-        // Add custom balloon style (gets rid of "Directions to here...")
-        // https://groups.google.com/forum/?fromgroups#!topic/kml-support-getting-started/2CqF9oiynRY
-        BalloonStylePtr balloonStyle = factory->CreateBalloonStyle();
-        balloonStyle->set_text("$[description]");
-
-        // Change the icon
-        IconStyleIconPtr iconStyleIcon = factory->CreateIconStyleIcon();
-        iconStyleIcon->set_href("http://maps.google.com/mapfiles/kml/shapes/arrow.png");
-
-        // Create an icon style
-        IconStylePtr iconStyle = factory->CreateIconStyle();
-        iconStyle->set_icon(iconStyleIcon);
-        iconStyle->set_scale(0.65);
-
-        // Create a label style
-        LabelStylePtr labelStyle = factory->CreateLabelStyle();
-        labelStyle->set_color(kmlbase::Color32(255, 0, 255, 255));
-        labelStyle->set_scale(0.9);
-
-        // Create a line style
-        LineStylePtr lineStyle = factory->CreateLineStyle();
-        lineStyle->set_width(6.5);
-
-        // Link the style to the icon
-        StylePtr style = factory->CreateStyle();
-        style->set_balloonstyle(balloonStyle);
-        style->set_iconstyle(iconStyle);
-        style->set_linestyle(lineStyle);
-        style->set_labelstyle(labelStyle);
-
-        PairPtr pair = factory->CreatePair();
-        pair->set_styleselector(style);
-        pair->set_key(kmldom::STYLESTATE_HIGHLIGHT);
-
-        styleMap->add_pair(pair);
-    }
+    foreach (const TrackSegment &segment, trackChunk)
+        writeLineStringPlacemark(segment);
 
-    styleMap->set_id("directiveArrowStyle");
+    xml.writeEndElement();
 
-    return styleMap;
+    trackChunk.clear();
 }
 
 /**
- * @brief KmlExport::createGroundTrackStyle Creates a custom style for the ground track.
- * @return Returns the custom style.
+ * @brief KmlExport::writeLineStringPlacemark Writes a line segment which is colored according
+ * to the vehicle's speed.
  */
-StylePtr KmlExport::createGroundTrackStyle()
+void KmlExport::writeLineStringPlacemark(const TrackSegment &segment)
 {
-    // Add custom balloon style (gets rid of "Directions to here...")
-    // https://groups.google.com/forum/?fromgroups#!topic/kml-support-getting-started/2CqF9oiynRY
-    BalloonStylePtr balloonStyle = factory->CreateBalloonStyle();
-    balloonStyle->set_text("$[id]");
-
-    // Create an icon style
-    IconStylePtr iconStyle = factory->CreateIconStyle();
-    iconStyle->set_scale(0);
-
-    // Create a label style
-    LabelStylePtr labelStyle = factory->CreateLabelStyle();
-    labelStyle->set_color(kmlbase::Color32(255, 0, 255, 255));
-    labelStyle->set_scale(0);
-
-    // Create a line style
-    LineStylePtr lineStyle = factory->CreateLineStyle();
-    lineStyle->set_color(kmlbase::Color32(255, 0, 0, 0)); // Black
-    lineStyle->set_width(9);
-
-    // Link the style to the icon
-    StylePtr style = factory->CreateStyle();
-    style->set_balloonstyle(balloonStyle);
-    style->set_iconstyle(iconStyle);
-    style->set_linestyle(lineStyle);
-    style->set_labelstyle(labelStyle);
-
-    style->set_id("ts_2_tb");
-
-    return style;
-}
+    QXmlStreamWriter &xml = kml.xml();
+    double currentVelocity = (segment.start.groundspeed + segment.end.groundspeed) / 2;
 
-StyleMapPtr KmlExport::createWallAxesStyle()
-{
-    StyleMapPtr styleMap = factory->CreateStyleMap();
-
-    {
-        // Add custom balloon style (gets rid of "Directions to here...")
-        // https://groups.google.com/forum/?fromgroups#!topic/kml-support-getting-started/2CqF9oiynRY
-        BalloonStylePtr balloonStyle = factory->CreateBalloonStyle();
-        balloonStyle->set_text("$[id]");
-
-        // Create an icon style
-        IconStylePtr iconStyle = factory->CreateIconStyle();
-        iconStyle->set_scale(0);
-
-        // Create a label style
-        LabelStylePtr labelStyle = factory->CreateLabelStyle();
-        labelStyle->set_color(kmlbase::Color32(255, 0, 255, 255));
-        labelStyle->set_scale(0);
-
-        // Create a line style
-        LineStylePtr lineStyle = factory->CreateLineStyle();
-        lineStyle->set_color(kmlbase::Color32(255, 0, 0, 0)); // Black
-        lineStyle->set_width(.9);
-
-        // Link the style to the icon
-        StylePtr style = factory->CreateStyle();
-        style->set_balloonstyle(balloonStyle);
-        style->set_iconstyle(iconStyle);
-        style->set_linestyle(lineStyle);
-        style->set_labelstyle(labelStyle);
-
-        PairPtr pair = factory->CreatePair();
-        pair->set_styleselector(style);
-        pair->set_key(kmldom::STYLESTATE_NORMAL);
-
-        styleMap->add_pair(pair);
-    }
+    xml.writeStartElement("Placemark");
+    xml.writeTextElement("name", placemarkTime(segment.time));
+    kml.writeBool("visibility", true);
 
-    {
-        // Add custom balloon style (gets rid of "Directions to here...")
-        // https://groups.google.com/forum/?fromgroups#!topic/kml-support-getting-started/2CqF9oiynRY
-        BalloonStylePtr balloonStyle = factory->CreateBalloonStyle();
-        balloonStyle->set_text("$[id]");
-
-        // Create an icon style
-        IconStylePtr iconStyle = factory->CreateIconStyle();
-        iconStyle->set_scale(0);
-
-        // Create a label style
-        LabelStylePtr labelStyle = factory->CreateLabelStyle();
-        labelStyle->set_color(kmlbase::Color32(255, 0, 255, 255));
-        labelStyle->set_scale(0.75);
-
-        // Create a line style
-        LineStylePtr lineStyle = factory->CreateLineStyle();
-        lineStyle->set_color(kmlbase::Color32(255, 0, 0, 0)); // Black
-        lineStyle->set_width(1.8);
-
-        // Link the style to the icon
-        StylePtr style = factory->CreateStyle();
-        style->set_balloonstyle(balloonStyle);
-        style->set_iconstyle(iconStyle);
-        style->set_linestyle(lineStyle);
-        style->set_labelstyle(labelStyle);
-
-        PairPtr pair = factory->CreatePair();
-        pair->set_styleselector(style);
-        pair->set_key(kmldom::STYLESTATE_HIGHLIGHT);
-
-        styleMap->add_pair(pair);
-    }
+    // Add a nice description to the track placemark
+    xml.writeTextElement("description", segment.information);
+
+    writeTimeSpan(segment.time, segment.time);
 
-    styleMap->set_id("ts_1_tb");
+    // The color is a function of speed
+    xml.writeTextElement("styleUrl",
+                         QString("#speed_%1").arg(mapVelocity2Index(currentVelocity)));
 
-    return styleMap;
+    xml.writeStartElement("LineString");
+    kml.writeBool("extrude", true); // Extrude to ground
+    xml.writeTextElement("altitudeMode", "absolute");
+    xml.writeStartElement("coordinates");
+    kml.writeCoordinate(segment.start.latitude, segment.start.longitude, segment.start.altitude);
+    kml.writeCoordinate(segment.end.latitude, segment.end.longitude, segment.end.altitude);
+    xml.writeEndElement();
+    xml.writeEndElement();
+
+    xml.writeEndElement();
 }
 
 /**
- * @brief KmlExport::CreateLineStringPlacemark Adds a line segment which is colored according to the
- * vehicle's speed.
- * @param startPoint Beginning point along line
- * @param endPoint End point point along line
- * @return Returns the placemark containing the line segment
+ * @brief KmlExport::writeTimespanPlacemark Writes a timespan placemark, which allows the
+ * trajectory to be played forward in time. The placemark also contains pertinent data about
+ * the vehicle's state at that timespan
  */
-PlacemarkPtr KmlExport::CreateLineStringPlacemark(const LLAVCoordinates &startPoint,
-                                                  const LLAVCoordinates &endPoint,
-                                                  quint32 newPlacemarkTime)
+void KmlExport::writeTimespanPlacemark(const TimespanArrow &arrow)
 {
-    CoordinatesPtr coordinates = factory->CreateCoordinates();
-    coordinates->add_latlngalt(startPoint.latitude, startPoint.longitude, startPoint.altitude);
-    coordinates->add_latlngalt(endPoint.latitude, endPoint.longitude, endPoint.altitude);
-
-    LineStringPtr linestring = factory->CreateLineString();
-    linestring->set_extrude(true); // Extrude to ground
-    linestring->set_altitudemode(kmldom::ALTITUDEMODE_ABSOLUTE);
-    linestring->set_coordinates(coordinates);
-
-    StyleMapPtr styleMap = factory->CreateStyleMap();
-
-    // Add custom balloon style (gets rid of "Directions to here...")
-    // https://groups.google.com/forum/?fromgroups#!topic/kml-support-getting-started/2CqF9oiynRY
-    BalloonStylePtr balloonStyle = factory->CreateBalloonStyle();
-    balloonStyle->set_text("$[description]");
-
-    {
-        double currentVelocity = (startPoint.groundspeed + endPoint.groundspeed) / 2;
+    QXmlStreamWriter &xml = kml.xml();
 
-        // Set the linestyle. The color is a function of speed.
-        LineStylePtr lineStyle = factory->CreateLineStyle();
-        lineStyle->set_color(mapVelocity2Color(currentVelocity));
+    xml.writeStartElement("Placemark");
+    xml.writeTextElement("name", QString("%1").arg(arrow.endTime / 1000.0));
+    kml.writeBool("visibility", true);
 
-        PolyStylePtr polyStyle = factory->CreatePolyStyle();
-        polyStyle->set_color(mapVelocity2Color(currentVelocity, 100));
-
-        // Link the style to the icon
-        StylePtr style = factory->CreateStyle();
-        style->set_balloonstyle(balloonStyle);
-        style->set_linestyle(lineStyle);
-        style->set_polystyle(polyStyle);
+    // Add a nice description to the placemark
+    xml.writeTextElement("description", arrow.information);
 
-        PairPtr pair = factory->CreatePair();
-        pair->set_styleselector(style);
-        pair->set_key(kmldom::STYLESTATE_NORMAL);
+    writeTimeSpan(arrow.startTime, arrow.endTime);
 
-        styleMap->add_pair(pair);
-    }
+    // Set the placemark to use the custom rotated arrow style
+    xml.writeTextElement("styleUrl", "#directiveArrowStyle");
+    xml.writeStartElement("Style");
+
+    // This arrow icon is rotated and colored to represent velocity
+    xml.writeStartElement("IconStyle");
+    writeJetColor("color", mapVelocity2Index(arrow.airspeed));
+    // Adding 180 degrees because the arrow art points down, i.e. south.
+    kml.writeNumber("heading", arrow.heading + 180);
+    xml.writeEndElement();
+
+    // This defines the style for the "legs" connecting the points to the ground.
+    xml.writeStartElement("LineStyle");
+    writeJetColor("color", mapVelocity2Index(arrow.point.groundspeed));
+    xml.writeEndElement();
+
+    xml.writeEndElement();
+
+    xml.writeStartElement("Point");
+    kml.writeBool("extrude", true); // Extrude to ground
+    xml.writeTextElement("altitudeMode", "absolute");
+    xml.writeStartElement("coordinates");
+    kml.writeCoordinate(arrow.point.latitude, arrow.point.longitude, arrow.point.altitude);
+    xml.writeEndElement();
+    xml.writeEndElement();
+
+    xml.writeEndElement();
+}
 
-    {
-        double currentVelocity = (startPoint.groundspeed + endPoint.groundspeed) / 2;
+void KmlExport::writeTimeSpan(quint32 startTime, quint32 endTime)
+{
+    kml.xml().writeStartElement("TimeSpan");
+    kml.xml().writeTextElement("begin", placemarkTime(startTime));
+    kml.xml().writeTextElement("end", placemarkTime(endTime));
+    kml.xml().writeEndElement();
+}
 
-        // Set the linestyle. The color is a function of speed.
-        LineStylePtr lineStyle = factory->CreateLineStyle();
-        lineStyle->set_color(mapVelocity2Color(currentVelocity));
+/**
+ * @brief KmlExport::writeOverview Writes the ground track and the wall axes
+ */
+void KmlExport::writeOverview()
+{
+    QXmlStreamWriter &xml = kml.xml();
 
-        PolyStylePtr polyStyle = factory->CreatePolyStyle();
-        polyStyle->set_color(mapVelocity2Color(currentVelocity, 100));
-        polyStyle->set_fill(false);
+    for (int i = 0; i < numberOfWallAxes + 1; i++) {
+        // The first line is the ground track, the wall axes follow in their own folder
+        bool groundTrack = i == 0;
+        int axis = groundTrack ? 0 : i - 1;
 
-        // Link the style to the icon
-        StylePtr style = factory->CreateStyle();
-        style->set_balloonstyle(balloonStyle);
-        style->set_linestyle(lineStyle);
-        style->set_polystyle(polyStyle);
+        if (i == 1) {
+            xml.writeStartElement("Folder");
+            xml.writeTextElement("name", "Wall axes");
+        }
 
-        PairPtr pair = factory->CreatePair();
-        pair->set_styleselector(style);
-        pair->set_key(kmldom::STYLESTATE_HIGHLIGHT);
+        xml.writeStartElement("Placemark");
+        if (groundTrack)
+            xml.writeTextElement("name", "Ground track");
+        xml.writeTextElement("styleUrl", groundTrack ? "#ts_2_tb" : "#ts_1_tb");
+
+        xml.writeStartElement("MultiGeometry");
+        xml.writeStartElement("LineString");
+        kml.writeBool("extrude", false); // Do not extrude to ground
+        xml.writeTextElement("altitudeMode", groundTrack ? "clampToGround" : "absolute");
+        xml.writeStartElement("coordinates");
+        foreach (const LLAVCoordinates &point, overviewPath) {
+            kml.writeCoordinate(point.latitude, point.longitude,
+                                axis * wallAxesSeparation + point.altitude);
+        }
+        xml.writeEndElement();
+        xml.writeEndElement();
+        xml.writeEndElement();
 
-        styleMap->add_pair(pair);
+        xml.writeEndElement();
     }
-
-    PlacemarkPtr placemark = factory->CreatePlacemark();
-    placemark->set_geometry(linestring);
-    placemark->set_styleselector(styleMap);
-    placemark->set_visibility(true);
-
-    // Create the timespan
-    TimeSpanPtr timeSpan = factory->CreateTimeSpan();
-    QDateTime startTime =
-        QDateTime::currentDateTimeUtc().addMSecs(newPlacemarkTime); // FIXME: Make this a function
-                                                                    // of the true time, preferably
-                                                                    // gotten from the GPS
-    QDateTime endTime = QDateTime::currentDateTimeUtc().addMSecs(newPlacemarkTime);
-    timeSpan->set_begin(startTime.toString(dateTimeFormat).toStdString());
-    timeSpan->set_end(endTime.toString(dateTimeFormat).toStdString());
-
-    // Set the name
-    QDateTime trackTime =
-        QDateTime::currentDateTimeUtc().addMSecs(newPlacemarkTime); // FIXME: Make it a function of
-                                                                    // the realtime preferably
-                                                                    // gotten from the GPS
-    placemark->set_name(trackTime.toString(dateTimeFormat).toStdString());
-
-    // Add a nice description to the track placemark
-    placemark->set_description(informationString.toStdString());
-
-    // Set the timespan
-    placemark->set_timeprimitive(timeSpan);
-
-    return placemark;
+    xml.writeEndElement();
 }
 
 /**
- * @brief KmlExport::createTimespanPlacemark Creates a timespan placemark, which allows the
- * trajectory to be played forward in time. The placemark also contains pertinent data about
- * the vehicle's state at that timespan
- * @param timestampPoint
- * @param lastPlacemarkTime
- * @param newPlacemarkTime
- * @return Returns the placemark containing the timespan
+ * @brief KmlExport::placemarkTime Time of a placemark, in the format KML wants
+ * @param time Log time in [ms]
  */
-PlacemarkPtr KmlExport::createTimespanPlacemark(const LLAVCoordinates &timestampPoint,
-                                                quint32 lastPlacemarkTime, quint32 newPlacemarkTime)
+QString KmlExport::placemarkTime(quint32 time) const
 {
-    // Create coordinates
-    CoordinatesPtr coordinates = factory->CreateCoordinates();
-    coordinates->add_latlngalt(timestampPoint.latitude, timestampPoint.longitude,
-                               timestampPoint.altitude);
-
-    // Create point, using previous coordinates
-    PointPtr point = factory->CreatePoint();
-    point->set_extrude(true); // Extrude to ground
-    point->set_altitudemode(kmldom::ALTITUDEMODE_ABSOLUTE);
-    point->set_coordinates(coordinates);
-
-    // Create the timespan
-    TimeSpanPtr timeSpan = factory->CreateTimeSpan();
-    QDateTime startTime =
-        QDateTime::currentDateTimeUtc().addMSecs(lastPlacemarkTime); // FIXME: Make it a function of
-                                                                     // the realtime preferably
-                                                                     // gotten from the GPS
-    QDateTime endTime = QDateTime::currentDateTimeUtc().addMSecs(newPlacemarkTime);
-    timeSpan->set_begin(startTime.toString(dateTimeFormat).toStdString());
-    timeSpan->set_end(endTime.toString(dateTimeFormat).toStdString());
-
-    // Create an icon style. This arrow icon will be rotated and colored to represent velocity
-    AttitudeActual::DataFields attitudeActualData = attitudeActual->getData();
-    AirspeedActual::DataFields airspeedActualData = airspeedActual->getData();
-    IconStylePtr iconStyle = factory->CreateIconStyle();
-    iconStyle->set_color(mapVelocity2Color(airspeedActualData.CalibratedAirspeed));
-    iconStyle->set_heading(
-        attitudeActualData.Yaw
-        + 180); // Adding 180 degrees because the arrow art points down, i.e. south.
-
-    // Create a line style. This defines the style for the "legs" connecting the points to the
-    // ground.
-    LineStylePtr lineStyle = factory->CreateLineStyle();
-    lineStyle->set_color(mapVelocity2Color(timestampPoint.groundspeed));
-
-    // Link the style to the icon
-    StylePtr style = factory->CreateStyle();
-    style->set_linestyle(lineStyle);
-    style->set_iconstyle(iconStyle);
-
-    // Generate the placemark with all above attributes
-    PlacemarkPtr placemark = factory->CreatePlacemark();
-    placemark->set_geometry(point);
-    placemark->set_timeprimitive(timeSpan);
-    placemark->set_name(QString("%1").arg(timeStamp / 1000.0).toStdString());
-    placemark->set_visibility(true);
-
-    // Set the placemark to use the custom rotated arrow style
-    placemark->set_styleurl("#directiveArrowStyle");
-    placemark->set_styleselector(style);
-
-    // Add a nice description to the placemark
-    placemark->set_description(informationString.toStdString());
-
-    return placemark;
+    // FIXME: Make this a function of the true time, preferably gotten from the GPS
+    return exportTime.addMSecs(time).toString(dateTimeFormat);
 }
 
 /**
- * @brief KmlExport::mapVelocity2Color Maps a velocity magnitude onto a color.
+ * @brief KmlExport::mapVelocity2Index Maps a velocity magnitude onto the color map.
  * @param velocity Vehicle velocity in [m/s]
+ * @return Returns the index in the color map
+ */
+quint8 KmlExport::mapVelocity2Index(double velocity)
+{
+    return fmin(fabs(velocity / maxVelocity), 1) * 255;
+}
+
+/**
+ * @brief KmlExport::writeJetColor Writes a color of the color map.
  * @param alpha Transparency. If no value provided, color is fully opaque
- * @return Returns the RGBA color
  */
-kmlbase::Color32 KmlExport::mapVelocity2Color(double velocity, quint8 alpha)
+void KmlExport::writeJetColor(const QString &name, quint8 index, quint8 alpha)
 {
-    quint8 colorMapIdx = fmin(fabs(velocity / maxVelocity), 1) * 255;
-    quint8 r = round(ColorMap_Jet[colorMapIdx][0]
-                     * 255); // Colormap is in [0,1], so it needs to be scaled to [0,255]
-    quint8 g = round(ColorMap_Jet[colorMapIdx][1] * 255);
-    quint8 b = round(ColorMap_Jet[colorMapIdx][2] * 255);
+    // Colormap is in [0,1], so it needs to be scaled to [0,255]
+    quint8 r = round(ColorMap_Jet[index][0] * 255);
+    quint8 g = round(ColorMap_Jet[index][1] * 255);
+    quint8 b = round(ColorMap_Jet[index][2] * 255);
 
-    return kmlbase::Color32(alpha, b, g, r);
+    kml.writeColor(name, alpha, r, g, b);
 }
 
 /**
@@ -851,43 +618,58 @@ void KmlExport::positionActualUpdated(UAVObject *obj)
                                  .arg(airspeedActualData.CalibratedAirspeed)
                                  .arg(newPoint.groundspeed));
 
-    // In case this is the first time through, copy data and exit
-    static bool firstPoint;
+    // Ground track and wall axes points are at the home altitude
+    LLAVCoordinates overviewPoint = newPoint;
+    overviewPoint.altitude = homeLocationData.Altitude;
 
+    // In case this is the first time through, copy data and exit
     if (firstPoint == false) {
-        oldPoint.latitude = newPoint.latitude;
-        oldPoint.longitude = newPoint.longitude;
-        oldPoint.altitude = newPoint.altitude;
-        oldPoint.groundspeed = newPoint.groundspeed;
+        oldPoint = newPoint;
+        memcpy(oldNED, NED, sizeof(NED));
+        memcpy(overviewNED, NED, sizeof(NED));
+        overviewPath.append(overviewPoint);
 
         firstPoint = true;
         return;
     }
 
-    // Create wall axes
-    for (int i = 0; i < numberOfWallAxes; i++) {
-        wallAxes[i]->add_latlngalt(newPoint.latitude, newPoint.longitude,
-                                   i * wallAxesSeparation + homeLocationData.Altitude);
-    }
-
-    // Create colored tracks and add to the KML document
-    PlacemarkPtr newPlacemark = CreateLineStringPlacemark(oldPoint, newPoint, timeStamp);
-    trackFolder->add_feature(newPlacemark);
-
     // Every 2 seconds generate a time stamp
     if (timeStamp - lastPlacemarkTime > 2000) {
+        TimespanArrow arrow;
+        arrow.point = newPoint;
+        arrow.startTime = lastPlacemarkTime;
+        arrow.endTime = timeStamp;
+        arrow.heading = attitudeActual->getYaw();
+        arrow.airspeed = airspeedActualData.CalibratedAirspeed;
+        arrow.information = informationString;
+        timespanArrows.append(arrow);
 
-        PlacemarkPtr newPlacemarkTimestamp =
-            createTimespanPlacemark(newPoint, lastPlacemarkTime, timeStamp);
-        timestampFolder->add_feature(newPlacemarkTimestamp);
         lastPlacemarkTime = timeStamp;
     }
 
+    // Extend the ground track and wall axes
+    if (distanceNED(NED, overviewNED) >= overviewTolerance) {
+        overviewPath.append(overviewPoint);
+        memcpy(overviewNED, NED, sizeof(NED));
+    }
+
+    // Create colored tracks, once the vehicle moved far enough
+    if (distanceNED(NED, oldNED) < trackTolerance)
+        return;
+
+    TrackSegment segment;
+    segment.start = oldPoint;
+    segment.end = newPoint;
+    segment.time = timeStamp;
+    segment.information = informationString;
+    trackChunk.append(segment);
+
+    if (trackChunk.size() >= trackChunkSize)
+        writeTrackChunk();
+
     // Copy newPoint to oldPoint
-    oldPoint.latitude = newPoint.latitude;
-    oldPoint.longitude = newPoint.longitude;
-    oldPoint.altitude = newPoint.altitude;
-    oldPoint.groundspeed = newPoint.groundspeed;
+    oldPoint = newPoint;
+    memcpy(oldNED, NED, sizeof(NED));
 }
 
 void KmlExport::homeLocationUpdated(UAVObject *obj)
@@ -31,13 +31,13 @@
 #include <QTimer>
 #include <QDebug>
 #include <QBuffer>
+#include <QDateTime>
+#include <QVector>
 #include <math.h>
 
-#include "kml/base/file.h"
-#include "kml/dom.h"
-#include "kml/engine.h"
+#include "kmlwriter.h"
 
-#include "./uavtalk/uavtalk.h"
+#include "./uavtalk/logdecoder.h"
 
 #include "airspeedactual.h"
 #include "attitudeactual.h"
@@ -46,8 +46,6 @@
 #include "positionactual.h"
 #include "velocityactual.h"
 
-using namespace kmldom;
-
 // This struct holds the 4D LLA-Velocity coordinates
 struct LLAVCoordinates
 {
@@ -60,18 +58,27 @@ struct LLAVCoordinates
 /**
  * @class KmlExport generates a KML file showing the flight path from a UAVTalk
  * log path that is viewable in Google Earth.
+ *
+ * The document is written while the log is decoded. Track segments are
+ * written a chunk at a time, each chunk in a folder with a region, so Google
+ * Earth only draws them once zoomed in enough. The ground track and wall axes
+ * are drawn at all ranges, from a coarser simplification of the path.
  */
 class KmlExport : public QObject
 {
     Q_OBJECT
 public:
     explicit KmlExport(QString inputFileName, QString outputFileName);
-    qint64 bytesAvailable() const;
-    qint64 bytesToWrite() { return logFile.bytesToWrite(); }
     bool open();
-    void setFileName(QString name) { logFile.setFileName(name); }
+    void setFileName(QString name) { logFileName = name; }
+
+    /**
+     * @brief Set how far in [m] the vehicle has to move for new points to be
+     * added to the track and to the ground track and wall axes. 0 keeps every
+     * point.
+     */
+    void setSimplification(double trackTolerance, double overviewTolerance);
 
-    bool preparseLogFile();
     bool stopExport();
     bool exportToKML();
 
@@ -86,13 +93,28 @@ signals:
     void replayFinished();
 
 protected:
-    QFile logFile;
+    QString logFileName;
 
 private:
-    QList<quint32> timestampBuffer;
-    QList<quint32> timestampPos;
-
-    UAVTalk *kmlTalk;
+    struct TrackSegment
+    {
+        LLAVCoordinates start;
+        LLAVCoordinates end;
+        quint32 time;
+        QString information;
+    };
+
+    struct TimespanArrow
+    {
+        LLAVCoordinates point;
+        quint32 startTime;
+        quint32 endTime;
+        double heading;
+        double airspeed;
+        QString information;
+    };
+
+    LogDecoder *logDecoder;
 
     AirspeedActual *airspeedActual;
     AttitudeActual *attitudeActual;
@@ -104,30 +126,39 @@ private:
     GPSPosition::DataFields gpsPositionData;
     HomeLocation::DataFields homeLocationData;
 
-    DocumentPtr document;
-    FolderPtr trackFolder;
-    FolderPtr timestampFolder;
-    KmlFactory *factory;
+    KmlWriter kml;
+    QDateTime exportTime;
+    double trackTolerance;
+    double overviewTolerance;
 
     QString outputFileName;
+    bool firstPoint;
     LLAVCoordinates oldPoint;
+    double oldNED[3];
+    double overviewNED[3];
     quint32 timeStamp;
     quint32 lastPlacemarkTime;
     QString informationString;
-    QVector<CoordinatesPtr> wallAxes;
+    QVector<TrackSegment> trackChunk;
+    QVector<TimespanArrow> timespanArrows;
+    //! Path of the ground track and wall axes, altitude is the home altitude
+    QVector<LLAVCoordinates> overviewPath;
     static QString dateTimeFormat;
 
-    void parseLogFile();
-    StylePtr createGroundTrackStyle();
-    StyleMapPtr createWallAxesStyle();
-    StyleMapPtr createCustomBalloonStyle();
-    PlacemarkPtr CreateLineStringPlacemark(const LLAVCoordinates &startPoint,
-                                           const LLAVCoordinates &endPoint,
-                                           quint32 newPlacemarkTime);
-    PlacemarkPtr createTimespanPlacemark(const LLAVCoordinates &point, quint32 lastPlacemarkTime,
-                                         quint32 newPlacemarkTime);
-
-    kmlbase::Color32 mapVelocity2Color(double velocity, quint8 alpha = 255);
+    bool parseLogFile();
+    void writeStyles();
+    void writeStyle(const QString &id, const QString &balloonText, const QString &iconHref,
+                    double iconScale, double labelScale, bool blackLine, double lineWidth);
+    void writeStylePair(const QString &key);
+    void writeTrackChunk();
+    void writeLineStringPlacemark(const TrackSegment &segment);
+    void writeTimespanPlacemark(const TimespanArrow &arrow);
+    void writeTimeSpan(quint32 startTime, quint32 endTime);
+    void writeOverview();
+    QString placemarkTime(quint32 time) const;
+
+    static quint8 mapVelocity2Index(double velocity);
+    void writeJetColor(const QString &name, quint8 index, quint8 alpha = 255);
 };
 
 //! Jet color map, as defined by matlab. Generated with `jet(256)`.
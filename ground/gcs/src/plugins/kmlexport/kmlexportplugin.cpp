@@ -85,7 +85,6 @@ void KmlExportPlugin::exportToKML()
                          "(uncompressed) (*.kml)");
     bool proceed_flag = false;
     QString outputFileName;
-    QString localizedOutputFileName;
 
     // Get output file. Suggest to user that output have same base name and location as input file.
     while (proceed_flag == false) {
@@ -105,22 +104,13 @@ void KmlExportPlugin::exportToKML()
             qDebug() << "Incorrect KML file extension: " << QFileInfo(outputFileName).suffix();
             QMessageBox::critical(new QWidget(), "Incorrect file extension",
                                   "Filename must have .kml or .kmz extension.");
-        } else if (outputFileName.toLocal8Bit() == (QByteArray)NULL) {
-            qDebug() << "Unsupported characters in path: " << outputFileName;
-            QMessageBox::critical(new QWidget(), "Unsupported characters",
-                                  "Not all uni-code characters are supported. Please choose a path "
-                                  "and file name that uses only the standard latin alphabet.");
         } else {
             proceed_flag = true;
-
-            // Due to limitations in the KML library, we must convert the output file name into
-            // local 8-bit characters.
-            localizedOutputFileName = outputFileName.toLocal8Bit();
         }
     }
 
     // Create kmlExport instance, and trigger export
-    KmlExport kmlExport(inputFileName, localizedOutputFileName);
+    KmlExport kmlExport(inputFileName, outputFileName);
     kmlExport.exportToKML();
 }
 
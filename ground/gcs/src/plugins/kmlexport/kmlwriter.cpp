@@ -0,0 +1,147 @@
+/**
+ ******************************************************************************
+ * @file       kmlwriter.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief Streams a KML document to a KML or KMZ file
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup KmlExportPlugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "kmlwriter.h"
+
+#include <QFileInfo>
+
+#include "quazip.h"
+#include "quazipfile.h"
+
+KmlWriter::KmlWriter()
+{
+}
+
+KmlWriter::~KmlWriter()
+{
+    if (writer.device())
+        close();
+}
+
+bool KmlWriter::open(const QString &fileName)
+{
+    QIODevice *device;
+
+    if (QFileInfo(fileName).suffix().toLower() == "kmz") {
+        zip.reset(new QuaZip(fileName));
+        if (!zip->open(QuaZip::mdCreate)) {
+            error = QString("Can't create %1").arg(fileName);
+            zip.reset();
+            return false;
+        }
+        zipFile.reset(new QuaZipFile(zip.data()));
+        if (!zipFile->open(QIODevice::WriteOnly, QuaZipNewInfo("doc.kml"))) {
+            error = QString("Can't add the document to %1").arg(fileName);
+            zipFile.reset();
+            zip->close();
+            zip.reset();
+            return false;
+        }
+        device = zipFile.data();
+    } else {
+        file.setFileName(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error = file.errorString();
+            return false;
+        }
+        device = &file;
+    }
+
+    writer.setDevice(device);
+    writer.setAutoFormatting(true);
+    writer.writeStartDocument();
+    writer.writeDefaultNamespace("http://www.opengis.net/kml/2.2");
+    writer.writeStartElement("kml");
+    writer.writeStartElement("Document");
+
+    return true;
+}
+
+bool KmlWriter::close()
+{
+    if (!writer.device())
+        return false;
+
+    writer.writeEndDocument();
+    bool ok = !writer.hasError();
+    writer.setDevice(Q_NULLPTR);
+
+    if (zip) {
+        zipFile->close();
+        ok = ok && zipFile->getZipError() == 0;
+        zipFile.reset();
+        zip->close();
+        ok = ok && zip->getZipError() == 0;
+        zip.reset();
+    } else {
+        ok = ok && file.error() == QFile::NoError;
+        file.close();
+    }
+
+    if (!ok && error.isEmpty())
+        error = "Write failed";
+
+    return ok;
+}
+
+/**
+ * @brief Write a KML color, which is hex aabbggrr
+ */
+void KmlWriter::writeColor(const QString &name, quint8 alpha, quint8 red, quint8 green,
+                           quint8 blue)
+{
+    quint32 abgr = ((quint32)alpha << 24) | (blue << 16) | (green << 8) | red;
+    writer.writeTextElement(name, QString("%1").arg(abgr, 8, 16, QChar('0')));
+}
+
+/**
+ * @brief Add a tuple to the <coordinates> being written. KML puts longitude first.
+ */
+void KmlWriter::writeCoordinate(double latitude, double longitude, double altitude)
+{
+    writer.writeCharacters(QString("%1,%2,%3 ")
+                               .arg(longitude, 0, 'f', 7)
+                               .arg(latitude, 0, 'f', 7)
+                               .arg(altitude, 0, 'f', 2));
+}
+
+void KmlWriter::writeBool(const QString &name, bool value)
+{
+    writer.writeTextElement(name, value ? "1" : "0");
+}
+
+void KmlWriter::writeNumber(const QString &name, double value)
+{
+    writer.writeTextElement(name, QString::number(value));
+}
+
+/**
+ * @}
+ * @}
+ */
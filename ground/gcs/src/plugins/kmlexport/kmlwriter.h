@@ -0,0 +1,87 @@
+/**
+ ******************************************************************************
+ * @file       kmlwriter.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief Streams a KML document to a KML or KMZ file
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup KmlExportPlugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef KMLWRITER_H
+#define KMLWRITER_H
+
+#include <QFile>
+#include <QScopedPointer>
+#include <QString>
+#include <QXmlStreamWriter>
+
+class QuaZip;
+class QuaZipFile;
+
+/**
+ * @brief Writes a KML document element by element, straight to the file, so
+ * nothing but the element being written is held in memory.
+ *
+ * A .kmz file name gets the document compressed into the archive as doc.kml,
+ * anything else is written as plain KML.
+ */
+class KmlWriter
+{
+public:
+    KmlWriter();
+    ~KmlWriter();
+
+    /**
+     * @brief Create the file and start the <kml> and <Document> elements
+     */
+    bool open(const QString &fileName);
+
+    /**
+     * @brief End the document and close the file
+     * @return false if any of it failed to be written
+     */
+    bool close();
+
+    QString errorString() const { return error; }
+
+    QXmlStreamWriter &xml() { return writer; }
+
+    void writeColor(const QString &name, quint8 alpha, quint8 red, quint8 green, quint8 blue);
+    void writeCoordinate(double latitude, double longitude, double altitude);
+    void writeBool(const QString &name, bool value);
+    void writeNumber(const QString &name, double value);
+
+private:
+    QFile file;
+    QScopedPointer<QuaZip> zip;
+    QScopedPointer<QuaZipFile> zipFile;
+    QXmlStreamWriter writer;
+    QString error;
+};
+
+#endif // KMLWRITER_H
+
+/**
+ * @}
+ * @}
+ */
@@ -32,6 +32,8 @@
 #include <uavobjects/uavobjectmanager.h>
 #include "uavobjectutil/uavobjectutilmanager.h"
 #include <extensionsystem/pluginmanager.h>
+#include "uavtalk/telemetrymanager.h"
+#include "uavtalk/logexpander.h"
 
 #include "loggingstats.h"
 
@@ -127,7 +129,7 @@ void FlightLogDownload::updateReceived()
         UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_MANUAL);
         loggingStats->setMetadata(mdata);
 
-        logFile->write(log);
+        logFile->write(LogExpander::expand(log));
         logFile->close();
 
         ui->lb_operationStatus->setText("Download complete.");
@@ -165,6 +167,12 @@ void FlightLogDownload::startDownload()
 
     log.clear();
 
+    qDebug() << "Download file id: " << file_id;
+    if (streamDownload(file_id))
+        return;
+
+    // Firmware without log file transfers: fall back to one sector per
+    // object update
     LoggingStats::DataFields logging = loggingStats->getData();
 
     // Stop any existing log file
@@ -177,7 +185,6 @@ void FlightLogDownload::startDownload()
     UAVObject::SetFlightTelemetryUpdateMode(mdata, UAVObject::UPDATEMODE_ONCHANGE);
     loggingStats->setMetadata(mdata);
 
-    qDebug() << "Download file id: " << file_id;
     dl_state = DL_DOWNLOADING;
     logging.Operation = LoggingStats::OPERATION_DOWNLOAD;
     logging.FileRequest = file_id;
@@ -186,6 +193,43 @@ void FlightLogDownload::startDownload()
     loggingStats->updated();
 }
 
+/**
+ * @brief FlightLogDownload::streamDownload fetch a log through the
+ * telemetry file transfer channel, which sends windows of chunks and
+ * resumes from the last received offset after a stall
+ * @return true if the firmware served the log this way
+ */
+bool FlightLogDownload::streamDownload(qint32 file_id)
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
+    if (!telMngr)
+        return false;
+
+    ui->lb_operationStatus->setText("Downloading...");
+    ui->saveButton->setEnabled(false);
+
+    QByteArray *data = telMngr->downloadFile(LOG_FILEID_BASE + file_id, MAX_LOG_SIZE,
+                                             [&](quint32 progress) {
+                                                 ui->sectorLabel->setText(
+                                                     tr("%0 kB").arg(progress / 1024));
+                                             });
+
+    ui->saveButton->setEnabled(true);
+
+    if (!data || data->isEmpty()) {
+        delete data;
+        return false;
+    }
+
+    logFile->write(LogExpander::expand(*data));
+    logFile->close();
+    delete data;
+
+    ui->lb_operationStatus->setText("Download complete.");
+    return true;
+}
+
 /**
  * @}
  * @}
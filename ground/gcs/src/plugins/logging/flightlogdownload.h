@@ -51,6 +51,13 @@ private slots:
     void getFilename();
 
 private:
+    bool streamDownload(qint32 file_id);
+
+    // File ids of the on-board log files for the telemetry file transfer,
+    // must match the firmware telemetry module
+    static const quint32 LOG_FILEID_BASE = 0x00010000;
+    static const quint32 MAX_LOG_SIZE = 64 * 1024 * 1024;
+
     LoggingStats *loggingStats;
     QByteArray log;
     QFile *logFile;
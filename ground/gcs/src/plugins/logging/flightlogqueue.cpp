@@ -0,0 +1,233 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogqueue.cpp
+ * @author     dRonin, http://dronin.org Copyright (C) 2016
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Background download of every on-board flight log
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+#include "flightlogqueue.h"
+
+#include <uavobjects/uavobjectmanager.h>
+#include <extensionsystem/pluginmanager.h>
+#include "uavtalk/telemetrymanager.h"
+#include "uavtalk/logexpander.h"
+
+#include "loggingstats.h"
+
+#include <QDir>
+#include <QSaveFile>
+#include <QtEndian>
+#include <QDebug>
+
+FlightLogQueue::FlightLogQueue(QObject *parent)
+    : QObject(parent)
+    , loggingStats(0)
+    , telemetryManager(0)
+    , state(QUEUE_IDLE)
+    , cancelled(false)
+    , firstFileId(0)
+    , nextFileId(0)
+    , lastFileId(-1)
+    , downloaded(0)
+    , skipped(0)
+    , failed(0)
+{
+    statsTimer.setSingleShot(true);
+    connect(&statsTimer, SIGNAL(timeout()), this, SLOT(statsTimeout()));
+}
+
+void FlightLogQueue::start(const QString &directory)
+{
+    if (isRunning())
+        return;
+
+    this->directory = directory;
+    cancelled = false;
+    downloaded = 0;
+    skipped = 0;
+    failed = 0;
+
+    if (!loggingStats) {
+        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+        UAVObjectManager *uavoManager = pm->getObject<UAVObjectManager>();
+        loggingStats = LoggingStats::GetInstance(uavoManager);
+        Q_ASSERT(loggingStats);
+        telemetryManager = pm->getObject<TelemetryManager>();
+        connect(loggingStats, SIGNAL(objectUnpacked(UAVObject *)), this, SLOT(statsReceived()));
+    }
+
+    if (!telemetryManager || !telemetryManager->isConnected()) {
+        QTimer::singleShot(0, this, SLOT(statsTimeout()));
+        return;
+    }
+
+    // The file ids have to be current, so wait for a fresh LoggingStats
+    state = QUEUE_WAITING_STATS;
+    statsTimer.start(STATS_TIMEOUT_MS);
+    loggingStats->requestUpdate();
+}
+
+void FlightLogQueue::cancel()
+{
+    cancelled = true;
+}
+
+void FlightLogQueue::statsReceived()
+{
+    if (state != QUEUE_WAITING_STATS)
+        return;
+
+    statsTimer.stop();
+
+    LoggingStats::DataFields logging = loggingStats->getData();
+    firstFileId = logging.MinFileId;
+    nextFileId = logging.MinFileId;
+    lastFileId = logging.MaxFileId;
+
+    state = QUEUE_DOWNLOADING;
+    QTimer::singleShot(0, this, SLOT(downloadNext()));
+}
+
+void FlightLogQueue::statsTimeout()
+{
+    qDebug() << "FlightLogQueue: no LoggingStats from the board";
+    finish();
+}
+
+/**
+ * @brief FlightLogQueue::downloadNext handle one log, then return to the
+ * event loop before the next so the queue can be cancelled in between
+ */
+void FlightLogQueue::downloadNext()
+{
+    if (cancelled || nextFileId > lastFileId || !telemetryManager->isConnected()) {
+        finish();
+        return;
+    }
+
+    qint32 fileId = nextFileId++;
+    emit progress(fileId - firstFileId + 1, lastFileId - firstFileId + 1);
+
+    quint32 length, crc;
+    if (!readChecksum(fileId, length, crc)) {
+        qDebug() << "FlightLogQueue: no checksum for log" << fileId;
+        failed++;
+    } else if (length == 0) {
+        skipped++;
+    } else {
+        // Tag the file with what identifies the log on the board
+        QString tag = QString("%1%2").arg(length, 8, 16, QChar('0')).arg(crc, 8, 16, QChar('0'));
+        QDir dir(directory);
+
+        if (!dir.entryList(QStringList() << QString("*-%1.drlog").arg(tag), QDir::Files).isEmpty()) {
+            skipped++;
+        } else if (downloadLog(fileId, length, crc,
+                               dir.filePath(QString("dRonin-log%1-%2.drlog").arg(fileId).arg(tag)))) {
+            downloaded++;
+        } else {
+            failed++;
+        }
+    }
+
+    QTimer::singleShot(0, this, SLOT(downloadNext()));
+}
+
+/**
+ * @brief FlightLogQueue::readChecksum fetch the length and CRC32 of a log,
+ * which the firmware computes over the log as stored on the board
+ * @return true on success
+ */
+bool FlightLogQueue::readChecksum(qint32 fileId, quint32 &length, quint32 &crc)
+{
+    QByteArray *data = telemetryManager->downloadFile(LOG_CHECKSUM_FILEID_BASE + fileId,
+                                                      2 * sizeof(quint32), nullptr);
+
+    bool ok = data && (size_t)data->size() == 2 * sizeof(quint32);
+    if (ok) {
+        const uchar *raw = (const uchar *)data->constData();
+        length = qFromLittleEndian<quint32>(raw);
+        crc = qFromLittleEndian<quint32>(raw + sizeof(quint32));
+    }
+
+    delete data;
+    return ok;
+}
+
+/**
+ * @brief FlightLogQueue::downloadLog fetch a log, check it against its
+ * length and CRC32 and save it expanded, retrying a corrupt transfer
+ * @return true if the log was saved
+ */
+bool FlightLogQueue::downloadLog(qint32 fileId, quint32 length, quint32 crc,
+                                 const QString &fileName)
+{
+    for (int attempt = 0; attempt < DOWNLOAD_ATTEMPTS; attempt++) {
+        QByteArray *data = telemetryManager->downloadFile(LOG_FILEID_BASE + fileId, length, nullptr);
+
+        if (!data || (quint32)data->size() != length || crc32(0, *data) != crc) {
+            qDebug() << "FlightLogQueue: log" << fileId << "failed verification";
+            delete data;
+            continue;
+        }
+
+        // Only a complete file ever gets the name the log is skipped by
+        QSaveFile logFile(fileName);
+        bool ok = logFile.open(QIODevice::WriteOnly);
+        ok = ok && logFile.write(LogExpander::expand(*data)) >= 0;
+        ok = ok && logFile.commit();
+        delete data;
+
+        if (!ok)
+            qDebug() << "FlightLogQueue: could not write" << fileName;
+        return ok;
+    }
+
+    return false;
+}
+
+void FlightLogQueue::finish()
+{
+    statsTimer.stop();
+    state = QUEUE_IDLE;
+    emit finished(downloaded, skipped, failed);
+}
+
+/**
+ * @brief FlightLogQueue::crc32 the CRC32 of the firmware, PIOS_CRC32_updateCRC():
+ * polynomial 0x04C11DB7, most significant bit first, no final xor
+ */
+quint32 FlightLogQueue::crc32(quint32 crc, const QByteArray &data)
+{
+    for (int i = 0; i < data.size(); i++) {
+        crc ^= (quint32)(quint8)data.at(i) << 24;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+    }
+
+    return crc;
+}
+
+/**
+ * @}
+ * @}
+ */
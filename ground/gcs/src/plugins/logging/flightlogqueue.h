@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ *
+ * @file       flightlogqueue.h
+ * @author     dRonin, http://dronin.org Copyright (C) 2016
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Background download of every on-board flight log
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+#ifndef FLIGHTLOGQUEUE_H
+#define FLIGHTLOGQUEUE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QTimer>
+
+class LoggingStats;
+class TelemetryManager;
+
+/**
+ * @brief Downloads every log between LoggingStats MinFileId and MaxFileId
+ * into a directory, one after the other, while the rest of the GCS stays
+ * usable.
+ *
+ * Each log is identified by the length and CRC32 the firmware reports for
+ * it. Both are part of the saved file name, so logs already in the
+ * directory are skipped without being transferred again, and every
+ * download is checked against them before it is written.
+ */
+class FlightLogQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FlightLogQueue(QObject *parent = 0);
+
+    bool isRunning() const { return state != QUEUE_IDLE; }
+
+public slots:
+    /**
+     * @brief Start downloading all logs on the board
+     * @param directory where to save the logs
+     */
+    void start(const QString &directory);
+
+    //! Stop once the log being downloaded is done
+    void cancel();
+
+signals:
+    //! A log is being looked at, @p index counting from 1 up to @p count
+    void progress(int index, int count);
+    //! All logs were handled, or the queue was cancelled
+    void finished(int downloaded, int skipped, int failed);
+
+private slots:
+    void statsReceived();
+    void statsTimeout();
+    void downloadNext();
+
+private:
+    bool readChecksum(qint32 fileId, quint32 &length, quint32 &crc);
+    bool downloadLog(qint32 fileId, quint32 length, quint32 crc, const QString &fileName);
+    void finish();
+
+    static quint32 crc32(quint32 crc, const QByteArray &data);
+
+    // File ids for the telemetry file transfer, must match the firmware
+    // telemetry module
+    static const quint32 LOG_FILEID_BASE = 0x00010000;
+    static const quint32 LOG_CHECKSUM_FILEID_BASE = 0x00030000;
+    static const int STATS_TIMEOUT_MS = 3000;
+    static const int DOWNLOAD_ATTEMPTS = 2;
+
+    LoggingStats *loggingStats;
+    TelemetryManager *telemetryManager;
+    QTimer statsTimer;
+    QString directory;
+
+    enum { QUEUE_IDLE, QUEUE_WAITING_STATS, QUEUE_DOWNLOADING } state;
+    bool cancelled;
+    qint32 firstFileId;
+    qint32 nextFileId;
+    qint32 lastFileId;
+    int downloaded;
+    int skipped;
+    int failed;
+};
+
+#endif // FLIGHTLOGQUEUE_H
+
+/**
+ * @}
+ * @}
+ */
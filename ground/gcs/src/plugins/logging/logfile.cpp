@@ -29,14 +29,87 @@
 #include <QtGlobal>
 #include <QTextStream>
 #include <QMessageBox>
+#include <QDataStream>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
 
 #include <coreplugin/coreconstants.h>
+#include <extensionsystem/pluginmanager.h>
+#include "uavtalk/logrecord.h"
+
+// Sidecar index file identification
+#define INDEX_MAGIC 0x44524c49 // "DRLI"
+#define INDEX_VERSION 1
+
+ReplayBuffer::ReplayBuffer()
+    : head(0)
+    , count(0)
+{
+}
+
+void ReplayBuffer::clear()
+{
+    head = 0;
+    count = 0;
+}
+
+void ReplayBuffer::append(const char *data, qint64 len)
+{
+    if (count + len > buf.size()) {
+        // Grow to the next power of two, unwrapping the contents
+        qint64 capacity = qMax<qint64>(buf.size(), 4096);
+        while (capacity < count + len)
+            capacity *= 2;
+
+        QByteArray grown(capacity, 0);
+        qint64 used = read(grown.data(), count);
+        buf = grown;
+        head = 0;
+        count = used;
+    }
+
+    qint64 tail = (head + count) % buf.size();
+    qint64 first = qMin(len, buf.size() - tail);
+    memcpy(buf.data() + tail, data, first);
+    memcpy(buf.data(), data + first, len - first);
+    count += len;
+}
+
+qint64 ReplayBuffer::read(char *data, qint64 maxLen)
+{
+    qint64 toRead = qMin(maxLen, count);
+    if (toRead <= 0)
+        return 0;
+
+    qint64 first = qMin(toRead, buf.size() - head);
+    memcpy(data, buf.constData() + head, first);
+    memcpy(data + first, buf.constData(), toRead - first);
+
+    head = (head + toRead) % buf.size();
+    count -= toRead;
+    return toRead;
+}
 
 LogFile::LogFile(QObject *parent)
     : QIODevice(parent)
-    , timestampBufferIdx(0)
+    , timer(this)
+    , bufferFirstTimestamp(0)
+    , bufferLastTimestamp(0)
+    , flushTimer(this)
+    , recordsChecked(false)
+    , blocksCompressed(false)
+    , currentBlock(-1)
+    , replayIdx(0)
+    , firstTimestamp(0)
+    , mapData(NULL)
+    , mapSize(0)
+    , recordData(NULL)
+    , objManager(NULL)
 {
     connect(&timer, SIGNAL(timeout()), this, SLOT(timerFired()));
+    connect(&flushTimer, SIGNAL(timeout()), this, SLOT(flushRecords()));
 }
 
 /**
@@ -87,7 +160,17 @@ bool LogFile::open(OpenMode mode)
                                .replace("0x", "");
         QTextStream out(&file);
 
-        out << "dRonin git hash:\n" << gitHash << "\n" << uavoHash << "\n##\n";
+        out << "dRonin git hash:\n"
+            << gitHash << "\n"
+            << uavoHash << "\n"
+            << LogRecord::headerTag() << "\n"
+            << LogBlock::headerTag() << "\n##\n";
+        out.flush();
+
+        writeBuffer.clear();
+        blocks.clear();
+        blocksCompressed = true;
+        flushTimer.start(FLUSH_INTERVAL_MS);
     } else if (mode == QIODevice::ReadOnly) {
         file.readLine(); // Read first line of log file. This assumes that the logfile is of the new
                          // format.
@@ -122,9 +205,15 @@ bool LogFile::open(OpenMode mode)
             msgBox.exec();
         }
 
-        QString tmpLine = file.readLine(); // Look for the header/body separation string.
+        QString tmpLine = file.readLine().trimmed(); // Look for the header/body separation string.
         int cnt = 0;
-        while (tmpLine != "##\n" && cnt < 10 && !file.atEnd()) {
+        recordsChecked = false;
+        blocksCompressed = false;
+        while (tmpLine != "##" && cnt < 10 && !file.atEnd()) {
+            if (tmpLine == LogRecord::headerTag())
+                recordsChecked = true;
+            else if (tmpLine == LogBlock::headerTag())
+                blocksCompressed = true;
             tmpLine = file.readLine().trimmed();
             cnt++;
         }
@@ -161,6 +250,24 @@ void LogFile::close()
 
     if (timer.isActive())
         timer.stop();
+    flushTimer.stop();
+    flushRecords();
+    if (blocksCompressed && file.isWritable()) {
+        // Lets replay seek without walking the blocks
+        QByteArray blockIndex;
+        LogBlock::appendIndex(blockIndex, blocks);
+        file.write(blockIndex);
+    }
+    if (mapData != NULL) {
+        file.unmap(const_cast<uchar *>(mapData));
+        mapData = NULL;
+        mapSize = 0;
+    }
+    recordData = NULL;
+    index.clear();
+    blocks.clear();
+    blockData.clear();
+    currentBlock = -1;
     file.close();
     QIODevice::close();
 }
@@ -170,25 +277,56 @@ qint64 LogFile::writeData(const char *data, qint64 dataSize)
     if (!file.isWritable())
         return dataSize;
 
-    quint32 timeStamp = myTime.elapsed();
+    bool full;
+    {
+        QMutexLocker locker(&writeMutex);
+        const quint32 timestamp = myTime.elapsed();
+        if (writeBuffer.isEmpty())
+            bufferFirstTimestamp = timestamp;
+        bufferLastTimestamp = timestamp;
+        LogRecord::append(writeBuffer, timestamp, data, dataSize);
+        full = writeBuffer.size() >= WRITE_BUFFER_SIZE;
+    }
 
-    file.write((char *)&timeStamp, sizeof(timeStamp));
-    file.write((char *)&dataSize, sizeof(dataSize));
+    if (full)
+        flushRecords();
 
-    qint64 written = file.write(data, dataSize);
-    if (written != -1)
-        emit bytesWritten(written);
+    emit bytesWritten(dataSize);
 
     return dataSize;
 }
 
+/**
+ * @brief Write out the buffered records as one compressed block and hand
+ * them to the OS, so they survive the GCS crashing
+ */
+void LogFile::flushRecords()
+{
+    QMutexLocker locker(&writeMutex);
+
+    if (writeBuffer.isEmpty() || !file.isWritable())
+        return;
+
+    LogBlock::Entry entry;
+    entry.offset = file.pos();
+    entry.firstTimestamp = bufferFirstTimestamp;
+    entry.lastTimestamp = bufferLastTimestamp;
+
+    QByteArray block;
+    LogBlock::append(block, writeBuffer, bufferFirstTimestamp, bufferLastTimestamp);
+
+    if (file.write(block) != block.size())
+        qDebug() << "Unable to write to " << file.fileName() << ": " << file.errorString();
+    else
+        blocks.append(entry);
+    file.flush();
+    writeBuffer.clear();
+}
+
 qint64 LogFile::readData(char *data, qint64 maxSize)
 {
     QMutexLocker locker(&mutex);
-    qint64 toRead = qMin(maxSize, (qint64)dataBuffer.size());
-    memcpy(data, dataBuffer.data(), toRead);
-    dataBuffer.remove(0, toRead);
-    return toRead;
+    return dataBuffer.read(data, maxSize);
 }
 
 qint64 LogFile::bytesAvailable() const
@@ -198,56 +336,358 @@ qint64 LogFile::bytesAvailable() const
 
 void LogFile::timerFired()
 {
-    qint64 dataSize;
+    if (!nextRecordReady()) {
+        stopReplay();
+        return;
+    }
 
-    if (file.bytesAvailable() > 4) {
+    int time;
+    time = myTime.elapsed();
 
-        int time;
-        time = myTime.elapsed();
+    const bool coalesce = playbackSpeed >= COALESCE_MIN_SPEED;
 
-        // Read packets
-        while ((lastPlayTime + ((time - lastPlayTimeOffset) * playbackSpeed)
-                > (lastTimeStamp - firstTimestamp))) {
-            lastPlayTime += ((time - lastPlayTimeOffset) * playbackSpeed);
-            if (file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
+    // Read packets
+    while ((lastPlayTime + ((time - lastPlayTimeOffset) * playbackSpeed)
+            > (index[replayIdx].timestamp - firstTimestamp))) {
+        lastPlayTime += ((time - lastPlayTimeOffset) * playbackSpeed);
 
-            file.seek(lastTimeStampPos + sizeof(lastTimeStamp));
+        const IndexEntry &entry = index[replayIdx];
+        lastTimeStamp = entry.timestamp;
 
-            file.read((char *)&dataSize, sizeof(dataSize));
+        qint64 dataSize = LogRecord::payloadSize(recordData + entry.offset, recordsChecked);
 
-            if (dataSize < 1 || dataSize > (1024 * 1024)) {
-                qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
-                stopReplay();
-                return;
-            }
-            if (file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
+        if (dataSize < 1 || dataSize > MAX_RECORD_SIZE) {
+            qDebug() << "Error: Logfile corrupted! Unlikely packet size: " << dataSize << "\n";
+            flushCoalesced();
+            stopReplay();
+            return;
+        }
+
+        const uchar *payload = recordData + entry.offset + LogRecord::HEADER_SIZE;
+        quint64 key;
+
+        if (coalesce && coalesceKey(payload, dataSize, &key)) {
+            QByteArray update((const char *)payload, dataSize);
+            QHash<quint64, int>::const_iterator slot = coalescedSlot.constFind(key);
+
+            if (slot != coalescedSlot.constEnd()) {
+                coalesced[slot.value()] = update;
+            } else {
+                coalescedSlot.insert(key, coalesced.size());
+                coalesced.append(update);
             }
+        } else {
+            // Keep the order with anything that isn't a plain update
+            flushCoalesced();
 
             mutex.lock();
-            dataBuffer.append(file.read(dataSize));
+            dataBuffer.append((const char *)payload, dataSize);
             mutex.unlock();
             emit readyRead();
+        }
 
-            if (file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
+        ++replayIdx;
+        if (!nextRecordReady()) {
+            flushCoalesced();
+            stopReplay();
+            return;
+        }
+
+        lastPlayTimeOffset = time;
+        time = myTime.elapsed();
+    }
+
+    flushCoalesced();
+}
+
+/**
+ * @brief Identify a record that is exactly one full object update, which
+ * a later update of the same object instance makes redundant. Partial
+ * updates, requests, acks and anything not framed one per record are
+ * always played.
+ * @param[in] data record payload
+ * @param[in] size payload size
+ * @param[out] key object and instance
+ * @return true if the record can be coalesced
+ */
+bool LogFile::coalesceKey(const uchar *data, qint64 size, quint64 *key)
+{
+    // UAVTalk framing, see uavtalk.h
+    static const quint8 SYNC_VAL = 0x3C;
+    static const int TYPE_MASK = 0x0f;
+    static const int TYPE_OBJ = 0x00;
+    static const int TYPE_OBJ_ACK = 0x02;
+    static const int MIN_HEADER_LENGTH = 8;
+    static const int CHECKSUM_LENGTH = 1;
+
+    if (size < MIN_HEADER_LENGTH + 2 + CHECKSUM_LENGTH || data[0] != SYNC_VAL)
+        return false;
+
+    int type = data[1] & TYPE_MASK;
+    if (type != TYPE_OBJ && type != TYPE_OBJ_ACK)
+        return false;
+
+    if (qFromLittleEndian<quint16>(data + 2) + CHECKSUM_LENGTH != size)
+        return false;
+
+    if (!objManager)
+        objManager = ExtensionSystem::PluginManager::instance()->getObject<UAVObjectManager>();
+
+    quint32 objId = qFromLittleEndian<quint32>(data + 4);
+    UAVObject *obj = objManager ? objManager->getObject(objId) : NULL;
+    if (!obj)
+        return false;
+
+    quint16 instId = 0;
+    if (!obj->isSingleInstance())
+        instId = qFromLittleEndian<quint16>(data + MIN_HEADER_LENGTH);
+
+    *key = ((quint64)instId << 32) | objId;
+
+    return true;
+}
+
+/**
+ * @brief Play the updates held back this tick
+ */
+void LogFile::flushCoalesced()
+{
+    if (coalesced.isEmpty())
+        return;
+
+    mutex.lock();
+    foreach (const QByteArray &update, coalesced)
+        dataBuffer.append(update.constData(), update.size());
+    mutex.unlock();
+
+    coalesced.clear();
+    coalescedSlot.clear();
+
+    emit readyRead();
+}
+
+/**
+ * @brief Name of the sidecar file caching the record index of the log
+ */
+QString LogFile::indexFileName() const
+{
+    return file.fileName() + ".idx";
+}
+
+/**
+ * @brief Load the record index from the sidecar file
+ * @param dataStart Offset of the first record, past the log header
+ * @param nonSequential Filled with the number of out of order timestamps
+ * @return True if a sidecar matching the log was loaded
+ */
+bool LogFile::loadIndex(qint64 dataStart, quint32 *nonSequential)
+{
+    QFile idxFile(indexFileName());
+    if (!idxFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QFileInfo logInfo(file);
+    QDataStream in(&idxFile);
+    quint32 magic, version, count;
+    qint64 logSize, logModified, start;
+
+    in >> magic >> version >> logSize >> logModified >> start >> *nonSequential >> count;
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION
+        || logSize != logInfo.size() || logModified != logInfo.lastModified().toMSecsSinceEpoch()
+        || start != dataStart || count > mapSize / LogRecord::HEADER_SIZE)
+        return false;
+
+    // Each entry must point at a whole record of the log, so replay can't
+    // run off the map
+    bool valid = true;
+    index.resize(count);
+    for (quint32 i = 0; i < count && valid; i++) {
+        IndexEntry entry;
+        in >> entry.timestamp >> entry.offset;
+
+        valid = entry.offset >= dataStart && entry.offset <= mapSize - LogRecord::HEADER_SIZE;
+        if (!valid)
+            break;
+
+        const uchar *header = mapData + entry.offset;
+        qint64 dataSize = LogRecord::payloadSize(header, recordsChecked);
+        valid = dataSize >= 1 && dataSize <= MAX_RECORD_SIZE
+            && dataSize <= mapSize - entry.offset - LogRecord::HEADER_SIZE
+            && qFromLittleEndian<quint32>(header) == entry.timestamp;
+
+        index[i] = entry;
+    }
+
+    if (!valid || in.status() != QDataStream::Ok) {
+        index.clear();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write the record index next to the log, so later replays needn't
+ * scan it. Failure (e.g. a read-only directory) is not an error.
+ */
+void LogFile::saveIndex(qint64 dataStart, quint32 nonSequential)
+{
+    QSaveFile idxFile(indexFileName());
+    if (!idxFile.open(QIODevice::WriteOnly))
+        return;
 
-            lastTimeStampPos = timestampPos[timestampBufferIdx];
-            lastTimeStamp = timestampBuffer[timestampBufferIdx];
-            timestampBufferIdx++;
+    QFileInfo logInfo(file);
+    QDataStream out(&idxFile);
+
+    out << (quint32)INDEX_MAGIC << (quint32)INDEX_VERSION << (qint64)logInfo.size()
+        << (qint64)logInfo.lastModified().toMSecsSinceEpoch() << dataStart << nonSequential
+        << (quint32)index.size();
+    foreach (const IndexEntry &entry, index)
+        out << entry.timestamp << entry.offset;
+
+    idxFile.commit();
+}
 
-            lastPlayTimeOffset = time;
-            time = myTime.elapsed();
+/**
+ * @brief Scan the mapped log for records
+ * @param dataStart Offset of the first record, past the log header
+ * @return Number of timestamps found out of order
+ */
+quint32 LogFile::buildIndex(qint64 dataStart)
+{
+    quint32 nonSequential = 0;
+    qint64 pos = dataStart;
+
+    index.clear();
+
+    // Legacy records have nothing but the six zero bytes at the top of
+    // their size to resync on, checked ones a sync word and a CRC
+    const qint64 maxSize = LogRecord::MAX_CHECKED_SIZE;
+
+    while (pos + LogRecord::HEADER_SIZE <= mapSize) {
+        IndexEntry entry;
+        qint64 dataSize;
+
+        LogRecord::Status status = LogRecord::parse(mapData + pos, mapSize - pos, recordsChecked,
+                                                    maxSize, &entry.timestamp, &dataSize);
+
+        // Truncated last record
+        if (status == LogRecord::RECORD_TRUNCATED && !recordsChecked)
+            break;
+
+        if (status != LogRecord::RECORD_OK) {
+            qint64 next = LogRecord::find(mapData, pos + 1, mapSize, recordsChecked, maxSize);
+            qDebug() << "Skipping" << next - pos << "corrupt bytes at file location 0x"
+                     << QString("%1").arg(pos, 0, 16);
+            pos = next;
+            continue;
         }
-    } else {
-        stopReplay();
+
+        // Check if timestamps are sequential.
+        if (!index.isEmpty() && entry.timestamp < index.last().timestamp) {
+            qDebug() << "Timestamp: " << index.last().timestamp << " " << entry.timestamp;
+            nonSequential++;
+        }
+
+        entry.offset = pos;
+        index.append(entry);
+
+        pos += LogRecord::HEADER_SIZE + dataSize;
+    }
+
+    return nonSequential;
+}
+
+/**
+ * @brief Find the blocks of a compressed log, from the index at its end
+ * or by walking them, and load the first
+ * @param dataStart Offset of the first block, past the log header
+ * @return Number of blocks starting before the previous one ended
+ */
+quint32 LogFile::loadBlocks(qint64 dataStart)
+{
+    quint32 nonSequential = 0;
+
+    if (!LogBlock::readIndex(mapData, dataStart, mapSize, blocks)) {
+        qint64 skipped = LogBlock::scan(mapData, dataStart, mapSize, blocks);
+        if (skipped > 0)
+            qDebug() << "Skipped" << skipped << "bytes of corrupt or incomplete blocks";
     }
+
+    for (int i = 1; i < blocks.size(); i++) {
+        if (blocks[i].firstTimestamp < blocks[i - 1].lastTimestamp) {
+            qDebug() << "Timestamp: " << blocks[i - 1].lastTimestamp << " "
+                     << blocks[i].firstTimestamp;
+            nonSequential++;
+        }
+    }
+
+    if (!blocks.isEmpty())
+        loadBlock(0);
+
+    return nonSequential;
+}
+
+/**
+ * @brief Decompress a block of the log and index its records
+ * @param block Block to load
+ * @return False if the block is corrupt, leaving the index empty
+ */
+bool LogFile::loadBlock(int block)
+{
+    const qint64 offset = blocks[block].offset;
+    qint64 size;
+
+    currentBlock = block;
+    index.clear();
+    blockData.clear();
+    recordData = NULL;
+
+    if (LogBlock::parse(mapData + offset, mapSize - offset, NULL, &size)
+        == LogRecord::RECORD_OK)
+        blockData = LogBlock::decompress(mapData + offset, size);
+
+    if (blockData.isEmpty()) {
+        qDebug() << "Skipping corrupt block at file location 0x"
+                 << QString("%1").arg(offset, 0, 16);
+        return false;
+    }
+
+    recordData = (const uchar *)blockData.constData();
+    qint64 pos = 0;
+    while (pos < blockData.size()) {
+        IndexEntry entry;
+        qint64 dataSize;
+
+        if (LogRecord::parse(recordData + pos, blockData.size() - pos, true,
+                             LogRecord::MAX_CHECKED_SIZE, &entry.timestamp, &dataSize)
+            != LogRecord::RECORD_OK)
+            break;
+
+        entry.offset = pos;
+        index.append(entry);
+        pos += LogRecord::HEADER_SIZE + dataSize;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Check that index[replayIdx] is a record to play, moving on to the
+ * next block of a compressed log once the current one is played out
+ * @return False at the end of the log
+ */
+bool LogFile::nextRecordReady()
+{
+    while (replayIdx >= index.size()) {
+        if (!blocksCompressed || currentBlock + 1 >= blocks.size())
+            return false;
+
+        loadBlock(currentBlock + 1);
+        replayIdx = 0;
+    }
+
+    return true;
 }
 
 bool LogFile::startReplay()
@@ -257,58 +697,52 @@ bool LogFile::startReplay()
     lastPlayTimeOffset = 0;
     lastPlayTime = 0;
     playbackSpeed = 1;
-
-    // Read all log timestamps into array
-    timestampBuffer.clear(); // Save beginning of log for later use
-    timestampPos.clear();
-    quint64 logFileStartIdx = file.pos();
-    timestampBufferIdx = 0;
     lastTimeStamp = 0;
+    replayIdx = 0;
 
-    while (!file.atEnd()) {
-        qint64 dataSize;
+    // The header has been consumed by open(), records start here
+    qint64 dataStart = file.pos();
 
-        // Get time stamp position
-        timestampPos.append(file.pos());
-
-        // Read timestamp and logfile packet size
-        file.read((char *)&lastTimeStamp, sizeof(lastTimeStamp));
-        file.read((char *)&dataSize, sizeof(dataSize));
-
-        // Check if dataSize sync bytes are correct.
-        // TODO: LIKELY AS NOT, THIS WILL FAIL TO RESYNC BECAUSE THERE IS TOO LITTLE INFORMATION IN
-        // THE STRING OF SIX 0x00
-        if ((dataSize & 0xFFFFFFFFFFFF0000) != 0) {
-            qDebug() << "Wrong sync byte. At file location 0x"
-                     << QString("%1").arg(file.pos(), 0, 16) << "Got 0x"
-                     << QString("%1").arg(dataSize & 0xFFFFFFFFFFFF0000, 0, 16)
-                     << ", but expected 0x"
-                        "00"
-                        ".";
-            file.seek(timestampPos.last() + 1);
-            timestampPos.pop_back();
-            continue;
-        }
+    mapSize = file.size();
+    mapData = file.map(0, mapSize);
+    if (mapData == NULL) {
+        qDebug() << "Unable to map " << file.fileName() << ": " << file.errorString();
+        mapSize = 0;
 
-        // Check if timestamps are sequential.
-        if (!timestampBuffer.isEmpty() && lastTimeStamp < timestampBuffer.last()) {
-            QMessageBox msgBox;
-            msgBox.setText("Corrupted file.");
-            msgBox.setInformativeText("Timestamps are not sequential. Playback may have unexpected "
-                                      "behavior"); //<--TODO: add hyperlink to webpage with better
-                                                   //description.
-            msgBox.exec();
+        QMessageBox msgBox;
+        msgBox.setText("Unable to read logfile.");
+        msgBox.setInformativeText(file.errorString());
+        msgBox.exec();
 
-            qDebug() << "Timestamp: " << timestampBuffer.last() << " " << lastTimeStamp;
-        }
+        stopReplay();
+        return false;
+    }
 
-        timestampBuffer.append(lastTimeStamp);
+    quint32 nonSequential = 0;
+    if (blocksCompressed) {
+        nonSequential = loadBlocks(dataStart);
+    } else {
+        // Use the sidecar index when it matches the log, build it otherwise
+        recordData = mapData;
+        if (!loadIndex(dataStart, &nonSequential)) {
+            nonSequential = buildIndex(dataStart);
+            if (!index.isEmpty())
+                saveIndex(dataStart, nonSequential);
+        }
+    }
 
-        file.seek(timestampPos.last() + sizeof(lastTimeStamp) + sizeof(dataSize) + dataSize);
+    if (nonSequential > 0) {
+        QMessageBox msgBox;
+        msgBox.setText("Corrupted file.");
+        msgBox.setInformativeText(QString("%1 timestamps are not sequential. Playback may have "
+                                          "unexpected behavior")
+                                      .arg(nonSequential)); //<--TODO: add hyperlink to webpage
+                                                            // with better description.
+        msgBox.exec();
     }
 
     // Check if any timestamps were successfully read
-    if (timestampBuffer.size() == 0) {
+    if (!nextRecordReady()) {
         QMessageBox msgBox;
         msgBox.setText("Empty logfile.");
         msgBox.setInformativeText("No log data can be found.");
@@ -318,12 +752,7 @@ bool LogFile::startReplay()
         return false;
     }
 
-    // Reset to log beginning.
-    file.seek(logFileStartIdx + sizeof(lastTimeStamp));
-    lastTimeStampPos = timestampPos[0];
-    lastTimeStamp = timestampBuffer[0];
-    firstTimestamp = timestampBuffer[0];
-    timestampBufferIdx = 1;
+    firstTimestamp = index[replayIdx].timestamp;
 
     timer.setInterval(10);
     timer.start();
@@ -351,20 +780,43 @@ void LogFile::resumeReplay()
 
 /**
  * @brief LogFile::setReplayTime, sets the playback time
- * @param val, the time in
+ * @param val, the time in seconds from the start of the log
  */
 void LogFile::setReplayTime(double val)
 {
-    quint32 tmpIdx = 0;
-    while (timestampBuffer[tmpIdx++] <= val * 1000 && tmpIdx <= timestampBufferIdx) {
+    if (blocksCompressed ? blocks.isEmpty() : index.isEmpty())
+        return;
+
+    IndexEntry target;
+    target.timestamp = firstTimestamp + (quint32)(val * 1000);
+
+    if (blocksCompressed) {
+        // Only the block holding the target time is decompressed
+        QVector<LogBlock::Entry>::const_iterator block =
+            std::lower_bound(blocks.constBegin(), blocks.constEnd(), target.timestamp,
+                             [](const LogBlock::Entry &a, quint32 timestamp) {
+                                 return a.lastTimestamp < timestamp;
+                             });
+        int blockIdx = qMin<int>(block - blocks.constBegin(), blocks.size() - 1);
+        if (blockIdx != currentBlock)
+            loadBlock(blockIdx);
     }
 
-    lastTimeStampPos = timestampPos[tmpIdx];
-    lastTimeStamp = timestampBuffer[tmpIdx];
-    timestampBufferIdx = tmpIdx;
+    QVector<IndexEntry>::const_iterator it =
+        std::lower_bound(index.constBegin(), index.constEnd(), target,
+                         [](const IndexEntry &a, const IndexEntry &b) {
+                             return a.timestamp < b.timestamp;
+                         });
+    replayIdx = it - index.constBegin();
+    if (!nextRecordReady()) {
+        if (index.isEmpty())
+            return;
+        replayIdx = index.size() - 1;
+    }
+    lastTimeStamp = index[replayIdx].timestamp;
 
     lastPlayTimeOffset = myTime.elapsed();
-    lastPlayTime = lastTimeStamp;
+    lastPlayTime = lastTimeStamp - firstTimestamp;
 
     qDebug() << "Replaying at: " << lastTimeStamp << ", but requestion at" << val * 1000;
 }
@@ -33,9 +33,30 @@
 #include <QMutexLocker>
 #include <QDebug>
 #include <QBuffer>
+#include <QVector>
+#include <QHash>
 #include "uavobjects/uavobjectmanager.h"
+#include "uavtalk/logblock.h"
 #include <math.h>
 
+/**
+ * Growable byte FIFO; reads consume from the front without moving data.
+ */
+class ReplayBuffer
+{
+public:
+    ReplayBuffer();
+    void clear();
+    qint64 size() const { return count; }
+    void append(const char *data, qint64 len);
+    qint64 read(char *data, qint64 maxLen);
+
+private:
+    QByteArray buf;
+    qint64 head;
+    qint64 count;
+};
+
 class LogFile : public QIODevice
 {
     Q_OBJECT
@@ -64,6 +85,7 @@ public slots:
 
 protected slots:
     void timerFired();
+    void flushRecords();
 
 signals:
     void readReady();
@@ -71,7 +93,7 @@ signals:
     void replayFinished();
 
 protected:
-    QByteArray dataBuffer;
+    ReplayBuffer dataBuffer;
     QTimer timer;
     QTime myTime;
     QFile file;
@@ -83,11 +105,56 @@ protected:
     double playbackSpeed;
 
 private:
-    QList<quint32> timestampBuffer;
-    QList<quint32> timestampPos;
-    quint32 timestampBufferIdx;
-    quint32 lastTimeStampPos;
+    // Records are laid out as described in uavtalk/logrecord.h, and new
+    // logs group them in compressed blocks, see uavtalk/logblock.h
+    static const qint64 MAX_RECORD_SIZE = 1024 * 1024;
+    // Records are compressed into a block once this many bytes are
+    // buffered, or at least this often, so a crash loses at most the last
+    // moments
+    static const int WRITE_BUFFER_SIZE = 64 * 1024;
+    static const int FLUSH_INTERVAL_MS = 2000;
+    // From this replay speed on, only the latest update of each object per
+    // timer tick is played; the display can't show the ones in between
+    static const int COALESCE_MIN_SPEED = 2;
+
+    QByteArray writeBuffer;
+    quint32 bufferFirstTimestamp;
+    quint32 bufferLastTimestamp;
+    QMutex writeMutex;
+    QTimer flushTimer;
+    bool recordsChecked; /** Whether the log being replayed has checked records */
+    bool blocksCompressed; /** Whether the log is split in compressed blocks */
+
+    QVector<LogBlock::Entry> blocks; /** Blocks written, or of the log replayed */
+    int currentBlock; /** Block whose records are in index */
+    QByteArray blockData; /** Decompressed records of currentBlock */
+
+    struct IndexEntry
+    {
+        quint32 timestamp;
+        qint64 offset; /** Offset of the record from recordData */
+    };
+
+    QVector<IndexEntry> index;
+    int replayIdx; /** Next record to play */
     quint32 firstTimestamp;
+    const uchar *mapData;
+    qint64 mapSize;
+    const uchar *recordData; /** What index offsets are relative to */
+
+    QString indexFileName() const;
+    bool loadIndex(qint64 dataStart, quint32 *nonSequential);
+    void saveIndex(qint64 dataStart, quint32 nonSequential);
+    quint32 buildIndex(qint64 dataStart);
+    quint32 loadBlocks(qint64 dataStart);
+    bool loadBlock(int block);
+    bool nextRecordReady();
+    bool coalesceKey(const uchar *data, qint64 size, quint64 *key);
+
+    UAVObjectManager *objManager;
+    QVector<QByteArray> coalesced; /** Updates held back this tick */
+    QHash<quint64, int> coalescedSlot; /** Where in coalesced an object is */
+    void flushCoalesced();
 };
 
 #endif // LOGFILE_H
@@ -17,7 +17,9 @@ HEADERS += loggingplugin.h \
     logginggadget.h \
     logginggadgetfactory.h \
     loggingdevice.h \
-    flightlogdownload.h
+    flightlogdownload.h \
+    flightlogqueue.h \
+    logmerger.h
 
 SOURCES += loggingplugin.cpp \
     logfile.cpp \
@@ -25,7 +27,9 @@ SOURCES += loggingplugin.cpp \
     logginggadget.cpp \
     logginggadgetfactory.cpp \
     loggingdevice.cpp \
-    flightlogdownload.cpp
+    flightlogdownload.cpp \
+    flightlogqueue.cpp \
+    logmerger.cpp
 
 OTHER_FILES += LoggingGadget.pluginspec
 
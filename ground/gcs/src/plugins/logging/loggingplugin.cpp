@@ -31,6 +31,8 @@
 #include "loggingdevice.h"
 #include "logginggadgetfactory.h"
 #include "flightlogdownload.h"
+#include "flightlogqueue.h"
+#include "logmerger.h"
 
 #include <QDebug>
 #include <QtPlugin>
@@ -38,8 +40,10 @@
 #include <QStringList>
 #include <QDir>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QList>
 #include <QErrorMessage>
+#include <QMessageBox>
 #include <QWriteLocker>
 
 #include <extensionsystem/pluginmanager.h>
@@ -145,10 +149,9 @@ bool LoggingThread::openFile(QString file, LoggingPlugin *parent)
 };
 
 /**
-  * Logs an object update to the file.  Data format is the
-  * timestamp as a 32 bit uint counting ms from start of
-  * file writing (flight time will be embedded in stream),
-  * then object packet size, then the packed UAVObject.
+  * Logs an object update to the file.  Each packet becomes a record
+  * timestamped in ms from the start of file writing (flight time will be
+  * embedded in stream), see LogRecord for the layout.
   */
 void LoggingThread::objectUpdated(UAVObject *obj)
 {
@@ -341,6 +344,26 @@ bool LoggingPlugin::initialize(const QStringList &args, QString *errMsg)
     ac->addAction(cmdDownload, "Logging");
     connect(cmdDownload->action(), SIGNAL(triggered(bool)), this, SLOT(downloadLog()));
 
+    // Command to download every log on the board in the background
+    cmdDownloadAll = am->registerAction(new QAction(this), "LoggingPlugin.DownloadAll",
+                                        QList<int>() << Core::Constants::C_GLOBAL_ID);
+    cmdDownloadAll->action()->setText("Download all logs...");
+    ac->addAction(cmdDownloadAll, "Logging");
+    connect(cmdDownloadAll->action(), SIGNAL(triggered(bool)), this, SLOT(downloadAllLogs()));
+
+    // Command to merge an on-board log into a GCS log of the same flight
+    cmdMerge = am->registerAction(new QAction(this), "LoggingPlugin.Merge",
+                                  QList<int>() << Core::Constants::C_GLOBAL_ID);
+    cmdMerge->action()->setText("Merge logs...");
+    ac->addAction(cmdMerge, "Logging");
+    connect(cmdMerge->action(), SIGNAL(triggered(bool)), this, SLOT(mergeLogs()));
+
+    logQueue = new FlightLogQueue(this);
+    logQueueDirectory = QDir::homePath();
+    connect(logQueue, SIGNAL(progress(int, int)), this, SLOT(logQueueProgress(int, int)));
+    connect(logQueue, SIGNAL(finished(int, int, int)), this,
+            SLOT(logQueueFinished(int, int, int)));
+
     mf = new LoggingGadgetFactory(this);
     addAutoReleasedObject(mf);
 
@@ -357,6 +380,90 @@ void LoggingPlugin::downloadLog()
     download.exec();
 }
 
+/**
+ * @brief LoggingPlugin::downloadAllLogs start fetching every log on the
+ * board into a directory, or stop the running queue after its current log
+ */
+void LoggingPlugin::downloadAllLogs()
+{
+    if (logQueue->isRunning()) {
+        logQueue->cancel();
+        cmdDownloadAll->action()->setText(tr("Stopping log download..."));
+        return;
+    }
+
+    QString directory = QFileDialog::getExistingDirectory(NULL, tr("Download all logs to..."),
+                                                          logQueueDirectory);
+    if (directory.isEmpty())
+        return;
+    logQueueDirectory = directory;
+
+    // Both share the telemetry file transfer
+    cmdDownload->action()->setEnabled(false);
+    cmdDownloadAll->action()->setText(tr("Stop log download"));
+    logQueue->start(directory);
+}
+
+/**
+ * @brief LoggingPlugin::mergeLogs ask for a GCS log and the on-board log
+ * of the same flight and write them merged into a single log
+ */
+void LoggingPlugin::mergeLogs()
+{
+    QString gcsLog = QFileDialog::getOpenFileName(NULL, tr("GCS log to merge"), QDir::homePath(),
+                                                  tr("Log (*.drlog)"));
+    if (gcsLog.isEmpty())
+        return;
+
+    QString onboardLog = QFileDialog::getOpenFileName(
+        NULL, tr("On-board log to merge"), QFileInfo(gcsLog).path(), tr("Log (*.drlog)"));
+    if (onboardLog.isEmpty())
+        return;
+
+    QString output = QFileDialog::getSaveFileName(
+        NULL, tr("Save merged log as..."),
+        QFileInfo(gcsLog).path() + QDir::separator() + QFileInfo(gcsLog).completeBaseName()
+            + "-merged.drlog",
+        tr("Log (*.drlog)"));
+    if (output.isEmpty())
+        return;
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    LogMerger merger(pm->getObject<UAVObjectManager>());
+
+    if (!merger.merge(gcsLog, onboardLog, output)) {
+        QMessageBox::warning(NULL, tr("Merge logs"), merger.errorString());
+        return;
+    }
+
+    QString alignment = merger.matchCount()
+        ? tr("Clocks aligned on %0 updates found in both logs.").arg(merger.matchCount())
+        : tr("No update was found in both logs, they were aligned by their first objects.");
+    QMessageBox::information(NULL, tr("Merge logs"),
+                             tr("%0 objects written. %1").arg(merger.frameCount()).arg(alignment));
+}
+
+void LoggingPlugin::logQueueProgress(int index, int count)
+{
+    if (logQueue->isRunning())
+        cmdDownloadAll->action()->setText(tr("Stop log download (%0/%1)").arg(index).arg(count));
+}
+
+void LoggingPlugin::logQueueFinished(int downloaded, int skipped, int failed)
+{
+    cmdDownload->action()->setEnabled(true);
+    cmdDownloadAll->action()->setText(tr("Download all logs..."));
+
+    // Not modal, the other gadgets may be in use
+    QMessageBox *box = new QMessageBox(QMessageBox::Information, tr("Log download"),
+                                       tr("%0 logs downloaded, %1 already present, %2 failed.")
+                                           .arg(downloaded)
+                                           .arg(skipped)
+                                           .arg(failed));
+    box->setAttribute(Qt::WA_DeleteOnClose);
+    box->show();
+}
+
 /**
   * The action that is triggered by the menu item which opens the
   * file and begins logging if successful
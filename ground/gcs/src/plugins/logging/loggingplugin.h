@@ -43,6 +43,7 @@
 
 class LoggingPlugin;
 class LoggingGadgetFactory;
+class FlightLogQueue;
 
 /**
 *   Define a connection via the IConnection interface
@@ -136,6 +137,10 @@ protected:
 
 private slots:
     void downloadLog();
+    void downloadAllLogs();
+    void mergeLogs();
+    void logQueueProgress(int index, int count);
+    void logQueueFinished(int downloaded, int skipped, int failed);
     void toggleLogging();
     void startLogging(QString file);
     void stopLogging();
@@ -147,6 +152,10 @@ private:
     LoggingGadgetFactory *mf;
     Core::Command *cmdLogging;
     Core::Command *cmdDownload;
+    Core::Command *cmdDownloadAll;
+    Core::Command *cmdMerge;
+    FlightLogQueue *logQueue;
+    QString logQueueDirectory;
 };
 #endif /* LoggingPLUGIN_H_ */
 /**
@@ -0,0 +1,527 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logmerger.cpp
+ * @author     dRonin, http://dronin.org Copyright (C) 2016
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Merges on-board and GCS logs of the same flight
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+#include "logmerger.h"
+
+#include "uavobjects/uavobjectmanager.h"
+#include "uavtalk/uavtalk.h"
+#include "uavtalk/logrecord.h"
+#include "uavtalk/logblock.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <cstring>
+
+LogMerger::LogMerger(UAVObjectManager *objMngr)
+    : objMngr(objMngr)
+    , offset(0)
+    , matches(0)
+    , frames(0)
+{
+}
+
+bool LogMerger::merge(const QString &gcsLogName, const QString &onboardLogName,
+                      const QString &outputName)
+{
+    error.clear();
+    frames = 0;
+
+    if (!estimateOffset(gcsLogName, onboardLogName))
+        return false;
+
+    GcsSource gcs(this, gcsLogName);
+    OnboardSource onboard(this, onboardLogName);
+    if (!gcs.open() || !onboard.open()) {
+        error = QString("Unable to read the logs");
+        return false;
+    }
+
+    QSaveFile out(outputName);
+    if (!out.open(QIODevice::WriteOnly)) {
+        error = out.errorString();
+        return false;
+    }
+
+    // The merged log replays as a GCS log, on the GCS clock
+    out.write(gcs.header);
+    out.write(LogRecord::headerTag() + "\n##\n");
+
+    Source *sources[] = { &gcs, &onboard };
+    const qint64 shift[] = { 0, offset };
+    const int numSources = sizeof(sources) / sizeof(sources[0]);
+
+    Frame heads[numSources];
+    typedef std::pair<qint64, int> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head> > heap;
+
+    for (int i = 0; i < numSources; i++) {
+        if (sources[i]->next(heads[i])) {
+            heads[i].time += shift[i];
+            heap.push(Head(heads[i].time, i));
+        }
+    }
+
+    // Records are unsigned, so start at the earliest frame of either log
+    const qint64 base = heap.empty() ? 0 : heap.top().first;
+    qint64 lastTime = 0;
+    QByteArray record;
+
+    while (!heap.empty()) {
+        const int i = heap.top().second;
+        heap.pop();
+
+        Frame &frame = heads[i];
+        if (frame.data.at(1) & TYPE_TIMESTAMPED)
+            stripTimestamp(frame.data);
+
+        // On-board timestamps may step back a little, keep the log sequential
+        lastTime = qMax(lastTime, frame.time - base);
+        record.clear();
+        LogRecord::append(record, lastTime, frame.data.constData(), frame.data.size());
+        out.write(record);
+        frames++;
+
+        if (sources[i]->next(frame)) {
+            frame.time += shift[i];
+            heap.push(Head(frame.time, i));
+        }
+    }
+
+    if (!out.commit()) {
+        error = out.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief LogMerger::estimateOffset find the offset between the on-board
+ * and GCS clocks from updates present in both logs
+ * @return false if either log has no frames
+ */
+bool LogMerger::estimateOffset(const QString &gcsLogName, const QString &onboardLogName)
+{
+    OnboardSource onboard(this, onboardLogName);
+    GcsSource gcs(this, gcsLogName);
+
+    if (!onboard.open()) {
+        error = QString("Unable to open %0").arg(onboardLogName);
+        return false;
+    }
+    if (!gcs.open()) {
+        error = QString("%0 is not a GCS log").arg(gcsLogName);
+        return false;
+    }
+
+    // A value is only looked up in the GCS log if it was logged on board
+    // once, and only changes are kept, as an object logged at a fixed rate
+    // repeats its value. -1 marks values seen more than once.
+    QHash<quint64, qint64> onboardTimes;
+    QHash<quint32, quint64> lastValue;
+    QHash<quint32, qint64> lastKept;
+    qint64 onboardFirst = -1;
+    Frame frame;
+
+    while (onboard.next(frame)) {
+        const quint8 *in = (const quint8 *)frame.data.constData();
+        if (onboardFirst < 0)
+            onboardFirst = frame.time;
+        if ((in[1] & TYPE_MASK) != TYPE_OBJ)
+            continue;
+
+        const quint32 objId = qFromLittleEndian<quint32>(in + 4);
+        const quint64 value = fingerprint(in, frame.data.size() - 1);
+        if (lastValue.contains(objId) && lastValue.value(objId) == value)
+            continue;
+        lastValue.insert(objId, value);
+
+        if (onboardTimes.contains(value)) {
+            onboardTimes.insert(value, -1);
+        } else if (onboardTimes.size() < MAX_FINGERPRINTS
+                   && frame.time - lastKept.value(objId, -FINGERPRINT_PERIOD_MS)
+                       >= FINGERPRINT_PERIOD_MS) {
+            // Spread the table over the flight rather than fill it with
+            // the first seconds of the fast objects
+            onboardTimes.insert(value, frame.time);
+            lastKept.insert(objId, frame.time);
+        }
+    }
+
+    QVector<qint64> delays;
+    qint64 gcsFirst = -1;
+
+    while (gcs.next(frame)) {
+        const quint8 *in = (const quint8 *)frame.data.constData();
+        if (gcsFirst < 0)
+            gcsFirst = frame.time;
+
+        const quint8 type = in[1] & TYPE_MASK;
+        if ((type != TYPE_OBJ && type != TYPE_OBJ_ACK) || delays.size() >= MAX_MATCHES)
+            continue;
+
+        qint64 time = onboardTimes.value(fingerprint(in, frame.data.size() - 1), -1);
+        if (time >= 0)
+            delays.append(frame.time - time);
+    }
+
+    if (onboardFirst < 0 || gcsFirst < 0) {
+        error = QString("No objects found in %0").arg(onboardFirst < 0 ? onboardLogName : gcsLogName);
+        return false;
+    }
+
+    matches = delays.size();
+    if (delays.isEmpty()) {
+        offset = gcsFirst - onboardFirst;
+        return true;
+    }
+
+    // Values sent again later, or that happen to repeat, give scattered
+    // delays; the first reception of each change clusters just above the
+    // true offset
+    std::sort(delays.begin(), delays.end());
+    int best = 0;
+    int bestCount = 0;
+    for (int start = 0, end = 0; start < delays.size(); start++) {
+        while (end < delays.size() && delays[end] - delays[start] < CLUSTER_WIDTH_MS)
+            end++;
+        if (end - start > bestCount) {
+            bestCount = end - start;
+            best = start;
+        }
+    }
+    offset = delays[best];
+
+    return true;
+}
+
+bool LogMerger::isSingleInstance(quint32 objId)
+{
+    if (!singleInstance.contains(objId)) {
+        UAVObject *obj = objMngr ? objMngr->getObject(objId) : NULL;
+        // Unknown objects can't be told apart, most are single instance
+        singleInstance.insert(objId, obj ? obj->isSingleInstance() : true);
+    }
+
+    return singleInstance.value(objId);
+}
+
+//! Offset of the timestamp, right after the object and instance ids
+int LogMerger::timestampOffset(const quint8 *frame)
+{
+    return isSingleInstance(qFromLittleEndian<quint32>(frame + 4)) ? MIN_OBJECT_LENGTH
+                                                                    : MIN_OBJECT_LENGTH + 2;
+}
+
+/**
+ * @brief LogMerger::fingerprint hash of the object, instance and data of
+ * a frame, leaving out the type and any timestamp so the same update
+ * matches in both logs
+ */
+quint64 LogMerger::fingerprint(const quint8 *frame, int length)
+{
+    const int stampStart = timestampOffset(frame);
+    const int stampEnd = (frame[1] & TYPE_TIMESTAMPED) ? stampStart + 2 : stampStart;
+
+    quint64 hash = Q_UINT64_C(14695981039346656037);
+    for (int i = HEADER_LENGTH; i < length; i++) {
+        if (i >= stampStart && i < stampEnd)
+            continue;
+        hash = (hash ^ frame[i]) * Q_UINT64_C(1099511628211);
+    }
+
+    return hash;
+}
+
+//! Turn a timestamped frame into a plain one, the record has the time
+void LogMerger::stripTimestamp(QByteArray &frame)
+{
+    const int stamp = timestampOffset((const quint8 *)frame.constData());
+    if (stamp + 2 >= frame.size())
+        return;
+
+    frame.remove(stamp, 2);
+    const int length = frame.size() - 1;
+    quint8 *out = (quint8 *)frame.data();
+    out[1] &= ~TYPE_TIMESTAMPED;
+    out[2] = length & 0xFF;
+    out[3] = (length >> 8) & 0xFF;
+    out[length] = UAVTalk::updateCRC(0, out, length);
+}
+
+LogMerger::Source::Source(LogMerger *merger, const QString &fileName)
+    : merger(merger)
+    , file(fileName)
+    , pos(0)
+{
+}
+
+bool LogMerger::Source::open()
+{
+    buffer.clear();
+    pos = 0;
+    return file.open(QIODevice::ReadOnly) && skipHeader();
+}
+
+/**
+ * @brief LogMerger::Source::next scan for the next complete frame
+ * @return false at the end of the log
+ */
+bool LogMerger::Source::next(Frame &frame)
+{
+    forever {
+        const quint8 *in = (const quint8 *)buffer.constData() + pos;
+        const int avail = buffer.size() - pos;
+
+        if (avail >= HEADER_LENGTH && in[0] != SYNC_VAL) {
+            const void *sync = memchr(in, SYNC_VAL, avail);
+            pos = sync ? (const char *)sync - buffer.constData() : buffer.size();
+            continue;
+        }
+
+        if (avail >= HEADER_LENGTH) {
+            const int length = in[2] | (in[3] << 8);
+
+            if (length < MIN_OBJECT_LENGTH || length >= MAX_PACKET_LENGTH
+                || (in[1] & ~(TYPE_TIMESTAMPED | TYPE_MASK)) != TYPE_VER) {
+                pos++;
+                continue;
+            }
+
+            if (length < avail) {
+                // A sync value inside other data fails the CRC
+                if (UAVTalk::updateCRC(0, in, length) != in[length]) {
+                    pos++;
+                    continue;
+                }
+
+                frame.time = frameTime(in, length);
+                frame.data = QByteArray((const char *)in, length + 1);
+                pos += length + 1;
+                return true;
+            }
+        }
+
+        buffer.remove(0, pos);
+        pos = 0;
+        if (!readMore())
+            return false;
+    }
+}
+
+//! Everything up to the "##" line written by LogFile
+bool LogMerger::GcsSource::skipHeader()
+{
+    header.clear();
+    recordsChecked = false;
+    blocksCompressed = false;
+    block.clear();
+    blockPos = 0;
+    for (int i = 0; i < 13 && !file.atEnd(); i++) {
+        QByteArray line = file.readLine();
+        if (line.trimmed() == "##")
+            return true;
+        if (line.trimmed() == LogRecord::headerTag())
+            recordsChecked = true;
+        else if (line.trimmed() == LogBlock::headerTag())
+            blocksCompressed = true;
+        else
+            header.append(line);
+    }
+
+    return false;
+}
+
+/**
+ * @brief LogMerger::GcsSource::readMore one record, as written by
+ * LogFile::writeData(). A corrupted checked record is skipped by
+ * scanning on one byte at a time.
+ */
+bool LogMerger::GcsSource::readMore()
+{
+    if (blocksCompressed)
+        return readBlockRecord();
+
+    forever {
+        const qint64 start = file.pos();
+        QByteArray record = file.read(LogRecord::HEADER_SIZE);
+        if (record.size() != LogRecord::HEADER_SIZE)
+            return false;
+
+        qint64 dataSize = LogRecord::payloadSize((const uchar *)record.constData(), recordsChecked);
+        if (dataSize > 0 && dataSize <= READ_CHUNK)
+            record.append(file.read(dataSize));
+
+        quint32 timeStamp;
+        LogRecord::Status status =
+            LogRecord::parse((const uchar *)record.constData(), record.size(), recordsChecked,
+                             READ_CHUNK, &timeStamp, &dataSize);
+
+        if (status == LogRecord::RECORD_OK) {
+            recordTime = timeStamp;
+            buffer.append(record.constData() + LogRecord::HEADER_SIZE, dataSize);
+            return true;
+        }
+
+        if (!recordsChecked || !file.seek(start + 1))
+            return false;
+    }
+}
+
+/**
+ * @brief LogMerger::GcsSource::readBlockRecord one record of a compressed
+ * log, decompressing the next block once the current one is used up
+ */
+bool LogMerger::GcsSource::readBlockRecord()
+{
+    forever {
+        if (blockPos >= block.size()) {
+            if (!readBlock())
+                return false;
+            continue;
+        }
+
+        const uchar *records = (const uchar *)block.constData();
+        quint32 timeStamp;
+        qint64 dataSize;
+
+        if (LogRecord::parse(records + blockPos, block.size() - blockPos, true,
+                             LogRecord::MAX_CHECKED_SIZE, &timeStamp, &dataSize)
+            == LogRecord::RECORD_OK) {
+            recordTime = timeStamp;
+            buffer.append((const char *)records + blockPos + LogRecord::HEADER_SIZE, dataSize);
+            blockPos += LogRecord::HEADER_SIZE + dataSize;
+            return true;
+        }
+
+        blockPos = LogRecord::find(records, blockPos + 1, block.size(), true,
+                                   LogRecord::MAX_CHECKED_SIZE);
+    }
+}
+
+/**
+ * @brief LogMerger::GcsSource::readBlock decompress the next good block,
+ * scanning on one byte at a time past corrupted ones
+ * @return false once the blocks are used up
+ */
+bool LogMerger::GcsSource::readBlock()
+{
+    block.clear();
+    blockPos = 0;
+
+    forever {
+        const qint64 start = file.pos();
+        QByteArray data = file.read(LogBlock::HEADER_SIZE);
+        const uchar *bytes = (const uchar *)data.constData();
+        if (data.size() != LogBlock::HEADER_SIZE || LogBlock::isIndex(bytes, data.size()))
+            return false;
+
+        qint64 size = LogBlock::compressedSize(bytes);
+        if (qFromLittleEndian<quint32>(bytes) == LogBlock::BLOCK_SYNC && size > 0
+            && size <= LogBlock::MAX_COMPRESSED_SIZE) {
+            data.append(file.read(size));
+            bytes = (const uchar *)data.constData();
+
+            if (LogBlock::parse(bytes, data.size(), NULL, &size) == LogRecord::RECORD_OK) {
+                block = LogBlock::decompress(bytes, size);
+                if (!block.isEmpty())
+                    return true;
+                continue;
+            }
+        }
+
+        if (!file.seek(start + 1))
+            return false;
+    }
+}
+
+//! Frames are timed by the record that completed them
+qint64 LogMerger::GcsSource::frameTime(const quint8 *frame, int length)
+{
+    Q_UNUSED(frame);
+    Q_UNUSED(length);
+
+    return recordTime;
+}
+
+//! The text lines written by the firmware's writeHeader()
+bool LogMerger::OnboardSource::skipHeader()
+{
+    if (!file.readLine().startsWith("dRonin git hash")) {
+        file.seek(0);
+        return true;
+    }
+
+    file.readLine();
+    file.readLine();
+    return true;
+}
+
+bool LogMerger::OnboardSource::readMore()
+{
+    QByteArray data = file.read(READ_CHUNK);
+    if (data.isEmpty())
+        return false;
+
+    buffer.append(data);
+    return true;
+}
+
+/**
+ * @brief LogMerger::OnboardSource::frameTime unwrap the 16 bit timestamp
+ * of a frame. Frames may be logged a little out of order, so up to a
+ * second backwards is taken as such rather than as a wrap.
+ */
+qint64 LogMerger::OnboardSource::frameTime(const quint8 *frame, int length)
+{
+    if (!(frame[1] & TYPE_TIMESTAMPED))
+        return time;
+
+    const int at = merger->timestampOffset(frame);
+    if (at + 2 > length)
+        return time;
+
+    const int stamp = frame[at] | (frame[at + 1] << 8);
+    if (lastStamp < 0) {
+        time = stamp;
+    } else {
+        const int delta = (stamp - lastStamp) & 0xFFFF;
+        time += (delta > 0xFFFF - 1000) ? delta - 0x10000 : delta;
+    }
+    lastStamp = stamp;
+
+    return time;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,191 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logmerger.h
+ * @author     dRonin, http://dronin.org Copyright (C) 2016
+ * @see        The GNU Public License (GPL) Version 3
+ * @brief      Merges on-board and GCS logs of the same flight
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup   Logging
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+#ifndef LOGMERGER_H
+#define LOGMERGER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QHash>
+#include <QVector>
+
+class UAVObjectManager;
+
+/**
+ * @brief Merges a GCS log (.drlog written by LoggingDevice) and a log
+ * downloaded from the on-board flash into one time ordered GCS log.
+ *
+ * On-board frames carry the 16 bit millisecond timestamp of
+ * UAVTalkSendObjectTimestamped(), which is unwrapped into a running
+ * flight controller time. GCS frames carry the time they were received.
+ * The offset between the two clocks is estimated from object updates
+ * found in both logs: the smallest delay in the densest cluster of delays
+ * is taken as the offset, as it is the one with the least link latency.
+ *
+ * Both logs are read twice as streams, once to estimate the offset and
+ * once for a k-way merge of their frames, so neither is held in memory.
+ */
+class LogMerger
+{
+public:
+    explicit LogMerger(UAVObjectManager *objMngr);
+
+    /**
+     * @brief Merge two logs into a new GCS log
+     * @param gcsLogName log recorded by the GCS
+     * @param onboardLogName log downloaded from the flight controller
+     * @param outputName merged log to write
+     * @return true on success, errorString() tells why not otherwise
+     */
+    bool merge(const QString &gcsLogName, const QString &onboardLogName, const QString &outputName);
+
+    QString errorString() const { return error; }
+    //! GCS time minus on-board time, in ms
+    qint64 clockOffset() const { return offset; }
+    //! Number of updates the offset was estimated from, 0 if the logs
+    //! were aligned by their first frames instead
+    int matchCount() const { return matches; }
+    quint32 frameCount() const { return frames; }
+
+private:
+    struct Frame
+    {
+        qint64 time;
+        QByteArray data;
+    };
+
+    /**
+     * @brief Reads the UAVTalk frames of a log one by one. Subclasses
+     * provide the bytes; only frames with a good CRC are returned.
+     */
+    class Source
+    {
+    public:
+        Source(LogMerger *merger, const QString &fileName);
+        virtual ~Source() {}
+        bool open();
+        bool next(Frame &frame);
+        //! Time of the frame in this source's clock
+        virtual qint64 frameTime(const quint8 *frame, int length) = 0;
+
+    protected:
+        virtual bool skipHeader() = 0;
+        //! Append more of the UAVTalk stream to buffer, false at the end
+        virtual bool readMore() = 0;
+
+        LogMerger *merger;
+        QFile file;
+        QByteArray buffer;
+        int pos;
+    };
+
+    class GcsSource : public Source
+    {
+    public:
+        GcsSource(LogMerger *merger, const QString &fileName)
+            : Source(merger, fileName)
+            , recordsChecked(false)
+            , blocksCompressed(false)
+            , blockPos(0)
+            , recordTime(0)
+        {
+        }
+        qint64 frameTime(const quint8 *frame, int length);
+        //! Header lines before the "##" separator, other than the format tags
+        QByteArray header;
+
+    protected:
+        bool skipHeader();
+        bool readMore();
+
+    private:
+        bool readBlockRecord();
+        bool readBlock();
+
+        bool recordsChecked;
+        bool blocksCompressed;
+        QByteArray block; /** Decompressed records of a compressed log */
+        int blockPos;
+        qint64 recordTime;
+    };
+
+    class OnboardSource : public Source
+    {
+    public:
+        OnboardSource(LogMerger *merger, const QString &fileName)
+            : Source(merger, fileName)
+            , lastStamp(-1)
+            , time(0)
+        {
+        }
+        qint64 frameTime(const quint8 *frame, int length);
+
+    protected:
+        bool skipHeader();
+        bool readMore();
+
+    private:
+        int lastStamp;
+        qint64 time;
+    };
+
+    bool estimateOffset(const QString &gcsLogName, const QString &onboardLogName);
+    bool isSingleInstance(quint32 objId);
+    int timestampOffset(const quint8 *frame);
+    quint64 fingerprint(const quint8 *frame, int length);
+    void stripTimestamp(QByteArray &frame);
+
+    static const quint8 SYNC_VAL = 0x3C;
+    static const quint8 TYPE_VER = 0x20;
+    static const quint8 TYPE_MASK = 0x0F;
+    static const quint8 TYPE_OBJ = 0x00;
+    static const quint8 TYPE_OBJ_ACK = 0x02;
+    static const quint8 TYPE_TIMESTAMPED = 0x80;
+    static const int HEADER_LENGTH = 4; // sync(1), type(1), size(2)
+    static const int MIN_OBJECT_LENGTH = 8; // header, object ID(4)
+    static const int MAX_PACKET_LENGTH = 256;
+    static const int READ_CHUNK = 64 * 1024;
+    static const int MAX_FINGERPRINTS = 65536;
+    static const qint64 FINGERPRINT_PERIOD_MS = 100;
+    static const int MAX_MATCHES = 16384;
+    static const qint64 CLUSTER_WIDTH_MS = 1000;
+
+    UAVObjectManager *objMngr;
+    QHash<quint32, bool> singleInstance;
+    QString error;
+    qint64 offset;
+    int matches;
+    quint32 frames;
+};
+
+#endif // LOGMERGER_H
+
+/**
+ * @}
+ * @}
+ */
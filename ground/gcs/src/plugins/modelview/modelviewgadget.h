@@ -46,6 +46,7 @@ public:
 
     QWidget *widget() { return m_widget; }
     void loadConfiguration(IUAVGadgetConfiguration *config);
+    void setActive(bool active);
 
 private:
     ModelViewGadgetWidget *m_widget;
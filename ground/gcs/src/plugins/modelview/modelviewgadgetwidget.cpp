@@ -34,6 +34,7 @@
 #include "glc_lib/glc_openglexception.h"
 #include "glc_lib/viewport/glc_userinput.h"
 
+#include <QFileInfo>
 #include <iostream>
 
 // Model 3d object and background image used when specific one isn't available
@@ -41,14 +42,26 @@ const QString ModelViewGadgetWidget::fallbackAcFilename =
     QString(":/modelview/models/warning_sign.obj");
 const QString ModelViewGadgetWidget::fallbackBgFilename = QString(":/modelview/models/black.jpg");
 
+QHash<QString, ModelViewGadgetWidget::CachedWorld> ModelViewGadgetWidget::worldCache;
+QList<ModelViewGadgetWidget *> ModelViewGadgetWidget::instances;
+
+static QGLFormat modelViewFormat()
+{
+    QGLFormat format(QGL::SampleBuffers);
+    format.setSwapInterval(1);
+    return format;
+}
+
 ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
-    : QGLWidget(new GLC_Context(QGLFormat(QGL::SampleBuffers)), parent)
+    : QGLWidget(new GLC_Context(modelViewFormat()), parent,
+                instances.isEmpty() ? Q_NULLPTR : instances.first())
     , m_Light()
     , m_World()
     , m_GlView()
     , m_MoverController()
     , m_ModelBoundingBox()
-    , m_MotionTimer()
+    , m_FrameTimer()
+    , m_SampleInterval(MAX_SAMPLE_INTERVAL_MS)
     , acFilename(fallbackAcFilename)
     , bgFilename(fallbackBgFilename)
     , vboEnable(false)
@@ -67,18 +80,31 @@ ModelViewGadgetWidget::ModelViewGadgetWidget(QWidget *parent)
     repColor.setRgbF(1.0, 0.11372, 0.11372, 0.0);
     m_MoverController = GLC_Factory::instance()->createDefaultMoverController(repColor, &m_GlView);
 
+    instances.append(this);
     CreateScene();
     // Get required UAVObjects
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
     attState = AttitudeActual::GetInstance(objManager);
 
-    connect(&m_MotionTimer, &QTimer::timeout, this,
-            QOverload<>::of(&ModelViewGadgetWidget::updateAttitude));
+    // Only runs while the model is moving towards the last attitude
+    m_FrameTimer.setTimerType(Qt::PreciseTimer);
+    m_FrameTimer.setInterval(FRAME_PERIOD_MS);
+    connect(&m_FrameTimer, &QTimer::timeout, this, &ModelViewGadgetWidget::renderFrame);
+    connect(attState, &UAVObject::objectUpdated, this, &ModelViewGadgetWidget::attitudeUpdated);
+    attitudeUpdated();
 }
 
 ModelViewGadgetWidget::~ModelViewGadgetWidget()
 {
+    instances.removeOne(this);
+
+    // The last one out frees the models, while a context that has them is current
+    if (instances.isEmpty()) {
+        makeCurrent();
+        m_World = GLC_World();
+        worldCache.clear();
+    }
 }
 
 void ModelViewGadgetWidget::setAcFilename(QString acf)
@@ -113,6 +139,22 @@ void ModelViewGadgetWidget::reloadScene()
     CreateScene();
 }
 
+/**
+ * @brief Follow the attitude only while the gadget's workspace is shown
+ */
+void ModelViewGadgetWidget::setActive(bool active)
+{
+    if (active) {
+        connect(attState, &UAVObject::objectUpdated, this,
+                &ModelViewGadgetWidget::attitudeUpdated, Qt::UniqueConnection);
+        attitudeUpdated();
+    } else {
+        disconnect(attState, &UAVObject::objectUpdated, this,
+                   &ModelViewGadgetWidget::attitudeUpdated);
+        m_FrameTimer.stop();
+    }
+}
+
 //// Private functions ////
 void ModelViewGadgetWidget::initializeGL()
 {
@@ -131,7 +173,6 @@ void ModelViewGadgetWidget::initializeGL()
     // Enable antialiasing
     glEnable(GL_MULTISAMPLE);
 
-    m_MotionTimer.start(100);
     setFocusPolicy(Qt::StrongFocus); // keyboard capture for camera switching
 }
 
@@ -159,6 +200,9 @@ void ModelViewGadgetWidget::paintGL()
         // Calculate camera depth of view
         m_GlView.setDistMinAndMax(m_World.boundingBox());
 
+        // The model may be shared with other gadgets, put it in our pose
+        applyPose();
+
         // define view matrix
         m_GlView.glExecuteCam();
         m_Light.glExecute();
@@ -203,8 +247,22 @@ void ModelViewGadgetWidget::CreateScene()
 
     try {
         if (QFile::exists(acFilename)) {
-            QFile aircraft(acFilename);
-            m_World = GLC_Factory::instance()->createWorldFromFile(aircraft);
+            // Models are only shared within the group of contexts sharing resources
+            bool shared = instances.first() == this || isSharing();
+            QDateTime modified = QFileInfo(acFilename).lastModified();
+            QHash<QString, CachedWorld>::const_iterator cached = worldCache.constFind(acFilename);
+
+            if (shared && cached != worldCache.constEnd() && cached->modified == modified) {
+                m_World = cached->world;
+            } else {
+                QFile aircraft(acFilename);
+                m_World = GLC_Factory::instance()->createWorldFromFile(aircraft);
+                if (shared) {
+                    CachedWorld entry = { m_World, modified };
+                    worldCache.insert(acFilename, entry);
+                }
+            }
+            m_World.collection()->setVboUsage(vboEnable);
             m_ModelBoundingBox = m_World.boundingBox();
             m_GlView.reframe(m_ModelBoundingBox); // center 3D model in the scene
         } else {
@@ -233,7 +291,7 @@ void ModelViewGadgetWidget::mousePressEvent(QMouseEvent *e)
 
     switch (e->button()) {
     case (Qt::LeftButton):
-        m_MotionTimer.stop();
+        m_FrameTimer.stop();
         m_MoverController.setActiveMover(GLC_MoverController::TurnTable, userInput);
         updateGL();
         break;
@@ -266,7 +324,7 @@ void ModelViewGadgetWidget::mouseReleaseEvent(QMouseEvent *)
         return;
     }
     m_MoverController.setNoMover();
-    m_MotionTimer.start();
+    m_FrameTimer.start();
     updateGL();
 }
 
@@ -324,18 +382,58 @@ void ModelViewGadgetWidget::keyPressEvent(QKeyEvent *e) // switch between camera
 //////////////////////////////////////////////////////////////////////
 // Private slots Functions
 //////////////////////////////////////////////////////////////////////
-void ModelViewGadgetWidget::updateAttitude()
+void ModelViewGadgetWidget::attitudeUpdated()
 {
     AttitudeActual::DataFields data = attState->getData(); // get attitude data
-    GLC_StructOccurence *rootObject = m_World.rootOccurence(); // get the full 3D model
-    double x = data.q3;
-    double y = data.q2;
-    double z = data.q4;
     double w = data.q1;
 
     if (w == 0.0) {
         w = 1.0;
     }
+    QQuaternion sample(w, data.q3, data.q2, data.q4);
+    if (qFuzzyCompare(sample, m_ToPose)) {
+        return;
+    }
+
+    // Ease from where the model is to the new attitude over the time it took to come
+    if (m_SampleClock.isValid()) {
+        m_SampleInterval =
+            qBound(MIN_SAMPLE_INTERVAL_MS, (int)m_SampleClock.restart(), MAX_SAMPLE_INTERVAL_MS);
+    } else {
+        m_SampleClock.start();
+    }
+    m_FromPose = m_Pose;
+    m_ToPose = sample;
+
+    // While the camera is dragged, the model stays put
+    if (!m_MoverController.hasActiveMover() && !m_FrameTimer.isActive()) {
+        m_FrameTimer.start();
+    }
+}
+
+void ModelViewGadgetWidget::renderFrame()
+{
+    qreal t = qMin(1.0, m_SampleClock.elapsed() / (qreal)m_SampleInterval);
+    QQuaternion pose = QQuaternion::slerp(m_FromPose, m_ToPose, t);
+
+    if (t >= 1.0) {
+        m_FrameTimer.stop();
+    }
+    if (qFuzzyCompare(pose, m_Pose)) {
+        return;
+    }
+    m_Pose = pose;
+    updateGL();
+}
+
+void ModelViewGadgetWidget::applyPose()
+{
+    GLC_StructOccurence *rootObject = m_World.rootOccurence(); // get the full 3D model
+    double x = m_Pose.x();
+    double y = m_Pose.y();
+    double z = m_Pose.z();
+    double w = m_Pose.scalar();
+
     // create and gives the product of 2 4x4 matrices to get the rotation of the 3D model's matrix
     QMatrix4x4 m1;
     m1.setRow(0, QVector4D(w, z, -y, x));
@@ -352,5 +450,4 @@ void ModelViewGadgetWidget::updateAttitude()
     GLC_Matrix4x4 rootObjectRotation(m0.data());
     rootObject->structInstance()->setMatrix(rootObjectRotation);
     rootObject->updateChildrenAbsoluteMatrix();
-    updateGL();
 }
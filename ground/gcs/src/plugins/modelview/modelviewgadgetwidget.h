@@ -27,7 +27,12 @@
 #ifndef MODELVIEWGADGETWIDGET_H_
 #define MODELVIEWGADGETWIDGET_H_
 
+#include <QDateTime>
+#include <QElapsedTimer>
 #include <QGLWidget>
+#include <QHash>
+#include <QList>
+#include <QQuaternion>
 #include <QTimer>
 
 #include "glc_lib/glc_factory.h"
@@ -52,7 +57,7 @@ public:
     void setBgFilename(QString bgf);
     void setVboEnable(bool eVbo);
     void reloadScene();
-    void updateAttitude(int value);
+    void setActive(bool active);
 
 private:
     void initializeGL();
@@ -72,9 +77,18 @@ private:
     // Private slots Functions
     //////////////////////////////////////////////////////////////////////
 private slots:
-    void updateAttitude();
+    void attitudeUpdated();
+    void renderFrame();
 
 private:
+    // Frame period while the model moves, swaps are synced to vblank too
+    static const int FRAME_PERIOD_MS = 16;
+    // Bounds on the time a new attitude is eased in over
+    static const int MIN_SAMPLE_INTERVAL_MS = 10;
+    static const int MAX_SAMPLE_INTERVAL_MS = 250;
+
+    void applyPose();
+
     GLC_Factory *m_pFactory;
     GLC_Light m_Light;
     GLC_World m_World;
@@ -82,7 +96,14 @@ private:
     GLC_MoverController m_MoverController;
     GLC_BoundingBox m_ModelBoundingBox;
     // ! The timer used for motion
-    QTimer m_MotionTimer;
+    QTimer m_FrameTimer;
+
+    // Pose shown, and the attitude samples it moves between
+    QQuaternion m_Pose;
+    QQuaternion m_FromPose;
+    QQuaternion m_ToPose;
+    QElapsedTimer m_SampleClock;
+    int m_SampleInterval;
 
     QString acFilename;
     QString bgFilename;
@@ -91,6 +112,18 @@ private:
     static const QString fallbackAcFilename;
     static const QString fallbackBgFilename;
 
+    /**
+     * Models loaded by any gadget, shared by all whose GL context shares with
+     * the others, so files are parsed and their VBOs uploaded once
+     */
+    struct CachedWorld
+    {
+        GLC_World world;
+        QDateTime modified;
+    };
+    static QHash<QString, CachedWorld> worldCache;
+    static QList<ModelViewGadgetWidget *> instances;
+
     AttitudeActual *attState;
 };
 
@@ -45,6 +45,8 @@ static const QString VERSION = "1.0.0";
 //#define DEBUG_NOTIFIES
 
 SoundNotifyPlugin::SoundNotifyPlugin()
+    : _nowPlayingNotification(NULL)
+    , playlist(NULL)
 {
     phonon.mo = NULL;
 }
@@ -180,10 +182,16 @@ void SoundNotifyPlugin::connectNotifications()
             disconnect(obj, &UAVObject::objectUpdated, this,
                        &SoundNotifyPlugin::on_arrived_Notification);
     }
+    lstNotifiedUAVObjects.clear();
+    objectRules.clear();
+
     if (phonon.mo != NULL) {
+        // Takes the playlist along
         delete phonon.mo;
         phonon.mo = NULL;
+        playlist = NULL;
     }
+    _nowPlayingNotification = NULL;
 
     if (!enableSound)
         return;
@@ -191,7 +199,6 @@ void SoundNotifyPlugin::connectNotifications()
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
 
-    lstNotifiedUAVObjects.clear();
     _pendingNotifications.clear();
     _notificationList.append(_toRemoveNotifications);
     _toRemoveNotifications.clear();
@@ -210,15 +217,38 @@ void SoundNotifyPlugin::connectNotifications()
 
         UAVDataObject *obj =
             dynamic_cast<UAVDataObject *>(objManager->getObject(notify->getDataObject()));
-        if (obj != NULL) {
-            if (!lstNotifiedUAVObjects.contains(obj)) {
-                lstNotifiedUAVObjects.append(obj);
+        if (obj == NULL) {
+            qNotifyDebug() << "Error: Object is unknown (" << notify->getDataObject() << ").";
+            continue;
+        }
 
-                connect(obj, &UAVObject::objectUpdated, this,
-                        &SoundNotifyPlugin::on_arrived_Notification, Qt::QueuedConnection);
+        // Look the field up once, rather than on every update
+        NotificationRule rule;
+        rule.notification = notify;
+        rule.field = obj->getField(notify->getObjectField());
+        rule.enumIndex = -1;
+        if (rule.field == NULL) {
+            qNotifyDebug() << "Error: Field is unknown (" << notify->getDataObject() << "."
+                           << notify->getObjectField() << ").";
+            continue;
+        }
+        if (rule.field->getType() == UAVObjectField::ENUM) {
+            QString option = notify->singleValue().toString();
+            QStringList options = rule.field->getOptions();
+            for (int i = 0; i < options.size(); i++) {
+                if (!QString::compare(options.at(i), option, Qt::CaseInsensitive)) {
+                    rule.enumIndex = i;
+                    break;
+                }
             }
-        } else {
-            qNotifyDebug() << "Error: Object is unknown (" << notify->getDataObject() << ").";
+        }
+        objectRules[obj].append(rule);
+
+        if (!lstNotifiedUAVObjects.contains(obj)) {
+            lstNotifiedUAVObjects.append(obj);
+
+            connect(obj, &UAVObject::objectUpdated, this,
+                    &SoundNotifyPlugin::on_arrived_Notification, Qt::QueuedConnection);
         }
     }
 
@@ -232,9 +262,11 @@ void SoundNotifyPlugin::connectNotifications()
 
 void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
 {
-    foreach (NotificationItem *ntf, _notificationList) {
-        if (object->getName() != ntf->getDataObject())
-            continue;
+    // A copy, playing may remove rules
+    const QVector<NotificationRule> rules = objectRules.value(object);
+
+    foreach (const NotificationRule &rule, rules) {
+        NotificationItem *ntf = rule.notification;
 
         // skip duplicate notifications
         if (_nowPlayingNotification == ntf)
@@ -253,16 +285,8 @@ void SoundNotifyPlugin::on_arrived_Notification(UAVObject *object)
             && ntf->retryValue() != NotificationItem::repeatOnce && ntf->_isPlayed)
             continue;
 
-        qNotifyDebug() << QString("new notification: | %1 | %2 | val1: %3 | val2: %4")
-                              .arg(ntf->getDataObject())
-                              .arg(ntf->getObjectField())
-                              .arg(ntf->singleValue().toString())
-                              .arg(ntf->valueRange2());
-
-        checkNotificationRule(ntf, object);
+        checkNotificationRule(rule);
     }
-    connect(object, &UAVObject::objectUpdated, this, &SoundNotifyPlugin::on_arrived_Notification,
-            Qt::UniqueConnection);
 }
 
 void SoundNotifyPlugin::on_timerRepeated_Notification()
@@ -284,11 +308,9 @@ void SoundNotifyPlugin::on_timerRepeated_Notification()
                           .arg(notification->getObjectField())
                           .arg(notification->toString());
 
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
-    UAVObject *object = objManager->getObject(notification->getDataObject());
-    if (object)
-        checkNotificationRule(notification, object);
+    const NotificationRule *rule = findRule(notification);
+    if (rule)
+        checkNotificationRule(*rule);
 }
 
 void SoundNotifyPlugin::on_expiredTimer_Notification()
@@ -336,13 +358,13 @@ void SoundNotifyPlugin::stateChanged(QMediaPlayer::State newstate)
     }
 }
 
-bool checkRange(QString fieldValue, QString enumValue, QStringList /* values */, int direction)
+bool checkRange(int fieldIndex, int enumIndex, int direction)
 {
 
     bool ret = false;
     switch (direction) {
     case NotifyPluginOptionsPage::equal:
-        ret = !QString::compare(enumValue, fieldValue, Qt::CaseInsensitive) ? true : false;
+        ret = (fieldIndex == enumIndex);
         break;
 
     default:
@@ -377,40 +399,50 @@ bool checkRange(double fieldValue, double min, double max, int direction)
     return ret;
 }
 
-void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UAVObject *object)
+/**
+ * @brief Find the rule of a notification, for its repeat timer
+ */
+const SoundNotifyPlugin::NotificationRule *
+SoundNotifyPlugin::findRule(NotificationItem *notification) const
 {
-    if (notification->getDataObject() != object->getName()
-        || object->getField(notification->getObjectField()) == NULL)
-        return;
+    for (auto it = objectRules.constBegin(); it != objectRules.constEnd(); ++it) {
+        for (const NotificationRule &rule : it.value()) {
+            if (rule.notification == notification)
+                return &rule;
+        }
+    }
+
+    return NULL;
+}
+
+void SoundNotifyPlugin::removeRule(NotificationItem *notification)
+{
+    for (auto it = objectRules.begin(); it != objectRules.end(); ++it) {
+        QVector<NotificationRule> &rules = it.value();
+        for (int i = 0; i < rules.size(); i++) {
+            if (rules.at(i).notification == notification) {
+                rules.remove(i);
+                return;
+            }
+        }
+    }
+}
+
+void SoundNotifyPlugin::checkNotificationRule(const NotificationRule &rule)
+{
+    NotificationItem *notification = rule.notification;
+    UAVObjectField *field = rule.field;
     bool condition = false;
 
     if (notification->mute())
         return;
 
     int direction = notification->getCondition();
-    QString fieldName = notification->getObjectField();
-    UAVObjectField *field = object->getField(fieldName);
-
-    if (field->getName().isEmpty())
-        return;
 
-    QVariant value = field->getValue();
     if (UAVObjectField::ENUM == field->getType()) {
-        qNotifyDebug() << "Check range ENUM" << value.toString() << "|"
-                       << notification->singleValue().toString() << "|" << field->getOptions()
-                       << "|" << direction
-                       << checkRange(value.toString(), notification->singleValue().toString(),
-                                     field->getOptions(), direction);
-        ;
-        condition = checkRange(value.toString(), notification->singleValue().toString(),
-                               field->getOptions(), direction);
+        condition = checkRange(field->getRawEnum(), rule.enumIndex, direction);
     } else {
-        qNotifyDebug() << "Check range VAL" << value.toString() << "|"
-                       << notification->singleValue().toString() << "|" << field->getOptions()
-                       << "|" << direction
-                       << checkRange(value.toDouble(), notification->singleValue().toDouble(),
-                                     notification->valueRange2(), direction);
-        condition = checkRange(value.toDouble(), notification->singleValue().toDouble(),
+        condition = checkRange(field->getDouble(), notification->singleValue().toDouble(),
                                notification->valueRange2(), direction);
     }
 
@@ -446,7 +478,6 @@ void SoundNotifyPlugin::checkNotificationRule(NotificationItem *notification, UA
 
 bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
 {
-    playlist = new QMediaPlaylist;
     if (!notification)
         return false;
 
@@ -464,6 +495,7 @@ bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
         if (notification->retryValue() == NotificationItem::repeatOnce) {
             _toRemoveNotifications.append(
                 _notificationList.takeAt(_notificationList.indexOf(notification)));
+            removeRule(notification);
         } else if (notification->retryValue() == NotificationItem::repeatOncePerUpdate)
             notification->setCurrentUpdatePlayed(true);
         else {
@@ -494,11 +526,15 @@ bool SoundNotifyPlugin::playNotification(NotificationItem *notification)
         }
         phonon.mo->stop();
         qNotifyDebug() << "play: " << notification->toString();
+        // The player doesn't own its playlist, the previous one goes once replaced
+        QMediaPlaylist *previous = playlist;
+        playlist = new QMediaPlaylist(phonon.mo);
         foreach (QString item, notification->toSoundList()) {
             playlist->addMedia(QUrl::fromLocalFile(item));
         }
         qNotifyDebug() << "begin play";
         phonon.mo->setPlaylist(playlist);
+        delete previous;
         phonon.mo->play();
         qNotifyDebug() << "end play";
         phonon.firstPlay =
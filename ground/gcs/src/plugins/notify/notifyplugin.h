@@ -36,7 +36,9 @@
 #include "uavobjects/uavobject.h"
 #include "notificationitem.h"
 
+#include <QHash>
 #include <QSettings>
+#include <QVector>
 #include <QMediaPlayer>
 #include <QMediaPlaylist>
 
@@ -75,8 +77,19 @@ public slots:
 private:
     Q_DISABLE_COPY(SoundNotifyPlugin)
 
+    //! A notification's condition, with its field looked up in advance
+    struct NotificationRule
+    {
+        NotificationItem *notification;
+        UAVObjectField *field;
+        //! Option the field is compared to, for ENUM fields
+        int enumIndex;
+    };
+
     bool playNotification(NotificationItem *notification);
-    void checkNotificationRule(NotificationItem *notification, UAVObject *object);
+    void checkNotificationRule(const NotificationRule &rule);
+    const NotificationRule *findRule(NotificationItem *notification) const;
+    void removeRule(NotificationItem *notification);
 
 private slots:
 
@@ -93,6 +106,8 @@ private:
     bool enableSound;
 
     QList<UAVDataObject *> lstNotifiedUAVObjects;
+    //! Rules of the notifications to check on each object's updates
+    QHash<UAVObject *, QVector<NotificationRule>> objectRules;
     QList<NotificationItem *> _notificationList;
     QList<NotificationItem *> _pendingNotifications;
     QList<NotificationItem *> _toRemoveNotifications;
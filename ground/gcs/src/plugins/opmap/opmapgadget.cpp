@@ -65,6 +65,7 @@ void OPMapGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     m_widget->setAccessMode(m_config->accessMode());
     m_widget->setUseMemoryCache(m_config->useMemoryCache());
     m_widget->setCacheLocation(m_config->cacheLocation());
+    m_widget->setCacheSizeLimit(m_config->cacheSizeLimit());
     m_widget->setUserImageHorizontalScale(m_config->getUserImageHorizontalScale());
     m_widget->setUserImageVerticalScale(m_config->getUserImageVerticalScale());
     m_widget->setUserImageLocation(m_config->getUserImageLocation());
@@ -40,6 +40,7 @@ OPMapGadgetConfiguration::OPMapGadgetConfiguration(QString classId, QSettings *q
     , m_accessMode("ServerAndCache")
     , m_useMemoryCache(true)
     , m_cacheLocation(Utils::PathUtils().GetStoragePath() + "mapscache" + QDir::separator())
+    , m_cacheSizeLimit(1024)
     , m_uavSymbol(QString::fromUtf8(":/uavs/images/mapquad.png"))
     , m_maxUpdateRate(2000)
     , // ms
@@ -59,6 +60,7 @@ OPMapGadgetConfiguration::OPMapGadgetConfiguration(QString classId, QSettings *q
         QString accessMode = qSettings->value("accessMode").toString();
         bool useMemoryCache = qSettings->value("useMemoryCache").toBool();
         QString cacheLocation = qSettings->value("cacheLocation").toString();
+        m_cacheSizeLimit = qSettings->value("cacheSizeLimit", m_cacheSizeLimit).toInt();
         QString uavSymbol = qSettings->value("uavSymbol").toString();
         int max_update_rate = qSettings->value("maxUpdateRate").toInt();
         float userImageHorizontalScale = qSettings->value("userImageHorizontalScale").toFloat();
@@ -109,6 +111,7 @@ IUAVGadgetConfiguration *OPMapGadgetConfiguration::clone()
     m->m_accessMode = m_accessMode;
     m->m_useMemoryCache = m_useMemoryCache;
     m->m_cacheLocation = m_cacheLocation;
+    m->m_cacheSizeLimit = m_cacheSizeLimit;
     m->m_uavSymbol = m_uavSymbol;
     m->m_maxUpdateRate = m_maxUpdateRate;
     m->m_opacity = m_opacity;
@@ -132,6 +135,7 @@ void OPMapGadgetConfiguration::saveConfig() const
     m_settings->setValue("useMemoryCache", m_useMemoryCache);
     m_settings->setValue("uavSymbol", m_uavSymbol);
     m_settings->setValue("cacheLocation", Utils::PathUtils().RemoveStoragePath(m_cacheLocation));
+    m_settings->setValue("cacheSizeLimit", m_cacheSizeLimit);
     m_settings->setValue("maxUpdateRate", m_maxUpdateRate);
     m_settings->setValue("overlayOpacity", m_opacity);
     m_settings->setValue("userImageHorizontalScale", m_userImageHorizontalScale);
@@ -150,6 +154,7 @@ void OPMapGadgetConfiguration::saveConfig(QSettings *qSettings) const
     qSettings->setValue("useMemoryCache", m_useMemoryCache);
     qSettings->setValue("uavSymbol", m_uavSymbol);
     qSettings->setValue("cacheLocation", Utils::PathUtils().RemoveStoragePath(m_cacheLocation));
+    qSettings->setValue("cacheSizeLimit", m_cacheSizeLimit);
     qSettings->setValue("maxUpdateRate", m_maxUpdateRate);
     qSettings->setValue("overlayOpacity", m_opacity);
     qSettings->setValue("userImageHorizontalScale", m_userImageHorizontalScale);
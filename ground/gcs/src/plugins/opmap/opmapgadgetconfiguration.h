@@ -46,6 +46,7 @@ class OPMapGadgetConfiguration : public IUAVGadgetConfiguration
     Q_PROPERTY(QString accessMode READ accessMode WRITE setAccessMode)
     Q_PROPERTY(bool useMemoryCache READ useMemoryCache WRITE setUseMemoryCache)
     Q_PROPERTY(QString cacheLocation READ cacheLocation WRITE setCacheLocation)
+    Q_PROPERTY(int cacheSizeLimit READ cacheSizeLimit WRITE setCacheSizeLimit)
     Q_PROPERTY(QString uavSymbol READ uavSymbol WRITE setUavSymbol)
     Q_PROPERTY(int maxUpdateRate READ maxUpdateRate WRITE setMaxUpdateRate)
     Q_PROPERTY(qreal overlayOpacity READ opacity WRITE setOpacity)
@@ -66,6 +67,7 @@ public:
     QString accessMode() const { return m_accessMode; }
     bool useMemoryCache() const { return m_useMemoryCache; }
     QString cacheLocation() const { return m_cacheLocation; }
+    int cacheSizeLimit() const { return m_cacheSizeLimit; }
     QString uavSymbol() const { return m_uavSymbol; }
     int maxUpdateRate() const { return m_maxUpdateRate; }
     qreal opacity() const { return m_opacity; }
@@ -85,6 +87,7 @@ public slots:
     void setAccessMode(QString accessMode) { m_accessMode = accessMode; }
     void setUseMemoryCache(bool useMemoryCache) { m_useMemoryCache = useMemoryCache; }
     void setCacheLocation(QString cacheLocation) { m_cacheLocation = cacheLocation; }
+    void setCacheSizeLimit(int cacheSizeLimit) { m_cacheSizeLimit = cacheSizeLimit; }
     void setUavSymbol(QString symbol) { m_uavSymbol = symbol; }
     void setMaxUpdateRate(int update_rate) { m_maxUpdateRate = update_rate; }
     void setUserImageLocation(QString userImageLocation)
@@ -109,6 +112,7 @@ private:
     QString m_accessMode;
     bool m_useMemoryCache;
     QString m_cacheLocation;
+    int m_cacheSizeLimit; // MB, 0 for no limit
     QString m_uavSymbol;
     int m_maxUpdateRate;
     QSettings *m_settings;
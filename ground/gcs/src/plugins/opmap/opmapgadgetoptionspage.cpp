@@ -108,6 +108,9 @@ QWidget *OPMapGadgetOptionsPage::createPage(QWidget *parent)
     m_page->lineEditCacheLocation->setPromptDialogTitle(tr("Choose Cache Directory"));
     m_page->lineEditCacheLocation->setPath(m_config->cacheLocation());
 
+    m_page->cacheSizeLimitSpinBox->setValue(m_config->cacheSizeLimit());
+    updateCacheStats();
+
     m_page->horizontalScaleDoubleSpinBox->setValue(m_config->getUserImageHorizontalScale());
     m_page->verticalScaleDoubleSpinBox->setValue(m_config->getUserImageVerticalScale());
 
@@ -160,6 +163,21 @@ void OPMapGadgetOptionsPage::on_pushButtonCacheDefaults_clicked()
     m_page->checkBoxUseMemoryCache->setChecked(true);
     m_page->lineEditCacheLocation->setPath(Utils::PathUtils().GetStoragePath() + "mapscache"
                                            + QDir::separator());
+    m_page->cacheSizeLimitSpinBox->setValue(1024);
+}
+
+void OPMapGadgetOptionsPage::updateCacheStats()
+{
+    mapcontrol::Configuration configuration;
+    core::PureImageCache::CacheStats stats;
+    if (!configuration.CacheStats(stats)) {
+        m_page->cacheStatsLabel->clear();
+        return;
+    }
+    m_page->cacheStatsLabel->setText(
+        tr("%1 tiles, %2 MB on disk")
+            .arg(stats.tiles)
+            .arg((stats.fileSize - stats.freeSize) / (1024.0 * 1024.0), 0, 'f', 1));
 }
 
 void OPMapGadgetOptionsPage::apply()
@@ -172,6 +190,7 @@ void OPMapGadgetOptionsPage::apply()
     m_config->setAccessMode(m_page->accessModeComboBox->currentText());
     m_config->setUseMemoryCache(m_page->checkBoxUseMemoryCache->isChecked());
     m_config->setCacheLocation(m_page->lineEditCacheLocation->path());
+    m_config->setCacheSizeLimit(m_page->cacheSizeLimitSpinBox->value());
     m_config->setUserImageHorizontalScale(m_page->horizontalScaleDoubleSpinBox->value());
     m_config->setUserImageVerticalScale(m_page->verticalScaleDoubleSpinBox->value());
     m_config->setUserImageLocation(m_page->lineEditCacheLocation->path());
@@ -59,6 +59,7 @@ public slots:
 private slots:
     void on_pushButtonCacheDefaults_clicked();
     void on_providerComboBox_changed();
+    void updateCacheStats();
 
 private:
     OPMapGadgetConfiguration *m_config;
@@ -43,6 +43,9 @@
 #include <QDir>
 #include <QFile>
 #include <QDateTime>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QScreen>
 
 #include <math.h>
 
@@ -114,6 +117,9 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent)
 
     m_telemetry_connected = false;
 
+    m_poseValid = false;
+    m_poseClock.start();
+
     m_context_menu_lat_lon = m_mouse_lat_lon = internals::PointLatLng(0, 0);
 
     setMouseTracking(true);
@@ -294,6 +300,15 @@ OPMapGadgetWidget::OPMapGadgetWidget(QWidget *parent)
     connect(m_updateTimer, &QTimer::timeout, this, &OPMapGadgetWidget::updatePosition);
     m_updateTimer->start();
 
+    // The UAV icon is moved at display rate, between telemetry samples, and
+    // only while it is actually moving
+    int refreshRate = 60;
+    if (QGuiApplication::primaryScreen())
+        refreshRate = qBound(10, qRound(QGuiApplication::primaryScreen()->refreshRate()), 120);
+    m_renderTimer = new QTimer(this);
+    m_renderTimer->setInterval(1000 / refreshRate);
+    connect(m_renderTimer, &QTimer::timeout, this, &OPMapGadgetWidget::renderUAVPose);
+
     m_statusUpdateTimer = new QTimer();
     m_statusUpdateTimer->setInterval(200);
     connect(m_statusUpdateTimer, &QTimer::timeout, this, &OPMapGadgetWidget::updateMousePos);
@@ -389,6 +404,8 @@ void OPMapGadgetWidget::contextMenuEvent(QContextMenuEvent *event)
     contextMenu.addAction(reloadAct);
     contextMenu.addSeparator();
     contextMenu.addAction(ripAct);
+    contextMenu.addAction(exportTilePackAct);
+    contextMenu.addAction(mountTilePackAct);
     contextMenu.addSeparator();
 
     QMenu maxUpdateRateSubMenu(
@@ -658,9 +675,7 @@ void OPMapGadgetWidget::updatePosition()
     // *************
     // set the UAV icon position on the map
 
-    m_map->UAV->SetUAVPos(uav_pos, uav_altitude); // set the maps UAV position
-    //	qDebug()<<"UAVPOSITION"<<uav_pos.ToString();
-    m_map->UAV->SetUAVHeading(uav_yaw); // set the maps UAV heading
+    addUAVPoseSample(uav_pos, uav_altitude, uav_yaw);
 
     // *************
     // set the GPS icon position on the map
@@ -673,6 +688,89 @@ void OPMapGadgetWidget::updatePosition()
     // *************
 }
 
+/**
+  Queue a new UAV pose. The icon glides from wherever it is now to the new
+  pose over one update period, so it arrives as the next sample comes in.
+ */
+void OPMapGadgetWidget::addUAVPoseSample(const internals::PointLatLng &pos, double altitude,
+                                         double yaw)
+{
+    qint64 now = m_poseClock.elapsed();
+
+    if (!m_poseValid) {
+        m_poseTo.pos = pos;
+        m_poseTo.altitude = altitude;
+        m_poseTo.yaw = yaw;
+        m_poseTo.time = now;
+        m_poseFrom = m_poseTo;
+        m_poseValid = true;
+
+        m_poseRendered = m_poseTo;
+        m_map->UAV->SetUAVPos(pos, altitude);
+        m_map->UAV->SetUAVHeading(yaw);
+        return;
+    }
+
+    if (pos == m_poseTo.pos && altitude == m_poseTo.altitude && yaw == m_poseTo.yaw)
+        return;
+
+    m_poseFrom = interpolatedUAVPose(now);
+    m_poseFrom.time = now;
+    m_poseTo.pos = pos;
+    m_poseTo.altitude = altitude;
+    m_poseTo.yaw = yaw;
+    m_poseTo.time = now + m_maxUpdateRate;
+
+    if (!m_renderTimer->isActive())
+        m_renderTimer->start();
+}
+
+OPMapGadgetWidget::UAVPose OPMapGadgetWidget::interpolatedUAVPose(qint64 now) const
+{
+    if (now >= m_poseTo.time || m_poseTo.time <= m_poseFrom.time)
+        return m_poseTo;
+
+    double t = double(now - m_poseFrom.time) / (m_poseTo.time - m_poseFrom.time);
+    UAVPose pose;
+    pose.pos = internals::PointLatLng(
+        m_poseFrom.pos.Lat() + t * (m_poseTo.pos.Lat() - m_poseFrom.pos.Lat()),
+        m_poseFrom.pos.Lng() + t * (m_poseTo.pos.Lng() - m_poseFrom.pos.Lng()));
+    pose.altitude = m_poseFrom.altitude + t * (m_poseTo.altitude - m_poseFrom.altitude);
+    // Turn the short way round
+    pose.yaw = m_poseFrom.yaw + t * remainder(m_poseTo.yaw - m_poseFrom.yaw, 360.0);
+    pose.time = now;
+    return pose;
+}
+
+/**
+  Move the UAV icon to its interpolated pose. Frames where it would not move
+  by a whole pixel or visibly turn are skipped, so nothing in the scene is
+  invalidated, and the timer stops once the latest sample is reached.
+ */
+void OPMapGadgetWidget::renderUAVPose()
+{
+    if (!m_map || !m_poseValid) {
+        m_renderTimer->stop();
+        return;
+    }
+
+    qint64 now = m_poseClock.elapsed();
+    UAVPose pose = interpolatedUAVPose(now);
+    bool arrived = (now >= m_poseTo.time);
+
+    QPointF moved = m_map->GetFromLatLngToLocal(pose.pos)
+        - m_map->GetFromLatLngToLocal(m_poseRendered.pos);
+    bool turned = fabs(remainder(pose.yaw - m_poseRendered.yaw, 360.0)) >= 0.5;
+    if (arrived || turned || moved.manhattanLength() >= 1) {
+        m_map->UAV->SetUAVPos(pose.pos, pose.altitude); // set the maps UAV position
+        m_map->UAV->SetUAVHeading(pose.yaw); // set the maps UAV heading
+        m_poseRendered = pose;
+    }
+
+    if (arrived)
+        m_renderTimer->stop();
+}
+
 /**
   Update plugin behaviour based on mouse position; Called every few ms by a
   timer.
@@ -1189,6 +1287,14 @@ void OPMapGadgetWidget::setCacheLocation(QString cacheLocation)
     m_map->configuration->SetCacheLocation(cacheLocation);
 }
 
+void OPMapGadgetWidget::setCacheSizeLimit(int megabytes)
+{
+    if (!m_widget || !m_map)
+        return;
+
+    m_map->configuration->SetCacheSizeLimit(megabytes);
+}
+
 void OPMapGadgetWidget::setMapMode(opMapModeType mode)
 {
     if (!m_widget || !m_map)
@@ -1282,6 +1388,14 @@ void OPMapGadgetWidget::createActions()
     ripAct = new QAction(tr("&Rip map"), this);
     ripAct->setStatusTip(tr("Rip the map tiles"));
     connect(ripAct, &QAction::triggered, this, &OPMapGadgetWidget::onRipAct_triggered);
+    exportTilePackAct = new QAction(tr("&Export tile pack..."), this);
+    exportTilePackAct->setStatusTip(tr("Save the cached map tiles to a single file"));
+    connect(exportTilePackAct, &QAction::triggered, this,
+            &OPMapGadgetWidget::onExportTilePackAct_triggered);
+    mountTilePackAct = new QAction(tr("&Load tile pack..."), this);
+    mountTilePackAct->setStatusTip(tr("Use the map tiles of a tile pack for offline operation"));
+    connect(mountTilePackAct, &QAction::triggered, this,
+            &OPMapGadgetWidget::onMountTilePackAct_triggered);
 
     copyMouseLatLonToClipAct = new QAction(tr("Mouse latitude and longitude"), this);
     copyMouseLatLonToClipAct->setStatusTip(
@@ -1602,6 +1716,34 @@ void OPMapGadgetWidget::onRipAct_triggered()
     m_map->RipMap();
 }
 
+void OPMapGadgetWidget::onExportTilePackAct_triggered()
+{
+    QString file = QFileDialog::getSaveFileName(this, tr("Export tile pack"), QString(),
+                                                tr("Tile packs (*.tilepack)"));
+    if (file.isEmpty())
+        return;
+    if (!file.endsWith(".tilepack"))
+        file += ".tilepack";
+
+    if (!m_map->configuration->ExportTilePack(file))
+        QMessageBox::warning(this, tr("Export tile pack"),
+                             tr("Could not write the map cache to %1").arg(file));
+}
+
+void OPMapGadgetWidget::onMountTilePackAct_triggered()
+{
+    QString file = QFileDialog::getOpenFileName(this, tr("Load tile pack"), QString(),
+                                                tr("Tile packs (*.tilepack)"));
+    if (file.isEmpty())
+        return;
+
+    if (!m_map->configuration->MountTilePack(file)) {
+        QMessageBox::warning(this, tr("Load tile pack"), tr("%1 is not a valid tile pack").arg(file));
+        return;
+    }
+    m_map->ReloadMap();
+}
+
 void OPMapGadgetWidget::onCopyMouseLatLonToClipAct_triggered()
 {
     QClipboard *clipboard = QApplication::clipboard();
@@ -44,6 +44,7 @@
 #include <QStandardItemModel>
 #include <QList>
 #include <QPointF>
+#include <QElapsedTimer>
 
 #include "tlmapcontrol/tlmapcontrol.h"
 
@@ -111,6 +112,7 @@ public:
     void setAccessMode(QString accessMode);
     void setUseMemoryCache(bool useMemoryCache);
     void setCacheLocation(QString cacheLocation);
+    void setCacheSizeLimit(int megabytes);
     void setMapMode(opMapModeType mode);
     void SetUavPic(QString UAVPic);
     void setMaxUpdateRate(int update_rate);
@@ -138,6 +140,7 @@ protected:
 private slots:
     void wpDoubleClickEvent(WayPointItem *wp);
     void updatePosition();
+    void renderUAVPose();
 
     void updateMousePos();
 
@@ -175,6 +178,8 @@ private slots:
     */
     void onReloadAct_triggered();
     void onRipAct_triggered();
+    void onExportTilePackAct_triggered();
+    void onMountTilePackAct_triggered();
     void onCopyMouseLatLonToClipAct_triggered();
     void onCopyMouseLatToClipAct_triggered();
     void onCopyMouseLonToClipAct_triggered();
@@ -231,10 +236,27 @@ private:
     int m_prev_tile_number;
     opMapModeType m_map_mode;
     int m_maxUpdateRate;
+
+    // UAV pose interpolated between telemetry samples by renderUAVPose()
+    struct UAVPose
+    {
+        internals::PointLatLng pos;
+        double altitude;
+        double yaw;
+        qint64 time; // ms on m_poseClock
+    };
+    UAVPose m_poseFrom;
+    UAVPose m_poseTo;
+    UAVPose m_poseRendered;
+    bool m_poseValid;
+    QElapsedTimer m_poseClock;
+    void addUAVPoseSample(const internals::PointLatLng &pos, double altitude, double yaw);
+    UAVPose interpolatedUAVPose(qint64 now) const;
     t_home m_home_position;
     QStringList findPlaceWordList;
     QCompleter *findPlaceCompleter;
     QTimer *m_updateTimer;
+    QTimer *m_renderTimer;
     QTimer *m_statusUpdateTimer;
     Ui::OPMap_Widget *m_widget;
     mapcontrol::TLMapWidget *m_map;
@@ -249,6 +271,8 @@ private:
     QAction *closeAct2;
     QAction *reloadAct;
     QAction *ripAct;
+    QAction *exportTilePackAct;
+    QAction *mountTilePackAct;
     QAction *copyMouseLatLonToClipAct;
     QAction *copyMouseLatToClipAct;
     QAction *copyMouseLonToClipAct;
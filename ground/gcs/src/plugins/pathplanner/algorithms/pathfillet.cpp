@@ -84,6 +84,9 @@ bool PathFillet::processPath(FlightDataModel *model)
 {
     new_model = new FlightDataModel(this);
 
+    // The plan is validated once it's complete, when it replaces the original
+    new_model->pauseValidation(true);
+
     int newWaypointIdx = 0;
 
     float pos_prev[3];
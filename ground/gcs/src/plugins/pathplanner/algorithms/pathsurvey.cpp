@@ -0,0 +1,259 @@
+/**
+ ******************************************************************************
+ * @file       pathsurvey.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Path Planner Pluggin
+ * @{
+ * @brief Abstact algorithm that can be run on a path
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <QInputDialog>
+#include <algorithms/pathsurvey.h>
+
+// Clipped sweeps shorter than this [m] only touch the polygon
+#define MIN_SWEEP_LENGTH 0.01
+
+PathSurvey::PathSurvey(QObject *parent)
+    : IPathAlgorithm(parent)
+    , spacing(20)
+    , heading(0)
+{
+}
+
+/**
+ * Ask for the spacing and heading of the sweeps
+ * @param callingUi the QWidget that called this algorithm
+ * @return true if both were given
+ */
+bool PathSurvey::configure(QWidget *callingUi)
+{
+    bool ok;
+    spacing = QInputDialog::getDouble(callingUi, tr("Select sweep spacing"), tr("In m:"), spacing,
+                                      1, 1000, 1, &ok);
+    if (!ok)
+        return false;
+
+    heading = QInputDialog::getDouble(callingUi, tr("Select sweep heading"),
+                                      tr("In degrees from North:"), heading, 0, 360, 0, &ok);
+
+    return ok;
+}
+
+/**
+ * Verify the path outlines an area
+ * @param[in] model the flight model to validate
+ * @param[out] err an error message for the user for invalid paths
+ * @return true for valid path, false for invalid
+ */
+bool PathSurvey::verifyPath(FlightDataModel *model, QString &err)
+{
+    if (model->rowCount() < 3) {
+        err = tr("The path needs at least three waypoints outlining the area to survey");
+        return false;
+    }
+
+    // Shoelace formula, twice the area
+    double area = 0;
+    for (int i = 0; i < model->rowCount(); i++) {
+        int j = (i + 1) % model->rowCount();
+        area += model->data(model->index(i, FlightDataModel::NED_NORTH)).toDouble()
+                * model->data(model->index(j, FlightDataModel::NED_EAST)).toDouble()
+            - model->data(model->index(j, FlightDataModel::NED_NORTH)).toDouble()
+                * model->data(model->index(i, FlightDataModel::NED_EAST)).toDouble();
+    }
+
+    if (fabs(area) < 2) {
+        err = tr("The waypoints of the path don't outline an area");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Replace the polygon with the survey path. The waypoints are flown at the
+ * altitude and velocity of the first waypoint of the polygon.
+ * @param model the flight model to process and update
+ * @return true for success, false for failure
+ */
+bool PathSurvey::processPath(FlightDataModel *model)
+{
+    QVector<QPointF> polygon;
+    for (int i = 0; i < model->rowCount(); i++) {
+        polygon.append(QPointF(model->data(model->index(i, FlightDataModel::NED_NORTH)).toDouble(),
+                               model->data(model->index(i, FlightDataModel::NED_EAST)).toDouble()));
+    }
+    double down = model->data(model->index(0, FlightDataModel::NED_DOWN)).toDouble();
+    float velocity = model->data(model->index(0, FlightDataModel::VELOCITY)).toFloat();
+
+    QVector<QPointF> path = coveragePath(polygon, spacing, heading * M_PI / 180);
+    if (path.isEmpty())
+        return false;
+
+    // Build the plan on its own, then hand it to the model in one insertion
+    FlightDataModel *newModel = new FlightDataModel(this);
+    newModel->pauseValidation(true);
+    newModel->insertRows(0, path.size());
+    for (int i = 0; i < path.size(); i++) {
+        newModel->setData(newModel->index(i, FlightDataModel::NED_NORTH), path[i].x());
+        newModel->setData(newModel->index(i, FlightDataModel::NED_EAST), path[i].y());
+        newModel->setData(newModel->index(i, FlightDataModel::NED_DOWN), down);
+        newModel->setData(newModel->index(i, FlightDataModel::VELOCITY), velocity);
+    }
+
+    model->replaceData(newModel);
+    delete newModel;
+
+    return true;
+}
+
+QVector<QPointF> PathSurvey::coveragePath(const QVector<QPointF> &polygon, double spacing,
+                                          double heading)
+{
+    QVector<Sweep> sweeps = clipSweeps(polygon, spacing, heading);
+    QVector<bool> flown(sweeps.size(), false);
+    QVector<QPointF> path;
+
+    if (sweeps.isEmpty())
+        return path;
+
+    // Always go on with the sweep whose nearer end is closest, from that end
+    QPointF position = sweeps.first().start;
+    for (int n = 0; n < sweeps.size(); n++) {
+        double closest = std::numeric_limits<double>::infinity();
+        int next = -1;
+        bool reverse = false;
+
+        for (int i = 0; i < sweeps.size(); i++) {
+            if (flown[i])
+                continue;
+
+            QPointF toStart = sweeps[i].start - position;
+            QPointF toEnd = sweeps[i].end - position;
+            double startDistance = QPointF::dotProduct(toStart, toStart);
+            double endDistance = QPointF::dotProduct(toEnd, toEnd);
+
+            if (startDistance < closest) {
+                closest = startDistance;
+                next = i;
+                reverse = false;
+            }
+            if (endDistance < closest) {
+                closest = endDistance;
+                next = i;
+                reverse = true;
+            }
+        }
+
+        flown[next] = true;
+        const Sweep &sweep = sweeps[next];
+        appendLeg(path, reverse ? sweep.end : sweep.start);
+        appendLeg(path, reverse ? sweep.start : sweep.end);
+        position = path.last();
+    }
+
+    return path;
+}
+
+/**
+ * Clip the sweep lines to the polygon
+ * @return the sweeps, ordered across and then along the sweep direction
+ */
+QVector<PathSurvey::Sweep> PathSurvey::clipSweeps(const QVector<QPointF> &polygon,
+                                                 double spacing, double heading)
+{
+    QVector<Sweep> sweeps;
+
+    if (polygon.size() < 3 || spacing <= 0)
+        return sweeps;
+
+    // Work in a frame with u along the sweeps and v across them
+    double cu = cos(heading);
+    double su = sin(heading);
+    QVector<QPointF> uv(polygon.size());
+    double vMin = std::numeric_limits<double>::infinity();
+    double vMax = -vMin;
+
+    for (int i = 0; i < polygon.size(); i++) {
+        const QPointF &p = polygon[i];
+        uv[i] = QPointF(p.x() * cu + p.y() * su, -p.x() * su + p.y() * cu);
+        vMin = qMin(vMin, uv[i].y());
+        vMax = qMax(vMax, uv[i].y());
+    }
+
+    // Center the sweeps across the polygon, at least half a spacing from its sides
+    int lines = qMax(1, (int)floor((vMax - vMin) / spacing));
+    double v = (vMin + vMax - (lines - 1) * spacing) / 2;
+    QVector<double> crossings;
+
+    for (int line = 0; line < lines; line++, v += spacing) {
+        crossings.clear();
+
+        for (int i = 0; i < uv.size(); i++) {
+            const QPointF &a = uv[i];
+            const QPointF &b = uv[(i + 1) % uv.size()];
+
+            // Edges are half open across the sweeps, so a corner on the line is
+            // crossed once, or not at all where the polygon only touches it
+            if ((a.y() <= v) == (b.y() <= v))
+                continue;
+
+            crossings.append(a.x() + (v - a.y()) * (b.x() - a.x()) / (b.y() - a.y()));
+        }
+
+        // Inside the polygon between every other crossing
+        std::sort(crossings.begin(), crossings.end());
+        for (int i = 0; i + 1 < crossings.size(); i += 2) {
+            if (crossings[i + 1] - crossings[i] < MIN_SWEEP_LENGTH)
+                continue;
+
+            Sweep sweep;
+            sweep.start = QPointF(crossings[i] * cu - v * su, crossings[i] * su + v * cu);
+            sweep.end = QPointF(crossings[i + 1] * cu - v * su, crossings[i + 1] * su + v * cu);
+            sweeps.append(sweep);
+        }
+    }
+
+    return sweeps;
+}
+
+/**
+ * Add a waypoint to a path, with more in between if the leg to it is long
+ */
+void PathSurvey::appendLeg(QVector<QPointF> &path, const QPointF &to)
+{
+    if (!path.isEmpty()) {
+        QPointF from = path.last();
+        QPointF leg = to - from;
+        double length = sqrt(QPointF::dotProduct(leg, leg));
+        int pieces = (int)ceil(length / MAX_LEG_LENGTH);
+
+        for (int i = 1; i < pieces; i++)
+            path.append(from + leg * ((double)i / pieces));
+    }
+
+    path.append(to);
+}
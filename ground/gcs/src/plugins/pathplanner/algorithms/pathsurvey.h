@@ -0,0 +1,107 @@
+/**
+ ******************************************************************************
+ * @file       pathsurvey.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      Algorithm to cover an area with a survey grid
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup Path Planner Algorithms
+ * @{
+ * @brief Abstact algorithm that can be run on a path
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+#ifndef PATHSURVEY_H
+#define PATHSURVEY_H
+
+#include <QPointF>
+#include <QVector>
+#include <ipathalgorithm.h>
+
+/**
+ * Replaces a path outlining an area with a lawn-mower pattern covering it.
+ *
+ * The waypoints of the path are the corners of the polygon, which may be
+ * concave. Parallel sweeps at the given spacing and heading are clipped to
+ * the polygon, and flown in the order that takes the shortest hop from the
+ * end of one to the start of the next, so the vehicle turns around at the
+ * end of each sweep. Hops between the parts of a concave polygon go straight,
+ * and may cross outside it.
+ */
+class PATHPLANNER_EXPORT PathSurvey : public IPathAlgorithm
+{
+    Q_OBJECT
+
+public:
+    explicit PathSurvey(QObject *parent = 0);
+
+    /**
+     * Verify the path is valid to run through this algorithm
+     * @param[in] model the flight model to validate
+     * @param[out] err an error message for the user for invalid paths
+     * @return true for valid path, false for invalid
+     */
+    virtual bool verifyPath(FlightDataModel *model, QString &err);
+
+    /**
+     * Process the flight path according to the algorithm
+     * @param model the flight model to process and update
+     * @return true for success, false for failure
+     */
+    virtual bool processPath(FlightDataModel *model);
+
+    /**
+     * Present a UI to configure options for the algorithm
+     * @param callingUi the QWidget that called this algorithm
+     * @return true for success, false for failure
+     */
+    virtual bool configure(QWidget *callingUi = 0);
+
+    /**
+     * Compute the path covering a polygon
+     * @param polygon corners of the polygon, North-East
+     * @param spacing distance between sweeps [m]
+     * @param heading direction of the sweeps, clockwise from North [rad]
+     * @return the waypoints, North-East
+     */
+    static QVector<QPointF> coveragePath(const QVector<QPointF> &polygon, double spacing,
+                                         double heading);
+
+private:
+    //! Distance between sweeps [m]
+    double spacing;
+
+    //! Direction of the sweeps [deg]
+    double heading;
+
+    struct Sweep
+    {
+        QPointF start;
+        QPointF end;
+    };
+
+    //! Longest leg to put between two waypoints, below what model validation shortens
+    static const int MAX_LEG_LENGTH = 500;
+
+    static QVector<Sweep> clipSweeps(const QVector<QPointF> &polygon, double spacing,
+                                     double heading);
+    static void appendLeg(QVector<QPointF> &path, const QPointF &to);
+};
+
+#endif // PATHSURVEY_H
@@ -40,6 +40,7 @@ QMap<int, QString> FlightDataModel::modeNames = QMap<int, QString>();
 //! Initialize an empty flight plan
 FlightDataModel::FlightDataModel(QObject *parent)
     : QAbstractTableModel(parent)
+    , homeLocation(NULL)
 {
     valPaused = false;
 
@@ -251,7 +252,7 @@ bool FlightDataModel::setData(const QModelIndex &index, const QVariant &value, i
             return false;
         }
 
-        fixupValidationErrors();
+        fixupValidationErrors(index.row(), index.row());
 
         emit dataChanged(index, index);
         return true;
@@ -333,7 +334,8 @@ bool FlightDataModel::removeRows(int row, int count, const QModelIndex & /*paren
     }
     endRemoveRows();
 
-    fixupValidationErrors();
+    // Only the waypoint now at row has a different leg
+    fixupValidationErrors(row, row - 1);
 
     return true;
 }
@@ -457,6 +459,18 @@ void FlightDataModel::pauseValidation(bool pausing)
 }
 
 void FlightDataModel::fixupValidationErrors()
+{
+    fixupValidationErrors(0, rowCount() - 1);
+}
+
+/**
+ * @brief FlightDataModel::fixupValidationErrors Validate the waypoints changed, and as many
+ * after them as their correction affects. A waypoint is only checked against the one before
+ * it, so the checks stop at the first one past the change that needed no correction.
+ * @param firstRow The first waypoint changed
+ * @param lastRow The last waypoint changed
+ */
+void FlightDataModel::fixupValidationErrors(int firstRow, int lastRow)
 {
     struct FlightDataModel::NED prevNED = { 0.0, 0.0, 0.0 };
 
@@ -465,97 +479,117 @@ void FlightDataModel::fixupValidationErrors()
         return;
     }
 
-    for (int i = 0; i < rowCount(); i++) {
-        PathPlanData *row = dataStorage.at(i);
+    firstRow = qMax(firstRow, 0);
+    if (firstRow > 0 && firstRow < rowCount())
+        prevNED = getNED(firstRow - 1);
 
-        bool dirty = false;
+    for (int i = firstRow; i < rowCount(); i++) {
+        bool dirty = validateRow(i, prevNED);
 
-        struct FlightDataModel::NED thisNED = getNED(row);
+        if (i > lastRow && !dirty)
+            break;
+    }
+}
 
-        if (i == 0) {
-            switch (row->mode) {
-            case Waypoint::MODE_CIRCLELEFT:
-            case Waypoint::MODE_CIRCLERIGHT:
-                row->mode = Waypoint::MODE_VECTOR;
+/**
+ * @brief FlightDataModel::validateRow Validate a waypoint and correct it
+ * @param i The waypoint to validate
+ * @param prevNED The previous waypoint, updated to this one
+ * @return True if the waypoint was corrected
+ */
+bool FlightDataModel::validateRow(int i, struct FlightDataModel::NED &prevNED)
+{
+    PathPlanData *row = dataStorage.at(i);
 
-                showErrorDialog("Waypoint corrected",
-                                "First waypoint may not be the endpoint of an arc");
-                dirty = true;
+    bool dirty = false;
 
-                break;
-            default:
-                break;
-            }
-        }
+    struct FlightDataModel::NED thisNED = getNED(row);
 
-        double distance =
-            sqrt(pow(thisNED.North - prevNED.North, 2) + pow(thisNED.East - prevNED.East, 2));
+    if (i == 0) {
+        switch (row->mode) {
+        case Waypoint::MODE_CIRCLELEFT:
+        case Waypoint::MODE_CIRCLERIGHT:
+            row->mode = Waypoint::MODE_VECTOR;
 
-        if (distance > 600) {
-            // If the distance is more than 600m, presume it's invalid.
-            // Distances larger than this begin to become problematic
-            // with local tangent plane approximation.
-            //
-            // If this happens, move the location of this waypoint to the
-            // previous location.
+            showErrorDialog("Waypoint corrected",
+                            "First waypoint may not be the endpoint of an arc");
+            dirty = true;
 
-            thisNED = prevNED;
-            setNED(row, thisNED);
-            distance = 0;
+            break;
+        default:
+            break;
+        }
+    }
 
-            showErrorDialog("Waypoint corrected", "Over-long leg shortened.");
+    double distance =
+        sqrt(pow(thisNED.North - prevNED.North, 2) + pow(thisNED.East - prevNED.East, 2));
 
-            dirty = true;
-        }
+    if (distance > 600) {
+        // If the distance is more than 600m, presume it's invalid.
+        // Distances larger than this begin to become problematic
+        // with local tangent plane approximation.
+        //
+        // If this happens, move the location of this waypoint to the
+        // previous location.
 
-        switch (row->mode) {
-        case Waypoint::MODE_CIRCLELEFT:
-        case Waypoint::MODE_CIRCLERIGHT:
-            if (row->mode_params < (distance / 2 + 0.1f)) {
-                row->mode_params = distance / 2 + 0.2f;
+        thisNED = prevNED;
+        setNED(row, thisNED);
+        distance = 0;
 
-                showErrorDialog("Waypoint corrected", "Radius of circle increased to minimum");
+        showErrorDialog("Waypoint corrected", "Over-long leg shortened.");
 
-                dirty = true;
-            }
+        dirty = true;
+    }
 
-            break;
-        case Waypoint::MODE_CIRCLEPOSITIONLEFT:
-        case Waypoint::MODE_CIRCLEPOSITIONRIGHT:
-            if (row->mode_params < 0.5f) {
-                row->mode_params = 0.5f;
+    switch (row->mode) {
+    case Waypoint::MODE_CIRCLELEFT:
+    case Waypoint::MODE_CIRCLERIGHT:
+        if (row->mode_params < (distance / 2 + 0.1f)) {
+            row->mode_params = distance / 2 + 0.2f;
 
-                showErrorDialog("Waypoint corrected", "Radius of circle increased to minimum");
+            showErrorDialog("Waypoint corrected", "Radius of circle increased to minimum");
 
-                dirty = true;
-            } else if (row->mode_params > 300) {
-                row->mode_params = 300;
+            dirty = true;
+        }
 
-                showErrorDialog("Waypoint corrected", "Radius of circle decreased to maximum");
+        break;
+    case Waypoint::MODE_CIRCLEPOSITIONLEFT:
+    case Waypoint::MODE_CIRCLEPOSITIONRIGHT:
+        if (row->mode_params < 0.5f) {
+            row->mode_params = 0.5f;
 
-                dirty = true;
-            }
+            showErrorDialog("Waypoint corrected", "Radius of circle increased to minimum");
 
-            break;
+            dirty = true;
+        } else if (row->mode_params > 300) {
+            row->mode_params = 300;
 
-        default:
-            break;
+            showErrorDialog("Waypoint corrected", "Radius of circle decreased to maximum");
+
+            dirty = true;
         }
 
-        if (dirty) {
-            /* Let anyone listening know we changed it - Fire an event for the
-             * entire row being changed.  (Because changing NED changes lots of
-             * columns) */
-            QModelIndex leftIndex, rightIndex;
+        break;
 
-            leftIndex = this->index(i, LATPOSITION);
-            rightIndex = this->index(i, LASTCOLUMN - 1);
+    default:
+        break;
+    }
 
-            emit dataChanged(leftIndex, rightIndex);
-        }
+    if (dirty) {
+        /* Let anyone listening know we changed it - Fire an event for the
+         * entire row being changed.  (Because changing NED changes lots of
+         * columns) */
+        QModelIndex leftIndex, rightIndex;
 
-        prevNED = thisNED;
+        leftIndex = this->index(i, LATPOSITION);
+        rightIndex = this->index(i, LASTCOLUMN - 1);
+
+        emit dataChanged(leftIndex, rightIndex);
     }
+
+    prevNED = thisNED;
+
+    return dirty;
 }
 
 /**
@@ -699,12 +733,7 @@ void FlightDataModel::readFromFile(QString fileName)
  */
 bool FlightDataModel::getHomeLocation(double *homeLLA) const
 {
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    Q_ASSERT(pm);
-    UAVObjectManager *objMngr = pm->getObject<UAVObjectManager>();
-    Q_ASSERT(objMngr);
-
-    HomeLocation *home = HomeLocation::GetInstance(objMngr);
+    HomeLocation *home = getHomeLocationObject();
     if (home == NULL)
         return false;
 
@@ -724,12 +753,7 @@ bool FlightDataModel::getHomeLocation(double *homeLLA) const
  */
 bool FlightDataModel::setHomeLocation(double *homeLLA)
 {
-    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
-    Q_ASSERT(pm);
-    UAVObjectManager *objMngr = pm->getObject<UAVObjectManager>();
-    Q_ASSERT(objMngr);
-
-    HomeLocation *home = HomeLocation::GetInstance(objMngr);
+    HomeLocation *home = getHomeLocationObject();
     if (home == NULL)
         return false;
 
@@ -747,6 +771,24 @@ bool FlightDataModel::setHomeLocation(double *homeLLA)
     return true;
 }
 
+/**
+ * @brief FlightDataModel::getHomeLocationObject Get the home location UAVO, which every
+ * conversion to and from NED needs
+ */
+HomeLocation *FlightDataModel::getHomeLocationObject() const
+{
+    if (homeLocation == NULL) {
+        ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+        Q_ASSERT(pm);
+        UAVObjectManager *objMngr = pm->getObject<UAVObjectManager>();
+        Q_ASSERT(objMngr);
+
+        homeLocation = HomeLocation::GetInstance(objMngr);
+    }
+
+    return homeLocation;
+}
+
 struct FlightDataModel::NED FlightDataModel::getNED(PathPlanData *row) const
 {
     double f_NED[3];
@@ -815,12 +857,12 @@ bool FlightDataModel::replaceData(FlightDataModel *newModel)
     // Delete existing data
     removeRows(0, rowCount());
 
-    for (int i = 0; i < newModel->rowCount(); i++) {
-        insertRow(i);
-        for (int j = 0; j < newModel->columnCount(); j++) {
-            // Use Qt::UserRole to make sure the mode is fetched numerically
-            setData(index(i, j), newModel->data(newModel->index(i, j), Qt::UserRole));
-        }
+    // Copy the waypoints as they are, in one insertion, and validate them once
+    if (newModel->rowCount() > 0) {
+        beginInsertRows(QModelIndex(), 0, newModel->rowCount() - 1);
+        foreach (PathPlanData *row, newModel->dataStorage)
+            dataStorage.append(new PathPlanData(*row));
+        endInsertRows();
     }
 
     fixupValidationErrors();
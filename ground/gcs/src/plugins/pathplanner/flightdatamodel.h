@@ -30,6 +30,8 @@
 #include <QAbstractTableModel>
 #include "pathplanner_global.h"
 
+class HomeLocation;
+
 /**
  * @brief The PathPlanData struct is the internal representation
  * of the waypoints. Notice this is in absolute terms, not NED.
@@ -72,6 +74,8 @@ public:
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
     QVariant headerData(int section, Qt::Orientation orientation, int role) const;
     void fixupValidationErrors();
+    //! Validate some rows, and the rows after them their correction affects
+    void fixupValidationErrors(int firstRow, int lastRow);
 
     bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole);
     Qt::ItemFlags flags(const QModelIndex &index) const;
@@ -85,7 +89,7 @@ public:
     //! Replace a model data with another model
     bool replaceData(FlightDataModel *newModel);
 
-    //! Prevent validation/correction of data
+    //! Prevent validation/correction of data, e.g. while building a plan in a batch
     void pauseValidation(bool pausing);
 
 private:
@@ -93,6 +97,9 @@ private:
 
     bool valPaused;
 
+    //! Looked up on first use
+    mutable HomeLocation *homeLocation;
+
     //! NED representation of a location
     struct NED
     {
@@ -113,6 +120,10 @@ private:
     bool getHomeLocation(double *homeLLA) const;
     //! Set the current home location
     bool setHomeLocation(double *homeLLA);
+    HomeLocation *getHomeLocationObject() const;
+
+    //! Validate a waypoint against the one before it, and correct it
+    bool validateRow(int i, struct FlightDataModel::NED &prevNED);
 
     //! Error box for file loading
     void showErrorDialog(const char *title, const char *message);
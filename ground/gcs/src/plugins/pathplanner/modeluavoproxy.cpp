@@ -45,6 +45,15 @@ ModelUavoProxy::ModelUavoProxy(QObject *parent, FlightDataModel *model)
     Q_ASSERT(objManager != NULL);
     waypointObj = Waypoint::GetInstance(objManager);
     Q_ASSERT(waypointObj != NULL);
+
+    uploadAckedCount = 0;
+    uploadLoop = NULL;
+    uploadWatchdog = new QTimer(this);
+    uploadWatchdog->setSingleShot(true);
+    connect(uploadWatchdog, &QTimer::timeout, this, [this]() {
+        if (uploadLoop)
+            uploadLoop->quit();
+    });
 }
 
 /**
@@ -69,35 +78,24 @@ bool ModelUavoProxy::modelToObjects()
     double NED[3];
     double LLA[3];
     getHomeLocation(homeLLA);
-    bool newInstance;
 
     // Get the number of existing waypoints
     int instances = Waypoint::getNumInstances(objManager);
     int x;
 
-    // Figure out the total amount of work to do.
-    int progressMax = myModel->rowCount();
-
-    if (instances > progressMax) {
-        progressMax = instances;
-    }
+    QVector<Waypoint::DataFields> waypoints;
+    waypoints.reserve(myModel->rowCount() + 1);
 
     for (x = 0; x < myModel->rowCount(); x++) {
-        newInstance = false;
-        Waypoint *wp = NULL; // Shadows above wp
-
-        // Create new instances of waypoints if this is more than exist
+        // Create new instances of waypoints if this is more than exist. The board
+        // creates them as they arrive, along with any missing before them.
         if (x >= instances) {
-            newInstance = true;
-            wp = new Waypoint;
+            Waypoint *wp = new Waypoint; // Shadows above wp
             wp->initialize(x, wp->getMetaObject());
             objManager->registerObject(wp);
-        } else {
-            wp = Waypoint::GetInstance(objManager, x);
         }
 
-        Q_ASSERT(wp);
-        Waypoint::DataFields waypoint = wp->getData();
+        Waypoint::DataFields waypoint = Waypoint::GetInstance(objManager, x)->getData();
 
         // Convert from LLA to NED for sending to the model
         LLA[0] = myModel->data(myModel->index(x, FlightDataModel::LATPOSITION)).toDouble();
@@ -115,82 +113,101 @@ bool ModelUavoProxy::modelToObjects()
         waypoint.ModeParameters =
             myModel->data(myModel->index(x, FlightDataModel::MODE_PARAMS)).toFloat();
 
-        if (robustUpdate(waypoint, x)) {
-            qDebug() << "Successfully updated";
-            emit sendPathPlanToUavProgress(100 * (x + 1) / progressMax);
-        } else {
-            qDebug() << "Upload failed";
-            emit sendPathPlanToUavProgress(100 * (x + 1) / progressMax);
-            return false;
-        }
-        if (newInstance) {
-            QEventLoop m_eventloop;
-            QTimer::singleShot(800, &m_eventloop, &QEventLoop::quit);
-            m_eventloop.exec();
-        }
+        waypoints.append(waypoint);
     }
 
-    /* Continue iterating over any instance indices that aren't needed to
-     * represent our model, and mark them invalid.  */
-    for (; x < instances; x++) {
-        Waypoint *wp = Waypoint::GetInstance(objManager, x);
-        // shadows wp above
-
-        Waypoint::DataFields waypoint = wp->getData();
-
+    /* The path ends at the first invalid waypoint, for the path planner as
+     * well as when reading it back, so any instances beyond the new path
+     * only need the one after its end marked invalid. */
+    if (x < instances) {
+        Waypoint::DataFields waypoint = Waypoint::GetInstance(objManager, x)->getData();
         waypoint.Mode = Waypoint::MODE_INVALID;
-        if (robustUpdate(waypoint, x)) {
-            qDebug() << "Successfully updated";
-            emit sendPathPlanToUavProgress(100 * (x + 1) / progressMax);
-        } else {
-            qDebug() << "Upload failed";
-            emit sendPathPlanToUavProgress(100 * (x + 1) / progressMax);
-            return false;
-        }
+        waypoints.append(waypoint);
     }
 
+    bool success = uploadWaypoints(waypoints);
+
     wp->setMetadata(initialMeta);
-    return true;
+    return success;
 }
 
 /**
- * @brief robustUpdate Upload a waypoint and check for an ACK or retry.
- * @param data The data to set
- * @param instance The instance id
- * @return True if set succeed, false otherwise
+ * @brief uploadWaypoints Send waypoints to the board, keeping several at a time
+ * awaiting their ack, rather than one after the other
+ *
+ * Telemetry retries each of them by itself. Those that still fail are sent
+ * again once the others are done, up to a few times.
+ * @param waypoints Data of the instances from 0 on
+ * @return True if every waypoint was acked, false otherwise
  */
-bool ModelUavoProxy::robustUpdate(Waypoint::DataFields data, int instance)
+bool ModelUavoProxy::uploadWaypoints(const QVector<Waypoint::DataFields> &waypoints)
 {
-    Waypoint *wp = Waypoint::GetInstance(objManager, instance);
-    connect(wp, QOverload<UAVObject *, bool>::of(&Waypoint::transactionCompleted), this,
-            &ModelUavoProxy::waypointTransactionCompleted);
-
-    for (int i = 0; i < 10; i++) {
-        QEventLoop m_eventloop;
-        QTimer::singleShot(1000, &m_eventloop, &QEventLoop::quit);
-        connect(this, &ModelUavoProxy::waypointTransactionSucceeded, &m_eventloop,
-                &QEventLoop::quit);
-        connect(this, &ModelUavoProxy::waypointTransactionFailed, &m_eventloop, &QEventLoop::quit);
-        waypointTransactionResult.insert(instance, false);
-        wp->setData(data);
-        wp->updated();
-        m_eventloop.exec();
-        if (waypointTransactionResult.value(instance)) {
-            disconnect(wp, QOverload<UAVObject *, bool>::of(&Waypoint::transactionCompleted), this,
-                       &ModelUavoProxy::waypointTransactionCompleted);
-            return true;
+    uploadData = waypoints;
+    uploadAcked.fill(false, waypoints.size());
+    uploadAckedCount = 0;
+
+    for (int i = 0; i < waypoints.size(); i++)
+        connect(Waypoint::GetInstance(objManager, i),
+                QOverload<UAVObject *, bool>::of(&Waypoint::transactionCompleted), this,
+                &ModelUavoProxy::waypointTransactionCompleted);
+
+    for (int round = 0; round < UPLOAD_ROUNDS && uploadAckedCount < waypoints.size(); round++) {
+        uploadQueue.clear();
+        for (int i = 0; i < waypoints.size(); i++) {
+            if (!uploadAcked.at(i))
+                uploadQueue.append(i);
+        }
+
+        QEventLoop loop;
+        uploadLoop = &loop;
+
+        // Waypoints may fail right away, e.g. when not connected
+        sendNextWaypoints();
+        if (!uploadInFlight.isEmpty()) {
+            uploadWatchdog->start(UPLOAD_TIMEOUT_MS);
+            loop.exec();
+            uploadWatchdog->stop();
         }
 
-        // Wait a second for next attempt
-        QTimer::singleShot(500, &m_eventloop, &QEventLoop::quit);
-        m_eventloop.exec();
+        uploadLoop = NULL;
+
+        if (!uploadInFlight.isEmpty()) {
+            qDebug() << "[ModelUavoProxy] No acks for" << uploadInFlight.size() << "waypoints";
+            uploadInFlight.clear();
+        }
+        if (uploadAckedCount < waypoints.size())
+            qDebug() << "[ModelUavoProxy]" << waypoints.size() - uploadAckedCount
+                     << "waypoints failed to upload";
     }
 
-    disconnect(wp, QOverload<UAVObject *, bool>::of(&Waypoint::transactionCompleted), this,
-               &ModelUavoProxy::waypointTransactionCompleted);
+    for (int i = 0; i < waypoints.size(); i++)
+        disconnect(Waypoint::GetInstance(objManager, i),
+                   QOverload<UAVObject *, bool>::of(&Waypoint::transactionCompleted), this,
+                   &ModelUavoProxy::waypointTransactionCompleted);
+
+    uploadQueue.clear();
+    uploadData.clear();
+
+    return uploadAckedCount == waypoints.size();
+}
+
+/**
+ * @brief sendNextWaypoints Send queued waypoints until the window is full
+ */
+void ModelUavoProxy::sendNextWaypoints()
+{
+    while (uploadInFlight.size() < UPLOAD_WINDOW && !uploadQueue.isEmpty()) {
+        int instance = uploadQueue.takeFirst();
+        Waypoint *wp = Waypoint::GetInstance(objManager, instance);
+
+        // In flight before updating, a failure may be reported from within
+        uploadInFlight.insert(instance);
+        wp->setData(uploadData.at(instance));
+        wp->updated();
+    }
 
-    // None of the attempt got an ack
-    return false;
+    if (uploadInFlight.isEmpty() && uploadLoop)
+        uploadLoop->quit();
 }
 
 /**
@@ -200,14 +217,22 @@ bool ModelUavoProxy::robustUpdate(Waypoint::DataFields data, int instance)
 void ModelUavoProxy::waypointTransactionCompleted(UAVObject *obj, bool success)
 {
     Q_ASSERT(obj->getObjID() == Waypoint::OBJID);
-    waypointTransactionResult.insert(obj->getInstID(), success);
+
+    int instance = obj->getInstID();
+    if (!uploadInFlight.remove(instance))
+        return;
+
     if (success) {
-        qDebug() << "Success " << obj->getInstID();
-        emit waypointTransactionSucceeded();
+        uploadAcked[instance] = true;
+        uploadAckedCount++;
+        emit sendPathPlanToUavProgress(100 * uploadAckedCount / uploadData.size());
     } else {
-        qDebug() << "Failed transaction " << obj->getInstID();
-        emit waypointTransactionFailed();
+        qDebug() << "[ModelUavoProxy] Failed transaction" << instance;
     }
+
+    if (uploadLoop)
+        uploadWatchdog->start(UPLOAD_TIMEOUT_MS);
+    sendNextWaypoints();
 }
 
 /**
@@ -26,11 +26,17 @@
 #ifndef ModelUavoProxy_H
 #define ModelUavoProxy_H
 
+#include <QList>
 #include <QObject>
+#include <QSet>
+#include <QVector>
 #include "flightdatamodel.h"
 #include "modeluavoproxy.h"
 #include "waypoint.h"
 
+class QEventLoop;
+class QTimer;
+
 class ModelUavoProxy : public QObject
 {
     Q_OBJECT
@@ -38,8 +44,11 @@ public:
     explicit ModelUavoProxy(QObject *parent, FlightDataModel *model);
 
 private:
-    //! Robustly upload a waypoint (like smart save)
-    bool robustUpdate(Waypoint::DataFields data, int instance);
+    //! Upload waypoints, several at a time, re-sending only those not acked
+    bool uploadWaypoints(const QVector<Waypoint::DataFields> &waypoints);
+
+    //! Fill the window of waypoints awaiting their ack
+    void sendNextWaypoints();
 
     //! Fetch the home LLA position
     bool getHomeLocation(double *homeLLA);
@@ -55,17 +64,28 @@ public slots:
     void waypointTransactionCompleted(UAVObject *, bool);
 
 signals:
-    void waypointTransactionSucceeded();
-    void waypointTransactionFailed();
     void sendPathPlanToUavProgress(int percent);
 
 private:
+    //! Waypoints awaiting their ack at once, well within the telemetry queue
+    static const int UPLOAD_WINDOW = 8;
+    //! Passes over the waypoints not acked yet before giving up
+    static const int UPLOAD_ROUNDS = 5;
+    //! Longest to wait for any ack, telemetry times out and retries before
+    static const int UPLOAD_TIMEOUT_MS = 10000;
+
     UAVObjectManager *objManager;
     Waypoint *waypointObj;
     FlightDataModel *myModel;
 
-    //! Track if each waypoint was updated
-    QMap<int, bool> waypointTransactionResult;
+    //! State of the upload in progress
+    QVector<Waypoint::DataFields> uploadData;
+    QVector<bool> uploadAcked;
+    int uploadAckedCount;
+    QList<int> uploadQueue;
+    QSet<int> uploadInFlight;
+    QEventLoop *uploadLoop;
+    QTimer *uploadWatchdog;
 };
 
 #endif // ModelUavoProxy_H
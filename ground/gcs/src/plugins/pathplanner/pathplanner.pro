@@ -23,6 +23,7 @@ HEADERS += flightdatamodel.h
 HEADERS += modeluavoproxy.h
 HEADERS += ipathalgorithm.h
 HEADERS += algorithms/pathfillet.h
+HEADERS += algorithms/pathsurvey.h
 
 SOURCES += pathplannergadget.cpp \
     waypointdialog.cpp \
@@ -34,6 +35,7 @@ SOURCES += pathplannerplugin.cpp
 SOURCES += flightdatamodel.cpp
 SOURCES += modeluavoproxy.cpp
 SOURCES += algorithms/pathfillet.cpp
+SOURCES += algorithms/pathsurvey.cpp
 
 OTHER_FILES += PathPlanner.pluginspec
 
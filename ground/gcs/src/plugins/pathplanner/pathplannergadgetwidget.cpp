@@ -27,6 +27,7 @@
 #include "waypointdelegate.h"
 #include "ui_pathplanner.h"
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QString>
 #include <QStringList>
 #include <QWidget>
@@ -35,6 +36,7 @@
 #include <QPushButton>
 
 #include "algorithms/pathfillet.h"
+#include "algorithms/pathsurvey.h"
 #include "extensionsystem/pluginmanager.h"
 
 PathPlannerGadgetWidget::PathPlannerGadgetWidget(QWidget *parent)
@@ -161,23 +163,44 @@ void PathPlannerGadgetWidget::on_tbFetchFromUAV_clicked()
  */
 void PathPlannerGadgetWidget::on_tbFilletPath_clicked()
 {
-    // Create a copy of the model before filleting
+    runPathAlgorithm(new PathFillet(this));
+}
+
+/**
+ * @brief PathPlannerGadgetWidget::on_tbSurveyPath_clicked Replace the path with a survey of
+ * the area it outlines
+ */
+void PathPlannerGadgetWidget::on_tbSurveyPath_clicked()
+{
+    runPathAlgorithm(new PathSurvey(this));
+}
+
+/**
+ * @brief PathPlannerGadgetWidget::runPathAlgorithm Run an algorithm on the current path,
+ * keeping a copy of the path to restore
+ */
+void PathPlannerGadgetWidget::runPathAlgorithm(IPathAlgorithm *algo)
+{
+    // Create a copy of the model before processing
     if (!prevModel)
         prevModel = new FlightDataModel(this);
     Q_ASSERT(prevModel);
     if (prevModel)
         prevModel->replaceData(model);
 
-    IPathAlgorithm *algo = new PathFillet(this);
     // Only process is successfully configured and the verification of the model succeeds
     QString err;
-    if (algo->configure(this) && algo->verifyPath(model, err)) {
-        // If unsuccessful delete the cached model
-        if (!algo->processPath(model)) {
+    if (algo->configure(this)) {
+        if (!algo->verifyPath(model, err)) {
+            QMessageBox::warning(this, tr("Invalid path"), err);
+        } else if (!algo->processPath(model)) {
+            // If unsuccessful delete the cached model
             delete prevModel;
             prevModel = NULL;
         }
     }
+
+    delete algo;
 }
 
 /**
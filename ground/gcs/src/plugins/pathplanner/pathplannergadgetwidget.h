@@ -33,6 +33,7 @@
 #include "modeluavoproxy.h"
 
 class Ui_PathPlanner;
+class IPathAlgorithm;
 
 class PATHPLANNER_EXPORT PathPlannerGadgetWidget : public QLabel
 {
@@ -63,6 +64,9 @@ private slots:
     //! Apply filets to the path
     void on_tbFilletPath_clicked();
 
+    //! Cover the area outlined by the path
+    void on_tbSurveyPath_clicked();
+
     //! Restore path before filleting
     void on_tbUnfilletPath_clicked();
 
@@ -77,6 +81,7 @@ private:
     //! Store previous models for rolling back changes
     FlightDataModel *prevModel;
     void enableButtons(bool);
+    void runPathAlgorithm(IPathAlgorithm *algo);
 signals:
     void sendPathPlanToUAV();
     void receivePathPlanFromUAV();
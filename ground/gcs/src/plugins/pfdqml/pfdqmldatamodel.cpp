@@ -0,0 +1,126 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "pfdqmldatamodel.h"
+#include "uavobjects/uavobject.h"
+
+#include <QMetaProperty>
+#include <QQmlPropertyMap>
+#include <QtQuick/QQuickWindow>
+
+PfdQmlDataModel::PfdQmlDataModel(QQuickWindow *window, QObject *parent)
+    : QObject(parent)
+    , window(window)
+    , framePending(false)
+    , suspended(false)
+{
+    // Emitted on the GUI thread for every frame, whichever render loop is in
+    // use. beforeSynchronizing would be too, but on the render thread.
+    connect(window, &QQuickWindow::afterAnimating, this, &PfdQmlDataModel::sample);
+}
+
+QQmlPropertyMap *PfdQmlDataModel::exportObject(const QString &name, UAVObject *object)
+{
+    Export &e = exports[name];
+
+    if (!e.map) {
+        e.map = new QQmlPropertyMap(this);
+    } else if (e.object == object) {
+        return e.map;
+    } else {
+        disconnect(e.object, &UAVObject::objectUpdated, this, &PfdQmlDataModel::objectUpdated);
+    }
+
+    // The fields are the properties of the generated class, past UAVObject's
+    e.object = object;
+    e.properties.clear();
+    const QMetaObject *meta = object->metaObject();
+    for (int i = UAVObject::staticMetaObject.propertyCount(); i < meta->propertyCount(); i++)
+        e.properties.append(meta->property(i).name());
+
+    if (!suspended)
+        connect(object, &UAVObject::objectUpdated, this, &PfdQmlDataModel::objectUpdated);
+
+    // Start out right away, the map is handed to QML before the next frame
+    sampleExport(e);
+
+    return e.map;
+}
+
+void PfdQmlDataModel::removeObject(const QString &name)
+{
+    QHash<QString, Export>::iterator it = exports.find(name);
+    if (it == exports.end())
+        return;
+
+    disconnect(it->object, &UAVObject::objectUpdated, this, &PfdQmlDataModel::objectUpdated);
+    it->map->deleteLater();
+    exports.erase(it);
+}
+
+void PfdQmlDataModel::setSuspended(bool suspended)
+{
+    if (this->suspended == suspended)
+        return;
+
+    this->suspended = suspended;
+
+    for (QHash<QString, Export>::iterator it = exports.begin(); it != exports.end(); ++it) {
+        if (suspended) {
+            disconnect(it->object, &UAVObject::objectUpdated, this,
+                       &PfdQmlDataModel::objectUpdated);
+        } else {
+            connect(it->object, &UAVObject::objectUpdated, this, &PfdQmlDataModel::objectUpdated);
+            sampleExport(*it);
+        }
+    }
+}
+
+void PfdQmlDataModel::objectUpdated(UAVObject *object)
+{
+    for (QHash<QString, Export>::iterator it = exports.begin(); it != exports.end(); ++it) {
+        if (it->object == object)
+            it->dirty = true;
+    }
+
+    // One frame picks up any number of updates
+    if (!framePending) {
+        framePending = true;
+        window->update();
+    }
+}
+
+void PfdQmlDataModel::sample()
+{
+    framePending = false;
+
+    for (QHash<QString, Export>::iterator it = exports.begin(); it != exports.end(); ++it) {
+        if (it->dirty)
+            sampleExport(*it);
+    }
+}
+
+void PfdQmlDataModel::sampleExport(Export &e)
+{
+    e.dirty = false;
+
+    // Only fields that changed notify their bindings
+    foreach (const QByteArray &property, e.properties) {
+        const QString key = QString::fromLatin1(property);
+        QVariant value = e.object->property(property.constData());
+        if (!e.map->contains(key) || e.map->value(key) != value)
+            e.map->insert(key, value);
+    }
+}
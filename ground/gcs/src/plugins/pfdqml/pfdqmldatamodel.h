@@ -0,0 +1,90 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PFDQMLDATAMODEL_H_
+#define PFDQMLDATAMODEL_H_
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+class QQmlPropertyMap;
+class QQuickWindow;
+class UAVObject;
+
+/**
+ * @brief Mirrors the fields of the UAVObjects shown by the PFD, for QML.
+ *
+ * Bindings on a UAVObject itself are evaluated on every update, however
+ * often telemetry sends it. Here an update only marks the object dirty and
+ * asks the window for a frame. The fields of the dirty objects are copied to
+ * their maps once per frame, after animations are advanced and before the
+ * scene is synchronized, so bindings see at most one change per frame.
+ */
+class PfdQmlDataModel : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PfdQmlDataModel(QQuickWindow *window, QObject *parent = 0);
+
+    /**
+     * @brief Mirror an object under a name, replacing the object mirrored
+     * under that name before, if any
+     * @return the map for QML, with a property for each field of the object
+     */
+    QQmlPropertyMap *exportObject(const QString &name, UAVObject *object);
+
+    /**
+     * @brief Stop mirroring the object exported as name
+     */
+    void removeObject(const QString &name);
+
+    /**
+     * @brief Stop following updates while the PFD isn't shown, and bring the
+     * maps up to date when it is again
+     */
+    void setSuspended(bool suspended);
+
+private slots:
+    void objectUpdated(UAVObject *object);
+    void sample();
+
+private:
+    struct Export
+    {
+        Export()
+            : object(0)
+            , map(0)
+            , dirty(false)
+        {
+        }
+
+        UAVObject *object;
+        QQmlPropertyMap *map;
+        QList<QByteArray> properties;
+        bool dirty;
+    };
+
+    void sampleExport(Export &e);
+
+    QQuickWindow *window;
+    QHash<QString, Export> exports;
+    bool framePending;
+    bool suspended;
+};
+
+#endif /* PFDQMLDATAMODEL_H_ */
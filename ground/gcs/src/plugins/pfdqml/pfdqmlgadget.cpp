@@ -44,3 +44,8 @@ void PfdQmlGadget::loadConfiguration(IUAVGadgetConfiguration *config)
     m_widget->setQmlFile(m->qmlFile());
     m_widget->setSettingsMap(m->settings());
 }
+
+void PfdQmlGadget::setActive(bool active)
+{
+    m_widget->setActive(active);
+}
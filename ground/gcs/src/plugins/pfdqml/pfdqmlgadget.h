@@ -45,6 +45,7 @@ public:
     }
 
     void loadConfiguration(IUAVGadgetConfiguration *config);
+    void setActive(bool active);
 
 private:
     QWidget *m_container;
@@ -14,6 +14,7 @@
  */
 
 #include "pfdqmlgadgetwidget.h"
+#include "pfdqmldatamodel.h"
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjects/uavobjectmanager.h"
 #include "uavobjects/uavobject.h"
@@ -52,6 +53,7 @@ PfdQmlGadgetWidget::PfdQmlGadgetWidget(QWindow *parent)
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     m_objManager = pm->getObject<UAVObjectManager>();
+    m_dataModel = new PfdQmlDataModel(this, this);
 
     foreach (const QString &objectName, objectsToExport) {
         exportUAVOInstance(objectName, 0);
@@ -66,9 +68,9 @@ PfdQmlGadgetWidget::~PfdQmlGadgetWidget()
 }
 
 /**
- * @brief PfdQmlGadgetWidget::exportUAVOInstance Makes the UAVO available inside the QML. This works
- * via the Q_PROPERTY()
- * values in the UAVO synthetic-headers
+ * @brief PfdQmlGadgetWidget::exportUAVOInstance Makes the UAVO available inside the QML. The QML
+ * sees a copy of the Q_PROPERTY() values in the UAVO synthetic-headers, which the data model
+ * updates at most once per frame
  * @param objectName UAVObject name
  * @param instId Instance ID
  */
@@ -76,7 +78,8 @@ void PfdQmlGadgetWidget::exportUAVOInstance(const QString &objectName, int instI
 {
     UAVObject *object = m_objManager->getObject(objectName, instId);
     if (object)
-        engine()->rootContext()->setContextProperty(objectName, object);
+        engine()->rootContext()->setContextProperty(objectName,
+                                                    m_dataModel->exportObject(objectName, object));
     else
         qWarning() << "[PFDQML] Failed to load object" << objectName;
 }
@@ -89,10 +92,20 @@ void PfdQmlGadgetWidget::exportUAVOInstance(const QString &objectName, int instI
 void PfdQmlGadgetWidget::resetUAVOExport(const QString &objectName, int instId)
 {
     UAVObject *object = m_objManager->getObject(objectName, instId);
-    if (object)
+    if (object) {
         engine()->rootContext()->setContextProperty(objectName, (QObject *)NULL);
-    else
+        m_dataModel->removeObject(objectName);
+    } else {
         qWarning() << "Failed to load object" << objectName;
+    }
+}
+
+/**
+ * @brief Follow the exported objects only while the gadget's workspace is shown
+ */
+void PfdQmlGadgetWidget::setActive(bool active)
+{
+    m_dataModel->setSuspended(!active);
 }
 
 void PfdQmlGadgetWidget::setQmlFile(QString fn)
@@ -19,6 +19,7 @@
 #include "pfdqmlgadgetconfiguration.h"
 #include <QtQuick/QQuickView>
 
+class PfdQmlDataModel;
 class UAVObjectManager;
 
 class PfdQmlGadgetWidget : public QQuickView
@@ -29,9 +30,12 @@ public:
     PfdQmlGadgetWidget(QWindow *parent = 0);
     ~PfdQmlGadgetWidget();
     void setQmlFile(QString fn);
+    void setActive(bool active);
 
 public slots:
     void setSettingsMap(const QVariantMap &settings);
+    // Also used by the QML to follow the active waypoint
+    void exportUAVOInstance(const QString &objectName, int instId);
 
 protected:
     void mouseReleaseEvent(QMouseEvent *event);
@@ -41,7 +45,7 @@ private:
     QString m_qmlFileName;
 
     UAVObjectManager *m_objManager;
-    void exportUAVOInstance(const QString &objectName, int instId);
+    PfdQmlDataModel *m_dataModel;
     void resetUAVOExport(const QString &objectName, int instId);
 };
 
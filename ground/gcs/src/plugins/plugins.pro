@@ -15,6 +15,8 @@ SUBDIRS += plugin_emptygadget
 # Debug Gadget plugin
 plugin_debuggadget.subdir = debuggadget
 plugin_debuggadget.depends = plugin_coreplugin
+plugin_debuggadget.depends += plugin_uavobjects
+plugin_debuggadget.depends += plugin_uavtalk
 SUBDIRS += plugin_debuggadget
 
 # Welcome plugin
@@ -42,6 +44,7 @@ SUBDIRS += plugin_uavtalk
 plugin_uavtalk.subdir = uavtalk
 plugin_uavtalk.depends = plugin_uavobjects
 plugin_uavtalk.depends += plugin_coreplugin
+plugin_uavtalk.depends += plugin_uavobjectutil
 
 # OPMap UAVGadget
 !LIGHTWEIGHT_GCS {
@@ -259,6 +262,13 @@ plugin_sysalarmsmessaging.depends += plugin_uavobjects
 plugin_sysalarmsmessaging.depends += plugin_uavtalk
 SUBDIRS += plugin_sysalarmsmessaging
 
+# Telemetry tap plugin
+plugin_telemetrytap.subdir = telemetrytap
+plugin_telemetrytap.depends = plugin_coreplugin
+plugin_telemetrytap.depends += plugin_uavobjects
+plugin_telemetrytap.depends += plugin_uavtalk
+SUBDIRS += plugin_telemetrytap
+
 # Usage Statistics plugin
 plugin_usagestatsgadget.subdir = usagestatsgadget
 plugin_usagestatsgadget.depends = plugin_coreplugin
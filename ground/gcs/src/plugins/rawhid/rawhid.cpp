@@ -45,8 +45,42 @@ static const int WRITE_SIZE = 64;
 
 static const int WRITE_RETRIES = 10;
 
+quint32 RawHIDRingBuffer::write(const char *data, quint32 size)
+{
+    const quint32 head = m_head.loadAcquire();
+
+    size = qMin(size, SIZE - (head - m_tail.loadAcquire()));
+
+    const quint32 offset = head & (SIZE - 1);
+    const quint32 first = qMin(size, SIZE - offset);
+    memcpy(m_buffer + offset, data, first);
+    memcpy(m_buffer, data + first, size - first);
+
+    m_head.storeRelease(head + size);
+
+    return size;
+}
+
+quint32 RawHIDRingBuffer::copy(char *data, quint32 size) const
+{
+    const quint32 tail = m_tail.loadAcquire();
+
+    size = qMin(size, m_head.loadAcquire() - tail);
+
+    // At most two contiguous spans, either side of the wrap
+    const quint32 offset = tail & (SIZE - 1);
+    const quint32 first = qMin(size, SIZE - offset);
+    memcpy(data, m_buffer + offset, first);
+    memcpy(data + first, m_buffer, size - first);
+
+    return size;
+}
+
+// *********************************************************************************
+
 RawHIDReadThread::RawHIDReadThread(hid_device *handle)
-    : m_handle(handle)
+    : m_readyPending(0)
+    , m_handle(handle)
     , m_running(true)
 {
 }
@@ -77,15 +111,14 @@ void RawHIDReadThread::run()
 
         if (ret > 0) // read some data
         {
-            QMutexLocker lock(&m_readBufMtx);
-
-            bool needSignal = m_readBuffer.size() == 0;
-
             // Note: Preprocess the USB packets in this OS independent code
             // First byte is report ID, second byte is the number of valid bytes
-            m_readBuffer.append((char *)&buffer[2], buffer[1]);
+            quint32 length = qMin<quint32>(buffer[1], READ_SIZE - 2);
+            if (m_readBuffer.write((char *)&buffer[2], length) != length)
+                RAW_HID_QXTLOG_DEBUG("Read buffer full: data from device dropped.");
 
-            if (needSignal) {
+            // One pending signal at a time, the reader drains everything it finds
+            if (m_readyPending.testAndSetOrdered(0, 1)) {
                 emit readyToRead();
             }
         } else if (ret == 0) // nothing read
@@ -100,26 +133,22 @@ void RawHIDReadThread::run()
 
 int RawHIDReadThread::getReadData(char *data, int size)
 {
-    QMutexLocker lock(&m_readBufMtx);
-
-    size = qMin(size, m_readBuffer.size());
-
-    memcpy(data, m_readBuffer.constData(), size);
-    m_readBuffer.remove(0, size);
+    size = m_readBuffer.copy(data, size);
+    m_readBuffer.consume(size);
 
     return size;
 }
 
 qint64 RawHIDReadThread::getBytesAvailable()
 {
-    QMutexLocker lock(&m_readBufMtx);
-    return m_readBuffer.size();
+    return m_readBuffer.used();
 }
 
 // *********************************************************************************
 
 RawHIDWriteThread::RawHIDWriteThread(hid_device *handle)
-    : m_handle(handle)
+    : m_coalesceWindowUs(0)
+    , m_handle(handle)
     , m_running(true)
 {
 }
@@ -133,53 +162,61 @@ void RawHIDWriteThread::run()
     connect(this, &QThread::finished, this, &QObject::deleteLater);
 
     int retry = 0;
-    while (m_running) {
-        unsigned char buffer[WRITE_SIZE] = { 0 };
-        int size;
-
+    bool failed = false;
+    while (m_running && !failed) {
         {
             QMutexLocker lock(&m_writeBufMtx);
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
 
-            while (m_running && (size <= 0)) {
+            while (m_running && (m_writeBuffer.used() == 0)) {
                 m_newDataToWrite.wait(&m_writeBufMtx);
-
-                size = m_writeBuffer.size();
             }
+        }
+
+        // Let the small frames of a burst gather into whole reports
+        int window = m_coalesceWindowUs.loadAcquire();
+        if (window > 0 && m_writeBuffer.used() < (quint32)(WRITE_SIZE - 2)) {
+            this->usleep(window);
+        }
+
+        // Then send everything queued back to back, one report per write
+        while (m_running) {
+            unsigned char buffer[WRITE_SIZE] = { 0 };
 
             // NOTE: data size is limited to 2 bytes less than the
             // usb packet size (64 bytes for interrupt) to make room
             // for the reportID and valid data length
-            size = qMin(WRITE_SIZE - 2, m_writeBuffer.size());
-            memcpy(&buffer[2], m_writeBuffer.constData(), size);
+            int size = m_writeBuffer.copy((char *)&buffer[2], WRITE_SIZE - 2);
+
+            if (size == 0) {
+                break;
+            }
 
             buffer[0] = 2; // reportID
             buffer[1] = size; // valid data length
-        }
-
-        // must hold lock through the send to know how much was sent
-        int ret = hid_write(m_handle, buffer, WRITE_SIZE);
 
-        if (ret > 0) {
-            // only remove the size actually written to the device
-            QMutexLocker lock(&m_writeBufMtx);
-            m_writeBuffer.remove(0, size);
-        } else if (ret == -110) // timeout
-        {
-            // timeout occured
-            RAW_HID_QXTLOG_DEBUG("Send Timeout: No data written to device.");
-        } else if (ret < 0) // < 0 => error
-        {
-            ++retry;
-            if (retry > WRITE_RETRIES) {
-                retry = 0;
-                qWarning() << "[RawHID] Error writing to device";
-                break; // Exit the loop but keep running.
+            int ret = hid_write(m_handle, buffer, WRITE_SIZE);
+
+            if (ret > 0) {
+                // only remove the size actually written to the device
+                m_writeBuffer.consume(size);
+            } else if (ret == -110) // timeout
+            {
+                // timeout occured
+                RAW_HID_QXTLOG_DEBUG("Send Timeout: No data written to device.");
+            } else if (ret < 0) // < 0 => error
+            {
+                ++retry;
+                if (retry > WRITE_RETRIES) {
+                    retry = 0;
+                    qWarning() << "[RawHID] Error writing to device";
+                    failed = true; // Exit the loop but keep running.
+                    break;
+                } else {
+                    this->msleep(40);
+                }
             } else {
-                this->msleep(40);
+                RAW_HID_QXTLOG_DEBUG("No data written to device ??");
             }
-        } else {
-            RAW_HID_QXTLOG_DEBUG("No data written to device ??");
         }
     }
 
@@ -206,9 +243,10 @@ void RawHIDWriteThread::stop()
 
 int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 {
-    QMutexLocker lock(&m_writeBufMtx);
+    size = m_writeBuffer.write(data, size);
 
-    m_writeBuffer.append(data, size);
+    // Taking the lock orders this against the thread checking for data before it sleeps
+    QMutexLocker lock(&m_writeBufMtx);
     m_newDataToWrite.wakeOne(); // signal that new data arrived
 
     return size;
@@ -216,7 +254,7 @@ int RawHIDWriteThread::pushDataToWrite(const char *data, int size)
 
 qint64 RawHIDWriteThread::getBytesToWrite()
 {
-    return m_writeBuffer.size();
+    return m_writeBuffer.used();
 }
 
 // *********************************************************************************
@@ -226,9 +264,18 @@ RawHID::RawHID(USBDevice *deviceStructure)
     , m_deviceInfo(deviceStructure)
     , m_readThread(NULL)
     , m_writeThread(NULL)
+    , m_writeCoalesceUs(DEFAULT_WRITE_COALESCE_US)
 {
 }
 
+void RawHID::setWriteCoalesceWindow(int us)
+{
+    m_writeCoalesceUs = qMax(us, 0);
+
+    if (m_writeThread)
+        m_writeThread->setCoalesceWindow(m_writeCoalesceUs);
+}
+
 RawHID::~RawHID()
 {
     hid_exit();
@@ -248,6 +295,7 @@ bool RawHID::open(OpenMode mode)
         m_handle = handle;
 
         m_writeThread = new RawHIDWriteThread(m_handle);
+        m_writeThread->setCoalesceWindow(m_writeCoalesceUs);
         m_readThread = new RawHIDReadThread(m_handle);
 
         // Plumb through read thread's ready read signal to our clients
@@ -265,6 +313,10 @@ bool RawHID::open(OpenMode mode)
 
 void RawHID::sendReadyRead()
 {
+    // Before reading, so data arriving from here on is signalled again
+    if (m_readThread)
+        m_readThread->clearReadyToRead();
+
     emit readyRead();
 }
 
@@ -30,6 +30,7 @@
 
 #include "rawhid_global.h"
 
+#include <QAtomicInt>
 #include <QByteArray>
 #include <QIODevice>
 #include <QMutex>
@@ -49,6 +50,41 @@
 #define RAW_HID_QXTLOG_DEBUG(...)
 #endif // RAW_HID_DEBUG
 
+/**
+*   Fixed size byte queue between one producer and one consumer thread,
+*   without locks.  Head and tail are free running byte counts.
+*/
+class RawHIDRingBuffer
+{
+public:
+    // Must be a power of two
+    static const quint32 SIZE = 64 * 1024;
+
+    RawHIDRingBuffer()
+        : m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    /** Bytes queued, only exact from the producer or consumer thread */
+    quint32 used() const { return m_head.loadAcquire() - m_tail.loadAcquire(); }
+
+    /** Producer: queue what fits of data, returns the bytes queued */
+    quint32 write(const char *data, quint32 size);
+
+    /** Consumer: copy from the front without dequeuing, returns the bytes copied */
+    quint32 copy(char *data, quint32 size) const;
+    /** Consumer: dequeue bytes from the front */
+    void consume(quint32 size) { m_tail.storeRelease(m_tail.loadAcquire() + size); }
+
+private:
+    char m_buffer[SIZE];
+    QAtomicInteger<quint32> m_head; // Only advanced by the producer
+    QAtomicInteger<quint32> m_tail; // Only advanced by the consumer
+};
+
+// *********************************************************************************
+
 /**
 *   Thread to desynchronize reading from the device
 */
@@ -66,6 +102,9 @@ public:
     /** return the bytes buffered */
     qint64 getBytesAvailable();
 
+    /** The reader got readyToRead(), which is emitted again for any data after this */
+    void clearReadyToRead() { m_readyPending.storeRelease(0); }
+
     void stop() { m_running = false; }
 
 signals:
@@ -74,12 +113,10 @@ signals:
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-    a circular buffer but it's good enough and very simple */
-    QByteArray m_readBuffer;
+    /** Filled by this thread, drained by the reader */
+    RawHIDRingBuffer m_readBuffer;
 
-    /** A mutex to protect read buffer */
-    QMutex m_readBufMtx;
+    QAtomicInt m_readyPending;
 
     hid_device *m_handle;
 
@@ -105,18 +142,22 @@ public:
     /** Return the number of bytes buffered */
     qint64 getBytesToWrite();
 
+    /** How long to let small writes gather before sending, in microseconds */
+    void setCoalesceWindow(int us) { m_coalesceWindowUs.storeRelease(us); }
+
     void stop();
 
 protected:
     void run();
 
-    /** QByteArray might not be the most efficient way to implement
-    a circular buffer but it's good enough and very simple */
-    QByteArray m_writeBuffer;
+    /** Filled by the writer, drained by this thread */
+    RawHIDRingBuffer m_writeBuffer;
 
-    /** A mutex to protect read buffer */
+    /** Only held to sleep on and wake m_newDataToWrite */
     QMutex m_writeBufMtx;
 
+    QAtomicInt m_coalesceWindowUs;
+
     /** Synchronize task with data arival */
     QWaitCondition m_newDataToWrite;
 
@@ -136,10 +177,20 @@ class RAWHID_EXPORT RawHID : public QIODevice
     Q_OBJECT
 
 public:
+    //! Default for setWriteCoalesceWindow(), a fraction of a UAVTalk update period
+    static const int DEFAULT_WRITE_COALESCE_US = 1000;
+
     RawHID();
     RawHID(USBDevice *deviceName);
     virtual ~RawHID();
 
+    /**
+     * @brief Set how long writes that don't fill a report wait for more data,
+     * trading latency for full reports during bulk transfers
+     * @param us window in microseconds, 0 sends every write right away
+     */
+    void setWriteCoalesceWindow(int us);
+
     virtual bool open(OpenMode mode);
     virtual void close();
     virtual bool isSequential() const;
@@ -158,6 +209,8 @@ protected:
 
     RawHIDReadThread *m_readThread;
     RawHIDWriteThread *m_writeThread;
+
+    int m_writeCoalesceUs;
 };
 
 #endif // RAWHID_H
@@ -25,7 +25,8 @@ OTHER_FILES += RawHID.pluginspec
 
 # Platform Specific USB HID Stuff
 win32 { 
-    SOURCES += hidapi/hidapi_windows.c 
+    SOURCES += hidapi/hidapi_windows.c \
+        usbmonitor_win.cpp
     LIBS += -lhid \
         -lsetupapi
         win32-msvc* {
@@ -33,11 +34,13 @@ win32 {
         }
 }
 macx { 
-    SOURCES += hidapi/hidapi_mac.c
+    SOURCES += hidapi/hidapi_mac.c \
+        usbmonitor_mac.cpp
     LIBS += -framework IOKit \
         -framework CoreFoundation
 }
 linux {
-    SOURCES += hidapi/hidapi_linux.c
+    SOURCES += hidapi/hidapi_linux.c \
+        usbmonitor_linux.cpp
     LIBS += -ludev -lrt
 }
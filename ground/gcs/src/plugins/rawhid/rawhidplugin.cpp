@@ -31,6 +31,7 @@
 #include <QtCore/QtPlugin>
 #include <QtCore/QMutexLocker>
 #include <QDebug>
+#include <QSettings>
 
 #include "rawhid_const.h"
 #include "usbsignalfilter.h"
@@ -117,6 +118,13 @@ QIODevice *RawHIDConnection::openDevice(Core::IDevice *deviceName)
     Q_ASSERT(usbDev);
 
     RawHidHandle = new RawHID(usbDev);
+
+    // Latency versus throughput of writes, 0 turns coalescing off
+    QSettings *settings = Core::ICore::instance()->settings();
+    RawHidHandle->setWriteCoalesceWindow(
+        settings->value("RawHID/WriteCoalesceWindowUs", RawHID::DEFAULT_WRITE_COALESCE_US)
+            .toInt());
+
     return RawHidHandle;
 }
 
@@ -43,6 +43,13 @@
 
 #define printf USB_MON_QXTLOG_DEBUG
 
+// Enumeration period without hotplug notifications
+#define POLL_INTERVAL_MS 150
+// With notifications, polling only catches anything they missed
+#define FALLBACK_POLL_INTERVAL_MS 5000
+// Lets the burst of notifications for one device settle before enumerating
+#define NOTIFY_SETTLE_MS 50
+
 USBMonitor *USBMonitor::m_instance = 0;
 
 /**
@@ -57,19 +64,30 @@ USBMonitor::USBMonitor(QObject *parent)
 
     hid_init();
 
-    connect(&periodicTimer, &QTimer::timeout, this, &USBMonitor::periodic);
-    periodicTimer.setSingleShot(true);
-    periodicTimer.start(150);
-
     enumerating = false;
     prevDevList = NULL;
+
+    hotplug = NULL;
+    if (!setUpNotifications())
+        qDebug() << "usbmonitor: no hotplug notifications, polling for devices";
+
+    connect(&periodicTimer, &QTimer::timeout, this, &USBMonitor::periodic);
+    periodicTimer.setSingleShot(true);
+    periodicTimer.start(POLL_INTERVAL_MS);
 }
 
 USBMonitor::~USBMonitor()
 {
+    tearDownNotifications();
     hid_free_enumeration(prevDevList);
 }
 
+void USBMonitor::deviceChanged()
+{
+    // Restarting the timer folds a burst of notifications into one enumeration
+    periodicTimer.start(NOTIFY_SETTLE_MS);
+}
+
 void USBMonitor::periodic()
 {
     // This is here to catch recursion, from the process_pending_events in
@@ -136,7 +154,7 @@ void USBMonitor::periodic()
     }
 
     /* Ensure our signals are spaced out.  Also limit our CPU consumption */
-    periodicTimer.start(150);
+    periodicTimer.start(hotplug ? FALLBACK_POLL_INTERVAL_MS : POLL_INTERVAL_MS);
 }
 
 QList<USBPortInfo> USBMonitor::availableDevices()
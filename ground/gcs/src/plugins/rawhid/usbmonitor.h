@@ -103,24 +103,31 @@ signals:
     /*!
       A new device has been connected to the system.
 
-      setUpNotifications() must be called first to enable event-driven device notifications.
-      Currently only implemented on Windows and OS X.
+      Emitted soon after the OS notifies a change where setUpNotifications()
+      succeeded, otherwise at the next poll.
       \param info The device that has been discovered.
     */
     void deviceDiscovered(const USBPortInfo &info);
     /*!
       A device has been disconnected from the system.
 
-      setUpNotifications() must be called first to enable event-driven device notifications.
-      Currently only implemented on Windows and OS X.
+      Emitted like deviceDiscovered().
       \param info The device that was disconnected.
     */
     void deviceRemoved(const USBPortInfo &info);
 
 private slots:
     void periodic();
+    //! The OS told of a HID device change, enumerate soon
+    void deviceChanged();
 
 private:
+    //! OS specific hotplug notifications, one implementation per platform
+    struct HotplugContext;
+    bool setUpNotifications();
+    void tearDownNotifications();
+    HotplugContext *hotplug;
+
     //! List of known devices maintained by callbacks
     QList<USBPortInfo> knowndevices;
 
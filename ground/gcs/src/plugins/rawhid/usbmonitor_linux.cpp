@@ -0,0 +1,98 @@
+/**
+ ******************************************************************************
+ *
+ * @file       usbmonitor_linux.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup RawHIDPlugin Raw HID Plugin
+ * @{
+ * @brief HID hotplug detection from udev monitor
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "usbmonitor.h"
+
+#include <QSocketNotifier>
+#include <libudev.h>
+
+struct USBMonitor::HotplugContext
+{
+    struct udev *udev;
+    struct udev_monitor *monitor;
+    QSocketNotifier *notifier;
+};
+
+/**
+ * @brief Listens for hidraw devices coming and going on the udev monitor
+ * @return false if udev isn't available
+ */
+bool USBMonitor::setUpNotifications()
+{
+    struct udev *udev = udev_new();
+    if (!udev)
+        return false;
+
+    // Events from udev rather than the kernel, so device node permissions are set
+    struct udev_monitor *monitor = udev_monitor_new_from_netlink(udev, "udev");
+    if (!monitor || udev_monitor_filter_add_match_subsystem_devtype(monitor, "hidraw", NULL) < 0
+        || udev_monitor_enable_receiving(monitor) < 0) {
+        if (monitor)
+            udev_monitor_unref(monitor);
+        udev_unref(udev);
+        return false;
+    }
+
+    hotplug = new HotplugContext;
+    hotplug->udev = udev;
+    hotplug->monitor = monitor;
+    hotplug->notifier =
+        new QSocketNotifier(udev_monitor_get_fd(monitor), QSocketNotifier::Read, this);
+
+    connect(hotplug->notifier, &QSocketNotifier::activated, this, [this]() {
+        // The enumeration tells what changed, only empty the (non blocking) socket
+        struct udev_device *dev;
+        while ((dev = udev_monitor_receive_device(hotplug->monitor)) != NULL)
+            udev_device_unref(dev);
+
+        deviceChanged();
+    });
+
+    return true;
+}
+
+void USBMonitor::tearDownNotifications()
+{
+    if (!hotplug)
+        return;
+
+    delete hotplug->notifier;
+    udev_monitor_unref(hotplug->monitor);
+    udev_unref(hotplug->udev);
+
+    delete hotplug;
+    hotplug = NULL;
+}
+
+/**
+ * @}
+ * @}
+ */
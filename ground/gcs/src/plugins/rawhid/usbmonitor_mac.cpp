@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ *
+ * @file       usbmonitor_mac.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup RawHIDPlugin Raw HID Plugin
+ * @{
+ * @brief HID hotplug detection from IOKit notifications
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "usbmonitor.h"
+
+#include <CoreFoundation/CoreFoundation.h>
+#include <IOKit/IOKitLib.h>
+#include <IOKit/hid/IOHIDKeys.h>
+
+struct USBMonitor::HotplugContext
+{
+    IONotificationPortRef port;
+    io_iterator_t added;
+    io_iterator_t removed;
+};
+
+//! Runs down a notification iterator, which arms it for the next notification
+static void drainIterator(io_iterator_t iterator)
+{
+    io_object_t service;
+    while ((service = IOIteratorNext(iterator)) != 0)
+        IOObjectRelease(service);
+}
+
+static void hotplugCallback(void *refCon, io_iterator_t iterator)
+{
+    drainIterator(iterator);
+
+    QMetaObject::invokeMethod(static_cast<USBMonitor *>(refCon), "deviceChanged",
+                              Qt::QueuedConnection);
+}
+
+/**
+ * @brief Asks IOKit to tell of HID devices being published and terminated,
+ * on the main run loop the Qt event loop runs
+ * @return false if IOKit refused the notifications
+ */
+bool USBMonitor::setUpNotifications()
+{
+    IONotificationPortRef port = IONotificationPortCreate(kIOMasterPortDefault);
+    if (!port)
+        return false;
+
+    CFRunLoopAddSource(CFRunLoopGetMain(), IONotificationPortGetRunLoopSource(port),
+                       kCFRunLoopDefaultMode);
+
+    hotplug = new HotplugContext;
+    hotplug->port = port;
+    hotplug->added = 0;
+    hotplug->removed = 0;
+
+    // Each call consumes a reference to its matching dictionary
+    kern_return_t ret = IOServiceAddMatchingNotification(port, kIOFirstMatchNotification,
+                                                         IOServiceMatching(kIOHIDDeviceKey),
+                                                         hotplugCallback, this, &hotplug->added);
+    if (ret == KERN_SUCCESS)
+        ret = IOServiceAddMatchingNotification(port, kIOTerminatedNotification,
+                                               IOServiceMatching(kIOHIDDeviceKey),
+                                               hotplugCallback, this, &hotplug->removed);
+    if (ret != KERN_SUCCESS) {
+        tearDownNotifications();
+        return false;
+    }
+
+    // Devices already there are found by the first enumeration
+    drainIterator(hotplug->added);
+    drainIterator(hotplug->removed);
+
+    return true;
+}
+
+void USBMonitor::tearDownNotifications()
+{
+    if (!hotplug)
+        return;
+
+    if (hotplug->added)
+        IOObjectRelease(hotplug->added);
+    if (hotplug->removed)
+        IOObjectRelease(hotplug->removed);
+    // Also removes the run loop source
+    IONotificationPortDestroy(hotplug->port);
+
+    delete hotplug;
+    hotplug = NULL;
+}
+
+/**
+ * @}
+ * @}
+ */
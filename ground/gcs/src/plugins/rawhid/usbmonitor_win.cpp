@@ -0,0 +1,127 @@
+/**
+ ******************************************************************************
+ *
+ * @file       usbmonitor_win.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup RawHIDPlugin Raw HID Plugin
+ * @{
+ * @brief HID hotplug detection from device notifications
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "usbmonitor.h"
+
+#include <windows.h>
+#include <dbt.h>
+
+// GUID_DEVINTERFACE_HID, as HidD_GetHidGuid() returns it
+static const GUID hidInterfaceGuid = { 0x4d1e55b2,
+                                       0xf16f,
+                                       0x11cf,
+                                       { 0x88, 0xcb, 0x00, 0x11, 0x11, 0x00, 0x00, 0x30 } };
+
+static const wchar_t hotplugWindowClass[] = L"dRoninUSBMonitor";
+
+struct USBMonitor::HotplugContext
+{
+    HWND window;
+    HDEVNOTIFY notification;
+};
+
+static LRESULT CALLBACK hotplugWindowProc(HWND window, UINT msg, WPARAM wParam, LPARAM lParam)
+{
+    if (msg == WM_DEVICECHANGE
+        && (wParam == DBT_DEVICEARRIVAL || wParam == DBT_DEVICEREMOVECOMPLETE)) {
+        USBMonitor *monitor =
+            reinterpret_cast<USBMonitor *>(GetWindowLongPtrW(window, GWLP_USERDATA));
+        if (monitor)
+            QMetaObject::invokeMethod(monitor, "deviceChanged", Qt::QueuedConnection);
+
+        return TRUE;
+    }
+
+    return DefWindowProcW(window, msg, wParam, lParam);
+}
+
+/**
+ * @brief Registers a message-only window for HID interface arrival and removal,
+ * its messages are dispatched by the Qt event loop
+ * @return false if the window or the registration couldn't be made
+ */
+bool USBMonitor::setUpNotifications()
+{
+    HINSTANCE instance = GetModuleHandleW(NULL);
+
+    WNDCLASSEXW windowClass;
+    ZeroMemory(&windowClass, sizeof(windowClass));
+    windowClass.cbSize = sizeof(windowClass);
+    windowClass.lpfnWndProc = hotplugWindowProc;
+    windowClass.hInstance = instance;
+    windowClass.lpszClassName = hotplugWindowClass;
+
+    if (!RegisterClassExW(&windowClass) && GetLastError() != ERROR_CLASS_ALREADY_EXISTS)
+        return false;
+
+    HWND window = CreateWindowExW(0, hotplugWindowClass, L"", 0, 0, 0, 0, 0, HWND_MESSAGE, NULL,
+                                  instance, NULL);
+    if (!window)
+        return false;
+
+    SetWindowLongPtrW(window, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
+
+    DEV_BROADCAST_DEVICEINTERFACE_W filter;
+    ZeroMemory(&filter, sizeof(filter));
+    filter.dbcc_size = sizeof(filter);
+    filter.dbcc_devicetype = DBT_DEVTYP_DEVICEINTERFACE;
+    filter.dbcc_classguid = hidInterfaceGuid;
+
+    HDEVNOTIFY notification =
+        RegisterDeviceNotificationW(window, &filter, DEVICE_NOTIFY_WINDOW_HANDLE);
+    if (!notification) {
+        DestroyWindow(window);
+        return false;
+    }
+
+    hotplug = new HotplugContext;
+    hotplug->window = window;
+    hotplug->notification = notification;
+
+    return true;
+}
+
+void USBMonitor::tearDownNotifications()
+{
+    if (!hotplug)
+        return;
+
+    UnregisterDeviceNotification(hotplug->notification);
+    DestroyWindow(hotplug->window);
+
+    delete hotplug;
+    hotplug = NULL;
+}
+
+/**
+ * @}
+ * @}
+ */
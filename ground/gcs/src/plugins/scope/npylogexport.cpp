@@ -0,0 +1,204 @@
+/**
+ ******************************************************************************
+ *
+ * @file       npylogexport.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "npylogexport.h"
+
+#include "uavobjects/uavdataobject.h"
+#include "uavobjects/uavobjectfield.h"
+#include "uavobjects/uavobjectmanager.h"
+#include "uavobjects/uavobjectsinit.h"
+#include "uavtalk/logdecoder.h"
+
+#include <QDebug>
+#include <QtEndian>
+
+#include <string.h>
+
+/**
+ * @brief NpyLogExport::NpyLogExport
+ * @param logFileName Telemetry log to decode
+ * @param outputDir Directory the .npy files are written to
+ */
+NpyLogExport::NpyLogExport(const QString &logFileName, const QString &outputDir)
+    : logFileName(logFileName)
+    , outputDir(outputDir)
+{
+    // Decode into a private object manager, so the rest of the GCS doesn't see the log
+    objManager = new UAVObjectManager;
+    UAVObjectsInitialize(objManager);
+
+    logDecoder = new LogDecoder(objManager);
+
+    foreach (const QVector<UAVDataObject *> &instances, objManager->getDataObjectsVector()) {
+        foreach (UAVDataObject *obj, instances)
+            connect(obj, &UAVObject::objectUpdated, this, &NpyLogExport::objectUpdated);
+    }
+    connect(objManager, &UAVObjectManager::newInstance, this, &NpyLogExport::newInstance);
+}
+
+NpyLogExport::~NpyLogExport()
+{
+    qDeleteAll(writers);
+
+    delete logDecoder;
+    delete objManager;
+}
+
+/**
+ * @brief NpyLogExport::exportLog Decode the whole log
+ * @return FALSE on error, see errorString()
+ */
+bool NpyLogExport::exportLog()
+{
+    if (!logDecoder->open(logFileName)) {
+        error = logDecoder->errorString();
+        return false;
+    }
+
+    logDecoder->decodeAll([this](quint32 timestamp) {
+        uchar stamp[sizeof(quint32)];
+        qToLittleEndian<quint32>(timestamp, stamp);
+
+        for (int i = 0; i < pending.size(); i++) {
+            QByteArray &record = pending[i].second;
+            memcpy(record.data(), stamp, sizeof(stamp));
+
+            if (!pending[i].first->write(record.constData())) {
+                error = pending[i].first->errorString();
+                return false;
+            }
+        }
+        pending.clear();
+
+        return true;
+    });
+
+    logDecoder->close();
+
+    foreach (NpyWriter *writer, writers) {
+        if (writer && !writer->close() && error.isEmpty())
+            error = writer->errorString();
+    }
+
+    return error.isEmpty();
+}
+
+/**
+ * @brief NpyLogExport::objectUpdated Pack the updated object into a record,
+ * stamped once the log entry is fully decoded
+ */
+void NpyLogExport::objectUpdated(UAVObject *obj)
+{
+    NpyWriter *writer = writerFor(obj);
+    if (!writer)
+        return;
+
+    QByteArray record(writer->recordSize(), 0);
+    int offset = sizeof(quint32);
+
+    if (!obj->isSingleInstance()) {
+        qToLittleEndian<quint16>(obj->getInstID(), (uchar *)record.data() + offset);
+        offset += sizeof(quint16);
+    }
+
+    obj->pack((quint8 *)record.data() + offset);
+
+    pending.append(qMakePair(writer, record));
+}
+
+void NpyLogExport::newInstance(UAVObject *obj)
+{
+    connect(obj, &UAVObject::objectUpdated, this, &NpyLogExport::objectUpdated);
+}
+
+/**
+ * @brief NpyLogExport::writerFor Get the file an object type is written to,
+ * creating it on the first update
+ * @return NULL if the object can't be exported
+ */
+NpyWriter *NpyLogExport::writerFor(UAVObject *obj)
+{
+    QHash<quint32, NpyWriter *>::const_iterator it = writers.constFind(obj->getObjID());
+    if (it != writers.constEnd())
+        return it.value();
+
+    QList<NpyWriter::Column> columns;
+    columns << NpyWriter::column("timestamp", "<u4", sizeof(quint32));
+    if (!obj->isSingleInstance())
+        columns << NpyWriter::column("instance", "<u2", sizeof(quint16));
+
+    int fieldBytes = 0;
+    foreach (UAVObjectField *field, obj->getFields()) {
+        QByteArray name = field->getName().toLatin1();
+        int elements = field->getNumElements();
+        int bytes = field->getNumBytes();
+
+        switch (field->getType()) {
+        case UAVObjectField::INT8:
+            columns << NpyWriter::column(name, "|i1", 1, elements);
+            break;
+        case UAVObjectField::INT16:
+            columns << NpyWriter::column(name, "<i2", 2, elements);
+            break;
+        case UAVObjectField::INT32:
+            columns << NpyWriter::column(name, "<i4", 4, elements);
+            break;
+        case UAVObjectField::UINT8:
+        case UAVObjectField::ENUM:
+            columns << NpyWriter::column(name, "|u1", 1, elements);
+            break;
+        case UAVObjectField::UINT16:
+            columns << NpyWriter::column(name, "<u2", 2, elements);
+            break;
+        case UAVObjectField::UINT32:
+            columns << NpyWriter::column(name, "<u4", 4, elements);
+            break;
+        case UAVObjectField::FLOAT32:
+            columns << NpyWriter::column(name, "<f4", 4, elements);
+            break;
+        case UAVObjectField::BITFIELD:
+            // Left packed, one bit per element
+            columns << NpyWriter::column(name, "|u1", 1, bytes);
+            break;
+        case UAVObjectField::STRING:
+            columns << NpyWriter::column(name, "|S" + QByteArray::number(bytes), bytes);
+            break;
+        }
+
+        fieldBytes += bytes;
+    }
+
+    NpyWriter *writer = new NpyWriter();
+    if (fieldBytes != (int)obj->getNumBytes()
+        || !writer->open(outputDir.filePath(obj->getName() + ".npy"), columns)) {
+        qDebug() << "Can't export" << obj->getName() << writer->errorString();
+        delete writer;
+        writer = NULL;
+    }
+
+    writers.insert(obj->getObjID(), writer);
+    return writer;
+}
@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ *
+ * @file       npylogexport.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef NPYLOGEXPORT_H
+#define NPYLOGEXPORT_H
+
+#include "npywriter.h"
+
+#include <QDir>
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+class LogDecoder;
+class UAVObject;
+class UAVObjectManager;
+
+/**
+ * @brief The NpyLogExport class Decodes a telemetry log into one .npy file
+ * per object type.
+ *
+ * Each record holds the log timestamp in ms, the instance ID for multiple
+ * instance objects, and every field as an (array) column of its UAVO type.
+ * Records are the packed object data, so they are streamed to disk as they
+ * are decoded.
+ */
+class NpyLogExport : public QObject
+{
+    Q_OBJECT
+public:
+    NpyLogExport(const QString &logFileName, const QString &outputDir);
+    ~NpyLogExport();
+
+    bool exportLog();
+    QString errorString() const { return error; }
+
+private slots:
+    void objectUpdated(UAVObject *obj);
+    void newInstance(UAVObject *obj);
+
+private:
+    QString logFileName;
+    QDir outputDir;
+    QString error;
+
+    UAVObjectManager *objManager;
+    LogDecoder *logDecoder;
+
+    QHash<quint32, NpyWriter *> writers; // By object ID, NULL if not exportable
+    // Records decoded from the current log entry, waiting for its timestamp
+    QVector<QPair<NpyWriter *, QByteArray>> pending;
+
+    NpyWriter *writerFor(UAVObject *obj);
+};
+
+#endif // NPYLOGEXPORT_H
@@ -0,0 +1,153 @@
+/**
+ ******************************************************************************
+ *
+ * @file       npywriter.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "npywriter.h"
+
+#include <QtEndian>
+
+NpyWriter::NpyWriter()
+    : rowSize(0)
+    , rows(0)
+{
+}
+
+NpyWriter::~NpyWriter()
+{
+    close();
+}
+
+/**
+ * @brief NpyWriter::column Describe a column
+ * @param name Column name
+ * @param type NumPy type string, e.g. "<f8"
+ * @param size Bytes per element
+ * @param count Number of elements, more than 1 for a sub-array
+ */
+NpyWriter::Column NpyWriter::column(const QByteArray &name, const QByteArray &type, int size,
+                                    int count)
+{
+    Column column = { name, type, count, size };
+    return column;
+}
+
+/**
+ * @brief NpyWriter::open Create the file and write its header
+ * @param fileName
+ * @param columns Layout of the records
+ * @return FALSE if the file couldn't be written
+ */
+bool NpyWriter::open(const QString &fileName, const QList<Column> &columns)
+{
+    close();
+
+    dtype = columns;
+    rows = 0;
+    rowSize = 0;
+    foreach (const Column &column, dtype)
+        rowSize += column.size * column.count;
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QByteArray head = header();
+    return file.write(head) == head.size();
+}
+
+/**
+ * @brief NpyWriter::write Append a record
+ * @param record recordSize() bytes laid out as the columns, little endian
+ */
+bool NpyWriter::write(const void *record)
+{
+    if (!file.isOpen())
+        return false;
+
+    if (file.write(static_cast<const char *>(record), rowSize) != rowSize)
+        return false;
+
+    rows++;
+    return true;
+}
+
+/**
+ * @brief NpyWriter::close Patch the row count into the header and close the file
+ */
+bool NpyWriter::close()
+{
+    if (!file.isOpen())
+        return true;
+
+    // The header keeps its length, only the padded shape changes
+    bool ok = file.seek(0);
+    if (ok) {
+        QByteArray head = header();
+        ok = file.write(head) == head.size();
+    }
+
+    file.close();
+    return ok;
+}
+
+/**
+ * @brief NpyWriter::header Build the version 1.0 header (2.0 if it doesn't
+ * fit), padded to a multiple of 64 bytes as NumPy does
+ */
+QByteArray NpyWriter::header() const
+{
+    QByteArray descr;
+    foreach (const Column &column, dtype) {
+        descr += "('" + column.name + "', '" + column.type + "'";
+        if (column.count > 1)
+            descr += ", (" + QByteArray::number(column.count) + ",)";
+        descr += "), ";
+    }
+
+    QByteArray dict = "{'descr': [" + descr + "], 'fortran_order': False, 'shape': ("
+        + QByteArray::number(rows).rightJustified(SHAPE_WIDTH, ' ') + ",), }";
+
+    int prefix = 8 + 2;
+    if (prefix + dict.size() + 1 > 0xffff)
+        prefix = 8 + 4;
+
+    int padding = 63 - (prefix + dict.size()) % 64;
+    dict += QByteArray(padding, ' ') + '\n';
+
+    QByteArray head("\x93NUMPY", 6);
+    if (prefix == 10) {
+        head += QByteArray("\x01\x00", 2);
+        uchar len[2];
+        qToLittleEndian<quint16>(dict.size(), len);
+        head += QByteArray((const char *)len, 2);
+    } else {
+        head += QByteArray("\x02\x00", 2);
+        uchar len[4];
+        qToLittleEndian<quint32>(dict.size(), len);
+        head += QByteArray((const char *)len, 4);
+    }
+
+    return head + dict;
+}
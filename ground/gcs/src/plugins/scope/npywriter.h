@@ -0,0 +1,81 @@
+/**
+ ******************************************************************************
+ *
+ * @file       npywriter.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef NPYWRITER_H
+#define NPYWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief The NpyWriter class Streams records to a NumPy .npy file with a
+ * structured dtype, so numpy.load() gives a record array with one named
+ * column per field.
+ *
+ * Records are written as they come. Only the row count in the header is
+ * patched on close, so exports don't need to be built in memory.
+ */
+class NpyWriter
+{
+public:
+    /**
+     * @brief Column of the records, in the order they are laid out
+     */
+    struct Column
+    {
+        QByteArray name;
+        QByteArray type; // NumPy type string, e.g. "<f8"
+        int count; // Elements, more than 1 for a sub-array
+        int size; // Bytes per element
+    };
+
+    NpyWriter();
+    ~NpyWriter();
+
+    bool open(const QString &fileName, const QList<Column> &columns);
+    bool write(const void *record);
+    bool close();
+
+    int recordSize() const { return rowSize; }
+    quint64 recordCount() const { return rows; }
+    QString errorString() const { return file.errorString(); }
+
+    static Column column(const QByteArray &name, const QByteArray &type, int size, int count = 1);
+
+private:
+    static const int SHAPE_WIDTH = 20; // Room for any 64-bit row count
+
+    QFile file;
+    QList<Column> dtype;
+    int rowSize;
+    quint64 rows;
+
+    QByteArray header() const;
+};
+
+#endif // NPYWRITER_H
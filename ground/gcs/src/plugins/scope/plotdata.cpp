@@ -34,6 +34,12 @@
 #include <math.h>
 #include <QDebug>
 
+PlotData::PlotData()
+    : boundField(NULL)
+    , boundElement(0)
+{
+}
+
 /**
  * @brief Plot2dData::Plot2dData Default 2d constructor
  * @param p_uavObject The plotted UAVO name
@@ -138,25 +144,31 @@ Plot3dData::~Plot3dData()
 }
 
 /**
- * @brief valueAsDouble Fetch the value from the UAVO and return it as a double
- * @param obj UAVO
- * @param field UAVO field
- * @param haveSubField TRUE if UAVO has subfield. FALSE if not.
- * @param uavSubFieldName UAVO subfield, if it exists
- * @return
+ * @brief PlotData::bindField Resolve the plotted field and element of an updated object.
+ * The lookups by name are only done the first time an object is seen, or after it was
+ * re-registered; otherwise the cached binding is used as is.
+ * @param obj Updated UAVO
+ * @return TRUE if obj is the plotted UAVO. boundField is NULL if it lacks the field.
  */
-double PlotData::valueAsDouble(UAVObject *obj, UAVObjectField *field, bool haveSubField,
-                               QString uavSubFieldName)
+bool PlotData::bindField(UAVObject *obj)
 {
-    Q_UNUSED(obj);
-    QVariant value;
-
-    if (haveSubField) {
-        int indexOfSubField = field->getElementNames().indexOf(
-            QRegExp(uavSubFieldName, Qt::CaseSensitive, QRegExp::FixedString));
-        value = field->getValue(indexOfSubField);
-    } else
-        value = field->getValue();
+    if (obj == boundObject)
+        return true;
+
+    if (uavObjectName != obj->getName())
+        return false;
+
+    boundObject = obj;
+    boundField = obj->getField(uavFieldName);
+    boundElement = 0;
+
+    if (boundField && haveSubField) {
+        int indexOfSubField = boundField->getElementNames().indexOf(uavSubFieldName);
+        if (indexOfSubField < 0)
+            boundField = NULL;
+        else
+            boundElement = indexOfSubField;
+    }
 
-    return value.toDouble();
+    return true;
 }
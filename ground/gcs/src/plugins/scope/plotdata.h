@@ -36,6 +36,7 @@ class ScopeConfig;
 #include "qwt/src/qwt_color_map.h"
 #include "qwt/src/qwt_scale_widget.h"
 
+#include <QPointer>
 #include <QTimer>
 #include <QTime>
 #include <QVector>
@@ -44,8 +45,7 @@ class PlotData : public QObject
 {
     Q_OBJECT
 public:
-    double valueAsDouble(UAVObject *obj, UAVObjectField *field, bool haveSubField,
-                         QString uavSubFieldName);
+    PlotData();
 
     // Setter functions
     void setXMinimum(double val) { xMinimum = val; }
@@ -109,7 +109,13 @@ protected:
     double correctionSum;
     int correctionCount;
 
+    // Field and element of the plotted object, resolved once per object
+    UAVObjectField *boundField;
+    quint32 boundElement;
+    bool bindField(UAVObject *obj);
+
 private:
+    QPointer<UAVObject> boundObject;
 };
 
 /**
@@ -1,5 +1,5 @@
 TEMPLATE = lib
-QT += widgets
+QT += widgets opengl concurrent
 TARGET = ScopeGadget
 DEFINES += SCOPE_LIBRARY
 DEFINES += QWT_DLL
@@ -14,11 +14,19 @@ include(../../plugins/uavobjects/uavobjects.pri)
 include(../../plugins/uavtalk/uavtalk.pri)
 
 HEADERS += scopeplugin.h \
+    npylogexport.h \
+    npywriter.h \
+    scopes2d/histogrambinner.h \
     scopes2d/histogramplotdata.h \
     scopes2d/histogramscopeconfig.h \
     scopes2d/scatterplotdata.h \
+    scopes2d/ringbuffer.h \
+    scopes2d/logseriesdata.h \
+    scopes2d/ringseriesdata.h \
+    scopes2d/timeseriesstore.h \
     scopes2d/scatterplotscopeconfig.h \
     scopes3d/spectrogramplotdata.h \
+    scopes3d/spectrogramrasterdata.h \
     scopes3d/spectrogramscopeconfig.h \
     scopes2d/plotdata2d.h \
     scopes2d/scopes2dconfig.h \
@@ -34,11 +42,18 @@ HEADERS += scopegadgetwidget.h
 HEADERS += scopegadgetfactory.h
 
 SOURCES += scopeplugin.cpp \
+    npylogexport.cpp \
+    npywriter.cpp \
+    scopes2d/histogrambinner.cpp \
     scopes2d/histogramplotdata.cpp \
     scopes2d/histogramscopeconfig.cpp \
     scopes2d/scatterplotdata.cpp \
+    scopes2d/logseriesdata.cpp \
+    scopes2d/ringseriesdata.cpp \
+    scopes2d/timeseriesstore.cpp \
     scopes2d/scatterplotscopeconfig.cpp \
     scopes3d/spectrogramplotdata.cpp \
+    scopes3d/spectrogramrasterdata.cpp \
     scopes3d/spectrogramscopeconfig.cpp \
     plotdata.cpp
 SOURCES += scopegadgetoptionspage.cpp
@@ -47,6 +62,9 @@ SOURCES += scopegadget.cpp
 SOURCES += scopegadgetfactory.cpp
 SOURCES += scopegadgetwidget.cpp
 
+# Log exports decode into their own object manager
+SOURCES += $$UAVOBJECT_SYNTHETICS/uavobjectsinit.cpp
+
 OTHER_FILES += ScopeGadget.pluginspec
 
 FORMS += scopegadgetoptionspage.ui
@@ -51,6 +51,7 @@ void ScopeGadget::loadConfiguration(IUAVGadgetConfiguration *config)
 
     scopeGadgetWidget->clearPlotWidget();
     scopeGadgetWidget->setScopeName(config->name());
+    scopeGadgetWidget->setUseOpenGL(sgConfig->useOpenGL());
 
     sgConfig->getScope()->loadConfiguration(scopeGadgetWidget);
 }
@@ -40,12 +40,14 @@ ScopeGadgetConfiguration::ScopeGadgetConfiguration(QString classId, QSettings *q
                                                    QObject *parent)
     : IUAVGadgetConfiguration(classId, parent)
     , m_scope(0)
+    , m_useOpenGL(false)
 {
     // Default for scopes
     int refreshInterval = 50;
 
     // if a saved configuration exists load it
     if (qSettings != 0) {
+        m_useOpenGL = qSettings->value("useOpenGL", false).toBool();
 
         PlotDimensions plotDimensions = (PlotDimensions)qSettings->value("plotDimensions").toInt();
 
@@ -111,6 +113,8 @@ void ScopeGadgetConfiguration::applyGuiConfiguration(Ui::ScopeGadgetOptionsPage
     // Default for scopes
     int refreshInterval = 50;
 
+    m_useOpenGL = options_page->cbUseOpenGL->isChecked();
+
     if (options_page->tabWidget2d3d->currentWidget() == options_page->tabPlot2d) { //--- 2D ---//
         Scopes2dConfig::Plot2dType plot2dType =
             (Scopes2dConfig::Plot2dType)options_page->cmb2dPlotType
@@ -157,6 +161,7 @@ IUAVGadgetConfiguration *ScopeGadgetConfiguration::clone()
 {
     ScopeGadgetConfiguration *m = new ScopeGadgetConfiguration(this->classId());
     m->m_scope = this->getScope()->cloneScope(m_scope);
+    m->m_useOpenGL = m_useOpenGL;
 
     return m;
 }
@@ -170,6 +175,7 @@ void ScopeGadgetConfiguration::saveConfig(QSettings *qSettings) const
 {
     qSettings->setValue("plotDimensions", m_scope->getScopeDimensions());
     qSettings->setValue("refreshInterval", m_scope->getRefreshInterval());
+    qSettings->setValue("useOpenGL", m_useOpenGL);
 
     m_scope->saveConfiguration(qSettings);
 }
@@ -48,6 +48,7 @@ public:
 
     // configurations getter functions
     ScopeConfig *getScope() { return m_scope; }
+    bool useOpenGL() const { return m_useOpenGL; }
 
     void saveConfig(QSettings *settings) const; // THIS SEEMS TO BE UNUSED
     IUAVGadgetConfiguration *clone();
@@ -56,6 +57,7 @@ public:
 
 private:
     ScopeConfig *m_scope;
+    bool m_useOpenGL; // Render the plot canvas through OpenGL rather than raster painting
 };
 
 #endif // SCOPEGADGETCONFIGURATION_H
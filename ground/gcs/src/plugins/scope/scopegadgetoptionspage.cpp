@@ -195,8 +195,10 @@ QWidget *ScopeGadgetOptionsPage::createPage(QWidget *parent)
             &ScopeGadgetOptionsPage::on_lst2dItem_clicked);
 
     // Configuration the GUI elements to reflect the scope settings
-    if (m_config)
+    if (m_config) {
         m_config->getScope()->setGuiConfiguration(options_page);
+        options_page->cbUseOpenGL->setChecked(m_config->useOpenGL());
+    }
 
     // Cascading update on the UI elements
     emit on_cmb2dPlotType_currentIndexChanged(options_page->cmb2dPlotType->currentText());
@@ -46,10 +46,19 @@
 
 #include "qwt/src/qwt_legend.h"
 #include "qwt/src/qwt_legend_label.h"
+#include "qwt/src/qwt_plot_canvas.h"
+#include "qwt/src/qwt_plot_glcanvas.h"
+#include "qwt/src/qwt_plot_renderer.h"
+#include "qwt/src/qwt_plot_curve.h"
+
+#include "npywriter.h"
+#include "scopes2d/ringseriesdata.h"
+#include "scopes2d/scatterplotdata.h"
 #include "qwt/src/qwt_scale_widget.h"
 
 #include <iostream>
 #include <math.h>
+#include <string.h>
 #include <QDebug>
 #include <QColor>
 #include <QStringList>
@@ -61,15 +70,30 @@
 #include <QAction>
 #include <QClipboard>
 #include <QApplication>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QtEndian>
+#include <QtConcurrent/QtConcurrentRun>
 
 QTimer *ScopeGadgetWidget::replotTimer = 0;
 
+//! Bit pattern of a double, to store it little endian
+static quint64 doubleBits(double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
 ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent)
     : QwtPlot(parent)
     , m_refreshInterval(50)
     , // Arbitrary 50ms refresh timer
     m_scope(0)
     , m_xWindowSize(60) // This is an arbitrary 1 minute window
+    , m_offline(false)
 {
     m_grid = new QwtPlotGrid;
 
@@ -91,6 +115,8 @@ ScopeGadgetWidget::ScopeGadgetWidget(QWidget *parent)
 
     setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, &QWidget::customContextMenuRequested, this, &ScopeGadgetWidget::popUpMenu);
+
+    connect(&m_logLoader, &QFutureWatcherBase::finished, this, &ScopeGadgetWidget::logLoaded);
 }
 
 /**
@@ -125,6 +151,25 @@ void ScopeGadgetWidget::popUpMenu(const QPoint &mousePosition)
 
     // Add copy to clipboard item to menu
     connect(action, &QAction::triggered, this, &ScopeGadgetWidget::copyToClipboardAsImage);
+
+    // Add export of the curve data
+    action = menu.addAction(tr("Export to NumPy..."));
+    connect(action, &QAction::triggered, this, &ScopeGadgetWidget::exportToNumPy);
+    menu.addSeparator();
+
+    // Time series can also be plotted from a log instead of the live data
+    bool haveTimeSeries = false;
+    foreach (PlotData *plotData, m_dataSources.values())
+        haveTimeSeries |= qobject_cast<TimeSeriesPlotData *>(plotData) != NULL;
+
+    action = menu.addAction(tr("Plot from Log..."));
+    action->setEnabled(haveTimeSeries && !m_logLoader.isRunning());
+    connect(action, &QAction::triggered, this, &ScopeGadgetWidget::openLog);
+
+    if (m_offline) {
+        action = menu.addAction(tr("Back to Live Data"));
+        connect(action, &QAction::triggered, this, &ScopeGadgetWidget::closeLog);
+    }
     menu.addSeparator();
 
     // Add options dialog to clipboard
@@ -153,7 +198,17 @@ void ScopeGadgetWidget::clearPlot()
  */
 void ScopeGadgetWidget::copyToClipboardAsImage()
 {
-    QPixmap pixmap = QWidget::grab();
+    QPixmap pixmap;
+
+    if (qobject_cast<QwtPlotGLCanvas *>(canvas())) {
+        // grab() doesn't capture the GL framebuffer, so render the plot again
+        pixmap = QPixmap(size());
+        pixmap.fill(Qt::white);
+        QwtPlotRenderer().renderTo(this, pixmap);
+    } else {
+        pixmap = QWidget::grab();
+    }
+
     if (pixmap.isNull()) {
         qDebug("Failed to capture the plot");
         return;
@@ -162,6 +217,77 @@ void ScopeGadgetWidget::copyToClipboardAsImage()
     clipboard->setPixmap(pixmap);
 }
 
+/**
+ * @brief ScopeGadgetWidget::exportToNumPy Writes the samples of each curve to a
+ * .npy file with t and value columns, in the chosen directory
+ */
+void ScopeGadgetWidget::exportToNumPy()
+{
+    QString dirName = QFileDialog::getExistingDirectory(this, tr("Export scope data to"));
+    if (dirName.isEmpty())
+        return;
+
+    QDir dir(dirName);
+    QList<NpyWriter::Column> columns;
+    columns << NpyWriter::column("t", "<f8", sizeof(double))
+            << NpyWriter::column("value", "<f8", sizeof(double));
+
+    foreach (QwtPlotItem *item, itemList(QwtPlotItem::Rtti_PlotCurve)) {
+        QwtPlotCurve *curve = static_cast<QwtPlotCurve *>(item);
+
+        // While plotting a log, export it rather than the live data
+        if (m_logHidden.contains(curve))
+            continue;
+
+        QString name = curve->title().text();
+        name.replace(QRegExp("[^A-Za-z0-9_.-]"), "_");
+
+        NpyWriter writer;
+        if (!writer.open(dir.filePath(name + ".npy"), columns)) {
+            QMessageBox::critical(this, tr("Export failed"), writer.errorString());
+            return;
+        }
+
+        // Time series are exported as sampled, not as reduced for display
+        RingSeriesData *ring = dynamic_cast<RingSeriesData *>(curve->data());
+        LogSeriesData *log = dynamic_cast<LogSeriesData *>(curve->data());
+        int count = ring ? ring->rawSize() : log ? log->rawSize() : (int)curve->dataSize();
+
+        for (int i = 0; i < count; i++) {
+            QPointF point =
+                ring ? ring->rawSample(i) : log ? log->rawSample(i) : curve->sample(i);
+            uchar record[2 * sizeof(double)];
+            qToLittleEndian<quint64>(doubleBits(point.x()), record);
+            qToLittleEndian<quint64>(doubleBits(point.y()), record + sizeof(double));
+
+            if (!writer.write(record)) {
+                QMessageBox::critical(this, tr("Export failed"), writer.errorString());
+                return;
+            }
+        }
+
+        writer.close();
+    }
+}
+
+/**
+ * @brief ScopeGadgetWidget::setUseOpenGL Choose how the plot canvas is painted.
+ * Through OpenGL, the curves and spectrograms are rasterized by the GPU, which
+ * takes most of the replot load off the CPU with several scopes open.
+ * @param useOpenGL TRUE for an OpenGL canvas, FALSE for the default raster one
+ */
+void ScopeGadgetWidget::setUseOpenGL(bool useOpenGL)
+{
+    if (useOpenGL == (qobject_cast<QwtPlotGLCanvas *>(canvas()) != NULL))
+        return;
+
+    // The plot deletes the previous canvas
+    if (useOpenGL)
+        setCanvas(new QwtPlotGLCanvas());
+    else
+        setCanvas(new QwtPlotCanvas());
+}
+
 /**
  * @brief ScopeGadgetWidget::showOptionDialog Show the settings dialog for the selected scope
  */
@@ -204,6 +330,8 @@ void ScopeGadgetWidget::mouseDoubleClickEvent(QMouseEvent *e)
 
     // On double-click, reset plot zoom
     setAxisAutoScale(QwtPlot::yLeft, true);
+    if (m_offline)
+        showWholeLog();
 
     update();
 
@@ -225,6 +353,32 @@ void ScopeGadgetWidget::mouseMoveEvent(QMouseEvent *e)
  */
 void ScopeGadgetWidget::wheelEvent(QWheelEvent *e)
 {
+    // On a log, Ctrl zooms and Shift scrolls through time instead
+    if (m_offline && (e->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier))) {
+        QwtInterval xInterval = axisInterval(QwtPlot::xBottom);
+        double from = xInterval.minValue();
+        double to = xInterval.maxValue();
+
+        if (e->modifiers() & Qt::ControlModifier) {
+            double zoomLine =
+                invTransform(QwtPlot::xBottom, canvas()->mapFrom(this, e->pos()).x());
+            double zoomScale = e->delta() < 0 ? 1.25 : 1 / 1.25;
+
+            from = (from - zoomLine) * zoomScale + zoomLine;
+            to = (to - zoomLine) * zoomScale + zoomLine;
+        } else {
+            double shift = (to - from) * (e->delta() < 0 ? 0.1 : -0.1);
+
+            from += shift;
+            to += shift;
+        }
+
+        setAxisScale(QwtPlot::xBottom, from, to);
+        replot();
+        e->accept();
+        return;
+    }
+
     // Change zoom on scroll wheel event
     QwtInterval yInterval = axisInterval(QwtPlot::yLeft);
     if (yInterval.minValue() != yInterval.maxValue()) // Make sure that the two values are never the
@@ -357,8 +511,9 @@ void ScopeGadgetWidget::uavObjectReceived(UAVObject *obj)
  */
 void ScopeGadgetWidget::replotNewData()
 {
-    // If the plot is not visible or there is no scope, do not replot
-    if (!isVisible() || m_scope == NULL)
+    // If the plot is not visible or there is no scope, do not replot.
+    // A log doesn't change, it's only replotted when zoomed.
+    if (!isVisible() || m_scope == NULL || m_offline)
         return;
 
     // Update the data in the scopes
@@ -375,6 +530,10 @@ void ScopeGadgetWidget::replotNewData()
  */
 void ScopeGadgetWidget::clearPlotWidget()
 {
+    // Let go of the curves before they are deleted
+    cancelLog();
+    closeLog();
+
     if (m_grid) {
         m_grid->detach();
     }
@@ -430,6 +589,192 @@ void ScopeGadgetWidget::showEvent(QShowEvent *event)
     QwtPlot::showEvent(event);
 }
 
+/**
+ * @brief ScopeGadgetWidget::resizeEvent Reimplemented from QwtPlot, so a log is
+ * reduced to the new width
+ * @param event
+ */
+void ScopeGadgetWidget::resizeEvent(QResizeEvent *event)
+{
+    QwtPlot::resizeEvent(event);
+
+    if (m_offline)
+        setLogResolution();
+}
+
+/**
+ * @brief ScopeGadgetWidget::openLog Ask for a log, and decode the plotted time
+ * series out of it in the background
+ */
+void ScopeGadgetWidget::openLog()
+{
+    QVector<LogSeriesLoader::Source> sources;
+    QList<QwtPlotCurve *> curves;
+
+    foreach (PlotData *plotData, m_dataSources.values()) {
+        // Scope math runs on the live updates, so only raw values are loaded
+        TimeSeriesPlotData *timeSeries = qobject_cast<TimeSeriesPlotData *>(plotData);
+        if (!timeSeries || timeSeries->getMathFunction() != "None")
+            continue;
+
+        LogSeriesLoader::Source source;
+        source.objectName = timeSeries->getUavoName();
+        source.fieldName = timeSeries->getUavoFieldName();
+        if (timeSeries->getHaveSubFieldFlag())
+            source.elementName = timeSeries->getUavoSubFieldName();
+        source.scale = pow(10, timeSeries->getScalePower());
+
+        sources.append(source);
+        curves.append(timeSeries->getCurve());
+    }
+
+    if (sources.isEmpty()) {
+        QMessageBox::information(this, tr("Plot from log"),
+                                 tr("Only curves without scope math can be plotted from a log."));
+        return;
+    }
+
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Plot from log"), QString(),
+                                                    tr("dRonin Log Files (*.drlog *.tll)"));
+    if (fileName.isEmpty())
+        return;
+
+    cancelLog();
+
+    m_logPending = curves;
+    m_logPendingFile = fileName;
+    m_logCancel.store(0);
+
+    setTitle(tr("Loading %1...").arg(QFileInfo(fileName).fileName()));
+    m_logLoader.setFuture(QtConcurrent::run(&LogSeriesLoader::load, fileName, sources, &m_logCancel));
+}
+
+/**
+ * @brief ScopeGadgetWidget::logLoaded Replace the live curves by the log once
+ * it is decoded
+ */
+void ScopeGadgetWidget::logLoaded()
+{
+    // Left over from a load that was superseded
+    if (!m_logLoader.isFinished())
+        return;
+
+    LogSeriesLoader::Result result = m_logLoader.result();
+    QList<QwtPlotCurve *> sources = m_logPending;
+    m_logPending.clear();
+
+    // Cancelled, the curves may be gone
+    if (sources.isEmpty()) {
+        qDeleteAll(result.series);
+        return;
+    }
+
+    bool loaded = false;
+    foreach (LogSeriesData *series, result.series)
+        loaded |= series != NULL;
+
+    if (!loaded) {
+        setTitle(m_offline ? QFileInfo(m_logFileName).fileName() : QString());
+        QMessageBox::critical(this, tr("Plot from log failed"),
+                              result.error.isEmpty() ? tr("None of the plotted fields are in the log.")
+                                                     : result.error);
+        return;
+    }
+
+    closeLog();
+    m_logFileName = m_logPendingFile;
+
+    for (int i = 0; i < sources.size(); i++) {
+        LogSeriesData *series = result.series.at(i);
+        if (!series)
+            continue;
+
+        // The curve owns the series from here on
+        QwtPlotCurve *curve = new QwtPlotCurve(sources.at(i)->title());
+        curve->setPen(sources.at(i)->pen());
+        curve->setData(series);
+        curve->attach(this);
+        m_logCurves.append(curve);
+
+        m_logBounds |= series->boundingRect();
+    }
+
+    // The live curves step aside, still collecting data for when the log is closed
+    foreach (QwtPlotCurve *curve, sources) {
+        curve->setItemAttribute(QwtPlotItem::Legend, false);
+        curve->setVisible(false);
+    }
+    m_logHidden = sources;
+    m_offline = true;
+
+    setTitle(QFileInfo(m_logFileName).fileName());
+    setAxisScaleDraw(QwtPlot::xBottom, new QwtScaleDraw());
+    setLogResolution();
+    showWholeLog();
+}
+
+/**
+ * @brief ScopeGadgetWidget::closeLog Go back to plotting the live data
+ */
+void ScopeGadgetWidget::closeLog()
+{
+    if (!m_offline)
+        return;
+
+    foreach (QwtPlotCurve *curve, m_logCurves) {
+        curve->detach();
+        delete curve;
+    }
+    m_logCurves.clear();
+    m_logBounds = QRectF();
+
+    foreach (QwtPlotCurve *curve, m_logHidden) {
+        curve->setItemAttribute(QwtPlotItem::Legend, true);
+        curve->setVisible(true);
+    }
+    m_logHidden.clear();
+
+    m_offline = false;
+
+    setTitle(QString());
+    setAxisScaleDraw(QwtPlot::xBottom, new TimeScaleDraw());
+    replotNewData();
+}
+
+/**
+ * @brief ScopeGadgetWidget::cancelLog Stop decoding a log, if one is being
+ * loaded, and drop its results
+ */
+void ScopeGadgetWidget::cancelLog()
+{
+    if (m_logLoader.isRunning()) {
+        m_logCancel.store(1);
+        m_logLoader.waitForFinished();
+    }
+
+    m_logPending.clear();
+}
+
+/**
+ * @brief ScopeGadgetWidget::setLogResolution Have the log curves reduced to a
+ * min/max pair per pixel column of the canvas
+ */
+void ScopeGadgetWidget::setLogResolution()
+{
+    foreach (QwtPlotCurve *curve, m_logCurves)
+        static_cast<LogSeriesData *>(curve->data())->setResolution(canvas()->width());
+}
+
+/**
+ * @brief ScopeGadgetWidget::showWholeLog Zoom out to the whole log
+ */
+void ScopeGadgetWidget::showWholeLog()
+{
+    setAxisScale(QwtPlot::xBottom, m_logBounds.left(), m_logBounds.right());
+    setAxisAutoScale(QwtPlot::yLeft, true);
+    replot();
+}
+
 /**
  * @brief ScopeGadgetWidget::connectUAVO Connects UAVO update signal, but only if it hasn't yet been
  * connected
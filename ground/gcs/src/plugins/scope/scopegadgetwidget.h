@@ -40,6 +40,7 @@
 
 class ScopeConfig;
 class UAVDataObject;
+class QwtPlotCurve;
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_legend.h"
@@ -50,7 +51,10 @@ class UAVDataObject;
 
 #include "uavobjects/uavobject.h"
 #include "plotdata.h"
+#include "scopes2d/logseriesdata.h"
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
 #include <QTimer>
 #include <QTime>
 #include <QVector>
@@ -104,6 +108,7 @@ public:
     QwtPlotGrid *m_grid;
     QwtLegend *m_legend;
     void setScopeName(QString val) { scopeName = val; }
+    void setUseOpenGL(bool useOpenGL);
 
 protected:
     void mousePressEvent(QMouseEvent *e);
@@ -112,6 +117,7 @@ protected:
     void mouseMoveEvent(QMouseEvent *e);
     void wheelEvent(QWheelEvent *e);
     void showEvent(QShowEvent *event);
+    void resizeEvent(QResizeEvent *event);
 
 private slots:
     void uavObjectReceived(UAVObject *);
@@ -122,7 +128,11 @@ private slots:
     void popUpMenu(const QPoint &mousePosition);
     void clearPlot();
     void copyToClipboardAsImage();
+    void exportToNumPy();
     void showOptionDialog();
+    void openLog();
+    void logLoaded();
+    void closeLog();
 
 private:
     int m_refreshInterval;
@@ -132,6 +142,21 @@ private:
     static QTimer *replotTimer;
     QList<QString> m_connectedUAVObjects;
     QString scopeName;
+
+    // Offline mode: time series plotted from a log instead of live telemetry
+    bool m_offline;
+    QFutureWatcher<LogSeriesLoader::Result> m_logLoader;
+    QAtomicInt m_logCancel;
+    QList<QwtPlotCurve *> m_logPending; // Live curves being loaded, in source order
+    QList<QwtPlotCurve *> m_logHidden; // Live curves replaced by the log
+    QString m_logPendingFile;
+    QString m_logFileName; // Log shown
+    QList<QwtPlotCurve *> m_logCurves;
+    QRectF m_logBounds;
+
+    void cancelLog();
+    void setLogResolution();
+    void showWholeLog();
 };
 
 #endif /* SCOPEGADGETWIDGET_H_ */
@@ -26,10 +26,17 @@
 
 #include "scopeplugin.h"
 #include "scopegadgetfactory.h"
+#include "scopes2d/histogrambinner.h"
+#include "npylogexport.h"
 #include <QDebug>
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QtPlugin>
 #include <QStringList>
 #include <extensionsystem/pluginmanager.h>
+#include <coreplugin/icore.h>
+#include <coreplugin/coreconstants.h>
+#include <coreplugin/actionmanager/actionmanager.h>
 
 ScopePlugin::ScopePlugin()
 {
@@ -38,7 +45,7 @@ ScopePlugin::ScopePlugin()
 
 ScopePlugin::~ScopePlugin()
 {
-    // Do nothing
+    HistogramBinner::shutdown();
 }
 
 bool ScopePlugin::initialize(const QStringList &args, QString *errMsg)
@@ -48,9 +55,44 @@ bool ScopePlugin::initialize(const QStringList &args, QString *errMsg)
     mf = new ScopeGadgetFactory(this);
     addAutoReleasedObject(mf);
 
+    // Command to convert a log file to NumPy arrays
+    Core::ActionManager *am = Core::ICore::instance()->actionManager();
+    Core::ActionContainer *ac = am->actionContainer(Core::Constants::M_TOOLS);
+
+    exportToNumPyCmd = am->registerAction(new QAction(this), "ScopePlugin.ExportToNumPy",
+                                          QList<int>() << Core::Constants::C_GLOBAL_ID);
+    exportToNumPyCmd->action()->setText(tr("Export logfile to NumPy"));
+
+    ac->menu()->addSeparator();
+    ac->appendGroup("NumPy Export");
+    ac->addAction(exportToNumPyCmd, "NumPy Export");
+
+    connect(exportToNumPyCmd->action(), &QAction::triggered, this, &ScopePlugin::exportLogToNumPy);
+
     return true;
 }
 
+/**
+ * Ask for a log file and a directory, and write one .npy file per object
+ * type found in the log there
+ */
+void ScopePlugin::exportLogToNumPy()
+{
+    QString inputFileName = QFileDialog::getOpenFileName(NULL, tr("Open file"), QString(""),
+                                                         tr("dRonin Log Files (*.drlog *.tll)"));
+    if (inputFileName.isEmpty())
+        return;
+
+    QString outputDir = QFileDialog::getExistingDirectory(NULL, tr("Export log to"),
+                                                          QFileInfo(inputFileName).path());
+    if (outputDir.isEmpty())
+        return;
+
+    NpyLogExport npyExport(inputFileName, outputDir);
+    if (!npyExport.exportLog())
+        QMessageBox::critical(NULL, tr("Export failed"), npyExport.errorString());
+}
+
 void ScopePlugin::extensionsInitialized()
 {
     // Do nothing
@@ -28,6 +28,7 @@
 
 #include "scope_global.h"
 #include <extensionsystem/iplugin.h>
+#include <coreplugin/actionmanager/command.h>
 
 class ScopeGadgetFactory;
 
@@ -43,7 +44,11 @@ public:
     bool initialize(const QStringList &arguments, QString *errorString);
     void shutdown();
 
+private slots:
+    void exportLogToNumPy();
+
 private:
     ScopeGadgetFactory *mf;
+    Core::Command *exportToNumPyCmd;
 };
 #endif /* SCOPEPLUGIN_H_ */
@@ -0,0 +1,205 @@
+/**
+ ******************************************************************************
+ *
+ * @file       histogrambinner.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "scopes2d/histogrambinner.h"
+
+#include <QMutexLocker>
+#include <QThread>
+#include <QtNumeric>
+
+#include <math.h>
+
+static QThread *binningThread = NULL;
+
+/**
+ * @brief HistogramBinner::HistogramBinner Create the binner on the worker thread
+ * @param binWidth Initial bin width
+ * @param numberOfBins Number of bins, rounded up to a power of two
+ */
+HistogramBinner::HistogramBinner(double binWidth, int numberOfBins)
+    : initialWidth(qMax(binWidth, 1e-6)) // Don't allow step size to be 0
+    , width(initialWidth)
+    , origin(0)
+    , empty(true)
+    , usedFirst(0)
+    , usedLast(0)
+    , countGeneration(0)
+{
+    int size = 2;
+    while (size < numberOfBins)
+        size *= 2;
+    counts.fill(0, size);
+
+    if (binningThread == NULL) {
+        binningThread = new QThread();
+        binningThread->setObjectName("HistogramBinning");
+        binningThread->start(QThread::LowPriority);
+    }
+    moveToThread(binningThread);
+}
+
+/**
+ * @brief HistogramBinner::shutdown Stop the worker thread, once all binners
+ * are gone
+ */
+void HistogramBinner::shutdown()
+{
+    if (binningThread == NULL)
+        return;
+
+    binningThread->quit();
+    binningThread->wait();
+    delete binningThread;
+    binningThread = NULL;
+}
+
+/**
+ * @brief HistogramBinner::append Queue a value to be counted, called from
+ * the GUI thread
+ */
+void HistogramBinner::append(double value)
+{
+    QMutexLocker locker(&lock);
+
+    pending.append(value);
+
+    // The worker takes every value queued until it runs
+    if (pending.size() == 1)
+        QMetaObject::invokeMethod(this, "processPending", Qt::QueuedConnection);
+}
+
+/**
+ * @brief HistogramBinner::clear Forget all the samples and go back to the
+ * initial bin width
+ */
+void HistogramBinner::clear()
+{
+    QMutexLocker locker(&lock);
+
+    pending.clear();
+    counts.fill(0);
+    width = initialWidth;
+    empty = true;
+    countGeneration++;
+}
+
+/**
+ * @brief HistogramBinner::snapshot Get the bins from the lowest to the highest
+ * one holding samples
+ * @param samples Filled with the bins
+ * @param generation Generation of the last snapshot taken, updated
+ * @return FALSE, leaving samples alone, if nothing changed since that snapshot
+ */
+bool HistogramBinner::snapshot(QVector<QwtIntervalSample> &samples, quint64 &generation)
+{
+    QMutexLocker locker(&lock);
+
+    if (generation == countGeneration)
+        return false;
+    generation = countGeneration;
+
+    samples.clear();
+    if (empty)
+        return true;
+
+    samples.reserve(usedLast - usedFirst + 1);
+    for (int i = usedFirst; i <= usedLast; i++) {
+        double minValue = origin + i * width;
+        samples.append(QwtIntervalSample(counts[i], minValue, minValue + width));
+    }
+
+    return true;
+}
+
+void HistogramBinner::processPending()
+{
+    QMutexLocker locker(&lock);
+
+    foreach (double value, pending)
+        addValue(value);
+    pending.clear();
+
+    countGeneration++;
+}
+
+void HistogramBinner::addValue(double value)
+{
+    if (!qIsFinite(value))
+        return;
+
+    const int size = counts.size();
+
+    // Center the first range on the first value, on a multiple of the bin width
+    if (empty) {
+        origin = (floor(value / width) - size / 2) * width;
+        usedFirst = usedLast = size / 2;
+        empty = false;
+    }
+
+    while (value < origin)
+        doubleWidth(true);
+    while (value >= origin + size * width)
+        doubleWidth(false);
+
+    int bin = qBound(0, (int)floor((value - origin) / width), size - 1);
+    counts[bin]++;
+
+    usedFirst = qMin(usedFirst, bin);
+    usedLast = qMax(usedLast, bin);
+}
+
+/**
+ * @brief HistogramBinner::doubleWidth Merge the bins pairwise into one half of
+ * the array, leaving the other half empty
+ * @param extendDown TRUE to make room below the range, FALSE above it
+ */
+void HistogramBinner::doubleWidth(bool extendDown)
+{
+    const int size = counts.size();
+    const int half = size / 2;
+
+    // Done in place, each bin is read before being overwritten
+    if (extendDown) {
+        for (int i = half - 1; i >= 0; i--)
+            counts[half + i] = counts[2 * i] + counts[2 * i + 1];
+        for (int i = 0; i < half; i++)
+            counts[i] = 0;
+
+        origin -= size * width;
+        usedFirst = half + usedFirst / 2;
+        usedLast = half + usedLast / 2;
+    } else {
+        for (int i = 0; i < half; i++)
+            counts[i] = counts[2 * i] + counts[2 * i + 1];
+        for (int i = half; i < size; i++)
+            counts[i] = 0;
+
+        usedFirst /= 2;
+        usedLast /= 2;
+    }
+
+    width *= 2;
+}
@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ *
+ * @file       histogrambinner.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef HISTOGRAMBINNER_H
+#define HISTOGRAMBINNER_H
+
+#include "qwt/src/qwt_samples.h"
+
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+/**
+ * @brief The HistogramBinner class Counts histogram samples on a worker
+ * thread shared by all histograms.
+ *
+ * The bins are a fixed, power of two sized array. When a value falls out of
+ * their range, the bin width is doubled by merging adjacent bins pairwise,
+ * which makes room on the side of the value without recounting anything.
+ * The GUI thread only queues values and takes a snapshot of the bins per
+ * replot.
+ */
+class HistogramBinner : public QObject
+{
+    Q_OBJECT
+public:
+    HistogramBinner(double binWidth, int numberOfBins);
+
+    void append(double value);
+    void clear();
+    bool snapshot(QVector<QwtIntervalSample> &samples, quint64 &generation);
+
+    static void shutdown();
+
+private slots:
+    void processPending();
+
+private:
+    mutable QMutex lock;
+    QVector<double> pending;
+
+    QVector<double> counts; // Size is always a power of two
+    double initialWidth;
+    double width;
+    double origin; // Lower bound of the first bin
+    bool empty;
+    int usedFirst; // Range of bins holding samples
+    int usedLast;
+    quint64 countGeneration; // Bumped whenever the counts change
+
+    void addValue(double value);
+    void doubleWidth(bool extendDown);
+};
+
+#endif // HISTOGRAMBINNER_H
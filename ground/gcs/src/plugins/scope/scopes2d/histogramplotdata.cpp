@@ -36,33 +36,33 @@
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_plot_histogram.h"
 
-#define MAX_NUMBER_OF_INTERVALS 1000
+#define MAX_NUMBER_OF_INTERVALS 1024
 
 /**
  * @brief HistogramData::HistogramData
  * @param uavObject
  * @param uavField
- * @param binWidth
+ * @param binWidth Initial bin width, doubled as needed to hold all the samples
  * @param numberOfBins
  */
 HistogramData::HistogramData(QString uavObject, QString uavField, double binWidth,
                              uint numberOfBins)
     : Plot2dData(uavObject, uavField)
     , histogram(0)
-    , histogramBins(0)
-    , histogramInterval(0)
     , intervalSeriesData(0)
+    , binsGeneration(0)
 {
-    this->binWidth = binWidth;
-    this->numberOfBins = numberOfBins;
     scalePower = 1;
 
-    // Create histogram data set
-    histogramBins = new QVector<QwtIntervalSample>();
-    histogramInterval = new QVector<QwtInterval>();
+    binner = new HistogramBinner(binWidth, qMin(numberOfBins, (uint)MAX_NUMBER_OF_INTERVALS));
 
     // Generate the interval series
-    intervalSeriesData = new QwtIntervalSeriesData(*histogramBins);
+    intervalSeriesData = new QwtIntervalSeriesData(histogramBins);
+}
+
+HistogramData::~HistogramData()
+{
+    binner->deleteLater();
 }
 
 /**
@@ -76,9 +76,10 @@ void HistogramData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
     Q_UNUSED(scopeGadgetWidget);
     Q_UNUSED(scopeConfig);
 
-    // Plot new data
+    // Plot new data, if the binning thread counted any
     histogram->setData(intervalSeriesData);
-    intervalSeriesData->setSamples(*histogramBins);
+    if (binner->snapshot(histogramBins, binsGeneration))
+        intervalSeriesData->setSamples(histogramBins);
 }
 
 /**
@@ -88,83 +89,14 @@ void HistogramData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
  */
 bool HistogramData::append(UAVObject *obj)
 {
-
-    // Empty histogram data set
-    xData->clear();
-    yData->clear();
-
-    if (uavObjectName == obj->getName()) {
+    if (bindField(obj)) {
 
         // Get the field of interest
-        UAVObjectField *field = obj->getField(uavFieldName);
-
-        // Bad place to do this
-        double step = binWidth;
-        if (step < 1e-6) // Don't allow step size to be 0.
-            step = 1e-6;
-
-        if (numberOfBins > MAX_NUMBER_OF_INTERVALS)
-            numberOfBins = MAX_NUMBER_OF_INTERVALS;
+        UAVObjectField *field = boundField;
 
         if (field) {
-            double currentValue =
-                valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
-
-            // Extend interval, if necessary
-            if (!histogramInterval->empty()) {
-                while (currentValue < histogramInterval->front().minValue()
-                       && histogramInterval->size() <= (int)numberOfBins) {
-                    histogramInterval->prepend(
-                        QwtInterval(histogramInterval->front().minValue() - step,
-                                    histogramInterval->front().minValue()));
-                    histogramBins->prepend(QwtIntervalSample(0, histogramInterval->front()));
-                }
-
-                while (currentValue > histogramInterval->back().maxValue()
-                       && histogramInterval->size() <= (int)numberOfBins) {
-                    histogramInterval->append(
-                        QwtInterval(histogramInterval->back().maxValue(),
-                                    histogramInterval->back().maxValue() + step));
-                    histogramBins->append(QwtIntervalSample(0, histogramInterval->back()));
-                }
-
-                // If the histogram reaches its max size, pop one off the end and return
-                // This is a graceful way not to lock up the GCS if the bin width
-                // is inappropriate, or if there is an extremely distant outlier.
-                if (histogramInterval->size() > (int)numberOfBins) {
-                    histogramBins->pop_back();
-                    histogramInterval->pop_back();
-                    return false;
-                }
-
-                // Test all intervals. This isn't particularly effecient, especially if we have just
-                // extended the interval and thus know for sure that the point lies on the
-                // extremity.
-                // On top of that, some kind of search by bisection would be better.
-                for (int i = 0; i < histogramInterval->size(); i++) {
-                    if (histogramInterval->at(i).contains(currentValue)) {
-                        histogramBins->replace(i, QwtIntervalSample(histogramBins->at(i).value + 1,
-                                                                    histogramInterval->at(i)));
-                        break;
-                    }
-                }
-            } else {
-                // Create first interval
-                double tmp = 0;
-                if (tmp < currentValue) {
-                    while (tmp < currentValue) {
-                        tmp += step;
-                    }
-                    histogramInterval->append(QwtInterval(tmp - step, tmp));
-                } else {
-                    while (tmp > step) {
-                        tmp -= step;
-                    }
-                    histogramInterval->append(QwtInterval(tmp, tmp + step));
-                }
-
-                histogramBins->append(QwtIntervalSample(0, histogramInterval->front()));
-            }
+            // Counted on the binning thread
+            binner->append(field->getDouble(boundElement) * pow(10, scalePower));
 
             return true;
         }
@@ -180,10 +112,6 @@ void HistogramData::deletePlots(PlotData *histogramData)
 {
     histogram->detach();
 
-    // Delete data bins
-    delete histogramInterval;
-    delete histogramBins;
-
     // Don't delete intervalSeriesData, this is done by the histogram's destructor
     /* delete intervalSeriesData; */
 
@@ -198,6 +126,5 @@ void HistogramData::deletePlots(PlotData *histogramData)
  */
 void HistogramData::clearPlots()
 {
-    histogramBins->clear();
-    histogramInterval->clear();
+    binner->clear();
 }
@@ -27,6 +27,7 @@
 #ifndef HISTOGRAMDATA_H
 #define HISTOGRAMDATA_H
 
+#include "scopes2d/histogrambinner.h"
 #include "scopes2d/plotdata2d.h"
 #include "uavobjects/uavobject.h"
 
@@ -45,7 +46,7 @@ class HistogramData : public Plot2dData
     Q_OBJECT
 public:
     HistogramData(QString uavObject, QString uavField, double binWidth, uint numberOfBins);
-    ~HistogramData() {}
+    ~HistogramData();
 
     bool append(UAVObject *obj);
 
@@ -59,12 +60,12 @@ public:
 
 private:
     QwtPlotHistogram *histogram;
-    QVector<QwtIntervalSample> *histogramBins; // Used for histograms
-    QVector<QwtInterval> *histogramInterval;
     QwtIntervalSeriesData *intervalSeriesData;
 
-    double binWidth;
-    uint numberOfBins;
+    // Lives on the binning thread, deleted from there
+    HistogramBinner *binner;
+    QVector<QwtIntervalSample> histogramBins; // Snapshot of the bins being plotted
+    quint64 binsGeneration;
 
 private slots:
 };
@@ -0,0 +1,252 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logseriesdata.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "scopes2d/logseriesdata.h"
+
+#include "uavobjects/uavdataobject.h"
+#include "uavobjects/uavobjectfield.h"
+#include "uavobjects/uavobjectmanager.h"
+#include "uavobjects/uavobjectsinit.h"
+#include "uavtalk/logdecoder.h"
+
+#include <algorithm>
+
+//! Levels stop being reduced once they are this small
+static const int MIN_LEVEL_POINTS = 1024;
+//! Resolution assumed until the widget tells
+static const int DEFAULT_RESOLUTION = 1000;
+
+static bool beforeX(const QPointF &point, double x)
+{
+    return point.x() < x;
+}
+
+static bool afterX(double x, const QPointF &point)
+{
+    return x < point.x();
+}
+
+/**
+ * @brief reduce Halve a level, keeping the minimum and maximum of every four
+ * points in the order they were sampled
+ */
+static QVector<QPointF> reduce(const QVector<QPointF> &points)
+{
+    QVector<QPointF> reduced;
+    reduced.reserve(points.size() / 2 + 2);
+
+    for (int i = 0; i < points.size(); i += 4) {
+        int end = qMin(i + 4, points.size());
+        int lo = i, hi = i;
+
+        for (int j = i + 1; j < end; j++) {
+            if (points[j].y() < points[lo].y())
+                lo = j;
+            if (points[j].y() > points[hi].y())
+                hi = j;
+        }
+
+        reduced.append(points[qMin(lo, hi)]);
+        reduced.append(points[qMax(lo, hi)]);
+    }
+
+    return reduced;
+}
+
+/**
+ * @brief LogSeriesData::LogSeriesData Build the reductions of the samples
+ * @param samples Samples ordered by x
+ */
+LogSeriesData::LogSeriesData(const QVector<QPointF> &samples)
+    : resolution(DEFAULT_RESOLUTION)
+    , xFrom(0)
+    , xTo(-1)
+    , level(0)
+    , first(0)
+    , count(samples.size())
+{
+    levels.append(samples);
+
+    while (levels.last().size() > MIN_LEVEL_POINTS)
+        levels.append(reduce(levels.last()));
+
+    // Reductions keep the extremes, so the top level has the y bounds of all samples
+    const QVector<QPointF> &top = levels.last();
+    double yMin = top.first().y(), yMax = yMin;
+    for (int i = 1; i < top.size(); i++) {
+        yMin = qMin(yMin, top.at(i).y());
+        yMax = qMax(yMax, top.at(i).y());
+    }
+
+    d_boundingRect = QRectF(samples.first().x(), yMin, samples.last().x() - samples.first().x(),
+                            yMax - yMin);
+
+    select();
+}
+
+size_t LogSeriesData::size() const
+{
+    return count;
+}
+
+QPointF LogSeriesData::sample(size_t i) const
+{
+    return levels.at(level).at(first + i);
+}
+
+/**
+ * @brief LogSeriesData::boundingRect Bounds of all samples, not only the
+ * ones shown, so autoscaling covers the whole log
+ */
+QRectF LogSeriesData::boundingRect() const
+{
+    return d_boundingRect;
+}
+
+/**
+ * @brief LogSeriesData::setRectOfInterest Pick the points for the visible
+ * area, called by the curve whenever the axes change
+ */
+void LogSeriesData::setRectOfInterest(const QRectF &rect)
+{
+    xFrom = rect.left();
+    xTo = rect.right();
+
+    select();
+}
+
+/**
+ * @brief LogSeriesData::setResolution Set how many pixel columns the rect of
+ * interest is painted on
+ */
+void LogSeriesData::setResolution(int pixels)
+{
+    resolution = qMax(pixels, 1);
+
+    select();
+}
+
+void LogSeriesData::select()
+{
+    bool all = !(xTo > xFrom);
+    int from = 0, to = 0;
+
+    // Go up while the level has more than a min/max pair per pixel column
+    for (level = 0; level < levels.size(); level++) {
+        const QVector<QPointF> &points = levels.at(level);
+
+        if (all) {
+            from = 0;
+            to = points.size();
+        } else {
+            from = std::lower_bound(points.begin(), points.end(), xFrom, beforeX) - points.begin();
+            to = std::upper_bound(points.begin(), points.end(), xTo, afterX) - points.begin();
+        }
+
+        if (to - from <= 2 * resolution || level == levels.size() - 1)
+            break;
+    }
+
+    // One more point on either side, so the curve runs off the edges
+    first = qMax(from - 1, 0);
+    count = qMin(to + 1, levels.at(level).size()) - first;
+}
+
+/**
+ * @brief LogSeriesLoader::load Decode the sources out of a log
+ * @param fileName Telemetry log
+ * @param sources Fields to collect; instance 0 of each object is plotted
+ * @param cancel Decoding stops once this is set
+ * @return The series, or the reason there are none
+ */
+LogSeriesLoader::Result LogSeriesLoader::load(const QString &fileName,
+                                              const QVector<Source> &sources, QAtomicInt *cancel)
+{
+    Result result;
+
+    // Objects created here live in this thread, and so are updated directly
+    UAVObjectManager objManager;
+    UAVObjectsInitialize(&objManager);
+    LogDecoder decoder(&objManager);
+
+    if (!decoder.open(fileName)) {
+        result.error = decoder.errorString();
+        return result;
+    }
+
+    QVector<QVector<QPointF>> samples(sources.size());
+    QVector<QPair<int, double>> pending;
+
+    for (int i = 0; i < sources.size(); i++) {
+        const Source &source = sources.at(i);
+        UAVObject *obj = objManager.getObject(source.objectName);
+        UAVObjectField *field = obj ? obj->getField(source.fieldName) : NULL;
+        if (!field)
+            continue;
+
+        int element = 0;
+        if (!source.elementName.isEmpty())
+            element = field->getElementNames().indexOf(source.elementName);
+        if (element < 0)
+            continue;
+
+        double scale = source.scale;
+        QObject::connect(obj, &UAVObject::objectUpdated, [&pending, i, field, element, scale]() {
+            pending.append(qMakePair(i, field->getDouble(element) * scale));
+        });
+    }
+
+    // Values are stamped once the record they came in is fully decoded
+    quint32 timestamp;
+    bool decoded = false;
+    while (!cancel->load() && decoder.next(&timestamp)) {
+        for (int i = 0; i < pending.size(); i++) {
+            QVector<QPointF> &series = samples[pending[i].first];
+            double x = timestamp / 1000.0;
+
+            // The reductions need x in order
+            if (!series.isEmpty())
+                x = qMax(x, series.last().x());
+            series.append(QPointF(x, pending[i].second));
+        }
+        pending.clear();
+        decoded = true;
+    }
+
+    // A log cut short still plots up to where it breaks
+    if (!decoded)
+        result.error = decoder.errorString();
+
+    decoder.close();
+
+    if (cancel->load() || !decoded)
+        return result;
+
+    for (int i = 0; i < samples.size(); i++)
+        result.series.append(samples[i].isEmpty() ? NULL : new LogSeriesData(samples[i]));
+
+    return result;
+}
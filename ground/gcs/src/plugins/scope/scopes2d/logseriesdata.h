@@ -0,0 +1,102 @@
+/**
+ ******************************************************************************
+ *
+ * @file       logseriesdata.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef LOGSERIESDATA_H
+#define LOGSERIESDATA_H
+
+#include "qwt/src/qwt_series_data.h"
+
+#include <QAtomicInt>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The LogSeriesData class Every sample of one signal in a telemetry
+ * log, handed directly to a QwtPlotCurve.
+ *
+ * Besides the raw samples it keeps a pyramid of reductions, each level
+ * holding the minimum and maximum of every group of four points of the
+ * level below, i.e. half as many points. The curve sets the visible area
+ * as rect of interest whenever the axes change; only the points in there,
+ * from the coarsest level that still has a min/max pair per pixel column,
+ * are painted. A whole flight shows at once, and zooming in is instant.
+ */
+class LogSeriesData : public QwtSeriesData<QPointF>
+{
+public:
+    explicit LogSeriesData(const QVector<QPointF> &samples);
+
+    virtual size_t size() const;
+    virtual QPointF sample(size_t i) const;
+    virtual QRectF boundingRect() const;
+    virtual void setRectOfInterest(const QRectF &rect);
+
+    void setResolution(int pixels);
+
+    //! All samples, before decimation
+    int rawSize() const { return levels.first().size(); }
+    QPointF rawSample(int i) const { return levels.first().at(i); }
+
+private:
+    QVector<QVector<QPointF>> levels; // Raw samples first
+    int resolution; // Pixel columns across the rect of interest
+    double xFrom;
+    double xTo;
+    int level; // Level shown
+    int first; // Index of the first point shown in that level
+    int count;
+
+    void select();
+};
+
+/**
+ * @brief The LogSeriesLoader class Decodes plotted fields out of a telemetry
+ * log through a private object manager. Meant to be run off the GUI thread,
+ * it builds the series data there too.
+ */
+class LogSeriesLoader
+{
+public:
+    struct Source
+    {
+        QString objectName;
+        QString fieldName;
+        QString elementName; // Empty for the first element
+        double scale;
+    };
+
+    struct Result
+    {
+        QVector<LogSeriesData *> series; // Same order as the sources, NULL if not in the log
+        QString error;
+    };
+
+    static Result load(const QString &fileName, const QVector<Source> &sources,
+                       QAtomicInt *cancel);
+};
+
+#endif // LOGSERIESDATA_H
@@ -0,0 +1,106 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringbuffer.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QVector>
+
+/**
+ * @brief The RingBuffer class Circular buffer with O(1) append and removal
+ * of the oldest elements.
+ *
+ * The capacity doubles while the buffer is filling up so a time window can be
+ * held whatever the sample rate is; once the window is full the storage is
+ * reused without reallocation. At MAX_CAPACITY the oldest element is
+ * overwritten.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+    static const int MIN_CAPACITY = 1024;
+    static const int MAX_CAPACITY = 1 << 20;
+
+    RingBuffer()
+        : buffer(MIN_CAPACITY)
+        , head(0)
+        , count(0)
+    {
+    }
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    const T &at(int i) const { return buffer[(head + i) & (buffer.size() - 1)]; }
+    const T &first() const { return buffer[head]; }
+    const T &last() const { return at(count - 1); }
+    T &last() { return buffer[(head + count - 1) & (buffer.size() - 1)]; }
+
+    void append(const T &val)
+    {
+        if (count == buffer.size()) {
+            if (buffer.size() < MAX_CAPACITY)
+                grow();
+            else
+                removeFirst();
+        }
+
+        buffer[(head + count) & (buffer.size() - 1)] = val;
+        count++;
+    }
+
+    void removeFirst(int n = 1)
+    {
+        n = qMin(n, count);
+        head = (head + n) & (buffer.size() - 1);
+        count -= n;
+    }
+
+    void clear()
+    {
+        head = 0;
+        count = 0;
+    }
+
+private:
+    QVector<T> buffer; // Size is always a power of two
+    int head;
+    int count;
+
+    //! Double the capacity, unwrapping the elements to the start of the new storage
+    void grow()
+    {
+        QVector<T> grown(buffer.size() * 2);
+
+        for (int i = 0; i < count; i++)
+            grown[i] = at(i);
+
+        buffer.swap(grown);
+        head = 0;
+    }
+};
+
+#endif // RINGBUFFER_H
@@ -0,0 +1,242 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringseriesdata.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "scopes2d/ringseriesdata.h"
+
+#include <math.h>
+
+RingSeriesData::RingSeriesData()
+    : window(0)
+    , maxRate(0)
+    , scale(1)
+    , begin(0)
+    , end(0)
+    , binned(0)
+    , binWidth(0)
+{
+}
+
+RingSeriesData::~RingSeriesData()
+{
+    if (buffer)
+        buffer->release(this);
+}
+
+size_t RingSeriesData::size() const
+{
+    return decimated() ? bins.size() * 2 : rawSize();
+}
+
+/**
+ * @brief RingSeriesData::sample When decimated, each bin gives its minimum
+ * and maximum in the order they were sampled
+ */
+QPointF RingSeriesData::sample(size_t i) const
+{
+    if (!decimated())
+        return scaled(buffer->at(begin + i));
+
+    const Bin &bin = bins.at(i / 2);
+    bool minFirst = bin.min.x() <= bin.max.x();
+
+    return scaled(((i & 1) == 0) == minFirst ? bin.min : bin.max);
+}
+
+/**
+ * @brief RingSeriesData::boundingRect Bounding rectangle of the samples, cached
+ * until the samples change
+ */
+QRectF RingSeriesData::boundingRect() const
+{
+    if (d_boundingRect.width() < 0.0)
+        d_boundingRect = qwtBoundingRect(*this);
+
+    return d_boundingRect;
+}
+
+/**
+ * @brief RingSeriesData::setSource Show another history, starting with the
+ * samples it already holds
+ */
+void RingSeriesData::setSource(const QSharedPointer<TimeSeriesBuffer> &source)
+{
+    if (source == buffer)
+        return;
+
+    if (buffer)
+        buffer->release(this);
+
+    buffer = source;
+    begin = end = binned = 0;
+    bins.clear();
+
+    if (buffer)
+        buffer->retain(this, window, maxRate);
+
+    update();
+}
+
+/**
+ * @brief RingSeriesData::setWindow Set the time span shown, which the source
+ * is asked to keep
+ */
+void RingSeriesData::setWindow(double seconds)
+{
+    window = seconds;
+
+    if (buffer)
+        buffer->retain(this, window, maxRate);
+}
+
+/**
+ * @brief RingSeriesData::setMaxRate Set the highest sample rate worth showing,
+ * which the source is asked to limit itself to
+ * @param hz Rate in Hz, 0 for every update
+ */
+void RingSeriesData::setMaxRate(double hz)
+{
+    maxRate = hz;
+
+    if (buffer)
+        buffer->retain(this, window, maxRate);
+}
+
+/**
+ * @brief RingSeriesData::setScale Set the factor the values are shown with
+ */
+void RingSeriesData::setScale(double factor)
+{
+    scale = factor;
+
+    invalidateBoundingRect();
+}
+
+/**
+ * @brief RingSeriesData::setBinWidth Set the x span reduced to a min/max pair,
+ * rebinning the samples if it changed noticeably
+ * @param width Bin width, typically the x span of one pixel. 0 disables decimation.
+ */
+void RingSeriesData::setBinWidth(double width)
+{
+    if (width <= 0) {
+        binWidth = 0;
+        bins.clear();
+        invalidateBoundingRect();
+        return;
+    }
+
+    // Don't rebin on every pixel of a resize
+    if (binWidth > 0 && fabs(width - binWidth) < binWidth * 0.1)
+        return;
+
+    binWidth = width;
+    rebin();
+}
+
+/**
+ * @brief RingSeriesData::update Catch up with the source: take the samples
+ * appended since the last update and drop those out of the time window
+ * @return TRUE if the samples shown changed
+ */
+bool RingSeriesData::update()
+{
+    if (!buffer)
+        return false;
+
+    if (end == buffer->endIndex() && begin >= buffer->firstIndex())
+        return false;
+
+    end = buffer->endIndex();
+    begin = qMax(begin, buffer->firstIndex());
+
+    if (begin < end) {
+        double newest = buffer->at(end - 1).x();
+        while (begin < end && newest - buffer->at(begin).x() > window)
+            begin++;
+    }
+
+    if (begin == end) {
+        bins.clear();
+        binned = end;
+    } else if (binWidth > 0) {
+        if (binned < begin)
+            binned = begin;
+        for (; binned < end; binned++)
+            addToBins(buffer->at(binned));
+
+        qint64 firstIndex = (qint64)floor(buffer->at(begin).x() / binWidth);
+        while (!bins.isEmpty() && bins.first().index < firstIndex)
+            bins.removeFirst();
+    }
+
+    invalidateBoundingRect();
+
+    return true;
+}
+
+/**
+ * @brief RingSeriesData::clear Hide the samples received so far. The source
+ * is left alone, as other views may share it.
+ */
+void RingSeriesData::clear()
+{
+    if (buffer)
+        begin = end = binned = buffer->endIndex();
+    bins.clear();
+
+    invalidateBoundingRect();
+}
+
+void RingSeriesData::rebin()
+{
+    bins.clear();
+    if (buffer) {
+        begin = qMax(begin, buffer->firstIndex());
+        end = qMax(end, begin);
+    }
+    for (quint64 i = begin; i < end; i++)
+        addToBins(buffer->at(i));
+    binned = end;
+
+    invalidateBoundingRect();
+}
+
+void RingSeriesData::addToBins(const QPointF &point)
+{
+    qint64 index = (qint64)floor(point.x() / binWidth);
+
+    if (bins.isEmpty() || bins.last().index != index) {
+        Bin bin = { index, point, point };
+        bins.append(bin);
+        return;
+    }
+
+    Bin &bin = bins.last();
+    if (point.y() < bin.min.y())
+        bin.min = point;
+    if (point.y() > bin.max.y())
+        bin.max = point;
+}
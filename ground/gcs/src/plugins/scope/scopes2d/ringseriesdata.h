@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ *
+ * @file       ringseriesdata.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef RINGSERIESDATA_H
+#define RINGSERIESDATA_H
+
+#include "qwt/src/qwt_series_data.h"
+#include "scopes2d/ringbuffer.h"
+#include "scopes2d/timeseriesstore.h"
+
+#include <QSharedPointer>
+
+/**
+ * @brief The RingSeriesData class View of a TimeSeriesBuffer handed directly
+ * to a QwtPlotCurve, so nothing is copied on replot and several curves can
+ * show the same history with their own time window and scale.
+ *
+ * Once a bin width is set, the samples are also reduced incrementally to the
+ * minimum and maximum of each bin (i.e. pixel column). While that is
+ * smaller than the raw data the curve is given the reduced points, so the
+ * cost of painting depends on the widget width instead of the sample count,
+ * without losing peaks.
+ */
+class RingSeriesData : public QwtSeriesData<QPointF>
+{
+public:
+    RingSeriesData();
+    ~RingSeriesData();
+
+    virtual size_t size() const;
+    virtual QPointF sample(size_t i) const;
+    virtual QRectF boundingRect() const;
+
+    void setSource(const QSharedPointer<TimeSeriesBuffer> &buffer);
+    const QSharedPointer<TimeSeriesBuffer> &source() const { return buffer; }
+    void setWindow(double seconds);
+    void setMaxRate(double hz);
+    void setScale(double factor);
+    void setBinWidth(double width);
+
+    bool update();
+    void clear();
+
+    //! Samples in the window before decimation
+    int rawSize() const { return (int)(end - begin); }
+    QPointF rawSample(int i) const { return scaled(buffer->at(begin + i)); }
+
+private:
+    struct Bin
+    {
+        qint64 index;
+        QPointF min;
+        QPointF max;
+    };
+
+    QSharedPointer<TimeSeriesBuffer> buffer;
+    double window;
+    double maxRate;
+    double scale;
+    quint64 begin; // Absolute index of the oldest sample shown
+    quint64 end; // Absolute index after the newest sample shown
+    quint64 binned; // Absolute index after the newest sample added to the bins
+    RingBuffer<Bin> bins;
+    double binWidth; // 0 when not decimating
+
+    bool decimated() const { return binWidth > 0 && bins.size() * 2 < rawSize(); }
+    QPointF scaled(const QPointF &point) const { return QPointF(point.x(), point.y() * scale); }
+    void rebin();
+    void addToBins(const QPointF &point);
+    void invalidateBoundingRect() { d_boundingRect = QRectF(0.0, 0.0, -1.0, -1.0); }
+};
+
+#endif // RINGSERIESDATA_H
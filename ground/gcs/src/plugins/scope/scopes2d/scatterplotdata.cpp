@@ -48,9 +48,23 @@ void TimeSeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeCon
     Q_UNUSED(scopeConfig);
     Q_UNUSED(scopeGadgetWidget);
 
-    // Plot new data
-    if (readAndResetUpdatedFlag() == true)
-        curve->setSamples(*xData, *yData);
+    // Catch up with the samples collected since the last plot, then reduce
+    // them to a min/max pair per pixel column of the canvas. Sampling faster
+    // than one min/max pair per pixel column wouldn't show anything more.
+    int canvasWidth = scopeGadgetWidget->canvas()->width();
+    bool changed = readAndResetUpdatedFlag();
+    if (samples) {
+        samples->setWindow(m_xWindowSize);
+        if (canvasWidth > 0) {
+            samples->setMaxRate(canvasWidth / m_xWindowSize);
+            samples->setBinWidth(m_xWindowSize / canvasWidth);
+        }
+        changed |= samples->update();
+    }
+
+    // The curve already shares the samples, it just needs to know they changed
+    if (changed)
+        curve->itemChanged();
 
     QDateTime NOW = QDateTime::currentDateTime();
     double toTime = NOW.toTime_t();
@@ -82,15 +96,14 @@ void SeriesPlotData::plotNewData(PlotData *plot2dData, ScopeConfig *scopeConfig,
  */
 bool SeriesPlotData::append(UAVObject *obj)
 {
-    if (uavObjectName == obj->getName()) {
+    if (bindField(obj)) {
 
         // Get the field of interest
-        UAVObjectField *field = obj->getField(uavFieldName);
+        UAVObjectField *field = boundField;
 
         if (field) {
 
-            double currentValue =
-                valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
+            double currentValue = field->getDouble(boundElement) * pow(10, scalePower);
 
             // Perform scope math, if necessary
             if (mathFunction == "Boxcar average" || mathFunction == "Standard deviation") {
@@ -149,57 +162,50 @@ bool SeriesPlotData::append(UAVObject *obj)
  */
 bool TimeSeriesPlotData::append(UAVObject *obj)
 {
-    if (uavObjectName == obj->getName()) {
+    if (samples && bindField(obj)) {
         // Get the field of interest
-        UAVObjectField *field = obj->getField(uavFieldName);
+        UAVObjectField *field = boundField;
 
-        if (field) {
+        // Without math, the samples come from the store
+        if (field && mathFunction != "None") {
             QDateTime NOW = QDateTime::currentDateTime(); // THINK ABOUT REIMPLEMENTING THIS TO SHOW
                                                           // UAVO TIME, NOT SYSTEM TIME
-            double currentValue =
-                valueAsDouble(obj, field, haveSubField, uavSubFieldName) * pow(10, scalePower);
+            double currentValue = field->getDouble(boundElement) * pow(10, scalePower);
 
-            // Perform scope math, if necessary
-            if (mathFunction == "Boxcar average" || mathFunction == "Standard deviation") {
-                // Put the new value at the back
-                yDataHistory->append(currentValue);
+            // Perform scope math
+            // Put the new value at the back
+            yDataHistory->append(currentValue);
 
-                // calculate average value
-                meanSum += currentValue;
-                if (yDataHistory->size() > (int)meanSamples) {
-                    meanSum -= yDataHistory->first();
-                    yDataHistory->pop_front();
-                }
-                // make sure to correct the sum every meanSamples steps to prevent it
-                // from running away due to floating point rounding errors
-                correctionSum += currentValue;
-                if (++correctionCount >= (int)meanSamples) {
-                    meanSum = correctionSum;
-                    correctionSum = 0.0f;
-                    correctionCount = 0;
-                }
+            // calculate average value
+            meanSum += currentValue;
+            if (yDataHistory->size() > (int)meanSamples) {
+                meanSum -= yDataHistory->first();
+                yDataHistory->pop_front();
+            }
+            // make sure to correct the sum every meanSamples steps to prevent it
+            // from running away due to floating point rounding errors
+            correctionSum += currentValue;
+            if (++correctionCount >= (int)meanSamples) {
+                meanSum = correctionSum;
+                correctionSum = 0.0f;
+                correctionCount = 0;
+            }
 
-                double boxcarAvg = meanSum / yDataHistory->size();
+            double boxcarAvg = meanSum / yDataHistory->size();
 
-                if (mathFunction == "Standard deviation") {
-                    // Calculate square of sample standard deviation, with Bessel's correction
-                    double stdSum = 0;
-                    for (int i = 0; i < yDataHistory->size(); i++) {
-                        stdSum += pow(yDataHistory->at(i) - boxcarAvg, 2) / (meanSamples - 1);
-                    }
-                    yData->append(sqrt(stdSum));
-                } else {
-                    yData->append(boxcarAvg);
+            if (mathFunction == "Standard deviation") {
+                // Calculate square of sample standard deviation, with Bessel's correction
+                double stdSum = 0;
+                for (int i = 0; i < yDataHistory->size(); i++) {
+                    stdSum += pow(yDataHistory->at(i) - boxcarAvg, 2) / (meanSamples - 1);
                 }
+                currentValue = sqrt(stdSum);
             } else {
-                yData->append(currentValue);
+                currentValue = boxcarAvg;
             }
 
             double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
-            xData->append(valueX);
-
-            // Remove stale data
-            removeStaleData();
+            samples->source()->append(valueX, currentValue);
 
             return true;
         }
@@ -209,26 +215,31 @@ bool TimeSeriesPlotData::append(UAVObject *obj)
 }
 
 /**
- * @brief TimeSeriesPlotData::removeStaleData Removes stale data from time series plot
+ * @brief TimeSeriesPlotData::subscribe Have the raw values of the field sampled
+ * by the store shared by all scopes, at the rate this curve can show
+ * @param obj Plotted UAVO
+ * @return TRUE if the store feeds the curve, FALSE if it needs the object updates
  */
-void TimeSeriesPlotData::removeStaleData()
+bool TimeSeriesPlotData::subscribe(UAVObject *obj)
 {
-    double newestValue;
-    double oldestValue;
+    if (!samples || mathFunction != "None")
+        return false;
 
-    while (1) {
-        if (xData->size() == 0)
-            break;
+    if (!bindField(obj) || !boundField)
+        return false;
 
-        newestValue = xData->last();
-        oldestValue = xData->first();
+    samples->setSource(TimeSeriesStore::instance()->acquire(obj, boundField, boundElement));
 
-        if (newestValue - oldestValue > getXWindowSize()) {
-            yData->pop_front();
-            xData->pop_front();
-        } else
-            break;
-    }
+    return true;
+}
+
+/**
+ * @brief TimeSeriesPlotData::removeStaleData Removes stale data from time series plot
+ */
+void TimeSeriesPlotData::removeStaleData()
+{
+    if (samples)
+        samples->update();
 }
 
 /**
@@ -240,6 +251,37 @@ void TimeSeriesPlotData::removeStaleDataTimeout()
     removeStaleData();
 }
 
+/**
+ * @brief TimeSeriesPlotData::setCurve Sets the curve and hands it a view of the samples
+ */
+void TimeSeriesPlotData::setCurve(QwtPlotCurve *val)
+{
+    ScatterplotData::setCurve(val);
+
+    samples = new RingSeriesData();
+    samples->setWindow(m_xWindowSize);
+
+    // Math results are specific to this curve, so they get a history of
+    // their own instead of a view of the shared one
+    if (mathFunction == "None")
+        samples->setScale(pow(10, scalePower));
+    else
+        samples->setSource(QSharedPointer<TimeSeriesBuffer>(new TimeSeriesBuffer()));
+
+    curve->setData(samples);
+}
+
+/**
+ * @brief TimeSeriesPlotData::clearPlots Clear all plot data
+ */
+void TimeSeriesPlotData::clearPlots()
+{
+    ScatterplotData::clearPlots();
+
+    if (samples)
+        samples->clear();
+}
+
 /**
  * @brief ScatterplotData::deletePlots Delete all plot data
  */
@@ -28,6 +28,7 @@
 #define SCATTERPLOTDATA_H
 
 #include "scopes2d/plotdata2d.h"
+#include "scopes2d/ringseriesdata.h"
 #include "uavobjects/uavobject.h"
 #include "qwt/src/qwt_plot_curve.h"
 
@@ -50,9 +51,10 @@ public:
     ~ScatterplotData() {}
 
     virtual void deletePlots(PlotData *);
-    void clearPlots();
+    virtual void clearPlots();
 
-    void setCurve(QwtPlotCurve *val) { curve = val; }
+    virtual void setCurve(QwtPlotCurve *val) { curve = val; }
+    QwtPlotCurve *getCurve() { return curve; }
 
 protected:
     QwtPlotCurve *curve;
@@ -94,15 +96,23 @@ class TimeSeriesPlotData : public ScatterplotData
 public:
     TimeSeriesPlotData(QString uavObject, QString uavField)
         : ScatterplotData(uavObject, uavField)
+        , samples(0)
     {
         scalePower = 1;
     }
     ~TimeSeriesPlotData() {}
 
     bool append(UAVObject *obj);
+    bool subscribe(UAVObject *obj);
 
+    virtual void setCurve(QwtPlotCurve *val);
     virtual void removeStaleData();
     virtual void plotNewData(PlotData *, ScopeConfig *, ScopeGadgetWidget *);
+    void clearPlots() override;
+
+private:
+    // Owned by the curve, which reads it directly when painting
+    RingSeriesData *samples;
 
 private slots:
     void removeStaleDataTimeout();
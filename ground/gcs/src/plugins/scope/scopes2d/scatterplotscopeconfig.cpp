@@ -304,8 +304,10 @@ void Scatterplot2dScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetW
         // Keep the curve details for later
         scopeGadgetWidget->insertDataSources(curveNameScaledMath, scatterplotData);
 
-        // Connect the UAVO
-        scopeGadgetWidget->connectUAVO(obj);
+        // Connect the UAVO, unless the curve is fed by the sample store at its own rate
+        TimeSeriesPlotData *timeSeriesData = qobject_cast<TimeSeriesPlotData *>(scatterplotData);
+        if (!timeSeriesData || !timeSeriesData->subscribe(obj))
+            scopeGadgetWidget->connectUAVO(obj);
     }
     scopeGadgetWidget->replot();
 }
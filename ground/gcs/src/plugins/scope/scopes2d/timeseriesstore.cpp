@@ -0,0 +1,166 @@
+/**
+ ******************************************************************************
+ *
+ * @file       timeseriesstore.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "scopes2d/timeseriesstore.h"
+
+#include <QCoreApplication>
+
+/**
+ * @brief TimeSeriesBuffer::TimeSeriesBuffer
+ * @param field Field to sample, or NULL for a history filled by append()
+ * @param element Index of the element in field
+ */
+TimeSeriesBuffer::TimeSeriesBuffer(UAVObjectField *field, quint32 element)
+    : appendCount(0)
+    , retention(0)
+{
+    if (!field)
+        return;
+
+    sampler.reset(new UAVObjectSampler(field, element));
+    sampler->setAggregation(UAVObjectSampler::AGGREGATE_MINMAX);
+    QObject::connect(sampler.data(), &UAVObjectSampler::sampled, sampler.data(),
+                     [this](qint64 timestampMs, double value) {
+                         append(timestampMs / 1000.0, value);
+                     });
+}
+
+/**
+ * @brief TimeSeriesBuffer::append Add a sample after the newest one, dropping
+ * those no view can show anymore
+ */
+void TimeSeriesBuffer::append(double x, double y)
+{
+    samples.append(QPointF(x, y));
+    appendCount++;
+
+    int stale = 0;
+    while (stale < samples.size() - 1 && x - samples.at(stale).x() > retention)
+        stale++;
+    samples.removeFirst(stale);
+}
+
+/**
+ * @brief TimeSeriesBuffer::retain Set what a view needs to be kept
+ * @param view Any pointer identifying the view
+ * @param window Time span in seconds
+ * @param maxRate Highest useful sample rate in Hz, 0 for every update
+ */
+void TimeSeriesBuffer::retain(const void *view, double window, double maxRate)
+{
+    QHash<const void *, ViewNeeds>::const_iterator it = views.constFind(view);
+    if (it != views.constEnd() && it->window == window && it->maxRate == maxRate)
+        return;
+
+    ViewNeeds needs = { window, maxRate };
+    views.insert(view, needs);
+
+    updateNeeds();
+}
+
+void TimeSeriesBuffer::release(const void *view)
+{
+    if (views.remove(view) == 0)
+        return;
+
+    updateNeeds();
+}
+
+/**
+ * @brief TimeSeriesBuffer::updateNeeds Keep the widest window, and sample as
+ * fast as the most demanding view
+ */
+void TimeSeriesBuffer::updateNeeds()
+{
+    double maxRate = 0;
+
+    retention = 0;
+    foreach (const ViewNeeds &needs, views) {
+        retention = qMax(retention, needs.window);
+
+        if (needs.maxRate <= 0 || maxRate < 0)
+            maxRate = -1;
+        else
+            maxRate = qMax(maxRate, needs.maxRate);
+    }
+
+    if (sampler)
+        sampler->setMaxRate(qMax(maxRate, 0.0));
+}
+
+TimeSeriesStore::TimeSeriesStore(QObject *parent)
+    : QObject(parent)
+{
+}
+
+TimeSeriesStore *TimeSeriesStore::instance()
+{
+    static TimeSeriesStore *store = new TimeSeriesStore(QCoreApplication::instance());
+
+    return store;
+}
+
+/**
+ * @brief TimeSeriesStore::acquire Get the history of an object field element,
+ * starting to sample it if no other curve does yet
+ * @param obj Object instance
+ * @param field Field of obj
+ * @param element Index of the element in field
+ * @return Shared history, kept as long as the returned pointer is
+ */
+QSharedPointer<TimeSeriesBuffer> TimeSeriesStore::acquire(UAVObject *obj, UAVObjectField *field,
+                                                          quint32 element)
+{
+    QVector<TrackedSignal> &objSignals = tracked[obj];
+
+    for (int i = 0; i < objSignals.size(); i++) {
+        if (objSignals[i].field != field || objSignals[i].element != element)
+            continue;
+
+        QSharedPointer<TimeSeriesBuffer> buffer = objSignals[i].buffer.toStrongRef();
+        if (buffer)
+            return buffer;
+
+        objSignals.remove(i);
+        break;
+    }
+
+    if (objSignals.isEmpty())
+        connect(obj, &QObject::destroyed, this, &TimeSeriesStore::objectDestroyed,
+                Qt::UniqueConnection);
+
+    QSharedPointer<TimeSeriesBuffer> buffer(new TimeSeriesBuffer(field, element));
+    TrackedSignal signal = { field, element, buffer };
+    objSignals.append(signal);
+
+    return buffer;
+}
+
+void TimeSeriesStore::objectDestroyed(QObject *obj)
+{
+    // Only the address is needed, the object is already partly destroyed
+    tracked.remove(static_cast<UAVObject *>(obj));
+}
@@ -0,0 +1,119 @@
+/**
+ ******************************************************************************
+ *
+ * @file       timeseriesstore.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include "scopes2d/ringbuffer.h"
+#include "uavobjects/uavobject.h"
+#include "uavobjects/uavobjectfield.h"
+#include "uavobjects/uavobjectsampler.h"
+
+#include <QHash>
+#include <QObject>
+#include <QPointF>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QVector>
+#include <QWeakPointer>
+
+/**
+ * @brief The TimeSeriesBuffer class History of one plotted signal, shared by
+ * every curve showing it.
+ *
+ * Samples are addressed by their absolute index, i.e. the number of samples
+ * appended before them, so each view can keep its own position in the
+ * history while the oldest samples are dropped. The history is as long as
+ * the widest time window retained by a view. When sampling a field, updates
+ * are taken at the highest rate a view asks for, keeping the minimum and
+ * maximum of each period.
+ */
+class TimeSeriesBuffer
+{
+public:
+    TimeSeriesBuffer(UAVObjectField *field = 0, quint32 element = 0);
+
+    void append(double x, double y);
+
+    //! Absolute index of the oldest sample held
+    quint64 firstIndex() const { return appendCount - samples.size(); }
+    //! Absolute index the next sample will get
+    quint64 endIndex() const { return appendCount; }
+    const QPointF &at(quint64 index) const { return samples.at(index - firstIndex()); }
+
+    void retain(const void *view, double window, double maxRate);
+    void release(const void *view);
+
+private:
+    struct ViewNeeds
+    {
+        double window; // Seconds
+        double maxRate; // Hz, 0 for every update
+    };
+
+    RingBuffer<QPointF> samples;
+    quint64 appendCount;
+    QHash<const void *, ViewNeeds> views;
+    double retention;
+    QScopedPointer<UAVObjectSampler> sampler;
+
+    void updateNeeds();
+};
+
+/**
+ * @brief The TimeSeriesStore class Collects the samples of every signal
+ * plotted against time, once for all scope gadgets.
+ *
+ * Signals are keyed by object instance, field and element. The store only
+ * holds weak references: a signal stops being sampled once the last curve
+ * showing it is gone.
+ */
+class TimeSeriesStore : public QObject
+{
+    Q_OBJECT
+public:
+    static TimeSeriesStore *instance();
+
+    QSharedPointer<TimeSeriesBuffer> acquire(UAVObject *obj, UAVObjectField *field,
+                                             quint32 element);
+
+private slots:
+    void objectDestroyed(QObject *obj);
+
+private:
+    struct TrackedSignal
+    {
+        UAVObjectField *field;
+        quint32 element;
+        QWeakPointer<TimeSeriesBuffer> buffer;
+    };
+
+    explicit TimeSeriesStore(QObject *parent);
+
+    QHash<UAVObject *, QVector<TrackedSignal>> tracked;
+};
+
+#endif // TIMESERIESSTORE_H
@@ -26,6 +26,7 @@
 
 #include <QDebug>
 #include <math.h>
+#include <string.h>
 
 #include "extensionsystem/pluginmanager.h"
 #include "uavobjects/uavobjectmanager.h"
@@ -35,7 +36,6 @@
 
 #include "qwt/src/qwt.h"
 #include "qwt/src/qwt_color_map.h"
-#include "qwt/src/qwt_matrix_raster_data.h"
 #include "qwt/src/qwt_plot_spectrogram.h"
 #include "qwt/src/qwt_scale_draw.h"
 #include "qwt/src/qwt_scale_widget.h"
@@ -55,24 +55,29 @@ SpectrogramData::SpectrogramData(QString uavObject, QString uavField, double sam
     : Plot3dData(uavObject, uavField)
     , spectrogram(0)
     , rasterData(0)
+    , hopSize(0)
     , fft_object(0)
+    , fftInputHead(0)
+    , fftInputCount(0)
 {
     this->samplingFrequency = samplingFrequency;
     this->timeHorizon = timeHorizon;
     autoscaleValueUpdated = 0;
 
+    this->windowWidth = windowWidth;
+
     // Create raster data
-    rasterData = new QwtMatrixRasterData();
+    rasterData = new SpectrogramRasterData();
+    rasterData->setColumnCount(windowWidth);
 
-    if (mathFunction == "FFT") {
-        fft_object = new ffft::FFTReal<double>(windowWidth);
-        windowWidth /= 2;
+    // Start with an empty (zero) history, which is scrolled out as rows come in
+    QDateTime NOW =
+        QDateTime::currentDateTime(); // TODO: Upgrade this to show UAVO time and not system time
+    for (uint i = 0; i < timeHorizon; i++) {
+        double *row = rasterData->appendRow(NOW.toTime_t() + NOW.time().msec() / 1000.0 + i);
+        memset(row, 0, windowWidth * sizeof(double));
     }
 
-    this->windowWidth = windowWidth;
-
-    rasterData->setValueMatrix(*zDataHistory, windowWidth);
-
     // Set the ranges for the plot
     resetAxisRanges();
     plotData.clear();
@@ -80,6 +85,11 @@ SpectrogramData::SpectrogramData(QString uavObject, QString uavField, double sam
         -1; // To keep track of missing instances. We assume communications keep packet order
 }
 
+SpectrogramData::~SpectrogramData()
+{
+    delete fft_object;
+}
+
 void SpectrogramData::setXMaximum(double val)
 {
     xMaximum = val;
@@ -119,10 +129,10 @@ void SpectrogramData::plotNewData(PlotData *plot3dData, ScopeConfig *scopeConfig
 
     removeStaleData();
 
-    // Check for new data
+    // Check for new data. The spectrogram reads the rows in place, it only needs to be
+    // told they changed.
     if (readAndResetUpdatedFlag() == true) {
-        // Plot new data
-        rasterData->setValueMatrix(*zDataHistory, windowWidth);
+        spectrogram->itemChanged();
 
         // Check autoscale. (For some reason, QwtSpectrogram doesn't support autoscale)
         if (zMaximum == 0) {
@@ -176,7 +186,7 @@ bool SpectrogramData::append(UAVObject *multiObj)
         QList<UAVObjectField *> fieldList = multiObj->getFields();
         foreach (UAVObjectField *field, fieldList) {
             if (field->getType() == UAVObjectField::INT16 && field->getName() == "samples") {
-                newWindowWidth = field->getValue().toDouble();
+                newWindowWidth = field->get<qint16>();
                 break;
             }
         }
@@ -200,7 +210,7 @@ bool SpectrogramData::append(UAVObject *multiObj)
             clearPlots();
 
             plotData.clear();
-            rasterData->setValueMatrix(*zDataHistory, windowWidth);
+            rasterData->setColumnCount(windowWidth);
 
             qDebug() << "Spectrogram width adjusted to " << windowWidth;
         }
@@ -215,18 +225,31 @@ bool SpectrogramData::append(UAVObject *multiObj)
                 int numElements = field->getNumElements();
 
                 double scale = 1;
+                double offset = 0;
                 QList<UAVObjectField *> fieldList = obj->getFields();
                 foreach (UAVObjectField *field, fieldList) {
                     // Check if the instance has a scale field
                     if (field->getType() == UAVObjectField::FLOAT32
                         && field->getName() == "scale") {
-                        scale = field->getValue().toDouble();
+                        scale = field->get<float>();
                         break;
                     }
 
+                    // Log magnitude bins computed on board, value = raw * dBPerLSB + dBOffset
+                    if (field->getType() == UAVObjectField::FLOAT32
+                        && field->getName() == "dBPerLSB") {
+                        scale = 1 / field->get<float>();
+                        continue;
+                    }
+                    if (field->getType() == UAVObjectField::FLOAT32
+                        && field->getName() == "dBOffset") {
+                        offset = field->get<float>();
+                        continue;
+                    }
+
                     // Check if data is ordered. If not, just discard everything
                     if (field->getType() == UAVObjectField::INT16 && field->getName() == "index") {
-                        int currentIndex = field->getValue().toDouble();
+                        int currentIndex = field->get<qint16>();
                         if (currentIndex != (lastInstanceIndex + 1)) {
                             fprintf(stderr, "Out of order index. Got %d expected %d\n",
                                     currentIndex, lastInstanceIndex + 1);
@@ -241,7 +264,7 @@ bool SpectrogramData::append(UAVObject *multiObj)
 
                 for (int i = 0; i < numElements; i++) {
                     double currentValue =
-                        field->getValue(i).toDouble() / scale; // Get the value and scale it
+                        field->getDouble(i) / scale + offset; // Get the value and scale it
 
                     // Normally some math would go here, modifying currentValue before appending it
                     // to values
@@ -265,63 +288,35 @@ bool SpectrogramData::append(UAVObject *multiObj)
                 return false;
             }
 
+            double timestamp = NOW.toTime_t() + NOW.time().msec() / 1000.0;
+
             // Check if the FFT needs to be calculated
             // Because this function is optional we will calculate the FFT and then
-            // update the original vector. This will allow using the same code
-            // to display the information.
+            // write the magnitudes as rows, the same way raw data is displayed.
             if (mathFunction == "FFT") {
-
-                // Check if the fft_object was already created or needs to be updated
-                // May happen if settings change after the spectrogram was created
-                if (fft_object == NULL || fft_object->get_length() != valuesToProcess) {
-                    if (fft_object != NULL)
-                        delete fft_object;
-
-                    fft_object = new ffft::FFTReal<double>(valuesToProcess);
-                }
-
-                // Hanning Window
-                for (int i = 0; i < valuesToProcess; i++) {
-                    plotData[i] *= pow(sin(PI * i / (valuesToProcess - 1)), 2);
-                }
-
-                QVector<double> fftout(valuesToProcess);
-
-                fft_object->do_fft(&fftout[0], plotData.data()); // Do FFT
-                plotData.clear(); // Clear vector
-
-                // Lets get the magnitude and scale it.
-                // mag = X * sqrt(re^2 + im^2)/n
-                // X (4.2) is chosen so that the magnitude presented is similar to the acceleration
-                // registered
-                // although this is not 100% correct, it helps users understanding the spectrogram.
-                for (unsigned int i = 0; i < valuesToProcess / 2; i++) {
-                    plotData << 4.2
-                            * sqrt(pow(fftout[i], 2) + pow(fftout[valuesToProcess / 2 + i], 2))
-                            / valuesToProcess;
-                }
-            }
-
-            // Apply autoscale if enabled
-            if (zMaximum == 0) {
-                for (unsigned int i = 0; i < windowWidth; i++) {
-                    // See if autoscale is turned on and if the value exceeds the maximum for the
-                    // scope.
-                    if (plotData[i] > rasterData->interval(Qt::ZAxis).maxValue()) {
-                        // Change scope maximum and color depth
-                        rasterData->setInterval(Qt::ZAxis, QwtInterval(0, plotData[i]));
-                        autoscaleValueUpdated = plotData[i];
+                prepareFFT(valuesToProcess);
+
+                // One row per hop, over the latest window. Windows overlap when the hop is
+                // shorter than the window.
+                unsigned int hop = (hopSize > 0 && hopSize < valuesToProcess) ? hopSize
+                                                                             : valuesToProcess;
+                foreach (double value, plotData) {
+                    fftInput[(fftInputHead + fftInputCount) % valuesToProcess] = value;
+
+                    if (++fftInputCount == valuesToProcess) {
+                        computeFFTRow(timestamp);
+                        fftInputHead = (fftInputHead + hop) % valuesToProcess;
+                        fftInputCount -= hop;
                     }
                 }
+            } else {
+                double *row = rasterData->appendRow(timestamp);
+                memcpy(row, plotData.constData(), windowWidth * sizeof(double));
+                autoscaleRow(row);
             }
 
-            timeDataHistory->append(NOW.toTime_t() + NOW.time().msec() / 1000.0);
-            while (timeDataHistory->back() - timeDataHistory->front() > timeHorizon) {
-                timeDataHistory->pop_front();
-                zDataHistory->remove(0, fminl(windowWidth, zDataHistory->size()));
-            }
+            rasterData->removeRowsOlderThan(rasterData->newestTimestamp() - timeHorizon);
 
-            *zDataHistory << plotData;
             plotData.clear();
             lastInstanceIndex = -1; // Next index will be 0
 
@@ -332,6 +327,84 @@ bool SpectrogramData::append(UAVObject *multiObj)
     return false;
 }
 
+/**
+ * @brief SpectrogramData::prepareFFT (Re)create the FFT, window and buffers when the FFT
+ * length changes. Might happen if settings change after the spectrogram was created.
+ * @param length FFT length, a power of 2
+ */
+void SpectrogramData::prepareFFT(unsigned int length)
+{
+    if (fft_object != NULL && fft_object->get_length() == (long)length)
+        return;
+
+    delete fft_object;
+    fft_object = new ffft::FFTReal<float>(length);
+
+    // Hanning Window
+    fftWindow.resize(length);
+    for (unsigned int i = 0; i < length; i++)
+        fftWindow[i] = pow(sin(PI * i / (length - 1)), 2);
+
+    fftInput.resize(length);
+    fftInputHead = 0;
+    fftInputCount = 0;
+    fftFrame.resize(length);
+    fftOutput.resize(length);
+}
+
+/**
+ * @brief SpectrogramData::computeFFTRow Compute the spectrum of the oldest queued window
+ * into a new row of the raster
+ * @param timestamp Time of the row
+ */
+void SpectrogramData::computeFFTRow(double timestamp)
+{
+    const unsigned int length = fftWindow.size();
+
+    for (unsigned int i = 0; i < length; i++)
+        fftFrame[i] = fftInput[(fftInputHead + i) % length] * fftWindow[i];
+
+    fft_object->do_fft(fftOutput.data(), fftFrame.data()); // Do FFT
+
+    // Lets get the magnitude and scale it.
+    // mag = X * sqrt(re^2 + im^2)/n
+    // X (4.2) is chosen so that the magnitude presented is similar to the acceleration
+    // registered
+    // although this is not 100% correct, it helps users understanding the spectrogram.
+    double *row = rasterData->appendRow(timestamp);
+    for (unsigned int i = 0; i < length / 2; i++) {
+        float re = fftOutput[i];
+        float im = fftOutput[length / 2 + i];
+        row[i] = 4.2 * sqrtf(re * re + im * im) / length;
+    }
+
+    // The spectrum only covers half the window's columns
+    for (unsigned int i = length / 2; i < windowWidth; i++)
+        row[i] = 0;
+
+    autoscaleRow(row);
+}
+
+/**
+ * @brief SpectrogramData::autoscaleRow Extend the Z range to a new row, if autoscale is
+ * enabled
+ */
+void SpectrogramData::autoscaleRow(const double *row)
+{
+    if (zMaximum != 0)
+        return;
+
+    for (unsigned int i = 0; i < windowWidth; i++) {
+        // See if autoscale is turned on and if the value exceeds the maximum for the
+        // scope.
+        if (row[i] > rasterData->interval(Qt::ZAxis).maxValue()) {
+            // Change scope maximum and color depth
+            rasterData->setInterval(Qt::ZAxis, QwtInterval(0, row[i]));
+            autoscaleValueUpdated = row[i];
+        }
+    }
+}
+
 /**
  * @brief SpectrogramScopeConfig::deletePlots Delete all plot data
  */
@@ -352,8 +425,9 @@ void SpectrogramData::deletePlots(PlotData *spectrogramData)
  */
 void SpectrogramData::clearPlots()
 {
-    timeDataHistory->clear();
-    zDataHistory->clear();
+    rasterData->clear();
+    fftInputHead = 0;
+    fftInputCount = 0;
 
     resetAxisRanges();
 }
@@ -28,9 +28,9 @@
 #define SPECTROGRAMDATA_H
 
 #include "scopes3d/plotdata3d.h"
+#include "scopes3d/spectrogramrasterdata.h"
 #include "uavobjects/uavobject.h"
 #include "qwt/src/qwt_plot_spectrogram.h"
-#include "qwt/src/qwt_matrix_raster_data.h"
 
 #include <QTimer>
 #include <QTime>
@@ -48,7 +48,7 @@ class SpectrogramData : public Plot3dData
 public:
     SpectrogramData(QString uavObject, QString uavField, double samplingFrequency,
                     unsigned int windowWidth, double timeHorizon);
-    ~SpectrogramData() {}
+    ~SpectrogramData();
 
     /*!
       \brief Append new data to the plot
@@ -76,24 +76,38 @@ public:
     virtual void setXMaximum(double val);
     virtual void setYMaximum(double val);
     virtual void setZMaximum(double val);
+    void setHopSize(unsigned int val) { hopSize = val; }
     void clearPlots();
 
-    QwtMatrixRasterData *getRasterData() { return rasterData; }
+    SpectrogramRasterData *getRasterData() { return rasterData; }
     void setSpectrogram(QwtPlotSpectrogram *val) { spectrogram = val; }
 
 private:
     void resetAxisRanges();
+    void prepareFFT(unsigned int length);
+    void computeFFTRow(double timestamp);
+    void autoscaleRow(const double *row);
 
     QwtPlotSpectrogram *spectrogram;
-    QwtMatrixRasterData *rasterData;
+    SpectrogramRasterData *rasterData;
 
     double samplingFrequency;
     double timeHorizon;
     unsigned int windowWidth;
     double autoscaleValueUpdated;
-    ffft::FFTReal<double> *fft_object;
     QVector<double> plotData;
     int lastInstanceIndex;
+
+    // Short time FFT state. Samples are queued in the fftInput ring, and a
+    // row is computed over the oldest window every hopSize samples.
+    unsigned int hopSize;
+    ffft::FFTReal<float> *fft_object;
+    QVector<float> fftWindow; // Precomputed Hann window
+    QVector<float> fftInput;
+    unsigned int fftInputHead; // Oldest queued sample
+    unsigned int fftInputCount;
+    QVector<float> fftFrame;
+    QVector<float> fftOutput;
 };
 
 #endif // SPECTROGRAMDATA_H
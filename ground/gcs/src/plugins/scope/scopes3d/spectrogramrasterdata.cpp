@@ -0,0 +1,158 @@
+/**
+ ******************************************************************************
+ *
+ * @file       spectrogramrasterdata.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "scopes3d/spectrogramrasterdata.h"
+
+#include <string.h>
+
+SpectrogramRasterData::SpectrogramRasterData()
+    : columns(1)
+    , capacity(64)
+    , head(0)
+    , rows(0)
+{
+    values.resize(capacity * columns);
+    times.resize(capacity);
+}
+
+/**
+ * @brief SpectrogramRasterData::setColumnCount Set the number of values per row.
+ * Drops all rows.
+ */
+void SpectrogramRasterData::setColumnCount(int val)
+{
+    columns = qMax(val, 1);
+
+    // Keep the current number of rows but within the memory budget
+    while (capacity > 1 && capacity * columns > MAX_VALUES)
+        capacity /= 2;
+
+    values.fill(0, capacity * columns);
+    times.fill(0, capacity);
+    clear();
+}
+
+/**
+ * @brief SpectrogramRasterData::appendRow Add a row after the newest one
+ * @param timestamp Time of the row
+ * @return Storage of the new row, columnCount() values to be filled by the caller
+ */
+double *SpectrogramRasterData::appendRow(double timestamp)
+{
+    if (rows == capacity) {
+        if (capacity * 2 * columns <= MAX_VALUES) {
+            grow();
+        } else {
+            // Out of budget, overwrite the oldest row
+            head = (head + 1) & (capacity - 1);
+            rows--;
+        }
+    }
+
+    int slot = (head + rows) & (capacity - 1);
+    rows++;
+
+    times[slot] = timestamp;
+    return values.data() + slot * columns;
+}
+
+/**
+ * @brief SpectrogramRasterData::removeRowsOlderThan Drop the rows before a time
+ */
+void SpectrogramRasterData::removeRowsOlderThan(double timestamp)
+{
+    while (rows > 0 && times[head] < timestamp) {
+        head = (head + 1) & (capacity - 1);
+        rows--;
+    }
+}
+
+void SpectrogramRasterData::clear()
+{
+    head = 0;
+    rows = 0;
+}
+
+/**
+ * @brief SpectrogramRasterData::value Nearest row and column of a point, the rows
+ * being spread evenly over the Y interval
+ */
+double SpectrogramRasterData::value(double x, double y) const
+{
+    const QwtInterval &xInterval = interval(Qt::XAxis);
+    const QwtInterval &yInterval = interval(Qt::YAxis);
+
+    if (rows == 0 || !xInterval.contains(x) || !yInterval.contains(y))
+        return 0;
+
+    int col = (int)((x - xInterval.minValue()) / xInterval.width() * columns);
+    int row = (int)((y - yInterval.minValue()) / yInterval.width() * rows);
+
+    col = qBound(0, col, columns - 1);
+    row = qBound(0, row, rows - 1);
+
+    return values[((head + row) & (capacity - 1)) * columns + col];
+}
+
+/**
+ * @brief SpectrogramRasterData::pixelHint Size of one value, so the spectrogram
+ * is rendered at the data resolution and then scaled
+ */
+QRectF SpectrogramRasterData::pixelHint(const QRectF &area) const
+{
+    Q_UNUSED(area);
+
+    if (rows == 0)
+        return QRectF();
+
+    const QwtInterval &xInterval = interval(Qt::XAxis);
+    const QwtInterval &yInterval = interval(Qt::YAxis);
+
+    return QRectF(xInterval.minValue(), yInterval.minValue(), xInterval.width() / columns,
+                  yInterval.width() / rows);
+}
+
+/**
+ * @brief SpectrogramRasterData::grow Double the row capacity, unwrapping the rows
+ * to the start of the new storage
+ */
+void SpectrogramRasterData::grow()
+{
+    QVector<double> grownValues(capacity * 2 * columns);
+    QVector<double> grownTimes(capacity * 2);
+
+    for (int i = 0; i < rows; i++) {
+        int slot = (head + i) & (capacity - 1);
+        memcpy(grownValues.data() + i * columns, values.constData() + slot * columns,
+               columns * sizeof(double));
+        grownTimes[i] = times[slot];
+    }
+
+    values.swap(grownValues);
+    times.swap(grownTimes);
+    capacity *= 2;
+    head = 0;
+}
@@ -0,0 +1,72 @@
+/**
+ ******************************************************************************
+ *
+ * @file       spectrogramrasterdata.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef SPECTROGRAMRASTERDATA_H
+#define SPECTROGRAMRASTERDATA_H
+
+#include "qwt/src/qwt_raster_data.h"
+
+#include <QVector>
+
+/**
+ * @brief The SpectrogramRasterData class Ring of spectrogram rows, oldest at
+ * the bottom of the Y interval, read directly by the QwtPlotSpectrogram.
+ *
+ * Rows are written in place: appending reuses the storage of dropped rows,
+ * and the storage only grows (by doubling) while the time horizon is filling
+ * up, so a running spectrogram neither copies nor reallocates its history.
+ */
+class SpectrogramRasterData : public QwtRasterData
+{
+public:
+    static const int MAX_VALUES = 10000000;
+
+    SpectrogramRasterData();
+
+    void setColumnCount(int columns);
+    int columnCount() const { return columns; }
+    int rowCount() const { return rows; }
+
+    double *appendRow(double timestamp);
+    void removeRowsOlderThan(double timestamp);
+    double newestTimestamp() const { return rows ? times[(head + rows - 1) & (capacity - 1)] : 0; }
+    void clear();
+
+    virtual double value(double x, double y) const;
+    virtual QRectF pixelHint(const QRectF &area) const;
+
+private:
+    QVector<double> values; // capacity * columns, one row after the other
+    QVector<double> times;
+    int columns;
+    int capacity; // In rows, always a power of two
+    int head;
+    int rows;
+
+    void grow();
+};
+
+#endif // SPECTROGRAMRASTERDATA_H
@@ -47,6 +47,7 @@ SpectrogramScopeConfig::SpectrogramScopeConfig()
     timeHorizon = 60;
     samplingFrequency = 100;
     windowWidth = 64;
+    hopSize = 0;
     zMaximum = 120;
     colorMapType = ColorMap::STANDARD;
 }
@@ -60,6 +61,7 @@ SpectrogramScopeConfig::SpectrogramScopeConfig(QSettings *qSettings)
     timeHorizon = qSettings->value("timeHorizon").toDouble();
     samplingFrequency = qSettings->value("samplingFrequency").toDouble();
     windowWidth = qSettings->value("windowWidth").toInt();
+    hopSize = qSettings->value("hopSize", 0).toInt();
     zMaximum = qSettings->value("zMaximum").toDouble();
     colorMapType = (ColorMap::ColorMapType)qSettings->value("colorMap").toInt();
 
@@ -94,6 +96,7 @@ SpectrogramScopeConfig::SpectrogramScopeConfig(Ui::ScopeGadgetOptionsPage *optio
     bool parseOK = false;
 
     windowWidth = options_page->sbSpectrogramWidth->value();
+    hopSize = options_page->sbSpectrogramHop->value();
     samplingFrequency = options_page->sbSpectrogramFrequency->value();
     timeHorizon = options_page->sbSpectrogramTimeHorizon->value();
     zMaximum = options_page->spnMaxSpectrogramZ->value();
@@ -174,6 +177,7 @@ void SpectrogramScopeConfig::saveConfiguration(QSettings *qSettings)
     qSettings->setValue("samplingFrequency", samplingFrequency);
     qSettings->setValue("timeHorizon", timeHorizon);
     qSettings->setValue("windowWidth", windowWidth);
+    qSettings->setValue("hopSize", hopSize);
     qSettings->setValue("zMaximum", zMaximum);
 
     for (int i = 0; i < plot3dCurveCount; i++) {
@@ -236,6 +240,7 @@ void SpectrogramScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetWid
     spectrogramData->setYMinimum(0);
     spectrogramData->setYMaximum(timeHorizon);
     spectrogramData->setZMaximum(zMaximum);
+    spectrogramData->setHopSize(hopSize);
     spectrogramData->setScalePower(spectrogramSourceConfigs->yScalePower);
     spectrogramData->setMeanSamples(spectrogramSourceConfigs->yMeanSamples);
     spectrogramData->setMathFunction(spectrogramSourceConfigs->mathFunction);
@@ -274,27 +279,6 @@ void SpectrogramScopeConfig::loadConfiguration(ScopeGadgetWidget *scopeGadgetWid
     plotSpectrogram->setRenderHint(QwtPlotItem::RenderAntialiased);
     plotSpectrogram->setColorMap(new ColorMap(colorMapType));
 
-    // Initial raster data
-
-    QDateTime NOW =
-        QDateTime::currentDateTime(); // TODO: Upgrade this to show UAVO time and not system time
-    for (uint i = 0; i < timeHorizon; i++) {
-        spectrogramData->timeDataHistory->append(NOW.toTime_t() + NOW.time().msec() / 1000.0 + i);
-    }
-
-    if (((double)windowWidth) * timeHorizon < (double)10000000.0
-            * sizeof(spectrogramData->zDataHistory->front())) { // Don't exceed 10MB for memory
-        for (uint i = 0; i < windowWidth * timeHorizon; i++) {
-            spectrogramData->zDataHistory->append(0);
-        }
-    } else {
-        qDebug() << "For some reason, we're trying to allocate a gigantic spectrogram. This "
-                    "probably represents a problem in the configuration file. TimeHorizion: "
-                 << timeHorizon << ", windowWidth: " << windowWidth;
-        Q_ASSERT(0);
-        return;
-    }
-
     // Set up colorbar on right axis
     spectrogramData->rightAxis = scopeGadgetWidget->axisWidget(QwtPlot::yRight);
     spectrogramData->rightAxis->setTitle("Intensity");
@@ -341,6 +325,7 @@ void SpectrogramScopeConfig::setGuiConfiguration(Ui::ScopeGadgetOptionsPage *opt
         int uavoIdx = options_page->cmbUAVObjectsSpectrogram->findText(plot3dData->uavObjectName);
         options_page->cmbUAVObjectsSpectrogram->setCurrentIndex(uavoIdx);
         options_page->sbSpectrogramWidth->setValue(windowWidth);
+        options_page->sbSpectrogramHop->setValue(hopSize);
 
         int uavoFieldIdx =
             options_page->cmbUavoFieldSpectrogram->findText(plot3dData->uavFieldName);
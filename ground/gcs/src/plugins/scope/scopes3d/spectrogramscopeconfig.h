@@ -63,6 +63,7 @@ public:
     double getSamplingFrequency() { return samplingFrequency; }
     double getZMaximum() { return zMaximum; }
     unsigned int getWindowWidth() { return windowWidth; }
+    unsigned int getHopSize() { return hopSize; }
     double getTimeHorizon() { return timeHorizon; }
     virtual QList<Plot3dCurveConfiguration *> getDataSourceConfigs()
     {
@@ -74,6 +75,7 @@ public:
     void setSamplingFrequency(double val) { samplingFrequency = val; }
     void setZMaximum(double val) { zMaximum = val; }
     void setWindowWidth(unsigned int val) { windowWidth = val; }
+    void setHopSize(unsigned int val) { hopSize = val; }
     void setTimeHorizon(double val) { timeHorizon = val; }
     virtual void setGuiConfiguration(Ui::ScopeGadgetOptionsPage *options_page);
     virtual ScopeConfig *cloneScope(ScopeConfig *);
@@ -96,6 +98,7 @@ private:
 
     double samplingFrequency;
     unsigned int windowWidth;
+    unsigned int hopSize; // FFT samples between rows, 0 for the window width
     QString yAxisUnits;
     double zMaximum;
 
@@ -148,6 +148,9 @@ QIODevice *SerialConnection::openDevice(IDevice *deviceName)
                     && serialHandle->setStopBits(QSerialPort::OneStop)
                     && serialHandle->setFlowControl(QSerialPort::NoFlowControl)) {
                     m_deviceOpened = true;
+                    // Telemetry steps up to this once connected
+                    if (m_config->maxSpeed().toInt() > m_config->speed().toInt())
+                        serialHandle->setProperty("negotiateSpeedTo", m_config->maxSpeed().toInt());
                 }
             }
             return serialHandle;
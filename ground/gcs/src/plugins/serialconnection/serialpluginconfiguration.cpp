@@ -57,6 +57,7 @@ IUAVGadgetConfiguration *SerialPluginConfiguration::clone()
 {
     SerialPluginConfiguration *m = new SerialPluginConfiguration(this->classId());
     m->m_speed = m_speed;
+    m->m_maxSpeed = m_maxSpeed;
     m->m_reconnect = m_reconnect;
     return m;
 }
@@ -77,6 +78,7 @@ void SerialPluginConfiguration::restoresettings()
         m_speed = "115200";
     else
         m_speed = str;
+    m_maxSpeed = settings->value(QLatin1String("maxSpeed")).toString();
     m_reconnect = settings->value(QLatin1String("reconnect"), tr("")).toBool();
     settings->endGroup();
 }
@@ -84,6 +86,7 @@ void SerialPluginConfiguration::savesettings() const
 {
     settings->beginGroup(QLatin1String("SerialConn"));
     settings->setValue(QLatin1String("speed"), m_speed);
+    settings->setValue(QLatin1String("maxSpeed"), m_maxSpeed);
     settings->setValue(QLatin1String("reconnect"), m_reconnect);
     settings->endGroup();
 }
@@ -42,6 +42,8 @@ public:
     explicit SerialPluginConfiguration(QString classId, QSettings *qSettings = 0,
                                        QObject *parent = 0);
     QString speed() { return m_speed; }
+    //! Highest speed to negotiate up to once connected, empty to keep speed()
+    QString maxSpeed() { return m_maxSpeed; }
     bool reconnect() { return m_reconnect; }
     void saveConfig(QSettings *settings) const;
     IUAVGadgetConfiguration *clone();
@@ -51,10 +53,12 @@ public:
 
 private:
     QString m_speed;
+    QString m_maxSpeed;
     bool m_reconnect;
     QSettings *settings;
 public slots:
     void setSpeed(QString speed) { m_speed = speed; }
+    void setMaxSpeed(QString speed) { m_maxSpeed = speed; }
     void setReconnect(bool reconnect) { m_reconnect = reconnect; }
 };
 
@@ -78,6 +78,14 @@ QWidget *SerialPluginOptionsPage::createPage(QWidget *parent)
 
     options_page->cb_speed->addItems(allowedSpeeds);
     options_page->cb_speed->setCurrentIndex(options_page->cb_speed->findText(m_config->speed()));
+
+    // Speeds the firmware can step up to
+    options_page->cb_maxSpeed->addItem(tr("Off"), QString());
+    foreach (const QString &speed, QStringList() << "57600" << "115200" << "230400" << "460800"
+                                                 << "921600")
+        options_page->cb_maxSpeed->addItem(speed, speed);
+    int maxIndex = options_page->cb_maxSpeed->findData(m_config->maxSpeed());
+    options_page->cb_maxSpeed->setCurrentIndex(qMax(maxIndex, 0));
     options_page->reconnectCB->setChecked(m_config->reconnect());
     return optionsPageWidget;
 }
@@ -91,6 +99,7 @@ QWidget *SerialPluginOptionsPage::createPage(QWidget *parent)
 void SerialPluginOptionsPage::apply()
 {
     m_config->setSpeed(options_page->cb_speed->currentText());
+    m_config->setMaxSpeed(options_page->cb_maxSpeed->currentData().toString());
     m_config->setReconnect(options_page->reconnectCB->isChecked());
     m_config->savesettings();
 }
@@ -48,6 +48,12 @@ SystemHealthGadgetWidget::SystemHealthGadgetWidget(QWidget *parent)
     foreground = new QGraphicsSvgItem();
     nolink = new QGraphicsSvgItem();
 
+    // These only change with the SVG file, the alarm indicators with their
+    // state, so render them once per size rather than on every repaint
+    background->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    foreground->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+    nolink->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+
     paint();
 
     // Now connect the widget to the SystemAlarms UAVObject
@@ -86,37 +92,45 @@ void SystemHealthGadgetWidget::onAutopilotDisconnect()
 void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
 {
     static QList<QString> warningClean;
-    // This code does not know anything about alarms beforehand, and
-    // I found no efficient way to locate items inside the scene by
-    // name, so it's just as simple to reset the scene:
-    // And add the one with the right name.
-    QGraphicsScene *m_scene = scene();
-    foreach (QGraphicsItem *item, background->childItems()) {
-        m_scene->removeItem(item);
-        delete item; // removeItem does _not_ delete the item.
-    }
 
+    SystemAlarms *alarms = qobject_cast<SystemAlarms *>(systemAlarm);
     UAVObjectField *field = systemAlarm->getField("Alarm");
-    Q_ASSERT(field);
-    if (field == NULL)
+    Q_ASSERT(alarms && field);
+    if (alarms == NULL || field == NULL)
+        return;
+
+    // The board sends the alarms periodically, mostly as they were, so
+    // compare the raw states before looking at any of them
+    const SystemAlarms::DataFields data = alarms->getData();
+    const QByteArray states(reinterpret_cast<const char *>(data.Alarm), sizeof(data.Alarm));
+    if (states == shownStates)
         return;
 
+    const QStringList elementNames = field->getElementNames();
+
     for (uint i = 0; i < field->getNumElements(); ++i) {
-        QString element = field->getElementNames()[i];
+        if ((int)i < shownStates.size() && shownStates.at(i) == states.at(i))
+            continue;
+
+        const QString &element = elementNames[i];
         QString value = field->getValue(i).toString();
-        if (m_renderer->elementExists(element)) {
-            QMatrix blockMatrix = m_renderer->matrixForElement(element);
-            qreal startX = blockMatrix.mapRect(m_renderer->boundsOnElement(element)).x();
-            qreal startY = blockMatrix.mapRect(m_renderer->boundsOnElement(element)).y();
+        QHash<QString, QPointF>::const_iterator pos = alarmPositions.constFind(element);
+        if (pos != alarmPositions.constEnd()) {
             QString element2 = element + "-" + value;
-            if (m_renderer->elementExists(element2)) {
-                QGraphicsSvgItem *ind = new QGraphicsSvgItem();
-                ind->setSharedRenderer(m_renderer);
-                ind->setElementId(element2);
-                ind->setParentItem(background);
-                QTransform matrix;
-                matrix.translate(startX, startY);
-                ind->setTransform(matrix, false);
+            QString shown = shownIndicators.value(element);
+            if (shown == element2)
+                continue;
+
+            // Only the indicators of alarms that changed are touched
+            if (!shown.isEmpty()) {
+                alarmIndicators.value(shown)->setVisible(false);
+                shownIndicators.remove(element);
+            }
+
+            QGraphicsSvgItem *ind = alarmIndicator(element2, *pos);
+            if (ind) {
+                ind->setVisible(true);
+                shownIndicators.insert(element, element2);
             } else {
                 if ((value.compare("Uninitialised") != 0) && !warningClean.contains(element2)) {
                     qDebug() << "[SystemHealth] Warning: The SystemHealth SVG does not contain a "
@@ -132,6 +146,52 @@ void SystemHealthGadgetWidget::updateAlarms(UAVObject *systemAlarm)
             warningClean.append(element);
         }
     }
+
+    shownStates = states;
+}
+
+/**
+ * @brief Get the indicator item for an SVG element, creating it if need be
+ * @param elementId id of the element of the alarm state
+ * @param pos where the alarm's group sits in the SVG
+ * @return the item, or null if the SVG has no such element
+ */
+QGraphicsSvgItem *SystemHealthGadgetWidget::alarmIndicator(const QString &elementId,
+                                                           const QPointF &pos)
+{
+    QHash<QString, QGraphicsSvgItem *>::const_iterator it = alarmIndicators.constFind(elementId);
+    if (it != alarmIndicators.constEnd())
+        return *it;
+
+    QGraphicsSvgItem *ind = NULL;
+    if (m_renderer->elementExists(elementId)) {
+        ind = new QGraphicsSvgItem();
+        ind->setSharedRenderer(m_renderer);
+        ind->setElementId(elementId);
+        ind->setCacheMode(QGraphicsItem::DeviceCoordinateCache);
+        ind->setParentItem(background);
+        ind->setTransform(QTransform::fromTranslate(pos.x(), pos.y()), false);
+    }
+    alarmIndicators.insert(elementId, ind);
+
+    return ind;
+}
+
+/**
+ * @brief Delete the alarm indicators, they belong to the SVG in use
+ */
+void SystemHealthGadgetWidget::clearAlarmIndicators()
+{
+    foreach (QGraphicsSvgItem *ind, alarmIndicators) {
+        if (ind) {
+            scene()->removeItem(ind);
+            delete ind; // removeItem does _not_ delete the item.
+        }
+    }
+    alarmIndicators.clear();
+    shownIndicators.clear();
+    shownStates.clear();
+    alarmPositions.clear();
 }
 
 SystemHealthGadgetWidget::~SystemHealthGadgetWidget()
@@ -142,6 +202,7 @@ SystemHealthGadgetWidget::~SystemHealthGadgetWidget()
 void SystemHealthGadgetWidget::setSystemFile(QString dfn)
 {
     if (QFile::exists(dfn)) {
+        clearAlarmIndicators();
         m_renderer->load(dfn);
         if (m_renderer->isValid()) {
             fgenabled = false;
@@ -164,13 +225,25 @@ void SystemHealthGadgetWidget::setSystemFile(QString dfn)
             l_scene->setSceneRect(background->boundingRect());
             fitInView(background, Qt::KeepAspectRatio);
 
-            // Check whether the autopilot is connected already, by the way:
             ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
             UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+            SystemAlarms *obj = SystemAlarms::GetInstance(objManager);
+
+            // Walking the SVG for an element is slow, do it once for each alarm
+            UAVObjectField *field = obj->getField("Alarm");
+            Q_ASSERT(field);
+            foreach (const QString &element, field->getElementNames()) {
+                if (m_renderer->elementExists(element)) {
+                    QMatrix blockMatrix = m_renderer->matrixForElement(element);
+                    QRectF bounds = blockMatrix.mapRect(m_renderer->boundsOnElement(element));
+                    alarmPositions.insert(element, bounds.topLeft());
+                }
+            }
+
+            // Check whether the autopilot is connected already, by the way:
             TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
             if (telMngr->isConnected()) {
                 onAutopilotConnect();
-                SystemAlarms *obj = SystemAlarms::GetInstance(objManager);
                 updateAlarms(obj);
             }
         }
@@ -260,7 +333,8 @@ void SystemHealthGadgetWidget::showAllAlarmDescriptions(const QPoint &location)
         // Loop through all items in the scene looking for svg items that represent alarms
         foreach (QGraphicsItem *curItem, graphicsScene->items()) {
             QGraphicsSvgItem *curSvgItem = dynamic_cast<QGraphicsSvgItem *>(curItem);
-            if (curSvgItem && (curSvgItem != foreground) && (curSvgItem != background)) {
+            if (curSvgItem && curSvgItem->isVisible() && (curSvgItem != foreground)
+                && (curSvgItem != background)) {
                 QString elementId = curSvgItem->elementId();
                 if (!elementId.contains("OK")) {
                     // Found an alarm, get its corresponding alarm html file contents
@@ -34,6 +34,8 @@
 #include <QtSvg/QSvgRenderer>
 #include <QtSvg/QGraphicsSvgItem>
 #include <QMouseEvent>
+#include <QByteArray>
+#include <QHash>
 #include <QMap>
 #include <QFile>
 #include <QTimer>
@@ -68,6 +70,19 @@ private:
     // Simple flag to skip rendering if the
     bool fgenabled; // layer does not exist.
 
+    // Where each alarm's group sits in the SVG, looked up once per file
+    QHash<QString, QPointF> alarmPositions;
+    // Indicators by element id, created the first time they're shown and
+    // hidden rather than deleted afterwards, null if the SVG has none
+    QHash<QString, QGraphicsSvgItem *> alarmIndicators;
+    // Element id of the indicator shown for each alarm
+    QHash<QString, QString> shownIndicators;
+    // Raw state of each alarm as last shown, empty if none are
+    QByteArray shownStates;
+
+    void clearAlarmIndicators();
+    QGraphicsSvgItem *alarmIndicator(const QString &elementId, const QPointF &pos);
+
     void showAlarmDescriptionForItemId(const QString itemId, const QPoint &location);
     void showAllAlarmDescriptions(const QPoint &location);
     QString getAlarmDescriptionFileName(const QString itemId);
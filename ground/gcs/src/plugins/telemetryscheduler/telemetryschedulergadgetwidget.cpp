@@ -51,10 +51,19 @@
 #include "uavobjects/uavdataobject.h"
 #include "uavobjects/uavmetaobject.h"
 #include "uavobjectutil/uavobjectutilmanager.h"
+#include "gcstelemetrystats.h"
 #include <coreplugin/coreconstants.h>
 #include <coreplugin/generalsettings.h>
 #include <QMenu>
 
+//! UAVTalk framing: sync, type, size(2), object ID(4) and checksum
+static const int UAVTALK_OVERHEAD = 9;
+//! Multiple instance objects also carry the instance ID
+static const int UAVTALK_INSTANCE_OVERHEAD = 2;
+//! Share of the link a schedule may use, the rest is left for acks,
+//! requests and retries
+static const double LINK_HEADROOM = 0.8;
+
 TelemetrySchedulerGadgetWidget::TelemetrySchedulerGadgetWidget(QWidget *parent)
     : QWidget(parent)
 {
@@ -195,6 +204,27 @@ TelemetrySchedulerGadgetWidget::TelemetrySchedulerGadgetWidget(QWidget *parent)
     // Populate combobox
     m_telemetryeditor->cmbScheduleList->addItem("");
     m_telemetryeditor->cmbScheduleList->addItems(columnHeaders);
+
+    // Link capacities in bytes/s, serial links with 8N1 framing
+    m_telemetryeditor->cmbLinkProfile->addItem(tr("Unlimited"), 0);
+    m_telemetryeditor->cmbLinkProfile->addItem(tr("9600 baud"), 960);
+    m_telemetryeditor->cmbLinkProfile->addItem(tr("19200 baud"), 1920);
+    m_telemetryeditor->cmbLinkProfile->addItem(tr("38400 baud"), 3840);
+    m_telemetryeditor->cmbLinkProfile->addItem(tr("57600 baud"), 5760);
+    m_telemetryeditor->cmbLinkProfile->addItem(tr("115200 baud"), 11520);
+    m_telemetryeditor->cmbLinkProfile->setCurrentIndex(4);
+    connect(m_telemetryeditor->cmbLinkProfile,
+            QOverload<int>::of(&QComboBox::currentIndexChanged), this,
+            &TelemetrySchedulerGadgetWidget::linkProfileChanged);
+    connect(m_telemetryeditor->bnFitToLink, &QAbstractButton::clicked, this,
+            &TelemetrySchedulerGadgetWidget::fitScheduleToLink);
+
+    // Live feedback of what the link actually carries
+    GCSTelemetryStats *gcsStats = GCSTelemetryStats::GetInstance(objManager);
+    Q_ASSERT(gcsStats);
+    connect(gcsStats, &UAVObject::objectUpdated, this,
+            &TelemetrySchedulerGadgetWidget::updateMeasuredRate);
+
     onHideNotPresent(true);
 }
 
@@ -256,45 +286,196 @@ void TelemetrySchedulerGadgetWidget::dataModel_itemChanged(QStandardItem *item)
 }
 
 /**
- * @brief Recalculates the bandwith required for a given column (value presented on the horizontal
- * header)
+ * @brief Whether a row counts towards the bandwidth of a schedule
  */
-void TelemetrySchedulerGadgetWidget::dataModel_itemChanged(int col)
+bool TelemetrySchedulerGadgetWidget::isRowScheduled(int row)
+{
+    QString uavObjectName = schedulerModel->verticalHeaderItem(row)->text();
+    UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(objManager->getObject(uavObjectName));
+    Q_ASSERT(dobj);
+
+    return !(dobj && m_telemetryeditor->hideNotPresent->isChecked()
+             && (!dobj->getIsPresentOnHardware()));
+}
+
+/**
+ * @brief Update period of an object in a column, falling back to the default for blank cells
+ * @return period in ms, 0 if the object is not sent periodically
+ */
+int TelemetrySchedulerGadgetWidget::rowUpdatePeriod(int row, int col)
+{
+    QModelIndex index = schedulerModel->index(row, col, QModelIndex());
+    if (schedulerModel->data(index).isValid() && stripMs(schedulerModel->data(index)) >= 0)
+        return stripMs(schedulerModel->data(index));
+
+    QString uavObjectName = schedulerModel->verticalHeaderItem(row)->text();
+    return defaultMdata.value(uavObjectName.append("Meta")).flightTelemetryUpdatePeriod;
+}
+
+/**
+ * @brief Bytes on the link for one update of an object, including the UAVTalk framing
+ */
+double TelemetrySchedulerGadgetWidget::objectBytes(UAVObject *obj)
+{
+    int overhead = UAVTALK_OVERHEAD;
+    if (!obj->isSingleInstance())
+        overhead += UAVTALK_INSTANCE_OVERHEAD;
+
+    return obj->getNumBytes() + overhead;
+}
+
+/**
+ * @brief Bandwidth a column needs on the link
+ * @return bytes/s
+ */
+double TelemetrySchedulerGadgetWidget::columnBandwidth(int col)
 {
-    // Update the speed estimate
     double bandwidthRequired_bps = 0;
     for (int i = 1; i < schedulerModel->rowCount(); i++) {
-        // Get UAVO size
-        QString uavObjectName = schedulerModel->verticalHeaderItem(i)->text();
-        UAVObject *obj = objManager->getObject(uavObjectName);
-        UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
-        if (dobj && m_telemetryeditor->hideNotPresent->isChecked()
-            && (!dobj->getIsPresentOnHardware()))
+        if (!isRowScheduled(i))
             continue;
+
+        UAVObject *obj = objManager->getObject(schedulerModel->verticalHeaderItem(i)->text());
         Q_ASSERT(obj);
-        quint16 size = obj->getNumBytes();
 
-        // Get UAVO speed
-        QModelIndex index = schedulerModel->index(i, col, QModelIndex());
-        double updatePeriod_s;
-        if (schedulerModel->data(index).isValid() && stripMs(schedulerModel->data(index)) >= 0)
-            updatePeriod_s = stripMs(schedulerModel->data(index)) / 1000.0;
-        else
-            updatePeriod_s =
-                defaultMdata.value(obj->getName().append("Meta")).flightTelemetryUpdatePeriod
-                / 1000.0;
+        int updatePeriod_ms = rowUpdatePeriod(i, col);
+        if (updatePeriod_ms > 0)
+            bandwidthRequired_bps += objectBytes(obj) * 1000.0 / updatePeriod_ms;
+    }
 
-        double updateFrequency_Hz = updatePeriod_s > 0 ? 1.0 / updatePeriod_s : 0;
+    return bandwidthRequired_bps;
+}
 
-        // Accumulate bandwidth
-        bandwidthRequired_bps += updateFrequency_Hz * size;
-    }
+/**
+ * @brief Capacity of the selected link profile
+ * @return bytes/s, 0 if unlimited
+ */
+double TelemetrySchedulerGadgetWidget::linkCapacity()
+{
+    return m_telemetryeditor->cmbLinkProfile->currentData().toDouble();
+}
+
+/**
+ * @brief Recalculates the bandwith required for a given column (value presented on the horizontal
+ * header)
+ */
+void TelemetrySchedulerGadgetWidget::dataModel_itemChanged(int col)
+{
+    double bandwidthRequired_bps = columnBandwidth(col);
+    double capacity = linkCapacity();
 
     QModelIndex index = telemetryScheduleView->getFrozenModel()->index(0, col, QModelIndex());
     telemetryScheduleView->getFrozenModel()->setData(
         index, QString("%1B/s").arg(lround(bandwidthRequired_bps)));
 
-    // TODO: Set color as function of available speed
+    QVariant color;
+    if (capacity > 0) {
+        if (bandwidthRequired_bps > capacity)
+            color = QColor(Qt::red);
+        else if (bandwidthRequired_bps > capacity * LINK_HEADROOM)
+            color = QColor(Qt::yellow);
+        else
+            color = QColor(Qt::green);
+    }
+    telemetryScheduleView->getFrozenModel()->setData(index, color, Qt::BackgroundRole);
+}
+
+/**
+ * @brief Recolours the bandwidth row for a new link
+ */
+void TelemetrySchedulerGadgetWidget::linkProfileChanged()
+{
+    for (int x = 0; x < schedulerModel->columnCount(); ++x) {
+        dataModel_itemChanged(x);
+    }
+}
+
+/**
+ * @brief Slows down the selected column until it fits the link.
+ *
+ * The fastest objects are the ones eating the link, so rather than
+ * stretching everything evenly this finds the shortest period that, used
+ * as a floor for all objects, fits the budget. Status objects that were
+ * already slow keep their rates; only the fast streams give way.
+ */
+void TelemetrySchedulerGadgetWidget::fitScheduleToLink()
+{
+    int col = columnHeaders.indexOf(m_telemetryeditor->cmbScheduleList->currentText());
+    if (col < 2) {
+        QMessageBox::warning(this, tr("No Schedule selected"),
+                             tr("Please select one of the editable schedules on the dropbox and "
+                                "retry"),
+                             QMessageBox::Ok);
+        return;
+    }
+
+    double capacity = linkCapacity();
+    if (capacity <= 0)
+        return;
+
+    double budget = capacity * LINK_HEADROOM;
+
+    QList<int> rows;
+    QList<int> periods;
+    QList<double> bytes;
+    for (int i = 1; i < schedulerModel->rowCount(); i++) {
+        int period = rowUpdatePeriod(i, col);
+        if (!isRowScheduled(i) || period <= 0)
+            continue;
+
+        rows << i;
+        periods << period;
+        bytes << objectBytes(objManager->getObject(schedulerModel->verticalHeaderItem(i)->text()));
+    }
+
+    // The load only drops as the floor rises, so bisect for the lowest
+    // floor that fits. Metadata periods are 16 bit.
+    int lo = 0, hi = 65535;
+    while (lo < hi) {
+        int floor_ms = (lo + hi) / 2;
+        double load = 0;
+        for (int i = 0; i < rows.size(); i++)
+            load += bytes[i] * 1000.0 / qMax(periods[i], floor_ms);
+
+        if (load <= budget)
+            hi = floor_ms;
+        else
+            lo = floor_ms + 1;
+    }
+
+    for (int i = 0; i < rows.size(); i++) {
+        if (periods[i] < lo) {
+            QModelIndex index = schedulerModel->index(rows[i], col, QModelIndex());
+            schedulerModel->setData(index, QString("%1ms").arg(lo));
+        }
+    }
+
+    dataModel_itemChanged(col);
+}
+
+/**
+ * @brief Shows the data rate the telemetry link is measured to carry
+ */
+void TelemetrySchedulerGadgetWidget::updateMeasuredRate(UAVObject *obj)
+{
+    GCSTelemetryStats *gcsStats = qobject_cast<GCSTelemetryStats *>(obj);
+    Q_ASSERT(gcsStats);
+    GCSTelemetryStats::DataFields stats = gcsStats->getData();
+
+    if (stats.Status != GCSTelemetryStats::STATUS_CONNECTED) {
+        m_telemetryeditor->lblMeasuredRate->setText(tr("Measured: -"));
+        return;
+    }
+
+    QString text = tr("Measured: %1B/s down, %2B/s up")
+                       .arg(lround(stats.RxDataRate))
+                       .arg(lround(stats.TxDataRate));
+
+    double capacity = linkCapacity();
+    if (capacity > 0)
+        text += tr(" (%1% of link)").arg(lround(100 * stats.RxDataRate / capacity));
+
+    m_telemetryeditor->lblMeasuredRate->setText(text);
 }
 
 void TelemetrySchedulerGadgetWidget::saveTelemetryToFile()
@@ -411,6 +592,20 @@ QList<UAVMetaObject *> TelemetrySchedulerGadgetWidget::applySchedule()
         Q_ASSERT(0);
         return metaList;
     }
+    double bandwidthRequired_bps = columnBandwidth(col);
+    double capacity = linkCapacity();
+    if (capacity > 0 && bandwidthRequired_bps > capacity) {
+        int ret = QMessageBox::warning(
+            this, tr("Schedule does not fit the link"),
+            tr("This schedule needs %1B/s but the link carries only %2B/s. Telemetry updates "
+               "will be delayed or dropped.\n\nApply it anyway?")
+                .arg(lround(bandwidthRequired_bps))
+                .arg(lround(capacity)),
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (ret != QMessageBox::Yes)
+            return metaList;
+    }
+
     QMap<QString, UAVObject::Metadata> metaDataList;
     for (int i = 1; i < schedulerModel->rowCount(); i++) {
         // Get UAVO name and metadata
@@ -426,8 +621,13 @@ QList<UAVMetaObject *> TelemetrySchedulerGadgetWidget::applySchedule()
         QModelIndex index = schedulerModel->index(i, col, QModelIndex());
         if (schedulerModel->data(index).isValid() && stripMs(schedulerModel->data(index)) >= 0) {
             updatePeriod_ms = stripMs(schedulerModel->data(index));
-            mdata.flightTelemetryUpdatePeriod = updatePeriod_ms;
-            metaDataList.insert(uavObjectName, mdata);
+
+            // Only write what changes, but still save all of them so what's
+            // on the board matches the schedule
+            if (mdata.flightTelemetryUpdatePeriod != updatePeriod_ms) {
+                mdata.flightTelemetryUpdatePeriod = updatePeriod_ms;
+                metaDataList.insert(uavObjectName, mdata);
+            }
             metaList.append(dobj->getMetaObject());
         }
     }
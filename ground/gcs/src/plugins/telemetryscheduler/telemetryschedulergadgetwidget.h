@@ -75,9 +75,17 @@ private slots:
     void customMenuRequested(QPoint pos);
     void uavoPresentOnHardwareChanged(UAVDataObject *);
     void onHideNotPresent(bool);
+    void linkProfileChanged();
+    void fitScheduleToLink();
+    void updateMeasuredRate(UAVObject *);
 
 private:
     int stripMs(QVariant rate_ms);
+    bool isRowScheduled(int row);
+    int rowUpdatePeriod(int row, int col);
+    static double objectBytes(UAVObject *obj);
+    double columnBandwidth(int col);
+    double linkCapacity();
     QList<UAVMetaObject *> metaObjectsToSave;
     void importTelemetryConfiguration(const QString &fileName);
     UAVObjectUtilManager *getObjectUtilManager();
@@ -0,0 +1,230 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrytap.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryTapPlugin Telemetry Tap Plugin
+ * @{
+ * @brief Publishes the UAVObjects in shared memory for external tools
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "telemetrytap.h"
+#include "uavoshm.h"
+
+#include <atomic>
+#include <cstring>
+#include <QAtomicInteger>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+
+template <typename T>
+static void storeRelease(void *p, T value)
+{
+    reinterpret_cast<QAtomicInteger<T> *>(p)->storeRelease(value);
+}
+
+TelemetryTap::TelemetryTap(UAVObjectManager *objMngr, const QString &path, quint32 ringSlots,
+                           QObject *parent)
+    : QObject(parent)
+    , objMngr(objMngr)
+    , file(path)
+    , base(Q_NULLPTR)
+    , ringSlots(qMax(ringSlots, 1u))
+{
+    qint64 size = UAVOSHM_SIZE((qint64)this->ringSlots);
+
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Truncate) || !file.resize(size)) {
+        qWarning() << "[TelemetryTap] Can't create" << path << file.errorString();
+        return;
+    }
+
+    base = file.map(0, size);
+    if (!base) {
+        qWarning() << "[TelemetryTap] Can't map" << path << file.errorString();
+        return;
+    }
+
+    std::memset(base, 0, size);
+    clock.start();
+
+    for (int i = 0; i < UAVOSHM_NUM_OBJECTS; i++)
+        objectIndex.insert(uavoshm_objects[i].id, i);
+
+    writeTable();
+
+    for (int i = 0; i < UAVOSHM_NUM_OBJECTS; i++) {
+        const QVector<UAVObject *> *instances = objMngr->getObjectInstances(uavoshm_objects[i].id);
+        if (!instances)
+            continue;
+        foreach (UAVObject *obj, *instances)
+            watch(obj);
+    }
+    connect(objMngr, &UAVObjectManager::newInstance, this, &TelemetryTap::watch);
+
+    // Readers check the magic last
+    storeRelease<quint32>(base, UAVOSHM_MAGIC);
+
+    qDebug() << "[TelemetryTap] Publishing" << UAVOSHM_NUM_OBJECTS << "objects in" << path;
+}
+
+TelemetryTap::~TelemetryTap()
+{
+    if (!base)
+        return;
+
+    // Tell readers that still have it mapped the tap is gone
+    storeRelease<quint32>(base, 0);
+
+    file.unmap(base);
+    file.remove();
+}
+
+/**
+ * @brief Where the tap goes unless set otherwise: in memory on Linux
+ */
+QString TelemetryTap::defaultPath()
+{
+    if (QDir("/dev/shm").exists())
+        return QStringLiteral("/dev/shm/dronin-telemetry");
+
+    return QDir::temp().absoluteFilePath(QStringLiteral("dronin-telemetry"));
+}
+
+void TelemetryTap::writeTable()
+{
+    uavoshm_header *header = reinterpret_cast<uavoshm_header *>(base);
+
+    header->version = UAVOSHM_VERSION;
+    header->header_size = sizeof(uavoshm_header);
+    header->uavo_hash = UAVOSHM_UAVO_HASH;
+    header->num_objects = UAVOSHM_NUM_OBJECTS;
+    header->table_offset = UAVOSHM_TABLE_OFFSET;
+    header->ring_offset = UAVOSHM_RING_OFFSET;
+    header->ring_slots = ringSlots;
+    header->ring_slot_size = UAVOSHM_RING_SLOT_SIZE;
+    header->writer_pid = QCoreApplication::applicationPid();
+    header->start_time = QDateTime::currentMSecsSinceEpoch() - clock.elapsed();
+
+    uavoshm_object *table = reinterpret_cast<uavoshm_object *>(base + UAVOSHM_TABLE_OFFSET);
+    for (int i = 0; i < UAVOSHM_NUM_OBJECTS; i++) {
+        const uavoshm_object_info &info = uavoshm_objects[i];
+        table[i].id = info.id;
+        table[i].num_bytes = info.num_bytes;
+        table[i].max_instances = info.max_instances;
+        table[i].data_offset = info.data_offset;
+        table[i].value_stride = info.value_stride;
+        table[i].num_instances = 0;
+    }
+}
+
+/**
+ * @brief Publish an object instance, from its current data on
+ */
+void TelemetryTap::watch(UAVObject *obj)
+{
+    QHash<quint32, int>::const_iterator it = objectIndex.constFind(obj->getObjID());
+    if (it == objectIndex.constEnd())
+        return;
+
+    const uavoshm_object_info &info = uavoshm_objects[it.value()];
+    if (obj->getNumBytes() != info.num_bytes)
+        return;
+
+    scratch.resize(info.num_bytes);
+    obj->pack(reinterpret_cast<quint8 *>(scratch.data()));
+    storeValue(info, obj, clock.elapsed(), reinterpret_cast<const quint8 *>(scratch.constData()));
+
+    connect(obj, &UAVObject::objectUpdated, this, &TelemetryTap::objectUpdated,
+            Qt::UniqueConnection);
+}
+
+void TelemetryTap::setConnected(bool connected)
+{
+    if (base)
+        storeRelease<quint32>(&reinterpret_cast<uavoshm_header *>(base)->connected, connected);
+}
+
+/**
+ * @brief Add an update to the ring, and make it the latest value
+ */
+void TelemetryTap::objectUpdated(UAVObject *obj)
+{
+    QHash<quint32, int>::const_iterator it = objectIndex.constFind(obj->getObjID());
+    if (it == objectIndex.constEnd())
+        return;
+
+    const uavoshm_object_info &info = uavoshm_objects[it.value()];
+    if (obj->getNumBytes() != info.num_bytes)
+        return;
+
+    uavoshm_header *header = reinterpret_cast<uavoshm_header *>(base);
+    quint32 timestamp = clock.elapsed();
+
+    // Only this thread writes, so the head can be read plainly
+    quint64 head = header->ring_head;
+    uchar *slot = base + UAVOSHM_RING_OFFSET + (head % ringSlots) * UAVOSHM_RING_SLOT_SIZE;
+    uavoshm_record *record = reinterpret_cast<uavoshm_record *>(slot);
+    quint8 *data = slot + sizeof(uavoshm_record);
+
+    storeRelease<quint64>(&record->seq, 0);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record->id = info.id;
+    record->timestamp = timestamp;
+    record->inst_id = obj->getInstID();
+    record->num_bytes = info.num_bytes;
+    obj->pack(data);
+
+    storeRelease<quint64>(&record->seq, head + 1);
+    storeRelease<quint64>(&header->ring_head, head + 1);
+
+    storeValue(info, obj, timestamp, data);
+}
+
+void TelemetryTap::storeValue(const uavoshm_object_info &info, UAVObject *obj, quint32 timestamp,
+                              const quint8 *data)
+{
+    quint32 instId = obj->getInstID();
+    if (instId >= info.max_instances)
+        return;
+
+    uchar *slot = base + info.data_offset + instId * info.value_stride;
+    uavoshm_value *value = reinterpret_cast<uavoshm_value *>(slot);
+
+    quint32 seq = value->seq;
+    storeRelease<quint32>(&value->seq, seq + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    value->timestamp = timestamp;
+    std::memcpy(slot + sizeof(uavoshm_value), data, info.num_bytes);
+
+    storeRelease<quint32>(&value->seq, seq + 2);
+
+    uavoshm_object *table = reinterpret_cast<uavoshm_object *>(base + UAVOSHM_TABLE_OFFSET);
+    uavoshm_object &entry = table[&info - uavoshm_objects];
+    if (entry.num_instances <= instId)
+        entry.num_instances = instId + 1;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,95 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrytap.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryTapPlugin Telemetry Tap Plugin
+ * @{
+ * @brief Publishes the UAVObjects in shared memory for external tools
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef TELEMETRYTAP_H
+#define TELEMETRYTAP_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include "uavobjects/uavobjectmanager.h"
+
+struct uavoshm_object_info;
+
+/**
+ * @brief Writes the latest value of every object, and a ring of all the
+ * updates, to a file mapped into memory, for tools running alongside the GCS
+ * to map and read without copies or sockets.
+ *
+ * The layout is in uavoshm.h, which uavobjgenerator makes from the object
+ * definitions. Readers never block the GCS: each value and ring record has
+ * a sequence number, by which a reader tells whether what it copied was
+ * overwritten meanwhile.
+ *
+ * All objects are created when the tap starts, so they all have a value.
+ */
+class TelemetryTap : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param objMngr objects to publish
+     * @param path file to map, created or overwritten
+     * @param ringSlots updates kept in the ring
+     */
+    TelemetryTap(UAVObjectManager *objMngr, const QString &path, quint32 ringSlots,
+                 QObject *parent = 0);
+    ~TelemetryTap();
+
+    bool isOpen() const { return base != Q_NULLPTR; }
+
+    static QString defaultPath();
+
+public slots:
+    void setConnected(bool connected);
+
+private slots:
+    void objectUpdated(UAVObject *obj);
+    void watch(UAVObject *obj);
+
+private:
+    void writeTable();
+    void storeValue(const uavoshm_object_info &info, UAVObject *obj, quint32 timestamp,
+                    const quint8 *data);
+
+    UAVObjectManager *objMngr;
+    QFile file;
+    uchar *base;
+    quint32 ringSlots;
+    QElapsedTimer clock;
+    // Object ID to index in uavoshm_objects
+    QHash<quint32, int> objectIndex;
+    QByteArray scratch;
+};
+
+#endif // TELEMETRYTAP_H
+
+/**
+ * @}
+ * @}
+ */
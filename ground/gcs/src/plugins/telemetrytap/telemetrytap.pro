@@ -0,0 +1,21 @@
+TEMPLATE = lib
+TARGET = TelemetryTap
+
+include(../../gcsplugin.pri)
+
+include(../../plugins/coreplugin/coreplugin.pri)
+include(../../plugins/uavobjects/uavobjects.pri)
+include(../../plugins/uavtalk/uavtalk.pri)
+
+# The layout uavobjgenerator makes from the object definitions
+INCLUDEPATH += $${GCS_BUILD_TREE}/../../uavobject-synthetics/shm
+DEPENDPATH += $${GCS_BUILD_TREE}/../../uavobject-synthetics/shm
+
+HEADERS += telemetrytapplugin.h \
+    telemetrytap.h
+
+SOURCES += telemetrytapplugin.cpp \
+    telemetrytap.cpp
+
+OTHER_FILES += TelemetryTap.pluginspec \
+    uavoshm.h.template
@@ -0,0 +1,90 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrytapplugin.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryTapPlugin Telemetry Tap Plugin
+ * @{
+ * @brief Publishes the UAVObjects in shared memory for external tools
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "telemetrytapplugin.h"
+#include "telemetrytap.h"
+
+#include <coreplugin/icore.h>
+#include <extensionsystem/pluginmanager.h>
+#include "uavtalk/telemetrymanager.h"
+#include <QSettings>
+#include <QtPlugin>
+
+TelemetryTapPlugin::TelemetryTapPlugin()
+    : tap(Q_NULLPTR)
+{
+}
+
+TelemetryTapPlugin::~TelemetryTapPlugin()
+{
+    delete tap;
+}
+
+bool TelemetryTapPlugin::initialize(const QStringList &arguments, QString *errorString)
+{
+    Q_UNUSED(arguments);
+    Q_UNUSED(errorString);
+    return true;
+}
+
+void TelemetryTapPlugin::extensionsInitialized()
+{
+    QSettings *qs = Core::ICore::instance()->settings();
+    qs->beginGroup("TelemetryTap");
+    bool enabled = qs->value("Enabled", false).toBool();
+    QString path = qs->value("Path", TelemetryTap::defaultPath()).toString();
+    quint32 ringSlots = qs->value("RingSlots", DEFAULT_RING_SLOTS).toUInt();
+    qs->endGroup();
+
+    if (!enabled)
+        return;
+
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objMngr = pm->getObject<UAVObjectManager>();
+
+    tap = new TelemetryTap(objMngr, path, ringSlots);
+    if (!tap->isOpen()) {
+        delete tap;
+        tap = Q_NULLPTR;
+        return;
+    }
+
+    TelemetryManager *telMngr = pm->getObject<TelemetryManager>();
+    tap->setConnected(telMngr->isConnected());
+    connect(telMngr, &TelemetryManager::connectedChanged, tap, &TelemetryTap::setConnected);
+}
+
+void TelemetryTapPlugin::shutdown()
+{
+    // Before the objects go
+    delete tap;
+    tap = Q_NULLPTR;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrytapplugin.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup TelemetryTapPlugin Telemetry Tap Plugin
+ * @{
+ * @brief Publishes the UAVObjects in shared memory for external tools
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef TELEMETRYTAPPLUGIN_H
+#define TELEMETRYTAPPLUGIN_H
+
+#include <extensionsystem/iplugin.h>
+
+class TelemetryTap;
+
+/**
+ * @brief Starts the @ref TelemetryTap when enabled in the settings, under
+ * TelemetryTap: Enabled, and optionally Path and RingSlots
+ */
+class TelemetryTapPlugin : public ExtensionSystem::IPlugin
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID "org.dronin.plugins.TelemetryTap")
+
+public:
+    TelemetryTapPlugin();
+    ~TelemetryTapPlugin();
+
+    bool initialize(const QStringList &arguments, QString *errorString);
+    void extensionsInitialized();
+    void shutdown();
+
+private:
+    // About a minute of updates of a busy link
+    static const quint32 DEFAULT_RING_SLOTS = 65536;
+
+    TelemetryTap *tap;
+};
+
+#endif // TELEMETRYTAPPLUGIN_H
+
+/**
+ * @}
+ * @}
+ */
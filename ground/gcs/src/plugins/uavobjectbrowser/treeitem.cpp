@@ -104,6 +104,7 @@ TreeItem::TreeItem(const QList<QVariant> &data, TreeItem *parent)
     , m_highlight(false)
     , m_changed(false)
     , m_updated(false)
+    , m_expanded(false)
 {
 }
 
@@ -114,6 +115,7 @@ TreeItem::TreeItem(const QVariant &data, TreeItem *parent)
     , m_highlight(false)
     , m_changed(false)
     , m_updated(false)
+    , m_expanded(false)
 {
     m_data << data << ""
            << "";
@@ -238,6 +240,38 @@ void TreeItem::setHighlightManager(HighLightManager *mgr)
     m_highlightManager = mgr;
 }
 
+/*
+ * True if the children of this item are on screen, i.e. it and all of its
+ * parents are expanded. The root item is never shown, so it doesn't count.
+ */
+bool TreeItem::childrenShown() const
+{
+    for (const TreeItem *item = this; item->m_parent; item = item->m_parent) {
+        if (!item->m_expanded)
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Whether the settings of an object whose field items weren't created yet
+ * are all at their defaults.
+ */
+bool ObjectTreeItem::objectIsDefaultValue() const
+{
+    UAVDataObject *dobj = qobject_cast<UAVDataObject *>(m_obj);
+    if (!dobj || !dobj->isSettings())
+        return true;
+
+    foreach (UAVObjectField *field, dobj->getFields()) {
+        for (quint32 i = 0; i < field->getNumElements(); i++) {
+            if (!field->isDefaultValue(i))
+                return false;
+        }
+    }
+    return true;
+}
+
 QList<MetaObjectTreeItem *> TopTreeItem::getMetaObjectItems()
 {
     return m_metaObjectTreeItemsPerObjectIds.values();
@@ -155,6 +155,10 @@ public:
 
     virtual void removeHighlight();
 
+    inline bool isExpanded() const { return m_expanded; }
+    inline void setExpanded(bool expanded) { m_expanded = expanded; }
+    bool childrenShown() const;
+
     int nameIndex(QString name)
     {
         for (int i = 0; i < childCount(); ++i) {
@@ -195,6 +199,7 @@ private:
     bool m_highlight;
     bool m_changed;
     bool m_updated;
+    bool m_expanded;
     HighLightManager *m_highlightManager;
     static int m_highlightTimeMs;
 
@@ -256,11 +261,13 @@ public:
     ObjectTreeItem(const QList<QVariant> &data, TreeItem *parent = 0)
         : TreeItem(data, parent)
         , m_obj(0)
+        , m_fieldsPopulated(false)
     {
     }
     ObjectTreeItem(const QVariant &data, TreeItem *parent = 0)
         : TreeItem(data, parent)
         , m_obj(0)
+        , m_fieldsPopulated(false)
     {
     }
     virtual void setObject(UAVObject *obj)
@@ -270,8 +277,16 @@ public:
     }
     inline UAVObject *object() { return m_obj; }
 
+    // The field items are only created once the object is first expanded
+    inline bool fieldsPopulated() const { return m_fieldsPopulated; }
+    inline void setFieldsPopulated(bool populated) { m_fieldsPopulated = populated; }
+
+protected:
+    bool objectIsDefaultValue() const;
+
 private:
     UAVObject *m_obj;
+    bool m_fieldsPopulated;
 };
 
 class MetaObjectTreeItem : public ObjectTreeItem
@@ -349,7 +364,13 @@ public:
         isPresentOnHardware = value;
     }
 
-    virtual bool isDefaultValue() const override { return childrenAreDefaultValue(); }
+    virtual bool isDefaultValue() const override
+    {
+        bool ret = childrenAreDefaultValue();
+        if (!fieldsPopulated())
+            ret &= objectIsDefaultValue();
+        return ret;
+    }
 
 
 protected slots:
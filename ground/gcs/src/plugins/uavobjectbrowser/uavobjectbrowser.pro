@@ -17,6 +17,7 @@ HEADERS += browserplugin.h \
     uavobjectbrowserfactory.h \
     uavobjectbrowseroptionspage.h \
     uavobjecttreemodel.h \
+    uavobjectsearchindex.h \
     treeitem.h \
     browseritemdelegate.h \
     fieldtreeitem.h
@@ -28,6 +29,7 @@ SOURCES += browserplugin.cpp \
     uavobjectbrowserwidget.cpp \
     uavobjectbrowseroptionspage.cpp \
     uavobjecttreemodel.cpp \
+    uavobjectsearchindex.cpp \
     treeitem.cpp \
     browseritemdelegate.cpp \
     fieldtreeitem.cpp
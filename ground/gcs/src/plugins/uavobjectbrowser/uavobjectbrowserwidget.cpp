@@ -96,6 +96,7 @@ UAVObjectBrowserWidget::UAVObjectBrowserWidget(QWidget *parent)
 void UAVObjectBrowserWidget::onTreeItemExpanded(QModelIndex currentProxyIndex)
 {
     QModelIndex currentIndex = proxyModel->mapToSource(currentProxyIndex);
+    m_model->setExpanded(currentIndex, true);
     TreeItem *item = static_cast<TreeItem *>(currentIndex.internalPointer());
     TopTreeItem *top = dynamic_cast<TopTreeItem *>(item->parent());
 
@@ -154,6 +155,7 @@ void UAVObjectBrowserWidget::onTreeItemExpanded(QModelIndex currentProxyIndex)
 void UAVObjectBrowserWidget::onTreeItemCollapsed(QModelIndex currentProxyIndex)
 {
     QModelIndex currentIndex = proxyModel->mapToSource(currentProxyIndex);
+    m_model->setExpanded(currentIndex, false);
     TreeItem *item = static_cast<TreeItem *>(currentIndex.internalPointer());
     TopTreeItem *top = dynamic_cast<TopTreeItem *>(item->parent());
 
@@ -621,7 +623,7 @@ void UAVObjectBrowserWidget::enableUAVOBrowserButtons(bool enableState)
  */
 void UAVObjectBrowserWidget::searchTextChanged(QString searchText)
 {
-    proxyModel->setFilterRegExp(QRegExp(searchText, Qt::CaseInsensitive, QRegExp::FixedString));
+    proxyModel->setSearchText(searchText);
 }
 
 void UAVObjectBrowserWidget::searchTextCleared()
@@ -751,66 +753,109 @@ TreeSortFilterProxyModel::TreeSortFilterProxyModel(QObject *p)
 }
 
 /**
- * @brief TreeSortFilterProxyModel::filterAcceptsRow  Taken from
- * http://qt-project.org/forums/viewthread/7782. This proxy model
- * will accept rows:
- *   - That match themselves, or
- *   - That have a parent that matches (on its own), or
- *   - That have a child that matches.
- * @param sourceRow
- * @param sourceParent
- * @return
+ * @brief TreeSortFilterProxyModel::setSearchText Look the text up in the index
+ * and filter the tree with the result; empty shows everything
  */
+void TreeSortFilterProxyModel::setSearchText(const QString &text)
+{
+    searchText = text;
+
+    const UAVObjectTreeModel *model = qobject_cast<const UAVObjectTreeModel *>(sourceModel());
+    matches = model ? model->searchIndex().search(text) : QHash<quint32, UAVObjectSearchIndex::Match>();
+
+    invalidateFilter();
+}
+
 bool TreeSortFilterProxyModel::filterAcceptsRow(int source_row,
                                                 const QModelIndex &source_parent) const
 {
-    if (filterAcceptsRowItself(source_row, source_parent))
+    if (searchText.isEmpty())
         return true;
 
-    // accept if any of the parents is accepted on it's own merits
-    QModelIndex parent = source_parent;
-    while (parent.isValid()) {
-        if (filterAcceptsRowItself(parent.row(), parent.parent()))
-            return true;
-        parent = parent.parent();
-    }
+    QModelIndex index = sourceModel()->index(source_row, 0, source_parent);
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
+    if (!item)
+        return false;
 
-    // accept if any of the children is accepted on it's own merits
-    if (hasAcceptedChildren(source_row, source_parent)) {
-        return true;
+    // Everything in a matching category is shown
+    for (TreeItem *parent = item->parent(); parent; parent = parent->parent()) {
+        if (categoryMatches(parent))
+            return true;
     }
 
-    return false;
+    return itemMatches(item);
 }
 
-bool TreeSortFilterProxyModel::filterAcceptsRowItself(int source_row,
-                                                      const QModelIndex &source_parent) const
+bool TreeSortFilterProxyModel::categoryMatches(TreeItem *item) const
 {
-    return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
+    return dynamic_cast<CategoryTreeItem *>(item)
+        && item->data(0).toString().contains(searchText, Qt::CaseInsensitive);
+}
+
+/**
+ * @brief TreeSortFilterProxyModel::objectMatches Look an object item up in the matches
+ * @param itself only when the object matched by name or description, not by a field
+ */
+bool TreeSortFilterProxyModel::objectMatches(ObjectTreeItem *item, bool itself) const
+{
+    // Multiple instance objects have theirs on the instance items
+    UAVObject *obj = item->object();
+    for (int i = 0; !obj && i < item->childCount(); i++) {
+        InstanceTreeItem *inst = dynamic_cast<InstanceTreeItem *>(item->getChild(i));
+        if (inst)
+            obj = inst->object();
+    }
+    if (!obj)
+        return false;
+
+    QHash<quint32, UAVObjectSearchIndex::Match>::const_iterator it =
+        matches.constFind(obj->getObjID());
+    return it != matches.constEnd() && (!itself || it->object);
 }
 
-bool TreeSortFilterProxyModel::hasAcceptedChildren(int source_row,
-                                                   const QModelIndex &source_parent) const
+bool TreeSortFilterProxyModel::itemMatches(TreeItem *item) const
 {
-    QModelIndex item = sourceModel()->index(source_row, 0, source_parent);
-    if (!item.isValid()) {
-        // qDebug() << "item invalid" << source_parent << source_row;
+    // Meta data is shown with an object that matches itself, fields don't count
+    if (MetaObjectTreeItem *meta = dynamic_cast<MetaObjectTreeItem *>(item)) {
+        ObjectTreeItem *parent = dynamic_cast<ObjectTreeItem *>(meta->parent());
+        return parent && objectMatches(parent, true);
+    }
+
+    if (ObjectTreeItem *obj = dynamic_cast<ObjectTreeItem *>(item))
+        return objectMatches(obj, false);
+
+    // Categories are shown when they hold a match; only objects are looked
+    // at below them, the field items may not even exist
+    if (dynamic_cast<CategoryTreeItem *>(item) || dynamic_cast<TopTreeItem *>(item)) {
+        if (categoryMatches(item))
+            return true;
+        foreach (TreeItem *child, item->treeChildren()) {
+            if (itemMatches(child))
+                return true;
+        }
         return false;
     }
 
-    // check if there are children
-    int childCount = item.model()->rowCount(item);
-    if (childCount == 0)
+    // A field, or an element of an array field
+    TreeItem *fieldItem = dynamic_cast<ArrayFieldTreeItem *>(item->parent()) ? item->parent() : item;
+    ObjectTreeItem *owner = dynamic_cast<ObjectTreeItem *>(fieldItem->parent());
+    if (!owner)
         return false;
 
-    for (int i = 0; i < childCount; ++i) {
-        if (filterAcceptsRowItself(i, item))
-            return true;
-        // recursive call -> NOTICE that this is depth-first searching, you're probably better off
-        // with breadth first search...
-        if (hasAcceptedChildren(i, item))
-            return true;
+    if (MetaObjectTreeItem *meta = dynamic_cast<MetaObjectTreeItem *>(owner)) {
+        ObjectTreeItem *parent = dynamic_cast<ObjectTreeItem *>(meta->parent());
+        return parent && objectMatches(parent, true);
     }
 
-    return false;
+    if (objectMatches(owner, true))
+        return true;
+
+    // Instance items hold no fields of their own in the index, ask the object
+    UAVObject *obj = owner->object();
+    if (!obj)
+        return false;
+
+    QHash<quint32, UAVObjectSearchIndex::Match>::const_iterator it =
+        matches.constFind(obj->getObjID());
+    return it != matches.constEnd() && it->fields.contains(fieldItem->data(0).toString());
 }
@@ -38,18 +38,34 @@
 
 class QPushButton;
 class ObjectTreeItem;
+class TreeItem;
 class Ui_UAVObjectBrowser;
 class Ui_viewoptions;
 
+/**
+ * @brief Shows the items matching a search, looked up in the search index of
+ * the UAVObjectTreeModel rather than by walking the tree.
+ *
+ * Rows are accepted when they match themselves, are inside a matching
+ * category or object, or hold a matching object or field.
+ */
 class TreeSortFilterProxyModel : public QSortFilterProxyModel
 {
 public:
     TreeSortFilterProxyModel(QObject *parent);
 
+    void setSearchText(const QString &text);
+
 protected:
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
-    bool filterAcceptsRowItself(int source_row, const QModelIndex &source_parent) const;
-    bool hasAcceptedChildren(int source_row, const QModelIndex &source_parent) const;
+
+private:
+    bool itemMatches(TreeItem *item) const;
+    bool categoryMatches(TreeItem *item) const;
+    bool objectMatches(ObjectTreeItem *item, bool itself) const;
+
+    QString searchText;
+    QHash<quint32, UAVObjectSearchIndex::Match> matches;
 };
 
 class UAVOBrowserTreeView : public QTreeView
@@ -0,0 +1,147 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsearchindex.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief Index of the names and descriptions searched by the browser
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "uavobjectsearchindex.h"
+#include "uavobjects/uavobject.h"
+#include "uavobjects/uavobjectfield.h"
+
+#include <algorithm>
+
+void UAVObjectSearchIndex::clear()
+{
+    entries.clear();
+    trigrams.clear();
+    indexed.clear();
+}
+
+void UAVObjectSearchIndex::addObject(UAVObject *obj)
+{
+    // Instances share their names and fields
+    quint32 objId = obj->getObjID();
+    if (indexed.contains(objId))
+        return;
+    indexed.insert(objId);
+
+    addEntry(obj->getName(), objId, QString());
+    addEntry(obj->getDescription(), objId, QString());
+
+    foreach (UAVObjectField *field, obj->getFields()) {
+        const QString name = field->getName();
+        addEntry(name, objId, name);
+        addEntry(field->getDescription(), objId, name);
+        if (field->getNumElements() > 1) {
+            foreach (const QString &element, field->getElementNames())
+                addEntry(element, objId, name);
+        }
+    }
+}
+
+void UAVObjectSearchIndex::addEntry(const QString &text, quint32 objId, const QString &field)
+{
+    if (text.isEmpty())
+        return;
+
+    Entry entry;
+    entry.text = text.toLower();
+    entry.objId = objId;
+    entry.field = field;
+
+    int id = entries.size();
+    entries.append(entry);
+
+    for (int i = 0; i + 3 <= entry.text.size(); i++) {
+        QVector<int> &list = trigrams[trigram(entry.text, i)];
+        if (list.isEmpty() || list.last() != id)
+            list.append(id);
+    }
+}
+
+quint64 UAVObjectSearchIndex::trigram(const QString &text, int i)
+{
+    return ((quint64)text.at(i).unicode() << 32) | ((quint64)text.at(i + 1).unicode() << 16)
+        | text.at(i + 2).unicode();
+}
+
+QHash<quint32, UAVObjectSearchIndex::Match> UAVObjectSearchIndex::search(const QString &text) const
+{
+    QHash<quint32, Match> matches;
+    const QString needle = text.toLower();
+    if (needle.isEmpty())
+        return matches;
+
+    QVector<int> candidates;
+
+    if (needle.size() < 3) {
+        // Too short for a trigram, but there are only a few thousand entries
+        candidates.reserve(entries.size());
+        for (int i = 0; i < entries.size(); i++)
+            candidates.append(i);
+    } else {
+        QVector<const QVector<int> *> lists;
+        for (int i = 0; i + 3 <= needle.size(); i++) {
+            QHash<quint64, QVector<int>>::const_iterator it = trigrams.constFind(trigram(needle, i));
+            if (it == trigrams.constEnd())
+                return matches;
+            lists.append(&it.value());
+        }
+
+        // Intersect starting from the rarest trigram
+        std::sort(lists.begin(), lists.end(),
+                  [](const QVector<int> *a, const QVector<int> *b) { return a->size() < b->size(); });
+        candidates = *lists.first();
+        for (int i = 1; i < lists.size() && !candidates.isEmpty(); i++) {
+            QVector<int> common;
+            std::set_intersection(candidates.constBegin(), candidates.constEnd(),
+                                  lists.at(i)->constBegin(), lists.at(i)->constEnd(),
+                                  std::back_inserter(common));
+            candidates.swap(common);
+        }
+    }
+
+    // Having the trigrams doesn't mean having them in a row
+    foreach (int id, candidates) {
+        const Entry &entry = entries.at(id);
+        if (!entry.text.contains(needle))
+            continue;
+
+        Match &match = matches[entry.objId];
+        if (entry.field.isEmpty())
+            match.object = true;
+        else
+            match.fields.insert(entry.field);
+    }
+
+    return matches;
+}
+
+/**
+ * @}
+ * @}
+ */
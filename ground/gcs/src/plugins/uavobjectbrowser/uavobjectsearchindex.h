@@ -0,0 +1,91 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsearchindex.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectBrowserPlugin UAVObject Browser Plugin
+ * @{
+ * @brief Index of the names and descriptions searched by the browser
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef UAVOBJECTSEARCHINDEX_H
+#define UAVOBJECTSEARCHINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+class UAVObject;
+
+/**
+ * @brief Names and descriptions of the objects, their fields and elements,
+ * indexed by the trigrams they contain.
+ *
+ * Objects are added as they register, once per object type. A search looks
+ * up the trigrams of the text, checks only the entries that have them all,
+ * and tells per object whether the object itself or which of its fields
+ * matched. Fields don't need to exist in the tree to be found.
+ */
+class UAVObjectSearchIndex
+{
+public:
+    struct Match
+    {
+        Match()
+            : object(false)
+        {
+        }
+
+        bool object; // The name or description of the object itself
+        QSet<QString> fields; // Fields matching by name, description or element
+    };
+
+    void clear();
+    void addObject(UAVObject *obj);
+
+    //! Case insensitive, by object ID
+    QHash<quint32, Match> search(const QString &text) const;
+
+private:
+    struct Entry
+    {
+        QString text; // Lower case
+        quint32 objId;
+        QString field; // Empty for the object itself
+    };
+
+    void addEntry(const QString &text, quint32 objId, const QString &field);
+    static quint64 trigram(const QString &text, int i);
+
+    QVector<Entry> entries;
+    QHash<quint64, QVector<int>> trigrams; // Entries holding each, in order
+    QSet<quint32> indexed;
+};
+
+#endif // UAVOBJECTSEARCHINDEX_H
+
+/**
+ * @}
+ * @}
+ */
@@ -43,7 +43,9 @@
 #include <QtCore/QTimer>
 #include <QtCore/QSignalMapper>
 #include <QtCore/QDebug>
+#include <QtCore/QHash>
 #include <math.h>
+#include <algorithm>
 
 #include <QApplication>
 
@@ -68,6 +70,10 @@ UAVObjectTreeModel::UAVObjectTreeModel(QObject *parent, bool useScientificNotati
     m_defaultValueFont = font;
     font.setWeight(QFont::Bold);
     m_nonDefaultValueFont = font;
+
+    m_dataChangedTimer.setSingleShot(true);
+    m_dataChangedTimer.setInterval(DATA_CHANGED_PERIOD_MS);
+    connect(&m_dataChangedTimer, &QTimer::timeout, this, &UAVObjectTreeModel::emitDataChanged);
 }
 
 UAVObjectTreeModel::~UAVObjectTreeModel()
@@ -100,6 +106,8 @@ void UAVObjectTreeModel::setupModelData(UAVObjectManager *objManager, bool categ
             &UAVObjectTreeModel::updateHighlight);
 
         delete m_highlightManager;
+        m_changedItems.clear();
+        m_dataChangedTimer.stop();
         int count = m_rootItem->childCount();
         beginRemoveRows(index(m_rootItem), 0, count);
         delete m_rootItem;
@@ -111,6 +119,7 @@ void UAVObjectTreeModel::setupModelData(UAVObjectManager *objManager, bool categ
     QList<QVariant> rootData;
     rootData << tr("Property") << tr("Value") << tr("Unit");
     m_rootItem = new TreeItem(rootData);
+    m_searchIndex.clear();
 
     m_settingsTree = new TopTreeItem(tr("Settings"), m_rootItem);
     m_settingsTree->setHighlightManager(m_highlightManager);
@@ -163,6 +172,7 @@ void UAVObjectTreeModel::instanceRemove(UAVObject *obj)
             InstanceTreeItem *inst = dynamic_cast<InstanceTreeItem *>(item);
             if (inst && inst->object() == obj) {
                 printf("removing an instance\n");
+                forgetItem(inst);
                 inst->parent()->removeChild(inst);
                 inst->deleteLater();
             }
@@ -186,6 +196,8 @@ void UAVObjectTreeModel::addDataObject(UAVDataObject *obj, bool categorize)
     if (existing) {
         addInstance(obj, existing);
     } else {
+        m_searchIndex.addObject(obj);
+
         DataObjectTreeItem *dataTreeItem = new DataObjectTreeItem(
             obj->getName() + " (" + QString::number(obj->getNumBytes()) + " bytes)");
         dataTreeItem->setHighlightManager(m_highlightManager);
@@ -217,24 +229,19 @@ TreeItem *UAVObjectTreeModel::createCategoryItems(QStringList categoryPath, Tree
 
 MetaObjectTreeItem *UAVObjectTreeModel::addMetaObject(UAVMetaObject *obj, TreeItem *parent)
 {
-    connect(obj, &UAVObject::objectUpdated, this, &UAVObjectTreeModel::highlightUpdatedObject);
+    connect(obj, &UAVObject::objectUpdatedCoalesced, this,
+            &UAVObjectTreeModel::highlightUpdatedObject);
     MetaObjectTreeItem *meta = new MetaObjectTreeItem(obj, tr("Meta Data"));
 
     meta->setHighlightManager(m_highlightManager);
-    foreach (UAVObjectField *field, obj->getFields()) {
-        if (field->getNumElements() > 1) {
-            addArrayField(field, meta);
-        } else {
-            addSingleField(0, field, meta);
-        }
-    }
     parent->appendChild(meta);
     return meta;
 }
 
 void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
 {
-    connect(obj, &UAVObject::objectUpdated, this, &UAVObjectTreeModel::highlightUpdatedObject);
+    connect(obj, &UAVObject::objectUpdatedCoalesced, this,
+            &UAVObjectTreeModel::highlightUpdatedObject);
     TreeItem *item;
     DataObjectTreeItem *p = static_cast<DataObjectTreeItem *>(parent);
     if (obj->isSingleInstance()) {
@@ -255,18 +262,41 @@ void UAVObjectTreeModel::addInstance(UAVObject *obj, TreeItem *parent)
         // Inform the model that the row addition is complete
         endInsertRows();
     }
-    foreach (UAVObjectField *field, obj->getFields()) {
+    // The fields are added by populateFields(), when the object is expanded
+    UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
+    if (dobj) {
+        connect(dobj, QOverload<UAVDataObject *>::of(&UAVDataObject::presentOnHardwareChanged),
+                this, &UAVObjectTreeModel::presentOnHardwareChangedCB, Qt::UniqueConnection);
+    }
+}
+
+/**
+ * @brief Creates the field items of an object, the first time it is expanded
+ */
+void UAVObjectTreeModel::populateFields(ObjectTreeItem *item)
+{
+    UAVObject *obj = item->object();
+    if (!obj || item->fieldsPopulated())
+        return;
+
+    item->setFieldsPopulated(true);
+
+    QList<UAVObjectField *> fields = obj->getFields();
+    if (fields.isEmpty())
+        return;
+
+    int first = item->childCount();
+    beginInsertRows(index(item), first, first + fields.size() - 1);
+    foreach (UAVObjectField *field, fields) {
         if (field->getNumElements() > 1) {
             addArrayField(field, item);
         } else {
             addSingleField(0, field, item);
         }
     }
-    UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
-    if (dobj) {
-        connect(dobj, QOverload<UAVDataObject *>::of(&UAVDataObject::presentOnHardwareChanged),
-                this, &UAVObjectTreeModel::presentOnHardwareChangedCB, Qt::UniqueConnection);
-    }
+    for (int i = first; i < item->childCount(); i++)
+        item->getChild(i)->setIsPresentOnHardware(item->getIsPresentOnHardware());
+    endInsertRows();
 }
 
 void UAVObjectTreeModel::addArrayField(UAVObjectField *field, TreeItem *parent)
@@ -294,7 +324,7 @@ void UAVObjectTreeModel::addSingleField(int index, UAVObjectField *field, TreeIt
     case UAVObjectField::BITFIELD:
     case UAVObjectField::ENUM: {
         QStringList options = field->getOptions();
-        QVariant value = field->getValue();
+        QVariant value = field->getValue(index);
         data.append(options.indexOf(value.toString()));
         data.append(field->getUnits());
         item = new EnumFieldTreeItem(field, index, data);
@@ -320,6 +350,9 @@ void UAVObjectTreeModel::addSingleField(int index, UAVObjectField *field, TreeIt
     }
     item->setDescription(field->getDescription());
     item->setHighlightManager(m_highlightManager);
+    UAVDataObject *obj = qobject_cast<UAVDataObject *>(field->getObject());
+    if (obj && obj->isSettings())
+        item->setIsDefaultValue(field->isDefaultValue(index));
     parent->appendChild(item);
 }
 
@@ -347,16 +380,9 @@ QModelIndex UAVObjectTreeModel::index(TreeItem *item)
     if (item->parent() == 0)
         return QModelIndex();
 
-    QModelIndex root = index(item->parent());
-
-    for (int i = 0; i < rowCount(root); ++i) {
-        QModelIndex childIndex = index(i, 0, root);
-        TreeItem *child = static_cast<TreeItem *>(childIndex.internalPointer());
-        if (child == item)
-            return childIndex;
-    }
-    Q_ASSERT(false);
-    return QModelIndex();
+    int row = item->row();
+    Q_ASSERT(row >= 0);
+    return createIndex(row, 0, item);
 }
 
 QModelIndex UAVObjectTreeModel::parent(const QModelIndex &index) const
@@ -394,6 +420,65 @@ int UAVObjectTreeModel::columnCount(const QModelIndex &parent) const
         return m_rootItem->columnCount();
 }
 
+bool UAVObjectTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    // Objects get an expander before their fields exist
+    if (canFetchMore(parent))
+        return true;
+
+    return QAbstractItemModel::hasChildren(parent);
+}
+
+bool UAVObjectTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (!parent.isValid() || parent.column() > 0)
+        return false;
+
+    ObjectTreeItem *item =
+        dynamic_cast<ObjectTreeItem *>(static_cast<TreeItem *>(parent.internalPointer()));
+    return item && item->object() && !item->fieldsPopulated();
+}
+
+void UAVObjectTreeModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent))
+        return;
+
+    populateFields(static_cast<ObjectTreeItem *>(parent.internalPointer()));
+}
+
+/**
+ * @brief Tells the model which items the view shows expanded. Only the fields
+ * of shown objects are kept up to date, the others are refreshed when they
+ * come into view again.
+ */
+void UAVObjectTreeModel::setExpanded(const QModelIndex &index, bool expanded)
+{
+    if (!index.isValid())
+        return;
+
+    TreeItem *item = static_cast<TreeItem *>(index.internalPointer());
+    item->setExpanded(expanded);
+
+    if (expanded && item->childrenShown())
+        refreshShownItems(item);
+}
+
+void UAVObjectTreeModel::refreshShownItems(TreeItem *item)
+{
+    if (!item->isExpanded())
+        return;
+
+    ObjectTreeItem *objItem = dynamic_cast<ObjectTreeItem *>(item);
+    if (objItem && objItem->object())
+        objItem->update();
+
+    foreach (TreeItem *child, item->treeChildren()) {
+        if (dynamic_cast<ObjectTreeItem *>(child) || dynamic_cast<CategoryTreeItem *>(child))
+            refreshShownItems(child);
+    }
+}
+
 QList<QModelIndex> UAVObjectTreeModel::getMetaDataIndexes()
 {
     QList<QModelIndex> metaIndexes;
@@ -523,15 +608,26 @@ void UAVObjectTreeModel::highlightUpdatedObject(UAVObject *obj)
     Q_ASSERT(obj);
     ObjectTreeItem *item = findObjectTreeItem(obj);
     Q_ASSERT(item);
-    if (!m_onlyHighlightChangedValues) {
-        item->setHighlight();
+
+    // Each instance of a multi instance object has an item of its own
+    if (!item->object()) {
+        foreach (TreeItem *child, item->treeChildren()) {
+            InstanceTreeItem *inst = dynamic_cast<InstanceTreeItem *>(child);
+            if (inst && inst->object() == obj) {
+                item = inst;
+                break;
+            }
+        }
     }
-    item->update();
+
     if (!m_onlyHighlightChangedValues) {
-        QModelIndex itemIndex = index(item);
-        Q_ASSERT(itemIndex != QModelIndex());
-        emit dataChanged(itemIndex, itemIndex);
+        item->setHighlight();
+        itemChanged(item);
     }
+
+    // Fields out of view are refreshed by setExpanded(), once they are shown
+    if (item->childrenShown())
+        item->update();
 }
 
 ObjectTreeItem *UAVObjectTreeModel::findObjectTreeItem(UAVObject *object)
@@ -570,9 +666,60 @@ void UAVObjectTreeModel::updateHighlight(TreeItem *item)
         return;
     }
 
-    QModelIndex itemIndex = index(item);
-    Q_ASSERT(itemIndex.isValid());
-    emit dataChanged(itemIndex, itemIndex.sibling(itemIndex.row(), TreeItem::dataColumn));
+    itemChanged(item);
+}
+
+/**
+ * @brief Queues the dataChanged of an item for the next frame
+ */
+void UAVObjectTreeModel::itemChanged(TreeItem *item)
+{
+    m_changedItems.insert(item);
+    if (!m_dataChangedTimer.isActive())
+        m_dataChangedTimer.start();
+}
+
+/**
+ * @brief Drops an item that is going away, and its children, from the
+ * changed items
+ */
+void UAVObjectTreeModel::forgetItem(TreeItem *item)
+{
+    m_changedItems.remove(item);
+    foreach (TreeItem *child, item->treeChildren())
+        forgetItem(child);
+}
+
+/**
+ * @brief Signals the items changed during the last frame, with one dataChanged
+ * per run of adjacent rows
+ */
+void UAVObjectTreeModel::emitDataChanged()
+{
+    QHash<TreeItem *, QVector<int>> rowsPerParent;
+    foreach (TreeItem *item, m_changedItems) {
+        int row = item->row();
+        if (row >= 0)
+            rowsPerParent[item->parent()].append(row);
+    }
+    m_changedItems.clear();
+
+    for (auto i = rowsPerParent.begin(); i != rowsPerParent.end(); ++i) {
+        TreeItem *parent = i.key();
+        QVector<int> &rows = i.value();
+        std::sort(rows.begin(), rows.end());
+
+        int n = 0;
+        while (n < rows.size()) {
+            int first = rows.at(n);
+            int last = first;
+            while (++n < rows.size() && rows.at(n) == last + 1)
+                last++;
+
+            emit dataChanged(createIndex(first, 0, parent->getChild(first)),
+                             createIndex(last, TreeItem::dataColumn, parent->getChild(last)));
+        }
+    }
 }
 
 void UAVObjectTreeModel::presentOnHardwareChangedCB(UAVDataObject *obj)
@@ -36,9 +36,12 @@
 #define UAVOBJECTTREEMODEL_H
 
 #include "treeitem.h"
+#include "uavobjectsearchindex.h"
 #include <QAbstractItemModel>
 #include <QtCore/QMap>
 #include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QTimer>
 #include <QColor>
 #include <QFont>
 
@@ -51,7 +54,6 @@ class UAVMetaObject;
 class UAVObjectField;
 class UAVObjectManager;
 class QSignalMapper;
-class QTimer;
 
 class UAVObjectTreeModel : public QAbstractItemModel
 {
@@ -68,6 +70,13 @@ public:
     QModelIndex parent(const QModelIndex &index) const;
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+    void setExpanded(const QModelIndex &index, bool expanded);
+
+    const UAVObjectSearchIndex &searchIndex() const { return m_searchIndex; }
 
     TopTreeItem *getSettingsTree() { return m_settingsTree; }
     TopTreeItem *getNonSettingsTree() { return m_nonSettingsTree; }
@@ -95,6 +104,7 @@ private slots:
     void highlightUpdatedObject(UAVObject *obj);
     void updateHighlight(TreeItem *);
     void presentOnHardwareChangedCB(UAVDataObject *);
+    void emitDataChanged();
 
 private:
     void setupModelData(UAVObjectManager *objManager, bool categorize = true,
@@ -105,6 +115,10 @@ private:
     void addArrayField(UAVObjectField *field, TreeItem *parent);
     void addSingleField(int index, UAVObjectField *field, TreeItem *parent);
     void addInstance(UAVObject *obj, TreeItem *parent);
+    void populateFields(ObjectTreeItem *item);
+    void refreshShownItems(TreeItem *item);
+    void itemChanged(TreeItem *item);
+    void forgetItem(TreeItem *item);
 
     TreeItem *createCategoryItems(QStringList categoryPath, TreeItem *root);
 
@@ -128,6 +142,12 @@ private:
     bool m_hideNotPresent;
     bool m_categorize;
     UAVObjectManager *objManager;
+    // Items changed since the last dataChanged, signalled once per frame
+    QSet<TreeItem *> m_changedItems;
+    QTimer m_dataChangedTimer;
+    static const int DATA_CHANGED_PERIOD_MS = 16;
+    // Names and descriptions of all objects, searched without creating the field items
+    UAVObjectSearchIndex m_searchIndex;
     // Highlight manager to handle highlighting of tree items.
     HighLightManager *m_highlightManager;
     bool isInitialized;
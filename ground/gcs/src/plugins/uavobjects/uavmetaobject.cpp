@@ -44,21 +44,11 @@ UAVMetaObject::UAVMetaObject(quint32 objID, const QString &name, UAVObject *pare
     this->parent = parent;
     // Setup default metadata of metaobject (can not be changed)
     UAVObject::MetadataInitialize(ownMetadata);
-    // Setup fields
-    QStringList modesBitField;
-    modesBitField << tr("FlightReadOnly") << tr("GCSReadOnly") << tr("FlightTelemetryAcked")
-                  << tr("GCSTelemetryAcked") << tr("FlightUpdatePeriodic")
-                  << tr("FlightUpdateOnChange") << tr("GCSUpdatePeriodic")
-                  << tr("GCSUpdateOnChange");
+    // Setup fields, all the metaobjects share their descriptions
+    static const QList<const UAVObjectField::Info *> fieldInfos = createFieldInfos();
     QList<UAVObjectField *> fields;
-    fields.append(new UAVObjectField(tr("Modes"), tr("boolean"), UAVObjectField::BITFIELD,
-                                     modesBitField, QStringList(), QList<int>()));
-    fields.append(new UAVObjectField(tr("Flight Telemetry Update Period"), tr("ms"),
-                                     UAVObjectField::UINT16, 1, QStringList(), QList<int>()));
-    fields.append(new UAVObjectField(tr("GCS Telemetry Update Period"), tr("ms"),
-                                     UAVObjectField::UINT16, 1, QStringList(), QList<int>()));
-    fields.append(new UAVObjectField(tr("Logging Update Period"), tr("ms"), UAVObjectField::UINT16,
-                                     1, QStringList(), QList<int>()));
+    foreach (const UAVObjectField::Info *info, fieldInfos)
+        fields.append(new UAVObjectField(info));
     // Initialize parent
     UAVObject::initialize(0);
     UAVObject::initializeFields(fields, (quint8 *)&parentMetadata, sizeof(Metadata));
@@ -66,6 +56,28 @@ UAVMetaObject::UAVMetaObject(quint32 objID, const QString &name, UAVObject *pare
     parentMetadata = parent->getDefaultMetadata();
 }
 
+/**
+ * Describe the metadata fields, this is done once for all the metaobjects
+ */
+QList<const UAVObjectField::Info *> UAVMetaObject::createFieldInfos()
+{
+    QStringList modesBitField;
+    modesBitField << tr("FlightReadOnly") << tr("GCSReadOnly") << tr("FlightTelemetryAcked")
+                  << tr("GCSTelemetryAcked") << tr("FlightUpdatePeriodic")
+                  << tr("FlightUpdateOnChange") << tr("GCSUpdatePeriodic")
+                  << tr("GCSUpdateOnChange");
+    QList<const UAVObjectField::Info *> infos;
+    infos.append(new UAVObjectField::Info(tr("Modes"), tr("boolean"), UAVObjectField::BITFIELD,
+                                          modesBitField, QStringList(), QList<int>()));
+    infos.append(new UAVObjectField::Info(tr("Flight Telemetry Update Period"), tr("ms"),
+                                          UAVObjectField::UINT16, 1, QStringList(), QList<int>()));
+    infos.append(new UAVObjectField::Info(tr("GCS Telemetry Update Period"), tr("ms"),
+                                          UAVObjectField::UINT16, 1, QStringList(), QList<int>()));
+    infos.append(new UAVObjectField::Info(tr("Logging Update Period"), tr("ms"),
+                                          UAVObjectField::UINT16, 1, QStringList(), QList<int>()));
+    return infos;
+}
+
 /**
  * Get the parent object
  */
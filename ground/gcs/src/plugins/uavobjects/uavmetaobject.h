@@ -47,6 +47,8 @@ private:
     UAVObject *parent;
     Metadata ownMetadata;
     Metadata parentMetadata;
+
+    static QList<const UAVObjectField::Info *> createFieldInfos();
 };
 
 #endif // UAVMETAOBJECT_H
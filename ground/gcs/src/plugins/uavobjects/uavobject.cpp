@@ -38,6 +38,10 @@
 #include <QDebug>
 #include <QJsonArray>
 #include <QJsonValue>
+#include <QMetaMethod>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
 
 // Constants
 #define UAVOBJ_ACCESS_SHIFT 0
@@ -51,6 +55,10 @@
 // Macros
 #define SET_BITS(var, shift, value, mask) var = (var & ~(mask << shift)) | (value << shift);
 
+// Objects waiting for their frame-coalesced notification
+static QVector<QPointer<UAVObject>> coalescedPending;
+static QTimer *coalesceTimer = NULL;
+
 /**
  * Constructor
  * @param objID The object ID
@@ -63,6 +71,10 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString &name)
     this->instID = 0;
     this->isSingleInst = isSingleInst;
     this->name = name;
+    this->coalescedUpdates = 0;
+    this->unpackCount = 0;
+
+    connect(this, &UAVObject::objectUpdated, this, &UAVObject::queueCoalescedUpdate);
 }
 
 /**
@@ -103,6 +115,50 @@ void UAVObject::fieldUpdated(UAVObjectField *field)
     //    emit objectUpdated(this);
 }
 
+/**
+ * Called on every objectUpdated. Schedules a single objectUpdatedCoalesced
+ * for the next UI frame if anybody listens to it.
+ */
+void UAVObject::queueCoalescedUpdate()
+{
+    static const QMetaMethod coalescedSignal =
+        QMetaMethod::fromSignal(&UAVObject::objectUpdatedCoalesced);
+
+    if (!isSignalConnected(coalescedSignal))
+        return;
+
+    if (coalescedUpdates++ > 0)
+        return; // Already pending, the notification will carry the latest data
+
+    coalescedPending.append(this);
+
+    if (coalesceTimer == NULL) {
+        coalesceTimer = new QTimer();
+        coalesceTimer->setSingleShot(true);
+        coalesceTimer->setInterval(COALESCE_PERIOD_MS);
+        QObject::connect(coalesceTimer, &QTimer::timeout, &UAVObject::flushCoalescedUpdates);
+    }
+    if (!coalesceTimer->isActive())
+        coalesceTimer->start();
+}
+
+/**
+ * Deliver the pending frame-coalesced notifications
+ */
+void UAVObject::flushCoalescedUpdates()
+{
+    QVector<QPointer<UAVObject>> pending;
+    pending.swap(coalescedPending);
+
+    foreach (const QPointer<UAVObject> &obj, pending) {
+        if (obj.isNull())
+            continue;
+        quint32 dropped = obj->coalescedUpdates - 1;
+        obj->coalescedUpdates = 0;
+        emit obj->objectUpdatedCoalesced(obj.data(), dropped);
+    }
+}
+
 /**
  * Get the object ID
  */
@@ -293,6 +349,8 @@ qint32 UAVObject::unpack(const quint8 *dataIn)
         field->unpack(&dataIn[offset]);
         offset += field->getNumBytes();
     }
+    // Sampled by the debug gadget, counting is all this costs per update
+    unpackCount++;
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
 
@@ -128,6 +128,8 @@ public:
     quint32 getNumBytes();
     qint32 pack(quint8 *dataOut);
     qint32 unpack(const quint8 *dataIn);
+    //! Number of times the object was unpacked, i.e. received, ever
+    quint32 getUnpackCount() const { return unpackCount; }
     virtual void setMetadata(const Metadata &mdata) = 0;
     virtual Metadata getMetadata() = 0;
     virtual Metadata getDefaultMetadata() = 0;
@@ -176,6 +178,19 @@ signals:
      */
     void objectUpdated(UAVObject *obj);
 
+    /**
+     * @brief objectUpdatedCoalesced: frame-coalesced variant of objectUpdated
+     *
+     * Emitted at most once per UI frame for an object that was updated one or
+     * more times since the last delivery; the object already holds the latest
+     * data. Meant for display gadgets that don't need every sample, while
+     * consumers like the scope keep listening to objectUpdated. Coalescing is
+     * only done while something is connected to this signal.
+     * @param obj
+     * @param dropped Number of updates folded into this notification
+     */
+    void objectUpdatedCoalesced(UAVObject *obj, quint32 dropped);
+
     /**
      * @brief objectUpdatedAuto: triggered on "setData" only (Object data updated by changing the
      * data structure)
@@ -241,6 +256,7 @@ signals:
 
 private slots:
     void fieldUpdated(UAVObjectField *field);
+    void queueCoalescedUpdate();
 
 protected:
     quint32 objID;
@@ -255,6 +271,12 @@ protected:
     void initializeFields(QList<UAVObjectField *> &fields, quint8 *data, quint32 numBytes);
     void setDescription(const QString &description);
     void setCategory(const QString &category);
+
+private:
+    static const int COALESCE_PERIOD_MS = 16;
+    quint32 coalescedUpdates;
+    quint32 unpackCount;
+    static void flushCoalescedUpdates();
 };
 
 #endif // UAVOBJECT_H
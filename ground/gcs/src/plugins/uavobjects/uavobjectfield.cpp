@@ -37,11 +37,11 @@
 #include <QDebug>
 #include <cfloat>
 
-UAVObjectField::UAVObjectField(const QString &name, const QString &units, FieldType type,
-                               quint32 numElements, const QStringList &options,
-                               const QList<int> &indices, const QString &limits,
-                               const QString &description, const QList<QVariant> defaultValues,
-                               const DisplayType display)
+UAVObjectField::Info::Info(const QString &name, const QString &units, FieldType type,
+                           quint32 numElements, const QStringList &options,
+                           const QList<int> &indices, const QString &limits,
+                           const QString &description, const QList<QVariant> defaultValues,
+                           const DisplayType display)
 {
     QStringList elementNames;
     // Set element names
@@ -53,22 +53,59 @@ UAVObjectField::UAVObjectField(const QString &name, const QString &units, FieldT
                           defaultValues, display);
 }
 
+UAVObjectField::Info::Info(const QString &name, const QString &units, FieldType type,
+                           const QStringList &elementNames, const QStringList &options,
+                           const QList<int> &indices, const QString &limits,
+                           const QString &description, const QList<QVariant> defaultValues,
+                           const DisplayType display)
+{
+    constructorInitialize(name, units, type, elementNames, options, indices, limits, description,
+                          defaultValues, display);
+}
+
+UAVObjectField::UAVObjectField(const Info *info)
+    : info(info)
+    , offset(0)
+    , data(NULL)
+    , obj(NULL)
+{
+}
+
+UAVObjectField::UAVObjectField(const QString &name, const QString &units, FieldType type,
+                               quint32 numElements, const QStringList &options,
+                               const QList<int> &indices, const QString &limits,
+                               const QString &description, const QList<QVariant> defaultValues,
+                               const DisplayType display)
+    : ownInfo(new Info(name, units, type, numElements, options, indices, limits, description,
+                       defaultValues, display))
+    , offset(0)
+    , data(NULL)
+    , obj(NULL)
+{
+    info = ownInfo.data();
+}
+
 UAVObjectField::UAVObjectField(const QString &name, const QString &units, FieldType type,
                                const QStringList &elementNames, const QStringList &options,
                                const QList<int> &indices, const QString &limits,
                                const QString &description, const QList<QVariant> defaultValues,
                                const DisplayType display)
+    : ownInfo(new Info(name, units, type, elementNames, options, indices, limits, description,
+                       defaultValues, display))
+    , offset(0)
+    , data(NULL)
+    , obj(NULL)
 {
-    constructorInitialize(name, units, type, elementNames, options, indices, limits, description,
-                          defaultValues, display);
+    info = ownInfo.data();
 }
 
-void UAVObjectField::constructorInitialize(const QString &name, const QString &units,
-                                           FieldType type, const QStringList &elementNames,
-                                           const QStringList &options, const QList<int> &indices,
-                                           const QString &limits, const QString &description,
-                                           const QList<QVariant> defaultValues,
-                                           const DisplayType display)
+void UAVObjectField::Info::constructorInitialize(const QString &name, const QString &units,
+                                                 FieldType type, const QStringList &elementNames,
+                                                 const QStringList &options,
+                                                 const QList<int> &indices, const QString &limits,
+                                                 const QString &description,
+                                                 const QList<QVariant> defaultValues,
+                                                 const DisplayType display)
 {
     // Copy params
     this->name = name;
@@ -77,9 +114,6 @@ void UAVObjectField::constructorInitialize(const QString &name, const QString &u
     this->options = options;
     this->indices = indices;
     this->numElements = elementNames.length();
-    this->offset = 0;
-    this->data = NULL;
-    this->obj = NULL;
     this->elementNames = elementNames;
     this->description = description;
     this->display = display;
@@ -129,7 +163,7 @@ void UAVObjectField::constructorInitialize(const QString &name, const QString &u
         this->defaultValues << QVariant(0);
 }
 
-void UAVObjectField::limitsInitialize(const QString &limits)
+void UAVObjectField::Info::limitsInitialize(const QString &limits)
 {
     /// format
     /// (TY)->type (EQ-equal;NE-not equal;BE-between;BI-bigger;SM-smaller)
@@ -143,7 +177,7 @@ void UAVObjectField::limitsInitialize(const QString &limits)
     quint32 index = 0;
     foreach (const QString &str, stringPerElement) {
         QStringList ruleList = str.split(";");
-        QList<LimitStruct> limitList;
+        QVector<LimitStruct> limitList;
         foreach (const QString &rule, ruleList) {
             QString _str = rule.trimmed();
             if (_str.isEmpty())
@@ -171,9 +205,11 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                     lstruc.type = BIGGER;
                 else if (valuesPerElement.at(0).right(2) == "SM")
                     lstruc.type = SMALLER;
-                else
+                else {
                     qDebug() << "limits parsing failed (invalid property) on UAVObjectField"
                              << name;
+                    continue;
+                }
                 valuesPerElement.removeAt(0);
                 foreach (const QString &_value, valuesPerElement) {
                     QString value = _value.trimmed();
@@ -202,6 +238,7 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                         lstruc.values.append(QVariant());
                     }
                 }
+                compileLimit(lstruc);
                 limitList.append(lstruc);
             } else {
                 if (!valuesPerElement.at(0).isEmpty() && !startFlag)
@@ -218,228 +255,123 @@ void UAVObjectField::limitsInitialize(const QString &limits)
                              << name;
             }
         }
-        elementLimits.insert(index, limitList);
+        elementLimits.append(limitList);
         ++index;
     }
 }
 
+double UAVObjectField::Info::limitKey(const QVariant &value) const
+{
+    switch (type) {
+    case INT8:
+    case INT16:
+    case INT32:
+        return value.toInt();
+    case UINT8:
+    case UINT16:
+    case UINT32:
+    case BITFIELD:
+        return value.toUInt();
+    case FLOAT32:
+        return value.toFloat();
+    case ENUM:
+        // Limits on enums go by the order in this object, not by the
+        // underlying values
+        return options.indexOf(value.toString());
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Turn the values of a limit into bounds or a set of allowed values
+ */
+void UAVObjectField::Info::compileLimit(LimitStruct &limit) const
+{
+    limit.valid = true;
+    limit.min = -DBL_MAX;
+    limit.max = DBL_MAX;
+
+    switch (limit.type) {
+    case EQUAL:
+    case NOT_EQUAL:
+        foreach (const QVariant &value, limit.values) {
+            double key = limitKey(value);
+            // An unknown option can't be matched by anything
+            if (type == ENUM && key < 0)
+                continue;
+            limit.allowed.append(key);
+        }
+        break;
+    case BETWEEN:
+        if (limit.values.length() < 2) {
+            qDebug() << __FUNCTION__ << "between limit with less than 1 pair, ignoring; field:"
+                     << name;
+            limit.valid = false;
+            break;
+        }
+        if (limit.values.length() > 2)
+            qDebug() << __FUNCTION__ << "between limit with more than 1 pair, using first; field"
+                     << name;
+        limit.min = limitKey(limit.values.at(0));
+        limit.max = limitKey(limit.values.at(1));
+        break;
+    case BIGGER:
+    case SMALLER:
+        if (limit.values.length() < 1) {
+            qDebug() << __FUNCTION__ << "limit with less than 1 value, ignoring; field:" << name;
+            limit.valid = false;
+            break;
+        }
+        if (limit.values.length() > 1)
+            qDebug() << __FUNCTION__ << "limit with more than 1 value, using first; field"
+                     << name;
+        if (limit.type == BIGGER)
+            limit.min = limitKey(limit.values.at(0));
+        else
+            limit.max = limitKey(limit.values.at(0));
+        break;
+    }
+}
+
 bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index))
+    if (index >= static_cast<quint32>(info->elementLimits.size()))
+        return true;
+
+    const QVector<LimitStruct> &limits = info->elementLimits.at(index);
+    if (limits.isEmpty())
         return true;
 
-    foreach (const LimitStruct &struc, elementLimits.value(index)) {
+    const double key = info->limitKey(var);
+
+    // The first limit that applies to the board decides
+    for (const LimitStruct &struc : limits) {
         if ((struc.board != board) && board != 0 && struc.board != 0)
             continue;
-        switch (struc.type) {
-        case EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toInt() == vars.toInt())
-                        return true;
-                }
-                return false;
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt())
-                        return true;
-                }
-                return false;
-                break;
-            case ENUM:
-            case STRING:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toString() == vars.toString())
-                        return true;
-                }
-                return false;
-                break;
-            case FLOAT32:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat())
-                        return true;
-                }
-                return false;
-                break;
-            default:
-                return true;
-            }
-            break;
-        case NOT_EQUAL:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toInt() == vars.toInt())
-                        return false;
-                }
-                return true;
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toUInt() == vars.toUInt())
-                        return false;
-                }
-                return true;
-                break;
-            case ENUM:
-            case STRING:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toString() == vars.toString())
-                        return false;
-                }
+        if (!struc.valid)
+            return true;
+
+        if (info->type == STRING) {
+            if (struc.type != EQUAL && struc.type != NOT_EQUAL)
                 return true;
-                break;
-            case FLOAT32:
-                foreach (const QVariant &vars, struc.values) {
-                    if (var.toFloat() == vars.toFloat())
-                        return false;
+            bool found = false;
+            foreach (const QVariant &vars, struc.values) {
+                if (var.toString() == vars.toString()) {
+                    found = true;
+                    break;
                 }
-                return true;
-                break;
-            default:
-                return true;
-            }
-            break;
-        case BETWEEN:
-            if (struc.values.length() < 2) {
-                qDebug() << __FUNCTION__
-                         << "between limit with less than 1 pair, aborting; field:" << name;
-                return true;
-            }
-            if (struc.values.length() > 2)
-                qDebug() << __FUNCTION__
-                         << "between limit with more than 1 pair, using first; field" << name;
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt()
-                      && var.toInt() <= struc.values.at(1).toInt()))
-                    return false;
-                return true;
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt()
-                      && var.toUInt() <= struc.values.at(1).toUInt()))
-                    return false;
-                return true;
-                break;
-            case ENUM:
-                // OK, I think this is OK with parents.  Because we'll
-                // consider the limit to mean "as ordered in this object".
-                // So no need to map to underlying types.
-                if (!(options.indexOf(var.toString())
-                          >= options.indexOf(struc.values.at(0).toString())
-                      && options.indexOf(var.toString())
-                          <= options.indexOf(struc.values.at(1).toString())))
-                    return false;
-                return true;
-                break;
-            case STRING:
-                return true;
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat()
-                      && var.toFloat() <= struc.values.at(1).toFloat()))
-                    return false;
-                return true;
-                break;
-            default:
-                return true;
-            }
-            break;
-        case BIGGER:
-            if (struc.values.length() < 1) {
-                qDebug() << __FUNCTION__
-                         << "BIGGER limit with less than 1 value, aborting; field:" << name;
-                return true;
-            }
-            if (struc.values.length() > 1)
-                qDebug() << __FUNCTION__
-                         << "BIGGER limit with more than 1 value, using first; field" << name;
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() >= struc.values.at(0).toInt()))
-                    return false;
-                return true;
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() >= struc.values.at(0).toUInt()))
-                    return false;
-                return true;
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString())
-                      >= options.indexOf(struc.values.at(0).toString())))
-                    return false;
-                return true;
-                break;
-            case STRING:
-                return true;
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() >= struc.values.at(0).toFloat()))
-                    return false;
-                return true;
-                break;
-            default:
-                return true;
-            }
-            break;
-        case SMALLER:
-            switch (type) {
-            case INT8:
-            case INT16:
-            case INT32:
-                if (!(var.toInt() <= struc.values.at(0).toInt()))
-                    return false;
-                return true;
-                break;
-            case UINT8:
-            case UINT16:
-            case UINT32:
-            case BITFIELD:
-                if (!(var.toUInt() <= struc.values.at(0).toUInt()))
-                    return false;
-                return true;
-                break;
-            case ENUM:
-                if (!(options.indexOf(var.toString())
-                      <= options.indexOf(struc.values.at(0).toString())))
-                    return false;
-                return true;
-                break;
-            case STRING:
-                return true;
-                break;
-            case FLOAT32:
-                if (!(var.toFloat() <= struc.values.at(0).toFloat()))
-                    return false;
-                return true;
-                break;
-            default:
-                return true;
             }
+            return found == (struc.type == EQUAL);
+        }
+
+        switch (struc.type) {
+        case EQUAL:
+            return struc.allowed.contains(key);
+        case NOT_EQUAL:
+            return !struc.allowed.contains(key);
+        default:
+            return key >= struc.min && key <= struc.max;
         }
     }
     return true;
@@ -447,9 +379,9 @@ bool UAVObjectField::isWithinLimits(QVariant var, quint32 index, int board)
 
 QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (index >= static_cast<quint32>(info->elementLimits.size())) {
         // if nothing explicitly specified, assume max possible value
-        switch (type) {
+        switch (info->type) {
         case INT8:
             return INT8_MAX;
         case INT16:
@@ -472,7 +404,7 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
         return QVariant();
     }
 
-    foreach (const LimitStruct &struc, elementLimits.value(index)) {
+    foreach (const LimitStruct &struc, info->elementLimits.at(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0)
             continue;
         switch (struc.type) {
@@ -497,9 +429,9 @@ QVariant UAVObjectField::getMaxLimit(quint32 index, int board)
 }
 QVariant UAVObjectField::getMinLimit(quint32 index, int board)
 {
-    if (!elementLimits.keys().contains(index)) {
+    if (index >= static_cast<quint32>(info->elementLimits.size())) {
         // if nothing explicitly specified, assume min possible value
-        switch (type) {
+        switch (info->type) {
         case INT8:
             return INT8_MIN;
         case INT16:
@@ -520,7 +452,7 @@ QVariant UAVObjectField::getMinLimit(quint32 index, int board)
         return QVariant();
     }
 
-    foreach (LimitStruct struc, elementLimits.value(index)) {
+    foreach (const LimitStruct &struc, info->elementLimits.at(index)) {
         if ((struc.board != board) && board != 0 && struc.board != 0)
             return QVariant();
         switch (struc.type) {
@@ -553,12 +485,12 @@ void UAVObjectField::initialize(quint8 *data, quint32 dataOffset, UAVObject *obj
 
 UAVObjectField::FieldType UAVObjectField::getType()
 {
-    return type;
+    return info->type;
 }
 
 QString UAVObjectField::getTypeAsString()
 {
-    switch (type) {
+    switch (info->type) {
     case UAVObjectField::INT8:
         return "int8";
     case UAVObjectField::INT16:
@@ -586,17 +518,17 @@ QString UAVObjectField::getTypeAsString()
 
 QStringList UAVObjectField::getElementNames()
 {
-    return elementNames;
+    return info->elementNames;
 }
 
 QString UAVObjectField::getElementName(quint32 index)
 {
-    if (index >= static_cast<quint32>(elementNames.length())) {
+    if (index >= static_cast<quint32>(info->elementNames.length())) {
         Q_ASSERT(false);
-        qWarning() << "Invalid element:" << index << " max=" << elementNames.length();
+        qWarning() << "Invalid element:" << index << " max=" << info->elementNames.length();
         return "";
     }
-    return elementNames.at(static_cast<int>(index));
+    return info->elementNames.at(static_cast<int>(index));
 }
 
 UAVObject *UAVObjectField::getObject()
@@ -606,7 +538,9 @@ UAVObject *UAVObjectField::getObject()
 
 void UAVObjectField::clear()
 {
-    switch (type) {
+    const quint32 numElements = info->numElements;
+    const quint32 numBytesPerElement = info->numBytesPerElement;
+    switch (info->type) {
     case BITFIELD:
         memset(&data[offset], 0, numBytesPerElement * ((quint32)(1 + (numElements - 1) / 8)));
         break;
@@ -618,27 +552,27 @@ void UAVObjectField::clear()
 
 QString UAVObjectField::getName()
 {
-    return name;
+    return info->name;
 }
 
 QString UAVObjectField::getUnits()
 {
-    return units;
+    return info->units;
 }
 
 QStringList UAVObjectField::getOptions()
 {
-    return options;
+    return info->options;
 }
 
 bool UAVObjectField::hasOption(const QString &option)
 {
-    return options.contains(option);
+    return info->options.contains(option);
 }
 
 quint32 UAVObjectField::getNumElements()
 {
-    return numElements;
+    return info->numElements;
 }
 
 quint32 UAVObjectField::getDataOffset()
@@ -648,12 +582,12 @@ quint32 UAVObjectField::getDataOffset()
 
 quint32 UAVObjectField::getNumBytes()
 {
-    switch (type) {
+    switch (info->type) {
     case BITFIELD:
-        return numBytesPerElement * ((quint32)(1 + (numElements - 1) / 8));
+        return info->numBytesPerElement * ((quint32)(1 + (info->numElements - 1) / 8));
         break;
     default:
-        return numBytesPerElement * numElements;
+        return info->numBytesPerElement * info->numElements;
         break;
     }
 }
@@ -661,22 +595,24 @@ quint32 UAVObjectField::getNumBytes()
 QString UAVObjectField::toString()
 {
     QString sout;
-    sout.append(QString("%1: [ ").arg(name));
-    for (unsigned int n = 0; n < numElements; ++n) {
-        if (type == ENUM) {
+    sout.append(QString("%1: [ ").arg(info->name));
+    for (unsigned int n = 0; n < info->numElements; ++n) {
+        if (info->type == ENUM) {
             sout.append(QString("%1 ").arg(getValue(n).toString()));
         } else {
             sout.append(QString("%1 ").arg(getDouble(n)));
         }
     }
-    sout.append(QString("] %1\n").arg(units));
+    sout.append(QString("] %1\n").arg(info->units));
     return sout;
 }
 
 qint32 UAVObjectField::pack(quint8 *dataOut)
 {
+    const quint32 numElements = info->numElements;
+    const quint32 numBytesPerElement = info->numBytesPerElement;
     // Pack each element in output buffer
-    switch (type) {
+    switch (info->type) {
     case INT8:
         memcpy(dataOut, &data[offset], numElements);
         break;
@@ -740,8 +676,10 @@ qint32 UAVObjectField::pack(quint8 *dataOut)
 
 qint32 UAVObjectField::unpack(const quint8 *dataIn)
 {
+    const quint32 numElements = info->numElements;
+    const quint32 numBytesPerElement = info->numBytesPerElement;
     // Unpack each element from input buffer
-    switch (type) {
+    switch (info->type) {
     case INT8:
         memcpy(&data[offset], dataIn, numElements);
         break;
@@ -805,7 +743,7 @@ qint32 UAVObjectField::unpack(const quint8 *dataIn)
 
 bool UAVObjectField::isNumeric()
 {
-    switch (type) {
+    switch (info->type) {
     case INT8:
         return true;
         break;
@@ -843,7 +781,7 @@ bool UAVObjectField::isNumeric()
 
 bool UAVObjectField::isText()
 {
-    switch (type) {
+    switch (info->type) {
     case INT8:
         return false;
         break;
@@ -881,12 +819,14 @@ bool UAVObjectField::isText()
 
 QVariant UAVObjectField::getValue(quint32 index)
 {
+    const quint32 numElements = info->numElements;
+    const quint32 numBytesPerElement = info->numBytesPerElement;
     // Check that index is not out of bounds
     if (index >= numElements) {
         return QVariant();
     }
     // Get value
-    switch (type) {
+    switch (info->type) {
     case INT8: {
         qint8 tmpint8;
         memcpy(&tmpint8, &data[offset + numBytesPerElement * index], numBytesPerElement);
@@ -933,9 +873,9 @@ QVariant UAVObjectField::getValue(quint32 index)
         quint8 tmpenum;
         memcpy(&tmpenum, &data[offset + numBytesPerElement * index], numBytesPerElement);
         // Too slow?
-        for (int i = 0; i < indices.length(); i++) {
-            if (tmpenum == indices[i]) {
-                return QVariant(options[i]);
+        for (int i = 0; i < info->indices.length(); i++) {
+            if (tmpenum == info->indices[i]) {
+                return QVariant(info->options[i]);
             }
         }
 
@@ -964,14 +904,14 @@ QVariant UAVObjectField::getValue(quint32 index)
 bool UAVObjectField::checkValue(const QVariant &value, quint32 index)
 {
     // Check that index is not out of bounds
-    if (index >= numElements) {
+    if (index >= info->numElements) {
         return false;
     }
     // Get metadata
     UAVObject::Metadata mdata = obj->getMetadata();
     // Update value if the access mode permits
     if (UAVObject::GetFlightAccess(mdata) == UAVObject::ACCESS_READWRITE) {
-        switch (type) {
+        switch (info->type) {
         case INT8:
         case INT16:
         case INT32:
@@ -985,11 +925,11 @@ bool UAVObjectField::checkValue(const QVariant &value, quint32 index)
             break;
         case ENUM: {
             if (static_cast<QMetaType::Type>(value.type()) == QMetaType::QString) {
-                int idx = options.indexOf(value.toString());
-                if (idx < 0 || idx >= indices.length())
+                int idx = info->options.indexOf(value.toString());
+                if (idx < 0 || idx >= info->indices.length())
                     return false;
             } else if (value.canConvert(QMetaType::Int)) {
-                if (!indices.contains(value.toInt()))
+                if (!info->indices.contains(value.toInt()))
                     return false;
             } else {
                 return false;
@@ -997,7 +937,7 @@ bool UAVObjectField::checkValue(const QVariant &value, quint32 index)
             return true;
         }
         default:
-            qDebug() << "checkValue: other types" << type;
+            qDebug() << "checkValue: other types" << info->type;
             Q_ASSERT(0); // To catch any programming errors where we tried to test invalid values
             break;
         }
@@ -1007,6 +947,8 @@ bool UAVObjectField::checkValue(const QVariant &value, quint32 index)
 
 void UAVObjectField::setValue(const QVariant &value, quint32 index)
 {
+    const quint32 numElements = info->numElements;
+    const quint32 numBytesPerElement = info->numBytesPerElement;
     // Check that index is not out of bounds
     if (index >= numElements) {
         return;
@@ -1015,7 +957,7 @@ void UAVObjectField::setValue(const QVariant &value, quint32 index)
     UAVObject::Metadata mdata = obj->getMetadata();
     // Update value if the access mode permits
     if (UAVObject::GetGcsAccess(mdata) == UAVObject::ACCESS_READWRITE) {
-        switch (type) {
+        switch (info->type) {
         case INT8: {
             qint8 tmpint8 = value.toInt();
             memcpy(&data[offset + numBytesPerElement * index], &tmpint8, numBytesPerElement);
@@ -1054,23 +996,25 @@ void UAVObjectField::setValue(const QVariant &value, quint32 index)
         case ENUM: {
             qint8 tmpenum;
             if (static_cast<QMetaType::Type>(value.type()) == QMetaType::QString) {
-                int idx = options.indexOf(value.toString());
-                if (idx < 0 || idx >= indices.length()) {
+                int idx = info->options.indexOf(value.toString());
+                if (idx < 0 || idx >= info->indices.length()) {
                     Q_ASSERT(false);
-                    qWarning() << "Invalid option!" << obj->getName() << name << value.toString();
+                    qWarning() << "Invalid option!" << obj->getName() << info->name
+                               << value.toString();
                     return;
                 }
-                tmpenum = static_cast<qint8>(indices[idx]);
+                tmpenum = static_cast<qint8>(info->indices[idx]);
             } else if (value.canConvert(QMetaType::Int)) {
-                if (!indices.contains(value.toInt())) {
+                if (!info->indices.contains(value.toInt())) {
                     Q_ASSERT(false);
-                    qWarning() << "Invalid option!" << obj->getName() << name << value.toInt();
+                    qWarning() << "Invalid option!" << obj->getName() << info->name
+                               << value.toInt();
                     return;
                 }
                 tmpenum = static_cast<qint8>(value.toInt());
             } else {
                 Q_ASSERT(false);
-                qWarning() << "Invalid type!" << obj->getName() << name << value;
+                qWarning() << "Invalid type!" << obj->getName() << info->name << value;
                 return;
             }
 
@@ -1104,7 +1048,28 @@ void UAVObjectField::setValue(const QVariant &value, quint32 index)
 
 double UAVObjectField::getDouble(quint32 index)
 {
-    return getValue(index).toDouble();
+    if (index >= info->numElements)
+        return 0;
+
+    // Numeric types are read directly, without boxing into a QVariant
+    switch (info->type) {
+    case INT8:
+        return get<qint8>(index);
+    case INT16:
+        return get<qint16>(index);
+    case INT32:
+        return get<qint32>(index);
+    case UINT8:
+        return get<quint8>(index);
+    case UINT16:
+        return get<quint16>(index);
+    case UINT32:
+        return get<quint32>(index);
+    case FLOAT32:
+        return get<float>(index);
+    default:
+        return getValue(index).toDouble();
+    }
 }
 
 void UAVObjectField::setDouble(double value, quint32 index)
@@ -1114,17 +1079,17 @@ void UAVObjectField::setDouble(double value, quint32 index)
 
 QString UAVObjectField::getDescription()
 {
-    return description;
+    return info->description;
 }
 
 QVariant UAVObjectField::getDefaultValue(quint32 index)
 {
-    return defaultValues.at(index);
+    return info->defaultValues.at(index);
 }
 
 bool UAVObjectField::isDefaultValue(quint32 index)
 {
-    switch (type) {
+    switch (info->type) {
     case INT8:
     case INT16:
     case INT32: {
@@ -1159,7 +1124,7 @@ bool UAVObjectField::isDefaultValue(quint32 index)
 
 int UAVObjectField::getDisplayIntegerBase()
 {
-    switch (display) {
+    switch (info->display) {
     case HEX:
         return 16;
     case BIN:
@@ -1173,7 +1138,7 @@ int UAVObjectField::getDisplayIntegerBase()
 
 QString UAVObjectField::getDisplayPrefix()
 {
-    switch (display) {
+    switch (info->display) {
     case HEX:
         return QStringLiteral("0x");
     case BIN:
@@ -33,7 +33,9 @@
 #include <QStringList>
 #include <QVariant>
 #include <QList>
-#include <QMap>
+#include <QScopedPointer>
+#include <QVector>
+#include <cstring>
 
 class UAVObject;
 
@@ -62,8 +64,69 @@ public:
         LimitType type;
         QList<QVariant> values;
         int board;
+        // Compiled from the values when parsed, so checks are plain compares
+        bool valid;
+        double min;
+        double max;
+        QVector<double> allowed;
     } LimitStruct;
 
+    /**
+     * @brief The description of a field: name, type, elements, options,
+     * limits and defaults. It never changes, so one is made per object type
+     * and shared by all the instances of it, in every object manager.
+     */
+    class UAVOBJECTS_EXPORT Info
+    {
+    public:
+        Info(const QString &name, const QString &units, FieldType type, quint32 numElements,
+             const QStringList &options, const QList<int> &indices,
+             const QString &limits = QString(), const QString &description = QString(),
+             const QList<QVariant> defaultValues = QList<QVariant>(),
+             const DisplayType display = DEC);
+        Info(const QString &name, const QString &units, FieldType type,
+             const QStringList &elementNames, const QStringList &options,
+             const QList<int> &indices, const QString &limits = QString(),
+             const QString &description = QString(),
+             const QList<QVariant> defaultValues = QList<QVariant>(),
+             const DisplayType display = DEC);
+
+        QString name;
+        QString units;
+        FieldType type;
+        QStringList elementNames;
+        QList<int> indices;
+        QStringList options;
+        quint32 numElements;
+        quint32 numBytesPerElement;
+        // Limits of each element, as many as the limits string has
+        QVector<QVector<LimitStruct>> elementLimits;
+        QString description;
+        QList<QVariant> defaultValues;
+        DisplayType display;
+
+        /**
+         * @brief Map a value onto the number its limits are compiled to: the
+         * value itself, or the option index for ENUM fields
+         */
+        double limitKey(const QVariant &value) const;
+
+    private:
+        void constructorInitialize(const QString &name, const QString &units, FieldType type,
+                                   const QStringList &elementNames, const QStringList &options,
+                                   const QList<int> &indices, const QString &limits,
+                                   const QString &description,
+                                   const QList<QVariant> defaultValues,
+                                   const DisplayType display);
+        void limitsInitialize(const QString &limits);
+        void compileLimit(LimitStruct &limit) const;
+    };
+
+    /**
+     * @brief Make a field described by a shared Info
+     * @param info The description, must outlive the field
+     */
+    explicit UAVObjectField(const Info *info);
     UAVObjectField(const QString &name, const QString &units, FieldType type, quint32 numElements,
                    const QStringList &options, const QList<int> &indices,
                    const QString &limits = QString(), const QString &description = QString(),
@@ -77,6 +140,7 @@ public:
                    const DisplayType display = DEC);
     void initialize(quint8 *data, quint32 dataOffset, UAVObject *obj);
     UAVObject *getObject();
+    const Info *getInfo() const { return info; }
     FieldType getType();
     QString getTypeAsString();
     QString getName();
@@ -98,6 +162,70 @@ public:
     void setValue(const QVariant &data, quint32 index = 0);
     double getDouble(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
+
+    /**
+     * @brief Read an element straight from the object data, without going
+     * through a QVariant
+     * @param index The element to read
+     * T must be the storage type of the field (quint8 for ENUM fields),
+     * this is asserted.
+     */
+    template <typename T>
+    T get(quint32 index = 0) const
+    {
+        Q_ASSERT(isStorageType<T>());
+        Q_ASSERT(index < info->numElements);
+        T value;
+        memcpy(&value, &data[offset + sizeof(T) * index], sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Get the raw (numeric) value of an ENUM element, without looking
+     * up the option string
+     */
+    quint8 getRawEnum(quint32 index = 0) const { return get<quint8>(index); }
+
+    /**
+     * @brief Read-only view over all the elements of a field, reading
+     * directly from the object data
+     */
+    template <typename T>
+    class ElementView
+    {
+    public:
+        ElementView(const quint8 *base, quint32 count)
+            : base(base)
+            , count(count)
+        {
+        }
+        quint32 size() const { return count; }
+        T operator[](quint32 index) const
+        {
+            Q_ASSERT(index < count);
+            T value;
+            memcpy(&value, base + sizeof(T) * index, sizeof(T));
+            return value;
+        }
+
+    private:
+        const quint8 *base;
+        quint32 count;
+    };
+
+    template <typename T>
+    ElementView<T> elements() const
+    {
+        Q_ASSERT(isStorageType<T>());
+        return ElementView<T>(&data[offset], info->numElements);
+    }
+
+    template <typename T>
+    bool isStorageType() const
+    {
+        return info->type == storageTypeOf<T>()
+            || (info->type == ENUM && storageTypeOf<T>() == UINT8);
+    }
     quint32 getDataOffset();
     quint32 getNumBytes();
     bool isNumeric();
@@ -134,31 +262,55 @@ signals:
     void fieldUpdated(UAVObjectField *field);
 
 protected:
-    QString name;
-    QString units;
-    FieldType type;
-    QStringList elementNames;
-    QList<int> indices;
-    QStringList options;
-    quint32 numElements;
-    quint32 numBytesPerElement;
+    const Info *info;
+    // Set when the field was made without a shared description
+    QScopedPointer<const Info> ownInfo;
     quint32 offset;
     quint8 *data;
     UAVObject *obj;
-    QMap<quint32, QList<LimitStruct>> elementLimits;
-    QString description;
-    QList<QVariant> defaultValues;
-    DisplayType display;
 
     void clear();
-    void constructorInitialize(const QString &name, const QString &units, FieldType type,
-                               const QStringList &elementNames, const QStringList &options,
-                               const QList<int> &indices, const QString &limits,
-                               const QString &description, const QList<QVariant> defaultValues,
-                               const DisplayType display);
-    void limitsInitialize(const QString &limits);
+
+    template <typename T>
+    static FieldType storageTypeOf();
 };
 
+template <>
+inline UAVObjectField::FieldType UAVObjectField::storageTypeOf<qint8>()
+{
+    return INT8;
+}
+template <>
+inline UAVObjectField::FieldType UAVObjectField::storageTypeOf<qint16>()
+{
+    return INT16;
+}
+template <>
+inline UAVObjectField::FieldType UAVObjectField::storageTypeOf<qint32>()
+{
+    return INT32;
+}
+template <>
+inline UAVObjectField::FieldType UAVObjectField::storageTypeOf<quint8>()
+{
+    return UINT8;
+}
+template <>
+inline UAVObjectField::FieldType UAVObjectField::storageTypeOf<quint16>()
+{
+    return UINT16;
+}
+template <>
+inline UAVObjectField::FieldType UAVObjectField::storageTypeOf<quint32>()
+{
+    return UINT32;
+}
+template <>
+inline UAVObjectField::FieldType UAVObjectField::storageTypeOf<float>()
+{
+    return FLOAT32;
+}
+
 #endif // UAVOBJECTFIELD_H
 
 /**
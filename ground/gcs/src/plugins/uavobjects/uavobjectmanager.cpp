@@ -57,6 +57,8 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
 {
     // Check if this object type is already in the list
     quint32 objID = obj->getObjID();
+    // A lazy object gets its first instance before any other
+    materialize(objID);
     if (objects.contains(objID)) // Known object ID
     {
         if (objects.value(objID).contains(obj->getInstID())) // Instance already present
@@ -82,6 +84,7 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
                 QMap<quint32, UAVObject *> ppp;
                 ppp.insert(instidx, cobj);
                 objects[objID].insert(instidx, cobj);
+                updateInstanceIndex(objID);
                 getObject(cobj->getObjID())->emitNewInstance(cobj); // TODO??
                 emit newInstance(cobj);
             }
@@ -92,6 +95,7 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
         }
         // Add the actual object instance in the list
         objects[objID].insert(obj->getInstID(), obj);
+        updateInstanceIndex(objID);
         getObject(objID)->emitNewInstance(obj);
         emit newInstance(obj);
         return true;
@@ -113,6 +117,75 @@ bool UAVObjectManager::registerObject(UAVDataObject *obj)
     }
 }
 
+/**
+ * @brief Register an object to be created once it is needed: when it is
+ * looked up, the objects are listed or an instance of it is registered.
+ * Objects nobody uses then cost neither startup time nor memory.
+ * @param objId ID of the object
+ * @param name name of the object
+ * @param factory creates the first instance, e.g. createObject<T>
+ */
+void UAVObjectManager::registerLazyObject(quint32 objId, const QString &name,
+                                          ObjectFactory factory)
+{
+    if (objects.contains(objId) || lazyObjects.contains(objId))
+        return;
+
+    lazyObjects.insert(objId, factory);
+    lazyObjectIds.insert(name, objId);
+    lazyOrder.append(objId);
+}
+
+/**
+ * @brief Create a lazy object now, if it is one
+ * @param objId ID of the object or of its metaobject
+ */
+void UAVObjectManager::materialize(quint32 objId)
+{
+    if (lazyObjects.isEmpty())
+        return;
+
+    // Object IDs are even, their metaobject's is the next one
+    QHash<quint32, ObjectFactory>::iterator it = lazyObjects.find(objId & ~1u);
+    if (it == lazyObjects.end())
+        return;
+
+    ObjectFactory factory = it.value();
+    lazyObjects.erase(it);
+
+    UAVDataObject *obj = factory();
+    lazyObjectIds.remove(obj->getName());
+    registerObject(obj);
+}
+
+void UAVObjectManager::materialize(const QString &name)
+{
+    if (lazyObjectIds.isEmpty())
+        return;
+
+    QHash<QString, quint32>::const_iterator it = lazyObjectIds.constFind(name);
+    if (it == lazyObjectIds.constEnd() && name.endsWith(QLatin1String("Meta")))
+        it = lazyObjectIds.constFind(name.left(name.length() - 4));
+
+    if (it != lazyObjectIds.constEnd())
+        materialize(it.value());
+}
+
+/**
+ * @brief Create all lazy objects, in the order they were registered
+ */
+void UAVObjectManager::materializeAll()
+{
+    if (lazyObjects.isEmpty())
+        return;
+
+    QVector<quint32> order;
+    order.swap(lazyOrder);
+
+    foreach (quint32 objId, order)
+        materialize(objId);
+}
+
 /**
  * @brief unregisters an object instance and all instances bigger than the one passed as argument
  * from the manager
@@ -131,6 +204,7 @@ bool UAVObjectManager::unRegisterObject(UAVDataObject *obj)
             ->emitInstanceRemoved(objects.value(objID).value(x));
         emit instanceRemoved(objects.value(objID).value(x));
         objects[objID].remove(x);
+        updateInstanceIndex(objID);
     }
     return true;
 }
@@ -143,16 +217,37 @@ void UAVObjectManager::addObject(UAVObject *obj)
     objects.insert(obj->getObjID(), list);
 
     objectsByName.insert(obj->getName(), list);
+    updateInstanceIndex(obj->getObjID());
 
     emit newObject(obj);
 }
 
+/**
+ * Rebuild the dense instance array of an object ID from the instance map.
+ * Only called when instances are added or removed.
+ */
+void UAVObjectManager::updateInstanceIndex(quint32 objId)
+{
+    QHash<quint32, ObjectMap>::const_iterator it = objects.constFind(objId);
+    if (it == objects.constEnd() || it->isEmpty()) {
+        instanceIndex.remove(objId);
+        return;
+    }
+
+    QVector<UAVObject *> &vec = instanceIndex[objId];
+    vec.fill(NULL, it->lastKey() + 1);
+    for (ObjectMap::const_iterator inst = it->constBegin(); inst != it->constEnd(); ++inst)
+        vec[inst.key()] = inst.value();
+}
+
 /**
  * Get all objects. A two dimentional QVector is returned. Objects are grouped by
  * instances of the same object type.
  */
 QVector<QVector<UAVObject *>> UAVObjectManager::getObjectsVector()
 {
+    materializeAll();
+
     QVector<QVector<UAVObject *>> vector;
     foreach (const ObjectMap &map, objects.values()) {
         QVector<UAVObject *> vec = map.values().toVector();
@@ -163,6 +258,8 @@ QVector<QVector<UAVObject *>> UAVObjectManager::getObjectsVector()
 
 QHash<quint32, QMap<quint32, UAVObject *>> UAVObjectManager::getObjects()
 {
+    materializeAll();
+
     return objects;
 }
 
@@ -171,6 +268,8 @@ QHash<quint32, QMap<quint32, UAVObject *>> UAVObjectManager::getObjects()
  */
 QVector<QVector<UAVDataObject *>> UAVObjectManager::getDataObjectsVector()
 {
+    materializeAll();
+
     QVector<QVector<UAVDataObject *>> vector;
     foreach (const ObjectMap &map, objects.values()) {
         UAVDataObject *obj = dynamic_cast<UAVDataObject *>(map.first());
@@ -192,6 +291,8 @@ QVector<QVector<UAVDataObject *>> UAVObjectManager::getDataObjectsVector()
  */
 QVector<QVector<UAVMetaObject *>> UAVObjectManager::getMetaObjectsVector()
 {
+    materializeAll();
+
     QVector<QVector<UAVMetaObject *>> vector;
     foreach (const ObjectMap &map, objects.values()) {
         UAVMetaObject *obj = dynamic_cast<UAVMetaObject *>(map.first());
@@ -232,14 +333,19 @@ UAVObject *UAVObjectManager::getObject(quint32 objId, quint32 instId)
 UAVObject *UAVObjectManager::getObject(const QString &name, quint32 objId, quint32 instId)
 {
     if (name != NULL) {
+        materialize(name);
+
         if (objectsByName.contains(name)) {
             return objectsByName.value(name).value(instId);
         }
 
         return NULL;
-    } else if (objects.contains(objId))
-        return objects.value(objId).value(instId);
-    return NULL;
+    }
+
+    const QVector<UAVObject *> *instances = getObjectInstances(objId);
+    if (instances == NULL || instId >= (quint32)instances->size())
+        return NULL;
+    return instances->at(instId);
 }
 
 /**
@@ -263,6 +369,11 @@ QVector<UAVObject *> UAVObjectManager::getObjectInstancesVector(quint32 objId)
  */
 QVector<UAVObject *> UAVObjectManager::getObjectInstancesVector(const QString *name, quint32 objId)
 {
+    if (name != NULL)
+        materialize(*name);
+    else
+        materialize(objId);
+
     if (name != NULL) {
         foreach (const ObjectMap &map, objects) {
             if (map.first()->getName().compare(name) == 0)
@@ -273,6 +384,23 @@ QVector<UAVObject *> UAVObjectManager::getObjectInstancesVector(const QString *n
     return QVector<UAVObject *>();
 }
 
+/**
+ * Get the instances of an object without copying them. Entries are indexed
+ * by instance ID. The pointer is only valid until the next (un)registration.
+ * @returns The instance array or NULL if the object ID is unknown
+ */
+const QVector<UAVObject *> *UAVObjectManager::getObjectInstances(quint32 objId) const
+{
+    // Creating a lazy object doesn't change what the manager holds, as seen
+    // from outside
+    const_cast<UAVObjectManager *>(this)->materialize(objId);
+
+    QHash<quint32, QVector<UAVObject *>>::const_iterator it = instanceIndex.constFind(objId);
+    if (it == instanceIndex.constEnd())
+        return NULL;
+    return &it.value();
+}
+
 /**
  * Get the number of instances for an object given its name
  */
@@ -294,6 +422,11 @@ qint32 UAVObjectManager::getNumInstances(quint32 objId)
  */
 qint32 UAVObjectManager::getNumInstances(const QString *name, quint32 objId)
 {
+    if (name != NULL)
+        materialize(*name);
+    else
+        materialize(objId);
+
     if (name != NULL) {
         foreach (const ObjectMap &map, objects) {
             if (map.first()->getName().compare(name) == 0)
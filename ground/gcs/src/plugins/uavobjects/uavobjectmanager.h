@@ -51,7 +51,14 @@ public:
     UAVObjectManager();
     ~UAVObjectManager();
     typedef QMap<quint32, UAVObject *> ObjectMap;
+    typedef UAVDataObject *(*ObjectFactory)();
+    template <typename T>
+    static UAVDataObject *createObject()
+    {
+        return new T();
+    }
     bool registerObject(UAVDataObject *obj);
+    void registerLazyObject(quint32 objId, const QString &name, ObjectFactory factory);
     QVector<QVector<UAVObject *>> getObjectsVector();
     QHash<quint32, QMap<quint32, UAVObject *>> getObjects();
     QVector<QVector<UAVDataObject *>> getDataObjectsVector();
@@ -69,6 +76,7 @@ public:
     UAVObjectField *getField(const QString &objName, const QString &fieldName, quint32 instId = 0);
     QVector<UAVObject *> getObjectInstancesVector(const QString &name);
     QVector<UAVObject *> getObjectInstancesVector(quint32 objId);
+    const QVector<UAVObject *> *getObjectInstances(quint32 objId) const;
     qint32 getNumInstances(const QString &name);
     qint32 getNumInstances(quint32 objId);
     bool unRegisterObject(UAVDataObject *obj);
@@ -81,8 +89,19 @@ private:
     static const quint32 MAX_INSTANCES = 1000;
     QHash<quint32, QMap<quint32, UAVObject *>> objects;
     QHash<QString, QMap<quint32, UAVObject *>> objectsByName;
+    // Dense per-ID instance arrays, indexed by instance ID. Rebuilt on
+    // (un)registration so lookups on the telemetry path never copy.
+    QHash<quint32, QVector<UAVObject *>> instanceIndex;
+    // Objects registered but not created yet, see registerLazyObject()
+    QHash<quint32, ObjectFactory> lazyObjects;
+    QHash<QString, quint32> lazyObjectIds;
+    QVector<quint32> lazyOrder;
 
     void addObject(UAVObject *obj);
+    void materialize(quint32 objId);
+    void materialize(const QString &name);
+    void materializeAll();
+    void updateInstanceIndex(quint32 objId);
     UAVObject *getObject(const QString &name, quint32 objId, quint32 instId);
     QVector<UAVObject *> getObjectInstancesVector(const QString *name, quint32 objId);
     qint32 getNumInstances(const QString *name, quint32 objId);
@@ -18,6 +18,7 @@ HEADERS += uavobjects_global.h \
     uavobjectmanager.h \
     uavdataobject.h \
     uavobjectfield.h \
+    uavobjectsampler.h \
     uavobjectsinit.h \
     uavobjectsplugin.h
 
@@ -26,6 +27,7 @@ SOURCES += uavobject.cpp \
     uavobjectmanager.cpp \
     uavdataobject.cpp \
     uavobjectfield.cpp \
+    uavobjectsampler.cpp \
     uavobjectsplugin.cpp
 
 OTHER_FILES += UAVObjects.pluginspec
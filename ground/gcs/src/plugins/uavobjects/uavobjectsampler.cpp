@@ -0,0 +1,145 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsampler.cpp
+ * @author     dRonin, http://dronin.org Copyright (C) 2016
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+#include "uavobjectsampler.h"
+
+#include <QDateTime>
+
+/**
+ * Constructor
+ * @param field Field to sample, whose object must outlive the sampler
+ * @param element Index of the element in the field
+ * @param parent
+ */
+UAVObjectSampler::UAVObjectSampler(UAVObjectField *field, quint32 element, QObject *parent)
+    : QObject(parent)
+    , field(field)
+    , element(element)
+    , maxRate(0)
+    , aggregation(AGGREGATE_LAST)
+    , nextDeliveryMs(0)
+    , count(0)
+    , sum(0)
+{
+    flushTimer.setSingleShot(true);
+    connect(&flushTimer, &QTimer::timeout, this, &UAVObjectSampler::flush);
+
+    connect(field->getObject(), &UAVObject::objectUpdated, this,
+            &UAVObjectSampler::objectUpdated);
+}
+
+/**
+ * Set the maximum delivery rate
+ * @param hz Periods delivered per second, 0 to deliver every update
+ */
+void UAVObjectSampler::setMaxRate(double hz)
+{
+    if (hz == maxRate)
+        return;
+
+    maxRate = qMax(hz, 0.0);
+
+    // Don't hold a pending period for a rate that may no longer apply
+    flush();
+}
+
+void UAVObjectSampler::setAggregation(Aggregation aggregation)
+{
+    flush();
+
+    this->aggregation = aggregation;
+}
+
+void UAVObjectSampler::objectUpdated(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    double value = field->getDouble(element);
+
+    if (maxRate <= 0) {
+        emit sampled(now, value);
+        return;
+    }
+
+    // Accumulate the period
+    Extremum sample = { now, value };
+    if (count == 0 || value < min.value)
+        min = sample;
+    if (count == 0 || value > max.value)
+        max = sample;
+    last = sample;
+    sum += value;
+    count++;
+
+    // Deliver right away after a quiet period, otherwise at its end
+    if (now >= nextDeliveryMs)
+        flush();
+    else if (!flushTimer.isActive())
+        flushTimer.start(nextDeliveryMs - now);
+}
+
+/**
+ * Deliver the accumulated period, if any
+ */
+void UAVObjectSampler::flush()
+{
+    flushTimer.stop();
+
+    if (count == 0)
+        return;
+
+    switch (aggregation) {
+    case AGGREGATE_LAST:
+        emit sampled(last.timestampMs, last.value);
+        break;
+    case AGGREGATE_MEAN:
+        emit sampled(last.timestampMs, sum / count);
+        break;
+    case AGGREGATE_MIN:
+        emit sampled(min.timestampMs, min.value);
+        break;
+    case AGGREGATE_MAX:
+        emit sampled(max.timestampMs, max.value);
+        break;
+    case AGGREGATE_MINMAX:
+        if (count == 1) {
+            emit sampled(last.timestampMs, last.value);
+        } else if (min.timestampMs <= max.timestampMs) {
+            emit sampled(min.timestampMs, min.value);
+            emit sampled(max.timestampMs, max.value);
+        } else {
+            emit sampled(max.timestampMs, max.value);
+            emit sampled(min.timestampMs, min.value);
+        }
+        break;
+    }
+
+    count = 0;
+    sum = 0;
+    if (maxRate > 0)
+        nextDeliveryMs = QDateTime::currentMSecsSinceEpoch() + periodMs();
+}
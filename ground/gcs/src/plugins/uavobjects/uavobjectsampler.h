@@ -0,0 +1,99 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectsampler.h
+ * @author     dRonin, http://dronin.org Copyright (C) 2016
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVObjectsPlugin UAVObjects Plugin
+ * @{
+ * @brief      The UAVUObjects GCS plugin
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+#ifndef UAVOBJECTSAMPLER_H
+#define UAVOBJECTSAMPLER_H
+
+#include "uavobjects/uavobjects_global.h"
+#include "uavobjects/uavobject.h"
+#include "uavobjects/uavobjectfield.h"
+#include <QObject>
+#include <QTimer>
+
+/**
+ * @brief The UAVObjectSampler class Rate limited subscription to one element
+ * of an object field.
+ *
+ * Updates arriving faster than the maximum rate are aggregated over each
+ * period and delivered as a single sample, so displays that can't show every
+ * update aren't woken for each of them. Below the maximum rate every update
+ * is delivered as is.
+ */
+class UAVOBJECTS_EXPORT UAVObjectSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Aggregation {
+        AGGREGATE_LAST, /** Latest value of the period */
+        AGGREGATE_MEAN, /** Average of the period */
+        AGGREGATE_MIN, /** Smallest value of the period */
+        AGGREGATE_MAX, /** Largest value of the period */
+        AGGREGATE_MINMAX /** Smallest and largest values, in the order they came */
+    };
+
+    UAVObjectSampler(UAVObjectField *field, quint32 element, QObject *parent = 0);
+
+    void setMaxRate(double hz);
+    double getMaxRate() const { return maxRate; }
+    void setAggregation(Aggregation aggregation);
+
+signals:
+    /**
+     * @brief Signal sent for each delivered sample
+     * @param timestampMs When the sample was taken, in ms since the epoch
+     * @param value Value of the element, aggregated when rate limited
+     */
+    void sampled(qint64 timestampMs, double value);
+
+private slots:
+    void objectUpdated(UAVObject *obj);
+    void flush();
+
+private:
+    struct Extremum
+    {
+        qint64 timestampMs;
+        double value;
+    };
+
+    UAVObjectField *field;
+    quint32 element;
+    double maxRate; // 0 when every update is delivered
+    Aggregation aggregation;
+
+    QTimer flushTimer;
+    qint64 nextDeliveryMs; // Earliest time the next period may be delivered
+    quint32 count;
+    double sum;
+    Extremum last;
+    Extremum min;
+    Extremum max;
+
+    qint64 periodMs() const { return (qint64)(1000.0 / maxRate); }
+};
+
+#endif // UAVOBJECTSAMPLER_H
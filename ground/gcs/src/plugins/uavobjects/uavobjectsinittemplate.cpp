@@ -33,7 +33,8 @@
 $(OBJINC)
 
 /**
- * Function used to initialize the first instance of each object.
+ * Function used to register each object; the first instance of an object is
+ * created when it is first used.
  * This file is automatically updated by the UAVObjectGenerator.
  */
 void UAVObjectsInitialize(UAVObjectManager* objMngr)
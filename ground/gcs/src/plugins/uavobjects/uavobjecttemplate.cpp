@@ -44,14 +44,26 @@ const QString $(NAME)::CATEGORY = QString("$(CATEGORY)");
 const QHash<QString, QString> $(NAME)::FIELD_DESCRIPTIONS{
 $(FIELDDESCRIPTIONS_STRINGS)};
 
+/**
+ * Describe the fields, this is done once for all the instances
+ */
+QList<const UAVObjectField::Info*> $(NAME)::createFieldInfos()
+{
+    QList<const UAVObjectField::Info*> infos;
+$(FIELDSINIT)
+    return infos;
+}
+
 /**
  * Constructor
  */
 $(NAME)::$(NAME)(): UAVDataObject(OBJID, ISSINGLEINST, ISSETTINGS, NAME)
 {
-    // Create fields
+    // Create fields, sharing their descriptions with the other instances
+    static const QList<const UAVObjectField::Info*> fieldInfos = createFieldInfos();
     QList<UAVObjectField*> fields;
-$(FIELDSINIT)
+    foreach (const UAVObjectField::Info* info, fieldInfos)
+        fields.append(new UAVObjectField(info));
     // Initialize object
     initializeFields(fields, (quint8*)&data, NUMBYTES);
     // Set the default field values
@@ -99,6 +99,7 @@ private:
     DataFields data;
 
     void setDefaultFieldValues();
+    static QList<const UAVObjectField::Info*> createFieldInfos();
 
 };
 
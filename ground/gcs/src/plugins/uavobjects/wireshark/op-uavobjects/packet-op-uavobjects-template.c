@@ -49,9 +49,11 @@ $(ENUMFIELDNAMES)
 
 void proto_reg_handoff_op_uavobjects_$(NAMELC)(void);
 
-static int dissect_uavo(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data _U_)
+static int dissect_uavo(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void *data)
 {
   int offset = 0;
+  /* Field mask of a partial object, NULL when all fields are present */
+  const guint32 *field_mask = (const guint32 *) data;
 
   col_append_str(pinfo->cinfo, COL_INFO, "($(NAME))");
 		  
@@ -109,4 +111,9 @@ void proto_reg_handoff_op_uavobjects_$(NAMELC)(void)
 
    /* Bind this protocol to its UAV ObjID in UAVTalk */
    dissector_add_uint("uavtalk.objid", $(OBJIDHEX), uavo_handle);
+
+   /* Let UAVTalk know the frames of this object carry an instance ID */
+   if (!$(ISSINGLEINST)) {
+      dissector_add_uint("uavtalk.multiinst", $(OBJIDHEX), uavo_handle);
+   }
 }
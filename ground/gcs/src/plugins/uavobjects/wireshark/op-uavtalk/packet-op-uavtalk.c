@@ -43,15 +43,40 @@ static gint ett_op_uavtalk = -1;
 
 static dissector_handle_t data_handle;
 static dissector_table_t uavtalk_subdissector_table;
+static dissector_table_t uavtalk_multiinst_table;
 
 static int hf_op_uavtalk_sync = -1;
 static int hf_op_uavtalk_version = -1;
 static int hf_op_uavtalk_type = -1;
 static int hf_op_uavtalk_len = -1;
 static int hf_op_uavtalk_objid = -1;
+static int hf_op_uavtalk_instid = -1;
+static int hf_op_uavtalk_timestamp = -1;
+static int hf_op_uavtalk_fieldmask = -1;
+static int hf_op_uavtalk_meta_flags = -1;
+static int hf_op_uavtalk_meta_telemetry_period = -1;
+static int hf_op_uavtalk_meta_gcs_period = -1;
+static int hf_op_uavtalk_meta_logging_period = -1;
+static int hf_op_uavtalk_file_offset = -1;
+static int hf_op_uavtalk_filereq_flags = -1;
+static int hf_op_uavtalk_filedata_flags = -1;
 static int hf_op_uavtalk_crc8 = -1;
 
 #define UAVTALK_SYNC_VAL 0x3C
+#define UAVTALK_TIMESTAMPED 0x80
+#define UAVTALK_TIMESTAMP_SIZE 2
+#define UAVTALK_INSTID_SIZE 2
+#define UAVTALK_TYPE_OBJ 0x00
+#define UAVTALK_TYPE_OBJ_REQ 0x01
+#define UAVTALK_TYPE_OBJ_ACK 0x02
+#define UAVTALK_TYPE_ACK 0x03
+#define UAVTALK_TYPE_NACK 0x04
+#define UAVTALK_TYPE_FILEREQ 0x08
+#define UAVTALK_TYPE_FILEDATA 0x09
+#define UAVTALK_TYPE_OBJ_PARTIAL 0x0C
+#define UAVTALK_FIELDMASK_SIZE 4
+/* File offset and flags */
+#define UAVTALK_FILEDATA_HEADER_SIZE 5
 
 static const value_string uavtalk_packet_types[]={
   { 0, "TxObj"      },
@@ -59,6 +84,9 @@ static const value_string uavtalk_packet_types[]={
   { 2, "SetObjAckd" },
   { 3, "Ack"        },
   { 4, "Nack"       },
+  { 8, "FileReq"    },
+  { 9, "FileData"   },
+  { 12, "TxObjPartial" },
   { 0, NULL         }
 };
 
@@ -70,10 +98,13 @@ static int dissect_op_uavtalk(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tre
 {
   gint offset = 0;
 
-  guint8 packet_type = tvb_get_guint8(tvb, 1) & 0x7;
+  guint8 packet_type = tvb_get_guint8(tvb, 1) & 0xf;
+  gboolean timestamped = (tvb_get_guint8(tvb, 1) & UAVTALK_TIMESTAMPED) != 0;
   guint32 objid = tvb_get_letohl(tvb, 4);
-  guint32 payload_length = tvb_get_letohs(tvb, 2) - UAVTALK_HEADER_SIZE - UAVTALK_TRAILER_SIZE;
+  guint32 payload_length = tvb_get_letohs(tvb, 2) - UAVTALK_HEADER_SIZE;
   guint32 reported_length = tvb_reported_length(tvb);
+  gboolean instanced = FALSE;
+  proto_tree *op_uavtalk_tree = NULL;
 
   col_set_str(pinfo->cinfo, COL_PROTOCOL, "UAVTALK");
   /* Clear out stuff in the info column */
@@ -86,7 +117,6 @@ static int dissect_op_uavtalk(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tre
 
 
   if (tree) { /* we are being asked for details */
-    proto_tree *op_uavtalk_tree = NULL;
     ptvcursor_t * cursor;
     proto_item *ti = NULL;
 
@@ -115,20 +145,73 @@ static int dissect_op_uavtalk(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tre
     offset = UAVTALK_HEADER_SIZE;
   }
 
-  {
-    tvbuff_t * next_tvb = tvb_new_subset(tvb, offset,
-					 reported_length - UAVTALK_HEADER_SIZE - UAVTALK_TRAILER_SIZE,
-					 payload_length);
-
-    /* Check if we have an embedded objid to decode */
-    if ((packet_type == 0) || (packet_type == 2)) {
-      /* Call any registered subdissector for this objid */
-      if (!dissector_try_uint(uavtalk_subdissector_table, objid, next_tvb, pinfo, tree)) {
-	/* No subdissector registered, use the default data dissector */
-	call_dissector(data_handle, next_tvb, pinfo, tree);
+  /* Requests carry an instance ID exactly when they have a payload, object
+   * frames when the object registered itself as multi-instance */
+  if (packet_type == UAVTALK_TYPE_OBJ_REQ || packet_type == UAVTALK_TYPE_ACK ||
+      packet_type == UAVTALK_TYPE_NACK) {
+    instanced = (payload_length == UAVTALK_INSTID_SIZE);
+  } else if (packet_type == UAVTALK_TYPE_OBJ || packet_type == UAVTALK_TYPE_OBJ_ACK ||
+	     packet_type == UAVTALK_TYPE_OBJ_PARTIAL) {
+    instanced = !(objid & 0x1) &&
+      dissector_get_uint_handle(uavtalk_multiinst_table, objid) != NULL;
+  }
+
+  if (instanced) {
+    if (tree) {
+      proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_instid, tvb, offset, UAVTALK_INSTID_SIZE, ENC_LITTLE_ENDIAN);
+    }
+    offset += UAVTALK_INSTID_SIZE;
+  }
+
+  if (timestamped && packet_type != UAVTALK_TYPE_FILEDATA) {
+    if (tree) {
+      proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_timestamp, tvb, offset, UAVTALK_TIMESTAMP_SIZE, ENC_LITTLE_ENDIAN);
+    }
+    offset += UAVTALK_TIMESTAMP_SIZE;
+  }
+
+  if (packet_type == UAVTALK_TYPE_FILEREQ) {
+    if (tree) {
+      proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_file_offset, tvb, offset, 4, ENC_LITTLE_ENDIAN);
+      proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_filereq_flags, tvb, offset + 4, 2, ENC_LITTLE_ENDIAN);
+    }
+  } else if (packet_type == UAVTALK_TYPE_FILEDATA) {
+    gint data_length = reported_length - offset - UAVTALK_FILEDATA_HEADER_SIZE - UAVTALK_TRAILER_SIZE;
+
+    if (tree) {
+      proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_file_offset, tvb, offset, 4, ENC_LITTLE_ENDIAN);
+      proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_filedata_flags, tvb, offset + 4, 1, ENC_LITTLE_ENDIAN);
+    }
+    offset += UAVTALK_FILEDATA_HEADER_SIZE;
+    call_dissector(data_handle, tvb_new_subset(tvb, offset, data_length, data_length), pinfo, tree);
+  } else if (packet_type == UAVTALK_TYPE_OBJ_PARTIAL) {
+    /* The mask of the fields present in the payload comes first */
+    guint32 field_mask = tvb_get_letohl(tvb, offset);
+    gint data_offset = offset + UAVTALK_FIELDMASK_SIZE;
+    gint data_length = reported_length - data_offset - UAVTALK_TRAILER_SIZE;
+    tvbuff_t * next_tvb = tvb_new_subset(tvb, data_offset, data_length, data_length);
+
+    if (tree) {
+      proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_fieldmask, tvb, offset, UAVTALK_FIELDMASK_SIZE, ENC_LITTLE_ENDIAN);
+    }
+
+    if (!dissector_try_uint_new(uavtalk_subdissector_table, objid, next_tvb, pinfo, tree, TRUE, &field_mask)) {
+      call_dissector(data_handle, next_tvb, pinfo, tree);
+    }
+  } else if (packet_type == UAVTALK_TYPE_OBJ || packet_type == UAVTALK_TYPE_OBJ_ACK) {
+    gint data_length = reported_length - offset - UAVTALK_TRAILER_SIZE;
+    tvbuff_t * next_tvb = tvb_new_subset(tvb, offset, data_length, data_length);
+
+    if (objid & 0x1) {
+      /* Metaobjects all share one layout */
+      if (tree) {
+	proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_meta_flags, tvb, offset, 1, ENC_LITTLE_ENDIAN);
+	proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_meta_telemetry_period, tvb, offset + 1, 2, ENC_LITTLE_ENDIAN);
+	proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_meta_gcs_period, tvb, offset + 3, 2, ENC_LITTLE_ENDIAN);
+	proto_tree_add_item(op_uavtalk_tree, hf_op_uavtalk_meta_logging_period, tvb, offset + 5, 2, ENC_LITTLE_ENDIAN);
       }
-    } else {
-      /* Render any remaining data as raw bytes */
+    } else if (!dissector_try_uint(uavtalk_subdissector_table, objid, next_tvb, pinfo, tree)) {
+      /* No subdissector registered, use the default data dissector */
       call_dissector(data_handle, next_tvb, pinfo, tree);
     }
   }
@@ -147,11 +230,11 @@ void proto_register_op_uavtalk(void)
      },
      { &hf_op_uavtalk_version,
        { "Version", "uavtalk.ver", FT_UINT8,
-	 BASE_DEC, NULL, 0xf8, NULL, HFILL }
+	 BASE_DEC, NULL, 0xf0, NULL, HFILL }
      },
      { &hf_op_uavtalk_type,
        { "Type", "uavtalk.type", FT_UINT8,
-	 BASE_HEX, VALS(uavtalk_packet_types), 0x07, NULL, HFILL }
+	 BASE_HEX, VALS(uavtalk_packet_types), 0x0f, NULL, HFILL }
      },
      { &hf_op_uavtalk_len,
        { "Length", "uavtalk.len", FT_UINT16,
@@ -161,6 +244,46 @@ void proto_register_op_uavtalk(void)
        { "ObjID", "uavtalk.objid", FT_UINT32,
 	 BASE_HEX, NULL, 0x0, NULL, HFILL }
      },
+     { &hf_op_uavtalk_instid,
+       { "InstID", "uavtalk.instid", FT_UINT16,
+	 BASE_DEC, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_timestamp,
+       { "Timestamp", "uavtalk.timestamp", FT_UINT16,
+	 BASE_DEC, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_fieldmask,
+       { "FieldMask", "uavtalk.fieldmask", FT_UINT32,
+	 BASE_HEX, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_meta_flags,
+       { "Flags", "uavtalk.meta.flags", FT_UINT8,
+	 BASE_HEX, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_meta_telemetry_period,
+       { "TelemetryUpdatePeriod", "uavtalk.meta.telemetryperiod", FT_UINT16,
+	 BASE_DEC, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_meta_gcs_period,
+       { "GCSTelemetryUpdatePeriod", "uavtalk.meta.gcsperiod", FT_UINT16,
+	 BASE_DEC, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_meta_logging_period,
+       { "LoggingUpdatePeriod", "uavtalk.meta.loggingperiod", FT_UINT16,
+	 BASE_DEC, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_file_offset,
+       { "FileOffset", "uavtalk.file.offset", FT_UINT32,
+	 BASE_DEC, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_filereq_flags,
+       { "FileReqFlags", "uavtalk.filereq.flags", FT_UINT16,
+	 BASE_HEX, NULL, 0x0, NULL, HFILL }
+     },
+     { &hf_op_uavtalk_filedata_flags,
+       { "FileDataFlags", "uavtalk.filedata.flags", FT_UINT8,
+	 BASE_HEX, NULL, 0x0, NULL, HFILL }
+     },
      { &hf_op_uavtalk_crc8,
        { "Crc8", "uavtalk.crc8", FT_UINT8,
 	 BASE_HEX, NULL, 0x0, NULL, HFILL }
@@ -179,6 +302,8 @@ void proto_register_op_uavtalk(void)
 
    /* Allow subdissectors for each objid to bind for decoding */
    uavtalk_subdissector_table = register_dissector_table("uavtalk.objid", "UAVObject ID", FT_UINT32, BASE_HEX);
+   /* Multi-instance objects also bind here, so the instance ID is found */
+   uavtalk_multiinst_table = register_dissector_table("uavtalk.multiinst", "Multi-instance UAVObject ID", FT_UINT32, BASE_HEX);
 
    proto_register_subtree_array(ett, array_length(ett));
    proto_register_field_array(proto_op_uavtalk, hf, array_length(hf));
@@ -39,6 +39,7 @@
 #include <QEventLoop>
 #include <QTimer>
 #include <QRegularExpression>
+#include <string.h>
 #include <objectpersistence.h>
 
 #include "firmwareiapobj.h"
@@ -68,6 +69,19 @@ UAVObjectUtilManager::UAVObjectUtilManager()
     if (pm) {
         obm = pm->getObject<UAVObjectManager>();
     }
+
+    memset(&firmwareIapData, 0, sizeof(firmwareIapData));
+    boardDescriptionValid = false;
+
+    FirmwareIAPObj *firmwareIap = obm ? FirmwareIAPObj::GetInstance(obm) : NULL;
+    if (firmwareIap) {
+        // Unpacked comes first, so the board answering is told about once
+        connect(firmwareIap, &UAVObject::objectUnpacked, this,
+                &UAVObjectUtilManager::firmwareIapUnpacked);
+        connect(firmwareIap, &UAVObject::objectUpdated, this,
+                &UAVObjectUtilManager::firmwareIapUpdated);
+        refreshBoardInfo();
+    }
 }
 
 UAVObjectUtilManager::~UAVObjectUtilManager()
@@ -107,6 +121,10 @@ UAVObjectManager *UAVObjectUtilManager::getObjectManager()
  *    once the operation is completed. We need therefore to listen to updates on the
  * objectPersistence
  *    object, and check the "Operation" field, which should be set to "completed", or "error".
+ *
+ * Objects queued together are saved with one "SaveList" request, of up to OBJECTIDS_NUMELEM
+ * objects, which the board writes to flash in one go. The queue is started from the event loop,
+ * so all objects queued in a row, e.g. a whole configuration, make it into the same requests.
  */
 void UAVObjectUtilManager::saveObjectToFlash(UAVObject *obj)
 {
@@ -114,10 +132,27 @@ void UAVObjectUtilManager::saveObjectToFlash(UAVObject *obj)
     queue.enqueue(obj);
     UAVOBJECTUTIL_QXTLOG_DEBUG(QString("Enqueue object:%0").arg(obj->getName()));
 
-    // If queue length is one, then start sending (call sendNextObject)
-    // Otherwise, do nothing, because we are already sending.
-    if (queue.length() == 1)
-        saveNextObject();
+    // If nothing is being saved, start sending once the caller is done queueing.
+    // Otherwise, do nothing, the queue is picked up when the current save completes.
+    if (saveState == IDLE && queue.length() == 1)
+        QTimer::singleShot(0, this, &UAVObjectUtilManager::saveNextObject);
+}
+
+/**
+ * @brief Whether the board can save an object as part of a SaveList request, which takes
+ * instance 0 of objects it knows only
+ */
+static bool canSaveInList(UAVObject *obj)
+{
+    if (obj->getInstID() != 0)
+        return false;
+
+    UAVMetaObject *meta = qobject_cast<UAVMetaObject *>(obj);
+    if (meta)
+        obj = meta->getParentObject();
+
+    UAVDataObject *dobj = qobject_cast<UAVDataObject *>(obj);
+    return dobj && dobj->getIsPresentOnHardware();
 }
 
 /**
@@ -127,16 +162,23 @@ void UAVObjectUtilManager::saveObjectToFlash(UAVObject *obj)
  */
 void UAVObjectUtilManager::saveNextObject()
 {
-    if (queue.isEmpty()) {
+    if (queue.isEmpty() || saveState != IDLE) {
         return;
     }
 
-    Q_ASSERT(saveState == IDLE);
-
-    // Get next object from the queue (don't dequeue yet)
-    UAVObject *obj = queue.head();
+    // Take the next objects from the queue, as many as fit in a request
+    savingObjects.clear();
+    savingObjects.append(queue.dequeue());
+    if (canSaveInList(savingObjects.first())) {
+        while (!queue.isEmpty() && canSaveInList(queue.head())
+               && savingObjects.size() < (int)ObjectPersistence::OBJECTIDS_NUMELEM)
+            savingObjects.append(queue.dequeue());
+    }
+    UAVObject *obj = savingObjects.first();
     Q_ASSERT(obj);
-    UAVOBJECTUTIL_QXTLOG_DEBUG(QString("Send save object request to board %0").arg(obj->getName()));
+    UAVOBJECTUTIL_QXTLOG_DEBUG(QString("Send save request for %0 objects to board, first %1")
+                                   .arg(savingObjects.size())
+                                   .arg(obj->getName()));
 
     ObjectPersistence *objectPersistence = ObjectPersistence::GetInstance(getObjectManager());
     Q_ASSERT(objectPersistence);
@@ -161,9 +203,16 @@ void UAVObjectUtilManager::saveNextObject()
     UAVOBJECTUTIL_QXTLOG_DEBUG(QString("[saveObjectToFlash] Moving on to AWAITING_ACK"));
 
     ObjectPersistence::DataFields data;
-    data.Operation = ObjectPersistence::OPERATION_SAVE;
+    memset(&data, 0, sizeof(data));
     data.ObjectID = obj->getObjID();
     data.InstanceID = obj->getInstID();
+    if (savingObjects.size() > 1) {
+        data.Operation = ObjectPersistence::OPERATION_SAVELIST;
+        for (int i = 0; i < savingObjects.size(); i++)
+            data.ObjectIDs[i] = savingObjects.at(i)->getObjID();
+    } else {
+        data.Operation = ObjectPersistence::OPERATION_SAVE;
+    }
     objectPersistence->setData(data);
     objectPersistence->updated();
     // Now: we are going to get the following:
@@ -215,12 +264,8 @@ void UAVObjectUtilManager::objectPersistenceTransactionCompleted(UAVObject *obj,
         Q_ASSERT(objectPersistence);
 
         objectPersistence->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it failed anyway.
         saveState = IDLE;
-        // Careful below: objectPersistence contains a field 'ObjectID' that corresponds to
-        // the objectID we wanted to save. Don't confuse with the OBJID of the Objectpersistence
-        // UAVO itself!
-        emit saveCompleted(objectPersistence->getObjectID(), false);
+        finishSave(false); // We can now remove the objects, they failed anyway.
         saveNextObject();
     }
 }
@@ -236,13 +281,10 @@ void UAVObjectUtilManager::objectPersistenceOperationFailed()
         ObjectPersistence *objectPersistence = ObjectPersistence::GetInstance(getObjectManager());
         Q_ASSERT(objectPersistence);
 
-        UAVObject *obj = queue.dequeue(); // We can now remove the object, it failed anyway.
-        Q_ASSERT(obj);
-
         objectPersistence->disconnect(this);
 
         saveState = IDLE;
-        emit saveCompleted(obj->getObjID(), false);
+        finishSave(false); // We can now remove the objects, they failed anyway.
 
         saveNextObject();
     }
@@ -271,21 +313,32 @@ void UAVObjectUtilManager::objectPersistenceUpdated(UAVObject *obj)
     } else if (objectPersistence.Operation == ObjectPersistence::OPERATION_COMPLETED) {
         failureTimer.stop();
         // Check right object saved
-        UAVObject *savingObj = queue.head();
+        UAVObject *savingObj = savingObjects.first();
         if (objectPersistence.ObjectID != savingObj->getObjID()) {
             objectPersistenceOperationFailed();
             return;
         }
 
         obj->disconnect(this);
-        queue.dequeue(); // We can now remove the object, it's done.
         saveState = IDLE;
         UAVOBJECTUTIL_QXTLOG_DEBUG(QString("[saveObjectToFlash] Object save succeeded"));
-        emit saveCompleted(objectPersistence.ObjectID, true);
+        finishSave(true); // We can now remove the objects, they're done.
         saveNextObject();
     }
 }
 
+/**
+ * @brief Report the result of the save request for each object in it
+ */
+void UAVObjectUtilManager::finishSave(bool success)
+{
+    QList<UAVObject *> saved = savingObjects;
+    savingObjects.clear();
+
+    foreach (UAVObject *obj, saved)
+        emit saveCompleted(obj->getObjID(), success);
+}
+
 /**
  * @brief UAVObjectUtilManager::readAllNonSettingsMetadata Convenience function for calling
  * readMetadata
@@ -362,7 +415,7 @@ bool UAVObjectUtilManager::setAllNonSettingsMetadata(
 bool UAVObjectUtilManager::setMetadata(QMap<QString, UAVObject::Metadata> metaDataSetList,
                                        metadataSetEnum metadataSetType)
 {
-    if (!metadataSendlist.isEmpty())
+    if (!metadataSendlist.isEmpty() || !metadataInFlight.isEmpty())
         return false;
     // Load all metadata objects.
     UAVObjectManager *objManager = getObjectManager();
@@ -397,16 +450,31 @@ bool UAVObjectUtilManager::setMetadata(QMap<QString, UAVObject::Metadata> metaDa
         emit completedMetadataWrite(true);
         return true;
     }
-    UAVDataObject *obj = metadataSendlist.keys().first();
-
-    // Connect transaction and timeout timers before making the request
-    connect(obj->getMetaObject(), SIGNAL(transactionCompleted(UAVObject *, bool)), this,
-            SLOT(metadataTransactionCompleted(UAVObject *, bool)), Qt::UniqueConnection);
-    obj->setMetadata(metadataSendlist.value(obj));
+    sendNextMetadata();
 
     return true;
 }
 
+/**
+ * @brief UAVObjectUtilManager::sendNextMetadata Keeps up to METADATA_WINDOW metadata writes
+ * outstanding. Waiting for each ack before sending the next one costs a round trip per
+ * object, which over a radio makes a full schedule change take minutes. The window stays
+ * below the telemetry queue length so no update gets dropped there.
+ */
+void UAVObjectUtilManager::sendNextMetadata()
+{
+    while (!metadataSendlist.isEmpty() && metadataInFlight.size() < METADATA_WINDOW) {
+        UAVDataObject *obj = metadataSendlist.firstKey();
+        UAVObject::Metadata mdata = metadataSendlist.take(obj);
+        metadataInFlight.append(obj);
+
+        // Connect transaction and timeout timers before making the request
+        connect(obj->getMetaObject(), SIGNAL(transactionCompleted(UAVObject *, bool)), this,
+                SLOT(metadataTransactionCompleted(UAVObject *, bool)), Qt::UniqueConnection);
+        obj->setMetadata(mdata);
+    }
+}
+
 /**
  * @brief UAVObjectUtilManager::resetMetadata Resets all metadata to defaults (from XML definitions)
  * @return
@@ -443,7 +511,7 @@ void UAVObjectUtilManager::metadataTransactionCompleted(UAVObject *uavoObject, b
     UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(mobj->getParentObject());
     Q_ASSERT(mobj);
     Q_ASSERT(dobj);
-    if (metadataSendlist.contains(dobj)) {
+    if (metadataInFlight.contains(dobj)) {
         if (success) {
             UAVOBJECTUTIL_QXTLOG_DEBUG(
                 QString("Writing metadata succeded on %0").arg(uavoObject->getName()));
@@ -451,37 +519,65 @@ void UAVObjectUtilManager::metadataTransactionCompleted(UAVObject *uavoObject, b
             // If unsuccessful
             metadataSendSuccess = false;
             UAVOBJECTUTIL_QXTLOG_DEBUG(
-                QString("metadata send failed").arg(metadataSendlist.keys().first()->getName()));
+                QString("metadata send failed on %0").arg(uavoObject->getName()));
         }
         disconnect(mobj, SIGNAL(transactionCompleted(UAVObject *, bool)), this,
                    SLOT(metadataTransactionCompleted(UAVObject *, bool)));
-        metadataSendlist.take(dobj);
-        if (!metadataSendlist.keys().isEmpty()) {
-            metadataSendlist.keys().first()->setMetadata(
-                metadataSendlist.value(metadataSendlist.keys().first()));
-            connect(metadataSendlist.keys().first()->getMetaObject(),
-                    SIGNAL(transactionCompleted(UAVObject *, bool)), this,
-                    SLOT(metadataTransactionCompleted(UAVObject *, bool)), Qt::UniqueConnection);
-            return;
-        } else {
+        metadataInFlight.removeAll(dobj);
+        sendNextMetadata();
+        if (metadataInFlight.isEmpty())
             emit completedMetadataWrite(metadataSendSuccess);
-        }
     }
 }
 
 /**
-  * Helper function that makes sure FirmwareIAP is updated and then returns the data
+  * Helper function that returns the FirmwareIAP data, as of its last update
   */
 FirmwareIAPObj::DataFields UAVObjectUtilManager::getFirmwareIap()
 {
-    FirmwareIAPObj::DataFields dummy;
+    return firmwareIapData;
+}
 
+/**
+ * @brief Keep a decoded copy of the board identity, so the gadgets asking for
+ * it on connect don't each read and parse FirmwareIAPObj again
+ * @return true if the identity changed
+ */
+bool UAVObjectUtilManager::refreshBoardInfo()
+{
     FirmwareIAPObj *firmwareIap = FirmwareIAPObj::GetInstance(obm);
-    Q_ASSERT(firmwareIap);
-    if (!firmwareIap)
-        return dummy;
+    FirmwareIAPObj::DataFields data = firmwareIap->getData();
+
+    // Commands to the IAP module don't change which board it is
+    bool changed = data.BoardType != firmwareIapData.BoardType
+        || data.BoardRevision != firmwareIapData.BoardRevision
+        || data.crc != firmwareIapData.crc
+        || memcmp(data.CPUSerial, firmwareIapData.CPUSerial, sizeof(data.CPUSerial))
+        || memcmp(data.Description, firmwareIapData.Description, sizeof(data.Description));
+
+    if (memcmp(data.Description, firmwareIapData.Description, sizeof(data.Description))
+        || !boardDescriptionValid) {
+        QByteArray description((const char *)data.Description, sizeof(data.Description));
+        boardDescriptionValid = descriptionToStructure(description, boardDescription);
+    }
+
+    firmwareIapData = data;
+
+    return changed;
+}
 
-    return firmwareIap->getData();
+//! The board sent FirmwareIAPObj, which the telemetry monitor asks for on connect
+void UAVObjectUtilManager::firmwareIapUnpacked()
+{
+    refreshBoardInfo();
+    emit boardInfoChanged();
+}
+
+//! Local changes, e.g. clearing the board type to reboot it
+void UAVObjectUtilManager::firmwareIapUpdated()
+{
+    if (refreshBoardInfo())
+        emit boardInfoChanged();
 }
 
 /**
@@ -493,7 +589,6 @@ FirmwareIAPObj::DataFields UAVObjectUtilManager::getFirmwareIap()
   */
 int UAVObjectUtilManager::getBoardModel()
 {
-    FirmwareIAPObj::DataFields firmwareIapData = getFirmwareIap();
     int ret = firmwareIapData.BoardType << 8;
     ret = ret + firmwareIapData.BoardRevision;
     return ret;
@@ -502,9 +597,7 @@ int UAVObjectUtilManager::getBoardModel()
 //! Get the connected board hardware revision
 int UAVObjectUtilManager::getBoardRevision()
 {
-    FirmwareIAPObj::DataFields firmwareIapData = getFirmwareIap();
-    int ret = firmwareIapData.BoardRevision;
-    return ret;
+    return firmwareIapData.BoardRevision;
 }
 
 //! Get the IBoardType corresponding to the connected board
@@ -524,18 +617,11 @@ Core::IBoardType *UAVObjectUtilManager::getBoardType()
   */
 QByteArray UAVObjectUtilManager::getBoardCPUSerial()
 {
-    QByteArray cpuSerial;
-    FirmwareIAPObj::DataFields firmwareIapData = getFirmwareIap();
-
-    for (unsigned int i = 0; i < FirmwareIAPObj::CPUSERIAL_NUMELEM; i++)
-        cpuSerial.append(firmwareIapData.CPUSerial[i]);
-
-    return cpuSerial;
+    return QByteArray((const char *)firmwareIapData.CPUSerial, FirmwareIAPObj::CPUSERIAL_NUMELEM);
 }
 
 quint32 UAVObjectUtilManager::getFirmwareCRC()
 {
-    FirmwareIAPObj::DataFields firmwareIapData = getFirmwareIap();
     return firmwareIapData.crc;
 }
 
@@ -544,13 +630,8 @@ quint32 UAVObjectUtilManager::getFirmwareCRC()
   */
 QByteArray UAVObjectUtilManager::getBoardDescription()
 {
-    QByteArray ret;
-    FirmwareIAPObj::DataFields firmwareIapData = getFirmwareIap();
-
-    for (unsigned int i = 0; i < FirmwareIAPObj::DESCRIPTION_NUMELEM; i++)
-        ret.append(firmwareIapData.Description[i]);
-
-    return ret;
+    return QByteArray((const char *)firmwareIapData.Description,
+                      FirmwareIAPObj::DESCRIPTION_NUMELEM);
 }
 
 // ******************************
@@ -660,8 +741,11 @@ int UAVObjectUtilManager::getGPSPosition(double LLA[3])
 
 bool UAVObjectUtilManager::getBoardDescriptionStruct(deviceDescriptorStruct &device)
 {
-    bool ret = descriptionToStructure(getBoardDescription(), device);
-    return ret;
+    // Parsed when FirmwareIAPObj was updated
+    if (boardDescriptionValid)
+        device = boardDescription;
+
+    return boardDescriptionValid;
 }
 
 bool UAVObjectUtilManager::descriptionToStructure(QByteArray desc, deviceDescriptorStruct &struc)
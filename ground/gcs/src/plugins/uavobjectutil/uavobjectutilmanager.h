@@ -85,21 +85,38 @@ protected:
 signals:
     void saveCompleted(int objectID, bool status);
     void completedMetadataWrite(bool);
+    //! The board identity was read from the board, i.e. once per connection, or changed
+    void boardInfoChanged();
 
 private:
+    //! Metadata writes outstanding at once, below the telemetry queue length
+    static const int METADATA_WINDOW = 8;
+
     QQueue<UAVObject *> queue;
+    QList<UAVObject *> savingObjects;
     enum { IDLE, AWAITING_ACK, AWAITING_COMPLETED } saveState;
     void saveNextObject();
+    void finishSave(bool success);
     QTimer failureTimer;
     ExtensionSystem::PluginManager *pm;
     UAVObjectManager *obm;
     QMap<UAVDataObject *, UAVObject::Metadata> metadataSendlist;
+    QList<UAVDataObject *> metadataInFlight;
     bool metadataSendSuccess;
+    void sendNextMetadata();
+
+    // Board identity from FirmwareIAPObj, decoded once per update of the object
+    FirmwareIAPObj::DataFields firmwareIapData;
+    deviceDescriptorStruct boardDescription;
+    bool boardDescriptionValid;
+    bool refreshBoardInfo();
 private slots:
     void objectPersistenceTransactionCompleted(UAVObject *obj, bool success);
     void objectPersistenceUpdated(UAVObject *obj);
     void objectPersistenceOperationFailed();
     void metadataTransactionCompleted(UAVObject *, bool);
+    void firmwareIapUpdated();
+    void firmwareIapUnpacked();
 };
 
 #endif
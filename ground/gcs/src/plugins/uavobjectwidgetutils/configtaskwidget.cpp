@@ -50,7 +50,7 @@ ConfigTaskWidget::ConfigTaskWidget(QWidget *parent)
     , smartsave(NULL)
     , dirty(false)
     , outOfLimitsStyle("background-color: rgb(255, 180, 0);")
-    , timeOut(NULL)
+    , fetchSuccess(true)
 {
     pm = ExtensionSystem::PluginManager::instance();
     objManager = pm->getObject<UAVObjectManager>();
@@ -62,6 +62,12 @@ ConfigTaskWidget::ConfigTaskWidget(QWidget *parent)
     connect(telMngr, SIGNAL(connected()), this, SIGNAL(autoPilotConnected()), Qt::UniqueConnection);
     connect(telMngr, SIGNAL(disconnected()), this, SIGNAL(autoPilotDisconnected()),
             Qt::UniqueConnection);
+
+    fetchTimer.setSingleShot(true);
+    connect(&fetchTimer, &QTimer::timeout, this, &ConfigTaskWidget::finishFetch);
+    reloadTimer.setSingleShot(true);
+    connect(&reloadTimer, &QTimer::timeout, this, &ConfigTaskWidget::reloadTimedOut);
+
     UAVSettingsImportExportManager *importexportplugin =
         pm->getObject<UAVSettingsImportExportManager>();
     connect(importexportplugin, SIGNAL(importAboutToBegin()), this, SLOT(invalidateObjects()));
@@ -269,10 +275,6 @@ ConfigTaskWidget::~ConfigTaskWidget()
         if (oTw)
             delete oTw;
     }
-    if (timeOut) {
-        delete timeOut;
-        timeOut = NULL;
-    }
 }
 
 void ConfigTaskWidget::saveObjectToSD(UAVObject *obj)
@@ -349,6 +351,13 @@ double ConfigTaskWidget::listVar(QList<double> list)
 
 void ConfigTaskWidget::onAutopilotDisconnect()
 {
+    // Nothing more is coming
+    reloadQueue.clear();
+    reloadedObjects.clear();
+    reloadTimer.stop();
+    if (isFetching())
+        finishFetch();
+
     isConnected = false;
     enableControls(false);
     invalidateObjects();
@@ -409,6 +418,10 @@ void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
     if (!allowWidgetUpdates)
         return;
 
+    // Refreshed with the others once the fetch completes
+    if (obj && fetchPending.contains(obj))
+        return;
+
     bool dirtyBack = dirty;
     emit refreshWidgetsValuesRequested();
     foreach (objectToWidget *ow, objOfInterest) {
@@ -418,6 +431,86 @@ void ConfigTaskWidget::refreshWidgetsValues(UAVObject *obj)
     }
     setDirty(dirtyBack);
 }
+
+/**
+ * Refresh the widgets of a set of objects in a single pass
+ */
+void ConfigTaskWidget::refreshWidgetsFromObjects(const QSet<UAVObject *> &objects)
+{
+    if (!allowWidgetUpdates || objects.isEmpty())
+        return;
+
+    bool dirtyBack = dirty;
+    emit refreshWidgetsValuesRequested();
+    foreach (objectToWidget *ow, objOfInterest) {
+        if (ow->object && ow->field && ow->widget && objects.contains(ow->object))
+            setWidgetFromField(ow->widget, ow->field, ow->index, ow->scale, ow->isLimited,
+                               ow->useUnits);
+    }
+    setDirty(dirtyBack);
+}
+
+void ConfigTaskWidget::fetchObjects(const QList<UAVObject *> &objects)
+{
+    foreach (UAVObject *obj, objects) {
+        if (!obj || fetchPending.contains(obj))
+            continue;
+
+        fetchPending.insert(obj);
+        connect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this,
+                SLOT(fetchTransactionCompleted(UAVObject *, bool)), Qt::UniqueConnection);
+        // Telemetry queues the request, so they all go out without waiting on each other
+        obj->requestUpdate();
+    }
+
+    if (fetchPending.isEmpty()) {
+        // Still complete from the event loop, like a fetch that went out
+        QTimer::singleShot(0, this, &ConfigTaskWidget::finishFetch);
+        return;
+    }
+
+    fetchTimer.start(FETCH_TIMEOUT_MS);
+}
+
+void ConfigTaskWidget::fetchTransactionCompleted(UAVObject *obj, bool success)
+{
+    if (!fetchPending.remove(obj))
+        return;
+
+    disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this,
+               SLOT(fetchTransactionCompleted(UAVObject *, bool)));
+
+    if (success)
+        fetchedObjects.insert(obj);
+    else
+        fetchSuccess = false;
+
+    if (fetchPending.isEmpty())
+        finishFetch();
+}
+
+/**
+ * Complete a fetch, when the last object arrived or on timeout
+ */
+void ConfigTaskWidget::finishFetch()
+{
+    fetchTimer.stop();
+
+    foreach (UAVObject *obj, fetchPending) {
+        disconnect(obj, SIGNAL(transactionCompleted(UAVObject *, bool)), this,
+                   SLOT(fetchTransactionCompleted(UAVObject *, bool)));
+        fetchSuccess = false;
+    }
+    fetchPending.clear();
+
+    QSet<UAVObject *> fetched = fetchedObjects;
+    bool success = fetchSuccess;
+    fetchedObjects.clear();
+    fetchSuccess = true;
+
+    refreshWidgetsFromObjects(fetched);
+    emit objectsFetched(success);
+}
 /**
  * SLOT function used to update the uavobject fields from widgets with relation to
  * object field added to the framework pool
@@ -1037,60 +1130,88 @@ void ConfigTaskWidget::rebootButtonClicked()
  */
 void ConfigTaskWidget::reloadButtonClicked()
 {
-    if (timeOut)
+    if (!reloadQueue.isEmpty())
         return;
     int group = sender()->property("group").toInt();
     QList<objectToWidget *> *list = defaultReloadGroups.value(group, NULL);
     if (!list)
         return;
-    ObjectPersistence *objper =
-        dynamic_cast<ObjectPersistence *>(getObjectManager()->getObject(ObjectPersistence::NAME));
-    timeOut = new QTimer(this);
-    QEventLoop *eventLoop = new QEventLoop(this);
-    connect(timeOut, SIGNAL(timeout()), eventLoop, SLOT(quit()));
-    connect(objper, SIGNAL(objectUpdated(UAVObject *)), eventLoop, SLOT(quit()));
-
-    QList<temphelper> temp;
+
     foreach (objectToWidget *oTw, *list) {
         if (oTw->object != NULL) {
             UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(oTw->object);
             if (dobj)
                 if (!dobj->getIsPresentOnHardware())
                     continue;
-            temphelper value;
-            value.objid = oTw->object->getObjID();
-            value.objinstid = oTw->object->getInstID();
-            if (temp.contains(value))
-                continue;
-            else
-                temp.append(value);
-            ObjectPersistence::DataFields data;
-            data.Operation = ObjectPersistence::OPERATION_LOAD;
-            data.ObjectID = oTw->object->getObjID();
-            data.InstanceID = oTw->object->getInstID();
-            objper->setData(data);
-            objper->updated();
-            timeOut->start(500);
-            eventLoop->exec();
-            if (timeOut->isActive()) {
-                oTw->object->requestUpdate();
-                if (oTw->widget)
-                    setWidgetFromField(oTw->widget, oTw->field, oTw->index, oTw->scale,
-                                       oTw->isLimited, oTw->useUnits);
-            }
-            timeOut->stop();
+            if (!reloadQueue.contains(oTw->object))
+                reloadQueue.enqueue(oTw->object);
         }
     }
-    if (eventLoop) {
-        delete eventLoop;
-        eventLoop = NULL;
+    reloadedObjects.clear();
+
+    ObjectPersistence *objper = ObjectPersistence::GetInstance(getObjectManager());
+    connect(objper, SIGNAL(objectUpdated(UAVObject *)), this,
+            SLOT(reloadPersistenceUpdated(UAVObject *)), Qt::UniqueConnection);
+
+    reloadNextObject();
+}
+
+/**
+ * Have the board load the next object of the reload group from flash. The board
+ * does one at a time, the objects are read back together once all are loaded.
+ */
+void ConfigTaskWidget::reloadNextObject()
+{
+    ObjectPersistence *objper = ObjectPersistence::GetInstance(getObjectManager());
+
+    if (reloadQueue.isEmpty()) {
+        disconnect(objper, SIGNAL(objectUpdated(UAVObject *)), this,
+                   SLOT(reloadPersistenceUpdated(UAVObject *)));
+        fetchObjects(reloadedObjects);
+        reloadedObjects.clear();
+        return;
     }
-    if (timeOut) {
-        delete timeOut;
-        timeOut = NULL;
+
+    UAVObject *obj = reloadQueue.head();
+    ObjectPersistence::DataFields data;
+    memset(&data, 0, sizeof(data));
+    data.Operation = ObjectPersistence::OPERATION_LOAD;
+    data.ObjectID = obj->getObjID();
+    data.InstanceID = obj->getInstID();
+    reloadTimer.start(RELOAD_TIMEOUT_MS);
+    objper->setData(data);
+    objper->updated();
+}
+
+void ConfigTaskWidget::reloadPersistenceUpdated(UAVObject *obj)
+{
+    if (reloadQueue.isEmpty() || !reloadTimer.isActive())
+        return;
+
+    ObjectPersistence::DataFields data = static_cast<ObjectPersistence *>(obj)->getData();
+    if (data.ObjectID != reloadQueue.head()->getObjID()
+        || data.InstanceID != reloadQueue.head()->getInstID())
+        return;
+
+    if (data.Operation == ObjectPersistence::OPERATION_COMPLETED) {
+        reloadTimer.stop();
+        reloadedObjects.append(reloadQueue.dequeue());
+        reloadNextObject();
+    } else if (data.Operation == ObjectPersistence::OPERATION_ERROR) {
+        reloadTimer.stop();
+        reloadQueue.dequeue();
+        reloadNextObject();
     }
 }
 
+void ConfigTaskWidget::reloadTimedOut()
+{
+    // Not loaded, its widgets keep their values
+    if (!reloadQueue.isEmpty())
+        reloadQueue.dequeue();
+    reloadNextObject();
+}
+
 void ConfigTaskWidget::connectionsButtonClicked()
 {
     ConnectionDiagram diagram(this);
@@ -33,6 +33,8 @@
 #include "uavobjects/uavobject.h"
 #include "uavobjectutil/uavobjectutilmanager.h"
 #include <QQueue>
+#include <QSet>
+#include <QTimer>
 #include <QWidget>
 #include <QList>
 #include <QLabel>
@@ -73,16 +75,6 @@ public:
         QList<shadow *> shadowsList;
     };
 
-    struct temphelper
-    {
-        quint32 objid;
-        quint32 objinstid;
-        bool operator==(const temphelper &lhs)
-        {
-            return (lhs.objid == this->objid && lhs.objinstid == this->objinstid);
-        }
-    };
-
     enum buttonTypeEnum {
         none,
         save_button,
@@ -199,6 +191,17 @@ public:
 
     void setNotMandatory(QString object);
 
+    /**
+     * @brief Request objects from the board without blocking, then refresh the widgets bound
+     * to them in one pass
+     *
+     * The requests all go out at once. Updates of the objects don't refresh their widgets
+     * one by one while the fetch runs; objectsFetched() is emitted when it is done.
+     * @param objects objects to fetch
+     */
+    void fetchObjects(const QList<UAVObject *> &objects);
+    bool isFetching() const { return !fetchPending.isEmpty(); }
+
     virtual void tabSwitchingAway() {}
 
 public slots:
@@ -224,6 +227,8 @@ signals:
     // fired when the autopilot disconnects
     void autoPilotDisconnected();
     void defaultRequested(int group);
+    // fired when a fetchObjects() completes, success is false if any object didn't arrive
+    void objectsFetched(bool success);
 
 private slots:
     void objectUpdated(UAVObject *);
@@ -232,8 +237,18 @@ private slots:
     void rebootButtonClicked();
     void connectionsButtonClicked();
     void doRefreshHiddenObjects(UAVDataObject *);
+    void fetchTransactionCompleted(UAVObject *obj, bool success);
+    void finishFetch();
+    void reloadNextObject();
+    void reloadPersistenceUpdated(UAVObject *obj);
+    void reloadTimedOut();
 
 private:
+    // Longest a fetch may take, telemetry normally times the requests out before
+    static const int FETCH_TIMEOUT_MS = 5000;
+    // Longest the board may take to load an object from flash
+    static const int RELOAD_TIMEOUT_MS = 1000;
+
     int currentBoard;
     bool isConnected;
     bool allowWidgetUpdates;
@@ -277,7 +292,14 @@ private:
     QString applyScaleToUnits(QString units, double scale);
     void setWidgetEnabledByObj(QWidget *widget, bool enabled);
     QString outOfLimitsStyle;
-    QTimer *timeOut;
+    QSet<UAVObject *> fetchPending;
+    QSet<UAVObject *> fetchedObjects;
+    bool fetchSuccess;
+    QTimer fetchTimer;
+    QQueue<UAVObject *> reloadQueue;
+    QList<UAVObject *> reloadedObjects;
+    QTimer reloadTimer;
+    void refreshWidgetsFromObjects(const QSet<UAVObject *> &objects);
 protected slots:
     virtual void disableObjUpdates();
     virtual void enableObjUpdates();
@@ -104,6 +104,7 @@ void smartSaveButton::processOperation(QPushButton *button, bool save)
     QStringList failedUploads;
     QStringList failedSaves;
     QStringList missingObjects;
+    QList<UAVDataObject *> toSave;
     if (button) {
         button->setEnabled(false);
         button->setIcon(QIcon(":/uploader/images/system-run.svg"));
@@ -169,40 +170,50 @@ void smartSaveButton::processOperation(QPushButton *button, bool save)
             continue;
         }
 
-        // Now object is uploaded, we can move on to saving it to flash:
-        save_result = false;
-        current_objectID = obj->getObjID();
+        // Now object is uploaded, it can be saved to flash with the others below
+        if (save)
+            toSave.append(obj);
+    }
+
+    if (!toSave.isEmpty()) {
+        pendingSaves.clear();
+        savedObjects.clear();
+        foreach (UAVDataObject *obj, toSave)
+            pendingSaves.insert(obj->getObjID(), obj);
 
-        if (save && (obj->isSettings())) {
+        connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this,
+                SLOT(saving_finished(int, bool)));
+        connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        foreach (UAVDataObject *obj, toSave) {
             qDebug() << "[smartsavebutton.cpp] Save request for object" << obj->getName();
-            connect(utilMngr, SIGNAL(saveCompleted(int, bool)), this,
-                    SLOT(saving_finished(int, bool)));
-            connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
             utilMngr->saveObjectToFlash(obj);
-            // Now, here is what will happen:
-            // - saveObjectToFlash is going to attempt the save operation
-            // - If save succeeds, then it will issue a saveCompleted signal with the ObjectID and
-            // 'true'
-            // - If save fails, either because of error or timeout, then it will issue a
-            // saveCompleted signal
-            //   with the ObjectID and 'false'.
-            //
-            // Note: in case of link timeout, the telemetry layer will retry up to 2 times, we don't
-            // need to retry ourselves here.
-            //
-            // Note 2: saveObjectToFlash manages save operations in a queue, so there is no
-            // guarantee that
-            // the first "saveCompleted" signal is for the object we just asked to save.
+        }
+        // Now, here is what will happen:
+        // - saveObjectToFlash queues the objects and saves them with as few requests as it can
+        // - For each object, it will issue a saveCompleted signal with the ObjectID and 'true'
+        //   if the save succeeds, or 'false' on error or timeout
+        //
+        // Note: in case of link timeout, the telemetry layer will retry up to 2 times, we don't
+        // need to retry ourselves here.
+        //
+        // Note 2: the save queue is shared, so there is no guarantee that a "saveCompleted"
+        // signal is for one of our objects. The wait is restarted as long as ours make progress.
+        while (!pendingSaves.isEmpty()) {
             timer.start(2000);
             loop.exec();
-            if (!timer.isActive())
-                qDebug() << "[smartsavebutton.cpp] Saving timeout for object" << obj->getName();
-            timer.stop();
-            disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this,
-                       SLOT(saving_finished(int, bool)));
-            disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+            if (!timer.isActive()) {
+                qDebug() << "[smartsavebutton.cpp] Saving timeout," << pendingSaves.size()
+                         << "objects left";
+                break;
+            }
+        }
+        timer.stop();
+        disconnect(utilMngr, SIGNAL(saveCompleted(int, bool)), this,
+                   SLOT(saving_finished(int, bool)));
+        disconnect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
 
-            if (save_result == false) {
+        foreach (UAVDataObject *obj, toSave) {
+            if (!savedObjects.contains(obj)) {
                 qDebug() << "[smartsavebutton.cpp] failed to save:" << obj->getName();
                 if (mandatoryList.value(obj, true))
                     failedSaves.append(obj->getName());
@@ -336,9 +347,11 @@ void smartSaveButton::saving_finished(int id, bool result)
 {
     // The saveOjectToFlash method manages its own save queue, so we can be
     // in a situation where we get a saving_finished message for an object
-    // which is not the one we're interested in, hence the check below:
-    if ((quint32)id == current_objectID) {
-        save_result = result;
+    // which is not one we're interested in, hence the check below:
+    UAVDataObject *obj = pendingSaves.take((quint32)id);
+    if (obj) {
+        if (result)
+            savedObjects.append(obj);
         loop.quit();
     }
 }
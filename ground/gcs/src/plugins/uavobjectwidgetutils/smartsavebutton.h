@@ -33,6 +33,7 @@
 #include "uavobjects/uavobjectmanager.h"
 #include "uavobjects/uavobject.h"
 #include <QPushButton>
+#include <QHash>
 #include <QList>
 #include <QEventLoop>
 #include "uavobjectutil/uavobjectutilmanager.h"
@@ -72,10 +73,10 @@ private slots:
     void saving_finished(int, bool);
 
 private:
-    quint32 current_objectID;
     UAVDataObject *current_object;
     bool upload_result;
-    bool save_result;
+    QHash<quint32, UAVDataObject *> pendingSaves;
+    QList<UAVDataObject *> savedObjects;
     QEventLoop loop;
     QList<UAVDataObject *> objects;
     QMap<QPushButton *, buttonTypeEnum> buttonList;
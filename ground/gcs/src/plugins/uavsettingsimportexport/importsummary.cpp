@@ -101,9 +101,10 @@ void ImportSummaryDialog::openHelp()
 
 /*
   Adds a new line about a UAVObject along with its status
-  (whether it got saved OK or not)
+  (whether it got saved OK or not). Objects that can be saved
+  start out selected if checked is set.
   */
-void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool status)
+void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool status, bool checked)
 {
     ui->importSummaryList->setRowCount(ui->importSummaryList->rowCount() + 1);
     int row = ui->importSummaryList->rowCount() - 1;
@@ -118,7 +119,7 @@ void ImportSummaryDialog::addLine(QString uavObjectName, QString text, bool stat
     ui->importSummaryList->item(row, 2)->setFlags(Qt::NoItemFlags);
 
     if (status) {
-        box->setChecked(true);
+        box->setChecked(checked);
     } else {
         box->setChecked(false);
         box->setEnabled(false);
@@ -166,8 +167,11 @@ void ImportSummaryDialog::doTheApplySaving()
         }
     }
 
-    if (itemCount == 0)
+    // Nothing differs from the board, or nothing was wanted
+    if (itemCount == 0) {
+        accept();
         return;
+    }
 
     ui->btnSaveToFlash->setEnabled(false);
     ui->closeButton->setEnabled(false);
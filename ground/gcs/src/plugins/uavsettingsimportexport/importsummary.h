@@ -47,7 +47,7 @@ class ImportSummaryDialog : public QDialog
 public:
     ImportSummaryDialog(QWidget *parent = 0, bool quiet = false);
     ~ImportSummaryDialog();
-    void addLine(QString objectName, QString text, bool status);
+    void addLine(QString objectName, QString text, bool status, bool checked = true);
     void setUAVOSettings(UAVObjectManager *obj);
     int numLines() const;
 
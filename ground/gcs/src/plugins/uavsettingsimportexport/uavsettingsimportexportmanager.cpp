@@ -107,6 +107,28 @@ void UAVSettingsImportExportManager::extensionsInitialized()
 #endif
 }
 
+/**
+ * @brief Names of the fields whose values differ between two instances of an object
+ */
+static QStringList changedFields(UAVObject *boardObj, UAVObject *importedObj)
+{
+    QStringList changed;
+    QList<UAVObjectField *> boardFields = boardObj->getFields();
+    QList<UAVObjectField *> importedFields = importedObj->getFields();
+
+    for (int i = 0; i < boardFields.size() && i < importedFields.size(); i++) {
+        UAVObjectField *field = boardFields.at(i);
+        for (quint32 n = 0; n < field->getNumElements(); n++) {
+            if (field->getValue(n) != importedFields.at(i)->getValue(n)) {
+                changed.append(field->getName());
+                break;
+            }
+        }
+    }
+
+    return changed;
+}
+
 bool UAVSettingsImportExportManager::importUAVSettings(const QByteArray &settings, bool quiet)
 {
     QDomDocument doc("UAVObjects");
@@ -209,16 +231,27 @@ bool UAVSettingsImportExportManager::importUAVSettings(const QByteArray &setting
                 }
                 newObj->updated();
 
+                // Objects already as on the board aren't selected, so only the
+                // changes are sent and saved
+                QStringList changed = changedFields(dobj, newObj);
+                bool isChanged = !changed.isEmpty();
+
                 if (error) {
-                    swui.addLine(uavObjectName, "Warning (Object field unknown)", true);
+                    swui.addLine(uavObjectName, "Warning (Object field unknown)", true, isChanged);
                 } else if (uavObjectID != newObj->getObjID()) {
                     qDebug() << "Mismatch for Object " << uavObjectName << uavObjectID << " - "
                              << newObj->getObjID();
-                    swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true);
+                    swui.addLine(uavObjectName, "Warning (ObjectID mismatch)", true, isChanged);
                 } else if (setError) {
                     swui.addLine(uavObjectName, "Warning (Objects field value(s) invalid)", false);
+                } else if (!isChanged) {
+                    swui.addLine(uavObjectName, "Unchanged", true, false);
+                } else if (changed.size() <= MAX_LISTED_FIELDS) {
+                    swui.addLine(uavObjectName, QString("OK (%1 changed)").arg(changed.join(", ")),
+                                 true);
                 } else {
-                    swui.addLine(uavObjectName, "OK", true);
+                    swui.addLine(uavObjectName,
+                                 QString("OK (%1 fields changed)").arg(changed.size()), true);
                 }
                 importedObjectManager->registerObject(newObj);
             }
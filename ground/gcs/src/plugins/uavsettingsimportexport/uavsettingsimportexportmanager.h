@@ -57,6 +57,9 @@ private Q_SLOTS:
     void setCommandsEnabled(bool enabled);
 
 private:
+    //! Most changed fields of an object named in the import summary
+    static const int MAX_LISTED_FIELDS = 3;
+
     enum storedData { Settings, Data, Both };
     QString createXMLDocument(const enum storedData, const bool fullExport);
 
@@ -0,0 +1,236 @@
+/**
+ ******************************************************************************
+ *
+ * @file       linklatency.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Measures the latency of the telemetry link
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "linklatency.h"
+#include "uavtalk.h"
+#include "telemetryping.h"
+#include "coreplugin/connectionmanager.h"
+#include "coreplugin/icore.h"
+
+#include <QDebug>
+#include <QStringList>
+#include <QTimer>
+
+LinkLatency::LinkLatency(UAVTalk *utalk, UAVObjectManager *objMngr, QObject *parent)
+    : QObject(parent)
+    , utalk(utalk)
+    , sequence(0)
+    , lastEchoed(0)
+    , sent(0)
+    , echoed(0)
+{
+    pingObj = TelemetryPing::GetInstance(objMngr);
+    Q_ASSERT(pingObj);
+
+    connect(pingObj, &UAVObject::objectUnpacked, this, &LinkLatency::pingUnpacked);
+
+    timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, this, &LinkLatency::sendPing);
+
+    Core::ConnectionManager *cm = Core::ICore::instance()->connectionManager();
+    connect(this, &LinkLatency::latencyUpdated, cm, &Core::ConnectionManager::linkLatencyUpdated);
+}
+
+LinkLatency::~LinkLatency()
+{
+    stop();
+}
+
+/**
+ * @brief Start pinging, once telemetry is connected
+ */
+void LinkLatency::start()
+{
+    if (timer->isActive())
+        return;
+
+    sent = 0;
+    echoed = 0;
+    lastEchoed = sequence;
+    recent.clear();
+    rtt.clear();
+    uplink.clear();
+    downlink.clear();
+
+    timer->start(PING_PERIOD_MS);
+}
+
+void LinkLatency::stop()
+{
+    if (!timer->isActive())
+        return;
+
+    timer->stop();
+    logHistograms();
+}
+
+void LinkLatency::sendPing()
+{
+    TelemetryPing::DataFields data = pingObj->getData();
+    data.Sequence = ++sequence;
+    data.FlightRxTime = 0;
+    data.FlightTxTime = 0;
+    data.GcsTime = (quint32)UAVTalk::clockUs();
+    pingObj->setData(data);
+
+    // Straight to the link, the telemetry queues would only add to the delay
+    utalk->sendObject(pingObj, false, false);
+    sent++;
+}
+
+void LinkLatency::pingUnpacked(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+
+    // Frames are unpacked as soon as they are read, so this is when the echo came in
+    quint32 t3 = (quint32)utalk->lastFrameRxTimeUs();
+
+    TelemetryPing::DataFields ping = pingObj->getData();
+
+    // Each ping counts once, and only pings sent this connection
+    if ((qint16)(ping.Sequence - lastEchoed) <= 0 || (qint16)(sequence - ping.Sequence) < 0)
+        return;
+    lastEchoed = ping.Sequence;
+    echoed++;
+
+    // All in us, and modulo 2^32 so the clocks may wrap
+    quint32 t0 = ping.GcsTime;
+    quint32 t1 = ping.FlightRxTime * 1000;
+    quint32 t2 = ping.FlightTxTime * 1000;
+
+    quint32 rttUs = t3 - t0;
+    // With ms stamps on the board this can come out a little below zero
+    qint32 linkUs = qMax((qint32)(rttUs - (t2 - t1)), 0);
+
+    Sample sample;
+    sample.linkUs = linkUs;
+    sample.offsetUs = t1 - t0 - linkUs / 2;
+    recent.append(sample);
+    if (recent.size() > OFFSET_WINDOW)
+        recent.removeFirst();
+
+    const Sample *best = &recent.first();
+    for (const Sample &s : recent) {
+        if (s.linkUs < best->linkUs)
+            best = &s;
+    }
+
+    qint32 upUs = qMax((qint32)(t1 - t0 - best->offsetUs), 0);
+    qint32 downUs = qMax((qint32)(t3 - t2 + best->offsetUs), 0);
+
+    rtt.add(rttUs / 1000.0);
+    uplink.add(upUs / 1000.0);
+    downlink.add(downUs / 1000.0);
+
+    emit latencyUpdated(rtt.percentile(0.5), uplink.percentile(0.5), downlink.percentile(0.5));
+
+    if (echoed % LOG_PERIOD == 0)
+        logHistograms();
+}
+
+void LinkLatency::logHistograms()
+{
+    // Older firmware doesn't know the object, and never echoes
+    if (!echoed)
+        return;
+
+    qDebug() << "[LinkLatency]" << echoed << "of" << sent << "pings echoed";
+    qDebug() << "[LinkLatency] Round trip ms median" << rtt.percentile(0.5) << "p95"
+             << rtt.percentile(0.95) << ":" << rtt.toString();
+    qDebug() << "[LinkLatency] Uplink ms median" << uplink.percentile(0.5) << "p95"
+             << uplink.percentile(0.95) << ":" << uplink.toString();
+    qDebug() << "[LinkLatency] Downlink ms median" << downlink.percentile(0.5) << "p95"
+             << downlink.percentile(0.95) << ":" << downlink.toString();
+}
+
+LinkLatency::Histogram::Histogram()
+    : bins(NUM_BINS, 0)
+    , total(0)
+{
+}
+
+void LinkLatency::Histogram::clear()
+{
+    bins.fill(0);
+    total = 0;
+}
+
+void LinkLatency::Histogram::add(double ms)
+{
+    int bin = qBound(0, (int)(ms / BIN_MS), NUM_BINS - 1);
+    bins[bin]++;
+    total++;
+}
+
+/**
+ * @brief Delay below which a fraction of the samples fall, to the middle of
+ * its bin; the overflow bin gives its lower edge
+ */
+double LinkLatency::Histogram::percentile(double fraction) const
+{
+    if (!total)
+        return 0;
+
+    quint32 needed = qMax((quint32)(fraction * total + 0.5), (quint32)1);
+    quint32 seen = 0;
+
+    for (int i = 0; i < NUM_BINS - 1; i++) {
+        seen += bins.at(i);
+        if (seen >= needed)
+            return (i + 0.5) * BIN_MS;
+    }
+
+    return (NUM_BINS - 1) * BIN_MS;
+}
+
+/**
+ * @brief The bins that have samples, as "from-to:count" in ms
+ */
+QString LinkLatency::Histogram::toString() const
+{
+    QStringList parts;
+
+    for (int i = 0; i < NUM_BINS; i++) {
+        if (!bins.at(i))
+            continue;
+
+        if (i == NUM_BINS - 1)
+            parts << QString("%1+:%2").arg(i * BIN_MS).arg(bins.at(i));
+        else
+            parts << QString("%1-%2:%3").arg(i * BIN_MS).arg((i + 1) * BIN_MS).arg(bins.at(i));
+    }
+
+    return parts.join(' ');
+}
+
+/**
+ * @}
+ * @}
+ */
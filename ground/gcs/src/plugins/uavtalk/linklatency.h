@@ -0,0 +1,133 @@
+/**
+ ******************************************************************************
+ *
+ * @file       linklatency.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Measures the latency of the telemetry link
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef LINKLATENCY_H
+#define LINKLATENCY_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include "uavobjects/uavobjectmanager.h"
+
+class QTimer;
+class UAVTalk;
+class TelemetryPing;
+
+/**
+ * @brief Measures the latency of the telemetry link with TelemetryPing.
+ *
+ * While connected a ping goes out every second, stamped with the link clock
+ * of UAVTalk, and the board sends it back stamped with when it came in and
+ * went out on its own clock. The round trip runs from sending the ping to
+ * reading the frame of its echo off the link.
+ *
+ * The offset between the clocks is estimated the way NTP does, from the
+ * ping with the shortest round trip of late: that one waited least in
+ * queues, so was most likely delayed the same both ways. The delay in each
+ * direction follows from it; the board stamps in ms, so those are good to
+ * about a ms.
+ *
+ * Histograms of all three are kept for the connection and written to the
+ * log now and then; their medians go to the telemetry monitor widget.
+ */
+class LinkLatency : public QObject
+{
+    Q_OBJECT
+
+public:
+    LinkLatency(UAVTalk *utalk, UAVObjectManager *objMngr, QObject *parent = 0);
+    ~LinkLatency();
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    //! Median round trip and one way delays this connection, in ms
+    void latencyUpdated(double rttMs, double uplinkMs, double downlinkMs);
+
+private slots:
+    void sendPing();
+    void pingUnpacked(UAVObject *obj);
+
+private:
+    static const int PING_PERIOD_MS = 1000;
+    // Pings the clock offset is estimated over
+    static const int OFFSET_WINDOW = 16;
+    // Echoes between writing the histograms to the log
+    static const int LOG_PERIOD = 60;
+
+    class Histogram
+    {
+    public:
+        static const int BIN_MS = 5;
+        static const int NUM_BINS = 100; // The last one takes everything beyond
+
+        Histogram();
+        void clear();
+        void add(double ms);
+        quint32 count() const { return total; }
+        double percentile(double fraction) const;
+        QString toString() const;
+
+    private:
+        QVector<quint32> bins;
+        quint32 total;
+    };
+
+    struct Sample
+    {
+        quint32 linkUs; // Round trip less the time the board held the ping
+        quint32 offsetUs; // Flight clock less GCS clock, were it symmetric
+    };
+
+    void logHistograms();
+
+    UAVTalk *utalk;
+    TelemetryPing *pingObj;
+    QTimer *timer;
+
+    quint16 sequence; // Of the last ping sent
+    quint16 lastEchoed;
+    quint32 sent;
+    quint32 echoed;
+    QVector<Sample> recent;
+
+    Histogram rtt;
+    Histogram uplink;
+    Histogram downlink;
+};
+
+#endif // LINKLATENCY_H
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,240 @@
+/**
+ ******************************************************************************
+ * @file       logblock.cpp
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Compressed blocks of GCS telemetry logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+
+#include "logblock.h"
+#include <QtEndian>
+
+/**
+ * @brief Compress a run of records into a block
+ * @param out Buffer to append the block to
+ * @param records Checked records, as written by LogRecord::append()
+ * @param firstTimestamp Timestamp of the first record
+ * @param lastTimestamp Timestamp of the last record
+ */
+void LogBlock::append(QByteArray &out, const QByteArray &records, quint32 firstTimestamp,
+                      quint32 lastTimestamp)
+{
+    const QByteArray compressed = qCompress(records);
+    uchar header[HEADER_SIZE];
+
+    qToLittleEndian<quint32>(BLOCK_SYNC, header);
+    qToLittleEndian<quint32>(firstTimestamp, header + 4);
+    qToLittleEndian<quint32>(lastTimestamp, header + 8);
+    qToLittleEndian<quint32>(compressed.size(), header + 12);
+    quint32 crc = LogRecord::crc32(0, header, 16);
+    crc = LogRecord::crc32(crc, (const uchar *)compressed.constData(), compressed.size());
+    qToLittleEndian<quint32>(crc, header + 16);
+
+    out.append((const char *)header, HEADER_SIZE);
+    out.append(compressed);
+}
+
+/**
+ * @brief Check the block at the start of a buffer
+ * @param data Start of the block
+ * @param avail Bytes available from data on
+ * @param entry Filled with the block timestamps, may be NULL
+ * @param size Filled with the compressed size, may be NULL
+ * @return RECORD_TRUNCATED if the block runs past avail, RECORD_INVALID if
+ * there is no block at data
+ */
+LogRecord::Status LogBlock::parse(const uchar *data, qint64 avail, Entry *entry, qint64 *size)
+{
+    if (avail < HEADER_SIZE)
+        return LogRecord::RECORD_TRUNCATED;
+
+    const qint64 length = compressedSize(data);
+
+    if (qFromLittleEndian<quint32>(data) != BLOCK_SYNC || length < 1
+        || length > MAX_COMPRESSED_SIZE)
+        return LogRecord::RECORD_INVALID;
+
+    if (avail - HEADER_SIZE < length)
+        return LogRecord::RECORD_TRUNCATED;
+
+    quint32 crc = LogRecord::crc32(0, data, 16);
+    crc = LogRecord::crc32(crc, data + HEADER_SIZE, length);
+    if (crc != qFromLittleEndian<quint32>(data + 16))
+        return LogRecord::RECORD_INVALID;
+
+    if (entry) {
+        entry->firstTimestamp = qFromLittleEndian<quint32>(data + 4);
+        entry->lastTimestamp = qFromLittleEndian<quint32>(data + 8);
+    }
+    if (size)
+        *size = length;
+
+    return LogRecord::RECORD_OK;
+}
+
+/**
+ * @brief Scan for the next good block
+ * @param data Start of the mapped log
+ * @param from First offset to look at
+ * @param end End of the log
+ * @return Offset of the block, end if there is none
+ */
+qint64 LogBlock::find(const uchar *data, qint64 from, qint64 end)
+{
+    for (qint64 pos = from; pos + HEADER_SIZE <= end; pos++) {
+        if (qFromLittleEndian<quint32>(data + pos) != BLOCK_SYNC)
+            continue;
+        if (parse(data + pos, end - pos, NULL, NULL) == LogRecord::RECORD_OK)
+            return pos;
+    }
+
+    return end;
+}
+
+//! True if the block index starts at data, which ends the blocks
+bool LogBlock::isIndex(const uchar *data, qint64 avail)
+{
+    return avail >= 4 && qFromLittleEndian<quint32>(data) == INDEX_SYNC;
+}
+
+//! Compressed size from a block header, without any checks
+qint64 LogBlock::compressedSize(const uchar *header)
+{
+    return qFromLittleEndian<quint32>(header + 12);
+}
+
+/**
+ * @brief Decompress a block that parse() accepted
+ * @param block Start of the block header
+ * @param size Compressed size from parse()
+ * @return The records of the block, empty if they don't decompress
+ */
+QByteArray LogBlock::decompress(const uchar *block, qint64 size)
+{
+    return qUncompress(block + HEADER_SIZE, size);
+}
+
+/**
+ * @brief Append the index of the blocks written so far
+ */
+void LogBlock::appendIndex(QByteArray &out, const QVector<Entry> &entries)
+{
+    QByteArray index(4 + entries.size() * INDEX_ENTRY_SIZE + INDEX_TRAILER_SIZE, 0);
+    uchar *p = (uchar *)index.data();
+
+    qToLittleEndian<quint32>(INDEX_SYNC, p);
+    p += 4;
+    foreach (const Entry &entry, entries) {
+        qToLittleEndian<quint64>(entry.offset, p);
+        qToLittleEndian<quint32>(entry.firstTimestamp, p + 8);
+        qToLittleEndian<quint32>(entry.lastTimestamp, p + 12);
+        p += INDEX_ENTRY_SIZE;
+    }
+    qToLittleEndian<quint32>(entries.size(), p);
+    const uchar *start = (const uchar *)index.constData();
+    qToLittleEndian<quint32>(LogRecord::crc32(0, start, p + 4 - start), p + 4);
+    qToLittleEndian<quint32>(INDEX_SYNC, p + 8);
+
+    out.append(index);
+}
+
+/**
+ * @brief Read the block index at the end of a mapped log
+ * @param data Start of the mapped log
+ * @param dataStart Offset of the first block, past the log header
+ * @param end End of the log
+ * @param entries Filled with the blocks
+ * @return False if the log doesn't end with a good index
+ */
+bool LogBlock::readIndex(const uchar *data, qint64 dataStart, qint64 end, QVector<Entry> &entries)
+{
+    entries.clear();
+
+    if (end - dataStart < 4 + INDEX_TRAILER_SIZE
+        || qFromLittleEndian<quint32>(data + end - 4) != INDEX_SYNC)
+        return false;
+
+    const qint64 count = qFromLittleEndian<quint32>(data + end - INDEX_TRAILER_SIZE);
+    if (count > (end - dataStart) / INDEX_ENTRY_SIZE)
+        return false;
+
+    const qint64 start = end - INDEX_TRAILER_SIZE - count * INDEX_ENTRY_SIZE - 4;
+    if (start < dataStart || !isIndex(data + start, end - start)
+        || LogRecord::crc32(0, data + start, end - 8 - start)
+            != qFromLittleEndian<quint32>(data + end - 8))
+        return false;
+
+    entries.resize(count);
+    const uchar *p = data + start + 4;
+    for (qint64 i = 0; i < count; i++, p += INDEX_ENTRY_SIZE) {
+        entries[i].offset = qFromLittleEndian<quint64>(p);
+        entries[i].firstTimestamp = qFromLittleEndian<quint32>(p + 8);
+        entries[i].lastTimestamp = qFromLittleEndian<quint32>(p + 12);
+
+        if (entries[i].offset < (i ? entries[i - 1].offset + HEADER_SIZE : dataStart)
+            || entries[i].offset + HEADER_SIZE > start) {
+            entries.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Index a log without a good index by walking its blocks
+ * @param data Start of the mapped log
+ * @param dataStart Offset of the first block, past the log header
+ * @param end End of the log
+ * @param entries Filled with the good blocks
+ * @return Number of bytes skipped over corrupt or torn blocks
+ */
+qint64 LogBlock::scan(const uchar *data, qint64 dataStart, qint64 end, QVector<Entry> &entries)
+{
+    qint64 skipped = 0;
+    qint64 pos = dataStart;
+
+    entries.clear();
+
+    while (pos + HEADER_SIZE <= end && !isIndex(data + pos, end - pos)) {
+        Entry entry;
+        qint64 size;
+
+        if (parse(data + pos, end - pos, &entry, &size) != LogRecord::RECORD_OK) {
+            qint64 next = find(data, pos + 1, end);
+            skipped += next - pos;
+            pos = next;
+            continue;
+        }
+
+        entry.offset = pos;
+        entries.append(entry);
+        pos += HEADER_SIZE + size;
+    }
+
+    return skipped;
+}
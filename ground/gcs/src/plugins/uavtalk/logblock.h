@@ -0,0 +1,97 @@
+/**
+ ******************************************************************************
+ * @file       logblock.h
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Compressed blocks of GCS telemetry logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+
+#ifndef LOGBLOCK_H
+#define LOGBLOCK_H
+
+#include <QByteArray>
+#include <QVector>
+#include "uavtalk_global.h"
+#include "logrecord.h"
+
+/**
+ * Encodes and decodes the compressed container of a GCS log, marked by
+ * headerTag() in the text header. The body is a run of blocks, each
+ * holding the checked records (see LogRecord) of a stretch of the session
+ * compressed on their own, so a reader can decompress just the blocks it
+ * needs. All fields are little endian.
+ *
+ * Block:
+ *   u32 BLOCK_SYNC, u32 first timestamp, u32 last timestamp,
+ *   u32 compressed size, u32 CRC-32 of the first 16 header bytes and the
+ *   compressed data, compressed data (qCompress() format)
+ * Index, written after the last block when the log is closed:
+ *   u32 INDEX_SYNC, for each block { u64 file offset, u32 first timestamp,
+ *   u32 last timestamp }, u32 block count, u32 CRC-32 of everything
+ *   before it, u32 INDEX_SYNC
+ *
+ * A log without an index, e.g. from a GCS that didn't exit cleanly, is
+ * indexed by walking the block headers.
+ */
+class UAVTALK_EXPORT LogBlock
+{
+public:
+    static const qint64 HEADER_SIZE = 20;
+    static const quint32 BLOCK_SYNC = 0x424C5244; // "DRLB"
+    static const quint32 INDEX_SYNC = 0x494C5244; // "DRLI"
+    //! Largest plausible compressed block
+    static const qint64 MAX_COMPRESSED_SIZE = 16 * 1024 * 1024;
+
+    struct Entry
+    {
+        qint64 offset; /** File offset of the block header */
+        quint32 firstTimestamp;
+        quint32 lastTimestamp;
+    };
+
+    //! Header line written before the "##" separator of compressed logs
+    static QByteArray headerTag() { return QByteArray("Blocks: zlib"); }
+
+    static void append(QByteArray &out, const QByteArray &records, quint32 firstTimestamp,
+                       quint32 lastTimestamp);
+    static LogRecord::Status parse(const uchar *data, qint64 avail, Entry *entry, qint64 *size);
+    static qint64 find(const uchar *data, qint64 from, qint64 end);
+    static bool isIndex(const uchar *data, qint64 avail);
+    static qint64 compressedSize(const uchar *header);
+    static QByteArray decompress(const uchar *block, qint64 size);
+
+    static void appendIndex(QByteArray &out, const QVector<Entry> &entries);
+    static bool readIndex(const uchar *data, qint64 dataStart, qint64 end,
+                          QVector<Entry> &entries);
+    static qint64 scan(const uchar *data, qint64 dataStart, qint64 end, QVector<Entry> &entries);
+
+private:
+    static const qint64 INDEX_ENTRY_SIZE = 16;
+    static const qint64 INDEX_TRAILER_SIZE = 12; // count, CRC, sync
+};
+
+#endif // LOGBLOCK_H
@@ -0,0 +1,301 @@
+/**
+ ******************************************************************************
+ * @file       logdecoder.cpp
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Headless decoding of recorded telemetry logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "logdecoder.h"
+#include "uavtalk.h"
+#include "logrecord.h"
+#include "logblock.h"
+#include <cstring>
+
+/**
+ * @brief Constructor
+ * @param objMngr Object manager the log is decoded into
+ */
+LogDecoder::LogDecoder(UAVObjectManager *objMngr)
+    : mapData(NULL)
+    , mapSize(0)
+    , pos(0)
+    , dataStart(0)
+    , headerFound(false)
+    , recordsChecked(false)
+    , blocksCompressed(false)
+    , blockPos(0)
+    , skipped(0)
+{
+    // Nothing is ever sent back; the read-only sink makes UAVTalk drop
+    // its replies to the recorded traffic.
+    sink.open(QIODevice::ReadOnly);
+    talk = new UAVTalk(&sink, objMngr);
+}
+
+LogDecoder::~LogDecoder()
+{
+    close();
+    delete talk;
+}
+
+/**
+ * @brief Open and map a log, and position the decoder on its first record
+ * @param fileName Log to decode
+ * @return False if the log can't be read, see errorString()
+ */
+bool LogDecoder::open(const QString &fileName)
+{
+    close();
+    error.clear();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    mapSize = file.size();
+    mapData = mapSize > 0 ? file.map(0, mapSize) : NULL;
+    if (mapData == NULL) {
+        error = mapSize > 0 ? file.errorString() : QString("Empty log file");
+        close();
+        return false;
+    }
+
+    if (!parseHeader()) {
+        // Headerless logs are decoded from the start
+        dataStart = 0;
+    }
+    pos = dataStart;
+
+    return true;
+}
+
+/**
+ * @brief Unmap and close the log
+ */
+void LogDecoder::close()
+{
+    if (mapData != NULL) {
+        file.unmap(const_cast<uchar *>(mapData));
+    }
+    mapData = NULL;
+    mapSize = 0;
+    pos = 0;
+    dataStart = 0;
+
+    logGitHash.clear();
+    logUAVOHash.clear();
+    headerFound = false;
+    recordsChecked = false;
+    blocksCompressed = false;
+    block.clear();
+    blockPos = 0;
+    skipped = 0;
+
+    file.close();
+}
+
+/**
+ * @brief Decode the next record of the log
+ * @param timestamp Filled with the record timestamp in ms, may be NULL
+ * @return False at the end of the log or on a corrupted record, in which
+ * case errorString() is set
+ */
+bool LogDecoder::next(quint32 *timestamp)
+{
+    if (mapData == NULL) {
+        return false;
+    }
+
+    if (!blocksCompressed) {
+        return nextRecord(mapData, mapSize, &pos, timestamp);
+    }
+
+    while (true) {
+        while (blockPos >= block.size()) {
+            if (!nextBlock()) {
+                return false;
+            }
+        }
+
+        if (nextRecord((const uchar *)block.constData(), block.size(), &blockPos, timestamp)) {
+            return true;
+        }
+
+        // Nothing more to decode in this block
+        blockPos = block.size();
+    }
+}
+
+/**
+ * @brief Decode the record at an offset and step past it
+ * @param data Start of the records, the mapped log or a decompressed block
+ * @param end End of the records
+ * @param at Offset of the record, advanced past it
+ * @param timestamp Filled with the record timestamp in ms, may be NULL
+ * @return False at the end of the records or on a corrupted record
+ */
+bool LogDecoder::nextRecord(const uchar *data, qint64 end, qint64 *at, quint32 *timestamp)
+{
+    quint32 recordTime;
+    qint64 dataSize;
+    LogRecord::Status status = LogRecord::parse(data + *at, end - *at, recordsChecked,
+                                                MAX_RECORD_SIZE, &recordTime, &dataSize);
+
+    if (status != LogRecord::RECORD_OK && recordsChecked) {
+        // Skip a torn or corrupted stretch, e.g. from a GCS that didn't
+        // exit cleanly, up to the next record that checks out
+        qint64 next = LogRecord::find(data, *at + 1, end, true, MAX_RECORD_SIZE);
+        skipped += next - *at;
+        *at = next;
+        status = LogRecord::parse(data + *at, end - *at, true, MAX_RECORD_SIZE, &recordTime,
+                                  &dataSize);
+    }
+
+    if (status == LogRecord::RECORD_INVALID) {
+        error = QString("Unlikely packet size %1 at offset %2")
+                    .arg(LogRecord::payloadSize(data + *at, false))
+                    .arg(*at);
+        return false;
+    }
+
+    if (status == LogRecord::RECORD_TRUNCATED) {
+        // Truncated final record, e.g. from a GCS that didn't exit cleanly
+        return false;
+    }
+
+    talk->processBytes(data + *at + LogRecord::HEADER_SIZE, dataSize);
+    *at += LogRecord::HEADER_SIZE + dataSize;
+
+    if (timestamp != NULL) {
+        *timestamp = recordTime;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Decompress the next good block of a compressed log
+ * @return False once the blocks are used up
+ */
+bool LogDecoder::nextBlock()
+{
+    block.clear();
+    blockPos = 0;
+
+    while (pos + LogBlock::HEADER_SIZE <= mapSize
+           && !LogBlock::isIndex(mapData + pos, mapSize - pos)) {
+        qint64 size;
+
+        if (LogBlock::parse(mapData + pos, mapSize - pos, NULL, &size) != LogRecord::RECORD_OK) {
+            qint64 next = LogBlock::find(mapData, pos + 1, mapSize);
+            skipped += next - pos;
+            pos = next;
+            continue;
+        }
+
+        block = LogBlock::decompress(mapData + pos, size);
+        pos += LogBlock::HEADER_SIZE + size;
+        if (!block.isEmpty()) {
+            return true;
+        }
+        skipped += LogBlock::HEADER_SIZE + size;
+    }
+
+    // Past the blocks, the index doesn't hold anything to decode
+    pos = mapSize;
+    return false;
+}
+
+/**
+ * @brief Decode the rest of the log
+ * @param callback Called after each record, may be null
+ * @return Number of records decoded
+ */
+quint32 LogDecoder::decodeAll(const RecordCallback &callback)
+{
+    quint32 records = 0;
+    quint32 timestamp;
+
+    while (next(&timestamp)) {
+        records++;
+        if (callback && !callback(timestamp)) {
+            break;
+        }
+    }
+
+    return records;
+}
+
+double LogDecoder::progress() const
+{
+    if (mapSize <= dataStart) {
+        return 1.0;
+    }
+
+    return (double)(pos - dataStart) / (mapSize - dataStart);
+}
+
+/**
+ * @brief Parse the text header written by LogFile, see LogFile::open()
+ * @return True if the header/body separator was found
+ */
+bool LogDecoder::parseHeader()
+{
+    QStringList lines;
+    qint64 lineStart = 0;
+
+    // Title, git hash, UAVO hash and optional extra lines, at most ten
+    // lines before the "##" separator
+    while (lines.size() < 13 && lineStart < mapSize) {
+        const uchar *eol = (const uchar *)memchr(mapData + lineStart, '\n', mapSize - lineStart);
+        if (eol == NULL) {
+            break;
+        }
+
+        QString line = QString::fromLatin1((const char *)mapData + lineStart,
+                                           eol - (mapData + lineStart)).trimmed();
+        lineStart = eol - mapData + 1;
+
+        if (line == LogRecord::headerTag()) {
+            recordsChecked = true;
+        } else if (line == LogBlock::headerTag()) {
+            blocksCompressed = true;
+        } else if (line == "##") {
+            logGitHash = lines.value(1);
+            logUAVOHash = lines.value(2);
+            dataStart = lineStart;
+            headerFound = true;
+            return true;
+        }
+
+        lines.append(line);
+    }
+
+    return false;
+}
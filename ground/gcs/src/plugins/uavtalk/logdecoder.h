@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ * @file       logdecoder.h
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Headless decoding of recorded telemetry logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef LOGDECODER_H
+#define LOGDECODER_H
+
+#include <QBuffer>
+#include <QFile>
+#include <QString>
+#include <functional>
+#include "uavtalk_global.h"
+
+class UAVObjectManager;
+class UAVTalk;
+
+/**
+ * Decodes a GCS telemetry log into an object manager as fast as the records
+ * can be parsed, without timers or a GUI. The log is memory mapped and
+ * walked record by record; each record's stream bytes go straight through
+ * UAVTalk, so the objects (and anything connected to their signals) are
+ * updated before next() returns.
+ *
+ * The object manager should be private to the decoder's user, otherwise
+ * the whole GCS sees the replayed data.
+ */
+class UAVTALK_EXPORT LogDecoder
+{
+public:
+    /**
+     * Called after each record is decoded, with the record timestamp in ms.
+     * Return false to stop decoding.
+     */
+    typedef std::function<bool(quint32 timestamp)> RecordCallback;
+
+    LogDecoder(UAVObjectManager *objMngr);
+    ~LogDecoder();
+
+    bool open(const QString &fileName);
+    void close();
+
+    bool next(quint32 *timestamp);
+    quint32 decodeAll(const RecordCallback &callback = nullptr);
+
+    //! Git revision the log was recorded with, empty for headerless logs
+    QString gitHash() const { return logGitHash; }
+    //! UAVO hash the log was recorded with, empty for headerless logs
+    QString uavoHash() const { return logUAVOHash; }
+    //! False when no header separator was found and decoding starts at offset 0
+    bool hasHeader() const { return headerFound; }
+    //! Bytes skipped to resynchronise on a checked log, see LogRecord and
+    //! LogBlock
+    qint64 skippedBytes() const { return skipped; }
+    //! Fraction of the log decoded so far, from 0 to 1
+    double progress() const;
+    QString errorString() const { return error; }
+
+private:
+    static const qint64 MAX_RECORD_SIZE = 1024 * 1024;
+
+    QFile file;
+    QBuffer sink;
+    UAVTalk *talk;
+
+    const uchar *mapData;
+    qint64 mapSize;
+    qint64 pos;
+    qint64 dataStart;
+
+    QString logGitHash;
+    QString logUAVOHash;
+    bool headerFound;
+    bool recordsChecked;
+    bool blocksCompressed;
+    QByteArray block; /** Decompressed records of the current block */
+    qint64 blockPos;
+    qint64 skipped;
+    QString error;
+
+    bool parseHeader();
+    bool nextBlock();
+    bool nextRecord(const uchar *data, qint64 end, qint64 *at, quint32 *timestamp);
+};
+
+#endif // LOGDECODER_H
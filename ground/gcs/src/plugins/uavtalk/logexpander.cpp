@@ -0,0 +1,180 @@
+/**
+ ******************************************************************************
+ * @file       logexpander.cpp
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Expansion of delta compressed on-board logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "logexpander.h"
+#include "uavtalk.h"
+#include <QVector>
+#include <cstring>
+
+/**
+ * @brief Expand the compressed records of an on-board log
+ * @param log Raw log as read from the flight controller
+ * @param expanded Filled with the number of compressed records expanded, may be NULL
+ * @param dropped Filled with the number of deltas that had no valid key
+ * to apply to, may be NULL
+ * @return The log with every compressed record replaced by a plain object
+ */
+QByteArray LogExpander::expand(const QByteArray &log, quint32 *expanded, quint32 *dropped)
+{
+    const quint8 *in = (const quint8 *)log.constData();
+    const int size = log.size();
+
+    QVector<Slot> slotTable(NUM_SLOTS);
+    quint32 numExpanded = 0;
+    quint32 numDropped = 0;
+
+    QByteArray out;
+    out.reserve(size + size / 2);
+
+    int pos = 0;
+    int copyStart = 0;
+
+    while (pos + HEADER_LENGTH <= size) {
+        if (in[pos] != SYNC_VAL) {
+            pos++;
+            continue;
+        }
+
+        const quint8 type = in[pos + 1];
+        const int length = in[pos + 2] | (in[pos + 3] << 8);
+
+        // Only whole frames with a good CRC are skipped or expanded, so a
+        // sync value inside other data can't throw off the scan
+        if (length < HEADER_LENGTH || length >= MAX_PACKET_LENGTH || pos + length >= size
+            || UAVTalk::updateCRC(0, in + pos, length) != in[pos + length]) {
+            pos++;
+            continue;
+        }
+
+        if (type == TYPE_LOG_KEY && length >= KEY_HEADER_LENGTH) {
+            out.append(log.constData() + copyStart, pos - copyStart);
+
+            Slot &slot = slotTable[in[pos + 8]];
+            slot.objId = in[pos + 4] | (in[pos + 5] << 8) | (in[pos + 6] << 16)
+                | ((quint32)in[pos + 7] << 24);
+            slot.data = QByteArray((const char *)in + pos + KEY_HEADER_LENGTH,
+                                   length - KEY_HEADER_LENGTH);
+            slot.valid = true;
+
+            appendObject(out, slot, in + pos + 9);
+            numExpanded++;
+            copyStart = pos + length + 1;
+        } else if (type == TYPE_LOG_DELTA && length >= DELTA_HEADER_LENGTH) {
+            out.append(log.constData() + copyStart, pos - copyStart);
+
+            Slot &slot = slotTable[in[pos + 4]];
+            if (slot.valid
+                && applyDelta(slot.data, in + pos + DELTA_HEADER_LENGTH,
+                              length - DELTA_HEADER_LENGTH)) {
+                appendObject(out, slot, in + pos + 5);
+                numExpanded++;
+            } else {
+                // Nothing can be applied to this slot until its next key
+                slot.valid = false;
+                numDropped++;
+            }
+            copyStart = pos + length + 1;
+        }
+
+        pos += length + 1;
+    }
+
+    out.append(log.constData() + copyStart, size - copyStart);
+
+    if (expanded)
+        *expanded = numExpanded;
+    if (dropped)
+        *dropped = numDropped;
+
+    return out;
+}
+
+/**
+ * @brief Append the slot contents as a timestamped object
+ * @param out Log being built
+ * @param slot Slot to write out
+ * @param timestamp Little endian timestamp of the record
+ */
+void LogExpander::appendObject(QByteArray &out, const Slot &slot, const quint8 *timestamp)
+{
+    quint8 frame[MAX_PACKET_LENGTH + 16];
+    const int length = 10 + slot.data.size();
+
+    frame[0] = SYNC_VAL;
+    frame[1] = TYPE_OBJ_TS;
+    frame[2] = length & 0xFF;
+    frame[3] = (length >> 8) & 0xFF;
+    frame[4] = slot.objId & 0xFF;
+    frame[5] = (slot.objId >> 8) & 0xFF;
+    frame[6] = (slot.objId >> 16) & 0xFF;
+    frame[7] = (slot.objId >> 24) & 0xFF;
+    frame[8] = timestamp[0];
+    frame[9] = timestamp[1];
+    memcpy(frame + 10, slot.data.constData(), slot.data.size());
+    frame[length] = UAVTalk::updateCRC(0, frame, length);
+
+    out.append((const char *)frame, length + 1);
+}
+
+/**
+ * @brief XOR a packed delta into the previous sample of a slot
+ * @param data Previous sample, updated in place
+ * @param payload For each group of 8 bytes, a bitmap of the changed bytes
+ * followed by their XOR
+ * @param length Length of the payload
+ * @return False if the payload doesn't match the sample size
+ */
+bool LogExpander::applyDelta(QByteArray &data, const quint8 *payload, int length)
+{
+    QByteArray sample = data;
+    quint8 *bytes = (quint8 *)sample.data();
+    int in = 0;
+
+    for (int i = 0; i < sample.size(); i += 8) {
+        if (in >= length)
+            return false;
+
+        const quint8 mask = payload[in++];
+        for (int j = 0; j < 8; j++) {
+            if (!(mask & (1 << j)))
+                continue;
+            if (i + j >= sample.size() || in >= length)
+                return false;
+            bytes[i + j] ^= payload[in++];
+        }
+    }
+
+    if (in != length)
+        return false;
+
+    data = sample;
+    return true;
+}
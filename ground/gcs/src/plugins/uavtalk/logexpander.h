@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ * @file       logexpander.h
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Expansion of delta compressed on-board logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef LOGEXPANDER_H
+#define LOGEXPANDER_H
+
+#include <QByteArray>
+#include "uavtalk_global.h"
+
+/**
+ * Turns the key and delta records the flight Logging module writes when
+ * LoggingSettings.Compression is enabled back into plain timestamped
+ * UAVTalk objects, so a downloaded log reads like an uncompressed one.
+ * Everything else in the log, including the text header, is copied as is.
+ *
+ * Record layouts are described with UAVTALK_TYPE_LOG_KEY in the firmware's
+ * uavtalk_priv.h.
+ */
+class UAVTALK_EXPORT LogExpander
+{
+public:
+    static QByteArray expand(const QByteArray &log, quint32 *expanded = nullptr,
+                             quint32 *dropped = nullptr);
+
+private:
+    struct Slot
+    {
+        Slot()
+            : objId(0)
+            , valid(false)
+        {
+        }
+        quint32 objId;
+        QByteArray data;
+        bool valid;
+    };
+
+    static void appendObject(QByteArray &out, const Slot &slot, const quint8 *timestamp);
+    static bool applyDelta(QByteArray &data, const quint8 *payload, int length);
+
+    static const quint8 SYNC_VAL = 0x3C;
+    static const quint8 TYPE_OBJ_TS = 0xA0;
+    static const quint8 TYPE_LOG_KEY = 0xAA;
+    static const quint8 TYPE_LOG_DELTA = 0xAB;
+    static const int HEADER_LENGTH = 4; // sync(1), type(1), size(2)
+    static const int KEY_HEADER_LENGTH = 11; // header, object ID(4), slot(1), timestamp(2)
+    static const int DELTA_HEADER_LENGTH = 7; // header, slot(1), timestamp(2)
+    static const int MAX_PACKET_LENGTH = 256;
+    static const int NUM_SLOTS = 256;
+};
+
+#endif // LOGEXPANDER_H
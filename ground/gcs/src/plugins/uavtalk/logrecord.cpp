@@ -0,0 +1,161 @@
+/**
+ ******************************************************************************
+ * @file       logrecord.cpp
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Record framing of GCS telemetry logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "logrecord.h"
+#include <QtEndian>
+
+/**
+ * @brief Append checked records holding a block of stream bytes
+ * @param out Buffer to append to
+ * @param timestamp Record timestamp in ms
+ * @param data Stream bytes
+ * @param size Number of stream bytes, split over several records with the
+ * same timestamp if more than MAX_CHECKED_SIZE
+ */
+void LogRecord::append(QByteArray &out, quint32 timestamp, const char *data, qint64 size)
+{
+    while (size > 0) {
+        const quint16 length = size > MAX_CHECKED_SIZE ? MAX_CHECKED_SIZE : size;
+        uchar header[HEADER_SIZE];
+
+        qToLittleEndian<quint32>(timestamp, header);
+        qToLittleEndian<quint16>(length, header + 4);
+        qToLittleEndian<quint16>(SYNC, header + 6);
+        quint32 crc = crc32(0, header, 8);
+        crc = crc32(crc, (const uchar *)data, length);
+        qToLittleEndian<quint32>(crc, header + 8);
+
+        out.append((const char *)header, HEADER_SIZE);
+        out.append(data, length);
+
+        data += length;
+        size -= length;
+    }
+}
+
+/**
+ * @brief Check the record at the start of a buffer
+ * @param data Start of the record
+ * @param avail Bytes available from data on
+ * @param checked True for a log of checked records
+ * @param maxSize Largest plausible payload of a legacy record
+ * @param timestamp Filled with the record timestamp, may be NULL
+ * @param size Filled with the payload size, may be NULL
+ * @return RECORD_TRUNCATED if the record runs past avail, RECORD_INVALID if
+ * there is no record at data
+ */
+LogRecord::Status LogRecord::parse(const uchar *data, qint64 avail, bool checked, qint64 maxSize,
+                                   quint32 *timestamp, qint64 *size)
+{
+    if (avail < HEADER_SIZE)
+        return RECORD_TRUNCATED;
+
+    const qint64 length = payloadSize(data, checked);
+
+    if (checked) {
+        if (qFromLittleEndian<quint16>(data + 6) != SYNC || length < 1)
+            return RECORD_INVALID;
+    } else if (length < 1 || length > maxSize) {
+        return RECORD_INVALID;
+    }
+
+    if (avail - HEADER_SIZE < length)
+        return RECORD_TRUNCATED;
+
+    if (checked) {
+        quint32 crc = crc32(0, data, 8);
+        crc = crc32(crc, data + HEADER_SIZE, length);
+        if (crc != qFromLittleEndian<quint32>(data + 8))
+            return RECORD_INVALID;
+    }
+
+    if (timestamp)
+        *timestamp = qFromLittleEndian<quint32>(data);
+    if (size)
+        *size = length;
+
+    return RECORD_OK;
+}
+
+/**
+ * @brief Scan for the next good record
+ * @param data Start of the mapped log
+ * @param from First offset to look at
+ * @param end End of the log
+ * @param checked True for a log of checked records
+ * @param maxSize Largest plausible payload of a legacy record
+ * @return Offset of the record, end if there is none
+ */
+qint64 LogRecord::find(const uchar *data, qint64 from, qint64 end, bool checked, qint64 maxSize)
+{
+    for (qint64 pos = from; pos + HEADER_SIZE <= end; pos++) {
+        // Cheap test of the sync word before the CRC
+        if (checked && qFromLittleEndian<quint16>(data + pos + 6) != SYNC)
+            continue;
+        if (parse(data + pos, end - pos, checked, maxSize, NULL, NULL) == RECORD_OK)
+            return pos;
+    }
+
+    return end;
+}
+
+//! Payload size from a record header, without any checks
+qint64 LogRecord::payloadSize(const uchar *header, bool checked)
+{
+    return checked ? (qint64)qFromLittleEndian<quint16>(header + 4)
+                   : qFromLittleEndian<qint64>(header + 4);
+}
+
+/**
+ * @brief CRC-32 with the reflected 0xEDB88320 polynomial, as zlib's crc32()
+ */
+quint32 LogRecord::crc32(quint32 crc, const uchar *data, qint64 length)
+{
+    static const struct Table
+    {
+        Table()
+        {
+            for (quint32 i = 0; i < 256; i++) {
+                quint32 c = i;
+                for (int bit = 0; bit < 8; bit++)
+                    c = (c & 1) ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+                entries[i] = c;
+            }
+        }
+        quint32 entries[256];
+    } table;
+
+    crc = ~crc;
+    for (qint64 i = 0; i < length; i++)
+        crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
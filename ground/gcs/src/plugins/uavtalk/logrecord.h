@@ -0,0 +1,74 @@
+/**
+ ******************************************************************************
+ * @file       logrecord.h
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Record framing of GCS telemetry logs
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef LOGRECORD_H
+#define LOGRECORD_H
+
+#include <QByteArray>
+#include "uavtalk_global.h"
+
+/**
+ * Encodes and decodes the records of a GCS log, which follow the text
+ * header. Every record is a 12 byte header and the stream bytes received
+ * at its timestamp, all little endian.
+ *
+ * Checked records, marked by headerTag() in the text header:
+ *   u32 timestamp, u16 size, u16 SYNC, u32 CRC-32 (as zlib's) of the
+ *   first 8 header bytes and the payload
+ * Legacy records:
+ *   u32 timestamp, u64 size
+ *
+ * The sync word and CRC let a reader find the next good record after a
+ * torn or corrupted one, such as the tail of a session where the GCS did
+ * not exit cleanly.
+ */
+class UAVTALK_EXPORT LogRecord
+{
+public:
+    static const qint64 HEADER_SIZE = 12;
+    //! Largest payload of a checked record, longer ones are split
+    static const qint64 MAX_CHECKED_SIZE = 0xFFFF;
+    static const quint16 SYNC = 0x5244; // "DR"
+
+    enum Status { RECORD_OK, RECORD_TRUNCATED, RECORD_INVALID };
+
+    //! Header line written before the "##" separator of checked logs
+    static QByteArray headerTag() { return QByteArray("Records: crc32"); }
+
+    static void append(QByteArray &out, quint32 timestamp, const char *data, qint64 size);
+    static Status parse(const uchar *data, qint64 avail, bool checked, qint64 maxSize,
+                        quint32 *timestamp, qint64 *size);
+    static qint64 find(const uchar *data, qint64 from, qint64 end, bool checked, qint64 maxSize);
+    static qint64 payloadSize(const uchar *header, bool checked);
+    static quint32 crc32(quint32 crc, const uchar *data, qint64 length);
+};
+
+#endif // LOGRECORD_H
@@ -0,0 +1,188 @@
+/**
+ ******************************************************************************
+ *
+ * @file       settingscache.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief On-disk cache of the settings last retrieved from a board
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "settingscache.h"
+#include <utils/pathutils.h>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+SettingsCache::SettingsCache(UAVObjectManager *objMngr)
+    : objMngr(objMngr)
+{
+}
+
+/**
+ * @brief Select the cache file for a board
+ * @param cpuSerial The board CPU serial, as from UAVObjectUtilManager::getBoardCPUSerial
+ * @param firmwareHash The firmware git hash, as from UAVObjectUtilManager::getFirmwareHash
+ */
+void SettingsCache::setBoard(const QByteArray &cpuSerial, const QString &firmwareHash)
+{
+    entries.clear();
+    cacheFile.clear();
+
+    if (cpuSerial.isEmpty() || firmwareHash.isEmpty())
+        return;
+
+    cacheFile = Utils::PathUtils().GetStoragePath() + "settingscache" + QDir::separator()
+        + QString("%0-%1.cache").arg(QString(cpuSerial.toHex())).arg(firmwareHash.toLower());
+}
+
+/**
+ * @brief Read the cache file for the current board
+ * @return true if a usable cache was read
+ */
+bool SettingsCache::load()
+{
+    entries.clear();
+
+    if (!isValid())
+        return false;
+
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION)
+        return false;
+
+    for (quint32 i = 0; i < count; i++) {
+        quint32 objID;
+        CacheEntry entry;
+        in >> objID >> entry.crc >> entry.instances;
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "[SettingsCache] Truncated cache file" << cacheFile;
+            entries.clear();
+            return false;
+        }
+        entries.insert(objID, entry);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write the current value of every settings object present on the
+ * board to the cache file
+ * @return true on success
+ */
+bool SettingsCache::save()
+{
+    if (!isValid())
+        return false;
+
+    entries.clear();
+    foreach (const QVector<UAVDataObject *> &instances, objMngr->getDataObjectsVector()) {
+        UAVDataObject *dobj = instances.first();
+        if (!dobj->isSettings() || !dobj->getIsPresentOnHardware())
+            continue;
+
+        CacheEntry entry;
+        QByteArray all;
+        foreach (UAVDataObject *inst, instances) {
+            QByteArray data(inst->getNumBytes(), 0);
+            inst->pack(reinterpret_cast<quint8 *>(data.data()));
+            entry.instances.append(data);
+            all.append(data);
+        }
+        entry.crc = dataCRC(all);
+        entries.insert(dobj->getObjID(), entry);
+    }
+
+    QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out << CACHE_MAGIC << CACHE_VERSION << quint32(entries.size());
+    for (QHash<quint32, CacheEntry>::const_iterator it = entries.constBegin();
+         it != entries.constEnd(); ++it)
+        out << it.key() << it.value().crc << it.value().instances;
+
+    return file.commit();
+}
+
+/**
+ * @brief Load a cached settings object into the object manager
+ * @param objID The object to restore
+ * @param dataCRC The CRC of the object data as currently reported by the board
+ * @return true if the cached data matched and was unpacked into every
+ * instance, false if the object has to be fetched from the board
+ */
+bool SettingsCache::restore(quint32 objID, quint32 dataCRC)
+{
+    QHash<quint32, CacheEntry>::const_iterator it = entries.constFind(objID);
+    if (it == entries.constEnd() || it.value().crc != dataCRC)
+        return false;
+
+    const QList<QByteArray> &instances = it.value().instances;
+    if (instances.size() != objMngr->getNumInstances(objID))
+        return false;
+
+    for (int i = 0; i < instances.size(); i++) {
+        UAVObject *obj = objMngr->getObject(objID, i);
+        if (!obj || obj->getNumBytes() != (quint32)instances[i].size())
+            return false;
+    }
+
+    for (int i = 0; i < instances.size(); i++)
+        objMngr->getObject(objID, i)
+            ->unpack(reinterpret_cast<const quint8 *>(instances[i].constData()));
+
+    return true;
+}
+
+/**
+ * @brief CRC32 matching the firmware's PIOS_CRC32_updateCRC with a zero seed
+ * (polynomial 0x04C11DB7, MSB first, no reflection or final xor)
+ */
+quint32 SettingsCache::dataCRC(const QByteArray &data)
+{
+    quint32 crc = 0;
+    for (int i = 0; i < data.size(); i++) {
+        crc ^= quint32(quint8(data[i])) << 24;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : (crc << 1);
+    }
+    return crc;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,77 @@
+/**
+ ******************************************************************************
+ *
+ * @file       settingscache.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief On-disk cache of the settings last retrieved from a board
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef SETTINGSCACHE_H
+#define SETTINGSCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include "uavobjects/uavobjectmanager.h"
+
+/**
+ * @brief Persistent per-board copy of settings objects
+ *
+ * Each cache file is keyed by the board CPU serial and the firmware git
+ * hash, and holds the packed data of every instance of every settings
+ * object together with its CRC32. The CRC matches what the firmware reports
+ * through the SettingsDigest object, so only settings that changed on the
+ * board since the cache was written need to be fetched again.
+ */
+class SettingsCache
+{
+public:
+    SettingsCache(UAVObjectManager *objMngr);
+
+    void setBoard(const QByteArray &cpuSerial, const QString &firmwareHash);
+    bool isValid() const { return !cacheFile.isEmpty(); }
+    bool load();
+    bool save();
+    bool restore(quint32 objID, quint32 dataCRC);
+
+    static quint32 dataCRC(const QByteArray &data);
+
+private:
+    static const quint32 CACHE_MAGIC = 0x53434348; // "SCCH"
+    static const quint32 CACHE_VERSION = 1;
+
+    struct CacheEntry
+    {
+        quint32 crc;
+        QList<QByteArray> instances;
+    };
+
+    UAVObjectManager *objMngr;
+    QString cacheFile;
+    QHash<quint32, CacheEntry> entries;
+};
+
+#endif // SETTINGSCACHE_H
@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ *
+ * @file       speednegotiator.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Steps serial telemetry links up to faster speeds
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "speednegotiator.h"
+#include "uavtalk.h"
+#include "telemetryspeednegotiation.h"
+
+#include <QDebug>
+#include <QTimer>
+
+SpeedNegotiator::SpeedNegotiator(UAVTalk *utalk, UAVObjectManager *objMngr, quint32 speed,
+                                 quint32 maxSpeed, QObject *parent)
+    : QObject(parent)
+    , utalk(utalk)
+    , currentSpeed(speed)
+    , next(0)
+    , state(STATE_IDLE)
+    , skipStats(0)
+{
+    // The speeds the flight side accepts
+    static const quint32 standardSpeeds[] = { 57600, 115200, 230400, 460800, 921600 };
+    for (quint32 s : standardSpeeds) {
+        if (s > speed && s <= maxSpeed)
+            speeds.append(s);
+    }
+
+    negotiationObj = TelemetrySpeedNegotiation::GetInstance(objMngr);
+    Q_ASSERT(negotiationObj);
+
+    connect(negotiationObj, QOverload<UAVObject *, bool>::of(&UAVObject::transactionCompleted),
+            this, &SpeedNegotiator::transactionCompleted);
+}
+
+/**
+ * @brief Start stepping up, once telemetry is connected
+ */
+void SpeedNegotiator::start()
+{
+    if (state != STATE_IDLE || next != 0)
+        return;
+
+    tryNext();
+}
+
+void SpeedNegotiator::tryNext()
+{
+    if (next >= speeds.size()) {
+        finish();
+        return;
+    }
+
+    state = STATE_TRYING;
+    sendCommand(TelemetrySpeedNegotiation::COMMAND_TRY);
+}
+
+void SpeedNegotiator::sendCommand(quint8 command)
+{
+    TelemetrySpeedNegotiation::DataFields data = negotiationObj->getData();
+    data.Command = command;
+    data.Speed = speeds.at(next);
+    negotiationObj->setData(data);
+    negotiationObj->updated();
+}
+
+void SpeedNegotiator::transactionCompleted(UAVObject *obj, bool success)
+{
+    Q_UNUSED(obj);
+
+    switch (state) {
+    case STATE_TRYING:
+        // Older firmware doesn't know the object and NACKs it
+        if (!success) {
+            finish();
+            return;
+        }
+        state = STATE_SWITCHING;
+        QTimer::singleShot(SWITCH_DELAY_MS, this, &SpeedNegotiator::switchSpeed);
+        break;
+    case STATE_COMMITTING:
+        if (!success) {
+            // The board goes back too, when its trial runs out
+            utalk->setLinkSpeed(currentSpeed);
+            finish();
+            return;
+        }
+        currentSpeed = speeds.at(next++);
+        tryNext();
+        break;
+    default:
+        break;
+    }
+}
+
+void SpeedNegotiator::switchSpeed()
+{
+    if (state != STATE_SWITCHING)
+        return;
+
+    utalk->setLinkSpeed(speeds.at(next));
+
+    // The period the switch happened in saw garbage, judge by the next one
+    state = STATE_MEASURING;
+    skipStats = 1;
+}
+
+/**
+ * @brief Judge the speed tried from the receive statistics of a stats period
+ */
+void SpeedNegotiator::linkStatsUpdated(quint32 rxObjects, quint32 rxErrors)
+{
+    if (state != STATE_MEASURING)
+        return;
+
+    if (skipStats > 0) {
+        skipStats--;
+        return;
+    }
+
+    if (rxObjects < MIN_RX_OBJECTS || rxErrors * 100 > rxObjects * MAX_ERROR_PERCENT) {
+        qDebug() << "[SpeedNegotiator]" << speeds.at(next) << "bps failed with" << rxObjects
+                 << "objects and" << rxErrors << "errors";
+        utalk->setLinkSpeed(currentSpeed);
+        finish();
+        return;
+    }
+
+    state = STATE_COMMITTING;
+    sendCommand(TelemetrySpeedNegotiation::COMMAND_COMMIT);
+}
+
+void SpeedNegotiator::finish()
+{
+    state = STATE_IDLE;
+    next = speeds.size();
+
+    qDebug() << "[SpeedNegotiator] Telemetry link running at" << currentSpeed << "bps";
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ *
+ * @file       speednegotiator.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Steps serial telemetry links up to faster speeds
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef SPEEDNEGOTIATOR_H
+#define SPEEDNEGOTIATOR_H
+
+#include <QObject>
+#include <QVector>
+#include "uavobjects/uavobjectmanager.h"
+
+class UAVTalk;
+class TelemetrySpeedNegotiation;
+
+/**
+ * @brief Raises the speed of a serial link once connected at the configured
+ * speed, one standard speed at a time.
+ *
+ * Each step asks the board to Try the next speed. Both ends switch a short
+ * while after the request is acked, and the link is then watched for a stats
+ * period. If enough objects arrive with few CRC errors, the speed is committed
+ * and the next one tried. Otherwise the GCS goes back to the last good speed
+ * and stops; the board does the same when the commit doesn't come.
+ */
+class SpeedNegotiator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param utalk the serial link
+     * @param objMngr object manager of the link
+     * @param speed speed the link was opened at
+     * @param maxSpeed highest speed to try, e.g. what the radios take
+     */
+    SpeedNegotiator(UAVTalk *utalk, UAVObjectManager *objMngr, quint32 speed, quint32 maxSpeed,
+                    QObject *parent = 0);
+
+public slots:
+    void start();
+    void linkStatsUpdated(quint32 rxObjects, quint32 rxErrors);
+
+private slots:
+    void transactionCompleted(UAVObject *obj, bool success);
+    void switchSpeed();
+
+private:
+    // Must match the flight side
+    static const int SWITCH_DELAY_MS = 250;
+    // What a good link carries in a stats period, at least
+    static const quint32 MIN_RX_OBJECTS = 10;
+    static const quint32 MAX_ERROR_PERCENT = 2;
+
+    enum State { STATE_IDLE, STATE_TRYING, STATE_SWITCHING, STATE_MEASURING, STATE_COMMITTING };
+
+    void tryNext();
+    void sendCommand(quint8 command);
+    void finish();
+
+    UAVTalk *utalk;
+    TelemetrySpeedNegotiation *negotiationObj;
+    QVector<quint32> speeds;
+    quint32 currentSpeed;
+    int next;
+    State state;
+    int skipStats;
+};
+
+#endif // SPEEDNEGOTIATOR_H
+
+/**
+ * @}
+ * @}
+ */
@@ -40,6 +40,8 @@
 #include <QtGlobal>
 #include <stdlib.h>
 #include <QDebug>
+#include <algorithm>
+#include <functional>
 
 #ifdef TELEMETRY_DEBUG
 #define TELEMETRY_QXTLOG_DEBUG(...) qDebug() << (__VA_ARGS__)
@@ -76,7 +78,7 @@ public:
     bool operator<(const TransactionKey &rhs) const
     {
         return objId < rhs.objId || (objId == rhs.objId && instId < rhs.instId)
-            || (objId == rhs.objId && instId == rhs.instId && req != rhs.req);
+            || (objId == rhs.objId && instId == rhs.instId && !req && rhs.req);
     }
 
     quint32 objId;
@@ -91,6 +93,18 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr)
 {
     this->utalk = utalk;
     this->objMngr = objMngr;
+    // Setup the periodic timer, armed whenever an update is scheduled
+    updateClock.start();
+    updateTimer = new QTimer(this);
+    updateTimer->setSingleShot(true);
+    updateTimer->setTimerType(Qt::PreciseTimer);
+    connect(updateTimer, &QTimer::timeout, this, &Telemetry::processPeriodicUpdates);
+    // One timer for all transaction timeouts, armed for the earliest deadline
+    transSerial = 0;
+    retryPolicy = defaultRetryPolicy();
+    transTimer = new QTimer(this);
+    transTimer->setSingleShot(true);
+    connect(transTimer, &QTimer::timeout, this, &Telemetry::processTransactionTimeouts);
     // Process all objects in the list
     QVector<QVector<UAVObject *>> objs = objMngr->getObjectsVector();
     const int objSize = objs.size();
@@ -105,11 +119,6 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr)
     connect(utalk, &UAVTalk::nackReceived, this, &Telemetry::transactionFailure);
     // Get GCS stats object
     gcsStatsObj = GCSTelemetryStats::GetInstance(objMngr);
-    // Setup and start the periodic timer
-    timeToNextUpdateMs = 0;
-    updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &Telemetry::processPeriodicUpdates);
-    updateTimer->start(1000);
     // Setup and start the stats timer
     txErrors = 0;
     txRetries = 0;
@@ -117,10 +126,28 @@ Telemetry::Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr)
 
 Telemetry::~Telemetry()
 {
-    for (QMap<TransactionKey, ObjectTransactionInfo *>::iterator itr = transMap.begin();
-         itr != transMap.end(); ++itr) {
-        delete itr.value();
-    }
+}
+
+Telemetry::RetryPolicy Telemetry::defaultRetryPolicy()
+{
+    RetryPolicy policy;
+    policy.timeoutMs = REQ_TIMEOUT_MS;
+    policy.maxRetries = MAX_RETRIES;
+    policy.backoff = 1.0;
+    policy.maxTimeoutMs = REQ_TIMEOUT_MS;
+    return policy;
+}
+
+/**
+ * Set the timeouts and retries of transactions started from now on
+ */
+void Telemetry::setRetryPolicy(const RetryPolicy &policy)
+{
+    retryPolicy = policy;
+    retryPolicy.timeoutMs = qMax(policy.timeoutMs, 1);
+    retryPolicy.maxRetries = qMax(policy.maxRetries, 0);
+    retryPolicy.backoff = qMax(policy.backoff, 1.0);
+    retryPolicy.maxTimeoutMs = qMax(policy.maxTimeoutMs, retryPolicy.timeoutMs);
 }
 
 /**
@@ -140,22 +167,16 @@ void Telemetry::registerObject(UAVObject *obj)
  */
 void Telemetry::addObject(UAVObject *obj)
 {
-    // Check if object type is already in the list
-    const QVector<ObjectTimeInfo>::iterator iterEnd = objList.end();
-    for (QVector<ObjectTimeInfo>::const_iterator iter = objList.constBegin(); iter != iterEnd;
-         ++iter) {
-        if (iter->obj->getObjID() == obj->getObjID()) {
-            // Object type (not instance!) is already in the list, do nothing
-            return;
-        }
-    }
+    // Object type (not instance!) already in the list, do nothing
+    if (objTimes.contains(obj->getObjID()))
+        return;
 
-    // If this point is reached, then the object type is new, let's add it
     ObjectTimeInfo timeInfo;
     timeInfo.obj = obj;
-    timeInfo.timeToNextUpdateMs = 0;
     timeInfo.updatePeriodMs = 0;
-    objList.append(timeInfo);
+    timeInfo.nextUpdateMs = 0;
+    timeInfo.generation = 0;
+    objTimes.insert(obj->getObjID(), timeInfo);
 }
 
 /**
@@ -164,16 +185,65 @@ void Telemetry::addObject(UAVObject *obj)
 void Telemetry::setUpdatePeriod(UAVObject *obj, qint32 periodMs)
 {
     // Find object type (not instance!) and update its period
-    const quint32 objID = obj->getObjID();
-
-    const QVector<ObjectTimeInfo>::iterator iterEnd = objList.end();
-    for (QVector<ObjectTimeInfo>::iterator iter = objList.begin(); iter != iterEnd; ++iter) {
-        if (iter->obj->getObjID() == objID) {
-            iter->updatePeriodMs = periodMs;
-            iter->timeToNextUpdateMs = quint32((float)periodMs * (float)qrand()
-                                               / (float)RAND_MAX); // avoid bunching of updates
+    QHash<quint32, ObjectTimeInfo>::iterator iter = objTimes.find(obj->getObjID());
+    if (iter == objTimes.end())
+        return;
+
+    // Any entry already in the schedule for this object is now stale
+    iter->generation++;
+    iter->updatePeriodMs = periodMs;
+
+    if (periodMs > 0) {
+        // Random phase to avoid bunching of updates
+        iter->nextUpdateMs = updateClock.elapsed()
+            + qint64((float)periodMs * (float)qrand() / (float)RAND_MAX);
+        scheduleUpdate(*iter);
+        rescheduleTimer();
+    }
+}
+
+/**
+ * Push the next update of an object on the schedule heap
+ */
+void Telemetry::scheduleUpdate(const ObjectTimeInfo &timeInfo)
+{
+    // Stale entries are only dropped when they reach the top; compact the
+    // heap if period changes have left too many of them behind
+    if (schedule.size() > 2 * objTimes.size() + 16) {
+        QVector<ScheduleEntry> live;
+        foreach (const ScheduleEntry &entry, schedule) {
+            QHash<quint32, ObjectTimeInfo>::const_iterator info = objTimes.constFind(entry.objId);
+            if (info != objTimes.constEnd() && info->generation == entry.generation)
+                live.append(entry);
         }
+        schedule.swap(live);
+        std::make_heap(schedule.begin(), schedule.end(), std::greater<ScheduleEntry>());
+    }
+
+    ScheduleEntry entry;
+    entry.deadlineMs = timeInfo.nextUpdateMs;
+    entry.objId = timeInfo.obj->getObjID();
+    entry.generation = timeInfo.generation;
+    schedule.append(entry);
+    std::push_heap(schedule.begin(), schedule.end(), std::greater<ScheduleEntry>());
+}
+
+/**
+ * Arm the update timer for the earliest scheduled deadline
+ */
+void Telemetry::rescheduleTimer()
+{
+    if (schedule.isEmpty()) {
+        updateTimer->stop();
+        return;
     }
+
+    qint64 delay = schedule.first().deadlineMs - updateClock.elapsed();
+    delay = qBound<qint64>(MIN_UPDATE_PERIOD_MS, delay, MAX_UPDATE_PERIOD_MS);
+
+    // Only move the timer earlier; a later expiry just finds nothing due
+    if (!updateTimer->isActive() || updateTimer->remainingTime() > delay)
+        updateTimer->start(delay);
 }
 
 /**
@@ -356,44 +426,146 @@ void Telemetry::transactionRequestCompleted(UAVObject *obj)
  */
 bool Telemetry::updateTransactionMap(UAVObject *obj, bool request)
 {
-    TransactionKey key(obj, request);
-    QMap<TransactionKey, ObjectTransactionInfo *>::iterator itr = transMap.find(key);
+    QMap<TransactionKey, int>::iterator itr = transMap.find(TransactionKey(obj, request));
     if (itr != transMap.end()) {
-        ObjectTransactionInfo *transInfo = itr.value();
-        // Remove this transaction as it is complete.
-        transInfo->timer->stop();
-        transMap.remove(key);
-        delete transInfo;
+        // Remove this transaction as it is complete; its deadline goes stale
+        releaseTransaction(itr.value());
+        transMap.erase(itr);
         return true;
     }
     return false;
 }
 
 /**
- * Called when a transaction is not completed within the timeout period (timer event)
+ * Take a transaction record from the pool
  */
-void Telemetry::transactionTimeout(ObjectTransactionInfo *transInfo)
+int Telemetry::allocTransaction()
 {
-    transInfo->timer->stop();
+    int slot;
+    if (freeTransSlots.isEmpty()) {
+        slot = transPool.size();
+        transPool.append(ObjectTransactionInfo());
+    } else {
+        slot = freeTransSlots.takeLast();
+    }
+
+    ObjectTransactionInfo &transInfo = transPool[slot];
+    transInfo.obj = NULL;
+    transInfo.allInstances = false;
+    transInfo.objRequest = false;
+    transInfo.acked = false;
+    transInfo.inUse = true;
+    transInfo.retriesRemaining = retryPolicy.maxRetries;
+    transInfo.timeoutMs = retryPolicy.timeoutMs;
+    transInfo.serial = ++transSerial;
+    return slot;
+}
+
+void Telemetry::releaseTransaction(int slot)
+{
+    transPool[slot].inUse = false;
+    transPool[slot].obj = NULL;
+    freeTransSlots.append(slot);
+}
+
+/**
+ * Push the timeout of the attempt in flight on the deadline heap
+ */
+void Telemetry::scheduleTimeout(int slot)
+{
+    // Completed transactions leave their deadline behind until it comes up;
+    // compact the heap if a burst of them has piled up
+    if (transDeadlines.size() > 2 * (transPool.size() - freeTransSlots.size()) + 16) {
+        QVector<TransactionDeadline> live;
+        foreach (const TransactionDeadline &entry, transDeadlines) {
+            const ObjectTransactionInfo &transInfo = transPool.at(entry.slot);
+            if (transInfo.inUse && transInfo.serial == entry.serial)
+                live.append(entry);
+        }
+        transDeadlines.swap(live);
+        std::make_heap(transDeadlines.begin(), transDeadlines.end(),
+                       std::greater<TransactionDeadline>());
+    }
+
+    TransactionDeadline entry;
+    entry.deadlineMs = updateClock.elapsed() + transPool.at(slot).timeoutMs;
+    entry.slot = slot;
+    entry.serial = transPool.at(slot).serial;
+    transDeadlines.append(entry);
+    std::push_heap(transDeadlines.begin(), transDeadlines.end(),
+                   std::greater<TransactionDeadline>());
+
+    rescheduleTransTimer();
+}
+
+/**
+ * Arm the transaction timer for the earliest deadline
+ */
+void Telemetry::rescheduleTransTimer()
+{
+    if (transDeadlines.isEmpty()) {
+        transTimer->stop();
+        return;
+    }
+
+    qint64 delay = qMax<qint64>(transDeadlines.first().deadlineMs - updateClock.elapsed(), 0);
+
+    // Only move the timer earlier; a later expiry just finds nothing due
+    if (!transTimer->isActive() || transTimer->remainingTime() > delay)
+        transTimer->start(delay);
+}
+
+/**
+ * Retry or fail the transactions whose deadline has passed
+ */
+void Telemetry::processTransactionTimeouts()
+{
+    const qint64 now = updateClock.elapsed();
+
+    while (!transDeadlines.isEmpty() && transDeadlines.first().deadlineMs <= now) {
+        TransactionDeadline entry = transDeadlines.first();
+        std::pop_heap(transDeadlines.begin(), transDeadlines.end(),
+                      std::greater<TransactionDeadline>());
+        transDeadlines.removeLast();
+
+        const ObjectTransactionInfo &transInfo = transPool.at(entry.slot);
+        if (!transInfo.inUse || transInfo.serial != entry.serial)
+            continue; // Completed before its deadline
+
+        transactionTimeout(entry.slot);
+    }
+
+    rescheduleTransTimer();
+}
+
+/**
+ * Called when a transaction is not completed within the timeout period
+ */
+void Telemetry::transactionTimeout(int slot)
+{
+    ObjectTransactionInfo &transInfo = transPool[slot];
+    UAVObject *obj = transInfo.obj;
+
     // Check if more retries are pending
-    if (transInfo->retriesRemaining > 0) {
+    if (transInfo.retriesRemaining > 0) {
         qInfo() << QString("[telemetry.cpp] Transaction timeout:%0 Instance:%1 Retrying")
-                .arg(transInfo->obj->getName()
+                .arg(obj->getName()
                      + QString(QString(" 0x")
-                               + QString::number(transInfo->obj->getObjID(), 16).toUpper()))
-                .arg(transInfo->obj->getInstID());
-        --transInfo->retriesRemaining;
-        processObjectTransaction(transInfo);
+                               + QString::number(obj->getObjID(), 16).toUpper()))
+                .arg(obj->getInstID());
+        --transInfo.retriesRemaining;
+        transInfo.timeoutMs =
+            qMin((int)(transInfo.timeoutMs * retryPolicy.backoff), retryPolicy.maxTimeoutMs);
+        processObjectTransaction(slot);
         ++txRetries;
     } else {
         qInfo() << QString("[telemetry.cpp] Transaction timeout:%0 Instance:%1 no more retries. FAILED "
                     "TRANSACT")
-                .arg(transInfo->obj->getName()
+                .arg(obj->getName()
                      + QString(QString(" 0x")
-                               + QString::number(transInfo->obj->getObjID(), 16).toUpper()))
-                .arg(transInfo->obj->getInstID());
-        transInfo->timer->stop();
-        transactionFailure(transInfo->obj);
+                               + QString::number(obj->getObjID(), 16).toUpper()))
+                .arg(obj->getInstID());
+        transactionFailure(obj);
         ++txErrors;
     }
 }
@@ -415,7 +587,7 @@ QByteArray *Telemetry::downloadFile(quint32 fileId, quint32 maxSize,
         sizeGuess = maxSize;
     }
 
-    result->reserve(maxSize);
+    result->reserve(sizeGuess);
 
     bool newReqNeeded = false;
     bool completed = false;
@@ -468,7 +640,7 @@ QByteArray *Telemetry::downloadFile(quint32 fileId, quint32 maxSize,
             );
 
     while (curOffset < maxSize && (!completed)) {
-        utalk->requestFile(fileId, curOffset);
+        utalk->requestFile(fileId, curOffset, FILE_REQ_WINDOW);
 
         newReqNeeded = false;
         inactivityCount = 0;
@@ -497,22 +669,23 @@ QByteArray *Telemetry::downloadFile(quint32 fileId, quint32 maxSize,
 /**
  * Start an object transaction with UAVTalk, all information is stored in transInfo.
  */
-void Telemetry::processObjectTransaction(ObjectTransactionInfo *transInfo)
+void Telemetry::processObjectTransaction(int slot)
 {
+    const ObjectTransactionInfo transInfo = transPool.at(slot);
 
     // Initiate transaction
-    if (transInfo->objRequest) { // We are requesting an object from the remote end
-        utalk->sendObjectRequest(transInfo->obj, transInfo->allInstances);
+    if (transInfo.objRequest) { // We are requesting an object from the remote end
+        utalk->sendObjectRequest(transInfo.obj, transInfo.allInstances);
     } else { // We are sending an object to the remote end
-        utalk->sendObject(transInfo->obj, transInfo->acked, transInfo->allInstances);
+        utalk->sendObject(transInfo.obj, transInfo.acked, transInfo.allInstances);
     }
-    // Start timer if a response is expected
-    if (transInfo->objRequest || transInfo->acked) {
-        transInfo->timer->start(REQ_TIMEOUT_MS);
+    // Set a deadline if a response is expected
+    if (transInfo.objRequest || transInfo.acked) {
+        scheduleTimeout(slot);
     } else {
         // Stop tracking this transaction, since we're not expecting a response:
-        transMap.remove(TransactionKey(transInfo->obj, transInfo->objRequest));
-        delete transInfo;
+        transMap.remove(TransactionKey(transInfo.obj, transInfo.objRequest));
+        releaseTransaction(slot);
     }
 }
 
@@ -603,22 +776,16 @@ void Telemetry::processObjectQueue()
             // We will not re-request it, then, we should wait for a timeout or success...
         } else {
             UAVObject::Metadata metadata = objInfo.obj->getMetadata();
-            ObjectTransactionInfo *transInfo = new ObjectTransactionInfo(this);
-            transInfo->obj = objInfo.obj;
-            transInfo->allInstances = objInfo.allInstances;
-            transInfo->retriesRemaining = MAX_RETRIES;
-            transInfo->acked = UAVObject::GetGcsTelemetryAcked(metadata);
-            if (objInfo.event == EV_UPDATED || objInfo.event == EV_UPDATED_MANUAL
-                || objInfo.event == EV_UPDATED_PERIODIC) {
-                transInfo->objRequest = false;
-            } else if (objInfo.event == EV_UPDATE_REQ) {
-                transInfo->objRequest = true;
-            }
-            transInfo->telem = this;
+            int slot = allocTransaction();
+            ObjectTransactionInfo &transInfo = transPool[slot];
+            transInfo.obj = objInfo.obj;
+            transInfo.allInstances = objInfo.allInstances;
+            transInfo.acked = UAVObject::GetGcsTelemetryAcked(metadata);
+            transInfo.objRequest = (objInfo.event == EV_UPDATE_REQ);
             // Insert the transaction into the transaction map.
-            TransactionKey key(objInfo.obj, transInfo->objRequest);
-            transMap.insert(key, transInfo);
-            processObjectTransaction(transInfo);
+            TransactionKey key(objInfo.obj, transInfo.objRequest);
+            transMap.insert(key, slot);
+            processObjectTransaction(slot);
         }
     }
 
@@ -650,58 +817,35 @@ void Telemetry::processObjectQueue()
 }
 
 /**
- * @brief Telemetry::processPeriodicUpdates Check if any objects are pending for periodic updates
+ * @brief Telemetry::processPeriodicUpdates Send the objects whose periodic
+ * update is due. Only due objects are touched; deadlines advance by whole
+ * periods so send times stay phase-stable.
  */
 void Telemetry::processPeriodicUpdates()
 {
-    // Stop timer
-    updateTimer->stop();
-
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update (will be used for setting timeToNextUpdateMs)
-    qint32 minDelay = MAX_UPDATE_PERIOD_MS;
-    qint32 elapsedMs = 0;
-    QTime time;
-    qint32 offset;
-
-    const QVector<ObjectTimeInfo>::iterator objInfoEnd = objList.end();
-    for (QVector<ObjectTimeInfo>::iterator objinfo = objList.begin(); objinfo != objInfoEnd;
-         ++objinfo) {
-        // If object is configured for periodic updates
-        // FixMe: This is an inefficient process as it depends on polling. It would be better to
-        // have
-        // this functionality be driven through timers.
-        if (objinfo->updatePeriodMs > 0) {
-            objinfo->timeToNextUpdateMs -= timeToNextUpdateMs;
-            // Check if time for the next update
-            if (objinfo->timeToNextUpdateMs <= 0) {
-                // Reset timer
-                offset = (-objinfo->timeToNextUpdateMs) % objinfo->updatePeriodMs;
-                objinfo->timeToNextUpdateMs = objinfo->updatePeriodMs - offset;
-                // Send object
-                time.start();
-                processObjectUpdates(objinfo->obj, EV_UPDATED_PERIODIC, true, false);
-                elapsedMs = time.elapsed();
-                // Update timeToNextUpdateMs with the elapsed delay of sending the object;
-                timeToNextUpdateMs += elapsedMs;
-            }
-            // Update minimum delay
-            if (objinfo->timeToNextUpdateMs < minDelay) {
-                minDelay = objinfo->timeToNextUpdateMs;
-            }
-        }
-    }
-
-    // Check if delay for the next update is too short
-    if (minDelay < MIN_UPDATE_PERIOD_MS) {
-        minDelay = MIN_UPDATE_PERIOD_MS;
+    const qint64 now = updateClock.elapsed();
+
+    while (!schedule.isEmpty() && schedule.first().deadlineMs <= now) {
+        ScheduleEntry entry = schedule.first();
+        std::pop_heap(schedule.begin(), schedule.end(), std::greater<ScheduleEntry>());
+        schedule.removeLast();
+
+        QHash<quint32, ObjectTimeInfo>::iterator info = objTimes.find(entry.objId);
+        if (info == objTimes.end() || info->generation != entry.generation
+            || info->updatePeriodMs <= 0)
+            continue; // Period changed since this entry was scheduled
+
+        // Advance to the first deadline in the future, skipping missed periods
+        info->nextUpdateMs += info->updatePeriodMs;
+        if (info->nextUpdateMs <= now)
+            info->nextUpdateMs +=
+                ((now - info->nextUpdateMs) / info->updatePeriodMs + 1) * info->updatePeriodMs;
+        scheduleUpdate(*info);
+
+        processObjectUpdates(info->obj, EV_UPDATED_PERIODIC, true, false);
     }
 
-    // Done
-    timeToNextUpdateMs = minDelay;
-
-    // Restart timer
-    updateTimer->start(timeToNextUpdateMs);
+    rescheduleTimer();
 }
 
 Telemetry::TelemetryStats Telemetry::getStats()
@@ -720,6 +864,8 @@ Telemetry::TelemetryStats Telemetry::getStats()
     stats.txErrors = utalkStats.txErrors + txErrors;
     stats.rxErrors = utalkStats.rxErrors;
     stats.txRetries = txRetries;
+    stats.rxLost = utalkStats.rxLost;
+    stats.rxReordered = utalkStats.rxReordered;
 
     txErrors = 0;
     txRetries = 0;
@@ -767,31 +913,3 @@ void Telemetry::newInstance(UAVObject *obj)
 {
     registerObject(obj);
 }
-
-ObjectTransactionInfo::ObjectTransactionInfo(QObject *parent)
-    : QObject(parent)
-{
-    obj = 0;
-    allInstances = false;
-    objRequest = false;
-    retriesRemaining = 0;
-    acked = false;
-    telem = 0;
-    // Setup transaction timer
-    timer = new QTimer(this);
-    timer->stop();
-    connect(timer, &QTimer::timeout, this, &ObjectTransactionInfo::timeout);
-}
-
-ObjectTransactionInfo::~ObjectTransactionInfo()
-{
-    telem = 0;
-    timer->stop();
-    timer->deleteLater();
-}
-
-void ObjectTransactionInfo::timeout()
-{
-    if (!telem.isNull())
-        telem->transactionTimeout(this);
-}
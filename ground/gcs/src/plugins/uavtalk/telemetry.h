@@ -42,27 +42,11 @@
 #include <QTimer>
 #include <QQueue>
 #include <QMap>
+#include <QHash>
+#include <QElapsedTimer>
 
 class TransactionKey;
 
-class ObjectTransactionInfo : public QObject
-{
-    Q_OBJECT
-
-public:
-    ObjectTransactionInfo(QObject *parent);
-    ~ObjectTransactionInfo();
-    UAVObject *obj;
-    bool allInstances;
-    bool objRequest;
-    qint32 retriesRemaining;
-    bool acked;
-    QPointer<class Telemetry> telem;
-    QTimer *timer;
-private slots:
-    void timeout();
-};
-
 class Telemetry : public QObject
 {
     Q_OBJECT
@@ -79,28 +63,43 @@ public:
         quint32 txErrors;
         quint32 rxErrors;
         quint32 txRetries;
+        quint32 rxLost;
+        quint32 rxReordered;
     } TelemetryStats;
 
+    /**
+     * How long to wait for an ACK or a requested object, and how often to retry
+     */
+    struct RetryPolicy
+    {
+        int timeoutMs; /** Of the first attempt */
+        int maxRetries;
+        double backoff; /** Timeout multiplier for each retry */
+        int maxTimeoutMs;
+    };
+
     Telemetry(UAVTalk *utalk, UAVObjectManager *objMngr);
     ~Telemetry();
     TelemetryStats getStats();
     QByteArray *downloadFile(quint32 fileId, quint32 maxSize,
             std::function<void(quint32)>progressCb = nullptr);
 
-    void transactionTimeout(ObjectTransactionInfo *info);
+    static RetryPolicy defaultRetryPolicy();
+    void setRetryPolicy(const RetryPolicy &policy);
 
 signals:
 
 private:
     // Constants
 
-    // TODO: Would be nice to dynamically scale the request timeout... 
+    // Defaults of the retry policy
     // This 1500 value is about what's necessary for 9600bps uavtalk links.
     static const int REQ_TIMEOUT_MS = 1500;
     static const int MAX_RETRIES = 4;
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
     static const int MAX_QUEUE_SIZE = 20;
+    static const quint8 FILE_REQ_WINDOW = 16; // data messages per file request
 
     // Types
     /**
@@ -119,9 +118,22 @@ private:
     {
         UAVObject *obj;
         qint32 updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-        qint32 timeToNextUpdateMs; /** Time delay to the next update */
+        qint64 nextUpdateMs; /** Deadline of the next update on updateClock */
+        quint32 generation; /** Bumped on every period change to retire stale schedule entries */
     } ObjectTimeInfo;
 
+    /**
+     * Entry of the periodic update min-heap, ordered by deadline
+     */
+    struct ScheduleEntry
+    {
+        qint64 deadlineMs;
+        quint32 objId;
+        quint32 generation;
+
+        bool operator>(const ScheduleEntry &other) const { return deadlineMs > other.deadlineMs; }
+    };
+
     typedef struct
     {
         UAVObject *obj;
@@ -129,17 +141,56 @@ private:
         bool allInstances;
     } ObjectQueueInfo;
 
+    /**
+     * Transaction awaiting an ACK, NACK or the object requested. Records are
+     * pooled and reused; the serial tells a reused record from the one a
+     * deadline was set for
+     */
+    typedef struct
+    {
+        UAVObject *obj;
+        bool allInstances;
+        bool objRequest;
+        bool acked;
+        bool inUse;
+        qint32 retriesRemaining;
+        qint32 timeoutMs; /** Of the attempt in flight */
+        quint32 serial;
+    } ObjectTransactionInfo;
+
+    /**
+     * Entry of the transaction timeout min-heap, ordered by deadline
+     */
+    struct TransactionDeadline
+    {
+        qint64 deadlineMs;
+        int slot;
+        quint32 serial;
+
+        bool operator>(const TransactionDeadline &other) const
+        {
+            return deadlineMs > other.deadlineMs;
+        }
+    };
+
     // Variables
     UAVObjectManager *objMngr;
     UAVTalk *utalk;
     GCSTelemetryStats *gcsStatsObj;
-    QVector<ObjectTimeInfo> objList;
+    QHash<quint32, ObjectTimeInfo> objTimes;
+    QVector<ScheduleEntry> schedule;
+    QElapsedTimer updateClock;
     QQueue<ObjectQueueInfo> objQueue;
     QQueue<ObjectQueueInfo> objPriorityQueue;
-    QMap<TransactionKey, ObjectTransactionInfo *> transMap;
+    QVector<ObjectTransactionInfo> transPool;
+    QVector<int> freeTransSlots;
+    QMap<TransactionKey, int> transMap; /** Pool slot of each transaction in flight */
+    QVector<TransactionDeadline> transDeadlines;
+    quint32 transSerial;
+    RetryPolicy retryPolicy;
     QTimer *updateTimer;
+    QTimer *transTimer;
     QTimer *statsTimer;
-    qint32 timeToNextUpdateMs;
     quint32 txErrors;
     quint32 txRetries;
 
@@ -147,10 +198,17 @@ private:
     void registerObject(UAVObject *obj);
     void addObject(UAVObject *obj);
     void setUpdatePeriod(UAVObject *obj, qint32 periodMs);
+    void scheduleUpdate(const ObjectTimeInfo &timeInfo);
+    void rescheduleTimer();
     void connectToObjectInstances(UAVObject *obj, quint32 eventMask);
     void updateObject(UAVObject *obj, quint32 eventMask);
     void processObjectUpdates(UAVObject *obj, EventMask event, bool allInstances, bool priority);
-    void processObjectTransaction(ObjectTransactionInfo *transInfo);
+    int allocTransaction();
+    void releaseTransaction(int slot);
+    void processObjectTransaction(int slot);
+    void scheduleTimeout(int slot);
+    void rescheduleTransTimer();
+    void transactionTimeout(int slot);
     void processObjectQueue();
     bool updateTransactionMap(UAVObject *obj, bool request);
 
@@ -164,6 +222,7 @@ private slots:
     void newObject(UAVObject *obj);
     void newInstance(UAVObject *obj);
     void processPeriodicUpdates();
+    void processTransactionTimeouts();
     void transactionSuccess(UAVObject *obj);
     void transactionFailure(UAVObject *obj);
     void transactionRequestCompleted(UAVObject *obj);
@@ -0,0 +1,243 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrydeltaserver.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Serves decoded object changes to lightweight clients
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "telemetrydeltaserver.h"
+#include "uavobjects/uavdataobject.h"
+#include "uavobjects/uavobjectfield.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QScopedPointer>
+#include <QTimer>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+#include <string.h>
+
+TelemetryDeltaServer::TelemetryDeltaServer(UAVObjectManager *objMngr, quint16 port,
+                                           const QStringList &objects, int intervalMs,
+                                           QObject *parent)
+    : QObject(parent)
+    , objMngr(objMngr)
+{
+    foreach (const QString &name, objects) {
+        if (objMngr->getObject(name))
+            servedObjects.insert(name);
+        else
+            qWarning() << "[TelemetryDeltaServer] Unknown object" << name;
+    }
+
+    foreach (const QVector<UAVDataObject *> &instances, objMngr->getDataObjectsVector()) {
+        foreach (UAVDataObject *obj, instances)
+            connectObject(obj);
+    }
+    connect(objMngr, &UAVObjectManager::newInstance, this,
+            [this](UAVObject *obj) { connectObject(obj); });
+
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &TelemetryDeltaServer::acceptClients);
+    if (!server->listen(QHostAddress::Any, port))
+        qWarning() << "[TelemetryDeltaServer] Can't listen on port" << port
+                   << server->errorString();
+
+    timer = new QTimer(this);
+    connect(timer, &QTimer::timeout, this, &TelemetryDeltaServer::sendDeltas);
+    timer->start(qMax(intervalMs, 10));
+}
+
+TelemetryDeltaServer::~TelemetryDeltaServer()
+{
+    while (!clients.isEmpty())
+        removeClient(clients.first());
+}
+
+bool TelemetryDeltaServer::isListening() const
+{
+    return server->isListening();
+}
+
+void TelemetryDeltaServer::connectObject(UAVObject *obj)
+{
+    if (!servedObjects.isEmpty() && !servedObjects.contains(obj->getName()))
+        return;
+
+    // Clients don't need more than one update per UI frame, let alone per interval
+    connect(obj, &UAVObject::objectUpdatedCoalesced, this, &TelemetryDeltaServer::objectUpdated);
+}
+
+void TelemetryDeltaServer::acceptClients()
+{
+    while (server->hasPendingConnections()) {
+        Client *client = new Client;
+        client->socket = server->nextPendingConnection();
+        client->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        // Gets all objects with the next deltas
+        client->stale = true;
+        clients.append(client);
+
+        qDebug() << "[TelemetryDeltaServer] Client" << client->socket->peerAddress().toString()
+                 << "connected";
+
+        // Nothing is taken from clients
+        connect(client->socket, &QTcpSocket::readyRead, this,
+                [client]() { client->socket->readAll(); });
+        connect(client->socket, &QTcpSocket::disconnected, this,
+                [this, client]() { removeClient(client); }, Qt::QueuedConnection);
+    }
+}
+
+void TelemetryDeltaServer::objectUpdated(UAVObject *obj)
+{
+    dirty.insert(obj);
+}
+
+/**
+ * @brief Send the fields changed over the last interval, and bring new or
+ * lagging clients up to date
+ */
+void TelemetryDeltaServer::sendDeltas()
+{
+    QByteArray deltas;
+
+    foreach (UAVObject *obj, dirty) {
+        QByteArray data(obj->getNumBytes(), 0);
+        obj->pack((quint8 *)data.data());
+
+        deltas.append(buildMessage(obj, obj, data, sent.value(obj)));
+        sent.insert(obj, data);
+    }
+    dirty.clear();
+
+    foreach (Client *client, clients) {
+        if (!client->stale)
+            sendToClient(client, deltas);
+        else if (client->socket->bytesToWrite() == 0)
+            sendSnapshot(client);
+    }
+}
+
+/**
+ * @brief Send every object seen so far with all its fields
+ */
+void TelemetryDeltaServer::sendSnapshot(Client *client)
+{
+    QByteArray snapshot;
+
+    // The objects may have moved on since, and the deltas continue from what was sent
+    for (QHash<UAVObject *, QByteArray>::const_iterator it = sent.constBegin();
+         it != sent.constEnd(); ++it) {
+        UAVDataObject *obj = dynamic_cast<UAVDataObject *>(it.key());
+        if (!obj)
+            continue;
+
+        QScopedPointer<UAVDataObject> values(obj->dirtyClone());
+        values->unpack((const quint8 *)it.value().constData());
+        snapshot.append(buildMessage(obj, values.data(), it.value(), QByteArray()));
+    }
+
+    client->stale = false;
+    client->socket->write(snapshot);
+}
+
+void TelemetryDeltaServer::sendToClient(Client *client, const QByteArray &message)
+{
+    if (message.isEmpty())
+        return;
+
+    // A slow client skips deltas until it has caught up, then gets everything again
+    if (client->socket->bytesToWrite() + message.size() > CLIENT_BACKLOG_SIZE) {
+        client->stale = true;
+        return;
+    }
+
+    client->socket->write(message);
+}
+
+void TelemetryDeltaServer::removeClient(Client *client)
+{
+    if (!clients.removeOne(client))
+        return;
+
+    qDebug() << "[TelemetryDeltaServer] Client" << client->socket->peerAddress().toString()
+             << "disconnected";
+
+    client->socket->disconnect(this);
+    client->socket->deleteLater();
+    delete client;
+}
+
+/**
+ * @brief Encode the fields of an object that differ from the previous data
+ * @param obj the object
+ * @param values object holding data, obj itself or a scratch copy
+ * @param data packed object data
+ * @param previous packed data the clients have, empty for none
+ * @return one message line, empty if nothing changed
+ */
+QByteArray TelemetryDeltaServer::buildMessage(UAVObject *obj, UAVObject *values,
+                                              const QByteArray &data, const QByteArray &previous)
+{
+    QJsonObject fields;
+
+    foreach (UAVObjectField *field, values->getFields()) {
+        quint32 offset = field->getDataOffset();
+        quint32 bytes = field->getNumBytes();
+
+        if (!previous.isEmpty()
+            && !memcmp(data.constData() + offset, previous.constData() + offset, bytes))
+            continue;
+
+        if (field->getNumElements() == 1) {
+            fields.insert(field->getName(), QJsonValue::fromVariant(field->getValue()));
+        } else {
+            QJsonArray values;
+            for (quint32 i = 0; i < field->getNumElements(); i++)
+                values.append(QJsonValue::fromVariant(field->getValue(i)));
+            fields.insert(field->getName(), values);
+        }
+    }
+
+    if (fields.isEmpty())
+        return QByteArray();
+
+    QJsonObject message;
+    message.insert("obj", obj->getName());
+    message.insert("inst", (int)obj->getInstID());
+    message.insert("fields", fields);
+
+    return QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+}
+
+/**
+ * @}
+ * @}
+ */
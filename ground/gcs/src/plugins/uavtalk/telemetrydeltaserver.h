@@ -0,0 +1,116 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetrydeltaserver.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2017
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Serves decoded object changes to lightweight clients
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef TELEMETRYDELTASERVER_H
+#define TELEMETRYDELTASERVER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include "uavobjects/uavobjectmanager.h"
+
+class QTcpServer;
+class QTcpSocket;
+class QTimer;
+
+/**
+ * @brief Serves the objects of the vehicle link, already decoded, to clients
+ * that can't afford running UAVTalk and the object model themselves, e.g.
+ * the Android app.
+ *
+ * Clients connect over TCP and read one compact JSON message per line:
+ *
+ *   {"obj":"AttitudeActual","inst":0,"fields":{"Roll":1.5,"Yaw":-90}}
+ *
+ * A new client first gets every object seen so far with all its fields.
+ * After that, updates are collected for an interval and only the fields
+ * that changed since the last message are sent. Field values are numbers,
+ * or the option name for enums; fields with several elements are arrays.
+ *
+ * The service is read only: nothing a client sends is passed on.
+ */
+class TelemetryDeltaServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param objMngr object manager of the vehicle link
+     * @param port TCP port to listen on
+     * @param objects names of the objects to serve, empty for all
+     * @param intervalMs period updates are collected for
+     */
+    TelemetryDeltaServer(UAVObjectManager *objMngr, quint16 port, const QStringList &objects,
+                         int intervalMs, QObject *parent = 0);
+    ~TelemetryDeltaServer();
+
+    bool isListening() const;
+    int clientCount() const { return clients.size(); }
+
+private slots:
+    void acceptClients();
+    void objectUpdated(UAVObject *obj);
+    void sendDeltas();
+
+private:
+    // Most a client may have waiting; beyond that it is resynchronised
+    static const int CLIENT_BACKLOG_SIZE = 64 * 1024;
+
+    struct Client
+    {
+        QTcpSocket *socket;
+        bool stale; // Missed deltas, needs all objects again
+    };
+
+    void connectObject(UAVObject *obj);
+    void sendSnapshot(Client *client);
+    void sendToClient(Client *client, const QByteArray &message);
+    void removeClient(Client *client);
+    static QByteArray buildMessage(UAVObject *obj, UAVObject *values, const QByteArray &data,
+                                   const QByteArray &previous);
+
+    UAVObjectManager *objMngr;
+    QTcpServer *server;
+    QTimer *timer;
+    QSet<QString> servedObjects;
+    QHash<UAVObject *, QByteArray> sent; // Object data as last sent to clients
+    QSet<UAVObject *> dirty;
+    QList<Client *> clients;
+};
+
+#endif // TELEMETRYDELTASERVER_H
+
+/**
+ * @}
+ * @}
+ */
@@ -30,7 +30,11 @@
 #include <coreplugin/icore.h>
 
 TelemetryManager::TelemetryManager()
-    : m_connected(false)
+    : relay(NULL)
+    , deltaServer(NULL)
+    , speedNegotiator(NULL)
+    , linkLatency(NULL)
+    , m_connected(false)
 {
     // Get UAVObjectManager instance
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -49,21 +53,81 @@ TelemetryManager::~TelemetryManager()
 
 void TelemetryManager::start(QIODevice *dev)
 {
-    utalk = new UAVTalk(dev, objMngr);
+    // Serial links may be stepped up to a faster speed, see SerialConnection
+    quint32 speed = dev->property("baudRate").toUInt();
+    quint32 maxSpeed = dev->property("negotiateSpeedTo").toUInt();
+
+    // Service the link from its own thread so GUI load doesn't stall it
+    utalk = new UAVTalk(dev, objMngr, true);
     telemetry = new Telemetry(utalk, objMngr);
+
+    // Slow or congested links may want longer timeouts, backing off on retries
+    QSettings *qs = Core::ICore::instance()->settings();
+    qs->beginGroup("TelemetryRetries");
+    Telemetry::RetryPolicy policy = Telemetry::defaultRetryPolicy();
+    policy.timeoutMs = qs->value("TimeoutMs", policy.timeoutMs).toInt();
+    policy.maxRetries = qs->value("MaxRetries", policy.maxRetries).toInt();
+    policy.backoff = qs->value("Backoff", policy.backoff).toDouble();
+    policy.maxTimeoutMs = qs->value("MaxTimeoutMs", 8 * policy.timeoutMs).toInt();
+    telemetry->setRetryPolicy(policy);
+    qs->endGroup();
+
     telemetryMon = new TelemetryMonitor(objMngr, telemetry, sessions);
     connect(telemetryMon, &TelemetryMonitor::connected, this, &TelemetryManager::onConnect);
     connect(telemetryMon, &TelemetryMonitor::disconnected, this, &TelemetryManager::onDisconnect);
+    connect(telemetryMon, &TelemetryMonitor::statsUpdated, this,
+            &TelemetryManager::telemetryStatsUpdated);
+
+    if (speed > 0 && maxSpeed > speed) {
+        speedNegotiator = new SpeedNegotiator(utalk, objMngr, speed, maxSpeed);
+        connect(telemetryMon, &TelemetryMonitor::connected, speedNegotiator,
+                &SpeedNegotiator::start);
+        connect(telemetryMon, &TelemetryMonitor::linkStatsUpdated, speedNegotiator,
+                &SpeedNegotiator::linkStatsUpdated);
+    }
+
+    linkLatency = new LinkLatency(utalk, objMngr);
+    connect(telemetryMon, &TelemetryMonitor::connected, linkLatency, &LinkLatency::start);
+    connect(telemetryMon, &TelemetryMonitor::disconnected, linkLatency, &LinkLatency::stop);
+
+    // Optionally share the link with other ground stations
+    qs->beginGroup("TelemetryRelay");
+    int port = qs->value("Port", 0).toInt();
+    if (port > 0 && port < 65536) {
+        relay = new TelemetryRelay(utalk, objMngr, port,
+                                   QHostAddress(qs->value("Master").toString()),
+                                   qs->value("Objects").toStringList());
+    }
+    qs->endGroup();
+
+    // Optionally serve decoded changes to clients without UAVTalk, e.g. phones
+    qs->beginGroup("TelemetryDeltaServer");
+    port = qs->value("Port", 0).toInt();
+    if (port > 0 && port < 65536) {
+        deltaServer = new TelemetryDeltaServer(objMngr, port, qs->value("Objects").toStringList(),
+                                               qs->value("IntervalMs", 100).toInt());
+    }
+    qs->endGroup();
 }
 
 void TelemetryManager::stop()
 {
+    delete relay;
+    relay = NULL;
+    delete deltaServer;
+    deltaServer = NULL;
+    delete speedNegotiator;
+    speedNegotiator = NULL;
+    delete linkLatency;
+    linkLatency = NULL;
     telemetryMon->disconnect(this);
     sessions = telemetryMon->savedSessions();
     telemetryMon->deleteLater();
     telemetryMon = NULL;
     telemetry->deleteLater();
     telemetry = NULL;
+    // The device is closed as soon as we return, take it back from the I/O thread
+    utalk->releaseDevice();
     utalk->deleteLater();
     utalk = NULL;
     onDisconnect();
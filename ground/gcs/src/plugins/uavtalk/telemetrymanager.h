@@ -34,6 +34,10 @@
 #include "telemetrymonitor.h"
 #include "telemetry.h"
 #include "uavtalk.h"
+#include "telemetryrelay.h"
+#include "telemetrydeltaserver.h"
+#include "speednegotiator.h"
+#include "linklatency.h"
 #include "uavobjects/uavobjectmanager.h"
 #include <QIODevice>
 #include <QObject>
@@ -57,6 +61,8 @@ signals:
     void connected();
     void disconnected();
     void connectedChanged(bool);
+    //! Telemetry stats for each stats period, as taken by the telemetry monitor
+    void telemetryStatsUpdated(const Telemetry::TelemetryStats &stats, int periodMs);
 
 private slots:
     void onConnect();
@@ -68,6 +74,10 @@ private:
     UAVTalk *utalk;
     Telemetry *telemetry;
     TelemetryMonitor *telemetryMon;
+    TelemetryRelay *relay;
+    TelemetryDeltaServer *deltaServer;
+    SpeedNegotiator *speedNegotiator;
+    LinkLatency *linkLatency;
 
     bool m_connected;
     QHash<quint16, QList<TelemetryMonitor::objStruc>> sessions;
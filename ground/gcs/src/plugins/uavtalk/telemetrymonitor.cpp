@@ -34,6 +34,7 @@
 #include "coreplugin/connectionmanager.h"
 #include "coreplugin/icore.h"
 #include "firmwareiapobj.h"
+#include "uavobjectutil/uavobjectutilmanager.h"
 
 // Number of retries for initial session object fetching
 // This is needed because sometimes the object is lost when asked right uppon connection
@@ -49,6 +50,12 @@
 #define OBJECT_RETRIEVE_TIMEOUT 5000
 // IAP object is very important, retry if not able to get it the first time
 #define IAP_OBJECT_RETRIES 3
+// A request that takes longer than this was retried by the telemetry layer
+// (see Telemetry::REQ_TIMEOUT_MS) and is treated as a lost request
+#define RETRIED_REQUEST_RTT_MS 1500
+// Round trip times above this multiple of the best observed RTT mean requests
+// are queueing behind each other on the link, so the window stops growing
+#define RTT_QUEUEING_FACTOR 2.0
 
 #ifdef TELEMETRYMONITOR_DEBUG
 #define TELEMETRYMONITOR_QXTLOG_DEBUG(...) qDebug() << __VA_ARGS__
@@ -67,6 +74,14 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel,
     , numberOfObjects(0)
     , retries(0)
     , requestsInFlight(0)
+    , rxDatagramsLost(0)
+    , rxDatagramsReordered(0)
+    , requestWindow(INITIAL_REQUEST_WINDOW)
+    , slowStartThreshold(MAX_REQUEST_WINDOW)
+    , smoothedRttMs(0)
+    , minRttMs(0)
+    , settingsCache(objMngr)
+    , digestInProgress(false)
     , isManaged(true)
     , sessions(sessions)
 {
@@ -77,6 +92,7 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel,
     flightStatsObj = FlightTelemetryStats::GetInstance(objMngr);
 
     sessionObj = SessionManaging::GetInstance(objMngr);
+    settingsDigestObj = SettingsDigest::GetInstance(objMngr);
 
     // Listen for flight stats updates
     connect(flightStatsObj, &UAVObject::objectUpdated, this, &TelemetryMonitor::flightStatsUpdated);
@@ -105,6 +121,8 @@ TelemetryMonitor::TelemetryMonitor(UAVObjectManager *objMngr, Telemetry *tel,
     connect(this, &TelemetryMonitor::telemetryUpdated, cm,
             &Core::ConnectionManager::telemetryUpdated);
     connect(sessionObj, &UAVObject::objectUnpacked, this, &TelemetryMonitor::sessionObjUnpackedCB);
+    connect(settingsDigestObj, &UAVObject::objectUnpacked, this,
+            &TelemetryMonitor::settingsDigestUnpackedCB);
     connect(objMngr, &UAVObjectManager::newInstance, this, &TelemetryMonitor::newInstanceSlot);
 
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
@@ -116,6 +134,9 @@ TelemetryMonitor::~TelemetryMonitor()
     // Before saying goodbye, set the GCS connection status to disconnected too:
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
     gcsStats.Status = GCSTelemetryStats::STATUS_DISCONNECTED;
+    // Keep any settings changes made during this connection for next time
+    if (connectionStatus == CON_CONNECTED_MANAGED || connectionStatus == CON_CONNECTED_UNMANAGED)
+        settingsCache.save();
     if (settings->useSessionManaging()) {
         foreach (UAVObjectManager::ObjectMap map, objMngr->getObjects()) {
             foreach (UAVObject *obj, map.values()) {
@@ -140,11 +161,22 @@ void TelemetryMonitor::startRetrievingObjects()
     // Get all objects, add metaobjects, settings and data objects with OnChange update mode to the
     // queue
     queue.clear();
+    deferredSettings.clear();
+    digestInProgress = false;
     retries = 0;
+    requestWindow = INITIAL_REQUEST_WINDOW;
+    slowStartThreshold = MAX_REQUEST_WINDOW;
+    smoothedRttMs = 0;
+    minRttMs = 0;
+    requestStartMs.clear();
+    retrieveClock.start();
     objectRetrieveTimeout->start(OBJECT_RETRIEVE_TIMEOUT);
+    // Boards that serve a settings digest get their settings checked against
+    // the cache once FirmwareIAPObj (which identifies the board) is known
+    bool useCache = settingsDigestObj->getIsPresentOnHardware();
     foreach (UAVObjectManager::ObjectMap map, objMngr->getObjects().values()) {
         UAVObject *obj = map.first();
-        if (obj->getObjID() == SessionManaging::OBJID) {
+        if (obj->getObjID() == SessionManaging::OBJID || obj->getObjID() == SettingsDigest::OBJID) {
             continue;
         }
         UAVDataObject *dobj = dynamic_cast<UAVDataObject *>(obj);
@@ -160,7 +192,10 @@ void TelemetryMonitor::startRetrievingObjects()
             if (dobj->isSettings()) {
                 TELEMETRYMONITOR_QXTLOG_DEBUG(
                     QString("%0 queing settings object %1").arg(Q_FUNC_INFO).arg(dobj->getName()));
-                queue.enqueue(obj);
+                if (useCache)
+                    deferredSettings.append(obj);
+                else
+                    queue.enqueue(obj);
             } else {
                 if (UAVObject::GetFlightTelemetryUpdateMode(mdata)
                     == UAVObject::UPDATEMODE_ONCHANGE) {
@@ -177,6 +212,13 @@ void TelemetryMonitor::startRetrievingObjects()
             }
         }
     }
+    if (!deferredSettings.isEmpty()) {
+        UAVObject *iapObj = objMngr->getObject(FirmwareIAPObj::OBJID);
+        if (queue.removeOne(iapObj))
+            queue.prepend(iapObj);
+        else
+            finishSettingsDigest();
+    }
     // Start retrieving
     TELEMETRYMONITOR_QXTLOG_DEBUG(
         QString(
@@ -240,7 +282,46 @@ void TelemetryMonitor::changeObjectInstances(quint32 objID, quint32 instID, bool
 }
 
 /**
- * Retrieve the next object in the queue
+ * Adapt the number of retrieval requests kept in flight.
+ *
+ * The window grows quickly (one request per completion) until the first loss,
+ * then by roughly one request per round trip. It is halved whenever a request
+ * times out or needed a retry, and holds steady while the round trip time is
+ * inflated by queueing, so that on slow links the window settles around the
+ * bandwidth-delay product instead of piling up retries.
+ * @param rttMs measured round trip time of the completed request
+ * @param lost true if the request timed out or needed a retry
+ */
+void TelemetryMonitor::updateRequestWindow(qint64 rttMs, bool lost)
+{
+    if (lost) {
+        slowStartThreshold = qMax<double>(requestWindow / 2, MIN_REQUEST_WINDOW);
+        requestWindow = slowStartThreshold;
+        return;
+    }
+
+    if (smoothedRttMs <= 0) {
+        smoothedRttMs = rttMs;
+        minRttMs = rttMs;
+    } else {
+        smoothedRttMs = 0.875 * smoothedRttMs + 0.125 * rttMs;
+        minRttMs = qMin<double>(minRttMs, rttMs);
+    }
+
+    if (smoothedRttMs > RTT_QUEUEING_FACTOR * qMax(minRttMs, 1.0))
+        return;
+
+    if (requestWindow < slowStartThreshold)
+        requestWindow += 1;
+    else
+        requestWindow += 1 / requestWindow;
+
+    requestWindow = qMin<double>(requestWindow, MAX_REQUEST_WINDOW);
+}
+
+/**
+ * Retrieve the next objects in the queue, keeping up to the current request
+ * window in flight
  */
 void TelemetryMonitor::retrieveNextObject()
 {
@@ -264,6 +345,7 @@ void TelemetryMonitor::retrieveNextObject()
             uavo->setIsPresentOnHardware(true);
         }
         delayedUpdate.clear();
+        settingsCache.save();
         emit connected();
         sessionRetrieveTimeout->stop();
         sessionInitialRetrieveTimeout->stop();
@@ -271,7 +353,7 @@ void TelemetryMonitor::retrieveNextObject()
         return;
     }
 
-    while (requestsInFlight < MAX_REQUESTS_IN_FLIGHT) {
+    while (requestsInFlight < qMax(MIN_REQUEST_WINDOW, (int)requestWindow)) {
         if (queue.isEmpty()) {
             return;
         }
@@ -285,9 +367,10 @@ void TelemetryMonitor::retrieveNextObject()
                                           .arg(obj->getInstID()));
 
         requestsInFlight++;
+        requestStartMs.insert(obj, retrieveClock.elapsed());
 
-        connect(obj, QOverload<UAVObject *, bool>::of(&UAVObject::transactionCompleted), this,
-                &TelemetryMonitor::transactionCompleted);
+        connect(obj, QOverload<UAVObject *, bool, bool>::of(&UAVObject::transactionCompleted),
+                this, &TelemetryMonitor::transactionCompleted);
         // Request update
         obj->requestUpdateAllInstances();
     }
@@ -296,17 +379,23 @@ void TelemetryMonitor::retrieveNextObject()
 /**
  * Called by the retrieved object when a transaction is completed.
  */
-void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
+void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success, bool nacked)
 {
-    TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 received %1 OBJID:%2 result:%3")
+    TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 received %1 OBJID:%2 result:%3 nacked:%4")
                                       .arg(Q_FUNC_INFO)
                                       .arg(obj->getName())
                                       .arg(obj->getObjID())
-                                      .arg(success));
-    Q_UNUSED(success);
+                                      .arg(success)
+                                      .arg(nacked));
+    qint64 rttMs = retrieveClock.elapsed() - requestStartMs.value(obj, retrieveClock.elapsed());
+    // NACKs are a complete round trip (the object is simply not on the board),
+    // only timeouts and retried requests mean the link is congested
+    updateRequestWindow(rttMs, (!success && !nacked) || rttMs > RETRIED_REQUEST_RTT_MS);
+
     if (obj->getObjID() == FirmwareIAPObj::OBJID) {
         if (!success && (retries < IAP_OBJECT_RETRIES)) {
             ++retries;
+            requestStartMs.insert(obj, retrieveClock.elapsed());
             obj->requestUpdate();
 
             return;
@@ -315,8 +404,13 @@ void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
 
     // Disconnect from sending object
     requestsInFlight--;
+    requestStartMs.remove(obj);
     obj->disconnect(this);
 
+    // The board is identified now, check the deferred settings against the cache
+    if (obj->getObjID() == FirmwareIAPObj::OBJID && !deferredSettings.isEmpty())
+        startSettingsDigest();
+
     // Process next object if telemetry is still available
     GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
     if (gcsStats.Status == GCSTelemetryStats::STATUS_CONNECTED) {
@@ -328,6 +422,9 @@ void TelemetryMonitor::transactionCompleted(UAVObject *obj, bool success)
             QString("%0 connection lost while retrieving objects, stopped object retrievel")
                 .arg(Q_FUNC_INFO));
         queue.clear();
+        requestStartMs.clear();
+        deferredSettings.clear();
+        digestInProgress = false;
         objectRetrieveTimeout->stop();
         sessionRetrieveTimeout->stop();
         sessionInitialRetrieveTimeout->stop();
@@ -450,6 +547,109 @@ void TelemetryMonitor::sessionObjUnpackedCB(UAVObject *obj)
 void TelemetryMonitor::objectRetrieveTimeoutCB()
 {
     queue.clear();
+    deferredSettings.clear();
+    if (digestInProgress) {
+        finishSettingsDigest();
+        retrieveNextObject();
+    }
+}
+
+/**
+ * Look up the cache for the connected board and ask the board for the CRCs of
+ * its settings, or fetch all the settings if there is nothing cached.
+ */
+void TelemetryMonitor::startSettingsDigest()
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectUtilManager *utilMngr = pm->getObject<UAVObjectUtilManager>();
+    if (utilMngr)
+        settingsCache.setBoard(utilMngr->getBoardCPUSerial(), utilMngr->getFirmwareHash());
+
+    if (!settingsCache.load()) {
+        TELEMETRYMONITOR_QXTLOG_DEBUG(
+            QString("%0 no settings cache for this board, fetching all").arg(Q_FUNC_INFO));
+        finishSettingsDigest();
+        return;
+    }
+
+    // The digest exchange counts as one request in flight so that object
+    // retrieval does not complete underneath it
+    digestInProgress = true;
+    requestsInFlight++;
+    connect(settingsDigestObj,
+            QOverload<UAVObject *, bool, bool>::of(&UAVObject::transactionCompleted), this,
+            &TelemetryMonitor::settingsDigestTransactionCompleted, Qt::UniqueConnection);
+    requestSettingsDigest(0);
+}
+
+void TelemetryMonitor::requestSettingsDigest(quint8 index)
+{
+    settingsDigestObj->setObjectIndex(index);
+    settingsDigestObj->updated();
+}
+
+/**
+ * Queue every deferred settings object that could not be restored from the
+ * cache, and end the digest exchange.
+ */
+void TelemetryMonitor::finishSettingsDigest()
+{
+    foreach (UAVObject *obj, deferredSettings)
+        queue.enqueue(obj);
+    deferredSettings.clear();
+
+    if (digestInProgress) {
+        digestInProgress = false;
+        requestsInFlight--;
+        disconnect(settingsDigestObj,
+                   QOverload<UAVObject *, bool, bool>::of(&UAVObject::transactionCompleted), this,
+                   &TelemetryMonitor::settingsDigestTransactionCompleted);
+    }
+}
+
+void TelemetryMonitor::settingsDigestUnpackedCB(UAVObject *obj)
+{
+    Q_UNUSED(obj);
+    if (!digestInProgress)
+        return;
+
+    SettingsDigest::DataFields digest = settingsDigestObj->getData();
+    bool lastPage = false;
+    for (quint32 i = 0; i < SettingsDigest::OBJECTID_NUMELEM; i++) {
+        if (digest.ObjectID[i] == 0) {
+            lastPage = true;
+            break;
+        }
+        UAVObject *sobj = objMngr->getObject(digest.ObjectID[i]);
+        if (sobj && deferredSettings.contains(sobj)
+            && settingsCache.restore(digest.ObjectID[i], digest.DataCRC[i])) {
+            TELEMETRYMONITOR_QXTLOG_DEBUG(
+                QString("%0 %1 unchanged, restored from cache").arg(Q_FUNC_INFO).arg(sobj->getName()));
+            deferredSettings.removeOne(sobj);
+        }
+    }
+
+    if (!lastPage) {
+        requestSettingsDigest(digest.NextObjectIndex);
+        return;
+    }
+
+    finishSettingsDigest();
+    retrieveNextObject();
+}
+
+void TelemetryMonitor::settingsDigestTransactionCompleted(UAVObject *obj, bool success,
+                                                          bool nacked)
+{
+    Q_UNUSED(obj);
+    Q_UNUSED(nacked);
+    if (success || !digestInProgress)
+        return;
+
+    TELEMETRYMONITOR_QXTLOG_DEBUG(
+        QString("%0 settings digest failed, fetching all settings").arg(Q_FUNC_INFO));
+    finishSettingsDigest();
+    retrieveNextObject();
 }
 
 void TelemetryMonitor::sessionInitialRetrieveTimeoutCB()
@@ -617,9 +817,17 @@ void TelemetryMonitor::processStatsUpdates()
     // Update stats object
     gcsStats.RxDataRate = (float)telStats.rxBytes / ((float)statsTimer->interval() / 1000.0);
     gcsStats.TxDataRate = (float)telStats.txBytes / ((float)statsTimer->interval() / 1000.0);
-    gcsStats.RxFailures += telStats.rxErrors;
+    // Datagrams lost on the link took whole frames with them
+    gcsStats.RxFailures += telStats.rxErrors + telStats.rxLost;
     gcsStats.TxFailures += telStats.txErrors;
     gcsStats.TxRetries += telStats.txRetries;
+    rxDatagramsLost += telStats.rxLost;
+    rxDatagramsReordered += telStats.rxReordered;
+    if (telStats.rxLost || telStats.rxReordered)
+        TELEMETRYMONITOR_QXTLOG_DEBUG(QString("%0 datagrams lost %1, reordered %2 (totals)")
+                                          .arg(Q_FUNC_INFO)
+                                          .arg(rxDatagramsLost)
+                                          .arg(rxDatagramsReordered));
 
     // Check for a connection timeout
     bool connectionTimeout;
@@ -650,6 +858,8 @@ void TelemetryMonitor::processStatsUpdates()
     }
 
     emit telemetryUpdated((double)gcsStats.TxDataRate, (double)gcsStats.RxDataRate);
+    emit linkStatsUpdated(telStats.rxObjects, telStats.rxErrors + telStats.rxLost);
+    emit statsUpdated(telStats, statsTimer->interval());
 
     // Set data
     gcsStatsObj->setData(gcsStats);
@@ -39,12 +39,16 @@
 #include <QQueue>
 #include <QTimer>
 #include <QTime>
+#include <QElapsedTimer>
+#include <QHash>
 #include "uavobjects/uavobjectmanager.h"
 #include "gcstelemetrystats.h"
 #include "flighttelemetrystats.h"
 #include "systemstats.h"
 #include "telemetry.h"
 #include "sessionmanaging.h"
+#include "settingsdigest.h"
+#include "settingscache.h"
 #include <coreplugin/generalsettings.h>
 #include <extensionsystem/pluginmanager.h>
 
@@ -64,13 +68,21 @@ public:
     ~TelemetryMonitor();
     QHash<quint16, QList<objStruc>> savedSessions() { return sessions; }
 
+    //! Datagrams lost and received out of order this connection, on links that number them
+    quint32 datagramsLost() const { return rxDatagramsLost; }
+    quint32 datagramsReordered() const { return rxDatagramsReordered; }
+
 signals:
     void connected();
     void disconnected();
     void telemetryUpdated(double txRate, double rxRate);
+    //! Received objects and errors over the last stats period
+    void linkStatsUpdated(quint32 rxObjects, quint32 rxErrors);
+    //! All of the telemetry stats of the last stats period
+    void statsUpdated(const Telemetry::TelemetryStats &stats, int periodMs);
 
 public slots:
-    void transactionCompleted(UAVObject *obj, bool success);
+    void transactionCompleted(UAVObject *obj, bool success, bool nacked);
     void processStatsUpdates();
     void flightStatsUpdated(UAVObject *obj);
     void checkSessionObjNacked(UAVObject *, bool, bool);
@@ -81,6 +93,8 @@ private slots:
     void sessionInitialRetrieveTimeoutCB();
     void saveSession();
     void newInstanceSlot(UAVObject *);
+    void settingsDigestUnpackedCB(UAVObject *obj);
+    void settingsDigestTransactionCompleted(UAVObject *obj, bool success, bool nacked);
 
 private:
     QList<UAVDataObject *> delayedUpdate;
@@ -95,7 +109,11 @@ private:
     static const int STATS_UPDATE_PERIOD_MS = 1600;
     static const int STATS_CONNECT_PERIOD_MS = 350;
     static const int CONNECTION_TIMEOUT_MS = 8000;
-    static const int MAX_REQUESTS_IN_FLIGHT = 3;
+    // Bounds of the adaptive object retrieval window. The upper bound stays
+    // below Telemetry::MAX_QUEUE_SIZE so requests are never dropped locally.
+    static const int MIN_REQUEST_WINDOW = 1;
+    static const int INITIAL_REQUEST_WINDOW = 3;
+    static const int MAX_REQUEST_WINDOW = 16;
     connectionStatusEnum connectionStatus;
     UAVObjectManager *objMngr;
     Telemetry *tel;
@@ -115,6 +133,29 @@ private:
     int retries;
     int requestsInFlight;
 
+    // Link datagram statistics, for links that number their datagrams
+    quint32 rxDatagramsLost;
+    quint32 rxDatagramsReordered;
+
+    // Adaptive window state for object retrieval
+    double requestWindow;
+    double slowStartThreshold;
+    double smoothedRttMs;
+    double minRttMs;
+    QElapsedTimer retrieveClock;
+    QHash<UAVObject *, qint64> requestStartMs;
+    void updateRequestWindow(qint64 rttMs, bool lost);
+
+    // Settings that may be restored from the on-disk cache instead of
+    // being fetched, pending the board's SettingsDigest
+    SettingsDigest *settingsDigestObj;
+    SettingsCache settingsCache;
+    QList<UAVObject *> deferredSettings;
+    bool digestInProgress;
+    void startSettingsDigest();
+    void requestSettingsDigest(quint8 index);
+    void finishSettingsDigest();
+
     void changeObjectInstances(quint32 objID, quint32 instID, bool delayed);
     void startSessionRetrieving(UAVObject *session);
     void sessionFallback();
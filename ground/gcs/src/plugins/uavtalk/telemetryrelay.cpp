@@ -0,0 +1,253 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryrelay.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Shares the vehicle link with other ground stations
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "telemetryrelay.h"
+#include "uavtalk.h"
+#include "uavtalkio.h"
+#include "gcstelemetrystats.h"
+#include "flighttelemetrystats.h"
+
+#include <QDebug>
+#include <QtEndian>
+#include <QtNetwork/QTcpServer>
+#include <QtNetwork/QTcpSocket>
+
+TelemetryRelay::TelemetryRelay(UAVTalk *utalk, UAVObjectManager *objMngr, quint16 port,
+                               const QHostAddress &master, const QStringList &objects,
+                               QObject *parent)
+    : QObject(parent)
+    , utalk(utalk)
+    , objMngr(objMngr)
+    , masterAddress(master)
+{
+    foreach (const QString &name, objects) {
+        UAVObject *obj = objMngr->getObject(name);
+        if (obj)
+            relayedObjects.insert(obj->getObjID());
+        else
+            qWarning() << "[TelemetryRelay] Unknown object" << name;
+    }
+
+    server = new QTcpServer(this);
+    connect(server, &QTcpServer::newConnection, this, &TelemetryRelay::acceptClients);
+    if (!server->listen(QHostAddress::Any, port))
+        qWarning() << "[TelemetryRelay] Can't listen on port" << port << server->errorString();
+
+    connect(utalk, &UAVTalk::frameReceived, this, &TelemetryRelay::relayFrame);
+}
+
+TelemetryRelay::~TelemetryRelay()
+{
+    while (!clients.isEmpty())
+        removeClient(clients.first());
+}
+
+bool TelemetryRelay::isListening() const
+{
+    return server->isListening();
+}
+
+void TelemetryRelay::acceptClients()
+{
+    while (server->hasPendingConnections()) {
+        Client *client = new Client;
+        client->socket = server->nextPendingConnection();
+        client->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        client->io = new UAVTalkIO(client->socket);
+        client->master =
+            !masterAddress.isNull() && client->socket->peerAddress().isEqual(masterAddress);
+        clients.append(client);
+
+        qDebug() << "[TelemetryRelay]" << (client->master ? "Master" : "Observer")
+                 << client->socket->peerAddress().toString() << "connected";
+
+        connect(client->io, &UAVTalkIO::framesAvailable, this,
+                [this, client]() { processClientFrames(client); });
+        // Queued, a write may see the client go while its frames are handled
+        connect(client->socket, &QTcpSocket::disconnected, this,
+                [this, client]() { removeClient(client); }, Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief Pass a frame received from the vehicle on to the clients that want it
+ */
+void TelemetryRelay::relayFrame(const QByteArray &frame)
+{
+    const quint8 *data = (const quint8 *)frame.constData();
+    quint8 type = data[1] & UAVTalk::TYPE_MASK;
+    quint32 objId = qFromLittleEndian<quint32>(data + 4);
+
+    // File data is keyed by file, not by object
+    bool isObject = type != UAVTalk::TYPE_FILEDATA;
+    if (isObject && !relayedObjects.isEmpty() && !relayedObjects.contains(objId))
+        return;
+
+    // The vehicle handshakes with us only, clients get their own answers
+    if (objId == FlightTelemetryStats::OBJID)
+        return;
+
+    foreach (Client *client, clients) {
+        if (isObject && client->nacked.contains(objId))
+            continue;
+        sendToClient(client, frame);
+    }
+}
+
+void TelemetryRelay::processClientFrames(Client *client)
+{
+    quint8 *frame;
+    quint32 length;
+
+    client->io->clearNotify();
+
+    while ((frame = client->io->frontFrame(&length)) != Q_NULLPTR) {
+        processClientFrame(client, frame, length);
+        client->io->popFrame();
+    }
+}
+
+/**
+ * @brief Handle a CRC checked frame from a client
+ * @param length frame length including the checksum
+ */
+void TelemetryRelay::processClientFrame(Client *client, const quint8 *frame, quint32 length)
+{
+    quint8 type = frame[1] & UAVTalk::TYPE_MASK;
+    quint32 objId = qFromLittleEndian<quint32>(frame + 4);
+
+    if (objId == GCSTelemetryStats::OBJID
+        && (type == UAVTalk::TYPE_OBJ || type == UAVTalk::TYPE_OBJ_ACK)) {
+        if (length == UAVTalk::MIN_HEADER_LENGTH + GCSTelemetryStats::NUMBYTES
+                + UAVTalk::CHECKSUM_LENGTH)
+            answerHandshake(client, type, frame + UAVTalk::MIN_HEADER_LENGTH);
+        return;
+    }
+
+    switch (type) {
+    case UAVTalk::TYPE_NACK:
+        // The client doesn't know this object, stop sending it
+        client->nacked.insert(objId);
+        return;
+    case UAVTalk::TYPE_OBJ_REQ:
+    case UAVTalk::TYPE_FILEREQ:
+        break;
+    default:
+        if (!client->master)
+            return;
+        break;
+    }
+
+    utalk->sendFrame(QByteArray((const char *)frame, length));
+}
+
+/**
+ * @brief Answer a client's GCSTelemetryStats like the vehicle would, as long
+ * as the vehicle is connected to us
+ */
+void TelemetryRelay::answerHandshake(Client *client, quint8 type, const quint8 *payload)
+{
+    if (type == UAVTalk::TYPE_OBJ_ACK) {
+        sendToClient(client, buildFrame(UAVTalk::TYPE_ACK, GCSTelemetryStats::OBJID,
+                                        QByteArray()));
+    }
+
+    FlightTelemetryStats *flightStats = FlightTelemetryStats::GetInstance(objMngr);
+    if (!flightStats)
+        return;
+
+    // Scratch copies, so the objects of the vehicle link are left alone
+    GCSTelemetryStats request;
+    request.unpack(payload);
+
+    QByteArray data(FlightTelemetryStats::NUMBYTES, 0);
+    flightStats->pack((quint8 *)data.data());
+    FlightTelemetryStats reply;
+    reply.unpack((const quint8 *)data.constData());
+
+    quint8 status = FlightTelemetryStats::STATUS_DISCONNECTED;
+    if (flightStats->getStatus() == FlightTelemetryStats::STATUS_CONNECTED) {
+        if (request.getStatus() == GCSTelemetryStats::STATUS_HANDSHAKEREQ)
+            status = FlightTelemetryStats::STATUS_HANDSHAKEACK;
+        else if (request.getStatus() == GCSTelemetryStats::STATUS_CONNECTED)
+            status = FlightTelemetryStats::STATUS_CONNECTED;
+    }
+    reply.setStatus(status);
+    reply.pack((quint8 *)data.data());
+
+    sendToClient(client, buildFrame(UAVTalk::TYPE_OBJ, FlightTelemetryStats::OBJID, data));
+}
+
+void TelemetryRelay::sendToClient(Client *client, const QByteArray &frame)
+{
+    // A slow client misses frames rather than holding up the others
+    if (client->io->txBacklog() >= (quint32)CLIENT_BACKLOG_SIZE)
+        return;
+
+    client->io->frameQueued(frame.size());
+    client->io->writeFrame(frame);
+}
+
+void TelemetryRelay::removeClient(Client *client)
+{
+    if (!clients.removeOne(client))
+        return;
+
+    qDebug() << "[TelemetryRelay] Client" << client->socket->peerAddress().toString()
+             << "disconnected";
+
+    client->socket->disconnect(this);
+    client->io->deleteLater();
+    client->socket->deleteLater();
+    delete client;
+}
+
+/**
+ * @brief Encode a frame for a single instance object
+ */
+QByteArray TelemetryRelay::buildFrame(quint8 type, quint32 objId, const QByteArray &payload)
+{
+    QByteArray frame(UAVTalk::MIN_HEADER_LENGTH, 0);
+
+    frame[0] = UAVTalk::SYNC_VAL;
+    frame[1] = UAVTalk::TYPE_VER | type;
+    frame[2] = UAVTalk::MIN_HEADER_LENGTH + payload.size();
+    frame[3] = 0;
+    qToLittleEndian<quint32>(objId, (uchar *)frame.data() + 4);
+    frame.append(payload);
+    frame.append((char)UAVTalk::updateCRC(0, (const quint8 *)frame.constData(), frame.size()));
+
+    return frame;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,117 @@
+/**
+ ******************************************************************************
+ *
+ * @file       telemetryrelay.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Shares the vehicle link with other ground stations
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef TELEMETRYRELAY_H
+#define TELEMETRYRELAY_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include "uavobjects/uavobjectmanager.h"
+
+class QTcpServer;
+class QTcpSocket;
+class UAVTalk;
+class UAVTalkIO;
+
+/**
+ * @brief Relays the frames received on the vehicle link to other ground
+ * stations connecting over TCP, e.g. with the IP connection plugin.
+ *
+ * Frames are passed on as received, after their CRC was checked, so they are
+ * never re-encoded per client. What goes to a client can be narrowed by the
+ * relay's list of objects and by the client itself, which stops getting an
+ * object once it NACKs it (the UAVTalk answer for an unknown object).
+ *
+ * Clients may always request objects and files. Only the designated master,
+ * if any, may write to the vehicle; writes from observers are dropped. The
+ * telemetry handshake is answered by the relay for every client, so the
+ * vehicle only handshakes with this ground station.
+ */
+class TelemetryRelay : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @param utalk the vehicle link
+     * @param objMngr object manager of the vehicle link
+     * @param port TCP port to listen on
+     * @param master address of the client allowed to write, null for none
+     * @param objects names of the objects to relay, empty for all
+     */
+    TelemetryRelay(UAVTalk *utalk, UAVObjectManager *objMngr, quint16 port,
+                   const QHostAddress &master, const QStringList &objects,
+                   QObject *parent = 0);
+    ~TelemetryRelay();
+
+    bool isListening() const;
+    int clientCount() const { return clients.size(); }
+
+private slots:
+    void acceptClients();
+    void relayFrame(const QByteArray &frame);
+
+private:
+    // Most a client may have waiting, beyond that it misses frames
+    static const int CLIENT_BACKLOG_SIZE = 8 * 1024;
+
+    struct Client
+    {
+        QTcpSocket *socket;
+        UAVTalkIO *io;
+        bool master;
+        QSet<quint32> nacked;
+    };
+
+    void processClientFrames(Client *client);
+    void processClientFrame(Client *client, const quint8 *frame, quint32 length);
+    void answerHandshake(Client *client, quint8 type, const quint8 *payload);
+    void sendToClient(Client *client, const QByteArray &frame);
+    void removeClient(Client *client);
+    static QByteArray buildFrame(quint8 type, quint32 objId, const QByteArray &payload);
+
+    UAVTalk *utalk;
+    UAVObjectManager *objMngr;
+    QTcpServer *server;
+    QHostAddress masterAddress;
+    QSet<quint32> relayedObjects;
+    QList<Client *> clients;
+};
+
+#endif // TELEMETRYRELAY_H
+
+/**
+ * @}
+ * @}
+ */
@@ -33,7 +33,10 @@
  */
 
 #include "uavtalk.h"
+#include "uavtalkio.h"
 #include <QtEndian>
+#include <QMetaMethod>
+#include <QThread>
 #include <QDebug>
 #include <extensionsystem/pluginmanager.h>
 #include <coreplugin/generalsettings.h>
@@ -45,8 +48,6 @@
 #define UAVTALK_QXTLOG_DEBUG(...)
 #endif // UAVTALK_DEBUG
 
-#define SYNC_VAL 0x3C
-
 const quint8 UAVTalk::crc_table[256] = {
     0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d,
     0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65, 0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d,
@@ -66,28 +67,199 @@ const quint8 UAVTalk::crc_table[256] = {
     0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3
 };
 
+/**
+ * Slicing-by-8 tables: crc_slice8[k][x] is the CRC of byte x followed by
+ * k + 1 zero bytes, letting updateCRC() consume eight bytes per step.
+ */
+const quint8 UAVTalk::crc_slice8[7][256] = {
+    {
+        0x00, 0x15, 0x2a, 0x3f, 0x54, 0x41, 0x7e, 0x6b, 0xa8, 0xbd, 0x82, 0x97, 0xfc, 0xe9, 0xd6, 0xc3,
+        0x57, 0x42, 0x7d, 0x68, 0x03, 0x16, 0x29, 0x3c, 0xff, 0xea, 0xd5, 0xc0, 0xab, 0xbe, 0x81, 0x94,
+        0xae, 0xbb, 0x84, 0x91, 0xfa, 0xef, 0xd0, 0xc5, 0x06, 0x13, 0x2c, 0x39, 0x52, 0x47, 0x78, 0x6d,
+        0xf9, 0xec, 0xd3, 0xc6, 0xad, 0xb8, 0x87, 0x92, 0x51, 0x44, 0x7b, 0x6e, 0x05, 0x10, 0x2f, 0x3a,
+        0x5b, 0x4e, 0x71, 0x64, 0x0f, 0x1a, 0x25, 0x30, 0xf3, 0xe6, 0xd9, 0xcc, 0xa7, 0xb2, 0x8d, 0x98,
+        0x0c, 0x19, 0x26, 0x33, 0x58, 0x4d, 0x72, 0x67, 0xa4, 0xb1, 0x8e, 0x9b, 0xf0, 0xe5, 0xda, 0xcf,
+        0xf5, 0xe0, 0xdf, 0xca, 0xa1, 0xb4, 0x8b, 0x9e, 0x5d, 0x48, 0x77, 0x62, 0x09, 0x1c, 0x23, 0x36,
+        0xa2, 0xb7, 0x88, 0x9d, 0xf6, 0xe3, 0xdc, 0xc9, 0x0a, 0x1f, 0x20, 0x35, 0x5e, 0x4b, 0x74, 0x61,
+        0xb6, 0xa3, 0x9c, 0x89, 0xe2, 0xf7, 0xc8, 0xdd, 0x1e, 0x0b, 0x34, 0x21, 0x4a, 0x5f, 0x60, 0x75,
+        0xe1, 0xf4, 0xcb, 0xde, 0xb5, 0xa0, 0x9f, 0x8a, 0x49, 0x5c, 0x63, 0x76, 0x1d, 0x08, 0x37, 0x22,
+        0x18, 0x0d, 0x32, 0x27, 0x4c, 0x59, 0x66, 0x73, 0xb0, 0xa5, 0x9a, 0x8f, 0xe4, 0xf1, 0xce, 0xdb,
+        0x4f, 0x5a, 0x65, 0x70, 0x1b, 0x0e, 0x31, 0x24, 0xe7, 0xf2, 0xcd, 0xd8, 0xb3, 0xa6, 0x99, 0x8c,
+        0xed, 0xf8, 0xc7, 0xd2, 0xb9, 0xac, 0x93, 0x86, 0x45, 0x50, 0x6f, 0x7a, 0x11, 0x04, 0x3b, 0x2e,
+        0xba, 0xaf, 0x90, 0x85, 0xee, 0xfb, 0xc4, 0xd1, 0x12, 0x07, 0x38, 0x2d, 0x46, 0x53, 0x6c, 0x79,
+        0x43, 0x56, 0x69, 0x7c, 0x17, 0x02, 0x3d, 0x28, 0xeb, 0xfe, 0xc1, 0xd4, 0xbf, 0xaa, 0x95, 0x80,
+        0x14, 0x01, 0x3e, 0x2b, 0x40, 0x55, 0x6a, 0x7f, 0xbc, 0xa9, 0x96, 0x83, 0xe8, 0xfd, 0xc2, 0xd7
+    },
+    {
+        0x00, 0x6b, 0xd6, 0xbd, 0xab, 0xc0, 0x7d, 0x16, 0x51, 0x3a, 0x87, 0xec, 0xfa, 0x91, 0x2c, 0x47,
+        0xa2, 0xc9, 0x74, 0x1f, 0x09, 0x62, 0xdf, 0xb4, 0xf3, 0x98, 0x25, 0x4e, 0x58, 0x33, 0x8e, 0xe5,
+        0x43, 0x28, 0x95, 0xfe, 0xe8, 0x83, 0x3e, 0x55, 0x12, 0x79, 0xc4, 0xaf, 0xb9, 0xd2, 0x6f, 0x04,
+        0xe1, 0x8a, 0x37, 0x5c, 0x4a, 0x21, 0x9c, 0xf7, 0xb0, 0xdb, 0x66, 0x0d, 0x1b, 0x70, 0xcd, 0xa6,
+        0x86, 0xed, 0x50, 0x3b, 0x2d, 0x46, 0xfb, 0x90, 0xd7, 0xbc, 0x01, 0x6a, 0x7c, 0x17, 0xaa, 0xc1,
+        0x24, 0x4f, 0xf2, 0x99, 0x8f, 0xe4, 0x59, 0x32, 0x75, 0x1e, 0xa3, 0xc8, 0xde, 0xb5, 0x08, 0x63,
+        0xc5, 0xae, 0x13, 0x78, 0x6e, 0x05, 0xb8, 0xd3, 0x94, 0xff, 0x42, 0x29, 0x3f, 0x54, 0xe9, 0x82,
+        0x67, 0x0c, 0xb1, 0xda, 0xcc, 0xa7, 0x1a, 0x71, 0x36, 0x5d, 0xe0, 0x8b, 0x9d, 0xf6, 0x4b, 0x20,
+        0x0b, 0x60, 0xdd, 0xb6, 0xa0, 0xcb, 0x76, 0x1d, 0x5a, 0x31, 0x8c, 0xe7, 0xf1, 0x9a, 0x27, 0x4c,
+        0xa9, 0xc2, 0x7f, 0x14, 0x02, 0x69, 0xd4, 0xbf, 0xf8, 0x93, 0x2e, 0x45, 0x53, 0x38, 0x85, 0xee,
+        0x48, 0x23, 0x9e, 0xf5, 0xe3, 0x88, 0x35, 0x5e, 0x19, 0x72, 0xcf, 0xa4, 0xb2, 0xd9, 0x64, 0x0f,
+        0xea, 0x81, 0x3c, 0x57, 0x41, 0x2a, 0x97, 0xfc, 0xbb, 0xd0, 0x6d, 0x06, 0x10, 0x7b, 0xc6, 0xad,
+        0x8d, 0xe6, 0x5b, 0x30, 0x26, 0x4d, 0xf0, 0x9b, 0xdc, 0xb7, 0x0a, 0x61, 0x77, 0x1c, 0xa1, 0xca,
+        0x2f, 0x44, 0xf9, 0x92, 0x84, 0xef, 0x52, 0x39, 0x7e, 0x15, 0xa8, 0xc3, 0xd5, 0xbe, 0x03, 0x68,
+        0xce, 0xa5, 0x18, 0x73, 0x65, 0x0e, 0xb3, 0xd8, 0x9f, 0xf4, 0x49, 0x22, 0x34, 0x5f, 0xe2, 0x89,
+        0x6c, 0x07, 0xba, 0xd1, 0xc7, 0xac, 0x11, 0x7a, 0x3d, 0x56, 0xeb, 0x80, 0x96, 0xfd, 0x40, 0x2b
+    },
+    {
+        0x00, 0x16, 0x2c, 0x3a, 0x58, 0x4e, 0x74, 0x62, 0xb0, 0xa6, 0x9c, 0x8a, 0xe8, 0xfe, 0xc4, 0xd2,
+        0x67, 0x71, 0x4b, 0x5d, 0x3f, 0x29, 0x13, 0x05, 0xd7, 0xc1, 0xfb, 0xed, 0x8f, 0x99, 0xa3, 0xb5,
+        0xce, 0xd8, 0xe2, 0xf4, 0x96, 0x80, 0xba, 0xac, 0x7e, 0x68, 0x52, 0x44, 0x26, 0x30, 0x0a, 0x1c,
+        0xa9, 0xbf, 0x85, 0x93, 0xf1, 0xe7, 0xdd, 0xcb, 0x19, 0x0f, 0x35, 0x23, 0x41, 0x57, 0x6d, 0x7b,
+        0x9b, 0x8d, 0xb7, 0xa1, 0xc3, 0xd5, 0xef, 0xf9, 0x2b, 0x3d, 0x07, 0x11, 0x73, 0x65, 0x5f, 0x49,
+        0xfc, 0xea, 0xd0, 0xc6, 0xa4, 0xb2, 0x88, 0x9e, 0x4c, 0x5a, 0x60, 0x76, 0x14, 0x02, 0x38, 0x2e,
+        0x55, 0x43, 0x79, 0x6f, 0x0d, 0x1b, 0x21, 0x37, 0xe5, 0xf3, 0xc9, 0xdf, 0xbd, 0xab, 0x91, 0x87,
+        0x32, 0x24, 0x1e, 0x08, 0x6a, 0x7c, 0x46, 0x50, 0x82, 0x94, 0xae, 0xb8, 0xda, 0xcc, 0xf6, 0xe0,
+        0x31, 0x27, 0x1d, 0x0b, 0x69, 0x7f, 0x45, 0x53, 0x81, 0x97, 0xad, 0xbb, 0xd9, 0xcf, 0xf5, 0xe3,
+        0x56, 0x40, 0x7a, 0x6c, 0x0e, 0x18, 0x22, 0x34, 0xe6, 0xf0, 0xca, 0xdc, 0xbe, 0xa8, 0x92, 0x84,
+        0xff, 0xe9, 0xd3, 0xc5, 0xa7, 0xb1, 0x8b, 0x9d, 0x4f, 0x59, 0x63, 0x75, 0x17, 0x01, 0x3b, 0x2d,
+        0x98, 0x8e, 0xb4, 0xa2, 0xc0, 0xd6, 0xec, 0xfa, 0x28, 0x3e, 0x04, 0x12, 0x70, 0x66, 0x5c, 0x4a,
+        0xaa, 0xbc, 0x86, 0x90, 0xf2, 0xe4, 0xde, 0xc8, 0x1a, 0x0c, 0x36, 0x20, 0x42, 0x54, 0x6e, 0x78,
+        0xcd, 0xdb, 0xe1, 0xf7, 0x95, 0x83, 0xb9, 0xaf, 0x7d, 0x6b, 0x51, 0x47, 0x25, 0x33, 0x09, 0x1f,
+        0x64, 0x72, 0x48, 0x5e, 0x3c, 0x2a, 0x10, 0x06, 0xd4, 0xc2, 0xf8, 0xee, 0x8c, 0x9a, 0xa0, 0xb6,
+        0x03, 0x15, 0x2f, 0x39, 0x5b, 0x4d, 0x77, 0x61, 0xb3, 0xa5, 0x9f, 0x89, 0xeb, 0xfd, 0xc7, 0xd1
+    },
+    {
+        0x00, 0x62, 0xc4, 0xa6, 0x8f, 0xed, 0x4b, 0x29, 0x19, 0x7b, 0xdd, 0xbf, 0x96, 0xf4, 0x52, 0x30,
+        0x32, 0x50, 0xf6, 0x94, 0xbd, 0xdf, 0x79, 0x1b, 0x2b, 0x49, 0xef, 0x8d, 0xa4, 0xc6, 0x60, 0x02,
+        0x64, 0x06, 0xa0, 0xc2, 0xeb, 0x89, 0x2f, 0x4d, 0x7d, 0x1f, 0xb9, 0xdb, 0xf2, 0x90, 0x36, 0x54,
+        0x56, 0x34, 0x92, 0xf0, 0xd9, 0xbb, 0x1d, 0x7f, 0x4f, 0x2d, 0x8b, 0xe9, 0xc0, 0xa2, 0x04, 0x66,
+        0xc8, 0xaa, 0x0c, 0x6e, 0x47, 0x25, 0x83, 0xe1, 0xd1, 0xb3, 0x15, 0x77, 0x5e, 0x3c, 0x9a, 0xf8,
+        0xfa, 0x98, 0x3e, 0x5c, 0x75, 0x17, 0xb1, 0xd3, 0xe3, 0x81, 0x27, 0x45, 0x6c, 0x0e, 0xa8, 0xca,
+        0xac, 0xce, 0x68, 0x0a, 0x23, 0x41, 0xe7, 0x85, 0xb5, 0xd7, 0x71, 0x13, 0x3a, 0x58, 0xfe, 0x9c,
+        0x9e, 0xfc, 0x5a, 0x38, 0x11, 0x73, 0xd5, 0xb7, 0x87, 0xe5, 0x43, 0x21, 0x08, 0x6a, 0xcc, 0xae,
+        0x97, 0xf5, 0x53, 0x31, 0x18, 0x7a, 0xdc, 0xbe, 0x8e, 0xec, 0x4a, 0x28, 0x01, 0x63, 0xc5, 0xa7,
+        0xa5, 0xc7, 0x61, 0x03, 0x2a, 0x48, 0xee, 0x8c, 0xbc, 0xde, 0x78, 0x1a, 0x33, 0x51, 0xf7, 0x95,
+        0xf3, 0x91, 0x37, 0x55, 0x7c, 0x1e, 0xb8, 0xda, 0xea, 0x88, 0x2e, 0x4c, 0x65, 0x07, 0xa1, 0xc3,
+        0xc1, 0xa3, 0x05, 0x67, 0x4e, 0x2c, 0x8a, 0xe8, 0xd8, 0xba, 0x1c, 0x7e, 0x57, 0x35, 0x93, 0xf1,
+        0x5f, 0x3d, 0x9b, 0xf9, 0xd0, 0xb2, 0x14, 0x76, 0x46, 0x24, 0x82, 0xe0, 0xc9, 0xab, 0x0d, 0x6f,
+        0x6d, 0x0f, 0xa9, 0xcb, 0xe2, 0x80, 0x26, 0x44, 0x74, 0x16, 0xb0, 0xd2, 0xfb, 0x99, 0x3f, 0x5d,
+        0x3b, 0x59, 0xff, 0x9d, 0xb4, 0xd6, 0x70, 0x12, 0x22, 0x40, 0xe6, 0x84, 0xad, 0xcf, 0x69, 0x0b,
+        0x09, 0x6b, 0xcd, 0xaf, 0x86, 0xe4, 0x42, 0x20, 0x10, 0x72, 0xd4, 0xb6, 0x9f, 0xfd, 0x5b, 0x39
+    },
+    {
+        0x00, 0x29, 0x52, 0x7b, 0xa4, 0x8d, 0xf6, 0xdf, 0x4f, 0x66, 0x1d, 0x34, 0xeb, 0xc2, 0xb9, 0x90,
+        0x9e, 0xb7, 0xcc, 0xe5, 0x3a, 0x13, 0x68, 0x41, 0xd1, 0xf8, 0x83, 0xaa, 0x75, 0x5c, 0x27, 0x0e,
+        0x3b, 0x12, 0x69, 0x40, 0x9f, 0xb6, 0xcd, 0xe4, 0x74, 0x5d, 0x26, 0x0f, 0xd0, 0xf9, 0x82, 0xab,
+        0xa5, 0x8c, 0xf7, 0xde, 0x01, 0x28, 0x53, 0x7a, 0xea, 0xc3, 0xb8, 0x91, 0x4e, 0x67, 0x1c, 0x35,
+        0x76, 0x5f, 0x24, 0x0d, 0xd2, 0xfb, 0x80, 0xa9, 0x39, 0x10, 0x6b, 0x42, 0x9d, 0xb4, 0xcf, 0xe6,
+        0xe8, 0xc1, 0xba, 0x93, 0x4c, 0x65, 0x1e, 0x37, 0xa7, 0x8e, 0xf5, 0xdc, 0x03, 0x2a, 0x51, 0x78,
+        0x4d, 0x64, 0x1f, 0x36, 0xe9, 0xc0, 0xbb, 0x92, 0x02, 0x2b, 0x50, 0x79, 0xa6, 0x8f, 0xf4, 0xdd,
+        0xd3, 0xfa, 0x81, 0xa8, 0x77, 0x5e, 0x25, 0x0c, 0x9c, 0xb5, 0xce, 0xe7, 0x38, 0x11, 0x6a, 0x43,
+        0xec, 0xc5, 0xbe, 0x97, 0x48, 0x61, 0x1a, 0x33, 0xa3, 0x8a, 0xf1, 0xd8, 0x07, 0x2e, 0x55, 0x7c,
+        0x72, 0x5b, 0x20, 0x09, 0xd6, 0xff, 0x84, 0xad, 0x3d, 0x14, 0x6f, 0x46, 0x99, 0xb0, 0xcb, 0xe2,
+        0xd7, 0xfe, 0x85, 0xac, 0x73, 0x5a, 0x21, 0x08, 0x98, 0xb1, 0xca, 0xe3, 0x3c, 0x15, 0x6e, 0x47,
+        0x49, 0x60, 0x1b, 0x32, 0xed, 0xc4, 0xbf, 0x96, 0x06, 0x2f, 0x54, 0x7d, 0xa2, 0x8b, 0xf0, 0xd9,
+        0x9a, 0xb3, 0xc8, 0xe1, 0x3e, 0x17, 0x6c, 0x45, 0xd5, 0xfc, 0x87, 0xae, 0x71, 0x58, 0x23, 0x0a,
+        0x04, 0x2d, 0x56, 0x7f, 0xa0, 0x89, 0xf2, 0xdb, 0x4b, 0x62, 0x19, 0x30, 0xef, 0xc6, 0xbd, 0x94,
+        0xa1, 0x88, 0xf3, 0xda, 0x05, 0x2c, 0x57, 0x7e, 0xee, 0xc7, 0xbc, 0x95, 0x4a, 0x63, 0x18, 0x31,
+        0x3f, 0x16, 0x6d, 0x44, 0x9b, 0xb2, 0xc9, 0xe0, 0x70, 0x59, 0x22, 0x0b, 0xd4, 0xfd, 0x86, 0xaf
+    },
+    {
+        0x00, 0xdf, 0xb9, 0x66, 0x75, 0xaa, 0xcc, 0x13, 0xea, 0x35, 0x53, 0x8c, 0x9f, 0x40, 0x26, 0xf9,
+        0xd3, 0x0c, 0x6a, 0xb5, 0xa6, 0x79, 0x1f, 0xc0, 0x39, 0xe6, 0x80, 0x5f, 0x4c, 0x93, 0xf5, 0x2a,
+        0xa1, 0x7e, 0x18, 0xc7, 0xd4, 0x0b, 0x6d, 0xb2, 0x4b, 0x94, 0xf2, 0x2d, 0x3e, 0xe1, 0x87, 0x58,
+        0x72, 0xad, 0xcb, 0x14, 0x07, 0xd8, 0xbe, 0x61, 0x98, 0x47, 0x21, 0xfe, 0xed, 0x32, 0x54, 0x8b,
+        0x45, 0x9a, 0xfc, 0x23, 0x30, 0xef, 0x89, 0x56, 0xaf, 0x70, 0x16, 0xc9, 0xda, 0x05, 0x63, 0xbc,
+        0x96, 0x49, 0x2f, 0xf0, 0xe3, 0x3c, 0x5a, 0x85, 0x7c, 0xa3, 0xc5, 0x1a, 0x09, 0xd6, 0xb0, 0x6f,
+        0xe4, 0x3b, 0x5d, 0x82, 0x91, 0x4e, 0x28, 0xf7, 0x0e, 0xd1, 0xb7, 0x68, 0x7b, 0xa4, 0xc2, 0x1d,
+        0x37, 0xe8, 0x8e, 0x51, 0x42, 0x9d, 0xfb, 0x24, 0xdd, 0x02, 0x64, 0xbb, 0xa8, 0x77, 0x11, 0xce,
+        0x8a, 0x55, 0x33, 0xec, 0xff, 0x20, 0x46, 0x99, 0x60, 0xbf, 0xd9, 0x06, 0x15, 0xca, 0xac, 0x73,
+        0x59, 0x86, 0xe0, 0x3f, 0x2c, 0xf3, 0x95, 0x4a, 0xb3, 0x6c, 0x0a, 0xd5, 0xc6, 0x19, 0x7f, 0xa0,
+        0x2b, 0xf4, 0x92, 0x4d, 0x5e, 0x81, 0xe7, 0x38, 0xc1, 0x1e, 0x78, 0xa7, 0xb4, 0x6b, 0x0d, 0xd2,
+        0xf8, 0x27, 0x41, 0x9e, 0x8d, 0x52, 0x34, 0xeb, 0x12, 0xcd, 0xab, 0x74, 0x67, 0xb8, 0xde, 0x01,
+        0xcf, 0x10, 0x76, 0xa9, 0xba, 0x65, 0x03, 0xdc, 0x25, 0xfa, 0x9c, 0x43, 0x50, 0x8f, 0xe9, 0x36,
+        0x1c, 0xc3, 0xa5, 0x7a, 0x69, 0xb6, 0xd0, 0x0f, 0xf6, 0x29, 0x4f, 0x90, 0x83, 0x5c, 0x3a, 0xe5,
+        0x6e, 0xb1, 0xd7, 0x08, 0x1b, 0xc4, 0xa2, 0x7d, 0x84, 0x5b, 0x3d, 0xe2, 0xf1, 0x2e, 0x48, 0x97,
+        0xbd, 0x62, 0x04, 0xdb, 0xc8, 0x17, 0x71, 0xae, 0x57, 0x88, 0xee, 0x31, 0x22, 0xfd, 0x9b, 0x44
+    },
+    {
+        0x00, 0x13, 0x26, 0x35, 0x4c, 0x5f, 0x6a, 0x79, 0x98, 0x8b, 0xbe, 0xad, 0xd4, 0xc7, 0xf2, 0xe1,
+        0x37, 0x24, 0x11, 0x02, 0x7b, 0x68, 0x5d, 0x4e, 0xaf, 0xbc, 0x89, 0x9a, 0xe3, 0xf0, 0xc5, 0xd6,
+        0x6e, 0x7d, 0x48, 0x5b, 0x22, 0x31, 0x04, 0x17, 0xf6, 0xe5, 0xd0, 0xc3, 0xba, 0xa9, 0x9c, 0x8f,
+        0x59, 0x4a, 0x7f, 0x6c, 0x15, 0x06, 0x33, 0x20, 0xc1, 0xd2, 0xe7, 0xf4, 0x8d, 0x9e, 0xab, 0xb8,
+        0xdc, 0xcf, 0xfa, 0xe9, 0x90, 0x83, 0xb6, 0xa5, 0x44, 0x57, 0x62, 0x71, 0x08, 0x1b, 0x2e, 0x3d,
+        0xeb, 0xf8, 0xcd, 0xde, 0xa7, 0xb4, 0x81, 0x92, 0x73, 0x60, 0x55, 0x46, 0x3f, 0x2c, 0x19, 0x0a,
+        0xb2, 0xa1, 0x94, 0x87, 0xfe, 0xed, 0xd8, 0xcb, 0x2a, 0x39, 0x0c, 0x1f, 0x66, 0x75, 0x40, 0x53,
+        0x85, 0x96, 0xa3, 0xb0, 0xc9, 0xda, 0xef, 0xfc, 0x1d, 0x0e, 0x3b, 0x28, 0x51, 0x42, 0x77, 0x64,
+        0xbf, 0xac, 0x99, 0x8a, 0xf3, 0xe0, 0xd5, 0xc6, 0x27, 0x34, 0x01, 0x12, 0x6b, 0x78, 0x4d, 0x5e,
+        0x88, 0x9b, 0xae, 0xbd, 0xc4, 0xd7, 0xe2, 0xf1, 0x10, 0x03, 0x36, 0x25, 0x5c, 0x4f, 0x7a, 0x69,
+        0xd1, 0xc2, 0xf7, 0xe4, 0x9d, 0x8e, 0xbb, 0xa8, 0x49, 0x5a, 0x6f, 0x7c, 0x05, 0x16, 0x23, 0x30,
+        0xe6, 0xf5, 0xc0, 0xd3, 0xaa, 0xb9, 0x8c, 0x9f, 0x7e, 0x6d, 0x58, 0x4b, 0x32, 0x21, 0x14, 0x07,
+        0x63, 0x70, 0x45, 0x56, 0x2f, 0x3c, 0x09, 0x1a, 0xfb, 0xe8, 0xdd, 0xce, 0xb7, 0xa4, 0x91, 0x82,
+        0x54, 0x47, 0x72, 0x61, 0x18, 0x0b, 0x3e, 0x2d, 0xcc, 0xdf, 0xea, 0xf9, 0x80, 0x93, 0xa6, 0xb5,
+        0x0d, 0x1e, 0x2b, 0x38, 0x41, 0x52, 0x67, 0x74, 0x95, 0x86, 0xb3, 0xa0, 0xd9, 0xca, 0xff, 0xec,
+        0x3a, 0x29, 0x1c, 0x0f, 0x76, 0x65, 0x50, 0x43, 0xa2, 0xb1, 0x84, 0x97, 0xee, 0xfd, 0xc8, 0xdb
+    }
+};
+
 /**
  * Constructor
+ * \param[in] iodev Link device
+ * \param[in] objMngr Object manager
+ * \param[in] useIOThread Service the device from a dedicated thread, so the
+ * link doesn't depend on the load of the thread UAVTalk lives on. Only
+ * possible for devices without a parent; releaseDevice() must be called
+ * before the device is closed.
  */
-UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr)
+UAVTalk::UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr, bool useIOThread)
 {
-    io = iodev;
-
     this->objMngr = objMngr;
-
-    startOffset = 0;
-    filledBytes = 0;
+    ioThread = Q_NULLPTR;
+    frameRxTimeUs = 0;
 
     memset(&stats, 0, sizeof(ComStats));
 
-    connect(io.data(), &QIODevice::readyRead, this, &UAVTalk::processInputStream);
+    linkIO = new UAVTalkIO(iodev);
+    connect(linkIO, &UAVTalkIO::framesAvailable, this, &UAVTalk::processFrames);
+    connect(this, &UAVTalk::frameReady, linkIO, &UAVTalkIO::writeFrame);
+
+    if (useIOThread && iodev->parent() == Q_NULLPTR) {
+        ioThread = new QThread(this);
+        ioThread->setObjectName("UAVTalkIO");
+        iodev->moveToThread(ioThread);
+        linkIO->moveToThread(ioThread);
+        ioThread->start();
+    }
 }
 
 UAVTalk::~UAVTalk()
 {
-    // According to Qt, it is not necessary to disconnect upon
-    // object deletion.
-    // disconnect(io, SIGNAL(readyRead()), this, SLOT(processInputStream()));
+    releaseDevice();
+    delete linkIO;
+}
+
+/**
+ * Stop the I/O thread, if any, and give the device back to our thread so
+ * its owner can close it. Blocks until the I/O thread is finished.
+ */
+void UAVTalk::releaseDevice()
+{
+    if (ioThread == Q_NULLPTR) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(linkIO, "release", Qt::BlockingQueuedConnection,
+                              Q_ARG(QThread *, thread()));
+    ioThread->quit();
+    ioThread->wait();
+    delete ioThread;
+    ioThread = Q_NULLPTR;
+}
+
+/**
+ * Clock the link is timed with, in microseconds
+ */
+qint64 UAVTalk::clockUs()
+{
+    return UAVTalkIO::clockUs();
 }
 
 /**
@@ -97,39 +269,52 @@ UAVTalk::ComStats UAVTalk::getStats()
 {
     UAVTalk::ComStats ret = stats;
 
+    ret.rxBytes += linkIO->takeRxBytes();
+    ret.rxErrors += linkIO->takeRxErrors();
+    ret.txErrors += linkIO->takeTxErrors();
+    linkIO->takeDatagramLoss(&ret.rxLost, &ret.rxReordered);
+
     memset(&stats, 0, sizeof(ComStats));
 
     return ret;
 }
 
 /**
- * Called each time there are data in the input buffer
+ * Decode a block of received bytes synchronously, bypassing the device.
+ * Used to feed recorded streams as fast as they can be parsed; objects are
+ * updated before this returns. Not available with an I/O thread.
+ * \param[in] data Raw UAVTalk stream bytes
+ * \param[in] length Number of bytes
  */
-void UAVTalk::processInputStream()
+void UAVTalk::processBytes(const quint8 *data, quint32 length)
 {
-    while (io && io->isReadable()) {
-        if (startOffset > (sizeof(rxBuffer) - MAX_PACKET_LENGTH)) {
-            /* If we're not sure there's room for a frame, shift things left in
-             * the buffer so that we can do a bigger read.
-             */
-            memmove(rxBuffer, rxBuffer + startOffset, filledBytes - startOffset);
-
-            filledBytes -= startOffset;
-            startOffset = 0;
-        }
+    Q_ASSERT(ioThread == Q_NULLPTR);
 
-        int bytes = io->read((char *) (rxBuffer + filledBytes),
-                sizeof(rxBuffer) - filledBytes);
+    linkIO->processBytes(data, length);
+}
 
-        if (bytes <= 0) {
-            return;
-        }
+/**
+ * Called when the link has queued received frames
+ */
+void UAVTalk::processFrames()
+{
+    quint8 *frame;
+    quint32 length;
+
+    linkIO->clearNotify();
 
-        filledBytes += bytes;
-        stats.rxBytes += bytes;
+    static const QMetaMethod frameReceivedSignal =
+        QMetaMethod::fromSignal(&UAVTalk::frameReceived);
+    bool relayFrames = isSignalConnected(frameReceivedSignal);
 
-        while (processInput());
+    while ((frame = linkIO->frontFrame(&length, &frameRxTimeUs)) != Q_NULLPTR) {
+        if (relayFrames)
+            emit frameReceived(QByteArray((const char *)frame, length));
+        processFrame(frame, length);
+        linkIO->popFrame();
     }
+
+    linkIO->resume();
 }
 
 /**
@@ -207,74 +392,19 @@ bool UAVTalk::receiveFileChunk(quint32 fileId, quint8 *data, quint32 length)
 }
 
 /**
- * Process a frame from input, if available.
- * \return False if there was insufficient data for a frame, true if trying
- * again is worthwhile.
+ * Process a complete, CRC checked frame from the link.
+ * \param[in] frame Frame, starting with the header
+ * \param[in] length Frame length including the checksum
  */
-bool UAVTalk::processInput()
+void UAVTalk::processFrame(quint8 *frame, quint32 length)
 {
-    unsigned int bytesAvail = filledBytes - startOffset;
-
-    if (bytesAvail < sizeof(UAVTalkHeader)) {
-        return false;
-    }
-
-    UAVTalkHeader *hdr = (UAVTalkHeader *) (rxBuffer + startOffset);
-
-    /* Basic framing checks.  If these fail, skip forward one byte and retry
-     * to capture stream sync.
-     */
-    if (hdr->sync != SYNC_VAL) {
-        startOffset++;
-        stats.rxErrors++;
-
-        return true;
-    }
-
-    if ((hdr->type & VER_MASK) != TYPE_VER) {
-        startOffset++;
-        stats.rxErrors++;
-
-        return true;
-    }
-
-    if (hdr->size < sizeof(UAVTalkHeader)) {
-        startOffset++;
-        stats.rxErrors++;
-
-        return true;
-    }
-
-    /* OK, let's ensure we have enough bytes for the whole frame. 
-     * Size doesn't include CRC, so add one.
-     */
-
-    if ((hdr->size + 1u) > bytesAvail) {
-        return false;
-    }
+    UAVTalkHeader *hdr = (UAVTalkHeader *) frame;
 
-    quint8 ourCrc = updateCRC(0, rxBuffer + startOffset, hdr->size);
-    quint8 *theirCrc = rxBuffer + startOffset + hdr->size;
-
-    if (ourCrc != *theirCrc) {
-        /* Since we can't trust hdr->size for sure, we should just skip
-         * forward one byte.
-         */
-
-        startOffset++;
-        stats.rxErrors++;
-
-        return true;
-    }
+    Q_UNUSED(length);
 
-    quint8 *payload = rxBuffer + startOffset + sizeof(*hdr);
+    quint8 *payload = frame + sizeof(*hdr);
     unsigned int payloadBytes = hdr->size - sizeof(*hdr);
 
-    /* At this point, we'll advance startOffset for the entire length of
-     * frame, and not touch startOffset again this function!
-     */
-    startOffset += hdr->size + 1;
-
     /* OK, we have a complete frame as encoded on the wire.  Time to do things
      * with it.
      */
@@ -283,7 +413,8 @@ bool UAVTalk::processInput()
     quint32 rxObjId = qFromLittleEndian(hdr->objId);
 
     if (rxType == TYPE_FILEDATA) {
-        return receiveFileChunk(rxObjId, payload, payloadBytes);
+        receiveFileChunk(rxObjId, payload, payloadBytes);
+        return;
     }
 
     UAVObject *rxObj = objMngr->getObject(rxObjId);
@@ -297,7 +428,7 @@ bool UAVTalk::processInput()
             transmitNack(rxObjId);
         }
 
-        return true;
+        return;
     }
 
     quint16 rxInstId = 0;
@@ -311,29 +442,101 @@ bool UAVTalk::processInput()
 
     /* XXX timestamps */
 
+    if (rxType == TYPE_OBJ_PARTIAL) {
+        if (hdr->type & TYPE_TIMESTAMPED) {
+            payload += TIMESTAMP_LENGTH;
+            payloadBytes -= qMin<unsigned int>(payloadBytes, TIMESTAMP_LENGTH);
+        }
+
+        if (!receivePartialObject(rxObj, rxInstId, payload, payloadBytes)) {
+            UAVTALK_QXTLOG_DEBUG("UAVTalk: Malformed partial object");
+            stats.rxErrors++;
+
+            return;
+        }
+
+        stats.rxObjectBytes += payloadBytes;
+        stats.rxObjects++;
+        return;
+    }
+
     // Check data length
     if (rxType == TYPE_OBJ_REQ || rxType == TYPE_ACK || rxType == TYPE_NACK) {
         if (payloadBytes != 0) {
             UAVTALK_QXTLOG_DEBUG("UAVTalk: Unexpected data in req/ack/nack");
             stats.rxErrors++;
 
-            return true;
+            return;
         }
     } else {
         if (payloadBytes != rxObj->getNumBytes()) {
             UAVTALK_QXTLOG_DEBUG("UAVTalk: Unexpected payload size for obj");
             stats.rxErrors++;
 
-            return true;
+            return;
         }
     }
 
     receiveObject(rxType, rxObjId, rxInstId, payload, payloadBytes);
     stats.rxObjectBytes += payloadBytes;
     stats.rxObjects++;
+}
 
-    // Done
-    return true;
+/**
+ * Apply a partial object: the fields present in the mask replace those of
+ * the current instance data, the others keep their value.
+ * \param[in] obj Any instance of the received object
+ * \param[in] instId The instance ID
+ * \param[in] data Field mask followed by the present fields, in order
+ * \param[in] length Buffer length
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::receivePartialObject(UAVObject *obj, quint16 instId,
+        quint8 *data, quint32 length)
+{
+    if (length < PARTIAL_MASK_LENGTH || instId == ALL_INSTANCES) {
+        return false;
+    }
+
+    quint32 mask = qFromLittleEndian<quint32>(data);
+    data += PARTIAL_MASK_LENGTH;
+    length -= PARTIAL_MASK_LENGTH;
+
+    // Start from the instance's current data, or from the object's
+    // first instance if this one doesn't exist yet
+    UAVObject *inst = objMngr->getObject(obj->getObjID(), instId);
+    if (inst == Q_NULLPTR) {
+        inst = obj;
+    }
+
+    QByteArray full(inst->getNumBytes(), 0);
+    quint8 *out = (quint8 *)full.data();
+    inst->pack(out);
+
+    QList<UAVObjectField *> fields = inst->getFields();
+    quint32 offset = 0;
+    quint32 used = 0;
+
+    for (int i = 0; i < fields.count() && i < PARTIAL_MASK_LENGTH * 8; i++) {
+        quint32 size = fields[i]->getNumBytes();
+
+        if (mask & (1u << i)) {
+            if (used + size > length) {
+                return false;
+            }
+
+            memcpy(out + offset, data + used, size);
+            used += size;
+        }
+
+        offset += size;
+    }
+
+    if (used != length) {
+        return false;
+    }
+
+    return updateObject(obj->getObjID(), instId, out) != Q_NULLPTR;
 }
 
 /**
@@ -514,12 +717,15 @@ bool UAVTalk::transmitObject(UAVObject *obj, quint8 type, bool allInstances)
     // Process message type
     if (type == TYPE_OBJ || type == TYPE_OBJ_ACK) {
         if (allInstances) {
-            // Get number of instances
-            quint32 numInst = objMngr->getNumInstances(obj->getObjID());
+            const QVector<UAVObject *> *instances = objMngr->getObjectInstances(obj->getObjID());
+            if (instances == Q_NULLPTR) {
+                return false;
+            }
             // Send all instances
-            for (quint32 instId = 0; instId < numInst; ++instId) {
-                UAVObject *inst = objMngr->getObject(obj->getObjID(), instId);
-                transmitSingleObject(inst, type, false);
+            foreach (UAVObject *inst, *instances) {
+                if (inst != Q_NULLPTR) {
+                    transmitSingleObject(inst, type, false);
+                }
             }
             return true;
         } else {
@@ -572,8 +778,9 @@ bool UAVTalk::transmitFrame(quint32 length, bool incrTxObj)
 
     txBuffer[length] = updateCRC(0, txBuffer, length);
 
-    if (!io.isNull() && io->isWritable() && io->bytesToWrite() < TX_BACKLOG_SIZE) {
-        io->write((const char *)txBuffer, length + CHECKSUM_LENGTH);
+    if (linkIO->txBacklog() < (quint32)TX_BACKLOG_SIZE) {
+        linkIO->frameQueued(length + CHECKSUM_LENGTH);
+        emit frameReady(QByteArray((const char *)txBuffer, length + CHECKSUM_LENGTH));
     } else {
         UAVTALK_QXTLOG_DEBUG("UAVTalk: TX refused");
         ++stats.txErrors;
@@ -594,18 +801,49 @@ bool UAVTalk::transmitFrame(quint32 length, bool incrTxObj)
     return true;
 }
 
+/**
+ * Send a frame received elsewhere, e.g. relayed from another ground station.
+ * \param[in] frame Complete frame including the checksum
+ * \return Success (true), Failure (false) if the link is backed up
+ */
+bool UAVTalk::sendFrame(const QByteArray &frame)
+{
+    if (linkIO->txBacklog() >= (quint32)TX_BACKLOG_SIZE) {
+        ++stats.txErrors;
+        return false;
+    }
+
+    linkIO->frameQueued(frame.size());
+    emit frameReady(frame);
+
+    stats.txBytes += frame.size();
+
+    return true;
+}
+
+/**
+ * Change the speed of a serial link, once the frames sent so far are out.
+ * \param[in] baud The new speed in bps
+ */
+void UAVTalk::setLinkSpeed(qint32 baud)
+{
+    // Queued behind the frames already handed to the I/O thread
+    QMetaObject::invokeMethod(linkIO, "setDeviceSpeed", Q_ARG(qint32, baud));
+}
+
 /**
  * Send a request for file data.
  * \param[in] fileId The file id to request.
  * \param[in] offset The first requested chunk of the file.
+ * \param[in] window Data messages to send in reply, 0 for the firmware default.
  */
-bool UAVTalk::requestFile(quint32 fileId, quint32 offset)
+bool UAVTalk::requestFile(quint32 fileId, quint32 offset, quint8 window)
 {
     txBuffer[0] = SYNC_VAL;
     txBuffer[1] = TYPE_VER | TYPE_FILEREQ;
     qToLittleEndian<quint32>(fileId, &txBuffer[4]);
     qToLittleEndian<quint32>(offset, &txBuffer[8]);
-    txBuffer[12] = 0;
+    txBuffer[12] = window;
     txBuffer[13] = 0;
 
     // qDebug() << "Sent file req offs=" << offset;
@@ -690,7 +928,14 @@ bool UAVTalk::transmitSingleObject(UAVObject *obj, quint8 type, bool allInstance
 
 quint8 UAVTalk::updateCRC(quint8 crc, const quint8 *data, qint32 length)
 {
-    while (length--)
+    while (length >= 8) {
+        crc = crc_slice8[6][crc ^ data[0]] ^ crc_slice8[5][data[1]] ^ crc_slice8[4][data[2]]
+            ^ crc_slice8[3][data[3]] ^ crc_slice8[2][data[4]] ^ crc_slice8[1][data[5]]
+            ^ crc_slice8[0][data[6]] ^ crc_table[data[7]];
+        data += 8;
+        length -= 8;
+    }
+    while (length-- > 0)
         crc = crc_table[crc ^ *data++];
     return crc;
 }
@@ -43,6 +43,8 @@
 #include "uavtalk_global.h"
 #include <QtNetwork/QUdpSocket>
 
+class UAVTalkIO;
+
 class UAVTALK_EXPORT UAVTalk : public QObject
 {
     Q_OBJECT
@@ -58,17 +60,27 @@ public:
         quint32 txObjects;
         quint32 txErrors;
         quint32 rxErrors;
+        quint32 rxLost; // Datagrams, on links that number them
+        quint32 rxReordered;
     };
 
-    UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr);
+    UAVTalk(QIODevice *iodev, UAVObjectManager *objMngr, bool useIOThread = false);
     ~UAVTalk();
+    void releaseDevice();
     bool sendObject(UAVObject *obj, bool acked, bool allInstances);
     bool sendObjectRequest(UAVObject *obj, bool allInstances);
-    bool requestFile(quint32 fileId, quint32 offset);
+    bool requestFile(quint32 fileId, quint32 offset, quint8 window = 0);
+    bool sendFrame(const QByteArray &frame);
+    void setLinkSpeed(qint32 baud);
+    void processBytes(const quint8 *data, quint32 length);
 
     ComStats getStats();
 
-    bool processInput();
+    static qint64 clockUs();
+    //! When the frame being handled, or the last one, was read off the link, on clockUs()
+    qint64 lastFrameRxTimeUs() const { return frameRxTimeUs; }
+
+    static quint8 updateCRC(quint8 crc, const quint8 *data, qint32 length);
 
 signals:
     // The only signals we send to the upper level are when we
@@ -80,11 +92,21 @@ signals:
     void fileDataReceived(quint32 fileId, quint32 offset, quint8 *data,
             quint32 dataLen, bool eof, bool lastInSeq);
 
+    // Hands a complete frame to the link device
+    void frameReady(const QByteArray &frame);
+
+    // Every CRC checked frame received, only emitted while connected to
+    void frameReceived(const QByteArray &frame);
+
 private slots:
-    void processInputStream(void);
+    void processFrames();
 
 protected:
+    friend class UAVTalkIO;
+    friend class TelemetryRelay;
+
     // Constants
+    static const quint8 SYNC_VAL = 0x3C;
     static const int VER_MASK = 0x70;
     static const int TYPE_MASK = 0x0f;
 
@@ -96,6 +118,11 @@ protected:
     static const int TYPE_NACK = 0x04;
     static const int TYPE_FILEREQ = 0x08;
     static const int TYPE_FILEDATA = 0x09;
+    static const int TYPE_OBJ_PARTIAL = 0x0C;
+    static const int TYPE_TIMESTAMPED = 0x80;
+
+    static const int TIMESTAMP_LENGTH = 2;
+    static const int PARTIAL_MASK_LENGTH = 4; // bit n set when field n is present
 
     static const int MIN_HEADER_LENGTH = 8; // sync(1), type (1), size(2), object ID(4)
     static const int MAX_HEADER_LENGTH = MIN_HEADER_LENGTH + 2; // instance ID(2, not used in single objs)
@@ -111,6 +138,7 @@ protected:
 
     static const int TX_BACKLOG_SIZE = 2 * 1024;
     static const quint8 crc_table[256];
+    static const quint8 crc_slice8[7][256];
 
 #pragma pack(push)
 #pragma pack(1)
@@ -132,31 +160,26 @@ protected:
 #pragma pack(pop)
 
     // Variables
-    QPointer<QIODevice> io;
     UAVObjectManager *objMngr;
+    UAVTalkIO *linkIO;
+    QThread *ioThread;
 
-    // This is a tradeoff between the frequency of the need to
-    // compact/copy left and buffer size.
-    quint8 rxBuffer[MAX_PACKET_LENGTH * 12];
     quint8 txBuffer[MAX_PACKET_LENGTH];
 
-    // Variables used by the receive state machine
-
-    quint32 startOffset;
-    quint32 filledBytes;
-
     ComStats stats;
+    qint64 frameRxTimeUs;
 
     // Methods
+    void processFrame(quint8 *frame, quint32 length);
     bool objectTransaction(UAVObject *obj, quint8 type, bool allInstances);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId,
             quint8 *data, quint32 length);
     bool receiveFileChunk(quint32 fileId, quint8 *data, quint32 length);
+    bool receivePartialObject(UAVObject *obj, quint16 instId, quint8 *data, quint32 length);
     UAVObject *updateObject(quint32 objId, quint16 instId, quint8 *data);
     bool transmitNack(quint32 objId);
     bool transmitObject(UAVObject *obj, quint8 type, bool allInstances);
     bool transmitSingleObject(UAVObject *obj, quint8 type, bool allInstances);
-    quint8 updateCRC(quint8 crc, const quint8 *data, qint32 length);
     bool transmitFrame(quint32 length, bool incrTxObj = true);
 };
 
@@ -10,18 +10,39 @@ include(../../libs/utils/utils.pri)
 
 include(../../plugins/coreplugin/coreplugin.pri)
 include(../../plugins/uavobjects/uavobjects.pri)
+include(../../plugins/uavobjectutil/uavobjectutil.pri)
 
 HEADERS += uavtalk.h \
+    uavtalkio.h \
+    logdecoder.h \
+    logrecord.h \
+    logblock.h \
+    logexpander.h \
     uavtalkplugin.h \
     telemetrymonitor.h \
     telemetrymanager.h \
     uavtalk_global.h \
-    telemetry.h
+    telemetry.h \
+    telemetryrelay.h \
+    telemetrydeltaserver.h \
+    speednegotiator.h \
+    linklatency.h \
+    settingscache.h
 
 SOURCES += uavtalk.cpp \
+    uavtalkio.cpp \
+    logdecoder.cpp \
+    logrecord.cpp \
+    logblock.cpp \
+    logexpander.cpp \
     uavtalkplugin.cpp \
     telemetrymonitor.cpp \
     telemetrymanager.cpp \
-    telemetry.cpp
+    telemetry.cpp \
+    telemetryrelay.cpp \
+    telemetrydeltaserver.cpp \
+    speednegotiator.cpp \
+    linklatency.cpp \
+    settingscache.cpp
 
 OTHER_FILES += UAVTalk.pluginspec
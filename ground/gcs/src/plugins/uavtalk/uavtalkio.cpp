@@ -0,0 +1,412 @@
+/**
+ ******************************************************************************
+ * @file       uavtalkio.cpp
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Device side of the UAVTalk link: reading, framing and writing
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "uavtalkio.h"
+#include "uavtalk.h"
+#include <QElapsedTimer>
+#include <QThread>
+#include <cstring>
+
+UAVTalkIO::UAVTalkIO(QIODevice *iodev)
+    : io(iodev)
+    , startOffset(0)
+    , filledBytes(0)
+    , rxTimeUs(0)
+    , frameHead(0)
+    , frameTail(0)
+    , notifyPending(0)
+    , stalled(0)
+    , rxBytes(0)
+    , rxErrors(0)
+    , txErrors(0)
+    , txQueuedBytes(0)
+    , txDeviceBytes(0)
+    , lostReported(0)
+    , reorderedReported(0)
+{
+    connect(io.data(), &QIODevice::readyRead, this, &UAVTalkIO::processInputStream);
+    connect(io.data(), &QIODevice::bytesWritten, this, &UAVTalkIO::updateTxBacklog);
+}
+
+/**
+ * Monotonic clock for timing the link, in microseconds. The same on every
+ * thread, so frames can be timed from where they are read to where their
+ * objects are handled.
+ */
+qint64 UAVTalkIO::clockUs()
+{
+    static const QElapsedTimer clock = []() {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+
+    return clock.nsecsElapsed() / 1000;
+}
+
+/**
+ * Get the oldest queued frame without removing it, consumer side.
+ * \param[out] length Frame length including the checksum
+ * \param[out] rxTimeUs When the frame was read, on clockUs(), if not NULL
+ * \return The frame, or NULL if the queue is empty. It stays valid until
+ * popFrame().
+ */
+quint8 *UAVTalkIO::frontFrame(quint32 *length, qint64 *rxTimeUs)
+{
+    quint32 tail = frameTail.loadAcquire();
+
+    if (tail == frameHead.loadAcquire()) {
+        return Q_NULLPTR;
+    }
+
+    Frame &frame = frames[tail & (FRAME_QUEUE_LEN - 1)];
+    *length = frame.length;
+    if (rxTimeUs)
+        *rxTimeUs = frame.rxTimeUs;
+
+    return frame.data;
+}
+
+/**
+ * Release the frame returned by frontFrame(), consumer side.
+ */
+void UAVTalkIO::popFrame()
+{
+    frameTail.storeRelease(frameTail.loadAcquire() + 1);
+}
+
+/**
+ * Re-arm framesAvailable(). Must be called before draining the queue so
+ * frames queued during the drain cause a new notification.
+ */
+void UAVTalkIO::clearNotify()
+{
+    notifyPending.storeRelease(0);
+}
+
+/**
+ * Restart reading the device if it stopped on a full queue. Must be called
+ * after draining the queue.
+ */
+void UAVTalkIO::resume()
+{
+    if (stalled.testAndSetOrdered(1, 0)) {
+        QMetaObject::invokeMethod(this, "processInputStream", Qt::QueuedConnection);
+    }
+}
+
+quint32 UAVTalkIO::takeRxBytes()
+{
+    return rxBytes.fetchAndStoreOrdered(0);
+}
+
+quint32 UAVTalkIO::takeRxErrors()
+{
+    return rxErrors.fetchAndStoreOrdered(0);
+}
+
+quint32 UAVTalkIO::takeTxErrors()
+{
+    return txErrors.fetchAndStoreOrdered(0);
+}
+
+/**
+ * Datagrams lost and reordered on the link since the last call, for devices
+ * that number their datagrams and publish the totals as the datagramsLost
+ * and datagramsReordered properties. Zero for other devices.
+ */
+void UAVTalkIO::takeDatagramLoss(quint32 *lost, quint32 *reordered)
+{
+    *lost = 0;
+    *reordered = 0;
+
+    if (io.isNull())
+        return;
+
+    // A late datagram takes back one lost, which has been reported already
+    quint32 totalLost = io->property("datagramsLost").toUInt();
+    if (totalLost > lostReported) {
+        *lost = totalLost - lostReported;
+        lostReported = totalLost;
+    }
+
+    quint32 totalReordered = io->property("datagramsReordered").toUInt();
+    if (totalReordered > reorderedReported) {
+        *reordered = totalReordered - reorderedReported;
+        reorderedReported = totalReordered;
+    }
+}
+
+/**
+ * Number of bytes sent but not yet written out by the device
+ */
+quint32 UAVTalkIO::txBacklog()
+{
+    return txQueuedBytes.loadAcquire() + txDeviceBytes.loadAcquire();
+}
+
+/**
+ * Account for a frame about to be handed to writeFrame(), sender side
+ */
+void UAVTalkIO::frameQueued(quint32 length)
+{
+    txQueuedBytes.fetchAndAddOrdered(length);
+}
+
+/**
+ * Write a complete frame to the device
+ */
+void UAVTalkIO::writeFrame(const QByteArray &frame)
+{
+    txQueuedBytes.fetchAndAddOrdered(-frame.size());
+
+    if (io.isNull() || !io->isWritable() || io->write(frame) != frame.size()) {
+        txErrors.fetchAndAddOrdered(1);
+    }
+
+    updateTxBacklog();
+}
+
+void UAVTalkIO::updateTxBacklog()
+{
+    txDeviceBytes.storeRelease(io.isNull() ? 0 : io->bytesToWrite());
+}
+
+/**
+ * Change the speed of a serial device, after what was written so far went
+ * out at the old speed. Does nothing for devices without a baudRate property.
+ */
+void UAVTalkIO::setDeviceSpeed(qint32 baud)
+{
+    if (io.isNull() || !io->property("baudRate").isValid())
+        return;
+
+    while (io->bytesToWrite() > 0) {
+        if (!io->waitForBytesWritten(100))
+            break;
+    }
+
+    io->setProperty("baudRate", baud);
+}
+
+/**
+ * Hand this object and the device over to another thread. Must run on the
+ * thread currently owning them.
+ */
+void UAVTalkIO::release(QThread *target)
+{
+    if (!io.isNull()) {
+        disconnect(io.data(), Q_NULLPTR, this, Q_NULLPTR);
+        io->moveToThread(target);
+    }
+
+    moveToThread(target);
+}
+
+/**
+ * Called each time there are data in the input buffer, and when the
+ * consumer has made room for a frame that didn't fit in the queue
+ */
+void UAVTalkIO::processInputStream()
+{
+    // Frames left in the buffer when the queue filled go first
+    while (processInput());
+    notifyFrames();
+
+    // Leaving the rest with the device pushes back on the sender
+    while (!stalled.loadAcquire() && io && io->isReadable()) {
+        if (startOffset > (sizeof(rxBuffer) - MAX_FRAME_LENGTH)) {
+            /* If we're not sure there's room for a frame, shift things left in
+             * the buffer so that we can do a bigger read.
+             */
+            memmove(rxBuffer, rxBuffer + startOffset, filledBytes - startOffset);
+
+            filledBytes -= startOffset;
+            startOffset = 0;
+        }
+
+        int bytes = io->read((char *) (rxBuffer + filledBytes),
+                sizeof(rxBuffer) - filledBytes);
+
+        if (bytes <= 0) {
+            break;
+        }
+
+        rxTimeUs = clockUs();
+        filledBytes += bytes;
+        rxBytes.fetchAndAddOrdered(bytes);
+
+        while (processInput());
+        notifyFrames();
+    }
+}
+
+/**
+ * Frame a block of bytes that didn't come from the device, e.g. a log
+ * record. The consumer is notified after each buffer full, so with a direct
+ * connection the frame queue is drained as we go and can't overflow.
+ */
+void UAVTalkIO::processBytes(const quint8 *data, quint32 length)
+{
+    while (length > 0) {
+        if (startOffset > (sizeof(rxBuffer) - MAX_FRAME_LENGTH)) {
+            memmove(rxBuffer, rxBuffer + startOffset, filledBytes - startOffset);
+
+            filledBytes -= startOffset;
+            startOffset = 0;
+        }
+
+        quint32 bytes = qMin<quint32>(length, sizeof(rxBuffer) - filledBytes);
+
+        memcpy(rxBuffer + filledBytes, data, bytes);
+        data += bytes;
+        length -= bytes;
+
+        rxTimeUs = clockUs();
+        filledBytes += bytes;
+        rxBytes.fetchAndAddOrdered(bytes);
+
+        while (processInput());
+
+        notifyFrames();
+    }
+}
+
+/**
+ * Tell the consumer about queued frames, unless a notification is pending
+ */
+void UAVTalkIO::notifyFrames()
+{
+    if (frameTail.loadAcquire() != frameHead.loadAcquire()
+        && notifyPending.testAndSetOrdered(0, 1)) {
+        emit framesAvailable();
+    }
+}
+
+/**
+ * Find a frame in the input buffer, if available, and queue it.
+ * \return False if there was insufficient data for a frame, true if trying
+ * again is worthwhile.
+ */
+bool UAVTalkIO::processInput()
+{
+    unsigned int bytesAvail = filledBytes - startOffset;
+
+    if (bytesAvail < sizeof(UAVTalk::UAVTalkHeader)) {
+        return false;
+    }
+
+    UAVTalk::UAVTalkHeader *hdr = (UAVTalk::UAVTalkHeader *) (rxBuffer + startOffset);
+
+    /* Basic framing checks.  If these fail, skip forward one byte and retry
+     * to capture stream sync.
+     */
+    if (hdr->sync != UAVTalk::SYNC_VAL) {
+        startOffset++;
+        rxErrors.fetchAndAddOrdered(1);
+
+        return true;
+    }
+
+    if ((hdr->type & UAVTalk::VER_MASK) != UAVTalk::TYPE_VER) {
+        startOffset++;
+        rxErrors.fetchAndAddOrdered(1);
+
+        return true;
+    }
+
+    if (hdr->size < sizeof(UAVTalk::UAVTalkHeader)) {
+        startOffset++;
+        rxErrors.fetchAndAddOrdered(1);
+
+        return true;
+    }
+
+    /* OK, let's ensure we have enough bytes for the whole frame. 
+     * Size doesn't include CRC, so add one.
+     */
+
+    if ((hdr->size + 1u) > bytesAvail) {
+        return false;
+    }
+
+    quint8 ourCrc = UAVTalk::updateCRC(0, rxBuffer + startOffset, hdr->size);
+    quint8 *theirCrc = rxBuffer + startOffset + hdr->size;
+
+    if (ourCrc != *theirCrc) {
+        /* Since we can't trust hdr->size for sure, we should just skip
+         * forward one byte.
+         */
+
+        startOffset++;
+        rxErrors.fetchAndAddOrdered(1);
+
+        return true;
+    }
+
+    if (!pushFrame(rxBuffer + startOffset, hdr->size + 1)) {
+        // Consumer is too far behind, keep the frame until resume()
+        stalled.storeRelease(1);
+
+        // The consumer may have drained the queue before seeing the flag
+        if (!pushFrame(rxBuffer + startOffset, hdr->size + 1)) {
+            return false;
+        }
+
+        stalled.storeRelease(0);
+    }
+
+    startOffset += hdr->size + 1;
+
+    return true;
+}
+
+/**
+ * Queue a checked frame for the consumer, producer side.
+ * \return False if the queue is full
+ */
+bool UAVTalkIO::pushFrame(const quint8 *data, quint32 length)
+{
+    quint32 head = frameHead.loadAcquire();
+
+    if (head - frameTail.loadAcquire() >= (quint32)FRAME_QUEUE_LEN) {
+        return false;
+    }
+
+    Frame &frame = frames[head & (FRAME_QUEUE_LEN - 1)];
+    frame.length = length;
+    frame.rxTimeUs = rxTimeUs;
+    memcpy(frame.data, data, length);
+
+    frameHead.storeRelease(head + 1);
+
+    return true;
+}
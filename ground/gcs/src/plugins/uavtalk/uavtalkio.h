@@ -0,0 +1,132 @@
+/**
+ ******************************************************************************
+ * @file       uavtalkio.h
+ *
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ *
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup UAVTalkPlugin UAVTalk Plugin
+ * @{
+ * @brief Device side of the UAVTalk link: reading, framing and writing
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef UAVTALKIO_H
+#define UAVTALKIO_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QIODevice>
+#include <QObject>
+#include <QPointer>
+
+class QThread;
+
+/**
+ * Reads the link device, finds and CRC checks UAVTalk frames and queues them
+ * for UAVTalk, and writes the frames UAVTalk sends.  It may live on its own
+ * thread so the link keeps being serviced while the GUI is busy; UAVObjects
+ * are never touched here.  The frame queue is lock-free with this object as
+ * the single producer and UAVTalk as the single consumer.  When it is full,
+ * reading stops until the consumer has caught up, so no frame is lost.
+ */
+class UAVTalkIO : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int MAX_FRAME_LENGTH = 256; // Header + payload + checksum
+
+    UAVTalkIO(QIODevice *iodev);
+
+    static qint64 clockUs();
+
+    quint8 *frontFrame(quint32 *length, qint64 *rxTimeUs = Q_NULLPTR);
+    void popFrame();
+    void clearNotify();
+    void resume();
+
+    quint32 takeRxBytes();
+    quint32 takeRxErrors();
+    quint32 takeTxErrors();
+    void takeDatagramLoss(quint32 *lost, quint32 *reordered);
+    quint32 txBacklog();
+    void frameQueued(quint32 length);
+    void processBytes(const quint8 *data, quint32 length);
+
+signals:
+    /**
+     * @brief Emitted when frames were queued while no notification was
+     * pending; the consumer calls clearNotify() and then drains the queue
+     */
+    void framesAvailable();
+
+public slots:
+    void writeFrame(const QByteArray &frame);
+    void release(QThread *target);
+    void setDeviceSpeed(qint32 baud);
+
+private slots:
+    void processInputStream();
+    void updateTxBacklog();
+
+private:
+    // Must be a power of two
+    static const int FRAME_QUEUE_LEN = 512;
+
+    struct Frame
+    {
+        quint32 length;
+        qint64 rxTimeUs; // When the bytes completing it were read
+        quint8 data[MAX_FRAME_LENGTH];
+    };
+
+    QPointer<QIODevice> io;
+
+    // This is a tradeoff between the frequency of the need to
+    // compact/copy left and buffer size.
+    quint8 rxBuffer[MAX_FRAME_LENGTH * 12];
+    quint32 startOffset;
+    quint32 filledBytes;
+    qint64 rxTimeUs; // When the last bytes were read, on clockUs()
+
+    Frame frames[FRAME_QUEUE_LEN];
+    QAtomicInteger<quint32> frameHead; // Only advanced by the producer
+    QAtomicInteger<quint32> frameTail; // Only advanced by the consumer
+    QAtomicInt notifyPending;
+    QAtomicInt stalled; // A frame is waiting for room in the queue
+
+    QAtomicInt rxBytes;
+    QAtomicInt rxErrors;
+    QAtomicInt txErrors;
+    QAtomicInt txQueuedBytes; // Handed to writeFrame() but not yet written
+    QAtomicInt txDeviceBytes; // Buffered by the device
+
+    // Device totals already handed out by takeDatagramLoss()
+    quint32 lostReported;
+    quint32 reorderedReported;
+
+    bool processInput();
+    void notifyFrames();
+    bool pushFrame(const quint8 *data, quint32 length);
+};
+
+#endif // UAVTALKIO_H
@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchflasher.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup  Uploader Uploader Plugin
+ * @{
+ * @brief Flashes every board sitting in the bootloader at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#include "batchflasher.h"
+
+#include <coreplugin/icore.h>
+#include <coreplugin/boardmanager.h>
+
+using namespace uploader;
+using namespace tl_dfu;
+
+BatchFlasher::BatchFlasher(QObject *parent)
+    : QObject(parent)
+    , pending(0)
+    , succeeded(0)
+{
+}
+
+BatchFlasher::~BatchFlasher()
+{
+    clearBoards();
+}
+
+void BatchFlasher::clearBoards()
+{
+    foreach (const Board &board, boards) {
+        board.dfu->wait();
+        delete board.dfu;
+    }
+    boards.clear();
+}
+
+int BatchFlasher::findBoards()
+{
+    if (isRunning())
+        return boards.size();
+
+    clearBoards();
+
+    // The upgrader-loader is left for the upgrade assistant
+    Core::BoardManager *brdMgr = Core::ICore::instance()->boardManager();
+    foreach (int vendorID, brdMgr->getKnownVendorIDs()) {
+        foreach (const USBPortInfo &port,
+                 USBMonitor::instance()->availableDevices(vendorID, -1, -1,
+                                                          USBMonitor::Bootloader)) {
+            Board board;
+            board.port = port;
+            board.dfu = new DFUObject();
+            board.step = STEP_FIRMWARE;
+            boards.append(board);
+        }
+    }
+
+    for (int i = 0; i < boards.size(); i++) {
+        DFUObject *dfu = boards[i].dfu;
+
+        connect(dfu, &DFUObject::operationProgress, this, [this, i](QString status, int progress) {
+            emit boardProgress(i, status, progress);
+        });
+        connect(dfu, &DFUObject::uploadFinished, this,
+                [this, i](tl_dfu::Status status) { onUploadFinished(i, status); });
+    }
+
+    return boards.size();
+}
+
+void BatchFlasher::start(const QByteArray &firmware, const QByteArray &description,
+                         int boardType)
+{
+    if (isRunning())
+        return;
+
+    // Fixed from here on, as opening a board runs the event loop
+    pending = boards.size();
+    succeeded = 0;
+    for (int i = 0; i < boards.size(); i++) {
+        boards[i].step = STEP_FIRMWARE;
+        boards[i].firmware = firmware;
+        boards[i].description = description;
+    }
+
+    for (int i = 0; i < boards.size(); i++)
+        startBoard(i, boardType);
+
+    if (boards.isEmpty())
+        emit finished(0, 0);
+}
+
+/**
+ * @brief Opens coms with a board, checks it can take the image and starts the upload
+ */
+void BatchFlasher::startBoard(int index, int boardType)
+{
+    Board &board = boards[index];
+
+    emit boardProgress(index, tr("Connecting..."), -1);
+    if (!board.dfu->OpenBootloaderComs(board.port)) {
+        finishBoard(index, false, tr("Could not open coms with the bootloader"));
+        return;
+    }
+
+    board.dev = board.dfu->findCapabilities();
+    if ((board.dev.ID >> 8) != boardType) {
+        finishBoard(index, false, tr("Firmware is for a different board"));
+        return;
+    }
+    if ((quint32)board.firmware.length() > board.dev.SizeOfCode) {
+        finishBoard(index, false, tr("Firmware is too big for the board"));
+        return;
+    }
+
+    board.dfu->UploadPartitionThreaded(board.firmware, DFU_PARTITION_FW, board.dev.SizeOfCode);
+}
+
+void BatchFlasher::onUploadFinished(int index, tl_dfu::Status status)
+{
+    Board &board = boards[index];
+
+    // The thread emits just before it returns
+    board.dfu->wait();
+
+    if (status != Last_operation_Success) {
+        finishBoard(index, false,
+                    board.step == STEP_FIRMWARE ? tr("Firmware upload failed")
+                                                : tr("Firmware metadata upload failed"));
+        return;
+    }
+
+    if (board.step == STEP_FIRMWARE && !board.description.isEmpty()) {
+        board.step = STEP_DESCRIPTION;
+        emit boardProgress(index, tr("Uploading firmware metadata..."), -1);
+        board.dfu->UploadPartitionThreaded(board.description, DFU_PARTITION_DESC,
+                                           board.dev.SizeOfDesc);
+        return;
+    }
+
+    board.step = STEP_DONE;
+    emit boardProgress(index, tr("Verifying..."), -1);
+
+    QString why;
+    if (!verify(board, why)) {
+        finishBoard(index, false, why);
+        return;
+    }
+
+    board.dfu->JumpToApp(false);
+    finishBoard(index, true, tr("Flashed and verified"));
+}
+
+/**
+ * @brief Reads back what the bootloader has on flash
+ * @param why filled with what didn't match
+ * @return true if the firmware CRC and descriptor match what was uploaded
+ */
+bool BatchFlasher::verify(Board &board, QString &why)
+{
+    device dev = board.dfu->findCapabilities();
+
+    if (dev.FW_CRC != DFUObject::CRCFromQBArray(board.firmware, dev.SizeOfCode)) {
+        why = tr("Firmware CRC mismatch");
+        return false;
+    }
+
+    if (!board.description.isEmpty()) {
+        QByteArray description = board.dfu->DownloadDescriptionAsByteArray(dev.SizeOfDesc);
+        if (!description.startsWith(board.description)) {
+            why = tr("Firmware metadata mismatch");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void BatchFlasher::finishBoard(int index, bool success, const QString &status)
+{
+    boards[index].dfu->CloseBootloaderComs();
+
+    if (success)
+        succeeded++;
+    emit boardFinished(index, success, status);
+
+    if (--pending == 0)
+        emit finished(succeeded, boards.size() - succeeded);
+}
+
+/**
+ * @}
+ * @}
+ */
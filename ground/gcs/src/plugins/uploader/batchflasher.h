@@ -0,0 +1,109 @@
+/**
+ ******************************************************************************
+ *
+ * @file       batchflasher.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup  Uploader Uploader Plugin
+ * @{
+ * @brief Flashes every board sitting in the bootloader at once
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ *
+ * Additional note on redistribution: The copyright and license notices above
+ * must be maintained in each individual source file that is a derivative work
+ * of this source file; otherwise redistribution is prohibited.
+ */
+
+#ifndef BATCHFLASHER_H
+#define BATCHFLASHER_H
+
+#include <QObject>
+#include <QVector>
+#include "tl_dfu.h"
+
+namespace uploader {
+
+/**
+ * @brief Flashes one firmware image to every board found in the bootloader.
+ *
+ * Each board gets its own DFUObject, so the uploads run concurrently on
+ * the DFUObject threads. After the firmware (and descriptor) is written
+ * the board is verified by reading back the firmware CRC and descriptor,
+ * and booted into the new firmware.
+ */
+class BatchFlasher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BatchFlasher(QObject *parent = 0);
+    ~BatchFlasher();
+
+    //! Find the boards in the bootloader, returns how many there are
+    int findBoards();
+
+    /**
+     * @brief Start flashing the boards found
+     * @param firmware image to flash
+     * @param description descriptor to write after the image, may be empty
+     * @param boardType boards of other types are refused
+     * @note finished() is emitted once all boards are done
+     */
+    void start(const QByteArray &firmware, const QByteArray &description, int boardType);
+
+    bool isRunning() const { return pending > 0; }
+    int boardCount() const { return boards.size(); }
+    //! Path of the USB device of a board, to tell boards apart
+    QString boardName(int index) const { return boards.at(index).port.path; }
+
+signals:
+    void boardProgress(int index, QString status, int progress);
+    void boardFinished(int index, bool success, QString status);
+    void finished(int succeeded, int failed);
+
+private:
+    enum Step { STEP_FIRMWARE, STEP_DESCRIPTION, STEP_DONE };
+
+    struct Board
+    {
+        USBPortInfo port;
+        tl_dfu::DFUObject *dfu;
+        tl_dfu::device dev;
+        Step step;
+        // Per board copies, the upload pads them on the board's thread
+        QByteArray firmware;
+        QByteArray description;
+    };
+
+    void clearBoards();
+    void startBoard(int index, int boardType);
+    void onUploadFinished(int index, tl_dfu::Status status);
+    bool verify(Board &board, QString &why);
+    void finishBoard(int index, bool success, const QString &status);
+
+    QVector<Board> boards;
+    int pending;
+    int succeeded;
+};
+}
+
+#endif // BATCHFLASHER_H
+
+/**
+ * @}
+ * @}
+ */
@@ -66,6 +66,11 @@ enum bl_commands {
     BL_MSG_WRITE_START =
         0x27, // f1 bl masks with 0b11111 so this looks like BL_MSG_WRITE_CONT there
     // the 6th bit ends up being start flag
+    BL_MSG_WRITE_START_WINDOWED = 0x28, // only sent if BL_CAP_FLAG_WINDOWED_WRITE is advertised
+    // only sent if BL_CAP_FLAG_DELTA_WRITE is advertised
+    BL_MSG_SECTOR_CRC_REQ = 0x29,
+    BL_MSG_SECTOR_CRC_REP = 0x2A,
+    BL_MSG_WRITE_SEEK = 0x2B,
 };
 
 #define BL_MSG_FLAGS_ECHO_REQ 0x80
@@ -120,6 +125,8 @@ struct msg_capabilities_rep_all
     uint16_t wrflags;
 };
 
+// Packed so the flags after the partition sizes don't pad the struct
+#pragma pack(push, 1)
 struct msg_capabilities_rep_specific
 {
     uint32_t fw_size;
@@ -134,8 +141,13 @@ struct msg_capabilities_rep_specific
 #define BL_CAP_EXTENSION_MAGIC 0x3456
     uint16_t cap_extension_magic;
     uint32_t partition_sizes[10];
+// Zero from bootloaders older than the flags
+#define BL_CAP_FLAG_WINDOWED_WRITE 0x01
+#define BL_CAP_FLAG_DELTA_WRITE 0x02
+    uint8_t cap_flags;
 #endif /* BL_INCLUDE_CAP_EXTENSIONS */
 };
+#pragma pack(pop)
 
 struct msg_enter_dfu
 {
@@ -195,6 +207,19 @@ struct msg_wipe_partition
     uint8_t label;
 };
 
+PACK(struct msg_sector_crc {
+    uint32_t offset; /* any offset in the sector, its start in replies */
+    uint32_t size; /* only used in replies, 0 if there is no such sector */
+    uint32_t crc; /* only used in replies */
+    uint8_t label;
+});
+
+struct msg_write_seek
+{
+    uint32_t offset; /* from the start of the partition */
+    uint32_t length; /* bytes written from offset on */
+};
+
 PACK(union msg_contents {
     struct msg_capabilities_req cap_req;
     struct msg_capabilities_rep_all cap_rep_all;
@@ -209,6 +234,8 @@ PACK(union msg_contents {
     struct msg_status_req status_req;
     struct msg_status_rep status_rep;
     struct msg_wipe_partition wipe_partition;
+    struct msg_sector_crc sector_crc;
+    struct msg_write_seek write_seek;
     uint8_t pad[62];
 });
 
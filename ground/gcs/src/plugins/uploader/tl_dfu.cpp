@@ -33,6 +33,7 @@
 
 #include <QApplication>
 #include <QThread>
+#include <QtEndian>
 
 #define TL_DFU_DEBUG
 #ifdef TL_DFU_DEBUG
@@ -41,10 +42,19 @@
 #define TL_DFU_QXTLOG_DEBUG(...)
 #endif // TL_DFU_DEBUG
 
+// Packets sent between status checks in windowed writes
+#define WRITE_WINDOW_PACKETS 128
+// A windowed write erases what the data didn't reach before the final CRC
+#define WRITE_FINISH_TIMEOUT_MS 60000
+// Reading back a sector CRC, the board may be reading a big sector
+#define SECTOR_CRC_TIMEOUT_MS 2000
+
 using namespace tl_dfu;
 
 DFUObject::DFUObject()
     : m_hidHandle(NULL)
+    , m_windowedWrite(false)
+    , m_deltaWrite(false)
 {
     qRegisterMetaType<tl_dfu::Status>("TL_DFU::Status");
 }
@@ -76,14 +86,15 @@ bool DFUObject::EnterDFU()
   @param numberOfByte number of bytes of the transfer
   @param label partition where the data will be uploaded to
   @param crc crc value of the data to be uploaded
+  @param windowed the board erases sectors as they are written instead of up front
   @returns result of the requested operation
   */
 bool DFUObject::StartUpload(qint32 const &numberOfBytes, dfu_partition_label const &label,
-                            quint32 crc)
+                            quint32 crc, bool windowed)
 {
     messagePackets msg = CalculatePadding(numberOfBytes);
     bl_messages message;
-    message.flags_command = BL_MSG_WRITE_START;
+    message.flags_command = windowed ? BL_MSG_WRITE_START_WINDOWED : BL_MSG_WRITE_START;
     message.v.xfer_start.expected_crc = ntohl(crc);
     message.v.xfer_start.packets_in_transfer = ntohl(msg.numberOfPackets);
     message.v.xfer_start.words_in_last_packet = msg.lastPacketCount;
@@ -94,9 +105,11 @@ bool DFUObject::StartUpload(qint32 const &numberOfBytes, dfu_partition_label con
                             .arg(msg.lastPacketCount));
 
     int result = SendData(message);
-    QEventLoop m_eventloop;
-    QTimer::singleShot(500, &m_eventloop, &QEventLoop::quit);
-    m_eventloop.exec();
+    if (!windowed) {
+        QEventLoop m_eventloop;
+        QTimer::singleShot(500, &m_eventloop, &QEventLoop::quit);
+        m_eventloop.exec();
+    }
     TL_DFU_QXTLOG_DEBUG(QString("%0 bytes sent").arg(result));
     if (result > 0)
         return true;
@@ -108,9 +121,11 @@ bool DFUObject::StartUpload(qint32 const &numberOfBytes, dfu_partition_label con
   board is ready to accept data following a StartUpload command, and it is erased.
   @param numberOfBytes number of bytes to transfer
   @param data data to transfer
+  @param windowed check how far the board got every WRITE_WINDOW_PACKETS packets,
+  which also waits out sector erases
   @returns result of the requested operation
   */
-bool DFUObject::UploadData(qint32 const &numberOfBytes, QByteArray &data)
+bool DFUObject::UploadData(qint32 const &numberOfBytes, QByteArray &data, bool windowed)
 {
     messagePackets msg = CalculatePadding(numberOfBytes);
     TL_DFU_QXTLOG_DEBUG(QString("Start Uploading:%0 56 byte packets").arg(msg.numberOfPackets));
@@ -135,7 +150,151 @@ bool DFUObject::UploadData(qint32 const &numberOfBytes, QByteArray &data)
         int result = SendData(message);
         if (result < 1)
             return false;
+
+        if (windowed && (packetcount + 1) % WRITE_WINDOW_PACKETS == 0) {
+            statusReport rep = StatusRequest();
+            if (rep.status != tl_dfu::uploading || rep.additional != packetcount + 1) {
+                qDebug() << QString("[tl_dfu] Board stopped at packet %0 of %1")
+                                .arg(rep.additional)
+                                .arg(packetcount + 1);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+  Asks the board for the extents and CRC of a flash sector
+  @param label partition to look in
+  @param offset any offset within the sector, from the start of the partition
+  @param sectorOffset filled with the start of the sector
+  @param sectorSize filled with the size of the sector
+  @param crc filled with the CRC of the whole sector
+  @returns false if the board doesn't have such a sector or didn't reply
+  */
+bool DFUObject::SectorCRC(dfu_partition_label label, quint32 offset, quint32 &sectorOffset,
+                          quint32 &sectorSize, quint32 &crc)
+{
+    bl_messages message;
+    message.flags_command = BL_MSG_SECTOR_CRC_REQ;
+    message.v.sector_crc.offset = ntohl(offset);
+    message.v.sector_crc.label = label;
+    if (SendData(message) < 1)
+        return false;
+
+    if (ReceiveData(message, SECTOR_CRC_TIMEOUT_MS) < 1
+        || message.flags_command != BL_MSG_SECTOR_CRC_REP)
+        return false;
+
+    sectorOffset = ntohl(message.v.sector_crc.offset);
+    sectorSize = ntohl(message.v.sector_crc.size);
+    crc = ntohl(message.v.sector_crc.crc);
+
+    // Must be the sector asked for, and move the caller forwards
+    return sectorSize > 0 && sectorOffset <= offset && offset - sectorOffset < sectorSize;
+}
+
+/**
+  Compares the new partition contents with the board's flash a sector at a time
+  @param data word padded data to upload
+  @param label partition the data will be uploaded to
+  @param partitionSize size of the partition, which is blank after the data
+  @param ranges filled with the parts of the data in sectors that differ,
+  sector runs that are next to each other are merged
+  @returns false if the board couldn't tell the sector CRCs
+  */
+bool DFUObject::FindChangedRanges(QByteArray &data, dfu_partition_label label,
+                                  quint32 partitionSize, QVector<writeRange> &ranges)
+{
+    const quint32 dataSize = data.length();
+
+    ranges.clear();
+    for (quint32 offset = 0; offset < partitionSize;) {
+        quint32 sectorOffset, sectorSize, crc;
+        if (!SectorCRC(label, offset, sectorOffset, sectorSize, crc))
+            return false;
+
+        quint32 sectorEnd = sectorOffset + sectorSize;
+        if (sectorOffset < dataSize && crc != CRCFromQBArrayRange(data, sectorOffset, sectorSize)) {
+            quint32 end = qMin(sectorEnd, dataSize);
+            if (!ranges.isEmpty() && ranges.last().offset + ranges.last().length == sectorOffset) {
+                ranges.last().length = end - ranges.last().offset;
+            } else {
+                writeRange range = { sectorOffset, end - sectorOffset };
+                ranges.append(range);
+            }
+        }
+        // Changed sectors past the data are erased by the board at the end of the write
+
+        offset = sectorEnd;
+    }
+
+    return true;
+}
+
+/**
+  Uploads only the given ranges of the data in a windowed write, seeking over the rest.
+  Needs to be called once the board accepts data following a windowed StartUpload.
+  @param data word padded data to transfer
+  @param ranges word aligned parts of the data to write, in order
+  @returns result of the requested operation
+  */
+bool DFUObject::UploadDelta(QByteArray &data, const QVector<writeRange> &ranges)
+{
+    quint32 totalBytes = 0;
+    foreach (const writeRange &range, ranges)
+        totalBytes += range.length;
+
+    bl_messages message;
+    quint32 packetcount = 0;
+    quint32 bytesSent = 0;
+    int laspercentage = 0;
+
+    foreach (const writeRange &range, ranges) {
+        message.flags_command = BL_MSG_WRITE_SEEK;
+        message.v.write_seek.offset = ntohl(range.offset);
+        message.v.write_seek.length = ntohl(range.length);
+        if (SendData(message) < 1)
+            return false;
+
+        message.flags_command = BL_MSG_WRITE_CONT;
+        for (quint32 pos = 0; pos < range.length; pos += XFER_BYTES_PER_PACKET) {
+            int packetsize = qMin<quint32>(XFER_BYTES_PER_PACKET, range.length - pos);
+            message.v.xfer_cont.current_packet_number = ntohl(packetcount);
+            CopyWords(data.data() + range.offset + pos, (char *)message.v.xfer_cont.data,
+                      packetsize);
+            if (SendData(message) < 1)
+                return false;
+            ++packetcount;
+
+            bytesSent += packetsize;
+            int percentage = (quint64)bytesSent * 100 / totalBytes;
+            if (laspercentage != percentage)
+                emit operationProgress("", percentage);
+            laspercentage = percentage;
+
+            if (packetcount % WRITE_WINDOW_PACKETS == 0) {
+                statusReport rep = StatusRequest();
+                if (rep.status != tl_dfu::uploading || rep.additional != packetcount) {
+                    qDebug() << QString("[tl_dfu] Board stopped at packet %0 of %1")
+                                    .arg(rep.additional)
+                                    .arg(packetcount);
+                    return false;
+                }
+            }
+        }
+    }
+
+    // Skip whatever is left unchanged to complete the transfer
+    if (ranges.isEmpty() || ranges.last().offset + ranges.last().length < (quint32)data.length()) {
+        message.flags_command = BL_MSG_WRITE_SEEK;
+        message.v.write_seek.offset = ntohl((quint32)data.length());
+        message.v.write_seek.length = 0;
+        if (SendData(message) < 1)
+            return false;
     }
+
     return true;
 }
 
@@ -369,8 +528,9 @@ int DFUObject::JumpToApp(bool safeboot)
 
 /**
   Requests the current bootloader status
+  @param timeoutMS how long to wait for the reply
   */
-DFUObject::statusReport DFUObject::StatusRequest()
+DFUObject::statusReport DFUObject::StatusRequest(int timeoutMS)
 {
     DFUObject::statusReport rep;
 
@@ -380,7 +540,7 @@ DFUObject::statusReport DFUObject::StatusRequest()
     Q_UNUSED(result);
 
     TL_DFU_QXTLOG_DEBUG(QString("StatusRequest:%0 bytes sent").arg(result));
-    result = ReceiveData(message);
+    result = ReceiveData(message, timeoutMS);
     TL_DFU_QXTLOG_DEBUG(QString("StatusRequest:%0 bytes received").arg(result));
     if (message.flags_command == BL_MSG_STATUS_REP) {
         TL_DFU_QXTLOG_DEBUG(QString("Status:%0").arg(message.v.status_rep.current_state));
@@ -422,6 +582,12 @@ device DFUObject::findCapabilities()
         currentDevice.CapExt = true;
     else
         currentDevice.CapExt = false;
+    currentDevice.WindowedWrite =
+        currentDevice.CapExt && (message.v.cap_rep_specific.cap_flags & BL_CAP_FLAG_WINDOWED_WRITE);
+    m_windowedWrite = currentDevice.WindowedWrite;
+    currentDevice.DeltaWrite = currentDevice.WindowedWrite
+        && (message.v.cap_rep_specific.cap_flags & BL_CAP_FLAG_DELTA_WRITE);
+    m_deltaWrite = currentDevice.DeltaWrite;
     currentDevice.SizeOfDesc = message.v.cap_rep_specific.desc_size;
     currentDevice.ID = ntohs(message.v.cap_rep_specific.device_id);
     message.v.cap_rep_specific.device_number = 1;
@@ -512,6 +678,9 @@ retry:
   */
 void DFUObject::CloseBootloaderComs()
 {
+    m_windowedWrite = false;
+    m_deltaWrite = false;
+
     if (m_hidHandle) {
         hid_close(m_hidHandle);
 
@@ -585,7 +754,29 @@ tl_dfu::Status DFUObject::UploadPartition(QByteArray &sourceArray, dfu_partition
     quint32 crc = DFUObject::CRCFromQBArray(sourceArray, threadJob.partition_size);
     TL_DFU_QXTLOG_DEBUG(QString("NEW FIRMWARE CRC=%0").arg(crc));
 
-    if (!StartUpload(sourceArray.length(), partition, crc)) {
+    // Capabilities of the board the coms were opened to
+    const bool windowed = m_windowedWrite;
+    TL_DFU_QXTLOG_DEBUG(QString("Windowed write:%0").arg(windowed));
+
+    // Rewrite only the sectors that differ, if the board can tell which
+    QVector<writeRange> ranges;
+    bool delta = false;
+    if (m_deltaWrite && partition != DFU_PARTITION_DESC) {
+        emit operationProgress(QString("Comparing with the board..."), -1);
+        delta = FindChangedRanges(sourceArray, partition, threadJob.partition_size, ranges);
+        if (delta) {
+            quint32 changed = 0;
+            foreach (const writeRange &range, ranges)
+                changed += range.length;
+            TL_DFU_QXTLOG_DEBUG(QString("Delta write:%0 of %1 bytes changed")
+                                    .arg(changed)
+                                    .arg(sourceArray.length()));
+        } else {
+            TL_DFU_QXTLOG_DEBUG("Couldn't read sector CRCs, writing the whole partition");
+        }
+    }
+
+    if (!StartUpload(sourceArray.length(), partition, crc, windowed)) {
         ret = StatusRequest();
         qDebug() << QString("[tl_dfu] StartUpload failed, status: %1, additional: 0x%2")
                         .arg(StatusToString(ret.status))
@@ -615,7 +806,8 @@ tl_dfu::Status DFUObject::UploadPartition(QByteArray &sourceArray, dfu_partition
     emit operationProgress(
         QString(tr("Uploading %0 partition...")).arg(partitionStringFromLabel(partition)), -1);
 
-    if (!UploadData(sourceArray.length(), sourceArray)) {
+    if (delta ? !UploadDelta(sourceArray, ranges)
+              : !UploadData(sourceArray.length(), sourceArray, windowed)) {
         ret = StatusRequest();
         qDebug() << QString("[tl_dfu] UploadData failed, status: %1, additional: 0x%2")
                         .arg(StatusToString(ret.status))
@@ -631,7 +823,7 @@ tl_dfu::Status DFUObject::UploadPartition(QByteArray &sourceArray, dfu_partition
 
         return ret.status;
     }
-    ret = StatusRequest();
+    ret = windowed ? StatusRequest(WRITE_FINISH_TIMEOUT_MS) : StatusRequest();
     if (ret.status != tl_dfu::Last_operation_Success) {
         qDebug() << QString("[tl_dfu] Upload failed, status: %1, additional: 0x%2")
                         .arg(StatusToString(ret.status))
@@ -692,6 +884,21 @@ quint32 DFUObject::CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer)
     return (Crc);
 }
 
+/**
+  Utility function
+  Calculates the CRC value of part of a word padded array, as the bootloader does
+  for a flash sector. Bytes past the end of the array are taken as blank.
+  */
+quint32 DFUObject::CRCFromQBArrayRange(const QByteArray &array, quint32 offset, quint32 size)
+{
+    QVector<quint32> words(size / 4, 0xFFFFFFFF);
+    const uchar *bytes = (const uchar *)array.constData();
+    for (quint32 x = 0; x < size / 4 && offset + x * 4 + 4 <= (quint32)array.length(); x++)
+        words[x] = qFromLittleEndian<quint32>(bytes + offset + x * 4);
+
+    return DFUObject::CRC32WideFast(0xFFFFFFFF, size / 4, words.data());
+}
+
 /**
   Utility function
   Calculates the CRC value of an array after padding it to the format used with the bootloader
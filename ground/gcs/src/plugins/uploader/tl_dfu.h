@@ -71,6 +71,8 @@ struct device
     QVector<quint32> PartitionSizes;
     int HW_Rev;
     bool CapExt;
+    bool WindowedWrite;
+    bool DeltaWrite;
 };
 
 class DFUObject : public QThread
@@ -90,6 +92,12 @@ class DFUObject : public QThread
         tl_dfu::Status status;
     } statusReport;
 
+    typedef struct writeRange
+    {
+        quint32 offset;
+        quint32 length;
+    } writeRange;
+
 public:
     static quint32 CRCFromQBArray(QByteArray array, quint32 Size);
     DFUObject();
@@ -125,12 +133,13 @@ private:
     // Helper functions:
     QString StatusToString(tl_dfu::Status const &status);
     static quint32 CRC32WideFast(quint32 Crc, quint32 Size, quint32 *Buffer);
+    static quint32 CRCFromQBArrayRange(const QByteArray &array, quint32 offset, quint32 size);
     void CopyWords(char *source, char *destination, int count);
     messagePackets CalculatePadding(quint32 numberOfBytes);
 
     // Service commands:
     bool EnterDFU();
-    statusReport StatusRequest();
+    statusReport StatusRequest(int timeoutMS = 10000);
     bool EndOperation();
     int AbortOperation(void);
 
@@ -138,9 +147,17 @@ private:
     int SendData(bl_messages);
     int ReceiveData(bl_messages &data, int timeoutMS = 10000);
     hid_device *m_hidHandle;
-
-    bool StartUpload(qint32 const &numberOfBytes, const dfu_partition_label &label, quint32 crc);
-    bool UploadData(qint32 const &numberOfPackets, QByteArray &data);
+    bool m_windowedWrite; // Board erases as it's written, see findCapabilities()
+    bool m_deltaWrite; // Board can skip sectors of a windowed write
+
+    bool StartUpload(qint32 const &numberOfBytes, const dfu_partition_label &label, quint32 crc,
+                     bool windowed);
+    bool UploadData(qint32 const &numberOfPackets, QByteArray &data, bool windowed);
+    bool SectorCRC(dfu_partition_label label, quint32 offset, quint32 &sectorOffset,
+                   quint32 &sectorSize, quint32 &crc);
+    bool FindChangedRanges(QByteArray &data, dfu_partition_label label, quint32 partitionSize,
+                           QVector<writeRange> &ranges);
+    bool UploadDelta(QByteArray &data, const QVector<writeRange> &ranges);
 
     typedef struct ThreadJobStruc
     {
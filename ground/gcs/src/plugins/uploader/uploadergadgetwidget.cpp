@@ -31,6 +31,11 @@
 
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QDialog>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QTableWidget>
+#include <QVBoxLayout>
 #include <QDesktopServices>
 #include <QHttpPart>
 #include <QHttpMultiPart>
@@ -112,8 +117,8 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent)
             &UploaderGadgetWidget::onAutopilotDisconnect, Qt::QueuedConnection);
     firmwareIap = FirmwareIAPObj::GetInstance(obm);
 
-    connect(firmwareIap, &UAVObject::objectUpdated, this, &UploaderGadgetWidget::onIAPUpdated,
-            Qt::QueuedConnection);
+    connect(utilMngr, &UAVObjectUtilManager::boardInfoChanged, this,
+            &UploaderGadgetWidget::onIAPUpdated, Qt::QueuedConnection);
 
     // Connect button signals to slots
     connect(m_widget->openButton, &QAbstractButton::clicked, this,
@@ -122,6 +127,8 @@ UploaderGadgetWidget::UploaderGadgetWidget(QWidget *parent)
             &UploaderGadgetWidget::onRescueButtonClick);
     connect(m_widget->flashButton, &QAbstractButton::clicked, this,
             &UploaderGadgetWidget::onFlashButtonClick);
+    connect(m_widget->flashAllButton, &QAbstractButton::clicked, this,
+            &UploaderGadgetWidget::onFlashAllButtonClick);
     connect(m_widget->bootButton, &QAbstractButton::clicked, this,
             &UploaderGadgetWidget::onBootButtonClick);
     connect(m_widget->safeBootButton, &QAbstractButton::clicked, this,
@@ -483,13 +490,7 @@ bool UploaderGadgetWidget::flashFirmware(QByteArray &firmwareImage)
         return true;
     }
 
-    tempArray.clear();
-    tempArray.append(firmwareImage.right(100));
-    tempArray.chop(12);
-    QString user("            ");
-    user = user.replace(0, m_widget->userDefined_LD_lbl->text().length(),
-                        m_widget->userDefined_LD_lbl->text());
-    tempArray.append(user.toLatin1());
+    tempArray = firmwareDescription(firmwareImage);
     setStatusInfo(tr("Starting firmware metadata upload"), uploader::STATUSICON_INFO);
     dfu.UploadPartitionThreaded(tempArray, DFU_PARTITION_DESC, 100);
 
@@ -521,6 +522,23 @@ bool UploaderGadgetWidget::flashFirmware(QByteArray &firmwareImage)
     return true;
 }
 
+/**
+ * @brief Builds the firmware metadata to upload after an image, with the
+ * user defined field as entered in the widget
+ * @param firmwareImage image with the metadata in its last 100 bytes
+ */
+QByteArray UploaderGadgetWidget::firmwareDescription(const QByteArray &firmwareImage)
+{
+    QByteArray description = firmwareImage.right(100);
+    description.chop(12);
+    QString user("            ");
+    user = user.replace(0, m_widget->userDefined_LD_lbl->text().length(),
+                        m_widget->userDefined_LD_lbl->text());
+    description.append(user.toLatin1());
+
+    return description;
+}
+
 /**
  * @brief slot called when the user presses the flash firmware button
  * It start a non blocking firmware upload
@@ -533,6 +551,93 @@ void UploaderGadgetWidget::onFlashButtonClick()
     }
 }
 
+/**
+ * @brief slot called when the user presses the flash all button
+ * Flashes the loaded firmware to every board in the bootloader concurrently,
+ * showing the progress of each board in a dialog
+ */
+void UploaderGadgetWidget::onFlashAllButtonClick()
+{
+    deviceDescriptorStruct firmware;
+    if (!utilMngr->descriptionToStructure(loadedFile.right(100), firmware)) {
+        setStatusInfo(tr("Flashing all boards needs a firmware file with valid metadata"),
+                      uploader::STATUSICON_FAIL);
+        return;
+    }
+
+    if (!batchFlasher)
+        batchFlasher = new BatchFlasher(this);
+    if (batchFlasher->isRunning())
+        return;
+
+    // The batch opens every board itself, the one shown here included
+    dfu.CloseBootloaderComs();
+
+    int count = batchFlasher->findBoards();
+    if (count == 0) {
+        setStatusInfo(tr("No devices in bootloader state detected"), uploader::STATUSICON_FAIL);
+        return;
+    }
+
+    QDialog *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle(tr("Flashing %0 boards").arg(count));
+    dialog->resize(600, 60 + 30 * count);
+
+    QTableWidget *table = new QTableWidget(count, 3, dialog);
+    table->setHorizontalHeaderLabels(QStringList() << tr("Device") << tr("Progress")
+                                                   << tr("Status"));
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->verticalHeader()->setVisible(false);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setSelectionMode(QAbstractItemView::NoSelection);
+    for (int i = 0; i < count; i++) {
+        table->setItem(i, 0, new QTableWidgetItem(batchFlasher->boardName(i)));
+        table->setCellWidget(i, 1, new QProgressBar(table));
+        table->setItem(i, 2, new QTableWidgetItem(tr("Waiting")));
+    }
+    table->resizeColumnToContents(0);
+
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+    layout->addWidget(table);
+
+    connect(batchFlasher, &BatchFlasher::boardProgress, table,
+            [table](int index, QString status, int progress) {
+                QProgressBar *bar = qobject_cast<QProgressBar *>(table->cellWidget(index, 1));
+                if (progress < 0) {
+                    bar->setRange(0, 0);
+                } else {
+                    bar->setRange(0, 100);
+                    bar->setValue(progress);
+                }
+                if (!status.isEmpty())
+                    table->item(index, 2)->setText(status);
+            });
+    connect(batchFlasher, &BatchFlasher::boardFinished, table,
+            [table](int index, bool success, QString status) {
+                QProgressBar *bar = qobject_cast<QProgressBar *>(table->cellWidget(index, 1));
+                bar->setRange(0, 100);
+                bar->setValue(success ? 100 : 0);
+                table->item(index, 2)->setText(status);
+                table->item(index, 2)->setForeground(success ? Qt::darkGreen : Qt::red);
+            });
+
+    connect(batchFlasher, &BatchFlasher::finished, this, [this](int succeeded, int failed) {
+        // The next batch connects afresh, the dialog keeps the results
+        batchFlasher->disconnect();
+
+        // Flashed boards have booted, the widget no longer sits on any of them
+        onBootloaderRemoved();
+        setStatusInfo(tr("Flashed %0 boards, %1 failed").arg(succeeded).arg(failed),
+                      failed ? uploader::STATUSICON_FAIL : uploader::STATUSICON_OK);
+    });
+
+    setUploaderStatus(uploader::BL_BUSY);
+    dialog->show();
+
+    batchFlasher->start(loadedFile, firmwareDescription(loadedFile), firmware.boardType);
+}
+
 void UploaderGadgetWidget::haltOrReset(bool halting)
 {
     if (!firmwareIap->getIsPresentOnHardware())
@@ -1310,6 +1415,10 @@ void UploaderGadgetWidget::onBootloaderDetected()
         return;
     }
 
+    // Boards come and go while flashing all of them
+    if (batchFlasher && batchFlasher->isRunning())
+        return;
+
     foreach (int vendorID, brdMgr->getKnownVendorIDs()) {
         devices.append(
             USBMonitor::instance()->availableDevices(vendorID, -1, -1, USBMonitor::Upgrader));
@@ -1490,6 +1599,9 @@ void UploaderGadgetWidget::onBootloaderDetected()
  */
 void UploaderGadgetWidget::onBootloaderRemoved()
 {
+    if (batchFlasher && batchFlasher->isRunning())
+        return;
+
     conMngr->resumePolling();
     setStatusInfo(tr("Bootloader disconnection detected"), uploader::STATUSICON_INFO);
     DeviceInformationClear();
@@ -1820,6 +1932,7 @@ void UploaderGadgetWidget::setUploaderStatus(const uploader::UploaderStatus &val
         m_widget->bootButton->setEnabled(false);
         m_widget->safeBootButton->setEnabled(false);
         m_widget->flashButton->setEnabled(false);
+        m_widget->flashAllButton->setEnabled(false);
         m_widget->exportConfigButton->setEnabled(false);
         m_widget->partitionBrowserTW->setContextMenuPolicy(Qt::NoContextMenu);
         break;
@@ -1834,6 +1947,7 @@ void UploaderGadgetWidget::setUploaderStatus(const uploader::UploaderStatus &val
         m_widget->bootButton->setEnabled(false);
         m_widget->safeBootButton->setEnabled(false);
         m_widget->flashButton->setEnabled(false);
+        m_widget->flashAllButton->setEnabled(false);
         m_widget->exportConfigButton->setEnabled(false);
         m_widget->partitionBrowserTW->setContextMenuPolicy(Qt::NoContextMenu);
         break;
@@ -1849,8 +1963,10 @@ void UploaderGadgetWidget::setUploaderStatus(const uploader::UploaderStatus &val
         m_widget->safeBootButton->setEnabled(true);
         if (!loadedFile.isEmpty())
             m_widget->flashButton->setEnabled(true);
+            m_widget->flashAllButton->setEnabled(true);
         else
             m_widget->flashButton->setEnabled(false);
+            m_widget->flashAllButton->setEnabled(false);
 
         m_widget->exportConfigButton->setEnabled(haveSettingsPart());
 
@@ -1867,6 +1983,7 @@ void UploaderGadgetWidget::setUploaderStatus(const uploader::UploaderStatus &val
         m_widget->bootButton->setEnabled(true);
         m_widget->safeBootButton->setEnabled(false);
         m_widget->flashButton->setEnabled(false);
+        m_widget->flashAllButton->setEnabled(false);
         m_widget->exportConfigButton->setEnabled(true);
 
         m_widget->partitionBrowserTW->setContextMenuPolicy(Qt::NoContextMenu);
@@ -1881,6 +1998,7 @@ void UploaderGadgetWidget::setUploaderStatus(const uploader::UploaderStatus &val
         m_widget->bootButton->setEnabled(false);
         m_widget->safeBootButton->setEnabled(false);
         m_widget->flashButton->setEnabled(false);
+        m_widget->flashAllButton->setEnabled(false);
         m_widget->exportConfigButton->setEnabled(false);
         m_widget->partitionBrowserTW->setContextMenuPolicy(Qt::NoContextMenu);
         break;
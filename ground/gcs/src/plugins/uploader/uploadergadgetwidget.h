@@ -42,6 +42,7 @@
 #include "coreplugin/connectionmanager.h"
 #include "uavsettingsimportexport/uavsettingsimportexportmanager.h"
 #include "upgradeassistantdialog.h"
+#include "batchflasher.h"
 
 class QNetworkAccessManager;
 class Ui_UploaderWidget;
@@ -76,6 +77,7 @@ private slots:
     void onIAPUpdated();
     void onLoadFirmwareButtonClick();
     void onFlashButtonClick();
+    void onFlashAllButtonClick();
     void onRescueButtonClick();
     void onExportButtonClick();
     void onBootloaderDetected();
@@ -123,6 +125,7 @@ private:
     void doUpgradeOperation(bool blankFC, tl_dfu::device &dev);
     void upgradeError(QString why);
     bool flashFirmware(QByteArray &firmwareImage);
+    QByteArray firmwareDescription(const QByteArray &firmwareImage);
     bool haveSettingsPart() const;
 
     Ui_UploaderWidget *m_widget;
@@ -136,6 +139,7 @@ private:
     QByteArray settingsDump;
 
     DFUObject dfu;
+    QPointer<BatchFlasher> batchFlasher;
     USBSignalFilter *usbFilterBL;
     USBSignalFilter *usbFilterUP;
     ExtensionSystem::PluginManager *pm;
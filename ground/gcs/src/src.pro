@@ -6,3 +6,8 @@ SUBDIRS = \
     plugins \
     app \
     crashreporterapp
+
+# Throughput benchmarks of the telemetry paths, see benchmark/benchmark.h
+BENCHMARK {
+    SUBDIRS += benchmark
+}
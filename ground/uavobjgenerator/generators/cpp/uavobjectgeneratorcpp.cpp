@@ -0,0 +1,171 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectgeneratorcpp.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      produce plain C++ structs for uavobjects
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "uavobjectgeneratorcpp.h"
+
+using namespace std;
+
+bool UAVObjectGeneratorCPP::generate(UAVObjectParser* parser,QString templatepath,QString outputpath) {
+    fieldTypeStr << "int8_t" << "int16_t" << "int32_t" <<
+        "uint8_t" << "uint16_t" << "uint32_t" << "float" << "uint8_t";
+
+    fieldTypeEnumStr << "INT8" << "INT16" << "INT32"
+        << "UINT8" << "UINT16" << "UINT32" << "FLOAT32" << "ENUM";
+
+    QDir cppTemplatePath = QDir( templatepath + QString("shared/uavobjectcpp"));
+    cppOutputPath = QDir( outputpath + QString("cpp") );
+    cppOutputPath.mkpath(cppOutputPath.absolutePath());
+
+    cppObjectTemplate = readFile( cppTemplatePath.absoluteFilePath("uavobjecttemplate.h") );
+    QString cppObjectsTemplate = readFile( cppTemplatePath.absoluteFilePath("uavobjectstemplate.h") );
+    QString cppCommonHeader = readFile( cppTemplatePath.absoluteFilePath("uavobjectpod.h") );
+
+    if (cppObjectTemplate.isEmpty() || cppObjectsTemplate.isEmpty() || cppCommonHeader.isEmpty()) {
+        cerr << "Problem reading cpp templates" << endl;
+        return false;
+    }
+
+    for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
+        ObjectInfo* info = parser->getObjectByIndex(objidx);
+        if (!process_object(parser, info))
+            return false;
+    }
+
+    replaceCommonTags(cppObjectsTemplate);
+    cppObjectsTemplate.replace( QString("$(INCLUDES)"), includesCode);
+    cppObjectsTemplate.replace( QString("$(DISPATCHCASES)"), dispatchCode);
+
+    bool res = writeFileIfDiffrent( cppOutputPath.absolutePath() + "/uavobjects.h",
+                                    cppObjectsTemplate );
+    res = res && writeFileIfDiffrent( cppOutputPath.absolutePath() + "/uavobjectpod.h",
+                                      cppCommonHeader );
+    if (!res) {
+        cout << "Error: Could not write cpp output files" << endl;
+        return false;
+    }
+
+    return true; // if we come here everything should be fine
+}
+
+QString UAVObjectGeneratorCPP::form_enum_name(const QString &fieldName, const QString &option) {
+    return QString("%1_%2").arg( fieldName.toUpper() )
+        .arg( option.toUpper().replace(QRegExp(ENUM_SPECIAL_CHARS), ""));
+}
+
+/**
+ * Generate the struct of an object, with its fields in packing order
+ */
+bool UAVObjectGeneratorCPP::process_object(UAVObjectParser* parser, ObjectInfo* info)
+{
+    if (info == NULL)
+        return false;
+
+    QString out = cppObjectTemplate;
+    replaceCommonTags(out, info);
+
+    QString constants;
+    QString datafields;
+    QString visits;
+    QString asserts;
+    QString fieldinfo;
+    int fieldOffset = 0;
+
+    for (int n = 0; n < info->fields.length(); ++n) {
+        FieldInfo *field = info->fields[n];
+
+        if (field->type == FIELDTYPE_ENUM) {
+            constants.append(QString("    /* Enumeration options for field %1 */\n").arg(field->name));
+            constants.append(QString("    enum %1Options : uint8_t { ").arg(field->name));
+            for (int m = 0; m < field->options.length(); ++m) {
+                // Inherited options keep the values of the parent
+                QString s = (m != (field->options.length()-1)) ? "%1=%2, " : "%1=%2";
+                constants.append( s.arg( form_enum_name(field->name, field->options[m]) )
+                                   .arg( parser->findOptionIndex(field, m) ) );
+            }
+            constants.append(" };\n");
+        }
+
+        if (field->numElements > 1 && !field->defaultElementNames) {
+            constants.append(QString("    /* Array element names for field %1 */\n").arg(field->name));
+            constants.append(QString("    enum %1Elem { ").arg(field->name));
+            for (int m = 0; m < field->elementNames.length(); ++m) {
+                QString s = (m != (field->elementNames.length()-1)) ? "%1_%2=%3, " : "%1_%2=%3";
+                constants.append( s.arg( field->name.toUpper() )
+                                   .arg( field->elementNames[m].toUpper() )
+                                   .arg(m) );
+            }
+            constants.append(" };\n");
+        }
+
+        if (field->numElements > 1) {
+            constants.append( QString("    static const uint16_t %1_NUMELEM = %2;\n")
+                              .arg( field->name.toUpper() )
+                              .arg( field->numElements ) );
+            datafields.append( QString("    %1 %2[%3];\n")
+                               .arg(fieldTypeStr[field->type])
+                               .arg(field->name)
+                               .arg(field->numElements) );
+        } else {
+            datafields.append( QString("    %1 %2;\n")
+                               .arg(fieldTypeStr[field->type])
+                               .arg(field->name) );
+        }
+
+        visits.append( QString("        v(\"%1\", %1);\n").arg(field->name) );
+
+        asserts.append( QString("static_assert(offsetof(%1, %2) == %3, \"%1.%2 is misplaced\");\n")
+                        .arg(info->name).arg(field->name).arg(fieldOffset) );
+
+        fieldinfo.append( QString("    { \"%1\", FieldType::%2, %3, %4, \"%5\" },\n")
+                          .arg(field->name)
+                          .arg(fieldTypeEnumStr[field->type])
+                          .arg(field->numElements)
+                          .arg(fieldOffset)
+                          .arg(field->units) );
+
+        fieldOffset += field->numBytes * field->numElements;
+    }
+
+    out.replace(QString("$(NUMFIELDS)"), QString::number(info->fields.length()));
+    out.replace(QString("$(ISSINGLEINSTBOOL)"), info->isSingleInst ? "true" : "false");
+    out.replace(QString("$(ISSETTINGSBOOL)"), info->isSettings ? "true" : "false");
+    out.replace(QString("$(FIELDCONSTANTS)"), constants);
+    out.replace(QString("$(DATAFIELDS)"), datafields);
+    out.replace(QString("$(VISITS)"), visits);
+    out.replace(QString("$(OFFSETASSERTS)"), asserts);
+    out.replace(QString("$(FIELDINFO)"), fieldinfo);
+
+    includesCode.append(QString("#include \"%1.h\"\n").arg(info->namelc));
+    dispatchCode.append(QString("    case %1::OBJID:\n        return unpackWith<%1>(data, len, visitor);\n")
+                        .arg(info->name));
+
+    bool res = writeFileIfDiffrent( cppOutputPath.absolutePath() + "/" + info->namelc + ".h", out );
+    if (!res) {
+        cout << "Error: Could not write cpp output files" << endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,48 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectgeneratorcpp.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      produce plain C++ structs for uavobjects
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef UAVOBJECTGENERATORCPP_H
+#define UAVOBJECTGENERATORCPP_H
+
+#include "../generator_common.h"
+
+class UAVObjectGeneratorCPP
+{
+public:
+    bool generate(UAVObjectParser* gen,QString templatepath,QString outputpath);
+
+private:
+    bool process_object(UAVObjectParser* parser, ObjectInfo* info);
+    QString form_enum_name(const QString &fieldName, const QString &option);
+
+    QString cppObjectTemplate;
+    QDir cppOutputPath;
+    QString includesCode;
+    QString dispatchCode;
+    QStringList fieldTypeStr;
+    QStringList fieldTypeEnumStr;
+};
+
+#endif
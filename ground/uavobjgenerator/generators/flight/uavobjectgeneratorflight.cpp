@@ -54,10 +54,16 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
             return false;
         }
 
+    GeneratorManifest manifest(flightOutputPath,
+            QStringList() << flightCodeTemplate << flightIncludeTemplate);
+
     sizeCalc = 0;
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo* info=parser->getObjectByIndex(objidx);
-        process_object(info);
+        QString base = flightOutputPath.absolutePath() + "/" + info->namelc;
+        if (manifest.isCurrent(info, QStringList() << base + ".c" << base + ".h")
+                || process_object(info))
+            manifest.record(info);
         flightObjInit.append("    " + info->name + "Initialize();\r\n");
         objInc.append("#include \"" + info->namelc + ".h\"\r\n");
 	objFileNames.append(" " + info->namelc);
@@ -96,6 +102,8 @@ bool UAVObjectGeneratorFlight::generate(UAVObjectParser* parser,QString template
         return false;
     }
 
+    manifest.save();
+
     return true; // if we come here everything should be fine
 }
 
@@ -153,11 +161,29 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo* info)
     }
     outInclude.replace(QString("$(DATAFIELDS)"), fields);
 
+    // Replace the $(NUMFIELDS) and $(FIELDSIZES) tags
+    QStringList fieldSizes;
+    for (int n = 0; n < info->fields.length(); ++n)
+    {
+        fieldSizes.append(QString::number(info->fields[n]->numBytes * info->fields[n]->numElements));
+    }
+    outInclude.replace(QString("$(NUMFIELDS)"), QString::number(info->fields.length()));
+    outInclude.replace(QString("$(FIELDSIZES)"), fieldSizes.join(", "));
+
     // Replace the $(DATAFIELDINFO) tag
     QString enums;
     for (int n = 0; n < info->fields.length(); ++n)
     {
         enums.append(QString("// Field %1 information\r\n").arg(info->fields[n]->name));
+        // Only the first 32 fields can be left out of partial object frames
+        if (n < 32)
+        {
+            enums.append(QString("/* Bit of field %1 in partial object masks */\r\n").arg(info->fields[n]->name));
+            enums.append( QString("#define %1_%2_FIELDBIT (1u << %3)\r\n")
+                          .arg( info->name.toUpper() )
+                          .arg( info->fields[n]->name.toUpper() )
+                          .arg( n ) );
+        }
         // Only for enum types
         if (info->fields[n]->type == FIELDTYPE_ENUM)
         {
@@ -263,75 +289,47 @@ bool UAVObjectGeneratorFlight::process_object(ObjectInfo* info)
     }
     outInclude.replace(QString("$(DATAFIELDINFO)"), enums);
 
-    // Replace the $(INITFIELDS) tag
+    // Replace the $(INITFIELDS) tag, designated initializers of the
+    // const table the defaults are copied from
     QString initfields;
     for (int n = 0; n < info->fields.length(); ++n)
     {
-        if (!info->fields[n]->defaultValues.isEmpty() )
+        FieldInfo *field = info->fields[n];
+
+        if (field->defaultValues.isEmpty())
+            continue;
+
+        QStringList values;
+        for (int idx = 0; idx < field->numElements; ++idx)
         {
-            // For non-array fields
-            if ( info->fields[n]->numElements == 1)
+            if ( field->type == FIELDTYPE_ENUM )
             {
-                if ( info->fields[n]->type == FIELDTYPE_ENUM )
-                {
-                    int defaultVal;
-                    if (info->fields[n]->parent != NULL)
-                        defaultVal = info->fields[n]->parent->options.indexOf( info->fields[n]->defaultValues[0] );
-                    else
-                        defaultVal = info->fields[n]->options.indexOf( info->fields[n]->defaultValues[0] );
-
-                    initfields.append( QString("\tdata.%1 = %2;\r\n")
-                                .arg( info->fields[n]->name )
-                                .arg( defaultVal ) );
-                }
-                else if ( info->fields[n]->type == FIELDTYPE_FLOAT32 )
-                {
-                    initfields.append( QString("\tdata.%1 = %2;\r\n")
-                                .arg( info->fields[n]->name )
-                                .arg( info->fields[n]->defaultValues[0].toFloat() ) );
-                }
+                int defaultVal;
+                if (field->parent != NULL)
+                    defaultVal = field->parent->options.indexOf( field->defaultValues[idx] );
                 else
-                {
-                    initfields.append( QString("\tdata.%1 = %2;\r\n")
-                                .arg( info->fields[n]->name )
-                                .arg( info->fields[n]->defaultValues[0].toInt() ) );
-                }
+                    defaultVal = field->options.indexOf( field->defaultValues[idx] );
+
+                values.append( QString::number(defaultVal) );
+            }
+            else if ( field->type == FIELDTYPE_FLOAT32 )
+            {
+                values.append( QString("%1").arg( field->defaultValues[idx].toFloat() ) );
             }
             else
             {
-                // Initialize all fields in the array
-                for (int idx = 0; idx < info->fields[n]->numElements; ++idx)
-                {
-                    if ( info->fields[n]->type == FIELDTYPE_ENUM )
-                    {
-                        int defaultVal;
-                        if (info->fields[n]->parent != NULL)
-                            defaultVal = info->fields[n]->parent->options.indexOf( info->fields[n]->defaultValues[idx] );
-                        else
-                            defaultVal = info->fields[n]->options.indexOf( info->fields[n]->defaultValues[idx] );
-                        
-                        initfields.append( QString("\tdata.%1[%2] = %3;\r\n")
-                                    .arg( info->fields[n]->name )
-                                    .arg( idx )
-                                    .arg( defaultVal ) );
-                    }
-                    else if ( info->fields[n]->type == FIELDTYPE_FLOAT32 )
-                    {
-                        initfields.append( QString("\tdata.%1[%2] = %3;\r\n")
-                                    .arg( info->fields[n]->name )
-                                    .arg( idx )
-                                    .arg( info->fields[n]->defaultValues[idx].toFloat() ) );
-                    }
-                    else
-                    {
-                        initfields.append( QString("\tdata.%1[%2] = %3;\r\n")
-                                    .arg( info->fields[n]->name )
-                                    .arg( idx )
-                                    .arg( info->fields[n]->defaultValues[idx].toInt() ) );
-                    }
-                }
+                values.append( QString::number( field->defaultValues[idx].toInt() ) );
             }
         }
+
+        if ( field->numElements == 1)
+            initfields.append( QString("\t.%1 = %2,\r\n")
+                        .arg( field->name )
+                        .arg( values[0] ) );
+        else
+            initfields.append( QString("\t.%1 = { %2 },\r\n")
+                        .arg( field->name )
+                        .arg( values.join(", ") ) );
     }
     outCode.replace(QString("$(INITFIELDS)"), initfields);
 
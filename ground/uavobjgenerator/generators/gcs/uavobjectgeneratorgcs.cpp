@@ -60,11 +60,19 @@ bool UAVObjectGeneratorGCS::generate(UAVObjectParser* parser,QString templatepat
     QString objInc;
     QString gcsObjInit;
 
+    GeneratorManifest manifest(gcsOutputPath,
+            QStringList() << gcsCodeTemplate << gcsIncludeTemplate);
+
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo* info=parser->getObjectByIndex(objidx);
-        process_object(info);
-
-        gcsObjInit.append("    objMngr->registerObject( new " + info->name + "() );\n");
+        QString base = gcsOutputPath.absolutePath() + "/" + info->namelc;
+        if (manifest.isCurrent(info, QStringList() << base + ".cpp" << base + ".h")
+                || process_object(info))
+            manifest.record(info);
+
+        // Objects are only created once something uses them
+        gcsObjInit.append("    objMngr->registerLazyObject(" + info->name + "::OBJID, \"" + info->name
+                          + "\", &UAVObjectManager::createObject<" + info->name + ">);\n");
         gcsObjInit.append("    qmlRegisterType<" + info->name + ">(\"com.dronin.uavo\", 1, 0, \"" + info->name + "Class\");\n");
         objInc.append("#include \"" + info->namelc + ".h\"\n");
     }
@@ -86,6 +94,8 @@ bool UAVObjectGeneratorGCS::generate(UAVObjectParser* parser,QString templatepat
         return false;
     }
 
+    manifest.save();
+
     return true; // if we come here everything should be fine
 }
 
@@ -342,7 +352,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
 
             const QString defaultValuesInit = "\"" + info->fields[n]->defaultValues.join("\",\"") + "\"";
 
-            finit.append( QString("    fields.append( new UAVObjectField(QString(\"%1\"), QString(\"%2\"), UAVObjectField::ENUM, %3, %4, %5, QString(\"%6\"), FIELD_DESCRIPTIONS[\"%1\"], QList<QVariant>({%7})));\n")
+            finit.append( QString("    infos.append( new UAVObjectField::Info(QString(\"%1\"), QString(\"%2\"), UAVObjectField::ENUM, %3, %4, %5, QString(\"%6\"), FIELD_DESCRIPTIONS[\"%1\"], QList<QVariant>({%7})));\n")
                           .arg(info->fields[n]->name)
                           .arg(info->fields[n]->units)
                           .arg(varElemName)
@@ -355,7 +365,7 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
         else {
             const QString defaultValuesInit = info->fields[n]->defaultValues.join(',');
 
-            finit.append( QString("    fields.append( new UAVObjectField(QString(\"%1\"), QString(\"%2\"), UAVObjectField::%3, %4, QStringList(), QList<int>(), QString(\"%5\"), FIELD_DESCRIPTIONS[\"%1\"], QList<QVariant>({%7}), UAVObjectField::%8));\n")
+            finit.append( QString("    infos.append( new UAVObjectField::Info(QString(\"%1\"), QString(\"%2\"), UAVObjectField::%3, %4, QStringList(), QList<int>(), QString(\"%5\"), FIELD_DESCRIPTIONS[\"%1\"], QList<QVariant>({%7}), UAVObjectField::%8));\n")
                           .arg(info->fields[n]->name)
                           .arg(info->fields[n]->units)
                           .arg(fieldTypeStrCPPClass[info->fields[n]->type])
@@ -373,12 +383,19 @@ bool UAVObjectGeneratorGCS::process_object(ObjectInfo* info)
     QString enums;
     // To be populated with the Q_ENUMS macro
     QString q_enums;
+    // Byte offset of each field within DataFields, fields are laid out in order
+    int fieldOffset = 0;
     for (int n = 0; n < info->fields.length(); ++n)
     {
         if(!info->fields[n]->name.isEmpty())
         {
             enums.append(QString("    // Field %1 information\n").arg(info->fields[n]->name));
         }
+        // Offset of the field in the object data, for direct access
+        enums.append( QString("    static const quint32 %1_OFFSET = %2;\n")
+                      .arg( info->fields[n]->name.toUpper() )
+                      .arg( fieldOffset ) );
+        fieldOffset += info->fields[n]->numBytes * info->fields[n]->numElements;
         // Only for enum types
         if (info->fields[n]->type == FIELDTYPE_ENUM)
         {
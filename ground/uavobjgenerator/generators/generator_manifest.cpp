@@ -0,0 +1,127 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_manifest.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      remembers what the outputs of each object were generated from
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "generator_manifest.h"
+#include "generator_io.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFile>
+#include <algorithm>
+
+bool GeneratorManifest::forced = false;
+
+GeneratorManifest::GeneratorManifest(const QDir &outputPath, const QStringList &templates)
+    : fileName(outputPath.absoluteFilePath(".uavobjgenerator-manifest"))
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    // A rebuilt generator may generate differently
+    QFile generator(QCoreApplication::applicationFilePath());
+    if (generator.open(QIODevice::ReadOnly))
+        hash.addData(&generator);
+
+    foreach (const QString &tmpl, templates)
+        hash.addData(tmpl.toUtf8());
+
+    generatorHash = hash.result();
+
+    if (forced)
+        return;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    while (!file.atEnd()) {
+        QList<QByteArray> entry = file.readLine().trimmed().split(' ');
+        if (entry.length() == 2)
+            previous.insert(QString::fromUtf8(entry[0]), QByteArray::fromHex(entry[1]));
+    }
+}
+
+QByteArray GeneratorManifest::objectHash(ObjectInfo *info) const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(generatorHash);
+    hash.addData(info->definitionHash);
+    hash.addData(QByteArray::number(info->id));
+
+    // Enum options come from the parents and their parents
+    QSet<ObjectInfo *> ancestors;
+    QList<ObjectInfo *> pending = info->parents.toList();
+    while (!pending.isEmpty()) {
+        ObjectInfo *parent = pending.takeFirst();
+        if (parent == info || ancestors.contains(parent))
+            continue;
+        ancestors.insert(parent);
+        pending.append(parent->parents.toList());
+    }
+
+    QList<ObjectInfo *> parents = ancestors.toList();
+    std::sort(parents.begin(), parents.end(), [](ObjectInfo *o1, ObjectInfo *o2) {
+            return o1->name < o2->name;
+            });
+    foreach (ObjectInfo *parent, parents)
+        hash.addData(parent->definitionHash);
+
+    return hash.result();
+}
+
+bool GeneratorManifest::isCurrent(ObjectInfo *info, const QStringList &outputs) const
+{
+    if (previous.value(info->name) != objectHash(info))
+        return false;
+
+    foreach (const QString &output, outputs) {
+        if (!QFile::exists(output))
+            return false;
+    }
+
+    return true;
+}
+
+void GeneratorManifest::record(ObjectInfo *info)
+{
+    current.insert(info->name, objectHash(info));
+}
+
+bool GeneratorManifest::save()
+{
+    QStringList names = current.keys();
+    names.sort();
+
+    QString out;
+    foreach (const QString &name, names)
+        out.append(name + " " + QString::fromLatin1(current.value(name).toHex()) + "\n");
+
+    return writeFileIfDiffrent(fileName, out);
+}
+
+void GeneratorManifest::setForced(bool forced)
+{
+    GeneratorManifest::forced = forced;
+}
@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ *
+ * @file       generator_manifest.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      remembers what the outputs of each object were generated from
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef GENERATORMANIFEST_H
+#define GENERATORMANIFEST_H
+
+#include "../uavobjectparser.h"
+#include <QDir>
+#include <QHash>
+#include <QStringList>
+
+/**
+ * A backend keeps one of these in its output directory. It holds a hash per
+ * object of everything the object's files were generated from: the XML of
+ * the object and of its parents, the templates and the generator itself.
+ * Objects whose hash didn't change, and whose files are all there, needn't
+ * be generated again.
+ */
+class GeneratorManifest
+{
+public:
+    /**
+     * @param outputPath the backend's output directory
+     * @param templates the templates the backend generates from
+     */
+    GeneratorManifest(const QDir &outputPath, const QStringList &templates);
+
+    /**
+     * @brief Check if the files of an object are up to date
+     * @param info the object
+     * @param outputs the files generated for the object
+     */
+    bool isCurrent(ObjectInfo *info, const QStringList &outputs) const;
+
+    /**
+     * @brief Note that the files of an object were generated
+     */
+    void record(ObjectInfo *info);
+
+    bool save();
+
+    /**
+     * @brief Generate everything regardless of the manifests
+     */
+    static void setForced(bool forced);
+
+private:
+    QByteArray objectHash(ObjectInfo *info) const;
+
+    static bool forced;
+
+    QString fileName;
+    QByteArray generatorHash;
+    QHash<QString, QByteArray> previous;
+    QHash<QString, QByteArray> current;
+};
+
+#endif
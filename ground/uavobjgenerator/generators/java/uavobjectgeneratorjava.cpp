@@ -49,9 +49,13 @@ bool UAVObjectGeneratorJava::generate(UAVObjectParser* parser,QString templatepa
     QString objInc;
     QString javaObjInit;
 
+    GeneratorManifest manifest(javaOutputPath, QStringList() << javaCodeTemplate);
+
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
         ObjectInfo* info=parser->getObjectByIndex(objidx);
-        process_object(info);
+        QString file = javaOutputPath.absolutePath() + "/" + info->name + ".java";
+        if (manifest.isCurrent(info, QStringList() << file) || process_object(info))
+            manifest.record(info);
 
         javaObjInit.append("\t\t\tobjMngr.registerObject( new " + info->name + "() );\n");
         objInc.append("#include \"" + info->namelc + ".h\"\n");
@@ -66,6 +70,8 @@ bool UAVObjectGeneratorJava::generate(UAVObjectParser* parser,QString templatepa
         return false;
     }
 
+    manifest.save();
+
     return true; // if we come here everything should be fine
 }
 
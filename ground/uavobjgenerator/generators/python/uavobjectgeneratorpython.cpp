@@ -0,0 +1,79 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectgeneratorpython.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      produce the object table of the native python log decoder
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "uavobjectgeneratorpython.h"
+
+using namespace std;
+
+bool UAVObjectGeneratorPython::generate(UAVObjectParser* parser,QString templatepath,QString outputpath) {
+    QDir pythonTemplatePath = QDir( templatepath + QString("python/uavodecode"));
+    QDir pythonOutputPath = QDir( outputpath + QString("python") );
+    pythonOutputPath.mkpath(pythonOutputPath.absolutePath());
+
+    QString objectsTemplate = readFile( pythonTemplatePath.absoluteFilePath("uavodecodeobjects.h.template") );
+
+    if (objectsTemplate.isEmpty()) {
+        cerr << "Problem reading python templates" << endl;
+        return false;
+    }
+
+    for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
+        process_object(parser->getObjectByIndex(objidx));
+    }
+
+    replaceCommonTags(objectsTemplate);
+    objectsTemplate.replace( QString("$(FIELDSIZES)"), fieldSizesCode);
+    objectsTemplate.replace( QString("$(OBJECTTABLE)"), objectTableCode);
+
+    bool res = writeFileIfDiffrent( pythonOutputPath.absolutePath() + "/uavodecodeobjects.h",
+                                    objectsTemplate );
+    if (!res) {
+        cout << "Error: Could not write python output files" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Add an object to the table; the fields are in the order they are packed
+ */
+void UAVObjectGeneratorPython::process_object(ObjectInfo* info)
+{
+    if (info == NULL)
+        return;
+
+    QStringList sizes;
+    for (int n = 0; n < info->fields.length(); ++n)
+        sizes << QString::number(info->fields[n]->numBytes * info->fields[n]->numElements);
+
+    fieldSizesCode.append(QString("static const uint16_t %1_field_sizes[] = { %2 };\n")
+            .arg(info->namelc).arg(sizes.join(", ")));
+
+    objectTableCode.append(QString("    { 0x%1, \"%2\", %3, %4, %5, %6_field_sizes },\n")
+            .arg(info->id, 8, 16, QChar('0')).arg(info->name)
+            .arg(info->numBytes).arg(info->isSingleInst ? "true" : "false")
+            .arg(info->fields.length()).arg(info->namelc));
+}
@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectgeneratorshm.cpp
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      produce the layout of the GCS telemetry tap's shared memory
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "uavobjectgeneratorshm.h"
+
+using namespace std;
+
+static quint32 align8(quint32 size)
+{
+    return (size + 7) & ~7u;
+}
+
+bool UAVObjectGeneratorShm::generate(UAVObjectParser* parser,QString templatepath,QString outputpath) {
+    QDir shmTemplatePath = QDir( templatepath + QString("ground/gcs/src/plugins/telemetrytap"));
+    QDir shmOutputPath = QDir( outputpath + QString("shm") );
+    shmOutputPath.mkpath(shmOutputPath.absolutePath());
+
+    QString layoutTemplate = readFile( shmTemplatePath.absoluteFilePath("uavoshm.h.template") );
+
+    if (layoutTemplate.isEmpty()) {
+        cerr << "Problem reading shm templates" << endl;
+        return false;
+    }
+
+    // The latest values follow the object table, in the order of the table
+    dataOffset = align8(HEADER_SIZE + parser->getNumObjects() * TABLE_ENTRY_SIZE);
+    maxObjectSize = 0;
+
+    for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
+        process_object(parser->getObjectByIndex(objidx));
+    }
+
+    replaceCommonTags(layoutTemplate);
+    layoutTemplate.replace( QString("$(UAVOHASH)"),
+            QString("%1").arg(parser->getUavoHash(), 16, 16, QChar('0')));
+    layoutTemplate.replace( QString("$(NUMOBJECTS)"), QString::number(parser->getNumObjects()));
+    layoutTemplate.replace( QString("$(MAXOBJECTSIZE)"), QString::number(maxObjectSize));
+    layoutTemplate.replace( QString("$(RINGOFFSET)"), QString::number(align8(dataOffset)));
+    layoutTemplate.replace( QString("$(RINGSLOTSIZE)"),
+            QString::number(RECORD_HEADER_SIZE + align8(maxObjectSize)));
+    layoutTemplate.replace( QString("$(DATAOFFSETS)"), offsetsCode);
+    layoutTemplate.replace( QString("$(OBJECTTABLE)"), objectTableCode);
+
+    bool res = writeFileIfDiffrent( shmOutputPath.absolutePath() + "/uavoshm.h",
+                                    layoutTemplate );
+    if (!res) {
+        cout << "Error: Could not write shm output files" << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Add an object to the table, and make room for its latest values
+ */
+void UAVObjectGeneratorShm::process_object(ObjectInfo* info)
+{
+    if (info == NULL)
+        return;
+
+    int maxInstances = info->isSingleInst ? 1 : MAX_INSTANCES;
+    quint32 stride = VALUE_HEADER_SIZE + align8(info->numBytes);
+
+    offsetsCode.append(QString("#define UAVOSHM_%1_OFFSET 0x%2\n")
+            .arg(info->name.toUpper()).arg(dataOffset, 0, 16));
+
+    objectTableCode.append(QString("    { 0x%1, %2, %3, 0x%4, %5, \"%6\" },\n")
+            .arg(info->id, 8, 16, QChar('0')).arg(info->numBytes).arg(maxInstances)
+            .arg(dataOffset, 0, 16).arg(stride).arg(info->name));
+
+    dataOffset += maxInstances * stride;
+    maxObjectSize = qMax(maxObjectSize, info->numBytes);
+}
@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectgeneratorshm.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      produce the layout of the GCS telemetry tap's shared memory
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef UAVOBJECTGENERATORSHM_H
+#define UAVOBJECTGENERATORSHM_H
+
+#include "../generator_common.h"
+
+class UAVObjectGeneratorShm
+{
+public:
+    bool generate(UAVObjectParser* gen,QString templatepath,QString outputpath);
+
+private:
+    // Must match uavoshm.h.template
+    static const int HEADER_SIZE = 64;
+    static const int TABLE_ENTRY_SIZE = 16;
+    static const int VALUE_HEADER_SIZE = 8;
+    static const int RECORD_HEADER_SIZE = 24;
+    static const int MAX_INSTANCES = 16;
+
+    void process_object(ObjectInfo* info);
+    quint32 dataOffset;
+    int maxObjectSize;
+    QString offsetsCode;
+    QString objectTableCode;
+};
+
+#endif
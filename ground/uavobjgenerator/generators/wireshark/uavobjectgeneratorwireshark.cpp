@@ -84,9 +84,12 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser* parser,QString templ
 
     /* Generate the per-object files from the templates, and keep track of the list of generated filenames */
     QString objFileNames;
+    GeneratorManifest manifest(uavobjectsOutputPath, QStringList() << wiresharkCodeTemplate);
     for (int objidx = 0; objidx < parser->getNumObjects(); ++objidx) {
       ObjectInfo* info = parser->getObjectByIndex(objidx);
-      process_object(info, uavobjectsOutputPath);
+      QString file = uavobjectsOutputPath.absoluteFilePath("packet-op-uavobjects-" + info->namelc + ".c");
+      if (manifest.isCurrent(info, QStringList() << file) || process_object(info, uavobjectsOutputPath))
+        manifest.record(info);
       objFileNames.append(" packet-op-uavobjects-" + info->namelc + ".c");
     }
 
@@ -99,6 +102,8 @@ bool UAVObjectGeneratorWireshark::generate(UAVObjectParser* parser,QString templ
       return false;
     }
 
+    manifest.save();
+
     return true;
 }
 
@@ -181,6 +186,10 @@ bool UAVObjectGeneratorWireshark::process_object(ObjectInfo* info, QDir outputpa
     // Replace the $(POPULATETREE) tag
     QString treefields;
     for (int n = 0; n < info->fields.length(); ++n) {
+      /* Partial objects only carry the fields in their mask */
+      if (n < 32) {
+	treefields.append( QString("    if (!field_mask || (*field_mask & (1u << %1)))\r\n").arg(n) );
+      }
       if ( info->fields[n]->numElements == 1 ) {
 	treefields.append( QString("    ptvcursor_add(cursor, hf_op_uavobjects_%1_%2, sizeof(%3), ENC_LITTLE_ENDIAN);\r\n")
 			   .arg(info->namelc)
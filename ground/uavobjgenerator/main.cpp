@@ -27,6 +27,7 @@
 #include <QFile>
 #include <QString>
 #include <QStringList>
+#include <QtConcurrent/QtConcurrentRun>
 #include <iostream>
 
 #include "generators/java/uavobjectgeneratorjava.h"
@@ -34,6 +35,9 @@
 #include "generators/gcs/uavobjectgeneratorgcs.h"
 #include "generators/matlab/uavobjectgeneratormatlab.h"
 #include "generators/wireshark/uavobjectgeneratorwireshark.h"
+#include "generators/python/uavobjectgeneratorpython.h"
+#include "generators/cpp/uavobjectgeneratorcpp.h"
+#include "generators/shm/uavobjectgeneratorshm.h"
 
 #define RETURN_ERR_USAGE 1
 #define RETURN_ERR_XML 2
@@ -45,17 +49,31 @@ using namespace std;
 /**
  * print usage info
  */
+template <typename Generator>
+static QFuture<bool> startGenerator(UAVObjectParser *parser, const QString &templatepath,
+        const QString &outputpath)
+{
+    return QtConcurrent::run([parser, templatepath, outputpath]() {
+        Generator gen;
+        return gen.generate(parser, templatepath, outputpath);
+    });
+}
+
 void usage() {
-    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-matlab] [-wireshark] [-none] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
+    cout << "Usage: uavobjectgenerator [-gcs] [-flight] [-java] [-matlab] [-wireshark] [-python] [-cpp] [-shm] [-none] [-force] [-v] xml_path template_base [UAVObj1] ... [UAVObjN]" << endl;
     cout << "Languages: "<< endl;
     cout << "\t-gcs           build groundstation code" << endl;
     cout << "\t-flight        build flight code" << endl;
     cout << "\t-java          build java code" << endl;
     cout << "\t-matlab        build matlab code" << endl;
     cout << "\t-wireshark     build wireshark plugin" << endl;
+    cout << "\t-python        build object table of the python log decoder" << endl;
+    cout << "\t-cpp           build plain C++ structs" << endl;
+    cout << "\t-shm           build shared memory layout of the GCS telemetry tap" << endl;
     cout << "\tIf no language is specified ( and not -none ) -> all are built." << endl;
     cout << "Misc: "<< endl;
     cout << "\t-none          build no language - just parse xml's" << endl;
+    cout << "\t-force         regenerate objects that didn't change since the last run" << endl;
     cout << "\t-h             this help" << endl;
     cout << "\t-v             verbose" << endl;
     cout << "\tinput_path     path to UAVObject definition (.xml) files." << endl;
@@ -103,9 +121,13 @@ int main(int argc, char *argv[])
     bool do_java=(arguments_stringlist.removeAll("-java")>0);
     bool do_matlab=(arguments_stringlist.removeAll("-matlab")>0);
     bool do_wireshark=(arguments_stringlist.removeAll("-wireshark")>0);
+    bool do_python=(arguments_stringlist.removeAll("-python")>0);
+    bool do_cpp=(arguments_stringlist.removeAll("-cpp")>0);
+    bool do_shm=(arguments_stringlist.removeAll("-shm")>0);
     bool do_none=(arguments_stringlist.removeAll("-none")>0); //
+    bool do_force=(arguments_stringlist.removeAll("-force")>0);
 
-    bool do_all=((do_gcs||do_flight||do_java||do_matlab)==false);
+    bool do_all=((do_gcs||do_flight||do_java||do_matlab||do_python||do_cpp||do_shm)==false);
     bool do_allObjects=true;
 
     if (arguments_stringlist.length() >= 2) {
@@ -223,41 +245,55 @@ int main(int argc, char *argv[])
     if (do_none)
       return RETURN_OK;     
 
-    // generate flight code if wanted
+    GeneratorManifest::setForced(do_force);
+    QDir().mkpath(outputpath);
+
+    // The backends only read the parsed objects, so they run side by side
+    QList<QFuture<bool> > backends;
+
     if (do_flight|do_all) {
         cout << "generating flight code" << endl ;
-        UAVObjectGeneratorFlight flightgen;
-        flightgen.generate(parser,templatepath,outputpath);
+        backends << startGenerator<UAVObjectGeneratorFlight>(parser,templatepath,outputpath);
     }
 
-    // generate gcs code if wanted
     if (do_gcs|do_all) {
         cout << "generating gcs code" << endl ;
-        UAVObjectGeneratorGCS gcsgen;
-        gcsgen.generate(parser,templatepath,outputpath);
+        backends << startGenerator<UAVObjectGeneratorGCS>(parser,templatepath,outputpath);
     }
 
-    // generate java code if wanted
     if (do_java|do_all) {
         cout << "generating java code" << endl ;
-        UAVObjectGeneratorJava javagen;
-        javagen.generate(parser,templatepath,outputpath);
+        backends << startGenerator<UAVObjectGeneratorJava>(parser,templatepath,outputpath);
     }
 
-    // generate matlab code if wanted
     if (do_matlab|do_all) {
         cout << "generating matlab code" << endl ;
-        UAVObjectGeneratorMatlab matlabgen;
-        matlabgen.generate(parser,templatepath,outputpath);
+        backends << startGenerator<UAVObjectGeneratorMatlab>(parser,templatepath,outputpath);
     }
 
-    // generate wireshark plugin if wanted
     if (do_wireshark|do_all) {
         cout << "generating wireshark code" << endl ;
-        UAVObjectGeneratorWireshark wiresharkgen;
-        wiresharkgen.generate(parser,templatepath,outputpath);
+        backends << startGenerator<UAVObjectGeneratorWireshark>(parser,templatepath,outputpath);
+    }
+
+    if (do_python|do_all) {
+        cout << "generating python code" << endl ;
+        backends << startGenerator<UAVObjectGeneratorPython>(parser,templatepath,outputpath);
+    }
+
+    if (do_cpp|do_all) {
+        cout << "generating cpp code" << endl ;
+        backends << startGenerator<UAVObjectGeneratorCPP>(parser,templatepath,outputpath);
     }
 
+    if (do_shm|do_all) {
+        cout << "generating shm layout" << endl ;
+        backends << startGenerator<UAVObjectGeneratorShm>(parser,templatepath,outputpath);
+    }
+
+    foreach (QFuture<bool> backend, backends)
+        backend.waitForFinished();
+
     bool changed = false;
 
     /* Symlink each of these to the current dir */
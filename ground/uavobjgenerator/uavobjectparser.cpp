@@ -28,6 +28,7 @@
 
 #include <QtDebug>
 #include <QTextStream>
+#include <QCryptographicHash>
 #include "uavobjectparser.h"
 
 /**
@@ -334,6 +335,9 @@ QString UAVObjectParser::parseXML(QString& xml, QString& filename)
         return genErrorMsg(filename, errorMsg, errorLine, errorCol);
     }
 
+    // Lets the generators tell which objects changed since their last run
+    QByteArray xmlHash = QCryptographicHash::hash(xml.toUtf8(), QCryptographicHash::Sha1);
+
     // Read all objects contained in the XML file, creating an new ObjectInfo for each
     QDomElement docElement = doc.documentElement();
     QDomNode node = docElement.firstChild();
@@ -341,6 +345,7 @@ QString UAVObjectParser::parseXML(QString& xml, QString& filename)
         // Create new object entry
         ObjectInfo* info = new ObjectInfo();
         info->filename=filename;
+        info->definitionHash = xmlHash;
         // Process object attributes
         QString status = processObjectAttributes(node, info);
         if (!status.isNull())
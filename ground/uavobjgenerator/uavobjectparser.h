@@ -125,6 +125,7 @@ struct ObjectInfo_s {
     QString category; /** Description used for Doxygen **/
     int numBytes;
     QSet<ObjectInfo*> parents;
+    QByteArray definitionHash; /** SHA1 of the XML file the object is defined in **/
 };
 
 class UAVObjectParser
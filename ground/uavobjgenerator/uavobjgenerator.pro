@@ -1,6 +1,6 @@
 include(../tools.pri)
 
-QT += xml
+QT += xml concurrent
 QT -= gui
 
 macx {
@@ -24,16 +24,24 @@ TEMPLATE = app
 SOURCES += main.cpp \
     uavobjectparser.cpp \
     generators/generator_io.cpp \
+    generators/generator_manifest.cpp \
     generators/java/uavobjectgeneratorjava.cpp \
     generators/flight/uavobjectgeneratorflight.cpp \
     generators/gcs/uavobjectgeneratorgcs.cpp \
     generators/matlab/uavobjectgeneratormatlab.cpp \
     generators/wireshark/uavobjectgeneratorwireshark.cpp \
+    generators/python/uavobjectgeneratorpython.cpp \
+    generators/cpp/uavobjectgeneratorcpp.cpp \
+    generators/shm/uavobjectgeneratorshm.cpp \
     generators/generator_common.cpp
 HEADERS += uavobjectparser.h \
     generators/generator_io.h \
+    generators/generator_manifest.h \
     generators/java/uavobjectgeneratorjava.h \
     generators/gcs/uavobjectgeneratorgcs.h \
     generators/matlab/uavobjectgeneratormatlab.h \
     generators/wireshark/uavobjectgeneratorwireshark.h \
+    generators/python/uavobjectgeneratorpython.h \
+    generators/cpp/uavobjectgeneratorcpp.h \
+    generators/shm/uavobjectgeneratorshm.h \
     generators/generator_common.h
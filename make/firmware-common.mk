@@ -29,7 +29,7 @@ all: gccversion build
 build: elf
 
 ifneq ($(BUILD_FWFILES), NO)
-build: hex bin lss sym
+build: hex bin lss sym uavos
 endif
 
 # Archive: Create library file from object files
@@ -76,6 +76,9 @@ tlfw: $(OUTDIR)/$(TARGET).tlfw
 # Display sizes of sections.
 $(eval $(call SIZE_TEMPLATE, $(OUTDIR)/$(TARGET).elf))
 
+# List the UAVObjects the modules and drivers pulled in.
+$(eval $(call UAVO_REPORT_TEMPLATE, $(OUTDIR)/$(TARGET).elf, $(OUTDIR)/$(TARGET).uavos))
+
 # Create output files directory
 $(shell mkdir -p $(OUTDIR) 2>/dev/null)
 
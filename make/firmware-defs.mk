@@ -92,6 +92,7 @@ MSG_ASSEMBLING       = ${quote} AS        $(MSG_EXTRA) ${quote}
 MSG_CLEANING         = ${quote} CLEAN     $(MSG_EXTRA) ${quote}
 MSG_TLFIRMWARE       = ${quote} TLFW      $(MSG_EXTRA) ${quote}
 MSG_FWINFO           = ${quote} FWINFO    $(MSG_EXTRA) ${quote}
+MSG_UAVO_REPORT      = ${quote} UAVOS     $(MSG_EXTRA) ${quote}
 MSG_JTAG_PROGRAM     = ${quote} JTAG-PGM  $(MSG_EXTRA) ${quote}
 MSG_JTAG_WIPE        = ${quote} JTAG-WIPE $(MSG_EXTRA) ${quote}
 MSG_JTAG_DEBUG       = ${quote} JTAG-DBG  $(MSG_EXTRA) ${quote}
@@ -148,6 +149,19 @@ $(1)_size: $(1)
 	$(V1) $(SIZE) -A $$<
 endef
 
+# UAVObjects linked into a firmware image
+#  $(1) = path to elf file, linked with a map file next to it
+#  $(2) = path to the report
+define UAVO_REPORT_TEMPLATE
+.PHONY: uavos
+uavos: $(2)
+
+$(2): $(1) $(ROOT_DIR)/make/scripts/uavo-report.py
+	@echo $(MSG_UAVO_REPORT) $$(call toprel, $$@)
+	$(V1) $(PYTHON) $(ROOT_DIR)/make/scripts/uavo-report.py \
+		$$(basename $$<).map $(ROOT_DIR)/shared/uavobjectdefinition > $$@
+endef
+
 # OpenPilot firmware image template
 #  $(1) = path to bin file
 #  $(2) = boardtype in hex
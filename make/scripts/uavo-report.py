@@ -0,0 +1,94 @@
+#!/usr/bin/env python
+#
+# Lists the UAVObjects linked into a firmware image.
+#
+# Objects are only registered by the modules and drivers that use them, and
+# the generated object code is linked from an archive, so a target only
+# carries the objects it references.  This reads which archive members the
+# linker pulled in from the map file and reports them, with the RAM their
+# first instance takes, so what a module costs a board can be followed.
+#
+# (c) 2017, dRonin
+#
+# See also: The GNU Public License (GPL) Version 3
+#
+
+from __future__ import print_function
+
+import argparse
+import glob
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+TYPE_SIZES = {
+    'int8': 1, 'int16': 2, 'int32': 4,
+    'uint8': 1, 'uint16': 2, 'uint32': 4,
+    'float': 4, 'enum': 1,
+}
+
+def num_elements(field):
+    """Number of elements of a field, given as a count or by name"""
+    names = field.get('elementnames')
+    if names:
+        return len([n for n in names.split(',') if n.strip()])
+
+    names = field.find('elementnames')
+    if names is not None:
+        return len(names.findall('elementname'))
+
+    return int(field.get('elements', '1'))
+
+def read_definitions(path):
+    """Map the lower case name of each object to (name, bytes, settings)"""
+    objects = {}
+
+    for filename in glob.glob(os.path.join(path, '*.xml')):
+        for obj in ET.parse(filename).getroot().findall('object'):
+            sizes = {}
+            for field in obj.findall('field'):
+                clone = field.get('cloneof')
+                if clone:
+                    sizes[field.get('name')] = sizes[clone]
+                else:
+                    sizes[field.get('name')] = \
+                        TYPE_SIZES[field.get('type')] * num_elements(field)
+
+            name = obj.get('name')
+            objects[name.lower()] = (name, sum(sizes.values()),
+                                     obj.get('settings') == 'true')
+
+    return objects
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='List the UAVObjects linked into a firmware image.')
+    parser.add_argument('map', help='linker map file of the image')
+    parser.add_argument('definitions', help='UAVObject definition directory')
+    args = parser.parse_args()
+
+    objects = read_definitions(args.definitions)
+
+    # Archive members are listed with what pulled them in
+    member = re.compile(r'^\S*libuavobject\.a\((\w+)\.o\)')
+    linked = set()
+    with open(args.map) as f:
+        for line in f:
+            m = member.match(line)
+            if m and m.group(1) in objects:
+                linked.add(m.group(1))
+
+    total = 0
+    for namelc in sorted(linked):
+        name, size, settings = objects[namelc]
+        total += size
+        print('%-40s %5d%s' % (name, size, ' settings' if settings else ''))
+
+    print('%d of %d objects linked, %d bytes of instance data' %
+          (len(linked), len(objects), total))
+
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
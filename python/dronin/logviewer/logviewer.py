@@ -126,31 +126,35 @@ def get_series(name):
 
     return series[name]
 
-def scan_for_events(uv):
+def scan_for_events():
     flight_mode = -1
     armed = -1
 
     events = []
 
-    for u in uv:
-        if u._name == 'UAVO_FlightStatus':
-            ev = []
-            # u.Armed DISARMED/ARMING/ARMED
-            # u.FlightMode
+    typ = t.uavo_defs.find_by_name('FlightStatus')
+    status = get_series('FlightStatus')
 
-            if u.Armed != armed:
-                armed = u.Armed
+    if len(status) == 0:
+        return events
 
-                ev.append(u.ENUMR_Armed[armed])
+    for tm, u_armed, u_mode in zip(status['time'], status['Armed'], status['FlightMode']):
+        ev = []
+        # Armed DISARMED/ARMING/ARMED
 
-            if u.FlightMode != flight_mode:
-                flight_mode = u.FlightMode
+        if u_armed != armed:
+            armed = u_armed
 
-                ev.append('MODE:' + u.ENUMR_FlightMode[flight_mode])
+            ev.append(typ.ENUMR_Armed[armed])
 
-            if len(ev):
-                tup = (u.time, '/'.join(ev))
-                events.append(tup)
+        if u_mode != flight_mode:
+            flight_mode = u_mode
+
+            ev.append('MODE:' + typ.ENUMR_FlightMode[flight_mode])
+
+        if len(ev):
+            tup = (tm, '/'.join(ev))
+            events.append(tup)
 
     return events
 
@@ -190,7 +194,8 @@ def handle_open(ignored=False, fname=None):
             dlg.setLabelText("%d objects read..." % n_objs)
 
         t = telemetry.FileTelemetry(f, parse_header=True, service_in_iter=True,
-                    gcs_timestamps=None, name=fname, progress_callback=cb)
+                    gcs_timestamps=None, name=fname, progress_callback=cb,
+                    columnar=True, processes=0)
 
         global series, objtyps
         series = {}
@@ -200,7 +205,7 @@ def handle_open(ignored=False, fname=None):
             short_name = typ._name[5:]
             objtyps[short_name] = typ
 
-        event_series = scan_for_events(t)
+        event_series = scan_for_events()
 
         global last_plot
         last_plot = None
@@ -219,7 +224,7 @@ def handle_open(ignored=False, fname=None):
         plot_vs_time('Gyros', ['x', 'y', 'z'])
         plot_vs_time('ActuatorCommand', ['Channel:0', 'Channel:1', 'Channel:2', 'Channel:3'])
 
-        objtyps = { k:v for k,v in objtyps.items() if v in t.last_values }
+        objtyps = { k:v for k,v in objtyps.items() if v in t.columns }
 
         #add all non-settings objects, and autotune, to the keys.
         objSel.clear()
@@ -27,7 +27,8 @@ class TelemetryBase(with_metaclass(ABCMeta)):
 
     def __init__(self, githash=None, service_in_iter=True,
             iter_blocks=True, use_walltime=True, do_handshaking=False,
-            gcs_timestamps=False, name=None, progress_callback=None):
+            gcs_timestamps=False, name=None, progress_callback=None,
+            columnar=False):
 
         """Instantiates a telemetry instance.  Called only by derived classes.
          - githash: revision control id of the UAVO's used to communicate.
@@ -47,8 +48,14 @@ class TelemetryBase(with_metaclass(ABCMeta)):
          - name: a filename to store into .filename for legacy purposes
          - progress_callback: a function to call periodically with progress
              information
+         - columnar: if true, keep the samples received in .columns, a
+             UAVOColumns, instead of as objects.  Far smaller for analysis
+             of long logs, but iterating yields no objects then.
         """
 
+        if columnar and do_handshaking:
+            raise ValueError("Invalid combination of flags")
+
         uavo_defs = uavo_collection.UAVOCollection()
 
         if githash:
@@ -59,15 +66,25 @@ class TelemetryBase(with_metaclass(ABCMeta)):
             uavo_defs.from_uavo_xml_path(xml_path)
 
         self.githash = githash
+        self.gcs_timestamps = gcs_timestamps
 
         self.uavo_defs = uavo_defs
+
+        if columnar:
+            self.columns = uavo_collection.UAVOColumns()
+            sample_callback = self.columns.append
+        else:
+            self.columns = None
+            sample_callback = None
+
         self.uavtalk_generator = uavtalk.process_stream(uavo_defs,
             use_walltime=use_walltime, gcs_timestamps=gcs_timestamps,
             progress_callback=progress_callback,
             ack_callback=self.gotack_callback,
             nack_callback=self.gotnack_callback,
             reqack_callback=self.reqack_callback,
-            filedata_callback=self.filedata_callback)
+            filedata_callback=self.filedata_callback,
+            sample_callback=sample_callback)
 
         self.uavtalk_generator.send(None)
 
@@ -122,6 +139,13 @@ class TelemetryBase(with_metaclass(ABCMeta)):
 
         import numpy as np
 
+        if self.columns is not None:
+            if filter_cond is not None:
+                raise ValueError("filter_cond needs objects, columnar telemetry has none")
+
+            with self.cond:
+                return self.columns.as_numpy_array(match_class)
+
         # Find the subset of this list that is of the requested class
         filtered_list = [x for x in self if isinstance(x, match_class)]
 
@@ -295,6 +319,15 @@ class TelemetryBase(with_metaclass(ABCMeta)):
             self.eof = True
             self._close()
         else:
+            if self.columns is not None:
+                # Samples go straight to the columns, nothing is yielded
+                with self.cond:
+                    self.uavtalk_generator.send(frames)
+
+                    self.cond.notifyAll()
+
+                return
+
             obj = self.uavtalk_generator.send(frames)
 
             while obj:
@@ -320,6 +353,9 @@ class TelemetryBase(with_metaclass(ABCMeta)):
     def get_last_values(self):
         """ Returns the last instance of each kind of object received. """
         with self.cond:
+            if self.columns is not None:
+                return self.columns.last_values()
+
             return self.last_values.copy()
 
     def wait_connection(self):
@@ -752,19 +788,23 @@ class HIDTelemetry(BidirTelemetry):
 class FileTelemetry(TelemetryBase):
     """ Telemetry interface to data in a file """
 
-    def __init__(self, file_obj, parse_header=False,
+    def __init__(self, file_obj, parse_header=False, processes=1,
              *args, **kwargs):
         """ Instantiates a telemetry instance reading from a file.
 
          - file_obj: the file object to read from
          - parse_header: whether to read a header like the GCS writes from the
            file.
+         - processes: how many processes columnar telemetry decodes the file
+           in, 0 for one per core.  Only logs the GCS wrote can be split up.
 
         Meaningful parameters passed up to TelemetryBase include: githash,
-        service_in_iter, iter_blocks, gcs_timestamps
+        service_in_iter, iter_blocks, gcs_timestamps, columnar
         """
 
         self.f = file_obj
+        self.blocks = False
+        self.processes = processes
 
         if parse_header:
             # Check the header signature
@@ -803,6 +843,26 @@ class FileTelemetry(TelemetryBase):
             # miss first objects in telemetry-type streams
             # divider = self.f.readline()
 
+            # So only look for it, and the format tags before it, where we
+            # can go back if it's not there
+            try:
+                start = self.f.tell()
+            except (IOError, AttributeError):
+                start = None
+
+            if start is not None:
+                tags = []
+                for i in range(10):
+                    line = self.f.readline().strip()
+                    if line == b'##':
+                        break
+                    tags.append(line)
+                else:
+                    tags = []
+                    self.f.seek(start)
+
+                self.blocks = uavtalk.LOG_BLOCK_TAG in tags
+
             TelemetryBase.__init__(self, iter_blocks=True,
                 do_handshaking=False, githash=githash, use_walltime=False,
                 *args, **kwargs)
@@ -811,10 +871,146 @@ class FileTelemetry(TelemetryBase):
                 do_handshaking=False, use_walltime=False, *args, **kwargs)
 
         self.done=False
+        self.native_columns = None
+
+    def as_numpy_array(self, match_class, filter_cond=None):
+        """ Transforms all instances of a given object in the file to a numpy
+        array.
+
+        When the compiled decoder can be used, the rest of the file is decoded
+        with it on the first call.  Columnar telemetry reads the rest of the
+        file into its columns; otherwise the file is left where it was.
+        """
+
+        if self.columns is not None:
+            self._read_columns()
+        elif filter_cond is None and self.native_columns is None and not self.uavo_list:
+            self.native_columns = self._decode_native()
+
+        if filter_cond is None and self.native_columns is not None:
+            return self.native_columns.as_numpy_array(match_class)
+
+        return TelemetryBase.as_numpy_array(self, match_class, filter_cond)
+
+    def _read_columns(self):
+        """ Reads the rest of the file into the columns """
+
+        with self.cond:
+            # Another thread reads the file
+            if not self.service_in_iter:
+                while not self.eof:
+                    self.cond.wait()
+                return
+
+            if self.eof:
+                return
+
+            # Nothing parsed yet, do it all at once
+            if not self.columns:
+                if self.processes != 1:
+                    decoded = self._decode_parallel(self.columns)
+                else:
+                    decoded = self._decode_native(self.columns)
+
+                if decoded is not None:
+                    self.eof = True
+                    self.cond.notifyAll()
+                    return
+
+        while not self._done():
+            self.service_connection()
+
+    def _read_rest(self):
+        """ Reads what's left of the file, and goes back to where it was.
+        Returns None if the file can't go back. """
+
+        try:
+            start = self.f.tell()
+        except (IOError, AttributeError):
+            return None
+
+        chunks = []
+        while True:
+            buf = self._receive(None)
+            if not buf:
+                break
+            chunks.append(buf)
+
+        self.f.seek(start)
+
+        return b''.join(chunks)
+
+    def _decode_native(self, columns=None):
+        """ Decode what's left of the file at once with the compiled decoder,
+        into columns if given.  Returns None if that's impossible. """
+
+        if not uavtalk.native_decoder_usable(self.uavo_defs):
+            return None
+
+        data = self._read_rest()
+        if data is None:
+            return None
+
+        return uavtalk.decode_log_native(self.uavo_defs, data,
+                self.gcs_timestamps, columns)
+
+    def _decode_parallel(self, columns):
+        """ Decode what's left of the file at once in a pool of processes,
+        into columns.  Returns None if that's impossible. """
+
+        data = self._read_rest()
+        if data is None:
+            return None
+
+        return uavtalk.decode_log_parallel(self.uavo_defs, data,
+                self.gcs_timestamps, self.processes, columns)
+
+    def __iter__(self):
+        """ Iterator service routine.  Columnar telemetry reads the whole file
+        first, then yields its samples in order of time. """
+
+        if self.columns is None:
+            for obj in TelemetryBase.__iter__(self):
+                yield obj
+            return
+
+        self._read_columns()
+
+        for obj in self.columns.iter_objects():
+            yield obj
+
+    def _receive_block(self):
+        """ Decompress the records of the next good block of a compressed
+        log, skipping over corrupt ones """
+        import zlib
+
+        while True:
+            start = self.f.tell()
+            hdr = self.f.read(uavtalk.logblock_fmt.size)
+            if len(hdr) < uavtalk.logblock_fmt.size:
+                return b''
+
+            sync, first, last, size, crc = uavtalk.logblock_fmt.unpack(hdr)
+            if sync == uavtalk.LOG_INDEX_SYNC:
+                return b''
+
+            if sync == uavtalk.LOG_BLOCK_SYNC and size <= uavtalk.LOG_BLOCK_MAX_SIZE:
+                data = self.f.read(size)
+                if (zlib.crc32(data, zlib.crc32(hdr[:16])) & 0xffffffff) == crc:
+                    try:
+                        # qCompress() puts the uncompressed size first
+                        return zlib.decompress(data[4:])
+                    except zlib.error:
+                        continue
+
+            self.f.seek(start + 1)
 
     def _receive(self, finish_time):
         """ Fetch available data from file """
 
+        if self.blocks:
+            return self._receive_block()
+
         buf = self.f.read(524288)   # 512k
 
         return buf
@@ -857,6 +1053,13 @@ def get_telemetry_by_args(desc="Process telemetry", service_in_iter=True,
                         dest    = "hid",
                         help    = "use usb hid to communicate with FC")
 
+    parser.add_argument("-j", "--jobs",
+                        action  = "store",
+                        type    = int,
+                        dest    = "jobs",
+                        default = None,
+                        help    = "decode log files in this many processes, 0 for one per core")
+
     parser.add_argument("source",
             help  = "file, host:port, vid:pid, or serial port")
 
@@ -893,13 +1096,19 @@ def get_telemetry_by_args(desc="Process telemetry", service_in_iter=True,
     if os.path.isfile(args.source):
         file_obj = open(args.source, 'rb')
 
+        # Split-up decoding goes through the columns
+        if args.jobs is not None:
+            extra = { 'columnar' : True, 'processes' : args.jobs }
+        else:
+            extra = {}
+
         if parse_header:
             t = telemetry.FileTelemetry(file_obj, parse_header=True,
-                gcs_timestamps=args.timestamped, name=args.source)
+                gcs_timestamps=args.timestamped, name=args.source, **extra)
         else:
             t = telemetry.FileTelemetry(file_obj, parse_header=False,
                 gcs_timestamps=args.timestamped, name=args.source,
-                githash=githash)
+                githash=githash, **extra)
 
         return t
 
@@ -51,6 +51,29 @@ class UAVTupleClass():
     def get_size_of_data(cls):
         return cls._packstruct.size
 
+    @classmethod
+    def get_packed_dtype(cls):
+        """ The numpy type of the packed data of this object """
+        import numpy as np
+
+        fields = []
+
+        for name, typ in cls._dtype[3 if cls._single else 4:]:
+            shape = None
+            if typ.startswith('('):
+                shape, typ = typ[1:].split(')', 1)
+                shape = (int(shape.rstrip(',')),)
+
+            # Floats are widened in the arrays, but packed as 32 bits
+            if typ == 'float':
+                base = np.dtype('<f4')
+            else:
+                base = np.dtype(typ).newbyteorder('<')
+
+            fields.append((name, base, shape) if shape else (name, base))
+
+        return np.dtype(fields)
+
     @classmethod
     def from_bytes(cls, data, timestamp, instance_id, offset=0):
         """ Deserializes and creates an instance of this object.
@@ -358,6 +381,7 @@ def make_class(collection, xml_file, update_globals=True):
         formats.append('' + f['elements'].__str__() + struct_element_map[f['type']])
 
     fmt = Struct('<' + ''.join(formats))
+    field_sizes = [calcsize('<' + f) for f in formats]
 
     ##### CALCULATE THE NUMPY TYPE ASSOCIATED WITH THIS CLASS #####
     dtype  = [('name', 'S20'), ('time', 'double'), ('uavo_id', 'uint')]
@@ -387,6 +411,7 @@ def make_class(collection, xml_file, update_globals=True):
         _id = uavo_id
         _single = is_single_inst
         _num_subelems = num_subelems
+        _field_sizes = field_sizes
         _dtype = dtype
         _is_settings = is_settings
         _units = {f['name'] : f['units'] for f in fields}
@@ -18,6 +18,9 @@ class UAVOCollection(dict):
     def __init__(self):
         self.clear()
 
+        # The definitions it was made from, e.g. to make it again elsewhere
+        self.xml_contents = []
+
     def find_by_name(self, uavo_name):
         if uavo_name[0:5]!='UAVO_':
             uavo_name = 'UAVO_' + uavo_name
@@ -35,6 +38,8 @@ class UAVOCollection(dict):
         return objs
 
     def from_file_contents(self, content_list):
+        self.xml_contents.extend(content_list)
+
         some_processed = True
 
         # There are dependencies here
@@ -143,3 +148,192 @@ class UAVOCollection(dict):
                 content_list.append(f.read())
 
         self.from_file_contents(content_list)
+
+class UAVOColumns(dict):
+    """ Samples of objects stored by column rather than as one object each.
+
+    Maps each object class to a UAVOColumn of its samples.  Appending to it
+    makes no Python object per sample, so a long log takes about as much
+    memory as its packed data. """
+
+    def __init__(self, chunk_size=4096):
+        self.chunk_size = chunk_size
+
+    def append(self, obj, timestamp, instance_id, data, offset=0):
+        """ Adds a sample of obj, from its packed data at offset in data,
+        e.g. as the sample_callback of uavtalk.process_stream. """
+        column = self.get(obj)
+        if column is None:
+            column = self[obj] = UAVOColumn(obj, self.chunk_size)
+
+        column.append(timestamp, instance_id, data, offset)
+
+    def extend(self, obj, times, instances, data):
+        """ Adds many samples of obj at once, like the compiled decoder
+        gives them: arrays of the timestamps in ms and the instance ids, and
+        the packed data of all the samples in a row. """
+        column = self.get(obj)
+        if column is None:
+            column = self[obj] = UAVOColumn(obj, self.chunk_size)
+
+        column.extend(times, instances, data)
+
+    def sort_by_time(self):
+        """ Puts the samples of each object in order of time, keeping the
+        order of those with the same time """
+        for column in self.values():
+            column.sort_by_time()
+
+    def iter_objects(self):
+        """ Yields all the samples as objects, in order of time.  Only one
+        object is made at a time. """
+        import numpy as np
+
+        columns = [ c for c in self.values() if len(c) ]
+        if not columns:
+            return
+
+        times = np.concatenate([ c.times[:len(c)] for c in columns ])
+        which = np.concatenate([ np.full(len(c), i, dtype='uint32')
+                for i, c in enumerate(columns) ])
+        rows = np.concatenate([ np.arange(len(c), dtype='uint32') for c in columns ])
+
+        for pos in np.argsort(times, kind='mergesort'):
+            yield columns[which[pos]].value(int(rows[pos]))
+
+    def as_numpy_array(self, obj):
+        """ The samples of obj, as TelemetryBase.as_numpy_array makes them """
+        column = self.get(obj)
+        if column is None:
+            import numpy as np
+
+            return np.array([])
+
+        return column.as_numpy_array()
+
+    def last_values(self):
+        """ The last sample of each object, as an object """
+        return dict((obj, column.last_value()) for obj, column in self.items()
+                if len(column))
+
+class UAVOColumn():
+    """ The samples of one object: a structured numpy array of their packed
+    data, plus their times and instance ids, that grow in chunks. """
+
+    def __init__(self, obj, chunk_size=4096):
+        import numpy as np
+
+        self.obj = obj
+        self.count = 0
+        self.chunk_size = chunk_size
+
+        self._size = obj.get_size_of_data()
+        self.data = np.zeros(0, dtype=obj.get_packed_dtype())
+        # In ms, as received
+        self.times = np.zeros(0, dtype='double')
+        self.instances = np.zeros(0, dtype='uint16')
+        self._raw = memoryview(self.data.view('uint8'))
+
+    def __len__(self):
+        return self.count
+
+    def _reserve(self, count):
+        """ Makes room for count more samples """
+        import numpy as np
+
+        needed = self.count + count
+        if needed <= len(self.data):
+            return
+
+        # Grow by whole chunks, and at least double, so appending stays
+        # linear in the number of samples
+        capacity = max(needed, 2 * len(self.data))
+        capacity = -(-capacity // self.chunk_size) * self.chunk_size
+
+        self._raw.release()
+
+        for name in ('data', 'times', 'instances'):
+            old = getattr(self, name)
+            new = np.zeros(capacity, dtype=old.dtype)
+            new[:self.count] = old[:self.count]
+            setattr(self, name, new)
+
+        self._raw = memoryview(self.data.view('uint8'))
+
+    def append(self, timestamp, instance_id, data, offset=0):
+        self._reserve(1)
+
+        pos = self.count * self._size
+        self._raw[pos : pos + self._size] = data[offset : offset + self._size]
+
+        self.times[self.count] = timestamp
+        if instance_id is not None:
+            self.instances[self.count] = instance_id
+
+        self.count += 1
+
+    def extend(self, times, instances, data):
+        """ Adds samples from arrays of their times in ms and instance ids,
+        and their packed data, in an array or in a row in bytes """
+        import numpy as np
+
+        if isinstance(data, np.ndarray):
+            packed = data
+        else:
+            packed = np.frombuffer(data, dtype=self.data.dtype)
+        count = len(packed)
+
+        self._reserve(count)
+
+        end = self.count + count
+        self.data[self.count : end] = packed
+        self.times[self.count : end] = times
+        if instances is not None:
+            self.instances[self.count : end] = instances
+
+        self.count = end
+
+    def export(self):
+        """ Copies of the times, instance ids and packed data of the samples,
+        as extend() takes them """
+        instances = None if self.obj._single else self.instances[:self.count].copy()
+
+        return (self.times[:self.count].copy(), instances, self.data[:self.count].copy())
+
+    def sort_by_time(self):
+        import numpy as np
+
+        order = np.argsort(self.times[:self.count], kind='mergesort')
+
+        for array in (self.data, self.times, self.instances):
+            array[:self.count] = array[:self.count][order]
+
+    def as_numpy_array(self):
+        """ The samples in an array of the object's _dtype """
+        import numpy as np
+
+        obj = self.obj
+        array = np.zeros(self.count, dtype=obj._dtype)
+        array['name'] = obj._name
+        array['time'] = self.times[:self.count] / 1000.0
+        array['uavo_id'] = obj._id
+
+        if not obj._single:
+            array['inst_id'] = self.instances[:self.count]
+
+        for name in self.data.dtype.names:
+            array[name] = self.data[name][:self.count]
+
+        return array
+
+    def value(self, index):
+        """ A sample, as an object """
+        pos = index * self._size
+        instance_id = None if self.obj._single else int(self.instances[index])
+
+        return self.obj.from_bytes(self._raw[pos : pos + self._size].tobytes(),
+                self.times[index], instance_id)
+
+    def last_value(self):
+        """ The last sample, as an object """
+        return self.value(self.count - 1)
@@ -17,16 +17,28 @@ except:
 
 import time
 
-__all__ = [ "send_object", "process_stream" ]
+__all__ = [ "send_object", "process_stream", "decode_log", "decode_log_columns",
+        "decode_log_parallel" ]
 
 from six import int2byte, indexbytes, byte2int, iterbytes
 
+# Optional compiled log decoder, built by setup.py from the object table
+# uavobjgenerator writes
+try:
+    from . import _uavodecode
+except ImportError:
+    _uavodecode = None
+
 # Constants used for UAVTalk parsing
 (MIN_HEADER_LENGTH, MAX_HEADER_LENGTH, MAX_PAYLOAD_LENGTH) = (8, 12, (256-12))
 (SYNC_VAL) = (0x3C)
 (TYPE_MASK, TYPE_VER) = (0x70, 0x20)
 (TIMESTAMPED) = (0x80)
 (TYPE_OBJ, TYPE_OBJ_REQ, TYPE_OBJ_ACK, TYPE_ACK, TYPE_NACK, TYPE_FILEREQ, TYPE_FILEDATA, TYPE_OBJ_TS, TYPE_OBJ_ACK_TS, ) = (0x00, 0x01, 0x02, 0x03, 0x04, 0x08, 0x09, 0x80, 0x82)
+# Compressed records from onboard logs, see UAVTALK_TYPE_LOG_KEY in uavtalk_priv.h
+(TYPE_LOG_KEY, TYPE_LOG_DELTA, LOG_KEY_HEADER_LENGTH, LOG_DELTA_HEADER_LENGTH) = (0x8A, 0x8B, 11, 7)
+# Objects with only some fields, after a mask of those present
+(TYPE_OBJ_PARTIAL, TYPE_OBJ_PARTIAL_TS) = (0x0C, 0x8C)
 (FILEDATA_EOF, FILEDATA_LAST) = (0x01, 0x02)
 
 # Serialization of header elements
@@ -34,10 +46,21 @@ from six import int2byte, indexbytes, byte2int, iterbytes
 # sync(1) + type(1) + len(2) + objid(4)
 header_fmt = Struct("<BBHL")
 logheader_fmt = Struct("<IQ")
+# Checked GCS log records put a sync word and a CRC in the top of the size,
+# see ground/gcs/src/plugins/uavtalk/logrecord.h
+LOG_RECORD_SYNC = 0x5244
+# Compressed GCS logs group records in blocks, see logblock.h next to it
+logblock_fmt = Struct("<IIIII")
+LOG_BLOCK_SYNC = 0x424c5244
+LOG_INDEX_SYNC = 0x494c5244
+LOG_BLOCK_MAX_SIZE = 16 * 1024 * 1024
+LOG_BLOCK_TAG = b'Blocks: zlib'
 timestamp_fmt = Struct("<H")
 instance_fmt = Struct("<H")
 filereq_fmt = Struct("<LH")
 fileresp_fmt = Struct("<LB")
+logslot_fmt = Struct("<BH")
+partialmask_fmt = Struct("<L")
 
 # CRC lookup table
 crc_table = [
@@ -61,12 +84,17 @@ crc_table = [
 
 def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
         progress_callback=None, ack_callback=None, reqack_callback=None,
-        nack_callback=None, filedata_callback=None):
+        nack_callback=None, filedata_callback=None, sample_callback=None):
     """Generator function that parses uavotalk stream.
 
     You are expected to send more bytes, or '' to it, until EOF.  Then send
     None.  After that, you may continue to receive objects back because of
-    buffering."""
+    buffering.
+
+    If sample_callback is given, it's called with the object class, the
+    timestamp, the instance id, the data and the offset of the packed object
+    in it for every object received, instead of making an object of it to
+    yield."""
 
     # These are used for accounting for timestamp wraparound
     timestamp_base = 0
@@ -81,6 +109,11 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
 
     pending_pieces = []
 
+    # Slot number to (object id, last sample) for compressed logs
+    log_slots = {}
+    # (object id, instance id) to last data, for applying partial objects
+    partial_objs = {}
+
     while True:
         # If we don't have sufficient data buffered, join up any chunks we've
         # been given to ensure pending_pieces is empty for the rest of this loop.
@@ -111,6 +144,9 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
 
             overrideTimestamp, logHdrLen = logheader_fmt.unpack_from(buf,buf_offset)
 
+            if (logHdrLen >> 16) & 0xffff == LOG_RECORD_SYNC:
+                logHdrLen &= 0xffff
+
             if gcs_timestamps is None:
                 if ((logHdrLen > 1000) or ( overrideTimestamp > 100000000)):
                     if indexbytes(buf, buf_offset) == SYNC_VAL:
@@ -165,6 +201,68 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
 
         pack_type &= ~ TYPE_MASK
 
+        if pack_type == TYPE_LOG_KEY or pack_type == TYPE_LOG_DELTA:
+            if pack_len < LOG_DELTA_HEADER_LENGTH or pack_len > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH:
+                print("badlen %d"%(pack_len))
+                buf_offset += 1
+                continue
+
+            while len(buf) < pack_len + 1 + buf_offset:
+                rx = yield None
+
+                if rx is None:
+                    return
+
+                buf += rx
+
+            if calcCRC(buf[buf_offset:pack_len+buf_offset]) != indexbytes(buf, buf_offset + pack_len):
+                print("Bad crc on compressed record")
+                buf_offset += 1
+                continue
+
+            obj = None
+            if pack_type == TYPE_LOG_KEY and pack_len >= LOG_KEY_HEADER_LENGTH:
+                (slot, timestamp) = logslot_fmt.unpack_from(buf, buf_offset + header_fmt.size)
+                log_slots[slot] = (objId, bytearray(buf[buf_offset + LOG_KEY_HEADER_LENGTH : buf_offset + pack_len]))
+                obj = uavo_defs.get('{0:08x}'.format(objId))
+            elif pack_type == TYPE_LOG_DELTA:
+                (slot, timestamp) = logslot_fmt.unpack_from(buf, buf_offset + 4)
+                if slot in log_slots and apply_log_delta(log_slots[slot][1],
+                        buf[buf_offset + LOG_DELTA_HEADER_LENGTH : buf_offset + pack_len]):
+                    objId = log_slots[slot][0]
+                    obj = uavo_defs.get('{0:08x}'.format(objId))
+                else:
+                    # Nothing to apply deltas to until the next key
+                    log_slots.pop(slot, None)
+
+            next_recv = None
+
+            if obj is not None and obj.get_size_of_data() == len(log_slots[slot][1]):
+                if timestamp < last_timestamp:
+                    timestamp_base = timestamp_base + 65536
+                last_timestamp = timestamp
+                timestamp += timestamp_base
+
+                if use_walltime:
+                    timestamp = int(time.time()*1000.0)
+
+                if gcs_timestamps:
+                    timestamp = overrideTimestamp
+
+                received += 1
+                if sample_callback is not None:
+                    sample_callback(obj, timestamp, None, log_slots[slot][1], 0)
+                else:
+                    objInstance = obj.from_bytes(bytes(log_slots[slot][1]), timestamp, None)
+                    next_recv = yield objInstance
+
+            buf_offset += pack_len + 1
+
+            if next_recv is not None and next_recv != '':
+                pending_pieces.append(next_recv)
+
+            continue
+
         if pack_len < MIN_HEADER_LENGTH or pack_len > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH:
             print("badlen %d"%(pack_len))
             buf_offset += 1
@@ -185,7 +283,7 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
             timestamp_len = 0
         else:
             if obj is not None:
-                timestamp_len = timestamp_fmt.size if pack_type == TYPE_OBJ_TS or pack_type == TYPE_OBJ_ACK_TS else 0
+                timestamp_len = timestamp_fmt.size if pack_type in (TYPE_OBJ_TS, TYPE_OBJ_ACK_TS, TYPE_OBJ_PARTIAL_TS) else 0
                 obj_len = obj.get_size_of_data()
             else:
                 # we don't know anything, so fudge to keep sync.
@@ -197,6 +295,12 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
         else:
             instance_len = 0
 
+        partial = obj is not None and pack_type in (TYPE_OBJ_PARTIAL, TYPE_OBJ_PARTIAL_TS)
+
+        if partial:
+            # Mask and present fields, checked against the object below
+            obj_len = pack_len - header_fmt.size - instance_len - timestamp_len
+
         # Check length and determine next state
         if obj_len >= MAX_PAYLOAD_LENGTH:
             print("bad len-- bad xml?")
@@ -271,18 +375,35 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
 
         data_offset = header_fmt.size + instance_len + timestamp_len + buf_offset
 
+        obj_data = buf
+        if partial:
+            obj_data = apply_partial_object(partial_objs, obj, instance_id,
+                    buf[data_offset : data_offset + obj_len])
+            if obj_data is None:
+                print("bad partial object id=%s"%(uavo_key))
+                obj_len = 0
+            else:
+                obj_data = bytes(obj_data)
+                data_offset = 0
+        elif obj_len > 0 and obj is not None:
+            # Base for the fields missing from later partial updates
+            partial_objs[(obj._id, instance_id)] = bytearray(buf[data_offset : data_offset + obj_len])
+
+        next_recv = None
+
         if (obj_len > 0) and (obj is not None):
-            objInstance = obj.from_bytes(buf, timestamp, instance_id,
-                    offset=data_offset)
             received += 1
             if not (received % 10000):
                 if progress_callback is not None:
                     progress_callback(received, past_bytes + buf_offset + calc_size + 1)
                 print("received %d objs"%(received))
 
-            next_recv = yield objInstance
-        else:
-            next_recv = None
+            if sample_callback is not None:
+                sample_callback(obj, timestamp, instance_id, obj_data, data_offset)
+            else:
+                objInstance = obj.from_bytes(obj_data, timestamp, instance_id,
+                        offset=data_offset)
+                next_recv = yield objInstance
 
         if (obj is not None) and (pack_type == TYPE_ACK):
             if ack_callback is not None:
@@ -313,6 +434,298 @@ def process_stream(uavo_defs, use_walltime=False, gcs_timestamps=None,
         if next_recv is not None and next_recv != '':
             pending_pieces.append(next_recv)
 
+def native_decoder_usable(uavo_defs):
+    """ Whether the compiled decoder is there and was built for exactly the
+    objects of uavo_defs, e.g. not for those of a log from another version """
+    if _uavodecode is None:
+        return False
+
+    native = _uavodecode.objects()
+
+    for obj in uavo_defs.values():
+        if native.get(obj._id) != obj.get_size_of_data():
+            return False
+
+    return True
+
+def detect_gcs_timestamps(data):
+    """ Tells from the start of a log whether its records carry GCS
+    timestamps, like process_stream does.  Returns None when unsure. """
+    if len(data) < header_fmt.size + logheader_fmt.size:
+        return None
+
+    overrideTimestamp, logHdrLen = logheader_fmt.unpack_from(data, 0)
+
+    if (logHdrLen >> 16) & 0xffff == LOG_RECORD_SYNC:
+        logHdrLen &= 0xffff
+
+    if (logHdrLen > 1000) or (overrideTimestamp > 100000000):
+        if indexbytes(data, 0) == SYNC_VAL:
+            return False
+    elif indexbytes(data, logheader_fmt.size) == SYNC_VAL:
+        return True
+
+    return None
+
+def decode_log_native(uavo_defs, data, gcs_timestamps=False, columns=None):
+    """ Decodes a whole log with the compiled decoder.
+
+    Returns a UAVOColumns of the samples, columns if given, or None if the
+    compiled decoder can't be used for these objects. """
+    if not native_decoder_usable(uavo_defs):
+        return None
+
+    if gcs_timestamps is None:
+        gcs_timestamps = detect_gcs_timestamps(data)
+        if gcs_timestamps is None:
+            return None
+
+    import numpy as np
+    from .uavo_collection import UAVOColumns
+
+    if columns is None:
+        columns = UAVOColumns()
+
+    for obj_id, (count, times, instances, objdata) in _uavodecode.decode(data, gcs_timestamps).items():
+        obj = uavo_defs['{0:08x}'.format(obj_id)]
+
+        if obj._single:
+            instances = None
+        else:
+            instances = np.frombuffer(instances, dtype='=u2')
+
+        columns.extend(obj, np.frombuffer(times, dtype='=u4'), instances, objdata)
+
+    return columns
+
+def decode_log_columns(uavo_defs, data, gcs_timestamps=False, columns=None):
+    """ Decodes a whole log into a UAVOColumns of its samples, columns if
+    given.  Uses the compiled decoder when available, process_stream
+    otherwise; neither makes an object per sample. """
+    native = decode_log_native(uavo_defs, data, gcs_timestamps, columns)
+    if native is not None:
+        return native
+
+    from .uavo_collection import UAVOColumns
+
+    if columns is None:
+        columns = UAVOColumns()
+
+    stream = process_stream(uavo_defs, gcs_timestamps=gcs_timestamps,
+            sample_callback=columns.append)
+    stream.send(None)
+    stream.send(data)
+    stream.close()
+
+    return columns
+
+def is_log_record(data, pos):
+    """ Whether a GCS log record starts at pos in data, holding a good
+    UAVTalk frame """
+    payload = pos + logheader_fmt.size
+
+    if pos < 0 or payload + header_fmt.size + 1 > len(data):
+        return False
+
+    overrideTimestamp, logHdrLen = logheader_fmt.unpack_from(data, pos)
+
+    if (logHdrLen >> 16) & 0xffff == LOG_RECORD_SYNC:
+        import zlib
+
+        size = logHdrLen & 0xffff
+        if payload + size > len(data):
+            return False
+
+        crc = zlib.crc32(data[pos : pos + 8])
+        crc = zlib.crc32(data[payload : payload + size], crc)
+
+        return (crc & 0xffffffff) == logHdrLen >> 32
+
+    # Legacy records have no check of their own, but the frame has
+    (sync, pack_type, pack_len, objId) = header_fmt.unpack_from(data, payload)
+
+    if sync != SYNC_VAL or (pack_type & TYPE_MASK) != TYPE_VER:
+        return False
+    if pack_len < MIN_HEADER_LENGTH or pack_len + 1 > logHdrLen:
+        return False
+    if payload + pack_len + 1 > len(data):
+        return False
+
+    return calcCRC(data[payload : payload + pack_len]) == indexbytes(data, payload + pack_len)
+
+def find_log_record(data, start, end=None):
+    """ Finds the first GCS log record at or after start, a point to start
+    decoding from.  Returns end, or the end of data, if there's none. """
+    if end is None:
+        end = len(data)
+
+    sync = int2byte(SYNC_VAL)
+    pos = start
+
+    while True:
+        # Records hold frames, which start with a sync byte
+        frame = data.find(sync, pos + logheader_fmt.size, end + logheader_fmt.size)
+        if frame < 0:
+            return end
+
+        pos = frame - logheader_fmt.size
+        if pos >= end:
+            return end
+
+        if is_log_record(data, pos):
+            return pos
+
+        pos += 1
+
+# At least this much of a log goes to each process
+PARALLEL_MIN_CHUNK = 4 * 1024 * 1024
+
+_worker_defs = None
+
+def _init_decode_worker(xml_contents):
+    global _worker_defs
+
+    from .uavo_collection import UAVOCollection
+
+    _worker_defs = UAVOCollection()
+    _worker_defs.from_file_contents(xml_contents)
+
+def _decode_chunk(chunk):
+    columns = decode_log_columns(_worker_defs, chunk, True)
+
+    # The classes of the worker mean nothing to the caller, the ids do
+    return dict((obj._id, column.export()) for obj, column in columns.items())
+
+def decode_log_parallel(uavo_defs, data, gcs_timestamps=None, processes=0,
+        columns=None):
+    """ Decodes a whole log like decode_log_columns, in a pool of processes,
+    0 for one per core.
+
+    The log is split at records found by find_log_record, the pieces are
+    decoded each on its own and the samples merged by timestamp.  Only logs
+    with GCS timestamps can be split: onboard logs have 16 bit timestamps,
+    and compressed slots building on earlier records, so they are decoded
+    in one piece. """
+    import multiprocessing
+
+    if gcs_timestamps is None:
+        gcs_timestamps = detect_gcs_timestamps(data)
+
+    if not processes:
+        processes = multiprocessing.cpu_count()
+
+    if (not gcs_timestamps or processes <= 1 or not uavo_defs.xml_contents or
+            len(data) < 2 * PARALLEL_MIN_CHUNK):
+        return decode_log_columns(uavo_defs, data, gcs_timestamps, columns)
+
+    from .uavo_collection import UAVOColumns
+
+    if columns is None:
+        columns = UAVOColumns()
+
+    # A few pieces per process, so they all stay busy until the end
+    pieces = min(4 * processes, len(data) // PARALLEL_MIN_CHUNK)
+    bounds = [0]
+    for i in range(1, pieces):
+        bounds.append(max(bounds[-1], find_log_record(data, i * len(data) // pieces)))
+    bounds.append(len(data))
+
+    pool = multiprocessing.Pool(processes, _init_decode_worker,
+            (uavo_defs.xml_contents,))
+
+    try:
+        chunks = (data[a:b] for a, b in zip(bounds, bounds[1:]) if b > a)
+
+        for part in pool.imap(_decode_chunk, chunks):
+            for obj_id, (times, instances, packed) in part.items():
+                columns.extend(uavo_defs['{0:08x}'.format(obj_id)], times,
+                        instances, packed)
+
+        pool.close()
+    except:
+        pool.terminate()
+        raise
+    finally:
+        pool.join()
+
+    columns.sort_by_time()
+
+    return columns
+
+def decode_log(uavo_defs, data, gcs_timestamps=False):
+    """ Decodes a whole log into a dict of object class to numpy array of its
+    samples, as TelemetryBase.as_numpy_array would make them. """
+    columns = decode_log_columns(uavo_defs, data, gcs_timestamps)
+
+    return dict((obj, columns.as_numpy_array(obj)) for obj in columns)
+
+def apply_partial_object(partial_objs, obj, instance_id, payload):
+    """ Applies the fields of a partial object onto the last data of the
+    instance, zero if there was none.  Returns the full object data, or None
+    if the payload doesn't match the object. """
+    if len(payload) < partialmask_fmt.size:
+        return None
+
+    mask = partialmask_fmt.unpack_from(payload, 0)[0]
+    payload = payload[partialmask_fmt.size:]
+
+    key = (obj._id, instance_id)
+    data = partial_objs.get(key)
+    if data is None:
+        data = bytearray(obj.get_size_of_data())
+
+    data = bytearray(data)
+    offset = 0
+    used = 0
+
+    for i, size in enumerate(obj._field_sizes):
+        if i < 32 and (mask & (1 << i)):
+            if used + size > len(payload):
+                return None
+
+            data[offset:offset + size] = payload[used:used + size]
+            used += size
+
+        offset += size
+
+    if used != len(payload):
+        return None
+
+    partial_objs[key] = data
+
+    return data
+
+def apply_log_delta(sample, payload):
+    """XOR a compressed log delta into the previous sample of its slot.
+
+    For each group of 8 bytes the payload holds a bitmap of the bytes that
+    changed, followed by their XOR.  Returns False, leaving sample alone, if
+    the payload does not match the sample size."""
+
+    result = bytearray(sample)
+    pos = 0
+
+    for i in range(0, len(result), 8):
+        if pos >= len(payload):
+            return False
+
+        mask = indexbytes(payload, pos)
+        pos += 1
+
+        for j in range(8):
+            if mask & (1 << j):
+                if i + j >= len(result) or pos >= len(payload):
+                    return False
+
+                result[i + j] ^= indexbytes(payload, pos)
+                pos += 1
+
+    if pos != len(payload):
+        return False
+
+    sample[:] = result
+    return True
+
 def send_object(obj, req_ack=False):
     """Generates a string containing a UAVTalk packet describing this object"""
 
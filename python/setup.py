@@ -5,15 +5,28 @@ https://github.com/pypa/sampleproject
 """
 
 # Always prefer setuptools over distutils
-from setuptools import setup, find_packages
+from setuptools import setup, find_packages, Extension
 # To use a consistent encoding
 from codecs import open
+import os
 from os import path
 
 here = path.abspath(path.dirname(__file__))
 with open(path.join(here, 'README.rst'), encoding='utf-8') as f:
     long_description = f.read()
 
+# The compiled log decoder needs the object table uavobjgenerator writes
+# (make uavobjects); without it, or a compiler, the package is pure python
+uavodecode_dir = os.environ.get('UAVODECODE_OBJECTS_DIR',
+        path.join(here, '..', 'build', 'uavobject-synthetics', 'python'))
+
+ext_modules = []
+if path.exists(path.join(uavodecode_dir, 'uavodecodeobjects.h')):
+    ext_modules.append(Extension('dronin._uavodecode',
+        sources=['uavodecode/uavodecode.cpp'],
+        include_dirs=[uavodecode_dir],
+        optional=True))
+
 long_description = """
 This is the dRonin UAVTalk API.  With these modules, it is possible to
 communicate with dRonin flight controllers and interpret log files and
@@ -77,6 +90,8 @@ setup(
     # simple. Or you can use find_packages().
     packages = ['dronin', 'dronin.logviewer'],
 
+    ext_modules = ext_modules,
+
     # Just requires the base python system to run
     install_requires=['six'],
 
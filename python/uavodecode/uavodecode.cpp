@@ -0,0 +1,547 @@
+/*
+ * Native decoding of UAVTalk logs, see decode_log() in dronin/uavtalk.py.
+ *
+ * Copyright (C) 2016 dRonin, http://dronin.org
+ *
+ * Licensed under the GNU LGPL version 2.1 or any later version (see
+ * COPYING.LESSER)
+ *
+ * This follows process_stream() in uavtalk.py frame by frame, so both give
+ * the same samples.  Instead of an object instance per sample, it collects
+ * the timestamps, instance ids and packed data of each object in one buffer
+ * apiece, for numpy to take as arrays.
+ */
+
+#include <Python.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "uavodecodeobjects.h"
+
+namespace {
+
+// Constants used for UAVTalk parsing, as in uavtalk.py
+const int MIN_HEADER_LENGTH = 8;
+const int MAX_HEADER_LENGTH = 12;
+const int MAX_PAYLOAD_LENGTH = 256 - 12;
+const int LOG_HEADER_LENGTH = 12;
+const uint8_t SYNC_VAL = 0x3C;
+const uint8_t TYPE_MASK = 0x70;
+const uint8_t TYPE_VER = 0x20;
+
+const uint8_t TYPE_OBJ_REQ = 0x01;
+const uint8_t TYPE_ACK = 0x03;
+const uint8_t TYPE_NACK = 0x04;
+const uint8_t TYPE_OBJ_TS = 0x80;
+const uint8_t TYPE_OBJ_ACK_TS = 0x82;
+const uint8_t TYPE_LOG_KEY = 0x8A;
+const uint8_t TYPE_LOG_DELTA = 0x8B;
+const uint8_t TYPE_OBJ_PARTIAL = 0x0C;
+const uint8_t TYPE_OBJ_PARTIAL_TS = 0x8C;
+const int LOG_KEY_HEADER_LENGTH = 11;
+const int LOG_DELTA_HEADER_LENGTH = 7;
+
+const uint8_t crc_table[256] = {
+    0x00, 0x07, 0x0e, 0x09, 0x1c, 0x1b, 0x12, 0x15, 0x38, 0x3f, 0x36, 0x31, 0x24, 0x23, 0x2a, 0x2d,
+    0x70, 0x77, 0x7e, 0x79, 0x6c, 0x6b, 0x62, 0x65, 0x48, 0x4f, 0x46, 0x41, 0x54, 0x53, 0x5a, 0x5d,
+    0xe0, 0xe7, 0xee, 0xe9, 0xfc, 0xfb, 0xf2, 0xf5, 0xd8, 0xdf, 0xd6, 0xd1, 0xc4, 0xc3, 0xca, 0xcd,
+    0x90, 0x97, 0x9e, 0x99, 0x8c, 0x8b, 0x82, 0x85, 0xa8, 0xaf, 0xa6, 0xa1, 0xb4, 0xb3, 0xba, 0xbd,
+    0xc7, 0xc0, 0xc9, 0xce, 0xdb, 0xdc, 0xd5, 0xd2, 0xff, 0xf8, 0xf1, 0xf6, 0xe3, 0xe4, 0xed, 0xea,
+    0xb7, 0xb0, 0xb9, 0xbe, 0xab, 0xac, 0xa5, 0xa2, 0x8f, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9d, 0x9a,
+    0x27, 0x20, 0x29, 0x2e, 0x3b, 0x3c, 0x35, 0x32, 0x1f, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0d, 0x0a,
+    0x57, 0x50, 0x59, 0x5e, 0x4b, 0x4c, 0x45, 0x42, 0x6f, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7d, 0x7a,
+    0x89, 0x8e, 0x87, 0x80, 0x95, 0x92, 0x9b, 0x9c, 0xb1, 0xb6, 0xbf, 0xb8, 0xad, 0xaa, 0xa3, 0xa4,
+    0xf9, 0xfe, 0xf7, 0xf0, 0xe5, 0xe2, 0xeb, 0xec, 0xc1, 0xc6, 0xcf, 0xc8, 0xdd, 0xda, 0xd3, 0xd4,
+    0x69, 0x6e, 0x67, 0x60, 0x75, 0x72, 0x7b, 0x7c, 0x51, 0x56, 0x5f, 0x58, 0x4d, 0x4a, 0x43, 0x44,
+    0x19, 0x1e, 0x17, 0x10, 0x05, 0x02, 0x0b, 0x0c, 0x21, 0x26, 0x2f, 0x28, 0x3d, 0x3a, 0x33, 0x34,
+    0x4e, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5c, 0x5b, 0x76, 0x71, 0x78, 0x7f, 0x6a, 0x6d, 0x64, 0x63,
+    0x3e, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2c, 0x2b, 0x06, 0x01, 0x08, 0x0f, 0x1a, 0x1d, 0x14, 0x13,
+    0xae, 0xa9, 0xa0, 0xa7, 0xb2, 0xb5, 0xbc, 0xbb, 0x96, 0x91, 0x98, 0x9f, 0x8a, 0x8d, 0x84, 0x83,
+    0xde, 0xd9, 0xd0, 0xd7, 0xc2, 0xc5, 0xcc, 0xcb, 0xe6, 0xe1, 0xe8, 0xef, 0xfa, 0xfd, 0xf4, 0xf3
+};
+
+uint8_t calcCRC(const uint8_t *data, size_t len)
+{
+    uint8_t cs = 0;
+
+    for (size_t i = 0; i < len; i++)
+        cs = crc_table[cs ^ data[i]];
+
+    return cs;
+}
+
+uint16_t le16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+struct Samples {
+    std::vector<uint32_t> times;
+    std::vector<uint16_t> instances;
+    std::vector<uint8_t> data;
+};
+
+struct LogSlot {
+    uint32_t objId;
+    std::vector<uint8_t> sample;
+};
+
+class LogDecoder
+{
+public:
+    LogDecoder(const uint8_t *buf, size_t len, bool gcsTimestamps);
+
+    void run();
+
+    std::map<uint32_t, Samples> samples;
+
+private:
+    const uavo_def *findObject(uint32_t objId);
+    uint32_t unwrapTimestamp(uint16_t timestamp);
+    void addSample(const uavo_def *def, uint32_t timestamp, uint16_t instId,
+                   const uint8_t *data);
+    bool decodeLogRecord(size_t pos, uint8_t type, int packLen, uint32_t objId,
+                         uint32_t overrideTimestamp);
+    const uint8_t *applyPartialObject(const uavo_def *def, uint16_t instId,
+                                      const uint8_t *payload, int len);
+    static bool applyLogDelta(std::vector<uint8_t> &sample, const uint8_t *payload,
+                              int len);
+
+    const uint8_t *buf;
+    size_t len;
+    bool gcsTimestamps;
+
+    // These are used for accounting for timestamp wraparound
+    uint32_t timestampBase;
+    uint16_t lastTimestamp;
+
+    std::map<uint32_t, const uavo_def *> defs;
+    // Slot number to object and last sample, for compressed logs
+    std::map<uint8_t, LogSlot> logSlots;
+    // Object and instance to last data, for applying partial objects
+    std::map<uint64_t, std::vector<uint8_t> > partialObjs;
+};
+
+LogDecoder::LogDecoder(const uint8_t *buf, size_t len, bool gcsTimestamps)
+    : buf(buf)
+    , len(len)
+    , gcsTimestamps(gcsTimestamps)
+    , timestampBase(0)
+    , lastTimestamp(0)
+{
+    for (size_t i = 0; i < sizeof(uavo_defs) / sizeof(uavo_defs[0]); i++)
+        defs[uavo_defs[i].id] = &uavo_defs[i];
+}
+
+const uavo_def *LogDecoder::findObject(uint32_t objId)
+{
+    std::map<uint32_t, const uavo_def *>::const_iterator it = defs.find(objId);
+
+    return it == defs.end() ? NULL : it->second;
+}
+
+uint32_t LogDecoder::unwrapTimestamp(uint16_t timestamp)
+{
+    if (timestamp < lastTimestamp)
+        timestampBase += 65536;
+    lastTimestamp = timestamp;
+
+    return timestamp + timestampBase;
+}
+
+void LogDecoder::addSample(const uavo_def *def, uint32_t timestamp, uint16_t instId,
+                           const uint8_t *data)
+{
+    Samples &s = samples[def->id];
+
+    s.times.push_back(timestamp);
+    if (!def->single_instance)
+        s.instances.push_back(instId);
+    s.data.insert(s.data.end(), data, data + def->num_bytes);
+}
+
+void LogDecoder::run()
+{
+    size_t pos = 0;
+
+    while (true) {
+        uint32_t overrideTimestamp = 0;
+
+        if (gcsTimestamps) {
+            if (len - pos < (size_t)(LOG_HEADER_LENGTH + MIN_HEADER_LENGTH))
+                return;
+
+            overrideTimestamp = le32(buf + pos);
+            pos += LOG_HEADER_LENGTH;
+        }
+
+        while (len - pos < (size_t)MIN_HEADER_LENGTH || buf[pos] != SYNC_VAL) {
+            if (len - pos < (size_t)MIN_HEADER_LENGTH + 1)
+                return;
+
+            const uint8_t *sync = (const uint8_t *)memchr(buf + pos, SYNC_VAL, len - pos);
+            pos = sync ? sync - buf : len - 1;
+        }
+
+        uint8_t type = buf[pos + 1];
+        int packLen = le16(buf + pos + 2);
+        uint32_t objId = le32(buf + pos + 4);
+
+        if ((type & TYPE_MASK) != TYPE_VER) {
+            pos++;
+            continue;
+        }
+
+        type &= ~TYPE_MASK;
+
+        if (type == TYPE_LOG_KEY || type == TYPE_LOG_DELTA) {
+            if (packLen < LOG_DELTA_HEADER_LENGTH
+                || packLen > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+                pos++;
+                continue;
+            }
+
+            if (len - pos < (size_t)packLen + 1)
+                return;
+
+            if (calcCRC(buf + pos, packLen) != buf[pos + packLen]) {
+                pos++;
+                continue;
+            }
+
+            decodeLogRecord(pos, type, packLen, objId, overrideTimestamp);
+
+            pos += packLen + 1;
+            continue;
+        }
+
+        if (packLen < MIN_HEADER_LENGTH || packLen > MAX_HEADER_LENGTH + MAX_PAYLOAD_LENGTH) {
+            pos++;
+            continue;
+        }
+
+        const uavo_def *def = findObject(objId);
+
+        // Determine data length
+        int objLen, timestampLen;
+        if (type == TYPE_OBJ_REQ || type == TYPE_ACK || type == TYPE_NACK) {
+            objLen = 0;
+            timestampLen = 0;
+        } else if (def) {
+            bool ts = type == TYPE_OBJ_TS || type == TYPE_OBJ_ACK_TS || type == TYPE_OBJ_PARTIAL_TS;
+            timestampLen = ts ? 2 : 0;
+            objLen = def->num_bytes;
+        } else {
+            // we don't know anything, so fudge to keep sync.
+            timestampLen = 0;
+            objLen = packLen - MIN_HEADER_LENGTH;
+        }
+
+        int instanceLen = (def && !def->single_instance) ? 2 : 0;
+
+        bool partial = def && (type == TYPE_OBJ_PARTIAL || type == TYPE_OBJ_PARTIAL_TS);
+        if (partial) {
+            // Mask and present fields, checked against the object below
+            objLen = packLen - MIN_HEADER_LENGTH - instanceLen - timestampLen;
+        }
+
+        if (objLen >= MAX_PAYLOAD_LENGTH) {
+            pos++;
+            continue;
+        }
+
+        int calcSize = MIN_HEADER_LENGTH + instanceLen + timestampLen + objLen;
+        if (calcSize != packLen) {
+            pos++;
+            continue;
+        }
+
+        if (len - pos < (size_t)calcSize + 1)
+            return;
+
+        if (calcCRC(buf + pos, calcSize) != buf[pos + calcSize]) {
+            pos++;
+            continue;
+        }
+
+        uint16_t instId = instanceLen ? le16(buf + pos + MIN_HEADER_LENGTH) : 0;
+
+        uint32_t timestamp;
+        if (timestampLen)
+            timestamp = unwrapTimestamp(le16(buf + pos + MIN_HEADER_LENGTH + instanceLen));
+        else
+            timestamp = lastTimestamp;
+
+        if (gcsTimestamps)
+            timestamp = overrideTimestamp;
+
+        const uint8_t *objData = buf + pos + MIN_HEADER_LENGTH + instanceLen + timestampLen;
+
+        if (partial) {
+            objData = applyPartialObject(def, instId, objData, objLen);
+            if (!objData)
+                objLen = 0;
+        } else if (objLen > 0 && def) {
+            // Base for the fields missing from later partial updates
+            partialObjs[((uint64_t)objId << 16) | instId].assign(objData, objData + objLen);
+        }
+
+        if (objLen > 0 && def)
+            addSample(def, timestamp, instId, objData);
+
+        pos += calcSize + 1;
+    }
+}
+
+/**
+ * Decode a CRC checked record of a compressed onboard log
+ * @return true if it gave a sample
+ */
+bool LogDecoder::decodeLogRecord(size_t pos, uint8_t type, int packLen, uint32_t objId,
+                                 uint32_t overrideTimestamp)
+{
+    const uavo_def *def = NULL;
+    uint8_t slot;
+    uint16_t timestamp;
+
+    if (type == TYPE_LOG_KEY && packLen >= LOG_KEY_HEADER_LENGTH) {
+        slot = buf[pos + MIN_HEADER_LENGTH];
+        timestamp = le16(buf + pos + MIN_HEADER_LENGTH + 1);
+
+        LogSlot &s = logSlots[slot];
+        s.objId = objId;
+        s.sample.assign(buf + pos + LOG_KEY_HEADER_LENGTH, buf + pos + packLen);
+        def = findObject(objId);
+    } else if (type == TYPE_LOG_DELTA) {
+        slot = buf[pos + 4];
+        timestamp = le16(buf + pos + 5);
+
+        std::map<uint8_t, LogSlot>::iterator it = logSlots.find(slot);
+        if (it != logSlots.end()
+            && applyLogDelta(it->second.sample, buf + pos + LOG_DELTA_HEADER_LENGTH,
+                             packLen - LOG_DELTA_HEADER_LENGTH)) {
+            def = findObject(it->second.objId);
+        } else {
+            // Nothing to apply deltas to until the next key
+            logSlots.erase(slot);
+        }
+    }
+
+    if (!def)
+        return false;
+
+    const std::vector<uint8_t> &sample = logSlots[slot].sample;
+    if (sample.size() != def->num_bytes)
+        return false;
+
+    uint32_t t = unwrapTimestamp(timestamp);
+    if (gcsTimestamps)
+        t = overrideTimestamp;
+
+    addSample(def, t, 0, &sample[0]);
+
+    return true;
+}
+
+/**
+ * Apply the fields of a partial object onto the last data of the instance,
+ * zero if there was none
+ * @return the full object data, NULL if the payload doesn't match the object
+ */
+const uint8_t *LogDecoder::applyPartialObject(const uavo_def *def, uint16_t instId,
+                                              const uint8_t *payload, int len)
+{
+    if (len < 4)
+        return NULL;
+
+    uint32_t mask = le32(payload);
+    payload += 4;
+    len -= 4;
+
+    uint64_t key = ((uint64_t)def->id << 16) | instId;
+    std::map<uint64_t, std::vector<uint8_t> >::const_iterator it = partialObjs.find(key);
+
+    std::vector<uint8_t> data;
+    if (it != partialObjs.end())
+        data = it->second;
+    else
+        data.resize(def->num_bytes);
+
+    int offset = 0;
+    int used = 0;
+
+    for (int i = 0; i < def->num_fields; i++) {
+        int size = def->field_sizes[i];
+
+        if (i < 32 && (mask & (1u << i))) {
+            if (used + size > len || offset + size > (int)data.size())
+                return NULL;
+
+            memcpy(&data[offset], payload + used, size);
+            used += size;
+        }
+
+        offset += size;
+    }
+
+    if (used != len)
+        return NULL;
+
+    std::vector<uint8_t> &stored = partialObjs[key];
+    stored.swap(data);
+
+    return &stored[0];
+}
+
+/**
+ * XOR a compressed log delta into the previous sample of its slot
+ * @return false, leaving the sample alone, if the payload doesn't match it
+ */
+bool LogDecoder::applyLogDelta(std::vector<uint8_t> &sample, const uint8_t *payload, int len)
+{
+    std::vector<uint8_t> result(sample);
+    int pos = 0;
+
+    for (size_t i = 0; i < result.size(); i += 8) {
+        if (pos >= len)
+            return false;
+
+        uint8_t mask = payload[pos++];
+
+        for (size_t j = 0; j < 8; j++) {
+            if (mask & (1 << j)) {
+                if (i + j >= result.size() || pos >= len)
+                    return false;
+
+                result[i + j] ^= payload[pos++];
+            }
+        }
+    }
+
+    if (pos != len)
+        return false;
+
+    sample.swap(result);
+    return true;
+}
+
+template <typename T>
+PyObject *vectorToBytes(const std::vector<T> &v)
+{
+    return PyBytes_FromStringAndSize(v.empty() ? "" : (const char *)&v[0], v.size() * sizeof(T));
+}
+
+PyObject *decode(PyObject *self, PyObject *args)
+{
+    (void)self;
+
+    Py_buffer data;
+    int gcsTimestamps = 0;
+
+#if PY_MAJOR_VERSION >= 3
+    if (!PyArg_ParseTuple(args, "y*|i", &data, &gcsTimestamps))
+#else
+    if (!PyArg_ParseTuple(args, "s*|i", &data, &gcsTimestamps))
+#endif
+        return NULL;
+
+    LogDecoder decoder((const uint8_t *)data.buf, data.len, gcsTimestamps != 0);
+
+    Py_BEGIN_ALLOW_THREADS
+    decoder.run();
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&data);
+
+    PyObject *result = PyDict_New();
+    if (!result)
+        return NULL;
+
+    for (std::map<uint32_t, Samples>::const_iterator it = decoder.samples.begin();
+         it != decoder.samples.end(); ++it) {
+        const Samples &s = it->second;
+
+        PyObject *key = PyLong_FromUnsignedLong(it->first);
+        PyObject *value = Py_BuildValue("(nNNN)", (Py_ssize_t)s.times.size(),
+                                        vectorToBytes(s.times), vectorToBytes(s.instances),
+                                        vectorToBytes(s.data));
+
+        if (!key || !value || PyDict_SetItem(result, key, value) < 0) {
+            Py_XDECREF(key);
+            Py_XDECREF(value);
+            Py_DECREF(result);
+            return NULL;
+        }
+
+        Py_DECREF(key);
+        Py_DECREF(value);
+    }
+
+    return result;
+}
+
+PyObject *objects(PyObject *self, PyObject *args)
+{
+    (void)self;
+    (void)args;
+
+    PyObject *result = PyDict_New();
+    if (!result)
+        return NULL;
+
+    for (size_t i = 0; i < sizeof(uavo_defs) / sizeof(uavo_defs[0]); i++) {
+        PyObject *key = PyLong_FromUnsignedLong(uavo_defs[i].id);
+        PyObject *value = PyLong_FromLong(uavo_defs[i].num_bytes);
+
+        if (!key || !value || PyDict_SetItem(result, key, value) < 0) {
+            Py_XDECREF(key);
+            Py_XDECREF(value);
+            Py_DECREF(result);
+            return NULL;
+        }
+
+        Py_DECREF(key);
+        Py_DECREF(value);
+    }
+
+    return result;
+}
+
+PyMethodDef methods[] = {
+    { "decode", decode, METH_VARARGS,
+      "decode(data, gcs_timestamps=False) -> {object id: (count, times, instances, data)}\n\n"
+      "Decode a whole log.  times holds a native uint32 per sample, in ms;\n"
+      "instances a native uint16 per sample of multi instance objects; data\n"
+      "the packed object data of the samples." },
+    { "objects", objects, METH_NOARGS,
+      "objects() -> {object id: size}\n\nThe objects the decoder was built for." },
+    { NULL, NULL, 0, NULL }
+};
+
+} // namespace
+
+#if PY_MAJOR_VERSION >= 3
+static struct PyModuleDef uavodecode_module = {
+    PyModuleDef_HEAD_INIT, "_uavodecode", "Native UAVTalk log decoder", -1, methods,
+    NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit__uavodecode(void)
+{
+    return PyModule_Create(&uavodecode_module);
+}
+#else
+PyMODINIT_FUNC init_uavodecode(void)
+{
+    Py_InitModule3("_uavodecode", methods, "Native UAVTalk log decoder");
+}
+#endif
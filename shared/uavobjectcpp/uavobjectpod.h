@@ -0,0 +1,100 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectpod.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      Common definitions of the plain UAVObject structs
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef UAVOBJECTPOD_H
+#define UAVOBJECTPOD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// The structs are the object data as sent, which is little endian
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The plain UAVObject structs need a little endian host"
+#endif
+
+namespace uavo {
+
+enum class FieldType : uint8_t { INT8, INT16, INT32, UINT8, UINT16, UINT32, FLOAT32, ENUM };
+
+/**
+ * @brief Description of an object field, in the order fields are packed
+ */
+struct FieldInfo
+{
+    const char *name;
+    FieldType type;
+    uint16_t numElements;
+    uint16_t offset;
+    const char *units;
+};
+
+/**
+ * @brief Field table of an object struct, specialized for each of them
+ */
+template <typename T>
+struct FieldTable;
+
+/**
+ * @brief Copy received object data into a struct
+ * @return false if the size doesn't match the object
+ */
+template <typename T>
+bool unpack(T &obj, const void *data, size_t len)
+{
+    if (len != sizeof(T))
+        return false;
+
+    memcpy(&obj, data, sizeof(T));
+    return true;
+}
+
+/**
+ * @brief Copy a struct out as object data, sizeof(T) bytes
+ */
+template <typename T>
+void pack(const T &obj, void *data)
+{
+    memcpy(data, &obj, sizeof(T));
+}
+
+/**
+ * @brief Unpack object data as T and pass the struct to a visitor
+ */
+template <typename T, typename V>
+bool unpackWith(const void *data, size_t len, V &visitor)
+{
+    T obj;
+
+    if (!unpack(obj, data, len))
+        return false;
+
+    visitor(obj);
+    return true;
+}
+
+} // namespace uavo
+
+#endif // UAVOBJECTPOD_H
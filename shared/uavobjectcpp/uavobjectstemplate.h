@@ -0,0 +1,51 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjects.h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      All plain UAVObject structs, and decoding by object id
+ *
+ * $(GENERATEDWARNING)
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef UAVOBJECTPOD_UAVOBJECTS_H
+#define UAVOBJECTPOD_UAVOBJECTS_H
+
+#include "uavobjectpod.h"
+$(INCLUDES)
+namespace uavo {
+
+/**
+ * @brief Unpack object data by object id and pass the struct to a visitor,
+ * which takes each of the object structs
+ * @return false if the object is unknown or the size doesn't match
+ */
+template <typename V>
+bool dispatch(uint32_t objId, const void *data, size_t len, V &&visitor)
+{
+    switch (objId) {
+$(DISPATCHCASES)    default:
+        return false;
+    }
+}
+
+} // namespace uavo
+
+#endif // UAVOBJECTPOD_UAVOBJECTS_H
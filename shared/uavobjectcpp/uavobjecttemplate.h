@@ -0,0 +1,78 @@
+/**
+ ******************************************************************************
+ *
+ * @file       $(NAMELC).h
+ * @author     dRonin, http://dRonin.org/, Copyright (C) 2016
+ * @brief      Plain struct of the $(NAME) object, laid out as sent
+ *
+ * $(GENERATEDWARNING)
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef UAVOBJECTPOD_$(NAMEUC)_H
+#define UAVOBJECTPOD_$(NAMEUC)_H
+
+#include "uavobjectpod.h"
+
+namespace uavo {
+
+#pragma pack(push, 1)
+
+struct $(NAME)
+{
+    static const uint32_t OBJID = $(OBJIDHEX);
+    static const uint16_t NUMBYTES = $(NUMBYTES);
+    static const uint16_t NUMFIELDS = $(NUMFIELDS);
+    static const bool ISSINGLEINST = $(ISSINGLEINSTBOOL);
+    static const bool ISSETTINGS = $(ISSETTINGSBOOL);
+
+    static constexpr const char *name() { return "$(NAME)"; }
+
+$(FIELDCONSTANTS)
+$(DATAFIELDS)
+    /**
+     * @brief Call v(name, field) for each field, in packing order
+     */
+    template <typename V>
+    void visit(V &&v)
+    {
+$(VISITS)    }
+
+    template <typename V>
+    void visit(V &&v) const
+    {
+$(VISITS)    }
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof($(NAME)) == $(NAME)::NUMBYTES, "$(NAME) doesn't match the object data");
+$(OFFSETASSERTS)
+static constexpr FieldInfo $(NAME)_fields[] = {
+$(FIELDINFO)};
+
+template <>
+struct FieldTable<$(NAME)>
+{
+    static constexpr const FieldInfo *fields() { return $(NAME)_fields; }
+};
+
+} // namespace uavo
+
+#endif // UAVOBJECTPOD_$(NAMEUC)_H